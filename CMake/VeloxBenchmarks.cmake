@@ -0,0 +1,88 @@
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Umbrella targets for the benchmarks of all modules. 'velox_benchmarks'
+# builds every executable target with "benchmark" in its name.
+# 'velox_benchmarks_run' runs them with scripts/benchmark-runner.py, writes
+# the results to velox_benchmarks.json in the build directory and, if
+# VELOX_BENCHMARKS_BASELINE is set, fails on significant regressions
+# against that baseline.
+
+set(VELOX_BENCHMARKS_EXCLUDE
+    "velox_tpch_benchmark|velox_fragmentation_benchmark|codegen"
+    CACHE STRING
+          "Regex of benchmarks that velox_benchmarks_run skips, e.g. the ones \
+that need external data")
+set(VELOX_BENCHMARKS_BASELINE
+    ""
+    CACHE FILEPATH "Results of velox_benchmarks_run to compare against")
+set(VELOX_BENCHMARKS_REPETITIONS
+    3
+    CACHE STRING "Number of runs of each benchmark by velox_benchmarks_run")
+
+# Sets 'result' to the benchmark targets defined in 'dir' and below.
+function(velox_collect_benchmarks dir result)
+  set(found)
+  get_property(
+    targets
+    DIRECTORY ${dir}
+    PROPERTY BUILDSYSTEM_TARGETS)
+  foreach(target ${targets})
+    get_target_property(type ${target} TYPE)
+    if(type STREQUAL "EXECUTABLE" AND target MATCHES "benchmark")
+      list(APPEND found ${target})
+    endif()
+  endforeach()
+  get_property(
+    subdirs
+    DIRECTORY ${dir}
+    PROPERTY SUBDIRECTORIES)
+  foreach(subdir ${subdirs})
+    velox_collect_benchmarks(${subdir} subdirFound)
+    list(APPEND found ${subdirFound})
+  endforeach()
+  set(${result}
+      ${found}
+      PARENT_SCOPE)
+endfunction()
+
+# Adds the umbrella targets. Called after all subdirectories are added.
+function(velox_add_benchmark_targets)
+  velox_collect_benchmarks(${CMAKE_SOURCE_DIR}/velox benchmarks)
+  if(NOT benchmarks)
+    return()
+  endif()
+  add_custom_target(velox_benchmarks)
+  add_dependencies(velox_benchmarks ${benchmarks})
+
+  set(binaries)
+  foreach(target ${benchmarks})
+    list(APPEND binaries $<TARGET_FILE:${target}>)
+  endforeach()
+  set(args --output ${CMAKE_BINARY_DIR}/velox_benchmarks.json --repetitions
+           ${VELOX_BENCHMARKS_REPETITIONS})
+  if(VELOX_BENCHMARKS_EXCLUDE)
+    list(APPEND args --exclude "${VELOX_BENCHMARKS_EXCLUDE}")
+  endif()
+  if(VELOX_BENCHMARKS_BASELINE)
+    list(APPEND args --baseline ${VELOX_BENCHMARKS_BASELINE})
+  endif()
+  add_custom_target(
+    velox_benchmarks_run
+    COMMAND ${CMAKE_SOURCE_DIR}/scripts/benchmark-runner.py run ${args}
+            ${binaries}
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    USES_TERMINAL VERBATIM)
+  add_dependencies(velox_benchmarks_run velox_benchmarks)
+endfunction()
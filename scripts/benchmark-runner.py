@@ -0,0 +1,238 @@
+#!/usr/bin/env python3
+# Copyright (c) Facebook, Inc. and its affiliates.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Runs folly benchmark binaries, writes their results in a common JSON
+# schema and compares results against a stored baseline.
+#
+#   benchmark-runner.py run --output current.json <binary>...
+#   benchmark-runner.py compare baseline.json current.json
+#
+# The result file is
+#
+#   {
+#     "schema_version": 1,
+#     "time": <epoch seconds>,
+#     "host": <hostname>,
+#     "benchmarks": [
+#       {"suite": <binary name>, "name": <benchmark name>,
+#        "unit": "ps", "samples": [<time per iteration>, ...]},
+#       ...
+#     ]
+#   }
+#
+# with one sample per repetition of the suite. Times per iteration are as
+# reported by folly's --json flag, in picoseconds.
+
+import argparse
+import json
+import math
+import os
+import re
+import socket
+import statistics
+import sys
+import time
+
+import util
+
+SCHEMA_VERSION = 1
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Velox benchmark runner")
+    command = parser.add_subparsers(dest="command")
+    command.add_parser("help")
+
+    run_parser = command.add_parser("run")
+    run_parser.add_argument("binaries", nargs="+")
+    run_parser.add_argument("--output", required=True)
+    run_parser.add_argument(
+        "--repetitions",
+        type=int,
+        default=3,
+        help="Number of runs of each binary",
+    )
+    run_parser.add_argument(
+        "--exclude",
+        default="",
+        help="Regex of binary names to skip",
+    )
+    run_parser.add_argument(
+        "--bm_args",
+        default="",
+        help="Extra flags passed to each binary",
+    )
+    run_parser.add_argument(
+        "--baseline",
+        default="",
+        help="Compares with this baseline after running",
+    )
+    add_compare_args(run_parser)
+
+    compare_parser = command.add_parser("compare")
+    compare_parser.add_argument("baseline")
+    compare_parser.add_argument("current")
+    add_compare_args(compare_parser)
+
+    parser.set_defaults(command="help")
+    return parser.parse_args()
+
+
+def add_compare_args(parser):
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.05,
+        help="Relative slowdown of the mean that counts as a regression",
+    )
+    parser.add_argument(
+        "--sigmas",
+        type=float,
+        default=2.0,
+        help="Number of standard errors of the difference of the means a "
+        "slowdown must exceed to be significant",
+    )
+
+
+def folly_results(stdout):
+    # Benchmarks may print more than folly's JSON object. Returns the last
+    # object that parses.
+    decoder = json.JSONDecoder()
+    result = None
+    for match in re.finditer(r"^\{", stdout, re.MULTILINE):
+        try:
+            value, _ = decoder.raw_decode(stdout[match.start() :])
+        except ValueError:
+            continue
+        if isinstance(value, dict):
+            result = value
+    return result
+
+
+def run(args):
+    exclude = re.compile(args.exclude) if args.exclude else None
+    benchmarks = {}
+    failed = []
+    for binary in args.binaries:
+        suite = os.path.basename(binary)
+        if exclude and exclude.search(suite):
+            continue
+        for repetition in range(args.repetitions):
+            print(f"Running {suite} ({repetition + 1}/{args.repetitions})")
+            status, stdout, _ = util.run(f"{binary} --json {args.bm_args}")
+            results = folly_results(stdout) if status == 0 else None
+            if results is None:
+                failed.append(suite)
+                break
+            for name, value in results.items():
+                # Separator lines of BENCHMARK_DRAW_LINE.
+                if name == "-":
+                    continue
+                benchmark = benchmarks.setdefault(
+                    (suite, name),
+                    {"suite": suite, "name": name, "unit": "ps", "samples": []},
+                )
+                benchmark["samples"].append(value)
+
+    with open(args.output, "w") as file:
+        json.dump(
+            {
+                "schema_version": SCHEMA_VERSION,
+                "time": int(time.time()),
+                "host": socket.gethostname(),
+                "benchmarks": list(benchmarks.values()),
+            },
+            file,
+            indent=2,
+        )
+    print(f"Wrote {len(benchmarks)} benchmarks to {args.output}")
+
+    if failed:
+        print(
+            "Failed or produced no results: " + ", ".join(failed),
+            file=sys.stderr,
+        )
+        return 1
+    if args.baseline:
+        return compare_files(args.baseline, args.output, args)
+    return 0
+
+
+def load(path):
+    with open(path) as file:
+        results = json.load(file)
+    if results.get("schema_version") != SCHEMA_VERSION:
+        raise ValueError(f"{path}: unsupported schema version")
+    return {(b["suite"], b["name"]): b["samples"] for b in results["benchmarks"]}
+
+
+def is_regression(baseline, current, args):
+    baseline_mean = statistics.mean(baseline)
+    current_mean = statistics.mean(current)
+    if baseline_mean <= 0:
+        return False, 0.0
+    change = (current_mean - baseline_mean) / baseline_mean
+    if change <= args.threshold:
+        return False, change
+    # Standard error of the difference of the means. A single sample has no
+    # spread, so the threshold alone decides.
+    variance = 0.0
+    if len(baseline) > 1:
+        variance += statistics.variance(baseline) / len(baseline)
+    if len(current) > 1:
+        variance += statistics.variance(current) / len(current)
+    significant = current_mean - baseline_mean > args.sigmas * math.sqrt(variance)
+    return significant, change
+
+
+def compare_files(baseline_path, current_path, args):
+    baseline = load(baseline_path)
+    current = load(current_path)
+    regressions = []
+    for key in sorted(current.keys()):
+        if key not in baseline:
+            print(f"NEW        {key[0]}: {key[1]}")
+            continue
+        regression, change = is_regression(baseline[key], current[key], args)
+        label = "REGRESSION" if regression else "ok"
+        print(f"{label:<10} {key[0]}: {key[1]} {change:+.1%}")
+        if regression:
+            regressions.append(key)
+    for key in sorted(baseline.keys() - current.keys()):
+        print(f"MISSING    {key[0]}: {key[1]}")
+
+    if regressions:
+        print(f"{len(regressions)} regressions", file=sys.stderr)
+        return 1
+    return 0
+
+
+def compare(args):
+    return compare_files(args.baseline, args.current, args)
+
+
+def help(args):
+    print("Usage: benchmark-runner.py {run,compare} ... (-h for details)")
+    return 0
+
+
+def main():
+    args = parse_args()
+    return globals()[args.command](args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
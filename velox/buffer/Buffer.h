@@ -650,5 +650,56 @@ class BufferView : public Buffer {
   Releaser const releaser_;
 };
 
+// Releaser of a BufferView over part of another Buffer. Holds a reference
+// to the other Buffer for the lifetime of the view.
+class SharedBufferReleaser {
+ public:
+  explicit SharedBufferReleaser(BufferPtr buffer)
+      : buffer_(std::move(buffer)) {}
+
+  void addRef() const {}
+  void release() const {}
+
+ private:
+  const BufferPtr buffer_;
+};
+
+// Returns a Buffer with 'length' values of type T of 'buffer' starting at
+// value 'offset'. The result is a view on the memory of 'buffer' and is not
+// mutable, so that vectors copy it before writing. For T = bool the values
+// are bits and are copied to a new Buffer from 'pool' if 'offset' is not a
+// multiple of 8.
+template <typename T>
+BufferPtr sliceBuffer(
+    const BufferPtr& buffer,
+    size_t offset,
+    size_t length,
+    memory::MemoryPool* pool) {
+  static_assert(Buffer::is_pod_like_v<T>);
+  if constexpr (std::is_same_v<T, bool>) {
+    VELOX_CHECK_LE(bits::nbytes(offset + length), buffer->size());
+    if (offset % 8 != 0) {
+      auto result = AlignedBuffer::allocate<bool>(length, pool);
+      bits::copyBits(
+          buffer->as<uint64_t>(),
+          offset,
+          result->asMutable<uint64_t>(),
+          0,
+          length);
+      return result;
+    }
+    return BufferView<SharedBufferReleaser>::create(
+        buffer->as<uint8_t>() + offset / 8,
+        bits::nbytes(length),
+        SharedBufferReleaser(buffer));
+  } else {
+    VELOX_CHECK_LE((offset + length) * sizeof(T), buffer->size());
+    return BufferView<SharedBufferReleaser>::create(
+        buffer->as<uint8_t>() + offset * sizeof(T),
+        length * sizeof(T),
+        SharedBufferReleaser(buffer));
+  }
+}
+
 } // namespace velox
 } // namespace facebook
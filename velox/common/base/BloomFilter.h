@@ -22,6 +22,8 @@
 #include <folly/Hash.h>
 
 #include "velox/common/base/BitUtil.h"
+#include "velox/common/base/Exceptions.h"
+#include "velox/common/base/SimdUtil.h"
 
 namespace facebook::velox {
 
@@ -38,8 +40,35 @@ class BloomFilter {
   // entries. Drops any prior content.
   void reset(int32_t capacity) {
     bits_.clear();
-    // 2 bytes per value.
-    bits_.resize(std::max<int32_t>(4, bits::nextPowerOfTwo(capacity) / 4));
+    bits_.resize(numWords(capacity));
+  }
+
+  // Halves the size until it is the size for 'capacity' entries. Keeps the
+  // inserted values. Used when fewer values than expected were inserted.
+  void shrink(int32_t capacity) {
+    auto size = numWords(capacity);
+    while (bits_.size() > size) {
+      // The word is selected by the low bits of the index, so words that
+      // differ only in the highest bit of the index are merged.
+      auto half = bits_.size() / 2;
+      for (auto i = 0; i < half; ++i) {
+        bits_[i] |= bits_[i + half];
+      }
+      bits_.resize(half);
+    }
+  }
+
+  // Returns the words of the filter, e.g. for serialization.
+  const std::vector<uint64_t>& bits() const {
+    return bits_;
+  }
+
+  // Replaces the content with 'bits' from bits() of another filter.
+  void setBits(std::vector<uint64_t> bits) {
+    VELOX_CHECK(
+        !bits.empty() && bits::isPowerOfTwo(bits.size()),
+        "BloomFilter size must be a power of 2");
+    bits_ = std::move(bits);
   }
 
   // Adds 'value'.
@@ -56,7 +85,36 @@ class BloomFilter {
         hashInput ? folly::hasher<uint64_t>()(value) : value);
   }
 
+  // Tests 4 hash numbers at a time. Returns a lane mask that is all ones
+  // for the lanes of 'hashes' that may have been inserted. Only for
+  // pre-hashed input. 'lanes' has all ones in the lanes to test. The others
+  // are not accessed and come out as 0.
+  __m256i mayContain4x64(__m256i hashes, __m256i lanes) const {
+    static_assert(!hashInput, "mayContain4x64 takes hash numbers");
+    using V64 = simd::Vectors<int64_t>;
+    auto one = V64::setAll(1);
+    auto sixBits = V64::setAll(63);
+    auto mask = _mm256_sllv_epi64(one, hashes & sixBits) |
+        _mm256_sllv_epi64(one, _mm256_srli_epi64(hashes, 6) & sixBits) |
+        _mm256_sllv_epi64(one, _mm256_srli_epi64(hashes, 12) & sixBits) |
+        _mm256_sllv_epi64(one, _mm256_srli_epi64(hashes, 18) & sixBits);
+    auto index =
+        _mm256_srli_epi64(hashes, 24) & V64::setAll(bits_.size() - 1);
+    auto words = _mm256_mask_i64gather_epi64(
+        V64::setAll(0),
+        reinterpret_cast<const long long int*>(bits_.data()),
+        index,
+        lanes,
+        8);
+    return V64::compareEq(words & mask, mask) & lanes;
+  }
+
  private:
+  // 2 bytes per value.
+  static size_t numWords(int32_t capacity) {
+    return std::max<int32_t>(4, bits::nextPowerOfTwo(capacity) / 4);
+  }
+
   // We use 4 independent hash functions by taking 24 bits of
   // the hash code and breaking these up into 4 groups of 6 bits. Each group
   // represents a number between 0 and 63 (2^6-1) and maps to one bit in a
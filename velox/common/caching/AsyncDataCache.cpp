@@ -16,14 +16,110 @@
 
 #include "velox/common/caching/AsyncDataCache.h"
 #include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/SsdCache.h"
 
 #include <folly/executors/QueuedImmediateExecutor.h>
 
+#include "velox/common/base/StatsReporter.h"
+
 namespace facebook::velox::cache {
 
 using memory::MachinePageCount;
 using memory::MappedMemory;
 
+namespace {
+// Returns the bucket of CacheStats::evictAgeHistogram for 'age'.
+int32_t ageBucket(AccessTime age) {
+  if (age <= 0) {
+    return 0;
+  }
+  return std::min<int32_t>(
+      CacheStats::kNumAgeBuckets - 1, 64 - bits::countLeadingZeros(age));
+}
+} // namespace
+
+void CacheStats::add(const CacheStats& other) {
+  tinySize += other.tinySize;
+  largeSize += other.largeSize;
+  tinyPadding += other.tinyPadding;
+  largePadding += other.largePadding;
+  numEntries += other.numEntries;
+  numEmptyEntries += other.numEmptyEntries;
+  numShared += other.numShared;
+  numExclusive += other.numExclusive;
+  numPrefetch += other.numPrefetch;
+  prefetchBytes += other.prefetchBytes;
+  numHit += other.numHit;
+  numNew += other.numNew;
+  numHighPriorityHit += other.numHighPriorityHit;
+  numHighPriorityNew += other.numHighPriorityNew;
+  highPriorityBytes += other.highPriorityBytes;
+  numEvict += other.numEvict;
+  numPrefetchHit += other.numPrefetchHit;
+  numPrefetchEvict += other.numPrefetchEvict;
+  numEvictChecks += other.numEvictChecks;
+  numWaitExclusive += other.numWaitExclusive;
+  allocClocks += other.allocClocks;
+  sumEvictScore += other.sumEvictScore;
+  for (auto i = 0; i < kNumAgeBuckets; ++i) {
+    evictAgeHistogram[i] += other.evictAgeHistogram[i];
+  }
+}
+
+CacheStats CacheStats::operator-(const CacheStats& other) const {
+  CacheStats result = *this;
+  result.numHit -= other.numHit;
+  result.numNew -= other.numNew;
+  result.numHighPriorityHit -= other.numHighPriorityHit;
+  result.numHighPriorityNew -= other.numHighPriorityNew;
+  result.numEvict -= other.numEvict;
+  result.numPrefetchHit -= other.numPrefetchHit;
+  result.numPrefetchEvict -= other.numPrefetchEvict;
+  result.numEvictChecks -= other.numEvictChecks;
+  result.numWaitExclusive -= other.numWaitExclusive;
+  result.allocClocks -= other.allocClocks;
+  result.sumEvictScore -= other.sumEvictScore;
+  for (auto i = 0; i < kNumAgeBuckets; ++i) {
+    result.evictAgeHistogram[i] -= other.evictAgeHistogram[i];
+  }
+  return result;
+}
+
+FrequencySketch::FrequencySketch(int32_t sizeBits)
+    : mask_(bits::lowMask(sizeBits)),
+      sampleSize_(10 << sizeBits),
+      counters_(kNumRows << sizeBits) {}
+
+void FrequencySketch::increment(uint64_t hash) {
+  auto rowSize = mask_ + 1;
+  for (auto row = 0; row < kNumRows; ++row) {
+    auto& counter = counters_[row * rowSize + index(hash, row)];
+    if (counter < kMaxCount) {
+      ++counter;
+    }
+  }
+  if (++numIncrements_ >= sampleSize_) {
+    age();
+  }
+}
+
+int32_t FrequencySketch::estimate(uint64_t hash) const {
+  auto rowSize = mask_ + 1;
+  int32_t result = kMaxCount;
+  for (auto row = 0; row < kNumRows; ++row) {
+    result = std::min<int32_t>(
+        result, counters_[row * rowSize + index(hash, row)]);
+  }
+  return result;
+}
+
+void FrequencySketch::age() {
+  for (auto& counter : counters_) {
+    counter >>= 1;
+  }
+  numIncrements_ = 0;
+}
+
 AsyncDataCacheEntry::AsyncDataCacheEntry(CacheShard* shard)
     : shard_(shard), data_(shard->cache()) {}
 
@@ -114,7 +210,8 @@ std::unique_ptr<AsyncDataCacheEntry> CacheShard::getFreeEntryWithSize(
 CachePin CacheShard::findOrCreate(
     RawFileCacheKey key,
     uint64_t size,
-    folly::SemiFuture<bool>* wait) {
+    folly::SemiFuture<bool>* wait,
+    CachePriority priority) {
   AsyncDataCacheEntry* entryToInit = nullptr;
   {
     std::lock_guard<std::mutex> l(mutex_);
@@ -131,18 +228,29 @@ CachePin CacheShard::findOrCreate(
         return CachePin();
       }
       found->touch();
-      // The entry is in a readable state. Add a pin.
+      if (priority > found->priority_) {
+        setPriorityLocked(found, priority);
+      }
+      // The entry is in a readable state. Add a pin. The first hit on
+      // a prefetched entry is the use the prefetch was made for and
+      // does not count as a reuse.
       if (found->isPrefetch_) {
         found->isFirstUse_ = true;
         found->setPrefetch(false);
+        ++numPrefetchHit_;
       } else {
         ++numHit_;
+        if (priority == CachePriority::kHigh) {
+          ++numHighPriorityHit_;
+        }
+        frequency_.increment(std::hash<RawFileCacheKey>()(key));
       }
       ++found->numPins_;
       CachePin pin;
       pin.setEntry(found);
       return pin;
     } else {
+      frequency_.increment(std::hash<RawFileCacheKey>()(key));
       auto newEntry = getFreeEntryWithSize(size);
       // Initialize the members that must be set inside 'mutex_'.
       newEntry->numPins_ = AsyncDataCacheEntry::kExclusive;
@@ -159,14 +267,30 @@ CachePin CacheShard::findOrCreate(
       }
     }
     ++numNew_;
+    if (priority == CachePriority::kHigh) {
+      ++numHighPriorityNew_;
+    }
+  }
+  return initEntry(key, entryToInit, size, priority);
+}
+
+void CacheShard::setPriorityLocked(
+    AsyncDataCacheEntry* entry,
+    CachePriority priority) {
+  if (entry->priority_ == CachePriority::kHigh) {
+    cache_->incrementHighPriorityBytes(-entry->size_);
+  }
+  entry->priority_ = priority;
+  if (priority == CachePriority::kHigh) {
+    cache_->incrementHighPriorityBytes(entry->size_);
   }
-  return initEntry(key, entryToInit, size);
 }
 
 CachePin CacheShard::initEntry(
     RawFileCacheKey key,
     AsyncDataCacheEntry* entry,
-    int64_t size) {
+    int64_t size,
+    CachePriority priority) {
   //   The new entry is in the map and is in
   // exclusive mode and is otherwise uninitialized. Other threads may
   // find it and may add a Promis or wait for a promise that another
@@ -198,6 +322,10 @@ CachePin CacheShard::initEntry(
   }
   entry->touch();
   entry->size_ = size;
+  if (priority != CachePriority::kNormal) {
+    std::lock_guard<std::mutex> l(mutex_);
+    setPriorityLocked(entry, priority);
+  }
   CachePin pin;
   pin.setEntry(entry);
   return pin;
@@ -293,6 +421,7 @@ void CacheShard::removeEntryLocked(AsyncDataCacheEntry* entry) {
     VELOX_CHECK(removeIter != entryMap_.end());
     entryMap_.erase(removeIter);
     entry->key_.fileNum.clear();
+    setPriorityLocked(entry, CachePriority::kNormal);
     if (entry->isPrefetch()) {
       entry->setPrefetch(false);
     }
@@ -304,6 +433,10 @@ void CacheShard::evict(uint64_t bytesToFree, bool evictAllUnpinned) {
   int64_t largeFreed = 0;
   auto now = accessTime();
   std::vector<MappedMemory::Allocation> toFree;
+  // Valid entries to be written to SSD. Their memory is freed after
+  // the write.
+  std::vector<SsdWriteItem> toSave;
+  auto ssdCache = cache_->ssdCache();
   {
     std::lock_guard<std::mutex> l(mutex_);
     int size = entries_.size();
@@ -326,6 +459,10 @@ void CacheShard::evict(uint64_t bytesToFree, bool evictAllUnpinned) {
       if (!candidate) {
         continue;
       }
+      if (candidate->priority_ == CachePriority::kHigh &&
+          cache_->isHighPriorityReserved()) {
+        continue;
+      }
       ++numChecked;
       ++clockHand_;
       if (evictionThreshold_ == kNoThreshold ||
@@ -339,14 +476,33 @@ void CacheShard::evict(uint64_t bytesToFree, bool evictAllUnpinned) {
       int32_t score = 0;
       if (candidate->numPins_ == 0 &&
           (!candidate->key_.fileNum.hasValue() || evictAllUnpinned ||
-           (score = candidate->score(now)) >= evictionThreshold_)) {
+           isProbation(*candidate) ||
+           (score = candidate->score(now, frequency(*candidate))) >=
+               evictionThreshold_)) {
+        tinyFreed += candidate->tinyData_.size();
+        largeFreed += candidate->data_.byteSize();
+        if (candidate->key_.fileNum.hasValue()) {
+          ++evictAgeHistogram_[ageBucket(
+              now - candidate->accessStats_.lastUse)];
+          if (candidate->isPrefetch_) {
+            ++numPrefetchEvict_;
+          }
+        }
+        if (ssdCache && candidate->dataValid_ &&
+            candidate->key_.fileNum.hasValue() &&
+            ssdCache->startWrite(candidate->size_)) {
+          toSave.push_back(SsdWriteItem{
+              candidate->key_,
+              candidate->size_,
+              std::move(candidate->data_),
+              std::move(candidate->tinyData_)});
+        } else {
+          toFree.push_back(std::move(candidate->data()));
+        }
         removeEntryLocked(candidate);
         freeEntries_.push_back(std::move(*iter));
         emptySlots_.push_back(entryIndex);
-        tinyFreed += candidate->tinyData_.size();
         candidate->tinyData_.clear();
-        largeFreed += candidate->data_.byteSize();
-        toFree.push_back(std::move(candidate->data()));
         candidate->size_ = 0;
         ++numEvict_;
         if (score) {
@@ -358,6 +514,9 @@ void CacheShard::evict(uint64_t bytesToFree, bool evictAllUnpinned) {
       }
     }
   }
+  if (!toSave.empty()) {
+    ssdCache->write(std::move(toSave));
+  }
   ClockTimer t(allocClocks_);
   toFree.clear();
   cache_->incrementCachedPages(
@@ -373,7 +532,14 @@ void CacheShard::calibrateThreshold() {
   evictionThreshold_ = percentile<int32_t>(
       [&]() -> int32_t {
         AsyncDataCacheEntry* element = iter->get();
-        int32_t score = element ? element->score(now) : 0;
+        // Free slots and probationary entries count as high scores so
+        // that retained entries are not evicted while there is other
+        // space to reclaim.
+        int32_t score = kProbationScore;
+        if (element && element->key_.fileNum.hasValue() &&
+            !isProbation(*element)) {
+          score = element->score(now, frequency(*element));
+        }
         if (entryIndex + step >= entries_.size()) {
           entryIndex = (entryIndex + step) % entries_.size();
           iter = entries_.begin() + entryIndex;
@@ -410,30 +576,65 @@ void CacheShard::updateStats(CacheStats& stats) {
   }
   stats.numHit += numHit_;
   stats.numNew += numNew_;
+  stats.numHighPriorityHit += numHighPriorityHit_;
+  stats.numHighPriorityNew += numHighPriorityNew_;
   stats.numEvict += numEvict_;
+  stats.numPrefetchHit += numPrefetchHit_;
+  stats.numPrefetchEvict += numPrefetchEvict_;
+  for (auto i = 0; i < CacheStats::kNumAgeBuckets; ++i) {
+    stats.evictAgeHistogram[i] += evictAgeHistogram_[i];
+  }
   stats.numEvictChecks += numEvictChecks_;
   stats.numWaitExclusive += numWaitExclusive_;
   stats.sumEvictScore += sumEvictScore_;
   stats.allocClocks += allocClocks_;
 }
 
+void CacheShard::addCachedBytes(const CachedFileRanges& ranges) {
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto& entry : entries_) {
+    if (!entry || !entry->key_.fileNum.hasValue() || !entry->dataValid_) {
+      continue;
+    }
+    auto it = ranges.find(entry->key_.fileNum.id());
+    if (it == ranges.end()) {
+      continue;
+    }
+    for (auto range : it->second) {
+      if (range->contains(entry->key_.offset)) {
+        range->memoryBytes += entry->size_;
+      }
+    }
+  }
+}
+
 AsyncDataCache::AsyncDataCache(
     std::unique_ptr<MappedMemory> mappedMemory,
     uint64_t maxBytes)
+    : AsyncDataCache(std::move(mappedMemory), maxBytes, nullptr) {}
+
+AsyncDataCache::AsyncDataCache(
+    std::unique_ptr<MappedMemory> mappedMemory,
+    uint64_t maxBytes,
+    std::unique_ptr<SsdCache> ssdCache)
     : mappedMemory_(std::move(mappedMemory)),
       cachedPages_(0),
-      maxBytes_(maxBytes) {
+      maxBytes_(maxBytes),
+      ssdCache_(std::move(ssdCache)) {
   for (auto i = 0; i < kNumShards; ++i) {
     shards_.push_back(std::make_unique<CacheShard>(this));
   }
 }
 
+AsyncDataCache::~AsyncDataCache() = default;
+
 CachePin AsyncDataCache::findOrCreate(
     RawFileCacheKey key,
     uint64_t size,
-    folly::SemiFuture<bool>* wait) {
+    folly::SemiFuture<bool>* wait,
+    CachePriority priority) {
   int shard = std::hash<RawFileCacheKey>()(key) & (kShardMask);
-  return shards_[shard]->findOrCreate(key, size, wait);
+  return shards_[shard]->findOrCreate(key, size, wait, priority);
 }
 
 bool AsyncDataCache::makeSpace(
@@ -487,9 +688,59 @@ CacheStats AsyncDataCache::refreshStats() const {
   for (auto& shard : shards_) {
     shard->updateStats(stats);
   }
+  stats.highPriorityBytes = highPriorityBytes_;
   return stats;
 }
 
+std::vector<CacheStats> AsyncDataCache::shardStats() const {
+  std::vector<CacheStats> stats(shards_.size());
+  for (auto i = 0; i < shards_.size(); ++i) {
+    shards_[i]->updateStats(stats[i]);
+  }
+  return stats;
+}
+
+void AsyncDataCache::cachedBytes(std::vector<CachedFileRange>& ranges) const {
+  CachedFileRanges byFile;
+  for (auto& range : ranges) {
+    range.memoryBytes = 0;
+    range.ssdBytes = 0;
+    byFile[range.fileNum].push_back(&range);
+  }
+  for (auto& shard : shards_) {
+    shard->addCachedBytes(byFile);
+  }
+  if (ssdCache_) {
+    ssdCache_->addCachedBytes(byFile);
+  }
+}
+
+void AsyncDataCache::reportStats() {
+  std::lock_guard<std::mutex> l(reportMutex_);
+  auto stats = refreshStats();
+  auto delta = stats - lastReportedStats_;
+  lastReportedStats_ = stats;
+  static std::once_flag registerOnce;
+  std::call_once(registerOnce, []() {
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_hit", StatType::SUM);
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_miss", StatType::SUM);
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_evict", StatType::SUM);
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_prefetch_hit", StatType::SUM);
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_prefetch_evict", StatType::SUM);
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_wait_exclusive", StatType::SUM);
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_bytes", StatType::AVG);
+    REPORT_ADD_STAT_EXPORT_TYPE("velox.cache_prefetch_bytes", StatType::AVG);
+  });
+  REPORT_ADD_STAT_VALUE("velox.cache_hit", delta.numHit);
+  REPORT_ADD_STAT_VALUE("velox.cache_miss", delta.numNew);
+  REPORT_ADD_STAT_VALUE("velox.cache_evict", delta.numEvict);
+  REPORT_ADD_STAT_VALUE("velox.cache_prefetch_hit", delta.numPrefetchHit);
+  REPORT_ADD_STAT_VALUE("velox.cache_prefetch_evict", delta.numPrefetchEvict);
+  REPORT_ADD_STAT_VALUE("velox.cache_wait_exclusive", delta.numWaitExclusive);
+  REPORT_ADD_STAT_VALUE("velox.cache_bytes", stats.tinySize + stats.largeSize);
+  REPORT_ADD_STAT_VALUE("velox.cache_prefetch_bytes", stats.prefetchBytes);
+}
+
 std::string AsyncDataCache::toString() const {
   auto stats = refreshStats();
   std::stringstream out;
@@ -498,9 +749,17 @@ std::string AsyncDataCache::toString() const {
           stats.largePadding
       << " / " << maxBytes_ << " bytes\n"
       << "Miss: " << stats.numNew << " Hit " << stats.numHit << " evict "
-      << stats.numEvict << "\n"
+      << stats.numEvict << " prefetch hit ratio "
+      << stats.prefetchHitRatio() << "\n"
+      << "High priority: " << stats.highPriorityBytes << " / "
+      << highPriorityReserve_ << " bytes, miss "
+      << stats.numHighPriorityNew << " hit " << stats.numHighPriorityHit
+      << "\n"
       << " read pins " << stats.numShared << " unused prefetch "
       << stats.numPrefetch << " Alloc Mclks " << (stats.allocClocks >> 20);
+  if (ssdCache_) {
+    out << "\n" << ssdCache_->toString();
+  }
   return out.str();
 }
 
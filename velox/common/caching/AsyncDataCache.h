@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <deque>
 
 #include <folly/chrono/Hardware.h>
@@ -29,6 +30,7 @@ namespace facebook::velox::cache {
 
 class AsyncDataCache;
 class CacheShard;
+class SsdCache;
 
 // Type for tracking last access. This is based on CPU clock and
 // scaled to be around 1ms resolution. This can wrap around and is
@@ -49,12 +51,15 @@ struct AccessStats {
   int32_t numUses{0};
 
   // Retention score. A higher number means less worth retaining. This
-  // works well with a typical formula of time over use count going to
-  // zero as uses go up and time goes down. 'now' is the current
-  // accessTime(), passed from the caller since getting the time is
-  // expensive and many entries are checked one after the other.
-  int32_t score(AccessTime now, uint64_t /*size*/) const {
-    return (now - lastUse) / (1 + numUses);
+  // is time since last use over access frequency. 'frequency' is the
+  // estimate from the FrequencySketch of the shard, which counts
+  // accesses also before the entry was last created, so that data
+  // that is repeatedly evicted and reloaded is recognized as hot.
+  // 'now' is the current accessTime(), passed from the caller since
+  // getting the time is expensive and many entries are checked one
+  // after the other.
+  int32_t score(AccessTime now, int32_t frequency) const {
+    return (now - lastUse) / (1 + std::max<int32_t>(numUses, frequency));
   }
 
   // Updates the last access.
@@ -64,6 +69,42 @@ struct AccessStats {
   }
 };
 
+// Approximate count of recent accesses to cache keys, including keys
+// that are not or no longer in cache. This is a count-min sketch with
+// kNumRows rows of saturating counters. The counters are halved after
+// every 'sampleSize_' increments so that the counts reflect recent
+// accesses (the aging of TinyLFU). Not thread safe.
+class FrequencySketch {
+ public:
+  static constexpr int32_t kNumRows = 4;
+  static constexpr int32_t kMaxCount = 15;
+
+  // Makes a sketch with 2^'sizeBits' counters per row.
+  explicit FrequencySketch(int32_t sizeBits = 16);
+
+  // Records an access to the key with 'hash'.
+  void increment(uint64_t hash);
+
+  // Returns the number of recorded accesses to the key with 'hash',
+  // possibly overestimated. Saturates at kMaxCount.
+  int32_t estimate(uint64_t hash) const;
+
+ private:
+  int32_t index(uint64_t hash, int32_t row) const {
+    return bits::hashMix(hash, row) & mask_;
+  }
+
+  // Halves all counters.
+  void age();
+
+  const uint64_t mask_;
+  const int32_t sampleSize_;
+  // Rows one after the other.
+  std::vector<uint8_t> counters_;
+  // Number of increments since the last age().
+  int32_t numIncrements_{0};
+};
+
 // Owning reference to a file number and an offset.
 struct FileCacheKey {
   StringIdLease fileNum;
@@ -102,6 +143,12 @@ namespace facebook::velox::cache {
 
 class FusedLoad;
 
+// Class of a cache entry. High priority entries are not evicted while
+// their total size is within the reserve set by
+// AsyncDataCache::setHighPriorityReserve(), so that data of hot tables
+// stays cached regardless of other scans.
+enum class CachePriority : uint8_t { kNormal = 0, kHigh = 1 };
+
 // Represents a contiguous range of bytes cached from a file. This
 // is the primary unit of access. These are typically owned via
 // CachePin and can be in shared or exclusive mode. 'numPins_'
@@ -148,6 +195,10 @@ class AsyncDataCacheEntry {
     return size_;
   }
 
+  CachePriority priority() const {
+    return priority_;
+  }
+
   // Sets 'this' to loading state. Requires exclusive access on
   // entry. Sets the access mode to shared after installing the load.
   void setLoading(std::shared_ptr<FusedLoad> load) {
@@ -166,8 +217,8 @@ class AsyncDataCacheEntry {
     accessStats_.touch();
   }
 
-  int32_t score(AccessTime now) const {
-    return accessStats_.score(now, size_);
+  int32_t score(AccessTime now, int32_t frequency) const {
+    return accessStats_.score(now, frequency);
   }
 
   bool isShared() const {
@@ -250,6 +301,10 @@ class AsyncDataCacheEntry {
   std::unique_ptr<folly::SharedPromise<bool>> promise_;
   int32_t size_{0};
 
+  // Set on creation and raised by a hit of higher priority. Changed
+  // inside the mutex of 'shard_'.
+  CachePriority priority_{CachePriority::kNormal};
+
   // Setting this from 0 to 1 or to kExclusive requires owning shard_->mutex_.
   std::atomic<int32_t> numPins_{0};
   AccessStats accessStats_;
@@ -429,6 +484,9 @@ class FusedLoad : public std::enable_shared_from_this<FusedLoad> {
 // Struct for CacheShard stats. Stats from all shards are added into
 // this struct to provide a snapshot of state.
 struct CacheStats {
+  // Number of buckets in 'evictAgeHistogram'.
+  static constexpr int32_t kNumAgeBuckets = 24;
+
   // Total size in 'tynyData_'
   int64_t tinySize{};
   // Total size in 'data_'
@@ -455,8 +513,18 @@ struct CacheStats {
   int64_t numHit{};
   // Number of new entries created.
   int64_t numNew{};
+  // Hits and new entries for high priority requests. These are also
+  // counted in 'numHit' and 'numNew'.
+  int64_t numHighPriorityHit{};
+  int64_t numHighPriorityNew{};
+  // Total size of high priority entries.
+  int64_t highPriorityBytes{};
   // Number of times a valid entry was removed in order to make space.
   int64_t numEvict{};
+  // Number of prefetched entries hit for the first time and number of
+  // prefetched entries evicted before their first hit.
+  int64_t numPrefetchHit{};
+  int64_t numPrefetchEvict{};
   // Number of entries considered for evicting.
   int64_t numEvictChecks{};
   // Number of times a user waited for an entry to transit from exclusive to
@@ -468,8 +536,46 @@ struct CacheStats {
   // Sum of scores of evicted entries. This serves to infer an average
   // lifetime for entries in cache.
   int64_t sumEvictScore{};
+  // Counts of evicted entries by time from the last use to the
+  // eviction. Bucket i counts ages under 2^i accessTime() units of
+  // about 1ms. The last bucket also counts older entries.
+  std::array<int64_t, kNumAgeBuckets> evictAgeHistogram{};
+
+  // Returns the fraction of prefetched entries that were used, out of
+  // those that were used or evicted.
+  double prefetchHitRatio() const {
+    auto total = numPrefetchHit + numPrefetchEvict;
+    return total == 0 ? 1 : static_cast<double>(numPrefetchHit) / total;
+  }
+
+  // Adds 'other' to 'this'.
+  void add(const CacheStats& other);
+
+  // Returns the cumulative counters of 'this' minus those of 'other'.
+  // The gauges, e.g. sizes and entry counts, are those of 'this'.
+  CacheStats operator-(const CacheStats& other) const;
 };
 
+// A byte range of a file and how much of it is cached. Filled in by
+// AsyncDataCache::cachedBytes().
+struct CachedFileRange {
+  // Id of the file path in fileIds().
+  uint64_t fileNum;
+  uint64_t offset;
+  uint64_t size;
+  // Bytes of the entries that start in the range, in memory and on SSD.
+  uint64_t memoryBytes{0};
+  uint64_t ssdBytes{0};
+
+  bool contains(uint64_t entryOffset) const {
+    return entryOffset >= offset && entryOffset - offset < size;
+  }
+};
+
+// The CachedFileRanges of each file number.
+using CachedFileRanges =
+    folly::F14FastMap<uint64_t, std::vector<CachedFileRange*>>;
+
 class ClockTimer {
  public:
   explicit ClockTimer(std::atomic<uint64_t>& total)
@@ -497,7 +603,8 @@ class CacheShard {
   CachePin findOrCreate(
       RawFileCacheKey key,
       uint64_t size,
-      folly::SemiFuture<bool>* FOLLY_NULLABLE readyFuture);
+      folly::SemiFuture<bool>* FOLLY_NULLABLE readyFuture,
+      CachePriority priority);
 
   AsyncDataCache* FOLLY_NONNULL cache() {
     return cache_;
@@ -507,10 +614,14 @@ class CacheShard {
   }
 
   // removes 'bytesToFree' worth of entries or as many entries as are
-  // not pinned. This favors first removing older and less frequently
-  // used entries. If 'evictAllUnpinned' is true, anything that is
-  // not pinned is evicted at first sight. This is for out of memory
-  // emergencies.
+  // not pinned. Entries that have been accessed only once are on
+  // probation and are evicted at first sight, so that a scan over
+  // data that is not reused does not displace frequently used
+  // entries. Among the other entries this favors first removing older
+  // and less frequently used ones. If 'evictAllUnpinned' is true,
+  // anything that is not pinned is evicted at first sight. This is
+  // for out of memory emergencies. High priority entries are skipped
+  // in both cases while they fit in the reserve of the cache.
   void evict(uint64_t bytesToFree, bool evictAllUnpinned);
 
   // Removes 'entry' from 'this'.
@@ -519,9 +630,35 @@ class CacheShard {
   // Adds the stats of 'this' to 'stats'.
   void updateStats(CacheStats& stats);
 
+  // Adds the sizes of the loaded entries to the memoryBytes of the
+  // 'ranges' they start in.
+  void addCachedBytes(const CachedFileRanges& ranges);
+
  private:
   static constexpr int32_t kNoThreshold = std::numeric_limits<int32_t>::max();
+  // Entries with at most this many accesses in 'frequency_' are on
+  // probation.
+  static constexpr int32_t kMaxProbationFrequency = 1;
+  // Score given to probationary entries and free slots in
+  // calibrateThreshold(). If many entries are on probation, the
+  // threshold goes high enough to retain all the other entries.
+  static constexpr int32_t kProbationScore = kNoThreshold - 1;
+
   void calibrateThreshold();
+
+  int32_t frequency(const AsyncDataCacheEntry& entry) const {
+    return frequency_.estimate(std::hash<RawFileCacheKey>()(
+        RawFileCacheKey{entry.key_.fileNum.id(), entry.key_.offset}));
+  }
+
+  // True if 'entry' has been accessed so rarely that it should be
+  // evicted before entries that are accessed more often. A prefetched
+  // entry that has not been hit yet is not on probation.
+  bool isProbation(const AsyncDataCacheEntry& entry) const {
+    return !entry.isPrefetch_ &&
+        frequency(entry) <= kMaxProbationFrequency;
+  }
+
   void removeEntryLocked(AsyncDataCacheEntry* FOLLY_NONNULL entry);
   // Returns an unused entry if found. 'size' is a hint for selecting an entry
   // that already has the right amount of memory associated with it.
@@ -529,7 +666,14 @@ class CacheShard {
   CachePin initEntry(
       RawFileCacheKey key,
       AsyncDataCacheEntry* FOLLY_NONNULL entry,
-      int64_t size);
+      int64_t size,
+      CachePriority priority);
+
+  // Sets the priority of 'entry' and updates the high priority bytes of
+  // the cache.
+  void setPriorityLocked(
+      AsyncDataCacheEntry* FOLLY_NONNULL entry,
+      CachePriority priority);
 
   std::mutex mutex_;
   folly::F14FastMap<RawFileCacheKey, AsyncDataCacheEntry * FOLLY_NONNULL>
@@ -548,14 +692,26 @@ class CacheShard {
   uint32_t eventCounter_{};
   // Maximum retainable entry score(). Anything above this is evictable.
   int32_t evictionThreshold_{kNoThreshold};
+  // Access counts of keys hashing to 'this'.
+  FrequencySketch frequency_;
   // Cumulative count of cache hits.
   uint64_t numHit_{};
   // Cumulative count of hits on entries held in exclusive mode.
   uint64_t numWaitExclusive_{};
   // Cumulative count of new entry creation.
   uint64_t numNew_{};
+  // Cumulative counts of hits and new entries for high priority
+  // requests.
+  uint64_t numHighPriorityHit_{};
+  uint64_t numHighPriorityNew_{};
   // Count of entries evicted.
   uint64_t numEvict_{};
+  // Counts of prefetched entries hit for the first time and evicted
+  // before their first hit.
+  uint64_t numPrefetchHit_{};
+  uint64_t numPrefetchEvict_{};
+  // See CacheStats::evictAgeHistogram.
+  std::array<uint64_t, CacheStats::kNumAgeBuckets> evictAgeHistogram_{};
   // Count of entries considered for eviction. This divided by
   // 'numEvict_' measured efficiency of eviction.
   uint64_t numEvictChecks_{};
@@ -574,6 +730,15 @@ class AsyncDataCache : public memory::MappedMemory,
       std::unique_ptr<memory::MappedMemory> mappedMemory,
       uint64_t maxBytes);
 
+  // Creates a cache that writes evicted entries to 'ssdCache' and
+  // reads them back on a miss. 'ssdCache' may be nullptr.
+  AsyncDataCache(
+      std::unique_ptr<memory::MappedMemory> mappedMemory,
+      uint64_t maxBytes,
+      std::unique_ptr<SsdCache> ssdCache);
+
+  ~AsyncDataCache() override;
+
   // Finds or creates a cache entry corresponding to 'key'. The entry
   // is returned in 'pin'. If the entry is new, it is pinned in
   // exclusive mode and its 'data_' has uninitialized space for at
@@ -584,11 +749,14 @@ class AsyncDataCache : public memory::MappedMemory,
   // future that is realized when the pin is no longer exclusive. When
   // the future is realized, the caller may retry findOrCreate().
   // runtime error with code kNoCacheSpace if there is no space to create the
-  // new entry after evicting any unpinned content.
+  // new entry after evicting any unpinned content. A new entry gets
+  // 'priority'. An existing entry found with a higher 'priority' is
+  // raised to it.
   CachePin findOrCreate(
       RawFileCacheKey key,
       uint64_t size,
-      folly::SemiFuture<bool>* FOLLY_NULLABLE waitFuture = nullptr);
+      folly::SemiFuture<bool>* FOLLY_NULLABLE waitFuture = nullptr,
+      CachePriority priority = CachePriority::kNormal);
 
   bool allocate(
       memory::MachinePageCount numPages,
@@ -629,6 +797,21 @@ class AsyncDataCache : public memory::MappedMemory,
 
   CacheStats refreshStats() const;
 
+  // Returns the stats of each shard.
+  std::vector<CacheStats> shardStats() const;
+
+  // Sets the memoryBytes and ssdBytes of each of 'ranges' to the bytes of
+  // the entries that start in it. This tells a scheduler which splits
+  // have their data cached here. Visits all entries, so this is meant
+  // for occasional calls.
+  void cachedBytes(std::vector<CachedFileRange>& ranges) const;
+
+  // Reports the change in the stats since the previous call to the
+  // BaseStatsReporter of the process. See StatsReporter.h for
+  // registering the reporter. Meant to be called periodically by the
+  // application.
+  void reportStats();
+
   std::string toString() const override;
 
   memory::MachinePageCount incrementCachedPages(int64_t pages) {
@@ -645,6 +828,32 @@ class AsyncDataCache : public memory::MappedMemory,
     return maxBytes_;
   }
 
+  // Returns the second level cache or nullptr if there is none.
+  SsdCache* FOLLY_NULLABLE ssdCache() const {
+    return ssdCache_.get();
+  }
+
+  // Reserves 'fraction' of the capacity for high priority entries.
+  // These are not evicted while their total size is at most the
+  // reserve. Beyond that, they are evicted like other entries.
+  void setHighPriorityReserve(double fraction) {
+    VELOX_CHECK(fraction >= 0 && fraction < 1);
+    highPriorityReserve_ = fraction * maxBytes_;
+  }
+
+  // True if high priority entries are exempt from eviction.
+  bool isHighPriorityReserved() const {
+    return highPriorityBytes_ <= highPriorityReserve_;
+  }
+
+  int64_t incrementHighPriorityBytes(int64_t bytes) {
+    return highPriorityBytes_.fetch_add(bytes) + bytes;
+  }
+
+  int64_t highPriorityBytes() const {
+    return highPriorityBytes_;
+  }
+
  private:
   static constexpr int32_t kNumShards = 4; // Must be power of 2.
   static constexpr int32_t kShardMask = kNumShards - 1;
@@ -661,7 +870,17 @@ class AsyncDataCache : public memory::MappedMemory,
   // but not yet hit for the first time.
   std::atomic<memory::MachinePageCount> prefetchPages_{0};
   uint64_t maxBytes_;
+  // Bytes reserved for high priority entries.
+  std::atomic<int64_t> highPriorityReserve_{0};
+  // Total size of high priority entries.
+  std::atomic<int64_t> highPriorityBytes_{0};
   CacheStats stats_;
+  // Serializes reportStats() and holds the stats of its last call.
+  std::mutex reportMutex_;
+  CacheStats lastReportedStats_;
+  // Declared last so that pending writes, which hold memory of 'this',
+  // finish before the other members are destroyed.
+  std::unique_ptr<SsdCache> ssdCache_;
 };
 
 // Samples a set of values T from 'numSamples' calls of
@@ -30,8 +30,10 @@
 #include <memory>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include "folly/container/F14Set.h"
+#include "folly/hash/Hash.h"
 #include "glog/logging.h"
 
 #include "velox/common/caching/SimpleLRUCache.h"
@@ -192,6 +194,76 @@ class CachedFactory {
   std::condition_variable pendingCv_;
 };
 
+// A CachedFactory split into shards by the hash of the key. Each shard
+// has its own cache, generator and mutexes, so that threads looking up
+// or generating different keys rarely contend. Concurrent requests for
+// the same key wait for a single generation as in CachedFactory. Each
+// shard gets 1/numShards of 'maxSize' and evicts independently.
+template <
+    typename Key,
+    typename Value,
+    typename Generator,
+    typename Sizer = DefaultSizer<Value>,
+    typename Comparator = std::equal_to<Key>,
+    typename Hash = std::hash<Key>>
+class ShardedCachedFactory {
+ public:
+  static constexpr int32_t kDefaultNumShards = 16;
+
+  // Makes 'numShards' shards, each with a copy of 'generator'.
+  ShardedCachedFactory(
+      int64_t maxSize,
+      const Generator& generator,
+      int32_t numShards = kDefaultNumShards) {
+    CHECK_GT(numShards, 0);
+    const int64_t shardSize = (maxSize + numShards - 1) / numShards;
+    shards_.reserve(numShards);
+    for (auto i = 0; i < numShards; ++i) {
+      shards_.push_back(std::make_unique<Shard>(
+          std::make_unique<SimpleLRUCache<Key, Value, Comparator, Hash>>(
+              shardSize),
+          std::make_unique<Generator>(generator)));
+    }
+  }
+
+  // See CachedFactory::generate().
+  CachedPtr<Key, Value, Comparator, Hash> generate(const Key& key) {
+    return shardFor(key).generate(key);
+  }
+
+  // Total size of elements cached in all shards.
+  int64_t currentSize() const {
+    int64_t size = 0;
+    for (auto& shard : shards_) {
+      size += shard->currentSize();
+    }
+    return size;
+  }
+
+  // The sum of the maximum sizes of the shards.
+  int64_t maxSize() const {
+    int64_t size = 0;
+    for (auto& shard : shards_) {
+      size += shard->maxSize();
+    }
+    return size;
+  }
+
+  int32_t numShards() const {
+    return shards_.size();
+  }
+
+ private:
+  using Shard = CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>;
+
+  Shard& shardFor(const Key& key) {
+    // Mixes the hash since std::hash of integers is the identity.
+    return *shards_[folly::hash::twang_mix64(Hash()(key)) % shards_.size()];
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
 //
 // End of public API. Implementation follows.
 //
@@ -291,7 +363,7 @@ template <
 CachedPtr<Key, Value, Comparator, Hash>
 CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::generate(
     const Key& key) {
-  std::unique_lock<std::mutex> pending_lock(pendingMu_);
+  // Hits take only the cache mutex.
   {
     std::lock_guard<std::mutex> cache_lock(cacheMu_);
     Value* value = cache_->get(key);
@@ -304,6 +376,22 @@ CachedFactory<Key, Value, Generator, Sizer, Comparator, Hash>::generate(
           &cacheMu_);
     }
   }
+  std::unique_lock<std::mutex> pending_lock(pendingMu_);
+  if (!pending_.contains(key)) {
+    // The value may have been added between the lookup above and taking
+    // 'pendingMu_'. Generators add the value before clearing the pending
+    // key, so the value is in the cache now if it was generated.
+    std::lock_guard<std::mutex> cache_lock(cacheMu_);
+    Value* value = cache_->get(key);
+    if (value) {
+      return CachedPtr<Key, Value, Comparator, Hash>(
+          /*wasCached=*/true,
+          value,
+          cache_.get(),
+          std::make_unique<Key>(key),
+          &cacheMu_);
+    }
+  }
   if (pending_.contains(key)) {
     pendingCv_.wait(pending_lock, [&]() { return !pending_.contains(key); });
     // Will normally hit the cache now.
@@ -18,23 +18,98 @@
 
 #include <sstream>
 
+#include "velox/common/caching/FileIds.h"
+
 namespace facebook::velox::cache {
 
+void ScanHistory::merge(
+    const std::string& group,
+    const GroupTrackingData& data) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = groups_.find(group);
+  if (it == groups_.end()) {
+    if (groups_.size() >= kMaxGroups) {
+      auto oldest = groups_.begin();
+      for (auto candidate = groups_.begin(); candidate != groups_.end();
+           ++candidate) {
+        if (candidate->second.lastMerge < oldest->second.lastMerge) {
+          oldest = candidate;
+        }
+      }
+      groups_.erase(oldest);
+    }
+    it = groups_.emplace(group, Group()).first;
+  }
+  auto& history = it->second.data;
+  for (auto entry = history.begin(); entry != history.end();) {
+    entry->second.decay();
+    if (entry->second.numReferences == 0) {
+      entry = history.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+  for (auto& [id, counts] : data) {
+    history[id].add(counts);
+  }
+  it->second.lastMerge = ++numMerges_;
+}
+
+GroupTrackingData ScanHistory::get(const std::string& group) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = groups_.find(group);
+  if (it == groups_.end()) {
+    return {};
+  }
+  return it->second.data;
+}
+
+ScanHistory& scanHistory() {
+  static ScanHistory* history = new ScanHistory();
+  return *history;
+}
+
+ScanTracker::~ScanTracker() {
+  if (unregisterer_) {
+    unregisterer_(this);
+  }
+  for (auto& [groupId, group] : groups_) {
+    if (!group.name.empty() && !group.data.empty()) {
+      scanHistory().merge(group.name, group.data);
+    }
+  }
+}
+
+ScanTracker::Group& ScanTracker::groupLocked(uint64_t groupId) {
+  auto it = groups_.find(groupId);
+  if (it != groups_.end()) {
+    return it->second;
+  }
+  auto& group = groups_[groupId];
+  group.name = fileIds().string(groupId);
+  if (!group.name.empty()) {
+    group.history = scanHistory().get(group.name);
+  }
+  return group;
+}
+
 void ScanTracker::recordReference(
     const TrackingId id,
     uint64_t bytes,
-    uint64_t /*groupId*/) {
+    uint64_t groupId) {
   std::lock_guard<std::mutex> l(mutex_);
   data_[id].incrementReference(bytes);
+  groupLocked(groupId).data[id].incrementReference(bytes);
   sum_.incrementReference(bytes);
 }
 
 void ScanTracker::recordRead(
     const TrackingId id,
     uint64_t bytes,
-    uint64_t /*groupId*/) {
+    uint64_t groupId) {
   std::lock_guard<std::mutex> l(mutex_);
   data_[id].incrementRead(bytes);
+  groupLocked(groupId).data[id].incrementRead(bytes);
   sum_.incrementRead(bytes);
 }
 
@@ -87,15 +87,73 @@ struct TrackingData {
     readBytes += bytes;
     ++numReads;
   }
+
+  void add(const TrackingData& other) {
+    referencedBytes += other.referencedBytes;
+    readBytes += other.readBytes;
+    numReferences += other.numReferences;
+    numReads += other.numReads;
+  }
+
+  // Halves the counts so that older scans weigh less than new ones.
+  void decay() {
+    referencedBytes /= 2;
+    readBytes /= 2;
+    numReferences /= 2;
+    numReads /= 2;
+  }
 };
 
+// Per-stream reference and read counts of a file group.
+using GroupTrackingData = folly::F14FastMap<TrackingId, TrackingData>;
+
+// Keeps the TrackingData of past scans per file group, e.g. a
+// partition of a table, so that a new scan of the group can prefetch
+// the streams that earlier scans read. The groups are identified by
+// name since their ids do not outlive the file handles. The counts of
+// a group decay by half with each scan merged into them. The number of
+// groups is bounded. The least recently merged group is dropped when
+// the bound is exceeded.
+class ScanHistory {
+ public:
+  static constexpr int32_t kMaxGroups = 10'000;
+
+  // Adds the counts of a finished scan of 'group'.
+  void merge(const std::string& group, const GroupTrackingData& data);
+
+  // Returns the counts of past scans of 'group'.
+  GroupTrackingData get(const std::string& group);
+
+  int32_t numGroups() {
+    std::lock_guard<std::mutex> l(mutex_);
+    return groups_.size();
+  }
+
+ private:
+  struct Group {
+    GroupTrackingData data;
+    // Value of 'numMerges_' when last merged.
+    uint64_t lastMerge{0};
+  };
+
+  std::mutex mutex_;
+  folly::F14FastMap<std::string, Group> groups_;
+  uint64_t numMerges_{0};
+};
+
+// Returns the process-wide ScanHistory.
+ScanHistory& scanHistory();
+
 // Tracks column access frequency during execution of a query. A
 // ScanTracker is created at the level of a Task/TableScan, so that
 // all threads of a scan report in the same tracker. The same
 // ScanTracker tracks all reads of all partitions of the scan. The
 // groupId argument identifies the file group (e.g. partition) a
 // tracking event pertains to, since a single ScanTracker can range
-// over multiple partitions.
+// over multiple partitions. The counts of each group are merged into
+// scanHistory() when the tracker is destroyed and the counts of past
+// scans of a group are taken into account when deciding what to
+// prefetch from the group.
 class ScanTracker {
  public:
   ScanTracker() {}
@@ -109,11 +167,7 @@ class ScanTracker {
       std::function<void(ScanTracker*)> unregisterer)
       : id_(id), unregisterer_(unregisterer) {}
 
-  ~ScanTracker() {
-    if (unregisterer_) {
-      unregisterer_(this);
-    }
-  }
+  ~ScanTracker();
 
   // Records that a scan references 'bytes' bytes of the stream given
   // by 'id'. This is called when preparing to read a stripe.
@@ -123,10 +177,18 @@ class ScanTracker {
   // given by 'id'.
   void recordRead(const TrackingId id, uint64_t bytes, uint64_t groupId);
 
-  // True if 'trackingId' is read at least  'minReadPct' % of the time.
-  bool shouldPrefetch(TrackingId id, int32_t minReadPct) {
+  // True if 'trackingId' is read at least  'minReadPct' % of the time
+  // in this scan and the past scans of 'groupId'.
+  bool shouldPrefetch(TrackingId id, int32_t minReadPct, uint64_t groupId) {
     std::lock_guard<std::mutex> l(mutex_);
-    const auto& data = data_[id];
+    TrackingData data = data_[id];
+    auto group = groups_.find(groupId);
+    if (group != groups_.end()) {
+      auto history = group->second.history.find(id);
+      if (history != group->second.history.end()) {
+        data.add(history->second);
+      }
+    }
     if (!data.numReferences) {
       // Always prefetch first time data is mentioned.
       return true;
@@ -141,11 +203,25 @@ class ScanTracker {
   std::string toString() const;
 
  private:
+  struct Group {
+    // Name of the group in fileIds(). Empty if the id has no name, in
+    // which case the group has no history.
+    std::string name;
+    // Counts of this scan.
+    GroupTrackingData data;
+    // Counts of past scans from scanHistory() when the group was first
+    // referenced.
+    GroupTrackingData history;
+  };
+
+  Group& groupLocked(uint64_t groupId);
+
   std::mutex mutex_;
   // Id of query + scan operator to track.
   const std::string id_;
   std::function<void(ScanTracker*)> unregisterer_;
   folly::F14FastMap<TrackingId, TrackingData> data_;
+  folly::F14FastMap<uint64_t, Group> groups_;
   TrackingData sum_;
 };
 
@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/caching/SsdCache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sstream>
+
+#include <folly/String.h>
+#include <folly/container/F14Set.h>
+#include <folly/hash/Checksum.h>
+#include <folly/portability/SysUio.h>
+#include <glog/logging.h>
+
+#include "velox/common/caching/FileIds.h"
+
+namespace facebook::velox::cache {
+
+using memory::MappedMemory;
+
+namespace {
+// Start of a checkpoint file. The low byte is the format version.
+constexpr uint64_t kCheckpointMagic = 0x5453504b43445301;
+
+template <typename T>
+void append(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Reads the fields written with append() from a checkpoint.
+class CheckpointReader {
+ public:
+  explicit CheckpointReader(std::string_view data) : data_(data) {}
+
+  template <typename T>
+  T read() {
+    T value;
+    memcpy(&value, bytes(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string_view readString(int32_t size) {
+    return std::string_view(bytes(size), size);
+  }
+
+  bool atEnd() const {
+    return position_ == data_.size();
+  }
+
+ private:
+  const char* bytes(uint64_t size) {
+    VELOX_CHECK_LE(position_ + size, data_.size(), "Truncated checkpoint");
+    auto result = data_.data() + position_;
+    position_ += size;
+    return result;
+  }
+
+  const std::string_view data_;
+  uint64_t position_{0};
+};
+} // namespace
+
+SsdPin::~SsdPin() {
+  if (file_) {
+    file_->unpinRegion(run_.offset());
+  }
+}
+
+void SsdPin::operator=(SsdPin&& other) noexcept {
+  if (file_) {
+    file_->unpinRegion(run_.offset());
+  }
+  file_ = other.file_;
+  run_ = other.run_;
+  other.file_ = nullptr;
+}
+
+SsdFile::SsdFile(
+    const std::string& filename,
+    int32_t maxRegions,
+    bool persistent)
+    : filename_(filename),
+      maxRegions_(std::max<int32_t>(1, maxRegions)),
+      persistent_(persistent),
+      regionSize_(maxRegions_),
+      regionPins_(maxRegions_) {
+  fd_ = open(
+      filename_.c_str(),
+      O_CREAT | O_RDWR | (persistent_ ? 0 : O_TRUNC),
+      S_IRUSR | S_IWUSR);
+  VELOX_CHECK_GE(
+      fd_,
+      0,
+      "Cannot open SSD cache file {}: {}",
+      filename_,
+      folly::errnoStr(errno));
+  if (persistent_) {
+    readCheckpoint();
+  }
+}
+
+SsdFile::~SsdFile() {
+  if (persistent_) {
+    try {
+      checkpoint();
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "Failed to checkpoint SSD cache file " << filename_
+                   << ": " << e.what();
+    }
+    close(fd_);
+    return;
+  }
+  close(fd_);
+  if (unlink(filename_.c_str()) != 0) {
+    LOG(WARNING) << "Failed to remove SSD cache file " << filename_;
+  }
+}
+
+void SsdFile::checkpoint() {
+  if (!persistent_) {
+    return;
+  }
+  std::lock_guard<std::mutex> w(writeMutex_);
+  checkpointLocked();
+}
+
+void SsdFile::checkpointLocked() {
+  // The checkpoint may only reference data that is on the device.
+  VELOX_CHECK_EQ(
+      0,
+      fdatasync(fd_),
+      "Cannot sync {}: {}",
+      filename_,
+      folly::errnoStr(errno));
+  std::string data;
+  append(data, kCheckpointMagic);
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    append(data, numRegions_);
+    append(data, writeRegion_);
+    for (auto i = 0; i < numRegions_; ++i) {
+      append(data, regionSize_[i]);
+    }
+    append<uint64_t>(data, entries_.size());
+    // File names by file number. Many entries share a file.
+    folly::F14FastMap<uint64_t, std::string> names;
+    for (auto& [key, entry] : entries_) {
+      auto it = names.find(key.fileNum);
+      if (it == names.end()) {
+        it = names.emplace(key.fileNum, fileIds().string(key.fileNum)).first;
+      }
+      append<int32_t>(data, it->second.size());
+      data.append(it->second);
+      append(data, key.offset);
+      append(data, entry.run.offset());
+      append(data, entry.run.size());
+      append(data, entry.run.checksum());
+    }
+    checkpointBytesWritten_ = bytesWritten_;
+  }
+  append(data, folly::crc32c(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+
+  // Writes a new file and renames it over the old one, so that a
+  // crash leaves either checkpoint in place.
+  auto path = checkpointPath();
+  auto tempPath = path + ".tmp";
+  auto fd = open(
+      tempPath.c_str(), O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
+  VELOX_CHECK_GE(
+      fd,
+      0,
+      "Cannot open SSD cache checkpoint {}: {}",
+      tempPath,
+      folly::errnoStr(errno));
+  auto written = ::write(fd, data.data(), data.size());
+  auto synced = fsync(fd);
+  close(fd);
+  VELOX_CHECK(
+      written == static_cast<ssize_t>(data.size()) && synced == 0,
+      "Cannot write SSD cache checkpoint {}: {}",
+      tempPath,
+      folly::errnoStr(errno));
+  VELOX_CHECK_EQ(
+      0,
+      rename(tempPath.c_str(), path.c_str()),
+      "Cannot rename SSD cache checkpoint {}: {}",
+      tempPath,
+      folly::errnoStr(errno));
+}
+
+void SsdFile::readCheckpoint() {
+  auto path = checkpointPath();
+  auto fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    VELOX_CHECK_EQ(0, ftruncate(fd_, 0));
+    return;
+  }
+  struct stat checkpointStat;
+  struct stat fileStat;
+  std::string data;
+  if (fstat(fd, &checkpointStat) == 0 && fstat(fd_, &fileStat) == 0) {
+    data.resize(checkpointStat.st_size);
+    if (pread(fd, data.data(), data.size(), 0) !=
+        static_cast<ssize_t>(data.size())) {
+      data.clear();
+    }
+  }
+  close(fd);
+  try {
+    VELOX_CHECK_LE(sizeof(kCheckpointMagic) + sizeof(uint32_t), data.size());
+    auto bodySize = data.size() - sizeof(uint32_t);
+    uint32_t checksum;
+    memcpy(&checksum, data.data() + bodySize, sizeof(checksum));
+    VELOX_CHECK_EQ(
+        checksum,
+        folly::crc32c(reinterpret_cast<const uint8_t*>(data.data()), bodySize),
+        "Bad checkpoint checksum");
+    CheckpointReader reader(std::string_view(data.data(), bodySize));
+    VELOX_CHECK_EQ(kCheckpointMagic, reader.read<uint64_t>());
+    numRegions_ = reader.read<int32_t>();
+    writeRegion_ = reader.read<int32_t>();
+    VELOX_CHECK_LE(0, numRegions_);
+    VELOX_CHECK_LE(numRegions_, maxRegions_);
+    VELOX_CHECK_LT(writeRegion_, numRegions_);
+    VELOX_CHECK(writeRegion_ >= 0 || numRegions_ == 0);
+    for (auto i = 0; i < numRegions_; ++i) {
+      regionSize_[i] = reader.read<uint64_t>();
+      VELOX_CHECK_LE(regionSize_[i], kRegionSize);
+    }
+    auto numEntries = reader.read<uint64_t>();
+    for (uint64_t i = 0; i < numEntries; ++i) {
+      auto name = reader.readString(reader.read<int32_t>());
+      auto offset = reader.read<uint64_t>();
+      auto runOffset = reader.read<uint64_t>();
+      auto size = reader.read<uint32_t>();
+      auto runChecksum = reader.read<uint32_t>();
+      auto region = runOffset / kRegionSize;
+      VELOX_CHECK_LT(region, numRegions_);
+      VELOX_CHECK_LE(
+          runOffset % kRegionSize + size, regionSize_[region]);
+      VELOX_CHECK_LE(runOffset + size, fileStat.st_size);
+      FileCacheKey key{StringIdLease(fileIds(), name), offset};
+      RawFileCacheKey rawKey{key.fileNum.id(), offset};
+      entries_[rawKey] = Entry{
+          std::move(key), SsdRun(runOffset, size, runChecksum, true)};
+      bytesCached_ += size;
+    }
+    VELOX_CHECK(reader.atEnd());
+  } catch (const VeloxException& e) {
+    LOG(WARNING) << "Ignoring SSD cache checkpoint " << path << ": "
+                 << e.message();
+    entries_.clear();
+    numRegions_ = 0;
+    writeRegion_ = -1;
+    std::fill(regionSize_.begin(), regionSize_.end(), 0);
+    bytesCached_ = 0;
+    VELOX_CHECK_EQ(0, ftruncate(fd_, 0));
+  }
+}
+
+std::vector<uint64_t> SsdFile::fileNums() {
+  std::lock_guard<std::mutex> l(mutex_);
+  folly::F14FastSet<uint64_t> fileNums;
+  for (auto& [key, entry] : entries_) {
+    fileNums.insert(key.fileNum);
+  }
+  return std::vector<uint64_t>(fileNums.begin(), fileNums.end());
+}
+
+void SsdFile::addCachedBytes(const CachedFileRanges& ranges) {
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto& [key, entry] : entries_) {
+    auto it = ranges.find(key.fileNum);
+    if (it == ranges.end()) {
+      continue;
+    }
+    for (auto range : it->second) {
+      if (range->contains(key.offset)) {
+        range->ssdBytes += entry.run.size();
+      }
+    }
+  }
+}
+
+SsdPin SsdFile::find(RawFileCacheKey key) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return SsdPin();
+  }
+  ++regionPins_[it->second.run.offset() / kRegionSize];
+  return SsdPin(*this, it->second.run);
+}
+
+void SsdFile::unpinRegion(uint64_t offset) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& pins = regionPins_[offset / kRegionSize];
+  VELOX_CHECK_LT(0, pins, "SSD region pin count goes negative");
+  --pins;
+}
+
+bool SsdFile::nextWriteRegionLocked() {
+  if (numRegions_ < maxRegions_) {
+    writeRegion_ = numRegions_++;
+    regionSize_[writeRegion_] = 0;
+    return true;
+  }
+  // All regions are in use. Reuse the oldest unpinned one. If there
+  // is only one region, this is the current write region, which is
+  // not being written since writers are serialized.
+  for (auto i = 1; i <= maxRegions_; ++i) {
+    auto candidate = (writeRegion_ + i) % maxRegions_;
+    if (regionPins_[candidate] == 0) {
+      evictRegionLocked(candidate);
+      writeRegion_ = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SsdFile::evictRegionLocked(int32_t region) {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.run.offset() / kRegionSize == region) {
+      bytesCached_ -= it->second.run.size();
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  regionSize_[region] = 0;
+  ++numRegionsEvicted_;
+}
+
+bool SsdFile::writeItem(
+    const SsdWriteItem& item,
+    uint64_t offset,
+    uint32_t& checksum) {
+  checksum = 0;
+  if (item.data.numPages() == 0) {
+    if (persistent_) {
+      checksum = folly::crc32c(
+          reinterpret_cast<const uint8_t*>(item.tinyData.data()), item.size);
+    }
+    return pwrite(fd_, item.tinyData.data(), item.size, offset) ==
+        static_cast<ssize_t>(item.size);
+  }
+  uint64_t written = 0;
+  for (int32_t i = 0; i < item.data.numRuns() && written < item.size; ++i) {
+    MappedMemory::PageRun run = item.data.runAt(i);
+    uint64_t bytes = std::min<uint64_t>(run.numBytes(), item.size - written);
+    if (persistent_) {
+      checksum = folly::crc32c(run.data(), bytes, checksum);
+    }
+    if (pwrite(fd_, run.data(), bytes, offset + written) !=
+        static_cast<ssize_t>(bytes)) {
+      return false;
+    }
+    written += bytes;
+  }
+  return written == item.size;
+}
+
+void SsdFile::write(std::vector<SsdWriteItem>& items) {
+  std::lock_guard<std::mutex> w(writeMutex_);
+  for (auto& item : items) {
+    RawFileCacheKey key{item.key.fileNum.id(), item.key.offset};
+    uint64_t offset;
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      if (item.size > kRegionSize) {
+        ++numWritesDropped_;
+        continue;
+      }
+      if (entries_.count(key)) {
+        continue;
+      }
+      if (writeRegion_ < 0 ||
+          regionSize_[writeRegion_] + item.size > kRegionSize) {
+        if (!nextWriteRegionLocked()) {
+          ++numWritesDropped_;
+          continue;
+        }
+      }
+      offset = writeRegion_ * kRegionSize + regionSize_[writeRegion_];
+      regionSize_[writeRegion_] += item.size;
+    }
+    // The write region is not evicted until the next call to
+    // nextWriteRegionLocked(), which only happens under 'writeMutex_'.
+    uint32_t checksum;
+    if (!writeItem(item, offset, checksum)) {
+      LOG(WARNING) << "Failed to write " << item.size << " bytes to "
+                   << filename_ << ": " << folly::errnoStr(errno);
+      std::lock_guard<std::mutex> l(mutex_);
+      ++numWritesDropped_;
+      continue;
+    }
+    std::lock_guard<std::mutex> l(mutex_);
+    entries_[key] =
+        Entry{item.key, SsdRun(offset, item.size, checksum, false)};
+    bytesCached_ += item.size;
+    ++numWritten_;
+    bytesWritten_ += item.size;
+  }
+  if (persistent_) {
+    bool due;
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      due = bytesWritten_ - checkpointBytesWritten_ >= kCheckpointBytes;
+    }
+    if (due) {
+      try {
+        checkpointLocked();
+      } catch (const std::exception& e) {
+        LOG(WARNING) << "Failed to checkpoint SSD cache file " << filename_
+                     << ": " << e.what();
+      }
+    }
+  }
+}
+
+bool SsdFile::load(const SsdRun& run, AsyncDataCacheEntry& entry) {
+  VELOX_CHECK_LE(entry.size(), run.size());
+  auto size = entry.size();
+  // The checksum covers the whole run.
+  if (run.verify() && size != run.size()) {
+    return false;
+  }
+  if (entry.data().numPages() == 0) {
+    VELOX_CHECK_EQ(
+        static_cast<ssize_t>(size),
+        pread(fd_, entry.tinyData(), size, run.offset()),
+        "Error reading {}: {}",
+        filename_,
+        folly::errnoStr(errno));
+  } else {
+    // Reads all the page runs of the entry with one system call.
+    uint64_t offsetInRuns = 0;
+    auto& data = entry.data();
+    std::vector<struct iovec> iovecs;
+    iovecs.reserve(data.numRuns());
+    for (int32_t i = 0; i < data.numRuns() && offsetInRuns < size; ++i) {
+      MappedMemory::PageRun pageRun = data.runAt(i);
+      uint64_t bytes =
+          std::min<uint64_t>(pageRun.numBytes(), size - offsetInRuns);
+      iovecs.push_back({pageRun.data(), bytes});
+      offsetInRuns += bytes;
+    }
+    VELOX_CHECK_EQ(
+        static_cast<ssize_t>(size),
+        folly::preadv(fd_, iovecs.data(), iovecs.size(), run.offset()),
+        "Error reading {}: {}",
+        filename_,
+        folly::errnoStr(errno));
+  }
+  if (run.verify()) {
+    uint32_t checksum;
+    if (entry.data().numPages() == 0) {
+      checksum = folly::crc32c(
+          reinterpret_cast<const uint8_t*>(entry.tinyData()), size);
+    } else {
+      checksum = 0;
+      uint64_t offsetInRuns = 0;
+      auto& data = entry.data();
+      for (int32_t i = 0; i < data.numRuns() && offsetInRuns < size; ++i) {
+        MappedMemory::PageRun pageRun = data.runAt(i);
+        uint64_t bytes =
+            std::min<uint64_t>(pageRun.numBytes(), size - offsetInRuns);
+        checksum = folly::crc32c(pageRun.data(), bytes, checksum);
+        offsetInRuns += bytes;
+      }
+    }
+    if (checksum != run.checksum()) {
+      LOG(WARNING) << "Checksum mismatch at offset " << run.offset()
+                   << " of SSD cache file " << filename_;
+      std::lock_guard<std::mutex> l(mutex_);
+      ++numChecksumErrors_;
+      // Errors are rare. The entries are not indexed by offset.
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->second.run.offset() == run.offset()) {
+          bytesCached_ -= it->second.run.size();
+          entries_.erase(it);
+          break;
+        }
+      }
+      return false;
+    }
+  }
+  ++numRead_;
+  bytesRead_ += size;
+  return true;
+}
+
+void SsdFile::updateStats(SsdCacheStats& stats) {
+  std::lock_guard<std::mutex> l(mutex_);
+  stats.entriesCached += entries_.size();
+  stats.bytesCached += bytesCached_;
+  stats.entriesWritten += numWritten_;
+  stats.bytesWritten += bytesWritten_;
+  stats.entriesRead += numRead_;
+  stats.bytesRead += bytesRead_;
+  stats.regionsEvicted += numRegionsEvicted_;
+  stats.writesDropped += numWritesDropped_;
+  stats.checksumErrors += numChecksumErrors_;
+}
+
+SsdCache::SsdCache(
+    std::string_view filePrefix,
+    uint64_t maxBytes,
+    int32_t numShards,
+    folly::Executor* executor,
+    bool persistent)
+    : executor_(executor), maxBytes_(maxBytes) {
+  VELOX_CHECK_LT(0, numShards);
+  int32_t regionsPerFile = maxBytes / numShards / SsdFile::kRegionSize;
+  for (auto i = 0; i < numShards; ++i) {
+    files_.push_back(std::make_unique<SsdFile>(
+        fmt::format("{}{}", filePrefix, i), regionsPerFile, persistent));
+    if (persistent) {
+      for (auto fileNum : files_.back()->fileNums()) {
+        if (fileNum % numShards != i) {
+          // A file number is in one checkpoint unless a crash left an
+          // older checkpoint behind. The first shard is kept.
+          restoredShards_.emplace(fileNum, i);
+        }
+      }
+    }
+  }
+}
+
+SsdCache::~SsdCache() {
+  std::unique_lock<std::mutex> l(writeMutex_);
+  writesDone_.wait(l, [&]() { return numPendingWrites_ == 0; });
+}
+
+void SsdCache::checkpoint() {
+  for (auto& file : files_) {
+    file->checkpoint();
+  }
+}
+
+bool SsdCache::startWrite(uint64_t bytes) {
+  if (pendingBytes_.fetch_add(bytes) + bytes > kMaxPendingBytes) {
+    pendingBytes_ -= bytes;
+    return false;
+  }
+  return true;
+}
+
+void SsdCache::write(std::vector<SsdWriteItem> items) {
+  {
+    std::lock_guard<std::mutex> l(writeMutex_);
+    ++numPendingWrites_;
+  }
+  if (executor_) {
+    executor_->add([this, items = std::move(items)]() mutable {
+      writeItems(items);
+    });
+  } else {
+    writeItems(items);
+  }
+}
+
+void SsdCache::writeItems(std::vector<SsdWriteItem>& items) {
+  uint64_t bytes = 0;
+  for (auto& item : items) {
+    bytes += item.size;
+  }
+  try {
+    if (files_.size() == 1) {
+      files_[0]->write(items);
+    } else {
+      std::vector<std::vector<SsdWriteItem>> shardItems(files_.size());
+      for (auto& item : items) {
+        shardItems[shardIndex(item.key.fileNum.id())].push_back(
+            std::move(item));
+      }
+      for (auto i = 0; i < files_.size(); ++i) {
+        if (!shardItems[i].empty()) {
+          files_[i]->write(shardItems[i]);
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Error writing to SSD cache: " << e.what();
+  }
+  // Frees the memory of the written entries.
+  items.clear();
+  pendingBytes_ -= bytes;
+  std::lock_guard<std::mutex> l(writeMutex_);
+  if (--numPendingWrites_ == 0) {
+    writesDone_.notify_all();
+  }
+}
+
+SsdCacheStats SsdCache::stats() const {
+  SsdCacheStats stats;
+  for (auto& file : files_) {
+    file->updateStats(stats);
+  }
+  return stats;
+}
+
+void SsdCache::addCachedBytes(const CachedFileRanges& ranges) {
+  for (auto& file : files_) {
+    file->addCachedBytes(ranges);
+  }
+}
+
+std::string SsdCache::toString() const {
+  auto data = stats();
+  std::stringstream out;
+  out << "SsdCache: " << data.bytesCached << " / " << maxBytes_ << " bytes "
+      << data.entriesCached << " entries\n"
+      << "Written: " << data.entriesWritten << " entries "
+      << data.bytesWritten << " bytes, read " << data.entriesRead
+      << " entries " << data.bytesRead << " bytes, regions evicted "
+      << data.regionsEvicted << " dropped " << data.writesDropped
+      << " checksum errors " << data.checksumErrors;
+  return out.str();
+}
+
+} // namespace facebook::velox::cache
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+
+#include <folly/Executor.h>
+#include <folly/container/F14Map.h>
+#include "velox/common/caching/AsyncDataCache.h"
+
+namespace facebook::velox::cache {
+
+class SsdFile;
+
+// Location of a cached range in an SsdFile.
+class SsdRun {
+ public:
+  SsdRun() : offset_(0), size_(0) {}
+
+  SsdRun(uint64_t offset, uint32_t size) : offset_(offset), size_(size) {}
+
+  SsdRun(uint64_t offset, uint32_t size, uint32_t checksum, bool verify)
+      : offset_(offset), size_(size), checksum_(checksum), verify_(verify) {}
+
+  uint64_t offset() const {
+    return offset_;
+  }
+
+  uint32_t size() const {
+    return size_;
+  }
+
+  // CRC32C of the 'size_' bytes at 'offset_'.
+  uint32_t checksum() const {
+    return checksum_;
+  }
+
+  // True if the data must be checked against checksum() when read.
+  // Set for runs restored from a checkpoint, which may have been
+  // overwritten after the checkpoint was taken.
+  bool verify() const {
+    return verify_;
+  }
+
+ private:
+  uint64_t offset_;
+  uint32_t size_;
+  uint32_t checksum_{0};
+  bool verify_{false};
+};
+
+// Data of an entry evicted from AsyncDataCache on its way to
+// SsdCache. Takes ownership of the memory of the evicted entry. The
+// memory goes back to the cache after the write.
+struct SsdWriteItem {
+  FileCacheKey key;
+  int32_t size;
+  memory::MappedMemory::Allocation data;
+  // Set instead of 'data' for entries under
+  // AsyncDataCacheEntry::kTinyDataSize.
+  std::string tinyData;
+};
+
+// Reference to a range in an SsdFile. The region of the range is not
+// evicted while pinned.
+class SsdPin {
+ public:
+  SsdPin() = default;
+
+  // Constructed by SsdFile inside its mutex after incrementing the pin
+  // count of the region of 'run'.
+  SsdPin(SsdFile& file, SsdRun run) : file_(&file), run_(run) {}
+
+  SsdPin(const SsdPin& other) = delete;
+
+  SsdPin(SsdPin&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  ~SsdPin();
+
+  void operator=(const SsdPin& other) = delete;
+
+  void operator=(SsdPin&& other) noexcept;
+
+  bool empty() const {
+    return file_ == nullptr;
+  }
+
+  SsdFile* FOLLY_NULLABLE file() const {
+    return file_;
+  }
+
+  const SsdRun& run() const {
+    return run_;
+  }
+
+ private:
+  SsdFile* FOLLY_NULLABLE file_{nullptr};
+  SsdRun run_;
+};
+
+// Struct for SsdCache stats. Stats from all files are added into
+// this struct to provide a snapshot of state.
+struct SsdCacheStats {
+  // Number of entries and bytes currently on SSD.
+  int64_t entriesCached{};
+  int64_t bytesCached{};
+  // Cumulative count of entries and bytes written to SSD.
+  int64_t entriesWritten{};
+  int64_t bytesWritten{};
+  // Cumulative count of entries and bytes read back from SSD.
+  int64_t entriesRead{};
+  int64_t bytesRead{};
+  // Number of regions evicted to make space for new writes.
+  int64_t regionsEvicted{};
+  // Number of entries not written because of size, write errors or
+  // all regions being pinned.
+  int64_t writesDropped{};
+  // Number of entries restored from a checkpoint whose data did not
+  // match the checksum when read.
+  int64_t checksumErrors{};
+};
+
+// A local file caching ranges of remote files. The file is divided
+// into regions of kRegionSize bytes. New data is appended to the
+// current write region. When no region has space, the next unpinned
+// region in circular order is cleared and reused. The file is created
+// empty and removed when 'this' is destroyed, unless it is
+// persistent. A persistent file keeps its contents and periodically
+// checkpoints its index to '<filename>.cpt'. A new SsdFile on the same
+// file restores the index from the checkpoint, so that a restarted
+// process starts with a warm cache.
+class SsdFile {
+ public:
+  static constexpr uint64_t kRegionSize = 64 << 20; // 64MB
+
+  // A persistent file checkpoints after this many bytes of new writes.
+  static constexpr uint64_t kCheckpointBytes = kRegionSize;
+
+  SsdFile(
+      const std::string& filename,
+      int32_t maxRegions,
+      bool persistent = false);
+
+  ~SsdFile();
+
+  // Returns a pin on the cached range for 'key' or an empty pin if
+  // 'key' is not cached.
+  SsdPin find(RawFileCacheKey key);
+
+  // Writes the items whose keys are not already cached. Concurrent
+  // calls are serialized.
+  void write(std::vector<SsdWriteItem>& items);
+
+  // Reads the first entry.size() bytes of 'run' into the memory of
+  // 'entry'. 'entry' must be pinned exclusive or be loading. Returns
+  // false if 'run' is restored from a checkpoint and its data cannot be
+  // verified or does not match its checksum. The entry of 'run' is
+  // then removed and the caller reads the data from its source.
+  bool load(const SsdRun& run, AsyncDataCacheEntry& entry);
+
+  // Writes the index of a persistent file to its checkpoint file. The
+  // data of the indexed entries is synced first. Concurrent writes wait
+  // for the checkpoint. A no-op if 'this' is not persistent.
+  void checkpoint();
+
+  // Returns the file numbers that have entries in 'this'.
+  std::vector<uint64_t> fileNums();
+
+  // Adds the stats of 'this' to 'stats'.
+  void updateStats(SsdCacheStats& stats);
+
+  // Adds the sizes of the entries to the ssdBytes of the 'ranges' they
+  // start in.
+  void addCachedBytes(const CachedFileRanges& ranges);
+
+  const std::string& filename() const {
+    return filename_;
+  }
+
+ private:
+  struct Entry {
+    // Holds an owning reference to the file number.
+    FileCacheKey key;
+    SsdRun run;
+  };
+
+  std::string checkpointPath() const {
+    return filename_ + ".cpt";
+  }
+
+  void checkpointLocked();
+
+  // Restores the index from the checkpoint file if there is a valid
+  // one. Otherwise the file is truncated and 'this' starts empty.
+  void readCheckpoint();
+
+  void unpinRegion(uint64_t offset);
+
+  // Sets 'writeRegion_' to an empty region. Returns false if all
+  // regions are pinned.
+  bool nextWriteRegionLocked();
+
+  // Removes the entries of 'region' from 'entries_'.
+  void evictRegionLocked(int32_t region);
+
+  // Writes the data of 'item' at 'offset'. Sets 'checksum' to the
+  // CRC32C of the data if 'this' is persistent. Returns false on error.
+  bool
+  writeItem(const SsdWriteItem& item, uint64_t offset, uint32_t& checksum);
+
+  const std::string filename_;
+  const int32_t maxRegions_;
+  const bool persistent_;
+  int32_t fd_;
+
+  // Serializes access to all members except 'fd_'.
+  std::mutex mutex_;
+
+  // Serializes writers. Held during the writes of a batch, outside of
+  // 'mutex_'.
+  std::mutex writeMutex_;
+
+  folly::F14FastMap<RawFileCacheKey, Entry> entries_;
+
+  // Number of regions that have been written to. Grows up to
+  // 'maxRegions_'.
+  int32_t numRegions_{0};
+
+  // Number of bytes written to each region.
+  std::vector<uint64_t> regionSize_;
+
+  // Count of SsdPins on each region.
+  std::vector<int32_t> regionPins_;
+
+  // Region receiving new writes. -1 before the first write.
+  int32_t writeRegion_{-1};
+
+  uint64_t bytesCached_{0};
+  uint64_t numWritten_{0};
+  uint64_t bytesWritten_{0};
+  std::atomic<uint64_t> numRead_{0};
+  std::atomic<uint64_t> bytesRead_{0};
+  uint64_t numRegionsEvicted_{0};
+  uint64_t numWritesDropped_{0};
+  uint64_t numChecksumErrors_{0};
+
+  // Value of 'bytesWritten_' at the last checkpoint.
+  uint64_t checkpointBytesWritten_{0};
+
+  friend class SsdPin;
+};
+
+// Second level cache under AsyncDataCache. Entries evicted from
+// memory are written to local SSD files and read back on a memory
+// miss before going to remote storage. The key space is divided
+// between 'numShards' SsdFiles by file number. File numbers are
+// assigned per process, so a file restored from a checkpoint may
+// hold file numbers of other shards. These stay with the shard that
+// has their data.
+class SsdCache {
+ public:
+  // Bytes of evicted entries that can be waiting for their write to
+  // SSD. Evictions beyond this are dropped.
+  static constexpr uint64_t kMaxPendingBytes = 128 << 20; // 128MB
+
+  // Creates 'numShards' files with names starting with 'filePrefix',
+  // together holding up to 'maxBytes'. Writes are done on 'executor'
+  // if given, otherwise on the evicting thread. If 'persistent', the
+  // files are kept and their contents restored from checkpoints left by
+  // a previous SsdCache with the same 'filePrefix' and 'numShards'.
+  SsdCache(
+      std::string_view filePrefix,
+      uint64_t maxBytes,
+      int32_t numShards = 4,
+      folly::Executor* FOLLY_NULLABLE executor = nullptr,
+      bool persistent = false);
+
+  // Waits for pending writes. Persistent files write a final
+  // checkpoint.
+  ~SsdCache();
+
+  // Returns the shard corresponding to 'fileNum'.
+  SsdFile& file(uint64_t fileNum) {
+    return *files_[shardIndex(fileNum)];
+  }
+
+  // Checkpoints all files. See SsdFile::checkpoint().
+  void checkpoint();
+
+  // Reserves space for 'bytes' of evicted data to be written. Returns
+  // false if too much data is waiting to be written. Each successful
+  // call is followed by write() of the item.
+  bool startWrite(uint64_t bytes);
+
+  // Writes 'items' to their shards and releases their reservation
+  // from startWrite().
+  void write(std::vector<SsdWriteItem> items);
+
+  SsdCacheStats stats() const;
+
+  // See SsdFile::addCachedBytes().
+  void addCachedBytes(const CachedFileRanges& ranges);
+
+  std::string toString() const;
+
+ private:
+  void writeItems(std::vector<SsdWriteItem>& items);
+
+  int32_t shardIndex(uint64_t fileNum) const {
+    if (!restoredShards_.empty()) {
+      auto it = restoredShards_.find(fileNum);
+      if (it != restoredShards_.end()) {
+        return it->second;
+      }
+    }
+    return fileNum % files_.size();
+  }
+
+  std::vector<std::unique_ptr<SsdFile>> files_;
+
+  // Shard of file numbers restored from a checkpoint to a shard other
+  // than the default one. Set in the constructor and read-only after
+  // that. File numbers are not reused, so an entry stays valid after
+  // the entries of its file are evicted.
+  folly::F14FastMap<uint64_t, int32_t> restoredShards_;
+  folly::Executor* FOLLY_NULLABLE const executor_;
+  const uint64_t maxBytes_;
+
+  // Bytes reserved by startWrite() and not yet written.
+  std::atomic<uint64_t> pendingBytes_{0};
+
+  // Number of write() calls in progress. The destructor waits for
+  // this to go to zero.
+  std::mutex writeMutex_;
+  std::condition_variable writesDone_;
+  int32_t numPendingWrites_{0};
+};
+
+} // namespace facebook::velox::cache
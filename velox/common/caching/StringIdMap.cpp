@@ -27,6 +27,15 @@ uint64_t StringIdMap::id(std::string_view string) {
   return kNoId;
 }
 
+std::string StringIdMap::string(uint64_t id) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = idToString_.find(id);
+  if (it != idToString_.end()) {
+    return it->second.string;
+  }
+  return "";
+}
+
 void StringIdMap::release(uint64_t id) {
   std::lock_guard<std::mutex> l(mutex_);
   auto it = idToString_.find(id);
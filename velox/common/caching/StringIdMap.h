@@ -38,6 +38,9 @@ class StringIdMap {
   // Returns the id of 'string' or kNoId if the string is not known.
   uint64_t id(std::string_view string);
 
+  // Returns the string for 'id' or an empty string if 'id' is not known.
+  std::string string(uint64_t id);
+
   // Returns the total length of strings involved in currently referenced
   // mappings.
   int64_t pinnedSize() const {
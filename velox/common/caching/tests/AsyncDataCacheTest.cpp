@@ -16,6 +16,10 @@
 
 #include "velox/common/caching/AsyncDataCache.h"
 #include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/SsdCache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <folly/executors/QueuedImmediateExecutor.h>
 #include <glog/logging.h>
@@ -29,15 +33,30 @@ using facebook::velox::memory::MappedMemory;
 class AsyncDataCacheTest : public testing::Test {
  protected:
   static constexpr int32_t kNumFiles = 100;
-  void initializeCache(int64_t maxBytes) {
+  void initializeCache(
+      int64_t maxBytes,
+      int64_t ssdBytes = 0,
+      bool persistentSsd = false) {
+    std::unique_ptr<SsdCache> ssdCache;
+    if (ssdBytes) {
+      ssdCache = std::make_unique<SsdCache>(
+          ssdPrefix(), ssdBytes, 1, nullptr, persistentSsd);
+    }
     cache_ = std::make_shared<AsyncDataCache>(
-        MappedMemory::createDefaultInstance(), maxBytes);
+        MappedMemory::createDefaultInstance(), maxBytes, std::move(ssdCache));
+    if (!filenames_.empty()) {
+      return;
+    }
     for (auto i = 0; i < kNumFiles; ++i) {
       auto name = fmt::format("testing_file_{}", i);
       filenames_.push_back(StringIdLease(fileIds(), name));
     }
   }
 
+  static std::string ssdPrefix() {
+    return fmt::format("/tmp/async_data_cache_test_{}_", getpid());
+  }
+
   // Loads a sequence of entries from a number of files. Looks up a
   // number of entries, then loads the ones that nobody else is
   // loading.
@@ -266,3 +285,260 @@ TEST_F(AsyncDataCacheTest, outOfCapacity) {
   EXPECT_EQ(0, cache_->incrementPrefetchPages(0));
   EXPECT_EQ(4092, cache_->numAllocated());
 }
+
+TEST_F(AsyncDataCacheTest, scanResistance) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  constexpr int32_t kSize = 1 << 20;
+  constexpr int32_t kNumHot = 4;
+  initializeCache(kMaxBytes);
+  // Reads the entry at 'offset', loading it if it is not in cache.
+  // Returns true if the entry was in cache.
+  auto read = [&](uint64_t offset) {
+    RawFileCacheKey key{filenames_[0].id(), offset};
+    auto pin = cache_->findOrCreate(key, kSize);
+    EXPECT_FALSE(pin.empty());
+    if (!pin.entry()->isExclusive()) {
+      return true;
+    }
+    initializeContents(offset, pin.entry()->data());
+    pin.entry()->setValid();
+    return false;
+  };
+  // The hot entries are used a few times.
+  for (auto i = 0; i < 3; ++i) {
+    for (auto hot = 0; hot < kNumHot; ++hot) {
+      read(hot * kSize);
+    }
+  }
+  // A scan reads 6x the capacity once.
+  for (auto i = 0; i < 100; ++i) {
+    read((kNumHot + i) * kSize);
+  }
+  EXPECT_LT(0, cache_->refreshStats().numEvict);
+  for (auto hot = 0; hot < kNumHot; ++hot) {
+    EXPECT_TRUE(read(hot * kSize));
+  }
+}
+
+TEST_F(AsyncDataCacheTest, stats) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  constexpr int32_t kSize = 1 << 20;
+  constexpr int32_t kNumEntries = 40;
+  initializeCache(kMaxBytes);
+  for (auto i = 0; i < kNumEntries; ++i) {
+    auto pin = newEntry(i * kSize, kSize);
+    ASSERT_FALSE(pin.empty());
+    initializeContents(i, pin.entry()->data());
+    pin.entry()->setValid();
+  }
+  // Hits the last prefetched entries, which are still in memory.
+  for (auto i = kNumEntries - 4; i < kNumEntries; ++i) {
+    RawFileCacheKey key{filenames_[0].id(), static_cast<uint64_t>(i * kSize)};
+    auto pin = cache_->findOrCreate(key, kSize);
+    ASSERT_FALSE(pin.empty());
+    EXPECT_TRUE(pin.entry()->isShared());
+  }
+  auto stats = cache_->refreshStats();
+  EXPECT_EQ(kNumEntries, stats.numNew);
+  EXPECT_EQ(4, stats.numPrefetchHit);
+  EXPECT_LT(0, stats.numPrefetchEvict);
+  EXPECT_LT(stats.prefetchHitRatio(), 1);
+
+  CacheStats sum;
+  for (auto& shardStats : cache_->shardStats()) {
+    sum.add(shardStats);
+  }
+  EXPECT_EQ(stats.numNew, sum.numNew);
+  EXPECT_EQ(stats.numEvict, sum.numEvict);
+  EXPECT_EQ(stats.numPrefetchHit, sum.numPrefetchHit);
+  int64_t numAged = 0;
+  for (auto count : stats.evictAgeHistogram) {
+    numAged += count;
+  }
+  EXPECT_LT(0, numAged);
+  EXPECT_LE(numAged, stats.numEvict);
+
+  auto delta = stats - sum;
+  EXPECT_EQ(0, delta.numNew);
+  EXPECT_EQ(stats.largeSize, delta.largeSize);
+}
+
+TEST_F(AsyncDataCacheTest, highPriority) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  constexpr int32_t kSize = 1 << 20;
+  constexpr int32_t kNumHigh = 4;
+  initializeCache(kMaxBytes);
+  cache_->setHighPriorityReserve(0.5);
+  auto highKey = [&](int32_t i) {
+    return RawFileCacheKey{
+        filenames_[1].id(), static_cast<uint64_t>(i) * kSize};
+  };
+  for (auto i = 0; i < kNumHigh; ++i) {
+    auto pin =
+        cache_->findOrCreate(highKey(i), kSize, nullptr, CachePriority::kHigh);
+    ASSERT_FALSE(pin.empty());
+    initializeContents(i, pin.entry()->data());
+    pin.entry()->setValid();
+  }
+  EXPECT_EQ(kNumHigh * kSize, cache_->highPriorityBytes());
+
+  // A scan of 5x the capacity does not evict the high priority entries.
+  for (auto i = 0; i < 80; ++i) {
+    auto pin = newEntry(i * kSize, kSize);
+    ASSERT_FALSE(pin.empty());
+    initializeContents(i, pin.entry()->data());
+    pin.entry()->setValid();
+  }
+  for (auto i = 0; i < kNumHigh; ++i) {
+    auto pin =
+        cache_->findOrCreate(highKey(i), kSize, nullptr, CachePriority::kHigh);
+    ASSERT_FALSE(pin.empty());
+    EXPECT_TRUE(pin.entry()->isShared());
+  }
+  auto stats = cache_->refreshStats();
+  EXPECT_EQ(kNumHigh, stats.numHighPriorityNew);
+  EXPECT_EQ(kNumHigh, stats.numHighPriorityHit);
+  EXPECT_EQ(kNumHigh * kSize, stats.highPriorityBytes);
+
+  // Entries found with normal priority keep their high priority.
+  auto pin = cache_->findOrCreate(highKey(0), kSize);
+  EXPECT_EQ(CachePriority::kHigh, pin.entry()->priority());
+}
+
+TEST_F(AsyncDataCacheTest, ssd) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  constexpr int32_t kSize = 1 << 20;
+  constexpr int32_t kNumEntries = 100;
+  initializeCache(kMaxBytes, SsdFile::kRegionSize);
+  // Fills the cache with 100MB of entries. The evicted ones go to SSD,
+  // which holds one region.
+  for (auto i = 0; i < kNumEntries; ++i) {
+    auto pin = newEntry(i * kSize, kSize);
+    ASSERT_FALSE(pin.empty());
+    initializeContents(i, pin.entry()->data());
+    pin.entry()->setValid();
+  }
+  auto ssdCache = cache_->ssdCache();
+  auto stats = ssdCache->stats();
+  EXPECT_LT(0, stats.entriesWritten);
+  EXPECT_LT(0, stats.entriesCached);
+  EXPECT_EQ(1, stats.regionsEvicted);
+
+  // Reads back the entries that are no longer in memory and checks
+  // the ones found on SSD.
+  int32_t numSsdHits = 0;
+  for (auto i = 0; i < kNumEntries; ++i) {
+    RawFileCacheKey key{filenames_[0].id(), static_cast<uint64_t>(i * kSize)};
+    auto ssdPin = ssdCache->file(key.fileNum).find(key);
+    if (ssdPin.empty()) {
+      continue;
+    }
+    auto pin = cache_->findOrCreate(key, kSize);
+    ASSERT_FALSE(pin.empty());
+    if (!pin.entry()->isExclusive()) {
+      continue;
+    }
+    ssdPin.file()->load(ssdPin.run(), *pin.entry());
+    // The first word of the contents is the sequence number. The rest
+    // are addresses that differ after reloading.
+    auto run = pin.entry()->data().runAt(0);
+    EXPECT_EQ(i, *reinterpret_cast<int64_t*>(run.data()));
+    pin.entry()->setValid();
+    ++numSsdHits;
+  }
+  EXPECT_LT(0, numSsdHits);
+  EXPECT_EQ(numSsdHits, ssdCache->stats().entriesRead);
+}
+
+TEST_F(AsyncDataCacheTest, cachedBytes) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  constexpr int32_t kSize = 1 << 20;
+  constexpr int32_t kNumEntries = 40;
+  initializeCache(kMaxBytes, SsdFile::kRegionSize);
+  for (auto i = 0; i < kNumEntries; ++i) {
+    auto pin = newEntry(i * kSize, kSize);
+    ASSERT_FALSE(pin.empty());
+    initializeContents(i, pin.entry()->data());
+    pin.entry()->setValid();
+  }
+  // A range starting inside one entry counts the entries that start
+  // after it. A file without entries has nothing cached.
+  std::vector<CachedFileRange> ranges = {
+      {filenames_[0].id(), 0, kNumEntries * kSize},
+      {filenames_[0].id(), 10 * kSize + 1, 10 * kSize},
+      {filenames_[0].id(), kNumEntries * kSize, kSize},
+      {filenames_[1].id(), 0, kNumEntries * kSize}};
+  cache_->cachedBytes(ranges);
+  auto stats = cache_->refreshStats();
+  auto ssdStats = cache_->ssdCache()->stats();
+  EXPECT_EQ(stats.largeSize, ranges[0].memoryBytes);
+  EXPECT_EQ(ssdStats.bytesCached, ranges[0].ssdBytes);
+  EXPECT_LT(0, ranges[0].memoryBytes);
+  EXPECT_LT(0, ranges[0].ssdBytes);
+  EXPECT_LE(ranges[1].memoryBytes + ranges[1].ssdBytes, 9 * kSize);
+  EXPECT_EQ(0, ranges[2].memoryBytes + ranges[2].ssdBytes);
+  EXPECT_EQ(0, ranges[3].memoryBytes + ranges[3].ssdBytes);
+}
+
+TEST_F(AsyncDataCacheTest, ssdCheckpoint) {
+  constexpr int64_t kMaxBytes = 16 << 20;
+  constexpr int32_t kSize = 1 << 20;
+  constexpr int32_t kNumEntries = 40;
+  auto ssdFile = ssdPrefix() + "0";
+  initializeCache(kMaxBytes, 2 * SsdFile::kRegionSize, true);
+  for (auto i = 0; i < kNumEntries; ++i) {
+    auto pin = newEntry(i * kSize, kSize);
+    ASSERT_FALSE(pin.empty());
+    initializeContents(i, pin.entry()->data());
+    pin.entry()->setValid();
+  }
+  EXPECT_LT(0, cache_->ssdCache()->stats().entriesCached);
+
+  // A new cache on the same file restores the entries from the
+  // checkpoint written when the old one is destroyed.
+  cache_.reset();
+  initializeCache(kMaxBytes, 2 * SsdFile::kRegionSize, true);
+  auto ssdCache = cache_->ssdCache();
+  auto numCached = ssdCache->stats().entriesCached;
+  EXPECT_LT(0, numCached);
+
+  // Corrupts the first entry on SSD.
+  RawFileCacheKey firstKey{filenames_[0].id(), 0};
+  {
+    auto ssdPin = ssdCache->file(firstKey.fileNum).find(firstKey);
+    ASSERT_FALSE(ssdPin.empty());
+    auto fd = open(ssdFile.c_str(), O_WRONLY);
+    ASSERT_LE(0, fd);
+    uint64_t garbage = 0;
+    ASSERT_EQ(
+        static_cast<ssize_t>(sizeof(garbage)),
+        pwrite(fd, &garbage, sizeof(garbage), ssdPin.run().offset()));
+    close(fd);
+  }
+
+  int32_t numSsdHits = 0;
+  for (auto i = 0; i < kNumEntries; ++i) {
+    RawFileCacheKey key{filenames_[0].id(), static_cast<uint64_t>(i * kSize)};
+    auto ssdPin = ssdCache->file(key.fileNum).find(key);
+    if (ssdPin.empty()) {
+      continue;
+    }
+    auto pin = cache_->findOrCreate(key, kSize);
+    ASSERT_FALSE(pin.empty());
+    ASSERT_TRUE(pin.entry()->isExclusive());
+    if (!ssdPin.file()->load(ssdPin.run(), *pin.entry())) {
+      EXPECT_EQ(0, i);
+      continue;
+    }
+    auto run = pin.entry()->data().runAt(0);
+    EXPECT_EQ(i, *reinterpret_cast<int64_t*>(run.data()));
+    pin.entry()->setValid();
+    ++numSsdHits;
+  }
+  EXPECT_EQ(numCached - 1, numSsdHits);
+  EXPECT_EQ(1, ssdCache->stats().checksumErrors);
+
+  cache_.reset();
+  unlink(ssdFile.c_str());
+  unlink((ssdFile + ".cpt").c_str());
+}
@@ -224,3 +224,40 @@ TEST(CachedFactoryTest, retrievedCached) {
   }
   ASSERT_EQ(*generated, 5);
 }
+
+// Copyable for ShardedCachedFactory. The copies share the count.
+struct SharedCountDoublerGenerator {
+  std::unique_ptr<int> operator()(const int& value) {
+    ++*generated;
+    return std::make_unique<int>(value * 2);
+  }
+  std::shared_ptr<std::atomic<int>> generated =
+      std::make_shared<std::atomic<int>>(0);
+};
+
+TEST(CachedFactoryTest, sharded) {
+  SharedCountDoublerGenerator generator;
+  ShardedCachedFactory<int, int, SharedCountDoublerGenerator> factory(
+      1000, generator, 4);
+  ASSERT_EQ(4, factory.numShards());
+  ASSERT_EQ(1000, factory.maxSize());
+  folly::EDFThreadPoolExecutor pool(
+      100, std::make_shared<folly::NamedThreadFactory>("test_pool"));
+  const int numValues = 20;
+  const int requestsPerValue = 10;
+  BlockingCounter counter(numValues * requestsPerValue);
+  for (int i = 0; i < requestsPerValue; i++) {
+    for (int j = 0; j < numValues; j++) {
+      pool.add([&, j]() {
+        auto value = factory.generate(j);
+        CHECK_EQ(*value, 2 * j);
+        counter.decrement();
+      });
+    }
+  }
+  counter.wait();
+  ASSERT_EQ(numValues, *generator.generated);
+  ASSERT_EQ(numValues, factory.currentSize());
+  ASSERT_TRUE(factory.generate(3).wasCached());
+  ASSERT_EQ(numValues, *generator.generated);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/caching/ScanTracker.h"
+#include "velox/common/caching/FileIds.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox;
+using namespace facebook::velox::cache;
+
+TEST(ScanTrackerTest, history) {
+  constexpr int32_t kMinReadPct = 60;
+  constexpr uint64_t kBytes = 1000;
+  StringIdLease group(fileIds(), "scan_tracker_test/partition=1");
+  TrackingId read(1, 2);
+  TrackingId notRead(2, 2);
+  {
+    auto tracker = std::make_shared<ScanTracker>();
+    for (auto stripe = 0; stripe < 10; ++stripe) {
+      tracker->recordReference(read, kBytes, group.id());
+      tracker->recordReference(notRead, kBytes, group.id());
+      tracker->recordRead(read, kBytes, group.id());
+    }
+  }
+  auto history = scanHistory().get("scan_tracker_test/partition=1");
+  EXPECT_EQ(10, history[read].numReads);
+  EXPECT_EQ(0, history[notRead].numReads);
+
+  // A new scan of the group prefetches the stream that was read
+  // before any read in the scan itself.
+  auto tracker = std::make_shared<ScanTracker>();
+  tracker->recordReference(read, kBytes, group.id());
+  tracker->recordReference(notRead, kBytes, group.id());
+  EXPECT_TRUE(tracker->shouldPrefetch(read, kMinReadPct, group.id()));
+  EXPECT_FALSE(tracker->shouldPrefetch(notRead, kMinReadPct, group.id()));
+
+  // Each merge halves the earlier counts.
+  tracker.reset();
+  history = scanHistory().get("scan_tracker_test/partition=1");
+  EXPECT_EQ(5, history[read].numReads);
+  EXPECT_EQ(6, history[read].numReferences);
+}
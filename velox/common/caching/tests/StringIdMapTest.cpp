@@ -33,7 +33,9 @@ TEST(StringIdMapTest, basic) {
     lease1 = lease2;
     EXPECT_EQ(id, lease1.id());
     EXPECT_EQ(strlen(kFile1), map.pinnedSize());
+    EXPECT_EQ(kFile1, map.string(id));
   }
+  EXPECT_EQ("", map.string(id));
   StringIdLease lease3(map, kFile1);
   EXPECT_NE(lease3.id(), id);
   lease3.clear();
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/compression/Compression.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include "velox/common/base/Exceptions.h"
+
+namespace facebook::velox::common {
+namespace {
+// The default level of the zstd command line tool. Higher levels cost more
+// CPU than the network they save for exchange.
+constexpr int32_t kZstdLevel = 3;
+} // namespace
+
+std::string compressionKindToString(CompressionKind kind) {
+  switch (kind) {
+    case CompressionKind::kNone:
+      return "none";
+    case CompressionKind::kLz4:
+      return "lz4";
+    case CompressionKind::kZstd:
+      return "zstd";
+  }
+  VELOX_UNREACHABLE();
+}
+
+CompressionKind stringToCompressionKind(const std::string& kind) {
+  if (kind == "none") {
+    return CompressionKind::kNone;
+  }
+  if (kind == "lz4") {
+    return CompressionKind::kLz4;
+  }
+  if (kind == "zstd") {
+    return CompressionKind::kZstd;
+  }
+  VELOX_USER_FAIL("Unsupported compression: {}", kind);
+}
+
+uint64_t maxCompressedLength(CompressionKind kind, uint64_t length) {
+  switch (kind) {
+    case CompressionKind::kLz4:
+      VELOX_CHECK_LE(length, LZ4_MAX_INPUT_SIZE);
+      return LZ4_compressBound(static_cast<int32_t>(length));
+    case CompressionKind::kZstd:
+      return ZSTD_compressBound(length);
+    case CompressionKind::kNone:
+      break;
+  }
+  VELOX_UNSUPPORTED(
+      "Unsupported compression: {}", compressionKindToString(kind));
+}
+
+uint64_t compress(
+    CompressionKind kind,
+    const char* input,
+    uint64_t inputLength,
+    char* output,
+    uint64_t outputLength) {
+  switch (kind) {
+    case CompressionKind::kLz4: {
+      auto result = LZ4_compress_default(
+          input,
+          output,
+          static_cast<int32_t>(inputLength),
+          static_cast<int32_t>(outputLength));
+      VELOX_CHECK_GT(result, 0, "lz4 failed to compress");
+      return result;
+    }
+    case CompressionKind::kZstd: {
+      auto result =
+          ZSTD_compress(output, outputLength, input, inputLength, kZstdLevel);
+      VELOX_CHECK(
+          !ZSTD_isError(result),
+          "zstd failed to compress: {}",
+          ZSTD_getErrorName(result));
+      return result;
+    }
+    case CompressionKind::kNone:
+      break;
+  }
+  VELOX_UNSUPPORTED(
+      "Unsupported compression: {}", compressionKindToString(kind));
+}
+
+uint64_t decompress(
+    CompressionKind kind,
+    const char* input,
+    uint64_t inputLength,
+    char* output,
+    uint64_t outputLength) {
+  switch (kind) {
+    case CompressionKind::kLz4: {
+      auto result = LZ4_decompress_safe(
+          input,
+          output,
+          static_cast<int32_t>(inputLength),
+          static_cast<int32_t>(outputLength));
+      VELOX_CHECK_GE(result, 0, "lz4 failed to decompress");
+      return result;
+    }
+    case CompressionKind::kZstd: {
+      auto result =
+          ZSTD_decompress(output, outputLength, input, inputLength);
+      VELOX_CHECK(
+          !ZSTD_isError(result),
+          "zstd failed to decompress: {}",
+          ZSTD_getErrorName(result));
+      return result;
+    }
+    case CompressionKind::kNone:
+      break;
+  }
+  VELOX_UNSUPPORTED(
+      "Unsupported compression: {}", compressionKindToString(kind));
+}
+
+} // namespace facebook::velox::common
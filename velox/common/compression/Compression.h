@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace facebook::velox::common {
+
+enum class CompressionKind {
+  kNone,
+  kLz4,
+  kZstd,
+};
+
+std::string compressionKindToString(CompressionKind kind);
+
+// Parses the result of compressionKindToString(). Throws a user error for
+// other strings.
+CompressionKind stringToCompressionKind(const std::string& kind);
+
+// Compression of self-contained blocks, e.g. serialized pages. The blocks
+// have no header. The reader must know the codec and the uncompressed
+// length.
+
+// Returns the size of a buffer that holds the compressed form of any
+// 'length' bytes.
+uint64_t maxCompressedLength(CompressionKind kind, uint64_t length);
+
+// Compresses 'inputLength' bytes from 'input' into 'output', which has
+// space for 'outputLength' bytes. Returns the compressed length.
+uint64_t compress(
+    CompressionKind kind,
+    const char* input,
+    uint64_t inputLength,
+    char* output,
+    uint64_t outputLength);
+
+// Decompresses 'inputLength' bytes from 'input' into 'output', which has
+// space for 'outputLength' bytes. Returns the decompressed length.
+uint64_t decompress(
+    CompressionKind kind,
+    const char* input,
+    uint64_t inputLength,
+    char* output,
+    uint64_t outputLength);
+
+} // namespace facebook::velox::common
@@ -15,6 +15,7 @@
  */
 
 #include "velox/common/file/File.h"
+#include "velox/common/file/IoUring.h"
 
 #include <fmt/format.h>
 #include <glog/logging.h>
@@ -22,6 +23,10 @@
 #include <stdexcept>
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <folly/String.h>
 #include <folly/portability/SysUio.h>
 
 namespace facebook::velox {
@@ -82,6 +87,12 @@ LocalReadFile::LocalReadFile(std::string_view path) {
   }
 }
 
+LocalReadFile::~LocalReadFile() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
 void LocalReadFile::preadInternal(uint64_t offset, uint64_t length, char* pos)
     const {
   bytesRead_ += length;
@@ -112,8 +123,10 @@ std::string LocalReadFile::pread(uint64_t offset, uint64_t length) const {
   return result;
 }
 
-uint64_t LocalReadFile::preadv(
-    uint64_t offset,
+namespace {
+// Builds the iovecs for preadv. A range with nullptr data reads into a
+// buffer that is never read back.
+std::vector<struct iovec> toIovecs(
     const std::vector<folly::Range<char*>>& buffers) {
   static char droppedBytes[8 * 1024];
   std::vector<struct iovec> iovecs;
@@ -130,9 +143,31 @@ uint64_t LocalReadFile::preadv(
       iovecs.push_back({range.data(), range.size()});
     }
   }
+  return iovecs;
+}
+} // namespace
+
+uint64_t LocalReadFile::preadv(
+    uint64_t offset,
+    const std::vector<folly::Range<char*>>& buffers) {
+  auto iovecs = toIovecs(buffers);
   return folly::preadv(fd_, iovecs.data(), iovecs.size(), offset);
 }
 
+folly::SemiFuture<uint64_t> LocalReadFile::preadvAsync(
+    uint64_t offset,
+    const std::vector<folly::Range<char*>>& buffers) {
+  auto* ring = IoUring::instance();
+  if (!ring) {
+    return ReadFile::preadvAsync(offset, buffers);
+  }
+  return ring->preadv(fd_, offset, toIovecs(buffers));
+}
+
+bool LocalReadFile::hasPreadvAsync() const {
+  return IoUring::instance() != nullptr;
+}
+
 uint64_t LocalReadFile::size() const {
   if (size_ != -1) {
     return size_;
@@ -153,6 +188,73 @@ uint64_t LocalReadFile::memoryUsage() const {
   return sizeof(FILE);
 }
 
+MappedReadFile::MappedReadFile(std::string_view path) {
+  const std::string filename(path);
+  auto fd = open(filename.c_str(), O_RDONLY);
+  VELOX_CHECK_GE(fd, 0, "Cannot open {}: {}", filename, folly::errnoStr(errno));
+  int error = 0;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    error = errno;
+  } else if (st.st_size > 0) {
+    auto data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      error = errno;
+    } else {
+      data_ = static_cast<const char*>(data);
+      size_ = st.st_size;
+    }
+  }
+  // The mapping stays valid after closing the file.
+  close(fd);
+  VELOX_CHECK_EQ(
+      error, 0, "Cannot map {}: {}", filename, folly::errnoStr(error));
+}
+
+MappedReadFile::~MappedReadFile() {
+  if (data_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+std::string_view MappedReadFile::pread(
+    uint64_t offset,
+    uint64_t length,
+    Arena* /*arena*/) const {
+  VELOX_CHECK_LE(offset + length, size_);
+  bytesRead_ += length;
+  return {data_ + offset, length};
+}
+
+std::string_view
+MappedReadFile::pread(uint64_t offset, uint64_t length, void* buf) const {
+  memcpy(buf, pread(offset, length, nullptr).data(), length);
+  return {static_cast<char*>(buf), length};
+}
+
+std::string MappedReadFile::pread(uint64_t offset, uint64_t length) const {
+  return std::string(pread(offset, length, nullptr));
+}
+
+uint64_t MappedReadFile::preadv(
+    uint64_t offset,
+    const std::vector<folly::Range<char*>>& buffers) {
+  uint64_t numRead = 0;
+  for (auto& range : buffers) {
+    if (offset >= size_) {
+      break;
+    }
+    auto copySize = std::min<uint64_t>(range.size(), size_ - offset);
+    if (range.data()) {
+      memcpy(range.data(), data_ + offset, copySize);
+    }
+    offset += copySize;
+    numRead += copySize;
+  }
+  bytesRead_ += numRead;
+  return numRead;
+}
+
 LocalWriteFile::LocalWriteFile(std::string_view path) {
   std::unique_ptr<char[]> buf(new char[path.size() + 1]);
   buf[path.size()] = 0;
@@ -65,7 +65,8 @@ folly::once_flag localFSInstantiationFlag;
 class LocalFileSystem : public FileSystem {
  public:
   explicit LocalFileSystem(std::shared_ptr<const Config> config)
-      : FileSystem(config) {}
+      : FileSystem(config),
+        mmap_(config_ && config_->get<bool>(kLocalFileMmap, false)) {}
 
   ~LocalFileSystem() override {}
 
@@ -75,7 +76,10 @@ class LocalFileSystem : public FileSystem {
 
   std::unique_ptr<ReadFile> openFileForRead(std::string_view path) override {
     if (path.find(kFileScheme) == 0) {
-      return std::make_unique<LocalReadFile>(path.substr(kFileScheme.length()));
+      path = path.substr(kFileScheme.length());
+    }
+    if (mmap_) {
+      return std::make_unique<MappedReadFile>(path);
     }
     return std::make_unique<LocalReadFile>(path);
   }
@@ -109,6 +113,9 @@ class LocalFileSystem : public FileSystem {
       return lfs;
     };
   }
+
+ private:
+  const bool mmap_;
 };
 } // namespace
 
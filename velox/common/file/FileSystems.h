@@ -59,6 +59,10 @@ void registerFileSystem(
     std::function<std::shared_ptr<FileSystem>(std::shared_ptr<const Config>)>
         fileSystemGenerator);
 
+// Config property of the local filesystem. If "true", files opened for
+// read are mapped into memory. See MappedReadFile.
+constexpr const char* kLocalFileMmap = "local-fs.mmap";
+
 // Register the local filesystem.
 void registerLocalFileSystem();
 
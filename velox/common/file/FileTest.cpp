@@ -89,6 +89,45 @@ TEST(LocalFile, writeAndRead) {
   readData(&readFile);
 }
 
+TEST(LocalFile, preadvAsync) {
+  auto tempFile = ::exec::test::TempFilePath::create();
+  const auto& filename = tempFile->path.c_str();
+  remove(filename);
+  {
+    LocalWriteFile writeFile(filename);
+    writeData(&writeFile);
+  }
+  LocalReadFile readFile(filename);
+
+  // Many reads in flight at a time, each of 1000 'c's and a skipped range
+  // followed by the last 5 bytes.
+  constexpr int32_t kNumReads = 1000;
+  std::vector<std::string> data(kNumReads, std::string(1000, 0));
+  std::vector<std::string> tails(kNumReads, std::string(5, 0));
+  std::vector<folly::SemiFuture<uint64_t>> futures;
+  for (auto i = 0; i < kNumReads; ++i) {
+    auto offset = 10 + i * 1000;
+    std::vector<folly::Range<char*>> buffers = {
+        folly::Range<char*>(data[i].data(), data[i].size()),
+        folly::Range<char*>(nullptr, 15 + kOneMB - offset - 1000 - 5),
+        folly::Range<char*>(tails[i].data(), tails[i].size())};
+    futures.push_back(readFile.preadvAsync(offset, buffers));
+  }
+  for (auto i = 0; i < kNumReads; ++i) {
+    auto offset = 10 + i * 1000;
+    ASSERT_EQ(15 + kOneMB - offset, std::move(futures[i]).get());
+    ASSERT_EQ(data[i], std::string(1000, 'c'));
+    ASSERT_EQ(tails[i], "ddddd");
+  }
+
+  // A read past the end of the file returns the bytes up to the end.
+  char tail[10];
+  std::vector<folly::Range<char*>> buffers = {
+      folly::Range<char*>(tail, sizeof(tail))};
+  ASSERT_EQ(5, readFile.preadvAsync(10 + kOneMB, buffers).get());
+  ASSERT_EQ(std::string_view(tail, 5), "ddddd");
+}
+
 TEST(LocalFile, viaRegistry) {
   filesystems::registerLocalFileSystem();
   const char filename[] = "/tmp/test";
@@ -103,3 +142,43 @@ TEST(LocalFile, viaRegistry) {
   Arena arena;
   ASSERT_EQ(readFile->pread(0, 5, &arena), "snarf");
 }
+
+TEST(ReadCost, shouldCoalesce) {
+  ReadCost defaultCost;
+  EXPECT_TRUE(defaultCost.shouldCoalesce(1'280 << 10));
+  EXPECT_FALSE(defaultCost.shouldCoalesce((1'280 << 10) + 1));
+  EXPECT_DOUBLE_EQ(2 * 1'280 + 1, defaultCost.timeUs(2, 1 << 10));
+
+  std::string data = "aaaaa";
+  InMemoryReadFile memoryFile(data);
+  EXPECT_FALSE(memoryFile.readCost().shouldCoalesce(1));
+  memoryFile.setShouldCoalesce(true);
+  EXPECT_TRUE(memoryFile.readCost().shouldCoalesce(1 << 20));
+
+  const char filename[] = "/tmp/test";
+  remove(filename);
+  {
+    LocalWriteFile writeFile(filename);
+    writeFile.append(data);
+  }
+  LocalReadFile localFile(filename);
+  // Reading over a gap on local disk pays off only for shorter gaps.
+  EXPECT_TRUE(localFile.readCost().shouldCoalesce(100 << 10));
+  EXPECT_FALSE(localFile.readCost().shouldCoalesce(1 << 20));
+}
+
+TEST(MappedFile, read) {
+  const char filename[] = "/tmp/test";
+  remove(filename);
+  {
+    LocalWriteFile writeFile(filename);
+    writeData(&writeFile);
+  }
+  MappedReadFile readFile(filename);
+  readData(&readFile);
+  Arena arena;
+  // Reads into an arena return the mapped memory.
+  EXPECT_EQ(
+      readFile.pread(10, 5, &arena).data(), readFile.mappedData().data() + 10);
+  EXPECT_EQ(readFile.size(), readFile.mappedData().size());
+}
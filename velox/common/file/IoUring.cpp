@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/file/IoUring.h"
+
+#include <fmt/format.h>
+#include <folly/String.h>
+#include <glog/logging.h>
+
+#include "velox/common/base/Exceptions.h"
+
+#ifdef VELOX_ENABLE_IO_URING
+#include <liburing.h>
+#endif
+
+namespace facebook::velox {
+
+#ifdef VELOX_ENABLE_IO_URING
+
+struct IoUring::Request {
+  int32_t fd;
+  uint64_t offset;
+  std::vector<struct iovec> iovecs;
+  // The first iovec that is not completely read.
+  size_t firstIovec{0};
+  uint64_t bytesRead{0};
+  folly::Promise<uint64_t> promise;
+};
+
+// static
+IoUring* IoUring::instance() {
+  static std::unique_ptr<IoUring> instance = []() {
+    auto ring = std::make_unique<struct io_uring>();
+    auto rc = io_uring_queue_init(kQueueDepth, ring.get(), 0);
+    if (rc < 0) {
+      LOG(WARNING) << "io_uring is not available, reading synchronously: "
+                   << folly::errnoStr(-rc);
+      return std::unique_ptr<IoUring>();
+    }
+    return std::unique_ptr<IoUring>(new IoUring(std::move(ring)));
+  }();
+  return instance.get();
+}
+
+IoUring::IoUring(std::unique_ptr<struct io_uring> ring)
+    : ring_(std::move(ring)), reaper_([this]() { reap(); }) {}
+
+IoUring::~IoUring() {
+  {
+    std::unique_lock<std::mutex> l(submitMutex_);
+    slotAvailable_.wait(l, [&]() { return numInFlight_ < kQueueDepth; });
+    shutdown_ = true;
+    // A completion without a request stops the reaper.
+    auto* sqe = io_uring_get_sqe(ring_.get());
+    VELOX_CHECK_NOT_NULL(sqe);
+    io_uring_prep_nop(sqe);
+    io_uring_sqe_set_data(sqe, nullptr);
+    io_uring_submit(ring_.get());
+  }
+  reaper_.join();
+  io_uring_queue_exit(ring_.get());
+}
+
+folly::SemiFuture<uint64_t> IoUring::preadv(
+    int32_t fd,
+    uint64_t offset,
+    std::vector<struct iovec> iovecs) {
+  auto request = std::make_unique<Request>();
+  request->fd = fd;
+  request->offset = offset;
+  request->iovecs = std::move(iovecs);
+  auto future = request->promise.getSemiFuture();
+  if (request->iovecs.empty()) {
+    request->promise.setValue(0);
+    return future;
+  }
+  std::unique_lock<std::mutex> l(submitMutex_);
+  slotAvailable_.wait(l, [&]() { return numInFlight_ < kQueueDepth; });
+  VELOX_CHECK(!shutdown_);
+  ++numInFlight_;
+  submitLocked(request.release());
+  return future;
+}
+
+void IoUring::submitLocked(Request* request) {
+  // There is a free entry since at most kQueueDepth reads are in flight.
+  auto* sqe = io_uring_get_sqe(ring_.get());
+  VELOX_CHECK_NOT_NULL(sqe);
+  io_uring_prep_readv(
+      sqe,
+      request->fd,
+      request->iovecs.data() + request->firstIovec,
+      request->iovecs.size() - request->firstIovec,
+      request->offset + request->bytesRead);
+  io_uring_sqe_set_data(sqe, request);
+  auto rc = io_uring_submit(ring_.get());
+  VELOX_CHECK_GE(rc, 0, "io_uring_submit failed: {}", folly::errnoStr(-rc));
+}
+
+void IoUring::reap() {
+  for (;;) {
+    struct io_uring_cqe* cqe;
+    auto rc = io_uring_wait_cqe(ring_.get(), &cqe);
+    if (rc == -EINTR) {
+      continue;
+    }
+    VELOX_CHECK_EQ(rc, 0, "io_uring_wait_cqe failed: {}", folly::errnoStr(-rc));
+    auto* request = static_cast<Request*>(io_uring_cqe_get_data(cqe));
+    auto result = cqe->res;
+    io_uring_cqe_seen(ring_.get(), cqe);
+    if (!request) {
+      return;
+    }
+    if (result == -EAGAIN) {
+      std::lock_guard<std::mutex> l(submitMutex_);
+      submitLocked(request);
+      continue;
+    }
+
+    if (result > 0) {
+      // Skips the iovecs that are read and trims the partially read one.
+      request->bytesRead += result;
+      auto& iovecs = request->iovecs;
+      size_t remaining = result;
+      while (request->firstIovec < iovecs.size() &&
+             remaining >= iovecs[request->firstIovec].iov_len) {
+        remaining -= iovecs[request->firstIovec].iov_len;
+        ++request->firstIovec;
+      }
+      if (request->firstIovec < iovecs.size()) {
+        auto& iovec = iovecs[request->firstIovec];
+        iovec.iov_base = static_cast<char*>(iovec.iov_base) + remaining;
+        iovec.iov_len -= remaining;
+        // A short read that is not at end of file reads the rest.
+        std::lock_guard<std::mutex> l(submitMutex_);
+        submitLocked(request);
+        continue;
+      }
+    }
+
+    std::unique_ptr<Request> completed(request);
+    {
+      std::lock_guard<std::mutex> l(submitMutex_);
+      --numInFlight_;
+    }
+    slotAvailable_.notify_one();
+    if (result < 0) {
+      completed->promise.setException(std::runtime_error(fmt::format(
+          "io_uring read failure: {}", folly::errnoStr(-result))));
+    } else {
+      // All read or end of file.
+      completed->promise.setValue(completed->bytesRead);
+    }
+  }
+}
+
+#else
+
+// static
+IoUring* IoUring::instance() {
+  return nullptr;
+}
+
+folly::SemiFuture<uint64_t> IoUring::preadv(
+    int32_t /*fd*/,
+    uint64_t /*offset*/,
+    std::vector<struct iovec> /*iovecs*/) {
+  VELOX_UNSUPPORTED("Velox is built without io_uring");
+}
+
+#endif
+
+} // namespace facebook::velox
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <folly/futures/Future.h>
+#include <folly/portability/SysUio.h>
+
+struct io_uring;
+
+namespace facebook::velox {
+
+// Reads local files through io_uring. There is one submission ring per
+// process and one thread that reaps the completions and fulfills the
+// futures, so that any number of reads can be in flight without blocking a
+// thread per read. Requires building with VELOX_ENABLE_IO_URING.
+class IoUring {
+ public:
+  // Up to this many reads are in flight. Further reads wait for a slot.
+  static constexpr int32_t kQueueDepth = 256;
+
+  // Returns the ring of the process or nullptr if io_uring is not built in
+  // or not available, e.g. on an old kernel.
+  static IoUring* instance();
+
+  ~IoUring();
+
+  // Reads from 'fd' starting at 'offset' into 'iovecs'. The memory of the
+  // iovecs must stay valid until the future is complete. The future has the
+  // number of bytes read, which is less than the size of 'iovecs' only at
+  // end of file.
+  folly::SemiFuture<uint64_t>
+  preadv(int32_t fd, uint64_t offset, std::vector<struct iovec> iovecs);
+
+ private:
+  struct Request;
+
+  explicit IoUring(std::unique_ptr<struct io_uring> ring);
+
+  // Adds 'request' to the submission queue and submits it. Must be called
+  // under 'submitMutex_'.
+  void submitLocked(Request* request);
+
+  // Loop of 'reaper_'. Completes or resubmits the reads.
+  void reap();
+
+  const std::unique_ptr<struct io_uring> ring_;
+
+  // Serializes the users of the submission queue.
+  std::mutex submitMutex_;
+  std::condition_variable slotAvailable_;
+  int32_t numInFlight_{0};
+  bool shutdown_{false};
+
+  std::thread reaper_;
+};
+
+} // namespace facebook::velox
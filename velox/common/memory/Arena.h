@@ -25,24 +25,50 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <memory>
 #include <string_view>
 #include <vector>
 
+#include "velox/common/memory/Memory.h"
+
 namespace facebook::velox {
 
-// Internally manages memory in chunks. Releases memory only upon destruction.
-// Arena is NOT threadsafe: external locking is required. All functions in this
-// class are expected to be used in tight loops, so we inline everything.
+// Internally manages memory in chunks. Releases memory only upon destruction
+// or clear(). Arena is NOT threadsafe: external locking is required. All
+// functions in this class are expected to be used in tight loops, so we inline
+// everything.
+//
+// If constructed with a MemoryPool, the chunks are allocated from and charged
+// to the pool. Otherwise they come from malloc. Chunks after the first are at
+// least 'minChunkSize' bytes.
 class Arena {
  public:
-  Arena(int64_t initial_chunk_size = kMinChunkSize) {
-    addChunk(initial_chunk_size);
+  static constexpr int64_t kMinChunkSize = 1LL << 20;
+
+  Arena(int64_t initial_chunk_size = kMinChunkSize)
+      : Arena(nullptr, initial_chunk_size) {}
+
+  explicit Arena(
+      memory::MemoryPool* pool,
+      int64_t initialChunkSize = kMinChunkSize,
+      int64_t minChunkSize = kMinChunkSize)
+      : pool_(pool), minChunkSize_(minChunkSize) {
+    addChunk(initialChunkSize);
     reserveEnd_ = pos_;
   }
 
+  ~Arena() {
+    for (auto& chunk : chunks_) {
+      freeChunk(chunk);
+    }
+  }
+
+  Arena(const Arena& other) = delete;
+  Arena& operator=(const Arena& other) = delete;
+
   // Returns a pointer to a block of memory of size bytes that can be written
   // to, and guarantees for the lifetime of *this that that region will remain
   // valid. Does NOT guarantee that the region is initially 0'd.
@@ -56,6 +82,24 @@ class Arena {
     return pos_;
   }
 
+  // Returns space for 'numElements' of T, aligned for T. Does not run
+  // constructors.
+  template <typename T>
+  T* allocate(int64_t numElements) {
+    auto bytes = numElements * sizeof(T);
+    auto aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(reserveEnd_) + alignof(T) - 1) &
+        ~(alignof(T) - 1));
+    if (aligned + bytes <= chunkEnd_) {
+      pos_ = aligned;
+      reserveEnd_ = aligned + bytes;
+      return reinterpret_cast<T*>(pos_);
+    }
+    // A new chunk starts at the alignment of the allocator.
+    addChunk(bytes);
+    return reinterpret_cast<T*>(pos_);
+  }
+
   // Copies |data| into the chunk, returning a view to the copied data.
   std::string_view writeString(std::string_view data) {
     char* pos = reserve(data.size());
@@ -63,21 +107,90 @@ class Arena {
     return {pos, data.size()};
   }
 
+  // Frees all chunks but the first one and makes the whole first chunk
+  // available. Invalidates all memory returned by 'this'.
+  void clear() {
+    for (auto i = 1; i < chunks_.size(); ++i) {
+      freeChunk(chunks_[i]);
+    }
+    chunks_.resize(1);
+    pos_ = chunks_[0].data;
+    reserveEnd_ = pos_;
+    chunkEnd_ = pos_ + chunks_[0].size;
+  }
+
+  // Returns the total size of the chunks of 'this'.
+  int64_t allocatedBytes() const {
+    int64_t total = 0;
+    for (auto& chunk : chunks_) {
+      total += chunk.size;
+    }
+    return total;
+  }
+
  private:
-  static constexpr int64_t kMinChunkSize = 1LL << 20;
+  struct Chunk {
+    char* data;
+    int64_t size;
+  };
 
   void addChunk(int64_t bytes) {
-    const int64_t chunkSize = std::max(bytes, kMinChunkSize);
-    chunks_.emplace_back(new char[chunkSize]);
-    pos_ = chunks_.back().get();
+    const int64_t chunkSize = std::max(bytes, minChunkSize_);
+    char* data = pool_ ? reinterpret_cast<char*>(pool_->allocate(chunkSize))
+                       : new char[chunkSize];
+    chunks_.push_back(Chunk{data, chunkSize});
+    pos_ = data;
     chunkEnd_ = pos_ + chunkSize;
     reserveEnd_ = pos_ + bytes;
   }
 
+  void freeChunk(Chunk& chunk) {
+    if (pool_) {
+      pool_->free(chunk.data, chunk.size);
+    } else {
+      delete[] chunk.data;
+    }
+  }
+
+  memory::MemoryPool* const pool_;
+  const int64_t minChunkSize_;
   char* chunkEnd_;
   char* pos_;
   char* reserveEnd_;
-  std::vector<std::unique_ptr<char[]>> chunks_;
+  std::vector<Chunk> chunks_;
+};
+
+// STL allocator over an Arena. Deallocation is a no-op, the memory is
+// reclaimed when the Arena is cleared or destroyed.
+template <typename T>
+struct ArenaAllocator {
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(std::size_t n) {
+    return arena_->allocate<T>(n);
+  }
+
+  void deallocate(T* /*p*/, std::size_t /*n*/) noexcept {}
+
+  Arena* arena() const {
+    return arena_;
+  }
+
+  friend bool operator==(const ArenaAllocator& lhs, const ArenaAllocator& rhs) {
+    return lhs.arena_ == rhs.arena_;
+  }
+
+  friend bool operator!=(const ArenaAllocator& lhs, const ArenaAllocator& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  Arena* arena_;
 };
 
 } //  namespace facebook::velox
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/common/memory/MemoryArbitrator.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include <folly/ScopeGuard.h>
+
+namespace facebook::velox::memory {
+
+namespace {
+// True while the thread runs an arbitration. Allocations made by
+// MemoryReclaimers do not start a nested arbitration.
+thread_local bool inArbitration = false;
+} // namespace
+
+MemoryArbitrator::MemoryArbitrator(
+    int64_t capacity,
+    int64_t initialQueryCapacity)
+    : capacity_(capacity),
+      initialQueryCapacity_(initialQueryCapacity),
+      freeCapacity_(capacity) {
+  VELOX_CHECK_GT(capacity_, 0);
+  VELOX_CHECK_GE(initialQueryCapacity_, 0);
+}
+
+void MemoryArbitrator::addQuery(
+    const std::shared_ptr<MemoryUsageTracker>& tracker) {
+  VELOX_CHECK_NULL(
+      tracker->parent(), "Only root trackers can be added to arbitration");
+  std::lock_guard<std::mutex> l(mutex_);
+  VELOX_CHECK_EQ(
+      queries_.count(tracker.get()), 0, "Query added twice to arbitration");
+  auto initial = std::min(initialQueryCapacity_, freeCapacity_);
+  freeCapacity_ -= initial;
+  tracker->setMaxTotalBytes(initial);
+  tracker->setGrowCallback(
+      [this](MemoryUsageTracker& tracker, int64_t bytes) {
+        return grow(tracker, bytes);
+      });
+  queries_[tracker.get()].tracker = tracker;
+}
+
+void MemoryArbitrator::removeQuery(const MemoryUsageTracker& tracker) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = queries_.find(&tracker);
+  VELOX_CHECK(it != queries_.end(), "Query not found in arbitration");
+  freeCapacity_ += tracker.getMaxTotalBytes();
+  queries_.erase(it);
+}
+
+void MemoryArbitrator::addReclaimer(
+    const MemoryUsageTracker& tracker,
+    std::shared_ptr<MemoryReclaimer> reclaimer) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto query = findQueryLocked(&tracker);
+  VELOX_CHECK_NOT_NULL(query, "Query not found in arbitration");
+  query->reclaimers.push_back(std::move(reclaimer));
+}
+
+void MemoryArbitrator::removeReclaimer(const MemoryReclaimer* reclaimer) {
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto& pair : queries_) {
+    auto& reclaimers = pair.second.reclaimers;
+    auto it = std::find_if(
+        reclaimers.begin(), reclaimers.end(), [&](const auto& other) {
+          return other.get() == reclaimer;
+        });
+    if (it != reclaimers.end()) {
+      reclaimers.erase(it);
+      return;
+    }
+  }
+}
+
+MemoryArbitrator::Query* MemoryArbitrator::findQueryLocked(
+    const MemoryUsageTracker* tracker) {
+  for (; tracker; tracker = tracker->parent()) {
+    auto it = queries_.find(tracker);
+    if (it != queries_.end()) {
+      return &it->second;
+    }
+  }
+  return nullptr;
+}
+
+bool MemoryArbitrator::growLocked(Query& query, int64_t bytes) {
+  if (freeCapacity_ < bytes) {
+    return false;
+  }
+  auto increment = std::min(freeCapacity_, std::max(bytes, kMinGrowBytes));
+  freeCapacity_ -= increment;
+  query.tracker->setMaxTotalBytes(
+      query.tracker->getMaxTotalBytes() + increment);
+  return true;
+}
+
+int64_t MemoryArbitrator::shrinkLocked(Query& query) {
+  auto& tracker = *query.tracker;
+  auto unused = tracker.getMaxTotalBytes() - tracker.getCurrentTotalBytes();
+  if (unused <= 0) {
+    return 0;
+  }
+  tracker.setMaxTotalBytes(tracker.getMaxTotalBytes() - unused);
+  freeCapacity_ += unused;
+  stats_.shrunkBytes += unused;
+  return unused;
+}
+
+bool MemoryArbitrator::grow(MemoryUsageTracker& tracker, int64_t bytes) {
+  if (inArbitration) {
+    return false;
+  }
+  std::vector<std::shared_ptr<MemoryReclaimer>> ownReclaimers;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.numRequests;
+    auto query = findQueryLocked(&tracker);
+    if (!query) {
+      ++stats_.numFailures;
+      return false;
+    }
+    ownReclaimers = query->reclaimers;
+  }
+  // The calling thread may belong to a Driver of a query that gets
+  // stopped by a concurrent arbitration. Let it be stopped while it waits.
+  std::shared_ptr<void> suspension;
+  for (auto& reclaimer : ownReclaimers) {
+    if ((suspension = reclaimer->enterArbitration())) {
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> arbitration(arbitrationMutex_);
+  inArbitration = true;
+  SCOPE_EXIT {
+    inArbitration = false;
+  };
+
+  std::vector<std::pair<int64_t, std::shared_ptr<MemoryReclaimer>>>
+      candidates;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    // The query may have been removed while waiting.
+    auto query = findQueryLocked(&tracker);
+    if (!query) {
+      ++stats_.numFailures;
+      return false;
+    }
+    if (growLocked(*query, bytes)) {
+      return true;
+    }
+    for (auto& pair : queries_) {
+      if (&pair.second != query) {
+        shrinkLocked(pair.second);
+      }
+    }
+    if (growLocked(*query, bytes)) {
+      return true;
+    }
+    for (auto& pair : queries_) {
+      if (&pair.second == query) {
+        continue;
+      }
+      auto usage = pair.second.tracker->getCurrentTotalBytes();
+      for (auto& reclaimer : pair.second.reclaimers) {
+        candidates.emplace_back(usage, reclaimer);
+      }
+    }
+  }
+
+  // Reclaims from the largest queries first. The reclaimers run outside
+  // of 'mutex_' since they free memory and may add or remove queries.
+  std::stable_sort(
+      candidates.begin(),
+      candidates.end(),
+      [](const auto& left, const auto& right) {
+        return left.first > right.first;
+      });
+  for (auto& candidate : candidates) {
+    int64_t needed;
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      needed = bytes - freeCapacity_;
+    }
+    auto freed = candidate.second->reclaim(std::max<int64_t>(needed, 0));
+    std::lock_guard<std::mutex> l(mutex_);
+    ++stats_.numReclaims;
+    stats_.reclaimedBytes += freed;
+    for (auto& pair : queries_) {
+      if (pair.first != &tracker) {
+        shrinkLocked(pair.second);
+      }
+    }
+    auto query = findQueryLocked(&tracker);
+    if (!query) {
+      ++stats_.numFailures;
+      return false;
+    }
+    if (growLocked(*query, bytes)) {
+      return true;
+    }
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  ++stats_.numFailures;
+  return false;
+}
+
+int64_t MemoryArbitrator::freeCapacity() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return freeCapacity_;
+}
+
+MemoryArbitrator::Stats MemoryArbitrator::stats() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return stats_;
+}
+
+std::string MemoryArbitrator::toString() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  std::stringstream out;
+  out << "MemoryArbitrator: " << queries_.size() << " queries, "
+      << freeCapacity_ << " / " << capacity_ << " bytes free\n"
+      << "Requests: " << stats_.numRequests
+      << " failures: " << stats_.numFailures
+      << " shrunk bytes: " << stats_.shrunkBytes
+      << " reclaims: " << stats_.numReclaims
+      << " reclaimed bytes: " << stats_.reclaimedBytes;
+  return out.str();
+}
+
+} // namespace facebook::velox::memory
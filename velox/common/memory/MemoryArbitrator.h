@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <folly/container/F14Map.h>
+#include "velox/common/memory/MemoryUsageTracker.h"
+
+namespace facebook::velox::memory {
+
+// Interface for freeing memory of a running query on request of a
+// MemoryArbitrator. The execution layer implements this for a Task,
+// which stops its Drivers and asks its Operators to spill or flush
+// their state.
+class MemoryReclaimer {
+ public:
+  virtual ~MemoryReclaimer() = default;
+
+  // Called on a thread of the query of 'this' before the thread waits
+  // for an arbitration. Returns an object that keeps the thread in a
+  // state where its query can be stopped, e.g. a suspended Driver, or
+  // nullptr if the thread does not run on behalf of 'this'. The state
+  // ends when the returned object is freed after the arbitration.
+  virtual std::shared_ptr<void> enterArbitration() {
+    return nullptr;
+  }
+
+  // Frees up to 'targetBytes' of memory. Returns the number of bytes
+  // freed.
+  virtual int64_t reclaim(int64_t targetBytes) = 0;
+};
+
+// Distributes a fixed node level memory capacity between the queries
+// running on a node. A query is represented by the root
+// MemoryUsageTracker of its memory, whose total cap is set by 'this'.
+// A query starts with a cap of 'initialQueryCapacity' and grows on
+// demand. When there is no free capacity, growing takes back the
+// unused capacity of the other queries and, if this is not enough,
+// asks the MemoryReclaimers of the other queries to free memory, in
+// order of decreasing memory usage of the query. Arbitrations are
+// serialized. 'this' must outlive the trackers of its queries.
+class MemoryArbitrator {
+ public:
+  // The minimum capacity given to a query at a time. Prevents frequent
+  // arbitration for queries that grow in small steps.
+  static constexpr int64_t kMinGrowBytes = 8 << 20; // 8MB
+
+  struct Stats {
+    // Number of calls to grow().
+    int64_t numRequests{0};
+    // Number of grow() calls that could not give the requested capacity.
+    int64_t numFailures{0};
+    // Unused capacity taken back from queries.
+    int64_t shrunkBytes{0};
+    // Number of calls to MemoryReclaimer::reclaim().
+    int64_t numReclaims{0};
+    // Bytes freed by MemoryReclaimers.
+    int64_t reclaimedBytes{0};
+  };
+
+  MemoryArbitrator(int64_t capacity, int64_t initialQueryCapacity);
+
+  // Adds a query with root tracker 'tracker'. Sets the total cap of
+  // 'tracker' to at most 'initialQueryCapacity' and makes 'tracker' grow
+  // its cap through 'this'.
+  void addQuery(const std::shared_ptr<MemoryUsageTracker>& tracker);
+
+  // Removes the query of 'tracker' and returns its capacity to the free
+  // capacity.
+  void removeQuery(const MemoryUsageTracker& tracker);
+
+  // Registers 'reclaimer' for the query of 'tracker'. 'tracker' is the
+  // root tracker of a query added with addQuery() or any of its
+  // descendants.
+  void addReclaimer(
+      const MemoryUsageTracker& tracker,
+      std::shared_ptr<MemoryReclaimer> reclaimer);
+
+  void removeReclaimer(const MemoryReclaimer* FOLLY_NONNULL reclaimer);
+
+  // Raises the total cap of the root tracker 'tracker' by at least
+  // 'bytes'. Returns false if the capacity could not be found. Called
+  // by 'tracker' when an allocation would exceed its cap. Returns false
+  // without arbitrating if called from inside an arbitration, i.e. when
+  // a MemoryReclaimer allocates past the cap of its query.
+  bool grow(MemoryUsageTracker& tracker, int64_t bytes);
+
+  int64_t capacity() const {
+    return capacity_;
+  }
+
+  // Returns the capacity not given to any query.
+  int64_t freeCapacity() const;
+
+  Stats stats() const;
+
+  std::string toString() const;
+
+ private:
+  struct Query {
+    std::shared_ptr<MemoryUsageTracker> tracker;
+    std::vector<std::shared_ptr<MemoryReclaimer>> reclaimers;
+  };
+
+  // Returns the query whose root tracker is 'tracker' or an ancestor of
+  // 'tracker', nullptr if there is none.
+  Query* FOLLY_NULLABLE findQueryLocked(const MemoryUsageTracker* tracker);
+
+  // Adds at least 'bytes' of free capacity to the cap of 'query'.
+  // Returns false if there is not enough free capacity.
+  bool growLocked(Query& query, int64_t bytes);
+
+  // Lowers the cap of 'query' to its current usage and returns the
+  // capacity taken back.
+  int64_t shrinkLocked(Query& query);
+
+  const int64_t capacity_;
+  const int64_t initialQueryCapacity_;
+
+  // Serializes arbitrations. Held while reclaiming, outside of 'mutex_'.
+  std::mutex arbitrationMutex_;
+
+  // Serializes access to the members below.
+  mutable std::mutex mutex_;
+
+  folly::F14FastMap<const MemoryUsageTracker*, Query> queries_;
+
+  int64_t freeCapacity_;
+
+  Stats stats_;
+};
+
+} // namespace facebook::velox::memory
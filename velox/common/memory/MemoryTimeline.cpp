@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/common/memory/MemoryTimeline.h"
+
+#include <algorithm>
+#include "velox/common/base/Exceptions.h"
+
+namespace facebook::velox::memory {
+
+MemoryTimeline::MemoryTimeline(uint64_t intervalMs, int32_t maxSamples)
+    : intervalMs_(std::max<uint64_t>(1, intervalMs)),
+      maxSamples_(maxSamples) {
+  VELOX_CHECK_GE(maxSamples_, 2);
+  samples_.reserve(maxSamples_);
+}
+
+void MemoryTimeline::record(uint64_t timeMs, int64_t bytes) {
+  std::lock_guard<std::mutex> l(mutex_);
+  if (!samples_.empty() && timeMs < samples_.back().timeMs + intervalMs_) {
+    samples_.back().bytes = std::max(samples_.back().bytes, bytes);
+    return;
+  }
+  if (samples_.size() == static_cast<size_t>(maxSamples_)) {
+    downsampleMemoryTimeline(samples_, maxSamples_ / 2);
+    intervalMs_ *= 2;
+  }
+  samples_.push_back({timeMs, bytes});
+}
+
+std::vector<MemoryUsageSample> MemoryTimeline::samples() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return samples_;
+}
+
+void downsampleMemoryTimeline(
+    std::vector<MemoryUsageSample>& timeline,
+    int32_t maxSamples) {
+  VELOX_CHECK_GE(maxSamples, 1);
+  while (timeline.size() > static_cast<size_t>(maxSamples)) {
+    size_t numKept = 0;
+    for (size_t i = 0; i < timeline.size(); i += 2) {
+      auto sample = timeline[i];
+      if (i + 1 < timeline.size()) {
+        sample.bytes = std::max(sample.bytes, timeline[i + 1].bytes);
+      }
+      timeline[numKept++] = sample;
+    }
+    timeline.resize(numKept);
+  }
+}
+
+std::vector<MemoryUsageSample> addMemoryTimelines(
+    const std::vector<MemoryUsageSample>& left,
+    const std::vector<MemoryUsageSample>& right,
+    int32_t maxSamples) {
+  std::vector<MemoryUsageSample> result;
+  result.reserve(left.size() + right.size());
+  int64_t leftBytes = 0;
+  int64_t rightBytes = 0;
+  auto leftIt = left.begin();
+  auto rightIt = right.begin();
+  while (leftIt != left.end() || rightIt != right.end()) {
+    uint64_t timeMs = std::min(
+        leftIt != left.end() ? leftIt->timeMs : UINT64_MAX,
+        rightIt != right.end() ? rightIt->timeMs : UINT64_MAX);
+    if (leftIt != left.end() && leftIt->timeMs == timeMs) {
+      leftBytes = (leftIt++)->bytes;
+    }
+    if (rightIt != right.end() && rightIt->timeMs == timeMs) {
+      rightBytes = (rightIt++)->bytes;
+    }
+    result.push_back({timeMs, leftBytes + rightBytes});
+  }
+  downsampleMemoryTimeline(result, maxSamples);
+  return result;
+}
+
+int64_t memoryUsageAt(
+    const std::vector<MemoryUsageSample>& timeline,
+    uint64_t timeMs) {
+  auto it = std::upper_bound(
+      timeline.begin(),
+      timeline.end(),
+      timeMs,
+      [](uint64_t time, const MemoryUsageSample& sample) {
+        return time < sample.timeMs;
+      });
+  return it == timeline.begin() ? 0 : std::prev(it)->bytes;
+}
+
+} // namespace facebook::velox::memory
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace facebook::velox::memory {
+
+struct MemoryUsageSample {
+  // Epoch time (ms) of the start of the interval of the sample.
+  uint64_t timeMs{0};
+  // The highest usage in the interval.
+  int64_t bytes{0};
+};
+
+// A bounded time series of the usage of a MemoryUsageTracker. A new
+// sample starts when 'intervalMs' has passed since the start of the last
+// one. Until then, the last sample keeps the highest usage recorded, so
+// that peaks are never lost. When 'maxSamples' samples are kept, adjacent
+// pairs are merged and the interval doubles, so that the series always
+// covers the whole lifetime of the tracker. Thread-safe.
+class MemoryTimeline {
+ public:
+  MemoryTimeline(uint64_t intervalMs, int32_t maxSamples);
+
+  void record(uint64_t timeMs, int64_t bytes);
+
+  std::vector<MemoryUsageSample> samples() const;
+
+ private:
+  mutable std::mutex mutex_;
+  uint64_t intervalMs_;
+  const int32_t maxSamples_;
+  std::vector<MemoryUsageSample> samples_;
+};
+
+// Merges adjacent pairs of samples of 'timeline', keeping the higher usage,
+// until at most 'maxSamples' remain.
+void downsampleMemoryTimeline(
+    std::vector<MemoryUsageSample>& timeline,
+    int32_t maxSamples);
+
+// Returns the timeline of the sum of the usages of 'left' and 'right',
+// downsampled to 'maxSamples'. The usage of a timeline at a time is that
+// of its last sample that starts at or before that time.
+std::vector<MemoryUsageSample> addMemoryTimelines(
+    const std::vector<MemoryUsageSample>& left,
+    const std::vector<MemoryUsageSample>& right,
+    int32_t maxSamples);
+
+// Returns the usage of 'timeline' at 'timeMs', 0 before the first sample.
+int64_t memoryUsageAt(
+    const std::vector<MemoryUsageSample>& timeline,
+    uint64_t timeMs);
+
+} // namespace facebook::velox::memory
@@ -16,6 +16,8 @@
 
 #include "velox/common/memory/MemoryUsageTracker.h"
 
+#include <chrono>
+
 namespace facebook::velox::memory {
 std::shared_ptr<MemoryUsageTracker> MemoryUsageTracker::create(
     const std::shared_ptr<MemoryUsageTracker>& parent,
@@ -56,9 +58,10 @@ void MemoryUsageTracker::updateInternal(UsageType type, int64_t size) {
   int64_t totalBytes = getCurrentUserBytes() + getCurrentSystemBytes();
 
   // Enforce the limit. Throw VeloxMemoryCapException exception if the limits
-  // are exceeded.
+  // are exceeded. A total cap under arbitration may first be raised.
   if (size > 0 &&
-      (newPeak > usage(maxMemory_, type) || totalBytes > total(maxMemory_))) {
+      (newPeak > usage(maxMemory_, type) ||
+       (totalBytes > total(maxMemory_) && !growTotal(totalBytes)))) {
     // Exceeded the limit. Fail allocation after reverting changes to
     // parent and currentUsageInBytes_.
     if (parent_) {
@@ -71,7 +74,19 @@ void MemoryUsageTracker::updateInternal(UsageType type, int64_t size) {
   }
 
   maySetMax(type, newPeak);
-  maySetMax(UsageType::kTotalMem, totalBytes);
+  const bool isTotalPeak = maySetMax(UsageType::kTotalMem, totalBytes);
+  if (isTotalPeak || timeline_) {
+    const uint64_t nowMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    if (isTotalPeak) {
+      peakTotalTimeMs_ = nowMs;
+    }
+    if (timeline_) {
+      timeline_->record(nowMs, totalBytes);
+    }
+  }
   checkNonNegativeSizes("after update");
 }
 
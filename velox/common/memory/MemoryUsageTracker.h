@@ -18,11 +18,13 @@
 
 #include <array>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <optional>
 
 #include "velox/common/base/BitUtil.h"
 #include "velox/common/base/Exceptions.h"
+#include "velox/common/memory/MemoryTimeline.h"
 
 namespace facebook::velox::memory {
 constexpr int64_t kMaxMemory = std::numeric_limits<int64_t>::max();
@@ -90,6 +92,13 @@ struct MemoryUsageConfigBuilder {
 class MemoryUsageTracker
     : public std::enable_shared_from_this<MemoryUsageTracker> {
  public:
+  // Called when an update would take the total usage of a tracker
+  // past its total cap. 'bytes' is the amount by which the cap would
+  // be exceeded. Returns true if the total cap of 'tracker' was raised
+  // to accommodate the update. See MemoryArbitrator.
+  using GrowCallback =
+      std::function<bool(MemoryUsageTracker& tracker, int64_t bytes)>;
+
   // Create default usage tracker. It aggregates both 'user' and 'system' memory
   // from its children and tracks the allocations as 'user' memory. It returns a
   // 'root' tracker.
@@ -214,6 +223,49 @@ class MemoryUsageTracker
     return user(maxMemory_);
   }
 
+  int64_t getMaxTotalBytes() const {
+    return total(maxMemory_);
+  }
+
+  // Changes the total cap. Lowering the cap below the current usage
+  // does not free anything but makes further allocations fail or
+  // grow the cap through the GrowCallback.
+  void setMaxTotalBytes(int64_t max) {
+    total(maxMemory_) = max;
+  }
+
+  // Sets the callback consulted before an update exceeding the total
+  // cap of 'this' fails. Must be set before 'this' is used for
+  // allocation.
+  void setGrowCallback(GrowCallback callback) {
+    growCallback_ = std::move(callback);
+  }
+
+  MemoryUsageTracker* parent() const {
+    return parent_.get();
+  }
+
+  // Starts recording the total usage of 'this' in a MemoryTimeline with
+  // 'maxSamples' samples of initially 'intervalMs' each. The usage is
+  // recorded when the reservation changes. Must be called before 'this' is
+  // used for allocation.
+  void enableTimeline(uint64_t intervalMs, int32_t maxSamples) {
+    timeline_ = std::make_unique<MemoryTimeline>(intervalMs, maxSamples);
+  }
+
+  // Returns the samples of the timeline, empty if not enabled.
+  std::vector<MemoryUsageSample> timeline() const {
+    if (!timeline_) {
+      return {};
+    }
+    return timeline_->samples();
+  }
+
+  // Epoch time (ms) when getPeakTotalBytes() was last raised.
+  uint64_t getPeakTotalTimeMs() const {
+    return peakTotalTimeMs_;
+  }
+
  private:
   static constexpr int64_t kMB = 1 << 20;
 
@@ -305,7 +357,9 @@ class MemoryUsageTracker
   UsageType type_;
   std::array<std::atomic<int64_t>, 2> currentUsageInBytes_{};
   std::array<std::atomic<int64_t>, 3> peakUsageInBytes_{};
-  std::array<int64_t, 3> maxMemory_;
+  // Caps for user, system and total memory. Atomic because the total
+  // cap can be changed by a MemoryArbitrator while 'this' is in use.
+  std::array<std::atomic<int64_t>, 3> maxMemory_;
   std::array<int64_t, 3> numAllocs_{};
   std::array<int64_t, 3> cumulativeBytes_{};
 
@@ -315,6 +369,11 @@ class MemoryUsageTracker
   int64_t minReservation_{0};
   std::atomic<int64_t> usedReservation_{};
 
+  GrowCallback growCallback_;
+
+  std::atomic<uint64_t> peakTotalTimeMs_{0};
+  std::unique_ptr<MemoryTimeline> timeline_;
+
   explicit MemoryUsageTracker(
       const std::shared_ptr<MemoryUsageTracker>& parent,
       UsageType type,
@@ -331,17 +390,28 @@ class MemoryUsageTracker
       UsageType type,
       const MemoryUsageConfig& config);
 
-  void maySetMax(UsageType type, int64_t newPeak) {
+  // Returns true if 'newPeak' raised the peak usage of 'type'.
+  bool maySetMax(UsageType type, int64_t newPeak) {
     auto& peakUsage = peakUsageInBytes_[static_cast<int>(type)];
     int64_t oldPeak = peakUsage;
-    while (oldPeak < newPeak &&
-           !peakUsage.compare_exchange_weak(oldPeak, newPeak)) {
-      oldPeak = peakUsage;
+    while (oldPeak < newPeak) {
+      if (peakUsage.compare_exchange_weak(oldPeak, newPeak)) {
+        return true;
+      }
     }
+    return false;
   }
 
   void updateInternal(UsageType type, int64_t size);
 
+  // Asks 'growCallback_' to raise the total cap so that 'totalBytes'
+  // fits. Returns true if the cap now accommodates 'totalBytes'.
+  bool growTotal(int64_t totalBytes) {
+    return growCallback_ &&
+        growCallback_(*this, totalBytes - total(maxMemory_)) &&
+        totalBytes <= total(maxMemory_);
+  }
+
   void checkNonNegativeSizes(const char* message) const {
     if (user(currentUsageInBytes_) < 0 || system(currentUsageInBytes_) < 0 ||
         total(currentUsageInBytes_) < 0) {
@@ -18,9 +18,58 @@
 #include "velox/common/base/BitUtil.h"
 
 #include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 namespace facebook::velox::memory {
 
+namespace {
+// Policy for mbind() that prefers a node but falls back to others when
+// the node is out of memory. Same as MPOL_PREFERRED in numaif.h.
+constexpr int kMpolPreferred = 1;
+
+// Returns the number of NUMA nodes of the host, 1 if this cannot be
+// determined.
+int32_t hostNumaNodes() {
+  int32_t numNodes = 0;
+  while (access(
+             fmt::format("/sys/devices/system/node/node{}", numNodes).c_str(),
+             F_OK) == 0) {
+    ++numNodes;
+  }
+  return std::max(1, numNodes);
+}
+
+// Binds the pages of ['address', 'address' + 'size') to 'node' when these
+// are first touched.
+void bindToNumaNode(void* address, size_t size, int32_t node) {
+#ifdef __linux__
+  uint64_t nodeMask = 1UL << node;
+  if (syscall(
+          SYS_mbind,
+          address,
+          size,
+          kMpolPreferred,
+          &nodeMask,
+          sizeof(nodeMask) * 8,
+          0) < 0) {
+    LOG(WARNING) << "mbind to NUMA node " << node << " failed with " << errno;
+  }
+#endif
+}
+
+// Advises the range at 'address' to be backed by transparent huge pages.
+void adviseHugePages(void* address, size_t size) {
+#ifdef MADV_HUGEPAGE
+  if (madvise(address, size, MADV_HUGEPAGE) < 0) {
+    LOG(WARNING) << "madvise for huge pages got errno " << errno;
+  }
+#endif
+}
+} // namespace
+
 MmapAllocator::MmapAllocator(const MmapAllocatorOptions& options)
     : MappedMemory(),
       numAllocated_(0),
@@ -28,10 +77,37 @@ MmapAllocator::MmapAllocator(const MmapAllocatorOptions& options)
 
       capacity_(bits::roundUp(
           options.capacity / kPageSize,
-          64 * sizeClassSizes_.back())) {
+          64 * sizeClassSizes_.back())),
+      useTransparentHugePages_(options.useTransparentHugePages),
+      useExplicitHugePages_(options.useExplicitHugePages),
+      threadCacheCapacity_(options.threadCacheBytes / kPageSize),
+      threadCaches_([this]() { return new ThreadCache(this); }) {
+  VELOX_CHECK_GE(options.numNumaNodes, 0);
+  VELOX_CHECK_LE(options.numNumaNodes, 64);
+  numNumaNodes_ = options.numNumaNodes == 0
+      ? std::min(hostNumaNodes(), 64)
+      : options.numNumaNodes;
   for (int size : sizeClassSizes_) {
-    sizeClasses_.push_back(std::make_unique<SizeClass>(capacity_ / size, size));
+    sizeClasses_.push_back(std::make_unique<SizeClass>(
+        capacity_ / size,
+        size,
+        numNumaNodes_,
+        useTransparentHugePages_ && size >= options.hugePageMinClassSize));
+  }
+}
+
+int32_t MmapAllocator::currentNumaNode() const {
+  if (numNumaNodes_ == 1) {
+    return -1;
+  }
+#ifdef __linux__
+  unsigned cpu;
+  unsigned node;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return node % numNumaNodes_;
   }
+#endif
+  return -1;
 }
 
 bool MmapAllocator::allocate(
@@ -45,6 +121,12 @@ bool MmapAllocator::allocate(
     numAllocated_.fetch_sub(numFreed);
   }
   auto mix = allocationSize(numPages, minSizeClass);
+  if (numCachedPages_ &&
+      numAllocated_ + numCachedPages_ + mix.totalPages > capacity_) {
+    // The cached pages are allocated in their size classes. Returns
+    // them so that the size classes have room.
+    flushThreadCaches();
+  }
   if (numAllocated_ + mix.totalPages > capacity_) {
     return false;
   }
@@ -63,9 +145,19 @@ bool MmapAllocator::allocate(
     }
   }
   MachinePageCount newMapsNeeded = 0;
+  auto numaNode = currentNumaNode();
+  ThreadCache* cache = threadCacheCapacity_ ? threadCaches_.get() : nullptr;
   for (int i = 0; i < mix.numSizes; ++i) {
+    ClassPageCount numClassPages = mix.sizeCounts[i];
+    if (cache) {
+      numClassPages -= takeFromThreadCache(
+          *cache, mix.sizeIndices[i], numClassPages, out);
+      if (!numClassPages) {
+        continue;
+      }
+    }
     if (!sizeClasses_[mix.sizeIndices[i]]->allocate(
-            mix.sizeCounts[i], owner, newMapsNeeded, out)) {
+            numClassPages, owner, newMapsNeeded, out, numaNode)) {
       // This does not normally happen since any size class can accommodate
       // all the capacity. 'allocatedPages_' must be out of sync.
       LOG(WARNING) << "Failed allocation in size class " << i << " for "
@@ -121,6 +213,9 @@ MachinePageCount MmapAllocator::freeInternal(Allocation& allocation) {
   if (allocation.numRuns() == 0) {
     return 0;
   }
+  if (threadCacheCapacity_) {
+    return freeToThreadCache(allocation);
+  }
   MachinePageCount numFreed = 0;
 
   for (auto& sizeClass : sizeClasses_) {
@@ -130,6 +225,89 @@ MachinePageCount MmapAllocator::freeInternal(Allocation& allocation) {
   return numFreed;
 }
 
+MachinePageCount MmapAllocator::freeToThreadCache(Allocation& allocation) {
+  auto& cache = *threadCaches_;
+  MachinePageCount numFreed = 0;
+  {
+    std::lock_guard<std::mutex> l(cache.mutex);
+    for (auto i = 0; i < allocation.numRuns(); ++i) {
+      auto run = allocation.runAt(i);
+      for (auto sizeIndex = 0; sizeIndex < sizeClasses_.size(); ++sizeIndex) {
+        auto& sizeClass = *sizeClasses_[sizeIndex];
+        if (!sizeClass.isInRange(run.data())) {
+          continue;
+        }
+        // A run may consist of consecutive pages of the size class.
+        const uint64_t unitBytes = sizeClass.unitSize() * kPageSize;
+        for (uint64_t offset = 0; offset < run.numBytes();
+             offset += unitBytes) {
+          cache.pages[sizeIndex].push_back(run.data() + offset);
+        }
+        numFreed += run.numPages();
+        break;
+      }
+    }
+    cache.numPages += numFreed;
+  }
+  numCachedPages_ += numFreed;
+  allocation.clear();
+  if (cache.numPages > threadCacheCapacity_) {
+    flushThreadCache(cache, threadCacheCapacity_ / 2);
+  }
+  return numFreed;
+}
+
+ClassPageCount MmapAllocator::takeFromThreadCache(
+    ThreadCache& cache,
+    int32_t sizeIndex,
+    ClassPageCount numPages,
+    Allocation& out) {
+  std::lock_guard<std::mutex> l(cache.mutex);
+  auto& pages = cache.pages[sizeIndex];
+  ClassPageCount numTaken =
+      std::min<ClassPageCount>(numPages, pages.size());
+  if (!numTaken) {
+    return 0;
+  }
+  auto unitSize = sizeClasses_[sizeIndex]->unitSize();
+  for (auto i = 0; i < numTaken; ++i) {
+    out.append(pages.back(), unitSize);
+    pages.pop_back();
+  }
+  cache.numPages -= numTaken * unitSize;
+  numCachedPages_ -= numTaken * unitSize;
+  return numTaken;
+}
+
+void MmapAllocator::flushThreadCache(
+    ThreadCache& cache,
+    MachinePageCount maxPages) {
+  std::lock_guard<std::mutex> l(cache.mutex);
+  for (int32_t sizeIndex = sizeClasses_.size() - 1;
+       sizeIndex >= 0 && cache.numPages > maxPages;
+       --sizeIndex) {
+    auto& pages = cache.pages[sizeIndex];
+    if (pages.empty()) {
+      continue;
+    }
+    auto& sizeClass = *sizeClasses_[sizeIndex];
+    Allocation allocation(this);
+    while (!pages.empty() && cache.numPages > maxPages) {
+      allocation.append(pages.back(), sizeClass.unitSize());
+      pages.pop_back();
+      cache.numPages -= sizeClass.unitSize();
+    }
+    numCachedPages_ -= sizeClass.free(allocation);
+    allocation.clear();
+  }
+}
+
+void MmapAllocator::flushThreadCaches() {
+  for (auto& cache : threadCaches_.accessAllThreads()) {
+    flushThreadCache(cache, 0);
+  }
+}
+
 bool MmapAllocator::allocateContiguous(
     MachinePageCount numPages,
     MmapAllocator::Allocation* FOLLY_NULLABLE collateral,
@@ -183,14 +361,32 @@ bool MmapAllocator::allocateContiguous(
     numMapped_ -= advised;
   }
   numExternalMapped_ += numPages - numLargeCollateralPages;
-  void* data = mmap(
-      nullptr,
-      numPages * kPageSize,
-      PROT_READ | PROT_WRITE,
-      MAP_PRIVATE | MAP_ANONYMOUS,
-      -1,
-      0);
-  allocation.reset(this, data, numPages * kPageSize);
+  auto numBytes = numPages * kPageSize;
+  void* data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (useExplicitHugePages_ && numBytes % kHugePageSize == 0) {
+    data = mmap(
+        nullptr,
+        numBytes,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+        -1,
+        0);
+  }
+#endif
+  if (data == MAP_FAILED) {
+    data = mmap(
+        nullptr,
+        numBytes,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (useTransparentHugePages_ && numBytes >= kHugePageSize) {
+      adviseHugePages(data, numBytes);
+    }
+  }
+  allocation.reset(this, data, numBytes);
   return true;
 }
 
@@ -223,10 +419,18 @@ MachinePageCount MmapAllocator::adviseAway(MachinePageCount target) {
   return numAway;
 }
 
-MmapAllocator::SizeClass::SizeClass(size_t capacity, MachinePageCount unitSize)
+MmapAllocator::SizeClass::SizeClass(
+    size_t capacity,
+    MachinePageCount unitSize,
+    int32_t numNumaNodes,
+    bool useHugePages)
     : capacity_(capacity),
       unitSize_(unitSize),
       byteSize_(capacity_ * unitSize_ * kPageSize),
+      numNumaNodes_(std::max<int32_t>(
+          1,
+          std::min<int32_t>(numNumaNodes, capacity_ / 64))),
+      nodeClockHands_(numNumaNodes_),
       pageAllocated_(capacity_ / 64),
       pageMapped_(capacity_ / 64) {
   VELOX_CHECK(
@@ -246,6 +450,18 @@ MmapAllocator::SizeClass::SizeClass(size_t capacity, MachinePageCount unitSize)
         errno);
   }
   address_ = reinterpret_cast<uint8_t*>(ptr);
+  if (useHugePages) {
+    adviseHugePages(address_, byteSize_);
+  }
+  if (numNumaNodes_ > 1) {
+    const auto wordBytes = 64 * unitSize_ * kPageSize;
+    for (auto node = 0; node < numNumaNodes_; ++node) {
+      auto begin = nodeBeginWord(node);
+      auto end = nodeBeginWord(node + 1);
+      bindToNumaNode(
+          address_ + begin * wordBytes, (end - begin) * wordBytes, node);
+    }
+  }
 }
 
 MmapAllocator::SizeClass::~SizeClass() {
@@ -301,59 +517,101 @@ bool MmapAllocator::SizeClass::allocate(
     ClassPageCount numPages,
     int32_t owner,
     MachinePageCount& numUnmapped,
-    MmapAllocator::Allocation& out) {
+    MmapAllocator::Allocation& out,
+    int32_t numaNode) {
   std::lock_guard<std::mutex> l(mutex_);
-  return allocateLocked(numPages, owner, &numUnmapped, out);
+  return allocateLocked(numPages, owner, &numUnmapped, out, numaNode);
 }
 
 bool MmapAllocator::SizeClass::allocateLocked(
     const ClassPageCount numPages,
     int32_t /* unused */,
     MachinePageCount* FOLLY_NULLABLE numUnmapped,
+    MmapAllocator::Allocation& out,
+    int32_t numaNode) {
+  auto numPagesToGo = numPages;
+  if (numaNode >= 0 && numNumaNodes_ > 1) {
+    // Memory local to the node of the caller is preferred, even if it
+    // needs to be backed, over memory already backed on another node.
+    numaNode %= numNumaNodes_;
+    allocateFromWords(
+        nodeBeginWord(numaNode),
+        nodeBeginWord(numaNode + 1),
+        nodeClockHands_[numaNode],
+        numPagesToGo,
+        numUnmapped,
+        out);
+    if (numPagesToGo == 0) {
+      return true;
+    }
+  }
+  allocateFromWords(
+      0, pageAllocated_.size(), clockHand_, numPagesToGo, numUnmapped, out);
+  return numPagesToGo == 0;
+}
+
+void MmapAllocator::SizeClass::allocateFromWords(
+    int32_t beginWord,
+    int32_t endWord,
+    int32_t& clockHand,
+    ClassPageCount& numPagesToGo,
+    MachinePageCount* FOLLY_NULLABLE numUnmapped,
     MmapAllocator::Allocation& out) {
-  size_t numWords = pageAllocated_.size();
-  uint32_t cursor = clockHand_ += 64;
-  if (clockHand_ > numWords) {
-    clockHand_ = clockHand_ % numWords;
+  const int32_t numWords = endWord - beginWord;
+  if (numWords <= 0) {
+    return;
+  }
+  uint32_t cursor = clockHand += 64;
+  if (clockHand > numWords) {
+    clockHand = clockHand % numWords;
   }
   cursor = cursor % numWords;
   int numWordsTried = 0;
-  int considerMappedOnly = std::min(numMappedFreePages_, numPages);
-  auto numPagesToGo = numPages;
+  int considerMappedOnly = std::min(numMappedFreePages_, numPagesToGo);
+  if (!considerMappedOnly && !numUnmapped) {
+    return;
+  }
   for (;;) {
     if (++cursor >= numWords) {
       cursor = 0;
     }
     if (++numWordsTried > numWords) {
-      return false;
+      if (considerMappedOnly <= 0 || !numUnmapped) {
+        return;
+      }
+      // The range has no more mapped free pages. Previously skipped
+      // words are again eligible.
+      considerMappedOnly = 0;
+      numWordsTried = 1;
     }
-    uint64_t bits = pageAllocated_[cursor];
+    const int32_t wordIndex = beginWord + cursor;
+    uint64_t bits = pageAllocated_[wordIndex];
     if (bits != kAllSet) {
       if (considerMappedOnly > 0) {
-        uint64_t mapped = pageMapped_[cursor];
+        uint64_t mapped = pageMapped_[wordIndex];
         uint64_t mappedFree = ~bits & mapped;
         if (!mappedFree) {
           continue;
         }
         int previousToGo = numPagesToGo;
-        allocateMapped(cursor, mappedFree, numPagesToGo, out);
+        allocateMapped(wordIndex, mappedFree, numPagesToGo, out);
         numAllocatedMapped_ += previousToGo - numPagesToGo;
         considerMappedOnly -= previousToGo - numPagesToGo;
         if (!considerMappedOnly && numPagesToGo) {
           // We move from allocating mapped to allocating
           // any. Previously skipped words are again eligible.
-          VELOX_CHECK(numUnmapped, "numUnmapped is not set");
-
+          if (!numUnmapped) {
+            return;
+          }
           numWordsTried = 0;
         }
       } else {
         int previousToGo = numPagesToGo;
-        assert(numUnmapped);
-        allocateAny(cursor, numPagesToGo, *numUnmapped, out);
+        allocateAny(wordIndex, numPagesToGo, *numUnmapped, out);
         numAllocatedUnmapped_ += previousToGo - numPagesToGo;
       }
       if (numPagesToGo == 0) {
-        return true;
+        return;
       }
     }
   }
@@ -528,10 +786,12 @@ bool MmapAllocator::checkConsistency() const {
     mappedCount += mapped * sizeClass->unitSize();
   }
   bool ok = true;
-  if (count != numAllocated_ - numExternalMapped_) {
+  // Pages in thread caches are allocated in their size classes.
+  if (count != numAllocated_ - numExternalMapped_ + numCachedPages_) {
     ok = false;
     LOG(WARNING) << "Allocated count out of sync. Actual= " << count
-                 << " recorded= " << numAllocated_ - numExternalMapped_;
+                 << " recorded= "
+                 << numAllocated_ - numExternalMapped_ + numCachedPages_;
   }
   if (mappedCount != numMapped_) {
     ok = false;
@@ -545,7 +805,14 @@ std::string MmapAllocator::toString() const {
   std::stringstream out;
   out << "[Memory capacity " << capacity_ << " free "
       << static_cast<int64_t>(capacity_ - numAllocated_) << " mapped "
-      << numMapped_ << std::endl;
+      << numMapped_;
+  if (numNumaNodes_ > 1) {
+    out << " NUMA nodes " << numNumaNodes_;
+  }
+  if (threadCacheCapacity_) {
+    out << " thread cached " << numCachedPages_;
+  }
+  out << std::endl;
   for (auto& sizeClass : sizeClasses_) {
     out << sizeClass->toString() << std::endl;
   }
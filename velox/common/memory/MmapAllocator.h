@@ -23,6 +23,8 @@
 #include <mutex>
 #include <unordered_set>
 
+#include <folly/ThreadLocal.h>
+
 #include "velox/common/base/BitUtil.h"
 #include "velox/common/memory/MappedMemory.h"
 
@@ -35,6 +37,32 @@ using ClassPageCount = int32_t;
 struct MmapAllocatorOptions {
   //  Capacity in bytes, default 512MB
   uint64_t capacity = 1L << 29;
+
+  // If true, the address ranges of size classes of at least
+  // 'hugePageMinClassSize' machine pages and contiguous allocations of
+  // at least a huge page are advised to be backed by transparent huge
+  // pages. This reduces TLB misses for large hash tables and row
+  // containers.
+  bool useTransparentHugePages = false;
+
+  MachinePageCount hugePageMinClassSize = 128;
+
+  // If true, contiguous allocations that are a multiple of the huge
+  // page size are first tried from the explicitly reserved huge pages
+  // of the host (MAP_HUGETLB). Falls back to regular pages if the
+  // reserve is exhausted.
+  bool useExplicitHugePages = false;
+
+  // Number of NUMA nodes between which the address range of each size
+  // class is divided. Each part is bound to its node, and allocations
+  // prefer the part of the node of the CPU of the allocating thread. 1
+  // disables NUMA awareness, 0 uses the number of nodes of the host.
+  int32_t numNumaNodes = 1;
+
+  // Bytes of freed size class pages each thread may keep for reuse by
+  // its next allocations. A thread cache over this is flushed back to
+  // the size classes down to half of this. 0 disables thread caches.
+  uint64_t threadCacheBytes = 0;
 };
 // Implementation of MappedMemory with mmap and madvise. Each size
 // class is mmapped for the whole capacity. Each size class has a
@@ -48,8 +76,17 @@ struct MmapAllocatorOptions {
 // we advise away enough pages from other size classes to cover for
 // it and then make a new mmap of the requested size
 // (ContiguousAllocation).
+//
+// With more than one NUMA node, the bitmaps of each size class are
+// divided into one range per node, each acting as a free list of
+// memory local to the node. An allocation first takes pages from the
+// range of the node of the calling thread and only then from the
+// other nodes.
 class MmapAllocator : public MappedMemory {
  public:
+  // Size of a huge page on x86_64 and the default on aarch64 Linux.
+  static constexpr uint64_t kHugePageSize = 2 << 20; // 2MB
+
   explicit MmapAllocator(const MmapAllocatorOptions& options);
 
   bool allocate(
@@ -87,6 +124,23 @@ class MmapAllocator : public MappedMemory {
     return numMapped_;
   }
 
+  int32_t numNumaNodes() const {
+    return numNumaNodes_;
+  }
+
+  // Returns the number of pages held in thread caches. These are
+  // allocated in their size classes but not counted in numAllocated().
+  MachinePageCount numCachedPages() const {
+    return numCachedPages_;
+  }
+
+  // Returns the pages in all thread caches to their size classes.
+  void flushThreadCaches();
+
+  // Returns the index of the NUMA node of the CPU of the calling thread
+  // in [0, numNumaNodes()), or -1 if 'this' is not NUMA aware.
+  int32_t currentNumaNode() const;
+
   std::string toString() const override;
 
  private:
@@ -96,7 +150,14 @@ class MmapAllocator : public MappedMemory {
   // 'unitSize_' machine pages.
   class SizeClass {
    public:
-    SizeClass(size_t capacity, MachinePageCount unitSize);
+    // Maps 'capacity' pages of 'unitSize' machine pages. The range is
+    // divided between 'numNumaNodes' nodes. If 'useHugePages' is true,
+    // the range is advised to be backed by transparent huge pages.
+    SizeClass(
+        size_t capacity,
+        MachinePageCount unitSize,
+        int32_t numNumaNodes = 1,
+        bool useHugePages = false);
 
     ~SizeClass();
 
@@ -106,12 +167,14 @@ class MmapAllocator : public MappedMemory {
 
     // Allocates 'numPages' from 'this' and appends these to
     // *out. '*numUnmapped' is incremented by the number of pages that
-    // are not backed by memory.
+    // are not backed by memory. Pages of the range of 'numaNode' are
+    // preferred if 'numaNode' is not -1.
     bool allocate(
         ClassPageCount numPages,
         int32_t owner,
         MachinePageCount& numUnmapped,
-        MappedMemory::Allocation& out);
+        MappedMemory::Allocation& out,
+        int32_t numaNode = -1);
 
     // Frees all pages of 'allocation' that fall in this size
     // class. Erases the corresponding runs from 'allocation'.
@@ -150,8 +213,28 @@ class MmapAllocator : public MappedMemory {
         ClassPageCount numPages,
         int32_t owner,
         MachinePageCount* FOLLY_NULLABLE numUnmapped,
+        MappedMemory::Allocation& out,
+        int32_t numaNode = -1);
+
+    // Allocates up to 'numPages' from the words in ['beginWord',
+    // 'endWord') of the bitmaps, first from pages backed by memory and
+    // then, if 'numUnmapped' is set, from any free pages. 'clockHand' is
+    // the sweep position of the range. 'numPages' is decremented by the
+    // count of allocated class pages.
+    void allocateFromWords(
+        int32_t beginWord,
+        int32_t endWord,
+        int32_t& clockHand,
+        ClassPageCount& numPages,
+        MachinePageCount* FOLLY_NULLABLE numUnmapped,
         MappedMemory::Allocation& out);
 
+    // Returns the first word of the bitmap range of 'numaNode'. The
+    // range ends at the first word of the next node.
+    int32_t nodeBeginWord(int32_t numaNode) const {
+      return pageAllocated_.size() * numaNode / numNumaNodes_;
+    }
+
     // Advises away the machine pages of 'this' size class contained in
     // 'allocation'.
     void adviseAway(const Allocation& allocation);
@@ -192,10 +275,17 @@ class MmapAllocator : public MappedMemory {
     // Size in bytes of the address range.
     const size_t byteSize_;
 
+    // Number of NUMA nodes between which the range is divided.
+    int32_t numNumaNodes_;
+
     // Index of last modified word in 'pageAllocated_'. Sweeps over
     // the bitmaps when looking for free pages.
     int32_t clockHand_ = 0;
 
+    // Sweep position in the range of each NUMA node, relative to the
+    // start of the range.
+    std::vector<int32_t> nodeClockHands_;
+
     // Count of free pages backed by memory.
     ClassPageCount numMappedFreePages_ = 0;
 
@@ -216,6 +306,54 @@ class MmapAllocator : public MappedMemory {
     uint64_t numAdvisedAway_ = 0;
   };
 
+  // Free size class pages kept by one thread. Allocation and free on
+  // the owning thread use these before going to the size classes,
+  // which are shared by all threads. The pages stay allocated and
+  // backed by memory in their size class.
+  struct ThreadCache {
+    explicit ThreadCache(MmapAllocator* FOLLY_NONNULL allocator)
+        : allocator(allocator) {}
+
+    // Returns the cached pages to the size classes at thread exit or
+    // when the allocator is destroyed.
+    ~ThreadCache() {
+      allocator->flushThreadCache(*this, 0);
+    }
+
+    MmapAllocator* FOLLY_NONNULL const allocator;
+
+    // Serializes the owning thread with flushes from other threads.
+    // Uncontended in the steady state.
+    std::mutex mutex;
+
+    // Start addresses of the cached pages of each size class.
+    std::array<std::vector<uint8_t*>, kMaxSizeClasses> pages;
+
+    // Total machine pages in 'pages'.
+    MachinePageCount numPages{0};
+  };
+
+  struct ThreadCacheTag {};
+
+  // Adds the runs of 'allocation' to the cache of the calling thread and
+  // flushes the cache if it exceeds its capacity. Returns the number of
+  // machine pages freed. Clears 'allocation'.
+  MachinePageCount freeToThreadCache(Allocation& allocation);
+
+  // Moves up to 'numPages' cached pages of the size class at
+  // 'sizeIndex' from 'cache' to 'out'. Returns the number of class pages
+  // moved.
+  ClassPageCount takeFromThreadCache(
+      ThreadCache& cache,
+      int32_t sizeIndex,
+      ClassPageCount numPages,
+      Allocation& out);
+
+  // Frees pages of 'cache' to their size classes until at most
+  // 'maxPages' machine pages are left. Larger size classes are flushed
+  // first.
+  void flushThreadCache(ThreadCache& cache, MachinePageCount maxPages);
+
   // Marks all the pages backing 'out' to be mapped if one can safely
   // write up to 'numMappedNeeded' pages that have no backing
   // memory. Returns true on success. Returns false if enough backed
@@ -253,6 +391,24 @@ class MmapAllocator : public MappedMemory {
 
   std::vector<std::unique_ptr<SizeClass>> sizeClasses_;
 
+  const bool useTransparentHugePages_;
+  const bool useExplicitHugePages_;
+
+  // Number of NUMA nodes the size classes are divided between. 1 if
+  // not NUMA aware.
+  int32_t numNumaNodes_{1};
+
+  // Capacity of each thread cache in machine pages. 0 if thread caches
+  // are disabled.
+  const MachinePageCount threadCacheCapacity_;
+
+  // Count of machine pages in all thread caches.
+  std::atomic<MachinePageCount> numCachedPages_{0};
+
+  // Declared after 'sizeClasses_' so that the caches are flushed before
+  // the size classes are destroyed.
+  folly::ThreadLocal<ThreadCache, ThreadCacheTag> threadCaches_;
+
   // Statistics. Not atomic.
   uint64_t numAllocations_ = 0;
   uint64_t numAllocatedPages_ = 0;
@@ -80,3 +80,36 @@ TEST(ArenaTest, writeString) {
   ASSERT_EQ(arena_fruits[2].find("pear"), 0);
   ASSERT_EQ(arena_fruits[3], "grape");
 }
+
+TEST(ArenaTest, memoryPool) {
+  auto pool = memory::getDefaultScopedMemoryPool();
+  constexpr int64_t kChunkSize = 64 << 10;
+  {
+    Arena arena(pool.get(), kChunkSize, kChunkSize);
+    EXPECT_EQ(kChunkSize, pool->getCurrentBytes());
+    auto numbers = arena.allocate<int64_t>(100);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(numbers) % alignof(int64_t));
+    arena.reserve(3);
+    // Allocations are aligned after an odd sized reserve.
+    numbers = arena.allocate<int64_t>(100);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(numbers) % alignof(int64_t));
+    arena.reserve(kChunkSize);
+    EXPECT_EQ(2 * kChunkSize, arena.allocatedBytes());
+    EXPECT_EQ(2 * kChunkSize, pool->getCurrentBytes());
+
+    // Clearing keeps the first chunk.
+    arena.clear();
+    EXPECT_EQ(kChunkSize, arena.allocatedBytes());
+    EXPECT_EQ(kChunkSize, pool->getCurrentBytes());
+
+    std::vector<int32_t, ArenaAllocator<int32_t>> values{
+        ArenaAllocator<int32_t>(&arena)};
+    for (auto i = 0; i < 1000; ++i) {
+      values.push_back(i);
+    }
+    for (auto i = 0; i < 1000; ++i) {
+      ASSERT_EQ(i, values[i]);
+    }
+  }
+  EXPECT_EQ(0, pool->getCurrentBytes());
+}
@@ -441,6 +441,98 @@ TEST_P(MappedMemoryTest, minSizeClass) {
   EXPECT_EQ(0, tracker->getCurrentUserBytes());
 }
 
+TEST(MmapAllocatorTest, numaAndHugePages) {
+  MmapAllocatorOptions options;
+  options.capacity = kMaxMappedMemory;
+  options.useTransparentHugePages = true;
+  options.useExplicitHugePages = true;
+  // The address ranges are divided between 2 nodes also on hosts with a
+  // single node. Binding to a missing node fails harmlessly.
+  options.numNumaNodes = 2;
+  MmapAllocator allocator(options);
+  EXPECT_EQ(2, allocator.numNumaNodes());
+  auto node = allocator.currentNumaNode();
+  EXPECT_LE(0, node);
+  EXPECT_GT(2, node);
+
+  // Takes more than half of the largest size class so that allocations
+  // continue in the range of the other node.
+  std::vector<std::unique_ptr<MappedMemory::Allocation>> allocations;
+  for (auto i = 0; i < 40; ++i) {
+    allocations.push_back(
+        std::make_unique<MappedMemory::Allocation>(&allocator));
+    ASSERT_TRUE(allocator.allocate(512 + i, 0, *allocations.back()));
+    auto& allocation = *allocations.back();
+    for (auto run = 0; run < allocation.numRuns(); ++run) {
+      memset(
+          allocation.runAt(run).data(),
+          i,
+          allocation.runAt(run).numPages() * MappedMemory::kPageSize);
+    }
+  }
+  EXPECT_TRUE(allocator.checkConsistency());
+
+  // A contiguous allocation of whole huge pages.
+  MappedMemory::ContiguousAllocation large;
+  ASSERT_TRUE(allocator.allocateContiguous(
+      MmapAllocator::kHugePageSize / MappedMemory::kPageSize, nullptr, large));
+  memset(large.data(), 1, large.size());
+  allocator.freeContiguous(large);
+
+  for (auto& allocation : allocations) {
+    allocator.free(*allocation);
+  }
+  EXPECT_TRUE(allocator.checkConsistency());
+  EXPECT_EQ(0, allocator.numAllocated());
+}
+
+TEST(MmapAllocatorTest, threadCache) {
+  MmapAllocatorOptions options;
+  options.capacity = kMaxMappedMemory;
+  options.threadCacheBytes = 8 << 20;
+  MmapAllocator allocator(options);
+  constexpr int32_t kNumPages = 300;
+  {
+    MappedMemory::Allocation allocation(&allocator);
+    ASSERT_TRUE(allocator.allocate(kNumPages, 0, allocation));
+    EXPECT_EQ(kNumPages, allocator.numAllocated());
+    allocator.free(allocation);
+    EXPECT_EQ(0, allocator.numAllocated());
+    EXPECT_EQ(kNumPages, allocator.numCachedPages());
+    EXPECT_TRUE(allocator.checkConsistency());
+
+    // The same size is allocated again from the cache.
+    ASSERT_TRUE(allocator.allocate(kNumPages, 0, allocation));
+    EXPECT_EQ(0, allocator.numCachedPages());
+    EXPECT_EQ(kNumPages, allocator.numAllocated());
+  }
+  EXPECT_EQ(kNumPages, allocator.numCachedPages());
+
+  // Freeing past the cache capacity flushes down to half of it.
+  std::vector<std::unique_ptr<MappedMemory::Allocation>> allocations;
+  for (auto i = 0; i < 16; ++i) {
+    allocations.push_back(
+        std::make_unique<MappedMemory::Allocation>(&allocator));
+    ASSERT_TRUE(allocator.allocate(256, 0, *allocations.back()));
+  }
+  allocations.clear();
+  EXPECT_GE(
+      options.threadCacheBytes / MappedMemory::kPageSize,
+      allocator.numCachedPages());
+  EXPECT_TRUE(allocator.checkConsistency());
+
+  // Caches of other threads are flushed when the capacity runs out.
+  std::thread([&]() {
+    MappedMemory::Allocation allocation(&allocator);
+    ASSERT_TRUE(allocator.allocate(kCapacity, 0, allocation));
+    EXPECT_EQ(0, allocator.numCachedPages());
+    allocator.free(allocation);
+  }).join();
+  allocator.flushThreadCaches();
+  EXPECT_EQ(0, allocator.numCachedPages());
+  EXPECT_TRUE(allocator.checkConsistency());
+}
+
 VELOX_INSTANTIATE_TEST_SUITE_P(
     MappedMemoryTests,
     MappedMemoryTest,
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "velox/common/memory/MemoryArbitrator.h"
+
+using namespace ::testing;
+using namespace ::facebook::velox::memory;
+using namespace ::facebook::velox;
+
+namespace {
+constexpr int64_t kMB = 1 << 20;
+
+// Frees the memory of 'tracker' when asked to reclaim.
+class TestReclaimer : public MemoryReclaimer {
+ public:
+  explicit TestReclaimer(std::shared_ptr<MemoryUsageTracker> tracker)
+      : tracker_(std::move(tracker)) {}
+
+  int64_t reclaim(int64_t /*targetBytes*/) override {
+    auto bytes = tracker_->getCurrentTotalBytes();
+    tracker_->update(-bytes);
+    ++numReclaims_;
+    return bytes;
+  }
+
+  int32_t numReclaims() const {
+    return numReclaims_;
+  }
+
+ private:
+  std::shared_ptr<MemoryUsageTracker> tracker_;
+  int32_t numReclaims_{0};
+};
+} // namespace
+
+TEST(MemoryArbitratorTest, growShrinkAndReclaim) {
+  MemoryArbitrator arbitrator(64 * kMB, 16 * kMB);
+  auto queryA = MemoryUsageTracker::create();
+  auto queryB = MemoryUsageTracker::create();
+  arbitrator.addQuery(queryA);
+  arbitrator.addQuery(queryB);
+  EXPECT_EQ(16 * kMB, queryA->getMaxTotalBytes());
+  EXPECT_EQ(32 * kMB, arbitrator.freeCapacity());
+  auto leafA = queryA->addChild();
+  auto leafB = queryB->addChild();
+  auto reclaimer = std::make_shared<TestReclaimer>(leafA);
+  arbitrator.addReclaimer(*leafA, reclaimer);
+
+  // Growing past the initial capacity takes from the free capacity.
+  leafA->update(24 * kMB);
+  EXPECT_EQ(24 * kMB, queryA->getMaxTotalBytes());
+  leafB->update(40 * kMB);
+  EXPECT_EQ(40 * kMB, queryB->getMaxTotalBytes());
+  EXPECT_EQ(0, arbitrator.freeCapacity());
+
+  // The capacity 'queryA' no longer uses is taken back for 'queryB'.
+  leafA->update(-24 * kMB);
+  leafB->update(8 * kMB);
+  EXPECT_EQ(0, queryA->getMaxTotalBytes());
+  EXPECT_EQ(48 * kMB, queryB->getMaxTotalBytes());
+  EXPECT_EQ(16 * kMB, arbitrator.freeCapacity());
+
+  // 'queryA' holds the rest of the capacity and has to free it.
+  leafA->update(16 * kMB);
+  EXPECT_EQ(0, arbitrator.freeCapacity());
+  leafB->update(16 * kMB);
+  EXPECT_EQ(1, reclaimer->numReclaims());
+  EXPECT_EQ(0, queryA->getCurrentTotalBytes());
+  EXPECT_EQ(64 * kMB, queryB->getMaxTotalBytes());
+
+  // Nothing is left to reclaim.
+  EXPECT_THROW(leafB->update(8 * kMB), VeloxRuntimeError);
+  auto stats = arbitrator.stats();
+  EXPECT_EQ(6, stats.numRequests);
+  EXPECT_EQ(1, stats.numFailures);
+  EXPECT_EQ(40 * kMB, stats.shrunkBytes);
+  EXPECT_EQ(16 * kMB, stats.reclaimedBytes);
+
+  arbitrator.removeReclaimer(reclaimer.get());
+  arbitrator.removeQuery(*queryA);
+  arbitrator.removeQuery(*queryB);
+  EXPECT_EQ(64 * kMB, arbitrator.freeCapacity());
+}
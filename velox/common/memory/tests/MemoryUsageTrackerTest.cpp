@@ -107,3 +107,59 @@ TEST(MemoryUsageTrackerTest, reserve) {
   child->release();
   EXPECT_EQ(0, parent->getCurrentTotalBytes());
 }
+
+TEST(MemoryUsageTrackerTest, timeline) {
+  constexpr int64_t kMB = 1 << 20;
+  auto parent = MemoryUsageTracker::create();
+  auto child = parent->addChild();
+  EXPECT_TRUE(child->timeline().empty());
+  // Each reservation change is in the single sample of the interval.
+  child->enableTimeline(1'000'000, 16);
+  child->update(1000);
+  child->update(3 * kMB);
+  child->update(-3 * kMB);
+  auto timeline = child->timeline();
+  ASSERT_EQ(1, timeline.size());
+  // The sample keeps the highest reservation.
+  EXPECT_EQ(4 * kMB, timeline[0].bytes);
+  EXPECT_GT(timeline[0].timeMs, 0);
+  EXPECT_GE(parent->getPeakTotalTimeMs(), timeline[0].timeMs);
+  EXPECT_EQ(4 * kMB, parent->getPeakTotalBytes());
+  EXPECT_TRUE(parent->timeline().empty());
+}
+
+TEST(MemoryUsageTrackerTest, timelineSamples) {
+  MemoryTimeline timeline(10, 4);
+  for (auto i = 0; i < 8; ++i) {
+    timeline.record(100 + i * 10, i % 2 ? 1 : 2);
+  }
+  // Full at 4, merged to 2 of 20ms, then filled up again.
+  auto samples = timeline.samples();
+  ASSERT_EQ(4, samples.size());
+  EXPECT_EQ(100, samples[0].timeMs);
+  EXPECT_EQ(2, samples[0].bytes);
+  EXPECT_EQ(120, samples[1].timeMs);
+  EXPECT_EQ(140, samples[2].timeMs);
+  EXPECT_EQ(160, samples[3].timeMs);
+  EXPECT_EQ(2, samples[3].bytes);
+
+  std::vector<MemoryUsageSample> left = {{10, 1}, {30, 5}};
+  std::vector<MemoryUsageSample> right = {{20, 2}, {30, 3}, {40, 0}};
+  auto sum = addMemoryTimelines(left, right, 100);
+  ASSERT_EQ(4, sum.size());
+  EXPECT_EQ(1, sum[0].bytes);
+  EXPECT_EQ(3, sum[1].bytes);
+  EXPECT_EQ(8, sum[2].bytes);
+  EXPECT_EQ(5, sum[3].bytes);
+  EXPECT_EQ(0, memoryUsageAt(sum, 5));
+  EXPECT_EQ(3, memoryUsageAt(sum, 25));
+  EXPECT_EQ(8, memoryUsageAt(sum, 30));
+  EXPECT_EQ(5, memoryUsageAt(sum, 1000));
+
+  downsampleMemoryTimeline(sum, 2);
+  ASSERT_EQ(2, sum.size());
+  EXPECT_EQ(10, sum[0].timeMs);
+  EXPECT_EQ(3, sum[0].bytes);
+  EXPECT_EQ(30, sum[1].timeMs);
+  EXPECT_EQ(8, sum[1].bytes);
+}
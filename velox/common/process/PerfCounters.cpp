@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/common/process/PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace facebook::velox::process {
+namespace {
+
+#ifdef __linux__
+// The counters of one thread. The first counter that opens is the group
+// leader. Reading the leader with PERF_FORMAT_GROUP returns all counters of
+// the group in the order they were opened.
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    for (auto i = 0; i < kNumPerfEvents; ++i) {
+      auto fd = open(static_cast<PerfEvent>(i));
+      if (fd < 0) {
+        continue;
+      }
+      if (leaderFd_ < 0) {
+        leaderFd_ = fd;
+      }
+      fds_[numOpen_] = fd;
+      events_[numOpen_++] = i;
+      available_ |= 1U << i;
+    }
+  }
+
+  ~ThreadCounters() {
+    for (auto i = 0; i < numOpen_; ++i) {
+      ::close(fds_[i]);
+    }
+  }
+
+  uint32_t available() const {
+    return available_;
+  }
+
+  bool read(PerfCounterValues& values) const {
+    if (leaderFd_ < 0) {
+      return false;
+    }
+    // The number of counters followed by their values.
+    uint64_t buffer[1 + kNumPerfEvents];
+    const ssize_t size = sizeof(uint64_t) * (1 + numOpen_);
+    if (::read(leaderFd_, buffer, size) != size ||
+        buffer[0] != static_cast<uint64_t>(numOpen_)) {
+      return false;
+    }
+    for (auto i = 0; i < numOpen_; ++i) {
+      values.values[events_[i]] = buffer[1 + i];
+    }
+    return true;
+  }
+
+ private:
+  int open(PerfEvent event) const {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (event) {
+      case PerfEvent::kCycles:
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+      case PerfEvent::kInstructions:
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+      case PerfEvent::kLlcMisses:
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+      case PerfEvent::kBranchMisses:
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    }
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Counts the calling thread on any CPU.
+    return syscall(
+        __NR_perf_event_open, &attr, 0, -1, leaderFd_, PERF_FLAG_FD_CLOEXEC);
+  }
+
+  int leaderFd_{-1};
+  int32_t numOpen_{0};
+  std::array<int, kNumPerfEvents> fds_{};
+  // The PerfEvent of each open counter in group order.
+  std::array<int32_t, kNumPerfEvents> events_{};
+  uint32_t available_{0};
+};
+
+const ThreadCounters& threadCounters() {
+  thread_local ThreadCounters counters;
+  return counters;
+}
+#endif
+} // namespace
+
+const char* perfEventName(PerfEvent event) {
+  switch (event) {
+    case PerfEvent::kCycles:
+      return "cycles";
+    case PerfEvent::kInstructions:
+      return "instructions";
+    case PerfEvent::kLlcMisses:
+      return "llcMisses";
+    case PerfEvent::kBranchMisses:
+      return "branchMisses";
+  }
+  return "unknown";
+}
+
+// static
+uint32_t PerfCounters::available() {
+#ifdef __linux__
+  return threadCounters().available();
+#else
+  return 0;
+#endif
+}
+
+// static
+bool PerfCounters::read(PerfCounterValues& values) {
+#ifdef __linux__
+  return threadCounters().read(values);
+#else
+  return false;
+#endif
+}
+
+} // namespace facebook::velox::process
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace facebook::velox::process {
+
+// Hardware events counted by PerfCounters.
+enum class PerfEvent {
+  kCycles,
+  kInstructions,
+  kLlcMisses,
+  kBranchMisses,
+};
+
+constexpr int32_t kNumPerfEvents =
+    static_cast<int32_t>(PerfEvent::kBranchMisses) + 1;
+
+// Name of 'event' for reporting, e.g. "cycles".
+const char* perfEventName(PerfEvent event);
+
+// Readings of the counters of the calling thread. The subscript is the
+// PerfEvent.
+struct PerfCounterValues {
+  std::array<uint64_t, kNumPerfEvents> values{};
+
+  uint64_t operator[](PerfEvent event) const {
+    return values[static_cast<int32_t>(event)];
+  }
+};
+
+// User space hardware counters of the calling thread from perf_event_open()
+// on Linux. The counters of a thread are opened as one group on first use and
+// stay open until the thread exits. Reading them is a system call, so this
+// is for opt-in profiling, not for always-on statistics.
+class PerfCounters {
+ public:
+  // Returns a bit mask with bit i set if PerfEvent i is counted for the
+  // calling thread. 0 if perf events are not supported or not permitted,
+  // e.g. by /proc/sys/kernel/perf_event_paranoid.
+  static uint32_t available();
+
+  // Reads the counters of the calling thread into 'values'. Returns false
+  // and leaves 'values' unchanged if no counter is available.
+  static bool read(PerfCounterValues& values);
+};
+
+} // namespace facebook::velox::process
@@ -17,16 +17,34 @@
 #include "velox/common/time/CpuWallTimer.h"
 
 namespace facebook::velox {
-CpuWallTimer::CpuWallTimer(CpuWallTiming& timing) : timing_(timing) {
+namespace {
+// Returns the number of operations that the next one of 'timing' stands
+// for, or 0 if it is not timed.
+uint32_t sampleWeight(const CpuWallTiming& timing, uint32_t sampleRate) {
+  if (sampleRate <= 1) {
+    return 1;
+  }
+  return timing.count % sampleRate == 0 ? sampleRate : 0;
+}
+} // namespace
+
+CpuWallTimer::CpuWallTimer(CpuWallTiming& timing, uint32_t sampleRate)
+    : timing_(timing), weight_(sampleWeight(timing, sampleRate)) {
   ++timing_.count;
+  if (!weight_) {
+    return;
+  }
   cpuTimeStart_ = process::threadCpuNanos();
   wallTimeStart_ = std::chrono::steady_clock::now();
 }
 
 CpuWallTimer::~CpuWallTimer() {
-  timing_.cpuNanos += process::threadCpuNanos() - cpuTimeStart_;
+  if (!weight_) {
+    return;
+  }
+  timing_.cpuNanos += (process::threadCpuNanos() - cpuTimeStart_) * weight_;
   auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
       std::chrono::steady_clock::now() - wallTimeStart_);
-  timing_.wallNanos += duration.count();
+  timing_.wallNanos += duration.count() * weight_;
 }
 } // namespace facebook::velox
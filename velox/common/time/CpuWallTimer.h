@@ -39,16 +39,21 @@ struct CpuWallTiming {
   }
 };
 
-// Adds elapsed CPU and wall time to an CpuWallTiming.
+// Adds elapsed CPU and wall time to an CpuWallTiming. With a 'sampleRate'
+// of N > 1, times only every Nth operation and adds N times its time, so
+// that the totals stay about right at a fraction of the cost. The count is
+// exact.
 class CpuWallTimer {
  public:
-  explicit CpuWallTimer(CpuWallTiming& timing);
+  explicit CpuWallTimer(CpuWallTiming& timing, uint32_t sampleRate = 1);
   ~CpuWallTimer();
 
  private:
   uint64_t cpuTimeStart_;
   std::chrono::steady_clock::time_point wallTimeStart_;
   CpuWallTiming& timing_;
+  // The number of operations the timed one stands for. 0 if not timed.
+  uint32_t weight_;
 };
 
 } // namespace facebook::velox
@@ -73,6 +73,53 @@ std::shared_ptr<Connector> getConnector(const std::string& connectorId) {
   return it->second;
 }
 
+void SplitPreload::run() {
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (started_) {
+      return;
+    }
+    started_ = true;
+  }
+  prepare();
+}
+
+void SplitPreload::prepare() {
+  std::shared_ptr<PreparedSplit> prepared;
+  std::exception_ptr error;
+  try {
+    prepared = make_();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  prepared_ = std::move(prepared);
+  error_ = std::move(error);
+  make_ = nullptr;
+  done_ = true;
+  finished_.notify_all();
+}
+
+std::shared_ptr<PreparedSplit> SplitPreload::get() {
+  bool runHere = false;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (!started_) {
+      started_ = true;
+      runHere = true;
+    }
+  }
+  if (runHere) {
+    prepare();
+  }
+  std::unique_lock<std::mutex> l(mutex_);
+  finished_.wait(l, [&]() { return done_; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  return prepared_;
+}
+
 folly::Synchronized<
     std::unordered_map<std::string_view, std::weak_ptr<cache::ScanTracker>>>
     Connector::trackers_;
@@ -20,10 +20,14 @@
 #include "velox/core/Context.h"
 #include "velox/vector/ComplexVector.h"
 
+#include <folly/Executor.h>
 #include <folly/Synchronized.h>
 
+#include <condition_variable>
+
 namespace facebook::velox::common {
 class Filter;
+class BigintTuplesUsingBloomFilter;
 }
 namespace facebook::velox::core {
 class ITypedExpr;
@@ -33,6 +37,43 @@ class ExprSet;
 }
 namespace facebook::velox::connector {
 
+// Connector specific state for a split that is prepared ahead of its turn,
+// e.g. an open file and its parsed footer.
+class PreparedSplit {
+ public:
+  virtual ~PreparedSplit() = default;
+};
+
+// Runs the preparation of a queued split on a background executor. If the
+// consumer gets to the split before the background task has started, the
+// preparation runs on the consumer thread instead, so a busy executor never
+// delays a split. An error in preparation is rethrown to the consumer.
+class SplitPreload {
+ public:
+  explicit SplitPreload(std::function<std::shared_ptr<PreparedSplit>()> make)
+      : make_(std::move(make)) {}
+
+  // Called from the executor. Prepares the split unless this is already
+  // started.
+  void run();
+
+  // Returns the prepared split. Runs the preparation if not started and
+  // waits if this is running on another thread.
+  std::shared_ptr<PreparedSplit> get();
+
+ private:
+  // Runs 'make_' outside of 'mutex_' and records the result.
+  void prepare();
+
+  std::mutex mutex_;
+  std::condition_variable finished_;
+  std::function<std::shared_ptr<PreparedSplit>()> make_;
+  bool started_{false};
+  bool done_{false};
+  std::shared_ptr<PreparedSplit> prepared_;
+  std::exception_ptr error_;
+};
+
 // A split represents a chunk of data that a connector should load and return
 // as a RowVectorPtr, potentially after processing pushdowns.
 struct ConnectorSplit {
@@ -42,6 +83,10 @@ struct ConnectorSplit {
   // async prefetch for the split.
   bool cancelled{false};
 
+  // Set if the split is being prepared in the background while it is
+  // queued. The DataSource the split is added to takes the result.
+  std::shared_ptr<SplitPreload> preload;
+
   explicit ConnectorSplit(const std::string& _connectorId)
       : connectorId(_connectorId) {}
 
@@ -50,6 +95,13 @@ struct ConnectorSplit {
   virtual std::string toString() const {
     return fmt::format("[split: {}]", connectorId);
   }
+
+  // Identifies the data of the split for caching results computed from it,
+  // e.g. by file, range and modification time. Empty if the data may change
+  // without changing the key, in which case nothing is cached.
+  virtual std::string cacheKey() const {
+    return "";
+  }
 };
 
 class ColumnHandle {
@@ -110,6 +162,13 @@ class DataSource {
       ChannelIndex outputChannel,
       const std::shared_ptr<common::Filter>& filter) = 0;
 
+  // Adds a dynamically generated filter on the columns at 'outputChannels'
+  // together. The filter is approximate, so a DataSource may ignore it.
+  virtual void addDynamicFilter(
+      const std::vector<ChannelIndex>& /*outputChannels*/,
+      const std::shared_ptr<common::BigintTuplesUsingBloomFilter>&
+      /*filter*/) {}
+
   // Returns the number of input bytes processed so far.
   virtual uint64_t getCompletedBytes() = 0;
 
@@ -128,6 +187,15 @@ class DataSource {
     return kUnknownRowSize;
   }
 
+  // Returns a function that prepares 'split' for a later addSplit() on a
+  // thread other than the one using 'this', or nullptr if the DataSource
+  // does not support preparing splits in advance. The function must not
+  // refer to mutable state of 'this'.
+  virtual std::function<std::shared_ptr<PreparedSplit>()> splitPreparer(
+      const std::shared_ptr<ConnectorSplit>& /*split*/) {
+    return nullptr;
+  }
+
   // TODO Allow DataSource to indicate that it is blocked (say waiting for IO)
   // to avoid holding up the thread.
 };
@@ -236,6 +304,12 @@ class Connector {
       std::shared_ptr<ConnectorInsertTableHandle> connectorInsertTableHandle,
       ConnectorQueryCtx* connectorQueryCtx) = 0;
 
+  // Returns the executor for background work of the connector, e.g.
+  // prefetch and preparing splits, or nullptr if there is none.
+  virtual folly::Executor* executor() const {
+    return nullptr;
+  }
+
   static std::shared_ptr<cache::ScanTracker> getTracker(
       const std::string& scanId);
 
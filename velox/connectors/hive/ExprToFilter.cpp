@@ -0,0 +1,705 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/connectors/hive/ExprToFilter.h"
+#include <algorithm>
+#include "velox/core/Expressions.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/SimpleVector.h"
+
+namespace facebook::velox::connector::hive {
+
+using common::Filter;
+using common::FilterKind;
+
+namespace {
+
+// The nulls and values of the column that pass a predicate. Several
+// predicates on an integer column combine into one of these before it
+// becomes a Filter, so that disjunctions and negations produce the simplest
+// Filter for the values that pass.
+struct IntegerSet {
+  // Sorted, disjoint, inclusive ranges of passing values.
+  std::vector<std::pair<int64_t, int64_t>> ranges;
+  bool nullAllowed{false};
+};
+
+using Ranges = std::vector<std::pair<int64_t, int64_t>>;
+
+constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+
+// Sorts 'ranges' and coalesces the overlapping and adjacent ranges.
+Ranges normalize(Ranges ranges) {
+  std::sort(ranges.begin(), ranges.end());
+  Ranges result;
+  for (const auto& range : ranges) {
+    if (!result.empty() &&
+        (result.back().second == kMax ||
+         range.first <= result.back().second + 1)) {
+      result.back().second = std::max(result.back().second, range.second);
+    } else {
+      result.push_back(range);
+    }
+  }
+  return result;
+}
+
+Ranges unite(const Ranges& left, const Ranges& right) {
+  Ranges all = left;
+  all.insert(all.end(), right.begin(), right.end());
+  return normalize(std::move(all));
+}
+
+Ranges intersect(const Ranges& left, const Ranges& right) {
+  Ranges result;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < left.size() && j < right.size()) {
+    auto lower = std::max(left[i].first, right[j].first);
+    auto upper = std::min(left[i].second, right[j].second);
+    if (lower <= upper) {
+      result.emplace_back(lower, upper);
+    }
+    if (left[i].second < right[j].second) {
+      ++i;
+    } else {
+      ++j;
+    }
+  }
+  return result;
+}
+
+// 'ranges' must be normalized.
+Ranges complement(const Ranges& ranges) {
+  Ranges result;
+  int64_t next = kMin;
+  for (const auto& [lower, upper] : ranges) {
+    if (lower > next) {
+      result.emplace_back(next, lower - 1);
+    }
+    if (upper == kMax) {
+      return result;
+    }
+    next = upper + 1;
+  }
+  result.emplace_back(next, kMax);
+  return result;
+}
+
+std::unique_ptr<Filter> nullOrFalse(bool nullAllowed) {
+  if (nullAllowed) {
+    return std::make_unique<common::IsNull>();
+  }
+  return std::make_unique<common::AlwaysFalse>();
+}
+
+std::unique_ptr<Filter> toFilter(const IntegerSet& set) {
+  const auto& ranges = set.ranges;
+  if (ranges.empty()) {
+    return nullOrFalse(set.nullAllowed);
+  }
+  if (ranges.size() == 1) {
+    if (ranges[0].first == kMin && ranges[0].second == kMax) {
+      if (set.nullAllowed) {
+        return std::make_unique<common::AlwaysTrue>();
+      }
+      return std::make_unique<common::IsNotNull>();
+    }
+    return std::make_unique<common::BigintRange>(
+        ranges[0].first, ranges[0].second, set.nullAllowed);
+  }
+  bool allSingleValues = std::all_of(
+      ranges.begin(), ranges.end(), [](const auto& range) {
+        return range.first == range.second;
+      });
+  if (allSingleValues) {
+    std::vector<int64_t> values;
+    values.reserve(ranges.size());
+    for (const auto& range : ranges) {
+      values.push_back(range.first);
+    }
+    return common::createBigintValues(values, set.nullAllowed);
+  }
+  std::vector<std::unique_ptr<common::BigintRange>> filters;
+  filters.reserve(ranges.size());
+  for (const auto& [lower, upper] : ranges) {
+    filters.push_back(
+        std::make_unique<common::BigintRange>(lower, upper, false));
+  }
+  return std::make_unique<common::BigintMultiRange>(
+      std::move(filters), set.nullAllowed);
+}
+
+// Returns the column if 'expr' is a top level column.
+const core::FieldAccessTypedExpr* asColumn(const core::ITypedExpr& expr) {
+  auto field = dynamic_cast<const core::FieldAccessTypedExpr*>(&expr);
+  if (!field) {
+    return nullptr;
+  }
+  if (field->inputs().empty() ||
+      dynamic_cast<const core::InputTypedExpr*>(field->inputs()[0].get())) {
+    return field;
+  }
+  return nullptr;
+}
+
+// Sets 'column' to the only column 'expr' refers to. Returns false if 'expr'
+// refers to more than one column or to a subfield.
+bool findColumn(
+    const core::ITypedExpr& expr,
+    const core::FieldAccessTypedExpr*& column) {
+  if (auto field = asColumn(expr)) {
+    if (column && column->name() != field->name()) {
+      return false;
+    }
+    column = field;
+    return true;
+  }
+  if (dynamic_cast<const core::FieldAccessTypedExpr*>(&expr)) {
+    return false;
+  }
+  for (const auto& input : expr.inputs()) {
+    if (!findColumn(*input, column)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <TypeKind kind>
+variant valueAt(const BaseVector& vector, vector_size_t index) {
+  using T = typename TypeTraits<kind>::NativeType;
+  if (vector.isNullAt(index)) {
+    return variant::null(kind);
+  }
+  auto value = vector.as<SimpleVector<T>>()->valueAt(index);
+  if constexpr (std::is_same_v<T, StringView>) {
+    return variant::create<kind>(std::string(value.data(), value.size()));
+  } else {
+    return variant::create<kind>(value);
+  }
+}
+
+std::optional<variant> scalarAt(const BaseVector& vector, vector_size_t index) {
+  if (!vector.type()->isPrimitiveType() ||
+      vector.typeKind() == TypeKind::UNKNOWN) {
+    return std::nullopt;
+  }
+  return VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+      valueAt, vector.typeKind(), vector, index);
+}
+
+// Returns the value of 'expr' if it is a scalar constant.
+std::optional<variant> toConstant(const core::ITypedExpr& expr) {
+  auto constant = dynamic_cast<const core::ConstantTypedExpr*>(&expr);
+  if (!constant) {
+    return std::nullopt;
+  }
+  if (constant->hasValueVector()) {
+    return scalarAt(*constant->valueVector(), 0);
+  }
+  return constant->value();
+}
+
+// A predicate on the column: a comparison with constants, in or is_null.
+struct Predicate {
+  // One of eq, lt, lte, gt, gte, between, in or is_null.
+  std::string name;
+  // The non-null constants the column is compared with.
+  std::vector<variant> values;
+  // True if the in list has a null.
+  bool hasNull{false};
+};
+
+std::optional<Predicate> toPredicate(
+    const core::CallTypedExpr& call,
+    bool& negated) {
+  static const std::unordered_map<std::string, std::string> kFlipped = {
+      {"eq", "eq"},
+      {"neq", "neq"},
+      {"lt", "gt"},
+      {"lte", "gte"},
+      {"gt", "lt"},
+      {"gte", "lte"}};
+
+  const auto& inputs = call.inputs();
+  Predicate predicate;
+  predicate.name = call.name();
+  if (kFlipped.count(call.name()) && inputs.size() == 2) {
+    auto value = toConstant(*inputs[1]);
+    if (!asColumn(*inputs[0])) {
+      predicate.name = kFlipped.at(call.name());
+      value = toConstant(*inputs[0]);
+      if (!asColumn(*inputs[1])) {
+        return std::nullopt;
+      }
+    }
+    if (!value.has_value() || value->isNull()) {
+      return std::nullopt;
+    }
+    predicate.values.push_back(std::move(value.value()));
+    if (predicate.name == "neq") {
+      predicate.name = "eq";
+      negated = !negated;
+    }
+    return predicate;
+  }
+  if (call.name() == "between" && inputs.size() == 3) {
+    auto lower = toConstant(*inputs[1]);
+    auto upper = toConstant(*inputs[2]);
+    if (!asColumn(*inputs[0]) || !lower.has_value() || lower->isNull() ||
+        !upper.has_value() || upper->isNull()) {
+      return std::nullopt;
+    }
+    predicate.values.push_back(std::move(lower.value()));
+    predicate.values.push_back(std::move(upper.value()));
+    return predicate;
+  }
+  if (call.name() == "in" && inputs.size() == 2) {
+    auto constant =
+        dynamic_cast<const core::ConstantTypedExpr*>(inputs[1].get());
+    if (!asColumn(*inputs[0]) || !constant) {
+      return std::nullopt;
+    }
+    auto addValue = [&](const variant& value) {
+      if (value.isNull()) {
+        predicate.hasNull = true;
+      } else {
+        predicate.values.push_back(value);
+      }
+    };
+    if (constant->hasValueVector()) {
+      const auto& valueVector = constant->valueVector();
+      auto array =
+          dynamic_cast<const ArrayVector*>(valueVector->wrappedVector());
+      if (!array) {
+        return std::nullopt;
+      }
+      auto index = valueVector->wrappedIndex(0);
+      auto offset = array->offsetAt(index);
+      for (auto i = offset; i < offset + array->sizeAt(index); ++i) {
+        auto value = scalarAt(*array->elements(), i);
+        if (!value.has_value()) {
+          return std::nullopt;
+        }
+        addValue(value.value());
+      }
+    } else if (constant->value().kind() == TypeKind::ARRAY) {
+      for (const auto& value : constant->value().array()) {
+        addValue(value);
+      }
+    } else {
+      return std::nullopt;
+    }
+    return predicate;
+  }
+  if (call.name() == "is_null" && inputs.size() == 1) {
+    if (!asColumn(*inputs[0])) {
+      return std::nullopt;
+    }
+    return predicate;
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> toInteger(const variant& value) {
+  switch (value.kind()) {
+    case TypeKind::TINYINT:
+      return value.value<TypeKind::TINYINT>();
+    case TypeKind::SMALLINT:
+      return value.value<TypeKind::SMALLINT>();
+    case TypeKind::INTEGER:
+      return value.value<TypeKind::INTEGER>();
+    case TypeKind::BIGINT:
+      return value.value<TypeKind::BIGINT>();
+    default:
+      return std::nullopt;
+  }
+}
+
+std::optional<IntegerSet> toIntegerSet(
+    const Predicate& predicate,
+    bool negated) {
+  if (predicate.name == "is_null") {
+    if (negated) {
+      return IntegerSet{{{kMin, kMax}}, false};
+    }
+    return IntegerSet{{}, true};
+  }
+
+  std::vector<int64_t> values;
+  for (const auto& value : predicate.values) {
+    auto integer = toInteger(value);
+    if (!integer.has_value()) {
+      return std::nullopt;
+    }
+    values.push_back(integer.value());
+  }
+
+  // Comparisons with a null column are null, so that nulls never pass,
+  // negated or not.
+  Ranges ranges;
+  if (predicate.name == "eq" || predicate.name == "in") {
+    if (negated && predicate.hasNull) {
+      // x NOT IN (..., NULL) is never true.
+      return IntegerSet{};
+    }
+    for (auto value : values) {
+      ranges.emplace_back(value, value);
+    }
+  } else if (predicate.name == "lt") {
+    if (values[0] != kMin) {
+      ranges.emplace_back(kMin, values[0] - 1);
+    }
+  } else if (predicate.name == "lte") {
+    ranges.emplace_back(kMin, values[0]);
+  } else if (predicate.name == "gt") {
+    if (values[0] != kMax) {
+      ranges.emplace_back(values[0] + 1, kMax);
+    }
+  } else if (predicate.name == "gte") {
+    ranges.emplace_back(values[0], kMax);
+  } else if (predicate.name == "between") {
+    if (values[0] <= values[1]) {
+      ranges.emplace_back(values[0], values[1]);
+    }
+  } else {
+    return std::nullopt;
+  }
+  ranges = normalize(std::move(ranges));
+  if (negated) {
+    ranges = complement(ranges);
+  }
+  return IntegerSet{std::move(ranges), false};
+}
+
+// Converts 'expr' to the values of the integer column that pass 'expr', or
+// of 'not expr' if 'negated' is true. A not is pushed down to the predicates
+// by De Morgan's laws. Since nulls pass no comparison, negated or not, this
+// gives the same result as evaluating 'expr' on a null.
+std::optional<IntegerSet> toIntegerSet(
+    const core::ITypedExpr& expr,
+    bool negated) {
+  auto call = dynamic_cast<const core::CallTypedExpr*>(&expr);
+  if (!call) {
+    return std::nullopt;
+  }
+  const auto& name = call->name();
+  if (name == "not" && call->inputs().size() == 1) {
+    return toIntegerSet(*call->inputs()[0], !negated);
+  }
+  if (name == "and" || name == "or") {
+    bool isOr = (name == "or") != negated;
+    std::optional<IntegerSet> result;
+    for (const auto& input : call->inputs()) {
+      auto set = toIntegerSet(*input, negated);
+      if (!set.has_value()) {
+        return std::nullopt;
+      }
+      if (!result.has_value()) {
+        result = std::move(set);
+      } else if (isOr) {
+        result->ranges = unite(result->ranges, set->ranges);
+        result->nullAllowed |= set->nullAllowed;
+      } else {
+        result->ranges = intersect(result->ranges, set->ranges);
+        result->nullAllowed &= set->nullAllowed;
+      }
+    }
+    return result;
+  }
+  auto predicate = toPredicate(*call, negated);
+  if (!predicate.has_value()) {
+    return std::nullopt;
+  }
+  return toIntegerSet(predicate.value(), negated);
+}
+
+// Returns the disjunction of 'filters' or nullptr if MultiRange does not
+// support the filters.
+std::unique_ptr<Filter> makeOr(std::vector<std::unique_ptr<Filter>> filters) {
+  bool nullAllowed = false;
+  bool allValuesPass = false;
+  std::vector<std::unique_ptr<Filter>> valueFilters;
+  for (auto& filter : filters) {
+    nullAllowed |= filter->testNull();
+    switch (filter->kind()) {
+      case FilterKind::kAlwaysTrue:
+      case FilterKind::kIsNotNull:
+        allValuesPass = true;
+        break;
+      case FilterKind::kAlwaysFalse:
+      case FilterKind::kIsNull:
+        break;
+      default:
+        valueFilters.push_back(std::move(filter));
+    }
+  }
+  if (allValuesPass) {
+    if (nullAllowed) {
+      return std::make_unique<common::AlwaysTrue>();
+    }
+    return std::make_unique<common::IsNotNull>();
+  }
+  if (valueFilters.empty()) {
+    return nullOrFalse(nullAllowed);
+  }
+  if (valueFilters.size() == 1) {
+    return valueFilters[0]->clone(nullAllowed);
+  }
+  for (auto& filter : valueFilters) {
+    switch (filter->kind()) {
+      case FilterKind::kBytesRange:
+      case FilterKind::kBytesValues:
+      case FilterKind::kDoubleRange:
+      case FilterKind::kFloatRange:
+      case FilterKind::kMultiRange:
+        filter = filter->clone(false);
+        break;
+      default:
+        return nullptr;
+    }
+  }
+  return std::make_unique<common::MultiRange>(
+      std::move(valueFilters), nullAllowed, false);
+}
+
+std::unique_ptr<Filter> bytesRange(
+    const std::optional<std::string>& lower,
+    bool lowerExclusive,
+    const std::optional<std::string>& upper,
+    bool upperExclusive) {
+  return std::make_unique<common::BytesRange>(
+      lower.value_or(""),
+      !lower.has_value(),
+      lower.has_value() && lowerExclusive,
+      upper.value_or(""),
+      !upper.has_value(),
+      upper.has_value() && upperExclusive,
+      false);
+}
+
+std::unique_ptr<Filter> toBytesFilter(
+    const Predicate& predicate,
+    bool negated) {
+  std::vector<std::string> values;
+  for (const auto& value : predicate.values) {
+    if (value.kind() != TypeKind::VARCHAR) {
+      return nullptr;
+    }
+    values.push_back(value.value<TypeKind::VARCHAR>());
+  }
+
+  const auto& name = predicate.name;
+  if (name == "eq" || name == "in") {
+    if (negated && predicate.hasNull) {
+      return std::make_unique<common::AlwaysFalse>();
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    if (values.empty()) {
+      // x IN (NULL) is never true.
+      return std::make_unique<common::AlwaysFalse>();
+    }
+    if (!negated) {
+      return std::make_unique<common::BytesValues>(values, false);
+    }
+    // The ranges between the values.
+    std::vector<std::unique_ptr<Filter>> ranges;
+    ranges.push_back(bytesRange(std::nullopt, false, values[0], true));
+    for (auto i = 1; i < values.size(); ++i) {
+      ranges.push_back(bytesRange(values[i - 1], true, values[i], true));
+    }
+    ranges.push_back(bytesRange(values.back(), true, std::nullopt, false));
+    return makeOr(std::move(ranges));
+  }
+  if (name == "between") {
+    if (negated) {
+      std::vector<std::unique_ptr<Filter>> ranges;
+      ranges.push_back(bytesRange(std::nullopt, false, values[0], true));
+      ranges.push_back(bytesRange(values[1], true, std::nullopt, false));
+      return makeOr(std::move(ranges));
+    }
+    if (values[0] > values[1]) {
+      return std::make_unique<common::AlwaysFalse>();
+    }
+    return bytesRange(values[0], false, values[1], false);
+  }
+  // not lt is gte, not lte is gt and so on.
+  bool isLess = (name == "lt" || name == "lte") != negated;
+  bool exclusive = (name == "lt" || name == "gt") != negated;
+  if (isLess) {
+    return bytesRange(std::nullopt, false, values[0], exclusive);
+  }
+  return bytesRange(values[0], exclusive, std::nullopt, false);
+}
+
+template <typename T>
+std::unique_ptr<Filter> floatingPointRange(
+    std::optional<T> lower,
+    bool lowerExclusive,
+    std::optional<T> upper,
+    bool upperExclusive) {
+  return std::make_unique<common::FloatingPointRange<T>>(
+      lower.value_or(0),
+      !lower.has_value(),
+      lower.has_value() && lowerExclusive,
+      upper.value_or(0),
+      !upper.has_value(),
+      upper.has_value() && upperExclusive,
+      false);
+}
+
+template <TypeKind kind>
+std::unique_ptr<Filter> toFloatingPointFilter(const Predicate& predicate) {
+  using T = typename TypeTraits<kind>::NativeType;
+  std::vector<T> values;
+  for (const auto& value : predicate.values) {
+    if (value.kind() != kind || std::isnan(value.value<kind>())) {
+      return nullptr;
+    }
+    values.push_back(value.value<kind>());
+  }
+
+  const auto& name = predicate.name;
+  if (name == "eq" || name == "in") {
+    std::vector<std::unique_ptr<Filter>> points;
+    for (auto value : values) {
+      points.push_back(floatingPointRange<T>(value, false, value, false));
+    }
+    return makeOr(std::move(points));
+  }
+  if (name == "between") {
+    if (values[0] > values[1]) {
+      return std::make_unique<common::AlwaysFalse>();
+    }
+    return floatingPointRange<T>(values[0], false, values[1], false);
+  }
+  if (name == "lt" || name == "lte") {
+    return floatingPointRange<T>(std::nullopt, false, values[0], name == "lt");
+  }
+  return floatingPointRange<T>(values[0], name == "gt", std::nullopt, false);
+}
+
+std::unique_ptr<Filter> toFilter(
+    const Predicate& predicate,
+    bool negated,
+    const Type& type) {
+  if (predicate.name == "is_null") {
+    if (negated) {
+      return std::make_unique<common::IsNotNull>();
+    }
+    return std::make_unique<common::IsNull>();
+  }
+  switch (type.kind()) {
+    case TypeKind::VARCHAR:
+      return toBytesFilter(predicate, negated);
+    case TypeKind::REAL:
+      return negated ? nullptr
+                     : toFloatingPointFilter<TypeKind::REAL>(predicate);
+    case TypeKind::DOUBLE:
+      return negated ? nullptr
+                     : toFloatingPointFilter<TypeKind::DOUBLE>(predicate);
+    case TypeKind::BOOLEAN:
+      if (predicate.name != "eq" ||
+          predicate.values[0].kind() != TypeKind::BOOLEAN) {
+        return nullptr;
+      }
+      return std::make_unique<common::BoolValue>(
+          predicate.values[0].value<TypeKind::BOOLEAN>() != negated, false);
+    default:
+      return nullptr;
+  }
+}
+
+// Converts 'expr', or 'not expr' if 'negated' is true, to a Filter on a
+// column of 'type'. Used for all but integer columns.
+std::unique_ptr<Filter>
+toFilter(const core::ITypedExpr& expr, bool negated, const Type& type) {
+  auto call = dynamic_cast<const core::CallTypedExpr*>(&expr);
+  if (!call) {
+    return nullptr;
+  }
+  const auto& name = call->name();
+  if (name == "not" && call->inputs().size() == 1) {
+    return toFilter(*call->inputs()[0], !negated, type);
+  }
+  if (name == "and" || name == "or") {
+    bool isOr = (name == "or") != negated;
+    std::vector<std::unique_ptr<Filter>> filters;
+    for (const auto& input : call->inputs()) {
+      auto filter = toFilter(*input, negated, type);
+      if (!filter) {
+        return nullptr;
+      }
+      filters.push_back(std::move(filter));
+    }
+    if (isOr) {
+      return makeOr(std::move(filters));
+    }
+    auto result = std::move(filters[0]);
+    for (auto i = 1; i < filters.size() && result; ++i) {
+      result = mergeFilters(*result, *filters[i]);
+    }
+    return result;
+  }
+  auto predicate = toPredicate(*call, negated);
+  if (!predicate.has_value()) {
+    return nullptr;
+  }
+  return toFilter(predicate.value(), negated, type);
+}
+
+bool isFloatingPointRange(const Filter& filter) {
+  return filter.kind() == FilterKind::kDoubleRange ||
+      filter.kind() == FilterKind::kFloatRange;
+}
+} // namespace
+
+std::unique_ptr<Filter> exprToFilter(
+    const core::ITypedExpr& expr,
+    std::string& column) {
+  const core::FieldAccessTypedExpr* field = nullptr;
+  if (!findColumn(expr, field) || !field) {
+    return nullptr;
+  }
+  column = field->name();
+  switch (field->type()->kind()) {
+    case TypeKind::TINYINT:
+    case TypeKind::SMALLINT:
+    case TypeKind::INTEGER:
+    case TypeKind::BIGINT: {
+      auto set = toIntegerSet(expr, false);
+      if (!set.has_value()) {
+        return nullptr;
+      }
+      return toFilter(set.value());
+    }
+    default:
+      return toFilter(expr, false, *field->type());
+  }
+}
+
+std::unique_ptr<Filter> mergeFilters(const Filter& left, const Filter& right) {
+  // MultiRange does not merge with a range of floating point values.
+  if ((left.kind() == FilterKind::kMultiRange && isFloatingPointRange(right)) ||
+      (right.kind() == FilterKind::kMultiRange && isFloatingPointRange(left))) {
+    return nullptr;
+  }
+  return left.mergeWith(&right);
+}
+
+} // namespace facebook::velox::connector::hive
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/core/ITypedExpr.h"
+#include "velox/type/Filter.h"
+
+namespace facebook::velox::connector::hive {
+
+// Converts 'expr' to a Filter on a single top level column, so that the
+// predicate can be evaluated by the column reader while decoding. 'expr' may
+// be a tree of and, or and not over comparisons of the column with constants,
+// between, in and is_null, all on the same column. Sets 'column' to the name
+// of the column. Returns nullptr if 'expr' is not convertible.
+//
+// Integer and varchar columns support all these forms. Real and double
+// columns support them only outside of a not, since a negated comparison
+// passes NaN, which the range Filters do not. Boolean columns support
+// equality. Other columns support is_null only.
+std::unique_ptr<common::Filter> exprToFilter(
+    const core::ITypedExpr& expr,
+    std::string& column);
+
+// Returns the conjunction of 'left' and 'right', two Filters on the same
+// column, or nullptr if Filter::mergeWith() does not support the
+// combination.
+std::unique_ptr<common::Filter> mergeFilters(
+    const common::Filter& left,
+    const common::Filter& right);
+
+} // namespace facebook::velox::connector::hive
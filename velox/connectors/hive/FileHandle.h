@@ -21,7 +21,7 @@
 //
 // The FileHandle will normally be used in conjunction with a CachedFactory
 // to speed up queries that hit the same files repeatedly; see the
-// FileHandleCache and FileHandleFactory.
+// FileHandleFactory.
 
 #pragma once
 
@@ -58,14 +58,14 @@ struct FileHandle {
   // first diff we'll not include the map.
 };
 
-// Estimates the memory usage of a FileHandle object.
+// Sizes a FileHandle in the cache as 1 since each open file may hold a
+// file descriptor. The cache is thus limited by the number of open files.
 struct FileHandleSizer {
   uint64_t operator()(const FileHandle& a);
 };
 
-using FileHandleCache = SimpleLRUCache<std::string, FileHandle>;
-
-// Creates FileHandles via the Generator interface the CachedFactory requires.
+// Creates FileHandles via the Generator interface the CachedFactory
+// requires.
 class FileHandleGenerator {
  public:
   FileHandleGenerator() {}
@@ -77,7 +77,9 @@ class FileHandleGenerator {
   const std::shared_ptr<const Config> properties_;
 };
 
-using FileHandleFactory = CachedFactory<
+// Sharded by the path so that concurrent opens of different files do
+// not serialize on one mutex.
+using FileHandleFactory = ShardedCachedFactory<
     std::string,
     FileHandle,
     FileHandleGenerator,
@@ -15,21 +15,32 @@
  */
 #include "velox/connectors/hive/HiveConnector.h"
 #include <velox/dwio/dwrf/reader/SelectiveColumnReader.h>
+#include "velox/connectors/hive/ExprToFilter.h"
 #include "velox/dwio/common/InputStream.h"
 #include "velox/dwio/common/ScanSpec.h"
 #include "velox/dwio/dwrf/common/CachedBufferedInput.h"
+#include "velox/dwio/dwrf/common/MappedBufferedInput.h"
 #include "velox/expression/ControlExpr.h"
 #include "velox/type/Conversions.h"
 #include "velox/type/Type.h"
 #include "velox/type/Variant.h"
 
+#include <fmt/format.h>
+#include <folly/Random.h>
+#include <folly/String.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <numeric>
+
 using namespace facebook::velox::dwrf;
 using WriterConfig = facebook::velox::dwrf::Config;
 
 DEFINE_int32(
-    file_handle_cache_mb,
-    1024,
-    "Amount of space for the file handle cache in mb.");
+    file_handle_cache_max_open_files,
+    0,
+    "Maximum number of cached open files. 0 means half the limit of open "
+    "files of the process.");
 
 namespace facebook::velox::connector::hive {
 namespace {
@@ -37,30 +48,241 @@ static const char* kPath = "$path";
 static const char* kBucket = "$bucket";
 } // namespace
 
+namespace {
+// Creates the directories of 'path' that do not exist. Only local paths have
+// directories to create.
+void makeDirectories(const std::string& path) {
+  if (path.empty() || path[0] != '/') {
+    return;
+  }
+  for (auto slash = path.find('/', 1); slash != std::string::npos;
+       slash = path.find('/', slash + 1)) {
+    auto directory = path.substr(0, slash);
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+      VELOX_FAIL("Cannot create directory {}: {}", directory, strerror(errno));
+    }
+  }
+}
+} // namespace
+
 HiveDataSink::HiveDataSink(
     std::shared_ptr<const RowType> inputType,
-    const std::string& filePath,
+    std::shared_ptr<const HiveInsertTableHandle> insertTableHandle,
     velox::memory::MemoryPool* memoryPool)
-    : inputType_(inputType) {
+    : inputType_(std::move(inputType)),
+      insertTableHandle_(std::move(insertTableHandle)),
+      pool_(memoryPool),
+      sinkId_(folly::Random::rand64()) {
+  if (!insertTableHandle_->writesDirectory()) {
+    dwio::common::DataSink* sink;
+    writer_ = createWriter(
+        insertTableHandle_->filePath(),
+        std::numeric_limits<int64_t>::max(),
+        sink);
+    filePaths_.push_back(insertTableHandle_->filePath());
+    return;
+  }
+
+  const auto& partitionedBy = insertTableHandle_->partitionedBy();
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  for (auto i = 0; i < inputType_->size(); ++i) {
+    const auto& name = inputType_->nameOf(i);
+    if (std::find(partitionedBy.begin(), partitionedBy.end(), name) !=
+        partitionedBy.end()) {
+      continue;
+    }
+    dataChannels_.push_back(i);
+    names.push_back(name);
+    types.push_back(inputType_->childAt(i));
+  }
+  for (const auto& name : partitionedBy) {
+    auto channel = inputType_->getChildIdx(name);
+    VELOX_CHECK(
+        inputType_->childAt(channel)->isPrimitiveType(),
+        "Partition column {} must be of a primitive type",
+        name);
+    partitionChannels_.push_back(channel);
+  }
+  VELOX_CHECK(!dataChannels_.empty(), "Hive write has no data columns");
+  dataType_ = ROW(std::move(names), std::move(types));
+  decodedPartitionKeys_.resize(partitionChannels_.size());
+
+  if (const auto& bucketProperty = insertTableHandle_->bucketProperty()) {
+    std::vector<ChannelIndex> bucketChannels;
+    for (const auto& name : bucketProperty->bucketedBy) {
+      bucketChannels.push_back(inputType_->getChildIdx(name));
+    }
+    std::vector<int> bucketToPartition(bucketProperty->numBuckets);
+    std::iota(bucketToPartition.begin(), bucketToPartition.end(), 0);
+    bucketFunction_ = std::make_unique<HivePartitionFunction>(
+        bucketProperty->numBuckets,
+        std::move(bucketToPartition),
+        std::move(bucketChannels));
+  }
+}
+
+std::unique_ptr<Writer> HiveDataSink::createWriter(
+    const std::string& path,
+    int64_t memoryBudget,
+    dwio::common::DataSink*& sink) {
   auto config = std::make_shared<WriterConfig>();
   // TODO: Wire up serde properties to writer configs.
 
   facebook::velox::dwrf::WriterOptions options;
   options.config = config;
-  options.schema = inputType;
+  options.schema = dataType_ ? dataType_ : inputType_;
+  options.memoryBudget = memoryBudget;
   // Without explicitly setting flush policy, the default memory based flush
   // policy is used.
 
-  auto sink = facebook::velox::dwio::common::DataSink::create(filePath);
-  writer_ = std::make_unique<Writer>(options, std::move(sink), *memoryPool);
+  auto dataSink = facebook::velox::dwio::common::DataSink::create(path);
+  sink = dataSink.get();
+  return std::make_unique<Writer>(options, std::move(dataSink), *pool_);
 }
 
 void HiveDataSink::appendData(VectorPtr input) {
-  writer_->write(input);
+  if (writer_) {
+    writer_->write(input);
+    return;
+  }
+  auto rowInput = std::dynamic_pointer_cast<RowVector>(input);
+  VELOX_CHECK_NOT_NULL(rowInput, "Hive write expects a RowVector");
+  computeWriterIds(*rowInput);
+  writerRows_.resize(writers_.size());
+  for (auto& rows : writerRows_) {
+    rows.clear();
+  }
+  for (auto row = 0; row < rowInput->size(); ++row) {
+    writerRows_[writerIds_[row]].push_back(row);
+  }
+  for (auto i = 0; i < writers_.size(); ++i) {
+    if (!writerRows_[i].empty()) {
+      write(*writers_[i], *rowInput, writerRows_[i]);
+    }
+  }
+}
+
+void HiveDataSink::computeWriterIds(const RowVector& input) {
+  auto numRows = input.size();
+  if (bucketFunction_) {
+    bucketFunction_->partition(input, buckets_);
+  } else {
+    buckets_.assign(numRows, 0);
+  }
+  rows_.resize(numRows);
+  rows_.setAll();
+  for (auto i = 0; i < partitionChannels_.size(); ++i) {
+    decodedPartitionKeys_[i].decode(
+        *input.childAt(partitionChannels_[i]), rows_);
+  }
+
+  writerIds_.resize(numRows);
+  for (auto row = 0; row < numRows; ++row) {
+    // The key is the partition directory followed by the bucket.
+    key_.clear();
+    for (auto i = 0; i < partitionChannels_.size(); ++i) {
+      auto& decoded = decodedPartitionKeys_[i];
+      key_ += inputType_->nameOf(partitionChannels_[i]);
+      key_ += '=';
+      if (decoded.isNullAt(row)) {
+        key_ += kDefaultPartitionValue;
+      } else {
+        key_ += decoded.base()->toString(decoded.index(row));
+      }
+      key_ += '/';
+    }
+    auto directoryLength = key_.size();
+    key_ += std::to_string(buckets_[row]);
+    auto it = writerIndex_.find(key_);
+    if (it != writerIndex_.end()) {
+      writerIds_[row] = it->second;
+      continue;
+    }
+    auto writer = std::make_unique<PartitionWriter>();
+    writer->directory = insertTableHandle_->location() + "/" +
+        key_.substr(0, directoryLength);
+    writer->bucket = buckets_[row];
+    writerIds_[row] = writers_.size();
+    writerIndex_[key_] = writers_.size();
+    writers_.push_back(std::move(writer));
+  }
+}
+
+void HiveDataSink::write(
+    PartitionWriter& writer,
+    const RowVector& input,
+    const std::vector<vector_size_t>& rows) {
+  auto maxOpenWriters = insertTableHandle_->maxOpenWriters();
+  if (!writer.writer) {
+    if (numOpenWriters_ == maxOpenWriters) {
+      // Closes the least recently written file. A later row of its partition
+      // and bucket starts the next file.
+      PartitionWriter* oldest = nullptr;
+      for (auto& other : writers_) {
+        if (other->writer &&
+            (!oldest || other->lastWrite < oldest->lastWrite)) {
+          oldest = other.get();
+        }
+      }
+      closeFile(*oldest);
+    }
+    auto path = fmt::format(
+        "{}{:06d}_{}_{:016x}",
+        writer.directory,
+        writer.bucket,
+        writer.numClosedFiles,
+        sinkId_);
+    makeDirectories(path);
+    writer.writer = createWriter(
+        path,
+        insertTableHandle_->writerMemoryBudget() / maxOpenWriters,
+        writer.sink);
+    filePaths_.push_back(path);
+    ++numOpenWriters_;
+  }
+
+  auto numRows = rows.size();
+  auto indices = allocateIndices(numRows, pool_);
+  std::copy(rows.begin(), rows.end(), indices->asMutable<vector_size_t>());
+  std::vector<VectorPtr> children;
+  children.reserve(dataChannels_.size());
+  for (auto channel : dataChannels_) {
+    children.push_back(BaseVector::wrapInDictionary(
+        nullptr, indices, numRows, input.childAt(channel)));
+  }
+  writer.writer->write(std::make_shared<RowVector>(
+      pool_, dataType_, nullptr, numRows, std::move(children)));
+  writer.lastWrite = ++numWrites_;
+
+  auto targetFileSize = insertTableHandle_->targetFileSize();
+  if (targetFileSize > 0 && writer.sink->size() >= targetFileSize) {
+    closeFile(writer);
+  }
+}
+
+void HiveDataSink::closeFile(PartitionWriter& writer) {
+  writer.writer->close();
+  writer.writer.reset();
+  writer.sink = nullptr;
+  ++writer.numClosedFiles;
+  --numOpenWriters_;
 }
 
 void HiveDataSink::close() {
-  writer_->close();
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  if (writer_) {
+    writer_->close();
+    return;
+  }
+  for (auto& writer : writers_) {
+    if (writer->writer) {
+      closeFile(*writer);
+    }
+  }
 }
 
 namespace {
@@ -109,6 +331,65 @@ std::unique_ptr<common::ScanSpec> makeScanSpec(
   }
   return spec;
 }
+
+void flattenConjuncts(
+    const std::shared_ptr<const core::ITypedExpr>& expr,
+    std::vector<std::shared_ptr<const core::ITypedExpr>>& conjuncts) {
+  auto call = dynamic_cast<const core::CallTypedExpr*>(expr.get());
+  if (call && call->name() == "and") {
+    for (const auto& input : call->inputs()) {
+      flattenConjuncts(input, conjuncts);
+    }
+  } else {
+    conjuncts.push_back(expr);
+  }
+}
+
+// Moves the conjuncts of 'filter' that convert to a Filter on a single column
+// to 'scanSpec', so that the column reader evaluates them while decoding and
+// the rows that do not pass are never materialized. 'excludedColumns' are
+// the partition keys and synthesized columns, which are constant and cannot
+// have filters. Returns the conjunction of the other conjuncts or nullptr if
+// there are none.
+std::shared_ptr<const core::ITypedExpr> extractFiltersFromRemainingFilter(
+    const std::shared_ptr<const core::ITypedExpr>& filter,
+    const std::unordered_set<std::string>& excludedColumns,
+    common::ScanSpec& scanSpec) {
+  std::vector<std::shared_ptr<const core::ITypedExpr>> conjuncts;
+  flattenConjuncts(filter, conjuncts);
+
+  std::vector<std::shared_ptr<const core::ITypedExpr>> remaining;
+  for (const auto& conjunct : conjuncts) {
+    std::string column;
+    auto columnFilter = exprToFilter(*conjunct, column);
+    if (!columnFilter || column == kPath || column == kBucket ||
+        excludedColumns.count(column)) {
+      remaining.push_back(conjunct);
+      continue;
+    }
+    if (columnFilter->kind() == common::FilterKind::kAlwaysTrue) {
+      continue;
+    }
+    auto fieldSpec = scanSpec.getOrCreateChild(common::Subfield(column));
+    if (fieldSpec->filter()) {
+      columnFilter = mergeFilters(*fieldSpec->filter(), *columnFilter);
+      if (!columnFilter) {
+        remaining.push_back(conjunct);
+        continue;
+      }
+    }
+    fieldSpec->setFilter(std::move(columnFilter));
+  }
+
+  if (remaining.empty()) {
+    return nullptr;
+  }
+  if (remaining.size() == 1) {
+    return remaining[0];
+  }
+  return std::make_shared<core::CallTypedExpr>(
+      BOOLEAN(), std::move(remaining), "and");
+}
 } // namespace
 
 HiveDataSource::HiveDataSource(
@@ -123,7 +404,10 @@ HiveDataSource::HiveDataSource(
     ExpressionEvaluator* expressionEvaluator,
     memory::MappedMemory* mappedMemory,
     const std::string& scanId,
-    folly::Executor* executor)
+    folly::Executor* executor,
+    bool returnRunLengthEncoded,
+    std::vector<std::string> highPriorityCachePaths,
+    bool returnIntegerDictionary)
     : outputType_(outputType),
       fileHandleFactory_(fileHandleFactory),
       pool_(pool),
@@ -132,7 +416,8 @@ HiveDataSource::HiveDataSource(
       expressionEvaluator_(expressionEvaluator),
       mappedMemory_(mappedMemory),
       scanId_(scanId),
-      executor_(executor) {
+      executor_(executor),
+      highPriorityCachePaths_(std::move(highPriorityCachePaths)) {
   for (const auto& entry : columnHandles) {
     auto handle = std::dynamic_pointer_cast<HiveColumnHandle>(entry.second);
     VELOX_CHECK(
@@ -166,13 +451,39 @@ HiveDataSource::HiveDataSource(
   VELOX_CHECK(
       hiveTableHandle->isFilterPushdownEnabled(),
       "Filter pushdown must be enabled");
+  if (hiveTableHandle->dataColumns()) {
+    readerOpts_.setFileSchema(hiveTableHandle->dataColumns());
+  }
 
   auto outputTypes = outputType_->children();
   readerOutputType_ = ROW(std::move(columnNames), std::move(outputTypes));
   scanSpec_ =
       makeScanSpec(hiveTableHandle->subfieldFilters(), readerOutputType_);
+  for (const auto& [name, handle] : columnHandles_) {
+    if (!handle->lengthsOnly()) {
+      continue;
+    }
+    auto kind = handle->dataType()->kind();
+    VELOX_USER_CHECK(
+        kind == TypeKind::ARRAY || kind == TypeKind::MAP,
+        "Only array and map columns can be read as lengths only: {}",
+        handle->name());
+    if (auto fieldSpec = scanSpec_->childByName(handle->name())) {
+      fieldSpec->setReadsLengthsOnly(true);
+    }
+  }
 
-  const auto& remainingFilter = hiveTableHandle->remainingFilter();
+  auto remainingFilter = hiveTableHandle->remainingFilter();
+  if (remainingFilter) {
+    std::unordered_set<std::string> nonRegularColumns;
+    for (const auto& [name, handle] : columnHandles_) {
+      if (handle->columnType() != HiveColumnHandle::ColumnType::kRegular) {
+        nonRegularColumns.insert(handle->name());
+      }
+    }
+    remainingFilter = extractFiltersFromRemainingFilter(
+        remainingFilter, nonRegularColumns, *scanSpec_);
+  }
   if (remainingFilter) {
     remainingFilterExprSet_ = expressionEvaluator_->compile(remainingFilter);
 
@@ -200,6 +511,8 @@ HiveDataSource::HiveDataSource(
   }
 
   rowReaderOpts_.setScanSpec(scanSpec_.get());
+  rowReaderOpts_.setReturnRunLengthEncoded(returnRunLengthEncoded);
+  rowReaderOpts_.setReturnIntegerDictionary(returnIntegerDictionary);
 
   ioStats_ = std::make_shared<dwio::common::IoStatistics>();
 }
@@ -221,7 +534,8 @@ bool testFilters(
             !child->filter()->testNull()) {
           return false;
         }
-      } else {
+      } else if (totalRows.has_value()) {
+        // Files without a footer, e.g. text files, have no statistics.
         const auto& typeWithId = fileTypeWithId->childByName(name);
         auto columnStats = reader->columnStatistics(typeWithId->id);
         if (!testFilter(
@@ -272,6 +586,16 @@ std::unique_ptr<InputStreamHolder> makeStreamHolder(
   return std::make_unique<InputStreamHolder>(factory->generate(path), stats);
 }
 
+// The open file and the Reader of a split, made by
+// HiveDataSource::splitPreparer(). 'readerOpts' owns the DataCacheConfig the
+// Reader refers to.
+struct HivePreparedSplit : public PreparedSplit {
+  FileHandleCachedPtr fileHandle;
+  std::unique_ptr<dwrf::BufferedInputFactory> bufferedInputFactory;
+  dwio::common::ReaderOptions readerOpts;
+  std::unique_ptr<dwio::common::Reader> reader;
+};
+
 template <TypeKind ToKind>
 velox::variant convertFromString(const std::optional<std::string>& value) {
   if (value.has_value()) {
@@ -301,7 +625,108 @@ void HiveDataSource::addDynamicFilter(
   }
   scanSpec_->resetCachedValues();
 
-  rowReader_->resetFilterCaches();
+  if (rowReader_) {
+    rowReader_->resetFilterCaches();
+  }
+}
+
+void HiveDataSource::addDynamicFilter(
+    const std::vector<ChannelIndex>& outputChannels,
+    const std::shared_ptr<common::BigintTuplesUsingBloomFilter>& filter) {
+  VELOX_CHECK_EQ(outputChannels.size(), filter->numColumns());
+  for (auto channel : outputChannels) {
+    auto kind = outputType_->childAt(channel)->kind();
+    VELOX_CHECK(
+        kind == TypeKind::TINYINT || kind == TypeKind::SMALLINT ||
+            kind == TypeKind::INTEGER || kind == TypeKind::BIGINT,
+        "Multi-column dynamic filter on a non-integer column: {}",
+        outputType_->childAt(channel)->toString());
+  }
+  multiColumnFilters_.emplace_back(outputChannels, filter);
+}
+
+cache::CachePriority HiveDataSource::cachePriority(
+    const std::string& path) const {
+  for (const auto& prefix : highPriorityCachePaths_) {
+    if (path.compare(0, prefix.size(), prefix) == 0) {
+      return cache::CachePriority::kHigh;
+    }
+  }
+  return cache::CachePriority::kNormal;
+}
+
+std::function<std::shared_ptr<PreparedSplit>()> HiveDataSource::splitPreparer(
+    const std::shared_ptr<ConnectorSplit>& split) {
+  auto hiveSplit = std::dynamic_pointer_cast<HiveConnectorSplit>(split);
+  VELOX_CHECK(hiveSplit, "Wrong type of split");
+  // Captures copies of the state of 'this' so that the preparation may run
+  // on another thread while 'this' processes a different split. Does not
+  // capture 'split' since this is kept by 'split'.
+  auto priority = cachePriority(hiveSplit->filePath);
+  return [factory = fileHandleFactory_,
+          path = hiveSplit->filePath,
+          fileFormat = hiveSplit->fileFormat,
+          readerOpts = readerOpts_,
+          asyncCache = dynamic_cast<cache::AsyncDataCache*>(mappedMemory_),
+          dataCache = dataCache_,
+          scanId = scanId_,
+          ioStats = ioStats_,
+          executor = executor_,
+          priority]() mutable -> std::shared_ptr<PreparedSplit> {
+    auto prepared = std::make_shared<HivePreparedSplit>();
+    prepared->fileHandle = factory->generate(path);
+    const auto& fileHandle = prepared->fileHandle;
+    // Decide between AsyncDataCache, legacy DataCache and no cache. All
+    // three are supported to enable comparison. The DataCacheConfig is new
+    // for each split since the reader of the previous split may still be
+    // using the previous one.
+    if (asyncCache) {
+      VELOX_CHECK(
+          !dataCache,
+          "DataCache should not be present if the MappedMemory is AsyncDataCache");
+      // Make DataCacheConfig to pass the filenum and a null DataCache.
+      auto dataCacheConfig = std::make_shared<dwio::common::DataCacheConfig>();
+      dataCacheConfig->filenum = fileHandle->uuid.id();
+      readerOpts.setDataCacheConfig(std::move(dataCacheConfig));
+      prepared->bufferedInputFactory =
+          std::make_unique<dwrf::CachedBufferedInputFactory>(
+              asyncCache,
+              Connector::getTracker(scanId),
+              fileHandle->groupId.id(),
+              [factory, path, stats = ioStats]() {
+                return makeStreamHolder(factory, path, stats);
+              },
+              ioStats,
+              executor,
+              priority);
+      readerOpts.setBufferedInputFactory(prepared->bufferedInputFactory.get());
+    } else if (dataCache) {
+      auto dataCacheConfig = std::make_shared<dwio::common::DataCacheConfig>();
+      dataCacheConfig->cache = dataCache;
+      dataCacheConfig->filenum = fileHandle->uuid.id();
+      readerOpts.setDataCacheConfig(std::move(dataCacheConfig));
+    } else if (!fileHandle->file->mappedData().empty()) {
+      // Reads memory mapped files without copying.
+      prepared->bufferedInputFactory =
+          std::make_unique<dwrf::MappedBufferedInputFactory>();
+      readerOpts.setBufferedInputFactory(prepared->bufferedInputFactory.get());
+    }
+    readerOpts.setFileFormat(fileFormat);
+
+    // We run with the default BufferedInputFactory and no DataCacheConfig if
+    // there is no DataCache, the MappedMemory is not an AsyncDataCache and
+    // the file is not memory mapped.
+    prepared->reader =
+        dwio::common::getReaderFactory(readerOpts.getFileFormat())
+            ->createReader(
+                std::make_unique<dwio::common::ReadFileInputStream>(
+                    fileHandle->file.get(),
+                    dwio::common::MetricsLog::voidLog(),
+                    ioStats.get()),
+                readerOpts);
+    prepared->readerOpts = std::move(readerOpts);
+    return prepared;
+  };
 }
 
 void HiveDataSource::addSplit(std::shared_ptr<ConnectorSplit> split) {
@@ -313,56 +738,36 @@ void HiveDataSource::addSplit(std::shared_ptr<ConnectorSplit> split) {
 
   VLOG(1) << "Adding split " << split_->toString();
 
-  fileHandle_ = fileHandleFactory_->generate(split_->filePath);
-  // Decide between AsyncDataCache, legacy DataCache and no cache. All
-  // three are supported to enable comparison.
-  if (auto asyncCache = dynamic_cast<cache::AsyncDataCache*>(mappedMemory_)) {
-    VELOX_CHECK(
-        !dataCache_,
-        "DataCache should not be present if the MappedMemory is AsyncDataCache");
-    // Make DataCacheConfig to pass the filenum and a null DataCache.
-    if (!readerOpts_.getDataCacheConfig()) {
-      auto dataCacheConfig = std::make_shared<dwio::common::DataCacheConfig>();
-      readerOpts_.setDataCacheConfig(std::move(dataCacheConfig));
-    }
-    readerOpts_.getDataCacheConfig()->filenum = fileHandle_->uuid.id();
-    bufferedInputFactory_ = std::make_unique<dwrf::CachedBufferedInputFactory>(
-        (asyncCache),
-        Connector::getTracker(scanId_),
-        fileHandle_->groupId.id(),
-        [factory = fileHandleFactory_,
-         path = split_->filePath,
-         stats = ioStats_]() { return makeStreamHolder(factory, path, stats); },
-        ioStats_,
-        executor_);
-    readerOpts_.setBufferedInputFactory(bufferedInputFactory_.get());
-  } else if (dataCache_) {
-    auto dataCacheConfig = std::make_shared<dwio::common::DataCacheConfig>();
-    dataCacheConfig->cache = dataCache_;
-    dataCacheConfig->filenum = fileHandle_->uuid.id();
-    readerOpts_.setDataCacheConfig(std::move(dataCacheConfig));
-  }
   if (readerOpts_.getFileFormat() != dwio::common::FileFormat::UNKNOWN) {
     VELOX_CHECK(
         readerOpts_.getFileFormat() == split_->fileFormat,
         "HiveDataSource received splits of different formats: {} and {}",
         toString(readerOpts_.getFileFormat()),
         toString(split_->fileFormat));
-  } else {
-    readerOpts_.setFileFormat(split_->fileFormat);
   }
 
-  // We run with the default BufferedInputFactory and no DataCacheConfig if
-  // there is no DataCache and the MappedMemory is not an AsyncDataCache.
-  reader_ = dwio::common::getReaderFactory(readerOpts_.getFileFormat())
-                ->createReader(
-                    std::make_unique<dwio::common::ReadFileInputStream>(
-                        fileHandle_->file.get(),
-                        dwio::common::MetricsLog::voidLog(),
-                        ioStats_.get()),
-                    readerOpts_);
+  std::shared_ptr<HivePreparedSplit> prepared;
+  if (split_->preload) {
+    prepared =
+        std::dynamic_pointer_cast<HivePreparedSplit>(split_->preload->get());
+    VELOX_CHECK(prepared, "Wrong type of prepared split");
+    split_->preload.reset();
+    ++numPreloadedSplits_;
+  } else {
+    prepared = std::dynamic_pointer_cast<HivePreparedSplit>(
+        splitPreparer(split_)());
+  }
+  // The readers of the previous split go before the DataCacheConfig and
+  // BufferedInputFactory they refer to. Those of the new reader stay alive
+  // in 'readerOpts_' and 'bufferedInputFactory_' until the next split.
+  rowReader_.reset();
+  reader_ = std::move(prepared->reader);
+  fileHandle_ = std::move(prepared->fileHandle);
+  bufferedInputFactory_ = std::move(prepared->bufferedInputFactory);
+  readerOpts_ = prepared->readerOpts;
 
   emptySplit_ = false;
+  numMetadataRows_ = 0;
   if (reader_->numberOfRows() == 0) {
     emptySplit_ = true;
     return;
@@ -427,6 +832,12 @@ void HiveDataSource::addSplit(std::shared_ptr<ConnectorSplit> split) {
     }
   }
 
+  if (columnNames.empty() && canAnswerFromMetadata()) {
+    numMetadataRows_ = reader_->numberOfRows().value();
+    ++numMetadataOnlySplits_;
+    return;
+  }
+
   std::shared_ptr<dwio::common::ColumnSelector> cs;
   if (columnNames.empty()) {
     static const std::shared_ptr<const RowType> kEmpty{ROW({}, {})};
@@ -456,7 +867,8 @@ RowVectorPtr HiveDataSource::next(uint64_t size) {
   // column, e.g. rand() < 0.1. Evaluate that conjunct first, then scan only
   // rows that passed.
 
-  auto rowsScanned = rowReader_->next(size, output_);
+  auto rowsScanned = rowReader_ ? rowReader_->next(size, output_)
+                                : nextFromMetadata(size);
   completedRows_ += rowsScanned;
 
   if (rowsScanned) {
@@ -484,6 +896,14 @@ RowVectorPtr HiveDataSource::next(uint64_t size) {
       }
     }
 
+    if (!multiColumnFilters_.empty()) {
+      rowsRemaining = evaluateMultiColumnFilters(
+          rowVector, rowsRemaining, remainingIndices);
+      if (rowsRemaining == 0) {
+        return RowVector::createEmpty(outputType_, pool_);
+      }
+    }
+
     if (outputType_->size() == 0) {
       return exec::wrap(rowsRemaining, remainingIndices, rowVector);
     }
@@ -499,7 +919,13 @@ RowVectorPtr HiveDataSource::next(uint64_t size) {
         pool_, outputType_, BufferPtr(nullptr), rowsRemaining, outputColumns);
   }
 
-  rowReader_->updateRuntimeStats(runtimeStats_);
+  if (rowReader_) {
+    rowReader_->updateRuntimeStats(runtimeStats_);
+  } else {
+    // The constant columns of a split answered from metadata are not for
+    // the next reader to fill in.
+    output_.reset();
+  }
 
   split_.reset();
   reader_.reset();
@@ -516,6 +942,102 @@ vector_size_t HiveDataSource::evaluateRemainingFilter(RowVectorPtr& rowVector) {
       filterResult_, filterRows_, filterEvalCtx_, pool_);
 }
 
+namespace {
+int64_t integerAt(const DecodedVector& decoded, vector_size_t row) {
+  switch (decoded.base()->typeKind()) {
+    case TypeKind::TINYINT:
+      return decoded.valueAt<int8_t>(row);
+    case TypeKind::SMALLINT:
+      return decoded.valueAt<int16_t>(row);
+    case TypeKind::INTEGER:
+      return decoded.valueAt<int32_t>(row);
+    case TypeKind::BIGINT:
+      return decoded.valueAt<int64_t>(row);
+    default:
+      VELOX_UNREACHABLE();
+  }
+}
+} // namespace
+
+vector_size_t HiveDataSource::evaluateMultiColumnFilters(
+    const RowVectorPtr& rowVector,
+    vector_size_t numRows,
+    BufferPtr& indices) {
+  multiColumnRows_.resize(numRows);
+  if (indices) {
+    auto rawIndices = indices->as<vector_size_t>();
+    std::copy(rawIndices, rawIndices + numRows, multiColumnRows_.begin());
+  } else {
+    std::iota(multiColumnRows_.begin(), multiColumnRows_.end(), 0);
+  }
+
+  SelectivityVector allRows(rowVector->size());
+  for (auto& [channels, filter] : multiColumnFilters_) {
+    multiColumnDecoded_.resize(channels.size());
+    multiColumnValues_.resize(channels.size());
+    for (auto i = 0; i < channels.size(); ++i) {
+      multiColumnDecoded_[i].decode(
+          *rowVector->loadedChildAt(channels[i]), allRows);
+    }
+    vector_size_t numPassed = 0;
+    for (auto row : multiColumnRows_) {
+      bool passed = true;
+      for (auto i = 0; i < channels.size(); ++i) {
+        auto& decoded = multiColumnDecoded_[i];
+        // A null key matches no row of a join.
+        if (decoded.isNullAt(row)) {
+          passed = false;
+          break;
+        }
+        multiColumnValues_[i] = integerAt(decoded, row);
+      }
+      if (passed && filter->testInt64s(multiColumnValues_.data())) {
+        multiColumnRows_[numPassed++] = row;
+      }
+    }
+    multiColumnRows_.resize(numPassed);
+  }
+
+  auto numPassed = multiColumnRows_.size();
+  if (numPassed == numRows || numPassed == 0) {
+    return numPassed;
+  }
+  indices = AlignedBuffer::allocate<vector_size_t>(numPassed, pool_);
+  std::copy(
+      multiColumnRows_.begin(),
+      multiColumnRows_.end(),
+      indices->asMutable<vector_size_t>());
+  return numPassed;
+}
+
+bool HiveDataSource::canAnswerFromMetadata() const {
+  if (remainingFilterExprSet_ || !reader_->numberOfRows().has_value()) {
+    return false;
+  }
+  for (const auto& child : scanSpec_->children()) {
+    if (child->filter()) {
+      return false;
+    }
+  }
+  // The footer counts the rows of the whole file, so the split must cover
+  // all of it.
+  return split_->start == 0 && split_->length >= fileHandle_->file->size();
+}
+
+uint64_t HiveDataSource::nextFromMetadata(uint64_t size) {
+  auto numRows = std::min(size, numMetadataRows_);
+  numMetadataRows_ -= numRows;
+  std::vector<VectorPtr> children;
+  children.reserve(readerOutputType_->size());
+  for (const auto& name : readerOutputType_->names()) {
+    children.push_back(BaseVector::wrapInConstant(
+        numRows, 0, scanSpec_->childByName(name)->constantValue()));
+  }
+  output_ = std::make_shared<RowVector>(
+      pool_, readerOutputType_, BufferPtr(nullptr), numRows, children);
+  return numRows;
+}
+
 void HiveDataSource::setConstantValue(
     common::ScanSpec* spec,
     const velox::variant& value) const {
@@ -552,7 +1074,29 @@ std::unordered_map<std::string, int64_t> HiveDataSource::runtimeStats() {
        {"numLocalRead", ioStats_->ssdRead().count()},
        {"localReadBytes", ioStats_->ssdRead().bytes()},
        {"numRamRead", ioStats_->ramHit().count()},
-       {"ramReadBytes", ioStats_->ramHit().bytes()}});
+       {"ramReadBytes", ioStats_->ramHit().bytes()},
+       {"overreadBytes", ioStats_->rawOverreadBytes()},
+       {"preloadedSplits", numPreloadedSplits_},
+       {"metadataOnlySplits", numMetadataOnlySplits_}});
+  // Storage reads by IO size, e.g. storageReadBytesUnder64KB.
+  static const char* kSizeNames[] = {
+      "8KB", "64KB", "512KB", "4MB", "32MB", "32MB"};
+  static_assert(
+      sizeof(kSizeNames) / sizeof(kSizeNames[0]) ==
+      dwio::common::IoStatistics::kNumReadSizeBuckets);
+  for (auto i = 0; i < dwio::common::IoStatistics::kNumReadSizeBuckets; ++i) {
+    auto& counter = ioStats_->readsBySizeBucket(i);
+    if (counter.count() == 0) {
+      continue;
+    }
+    auto suffix = fmt::format(
+        "{}{}",
+        i == dwio::common::IoStatistics::kNumReadSizeBuckets - 1 ? "Over"
+                                                                  : "Under",
+        kSizeNames[i]);
+    res[fmt::format("numStorageRead{}", suffix)] = counter.count();
+    res[fmt::format("storageReadBytes{}", suffix)] = counter.bytes();
+  }
   return res;
 }
 
@@ -572,6 +1116,24 @@ int64_t HiveDataSource::estimatedRowSize() {
   }
 }
 
+namespace {
+// Returns the capacity of the file handle cache. Each cached handle may
+// keep a file descriptor open, so the default leaves half of the open
+// file limit of the process for everything else.
+int64_t maxCachedFileHandles() {
+  constexpr int64_t kDefaultMaxOpenFiles = 10'000;
+  if (FLAGS_file_handle_cache_max_open_files > 0) {
+    return FLAGS_file_handle_cache_max_open_files;
+  }
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0 ||
+      limit.rlim_cur == RLIM_INFINITY) {
+    return kDefaultMaxOpenFiles;
+  }
+  return std::max<int64_t>(1, limit.rlim_cur / 2);
+}
+} // namespace
+
 HiveConnector::HiveConnector(
     const std::string& id,
     std::shared_ptr<const Config> properties,
@@ -580,10 +1142,15 @@ HiveConnector::HiveConnector(
     : Connector(id, properties),
       dataCache_(std::move(dataCache)),
       fileHandleFactory_(
-          std::make_unique<SimpleLRUCache<std::string, FileHandle>>(
-              FLAGS_file_handle_cache_mb << 20),
-          std::make_unique<FileHandleGenerator>(std::move(properties))),
-      executor_(executor) {}
+          maxCachedFileHandles(),
+          FileHandleGenerator(properties)),
+      executor_(executor) {
+  if (properties) {
+    auto paths =
+        properties->get<std::string>(kHighPriorityCachePaths, std::string());
+    folly::split(',', paths, highPriorityCachePaths_, true);
+  }
+}
 
 VELOX_REGISTER_CONNECTOR_FACTORY(std::make_shared<HiveConnectorFactory>())
 VELOX_REGISTER_CONNECTOR_FACTORY(
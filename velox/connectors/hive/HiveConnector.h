@@ -15,9 +15,14 @@
  */
 #pragma once
 
+#include <optional>
+
+#include <folly/container/F14Map.h>
+
 #include "velox/common/caching/DataCache.h"
 #include "velox/connectors/hive/FileHandle.h"
 #include "velox/connectors/hive/HiveConnectorSplit.h"
+#include "velox/connectors/hive/HivePartitionFunction.h"
 #include "velox/dwio/common/ScanSpec.h"
 #include "velox/dwio/dwrf/common/CachedBufferedInput.h"
 #include "velox/dwio/dwrf/reader/DwrfReader.h"
@@ -33,11 +38,17 @@ class HiveColumnHandle : public ColumnHandle {
  public:
   enum class ColumnType { kPartitionKey, kRegular, kSynthesized };
 
+  // 'lengthsOnly' is true for an array or map column of which only the
+  // number of elements of each row is used, e.g. by cardinality().
   HiveColumnHandle(
       const std::string& name,
       ColumnType columnType,
-      TypePtr dataType)
-      : name_(name), columnType_(columnType), dataType_(std::move(dataType)) {}
+      TypePtr dataType,
+      bool lengthsOnly = false)
+      : name_(name),
+        columnType_(columnType),
+        dataType_(std::move(dataType)),
+        lengthsOnly_(lengthsOnly) {}
 
   const std::string& name() const {
     return name_;
@@ -51,10 +62,15 @@ class HiveColumnHandle : public ColumnHandle {
     return dataType_;
   }
 
+  bool lengthsOnly() const {
+    return lengthsOnly_;
+  }
+
  private:
   const std::string name_;
   const ColumnType columnType_;
   const TypePtr dataType_;
+  const bool lengthsOnly_;
 };
 
 using SubfieldFilters =
@@ -65,10 +81,12 @@ class HiveTableHandle : public ConnectorTableHandle {
   HiveTableHandle(
       bool filterPushdownEnabled,
       SubfieldFilters subfieldFilters,
-      const std::shared_ptr<const core::ITypedExpr>& remainingFilter)
+      const std::shared_ptr<const core::ITypedExpr>& remainingFilter,
+      RowTypePtr dataColumns = nullptr)
       : filterPushdownEnabled_(filterPushdownEnabled),
         subfieldFilters_(std::move(subfieldFilters)),
-        remainingFilter_(remainingFilter) {}
+        remainingFilter_(remainingFilter),
+        dataColumns_(std::move(dataColumns)) {}
 
   bool isFilterPushdownEnabled() const {
     return filterPushdownEnabled_;
@@ -82,10 +100,24 @@ class HiveTableHandle : public ConnectorTableHandle {
     return remainingFilter_;
   }
 
+  // The columns of the data files in file order, without the partition
+  // keys. Needed for formats whose files have no schema, e.g. TEXT.
+  const RowTypePtr& dataColumns() const {
+    return dataColumns_;
+  }
+
  private:
   const bool filterPushdownEnabled_;
   const SubfieldFilters subfieldFilters_;
   const std::shared_ptr<const core::ITypedExpr> remainingFilter_;
+  const RowTypePtr dataColumns_;
+};
+
+// Bucketing of a Hive table. A row goes to the bucket HivePartitionFunction
+// assigns to the values of its 'bucketedBy' columns.
+struct HiveBucketProperty {
+  int32_t numBuckets;
+  std::vector<std::string> bucketedBy;
 };
 
 /**
@@ -93,33 +125,170 @@ class HiveTableHandle : public ConnectorTableHandle {
  */
 class HiveInsertTableHandle : public ConnectorInsertTableHandle {
  public:
+  // Writes all rows to the single file 'filePath'.
   explicit HiveInsertTableHandle(const std::string& filePath)
       : filePath_(filePath) {}
 
+  // Writes a table partitioned on the 'partitionedBy' columns and bucketed by
+  // 'bucketProperty', if set, under the directory 'location'. Each partition
+  // is a subdirectory 'column=value/...' and its columns are not written to
+  // the files. A file is closed and the next one of its partition and bucket
+  // started once it reaches 'targetFileSize' bytes, 0 for no limit. At most
+  // 'maxOpenWriters' files are open at a time and they split
+  // 'writerMemoryBudget' between them.
+  HiveInsertTableHandle(
+      const std::string& location,
+      std::vector<std::string> partitionedBy,
+      std::optional<HiveBucketProperty> bucketProperty,
+      uint64_t targetFileSize = 0,
+      int32_t maxOpenWriters = 100,
+      int64_t writerMemoryBudget = std::numeric_limits<int64_t>::max())
+      : location_(location),
+        partitionedBy_(std::move(partitionedBy)),
+        bucketProperty_(std::move(bucketProperty)),
+        targetFileSize_(targetFileSize),
+        maxOpenWriters_(maxOpenWriters),
+        writerMemoryBudget_(writerMemoryBudget) {
+    VELOX_CHECK(!location_.empty(), "Hive write needs a location");
+    VELOX_CHECK_GT(maxOpenWriters_, 0);
+    if (bucketProperty_.has_value()) {
+      VELOX_CHECK_GT(bucketProperty_->numBuckets, 0);
+      VELOX_CHECK(!bucketProperty_->bucketedBy.empty());
+    }
+  }
+
   const std::string& filePath() const {
     return filePath_;
   }
 
+  // True if the rows go to files under location() instead of to filePath().
+  bool writesDirectory() const {
+    return !location_.empty();
+  }
+
+  const std::string& location() const {
+    return location_;
+  }
+
+  const std::vector<std::string>& partitionedBy() const {
+    return partitionedBy_;
+  }
+
+  const std::optional<HiveBucketProperty>& bucketProperty() const {
+    return bucketProperty_;
+  }
+
+  uint64_t targetFileSize() const {
+    return targetFileSize_;
+  }
+
+  int32_t maxOpenWriters() const {
+    return maxOpenWriters_;
+  }
+
+  int64_t writerMemoryBudget() const {
+    return writerMemoryBudget_;
+  }
+
   virtual ~HiveInsertTableHandle() {}
 
  private:
   const std::string filePath_;
+  const std::string location_;
+  const std::vector<std::string> partitionedBy_;
+  const std::optional<HiveBucketProperty> bucketProperty_;
+  const uint64_t targetFileSize_{0};
+  const int32_t maxOpenWriters_{1};
+  const int64_t writerMemoryBudget_{std::numeric_limits<int64_t>::max()};
 };
 
+// Writes to the file of a HiveInsertTableHandle, or routes the rows to a
+// writer per partition and bucket under its location.
 class HiveDataSink : public DataSink {
  public:
-  explicit HiveDataSink(
+  HiveDataSink(
       std::shared_ptr<const RowType> inputType,
-      const std::string& filePath,
+      std::shared_ptr<const HiveInsertTableHandle> insertTableHandle,
       velox::memory::MemoryPool* FOLLY_NONNULL memoryPool);
 
   void appendData(VectorPtr input) override;
 
   void close() override;
 
+  // The files written or being written, in the order they were opened.
+  const std::vector<std::string>& filePaths() const {
+    return filePaths_;
+  }
+
+  // The value of a null partition column in the partition directory name.
+  static constexpr const char* FOLLY_NONNULL kDefaultPartitionValue =
+      "__HIVE_DEFAULT_PARTITION__";
+
  private:
+  // The file being written for one partition and bucket.
+  struct PartitionWriter {
+    // The partition directory under the location, ending in '/'.
+    std::string directory;
+    int32_t bucket;
+    // Number of files of the partition and bucket closed so far.
+    int32_t numClosedFiles{0};
+    // nullptr if no file is open.
+    std::unique_ptr<dwrf::Writer> writer;
+    // The sink of 'writer', which owns it.
+    dwio::common::DataSink* FOLLY_NULLABLE sink{nullptr};
+    // Value of 'numWrites_' at the last write, for closing the least recently
+    // used file when too many are open.
+    uint64_t lastWrite{0};
+  };
+
+  std::unique_ptr<dwrf::Writer> createWriter(
+      const std::string& path,
+      int64_t memoryBudget,
+      dwio::common::DataSink*& sink);
+
+  // Sets 'writerIds_' to the index in 'writers_' of the writer of each row
+  // of 'input', adding writers for new partitions and buckets.
+  void computeWriterIds(const RowVector& input);
+
+  // Writes the rows of 'input' at 'rows' to 'writer', opening a file if
+  // needed and closing it once it reaches the target size.
+  void write(
+      PartitionWriter& writer,
+      const RowVector& input,
+      const std::vector<vector_size_t>& rows);
+
+  void closeFile(PartitionWriter& writer);
+
   const std::shared_ptr<const RowType> inputType_;
+  const std::shared_ptr<const HiveInsertTableHandle> insertTableHandle_;
+  velox::memory::MemoryPool* FOLLY_NONNULL const pool_;
+  // The single file writer if the handle does not write a directory.
   std::unique_ptr<facebook::velox::dwrf::Writer> writer_;
+
+  // Channels of 'inputType_' that are partition keys and that are written.
+  std::vector<ChannelIndex> partitionChannels_;
+  std::vector<ChannelIndex> dataChannels_;
+  std::shared_ptr<const RowType> dataType_;
+  std::unique_ptr<HivePartitionFunction> bucketFunction_;
+  // Distinguishes the files of this sink from those of other writers to the
+  // same location.
+  const uint64_t sinkId_;
+
+  std::vector<std::unique_ptr<PartitionWriter>> writers_;
+  // Index in 'writers_' by partition directory and bucket.
+  folly::F14FastMap<std::string, int32_t> writerIndex_;
+  int32_t numOpenWriters_{0};
+  uint64_t numWrites_{0};
+  std::vector<std::string> filePaths_;
+  bool closed_{false};
+
+  // Reusable memory.
+  SelectivityVector rows_;
+  std::vector<DecodedVector> decodedPartitionKeys_;
+  std::vector<uint32_t> buckets_;
+  std::vector<int32_t> writerIds_;
+  std::vector<std::vector<vector_size_t>> writerRows_;
+  std::string key_;
 };
 
 class HiveConnector;
@@ -138,14 +307,26 @@ class HiveDataSource : public DataSource {
       ExpressionEvaluator* FOLLY_NONNULL expressionEvaluator,
       memory::MappedMemory* FOLLY_NONNULL mappedMemory,
       const std::string& scanId,
-      folly::Executor* FOLLY_NULLABLE executor);
+      folly::Executor* FOLLY_NULLABLE executor,
+      bool returnRunLengthEncoded = false,
+      std::vector<std::string> highPriorityCachePaths = {},
+      bool returnIntegerDictionary = false);
 
   void addSplit(std::shared_ptr<ConnectorSplit> split) override;
 
+  // Opens the file and reads the footer of 'split'.
+  std::function<std::shared_ptr<PreparedSplit>()> splitPreparer(
+      const std::shared_ptr<ConnectorSplit>& split) override;
+
   void addDynamicFilter(
       ChannelIndex outputChannel,
       const std::shared_ptr<common::Filter>& filter) override;
 
+  void addDynamicFilter(
+      const std::vector<ChannelIndex>& outputChannels,
+      const std::shared_ptr<common::BigintTuplesUsingBloomFilter>& filter)
+      override;
+
   RowVectorPtr next(uint64_t size) override;
 
   uint64_t getCompletedRows() override {
@@ -167,6 +348,27 @@ class HiveDataSource : public DataSource {
   // filterEvalCtx_.selectedIndices and selectedBits are not updated.
   vector_size_t evaluateRemainingFilter(RowVectorPtr& rowVector);
 
+  // Evaluates 'multiColumnFilters_' on the 'numRows' rows of 'rowVector' at
+  // 'indices', or on the first 'numRows' rows if 'indices' is null. Returns
+  // the number of rows passed and sets 'indices' to the passing rows if only
+  // some pass.
+  vector_size_t evaluateMultiColumnFilters(
+      const RowVectorPtr& rowVector,
+      vector_size_t numRows,
+      BufferPtr& indices);
+
+  // Returns true if all columns of the current split are constant and there
+  // are no filters, so that the row count in the file footer is enough to
+  // produce the output.
+  bool canAnswerFromMetadata() const;
+
+  // Sets 'output_' to up to 'size' rows of the constant columns of the
+  // current split and returns the number of rows.
+  uint64_t nextFromMetadata(uint64_t size);
+
+  // Returns the priority of the cache entries of the file at 'path'.
+  cache::CachePriority cachePriority(const std::string& path) const;
+
   void setConstantValue(
       common::ScanSpec* FOLLY_NONNULL spec,
       const velox::variant& value) const;
@@ -199,6 +401,13 @@ class HiveDataSource : public DataSource {
   bool emptySplit_;
 
   dwio::common::RuntimeStatistics runtimeStats_;
+  // Number of splits that were prepared before addSplit().
+  int64_t numPreloadedSplits_{0};
+  // Number of splits answered from the file footer without reading data.
+  int64_t numMetadataOnlySplits_{0};
+  // Rows of the current split left to produce from metadata if there is no
+  // 'rowReader_'.
+  uint64_t numMetadataRows_{0};
 
   VectorPtr output_;
   FileHandleCachedPtr fileHandle_;
@@ -211,9 +420,21 @@ class HiveDataSource : public DataSource {
   SelectivityVector filterRows_;
   exec::FilterEvalCtx filterEvalCtx_;
 
+  // Dynamic filters on several columns together, with the output channels
+  // of the columns. Evaluated on the rows that pass all other filters.
+  std::vector<std::pair<
+      std::vector<ChannelIndex>,
+      std::shared_ptr<common::BigintTuplesUsingBloomFilter>>>
+      multiColumnFilters_;
+  std::vector<DecodedVector> multiColumnDecoded_;
+  std::vector<int64_t> multiColumnValues_;
+  std::vector<vector_size_t> multiColumnRows_;
+
   memory::MappedMemory* const FOLLY_NONNULL mappedMemory_;
   const std::string& scanId_;
   folly::Executor* FOLLY_NULLABLE executor_;
+  // Prefixes of the paths of files cached with high priority.
+  const std::vector<std::string> highPriorityCachePaths_;
   bool errorInRowSize_{false};
 };
 
@@ -246,7 +467,12 @@ class HiveConnector final : public Connector {
         connectorQueryCtx->expressionEvaluator(),
         connectorQueryCtx->mappedMemory(),
         connectorQueryCtx->scanId(),
-        executor_);
+        executor_,
+        connectorQueryCtx->config()->get<bool>(
+            kReturnRunLengthEncoded, false),
+        highPriorityCachePaths_,
+        connectorQueryCtx->config()->get<bool>(
+            kReturnIntegerDictionary, false));
   }
 
   std::shared_ptr<DataSink> createDataSink(
@@ -259,19 +485,26 @@ class HiveConnector final : public Connector {
         hiveInsertHandle != nullptr,
         "Hive connector expecting hive write handle!");
     return std::make_shared<HiveDataSink>(
-        inputType,
-        hiveInsertHandle->filePath(),
-        connectorQueryCtx->memoryPool());
+        inputType, hiveInsertHandle, connectorQueryCtx->memoryPool());
   }
 
-  folly::Executor* FOLLY_NULLABLE executor() {
+  folly::Executor* FOLLY_NULLABLE executor() const override {
     return executor_;
   }
 
+  // Connector property with a comma separated list of path prefixes,
+  // e.g. table locations or file paths. Data of files under these is
+  // cached with high priority in AsyncDataCache. See
+  // AsyncDataCache::setHighPriorityReserve().
+  static constexpr const char* FOLLY_NONNULL kHighPriorityCachePaths =
+      "cache.high-priority-paths";
+
  private:
   std::unique_ptr<DataCache> dataCache_;
   FileHandleFactory fileHandleFactory_;
   folly::Executor* FOLLY_NULLABLE executor_;
+  // Parsed from kHighPriorityCachePaths.
+  std::vector<std::string> highPriorityCachePaths_;
 
   static constexpr const char* FOLLY_NONNULL kNodeSelectionStrategy =
       "node_selection_strategy";
@@ -279,6 +512,14 @@ class HiveConnector final : public Connector {
       kNodeSelectionStrategyNoPreference = "NO_PREFERENCE";
   static constexpr const char* FOLLY_NONNULL
       kNodeSelectionStrategySoftAffinity = "SOFT_AFFINITY";
+  // If true, columns with long runs of equal values are read as
+  // SequenceVectors. See RowReaderOptions::setReturnRunLengthEncoded().
+  static constexpr const char* FOLLY_NONNULL kReturnRunLengthEncoded =
+      "return_run_length_encoded";
+  // If true, integer columns with dictionary encoding are read as
+  // DictionaryVectors. See RowReaderOptions::setReturnIntegerDictionary().
+  static constexpr const char* FOLLY_NONNULL kReturnIntegerDictionary =
+      "return_integer_dictionary";
 };
 
 class HiveConnectorFactory : public ConnectorFactory {
@@ -30,6 +30,9 @@ struct HiveConnectorSplit : public connector::ConnectorSplit {
   const std::unordered_map<std::string, std::optional<std::string>>
       partitionKeys;
   std::optional<int32_t> tableBucketNumber;
+  // Modification time of the file, e.g. in milliseconds since the epoch.
+  // Only splits that have it are cached by cacheKey().
+  std::optional<int64_t> fileModifiedTime;
 
   HiveConnectorSplit(
       const std::string& connectorId,
@@ -39,14 +42,16 @@ struct HiveConnectorSplit : public connector::ConnectorSplit {
       uint64_t _length = std::numeric_limits<uint64_t>::max(),
       const std::unordered_map<std::string, std::optional<std::string>>&
           _partitionKeys = {},
-      std::optional<int32_t> _tableBucketNumber = std::nullopt)
+      std::optional<int32_t> _tableBucketNumber = std::nullopt,
+      std::optional<int64_t> _fileModifiedTime = std::nullopt)
       : ConnectorSplit(connectorId),
         filePath(_filePath),
         fileFormat(_fileFormat),
         start(_start),
         length(_length),
         partitionKeys(_partitionKeys),
-        tableBucketNumber(_tableBucketNumber) {}
+        tableBucketNumber(_tableBucketNumber),
+        fileModifiedTime(_fileModifiedTime) {}
 
   std::string toString() const override {
     if (tableBucketNumber.has_value()) {
@@ -59,6 +64,14 @@ struct HiveConnectorSplit : public connector::ConnectorSplit {
     }
     return fmt::format("[file {} {} - {}]", filePath, start, length);
   }
+
+  std::string cacheKey() const override {
+    if (!fileModifiedTime.has_value()) {
+      return "";
+    }
+    return fmt::format(
+        "{}:{}:{}:{}", filePath, fileModifiedTime.value(), start, length);
+  }
 };
 
 } // namespace facebook::velox::connector::hive
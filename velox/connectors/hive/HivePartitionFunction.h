@@ -33,9 +33,18 @@ class HivePartitionFunction : public core::PartitionFunction {
       override;
 
  private:
+  // Returns 'hash' % 'numBuckets_' with multiplies instead of a division.
+  // Exact for all 32 bit 'hash' and 'numBuckets_'. See Lemire, Kaser and
+  // Kurz, "Faster Remainder by Direct Computation".
+  uint32_t bucketModulo(uint32_t hash) const {
+    uint64_t lowBits = bucketMultiplier_ * hash;
+    return (static_cast<__uint128_t>(lowBits) * numBuckets_) >> 64;
+  }
+
   const int numBuckets_;
   const std::vector<int> bucketToPartition_;
   const std::vector<ChannelIndex> keyChannels_;
+  const uint64_t bucketMultiplier_;
 
   // Reusable memory.
   std::vector<int32_t> hashes_;
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/connectors/hive/SplitAffinity.h"
+
+#include <folly/hash/Hash.h>
+#include <algorithm>
+#include "velox/common/base/BitUtil.h"
+#include "velox/common/caching/FileIds.h"
+
+namespace facebook::velox::connector::hive {
+
+SplitAffinity::SplitAffinity(const std::vector<std::string>& workers) {
+  VELOX_CHECK(!workers.empty(), "SplitAffinity needs at least one worker");
+  workerHashes_.reserve(workers.size());
+  for (const auto& worker : workers) {
+    workerHashes_.push_back(folly::hasher<std::string>()(worker));
+  }
+}
+
+// static
+uint64_t SplitAffinity::splitHash(const HiveConnectorSplit& split) {
+  return bits::hashMix(
+      folly::hasher<std::string>()(split.filePath),
+      folly::hasher<uint64_t>()(split.start));
+}
+
+int32_t SplitAffinity::preferredWorker(const HiveConnectorSplit& split) const {
+  auto hash = splitHash(split);
+  int32_t best = 0;
+  uint64_t bestScore = 0;
+  // Ties go to the higher index, as in preferredWorkers().
+  for (auto i = 0; i < workerHashes_.size(); ++i) {
+    auto score = bits::hashMix(workerHashes_[i], hash);
+    if (score >= bestScore) {
+      best = i;
+      bestScore = score;
+    }
+  }
+  return best;
+}
+
+std::vector<int32_t> SplitAffinity::preferredWorkers(
+    const HiveConnectorSplit& split,
+    int32_t maxWorkers) const {
+  auto hash = splitHash(split);
+  std::vector<std::pair<uint64_t, int32_t>> scores;
+  scores.reserve(workerHashes_.size());
+  for (auto i = 0; i < workerHashes_.size(); ++i) {
+    scores.emplace_back(bits::hashMix(workerHashes_[i], hash), i);
+  }
+  auto numWorkers = std::min<int32_t>(maxWorkers, scores.size());
+  std::partial_sort(
+      scores.begin(),
+      scores.begin() + numWorkers,
+      scores.end(),
+      std::greater<>());
+  std::vector<int32_t> workers;
+  workers.reserve(numWorkers);
+  for (auto i = 0; i < numWorkers; ++i) {
+    workers.push_back(scores[i].second);
+  }
+  return workers;
+}
+
+std::vector<cache::CachedFileRange> cachedBytes(
+    const std::vector<std::shared_ptr<HiveConnectorSplit>>& splits,
+    const cache::AsyncDataCache& cache) {
+  std::vector<cache::CachedFileRange> ranges;
+  ranges.reserve(splits.size());
+  for (const auto& split : splits) {
+    ranges.push_back(
+        {fileIds().id(split->filePath), split->start, split->length});
+  }
+  cache.cachedBytes(ranges);
+  return ranges;
+}
+
+} // namespace facebook::velox::connector::hive
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include "velox/common/caching/AsyncDataCache.h"
+#include "velox/connectors/hive/HiveConnectorSplit.h"
+
+namespace facebook::velox::connector::hive {
+
+// Places HiveConnectorSplits on workers so that the same split goes to the
+// same worker every time it is scheduled, e.g. for every query reading a
+// table. That worker is then likely to have the data of the split in its
+// AsyncDataCache or SSD cache. The placement is by rendezvous hashing, a
+// form of consistent hashing: a split goes to the worker with the highest
+// hash of the worker and the split. Adding or removing a worker only moves
+// the splits that go to or came from that worker.
+class SplitAffinity {
+ public:
+  // 'workers' are the names of the workers, e.g. host:port. The names and
+  // not their order decide the placement.
+  explicit SplitAffinity(const std::vector<std::string>& workers);
+
+  // Returns the index in 'workers' of the preferred worker for 'split'.
+  int32_t preferredWorker(const HiveConnectorSplit& split) const;
+
+  // Returns the indices in 'workers' of up to 'maxWorkers' workers in order
+  // of preference for 'split'. A scheduler may go down the list if the
+  // first ones are busy, so that the split still lands on a worker that
+  // gets it when the others are busy or gone.
+  std::vector<int32_t> preferredWorkers(
+      const HiveConnectorSplit& split,
+      int32_t maxWorkers) const;
+
+ private:
+  static uint64_t splitHash(const HiveConnectorSplit& split);
+
+  std::vector<uint64_t> workerHashes_;
+};
+
+// Returns the bytes of each of 'splits' in 'cache', in memory and on SSD.
+// A worker reports these so that a scheduler can tell where the data of
+// the splits is cached. A file that has not been opened on the worker has
+// nothing cached.
+std::vector<cache::CachedFileRange> cachedBytes(
+    const std::vector<std::shared_ptr<HiveConnectorSplit>>& splits,
+    const cache::AsyncDataCache& cache);
+
+} // namespace facebook::velox::connector::hive
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/connectors/hive/storage_adapters/s3fs/ReadHedger.h"
+#include "velox/common/base/BitUtil.h"
+#include "velox/common/base/Exceptions.h"
+
+namespace facebook::velox {
+
+ReadHedger::ReadHedger(int32_t percentile, int32_t budgetPct)
+    : percentile_(percentile), budgetPct_(budgetPct) {
+  VELOX_CHECK_GT(percentile_, 0);
+  VELOX_CHECK_LE(percentile_, 100);
+  VELOX_CHECK_GE(budgetPct_, 0);
+  VELOX_CHECK_LE(budgetPct_, 100);
+}
+
+// static
+int32_t ReadHedger::sizeClass(uint64_t size) {
+  if (size <= 64 << 10) {
+    return 0;
+  }
+  return size <= 1 << 20 ? 1 : 2;
+}
+
+std::optional<std::chrono::microseconds> ReadHedger::hedgeDelay(
+    uint64_t size) const {
+  const auto sizeClass = ReadHedger::sizeClass(size);
+  std::lock_guard<std::mutex> l(mutex_);
+  const auto numSamples = numSamples_[sizeClass];
+  if (numSamples < kMinSamples) {
+    return std::nullopt;
+  }
+  const int64_t threshold = (numSamples * percentile_ + 99) / 100;
+  int64_t count = 0;
+  for (auto i = 0; i < kNumBuckets; ++i) {
+    count += counts_[sizeClass][i];
+    if (count >= threshold) {
+      // The upper bound of the bucket.
+      return std::chrono::microseconds(2L << i);
+    }
+  }
+  return std::chrono::microseconds(1L << kNumBuckets);
+}
+
+bool ReadHedger::tryHedge() {
+  std::lock_guard<std::mutex> l(mutex_);
+  if ((numHedged_ + 1) * 100 > budgetPct_ * numRequests_) {
+    return false;
+  }
+  ++numHedged_;
+  return true;
+}
+
+void ReadHedger::record(uint64_t size, std::chrono::microseconds latency) {
+  const auto sizeClass = ReadHedger::sizeClass(size);
+  const uint64_t micros = std::max<int64_t>(1, latency.count());
+  const auto bucket =
+      std::min<int32_t>(kNumBuckets - 1, 63 - bits::countLeadingZeros(micros));
+  std::lock_guard<std::mutex> l(mutex_);
+  ++numRequests_;
+  auto& counts = counts_[sizeClass];
+  ++counts[bucket];
+  if (++numSamples_[sizeClass] > kMaxSamples) {
+    int64_t numSamples = 0;
+    for (auto& count : counts) {
+      count /= 2;
+      numSamples += count;
+    }
+    numSamples_[sizeClass] = numSamples;
+  }
+}
+
+} // namespace facebook::velox
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace facebook::velox {
+
+// Decides when a GET from S3 is hedged, i.e. issued a second time on
+// another connection because the first one takes longer than most recent
+// GETs of a similar size. The hedge delay is the 'percentile' of the
+// recent latencies of the size class of the GET. At most 'budgetPct'
+// percent of the GETs are hedged so that a slow store is not flooded with
+// duplicates. Thread-safe.
+class ReadHedger {
+ public:
+  // No delay is returned for a size class with fewer samples.
+  static constexpr int64_t kMinSamples = 100;
+
+  // The counts of a size class are halved when it has more samples, so
+  // that the delay follows changes in latency.
+  static constexpr int64_t kMaxSamples = 10'000;
+
+  ReadHedger(int32_t percentile, int32_t budgetPct);
+
+  // Returns the time after which a GET of 'size' bytes should be hedged,
+  // or std::nullopt if there are not enough samples to tell.
+  std::optional<std::chrono::microseconds> hedgeDelay(uint64_t size) const;
+
+  // Returns true and counts a hedged GET if the budget allows one more.
+  bool tryHedge();
+
+  // Records the 'latency' of a completed GET of 'size' bytes.
+  void record(uint64_t size, std::chrono::microseconds latency);
+
+  int64_t numRequests() const {
+    std::lock_guard<std::mutex> l(mutex_);
+    return numRequests_;
+  }
+
+  int64_t numHedged() const {
+    std::lock_guard<std::mutex> l(mutex_);
+    return numHedged_;
+  }
+
+ private:
+  static constexpr int32_t kNumSizeClasses = 3;
+  // Bucket i counts latencies in [2^i, 2^(i + 1)) microseconds.
+  static constexpr int32_t kNumBuckets = 32;
+
+  static int32_t sizeClass(uint64_t size);
+
+  const int32_t percentile_;
+  const int32_t budgetPct_;
+  mutable std::mutex mutex_;
+  std::array<std::array<int64_t, kNumBuckets>, kNumSizeClasses> counts_{};
+  std::array<int64_t, kNumSizeClasses> numSamples_{};
+  int64_t numRequests_{0};
+  int64_t numHedged_{0};
+};
+
+} // namespace facebook::velox
@@ -16,11 +16,18 @@
 
 #include "velox/connectors/hive/storage_adapters/s3fs/S3FileSystem.h"
 #include "velox/common/file/File.h"
+#include "velox/connectors/hive/storage_adapters/s3fs/ReadHedger.h"
 #include "velox/connectors/hive/storage_adapters/s3fs/S3Util.h"
 #include "velox/core/Context.h"
+#include "velox/dwio/common/DataSink.h"
 
 #include <fmt/format.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/futures/Future.h>
 #include <glog/logging.h>
+#include <chrono>
+#include <deque>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -31,14 +38,38 @@
 #include <aws/core/utils/logging/ConsoleLogSystem.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/model/GetObjectRequest.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/HeadObjectRequest.h>
+#include <aws/s3/model/PutObjectRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
 
 namespace facebook::velox {
 namespace {
 class S3ReadFile final : public ReadFile {
  public:
-  S3ReadFile(const std::string& path, Aws::S3::S3Client* client)
-      : client_(client) {
+  // Ranges of preadv() separated by at most this many bytes are read
+  // in a single GET. The skipped bytes are cheaper than the latency of
+  // a separate request.
+  static constexpr uint64_t kMaxCoalesceDistance = 512 << 10;
+
+  // Maximum size of a single GET. Larger reads are split so that the
+  // parts are fetched in parallel.
+  static constexpr uint64_t kMaxRangeSize = 8 << 20;
+
+  // How often a hedged GET checks which of its requests is done.
+  static constexpr std::chrono::milliseconds kHedgePollInterval{1};
+
+  // If 'executor' is not nullptr, preadv() and preadvAsync() issue
+  // the GETs of a read in parallel on 'executor'. If 'hedger' is not
+  // nullptr, slow GETs are hedged as it decides.
+  S3ReadFile(
+      const std::string& path,
+      Aws::S3::S3Client* client,
+      folly::Executor* executor,
+      ReadHedger* hedger)
+      : client_(client), executor_(executor), hedger_(hedger) {
     bucketAndKeyFromS3Path(path, bucket_, key_);
   }
 
@@ -85,7 +116,40 @@ class S3ReadFile final : public ReadFile {
   uint64_t preadv(
       uint64_t offset,
       const std::vector<folly::Range<char*>>& buffers) override {
-    VELOX_NYI();
+    auto reads = coalesce(offset, buffers);
+    if (executor_ && reads.size() > 1) {
+      return preadvAsync(offset, buffers).get();
+    }
+    for (auto& read : reads) {
+      readRange(read);
+    }
+    return totalSize(buffers);
+  }
+
+  // Issues the GETs of the read on 'executor_'. The caller keeps
+  // 'this' and the memory of 'buffers' alive until the result is
+  // ready.
+  folly::SemiFuture<uint64_t> preadvAsync(
+      uint64_t offset,
+      const std::vector<folly::Range<char*>>& buffers) override {
+    if (!executor_) {
+      return ReadFile::preadvAsync(offset, buffers);
+    }
+    std::vector<folly::SemiFuture<folly::Unit>> futures;
+    for (auto& read : coalesce(offset, buffers)) {
+      futures.push_back(
+          folly::via(executor_, [this, read = std::move(read)]() {
+            readRange(read);
+          }).semi());
+    }
+    return folly::collect(std::move(futures))
+        .deferValue([size = totalSize(buffers)](auto&& /*unused*/) {
+          return size;
+        });
+  }
+
+  bool hasPreadvAsync() const override {
+    return executor_ != nullptr;
   }
 
   uint64_t size() const override {
@@ -102,14 +166,80 @@ class S3ReadFile final : public ReadFile {
     return false;
   }
 
+  // About 10ms per GET, with gaps of up to kMaxCoalesceDistance read over
+  // as in preadv().
+  ReadCost readCost() const final {
+    return ReadCost{10'000, 10'000.0 / kMaxCoalesceDistance};
+  }
+
  private:
-  // The assumption here is that "position" has space for at least "length"
-  // bytes.
-  void preadInternal(uint64_t offset, uint64_t length, char* position) const {
-    // Read the desired range of bytes.
-    Aws::S3::Model::GetObjectRequest request;
-    Aws::S3::Model::GetObjectResult result;
+  // A single ranged GET filling 'buffers'. Buffers with nullptr data
+  // are skipped.
+  struct RangeRead {
+    uint64_t offset;
+    uint64_t length;
+    std::vector<folly::Range<char*>> buffers;
+  };
+
+  static uint64_t totalSize(const std::vector<folly::Range<char*>>& buffers) {
+    uint64_t size = 0;
+    for (auto& buffer : buffers) {
+      size += buffer.size();
+    }
+    return size;
+  }
+
+  // Divides the read of 'buffers' starting at 'offset' into GETs of at
+  // most about kMaxRangeSize bytes. Skipped ranges of over
+  // kMaxCoalesceDistance bytes are not read.
+  static std::vector<RangeRead> coalesce(
+      uint64_t offset,
+      const std::vector<folly::Range<char*>>& buffers) {
+    std::vector<RangeRead> reads;
+    // True if the next buffer can be added to reads.back().
+    bool open = false;
+    uint64_t position = offset;
+    for (auto& buffer : buffers) {
+      if (!buffer.data()) {
+        if (open && buffer.size() <= kMaxCoalesceDistance) {
+          reads.back().buffers.push_back(buffer);
+          reads.back().length += buffer.size();
+        } else {
+          open = false;
+        }
+        position += buffer.size();
+        continue;
+      }
+      auto data = buffer.data();
+      uint64_t size = buffer.size();
+      while (size > 0) {
+        if (!open || reads.back().length >= kMaxRangeSize) {
+          reads.push_back(RangeRead{position, 0, {}});
+          open = true;
+        }
+        auto& read = reads.back();
+        auto bytes = std::min<uint64_t>(size, kMaxRangeSize - read.length);
+        read.buffers.push_back(folly::Range<char*>(data, bytes));
+        read.length += bytes;
+        data += bytes;
+        size -= bytes;
+        position += bytes;
+      }
+    }
+    // A read does not end with skipped bytes.
+    for (auto& read : reads) {
+      while (!read.buffers.back().data()) {
+        read.length -= read.buffers.back().size();
+        read.buffers.pop_back();
+      }
+    }
+    return reads;
+  }
 
+  // Returns the result of a GET of 'length' bytes from 'offset'.
+  Aws::S3::Model::GetObjectResult getObject(uint64_t offset, uint64_t length)
+      const {
+    Aws::S3::Model::GetObjectRequest request;
     request.SetBucket(awsString(bucket_));
     request.SetKey(awsString(key_));
     std::stringstream ss;
@@ -117,20 +247,289 @@ class S3ReadFile final : public ReadFile {
     request.SetRange(awsString(ss.str()));
     // TODO: Avoid copy below by using  req.SetResponseStreamFactory();
     // Reference: ARROW-8692
-    auto outcome = client_->GetObject(request);
+    auto outcome = hedger_ ? hedgedGetObject(request, length)
+                           : client_->GetObject(request);
     VELOX_CHECK_AWS_OUTCOME(
-        outcome, "Failure in S3ReadFile::preadInternal", bucket_, key_);
+        outcome, "Failure in S3ReadFile::getObject", bucket_, key_);
+    return std::move(outcome).GetResultWithOwnership();
+  }
 
-    result = std::move(outcome).GetResultWithOwnership();
+  // Issues 'request' for 'length' bytes. If it is not done within the
+  // hedge delay and the budget allows, issues it again and returns the
+  // first of the two to succeed. The other one completes in the background
+  // and its result is dropped.
+  Aws::S3::Model::GetObjectOutcome hedgedGetObject(
+      const Aws::S3::Model::GetObjectRequest& request,
+      uint64_t length) const {
+    using Clock = std::chrono::steady_clock;
+    auto elapsedSince = [](Clock::time_point start) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+          Clock::now() - start);
+    };
+    auto delay = hedger_->hedgeDelay(length);
+    auto start = Clock::now();
+    if (!delay.has_value()) {
+      auto outcome = client_->GetObject(request);
+      hedger_->record(length, elapsedSince(start));
+      return outcome;
+    }
+    auto first = client_->GetObjectCallable(request);
+    if (first.wait_for(delay.value()) == std::future_status::ready ||
+        !hedger_->tryHedge()) {
+      auto outcome = first.get();
+      hedger_->record(length, elapsedSince(start));
+      return outcome;
+    }
+    auto hedgeStart = Clock::now();
+    auto second = client_->GetObjectCallable(request);
+    for (;;) {
+      if (first.valid() &&
+          first.wait_for(kHedgePollInterval) == std::future_status::ready) {
+        auto outcome = first.get();
+        if (outcome.IsSuccess() || !second.valid()) {
+          hedger_->record(length, elapsedSince(start));
+          return outcome;
+        }
+      }
+      if (second.valid() &&
+          second.wait_for(first.valid() ? std::chrono::milliseconds(0)
+                                        : kHedgePollInterval) ==
+              std::future_status::ready) {
+        auto outcome = second.get();
+        if (outcome.IsSuccess() || !first.valid()) {
+          hedger_->record(length, elapsedSince(hedgeStart));
+          return outcome;
+        }
+      }
+    }
+  }
+
+  // The assumption here is that "position" has space for at least "length"
+  // bytes.
+  void preadInternal(uint64_t offset, uint64_t length, char* position) const {
+    auto result = getObject(offset, length);
     auto& stream = result.GetBody();
     stream.read(reinterpret_cast<char*>(position), length);
   }
 
+  void readRange(const RangeRead& read) const {
+    auto result = getObject(read.offset, read.length);
+    auto& stream = result.GetBody();
+    for (auto& buffer : read.buffers) {
+      if (buffer.data()) {
+        stream.read(buffer.data(), buffer.size());
+      } else {
+        stream.ignore(buffer.size());
+      }
+    }
+    VELOX_CHECK(
+        stream.good(),
+        "Short read from S3 object {}/{} at {}",
+        bucket_,
+        key_,
+        read.offset);
+  }
+
   Aws::S3::S3Client* client_;
+  folly::Executor* executor_;
+  ReadHedger* hedger_;
   std::string bucket_;
   std::string key_;
   int64_t length_ = -1;
 };
+
+// Uploads the appended data in parts of 'partSize' bytes with a multipart
+// upload. Full parts are uploaded on 'executor' while appends continue. An
+// append blocks only when 'maxPendingParts' parts are in flight, so the
+// buffered data is at most about (maxPendingParts + 1) * partSize bytes. A
+// file smaller than a part is written with a single PUT on close().
+class S3WriteFile final : public WriteFile {
+ public:
+  // S3 requires all parts but the last to be at least 5MB.
+  static constexpr uint64_t kMinPartSize = 5 << 20;
+
+  S3WriteFile(
+      const std::string& path,
+      Aws::S3::S3Client* client,
+      folly::Executor* executor,
+      uint64_t partSize,
+      int32_t maxPendingParts)
+      : client_(client),
+        executor_(executor),
+        partSize_(partSize),
+        maxPendingParts_(maxPendingParts) {
+    VELOX_CHECK_GE(partSize_, kMinPartSize);
+    VELOX_CHECK_GT(maxPendingParts_, 0);
+    bucketAndKeyFromS3Path(path, bucket_, key_);
+  }
+
+  ~S3WriteFile() {
+    if (!closed_) {
+      LOG(WARNING) << "S3 file " << bucket_ << "/" << key_
+                   << " is destroyed without close()";
+      abort();
+    }
+  }
+
+  void append(std::string_view data) override {
+    VELOX_CHECK(!closed_, "Append to closed S3 file {}/{}", bucket_, key_);
+    size_ += data.size();
+    while (!data.empty()) {
+      auto bytes = std::min<uint64_t>(data.size(), partSize_ - part_.size());
+      part_.append(data.data(), bytes);
+      data.remove_prefix(bytes);
+      if (part_.size() == partSize_) {
+        uploadPart();
+      }
+    }
+  }
+
+  // Waits for the parts in flight. Data short of a full part stays buffered
+  // until close() since only the last part may be smaller.
+  void flush() override {
+    waitForParts(0);
+  }
+
+  void close() override {
+    if (closed_) {
+      return;
+    }
+    if (uploadId_.empty()) {
+      putObject();
+      closed_ = true;
+      return;
+    }
+    if (!part_.empty()) {
+      uploadPart();
+    }
+    waitForParts(0);
+
+    Aws::S3::Model::CompletedMultipartUpload upload;
+    for (auto& part : completedParts_) {
+      upload.AddParts(std::move(part));
+    }
+    Aws::S3::Model::CompleteMultipartUploadRequest request;
+    request.SetBucket(awsString(bucket_));
+    request.SetKey(awsString(key_));
+    request.SetUploadId(uploadId_);
+    request.SetMultipartUpload(std::move(upload));
+    auto outcome = client_->CompleteMultipartUpload(request);
+    VELOX_CHECK_AWS_OUTCOME(
+        outcome, "Failed to complete S3 multipart upload", bucket_, key_);
+    closed_ = true;
+  }
+
+  uint64_t size() const override {
+    return size_;
+  }
+
+ private:
+  static std::shared_ptr<Aws::IOStream> makeBody(const std::string& data) {
+    auto body = Aws::MakeShared<Aws::StringStream>("S3WriteFile");
+    body->write(data.data(), data.size());
+    return body;
+  }
+
+  void putObject() {
+    Aws::S3::Model::PutObjectRequest request;
+    request.SetBucket(awsString(bucket_));
+    request.SetKey(awsString(key_));
+    request.SetContentLength(part_.size());
+    request.SetBody(makeBody(part_));
+    auto outcome = client_->PutObject(request);
+    VELOX_CHECK_AWS_OUTCOME(outcome, "Failed to put S3 object", bucket_, key_);
+  }
+
+  // Starts the upload of 'part_' as the next part, waiting first if
+  // 'maxPendingParts_' parts are in flight.
+  void uploadPart() {
+    if (uploadId_.empty()) {
+      Aws::S3::Model::CreateMultipartUploadRequest request;
+      request.SetBucket(awsString(bucket_));
+      request.SetKey(awsString(key_));
+      auto outcome = client_->CreateMultipartUpload(request);
+      VELOX_CHECK_AWS_OUTCOME(
+          outcome, "Failed to start S3 multipart upload", bucket_, key_);
+      uploadId_ = outcome.GetResult().GetUploadId();
+    }
+    waitForParts(maxPendingParts_ - 1);
+    // Part numbers start at 1.
+    int32_t partNumber = completedParts_.size() + pendingParts_.size() + 1;
+    auto data = std::move(part_);
+    part_.clear();
+    if (!executor_) {
+      completedParts_.push_back(uploadPartSync(partNumber, data));
+      return;
+    }
+    pendingParts_.push_back(folly::via(
+        executor_, [this, partNumber, data = std::move(data)]() {
+          return uploadPartSync(partNumber, data);
+        }));
+  }
+
+  Aws::S3::Model::CompletedPart uploadPartSync(
+      int32_t partNumber,
+      const std::string& data) const {
+    Aws::S3::Model::UploadPartRequest request;
+    request.SetBucket(awsString(bucket_));
+    request.SetKey(awsString(key_));
+    request.SetUploadId(uploadId_);
+    request.SetPartNumber(partNumber);
+    request.SetContentLength(data.size());
+    request.SetBody(makeBody(data));
+    auto outcome = client_->UploadPart(request);
+    VELOX_CHECK_AWS_OUTCOME(
+        outcome, "Failed to upload S3 part", bucket_, key_);
+    return Aws::S3::Model::CompletedPart()
+        .WithETag(outcome.GetResult().GetETag())
+        .WithPartNumber(partNumber);
+  }
+
+  // Waits until at most 'maxPending' parts are in flight. The parts are
+  // collected in order of part number, as CompleteMultipartUpload expects.
+  void waitForParts(size_t maxPending) {
+    while (pendingParts_.size() > maxPending) {
+      auto part = std::move(pendingParts_.front());
+      pendingParts_.pop_front();
+      completedParts_.push_back(std::move(part).get());
+    }
+  }
+
+  // Abandons the upload so that the uploaded parts are not kept.
+  void abort() {
+    for (auto& part : pendingParts_) {
+      part.wait();
+    }
+    pendingParts_.clear();
+    closed_ = true;
+    if (uploadId_.empty()) {
+      return;
+    }
+    Aws::S3::Model::AbortMultipartUploadRequest request;
+    request.SetBucket(awsString(bucket_));
+    request.SetKey(awsString(key_));
+    request.SetUploadId(uploadId_);
+    auto outcome = client_->AbortMultipartUpload(request);
+    if (!outcome.IsSuccess()) {
+      LOG(WARNING) << "Failed to abort S3 multipart upload of " << bucket_
+                   << "/" << key_;
+    }
+  }
+
+  Aws::S3::S3Client* client_;
+  folly::Executor* executor_;
+  const uint64_t partSize_;
+  const int32_t maxPendingParts_;
+  std::string bucket_;
+  std::string key_;
+  Aws::String uploadId_;
+  // The data of the next part.
+  std::string part_;
+  std::deque<folly::Future<Aws::S3::Model::CompletedPart>> pendingParts_;
+  std::vector<Aws::S3::Model::CompletedPart> completedParts_;
+  uint64_t size_{0};
+  bool closed_{false};
+};
 } // namespace
 
 namespace filesystems {
@@ -144,6 +543,22 @@ constexpr char const* kAccessKey{"hive.s3.aws-access-key"};
 constexpr char const* kSSLEnabled{"hive.s3.ssl.enabled"};
 constexpr char const* kUseInstanceCredentials{
     "hive.s3.use-instance-credentials"};
+// Number of threads issuing the GETs of preadv() in parallel. 0 reads
+// on the calling thread.
+constexpr char const* kMaxConcurrentReads{"hive.s3.max-concurrent-reads"};
+// Number of threads uploading the parts of written files. 0 uploads on
+// the writing thread.
+constexpr char const* kMaxConcurrentUploads{"hive.s3.max-concurrent-uploads"};
+// Size of the parts of a multipart upload. At least 5MB.
+constexpr char const* kUploadPartSize{"hive.s3.upload-part-size"};
+// Number of parts of a written file that may be in flight before appends
+// wait. Bounds the memory buffered per file.
+constexpr char const* kMaxPendingUploads{"hive.s3.max-pending-uploads"};
+// A GET that takes longer than this percentile of the recent GETs of a
+// similar size is hedged with a second GET. 0 disables hedging.
+constexpr char const* kHedgePercentile{"hive.s3.hedge-percentile"};
+// Maximum percentage of GETs that are hedged.
+constexpr char const* kHedgeBudgetPct{"hive.s3.hedge-budget-pct"};
 } // namespace
 } // namespace S3Config
 
@@ -159,6 +574,9 @@ class S3FileSystem::Impl {
   }
 
   ~Impl() {
+    // Finishes pending reads and uploads before the client goes away.
+    executor_.reset();
+    uploadExecutor_.reset();
     const size_t newCount = --initCounter_;
     if (newCount == 0) {
       Aws::SDKOptions awsOptions;
@@ -215,6 +633,34 @@ class S3FileSystem::Impl {
       credentialsProvider = getDefaultCredentialProvider();
     }
 
+    const auto maxConcurrentReads =
+        config_->get(S3Config::kMaxConcurrentReads, 16);
+    if (maxConcurrentReads > 0) {
+      clientConfig.maxConnections =
+          std::max<uint32_t>(clientConfig.maxConnections, maxConcurrentReads);
+      executor_ = std::make_unique<folly::IOThreadPoolExecutor>(
+          maxConcurrentReads, maxConcurrentReads);
+    }
+
+    const auto maxConcurrentUploads =
+        config_->get(S3Config::kMaxConcurrentUploads, 16);
+    if (maxConcurrentUploads > 0) {
+      clientConfig.maxConnections = std::max<uint32_t>(
+          clientConfig.maxConnections,
+          std::max(maxConcurrentReads, 0) + maxConcurrentUploads);
+      uploadExecutor_ = std::make_unique<folly::IOThreadPoolExecutor>(
+          maxConcurrentUploads, maxConcurrentUploads);
+    }
+    uploadPartSize_ =
+        config_->get<uint64_t>(S3Config::kUploadPartSize, 8 << 20);
+    maxPendingUploads_ = config_->get(S3Config::kMaxPendingUploads, 4);
+
+    const auto hedgePercentile = config_->get(S3Config::kHedgePercentile, 95);
+    if (hedgePercentile > 0) {
+      hedger_ = std::make_unique<ReadHedger>(
+          hedgePercentile, config_->get(S3Config::kHedgeBudgetPct, 5));
+    }
+
     client_ = std::make_shared<Aws::S3::S3Client>(
         credentialsProvider,
         clientConfig,
@@ -222,6 +668,31 @@ class S3FileSystem::Impl {
         useVirtualAddressing);
   }
 
+  // Executor for parallel reads or nullptr if reads are done on the
+  // calling thread.
+  folly::Executor* executor() const {
+    return executor_.get();
+  }
+
+  // Executor for uploading parts of written files or nullptr if they are
+  // uploaded on the writing thread.
+  folly::Executor* uploadExecutor() const {
+    return uploadExecutor_.get();
+  }
+
+  // Decides on hedging GETs or nullptr if GETs are not hedged.
+  ReadHedger* hedger() const {
+    return hedger_.get();
+  }
+
+  uint64_t uploadPartSize() const {
+    return uploadPartSize_;
+  }
+
+  int32_t maxPendingUploads() const {
+    return maxPendingUploads_;
+  }
+
   // Make it clear that the S3FileSystem instance owns the S3Client.
   // Once the S3FileSystem is destroyed, the S3Client fails to work
   // due to the Aws::ShutdownAPI invocation in the destructor.
@@ -232,6 +703,11 @@ class S3FileSystem::Impl {
  private:
   const Config* config_;
   std::shared_ptr<Aws::S3::S3Client> client_;
+  std::unique_ptr<folly::IOThreadPoolExecutor> executor_;
+  std::unique_ptr<folly::IOThreadPoolExecutor> uploadExecutor_;
+  std::unique_ptr<ReadHedger> hedger_;
+  uint64_t uploadPartSize_;
+  int32_t maxPendingUploads_;
   static std::atomic<size_t> initCounter_;
 };
 
@@ -249,14 +725,20 @@ void S3FileSystem::initializeClient() {
 
 std::unique_ptr<ReadFile> S3FileSystem::openFileForRead(std::string_view path) {
   const std::string file = s3Path(path);
-  auto s3file = std::make_unique<S3ReadFile>(file, impl_->s3Client());
+  auto s3file = std::make_unique<S3ReadFile>(
+      file, impl_->s3Client(), impl_->executor(), impl_->hedger());
   s3file->initialize();
   return s3file;
 }
 
 std::unique_ptr<WriteFile> S3FileSystem::openFileForWrite(
     std::string_view path) {
-  VELOX_NYI();
+  return std::make_unique<S3WriteFile>(
+      s3Path(path),
+      impl_->s3Client(),
+      impl_->uploadExecutor(),
+      impl_->uploadPartSize(),
+      impl_->maxPendingUploads());
 }
 
 std::string S3FileSystem::name() const {
@@ -277,8 +759,25 @@ static std::function<std::shared_ptr<FileSystem>(std::shared_ptr<const Config>)>
       return s3fs;
     };
 
+namespace {
+// Writes s3:// paths of DWIO writers through S3WriteFile. The file system
+// is the one instance of S3FileSystem, configured by whoever got it first.
+std::unique_ptr<dwio::common::DataSink> s3DataSink(
+    const std::string& path,
+    const dwio::common::MetricsLogPtr& metricsLog,
+    dwio::common::IoStatistics* stats) {
+  if (!isS3File(path)) {
+    return nullptr;
+  }
+  auto fs = filesystemGenerator(std::make_shared<core::MemConfig>());
+  return std::make_unique<dwio::common::WriteFileDataSink>(
+      fs->openFileForWrite(path), path, metricsLog, stats);
+}
+} // namespace
+
 void registerS3FileSystem() {
   registerFileSystem(isS3File, filesystemGenerator);
+  dwio::common::DataSink::registerFactory(s3DataSink);
 }
 
 } // namespace filesystems
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/connectors/hive/storage_adapters/s3fs/ReadHedger.h"
+
+#include "gtest/gtest.h"
+
+using namespace facebook::velox;
+using std::chrono::microseconds;
+
+TEST(ReadHedgerTest, hedgeDelay) {
+  ReadHedger hedger(90, 10);
+  EXPECT_FALSE(hedger.hedgeDelay(1000).has_value());
+  // 90 GETs of 1KB take 100us and 10 take 10ms.
+  for (auto i = 0; i < ReadHedger::kMinSamples; ++i) {
+    hedger.record(1000, microseconds(i < 90 ? 100 : 10'000));
+  }
+  auto delay = hedger.hedgeDelay(1000);
+  ASSERT_TRUE(delay.has_value());
+  // The upper bound of the bucket of 100us.
+  EXPECT_EQ(microseconds(128), delay.value());
+  // Larger GETs have their own latencies.
+  EXPECT_FALSE(hedger.hedgeDelay(4 << 20).has_value());
+  EXPECT_EQ(ReadHedger::kMinSamples, hedger.numRequests());
+}
+
+TEST(ReadHedgerTest, budget) {
+  ReadHedger hedger(95, 10);
+  EXPECT_FALSE(hedger.tryHedge());
+  for (auto i = 0; i < 50; ++i) {
+    hedger.record(1000, microseconds(100));
+  }
+  for (auto i = 0; i < 5; ++i) {
+    EXPECT_TRUE(hedger.tryHedge());
+  }
+  EXPECT_FALSE(hedger.tryHedge());
+  EXPECT_EQ(5, hedger.numHedged());
+}
+
+TEST(ReadHedgerTest, decay) {
+  ReadHedger hedger(50, 10);
+  for (auto i = 0; i < ReadHedger::kMaxSamples; ++i) {
+    hedger.record(1000, microseconds(100));
+  }
+  EXPECT_EQ(microseconds(128), hedger.hedgeDelay(1000).value());
+  // The old samples are halved as new ones come in, so that the median
+  // moves to the new latency.
+  for (auto i = 0; i < ReadHedger::kMaxSamples; ++i) {
+    hedger.record(1000, microseconds(1000));
+  }
+  EXPECT_EQ(microseconds(1024), hedger.hedgeDelay(1000).value());
+}
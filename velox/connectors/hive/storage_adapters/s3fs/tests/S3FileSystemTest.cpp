@@ -81,6 +81,30 @@ class S3FileSystemTest : public testing::Test {
     ASSERT_EQ(zarf, "ccccccccccddddd");
     ASSERT_EQ(warf, "abbbbbcc");
     ASSERT_EQ(warfFromBuf, "abbbbbcc");
+
+    // The small gap is read over, the large one splits the read in two
+    // GETs.
+    char head[5];
+    char middle[100];
+    char tail[105];
+    std::vector<folly::Range<char*>> buffers = {
+        folly::Range<char*>(head, sizeof(head)),
+        folly::Range<char*>(nullptr, 5),
+        folly::Range<char*>(middle, sizeof(middle)),
+        folly::Range<char*>(nullptr, kOneMB - 200),
+        folly::Range<char*>(tail, sizeof(tail))};
+    ASSERT_EQ(15 + kOneMB, readFile->preadv(0, buffers));
+    ASSERT_EQ(std::string_view(head, sizeof(head)), "aaaaa");
+    ASSERT_EQ(
+        std::string_view(middle, sizeof(middle)), std::string(100, 'c'));
+    ASSERT_EQ(
+        std::string_view(tail, sizeof(tail)),
+        std::string(100, 'c') + "ddddd");
+    memset(tail, 0, sizeof(tail));
+    ASSERT_EQ(15 + kOneMB, readFile->preadvAsync(0, buffers).get());
+    ASSERT_EQ(
+        std::string_view(tail, sizeof(tail)),
+        std::string(100, 'c') + "ddddd");
   }
 
   static std::shared_ptr<MinioServer> minioServer_;
@@ -143,9 +167,46 @@ TEST_F(S3FileSystemTest, fileHandle) {
     writeData(&writeFile);
   }
   auto hiveConfig = minioServer_->hiveConfig();
-  FileHandleFactory factory(
-      std::make_unique<SimpleLRUCache<std::string, FileHandle>>(1000),
-      std::make_unique<FileHandleGenerator>(hiveConfig));
+  FileHandleFactory factory(1000, FileHandleGenerator(hiveConfig));
   auto fileHandle = factory.generate(s3File);
   readData(fileHandle->file.get());
 }
+
+TEST_F(S3FileSystemTest, writeFile) {
+  const char* bucketName = "data4";
+  addBucket(bucketName);
+  auto hiveConfig = minioServer_->hiveConfig();
+  filesystems::S3FileSystem s3fs(hiveConfig);
+  s3fs.initializeClient();
+
+  // Smaller than a part, written with a single PUT.
+  const std::string smallFile = s3URI(bucketName) + "/small.txt";
+  {
+    auto writeFile = s3fs.openFileForWrite(smallFile);
+    writeData(writeFile.get());
+    writeFile->close();
+  }
+  readData(s3fs.openFileForRead(smallFile).get());
+
+  // Uploaded in parts of 8MB, the last one shorter.
+  const std::string largeFile = s3URI(bucketName) + "/large.txt";
+  constexpr int kNumChunks = 20;
+  std::string chunk(kOneMB, 'x');
+  {
+    auto writeFile = s3fs.openFileForWrite(largeFile);
+    for (int i = 0; i < kNumChunks; ++i) {
+      chunk[0] = 'a' + i;
+      writeFile->append(chunk);
+    }
+    writeFile->close();
+    ASSERT_EQ(kNumChunks * kOneMB, writeFile->size());
+  }
+  auto readFile = s3fs.openFileForRead(largeFile);
+  ASSERT_EQ(kNumChunks * kOneMB, readFile->size());
+  for (uint64_t i = 0; i < kNumChunks; ++i) {
+    ASSERT_EQ(std::string(1, 'a' + i), readFile->pread(i * kOneMB, 1));
+    ASSERT_EQ(
+        std::string(kOneMB - 1, 'x'),
+        readFile->pread(i * kOneMB + 1, kOneMB - 1));
+  }
+}
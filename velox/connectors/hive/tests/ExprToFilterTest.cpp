@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/connectors/hive/ExprToFilter.h"
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::connector::hive;
+using namespace facebook::velox::exec::test;
+using common::FilterKind;
+
+class ExprToFilterTest : public OperatorTestBase {
+ protected:
+  std::unique_ptr<common::Filter> toFilter(const std::string& text) {
+    column_.clear();
+    return exprToFilter(*parseExpr(text, rowType_), column_);
+  }
+
+  const std::shared_ptr<const RowType> rowType_{
+      ROW({"c0", "c1", "c2", "c3", "c4"},
+          {BIGINT(), BIGINT(), VARCHAR(), DOUBLE(), BOOLEAN()})};
+  std::string column_;
+};
+
+TEST_F(ExprToFilterTest, integer) {
+  auto filter = toFilter("c0 between 10 and 20");
+  ASSERT_TRUE(filter);
+  EXPECT_EQ("c0", column_);
+  EXPECT_EQ(FilterKind::kBigintRange, filter->kind());
+  EXPECT_TRUE(filter->testInt64(10));
+  EXPECT_TRUE(filter->testInt64(20));
+  EXPECT_FALSE(filter->testInt64(21));
+  EXPECT_FALSE(filter->testNull());
+
+  // The constant may come first.
+  filter = toFilter("5 < c0");
+  ASSERT_TRUE(filter);
+  EXPECT_FALSE(filter->testInt64(5));
+  EXPECT_TRUE(filter->testInt64(6));
+
+  filter = toFilter("c0 in (1, 5, 7)");
+  ASSERT_TRUE(filter);
+  EXPECT_TRUE(filter->testInt64(5));
+  EXPECT_FALSE(filter->testInt64(6));
+
+  // Adjacent values coalesce into ranges.
+  filter = toFilter("c0 = 1 or c0 = 2 or c0 between 3 and 10 or c0 > 100");
+  ASSERT_TRUE(filter);
+  EXPECT_EQ(FilterKind::kBigintMultiRange, filter->kind());
+  EXPECT_TRUE(filter->testInt64(1));
+  EXPECT_TRUE(filter->testInt64(10));
+  EXPECT_FALSE(filter->testInt64(11));
+  EXPECT_TRUE(filter->testInt64(101));
+
+  filter = toFilter("c0 is null or c0 < 0");
+  ASSERT_TRUE(filter);
+  EXPECT_TRUE(filter->testNull());
+  EXPECT_TRUE(filter->testInt64(-1));
+  EXPECT_FALSE(filter->testInt64(0));
+
+  filter = toFilter("c0 >= 0 and c0 < 10 and c0 <> 5");
+  ASSERT_TRUE(filter);
+  EXPECT_TRUE(filter->testInt64(4));
+  EXPECT_FALSE(filter->testInt64(5));
+  EXPECT_FALSE(filter->testInt64(10));
+
+  filter = toFilter("c0 is not null");
+  ASSERT_TRUE(filter);
+  EXPECT_EQ(FilterKind::kIsNotNull, filter->kind());
+
+  filter = toFilter("c0 > 10 and c0 < 5");
+  ASSERT_TRUE(filter);
+  EXPECT_EQ(FilterKind::kAlwaysFalse, filter->kind());
+}
+
+TEST_F(ExprToFilterTest, negation) {
+  auto filter = toFilter("c0 not in (1, 5, 7)");
+  ASSERT_TRUE(filter);
+  EXPECT_FALSE(filter->testNull());
+  EXPECT_TRUE(filter->testInt64(0));
+  EXPECT_FALSE(filter->testInt64(1));
+  EXPECT_TRUE(filter->testInt64(6));
+  EXPECT_FALSE(filter->testInt64(7));
+
+  filter = toFilter("not (c0 between 1 and 10)");
+  ASSERT_TRUE(filter);
+  EXPECT_TRUE(filter->testInt64(0));
+  EXPECT_FALSE(filter->testInt64(5));
+  EXPECT_TRUE(filter->testInt64(11));
+
+  // not (c0 is null or c0 < 0) is c0 >= 0, which nulls do not pass.
+  filter = toFilter("not (c0 is null or c0 < 0)");
+  ASSERT_TRUE(filter);
+  EXPECT_FALSE(filter->testNull());
+  EXPECT_FALSE(filter->testInt64(-1));
+  EXPECT_TRUE(filter->testInt64(0));
+
+  filter = toFilter("c2 not in ('a', 'c')");
+  ASSERT_TRUE(filter);
+  EXPECT_EQ("c2", column_);
+  EXPECT_FALSE(filter->testNull());
+  EXPECT_FALSE(filter->testBytes("a", 1));
+  EXPECT_TRUE(filter->testBytes("b", 1));
+  EXPECT_FALSE(filter->testBytes("c", 1));
+  EXPECT_TRUE(filter->testBytes("cc", 2));
+
+  filter = toFilter("not (c2 < 'b')");
+  ASSERT_TRUE(filter);
+  EXPECT_FALSE(filter->testBytes("a", 1));
+  EXPECT_TRUE(filter->testBytes("b", 1));
+
+  // Negated comparisons of floating point values pass NaN.
+  EXPECT_FALSE(toFilter("not (c3 < 1.5)"));
+}
+
+TEST_F(ExprToFilterTest, other) {
+  auto filter = toFilter("c2 in ('a', 'b') or c2 > 'x'");
+  ASSERT_TRUE(filter);
+  EXPECT_EQ(FilterKind::kMultiRange, filter->kind());
+  EXPECT_TRUE(filter->testBytes("a", 1));
+  EXPECT_FALSE(filter->testBytes("c", 1));
+  EXPECT_TRUE(filter->testBytes("y", 1));
+
+  filter = toFilter("c3 between 1.5 and 2.5 or c3 is null");
+  ASSERT_TRUE(filter);
+  EXPECT_TRUE(filter->testNull());
+  EXPECT_TRUE(filter->testDouble(2.0));
+  EXPECT_FALSE(filter->testDouble(3.0));
+
+  filter = toFilter("c4 = false");
+  ASSERT_TRUE(filter);
+  EXPECT_TRUE(filter->testBool(false));
+  EXPECT_FALSE(filter->testBool(true));
+}
+
+TEST_F(ExprToFilterTest, notConvertible) {
+  EXPECT_FALSE(toFilter("c0 < c1"));
+  EXPECT_FALSE(toFilter("c0 = 1 or c2 = 'a'"));
+  EXPECT_FALSE(toFilter("c0 % 2 = 1"));
+  EXPECT_FALSE(toFilter("c0 + 1 > 10"));
+  EXPECT_FALSE(toFilter("length(c2) = 1"));
+}
@@ -17,7 +17,6 @@
 #include "velox/connectors/hive/FileHandle.h"
 
 #include "gtest/gtest.h"
-#include "velox/common/caching/SimpleLRUCache.h"
 #include "velox/common/file/File.h"
 #include "velox/common/file/FileSystems.h"
 #include "velox/common/memory/Arena.h"
@@ -37,9 +36,7 @@ TEST(FileHandleTest, localFile) {
     writeFile.append("foo");
   }
 
-  FileHandleFactory factory(
-      std::make_unique<SimpleLRUCache<std::string, FileHandle>>(1000),
-      std::make_unique<FileHandleGenerator>());
+  FileHandleFactory factory(1000, FileHandleGenerator());
   auto fileHandle = factory.generate(filename);
   ASSERT_EQ(fileHandle->file->size(), 3);
   Arena arena;
@@ -83,3 +83,53 @@ TEST_F(HivePartitionFunctionTest, bool) {
   assertPartitions(values, 500, {0, 1, 0, 0, 1});
   assertPartitions(values, 997, {0, 1, 0, 0, 1});
 }
+
+TEST_F(HivePartitionFunctionTest, encodings) {
+  auto flat = vm_.flatVector<int64_t>(
+      100, [](auto row) { return row * 300'000'000'007; });
+  auto nullable = vm_.flatVector<int64_t>(
+      100,
+      [](auto row) { return row * 300'000'000'007; },
+      [](auto row) { return row % 7 == 0; });
+
+  // Reverses the rows.
+  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(100, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  for (auto i = 0; i < 100; ++i) {
+    rawIndices[i] = 99 - i;
+  }
+  auto dictionary =
+      BaseVector::wrapInDictionary(BufferPtr(nullptr), indices, 100, flat);
+  auto constant = BaseVector::wrapInConstant(100, 7, flat);
+
+  // The partitions of the encoded vectors are the same as for the flat
+  // vector with the same values.
+  auto partition = [&](const std::vector<VectorPtr>& keys) {
+    std::vector<int> bucketToPartition(997);
+    std::iota(bucketToPartition.begin(), bucketToPartition.end(), 0);
+    std::vector<ChannelIndex> keyChannels(keys.size());
+    std::iota(keyChannels.begin(), keyChannels.end(), 0);
+    connector::hive::HivePartitionFunction partitionFunction(
+        997, bucketToPartition, keyChannels);
+    std::vector<uint32_t> partitions;
+    partitionFunction.partition(*vm_.rowVector(keys), partitions);
+    return partitions;
+  };
+
+  auto flatPartitions = partition({flat});
+  auto dictionaryPartitions = partition({dictionary});
+  auto constantPartitions = partition({constant});
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_EQ(flatPartitions[99 - i], dictionaryPartitions[i]);
+    EXPECT_EQ(flatPartitions[7], constantPartitions[i]);
+  }
+
+  // Mixing is the same for nullable and encoded second keys.
+  auto mixed = partition({nullable, dictionary});
+  auto reversed = vm_.flatVector<int64_t>(
+      100, [](auto row) { return (99 - row) * 300'000'000'007; });
+  EXPECT_EQ(mixed, partition({nullable, reversed}));
+  auto seven = vm_.flatVector<int64_t>(
+      100, [](auto /*row*/) { return 7 * 300'000'000'007; });
+  EXPECT_EQ(partition({flat, constant}), partition({flat, seven}));
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/connectors/hive/SplitAffinity.h"
+
+#include "gtest/gtest.h"
+#include "velox/common/caching/FileIds.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::connector::hive;
+
+namespace {
+
+std::vector<std::string> makeWorkers(int32_t numWorkers) {
+  std::vector<std::string> workers;
+  for (auto i = 0; i < numWorkers; ++i) {
+    workers.push_back(fmt::format("worker{}:8080", i));
+  }
+  return workers;
+}
+
+std::vector<std::shared_ptr<HiveConnectorSplit>> makeSplits(
+    int32_t numSplits) {
+  std::vector<std::shared_ptr<HiveConnectorSplit>> splits;
+  for (auto i = 0; i < numSplits; ++i) {
+    splits.push_back(std::make_shared<HiveConnectorSplit>(
+        "hive",
+        fmt::format("/table/file{}", i / 4),
+        dwio::common::FileFormat::ORC,
+        (i % 4) << 20,
+        1 << 20));
+  }
+  return splits;
+}
+
+} // namespace
+
+TEST(SplitAffinityTest, placement) {
+  constexpr int32_t kNumWorkers = 10;
+  constexpr int32_t kNumSplits = 1'000;
+  auto workers = makeWorkers(kNumWorkers);
+  auto splits = makeSplits(kNumSplits);
+  SplitAffinity affinity(workers);
+
+  std::vector<int32_t> placement;
+  std::vector<int32_t> counts(kNumWorkers);
+  for (const auto& split : splits) {
+    auto worker = affinity.preferredWorker(*split);
+    ASSERT_GE(worker, 0);
+    ASSERT_LT(worker, kNumWorkers);
+    placement.push_back(worker);
+    ++counts[worker];
+
+    auto preferred = affinity.preferredWorkers(*split, 3);
+    ASSERT_EQ(3, preferred.size());
+    EXPECT_EQ(worker, preferred[0]);
+    EXPECT_NE(preferred[0], preferred[1]);
+    EXPECT_NE(preferred[1], preferred[2]);
+    EXPECT_EQ(kNumWorkers, affinity.preferredWorkers(*split, 100).size());
+  }
+  // The splits are spread over all workers.
+  for (auto count : counts) {
+    EXPECT_LT(kNumSplits / kNumWorkers / 2, count);
+    EXPECT_GT(kNumSplits / kNumWorkers * 2, count);
+  }
+
+  // The order of the workers does not matter.
+  auto reversed = workers;
+  std::reverse(reversed.begin(), reversed.end());
+  SplitAffinity reversedAffinity(reversed);
+  for (auto i = 0; i < kNumSplits; ++i) {
+    EXPECT_EQ(
+        workers[placement[i]],
+        reversed[reversedAffinity.preferredWorker(*splits[i])]);
+  }
+
+  // A new worker takes splits only from the others. Removing the first
+  // worker moves only its splits.
+  auto moreWorkers = makeWorkers(kNumWorkers + 1);
+  SplitAffinity moreAffinity(moreWorkers);
+  std::vector<std::string> fewerWorkers(workers.begin() + 1, workers.end());
+  SplitAffinity fewerAffinity(fewerWorkers);
+  int32_t numMoved = 0;
+  for (auto i = 0; i < kNumSplits; ++i) {
+    auto worker = moreAffinity.preferredWorker(*splits[i]);
+    if (worker != placement[i]) {
+      EXPECT_EQ(kNumWorkers, worker);
+      ++numMoved;
+    }
+    if (placement[i] != 0) {
+      EXPECT_EQ(
+          workers[placement[i]],
+          fewerWorkers[fewerAffinity.preferredWorker(*splits[i])]);
+    }
+  }
+  EXPECT_LT(0, numMoved);
+  EXPECT_GT(kNumSplits / kNumWorkers * 2, numMoved);
+}
+
+TEST(SplitAffinityTest, cachedBytes) {
+  auto cache = std::make_shared<cache::AsyncDataCache>(
+      memory::MappedMemory::createDefaultInstance(), 16 << 20);
+  auto splits = makeSplits(8);
+  // Caches 3 entries of 100KB in the second split of the first file.
+  StringIdLease fileNum(fileIds(), splits[1]->filePath);
+  for (auto i = 0; i < 3; ++i) {
+    auto pin = cache->findOrCreate(
+        {fileNum.id(), splits[1]->start + i * 100'000}, 100'000);
+    ASSERT_FALSE(pin.empty());
+    pin.entry()->setValid();
+  }
+  auto ranges = cachedBytes(splits, *cache);
+  ASSERT_EQ(splits.size(), ranges.size());
+  for (auto i = 0; i < splits.size(); ++i) {
+    EXPECT_EQ(i == 1 ? 300'000 : 0, ranges[i].memoryBytes) << i;
+    EXPECT_EQ(0, ranges[i].ssdBytes);
+  }
+}
@@ -15,6 +15,8 @@
  */
 #include "velox/core/PlanNode.h"
 
+#include <algorithm>
+
 namespace facebook::velox::core {
 
 namespace {
@@ -61,14 +63,45 @@ AggregationNode::AggregationNode(
         aggregateMasks,
     bool ignoreNullKeys,
     std::shared_ptr<const PlanNode> source)
+    : AggregationNode(
+          id,
+          step,
+          groupingKeys,
+          {},
+          aggregateNames,
+          aggregates,
+          aggregateMasks,
+          ignoreNullKeys,
+          std::move(source)) {}
+
+AggregationNode::AggregationNode(
+    const PlanNodeId& id,
+    Step step,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        groupingKeys,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        preGroupedKeys,
+    const std::vector<std::string>& aggregateNames,
+    const std::vector<std::shared_ptr<const CallTypedExpr>>& aggregates,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        aggregateMasks,
+    bool ignoreNullKeys,
+    std::shared_ptr<const PlanNode> source,
+    int64_t numGroupsHint,
+    const std::vector<bool>& distinctAggregates,
+    const std::vector<AggregateOrdering>& aggregateOrderings)
     : PlanNode(id),
       step_(step),
       groupingKeys_(groupingKeys),
+      preGroupedKeys_(preGroupedKeys),
       aggregateNames_(aggregateNames),
       aggregates_(aggregates),
       aggregateMasks_(aggregateMasks),
       ignoreNullKeys_(ignoreNullKeys),
       sources_{source},
+      numGroupsHint_(numGroupsHint),
+      distinctAggregates_(distinctAggregates),
+      aggregateOrderings_(aggregateOrderings),
       outputType_(getAggregationOutputType(
           groupingKeys_,
           aggregateNames_,
@@ -80,6 +113,43 @@ AggregationNode::AggregationNode(
   VELOX_CHECK(
       !groupingKeys_.empty() || !aggregates_.empty(),
       "Aggregation must specify either grouping keys or aggregates");
+  VELOX_CHECK_GE(
+      numGroupsHint_, 0, "Number of groups hint must not be negative");
+  if (!distinctAggregates_.empty()) {
+    VELOX_CHECK_EQ(
+        distinctAggregates_.size(),
+        aggregates_.size(),
+        "Distinct flags must be given for all aggregates");
+  }
+  // A partial step cannot drop duplicates that another partial step sees.
+  VELOX_CHECK(
+      !hasDistinctAggregates() || step_ == Step::kSingle,
+      "DISTINCT aggregates require a single step aggregation");
+  if (!aggregateOrderings_.empty()) {
+    VELOX_CHECK_EQ(
+        aggregateOrderings_.size(),
+        aggregates_.size(),
+        "Orderings must be given for all aggregates");
+    for (const auto& ordering : aggregateOrderings_) {
+      VELOX_CHECK_EQ(
+          ordering.sortingKeys.size(), ordering.sortingOrders.size());
+    }
+  }
+  // Partial results cannot be merged in order.
+  VELOX_CHECK(
+      !hasOrderedAggregates() || step_ == Step::kSingle,
+      "Ordered aggregates require a single step aggregation");
+  for (const auto& key : preGroupedKeys_) {
+    VELOX_CHECK(
+        std::find_if(
+            groupingKeys_.begin(),
+            groupingKeys_.end(),
+            [&](const auto& groupingKey) {
+              return groupingKey->name() == key->name();
+            }) != groupingKeys_.end(),
+        "Pre-grouped key must be a grouping key: {}",
+        key->name());
+  }
 }
 
 const std::vector<std::shared_ptr<const PlanNode>>& ValuesNode::sources()
@@ -146,6 +216,95 @@ UnnestNode::UnnestNode(
   outputType_ = ROW(std::move(names), std::move(types));
 }
 
+TopNRowNumberNode::TopNRowNumberNode(
+    const PlanNodeId& id,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        partitionKeys,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        sortingKeys,
+    const std::vector<SortOrder>& sortingOrders,
+    const std::optional<std::string>& rowNumberColumnName,
+    int32_t limit,
+    std::shared_ptr<const PlanNode> source)
+    : PlanNode(id),
+      partitionKeys_(partitionKeys),
+      sortingKeys_(sortingKeys),
+      sortingOrders_(sortingOrders),
+      generateRowNumber_(rowNumberColumnName.has_value()),
+      limit_(limit),
+      sources_{std::move(source)} {
+  VELOX_CHECK(
+      !partitionKeys_.empty(),
+      "TopNRowNumber must specify partition keys, use TopN otherwise");
+  VELOX_CHECK(!sortingKeys_.empty(), "TopNRowNumber must specify sorting keys");
+  VELOX_CHECK_EQ(
+      sortingKeys_.size(),
+      sortingOrders_.size(),
+      "Number of sorting keys and sorting orders in TopNRowNumber must be the same");
+  VELOX_CHECK_GT(
+      limit_, 0, "TopNRowNumber must keep more than zero rows per partition");
+
+  std::vector<std::string> names(sources_[0]->outputType()->names());
+  std::vector<TypePtr> types(sources_[0]->outputType()->children());
+  if (generateRowNumber_) {
+    names.push_back(rowNumberColumnName.value());
+    types.push_back(BIGINT());
+  }
+  outputType_ = ROW(std::move(names), std::move(types));
+}
+
+WindowNode::WindowNode(
+    const PlanNodeId& id,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        partitionKeys,
+    const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+        sortingKeys,
+    const std::vector<SortOrder>& sortingOrders,
+    const std::vector<std::string>& windowColumnNames,
+    const std::vector<Function>& windowFunctions,
+    bool inputsSorted,
+    std::shared_ptr<const PlanNode> source)
+    : PlanNode(id),
+      partitionKeys_(partitionKeys),
+      sortingKeys_(sortingKeys),
+      sortingOrders_(sortingOrders),
+      windowFunctions_(windowFunctions),
+      inputsSorted_(inputsSorted),
+      sources_{std::move(source)} {
+  VELOX_CHECK_EQ(
+      sortingKeys_.size(),
+      sortingOrders_.size(),
+      "Number of sorting keys and sorting orders in Window must be the same");
+  VELOX_CHECK_EQ(
+      windowColumnNames.size(),
+      windowFunctions_.size(),
+      "Number of window column names must be equal to number of window functions");
+
+  std::vector<std::string> names(sources_[0]->outputType()->names());
+  std::vector<TypePtr> types(sources_[0]->outputType()->children());
+  for (auto i = 0; i < windowFunctions_.size(); ++i) {
+    names.push_back(windowColumnNames[i]);
+    types.push_back(windowFunctions_[i].functionCall->type());
+  }
+  outputType_ = ROW(std::move(names), std::move(types));
+}
+
+void WindowNode::addDetails(std::stringstream& stream) const {
+  stream << "partition by: ";
+  for (const auto& key : partitionKeys_) {
+    stream << key->toString() << ", ";
+  }
+  stream << "order by: ";
+  for (auto i = 0; i < sortingKeys_.size(); ++i) {
+    stream << "(" << sortingKeys_[i]->toString() << " "
+           << sortingOrders_[i].toString() << "), ";
+  }
+  stream << "functions: ";
+  for (const auto& function : windowFunctions_) {
+    stream << function.functionCall->toString() << ", ";
+  }
+}
+
 AbstractJoinNode::AbstractJoinNode(
     const PlanNodeId& id,
     JoinType joinType,
@@ -212,10 +371,12 @@ CrossJoinNode::CrossJoinNode(
     const PlanNodeId& id,
     std::shared_ptr<const PlanNode> left,
     std::shared_ptr<const PlanNode> right,
-    RowTypePtr outputType)
+    RowTypePtr outputType,
+    std::shared_ptr<const ITypedExpr> filter)
     : PlanNode(id),
       sources_({std::move(left), std::move(right)}),
-      outputType_(std::move(outputType)) {}
+      outputType_(std::move(outputType)),
+      filter_(std::move(filter)) {}
 
 AssignUniqueIdNode::AssignUniqueIdNode(
     const PlanNodeId& id,
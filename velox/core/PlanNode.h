@@ -306,11 +306,13 @@ class TableScanNode : public PlanNode {
       const std::shared_ptr<connector::ConnectorTableHandle>& tableHandle,
       const std::unordered_map<
           std::string,
-          std::shared_ptr<connector::ColumnHandle>>& assignments)
+          std::shared_ptr<connector::ColumnHandle>>& assignments,
+      std::string resultCacheFingerprint = "")
       : PlanNode(id),
         outputType_(outputType),
         tableHandle_(tableHandle),
-        assignments_(assignments) {}
+        assignments_(assignments),
+        resultCacheFingerprint_(std::move(resultCacheFingerprint)) {}
 
   const std::vector<std::shared_ptr<const PlanNode>>& sources() const override;
 
@@ -328,6 +330,16 @@ class TableScanNode : public PlanNode {
     return assignments_;
   }
 
+  // If not empty, identifies this scan and the filters, projections and
+  // partial aggregation over it, so that the partial aggregation results of
+  // each split can be cached and reused by plans with the same
+  // fingerprint. Set by the producer of the plan, which must give
+  // different fingerprints to plans that compute different results. See
+  // QueryConfig::kFragmentResultCacheEnabled.
+  const std::string& resultCacheFingerprint() const {
+    return resultCacheFingerprint_;
+  }
+
   std::string_view name() const override {
     return "table scan";
   }
@@ -338,6 +350,7 @@ class TableScanNode : public PlanNode {
   const std::
       unordered_map<std::string, std::shared_ptr<connector::ColumnHandle>>
           assignments_;
+  const std::string resultCacheFingerprint_;
 };
 
 class TableWriteNode : public PlanNode {
@@ -348,17 +361,29 @@ class TableWriteNode : public PlanNode {
       const std::vector<std::string>& columnNames,
       const std::shared_ptr<InsertTableHandle>& insertTableHandle,
       const RowTypePtr& outputType,
-      const std::shared_ptr<const PlanNode>& source)
+      const std::shared_ptr<const PlanNode>& source,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          sortingKeys = {},
+      const std::vector<SortOrder>& sortingOrders = {})
       : PlanNode(id),
         sources_{source},
         columns_{columns},
         columnNames_{columnNames},
         insertTableHandle_(insertTableHandle),
-        outputType_(outputType) {
+        outputType_(outputType),
+        sortingKeys_(sortingKeys),
+        sortingOrders_(sortingOrders) {
     VELOX_CHECK_EQ(columns->size(), columnNames.size());
     for (const auto& column : columns->names()) {
       VELOX_CHECK(source->outputType()->containsChild(column));
     }
+    VELOX_CHECK_EQ(
+        sortingKeys.size(),
+        sortingOrders.size(),
+        "Number of sorting keys and sorting orders in TableWrite must be the same");
+    for (const auto& key : sortingKeys) {
+      VELOX_CHECK(source->outputType()->containsChild(key->name()));
+    }
   }
 
   const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
@@ -385,6 +410,20 @@ class TableWriteNode : public PlanNode {
     return insertTableHandle_;
   }
 
+  /// Columns of the source to sort the rows of each written file by. Each
+  /// writer buffers and sorts its input, spilling if enabled, before the rows
+  /// reach the data sink. Files sorted on commonly filtered columns get
+  /// narrow per stripe and row group min/max statistics, which readers use
+  /// to skip data. Empty if the rows are written in arrival order.
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& sortingKeys()
+      const {
+    return sortingKeys_;
+  }
+
+  const std::vector<SortOrder>& sortingOrders() const {
+    return sortingOrders_;
+  }
+
   std::string_view name() const override {
     return "table write";
   }
@@ -395,6 +434,8 @@ class TableWriteNode : public PlanNode {
   const std::vector<std::string> columnNames_;
   const std::shared_ptr<InsertTableHandle> insertTableHandle_;
   const RowTypePtr outputType_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> sortingKeys_;
+  const std::vector<SortOrder> sortingOrders_;
 };
 
 class AggregationNode : public PlanNode {
@@ -410,6 +451,13 @@ class AggregationNode : public PlanNode {
     kSingle
   };
 
+  // Sorting keys of an aggregate that consumes its input in order, e.g.
+  // array_agg(x ORDER BY y). No keys means any order.
+  struct AggregateOrdering {
+    std::vector<std::shared_ptr<const FieldAccessTypedExpr>> sortingKeys;
+    std::vector<SortOrder> sortingOrders;
+  };
+
   /**
    * @param ignoreNullKeys True if rows with at least one null key should be
    * ignored. Used when group by is a source of a join build side and grouping
@@ -427,6 +475,38 @@ class AggregationNode : public PlanNode {
       bool ignoreNullKeys,
       std::shared_ptr<const PlanNode> source);
 
+  /**
+   * @param preGroupedKeys Subset of 'groupingKeys' on which the input is
+   * clustered, i.e. all rows with the same values of these keys are adjacent.
+   * If all grouping keys are pre-grouped, the aggregation runs in streaming
+   * mode and produces each group as soon as its last row has been seen.
+   * @param numGroupsHint Estimated number of groups, e.g. from connector
+   * statistics, or 0 if unknown. Used to pre-size the hash table of a final
+   * or single aggregation so that it does not rehash repeatedly as it grows.
+   * @param distinctAggregates Empty or one flag per aggregate. A flagged
+   * aggregate only sees the distinct values of its arguments in each group,
+   * e.g. count(DISTINCT x). Requires a single step aggregation.
+   * @param aggregateOrderings Empty or one ordering per aggregate. An
+   * aggregate with sorting keys receives the rows of each group sorted on
+   * these keys. Requires a single step aggregation.
+   */
+  AggregationNode(
+      const PlanNodeId& id,
+      Step step,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          groupingKeys,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          preGroupedKeys,
+      const std::vector<std::string>& aggregateNames,
+      const std::vector<std::shared_ptr<const CallTypedExpr>>& aggregates,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          aggregateMasks,
+      bool ignoreNullKeys,
+      std::shared_ptr<const PlanNode> source,
+      int64_t numGroupsHint = 0,
+      const std::vector<bool>& distinctAggregates = {},
+      const std::vector<AggregateOrdering>& aggregateOrderings = {});
+
   const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
     return sources_;
   }
@@ -444,6 +524,17 @@ class AggregationNode : public PlanNode {
     return groupingKeys_;
   }
 
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  preGroupedKeys() const {
+    return preGroupedKeys_;
+  }
+
+  // True if the input is clustered on all grouping keys.
+  bool isPreGrouped() const {
+    return !groupingKeys_.empty() &&
+        preGroupedKeys_.size() == groupingKeys_.size();
+  }
+
   const std::vector<std::string>& aggregateNames() const {
     return aggregateNames_;
   }
@@ -461,6 +552,43 @@ class AggregationNode : public PlanNode {
     return ignoreNullKeys_;
   }
 
+  int64_t numGroupsHint() const {
+    return numGroupsHint_;
+  }
+
+  // True if aggregate 'i' is computed over the distinct values of its
+  // arguments in each group.
+  bool isDistinctAggregate(size_t i) const {
+    return !distinctAggregates_.empty() && distinctAggregates_[i];
+  }
+
+  bool hasDistinctAggregates() const {
+    return std::find(
+               distinctAggregates_.begin(), distinctAggregates_.end(), true) !=
+        distinctAggregates_.end();
+  }
+
+  // True if aggregate 'i' receives its input sorted on some keys.
+  bool isOrderedAggregate(size_t i) const {
+    return !aggregateOrderings_.empty() &&
+        !aggregateOrderings_[i].sortingKeys.empty();
+  }
+
+  // The ordering of aggregate 'i'. Must only be called if
+  // isOrderedAggregate(i).
+  const AggregateOrdering& aggregateOrdering(size_t i) const {
+    return aggregateOrderings_[i];
+  }
+
+  bool hasOrderedAggregates() const {
+    for (auto i = 0; i < aggregateOrderings_.size(); ++i) {
+      if (isOrderedAggregate(i)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   std::string_view name() const override {
     return "aggregation";
   }
@@ -468,6 +596,8 @@ class AggregationNode : public PlanNode {
  private:
   const Step step_;
   const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> groupingKeys_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+      preGroupedKeys_;
   const std::vector<std::string> aggregateNames_;
   const std::vector<std::shared_ptr<const CallTypedExpr>> aggregates_;
   // Keeps mask/'no mask' for every aggregation. Mask, if given, is a reference
@@ -476,6 +606,9 @@ class AggregationNode : public PlanNode {
       aggregateMasks_;
   const bool ignoreNullKeys_;
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
+  const int64_t numGroupsHint_;
+  const std::vector<bool> distinctAggregates_;
+  const std::vector<AggregateOrdering> aggregateOrderings_;
   const RowTypePtr outputType_;
 };
 
@@ -592,6 +725,11 @@ class LocalMergeNode : public PlanNode {
 /// Calculates partition number for each row of the specified vector.
 class PartitionFunction {
  public:
+  /// Partition number of rows that go to all partitions. Returned only by
+  /// functions that say so, e.g. for the build side rows of the hot keys of
+  /// a skewed join.
+  static constexpr uint32_t kAllPartitions = ~0U;
+
   virtual ~PartitionFunction() = default;
 
   /// @param input RowVector to split into partitions.
@@ -609,17 +747,24 @@ using PartitionFunctionFactory =
 /// is determined by the parallelism of the upstream pipeline. Can be used to
 /// gather data from multiple sources. The order of columns in the output may be
 /// different from input.
+///
+/// If 'scaleWriters' is true, the partition function is not used. The input
+/// batches go round-robin to a number of partitions that starts at one and
+/// grows while the consumers fall behind. This spreads the rows of a
+/// TableWriter over as many writers as the data volume needs.
 class LocalPartitionNode : public PlanNode {
  public:
   LocalPartitionNode(
       const PlanNodeId& id,
       PartitionFunctionFactory partitionFunctionFactory,
       RowTypePtr outputType,
-      std::vector<std::shared_ptr<const PlanNode>> sources)
+      std::vector<std::shared_ptr<const PlanNode>> sources,
+      bool scaleWriters = false)
       : PlanNode(id),
         sources_{std::move(sources)},
         partitionFunctionFactory_{std::move(partitionFunctionFactory)},
-        outputType_{std::move(outputType)} {
+        outputType_{std::move(outputType)},
+        scaleWriters_{scaleWriters} {
     VELOX_CHECK_GT(
         sources_.size(),
         0,
@@ -639,6 +784,20 @@ class LocalPartitionNode : public PlanNode {
         std::move(sources));
   }
 
+  static std::shared_ptr<LocalPartitionNode> scaleWriters(
+      const PlanNodeId& id,
+      RowTypePtr outputType,
+      std::vector<std::shared_ptr<const PlanNode>> sources) {
+    return std::make_shared<LocalPartitionNode>(
+        id,
+        [](auto /*numPartitions*/) -> std::unique_ptr<PartitionFunction> {
+          VELOX_UNREACHABLE();
+        },
+        std::move(outputType),
+        std::move(sources),
+        true);
+  }
+
   const RowTypePtr& outputType() const override {
     return outputType_;
   }
@@ -655,6 +814,10 @@ class LocalPartitionNode : public PlanNode {
     return partitionFunctionFactory_;
   }
 
+  bool scaleWriters() const {
+    return scaleWriters_;
+  }
+
   std::string_view name() const override {
     return "local repartitioning";
   }
@@ -663,6 +826,7 @@ class LocalPartitionNode : public PlanNode {
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
   const PartitionFunctionFactory partitionFunctionFactory_;
   const RowTypePtr outputType_;
+  const bool scaleWriters_;
 };
 
 class PartitionedOutputNode : public PlanNode {
@@ -891,6 +1055,9 @@ class AbstractJoinNode : public PlanNode {
 /// Represents inner/outer/semi/anti hash joins. Translates to an
 /// exec::HashBuild and exec::HashProbe. A separate pipeline is produced for the
 /// build side when generating exec::Operators.
+///
+/// 'isBroadcast' means that all tasks of the query get the same build side
+/// input, so that the tasks on the same node may share one hash table.
 class HashJoinNode : public AbstractJoinNode {
  public:
   HashJoinNode(
@@ -901,7 +1068,8 @@ class HashJoinNode : public AbstractJoinNode {
       std::shared_ptr<const ITypedExpr> filter,
       std::shared_ptr<const PlanNode> left,
       std::shared_ptr<const PlanNode> right,
-      const RowTypePtr outputType)
+      const RowTypePtr outputType,
+      bool isBroadcast = false)
       : AbstractJoinNode(
             id,
             joinType,
@@ -910,11 +1078,19 @@ class HashJoinNode : public AbstractJoinNode {
             filter,
             left,
             right,
-            outputType) {}
+            outputType),
+        isBroadcast_(isBroadcast) {}
 
   std::string_view name() const override {
     return "hash join";
   }
+
+  bool isBroadcast() const {
+    return isBroadcast_;
+  }
+
+ private:
+  const bool isBroadcast_;
 };
 
 /// Represents inner/outer/semi/anti merge joins. Translates to an
@@ -955,7 +1131,8 @@ class CrossJoinNode : public PlanNode {
       const PlanNodeId& id,
       std::shared_ptr<const PlanNode> left,
       std::shared_ptr<const PlanNode> right,
-      RowTypePtr outputType);
+      RowTypePtr outputType,
+      std::shared_ptr<const ITypedExpr> filter = nullptr);
 
   const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
     return sources_;
@@ -969,9 +1146,16 @@ class CrossJoinNode : public PlanNode {
     return "cross join";
   }
 
+  const std::shared_ptr<const ITypedExpr>& filter() const {
+    return filter_;
+  }
+
  private:
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
   const RowTypePtr outputType_;
+  // Optional filter on the rows of the cross product, nullptr if absent.
+  // May refer to any column of either side.
+  const std::shared_ptr<const ITypedExpr> filter_;
 };
 
 // Represents the 'SortBy' node in the plan.
@@ -1101,6 +1285,70 @@ class TopNNode : public PlanNode {
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
 };
 
+/// Keeps the first 'limit' rows of each partition in the order of the sorting
+/// keys, i.e. the rows for which row_number() <= 'limit'. The output has the
+/// input columns, optionally followed by the row number within the
+/// partition.
+class TopNRowNumberNode : public PlanNode {
+ public:
+  /// @param rowNumberColumnName Optional name of the row number column. If
+  /// not present, the row number is not produced.
+  TopNRowNumberNode(
+      const PlanNodeId& id,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          partitionKeys,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          sortingKeys,
+      const std::vector<SortOrder>& sortingOrders,
+      const std::optional<std::string>& rowNumberColumnName,
+      int32_t limit,
+      std::shared_ptr<const PlanNode> source);
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
+    return sources_;
+  }
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  partitionKeys() const {
+    return partitionKeys_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& sortingKeys()
+      const {
+    return sortingKeys_;
+  }
+
+  const std::vector<SortOrder>& sortingOrders() const {
+    return sortingOrders_;
+  }
+
+  bool generateRowNumber() const {
+    return generateRowNumber_;
+  }
+
+  int32_t limit() const {
+    return limit_;
+  }
+
+  std::string_view name() const override {
+    return "topNRowNumber";
+  }
+
+ private:
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+      partitionKeys_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> sortingKeys_;
+  const std::vector<SortOrder> sortingOrders_;
+  const bool generateRowNumber_;
+  const int32_t limit_;
+  const std::vector<std::shared_ptr<const PlanNode>> sources_;
+  RowTypePtr outputType_;
+};
+
 class LimitNode : public PlanNode {
  public:
   // @param isPartial Boolean indicating whether Limit node generates partial
@@ -1153,6 +1401,93 @@ class LimitNode : public PlanNode {
   const std::vector<std::shared_ptr<const PlanNode>> sources_;
 };
 
+/// Computes window functions over partitions of the input. The output has
+/// the input columns followed by one column per window function.
+class WindowNode : public PlanNode {
+ public:
+  enum class WindowType { kRange, kRows };
+
+  enum class BoundType {
+    kUnboundedPreceding,
+    kCurrentRow,
+    kUnboundedFollowing
+  };
+
+  /// The rows of the partition a window function sees for a row. The default
+  /// is RANGE BETWEEN UNBOUNDED PRECEDING AND CURRENT ROW.
+  struct Frame {
+    WindowType type{WindowType::kRange};
+    BoundType startType{BoundType::kUnboundedPreceding};
+    BoundType endType{BoundType::kCurrentRow};
+  };
+
+  struct Function {
+    std::shared_ptr<const CallTypedExpr> functionCall;
+    Frame frame;
+  };
+
+  /// @param inputsSorted True if the input is clustered on 'partitionKeys'
+  /// and sorted on 'sortingKeys' within each partition. The partitions then
+  /// stream through the operator instead of being buffered and sorted.
+  WindowNode(
+      const PlanNodeId& id,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          partitionKeys,
+      const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+          sortingKeys,
+      const std::vector<SortOrder>& sortingOrders,
+      const std::vector<std::string>& windowColumnNames,
+      const std::vector<Function>& windowFunctions,
+      bool inputsSorted,
+      std::shared_ptr<const PlanNode> source);
+
+  const std::vector<std::shared_ptr<const PlanNode>>& sources() const override {
+    return sources_;
+  }
+
+  const RowTypePtr& outputType() const override {
+    return outputType_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>&
+  partitionKeys() const {
+    return partitionKeys_;
+  }
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>& sortingKeys()
+      const {
+    return sortingKeys_;
+  }
+
+  const std::vector<SortOrder>& sortingOrders() const {
+    return sortingOrders_;
+  }
+
+  const std::vector<Function>& windowFunctions() const {
+    return windowFunctions_;
+  }
+
+  bool inputsSorted() const {
+    return inputsSorted_;
+  }
+
+  std::string_view name() const override {
+    return "window";
+  }
+
+ private:
+  void addDetails(std::stringstream& stream) const override;
+
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>>
+      partitionKeys_;
+  const std::vector<std::shared_ptr<const FieldAccessTypedExpr>> sortingKeys_;
+  const std::vector<SortOrder> sortingOrders_;
+  const std::vector<Function> windowFunctions_;
+  const bool inputsSorted_;
+  const std::vector<std::shared_ptr<const PlanNode>> sources_;
+  RowTypePtr outputType_;
+};
+
 /// Expands arrays and maps into separate columns. Arrays are expanded into a
 /// single column, and maps are expanded into two columns (key, value). Can be
 /// used to expand multiple columns. In this case will produce as many rows as
@@ -31,6 +31,12 @@ class QueryConfig {
   static constexpr const char* kCodegenLazyLoading =
       "driver.codegen.lazy_loading";
 
+  /// If true, the plan is compiled on a background thread and a task runs the
+  /// interpreted plan until the compiled plan is available. Tasks started
+  /// after that use the compiled plan. The compiled libraries are cached on
+  /// disk, so that later processes skip the compiler.
+  static constexpr const char* kCodegenAsync = "driver.codegen.async";
+
   // User provided session timezone. Stores a string with the actual timezone
   // name, e.g: "America/Los_Angeles".
   static constexpr const char* kSessionTimezone = "driver.session.timezone";
@@ -52,6 +58,10 @@ class QueryConfig {
   static constexpr const char* kExprEvalSimplified =
       "driver.expr_eval.simplified";
 
+  // Whether FilterProject collects per-expression stats and reports them in
+  // its runtime stats. False by default.
+  static constexpr const char* kExprTrackStats = "driver.expr_eval.track_stats";
+
   // Flags used to configure the CAST operator:
 
   // This flag makes the Row conversion to by applied
@@ -68,48 +78,203 @@ class QueryConfig {
   static constexpr const char* kMaxLocalExchangeBufferSize =
       "max_local_exchange_buffer_size";
 
+  /// Bytes a scale writers LocalPartition sends per writer before it may
+  /// start sending to one more writer.
+  static constexpr const char* kScaleWriterMinBytesPerWriter =
+      "driver.scale_writer_min_bytes_per_writer";
+
   static constexpr const char* kMaxPartialAggregationMemory =
       "max_partial_aggregation_memory";
 
+  /// A partial aggregation that has seen at least this many input rows
+  /// since its last flush and has more than
+  /// kAbandonPartialAggregationMinPct groups per 100 of these rows stops
+  /// grouping and converts each input row to intermediate results.
+  static constexpr const char* kAbandonPartialAggregationMinRows =
+      "abandon_partial_aggregation_min_rows";
+
+  static constexpr const char* kAbandonPartialAggregationMinPct =
+      "abandon_partial_aggregation_min_pct";
+
   static constexpr const char* kMaxPartitionedOutputBufferSize =
       "driver.max-page-partitioning-buffer-size";
 
+  /// Bytes of pages an Exchange buffers or has requested from its sources.
+  /// Requests to the sources are sized to stay within this budget.
+  static constexpr const char* kMaxExchangeBufferSize =
+      "exchange.max_buffer_size";
+
+  /// Codec for compressing the pages of remote exchanges: none, lz4 or
+  /// zstd. The producer and the consumer of an exchange must use the same
+  /// codec.
+  static constexpr const char* kExchangeCompressionCodec =
+      "driver.exchange_compression_codec";
+
+  /// If true, PartitionedOutput gives its rows to the consuming Exchanges as
+  /// RowVectors instead of serializing them. Only for queries whose Tasks
+  /// all run in this process and exchange data through "local://" sources.
+  static constexpr const char* kExchangeLocalBypassEnabled =
+      "driver.exchange_local_bypass_enabled";
+
   /// Preffered number of rows to be returned by operators from
   /// Operator::getOutput.
   static constexpr const char* kPreferredOutputBatchSize =
       "preferred_output_batch_size";
 
+  /// Preferred number of bytes in a batch produced by TableScan. The number
+  /// of rows requested from the connector is adjusted to the size of the
+  /// rows.
+  static constexpr const char* kPreferredOutputBatchBytes =
+      "preferred_output_batch_bytes";
+
   static constexpr const char* kHashAdaptivityEnabled =
       "driver.hash_adaptivity_enabled";
 
   static constexpr const char* kAdaptiveFilterReorderingEnabled =
       "driver.adaptive_filter_reordering_enabled";
 
+  /// If true, a filter that feeds a HashProbe or a PartitionedOutput and
+  /// passes few of its input rows copies the passing rows into batches of
+  /// preferred_output_batch_size rows instead of producing a small batch
+  /// for each input.
+  static constexpr const char* kCoalesceFilterOutputEnabled =
+      "driver.coalesce_filter_output_enabled";
+
+  /// If true, LocalPartition copies the rows it sends to a partition into
+  /// batches of preferred_output_batch_size rows instead of sending a small
+  /// batch to each partition for each input.
+  static constexpr const char* kLocalExchangeCoalesceEnabled =
+      "driver.local_exchange_coalesce_enabled";
+
+  /// If true, pipelines that start with a TableScan take Drivers off
+  /// thread while their consumer is slow and add them back when it keeps
+  /// up again.
+  static constexpr const char* kAdaptiveDriverCountEnabled =
+      "driver.adaptive_driver_count_enabled";
+
   static constexpr const char* kCreateEmptyFiles = "driver.create_empty_files";
 
+  /// Number of queued splits a TableScan Driver opens in the background on
+  /// the connector's executor while it reads its current split. 0 disables
+  /// split preload.
+  static constexpr const char* kMaxSplitPreloadPerDriver =
+      "driver.max_split_preload_per_driver";
+
+  /// If true, operators that support spilling write part of their state to
+  /// local files instead of failing when over their memory budget.
+  static constexpr const char* kSpillEnabled = "driver.spill_enabled";
+
+  /// Directory for spill files.
+  static constexpr const char* kSpillPath = "driver.spill_path";
+
+  /// Bytes of RowContainer memory after which OrderBy sorts its rows into a
+  /// run and spills it. 0 means no limit.
+  static constexpr const char* kOrderBySpillMemoryThreshold =
+      "driver.order_by_spill_memory_threshold";
+
+  /// If true, a final OrderBy is planned as a partial OrderBy that runs on
+  /// all the drivers of its pipeline, followed by a LocalMerge of the sorted
+  /// runs. Applies if the plan has a single final OrderBy and no LocalMerge.
+  static constexpr const char* kParallelOrderByEnabled =
+      "driver.parallel_order_by_enabled";
+
+  /// If true, a final or single grouped aggregation runs on all the drivers
+  /// of its pipeline, which add their input to groups they share, split in
+  /// hash partitions. Does not apply to DISTINCT and ordered aggregates.
+  /// The shared groups are not spilled.
+  static constexpr const char* kSharedFinalAggregationEnabled =
+      "driver.shared_final_aggregation_enabled";
+
+  /// Bytes of hash table memory after which a final aggregation spills its
+  /// groups to disk. 0 means no limit.
+  static constexpr const char* kAggregationSpillMemoryThreshold =
+      "driver.aggregation_spill_memory_threshold";
+
+  /// Bytes of build side memory after which a hash join build spills hash
+  /// partitions of its input to disk. 0 means no limit.
+  static constexpr const char* kJoinSpillMemoryThreshold =
+      "driver.join_spill_memory_threshold";
+
+  /// If true, a partial aggregation over a TableScan with a result cache
+  /// fingerprint, optionally with filters and projections in between,
+  /// caches its results for each split that has a cache key. A split whose
+  /// results are cached is not read. The results are kept in the
+  /// AsyncDataCache, if that is the MappedMemory of the query, and move to
+  /// its SSD cache on eviction.
+  static constexpr const char* kFragmentResultCacheEnabled =
+      "driver.fragment_result_cache_enabled";
+
+  /// If true, hash aggregations and hash joins store TIMESTAMP keys and
+  /// build side columns in their hash tables as 64-bit nanoseconds since the
+  /// epoch instead of 16 bytes. The query fails on timestamps outside of
+  /// about the years 1677 to 2262.
+  static constexpr const char* kHashTablePackTimestamps =
+      "driver.hash_table_pack_timestamps";
+
   uint64_t maxPartialAggregationMemoryUsage() const {
     static constexpr uint64_t kDefault = 1L << 24;
     return get<uint64_t>(kMaxPartialAggregationMemory, kDefault);
   }
 
+  int64_t abandonPartialAggregationMinRows() const {
+    static constexpr int64_t kDefault = 100'000;
+    return get<int64_t>(kAbandonPartialAggregationMinRows, kDefault);
+  }
+
+  int32_t abandonPartialAggregationMinPct() const {
+    static constexpr int32_t kDefault = 80;
+    return get<int32_t>(kAbandonPartialAggregationMinPct, kDefault);
+  }
+
   uint64_t maxPartitionedOutputBufferSize() const {
     static constexpr uint64_t kDefault = 32UL << 20;
     return get<uint64_t>(kMaxPartitionedOutputBufferSize, kDefault);
   }
 
+  uint64_t maxExchangeBufferSize() const {
+    static constexpr uint64_t kDefault = 32UL << 20;
+    return get<uint64_t>(kMaxExchangeBufferSize, kDefault);
+  }
+
+  std::string exchangeCompressionCodec() const {
+    return get<std::string>(kExchangeCompressionCodec, "none");
+  }
+
+  bool exchangeLocalBypassEnabled() const {
+    return get<bool>(kExchangeLocalBypassEnabled, false);
+  }
+
   uint64_t maxLocalExchangeBufferSize() const {
     static constexpr uint64_t kDefault = 32UL << 20;
     return get<uint64_t>(kMaxLocalExchangeBufferSize, kDefault);
   }
 
+  uint64_t scaleWriterMinBytesPerWriter() const {
+    static constexpr uint64_t kDefault = 32UL << 20;
+    return get<uint64_t>(kScaleWriterMinBytesPerWriter, kDefault);
+  }
+
   uint32_t preferredOutputBatchSize() const {
     return get<uint32_t>(kPreferredOutputBatchSize, 1024);
   }
 
+  uint64_t preferredOutputBatchBytes() const {
+    static constexpr uint64_t kDefault = 10UL << 20;
+    return get<uint64_t>(kPreferredOutputBatchBytes, kDefault);
+  }
+
   bool hashAdaptivityEnabled() const {
     return get<bool>(kHashAdaptivityEnabled, true);
   }
 
+  bool adaptiveDriverCountEnabled() const {
+    return get<bool>(kAdaptiveDriverCountEnabled, false);
+  }
+
+  int32_t maxSplitPreloadPerDriver() const {
+    return get<int32_t>(kMaxSplitPreloadPerDriver, 2);
+  }
+
   uint32_t writeStrideSize() const {
     static constexpr uint32_t kDefault = 100'000;
     return kDefault;
@@ -124,6 +289,14 @@ class QueryConfig {
     return get<bool>(kAdaptiveFilterReorderingEnabled, true);
   }
 
+  bool coalesceFilterOutputEnabled() const {
+    return get<bool>(kCoalesceFilterOutputEnabled, false);
+  }
+
+  bool localExchangeCoalesceEnabled() const {
+    return get<bool>(kLocalExchangeCoalesceEnabled, false);
+  }
+
   bool isMatchStructByName() const {
     return get<bool>(kCastMatchStructByName, false);
   }
@@ -144,6 +317,10 @@ class QueryConfig {
     return get<bool>(kCodegenLazyLoading, true);
   }
 
+  bool codegenAsync() const {
+    return get<bool>(kCodegenAsync, false);
+  }
+
   bool createEmptyFiles() const {
     return get<bool>(kCreateEmptyFiles, false);
   }
@@ -160,6 +337,46 @@ class QueryConfig {
     return get<bool>(kExprEvalSimplified, false);
   }
 
+  bool exprTrackStats() const {
+    return get<bool>(kExprTrackStats, false);
+  }
+
+  bool spillEnabled() const {
+    return get<bool>(kSpillEnabled, false);
+  }
+
+  std::string spillPath() const {
+    return get<std::string>(kSpillPath, "/tmp");
+  }
+
+  uint64_t orderBySpillMemoryThreshold() const {
+    return get<uint64_t>(kOrderBySpillMemoryThreshold, 0);
+  }
+
+  bool parallelOrderByEnabled() const {
+    return get<bool>(kParallelOrderByEnabled, false);
+  }
+
+  bool sharedFinalAggregationEnabled() const {
+    return get<bool>(kSharedFinalAggregationEnabled, false);
+  }
+
+  uint64_t aggregationSpillMemoryThreshold() const {
+    return get<uint64_t>(kAggregationSpillMemoryThreshold, 0);
+  }
+
+  uint64_t joinSpillMemoryThreshold() const {
+    return get<uint64_t>(kJoinSpillMemoryThreshold, 0);
+  }
+
+  bool hashTablePackTimestamps() const {
+    return get<bool>(kHashTablePackTimestamps, false);
+  }
+
+  bool fragmentResultCacheEnabled() const {
+    return get<bool>(kFragmentResultCacheEnabled, false);
+  }
+
  private:
   template <typename T>
   T get(const std::string& key, const T& defaultValue) const {
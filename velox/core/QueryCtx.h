@@ -16,8 +16,10 @@
 #pragma once
 
 #include <folly/Executor.h>
+#include "velox/common/memory/Arena.h"
 #include "velox/common/memory/MappedMemory.h"
 #include "velox/common/memory/Memory.h"
+#include "velox/common/memory/MemoryArbitrator.h"
 #include "velox/core/Context.h"
 #include "velox/core/QueryConfig.h"
 #include "velox/vector/DecodedVector.h"
@@ -94,6 +96,20 @@ class QueryCtx : public Context {
     return executor_.get();
   }
 
+  // Returns the arbitrator managing the memory capacity of the query, or
+  // nullptr if the query has a fixed memory limit.
+  memory::MemoryArbitrator* memoryArbitrator() const {
+    return memoryArbitrator_;
+  }
+
+  // Sets the arbitrator to which Tasks of the query register for
+  // reclaiming memory. The root tracker of the memory of the query must
+  // have been added to 'arbitrator'. Must be set before Tasks are
+  // started.
+  void setMemoryArbitrator(memory::MemoryArbitrator* arbitrator) {
+    memoryArbitrator_ = arbitrator;
+  }
+
   const QueryConfig& config() const {
     return config_;
   }
@@ -137,6 +153,7 @@ class QueryCtx : public Context {
   memory::MappedMemory* mappedMemory_;
   std::unordered_map<std::string, std::shared_ptr<Config>> connectorConfigs_;
   std::shared_ptr<folly::Executor> executor_;
+  memory::MemoryArbitrator* memoryArbitrator_{nullptr};
   QueryConfig config_;
 };
 
@@ -187,7 +204,35 @@ class ExecCtx : public Context {
     decodedVectorPool_.push_back(std::move(vector));
   }
 
+  /// Returns an arena for scratch memory of expression evaluation. The
+  /// memory is charged to pool() and stays valid until the outermost
+  /// ExprSet::eval on 'this' returns. It must not back results.
+  Arena& arena() {
+    if (!arena_) {
+      arena_ = std::make_unique<Arena>(pool_, kArenaChunkSize, kArenaChunkSize);
+    }
+    return *arena_;
+  }
+
+  /// Called by ExprSet::eval on entry and exit. The outermost exit frees the
+  /// memory of arena().
+  void enterEval() {
+    ++evalDepth_;
+  }
+
+  void leaveEval() {
+    if (--evalDepth_ == 0 && arena_) {
+      arena_->clear();
+    }
+  }
+
+  bool inEval() const {
+    return evalDepth_ > 0;
+  }
+
  private:
+  static constexpr int64_t kArenaChunkSize = 64 << 10;
+
   // Pool for all Buffers for this thread
   memory::MemoryPool* pool_;
   QueryCtx* queryCtx_;
@@ -196,6 +241,10 @@ class ExecCtx : public Context {
   // A pool of preallocated SelectivityVectors for use by expressions
   // and operators.
   std::vector<std::unique_ptr<SelectivityVector>> selectivityVectorPool_;
+  // Scratch memory for expression evaluation, created on first use.
+  std::unique_ptr<Arena> arena_;
+  // Number of ExprSet::eval calls in progress on 'this'.
+  int32_t evalDepth_{0};
 };
 
 } // namespace facebook::velox::core
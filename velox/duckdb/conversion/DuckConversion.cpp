@@ -108,6 +108,18 @@ TypePtr toVeloxType(LogicalType type) {
       return TIMESTAMP();
     case LogicalTypeId::BLOB:
       return VARBINARY();
+    case LogicalTypeId::LIST:
+      return ARRAY(toVeloxType(::duckdb::ListType::GetChildType(type)));
+    case LogicalTypeId::STRUCT: {
+      std::vector<std::string> names;
+      std::vector<TypePtr> types;
+      const auto& childTypes = ::duckdb::StructType::GetChildTypes(type);
+      for (const auto& [name, childType] : childTypes) {
+        names.push_back(name);
+        types.push_back(toVeloxType(childType));
+      }
+      return ROW(std::move(names), std::move(types));
+    }
     default:
       throw std::runtime_error(
           "unsupported type for duckdb -> velox conversion: " +
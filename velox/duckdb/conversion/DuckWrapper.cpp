@@ -18,6 +18,7 @@
 #include "velox/duckdb/conversion/DuckConversion.h"
 #include "velox/external/duckdb/duckdb.hpp"
 #include "velox/external/duckdb/tpch/include/tpch-extension.hpp"
+#include "velox/vector/ComplexVector.h"
 #include "velox/vector/FlatVector.h"
 
 namespace facebook::velox::duckdb {
@@ -131,6 +132,79 @@ std::string DuckResult::getName(size_t columnIdx) {
   return queryResult_->names[columnIdx];
 }
 
+namespace {
+
+// Returns the nulls of the first 'size' rows of 'duckValidity'. The nulls are
+// shared with DuckDB unless 'validity' is given. 'validity' has a bit set for
+// each row that is used and the rows that are not are set to null.
+BufferPtr toVeloxNulls(
+    ::duckdb::ValidityMask& duckValidity,
+    size_t size,
+    memory::MemoryPool* pool,
+    const uint8_t* validity) {
+  if (validity) {
+    auto nulls = AlignedBuffer::allocate<bool>(size, pool);
+    auto* rawNulls = nulls->asMutable<uint8_t>();
+    auto numBytes = bits::nbytes(size);
+    if (duckValidity.AllValid()) {
+      memcpy(rawNulls, validity, numBytes);
+    } else {
+      auto* duckBits = reinterpret_cast<const uint8_t*>(duckValidity.GetData());
+      for (auto i = 0; i < numBytes; ++i) {
+        rawNulls[i] = validity[i] & duckBits[i];
+      }
+    }
+    return nulls;
+  }
+  if (duckValidity.AllValid()) {
+    return nullptr;
+  }
+  return BufferView<DuckDBValidityReleaser>::create(
+      reinterpret_cast<const uint8_t*>(duckValidity.GetData()),
+      bits::nbytes(size),
+      DuckDBValidityReleaser(duckValidity));
+}
+
+// DuckDB strings have the layout of StringView: the size, a 4 byte prefix
+// and either the rest of an inline string of up to 12 bytes or a pointer to
+// the string. Both zero the unused bytes of inline strings. The values are
+// therefore shared as they are and the vector keeps a reference to the
+// DuckDB string heap that the pointers point into.
+static_assert(sizeof(StringView) == sizeof(::duckdb::string_t));
+
+VectorPtr convertStrings(
+    ::duckdb::Vector& duckVector,
+    const TypePtr& veloxType,
+    size_t size,
+    memory::MemoryPool* pool,
+    const uint8_t* validity) {
+  auto& duckValidity = ::duckdb::FlatVector::Validity(duckVector);
+  auto* duckData =
+      ::duckdb::FlatVector::GetData<::duckdb::string_t>(duckVector);
+  auto valuesView = BufferView<DuckDBBufferReleaser>::create(
+      reinterpret_cast<const uint8_t*>(duckData),
+      size * sizeof(StringView),
+      DuckDBBufferReleaser(duckVector.GetBuffer()));
+
+  std::vector<BufferPtr> stringBuffers;
+  if (auto auxiliary = duckVector.GetAuxiliary()) {
+    stringBuffers.push_back(BufferView<DuckDBBufferReleaser>::create(
+        reinterpret_cast<const uint8_t*>(duckData),
+        0,
+        DuckDBBufferReleaser(std::move(auxiliary))));
+  }
+
+  return std::make_shared<FlatVector<StringView>>(
+      pool,
+      veloxType,
+      toVeloxNulls(duckValidity, size, pool, validity),
+      size,
+      valuesView,
+      std::move(stringBuffers));
+}
+
+} // namespace
+
 template <class OP>
 VectorPtr convert(
     ::duckdb::Vector& duckVector,
@@ -141,6 +215,12 @@ VectorPtr convert(
   auto vectorType = duckVector.GetVectorType();
   switch (vectorType) {
     case ::duckdb::VectorType::FLAT_VECTOR: {
+      if constexpr (std::is_same_v<
+                        typename OP::DUCK_TYPE,
+                        ::duckdb::string_t>) {
+        return convertStrings(duckVector, veloxType, size, pool, validity);
+      }
+
       VectorPtr result;
       auto& duckValidity = ::duckdb::FlatVector::Validity(duckVector);
       auto* duckData =
@@ -149,9 +229,7 @@ VectorPtr convert(
       // Some DuckDB vectors have different internal layout and cannot be
       // trivially copied.
       if (duckVector.GetType() == LogicalTypeId::HUGEINT ||
-          duckVector.GetType() == LogicalTypeId::TIMESTAMP ||
-          duckVector.GetType() == LogicalTypeId::VARCHAR) {
-        // TODO Figure out how to perform a zero-copy conversion.
+          duckVector.GetType() == LogicalTypeId::TIMESTAMP) {
         result = BaseVector::create(veloxType, size, pool);
         auto flatResult = result->as<FlatVector<typename OP::VELOX_TYPE>>();
 
@@ -172,16 +250,12 @@ VectorPtr convert(
             size * sizeof(typename OP::VELOX_TYPE),
             DuckDBBufferReleaser(duckVector.GetBuffer()));
 
-        BufferPtr nullsView(nullptr);
-        if (!duckValidity.AllValid()) {
-          nullsView = BufferView<DuckDBValidityReleaser>::create(
-              reinterpret_cast<const uint8_t*>(duckValidity.GetData()),
-              bits::nbytes(size),
-              DuckDBValidityReleaser(duckValidity));
-        }
-
         result = std::make_shared<FlatVector<typename OP::VELOX_TYPE>>(
-            pool, nullsView, size, valuesView, std::vector<BufferPtr>());
+            pool,
+            toVeloxNulls(duckValidity, size, pool, nullptr),
+            size,
+            valuesView,
+            std::vector<BufferPtr>());
       }
 
       return result;
@@ -200,11 +274,13 @@ VectorPtr convert(
       VectorPtr base;
       // Unused dictionary elements can be uninitialized. That can cause
       // errors if we try to decode them. Here we create a bitmap of
-      // used values to avoid that.
+      // used values to avoid that. The strings are not decoded but the
+      // unused ones are set to null so that nothing reads them later.
       if (child.GetType() == LogicalTypeId::HUGEINT ||
           child.GetType() == LogicalTypeId::TIMESTAMP ||
-          child.GetType() == LogicalTypeId::VARCHAR) {
-        std::vector<uint8_t> validityVector((maxIndex + 7) / 8, 0);
+          child.GetType() == LogicalTypeId::VARCHAR ||
+          child.GetType() == LogicalTypeId::BLOB) {
+        std::vector<uint8_t> validityVector(bits::nbytes(maxIndex + 1), 0);
         auto validity_ptr = validityVector.data();
         for (auto i = 0; i < size; i++) {
           bits::setBit(validity_ptr, selection.get_index(i));
@@ -230,6 +306,72 @@ VectorPtr convert(
   }
 }
 
+// Converts a DuckDB list. The elements are converted as a whole. The 64 bit
+// DuckDB offsets and lengths are narrowed to the Velox ones.
+VectorPtr convertList(
+    ::duckdb::Vector& duckVector,
+    const TypePtr& veloxType,
+    size_t size,
+    memory::MemoryPool* pool) {
+  duckVector.Normalify(size);
+  auto& duckValidity = ::duckdb::FlatVector::Validity(duckVector);
+  auto* entries = ::duckdb::ListVector::GetData(duckVector);
+  auto elements = toVeloxVector(
+      ::duckdb::ListVector::GetListSize(duckVector),
+      ::duckdb::ListVector::GetEntry(duckVector),
+      veloxType->childAt(0),
+      pool);
+
+  auto offsets = AlignedBuffer::allocate<vector_size_t>(size, pool);
+  auto sizes = AlignedBuffer::allocate<vector_size_t>(size, pool);
+  auto* rawOffsets = offsets->asMutable<vector_size_t>();
+  auto* rawSizes = sizes->asMutable<vector_size_t>();
+  for (auto i = 0; i < size; ++i) {
+    if (duckValidity.RowIsValid(i)) {
+      rawOffsets[i] = entries[i].offset;
+      rawSizes[i] = entries[i].length;
+    } else {
+      rawOffsets[i] = 0;
+      rawSizes[i] = 0;
+    }
+  }
+
+  return std::make_shared<ArrayVector>(
+      pool,
+      veloxType,
+      toVeloxNulls(duckValidity, size, pool, nullptr),
+      size,
+      offsets,
+      sizes,
+      elements);
+}
+
+// Converts a DuckDB struct. The children have the size of the struct.
+VectorPtr convertStruct(
+    ::duckdb::Vector& duckVector,
+    const TypePtr& veloxType,
+    size_t size,
+    memory::MemoryPool* pool) {
+  duckVector.Normalify(size);
+  auto& duckValidity = ::duckdb::FlatVector::Validity(duckVector);
+  auto& entries = ::duckdb::StructVector::GetEntries(duckVector);
+  VELOX_CHECK_EQ(entries.size(), veloxType->size());
+
+  std::vector<VectorPtr> children;
+  children.reserve(entries.size());
+  for (auto i = 0; i < entries.size(); ++i) {
+    children.push_back(
+        toVeloxVector(size, *entries[i], veloxType->childAt(i), pool));
+  }
+
+  return std::make_shared<RowVector>(
+      pool,
+      veloxType,
+      toVeloxNulls(duckValidity, size, pool, nullptr),
+      size,
+      std::move(children));
+}
+
 struct NumericCastToDouble {
   template <class T>
   static double operation(T input) {
@@ -320,12 +462,17 @@ VectorPtr toVeloxVector(
       }
     }
     case LogicalTypeId::VARCHAR:
+    case LogicalTypeId::BLOB:
       return convert<DuckStringConversion>(duckVector, veloxType, size, pool);
     case LogicalTypeId::DATE:
       return convert<DuckDateConversion>(duckVector, veloxType, size, pool);
     case LogicalTypeId::TIMESTAMP:
       return convert<DuckTimestampConversion>(
           duckVector, veloxType, size, pool);
+    case LogicalTypeId::LIST:
+      return convertList(duckVector, veloxType, size, pool);
+    case LogicalTypeId::STRUCT:
+      return convertStruct(duckVector, veloxType, size, pool);
     default:
       throw std::runtime_error(
           "Unsupported vector type for conversion: " + type.ToString());
@@ -224,3 +224,46 @@ TEST_F(BaseDuckWrapperTest, dictConversion) {
     ASSERT_TRUE(expected->equalValueAt(actual.get(), i, i));
   }
 }
+
+TEST_F(BaseDuckWrapperTest, stringsOutliveResult) {
+  // The strings are shared with DuckDB. The vector keeps them alive after the
+  // result is gone.
+  auto result = db_->execute(
+      "SELECT i || ' is a long, non-inlined, example string' "
+      "FROM range(1000) tbl(i)");
+  ASSERT_TRUE(result->success()) << "Query failed: " << result->errorMessage();
+  ASSERT_TRUE(result->next());
+  auto rowVector = result->getVector();
+  result.reset();
+
+  auto strings = rowVector->childAt(0)->as<SimpleVector<StringView>>();
+  ASSERT_NE(strings, nullptr);
+  for (auto i = 0; i < strings->size(); i++) {
+    ASSERT_EQ(
+        strings->valueAt(i).str(),
+        fmt::format("{} is a long, non-inlined, example string", i));
+  }
+}
+
+TEST_F(BaseDuckWrapperTest, nestedTypes) {
+  auto result = db_->execute(
+      "SELECT list_value(i, i + 1), struct_pack(a := i, b := 'x' || i) "
+      "FROM (VALUES (1), (2), (3)) tbl(i)");
+  ASSERT_TRUE(result->success()) << "Query failed: " << result->errorMessage();
+  ASSERT_TRUE(result->next());
+  auto rowVector = result->getVector();
+  ASSERT_EQ(rowVector->size(), 3);
+
+  test::VectorMaker maker(pool_.get());
+  auto expectedArrays =
+      maker.arrayVector<int32_t>({{1, 2}, {2, 3}, {3, 4}});
+  auto expectedStructs = maker.rowVector(
+      {maker.flatVector<int32_t>({1, 2, 3}),
+       maker.flatVector(std::vector<std::string>{"x1", "x2", "x3"})});
+  for (auto i = 0; i < rowVector->size(); i++) {
+    ASSERT_TRUE(
+        expectedArrays->equalValueAt(rowVector->childAt(0).get(), i, i));
+    ASSERT_TRUE(
+        expectedStructs->equalValueAt(rowVector->childAt(1).get(), i, i));
+  }
+}
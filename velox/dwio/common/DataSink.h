@@ -18,6 +18,7 @@
 
 #include <chrono>
 
+#include "velox/common/file/File.h"
 #include "velox/dwio/common/Closeable.h"
 #include "velox/dwio/common/DataBuffer.h"
 #include "velox/dwio/common/IoStatistics.h"
@@ -159,6 +160,40 @@ class FileSink : public DataSink {
   int file_;
 };
 
+// Writes to a WriteFile of a FileSystem, e.g. a file of an object store that
+// uploads in the background while the writer produces the next stripes.
+class WriteFileDataSink : public DataSink {
+ public:
+  WriteFileDataSink(
+      std::unique_ptr<WriteFile> file,
+      std::string name,
+      const MetricsLogPtr& metricLogger = MetricsLog::voidLog(),
+      common::IoStatistics* stats = nullptr)
+      : DataSink{std::move(name), metricLogger, stats},
+        file_{std::move(file)} {}
+
+  ~WriteFileDataSink() override {
+    destroy();
+  }
+
+  using DataSink::write;
+
+  void write(std::vector<DataBuffer<char>>& buffers) override {
+    writeImpl(buffers, [&](auto& buffer) {
+      file_->append(std::string_view(buffer.data(), buffer.size()));
+      return buffer.size();
+    });
+  }
+
+ protected:
+  void doClose() override {
+    file_->close();
+  }
+
+ private:
+  std::unique_ptr<WriteFile> file_;
+};
+
 class MemorySink : public DataSink {
  public:
   MemorySink(
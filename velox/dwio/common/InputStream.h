@@ -128,6 +128,18 @@ class InputStream {
     return false;
   }
 
+  /// Returns the cost model of reads from 'this' for deciding which reads
+  /// to coalesce.
+  virtual velox::ReadCost readCost() const {
+    return velox::ReadCost();
+  }
+
+  /// Returns the whole file if it is in addressable memory, or an empty
+  /// view. See ReadFile::mappedData().
+  virtual std::string_view mappedData() const {
+    return {};
+  }
+
   /**
    * Take advantage of vectorized read API provided by some file system.
    * Allow file system to do optimzied reading plan to disk to minimize
@@ -219,6 +231,14 @@ class ReadFileInputStream final : public InputStream {
 
   bool hasReadAsync() const override;
 
+  velox::ReadCost readCost() const override {
+    return readFile_->readCost();
+  }
+
+  std::string_view mappedData() const override {
+    return readFile_->mappedData();
+  }
+
  private:
   velox::ReadFile* FOLLY_NONNULL readFile_;
 };
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -59,6 +60,10 @@ class IoCounter {
 
 class IoStatistics {
  public:
+  // Number of buckets of readsBySize(). Bucket i counts reads under
+  // 8KB * 8^i bytes. The last bucket also counts larger reads.
+  static constexpr int32_t kNumReadSizeBuckets = 6;
+
   uint64_t rawBytesRead() const;
   uint64_t rawOverreadBytes() const;
   uint64_t rawBytesWritten() const;
@@ -87,6 +92,25 @@ class IoStatistics {
     return ramHit_;
   }
 
+  // Returns the counter of storage reads of 'readSize' bytes.
+  IoCounter& readsBySize(uint64_t readSize) {
+    return readsBySize_[readSizeBucket(readSize)];
+  }
+
+  const IoCounter& readsBySizeBucket(int32_t bucket) const {
+    return readsBySize_[bucket];
+  }
+
+  static int32_t readSizeBucket(uint64_t readSize) {
+    int32_t bucket = 0;
+    for (auto limit = 8UL << 10;
+         readSize >= limit && bucket < kNumReadSizeBuckets - 1;
+         limit *= 8) {
+      ++bucket;
+    }
+    return bucket;
+  }
+
   void incOperationCounters(
       const std::string& operation,
       const uint64_t resourceThrottleCount,
@@ -118,6 +142,10 @@ class IoStatistics {
   // reads.
   IoCounter ssdRead_;
 
+  // Reads from storage by size of the IO. The bytes include gaps
+  // read to coalesce nearby ranges, which are in 'rawOverreadBytes_'.
+  std::array<IoCounter, kNumReadSizeBuckets> readsBySize_;
+
   std::unordered_map<std::string, OperationCounters> operationStats_;
   mutable std::mutex operationStatsMutex_;
 };
@@ -19,6 +19,7 @@
 #include <limits>
 #include <unordered_set>
 
+#include "velox/common/base/Exceptions.h"
 #include "velox/common/caching/DataCache.h"
 #include "velox/common/memory/Memory.h"
 #include "velox/dwio/common/ColumnSelector.h"
@@ -91,8 +92,13 @@ class RowReaderOptions {
   uint64_t dataStart;
   uint64_t dataLength;
   bool preloadStripe;
+  // Number of stripes after the current one whose IO is started ahead of
+  // their decoding.
+  int32_t stripeLookahead_ = 1;
   bool projectSelectedType;
   bool returnFlatVector_ = false;
+  bool returnRunLengthEncoded_ = false;
+  bool returnIntegerDictionary_ = false;
   ErrorTolerance errorTolerance_;
   std::shared_ptr<ColumnSelector> selector_;
   velox::common::ScanSpec* scanSpec_ = nullptr;
@@ -103,11 +109,14 @@ class RowReaderOptions {
     dataStart = other.dataStart;
     dataLength = other.dataLength;
     preloadStripe = other.preloadStripe;
+    stripeLookahead_ = other.stripeLookahead_;
     projectSelectedType = other.projectSelectedType;
     errorTolerance_ = other.errorTolerance_;
     selector_ = other.selector_;
     scanSpec_ = other.scanSpec_;
     returnFlatVector_ = other.returnFlatVector_;
+    returnRunLengthEncoded_ = other.returnRunLengthEncoded_;
+    returnIntegerDictionary_ = other.returnIntegerDictionary_;
     flatmapNodeIdAsStruct_ = other.flatmapNodeIdAsStruct_;
   }
 
@@ -189,6 +198,18 @@ class RowReaderOptions {
     return preloadStripe;
   }
 
+  // Sets the number of stripes after the current one to prefetch while the
+  // current one is decoded. 0 disables prefetching. The prefetch stops short
+  // of this if the input has no memory for it.
+  void setStripeLookahead(int32_t lookahead) {
+    VELOX_CHECK_GE(lookahead, 0);
+    stripeLookahead_ = lookahead;
+  }
+
+  int32_t getStripeLookahead() const {
+    return stripeLookahead_;
+  }
+
   // For flat map, return flat vector representation
   bool getReturnFlatVector() const {
     return returnFlatVector_;
@@ -199,6 +220,32 @@ class RowReaderOptions {
     returnFlatVector_ = value;
   }
 
+  // True if scalar columns with long runs of equal values are returned as
+  // SequenceVectors.
+  bool getReturnRunLengthEncoded() const {
+    return returnRunLengthEncoded_;
+  }
+
+  // Requests that scalar columns whose values in a batch form long runs,
+  // e.g. sorted or clustered columns, are returned as SequenceVectors, so
+  // that expressions over them are evaluated once per run.
+  void setReturnRunLengthEncoded(bool value) {
+    returnRunLengthEncoded_ = value;
+  }
+
+  // True if dictionary encoded integer columns are returned as
+  // DictionaryVectors over the stripe dictionary.
+  bool getReturnIntegerDictionary() const {
+    return returnIntegerDictionary_;
+  }
+
+  // Requests that integer columns with dictionary encoding are returned as
+  // DictionaryVectors where possible, so that expressions, hashing and
+  // memoization see the few distinct values without looking for them.
+  void setReturnIntegerDictionary(bool value) {
+    returnIntegerDictionary_ = value;
+  }
+
   /**
    * Request that the selected type be projected.
    */
@@ -44,9 +44,16 @@ class ScanSpec {
     if (element.kind() == kNestedField) {
       auto field = reinterpret_cast<const Subfield::NestedField*>(&element);
       fieldName_ = field->name();
-
+    } else if (element.kind() == kLongSubscript) {
+      subscript_ =
+          reinterpret_cast<const Subfield::LongSubscript*>(&element)->index();
+    } else if (element.kind() == kStringSubscript) {
+      fieldName_ =
+          reinterpret_cast<const Subfield::StringSubscript*>(&element)
+              ->index();
     } else {
-      VELOX_CHECK(false, "Only nested fields are supported");
+      VELOX_CHECK(
+          false, "Only nested fields and map or list subscripts are supported");
     }
   }
 
@@ -221,6 +228,17 @@ class ScanSpec {
     return false;
   }
 
+  // True if only the number of elements of each list or map is needed,
+  // e.g. for cardinality(). The reader then reads the lengths and not the
+  // elements, keys or values, which come out as null constants.
+  bool readsLengthsOnly() const {
+    return readsLengthsOnly_;
+  }
+
+  void setReadsLengthsOnly(bool readsLengthsOnly) {
+    readsLengthsOnly_ = readsLengthsOnly;
+  }
+
   bool makeFlat() const {
     return makeFlat_;
   }
@@ -278,6 +296,8 @@ class ScanSpec {
   // True if a string dictionary or flat map in this field should be
   // returned as flat.
   bool makeFlat_ = false;
+  // True if a list or map reader reads only the lengths.
+  bool readsLengthsOnly_ = false;
   std::unique_ptr<common::Filter> filter_;
   SelectivityInfo selectivity_;
   // Sort children by filtering efficiency.
@@ -90,6 +90,14 @@ class Decrypter {
       folly::StringPiece input) const = 0;
 
   virtual std::unique_ptr<Decrypter> clone() const = 0;
+
+  // True if decrypt() may be called from several threads at the same time,
+  // so that blocks of a stream may be decrypted ahead of use on an
+  // executor. Block ciphers in counter or GCM mode decrypt each block
+  // independently of the others.
+  virtual bool canDecryptConcurrently() const {
+    return false;
+  }
 };
 
 class DecrypterFactory {
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include "velox/common/encode/Base64.h"
 #include "velox/dwio/common/encryption/Encryption.h"
 #include "velox/dwio/common/exception/Exception.h"
@@ -58,7 +59,7 @@ class TestEncryption {
 
  private:
   std::string key_;
-  mutable size_t count_;
+  mutable std::atomic<size_t> count_{0};
 };
 
 class TestEncrypter : public TestEncryption, public Encrypter {
@@ -99,6 +100,10 @@ class TestDecrypter : public TestEncryption, public Decrypter {
     decrypter->setKey(getKey());
     return decrypter;
   }
+
+  bool canDecryptConcurrently() const override {
+    return true;
+  }
 };
 
 class TestEncryptionProperties : public EncryptionProperties {
@@ -21,6 +21,8 @@
 #include "velox/dwio/dwrf/common/Common.h"
 #include "velox/dwio/dwrf/common/InputStream.h"
 
+#include <folly/Executor.h>
+
 namespace facebook::velox::dwrf {
 
 class BufferedInput {
@@ -55,6 +57,15 @@ class BufferedInput {
   // load all regions to be read in an optimized way (IO efficiency)
   virtual void load(const dwio::common::LogType);
 
+  // Loads the enqueued regions of index streams and leaves the other
+  // regions enqueued for the next load(). This lets the reader test filters
+  // against row group statistics before scheduling IO for data streams.
+  // Returns false if not supported, in which case the index streams are
+  // readable only after load().
+  virtual bool loadRowIndexes(const dwio::common::LogType) {
+    return false;
+  }
+
   virtual bool isBuffered(uint64_t offset, uint64_t length) const {
     return !!readBuffer(offset, length);
   }
@@ -88,6 +99,13 @@ class BufferedInput {
     return false;
   }
 
+  // Returns an executor for background work on the data of this input, e.g.
+  // decompression, or nullptr if the work should be done on the caller's
+  // thread.
+  virtual folly::Executor* FOLLY_NULLABLE executor() const {
+    return nullptr;
+  }
+
  protected:
   dwio::common::InputStream& input_;
 
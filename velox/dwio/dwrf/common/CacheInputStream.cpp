@@ -16,6 +16,7 @@
 
 #include "velox/dwio/dwrf/common/CacheInputStream.h"
 #include <folly/executors/QueuedImmediateExecutor.h>
+#include "velox/common/caching/SsdCache.h"
 
 namespace facebook::velox::dwrf {
 
@@ -31,7 +32,8 @@ CacheInputStream::CacheInputStream(
     uint64_t fileNum,
     std::shared_ptr<ScanTracker> tracker,
     TrackingId trackingId,
-    uint64_t groupId)
+    uint64_t groupId,
+    cache::CachePriority priority)
     : cache_(cache),
       ioStats_(ioStats),
       input_(input),
@@ -39,7 +41,8 @@ CacheInputStream::CacheInputStream(
       fileNum_(fileNum),
       tracker_(std::move(tracker)),
       trackingId_(trackingId),
-      groupId_(groupId) {}
+      groupId_(groupId),
+      priority_(priority) {}
 
 bool CacheInputStream::Next(const void** buffer, int32_t* size) {
   if (position_ >= region_.length) {
@@ -101,6 +104,24 @@ size_t CacheInputStream::loadIndices(
   return startIndex + 1;
 }
 
+namespace {
+// Keeps a cache entry pinned while a BufferView over its data is live.
+struct CachePinReleaser {
+  void addRef() const {}
+  void release() const {}
+
+  cache::CachePin pin;
+};
+} // namespace
+
+BufferPtr CacheInputStream::currentBuffer() {
+  if (!run_ || pin_.empty()) {
+    return nullptr;
+  }
+  return BufferView<CachePinReleaser>::create(
+      run_, runSize_, CachePinReleaser{pin_});
+}
+
 namespace {
 std::vector<folly::Range<char*>> makeRanges(
     cache::AsyncDataCacheEntry* entry,
@@ -129,7 +150,7 @@ void CacheInputStream::loadSync(dwio::common::Region region) {
     folly::SemiFuture<bool> wait(false);
     cache::RawFileCacheKey key{fileNum_, region.offset};
     pin_.clear();
-    pin_ = cache_->findOrCreate(key, region.length, &wait);
+    pin_ = cache_->findOrCreate(key, region.length, &wait, priority_);
     if (pin_.empty()) {
       VELOX_CHECK(wait.valid());
       auto& exec = folly::QueuedImmediateExecutor::instance();
@@ -137,9 +158,22 @@ void CacheInputStream::loadSync(dwio::common::Region region) {
       continue;
     }
     if (pin_.entry()->isExclusive()) {
-      auto ranges = makeRanges(pin_.entry(), region.length);
-      input_.read(ranges, region.offset, dwio::common::LogType::FILE);
-      ioStats_->read().increment(region.length);
+      // A miss in memory. Reads from the SSD cache if the range is
+      // there, else from the file.
+      auto ssdCache = cache_->ssdCache();
+      cache::SsdPin ssdPin;
+      if (ssdCache) {
+        ssdPin = ssdCache->file(fileNum_).find(key);
+      }
+      if (!ssdPin.empty() && ssdPin.run().size() >= region.length &&
+          ssdPin.file()->load(ssdPin.run(), *pin_.entry())) {
+        ioStats_->ssdRead().increment(region.length);
+      } else {
+        auto ranges = makeRanges(pin_.entry(), region.length);
+        input_.read(ranges, region.offset, dwio::common::LogType::FILE);
+        ioStats_->read().increment(region.length);
+        ioStats_->readsBySize(region.length).increment(region.length);
+      }
       pin_.entry()->setValid(true);
       pin_.entry()->setExclusiveToShared();
     } else {
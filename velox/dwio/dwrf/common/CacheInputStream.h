@@ -48,7 +48,8 @@ class CacheInputStream : public SeekableInputStream {
       uint64_t fileNum,
       std::shared_ptr<cache::ScanTracker> tracker,
       cache::TrackingId trackingId,
-      uint64_t groupId);
+      uint64_t groupId,
+      cache::CachePriority priority = cache::CachePriority::kNormal);
 
   bool Next(const void** data, int* size) override;
   void BackUp(int count) override;
@@ -59,6 +60,9 @@ class CacheInputStream : public SeekableInputStream {
   size_t loadIndices(const proto::RowIndex& rowIndex, size_t startIndex)
       override;
 
+  // Returns a view of the current run that holds a pin on the cache entry.
+  BufferPtr currentBuffer() override;
+
  private:
   void loadPosition();
   void loadSync(dwio::common::Region region);
@@ -71,6 +75,7 @@ class CacheInputStream : public SeekableInputStream {
   std::shared_ptr<cache::ScanTracker> tracker_;
   const cache::TrackingId trackingId_;
   const uint64_t groupId_;
+  const cache::CachePriority priority_;
 
   // Maximum number of bytes read from 'input' at a time. This gives the maximum
   // pin_.entry()->size().
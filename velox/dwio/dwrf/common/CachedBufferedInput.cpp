@@ -15,6 +15,7 @@
  */
 
 #include "velox/dwio/dwrf/common/CachedBufferedInput.h"
+#include "velox/common/caching/SsdCache.h"
 #include "velox/dwio/dwrf/common/CacheInputStream.h"
 
 namespace facebook::velox::dwrf {
@@ -39,10 +40,22 @@ std::unique_ptr<SeekableInputStream> CachedBufferedInput::enqueue(
     id = TrackingId(si->node, si->kind);
   }
   requests_.emplace_back(CacheRequest{
-      RawFileCacheKey{fileNum_, region.offset}, region.length, id, CachePin()});
+      RawFileCacheKey{fileNum_, region.offset},
+      region.length,
+      id,
+      CachePin(),
+      si && isIndexStream(si->kind)});
   tracker_->recordReference(id, region.length, groupId_);
   return std::make_unique<CacheInputStream>(
-      cache_, ioStats_.get(), region, input_, fileNum_, tracker_, id, groupId_);
+      cache_,
+      ioStats_.get(),
+      region,
+      input_,
+      fileNum_,
+      tracker_,
+      id,
+      groupId_,
+      priority_);
 }
 
 bool CachedBufferedInput::isBuffered(uint64_t /*offset*/, uint64_t /*length*/)
@@ -84,8 +97,10 @@ void CachedBufferedInput::load(const dwio::common::LogType) {
   auto requests = std::move(requests_);
   for (auto& request : requests) {
     if (request.trackingId.empty() ||
-        tracker_->shouldPrefetch(request.trackingId, prefetchThreshold_)) {
-      request.pin = cache_->findOrCreate(request.key, request.size, nullptr);
+        tracker_->shouldPrefetch(
+            request.trackingId, prefetchThreshold_, groupId_)) {
+      request.pin = cache_->findOrCreate(
+          request.key, request.size, nullptr, priority_);
       if (request.pin.empty()) {
         // Already loading for another thread.
         continue;
@@ -145,6 +160,20 @@ void CachedBufferedInput::load(const dwio::common::LogType) {
   }
 }
 
+bool CachedBufferedInput::loadRowIndexes(const dwio::common::LogType logType) {
+  auto firstData = std::stable_partition(
+      requests_.begin(), requests_.end(), [](const CacheRequest& request) {
+        return request.isIndex;
+      });
+  std::vector<CacheRequest> dataRequests(
+      std::make_move_iterator(firstData),
+      std::make_move_iterator(requests_.end()));
+  requests_.erase(firstData, requests_.end());
+  load(logType);
+  requests_ = std::move(dataRequests);
+  return true;
+}
+
 bool CachedBufferedInput::tryMerge(
     dwio::common::Region& first,
     const dwio::common::Region& second) {
@@ -154,8 +183,7 @@ bool CachedBufferedInput::tryMerge(
     // We do not support one region going to two target buffers.
     return false;
   }
-  // compare with 0 since it's comparison in different types
-  if (gap <= kMaxMergeDistance) {
+  if (readCost_.shouldCoalesce(gap)) {
     int64_t extension = gap + second.length;
 
     if (extension > 0) {
@@ -175,6 +203,28 @@ bool CachedBufferedInput::tryMerge(
 }
 
 namespace {
+// Appends the memory of 'entry' to 'buffers'.
+void appendBuffers(
+    cache::AsyncDataCacheEntry& entry,
+    std::vector<folly::Range<char*>>& buffers) {
+  auto& buffer = entry.data();
+  auto size = entry.size();
+  uint64_t offsetInRuns = 0;
+  if (buffer.numPages() == 0) {
+    buffers.push_back(folly::Range<char*>(entry.tinyData(), size));
+    offsetInRuns = size;
+  } else {
+    for (int i = 0; i < buffer.numRuns(); ++i) {
+      velox::memory::MappedMemory::PageRun run = buffer.runAt(i);
+      uint64_t bytes = run.numBytes();
+      uint64_t readSize = std::min(bytes, size - offsetInRuns);
+      buffers.push_back(folly::Range<char*>(run.data<char>(), readSize));
+      offsetInRuns += readSize;
+    }
+  }
+  DWIO_ENSURE(offsetInRuns == size);
+}
+
 class DwrfFusedLoad : public cache::FusedLoad {
  public:
   void initialize(
@@ -195,29 +245,14 @@ class DwrfFusedLoad : public cache::FusedLoad {
     uint64_t lastOffset = start;
     uint64_t totalRead = 0;
     for (auto& pin : pins_) {
-      auto& buffer = pin.entry()->data();
       uint64_t startOffset = pin.entry()->offset();
-      totalRead += pin.entry()->size();
+      auto size = pin.entry()->size();
+      totalRead += size;
       if (lastOffset < startOffset) {
         buffers.push_back(
             folly::Range<char*>(nullptr, startOffset - lastOffset));
       }
-
-      auto size = pin.entry()->size();
-      uint64_t offsetInRuns = 0;
-      if (buffer.numPages() == 0) {
-        buffers.push_back(folly::Range<char*>(pin.entry()->tinyData(), size));
-        offsetInRuns = size;
-      } else {
-        for (int i = 0; i < buffer.numRuns(); ++i) {
-          velox::memory::MappedMemory::PageRun run = buffer.runAt(i);
-          uint64_t bytes = run.numBytes();
-          uint64_t readSize = std::min(bytes, size - offsetInRuns);
-          buffers.push_back(folly::Range<char*>(run.data<char>(), readSize));
-          offsetInRuns += readSize;
-        }
-      }
-      DWIO_ENSURE(offsetInRuns == size);
+      appendBuffers(*pin.entry(), buffers);
       lastOffset = startOffset + size;
     }
     if (isPrefetch) {
@@ -225,6 +260,7 @@ class DwrfFusedLoad : public cache::FusedLoad {
     } else {
       ioStats_->read().increment(totalRead);
     }
+    ioStats_->readsBySize(lastOffset - start).increment(lastOffset - start);
     stream.read(buffers, start, dwio::common::LogType::FILE);
   }
 
@@ -232,6 +268,49 @@ class DwrfFusedLoad : public cache::FusedLoad {
   std::unique_ptr<AbstractInputStreamHolder> input_;
   std::shared_ptr<dwio::common::IoStatistics> ioStats_;
 };
+
+// Loads entries from the SSD cache. 'ssdPins_' keeps the SSD ranges
+// of the entries from being evicted until the load is done. Entries
+// that fail verification on SSD are read from 'input_'.
+class SsdFusedLoad : public cache::FusedLoad {
+ public:
+  void initialize(
+      std::vector<CachePin>&& pins,
+      std::vector<cache::SsdPin>&& ssdPins,
+      std::unique_ptr<AbstractInputStreamHolder> input,
+      std::shared_ptr<dwio::common::IoStatistics> ioStats) {
+    ssdPins_ = std::move(ssdPins);
+    input_ = std::move(input);
+    ioStats_ = std::move(ioStats);
+    cache::FusedLoad::initialize(std::move(pins));
+  }
+
+  void loadData(bool /*isPrefetch*/) override {
+    uint64_t totalRead = 0;
+    for (auto i = 0; i < pins_.size(); ++i) {
+      auto& ssdPin = ssdPins_[i];
+      auto* entry = pins_[i].entry();
+      if (ssdPin.file()->load(ssdPin.run(), *entry)) {
+        totalRead += entry->size();
+        continue;
+      }
+      std::vector<folly::Range<char*>> buffers;
+      appendBuffers(*entry, buffers);
+      input_->get().read(
+          buffers, entry->offset(), dwio::common::LogType::FILE);
+      ioStats_->read().increment(entry->size());
+      ioStats_->readsBySize(entry->size()).increment(entry->size());
+    }
+    ioStats_->ssdRead().increment(totalRead);
+    ssdPins_.clear();
+  }
+
+ private:
+  // Aligned with 'pins_'.
+  std::vector<cache::SsdPin> ssdPins_;
+  std::unique_ptr<AbstractInputStreamHolder> input_;
+  std::shared_ptr<dwio::common::IoStatistics> ioStats_;
+};
 } // namespace
 
 void CachedBufferedInput::readRegion(std::vector<CachePin> pins) {
@@ -252,10 +331,38 @@ std::unique_ptr<SeekableInputStream> CachedBufferedInput::read(
       fileNum_,
       nullptr,
       TrackingId(),
-      0);
+      0,
+      priority_);
 }
 
-void CachedBufferedInput::loadFromSsd(std::vector<CacheRequest*> /*requests*/) {
-  // No op placeholder.
+void CachedBufferedInput::loadFromSsd(std::vector<CacheRequest*>& requests) {
+  auto ssdCache = cache_->ssdCache();
+  if (!ssdCache) {
+    return;
+  }
+  auto& file = ssdCache->file(fileNum_);
+  std::vector<CachePin> pins;
+  std::vector<cache::SsdPin> ssdPins;
+  auto end = std::remove_if(
+      requests.begin(), requests.end(), [&](CacheRequest* request) {
+        auto ssdPin = file.find(request->key);
+        if (ssdPin.empty() || ssdPin.run().size() < request->size) {
+          return false;
+        }
+        pins.push_back(std::move(request->pin));
+        ssdPins.push_back(std::move(ssdPin));
+        return true;
+      });
+  requests.erase(end, requests.end());
+  if (pins.empty()) {
+    return;
+  }
+  auto load = std::make_shared<SsdFusedLoad>();
+  load->initialize(
+      std::move(pins), std::move(ssdPins), streamSource_(), ioStats_);
+  fusedLoads_.push_back(load);
+  if (executor_) {
+    executor_->add([load]() { load->loadOrFuture(nullptr); });
+  }
 }
 } // namespace facebook::velox::dwrf
@@ -53,7 +53,8 @@ class CachedBufferedInput : public BufferedInput {
       uint64_t groupId,
       StreamSource streamSource,
       std::shared_ptr<dwio::common::IoStatistics> ioStats,
-      folly::Executor* executor)
+      folly::Executor* executor,
+      cache::CachePriority priority = cache::CachePriority::kNormal)
       : BufferedInput(input, pool, dataCacheConfig),
         cache_(cache),
         fileNum_(dataCacheConfig->filenum),
@@ -61,7 +62,9 @@ class CachedBufferedInput : public BufferedInput {
         groupId_(groupId),
         streamSource_(streamSource),
         ioStats_(std::move(ioStats)),
-        executor_(executor) {}
+        executor_(executor),
+        priority_(priority),
+        readCost_(input.readCost()) {}
 
   ~CachedBufferedInput() override {
     for (auto& load : fusedLoads_) {
@@ -79,6 +82,8 @@ class CachedBufferedInput : public BufferedInput {
 
   void load(const dwio::common::LogType) override;
 
+  bool loadRowIndexes(const dwio::common::LogType) override;
+
   bool isBuffered(uint64_t offset, uint64_t length) const override;
 
   std::unique_ptr<SeekableInputStream> read(
@@ -92,16 +97,22 @@ class CachedBufferedInput : public BufferedInput {
     return true;
   }
 
+  folly::Executor* FOLLY_NULLABLE executor() const override {
+    return executor_;
+  }
+
  private:
   struct CacheRequest {
     cache::RawFileCacheKey key;
     uint64_t size;
     cache::TrackingId trackingId;
     cache::CachePin pin;
+    // True for a row index or bloom filter stream.
+    bool isIndex{false};
   };
 
-  // Updates first  to include second if they are near enough to justify merging
-  // the IO.
+  // Updates first to include second if reading over the gap between them
+  // is cheaper than a separate IO according to 'readCost_'.
   bool tryMerge(
       dwio::common::Region& first,
       const dwio::common::Region& second);
@@ -111,9 +122,10 @@ class CachedBufferedInput : public BufferedInput {
   // excessive gaps between the end of one and the start of the next.
   void readRegion(std::vector<cache::CachePin> pins);
 
-  // Removes the requests from 'toLoad' if they hit SSD cache. May start
-  // background load from SSD.
-  void loadFromSsd(std::vector<CacheRequest*> requests);
+  // Removes the requests from 'requests' if they hit SSD cache. The
+  // hits are loaded together from SSD, in the background if there is
+  // an executor.
+  void loadFromSsd(std::vector<CacheRequest*>& requests);
 
   cache::AsyncDataCache* cache_;
   const uint64_t fileNum_;
@@ -122,6 +134,10 @@ class CachedBufferedInput : public BufferedInput {
   StreamSource streamSource_;
   std::shared_ptr<dwio::common::IoStatistics> ioStats_;
   folly::Executor* const executor_;
+  // Priority of the cache entries of the file.
+  const cache::CachePriority priority_;
+  // Cost model of reads from 'input_'.
+  const ReadCost readCost_;
 
   //  Percentage of reads over enqueues that qualifies a stream to be
   //  coalesced with nearby streams and prefetched. Anything read less
@@ -142,13 +158,15 @@ class CachedBufferedInputFactory : public BufferedInputFactory {
       uint64_t groupId,
       StreamSource streamSource,
       std::shared_ptr<dwio::common::IoStatistics> ioStats,
-      folly::Executor* executor)
+      folly::Executor* executor,
+      cache::CachePriority priority = cache::CachePriority::kNormal)
       : cache_(cache),
         tracker_(std::move(tracker)),
         groupId_(groupId),
         streamSource_(streamSource),
         ioStats_(ioStats),
-        executor_(executor) {}
+        executor_(executor),
+        priority_(priority) {}
 
   std::unique_ptr<BufferedInput> create(
       dwio::common::InputStream& input,
@@ -163,7 +181,8 @@ class CachedBufferedInputFactory : public BufferedInputFactory {
         groupId_,
         streamSource_,
         ioStats_,
-        executor_);
+        executor_,
+        priority_);
   }
 
   std::string toString() const {
@@ -180,5 +199,6 @@ class CachedBufferedInputFactory : public BufferedInputFactory {
   StreamSource streamSource_;
   std::shared_ptr<dwio::common::IoStatistics> ioStats_;
   folly::Executor* executor_;
+  const cache::CachePriority priority_;
 };
 } // namespace facebook::velox::dwrf
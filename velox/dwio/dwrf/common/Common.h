@@ -82,6 +82,11 @@ enum StreamKind {
  */
 std::string streamKindToString(StreamKind kind);
 
+// True for the streams that are placed in the index area of a stripe.
+inline bool isIndexStream(StreamKind kind) {
+  return kind == StreamKind_ROW_INDEX || kind == StreamKind_BLOOM_FILTER_UTF8;
+}
+
 class StreamInformation {
  public:
   virtual ~StreamInformation() = default;
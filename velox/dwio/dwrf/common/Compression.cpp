@@ -24,6 +24,7 @@
 #include <folly/logging/xlog.h>
 #include <lz4.h>
 #include <snappy.h>
+#include <zdict.h>
 #include <zlib.h>
 #include <zstd.h>
 #include <zstd_errors.h>
@@ -36,22 +37,86 @@ using memory::MemoryPool;
 
 namespace {
 
+// Training looks at pieces of at most this size, so that a few large blocks
+// still make enough samples.
+constexpr uint64_t kMaxZstdSampleLength = 16 << 10;
+
 class ZstdCompressor : public Compressor {
  public:
-  explicit ZstdCompressor(int32_t level) : Compressor{level} {}
+  ZstdCompressor(int32_t level, std::shared_ptr<ZstdStreamState> state)
+      : Compressor{level}, state_{std::move(state)} {
+    if (state_) {
+      context_.reset(ZSTD_createCCtx());
+      DWIO_ENSURE_NOT_NULL(context_, "Failed to create ZSTD context");
+    }
+  }
 
   uint64_t compress(const void* src, void* dest, uint64_t length) override;
+
+ private:
+  struct ContextDeleter {
+    void operator()(ZSTD_CCtx* context) const {
+      ZSTD_freeCCtx(context);
+    }
+  };
+
+  // Compresses with the level and dictionary of 'state_'.
+  size_t compressWithState(const void* src, void* dest, uint64_t length);
+
+  const std::shared_ptr<ZstdStreamState> state_;
+  std::unique_ptr<ZSTD_CCtx, ContextDeleter> context_;
+  // The level 'context_' is set up with. 0 if not set up yet.
+  int32_t contextLevel_{0};
+  bool hasDictionary_{false};
 };
 
+size_t ZstdCompressor::compressWithState(
+    const void* src,
+    void* dest,
+    uint64_t length) {
+  const auto& dictionary = state_->dictionary();
+  bool useDictionary = false;
+  if (dictionary) {
+    if (dictionary->isActive()) {
+      useDictionary = true;
+    } else {
+      dictionary->addSample(src, length);
+    }
+  }
+  auto level = state_->level();
+  if (level != contextLevel_ || useDictionary != hasDictionary_) {
+    auto* context = context_.get();
+    ZSTD_CCtx_reset(context, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, level);
+    if (useDictionary) {
+      // The dictionary is digested for the level of the context.
+      auto ret = ZSTD_CCtx_loadDictionary(
+          context, dictionary->bytes().data(), dictionary->bytes().size());
+      DWIO_ENSURE(
+          !ZSTD_isError(ret),
+          "Failed to load ZSTD dictionary: ",
+          ZSTD_getErrorName(ret));
+    }
+    contextLevel_ = level;
+    hasDictionary_ = useDictionary;
+  }
+  return ZSTD_compress2(context_.get(), dest, length, src, length);
+}
+
 uint64_t
 ZstdCompressor::compress(const void* src, void* dest, uint64_t length) {
-  auto ret = ZSTD_compress(dest, length, src, length, level_);
+  auto ret = state_ ? compressWithState(src, dest, length)
+                    : ZSTD_compress(dest, length, src, length, level_);
   if (ZSTD_isError(ret)) {
     // it's fine to hit dest size too small
     if (ZSTD_getErrorCode(ret) == ZSTD_ErrorCode::ZSTD_error_dstSize_tooSmall) {
-      return length;
+      ret = length;
+    } else {
+      DWIO_RAISE("ZSTD returned an error: ", ZSTD_getErrorName(ret));
     }
-    DWIO_RAISE("ZSTD returned an error: ", ZSTD_getErrorName(ret));
+  }
+  if (state_) {
+    state_->recordBlock(length, ret);
   }
   return ret;
 }
@@ -200,6 +265,10 @@ class LzoDecompressor : public Decompressor {
     return dwio::common::compression::lzoDecompress(
         src, src + srcLength, dest, dest + destLength);
   }
+
+  bool canDecompressConcurrently() const override {
+    return true;
+  }
 };
 
 class Lz4Decompressor : public Decompressor {
@@ -214,6 +283,10 @@ class Lz4Decompressor : public Decompressor {
       uint64_t srcLength,
       char* dest,
       uint64_t destLength) override;
+
+  bool canDecompressConcurrently() const override {
+    return true;
+  }
 };
 
 uint64_t Lz4Decompressor::decompress(
@@ -234,10 +307,11 @@ uint64_t Lz4Decompressor::decompress(
 
 class ZstdDecompressor : public Decompressor {
  public:
-  explicit ZstdDecompressor(
+  ZstdDecompressor(
       uint64_t blockSize,
-      const std::string& streamDebugInfo)
-      : Decompressor{blockSize, streamDebugInfo} {}
+      const std::string& streamDebugInfo,
+      const ZstdDecompressionDictionaries* dictionaries)
+      : Decompressor{blockSize, streamDebugInfo}, dictionaries_{dictionaries} {}
 
   uint64_t decompress(
       const char* src,
@@ -245,8 +319,15 @@ class ZstdDecompressor : public Decompressor {
       char* dest,
       uint64_t destLength) override;
 
+  bool canDecompressConcurrently() const override {
+    return true;
+  }
+
   uint64_t getUncompressedLength(const char* src, uint64_t srcLength)
       const override;
+
+ private:
+  const ZstdDecompressionDictionaries* const dictionaries_;
 };
 
 uint64_t ZstdDecompressor::decompress(
@@ -254,7 +335,25 @@ uint64_t ZstdDecompressor::decompress(
     uint64_t srcLength,
     char* dest,
     uint64_t destLength) {
-  auto ret = ZSTD_decompress(dest, destLength, src, srcLength);
+  size_t ret;
+  auto dictionaryId = ZSTD_getDictID_fromFrame(src, srcLength);
+  if (dictionaryId == 0) {
+    ret = ZSTD_decompress(dest, destLength, src, srcLength);
+  } else {
+    auto* dictionary =
+        dictionaries_ ? dictionaries_->find(dictionaryId) : nullptr;
+    DWIO_ENSURE_NOT_NULL(
+        dictionary,
+        "Missing ZSTD dictionary ",
+        dictionaryId,
+        " Info: ",
+        streamDebugInfo_);
+    // Blocks may be decompressed concurrently, so each thread has a context.
+    thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context{
+        ZSTD_createDCtx(), &ZSTD_freeDCtx};
+    ret = ZSTD_decompress_usingDDict(
+        context.get(), dest, destLength, src, srcLength, dictionary);
+  }
   DWIO_ENSURE(
       !ZSTD_isError(ret),
       "ZSTD returned an error: ",
@@ -295,6 +394,10 @@ class SnappyDecompressor : public Decompressor {
       char* dest,
       uint64_t destLength) override;
 
+  bool canDecompressConcurrently() const override {
+    return true;
+  }
+
   uint64_t getUncompressedLength(const char* src, uint64_t srcLength)
       const override;
 };
@@ -432,12 +535,64 @@ bool ZlibDecompressionStream::Next(const void** data, int32_t* size) {
 
 } // namespace
 
+void ZstdDictionary::addSample(const void* data, uint64_t length) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto* begin = static_cast<const char*>(data);
+  for (uint64_t offset = 0;
+       sampling_ && offset < length && samples_.size() < maxSampleBytes_;
+       offset += kMaxZstdSampleLength) {
+    auto size = std::min(
+        {length - offset,
+         kMaxZstdSampleLength,
+         maxSampleBytes_ - samples_.size()});
+    samples_.append(begin + offset, size);
+    sampleSizes_.push_back(size);
+  }
+}
+
+bool ZstdDictionary::train() {
+  std::lock_guard<std::mutex> l(mutex_);
+  DWIO_ENSURE(sampling_, "ZSTD dictionary is already trained");
+  sampling_ = false;
+  std::string dictionary(maxSize_, '\0');
+  auto size = sampleSizes_.empty()
+      ? 0
+      : ZDICT_trainFromBuffer(
+            dictionary.data(),
+            dictionary.size(),
+            samples_.data(),
+            sampleSizes_.data(),
+            sampleSizes_.size());
+  std::string().swap(samples_);
+  std::vector<size_t>().swap(sampleSizes_);
+  if (size == 0 || ZDICT_isError(size)) {
+    return false;
+  }
+  dictionary.resize(size);
+  id_ = ZDICT_getDictID(dictionary.data(), dictionary.size());
+  if (id_ == 0) {
+    return false;
+  }
+  bytes_ = std::move(dictionary);
+  return true;
+}
+
+void ZstdDecompressionDictionaries::add(folly::StringPiece bytes) {
+  auto id = ZDICT_getDictID(bytes.data(), bytes.size());
+  DWIO_ENSURE_NE(id, 0, "Invalid ZSTD dictionary");
+  std::shared_ptr<ZSTD_DDict> dictionary(
+      ZSTD_createDDict(bytes.data(), bytes.size()), &ZSTD_freeDDict);
+  DWIO_ENSURE_NOT_NULL(dictionary, "Failed to create ZSTD dictionary");
+  dictionaries_[id] = std::move(dictionary);
+}
+
 std::unique_ptr<BufferedOutputStream> createCompressor(
     CompressionKind kind,
     CompressionBufferPool& bufferPool,
     DataBufferHolder& bufferHolder,
     const Config& config,
-    const Encrypter* encrypter) {
+    const Encrypter* encrypter,
+    std::shared_ptr<ZstdStreamState> zstdState) {
   std::unique_ptr<Compressor> compressor;
   switch (static_cast<int64_t>(kind)) {
     case CompressionKind_NONE:
@@ -456,7 +611,8 @@ std::unique_ptr<BufferedOutputStream> createCompressor(
     }
     case CompressionKind_ZSTD: {
       int32_t zstdCompressionLevel = config.get(Config::ZSTD_COMPRESSION_LEVEL);
-      compressor = std::make_unique<ZstdCompressor>(zstdCompressionLevel);
+      compressor = std::make_unique<ZstdCompressor>(
+          zstdCompressionLevel, std::move(zstdState));
       XLOG_FIRST_N(INFO, 1) << fmt::format(
           "Initialized zstd compressor with compression level {}",
           zstdCompressionLevel);
@@ -478,7 +634,9 @@ std::unique_ptr<SeekableInputStream> createDecompressor(
     uint64_t blockSize,
     MemoryPool& pool,
     const std::string& streamDebugInfo,
-    const Decrypter* decrypter) {
+    const Decrypter* decrypter,
+    folly::Executor* executor,
+    const ZstdDecompressionDictionaries* zstdDictionaries) {
   std::unique_ptr<Decompressor> decompressor;
   switch (static_cast<int64_t>(kind)) {
     case CompressionKind_NONE:
@@ -510,8 +668,8 @@ std::unique_ptr<SeekableInputStream> createDecompressor(
           std::make_unique<Lz4Decompressor>(blockSize, streamDebugInfo);
       break;
     case CompressionKind_ZSTD:
-      decompressor =
-          std::make_unique<ZstdDecompressor>(blockSize, streamDebugInfo);
+      decompressor = std::make_unique<ZstdDecompressor>(
+          blockSize, streamDebugInfo, zstdDictionaries);
       break;
     default:
       DWIO_RAISE("Unknown compression codec ", kind);
@@ -521,7 +679,8 @@ std::unique_ptr<SeekableInputStream> createDecompressor(
       pool,
       std::move(decompressor),
       decrypter,
-      streamDebugInfo);
+      streamDebugInfo,
+      executor);
 }
 
 } // namespace facebook::velox::dwrf
@@ -24,10 +24,130 @@
 #include "velox/dwio/dwrf/common/InputStream.h"
 #include "velox/dwio/dwrf/common/OutputStream.h"
 
+#include <folly/Executor.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+struct ZSTD_DDict_s;
+
 namespace facebook::velox::dwrf {
 
 constexpr uint8_t PAGE_HEADER_SIZE = 3;
 
+// Prefix of the keys of the file metadata entries that hold the ZSTD
+// dictionaries of the columns. The key ends with the node id.
+constexpr folly::StringPiece kZstdDictionaryKeyPrefix{"orc.zstd.dictionary."};
+
+// A ZSTD dictionary shared by the streams of one column. Until train(), the
+// compressors of the streams add samples of their input. After activate(),
+// they compress with the dictionary. The frames carry the id of the
+// dictionary, so that the reader finds it among the dictionaries of the file.
+class ZstdDictionary {
+ public:
+  // 'maxSampleBytes' caps the sample data kept for training.
+  ZstdDictionary(uint32_t maxSize, uint64_t maxSampleBytes)
+      : maxSize_{maxSize}, maxSampleBytes_{maxSampleBytes} {}
+
+  // Adds a sample of stream content. Ignored after train().
+  void addSample(const void* data, uint64_t length);
+
+  // Trains the dictionary on the samples and drops them. Returns false if
+  // training fails, e.g. on too little sample data, in which case the
+  // streams keep compressing without a dictionary.
+  bool train();
+
+  // Makes the compressors use the trained dictionary. Called once the
+  // dictionary is known to be stored in the file.
+  void activate() {
+    DWIO_ENSURE(!bytes_.empty(), "ZSTD dictionary is not trained");
+    active_.store(true, std::memory_order_release);
+  }
+
+  bool isActive() const {
+    return active_.load(std::memory_order_acquire);
+  }
+
+  // The serialized dictionary. Set after a successful train().
+  const std::string& bytes() const {
+    return bytes_;
+  }
+
+  uint32_t id() const {
+    return id_;
+  }
+
+ private:
+  const uint32_t maxSize_;
+  const uint64_t maxSampleBytes_;
+  std::mutex mutex_;
+  bool sampling_{true};
+  std::string samples_;
+  std::vector<size_t> sampleSizes_;
+  std::string bytes_;
+  uint32_t id_{0};
+  std::atomic<bool> active_{false};
+};
+
+// The state of the ZSTD compressor of a stream that the writer adjusts
+// between stripes: the compression level and the dictionary of the column.
+class ZstdStreamState {
+ public:
+  ZstdStreamState(int32_t level, std::shared_ptr<ZstdDictionary> dictionary)
+      : level_{level}, dictionary_{std::move(dictionary)} {}
+
+  int32_t level() const {
+    return level_.load(std::memory_order_relaxed);
+  }
+
+  void setLevel(int32_t level) {
+    level_.store(level, std::memory_order_relaxed);
+  }
+
+  // nullptr if the stream is compressed without a dictionary.
+  const std::shared_ptr<ZstdDictionary>& dictionary() const {
+    return dictionary_;
+  }
+
+  // Adds the raw and compressed sizes of a block.
+  void recordBlock(uint64_t rawSize, uint64_t compressedSize) {
+    rawBytes_ += rawSize;
+    compressedBytes_ += compressedSize;
+  }
+
+  // Returns the raw and compressed sizes of the blocks since the last call.
+  std::pair<uint64_t, uint64_t> takeBlockSizes() {
+    return {rawBytes_.exchange(0), compressedBytes_.exchange(0)};
+  }
+
+ private:
+  std::atomic<int32_t> level_;
+  const std::shared_ptr<ZstdDictionary> dictionary_;
+  std::atomic<uint64_t> rawBytes_{0};
+  std::atomic<uint64_t> compressedBytes_{0};
+};
+
+// The ZSTD dictionaries of a file by dictionary id.
+class ZstdDecompressionDictionaries {
+ public:
+  // Adds the serialized dictionary 'bytes'.
+  void add(folly::StringPiece bytes);
+
+  // Returns the dictionary with 'id' or nullptr.
+  const ZSTD_DDict_s* find(uint32_t id) const {
+    auto it = dictionaries_.find(id);
+    return it == dictionaries_.end() ? nullptr : it->second.get();
+  }
+
+  bool empty() const {
+    return dictionaries_.empty();
+  }
+
+ private:
+  std::unordered_map<uint32_t, std::shared_ptr<ZSTD_DDict_s>> dictionaries_;
+};
+
 class Compressor {
  public:
   explicit Compressor(int32_t level) : level_{level} {}
@@ -59,6 +179,17 @@ class Decompressor {
       char* dest,
       uint64_t destLength) = 0;
 
+  // True if decompress() keeps no state between calls, so that several
+  // blocks may be decompressed at the same time on different threads.
+  virtual bool canDecompressConcurrently() const {
+    return false;
+  }
+
+  // The largest uncompressed size of a block.
+  uint64_t blockSize() const {
+    return blockSize_;
+  }
+
  protected:
   uint64_t blockSize_;
   const std::string streamDebugInfo_;
@@ -70,6 +201,8 @@ class Decompressor {
  * @param input the input stream that is the underlying source
  * @param bufferSize the maximum size of the buffer
  * @param pool the memory pool
+ * @param executor if set, blocks are read ahead and decompressed on it
+ * @param zstdDictionaries the ZSTD dictionaries of the file, if any
  */
 std::unique_ptr<SeekableInputStream> createDecompressor(
     CompressionKind kind,
@@ -77,7 +210,9 @@ std::unique_ptr<SeekableInputStream> createDecompressor(
     uint64_t bufferSize,
     memory::MemoryPool& pool,
     const std::string& streamDebugInfo,
-    const dwio::common::encryption::Decrypter* decryptr = nullptr);
+    const dwio::common::encryption::Decrypter* decryptr = nullptr,
+    folly::Executor* executor = nullptr,
+    const ZstdDecompressionDictionaries* zstdDictionaries = nullptr);
 
 /**
  * Create a compressor for the given compression kind.
@@ -86,12 +221,14 @@ std::unique_ptr<SeekableInputStream> createDecompressor(
  * @param bufferHolder buffer holder that handles buffer allocation and
  * collection
  * @param level compression level
+ * @param zstdState if set, the level and dictionary of a ZSTD compressor
  */
 std::unique_ptr<BufferedOutputStream> createCompressor(
     CompressionKind kind,
     CompressionBufferPool& bufferPool,
     DataBufferHolder& bufferHolder,
     const Config& config,
-    const dwio::common::encryption::Encrypter* encrypter = nullptr);
+    const dwio::common::encryption::Encrypter* encrypter = nullptr,
+    std::shared_ptr<ZstdStreamState> zstdState = nullptr);
 
 } // namespace facebook::velox::dwrf
@@ -36,6 +36,14 @@ Config::Entry<int32_t> Config::ZSTD_COMPRESSION_LEVEL(
     "hive.exec.orc.compress.zstd.level",
     7);
 
+Config::Entry<uint32_t> Config::ZSTD_DICTIONARY_SIZE(
+    "orc.compress.zstd.dictionary.size",
+    0);
+
+Config::Entry<bool> Config::ZSTD_ADAPTIVE_LEVEL(
+    "orc.compress.zstd.adaptive.level",
+    false);
+
 Config::Entry<uint64_t> Config::COMPRESSION_BLOCK_SIZE{
     "hive.exec.orc.compress.size",
     256 * 1024};
@@ -58,6 +66,25 @@ Config::Entry<uint32_t> Config::ROW_INDEX_STRIDE{
     "hive.exec.orc.row.index.stride",
     10000};
 
+Config::Entry<const std::vector<uint32_t>> Config::BLOOM_FILTER_COLS(
+    "orc.bloom.filter.cols",
+    {},
+    [](const std::vector<uint32_t>& val) { return folly::join(",", val); },
+    [](const std::string& val) {
+      std::vector<uint32_t> result;
+      if (!val.empty()) {
+        std::vector<folly::StringPiece> pieces;
+        folly::split(',', val, pieces, true);
+        for (auto& p : pieces) {
+          const auto& trimmedCol = folly::trimWhitespace(p);
+          if (!trimmedCol.empty()) {
+            result.push_back(folly::to<uint32_t>(trimmedCol));
+          }
+        }
+      }
+      return result;
+    });
+
 Config::Entry<proto::ChecksumAlgorithm> Config::CHECKSUM_ALGORITHM{
     "orc.checksum.algorithm",
     proto::ChecksumAlgorithm::XXHASH};
@@ -88,6 +115,10 @@ Config::Entry<bool> Config::DICTIONARY_SORT_KEYS{
     "hive.exec.orc.dictionary.key.sorted",
     false};
 
+Config::Entry<uint32_t> Config::DICTIONARY_SAMPLE_ROWS{
+    "orc.dictionary.sample.rows",
+    0};
+
 Config::Entry<float> Config::ENTROPY_KEY_STRING_SIZE_THRESHOLD{
     "hive.exec.orc.entropy.key.string.size.threshold",
     0.9f};
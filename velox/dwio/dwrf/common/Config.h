@@ -81,12 +81,23 @@ class Config {
   static Entry<CompressionKind> COMPRESSION;
   static Entry<int32_t> ZLIB_COMPRESSION_LEVEL;
   static Entry<int32_t> ZSTD_COMPRESSION_LEVEL;
+  // If not 0, the ZSTD streams of each column are compressed with a
+  // dictionary of at most this many bytes from the second stripe on. The
+  // dictionary is trained on the first stripe and stored in the file
+  // metadata. Such files need a reader that supports dictionaries.
+  static Entry<uint32_t> ZSTD_DICTIONARY_SIZE;
+  // Compresses the ZSTD streams that compress poorly with level 1 instead
+  // of ZSTD_COMPRESSION_LEVEL, as measured after each stripe.
+  static Entry<bool> ZSTD_ADAPTIVE_LEVEL;
   static Entry<uint64_t> COMPRESSION_BLOCK_SIZE;
   static Entry<uint64_t> COMPRESSION_BLOCK_SIZE_MIN;
   static Entry<float> COMPRESSION_BLOCK_SIZE_EXTEND_RATIO;
   static Entry<uint32_t> COMPRESSION_THRESHOLD;
   static Entry<bool> CREATE_INDEX;
   static Entry<uint32_t> ROW_INDEX_STRIDE;
+  // Top level columns, by index, that get per row group bloom filters.
+  // Supported for integer and varchar columns.
+  static Entry<const std::vector<uint32_t>> BLOOM_FILTER_COLS;
   static Entry<proto::ChecksumAlgorithm> CHECKSUM_ALGORITHM;
   static Entry<proto::StripeCacheMode> STRIPE_CACHE_MODE;
   static Entry<uint32_t> STRIPE_CACHE_SIZE;
@@ -95,6 +106,9 @@ class Config {
   static Entry<float> DICTIONARY_NUMERIC_KEY_SIZE_THRESHOLD;
   static Entry<float> DICTIONARY_STRING_KEY_SIZE_THRESHOLD;
   static Entry<bool> DICTIONARY_SORT_KEYS;
+  // If not 0, the first stripe decides between dictionary and direct
+  // encoding once a column has seen this many values, instead of at flush.
+  static Entry<uint32_t> DICTIONARY_SAMPLE_ROWS;
   static Entry<float> ENTROPY_KEY_STRING_SIZE_THRESHOLD;
   static Entry<uint32_t> ENTROPY_STRING_MIN_SAMPLES;
   static Entry<float> ENTROPY_STRING_DICT_SAMPLE_FRACTION;
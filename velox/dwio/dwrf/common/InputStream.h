@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "velox/buffer/Buffer.h"
 #include "velox/dwio/common/DataBuffer.h"
 #include "velox/dwio/common/InputStream.h"
 #include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
@@ -59,6 +60,14 @@ class SeekableInputStream : public google::protobuf::io::ZeroCopyInputStream {
       size_t startIndex) = 0;
 
   void readFully(char* buffer, size_t bufferSize);
+
+  // Returns a Buffer over the bytes returned by the last Next() that keeps
+  // these live and unchanged for its lifetime, or nullptr if these may be
+  // freed or overwritten when 'this' advances. Lets readers reference the
+  // bytes instead of copying them.
+  virtual BufferPtr currentBuffer() {
+    return nullptr;
+  }
 };
 
 /**
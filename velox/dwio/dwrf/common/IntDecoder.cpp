@@ -893,6 +893,96 @@ __attribute__((__target__("bmi2"))) FOLLY_ALWAYS_INLINE void varintSwitch(
   }
 }
 
+namespace {
+// A pshufb mask that moves the 1 and 2 byte varints at the start of an 8
+// byte word into consecutive 16 bit lanes, low byte first. Bytes of lanes
+// past the last varint are cleared.
+struct ShortVarintShuffle {
+  int8_t shuffle[16];
+  // Number of varints decoded by 'shuffle'.
+  uint8_t numValues;
+  // Number of bytes these varints occupy.
+  uint8_t numBytes;
+};
+
+// Indexed by the continuation bits of an 8 byte word. The varints are taken
+// up to the first one longer than 2 bytes or not ending in the word.
+std::array<ShortVarintShuffle, 256> makeShortVarintShuffles() {
+  std::array<ShortVarintShuffle, 256> shuffles;
+  for (int32_t bits = 0; bits < 256; ++bits) {
+    auto& entry = shuffles[bits];
+    std::fill(std::begin(entry.shuffle), std::end(entry.shuffle), -1);
+    int32_t byte = 0;
+    int32_t numValues = 0;
+    while (byte < 8) {
+      if (!(bits & (1 << byte))) {
+        entry.shuffle[numValues * 2] = byte;
+        byte += 1;
+      } else if (byte < 7 && !(bits & (1 << (byte + 1)))) {
+        entry.shuffle[numValues * 2] = byte;
+        entry.shuffle[numValues * 2 + 1] = byte + 1;
+        byte += 2;
+      } else {
+        break;
+      }
+      ++numValues;
+    }
+    entry.numValues = numValues;
+    entry.numBytes = byte;
+  }
+  return shuffles;
+}
+
+const std::array<ShortVarintShuffle, 256> kShortVarintShuffles =
+    makeShortVarintShuffles();
+
+// Minimum number of varints for which decodeShortVarints() is preferred
+// over varintSwitch().
+constexpr int32_t kMinShortVarints = 4;
+
+// Stores the 8 16 bit lanes of 'lanes' as T at output[0] ... output[7].
+template <typename T>
+inline void store8x16(__m128i lanes, T* output) {
+  if constexpr (sizeof(T) == 8) {
+    *reinterpret_cast<__m256i_u*>(output) = _mm256_cvtepu16_epi64(lanes);
+    *reinterpret_cast<__m256i_u*>(output + 4) =
+        _mm256_cvtepu16_epi64(_mm_srli_si128(lanes, 8));
+  } else if constexpr (sizeof(T) == 4) {
+    *reinterpret_cast<__m256i_u*>(output) = _mm256_cvtepu16_epi32(lanes);
+  } else {
+    static_assert(sizeof(T) == 2);
+    *reinterpret_cast<__m128i_u*>(output) = lanes;
+  }
+}
+
+// Decodes the 1 and 2 byte varints at the start of 'word', whose
+// continuation bits are 'controlBits', in the manner of Masked VByte: one
+// table lookup and one shuffle for up to 8 values instead of a branch per
+// value. This is the common shape of lengths and small integers. Stores 8
+// values at 'output' and advances 'output' past the valid ones. Returns the
+// number of bytes consumed, or 0 without storing if fewer than
+// kMinShortVarints varints qualify, in which case the caller uses
+// varintSwitch().
+template <typename T>
+FOLLY_ALWAYS_INLINE int32_t
+decodeShortVarints(uint64_t word, uint64_t controlBits, T*& output) {
+  const auto& entry = kShortVarintShuffles[controlBits];
+  if (entry.numValues < kMinShortVarints) {
+    return 0;
+  }
+  auto lanes = _mm_shuffle_epi8(
+      _mm_cvtsi64_si128(word),
+      *reinterpret_cast<const __m128i_u*>(entry.shuffle));
+  // Drops the continuation bit of the first byte and joins the 7 bit groups.
+  lanes = _mm_or_si128(
+      _mm_and_si128(lanes, _mm_set1_epi16(0x7f)),
+      _mm_srli_epi16(_mm_and_si128(lanes, _mm_set1_epi16(0x7f00)), 1));
+  store8x16(lanes, output);
+  output += entry.numValues;
+  return entry.numBytes;
+}
+} // namespace
+
 template <bool isSigned>
 template <typename T>
 __attribute__((__target__("bmi2"))) void IntDecoder<isSigned>::bulkRead(
@@ -918,6 +1008,12 @@ __attribute__((__target__("bmi2"))) void IntDecoder<isSigned>::bulkRead(
       pos += maskSize;
       const auto word = folly::loadUnaligned<uint64_t>(pos);
       const uint64_t controlBits = _pext_u64(word, mask);
+      if (!carryoverBits) {
+        if (auto numBytes = decodeShortVarints(word, controlBits, output)) {
+          pos += numBytes - maskSize;
+          continue;
+        }
+      }
       varintSwitch(word, controlBits, pos, output, carryover, carryoverBits);
     }
     if (pos) {
@@ -988,8 +1084,17 @@ IntDecoder<isSigned>::bulkReadRows(RowSet rows, T* result, int32_t initialRow) {
           rows[nextRowIndex + numEnds] == row + numEnds) {
         // A word worth of contiguous rows.
         auto orgOutput = output;
-        // Reading 6 - 8 bytes of contiguous values.
-        varintSwitch(word, controlBits, pos, output, carryover, carryoverBits);
+        int32_t numBytes = 0;
+        if (!carryoverBits && nextRowIndex + 8 <= rows.size()) {
+          numBytes = decodeShortVarints(word, controlBits, output);
+        }
+        if (numBytes) {
+          pos += numBytes - maskSize;
+        } else {
+          // Reading 6 - 8 bytes of contiguous values.
+          varintSwitch(
+              word, controlBits, pos, output, carryover, carryoverBits);
+        }
         int numDone = output - orgOutput;
         row += numDone;
         nextRowIndex += numDone;
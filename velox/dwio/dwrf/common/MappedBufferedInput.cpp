@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/dwio/dwrf/common/MappedBufferedInput.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace facebook::velox::dwrf {
+
+MappedBufferedInput::MappedBufferedInput(
+    dwio::common::InputStream& input,
+    memory::MemoryPool& pool,
+    dwio::common::DataCacheConfig* dataCacheConfig)
+    : BufferedInput(input, pool, dataCacheConfig), data_(input.mappedData()) {
+  VELOX_CHECK(!data_.empty(), "MappedBufferedInput needs mapped data");
+}
+
+std::unique_ptr<SeekableInputStream> MappedBufferedInput::enqueue(
+    dwio::common::Region region,
+    const StreamIdentifier* /*si*/) {
+  if (region.length > 0) {
+    regions_.push_back(region);
+  }
+  return view(region.offset, region.length);
+}
+
+void MappedBufferedInput::load(const dwio::common::LogType) {
+  static const uint64_t kPageSize = sysconf(_SC_PAGESIZE);
+  auto base = reinterpret_cast<uintptr_t>(data_.data());
+  for (auto& region : regions_) {
+    // madvise() takes a page aligned start.
+    auto start = base + region.offset;
+    auto alignedStart = start & ~(kPageSize - 1);
+    madvise(
+        reinterpret_cast<void*>(alignedStart),
+        start + region.length - alignedStart,
+        MADV_WILLNEED);
+  }
+  regions_.clear();
+}
+
+std::unique_ptr<SeekableInputStream> MappedBufferedInput::read(
+    uint64_t offset,
+    uint64_t length,
+    dwio::common::LogType /*logType*/) const {
+  return view(offset, length);
+}
+
+std::unique_ptr<SeekableInputStream> MappedBufferedInput::view(
+    uint64_t offset,
+    uint64_t length) const {
+  VELOX_CHECK_LE(
+      offset + length,
+      data_.size(),
+      "Read past the end of {}",
+      input_.getName());
+  return std::make_unique<SeekableArrayInputStream>(
+      data_.data() + offset, length);
+}
+
+std::unique_ptr<BufferedInput> MappedBufferedInputFactory::create(
+    dwio::common::InputStream& input,
+    velox::memory::MemoryPool& pool,
+    dwio::common::DataCacheConfig* dataCacheConfig) const {
+  if (input.mappedData().empty()) {
+    return std::make_unique<BufferedInput>(input, pool, dataCacheConfig);
+  }
+  return std::make_unique<MappedBufferedInput>(input, pool, dataCacheConfig);
+}
+
+} // namespace facebook::velox::dwrf
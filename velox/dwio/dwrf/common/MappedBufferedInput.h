@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/dwio/dwrf/common/BufferedInput.h"
+
+namespace facebook::velox::dwrf {
+
+// BufferedInput over a file that is in addressable memory, e.g. a memory
+// mapped local file. See InputStream::mappedData(). Streams are views of
+// the file's memory, so nothing is copied and uncompressed streams go to
+// the decoders as they are. load() advises the kernel to read ahead the
+// pages of the enqueued regions.
+class MappedBufferedInput : public BufferedInput {
+ public:
+  MappedBufferedInput(
+      dwio::common::InputStream& input,
+      memory::MemoryPool& pool,
+      dwio::common::DataCacheConfig* dataCacheConfig = nullptr);
+
+  std::unique_ptr<SeekableInputStream> enqueue(
+      dwio::common::Region region,
+      const StreamIdentifier* si) override;
+
+  void load(const dwio::common::LogType) override;
+
+  bool isBuffered(uint64_t offset, uint64_t length) const override {
+    return offset + length <= data_.size();
+  }
+
+  std::unique_ptr<SeekableInputStream> read(
+      uint64_t offset,
+      uint64_t length,
+      dwio::common::LogType logType) const override;
+
+  // Preloading only issues read-ahead advice.
+  bool shouldPreload() override {
+    return true;
+  }
+
+ private:
+  std::unique_ptr<SeekableInputStream> view(uint64_t offset, uint64_t length)
+      const;
+
+  const std::string_view data_;
+  // Regions enqueued since the last load().
+  std::vector<dwio::common::Region> regions_;
+};
+
+// Makes MappedBufferedInput for inputs with mapped data and BufferedInput
+// for others.
+class MappedBufferedInputFactory : public BufferedInputFactory {
+ public:
+  std::unique_ptr<BufferedInput> create(
+      dwio::common::InputStream& input,
+      velox::memory::MemoryPool& pool,
+      dwio::common::DataCacheConfig* dataCacheConfig = nullptr) const override;
+};
+
+} // namespace facebook::velox::dwrf
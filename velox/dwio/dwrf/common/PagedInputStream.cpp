@@ -113,6 +113,10 @@ bool PagedInputStream::Next(const void** data, int32_t* size) {
     return true;
   }
 
+  if (executor_) {
+    return nextWithReadAhead(data, size);
+  }
+
   // release previous decryption buffer
   decryptionBuffer_ = nullptr;
 
@@ -183,6 +187,146 @@ bool PagedInputStream::Next(const void** data, int32_t* size) {
   return true;
 }
 
+void PagedInputStream::fillReadAhead() {
+  while (readAhead_.size() < kMaxReadAhead) {
+    readHeader();
+    if (state_ == State::END) {
+      return;
+    }
+    auto block = std::make_shared<ReadAheadBlock>(pool_);
+    block->headerOffset = lastHeaderOffset_;
+    block->original = state_ == State::ORIGINAL;
+    block->inputLength = remainingLength_;
+    block->input.reserve(remainingLength_);
+    for (size_t pos = 0; pos < remainingLength_;) {
+      if (inputBufferPtr_ == inputBufferPtrEnd_) {
+        readBuffer(true);
+      }
+      auto length = std::min(
+          static_cast<size_t>(inputBufferPtrEnd_ - inputBufferPtr_),
+          remainingLength_ - pos);
+      std::copy(
+          inputBufferPtr_,
+          inputBufferPtr_ + length,
+          block->input.data() + pos);
+      pos += length;
+      inputBufferPtr_ += length;
+    }
+    remainingLength_ = 0;
+    state_ = State::HEADER;
+
+    if (block->original && !decrypter_) {
+      block->outputLength = block->inputLength;
+      block->started = true;
+      block->finished = true;
+    } else {
+      if (!block->original) {
+        // The size of an encrypted block is known after decryption, so
+        // its output has room for the largest block.
+        block->output.reserve(
+            decrypter_ ? decompressor_->blockSize()
+                       : decompressor_->getUncompressedLength(
+                             block->input.data(), block->inputLength));
+      }
+      executor_->add([decompressor = decompressor_.get(),
+                      decrypter = decrypter_,
+                      block]() {
+        decodeBlock(decompressor, decrypter, *block);
+      });
+    }
+    readAhead_.push_back(std::move(block));
+  }
+}
+
+// static
+void PagedInputStream::decodeBlock(
+    Decompressor* decompressor,
+    const dwio::common::encryption::Decrypter* decrypter,
+    ReadAheadBlock& block) {
+  {
+    std::lock_guard<std::mutex> l(block.mutex);
+    if (block.started) {
+      return;
+    }
+    block.started = true;
+  }
+  try {
+    const char* input = block.input.data();
+    size_t length = block.inputLength;
+    if (decrypter) {
+      block.decrypted = decrypter->decrypt(folly::StringPiece{input, length});
+      input = reinterpret_cast<const char*>(block.decrypted->data());
+      length = block.decrypted->length();
+    }
+    if (block.original) {
+      block.outputLength = length;
+    } else {
+      block.outputLength = decompressor->decompress(
+          input, length, block.output.data(), block.output.capacity());
+      block.decrypted = nullptr;
+    }
+  } catch (const std::exception&) {
+    block.error = std::current_exception();
+  }
+  std::lock_guard<std::mutex> l(block.mutex);
+  block.finished = true;
+  block.done.notify_all();
+}
+
+void PagedInputStream::waitForBlock(ReadAheadBlock& block) {
+  decodeBlock(decompressor_.get(), decrypter_, block);
+  std::unique_lock<std::mutex> l(block.mutex);
+  block.done.wait(l, [&]() { return block.finished; });
+  if (block.error) {
+    std::rethrow_exception(block.error);
+  }
+}
+
+bool PagedInputStream::nextWithReadAhead(const void** data, int32_t* size) {
+  if (currentBlock_) {
+    currentBlock_->freeBuffers();
+    currentBlock_ = nullptr;
+  }
+  fillReadAhead();
+  if (readAhead_.empty()) {
+    return false;
+  }
+  currentBlock_ = std::move(readAhead_.front());
+  readAhead_.pop_front();
+  // Schedules the blocks after this one before waiting for it.
+  fillReadAhead();
+  waitForBlock(*currentBlock_);
+
+  // Seeks within the current block are relative to its header.
+  lastHeaderOffset_ = currentBlock_->headerOffset;
+  bytesReturnedAtLastHeaderOffset_ = bytesReturned_;
+  const char* output = currentBlock_->data();
+  *data = output;
+  *size = static_cast<int32_t>(currentBlock_->outputLength);
+  outputBufferPtr_ = output + currentBlock_->outputLength;
+  outputBufferLength_ = 0;
+  bytesReturned_ += *size;
+  return true;
+}
+
+void PagedInputStream::clearReadAhead() {
+  for (auto& block : readAhead_) {
+    std::unique_lock<std::mutex> l(block->mutex);
+    if (!block->started) {
+      // The executor skips the block when it gets to it.
+      block->started = true;
+    } else {
+      block->done.wait(l, [&]() { return block->finished; });
+    }
+    block->freeBuffers();
+  }
+  readAhead_.clear();
+  if (currentBlock_) {
+    currentBlock_->freeBuffers();
+    currentBlock_ = nullptr;
+  }
+}
+
 void PagedInputStream::BackUp(int32_t count) {
   DWIO_ENSURE(
       outputBufferPtr_ != nullptr,
@@ -213,6 +357,7 @@ bool PagedInputStream::Skip(int32_t count) {
 }
 
 void PagedInputStream::clearDecompressionState() {
+  clearReadAhead();
   state_ = State::HEADER;
   outputBufferLength_ = 0;
   remainingLength_ = 0;
@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
 #include "velox/dwio/dwrf/common/Compression.h"
 
 namespace facebook::velox::dwrf {
@@ -27,7 +31,8 @@ class PagedInputStream : public SeekableInputStream {
       memory::MemoryPool& memPool,
       std::unique_ptr<Decompressor> decompressor,
       const dwio::common::encryption::Decrypter* decrypter,
-      const std::string& streamDebugInfo)
+      const std::string& streamDebugInfo,
+      folly::Executor* executor = nullptr)
       : input_(std::move(inStream)),
         pool_(memPool),
         inputBuffer_(pool_),
@@ -37,6 +42,17 @@ class PagedInputStream : public SeekableInputStream {
     DWIO_ENSURE(
         decompressor_ || decrypter_,
         "one of decompressor or decryptor is required");
+    // Blocks are read ahead if both their decryption and decompression
+    // may run on other threads.
+    if (executor &&
+        (!decompressor_ || decompressor_->canDecompressConcurrently()) &&
+        (!decrypter_ || decrypter_->canDecryptConcurrently())) {
+      executor_ = executor;
+    }
+  }
+
+  ~PagedInputStream() override {
+    clearReadAhead();
   }
 
   bool Next(const void** data, int32_t* size) override;
@@ -88,6 +104,76 @@ class PagedInputStream : public SeekableInputStream {
 
   void clearDecompressionState();
 
+  // Maximum number of blocks read ahead of the block being returned
+  // from Next().
+  static constexpr size_t kMaxReadAhead = 3;
+
+  // A block read ahead of use. The decryption and decompression are
+  // scheduled on 'executor_' and whichever of the executor and the reader
+  // gets to it first does them. The memory from 'pool_' is allocated and
+  // freed on the reader's thread.
+  struct ReadAheadBlock {
+    explicit ReadAheadBlock(memory::MemoryPool& pool)
+        : input(pool), output(pool) {}
+
+    void freeBuffers() {
+      input.clear();
+      output.clear();
+      decrypted = nullptr;
+    }
+
+    // The data of the block for the reader.
+    const char* data() const {
+      if (!original) {
+        return output.data();
+      }
+      return decrypted ? reinterpret_cast<const char*>(decrypted->data())
+                       : input.data();
+    }
+
+    // Offset of the header of the block in 'input_'.
+    uint64_t headerOffset{0};
+    // The block as stored in the file and its uncompressed form. For
+    // an uncompressed block, 'input' holds the data.
+    dwio::common::DataBuffer<char> input;
+    dwio::common::DataBuffer<char> output;
+    // The decrypted 'input' of an uncompressed block of an encrypted
+    // stream.
+    std::unique_ptr<folly::IOBuf> decrypted;
+    size_t inputLength{0};
+    size_t outputLength{0};
+    bool original{false};
+
+    std::mutex mutex;
+    std::condition_variable done;
+    bool started{false};
+    bool finished{false};
+    std::exception_ptr error;
+  };
+
+  // Next() when blocks are read ahead and decoded on 'executor_'.
+  bool nextWithReadAhead(const void** data, int32_t* size);
+
+  // Reads blocks and schedules their decoding until there are
+  // kMaxReadAhead blocks or the input is at end.
+  void fillReadAhead();
+
+  // Decrypts and decompresses 'block' unless this is already started.
+  // 'decompressor' and 'decrypter' are nullptr if the stream is not
+  // compressed or not encrypted.
+  static void decodeBlock(
+      Decompressor* decompressor,
+      const dwio::common::encryption::Decrypter* decrypter,
+      ReadAheadBlock& block);
+
+  // Returns when 'block' is decoded, decoding it on the calling thread if
+  // it is not started. Throws the decoding error if any.
+  void waitForBlock(ReadAheadBlock& block);
+
+  // Drops the read ahead blocks after waiting for the ones being
+  // decoded.
+  void clearReadAhead();
+
   enum class State { HEADER, START, ORIGINAL, END };
 
   // make sure input is contiguous for decompression/decryption
@@ -137,6 +223,16 @@ class PagedInputStream : public SeekableInputStream {
   // decrypter
   const dwio::common::encryption::Decrypter* decrypter_;
 
+  // Executor for decrypting and decompressing read ahead blocks. nullptr
+  // if blocks are decoded inline.
+  folly::Executor* executor_{nullptr};
+
+  // Blocks following 'currentBlock_' in read order.
+  std::deque<std::shared_ptr<ReadAheadBlock>> readAhead_;
+
+  // The block returned by the last Next() if reading ahead.
+  std::shared_ptr<ReadAheadBlock> currentBlock_;
+
  private:
   // Stream Debug Info
   const std::string streamDebugInfo_;
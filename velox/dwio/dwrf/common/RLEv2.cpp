@@ -16,6 +16,8 @@
 
 #include "velox/dwio/dwrf/common/RLEv2.h"
 
+#include <folly/lang/Bits.h>
+
 namespace facebook::velox::dwrf {
 
 using memory::MemoryPool;
@@ -105,6 +107,57 @@ inline uint32_t getClosestFixedBits(uint32_t n) {
   }
 }
 
+namespace {
+// Unpacks 'numValues' kWidth bit values packed most significant bit first,
+// starting at the first bit of 'input'. Each value comes from an unaligned
+// big endian load with constant shifts, so that the loop has no branch per
+// bit or per value. Reads up to 9 bytes from the first byte of the last
+// value.
+template <int32_t kWidth>
+void unpackBits(const char* input, uint64_t numValues, int64_t* output) {
+  if constexpr (kWidth == 8 || kWidth == 16 || kWidth == 32) {
+    using T = std::conditional_t<
+        kWidth == 8,
+        uint8_t,
+        std::conditional_t<kWidth == 16, uint16_t, uint32_t>>;
+    for (uint64_t i = 0; i < numValues; ++i) {
+      output[i] =
+          folly::Endian::big(folly::loadUnaligned<T>(input + i * sizeof(T)));
+    }
+  } else {
+    for (uint64_t i = 0; i < numValues; ++i) {
+      const uint64_t bit = i * kWidth;
+      const auto word =
+          folly::Endian::big(folly::loadUnaligned<uint64_t>(input + bit / 8));
+      uint64_t value = (word << (bit % 8)) >> (64 - kWidth);
+      if constexpr (kWidth > 56 && kWidth < 64) {
+        // The value may end in the 9th byte.
+        const int32_t overflow = bit % 8 + kWidth - 64;
+        if (overflow > 0) {
+          value |= static_cast<uint8_t>(input[bit / 8 + 8]) >> (8 - overflow);
+        }
+      }
+      output[i] = static_cast<int64_t>(value);
+    }
+  }
+}
+
+using UnpackFunction = void (*)(const char*, uint64_t, int64_t*);
+
+template <int32_t... kWidths>
+constexpr std::array<UnpackFunction, sizeof...(kWidths) + 1>
+makeUnpackFunctions(std::integer_sequence<int32_t, kWidths...>) {
+  return {{nullptr, &unpackBits<kWidths + 1>...}};
+}
+
+// unpackBits() for each bit width from 1 to 64, indexed by the width.
+constexpr auto kUnpackFunctions =
+    makeUnpackFunctions(std::make_integer_sequence<int32_t, 64>());
+
+// Bytes that unpackBits() may read from the start of the last value.
+constexpr uint64_t kUnpackSlack = 9;
+} // namespace
+
 template <bool isSigned>
 int64_t RleDecoderV2<isSigned>::readLongBE(uint64_t bsz) {
   int64_t ret = 0, val;
@@ -117,6 +170,54 @@ int64_t RleDecoderV2<isSigned>::readLongBE(uint64_t bsz) {
   return ret;
 }
 
+template <bool isSigned>
+void RleDecoderV2<isSigned>::skipBits(uint64_t numBits) {
+  if (numBits <= bitsLeft) {
+    bitsLeft -= numBits;
+    return;
+  }
+  numBits -= bitsLeft;
+  bitsLeft = 0;
+  skipBytes(
+      numBits / 8,
+      IntDecoder<isSigned>::inputStream.get(),
+      IntDecoder<isSigned>::bufferStart,
+      IntDecoder<isSigned>::bufferEnd);
+  if (numBits % 8) {
+    curByte = readByte();
+    bitsLeft = 8 - numBits % 8;
+  }
+}
+
+template <bool isSigned>
+void RleDecoderV2<isSigned>::readLongsDense(
+    int64_t* data,
+    uint64_t len,
+    uint64_t fb) {
+  VELOX_DCHECK(fb >= 1 && fb <= 64);
+  uint64_t i = 0;
+  while (i < len) {
+    auto& bufferStart = IntDecoder<isSigned>::bufferStart;
+    const uint64_t available = IntDecoder<isSigned>::bufferEnd - bufferStart;
+    if (bitsLeft > 0 || available < kUnpackSlack) {
+      // Reads single values until the next one starts at a byte boundary or
+      // the buffer is refilled.
+      data[i++] = static_cast<int64_t>(readBits(fb));
+      continue;
+    }
+    const uint64_t numValues =
+        std::min(len - i, (available - kUnpackSlack) * 8 / fb + 1);
+    kUnpackFunctions[fb](bufferStart, numValues, data + i);
+    i += numValues;
+    const uint64_t numBits = numValues * fb;
+    bufferStart += numBits / 8;
+    if (numBits % 8) {
+      curByte = static_cast<unsigned char>(*bufferStart++);
+      bitsLeft = 8 - numBits % 8;
+    }
+  }
+}
+
 template <bool isSigned>
 RleDecoderV2<isSigned>::RleDecoderV2(
     std::unique_ptr<SeekableInputStream> input,
@@ -168,15 +269,51 @@ template void RleDecoderV2<false>::seekToRowGroup(PositionProvider& location);
 
 template <bool isSigned>
 void RleDecoderV2<isSigned>::skip(uint64_t numValues) {
-  // simple for now, until perf tests indicate something encoding specific is
-  // needed
+  // Repeats, direct runs and fixed deltas are skipped without decoding. The
+  // other runs are decoded into 'dummy'.
   const uint64_t N = 64;
   int64_t dummy[N];
 
   while (numValues) {
-    uint64_t nRead = std::min(N, numValues);
-    next(dummy, nRead, nullptr);
-    numValues -= nRead;
+    if (runRead == runLength) {
+      resetRun();
+      firstByte = readByte();
+    }
+
+    uint64_t nSkipped;
+    EncodingType enc = static_cast<EncodingType>((firstByte >> 6) & 0x03);
+    switch (static_cast<int64_t>(enc)) {
+      case SHORT_REPEAT:
+        // Reads the header of a new run.
+        nextShortRepeats(dummy, 0, 0, nullptr);
+        nSkipped = std::min(runLength - runRead, numValues);
+        break;
+      case DIRECT:
+        nextDirect(dummy, 0, 0, nullptr);
+        nSkipped = std::min(runLength - runRead, numValues);
+        skipBits(nSkipped * bitSize);
+        break;
+      case PATCHED_BASE:
+        numValues -= nextPatched(dummy, 0, std::min(N, numValues), nullptr);
+        continue;
+      case DELTA:
+        nextDelta(dummy, 0, 0, nullptr);
+        if (bitSize != 0) {
+          numValues -= nextDelta(dummy, 0, std::min(N, numValues), nullptr);
+          continue;
+        }
+        nSkipped = std::min(runLength - runRead, numValues);
+        // The value before the next one to read. The first value has no
+        // delta.
+        prevValue = runRead == 0
+            ? firstValue + static_cast<int64_t>(nSkipped - 1) * deltaBase
+            : prevValue + static_cast<int64_t>(nSkipped) * deltaBase;
+        break;
+      default:
+        DWIO_RAISE("unknown encoding");
+    }
+    runRead += nSkipped;
+    numValues -= nSkipped;
   }
 }
 
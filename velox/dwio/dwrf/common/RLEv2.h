@@ -106,37 +106,52 @@ class RleDecoderV2 : public IntDecoder<isSigned> {
   }
 
   int64_t readLongBE(uint64_t bsz);
+
+  // Reads the next 'fb' bit value, most significant bit first.
+  uint64_t readBits(uint64_t fb) {
+    uint64_t result = 0;
+    uint64_t bitsLeftToRead = fb;
+    while (bitsLeftToRead > bitsLeft) {
+      result <<= bitsLeft;
+      result |= curByte & ((1 << bitsLeft) - 1);
+      bitsLeftToRead -= bitsLeft;
+      curByte = readByte();
+      bitsLeft = 8;
+    }
+
+    // handle the left over bits
+    if (bitsLeftToRead > 0) {
+      result <<= bitsLeftToRead;
+      bitsLeft -= static_cast<uint32_t>(bitsLeftToRead);
+      result |= (curByte >> bitsLeft) & ((1 << bitsLeftToRead) - 1);
+    }
+    return result;
+  }
+
+  // Skips 'numBits' bits of bit packed values.
+  void skipBits(uint64_t numBits);
+
+  // Reads 'len' consecutive 'fb' bit values into 'data'. Unpacks the values
+  // in the current buffer with a kernel specialized for 'fb'.
+  void readLongsDense(int64_t* data, uint64_t len, uint64_t fb);
+
   uint64_t readLongs(
       int64_t* data,
       uint64_t offset,
       uint64_t len,
       uint64_t fb,
       const uint64_t* nulls = nullptr) {
+    if (!nulls) {
+      readLongsDense(data + offset, len, fb);
+      return len;
+    }
     uint64_t ret = 0;
-
-    // TODO: unroll to improve performance
     for (uint64_t i = offset; i < (offset + len); i++) {
       // skip null positions
-      if (nulls && bits::isBitNull(nulls, i)) {
+      if (bits::isBitNull(nulls, i)) {
         continue;
       }
-      uint64_t result = 0;
-      uint64_t bitsLeftToRead = fb;
-      while (bitsLeftToRead > bitsLeft) {
-        result <<= bitsLeft;
-        result |= curByte & ((1 << bitsLeft) - 1);
-        bitsLeftToRead -= bitsLeft;
-        curByte = readByte();
-        bitsLeft = 8;
-      }
-
-      // handle the left over bits
-      if (bitsLeftToRead > 0) {
-        result <<= bitsLeftToRead;
-        bitsLeft -= static_cast<uint32_t>(bitsLeftToRead);
-        result |= (curByte >> bitsLeft) & ((1 << bitsLeftToRead) - 1);
-      }
-      data[i] = static_cast<int64_t>(result);
+      data[i] = static_cast<int64_t>(readBits(fb));
       ++ret;
     }
 
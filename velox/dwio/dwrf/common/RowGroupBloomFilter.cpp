@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/dwio/dwrf/common/RowGroupBloomFilter.h"
+
+#include <folly/hash/SpookyHashV2.h>
+
+namespace facebook::velox::dwrf {
+
+uint64_t bloomFilterHash(folly::StringPiece value) {
+  // The hash is stored in files, so it must not change with the folly
+  // version, which folly::hasher does not promise.
+  return folly::hash::SpookyHashV2::Hash64(value.data(), value.size(), 0);
+}
+
+void bloomFilterToProto(
+    const BloomFilter<false>& bloomFilter,
+    proto::BloomFilter& proto) {
+  proto.set_numhashfunctions(kBloomFilterNumHashFunctions);
+  auto* bitset = proto.mutable_bitset();
+  bitset->Reserve(bloomFilter.bits().size());
+  for (auto word : bloomFilter.bits()) {
+    bitset->Add(word);
+  }
+}
+
+std::unique_ptr<BloomFilter<false>> bloomFilterFromProto(
+    const proto::BloomFilter& proto) {
+  if (proto.numhashfunctions() != kBloomFilterNumHashFunctions ||
+      proto.has_utf8bitset() || proto.bitset_size() == 0 ||
+      !bits::isPowerOfTwo(proto.bitset_size())) {
+    return nullptr;
+  }
+  auto bloomFilter = std::make_unique<BloomFilter<false>>();
+  bloomFilter->setBits(
+      std::vector<uint64_t>(proto.bitset().begin(), proto.bitset().end()));
+  return bloomFilter;
+}
+
+namespace {
+template <typename T>
+bool testValues(const T& values, const BloomFilter<false>& bloomFilter) {
+  if (values.size() > kMaxBloomFilterTestValues) {
+    return true;
+  }
+  for (const auto& value : values) {
+    if (bloomFilter.mayContain(bloomFilterHash(value))) {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+bool testBloomFilter(
+    const common::Filter& filter,
+    const BloomFilter<false>& bloomFilter) {
+  switch (filter.kind()) {
+    case common::FilterKind::kBigintRange: {
+      auto range = static_cast<const common::BigintRange*>(&filter);
+      return !range->isSingleValue() ||
+          bloomFilter.mayContain(bloomFilterHash(range->lower()));
+    }
+    case common::FilterKind::kBigintValuesUsingHashTable:
+      return testValues(
+          static_cast<const common::BigintValuesUsingHashTable*>(&filter)
+              ->values(),
+          bloomFilter);
+    case common::FilterKind::kBigintValuesUsingBitmask:
+      return testValues(
+          static_cast<const common::BigintValuesUsingBitmask*>(&filter)
+              ->values(),
+          bloomFilter);
+    case common::FilterKind::kBytesRange: {
+      auto range = static_cast<const common::BytesRange*>(&filter);
+      return !range->isSingleValue() ||
+          bloomFilter.mayContain(bloomFilterHash(range->lower()));
+    }
+    case common::FilterKind::kBytesValues:
+      return testValues(
+          static_cast<const common::BytesValues*>(&filter)->values(),
+          bloomFilter);
+    default:
+      return true;
+  }
+}
+
+} // namespace facebook::velox::dwrf
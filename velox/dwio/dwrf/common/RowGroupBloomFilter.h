@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <folly/Range.h>
+
+#include "velox/common/base/BloomFilter.h"
+#include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
+#include "velox/type/Filter.h"
+
+namespace facebook::velox::dwrf {
+
+// Row group bloom filters are BloomFilter<false> over the hashes below. They
+// are written to BLOOM_FILTER_UTF8 streams, one proto::BloomFilter per row
+// group, with the words of the filter in 'bitset'. Bloom filters of other
+// writers put their bits in 'utf8bitset' and are not used.
+constexpr uint32_t kBloomFilterNumHashFunctions = 4;
+
+// The most values of an IN list tested against each row group bloom filter.
+constexpr int32_t kMaxBloomFilterTestValues = 1000;
+
+inline uint64_t bloomFilterHash(int64_t value) {
+  return common::BigintValuesUsingBloomFilter::hashValue(value);
+}
+
+uint64_t bloomFilterHash(folly::StringPiece value);
+
+void bloomFilterToProto(
+    const BloomFilter<false>& bloomFilter,
+    proto::BloomFilter& proto);
+
+// Returns the bloom filter in 'proto' or nullptr if it was not written in the
+// format above.
+std::unique_ptr<BloomFilter<false>> bloomFilterFromProto(
+    const proto::BloomFilter& proto);
+
+// Returns false if no non-null value that passes 'filter' can be in
+// 'bloomFilter'. Returns true for filters that do not consist of a
+// moderate number of discrete values.
+bool testBloomFilter(
+    const common::Filter& filter,
+    const BloomFilter<false>& bloomFilter);
+
+} // namespace facebook::velox::dwrf
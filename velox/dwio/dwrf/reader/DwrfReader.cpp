@@ -36,7 +36,8 @@ void DwrfRowReader::checkSkipStrides(
     return;
   }
 
-  if (currentRowInStripe == 0 || recomputeStridesToSkip_) {
+  if ((currentRowInStripe == 0 && !stridesToSkipLoaded_) ||
+      recomputeStridesToSkip_) {
     stridesToSkip_ = columnReader_->filterRowGroups(strideSize, context);
     recomputeStridesToSkip_ = false;
   }
@@ -65,6 +66,19 @@ void DwrfRowReader::checkSkipStrides(
   }
 }
 
+bool DwrfRowReader::skipAllRowGroupsImpl() {
+  auto strideSize = getReader().getFooter().rowindexstride();
+  if (strideSize == 0) {
+    return false;
+  }
+  StatsContext context(
+      getReader().getWriterName(), getReader().getWriterVersion());
+  stridesToSkip_ = columnReader_->filterRowGroups(strideSize, context);
+  stridesToSkipLoaded_ = true;
+  auto numStrides = (rowsInCurrentStripe + strideSize - 1) / strideSize;
+  return stridesToSkip_.size() == numStrides;
+}
+
 uint64_t DwrfRowReader::next(uint64_t size, VectorPtr& result) {
   DWIO_ENSURE_GT(size, 0);
   auto& footer = getReader().getFooter();
@@ -26,6 +26,7 @@ class DwrfRowReader : public DwrfRowReaderShared {
  protected:
   void resetColumnReaderImpl() override {
     columnReader_.reset();
+    stridesToSkipLoaded_ = false;
   }
 
   void createColumnReaderImpl(StripeStreams& stripeStreams) override {
@@ -41,6 +42,8 @@ class DwrfRowReader : public DwrfRowReaderShared {
     columnReader_->skip(currentRowInStripe);
   }
 
+  bool skipAllRowGroupsImpl() override;
+
  public:
   /**
    * Constructor that lets the user specify additional options.
@@ -81,6 +84,10 @@ class DwrfRowReader : public DwrfRowReaderShared {
   // filter. Causes filters to be re-evaluated against stride stats on
   // next stride instead of next stripe.
   bool recomputeStridesToSkip_{false};
+
+  // True if 'stridesToSkip_' was computed for the current stripe before its
+  // data streams were loaded.
+  bool stridesToSkipLoaded_{false};
 };
 
 class DwrfReader : public DwrfReaderShared {
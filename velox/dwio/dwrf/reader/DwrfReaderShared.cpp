@@ -26,6 +26,7 @@ namespace facebook::velox::dwrf {
 
 using dwio::common::ColumnSelector;
 using dwio::common::InputStream;
+using dwio::common::LogType;
 using dwio::common::ReaderOptions;
 using dwio::common::RowReaderOptions;
 using dwio::common::StatsError;
@@ -404,13 +405,70 @@ void DwrfRowReaderShared::startNextStripe() {
   // load data plan according to its updated selector
   // during column reader construction
   // if planReads is off which means stripe data loaded as whole
+  // If the row indexes can be read first, the row group stats can exclude the
+  // whole stripe before its data is read.
   if (!preload) {
-    VLOG(1) << "[DWRF] Load read plan for stripe " << currentStripe;
-    stripeStreams.loadReadPlan();
+    if (stripeStreams.loadRowIndexes() && skipAllRowGroupsImpl()) {
+      VLOG(1) << "[DWRF] Skip read plan for stripe " << currentStripe;
+    } else {
+      VLOG(1) << "[DWRF] Load read plan for stripe " << currentStripe;
+      stripeStreams.loadReadPlan();
+    }
   }
 
   stripeDictionaryCache_ = stripeStreams.getStripeDictionaryCache();
   newStripeLoaded = true;
+  // The IO for the current stripe is issued first, so that the prefetches
+  // queue behind it.
+  prefetchStripes();
+}
+
+void DwrfRowReaderShared::prefetchStripes() {
+  // Only the cache loads in the background. Other inputs would read the
+  // stripe footers inline for nothing.
+  if (!getReader().getDataCacheConfig()) {
+    prefetchedStripes_.clear();
+    return;
+  }
+  auto end = std::min<uint64_t>(
+      lastStripe,
+      static_cast<uint64_t>(currentStripe) + 1 +
+          options_.getStripeLookahead());
+  // Drops the stripes left behind by reading or seeking. The current stripe
+  // may still be waiting for its prefetch.
+  prefetchedStripes_.erase(
+      prefetchedStripes_.begin(),
+      prefetchedStripes_.lower_bound(currentStripe));
+  prefetchedStripes_.erase(
+      prefetchedStripes_.lower_bound(end), prefetchedStripes_.end());
+  for (auto index = currentStripe + 1; index < end; ++index) {
+    if (prefetchedStripes_.count(index)) {
+      continue;
+    }
+    auto prefetch = std::make_unique<StripeReaderBase>(getReaderPtr());
+    bool preload = false;
+    auto& stripeInfo = prefetch->loadStripe(index, preload);
+    if (preload) {
+      // The stripe is in memory.
+      continue;
+    }
+    StripeStreamsImpl stripeStreams(
+        *prefetch,
+        getColumnSelector(),
+        options_,
+        stripeInfo.offset(),
+        *this,
+        index);
+    stripeStreams.enqueueStreams();
+    auto& input = prefetch->getStripeInput();
+    // Stops at the first stripe that the input has no memory for.
+    if (!input.shouldPreload()) {
+      break;
+    }
+    VLOG(1) << "[DWRF] Prefetch stripe " << index;
+    input.load(LogType::STREAM_BUNDLE);
+    prefetchedStripes_[index] = std::move(prefetch);
+  }
 }
 
 size_t DwrfRowReaderShared::estimatedReaderMemory() const {
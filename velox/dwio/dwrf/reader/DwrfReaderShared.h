@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <map>
+
 #include "velox/dwio/common/Options.h"
 #include "velox/dwio/common/Reader.h"
 #include "velox/dwio/dwrf/reader/ColumnReader.h"
@@ -48,9 +50,17 @@ class DwrfRowReaderShared : public StrideIndexProvider,
   // column selector
   std::shared_ptr<dwio::common::ColumnSelector> columnSelector_;
 
+  // Readers of the stripes after the current one whose IO has been started,
+  // by stripe index. A reader is kept until its stripe has been read, since
+  // destroying its input cancels the loads that have not started.
+  std::map<uint32_t, std::unique_ptr<StripeReaderBase>> prefetchedStripes_;
+
   // internal methods
   void startNextStripe();
 
+  // Starts the IO for the stripes in the lookahead of the current stripe.
+  void prefetchStripes();
+
   size_t estimatedRowSizeHelper(
       const proto::Footer& footer,
       const dwio::common::Statistics& stats,
@@ -71,6 +81,13 @@ class DwrfRowReaderShared : public StrideIndexProvider,
 
   virtual void seekImpl() = 0;
 
+  // Called after the row index streams of a stripe are loaded and before IO
+  // for its data streams is scheduled. Returns true if the filters exclude
+  // all row groups of the stripe, so that its data streams are not read.
+  virtual bool skipAllRowGroupsImpl() {
+    return false;
+  }
+
   void setStrideIndex(uint64_t index) {
     strideIndex_ = index;
   }
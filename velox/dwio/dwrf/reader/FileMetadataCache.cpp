@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/dwio/dwrf/reader/FileMetadataCache.h"
+
+#include "velox/common/base/BitUtil.h"
+
+namespace facebook::velox::dwrf {
+
+namespace {
+std::atomic<FileMetadataCache*> instance{nullptr};
+} // namespace
+
+FileMetadataCache::FileMetadataCache(int64_t maxBytes)
+    : pool_(memory::getProcessDefaultMemoryManager().getRoot().addScopedChild(
+          "FileMetadataCache")),
+      cache_(maxBytes) {}
+
+size_t FileMetadataCache::KeyHasher::operator()(const Key& key) const {
+  return bits::hashMix(
+      bits::hashMix(key.fileNum, key.fileLength), key.stripeIndex);
+}
+
+std::optional<FileMetadataCache::Entry> FileMetadataCache::find(
+    const Key& key) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto entry = cache_.get(key);
+  if (!entry) {
+    ++numMisses_;
+    return std::nullopt;
+  }
+  // The shared_ptrs keep the metadata live after the entry is released.
+  auto result = *entry;
+  cache_.release(key);
+  ++numHits_;
+  return result;
+}
+
+void FileMetadataCache::insert(const Key& key, Entry entry, int64_t size) {
+  auto value = std::make_unique<Entry>(std::move(entry));
+  std::lock_guard<std::mutex> l(mutex_);
+  // The cache takes ownership on success. Fails if the key is present, e.g.
+  // inserted by another reader of the same file.
+  if (cache_.add(key, value.get(), size)) {
+    value.release();
+  }
+}
+
+std::shared_ptr<const FileTail> FileMetadataCache::findTail(
+    uint64_t fileNum,
+    uint64_t fileLength) {
+  auto entry = find({fileNum, fileLength, -1});
+  return entry ? entry->tail : nullptr;
+}
+
+void FileMetadataCache::insertTail(
+    uint64_t fileNum,
+    uint64_t fileLength,
+    std::shared_ptr<const FileTail> tail) {
+  auto size = sizeof(FileTail) + tail->postScript->SpaceUsedLong() +
+      tail->footer->SpaceUsedLong() +
+      (tail->stripeCache ? tail->stripeCache->capacity() : 0);
+  insert({fileNum, fileLength, -1}, {std::move(tail), nullptr}, size);
+}
+
+std::shared_ptr<const proto::StripeFooter> FileMetadataCache::findStripeFooter(
+    uint64_t fileNum,
+    uint64_t fileLength,
+    uint32_t stripeIndex) {
+  auto entry = find({fileNum, fileLength, stripeIndex});
+  return entry ? entry->stripeFooter : nullptr;
+}
+
+void FileMetadataCache::insertStripeFooter(
+    uint64_t fileNum,
+    uint64_t fileLength,
+    uint32_t stripeIndex,
+    std::shared_ptr<const proto::StripeFooter> footer) {
+  auto size = footer->SpaceUsedLong();
+  insert(
+      {fileNum, fileLength, stripeIndex}, {nullptr, std::move(footer)}, size);
+}
+
+// static
+FileMetadataCache* FileMetadataCache::getInstance() {
+  return instance;
+}
+
+// static
+void FileMetadataCache::setInstance(FileMetadataCache* instance) {
+  ::facebook::velox::dwrf::instance = instance;
+}
+
+} // namespace facebook::velox::dwrf
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "velox/common/caching/SimpleLRUCache.h"
+#include "velox/common/memory/Memory.h"
+#include "velox/dwio/common/DataBuffer.h"
+#include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
+
+namespace facebook::velox::dwrf {
+
+// The parsed tail of a file.
+struct FileTail {
+  std::unique_ptr<google::protobuf::Arena> arena;
+  std::unique_ptr<proto::PostScript> postScript;
+  // Allocated from 'arena'.
+  const proto::Footer* footer{nullptr};
+  uint64_t psLength{0};
+  // The stripe metadata section of the tail. nullptr if the file has none.
+  std::shared_ptr<dwio::common::DataBuffer<char>> stripeCache;
+};
+
+// Process wide cache of the parsed file footers and stripe footers of files,
+// so that readers of different splits and queries on the same file do not
+// read and parse these again. A file is identified by its file number, i.e.
+// the id of its path in the FileHandle, and its length, which changes when
+// the file is rewritten. The entries are charged against 'maxBytes' and the
+// oldest are dropped first. Thread safe.
+class FileMetadataCache {
+ public:
+  explicit FileMetadataCache(int64_t maxBytes);
+
+  // Returns the tail of the file or nullptr if not cached.
+  std::shared_ptr<const FileTail> findTail(
+      uint64_t fileNum,
+      uint64_t fileLength);
+
+  void insertTail(
+      uint64_t fileNum,
+      uint64_t fileLength,
+      std::shared_ptr<const FileTail> tail);
+
+  // Returns the footer of stripe 'stripeIndex' of the file or nullptr if not
+  // cached.
+  std::shared_ptr<const proto::StripeFooter> findStripeFooter(
+      uint64_t fileNum,
+      uint64_t fileLength,
+      uint32_t stripeIndex);
+
+  void insertStripeFooter(
+      uint64_t fileNum,
+      uint64_t fileLength,
+      uint32_t stripeIndex,
+      std::shared_ptr<const proto::StripeFooter> footer);
+
+  // Pool for the memory of the cached FileTails.
+  memory::MemoryPool& pool() const {
+    return *pool_;
+  }
+
+  int64_t numHits() const {
+    return numHits_;
+  }
+
+  int64_t numMisses() const {
+    return numMisses_;
+  }
+
+  // Returns the process wide instance or nullptr if none is set.
+  static FileMetadataCache* FOLLY_NULLABLE getInstance();
+
+  // Sets the process wide instance. The caller keeps ownership. nullptr
+  // disables the caching.
+  static void setInstance(FileMetadataCache* FOLLY_NULLABLE instance);
+
+ private:
+  struct Key {
+    uint64_t fileNum;
+    uint64_t fileLength;
+    // -1 for the tail.
+    int64_t stripeIndex;
+
+    bool operator==(const Key& other) const {
+      return fileNum == other.fileNum && fileLength == other.fileLength &&
+          stripeIndex == other.stripeIndex;
+    }
+  };
+
+  struct KeyHasher {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    std::shared_ptr<const FileTail> tail;
+    std::shared_ptr<const proto::StripeFooter> stripeFooter;
+  };
+
+  std::optional<Entry> find(const Key& key);
+
+  void insert(const Key& key, Entry entry, int64_t size);
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::mutex mutex_;
+  SimpleLRUCache<Key, Entry, std::equal_to<Key>, KeyHasher> cache_;
+  std::atomic<int64_t> numHits_{0};
+  std::atomic<int64_t> numMisses_{0};
+};
+
+} // namespace facebook::velox::dwrf
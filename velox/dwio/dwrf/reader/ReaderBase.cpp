@@ -96,6 +96,21 @@ ReaderBase::ReaderBase(
       dataCacheConfig_(dataCacheConfig) {
   input_ = bufferedInputFactory_->create(*stream_, pool, dataCacheConfig);
 
+  // The parsed tail may be shared with another reader of the same file.
+  auto* metadataCache =
+      dataCacheConfig ? FileMetadataCache::getInstance() : nullptr;
+  std::shared_ptr<FileTail> newTail;
+  if (metadataCache) {
+    fileLength_ = stream_->getLength();
+    if (auto tail =
+            metadataCache->findTail(dataCacheConfig->filenum, fileLength_)) {
+      initFromTail(std::move(tail), factory);
+      return;
+    }
+    newTail = std::make_shared<FileTail>();
+    newTail->arena = std::make_unique<google::protobuf::Arena>();
+  }
+
   // We may have cached the tail before, in which case we can skip the read.
   if (dataCacheConfig && dataCacheConfig->cache) {
     const std::string tailKey = TailKey(dataCacheConfig->filenum);
@@ -105,7 +120,7 @@ ReaderBase::ReaderBase(
       postScript_ = ProtoUtils::readProto<proto::PostScript>(
           std::make_unique<SeekableArrayInputStream>(
               tail.data() + tail.size() - 1 - psLength_, psLength_));
-      footer_ =
+      auto footer =
           google::protobuf::Arena::CreateMessage<proto::Footer>(arena_.get());
       ProtoUtils::readProtoInto(
           createDecompressedStream(
@@ -114,7 +129,8 @@ ReaderBase::ReaderBase(
                       postScript_->footerlength(),
                   postScript_->footerlength()),
               "File Footer"),
-          footer_);
+          footer);
+      footer_ = footer;
       schema_ = std::dynamic_pointer_cast<const RowType>(convertType(*footer_));
       DWIO_ENSURE_NOT_NULL(schema_, "invalid schema");
       if (postScript_->cachesize() > 0) {
@@ -125,6 +141,7 @@ ReaderBase::ReaderBase(
             *postScript_, *footer_, std::move(cacheBuffer));
       }
       handler_ = DecryptionHandler::create(*footer_, factory);
+      loadZstdDictionaries();
       return;
     }
   }
@@ -187,24 +204,40 @@ ReaderBase::ReaderBase(
 
   auto footerStream = input_->read(
       fileLength_ - psLength_ - footerSize - 1, footerSize, LogType::FOOTER);
-  footer_ = google::protobuf::Arena::CreateMessage<proto::Footer>(arena_.get());
+  auto footer = google::protobuf::Arena::CreateMessage<proto::Footer>(
+      newTail ? newTail->arena.get() : arena_.get());
   ProtoUtils::readProtoInto<proto::Footer>(
       createDecompressedStream(std::move(footerStream), "File Footer"),
-      footer_);
+      footer);
+  footer_ = footer;
 
   schema_ = std::dynamic_pointer_cast<const RowType>(convertType(*footer_));
   DWIO_ENSURE_NOT_NULL(schema_, "invalid schema");
 
   // load stripe index/footer cache
   if (cacheSize > 0) {
-    auto cacheBuffer =
-        std::make_shared<dwio::common::DataBuffer<char>>(pool, cacheSize);
+    // A shared tail outlives this reader, so its memory is not charged to
+    // 'pool'.
+    auto cacheBuffer = std::make_shared<dwio::common::DataBuffer<char>>(
+        newTail ? metadataCache->pool() : pool, cacheSize);
     input_->read(fileLength_ - tailSize, cacheSize, LogType::FOOTER)
         ->readFully(cacheBuffer->data(), cacheSize);
+    if (newTail) {
+      newTail->stripeCache = cacheBuffer;
+    }
     cache_ = std::make_unique<StripeMetadataCache>(
         *postScript_, *footer_, std::move(cacheBuffer));
   }
 
+  if (newTail) {
+    newTail->postScript = std::make_unique<proto::PostScript>(*postScript_);
+    newTail->footer = footer_;
+    newTail->psLength = psLength_;
+    tail_ = newTail;
+    metadataCache->insertTail(
+        dataCacheConfig->filenum, fileLength_, std::move(newTail));
+  }
+
   // Insert the tail in the data cache so we can skip the disk read next time.
   if (dataCacheConfig && dataCacheConfig->cache) {
     std::unique_ptr<char[]> tail(new char[tailSize]);
@@ -227,6 +260,39 @@ ReaderBase::ReaderBase(
   }
   // initialize file decrypter
   handler_ = DecryptionHandler::create(*footer_, factory);
+  loadZstdDictionaries();
+}
+
+void ReaderBase::initFromTail(
+    std::shared_ptr<const FileTail> tail,
+    DecrypterFactory* factory) {
+  tail_ = std::move(tail);
+  psLength_ = tail_->psLength;
+  postScript_ = std::make_unique<proto::PostScript>(*tail_->postScript);
+  footer_ = tail_->footer;
+  schema_ = std::dynamic_pointer_cast<const RowType>(convertType(*footer_));
+  DWIO_ENSURE_NOT_NULL(schema_, "invalid schema");
+  if (tail_->stripeCache) {
+    cache_ = std::make_unique<StripeMetadataCache>(
+        *postScript_, *footer_, tail_->stripeCache);
+  }
+  handler_ = DecryptionHandler::create(*footer_, factory);
+  loadZstdDictionaries();
+}
+
+void ReaderBase::loadZstdDictionaries() {
+  if (getCompressionKind() != CompressionKind::CompressionKind_ZSTD) {
+    return;
+  }
+  for (auto& entry : footer_->metadata()) {
+    folly::StringPiece name{entry.name()};
+    if (name.startsWith(kZstdDictionaryKeyPrefix)) {
+      if (!zstdDictionaries_) {
+        zstdDictionaries_ = std::make_unique<ZstdDecompressionDictionaries>();
+      }
+      zstdDictionaries_->add(entry.value());
+    }
+  }
 }
 
 std::vector<uint64_t> ReaderBase::getRowsPerStripe() const {
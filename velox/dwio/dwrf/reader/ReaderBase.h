@@ -21,6 +21,7 @@
 #include "velox/dwio/dwrf/common/Compression.h"
 #include "velox/dwio/dwrf/common/Statistics.h"
 #include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
+#include "velox/dwio/dwrf/reader/FileMetadataCache.h"
 #include "velox/dwio/dwrf/reader/StripeMetadataCache.h"
 #include "velox/dwio/dwrf/utils/ProtoUtils.h"
 
@@ -93,6 +94,7 @@ class ReaderBase {
     if (!handler_) {
       handler_ = encryption::DecryptionHandler::create(*footer_);
     }
+    loadZstdDictionaries();
   }
 
   // for testing
@@ -196,14 +198,17 @@ class ReaderBase {
   std::unique_ptr<SeekableInputStream> createDecompressedStream(
       std::unique_ptr<SeekableInputStream> compressed,
       const std::string& streamDebugInfo,
-      const dwio::common::encryption::Decrypter* decrypter = nullptr) const {
+      const dwio::common::encryption::Decrypter* decrypter = nullptr,
+      folly::Executor* executor = nullptr) const {
     return createDecompressor(
         getCompressionKind(),
         std::move(compressed),
         getCompressionBlockSize(),
         pool_,
         streamDebugInfo,
-        decrypter);
+        decrypter,
+        executor,
+        zstdDictionaries_.get());
   }
 
   template <typename T>
@@ -225,6 +230,14 @@ class ReaderBase {
   }
 
  private:
+  // Initializes from 'tail' found in the FileMetadataCache.
+  void initFromTail(
+      std::shared_ptr<const FileTail> tail,
+      dwio::common::encryption::DecrypterFactory* factory);
+
+  // Loads the ZSTD dictionaries from the footer metadata.
+  void loadZstdDictionaries();
+
   static std::shared_ptr<const Type> convertType(
       const proto::Footer& footer,
       uint32_t index = 0);
@@ -233,9 +246,14 @@ class ReaderBase {
   std::unique_ptr<dwio::common::InputStream> stream_;
   std::unique_ptr<google::protobuf::Arena> arena_;
   std::unique_ptr<proto::PostScript> postScript_;
-  proto::Footer* footer_ = nullptr;
+  const proto::Footer* footer_ = nullptr;
+  // Owns 'footer_' and the buffer of 'cache_' if these come from or are
+  // shared with the FileMetadataCache.
+  std::shared_ptr<const FileTail> tail_;
   std::unique_ptr<StripeMetadataCache> cache_;
   std::unique_ptr<encryption::DecryptionHandler> handler_;
+  // nullptr if the file has no ZSTD dictionaries.
+  std::unique_ptr<ZstdDecompressionDictionaries> zstdDictionaries_;
   BufferedInputFactory* bufferedInputFactory_ =
       BufferedInputFactory::baseFactory();
   dwio::common::DataCacheConfig* dataCacheConfig_ = nullptr;
@@ -21,11 +21,13 @@
 #include "velox/dwio/dwrf/common/DirectDecoder.h"
 #include "velox/dwio/dwrf/common/FloatingPointDecoder.h"
 #include "velox/dwio/dwrf/common/RLEv1.h"
+#include "velox/dwio/dwrf/common/RowGroupBloomFilter.h"
 #include "velox/dwio/dwrf/utils/ProtoUtils.h"
 #include "velox/exec/AggregationHook.h"
 #include "velox/vector/ConstantVector.h"
 #include "velox/vector/DictionaryVector.h"
 #include "velox/vector/FlatVector.h"
+#include "velox/vector/SequenceVector.h"
 
 #include <numeric>
 
@@ -59,6 +61,73 @@ struct Filters {
   static common::AlwaysTrue alwaysTrue;
 };
 
+// Minimum average number of values per run for returning a SequenceVector
+// instead of a FlatVector.
+constexpr vector_size_t kMinAverageRunLength = 8;
+
+// Replaces the FlatVector<T> in '*result' with a SequenceVector over its
+// runs of equal values if the runs are at least kMinAverageRunLength long
+// on average. Nulls form runs of their own.
+template <typename T>
+void maybeRunLengthEncode(VectorPtr* result, memory::MemoryPool* pool) {
+  auto flat = (*result)->asUnchecked<FlatVector<T>>();
+  vector_size_t size = flat->size();
+  if (size < 2 * kMinAverageRunLength) {
+    return;
+  }
+  auto values = flat->rawValues();
+  auto nulls = flat->rawNulls();
+  auto sameAsPrevious = [&](vector_size_t row) {
+    if (nulls) {
+      bool isNull = bits::isBitNull(nulls, row);
+      if (isNull != bits::isBitNull(nulls, row - 1)) {
+        return false;
+      }
+      if (isNull) {
+        return true;
+      }
+    }
+    return values[row] == values[row - 1];
+  };
+  vector_size_t maxRuns = size / kMinAverageRunLength;
+  vector_size_t numRuns = 1;
+  for (vector_size_t row = 1; row < size; ++row) {
+    if (!sameAsPrevious(row) && ++numRuns > maxRuns) {
+      return;
+    }
+  }
+
+  auto runValues = AlignedBuffer::allocate<T>(numRuns, pool);
+  auto rawRunValues = runValues->asMutable<T>();
+  BufferPtr runNulls = nulls
+      ? AlignedBuffer::allocate<bool>(numRuns, pool, bits::kNotNull)
+      : nullptr;
+  auto lengths = AlignedBuffer::allocate<SequenceLength>(numRuns, pool);
+  auto rawLengths = lengths->asMutable<SequenceLength>();
+  vector_size_t run = 0;
+  vector_size_t start = 0;
+  for (vector_size_t row = 1; row <= size; ++row) {
+    if (row < size && sameAsPrevious(row)) {
+      continue;
+    }
+    rawRunValues[run] = values[start];
+    if (nulls && bits::isBitNull(nulls, start)) {
+      bits::setNull(runNulls->asMutable<uint64_t>(), run);
+    }
+    rawLengths[run++] = row - start;
+    start = row;
+  }
+  auto runVector = std::make_shared<FlatVector<T>>(
+      pool,
+      flat->type(),
+      std::move(runNulls),
+      numRuns,
+      std::move(runValues),
+      std::vector<BufferPtr>(flat->stringBuffers()));
+  *result = std::make_shared<SequenceVector<T>>(
+      pool, size, std::move(runVector), std::move(lengths));
+}
+
 inline RleVersion convertRleVersion(proto::ColumnEncoding_Kind kind) {
   switch (static_cast<int64_t>(kind)) {
     case proto::ColumnEncoding_Kind_DIRECT:
@@ -78,7 +147,9 @@ SelectiveColumnReader::SelectiveColumnReader(
     : ColumnReader(ek, stripe),
       scanSpec_(scanSpec),
       type_{type},
-      rowsPerRowGroup_{stripe.rowsPerRowGroup()} {
+      rowsPerRowGroup_{stripe.rowsPerRowGroup()},
+      returnRunLengthEncoded_{
+          stripe.getRowReaderOptions().getReturnRunLengthEncoded()} {
   // We always initialize indexStream_ because indices are needed as
   // soon as there is a single filter that can trigger row group skips
   // anywhere in the reader tree. This is not known at construct time
@@ -86,6 +157,8 @@ SelectiveColumnReader::SelectiveColumnReader(
   // time pushdown.
   indexStream_ =
       stripe.getStream(ek.forKind(proto::Stream_Kind_ROW_INDEX), false);
+  bloomFilterStream_ = stripe.getStream(
+      ek.forKind(proto::Stream_Kind_BLOOM_FILTER_UTF8), false);
 }
 
 std::vector<uint32_t> SelectiveColumnReader::filterRowGroups(
@@ -98,6 +171,13 @@ std::vector<uint32_t> SelectiveColumnReader::filterRowGroups(
   ensureRowGroupIndex();
   auto filter = scanSpec_->filter();
 
+  // A row group with nulls that pass 'filter' can not be skipped based on
+  // the bloom filter, which only has the non-null values.
+  if (bloomFilterStream_ && !filter->testNull()) {
+    bloomFilterIndex_ = ProtoUtils::readProto<proto::BloomFilterIndex>(
+        std::move(bloomFilterStream_));
+  }
+
   std::vector<uint32_t> stridesToSkip;
   for (auto i = 0; i < index_->entry_size(); i++) {
     const auto& entry = index_->entry(i);
@@ -105,6 +185,14 @@ std::vector<uint32_t> SelectiveColumnReader::filterRowGroups(
         buildColumnStatisticsFromProto(entry.statistics(), context);
     if (!testFilter(filter, columnStats.get(), rowGroupSize, type_)) {
       stridesToSkip.push_back(i); // Skipping stride based on column stats.
+    } else if (
+        bloomFilterIndex_ && !filter->testNull() &&
+        i < bloomFilterIndex_->bloomfilter_size()) {
+      auto bloomFilter =
+          bloomFilterFromProto(bloomFilterIndex_->bloomfilter(i));
+      if (bloomFilter && !testBloomFilter(*filter, *bloomFilter)) {
+        stridesToSkip.push_back(i); // Skipping stride based on bloom filter.
+      }
     }
   }
   return stridesToSkip;
@@ -245,8 +333,12 @@ void SelectiveColumnReader::getFlatValues(
   BufferPtr nulls = anyNulls_
       ? (returnReaderNulls_ ? nullsInReadRange_ : resultNulls_)
       : nullptr;
+  addReferencedStreamBuffers();
   *result = std::make_shared<FlatVector<TVector>>(
       &memoryPool, type, nulls, numValues_, values_, std::move(stringBuffers_));
+  if (returnRunLengthEncoded_) {
+    maybeRunLengthEncode<TVector>(result, &memoryPool);
+  }
 }
 
 template <>
@@ -611,6 +703,32 @@ char* SelectiveColumnReader::copyStringValue(folly::StringPiece value) {
   return rawStringBuffer_ + start;
 }
 
+void SelectiveColumnReader::setStreamBuffer(BufferPtr buffer) {
+  if (streamBufferReferenced_) {
+    referencedStreamBuffers_.push_back(std::move(streamBuffer_));
+    streamBufferReferenced_ = false;
+  }
+  streamBuffer_ = std::move(buffer);
+  if (streamBuffer_) {
+    streamBufferStart_ = streamBuffer_->as<char>();
+    streamBufferEnd_ = streamBufferStart_ + streamBuffer_->size();
+  } else {
+    streamBufferStart_ = nullptr;
+    streamBufferEnd_ = nullptr;
+  }
+}
+
+void SelectiveColumnReader::addReferencedStreamBuffers() {
+  for (auto& buffer : referencedStreamBuffers_) {
+    stringBuffers_.push_back(std::move(buffer));
+  }
+  referencedStreamBuffers_.clear();
+  if (streamBufferReferenced_) {
+    stringBuffers_.push_back(streamBuffer_);
+    streamBufferReferenced_ = false;
+  }
+}
+
 void SelectiveColumnReader::addStringValue(folly::StringPiece value) {
   auto copy = copyStringValue(value);
   reinterpret_cast<StringView*>(rawValues_)[numValues_++] =
@@ -622,6 +740,31 @@ std::vector<uint64_t> toPositions(const proto::RowIndexEntry& entry) {
       entry.positions().begin(), entry.positions().end());
 }
 
+std::vector<uint64_t> SelectiveColumnReader::rowGroupPositions(
+    uint32_t index) const {
+  ensureRowGroupIndex();
+  return toPositions(index_->entry(index));
+}
+
+std::vector<std::vector<uint64_t>> SelectiveColumnReader::removeIndexPrefix(
+    int32_t numPositions) {
+  ensureRowGroupIndex();
+  std::vector<std::vector<uint64_t>> prefixes;
+  prefixes.reserve(index_->entry_size());
+  for (auto i = 0; i < index_->entry_size(); ++i) {
+    auto positions = toPositions(index_->entry(i));
+    VELOX_CHECK_LE(numPositions, positions.size());
+    prefixes.emplace_back(
+        positions.begin(), positions.begin() + numPositions);
+    auto* mutablePositions = index_->mutable_entry(i)->mutable_positions();
+    mutablePositions->Clear();
+    for (auto j = numPositions; j < positions.size(); ++j) {
+      mutablePositions->Add(positions[j]);
+    }
+  }
+  return prefixes;
+}
+
 // structs for extractValues in ColumnVisitor.
 
 // Represents values not being retained after filter evaluation. Must
@@ -1250,6 +1393,10 @@ void SelectiveByteRleColumnReader::processValueHook(
           rows,
           ExtractToHook<SumHook<int64_t, int64_t>>(hook));
       break;
+    case AggregationHook::kCount:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue, rows, ExtractToHook<CountHook>(hook));
+      break;
     default:
       readHelper<common::AlwaysTrue, isDense>(
           &Filters::alwaysTrue, rows, ExtractToGenericHook(hook));
@@ -1442,6 +1589,10 @@ void SelectiveIntegerDirectColumnReader::processFilter(
       readHelper<common::BigintValuesUsingBitmask, isDense>(
           filter, rows, extractValues);
       break;
+    case FilterKind::kBigintValuesUsingBloomFilter:
+      readHelper<common::BigintValuesUsingBloomFilter, isDense>(
+          filter, rows, extractValues);
+      break;
     default:
       readHelper<common::Filter, isDense>(filter, rows, extractValues);
       break;
@@ -1459,6 +1610,12 @@ void SelectiveIntegerDirectColumnReader::processValueHook(
           rows,
           ExtractToHook<SumHook<int64_t, int64_t>>(hook));
       break;
+    case AggregationHook::kSumIntegerToBigint:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue,
+          rows,
+          ExtractToHook<SumHook<int32_t, int64_t>>(hook));
+      break;
     case AggregationHook::kBigintMax:
       readHelper<common::AlwaysTrue, isDense>(
           &Filters::alwaysTrue,
@@ -1471,6 +1628,10 @@ void SelectiveIntegerDirectColumnReader::processValueHook(
           rows,
           ExtractToHook<MinMaxHook<int64_t, true>>(hook));
       break;
+    case AggregationHook::kCount:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue, rows, ExtractToHook<CountHook>(hook));
+      break;
     default:
       readHelper<common::AlwaysTrue, isDense>(
           &Filters::alwaysTrue, rows, ExtractToGenericHook(hook));
@@ -1511,6 +1672,40 @@ void SelectiveIntegerDirectColumnReader::read(
 
 enum FilterResult { kUnknown = 0x40, kSuccess = 0x80, kFailure = 0 };
 
+// Evaluates 'filter' on the 'size' entries of a stripe dictionary and
+// records the results in 'filterCache', so that reading the indices only
+// gathers the results. 'valueAt(i)' returns entry i. Returns false if no
+// entry passes. Leaves 'filterCache' as is and returns true if the filter
+// does not depend on the values or is not deterministic.
+template <typename ValueAt>
+bool prefilterDictionary(
+    common::Filter* filter,
+    int32_t size,
+    ValueAt valueAt,
+    uint8_t* filterCache) {
+  if (!filter || !filter->isDeterministic()) {
+    return true;
+  }
+  switch (filter->kind()) {
+    case FilterKind::kAlwaysTrue:
+    case FilterKind::kIsNull:
+    case FilterKind::kIsNotNull:
+      return true;
+    default:
+      break;
+  }
+  bool anyPassed = false;
+  for (auto i = 0; i < size; ++i) {
+    if (common::applyFilter(*filter, valueAt(i))) {
+      filterCache[i] = FilterResult::kSuccess;
+      anyPassed = true;
+    } else {
+      filterCache[i] = FilterResult::kFailure;
+    }
+  }
+  return anyPassed;
+}
+
 template <typename T>
 inline __m256si load8Indices(const T* /*input*/) {
   VELOX_FAIL("Unsupported dictionary index type");
@@ -2006,6 +2201,7 @@ class SelectiveIntegerDictionaryColumnReader : public SelectiveColumnReader {
     if (!filterCache_.empty()) {
       simd::memset(
           filterCache_.data(), FilterResult::kUnknown, dictionarySize_);
+      VELOX_WIDTH_DISPATCH(valueSize_, prefilterDictionary);
     }
   }
 
@@ -2033,14 +2229,26 @@ class SelectiveIntegerDictionaryColumnReader : public SelectiveColumnReader {
   void read(vector_size_t offset, RowSet rows, const uint64_t* incomingNulls)
       override;
 
-  void getValues(RowSet rows, VectorPtr* result) override {
-    getIntValues(rows, requestedType_.get(), result);
-  }
+  void getValues(RowSet rows, VectorPtr* result) override;
 
  private:
   template <typename ColumnVisitor>
   void readWithVisitor(RowSet rows, ColumnVisitor visitor);
 
+  // True if the next read() can produce dictionary indices instead of
+  // values, i.e. if all the values are in the stripe dictionary and the
+  // filter does not depend on the values.
+  bool canReadIndices(common::Filter* filter) const;
+
+  // Reads the dictionary indices of 'rows' into 'values_'.
+  template <bool isDense>
+  void readIndices(common::Filter* filter, RowSet rows);
+
+  // Sets 'result' to a DictionaryVector over 'dictionaryValues_' with the
+  // indices in 'values_'.
+  template <typename T>
+  void makeDictionaryVector(VectorPtr* result);
+
   template <bool isDense, typename ExtractValues>
   void processFilter(
       common::Filter* filter,
@@ -2056,6 +2264,10 @@ class SelectiveIntegerDictionaryColumnReader : public SelectiveColumnReader {
 
   void ensureInitialized();
 
+  // Evaluates the filter on the whole dictionary.
+  template <typename T>
+  void prefilterDictionary();
+
   BufferPtr dictionary_;
   BufferPtr inDictionary_;
   std::unique_ptr<ByteRleDecoder> inDictionaryReader_;
@@ -2064,9 +2276,17 @@ class SelectiveIntegerDictionaryColumnReader : public SelectiveColumnReader {
   std::unique_ptr<IntDecoder</* isSigned = */ true>> dictReader_;
   std::function<BufferPtr()> dictInit_;
   raw_vector<uint8_t> filterCache_;
+  // False if no value of the dictionary passes the filter.
+  bool anyDictionaryValuePasses_{true};
   RleVersion rleVersion_;
   const TypePtr requestedType_;
   bool initialized_{false};
+  // See RowReaderOptions::setReturnIntegerDictionary().
+  const bool returnDictionary_;
+  // True if 'values_' holds dictionary indices since the last read().
+  bool readsIndices_{false};
+  // The dictionary as a vector of 'requestedType_'. Made on first use.
+  VectorPtr dictionaryValues_;
 };
 
 SelectiveIntegerDictionaryColumnReader::SelectiveIntegerDictionaryColumnReader(
@@ -2077,7 +2297,9 @@ SelectiveIntegerDictionaryColumnReader::SelectiveIntegerDictionaryColumnReader(
     common::ScanSpec* scanSpec,
     uint32_t numBytes)
     : SelectiveColumnReader(ek, stripe, scanSpec, dataType->type),
-      requestedType_(requestedType->type) {
+      requestedType_(requestedType->type),
+      returnDictionary_(
+          stripe.getRowReaderOptions().getReturnIntegerDictionary()) {
   auto encoding = stripe.getEncoding(ek);
   dictionarySize_ = encoding.dictionarysize();
   rleVersion_ = convertRleVersion(encoding.kind());
@@ -2206,6 +2428,10 @@ void SelectiveIntegerDictionaryColumnReader::processFilter(
       readHelper<common::BigintValuesUsingBitmask, isDense>(
           filter, rows, extractValues);
       break;
+    case FilterKind::kBigintValuesUsingBloomFilter:
+      readHelper<common::BigintValuesUsingBloomFilter, isDense>(
+          filter, rows, extractValues);
+      break;
     default:
       readHelper<common::Filter, isDense>(filter, rows, extractValues);
       break;
@@ -2223,18 +2449,77 @@ void SelectiveIntegerDictionaryColumnReader::processValueHook(
           rows,
           ExtractToHook<SumHook<int64_t, int64_t>>(hook));
       break;
+    case AggregationHook::kSumIntegerToBigint:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue,
+          rows,
+          ExtractToHook<SumHook<int32_t, int64_t>>(hook));
+      break;
+    case AggregationHook::kBigintMax:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue,
+          rows,
+          ExtractToHook<MinMaxHook<int64_t, false>>(hook));
+      break;
+    case AggregationHook::kBigintMin:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue,
+          rows,
+          ExtractToHook<MinMaxHook<int64_t, true>>(hook));
+      break;
+    case AggregationHook::kCount:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue, rows, ExtractToHook<CountHook>(hook));
+      break;
     default:
       readHelper<common::AlwaysTrue, isDense>(
           &Filters::alwaysTrue, rows, ExtractToGenericHook(hook));
   }
 }
 
+bool SelectiveIntegerDictionaryColumnReader::canReadIndices(
+    common::Filter* filter) const {
+  if (!returnDictionary_ || inDictionaryReader_ || dictionarySize_ == 0 ||
+      scanSpec_->makeFlat() || !scanSpec_->keepValues() ||
+      scanSpec_->valueHook() || requestedType_->kind() != type_->kind()) {
+    return false;
+  }
+  return !filter || filter->kind() == FilterKind::kAlwaysTrue ||
+      filter->kind() == FilterKind::kIsNotNull;
+}
+
+template <bool isDense>
+void SelectiveIntegerDictionaryColumnReader::readIndices(
+    common::Filter* filter,
+    RowSet rows) {
+  if (filter && filter->kind() == FilterKind::kIsNotNull) {
+    readWithVisitor(
+        rows,
+        ColumnVisitor<int32_t, common::IsNotNull, ExtractToReader, isDense>(
+            *reinterpret_cast<common::IsNotNull*>(filter),
+            this,
+            rows,
+            ExtractToReader(this)));
+  } else {
+    readWithVisitor(
+        rows,
+        ColumnVisitor<int32_t, common::AlwaysTrue, ExtractToReader, isDense>(
+            Filters::alwaysTrue, this, rows, ExtractToReader(this)));
+  }
+}
+
 void SelectiveIntegerDictionaryColumnReader::read(
     vector_size_t offset,
     RowSet rows,
     const uint64_t* incomingNulls) {
-  VELOX_WIDTH_DISPATCH(
-      sizeOfIntKind(type_->kind()), prepareRead, offset, rows, incomingNulls);
+  common::Filter* filter = scanSpec_->filter();
+  readsIndices_ = canReadIndices(filter);
+  if (readsIndices_) {
+    prepareRead<int32_t>(offset, rows, incomingNulls);
+  } else {
+    VELOX_WIDTH_DISPATCH(
+        sizeOfIntKind(type_->kind()), prepareRead, offset, rows, incomingNulls);
+  }
   auto end = rows.back() + 1;
   const auto* rawNulls =
       nullsInReadRange_ ? nullsInReadRange_->as<uint64_t>() : nullptr;
@@ -2257,8 +2542,23 @@ void SelectiveIntegerDictionaryColumnReader::read(
   // lazy load dictionary only when it's needed
   ensureInitialized();
 
+  if (!anyDictionaryValuePasses_ && !inDictionaryReader_ &&
+      !filter->testNull()) {
+    // All values come from the dictionary and none passes, so no row does.
+    dataReader_->skip(rawNulls ? bits::countNonNulls(rawNulls, 0, end) : end);
+    readOffset_ += end;
+    return;
+  }
+
   bool isDense = rows.back() == rows.size() - 1;
-  common::Filter* filter = scanSpec_->filter();
+  if (readsIndices_) {
+    if (isDense) {
+      readIndices<true>(filter, rows);
+    } else {
+      readIndices<false>(filter, rows);
+    }
+    return;
+  }
   if (scanSpec_->keepValues()) {
     if (scanSpec_->valueHook()) {
       if (isDense) {
@@ -2282,6 +2582,41 @@ void SelectiveIntegerDictionaryColumnReader::read(
   }
 }
 
+void SelectiveIntegerDictionaryColumnReader::getValues(
+    RowSet rows,
+    VectorPtr* result) {
+  if (!readsIndices_) {
+    getIntValues(rows, requestedType_.get(), result);
+    return;
+  }
+  compactScalarValues<int32_t, int32_t>(rows, false);
+  VELOX_WIDTH_DISPATCH(
+      sizeOfIntKind(type_->kind()), makeDictionaryVector, result);
+}
+
+template <typename T>
+void SelectiveIntegerDictionaryColumnReader::makeDictionaryVector(
+    VectorPtr* result) {
+  if (!dictionaryValues_) {
+    dictionaryValues_ = std::make_shared<FlatVector<T>>(
+        &memoryPool,
+        requestedType_,
+        nullptr,
+        dictionarySize_,
+        dictionary_,
+        std::vector<BufferPtr>{});
+  }
+  *result = std::make_shared<DictionaryVector<T>>(
+      &memoryPool,
+      !anyNulls_               ? nullptr
+          : returnReaderNulls_ ? nullsInReadRange_
+                               : resultNulls_,
+      numValues_,
+      dictionaryValues_,
+      TypeKind::INTEGER,
+      values_);
+}
+
 void SelectiveIntegerDictionaryColumnReader::ensureInitialized() {
   if (LIKELY(initialized_)) {
     return;
@@ -2294,10 +2629,21 @@ void SelectiveIntegerDictionaryColumnReader::ensureInitialized() {
   // out.
   filterCache_.resize(std::max<int32_t>(1, dictionarySize_));
   simd::memset(filterCache_.data(), FilterResult::kUnknown, dictionarySize_);
+  VELOX_WIDTH_DISPATCH(valueSize_, prefilterDictionary);
   initialized_ = true;
   initTimeClocks_ = timer.elapsedClocks();
 }
 
+template <typename T>
+void SelectiveIntegerDictionaryColumnReader::prefilterDictionary() {
+  auto* values = dictionary_->as<T>();
+  anyDictionaryValuePasses_ = dwrf::prefilterDictionary(
+      scanSpec_->filter(),
+      dictionarySize_,
+      [&](int32_t i) { return values[i]; },
+      filterCache_.data());
+}
+
 template <typename TData, typename TRequested>
 class SelectiveFloatingPointColumnReader : public SelectiveColumnReader {
  public:
@@ -2464,6 +2810,10 @@ void SelectiveFloatingPointColumnReader<TData, TRequested>::processValueHook(
           rows,
           ExtractToHook<MinMaxHook<TRequested, true>>(hook));
       break;
+    case AggregationHook::kCount:
+      readHelper<common::AlwaysTrue, isDense>(
+          &Filters::alwaysTrue, rows, ExtractToHook<CountHook>(hook));
+      break;
     default:
       readHelper<common::AlwaysTrue, isDense>(
           &Filters::alwaysTrue, rows, ExtractToGenericHook(hook));
@@ -2500,15 +2850,26 @@ void SelectiveFloatingPointColumnReader<TData, TRequested>::read(
   }
 }
 
-class SelectiveStringDirectColumnReader : public SelectiveColumnReader {
+// Reads TIMESTAMP columns. Seconds and nanos come from separate
+// streams. Both are decoded for all rows in 'rows' and combined into
+// Timestamps in 'values_' before the filter or value hook is
+// applied. Filters see the value as milliseconds since epoch, see
+// common::applyFilter().
+class SelectiveTimestampColumnReader : public SelectiveColumnReader {
  public:
-  using ValueType = StringView;
-  SelectiveStringDirectColumnReader(
+  // The readers produce int64_t, the vector is Timestamps.
+  using ValueType = int64_t;
+
+  SelectiveTimestampColumnReader(
       const EncodingKey& ek,
-      const std::shared_ptr<const TypeWithId>& type,
       StripeStreams& stripe,
       common::ScanSpec* scanSpec);
 
+  // The values are combined from two streams after decoding.
+  bool hasBulkPath() const override {
+    return false;
+  }
+
   void seekToRowGroup(uint32_t index) override {
     ensureRowGroupIndex();
 
@@ -2519,13 +2880,10 @@ class SelectiveStringDirectColumnReader : public SelectiveColumnReader {
       notNullDecoder->seekToRowGroup(positionsProvider);
     }
 
-    blobStream_->seekToRowGroup(positionsProvider);
-    lengthDecoder_->seekToRowGroup(positionsProvider);
+    seconds_->seekToRowGroup(positionsProvider);
+    nano_->seekToRowGroup(positionsProvider);
 
     VELOX_CHECK(!positionsProvider.hasNext());
-
-    bytesToSkip_ = 0;
-    bufferStart_ = bufferEnd_;
   }
 
   uint64_t skip(uint64_t numValues) override;
@@ -2534,114 +2892,344 @@ class SelectiveStringDirectColumnReader : public SelectiveColumnReader {
       override;
 
   void getValues(RowSet rows, VectorPtr* result) override {
-    rawStringBuffer_ = nullptr;
-    rawStringSize_ = 0;
-    rawStringUsed_ = 0;
-    getFlatValues<StringView, StringView>(rows, result, type_);
+    getFlatValues<Timestamp, Timestamp>(rows, result, type_);
   }
 
  private:
-  template <bool hasNulls>
-  void skipInDecode(int32_t numValues, int32_t current, const uint64_t* nulls);
-
-  folly::StringPiece readValue(int32_t length);
-
-  template <bool hasNulls, typename Visitor>
-  void decode(const uint64_t* nulls, Visitor visitor);
-
-  template <typename TVisitor>
-  void readWithVisitor(RowSet rows, TVisitor visitor);
-
-  template <typename TFilter, bool isDense, typename ExtractValues>
-  void readHelper(common::Filter* filter, RowSet rows, ExtractValues values);
-
-  template <bool isDense, typename ExtractValues>
-  void processFilter(
-      common::Filter* filter,
-      RowSet rows,
-      ExtractValues extractValues);
-
-  void extractCrossBuffers(
-      const int32_t* lengths,
-      const int32_t* starts,
-      int32_t rowIndex,
-      int32_t numValues);
-
-  inline void makeSparseStarts(
-      int32_t startRow,
-      const int32_t* rows,
-      int32_t numRows,
-      int32_t* starts);
-
-  inline void extractNSparse(const int32_t* rows, int32_t row, int numRows);
+  // Decodes the seconds and nanos of 'rows' into Timestamps in
+  // 'values_', one for each row, nulls included.
+  template <bool isDense>
+  void readHelper(RowSet rows);
 
-  void extractSparse(const int32_t* rows, int32_t numRows);
+  // Applies the filter of 'scanSpec_' to the values decoded by
+  // readHelper() and compacts the passing values, or passes all
+  // values to 'hook'.
+  void processFilter(RowSet rows);
+  void processValueHook(RowSet rows, ValueHook* hook);
 
-  template <bool scatter, bool skip>
-  bool try8Consecutive(int32_t start, const int32_t* rows, int32_t row);
+  std::unique_ptr<IntDecoder</*isSigned*/ true>> seconds_;
+  std::unique_ptr<IntDecoder</*isSigned*/ false>> nano_;
+  RleVersion rleVersion_;
 
-  std::unique_ptr<IntDecoder</*isSigned*/ false>> lengthDecoder_;
-  std::unique_ptr<SeekableInputStream> blobStream_;
-  const char* bufferStart_ = nullptr;
-  const char* bufferEnd_ = nullptr;
-  BufferPtr lengths_;
-  int32_t lengthIndex_ = 0;
-  const uint32_t* rawLengths_ = nullptr;
-  int64_t bytesToSkip_ = 0;
-  // Storage for a string straddling a buffer boundary. Needed for calling
-  // the filter.
-  std::string tempString_;
+  // Seconds of the last read() while the nanos are being decoded.
+  BufferPtr secondsValues_;
 };
 
-SelectiveStringDirectColumnReader::SelectiveStringDirectColumnReader(
+SelectiveTimestampColumnReader::SelectiveTimestampColumnReader(
     const EncodingKey& ek,
-    const std::shared_ptr<const TypeWithId>& type,
     StripeStreams& stripe,
     common::ScanSpec* scanSpec)
-    : SelectiveColumnReader(ek, stripe, scanSpec, type->type) {
-  RleVersion rleVersion = convertRleVersion(stripe.getEncoding(ek).kind());
-  auto lenId = ek.forKind(proto::Stream_Kind_LENGTH);
-  bool lenVInts = stripe.getUseVInts(lenId);
-  lengthDecoder_ = IntDecoder</*isSigned*/ false>::createRle(
-      stripe.getStream(lenId, true),
-      rleVersion,
+    : SelectiveColumnReader(ek, stripe, scanSpec, TIMESTAMP()) {
+  rleVersion_ = convertRleVersion(stripe.getEncoding(ek).kind());
+  auto data = ek.forKind(proto::Stream_Kind_DATA);
+  bool vints = stripe.getUseVInts(data);
+  seconds_ = IntDecoder</*isSigned*/ true>::createRle(
+      stripe.getStream(data, true),
+      rleVersion_,
       memoryPool,
-      lenVInts,
-      INT_BYTE_SIZE);
-  blobStream_ = stripe.getStream(ek.forKind(proto::Stream_Kind_DATA), true);
+      vints,
+      LONG_BYTE_SIZE);
+  auto nanoData = ek.forKind(proto::Stream_Kind_NANO_DATA);
+  bool nanoVInts = stripe.getUseVInts(nanoData);
+  nano_ = IntDecoder</*isSigned*/ false>::createRle(
+      stripe.getStream(nanoData, true),
+      rleVersion_,
+      memoryPool,
+      nanoVInts,
+      LONG_BYTE_SIZE);
 }
 
-uint64_t SelectiveStringDirectColumnReader::skip(uint64_t numValues) {
+uint64_t SelectiveTimestampColumnReader::skip(uint64_t numValues) {
   numValues = ColumnReader::skip(numValues);
-  ensureCapacity<int64_t>(lengths_, numValues, &memoryPool);
-  lengthDecoder_->nextLengths(lengths_->asMutable<int32_t>(), numValues);
-  rawLengths_ = lengths_->as<uint32_t>();
-  for (auto i = 0; i < numValues; ++i) {
-    bytesToSkip_ += rawLengths_[i];
-  }
-  skipBytes(bytesToSkip_, blobStream_.get(), bufferStart_, bufferEnd_);
-  bytesToSkip_ = 0;
+  seconds_->skip(numValues);
+  nano_->skip(numValues);
   return numValues;
 }
 
-void SelectiveStringDirectColumnReader::extractCrossBuffers(
-    const int32_t* lengths,
-    const int32_t* starts,
-    int32_t rowIndex,
-    int32_t numValues) {
-  int32_t current = 0;
-  bool scatter = !outerNonNullRows_.empty();
-  for (auto i = 0; i < numValues; ++i) {
-    auto gap = starts[i] - current;
-    bytesToSkip_ += gap;
-    auto size = lengths[i];
-    auto value = readValue(size);
-    current += size + gap;
-    if (!scatter) {
-      addValue(value);
-    } else {
-      auto index = outerNonNullRows_[rowIndex + i];
-      if (size <= StringView::kInlineSize) {
+template <bool isDense>
+void SelectiveTimestampColumnReader::readHelper(RowSet rows) {
+  VELOX_CHECK_EQ(rleVersion_, RleVersion_1);
+  vector_size_t numRows = rows.back() + 1;
+  const uint64_t* rawNulls =
+      nullsInReadRange_ ? nullsInReadRange_->as<uint64_t>() : nullptr;
+  ExtractToReader extractValues(this);
+  common::AlwaysTrue filter;
+
+  auto secondsReader = reinterpret_cast<RleDecoderV1<true>*>(seconds_.get());
+  ColumnVisitor<int64_t, common::AlwaysTrue, decltype(extractValues), isDense>
+      secondsVisitor(filter, this, rows, extractValues);
+  if (rawNulls) {
+    secondsReader->readWithVisitor<true>(rawNulls, secondsVisitor);
+  } else {
+    secondsReader->readWithVisitor<false>(nullptr, secondsVisitor);
+  }
+
+  // Moves the seconds aside and reads the nanos into 'values_'.
+  ensureCapacity<int64_t>(secondsValues_, rows.size(), &memoryPool);
+  memcpy(
+      secondsValues_->asMutable<int64_t>(),
+      rawValues_,
+      rows.size() * sizeof(int64_t));
+  numValues_ = 0;
+  innerNonNullRows_.clear();
+  outerNonNullRows_.clear();
+
+  auto nanoReader = reinterpret_cast<RleDecoderV1<false>*>(nano_.get());
+  ColumnVisitor<int64_t, common::AlwaysTrue, decltype(extractValues), isDense>
+      nanoVisitor(filter, this, rows, extractValues);
+  if (rawNulls) {
+    nanoReader->readWithVisitor<true>(rawNulls, nanoVisitor);
+  } else {
+    nanoReader->readWithVisitor<false>(nullptr, nanoVisitor);
+  }
+  readOffset_ += numRows;
+
+  // Timestamps are twice as wide as the nanos they overwrite. Going
+  // from the end, each Timestamp only overwrites nanos that have
+  // already been consumed.
+  auto rawSeconds = secondsValues_->as<int64_t>();
+  auto rawNanos = reinterpret_cast<const int64_t*>(rawValues_);
+  auto rawTimestamps = reinterpret_cast<Timestamp*>(rawValues_);
+  for (int32_t i = rows.size() - 1; i >= 0; --i) {
+    if (rawNulls && bits::isBitNull(rawNulls, rows[i])) {
+      rawTimestamps[i] = Timestamp();
+      continue;
+    }
+    uint64_t nanos = rawNanos[i];
+    uint64_t zeros = nanos & 0x7;
+    nanos >>= 3;
+    if (zeros != 0) {
+      for (uint64_t j = 0; j <= zeros; ++j) {
+        nanos *= 10;
+      }
+    }
+    int64_t seconds = rawSeconds[i] + EPOCH_OFFSET;
+    if (seconds < 0 && nanos != 0) {
+      seconds -= 1;
+    }
+    rawTimestamps[i] = Timestamp(seconds, nanos);
+  }
+  numValues_ = rows.size();
+  valueSize_ = sizeof(Timestamp);
+}
+
+void SelectiveTimestampColumnReader::processFilter(RowSet rows) {
+  auto filter = scanSpec_->filter();
+  const uint64_t* rawNulls =
+      nullsInReadRange_ ? nullsInReadRange_->as<uint64_t>() : nullptr;
+  if (!filter && !rawNulls) {
+    return;
+  }
+  // The decoders leave null flags in 'resultNulls_' only for some
+  // paths. The flags are set here for the values that are kept.
+  bool keepValues = scanSpec_->keepValues();
+  auto rawTimestamps = reinterpret_cast<Timestamp*>(rawValues_);
+  vector_size_t numValues = 0;
+  anyNulls_ = false;
+  for (auto i = 0; i < rows.size(); ++i) {
+    bool isNull = rawNulls && bits::isBitNull(rawNulls, rows[i]);
+    if (filter) {
+      if (isNull ? !filter->testNull()
+                 : !common::applyFilter(*filter, rawTimestamps[i])) {
+        continue;
+      }
+      addOutputRow(rows[i]);
+    }
+    if (keepValues) {
+      rawTimestamps[numValues] = rawTimestamps[i];
+      if (rawNulls) {
+        bits::setNull(rawResultNulls_, numValues, isNull);
+        anyNulls_ |= isNull;
+      }
+      ++numValues;
+    }
+  }
+  numValues_ = numValues;
+}
+
+void SelectiveTimestampColumnReader::processValueHook(
+    RowSet rows,
+    ValueHook* hook) {
+  const uint64_t* rawNulls =
+      nullsInReadRange_ ? nullsInReadRange_->as<uint64_t>() : nullptr;
+  auto rawTimestamps = reinterpret_cast<const Timestamp*>(rawValues_);
+  bool acceptsNulls = hook->acceptsNulls();
+  for (auto i = 0; i < rows.size(); ++i) {
+    if (rawNulls && bits::isBitNull(rawNulls, rows[i])) {
+      if (acceptsNulls) {
+        hook->addNull(i);
+      }
+    } else {
+      hook->addValue(i, &rawTimestamps[i]);
+    }
+  }
+}
+
+void SelectiveTimestampColumnReader::read(
+    vector_size_t offset,
+    RowSet rows,
+    const uint64_t* incomingNulls) {
+  prepareRead<int64_t>(offset, rows, incomingNulls);
+  ensureValuesCapacity<Timestamp>(rows.size());
+  if (!scanSpec_->keepValues() || scanSpec_->valueHook()) {
+    // The decoders add nulls to 'resultNulls_' when there are nulls.
+    prepareNulls(rows, nullsInReadRange_ != nullptr);
+  }
+  bool isDense = rows.back() == rows.size() - 1;
+  if (isDense) {
+    readHelper<true>(rows);
+  } else {
+    readHelper<false>(rows);
+  }
+  if (scanSpec_->keepValues() && scanSpec_->valueHook()) {
+    processValueHook(rows, scanSpec_->valueHook());
+    return;
+  }
+  processFilter(rows);
+}
+
+class SelectiveStringDirectColumnReader : public SelectiveColumnReader {
+ public:
+  using ValueType = StringView;
+  SelectiveStringDirectColumnReader(
+      const EncodingKey& ek,
+      const std::shared_ptr<const TypeWithId>& type,
+      StripeStreams& stripe,
+      common::ScanSpec* scanSpec);
+
+  void seekToRowGroup(uint32_t index) override {
+    ensureRowGroupIndex();
+
+    auto positions = toPositions(index_->entry(index));
+    PositionProvider positionsProvider(positions);
+
+    if (notNullDecoder) {
+      notNullDecoder->seekToRowGroup(positionsProvider);
+    }
+
+    blobStream_->seekToRowGroup(positionsProvider);
+    lengthDecoder_->seekToRowGroup(positionsProvider);
+
+    VELOX_CHECK(!positionsProvider.hasNext());
+
+    bytesToSkip_ = 0;
+    bufferStart_ = bufferEnd_;
+  }
+
+  uint64_t skip(uint64_t numValues) override;
+
+  void read(vector_size_t offset, RowSet rows, const uint64_t* incomingNulls)
+      override;
+
+  void getValues(RowSet rows, VectorPtr* result) override {
+    rawStringBuffer_ = nullptr;
+    rawStringSize_ = 0;
+    rawStringUsed_ = 0;
+    getFlatValues<StringView, StringView>(rows, result, type_);
+  }
+
+ private:
+  template <bool hasNulls>
+  void skipInDecode(int32_t numValues, int32_t current, const uint64_t* nulls);
+
+  folly::StringPiece readValue(int32_t length);
+
+  template <bool hasNulls, typename Visitor>
+  void decode(const uint64_t* nulls, Visitor visitor);
+
+  template <typename TVisitor>
+  void readWithVisitor(RowSet rows, TVisitor visitor);
+
+  template <typename TFilter, bool isDense, typename ExtractValues>
+  void readHelper(common::Filter* filter, RowSet rows, ExtractValues values);
+
+  template <bool isDense, typename ExtractValues>
+  void processFilter(
+      common::Filter* filter,
+      RowSet rows,
+      ExtractValues extractValues);
+
+  void extractCrossBuffers(
+      const int32_t* lengths,
+      const int32_t* starts,
+      int32_t rowIndex,
+      int32_t numValues);
+
+  inline void makeSparseStarts(
+      int32_t startRow,
+      const int32_t* rows,
+      int32_t numRows,
+      int32_t* starts);
+
+  inline void extractNSparse(const int32_t* rows, int32_t row, int numRows);
+
+  void extractSparse(const int32_t* rows, int32_t numRows);
+
+  template <bool scatter, bool skip>
+  bool try8Consecutive(int32_t start, const int32_t* rows, int32_t row);
+
+  std::unique_ptr<IntDecoder</*isSigned*/ false>> lengthDecoder_;
+  std::unique_ptr<SeekableInputStream> blobStream_;
+  const char* bufferStart_ = nullptr;
+  const char* bufferEnd_ = nullptr;
+  BufferPtr lengths_;
+  int32_t lengthIndex_ = 0;
+  const uint32_t* rawLengths_ = nullptr;
+  int64_t bytesToSkip_ = 0;
+  // Storage for a string straddling a buffer boundary. Needed for calling
+  // the filter.
+  std::string tempString_;
+};
+
+SelectiveStringDirectColumnReader::SelectiveStringDirectColumnReader(
+    const EncodingKey& ek,
+    const std::shared_ptr<const TypeWithId>& type,
+    StripeStreams& stripe,
+    common::ScanSpec* scanSpec)
+    : SelectiveColumnReader(ek, stripe, scanSpec, type->type) {
+  RleVersion rleVersion = convertRleVersion(stripe.getEncoding(ek).kind());
+  auto lenId = ek.forKind(proto::Stream_Kind_LENGTH);
+  bool lenVInts = stripe.getUseVInts(lenId);
+  lengthDecoder_ = IntDecoder</*isSigned*/ false>::createRle(
+      stripe.getStream(lenId, true),
+      rleVersion,
+      memoryPool,
+      lenVInts,
+      INT_BYTE_SIZE);
+  blobStream_ = stripe.getStream(ek.forKind(proto::Stream_Kind_DATA), true);
+}
+
+uint64_t SelectiveStringDirectColumnReader::skip(uint64_t numValues) {
+  numValues = ColumnReader::skip(numValues);
+  ensureCapacity<int64_t>(lengths_, numValues, &memoryPool);
+  lengthDecoder_->nextLengths(lengths_->asMutable<int32_t>(), numValues);
+  rawLengths_ = lengths_->as<uint32_t>();
+  for (auto i = 0; i < numValues; ++i) {
+    bytesToSkip_ += rawLengths_[i];
+  }
+  skipBytes(bytesToSkip_, blobStream_.get(), bufferStart_, bufferEnd_);
+  bytesToSkip_ = 0;
+  return numValues;
+}
+
+void SelectiveStringDirectColumnReader::extractCrossBuffers(
+    const int32_t* lengths,
+    const int32_t* starts,
+    int32_t rowIndex,
+    int32_t numValues) {
+  int32_t current = 0;
+  bool scatter = !outerNonNullRows_.empty();
+  for (auto i = 0; i < numValues; ++i) {
+    auto gap = starts[i] - current;
+    bytesToSkip_ += gap;
+    auto size = lengths[i];
+    auto value = readValue(size);
+    current += size + gap;
+    if (!scatter) {
+      addValue(value);
+    } else {
+      auto index = outerNonNullRows_[rowIndex + i];
+      if (size <= StringView::kInlineSize || referenceStreamBuffer(value)) {
         reinterpret_cast<StringView*>(rawValues_)[index] =
             StringView(value.data(), size);
       } else {
@@ -2714,6 +3302,7 @@ inline bool SelectiveStringDirectColumnReader::try8Consecutive(
   int32_t* result = reinterpret_cast<int32_t*>(rawValues_);
   int32_t resultIndex = numValues_ * 4 - 4;
   auto rawUsed = rawStringUsed_;
+  bool referencesStreamBuffer = false;
   auto previousRow = sparse ? lengthIndex_ : 0;
   auto endRow = row + 8;
   for (auto i = row; i < endRow; ++i) {
@@ -2743,6 +3332,13 @@ inline bool SelectiveStringDirectColumnReader::try8Consecutive(
           reinterpret_cast<char*>(result + resultIndex + 1) + length) = 0;
       continue;
     }
+    if (data >= streamBufferStart_ && data + length <= streamBufferEnd_) {
+      // The bytes stay live in the buffer of the stream.
+      *reinterpret_cast<const char**>(result + resultIndex + 2) = data;
+      referencesStreamBuffer = true;
+      data += length;
+      continue;
+    }
     if (!rawStringBuffer_ || rawUsed + length > rawStringSize_) {
       // Slow path if no space in raw strings
       return false;
@@ -2762,6 +3358,7 @@ inline bool SelectiveStringDirectColumnReader::try8Consecutive(
   bufferStart_ = data;
   bytesToSkip_ = 0;
   rawStringUsed_ = rawUsed;
+  streamBufferReferenced_ |= referencesStreamBuffer;
   numValues_ = scatter ? outerNonNullRows_[row + 7] + 1 : numValues_ + 8;
   lengthIndex_ = sparse ? rows[row + 7] + 1 : lengthIndex_ + 8;
   return true;
@@ -2825,6 +3422,9 @@ folly::StringPiece SelectiveStringDirectColumnReader::readValue(
   tempString_.resize(length);
   readBytes(
       length, blobStream_.get(), tempString_.data(), bufferStart_, bufferEnd_);
+  // The rest of the bytes returned by the stream may be referenced instead
+  // of copied if the stream keeps them live.
+  setStreamBuffer(blobStream_->currentBuffer());
   return folly::StringPiece(tempString_);
 }
 
@@ -3027,6 +3627,7 @@ class SelectiveStringDictionaryColumnReader : public SelectiveColumnReader {
     if (!filterCache_.empty()) {
       simd::memset(
           filterCache_.data(), FilterResult::kUnknown, dictionaryCount_);
+      prefilterDictionary();
     }
   }
 
@@ -3087,6 +3688,9 @@ class SelectiveStringDictionaryColumnReader : public SelectiveColumnReader {
 
   void ensureInitialized();
 
+  // Evaluates the filter on the whole stripe dictionary.
+  void prefilterDictionary();
+
   BufferPtr dictionaryBlob_;
   BufferPtr dictionaryOffset_;
   BufferPtr inDict_;
@@ -3111,6 +3715,8 @@ class SelectiveStringDictionaryColumnReader : public SelectiveColumnReader {
   std::unique_ptr<IntDecoder</*isSigned*/ false>> lengthDecoder_;
   std::unique_ptr<SeekableInputStream> blobStream_;
   raw_vector<uint8_t> filterCache_;
+  // False if no value of the stripe dictionary passes the filter.
+  bool anyDictionaryValuePasses_{true};
   bool initialized_{false};
 };
 
@@ -3211,6 +3817,7 @@ void SelectiveStringDictionaryColumnReader::loadStrideDictionary() {
 
   // get stride dictionary size and load it if needed
   auto& positions = index_->entry(nextStride).positions();
+  auto previousStrideDictCount = strideDictCount_;
   strideDictCount_ = positions.Get(strideDictSizeOffset_);
   if (strideDictCount_ > 0) {
     // seek stride dictionary related streams
@@ -3233,12 +3840,19 @@ void SelectiveStringDictionaryColumnReader::loadStrideDictionary() {
 
   lastStrideIndex_ = nextStride;
 
+  // Strides without a stride dictionary keep the stripe dictionary vector, so
+  // that expressions memoized on the identity of the dictionary base stay
+  // valid for the whole stripe. The filter results for the stripe dictionary
+  // stay valid across strides.
+  if (strideDictCount_ == 0 && previousStrideDictCount == 0) {
+    return;
+  }
   dictionaryValues_.reset();
   filterCache_.resize(dictionaryCount_ + strideDictCount_);
   simd::memset(
-      filterCache_.data(),
+      filterCache_.data() + dictionaryCount_,
       FilterResult::kUnknown,
-      dictionaryCount_ + strideDictCount_);
+      strideDictCount_);
 }
 
 void SelectiveStringDictionaryColumnReader::makeDictionaryBaseVector() {
@@ -3289,6 +3903,17 @@ void SelectiveStringDictionaryColumnReader::makeDictionaryBaseVector() {
         values,
         std::vector<BufferPtr>{dictionaryBlob_});
   }
+
+  // The dictionary is reused for every batch of the stripe, so check its
+  // blobs once. DictionaryVectors over an all-ASCII base inherit the flag.
+  bool isAscii = functions::stringCore::isAscii(
+      dictionaryBlob_Ptr, dictionaryOffset_sPtr[dictionaryCount_]);
+  if (isAscii && strideDictCount_) {
+    isAscii = functions::stringCore::isAscii(
+        strideDict_->as<char>(),
+        strideDictOffset_->as<int64_t>()[strideDictCount_]);
+  }
+  dictionaryValues_->setAllIsAscii(isAscii);
 }
 
 template <typename TFilter, typename ExtractValues, bool isDense>
@@ -3685,6 +4310,16 @@ void SelectiveStringDictionaryColumnReader::read(
   // lazy loading dictionary data when first hit
   ensureInitialized();
 
+  if (!anyDictionaryValuePasses_ && !inDictionaryReader_ &&
+      !scanSpec_->filter()->testNull()) {
+    // All values come from the stripe dictionary and none passes, so no row
+    // does.
+    dictIndex_->skip(
+        nullsPtr ? bits::countNonNulls(nullsPtr, 0, numRows) : numRows);
+    readOffset_ += numRows;
+    return;
+  }
+
   if (inDictionaryReader_) {
     auto end = rows.back() + 1;
     bool isBulk = useBulkPath();
@@ -3793,6 +4428,7 @@ void SelectiveStringDictionaryColumnReader::ensureInitialized() {
   dictionaryValues_.reset();
   filterCache_.resize(dictionaryCount_);
   simd::memset(filterCache_.data(), FilterResult::kUnknown, dictionaryCount_);
+  prefilterDictionary();
 
   // handle in dictionary stream
   if (inDictionaryReader_) {
@@ -3808,6 +4444,18 @@ void SelectiveStringDictionaryColumnReader::ensureInitialized() {
   initTimeClocks_ = timer.elapsedClocks();
 }
 
+void SelectiveStringDictionaryColumnReader::prefilterDictionary() {
+  auto* blob = dictionaryBlob_->as<char>();
+  auto* offsets = dictionaryOffset_->as<int64_t>();
+  anyDictionaryValuePasses_ = dwrf::prefilterDictionary(
+      scanSpec_->filter(),
+      dictionaryCount_,
+      [&](int32_t i) {
+        return StringView(blob + offsets[i], offsets[i + 1] - offsets[i]);
+      },
+      filterCache_.data());
+}
+
 class SelectiveStructColumnReader : public SelectiveColumnReader {
  public:
   SelectiveStructColumnReader(
@@ -4116,12 +4764,12 @@ void SelectiveStructColumnReader::read(
     auto fieldIndex = childSpec->subscript();
     auto reader = children_.at(fieldIndex).get();
     if (reader->isTopLevel() && childSpec->projectOut() &&
-        !childSpec->filter() && !childSpec->extractValues()) {
+        !childSpec->hasFilter() && !childSpec->extractValues()) {
       // Will make a LazyVector.
       continue;
     }
     advanceFieldReader(reader, offset);
-    if (childSpec->filter()) {
+    if (childSpec->hasFilter()) {
       hasFilter = true;
       {
         SelectivityTimer timer(childSpec->selectivity(), activeRows.size());
@@ -4182,7 +4830,7 @@ void SelectiveStructColumnReader::getValues(RowSet rows, VectorPtr* result) {
       resultRow->childAt(channel) = BaseVector::wrapInConstant(
           rows.size(), 0, childSpec->constantValue());
     } else {
-      if (!childSpec->extractValues() && !childSpec->filter() &&
+      if (!childSpec->extractValues() && !childSpec->hasFilter() &&
           children_[index]->isTopLevel()) {
         // LazyVector result.
         if (!lazyPrepared) {
@@ -4328,6 +4976,13 @@ class SelectiveRepeatedColumnReader : public SelectiveColumnReader {
     sizes_->setSize(numValues_ * sizeof(vector_size_t));
   }
 
+  // Returns null constant elements, keys or values of 'type' for a reader
+  // that reads only the lengths.
+  VectorPtr makeNullChildren(const TypePtr& type) {
+    return BaseVector::createNullConstant(
+        type, nestedRows_.size(), &memoryPool);
+  }
+
   // Creates a struct if '*result' is empty and 'type' is a row.
   void prepareStructResult(const TypePtr& type, VectorPtr* result) {
     if (!*result && type->kind() == TypeKind::ROW) {
@@ -4358,7 +5013,9 @@ class SelectiveListColumnReader : public SelectiveRepeatedColumnReader {
       common::ScanSpec* scanSpec);
 
   void resetFilterCaches() override {
-    child_->resetFilterCaches();
+    if (child_) {
+      child_->resetFilterCaches();
+    }
   }
 
   void seekToRowGroup(uint32_t index) override {
@@ -4375,8 +5032,10 @@ class SelectiveListColumnReader : public SelectiveRepeatedColumnReader {
 
     VELOX_CHECK(!positionsProvider.hasNext());
 
-    child_->seekToRowGroup(index);
-    child_->setReadOffsetRecursive(0);
+    if (child_) {
+      child_->seekToRowGroup(index);
+      child_->setReadOffsetRecursive(0);
+    }
     childTargetReadOffset_ = 0;
   }
 
@@ -4401,6 +5060,9 @@ SelectiveListColumnReader::SelectiveListColumnReader(
     : SelectiveRepeatedColumnReader(ek, stripe, scanSpec, dataType->type),
       requestedType_(requestedType->type) {
   DWIO_ENSURE_EQ(ek.node, dataType->id, "working on the same node");
+  if (scanSpec_->readsLengthsOnly()) {
+    return;
+  }
   // count the number of selected sub-columns
   const auto& cs = stripe.getColumnSelector();
   auto& childType = requestedType->childAt(0);
@@ -4450,7 +5112,9 @@ void SelectiveListColumnReader::read(
     RowSet rows,
     const uint64_t* incomingNulls) {
   // Catch up if the child is behind the length stream.
-  child_->seekTo(childTargetReadOffset_, false);
+  if (child_) {
+    child_->seekTo(childTargetReadOffset_, false);
+  }
   prepareRead<char>(offset, rows, incomingNulls);
   makeNestedRowSet(rows);
   if (child_ && !nestedRows_.empty()) {
@@ -4463,7 +5127,9 @@ void SelectiveListColumnReader::read(
 void SelectiveListColumnReader::getValues(RowSet rows, VectorPtr* result) {
   compactOffsets(rows);
   VectorPtr elements;
-  if (child_ && !nestedRows_.empty()) {
+  if (!child_) {
+    elements = makeNullChildren(requestedType_->childAt(0));
+  } else if (!nestedRows_.empty()) {
     prepareStructResult(type_->childAt(0), &elements);
     child_->getValues(nestedRows_, &elements);
   }
@@ -4487,8 +5153,10 @@ class SelectiveMapColumnReader : public SelectiveRepeatedColumnReader {
       common::ScanSpec* scanSpec);
 
   void resetFilterCaches() override {
-    keyReader_->resetFilterCaches();
-    elementReader_->resetFilterCaches();
+    if (keyReader_) {
+      keyReader_->resetFilterCaches();
+      elementReader_->resetFilterCaches();
+    }
   }
 
   void seekToRowGroup(uint32_t index) override {
@@ -4505,10 +5173,12 @@ class SelectiveMapColumnReader : public SelectiveRepeatedColumnReader {
 
     VELOX_CHECK(!positionsProvider.hasNext());
 
-    keyReader_->seekToRowGroup(index);
-    keyReader_->setReadOffsetRecursive(0);
-    elementReader_->seekToRowGroup(index);
-    elementReader_->setReadOffsetRecursive(0);
+    if (keyReader_) {
+      keyReader_->seekToRowGroup(index);
+      keyReader_->setReadOffsetRecursive(0);
+      elementReader_->seekToRowGroup(index);
+      elementReader_->setReadOffsetRecursive(0);
+    }
     childTargetReadOffset_ = 0;
   }
 
@@ -4534,6 +5204,9 @@ SelectiveMapColumnReader::SelectiveMapColumnReader(
     : SelectiveRepeatedColumnReader(ek, stripe, scanSpec, dataType->type),
       requestedType_(requestedType->type) {
   DWIO_ENSURE_EQ(ek.node, dataType->id, "working on the same node");
+  if (scanSpec_->readsLengthsOnly()) {
+    return;
+  }
   if (scanSpec_->children().empty()) {
     scanSpec->getOrCreateChild(common::Subfield("keys"));
     scanSpec->getOrCreateChild(common::Subfield("elements"));
@@ -4627,11 +5300,14 @@ void SelectiveMapColumnReader::getValues(RowSet rows, VectorPtr* result) {
   compactOffsets(rows);
   VectorPtr keys;
   VectorPtr values;
-  VELOX_CHECK(
-      keyReader_ && elementReader_,
-      "keyReader_ and elementReaer_ must exist in "
-      "SelectiveMapColumnReader::getValues");
-  if (!nestedRows_.empty()) {
+  if (scanSpec_->readsLengthsOnly()) {
+    keys = makeNullChildren(requestedType_->childAt(0));
+    values = makeNullChildren(requestedType_->childAt(1));
+  } else if (!nestedRows_.empty()) {
+    VELOX_CHECK(
+        keyReader_ && elementReader_,
+        "keyReader_ and elementReaer_ must exist in "
+        "SelectiveMapColumnReader::getValues");
     keyReader_->getValues(nestedRows_, &keys);
     prepareStructResult(type_->childAt(1), &values);
     elementReader_->getValues(nestedRows_, &values);
@@ -4647,6 +5323,612 @@ void SelectiveMapColumnReader::getValues(RowSet rows, VectorPtr* result) {
       values);
 }
 
+// Integer keys of flat maps are matched as int64_t, string keys as
+// std::string.
+template <typename T>
+using FlatMapKey =
+    std::conditional_t<std::is_same_v<T, StringView>, std::string, int64_t>;
+
+inline void readFlatMapKey(const proto::KeyInfo& info, int64_t& key) {
+  key = info.intkey();
+}
+
+inline void readFlatMapKey(const proto::KeyInfo& info, std::string& key) {
+  key = info.byteskey();
+}
+
+inline bool matchesFlatMapKey(const common::ScanSpec& spec, int64_t key) {
+  return spec.fieldName().empty() && spec.subscript() == key;
+}
+
+inline bool matchesFlatMapKey(
+    const common::ScanSpec& spec,
+    const std::string& key) {
+  return spec.fieldName() == key;
+}
+
+// True if 'spec' is a child of a map spec that refers to a single
+// key, i.e. was made from a subscript and not from 'keys' or
+// 'elements'.
+inline bool isFlatMapKeySpec(const common::ScanSpec& spec) {
+  return spec.fieldName() != "keys" && spec.fieldName() != "elements";
+}
+
+// True if a null value, i.e. a null map or a map without the key,
+// passes the filters of 'spec'.
+inline bool nullPassesFlatMapKey(const common::ScanSpec& spec) {
+  return spec.filter() && spec.filter()->testNull();
+}
+
+// Reader for maps with MAP_FLAT encoding. Each key has an in-map
+// stream and its own value streams. Only the keys that have a
+// subscript child in the ScanSpec, e.g. m[1] or m["a"], are read. If
+// none of these keeps values, all keys are read and the values of
+// keys without a subscript child are read with the 'elements'
+// spec. A filter on a subscript child applies to the value of the
+// key. The value is null for null maps and maps without the key. The
+// result is a MapVector or, if the column is to be read as struct, a
+// RowVector with a field for each projected key.
+template <typename T>
+class SelectiveFlatMapColumnReader : public SelectiveColumnReader {
+ public:
+  using KeyType = FlatMapKey<T>;
+
+  SelectiveFlatMapColumnReader(
+      const EncodingKey& ek,
+      const std::shared_ptr<const TypeWithId>& requestedType,
+      const std::shared_ptr<const TypeWithId>& dataType,
+      StripeStreams& stripe,
+      common::ScanSpec* scanSpec);
+
+  bool useBulkPath() const override {
+    return false;
+  }
+
+  void resetFilterCaches() override {
+    for (auto& node : keyNodes_) {
+      node->reader->resetFilterCaches();
+    }
+  }
+
+  void seekToRowGroup(uint32_t index) override;
+
+  uint64_t skip(uint64_t numValues) override;
+
+  void read(vector_size_t offset, RowSet rows, const uint64_t* incomingNulls)
+      override;
+
+  void getValues(RowSet rows, VectorPtr* result) override;
+
+ private:
+  struct KeyNode {
+    KeyType key;
+    // Value of 'key' in the keys of a MapVector result.
+    T keyValue;
+    uint32_t sequence;
+    common::ScanSpec* spec;
+    std::unique_ptr<SelectiveColumnReader> reader;
+    std::unique_ptr<ByteRleDecoder> inMap;
+    // Positions of 'inMap' for each row group. These are removed from
+    // the row group index of 'reader' on first seek.
+    std::vector<std::vector<uint64_t>> inMapPositions;
+    // The position in 'reader' that corresponds to the position in
+    // 'inMap'. 'reader' can be behind if the last rows read did not
+    // have the key.
+    vector_size_t childTargetReadOffset{0};
+    // In-map flags for the non-null maps in the last read range.
+    raw_vector<uint64_t> inMapBits;
+    // For each row of the last read range, the row in 'reader' or -1
+    // if the map is null or does not have the key.
+    raw_vector<vector_size_t> valueIndex;
+    // Rows of 'reader' in the last read().
+    raw_vector<vector_size_t> readRows;
+    // Rows of 'reader' in the last getValues().
+    raw_vector<vector_size_t> valueRows;
+    VectorPtr values;
+  };
+
+  // Reads the in-map flags of 'node' for 'numRows' rows, of which
+  // 'numMaps' are not null.
+  void readInMap(
+      KeyNode& node,
+      vector_size_t numRows,
+      vector_size_t numMaps,
+      const uint64_t* nulls);
+
+  // Reads the values of 'node' for the rows in 'rows' that have the key.
+  void readKey(KeyNode& node, RowSet rows);
+
+  // Returns the subset of 'rows' that pass the filters on the value of
+  // 'node'. Must be called after readKey() with the same rows.
+  RowSet filterRows(KeyNode& node, RowSet rows);
+
+  // Returns a buffer for rows that is not referenced by 'rows'.
+  raw_vector<vector_size_t>& otherRowsBuffer(RowSet rows) {
+    return rows.data() == activeRows_[0].data() ? activeRows_[1]
+                                                : activeRows_[0];
+  }
+
+  void loadValues(KeyNode& node, RowSet rows);
+
+  VectorPtr makeMap(RowSet rows, BufferPtr nulls);
+
+  VectorPtr makeStruct(RowSet rows, BufferPtr nulls);
+
+  const TypePtr requestedType_;
+  const TypePtr valueType_;
+  // True if the result is a RowVector with a field per projected key.
+  bool asStruct_;
+  std::vector<std::unique_ptr<KeyNode>> keyNodes_;
+  // Nodes whose values are returned, in the order of the result. In
+  // struct mode, a projected key that is not in the stripe is nullptr.
+  std::vector<KeyNode*> outputNodes_;
+  // Nodes with filters, applied in order before reading other nodes.
+  std::vector<KeyNode*> filteredNodes_;
+  std::vector<KeyNode*> unfilteredNodes_;
+  // Specs of filtered keys that are not in the stripe.
+  std::vector<common::ScanSpec*> missingKeyFilters_;
+  // Holds the bytes of string keys for MapVector results.
+  BufferPtr keyBuffer_;
+  raw_vector<vector_size_t> activeRows_[2];
+  raw_vector<vector_size_t> mapFill_;
+  raw_vector<vector_size_t> sourceRows_;
+};
+
+template <typename T>
+SelectiveFlatMapColumnReader<T>::SelectiveFlatMapColumnReader(
+    const EncodingKey& ek,
+    const std::shared_ptr<const TypeWithId>& requestedType,
+    const std::shared_ptr<const TypeWithId>& dataType,
+    StripeStreams& stripe,
+    common::ScanSpec* scanSpec)
+    : SelectiveColumnReader(ek, stripe, scanSpec, dataType->type),
+      requestedType_(requestedType->type),
+      valueType_(requestedType->type->childAt(1)),
+      asStruct_(
+          stripe.getRowReaderOptions().getMapColumnIdAsStruct().count(
+              requestedType->id) > 0) {
+  DWIO_ENSURE_EQ(ek.node, dataType->id, "working on the same node");
+  std::vector<common::ScanSpec*> keySpecs;
+  bool projectKeys = false;
+  for (auto& child : scanSpec_->children()) {
+    if (isFlatMapKeySpec(*child)) {
+      keySpecs.push_back(child.get());
+      projectKeys |= child->keepValues();
+    }
+  }
+  VELOX_CHECK(
+      projectKeys || !asStruct_,
+      "Reading a flat map as struct requires projected keys");
+  common::ScanSpec* elementsSpec = nullptr;
+  if (!projectKeys) {
+    elementsSpec = scanSpec_->getOrCreateChild(common::Subfield("elements"));
+    elementsSpec->setProjectOut(true);
+    elementsSpec->setExtractValues(true);
+    VELOX_CHECK(
+        !elementsSpec->hasFilter(),
+        "Flat map values can only be filtered by key");
+    // All keys are returned, including the ones that have a filter.
+    for (auto spec : keySpecs) {
+      spec->setExtractValues(true);
+    }
+  }
+
+  const auto& cs = stripe.getColumnSelector();
+  auto& requestedValueType = requestedType->childAt(1);
+  auto& dataValueType = dataType->childAt(1);
+  VELOX_CHECK(
+      cs.shouldReadNode(requestedValueType->id),
+      "Map values must be selected in SelectiveFlatMapColumnReader");
+  std::unordered_set<uint32_t> processed;
+  stripe.visitStreamsOfNode(
+      dataValueType->id, [&](const StreamInformation& stream) {
+        auto sequence = stream.getSequence();
+        // Sequence 0 is the shared dictionary.
+        if (sequence == 0 || !processed.insert(sequence).second) {
+          return;
+        }
+        EncodingKey seqEk(dataValueType->id, sequence);
+        KeyType key;
+        readFlatMapKey(stripe.getEncoding(seqEk).key(), key);
+        common::ScanSpec* spec = nullptr;
+        for (auto keySpec : keySpecs) {
+          if (matchesFlatMapKey(*keySpec, key)) {
+            spec = keySpec;
+            break;
+          }
+        }
+        if (!spec) {
+          if (projectKeys) {
+            return;
+          }
+          spec = elementsSpec;
+        } else if (!spec->keepValues() && !spec->hasFilter()) {
+          return;
+        }
+        auto node = std::make_unique<KeyNode>();
+        node->key = key;
+        node->sequence = sequence;
+        node->spec = spec;
+        node->reader = SelectiveColumnReader::build(
+            requestedValueType, dataValueType, stripe, spec, sequence);
+        auto inMap =
+            stripe.getStream(seqEk.forKind(proto::Stream_Kind_IN_MAP), true);
+        DWIO_ENSURE_NOT_NULL(inMap, "In map stream is required");
+        node->inMap = createBooleanRleDecoder(std::move(inMap), seqEk);
+        keyNodes_.push_back(std::move(node));
+      });
+  // Sort by sequence so that the order of keys is fixed.
+  std::sort(keyNodes_.begin(), keyNodes_.end(), [](auto& a, auto& b) {
+    return a->sequence < b->sequence;
+  });
+
+  if constexpr (std::is_same_v<T, StringView>) {
+    size_t size = 0;
+    for (auto& node : keyNodes_) {
+      size += node->key.size();
+    }
+    keyBuffer_ = AlignedBuffer::allocate<char>(size, &memoryPool);
+    auto data = keyBuffer_->asMutable<char>();
+    for (auto& node : keyNodes_) {
+      memcpy(data, node->key.data(), node->key.size());
+      node->keyValue = StringView(data, node->key.size());
+      data += node->key.size();
+    }
+  } else {
+    for (auto& node : keyNodes_) {
+      node->keyValue = static_cast<T>(node->key);
+    }
+  }
+
+  auto findNode = [&](common::ScanSpec* spec) -> KeyNode* {
+    for (auto& node : keyNodes_) {
+      if (node->spec == spec) {
+        return node.get();
+      }
+    }
+    return nullptr;
+  };
+  for (auto spec : keySpecs) {
+    auto node = findNode(spec);
+    if (projectKeys && spec->keepValues() && (node || asStruct_)) {
+      outputNodes_.push_back(node);
+    }
+    if (!node && spec->hasFilter()) {
+      missingKeyFilters_.push_back(spec);
+    }
+  }
+  for (auto& node : keyNodes_) {
+    if (!projectKeys) {
+      outputNodes_.push_back(node.get());
+    }
+    if (node->spec != elementsSpec && node->spec->hasFilter()) {
+      filteredNodes_.push_back(node.get());
+    } else {
+      unfilteredNodes_.push_back(node.get());
+    }
+  }
+  VLOG(1) << "[Flat-Map] Initialized a selective flat-map reader for node "
+          << dataType->id << ", keys=" << keyNodes_.size();
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::seekToRowGroup(uint32_t index) {
+  if (notNullDecoder) {
+    auto positions = rowGroupPositions(index);
+    PositionProvider positionsProvider(positions);
+    notNullDecoder->seekToRowGroup(positionsProvider);
+  }
+  for (auto& node : keyNodes_) {
+    if (node->inMapPositions.empty()) {
+      // The in-map positions are first in the index of the value
+      // reader. Seeking the in-map stream tells how many there are.
+      auto positions = node->reader->rowGroupPositions(0);
+      PositionProvider positionsProvider(positions);
+      node->inMap->seekToRowGroup(positionsProvider);
+      int32_t numValuePositions = 0;
+      while (positionsProvider.hasNext()) {
+        positionsProvider.next();
+        ++numValuePositions;
+      }
+      node->inMapPositions = node->reader->removeIndexPrefix(
+          positions.size() - numValuePositions);
+    }
+    PositionProvider positionsProvider(node->inMapPositions[index]);
+    node->inMap->seekToRowGroup(positionsProvider);
+    node->reader->seekToRowGroup(index);
+    node->reader->setReadOffsetRecursive(0);
+    node->childTargetReadOffset = 0;
+  }
+}
+
+template <typename T>
+uint64_t SelectiveFlatMapColumnReader<T>::skip(uint64_t numValues) {
+  auto numMaps = ColumnReader::skip(numValues);
+  if (numMaps == 0) {
+    return numValues;
+  }
+  // The values are skipped when catching up at the next read.
+  for (auto& node : keyNodes_) {
+    node->inMapBits.resize(bits::nwords(numMaps));
+    node->inMap->next(
+        reinterpret_cast<char*>(node->inMapBits.data()), numMaps, nullptr);
+    node->childTargetReadOffset +=
+        bits::countBits(node->inMapBits.data(), 0, numMaps);
+  }
+  return numValues;
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::readInMap(
+    KeyNode& node,
+    vector_size_t numRows,
+    vector_size_t numMaps,
+    const uint64_t* nulls) {
+  node.inMapBits.resize(bits::nwords(numMaps));
+  if (numMaps) {
+    node.inMap->next(
+        reinterpret_cast<char*>(node.inMapBits.data()), numMaps, nullptr);
+  }
+  node.valueIndex.resize(numRows);
+  vector_size_t numValues = 0;
+  vector_size_t mapIndex = 0;
+  for (auto row = 0; row < numRows; ++row) {
+    if (nulls && bits::isBitNull(nulls, row)) {
+      node.valueIndex[row] = -1;
+      continue;
+    }
+    node.valueIndex[row] =
+        bits::isBitSet(node.inMapBits.data(), mapIndex++) ? numValues++ : -1;
+  }
+  // Catch up if the value reader is behind the in-map stream.
+  node.reader->seekTo(node.childTargetReadOffset, false);
+  node.childTargetReadOffset += numValues;
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::readKey(KeyNode& node, RowSet rows) {
+  node.readRows.clear();
+  for (auto row : rows) {
+    auto index = node.valueIndex[row];
+    if (index >= 0) {
+      node.readRows.push_back(index);
+    }
+  }
+  if (!node.readRows.empty()) {
+    node.reader->read(node.reader->readOffset(), node.readRows, nullptr);
+  }
+}
+
+template <typename T>
+RowSet SelectiveFlatMapColumnReader<T>::filterRows(
+    KeyNode& node,
+    RowSet rows) {
+  auto& passed = otherRowsBuffer(rows);
+  passed.clear();
+  bool nullPasses = nullPassesFlatMapKey(*node.spec);
+  RowSet valueRows =
+      node.readRows.empty() ? RowSet() : node.reader->outputRows();
+  int32_t valueIndex = 0;
+  for (auto row : rows) {
+    auto index = node.valueIndex[row];
+    if (index < 0) {
+      if (nullPasses) {
+        passed.push_back(row);
+      }
+      continue;
+    }
+    while (valueIndex < valueRows.size() && valueRows[valueIndex] < index) {
+      ++valueIndex;
+    }
+    if (valueIndex < valueRows.size() && valueRows[valueIndex] == index) {
+      passed.push_back(row);
+    }
+  }
+  return passed;
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::read(
+    vector_size_t offset,
+    RowSet rows,
+    const uint64_t* incomingNulls) {
+  prepareRead<char>(offset, rows, incomingNulls);
+  const vector_size_t numRows = rows.back() + 1;
+  const auto* nulls =
+      nullsInReadRange_ ? nullsInReadRange_->as<uint64_t>() : nullptr;
+  const vector_size_t numMaps =
+      nulls ? numRows - bits::countNulls(nulls, 0, numRows) : numRows;
+  for (auto& node : keyNodes_) {
+    readInMap(*node, numRows, numMaps, nulls);
+  }
+
+  RowSet activeRows = rows;
+  bool hasFilter = false;
+  if (auto filter = scanSpec_->filter()) {
+    // A filter on the map itself can only be is null or is not null.
+    hasFilter = true;
+    auto& passed = otherRowsBuffer(activeRows);
+    passed.clear();
+    bool nullPasses = filter->testNull();
+    bool nonNullPasses = filter->kind() != FilterKind::kIsNull;
+    for (auto row : activeRows) {
+      bool isNull = nulls && bits::isBitNull(nulls, row);
+      if (isNull ? nullPasses : nonNullPasses) {
+        passed.push_back(row);
+      }
+    }
+    activeRows = passed;
+  }
+  for (auto spec : missingKeyFilters_) {
+    hasFilter = true;
+    if (!nullPassesFlatMapKey(*spec)) {
+      activeRows = RowSet();
+      break;
+    }
+  }
+  for (auto node : filteredNodes_) {
+    hasFilter = true;
+    if (activeRows.empty()) {
+      break;
+    }
+    readKey(*node, activeRows);
+    activeRows = filterRows(*node, activeRows);
+  }
+  if (!activeRows.empty()) {
+    for (auto node : unfilteredNodes_) {
+      readKey(*node, activeRows);
+    }
+  }
+  if (hasFilter) {
+    setOutputRows(activeRows);
+  }
+  numValues_ = activeRows.size();
+  readOffset_ = offset + numRows;
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::loadValues(
+    KeyNode& node,
+    RowSet rows) {
+  node.valueRows.clear();
+  for (auto row : rows) {
+    auto index = node.valueIndex[row];
+    if (index >= 0) {
+      node.valueRows.push_back(index);
+    }
+  }
+  if (node.valueRows.empty()) {
+    node.values = nullptr;
+    return;
+  }
+  if (!node.values && valueType_->kind() == TypeKind::ROW) {
+    node.values = BaseVector::create(valueType_, 0, &memoryPool);
+  }
+  node.reader->getValues(node.valueRows, &node.values);
+}
+
+template <typename T>
+void SelectiveFlatMapColumnReader<T>::getValues(
+    RowSet rows,
+    VectorPtr* result) {
+  BufferPtr nulls;
+  if (nullsInReadRange_) {
+    auto readerNulls = nullsInReadRange_->as<uint64_t>();
+    nulls = AlignedBuffer::allocate<bool>(
+        rows.size(), &memoryPool, bits::kNotNull);
+    auto rawNulls = nulls->asMutable<uint64_t>();
+    for (auto i = 0; i < rows.size(); ++i) {
+      if (bits::isBitNull(readerNulls, rows[i])) {
+        bits::setNull(rawNulls, i);
+      }
+    }
+  }
+  for (auto node : outputNodes_) {
+    if (node) {
+      loadValues(*node, rows);
+    }
+  }
+  *result = asStruct_ ? makeStruct(rows, nulls) : makeMap(rows, nulls);
+}
+
+template <typename T>
+VectorPtr SelectiveFlatMapColumnReader<T>::makeMap(
+    RowSet rows,
+    BufferPtr nulls) {
+  auto offsets =
+      AlignedBuffer::allocate<vector_size_t>(rows.size(), &memoryPool);
+  auto sizes =
+      AlignedBuffer::allocate<vector_size_t>(rows.size(), &memoryPool);
+  auto rawOffsets = offsets->asMutable<vector_size_t>();
+  auto rawSizes = sizes->asMutable<vector_size_t>();
+  vector_size_t numEntries = 0;
+  for (auto i = 0; i < rows.size(); ++i) {
+    vector_size_t size = 0;
+    for (auto node : outputNodes_) {
+      size += node->valueIndex[rows[i]] >= 0;
+    }
+    rawOffsets[i] = numEntries;
+    rawSizes[i] = size;
+    numEntries += size;
+  }
+
+  auto keys = BaseVector::create(type_->childAt(0), numEntries, &memoryPool);
+  auto rawKeys = keys->asFlatVector<T>()->mutableRawValues();
+  if constexpr (std::is_same_v<T, StringView>) {
+    keys->asFlatVector<T>()->setStringBuffers({keyBuffer_});
+  }
+  auto values = BaseVector::create(valueType_, numEntries, &memoryPool);
+  mapFill_.resize(rows.size());
+  std::fill(mapFill_.data(), mapFill_.data() + rows.size(), 0);
+  sourceRows_.resize(numEntries);
+  for (auto node : outputNodes_) {
+    if (!node->values) {
+      continue;
+    }
+    SelectivityVector targets(numEntries, false);
+    vector_size_t source = 0;
+    for (auto i = 0; i < rows.size(); ++i) {
+      if (node->valueIndex[rows[i]] < 0) {
+        continue;
+      }
+      auto target = rawOffsets[i] + mapFill_[i]++;
+      rawKeys[target] = node->keyValue;
+      targets.setValid(target, true);
+      sourceRows_[target] = source++;
+    }
+    targets.updateBounds();
+    values->copy(node->values.get(), targets, sourceRows_.data());
+  }
+  return std::make_shared<MapVector>(
+      &memoryPool,
+      requestedType_,
+      nulls,
+      rows.size(),
+      offsets,
+      sizes,
+      keys,
+      values);
+}
+
+template <typename T>
+VectorPtr SelectiveFlatMapColumnReader<T>::makeStruct(
+    RowSet rows,
+    BufferPtr nulls) {
+  std::vector<VectorPtr> children;
+  children.reserve(outputNodes_.size());
+  sourceRows_.resize(rows.size());
+  for (auto node : outputNodes_) {
+    if (!node || !node->values) {
+      children.push_back(BaseVector::createNullConstant(
+          valueType_, rows.size(), &memoryPool));
+      continue;
+    }
+    auto child = BaseVector::create(valueType_, rows.size(), &memoryPool);
+    SelectivityVector targets(rows.size(), false);
+    vector_size_t source = 0;
+    for (auto i = 0; i < rows.size(); ++i) {
+      if (node->valueIndex[rows[i]] < 0) {
+        child->setNull(i, true);
+        continue;
+      }
+      targets.setValid(i, true);
+      sourceRows_[i] = source++;
+    }
+    targets.updateBounds();
+    child->copy(node->values.get(), targets, sourceRows_.data());
+    children.push_back(std::move(child));
+  }
+  auto numFields = outputNodes_.size();
+  return std::make_shared<RowVector>(
+      &memoryPool,
+      ROW(std::vector<std::string>(numFields),
+          std::vector<TypePtr>(numFields, valueType_)),
+      nulls,
+      rows.size(),
+      std::move(children));
+}
+
 } // namespace
 
 std::unique_ptr<SelectiveColumnReader> buildIntegerReader(
@@ -4668,6 +5950,35 @@ std::unique_ptr<SelectiveColumnReader> buildIntegerReader(
   }
 }
 
+std::unique_ptr<SelectiveColumnReader> buildFlatMapReader(
+    const EncodingKey& ek,
+    const std::shared_ptr<const TypeWithId>& requestedType,
+    const std::shared_ptr<const TypeWithId>& dataType,
+    StripeStreams& stripe,
+    common::ScanSpec* scanSpec) {
+  const auto kind = dataType->childAt(0)->type->kind();
+  switch (kind) {
+    case TypeKind::TINYINT:
+      return std::make_unique<SelectiveFlatMapColumnReader<int8_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::SMALLINT:
+      return std::make_unique<SelectiveFlatMapColumnReader<int16_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::INTEGER:
+      return std::make_unique<SelectiveFlatMapColumnReader<int32_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::BIGINT:
+      return std::make_unique<SelectiveFlatMapColumnReader<int64_t>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    case TypeKind::VARBINARY:
+    case TypeKind::VARCHAR:
+      return std::make_unique<SelectiveFlatMapColumnReader<StringView>>(
+          ek, requestedType, dataType, stripe, scanSpec);
+    default:
+      DWIO_RAISE("Not supported flat map key type: ", kind);
+  }
+}
+
 std::unique_ptr<SelectiveColumnReader> SelectiveColumnReader::build(
     const std::shared_ptr<const TypeWithId>& requestedType,
     const std::shared_ptr<const TypeWithId>& dataType,
@@ -4693,7 +6004,8 @@ std::unique_ptr<SelectiveColumnReader> SelectiveColumnReader::build(
     case TypeKind::MAP:
       if (stripe.getEncoding(ek).kind() ==
           proto::ColumnEncoding_Kind_MAP_FLAT) {
-        VELOX_UNSUPPORTED("SelectiveColumnReader does not support flat maps");
+        return buildFlatMapReader(
+            ek, requestedType, dataType, stripe, scanSpec);
       }
       return std::make_unique<SelectiveMapColumnReader>(
           ek, requestedType, dataType, stripe, scanSpec);
@@ -4717,6 +6029,9 @@ std::unique_ptr<SelectiveColumnReader> SelectiveColumnReader::build(
     case TypeKind::BOOLEAN:
       return std::make_unique<SelectiveByteRleColumnReader>(
           ek, requestedType, dataType, stripe, scanSpec, true);
+    case TypeKind::TIMESTAMP:
+      return std::make_unique<SelectiveTimestampColumnReader>(
+          ek, stripe, scanSpec);
     case TypeKind::TINYINT:
       return std::make_unique<SelectiveByteRleColumnReader>(
           ek, requestedType, dataType, stripe, scanSpec, false);
@@ -213,6 +213,16 @@ class SelectiveColumnReader : public ColumnReader {
       uint64_t rowGroupSize,
       const StatsContext& context) const override;
 
+  // Returns the positions recorded for row group 'index'.
+  std::vector<uint64_t> rowGroupPositions(uint32_t index) const;
+
+  // Removes the first 'numPositions' positions of each row group
+  // index entry and returns them, one vector per row group. Used for
+  // the value readers of flat map keys, since the writer records the
+  // positions of the in-map stream of the key before the positions of
+  // the value streams.
+  std::vector<std::vector<uint64_t>> removeIndexPrefix(int32_t numPositions);
+
   raw_vector<int32_t>& innerNonNullRows() {
     return innerNonNullRows_;
   }
@@ -295,6 +305,25 @@ class SelectiveColumnReader : public ColumnReader {
   // copy.
   char* copyStringValue(folly::StringPiece value);
 
+  // Sets the buffer over the stream bytes that string values may refer to.
+  // 'buffer' may be nullptr.
+  void setStreamBuffer(BufferPtr buffer);
+
+  // Returns true if the bytes of 'value' are in 'streamBuffer_', so that a
+  // StringView may refer to them. Records that 'streamBuffer_' is
+  // referenced.
+  bool referenceStreamBuffer(folly::StringPiece value) {
+    if (value.data() < streamBufferStart_ ||
+        value.data() + value.size() > streamBufferEnd_) {
+      return false;
+    }
+    streamBufferReferenced_ = true;
+    return true;
+  }
+
+  // Adds the stream buffers that values refer to to 'stringBuffers_'.
+  void addReferencedStreamBuffers();
+
   void ensureRowGroupIndex() const {
     VELOX_CHECK(index_ || indexStream_, "Reader needs to have an index stream");
     if (indexStream_) {
@@ -309,6 +338,9 @@ class SelectiveColumnReader : public ColumnReader {
   TypePtr type_;
   mutable std::unique_ptr<SeekableInputStream> indexStream_;
   mutable std::unique_ptr<proto::RowIndex> index_;
+  // The per row group bloom filters, read on first use.
+  mutable std::unique_ptr<SeekableInputStream> bloomFilterStream_;
+  mutable std::unique_ptr<proto::BloomFilterIndex> bloomFilterIndex_;
   // Number of rows in a row group. Last row group may have fewer rows.
   uint32_t rowsPerRowGroup_;
 
@@ -364,12 +396,23 @@ class SelectiveColumnReader : public ColumnReader {
   std::vector<BufferPtr> stringBuffers_;
   // Writable contents of 'stringBuffers_.back()'.
   char* rawStringBuffer_ = nullptr;
-  // True if a vector can acquire a pin to a stream's buffer and refer
-  // to that as its values.
-  bool mayUseStreamBuffer_ = false;
+  // Holds the stream bytes in ['streamBufferStart_', 'streamBufferEnd_')
+  // live. String values in this range refer to it instead of being
+  // copied. nullptr if the stream does not provide such buffers.
+  BufferPtr streamBuffer_;
+  const char* streamBufferStart_ = nullptr;
+  const char* streamBufferEnd_ = nullptr;
+  // True if values since the last getValues() refer to 'streamBuffer_'.
+  bool streamBufferReferenced_ = false;
+  // Earlier stream buffers that values since the last getValues() refer
+  // to.
+  std::vector<BufferPtr> referencedStreamBuffers_;
   // True if nulls and everything selected, so that nullsInReadRange
   // can be returned as the null flags of the vector in getValues().
   bool returnReaderNulls_ = false;
+  // True if getFlatValues() returns a SequenceVector for values with long
+  // runs. See RowReaderOptions::setReturnRunLengthEncoded().
+  const bool returnRunLengthEncoded_;
   // Total writable bytes in 'rawStringBuffer_'.
   int32_t rawStringSize_ = 0;
   // Number of written bytes in 'rawStringBuffer_'.
@@ -392,6 +435,11 @@ inline void SelectiveColumnReader::addValue(const folly::StringPiece value) {
         StringView(value.data(), size);
     return;
   }
+  if (referenceStreamBuffer(value)) {
+    reinterpret_cast<StringView*>(rawValues_)[numValues_++] =
+        StringView(value.data(), size);
+    return;
+  }
   if (rawStringBuffer_ && rawStringUsed_ + size <= rawStringSize_) {
     memcpy(rawStringBuffer_ + rawStringUsed_, value.data(), size);
     reinterpret_cast<StringView*>(rawValues_)[numValues_++] =
@@ -59,6 +59,21 @@ const proto::StripeInformation& StripeReaderBase::loadStripe(
     }
   }
 
+  // The footer may have been parsed by another reader of the same file.
+  auto* dataCacheConfig = reader_->getDataCacheConfig();
+  auto* metadataCache =
+      dataCacheConfig ? FileMetadataCache::getInstance() : nullptr;
+  sharedFooter_.reset();
+  if (metadataCache) {
+    sharedFooter_ = metadataCache->findStripeFooter(
+        dataCacheConfig->filenum, reader_->getFileLength(), index);
+    if (sharedFooter_) {
+      loadEncryptionKeys(index);
+      lastStripeIndex_ = index;
+      return stripe;
+    }
+  }
+
   // load stripe footer
   std::unique_ptr<SeekableInputStream> stream;
   if (cache) {
@@ -80,16 +95,25 @@ const proto::StripeInformation& StripeReaderBase::loadStripe(
     }
   }
 
-  // Reuse footer_'s memory to avoid expensive destruction
-  if (!footer_) {
-    footer_ = google::protobuf::Arena::CreateMessage<proto::StripeFooter>(
-        reader_->arena());
-  }
-
   auto streamDebugInfo = fmt::format("Stripe {} Footer ", index);
-  ProtoUtils::readProtoInto<proto::StripeFooter>(
-      reader_->createDecompressedStream(std::move(stream), streamDebugInfo),
-      footer_);
+  if (metadataCache) {
+    auto footer = std::make_shared<proto::StripeFooter>();
+    ProtoUtils::readProtoInto<proto::StripeFooter>(
+        reader_->createDecompressedStream(std::move(stream), streamDebugInfo),
+        footer.get());
+    metadataCache->insertStripeFooter(
+        dataCacheConfig->filenum, reader_->getFileLength(), index, footer);
+    sharedFooter_ = std::move(footer);
+  } else {
+    // Reuse footer_'s memory to avoid expensive destruction
+    if (!footer_) {
+      footer_ = google::protobuf::Arena::CreateMessage<proto::StripeFooter>(
+          reader_->arena());
+    }
+    ProtoUtils::readProtoInto<proto::StripeFooter>(
+        reader_->createDecompressedStream(std::move(stream), streamDebugInfo),
+        footer_);
+  }
 
   // refresh stripe encryption key if necessary
   loadEncryptionKeys(index);
@@ -104,7 +128,8 @@ void StripeReaderBase::loadEncryptionKeys(uint32_t index) {
   }
 
   DWIO_ENSURE_EQ(
-      footer_->encryptiongroups_size(), handler_->getEncryptionGroupCount());
+      getStripeFooter().encryptiongroups_size(),
+      handler_->getEncryptionGroupCount());
   auto& footer = reader_->getFooter();
   DWIO_ENSURE_LT(index, footer.stripes_size(), "invalid stripe index");
 
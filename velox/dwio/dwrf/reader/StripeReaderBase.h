@@ -46,6 +46,9 @@ class StripeReaderBase {
   const proto::StripeInformation& loadStripe(uint32_t index, bool& preload);
 
   const proto::StripeFooter& getStripeFooter() const {
+    if (sharedFooter_) {
+      return *sharedFooter_;
+    }
     DWIO_ENSURE_NOT_NULL(footer_, "stripe not loaded");
     return *footer_;
   }
@@ -58,6 +61,10 @@ class StripeReaderBase {
     return *reader_;
   }
 
+  const std::shared_ptr<ReaderBase>& getReaderPtr() const {
+    return reader_;
+  }
+
   const encryption::DecryptionHandler& getDecryptionHandler() const {
     return *handler_;
   }
@@ -66,6 +73,9 @@ class StripeReaderBase {
   std::shared_ptr<ReaderBase> reader_;
   std::unique_ptr<BufferedInput> stripeInput_;
   proto::StripeFooter* footer_ = nullptr;
+  // The footer of the current stripe if it is shared through the
+  // FileMetadataCache. Takes precedence over 'footer_'.
+  std::shared_ptr<const proto::StripeFooter> sharedFooter_;
   std::unique_ptr<encryption::DecryptionHandler> handler_;
   std::optional<uint32_t> lastStripeIndex_;
 
@@ -216,7 +216,7 @@ std::unique_ptr<SeekableInputStream> StripeStreamsImpl::getCompressedStream(
   const auto& info = getStreamInfo(si);
 
   std::unique_ptr<SeekableInputStream> streamRead;
-  if (si.kind == StreamKind::StreamKind_ROW_INDEX) {
+  if (isIndexStream(si.kind)) {
     streamRead = getIndexStreamFromCache(info);
   }
 
@@ -266,7 +266,7 @@ std::unique_ptr<SeekableInputStream> StripeStreamsImpl::getStream(
   }
 
   std::unique_ptr<SeekableInputStream> streamRead;
-  if (si.kind == StreamKind::StreamKind_ROW_INDEX) {
+  if (isIndexStream(si.kind)) {
     streamRead = getIndexStreamFromCache(info);
   }
 
@@ -281,8 +281,13 @@ std::unique_ptr<SeekableInputStream> StripeStreamsImpl::getStream(
 
   auto streamDebugInfo =
       fmt::format("Stripe {} Stream {}", stripeIndex_, si.toString());
+  // Data streams are decompressed ahead of use if the input has an
+  // executor. Index streams are read once, so they are decompressed inline.
   return reader_.getReader().createDecompressedStream(
-      std::move(streamRead), streamDebugInfo, getDecrypter(si.node));
+      std::move(streamRead),
+      streamDebugInfo,
+      getDecrypter(si.node),
+      isIndexStream(si.kind) ? nullptr : reader_.getStripeInput().executor());
 }
 
 uint32_t StripeStreamsImpl::visitStreamsOfNode(
@@ -340,4 +345,18 @@ void StripeStreamsImpl::loadReadPlan() {
   input.load(LogType::STREAM_BUNDLE);
 }
 
+bool StripeStreamsImpl::loadRowIndexes() {
+  DWIO_ENSURE_EQ(readPlanLoaded_, false, "row indexes loaded after read plan");
+  return reader_.getStripeInput().loadRowIndexes(LogType::STREAM);
+}
+
+void StripeStreamsImpl::enqueueStreams() {
+  auto& input = reader_.getStripeInput();
+  for (auto& entry : streams_) {
+    auto& info = entry.second;
+    // No stream id, so that the accesses are tracked when the stripe is read.
+    input.enqueue({info.getOffset() + stripeStart_, info.getLength()});
+  }
+}
+
 } // namespace facebook::velox::dwrf
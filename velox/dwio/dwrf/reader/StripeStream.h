@@ -256,6 +256,15 @@ class StripeStreamsImpl : public StripeStreamsBase {
   // load data into buffer according to read plan
   void loadReadPlan();
 
+  // Loads the row index streams of the read plan ahead of the other streams.
+  // Returns false if the input does not support this.
+  bool loadRowIndexes();
+
+  // Enqueues all the projected streams of the stripe without creating
+  // readers for them. Used for starting the IO of a stripe ahead of its
+  // decoding.
+  void enqueueStreams();
+
   std::unique_ptr<SeekableInputStream> getCompressedStream(
       const StreamIdentifier& si) const;
 
@@ -321,6 +321,30 @@ TEST_F(CacheTest, bufferedInput) {
   readLoop("testfile2", 30, 70, 70, 20);
 }
 
+TEST_F(CacheTest, currentBuffer) {
+  initializeCache(64 << 20);
+  auto tracker = std::make_shared<ScanTracker>();
+  uint64_t fileId;
+  uint64_t groupId;
+  auto input = inputByPath("testfile", fileId, groupId);
+  auto stripe = makeStripeData(input, tracker, fileId, groupId, 0);
+  stripe->input->load(facebook::velox::dwio::common::LogType::TEST);
+  const void* data;
+  int32_t size;
+  ASSERT_TRUE(stripe->streams[0]->Next(&data, &size));
+  auto buffer = stripe->streams[0]->currentBuffer();
+  ASSERT_NE(nullptr, buffer);
+  auto bytes = reinterpret_cast<const char*>(data);
+  EXPECT_LE(buffer->as<char>(), bytes);
+  EXPECT_GE(buffer->as<char>() + buffer->size(), bytes + size);
+
+  // The buffer keeps the cache entry pinned after the stream is gone.
+  auto file = stripe->file;
+  auto offset = stripe->regions[0].offset;
+  stripe.reset();
+  file->checkData(data, offset, size);
+}
+
 TEST_F(CacheTest, TestSingleFileThreads) {
   initializeCache(1 << 30);
 
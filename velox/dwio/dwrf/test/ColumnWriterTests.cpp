@@ -2332,6 +2332,65 @@ TEST(ColumnWriterTests, IntegerColumnWriterAbandonDictionariesWithNulls) {
   }
 }
 
+TEST(ColumnWriterTests, IntegerColumnWriterDictionarySample) {
+  std::unique_ptr<ScopedMemoryPool> scopedPool = getDefaultScopedMemoryPool();
+  auto& pool = *scopedPool;
+  auto makeBatch = [&](size_t size, std::function<int64_t(size_t)> genData) {
+    BufferPtr values = AlignedBuffer::allocate<int64_t>(size, &pool);
+    auto* valuesPtr = values->asMutable<int64_t>();
+    for (size_t i = 0; i != size; ++i) {
+      valuesPtr[i] = genData(i);
+    }
+    return std::make_shared<FlatVector<int64_t>>(
+        &pool, nullptr, size, values, std::vector<BufferPtr>());
+  };
+  // The first 1000 values are distinct. Over the whole stripe the dictionary
+  // is efficient, but not over the first batch.
+  std::vector<std::shared_ptr<FlatVector<int64_t>>> batches{
+      makeBatch(1000, [](size_t i) { return i; }),
+      makeBatch(10000, [](size_t /* unused */) { return 0; })};
+
+  for (uint32_t sampleRows : {0, 1000}) {
+    auto config = std::make_shared<Config>();
+    config->set(Config::DICTIONARY_SAMPLE_ROWS, sampleRows);
+    WriterContext context{config, getDefaultScopedMemoryPool()};
+    auto typeWithId = TypeWithId::create(BIGINT(), 1);
+    auto columnWriter = ColumnWriter::create(context, *typeWithId);
+
+    proto::StripeFooter stripeFooter;
+    for (auto& batch : batches) {
+      columnWriter->write(batch, Ranges::of(0, batch->size()));
+    }
+    columnWriter->createIndexEntry();
+    columnWriter->flush(
+        [&stripeFooter](uint32_t /* unused */) -> proto::ColumnEncoding& {
+          return *stripeFooter.add_encoding();
+        });
+
+    auto rowType = ROW({{"integral_column", BIGINT()}});
+    TestStripeStreams streams(context, stripeFooter, rowType);
+    EXPECT_EQ(
+        sampleRows == 0
+            ? proto::ColumnEncoding_Kind::ColumnEncoding_Kind_DICTIONARY
+            : proto::ColumnEncoding_Kind::ColumnEncoding_Kind_DIRECT,
+        streams.getEncoding(EncodingKey{1}).kind());
+    auto reqType = TypeWithId::create(rowType)->childAt(0);
+    auto columnReader = ColumnReader::build(reqType, reqType, streams);
+    for (auto& batch : batches) {
+      VectorPtr result;
+      columnReader->next(batch->size(), result);
+      auto resultValues =
+          std::dynamic_pointer_cast<FlatVector<int64_t>>(result);
+      ASSERT_TRUE(resultValues);
+      EXPECT_THAT(
+          std::vector<int64_t>(
+              resultValues->rawValues(),
+              resultValues->rawValues() + resultValues->size()),
+          ElementsAreArray(batch->rawValues(), batch->size()));
+    }
+  }
+}
+
 template <typename Integer>
 void testIntegerDictionaryEncodableWriterConstructor() {
   auto type = CppToType<Integer>::create();
@@ -3260,6 +3319,71 @@ TEST(ColumnWriterTests, ColumnWriterDictionarySimple) {
   });
 };
 
+template <typename T>
+void testSmallDictionary(
+    const TypePtr& type,
+    std::function<T(vector_size_t)> valueAt) {
+  // A few distinct base values referenced by many rows, so the writer remaps
+  // the base dictionary instead of hashing each row.
+  constexpr vector_size_t baseSize = 4;
+  constexpr vector_size_t size = 1000;
+  auto scopedPool = getDefaultScopedMemoryPool();
+  auto& pool = *scopedPool;
+  auto base = std::dynamic_pointer_cast<FlatVector<T>>(
+      BaseVector::create(type, baseSize, &pool));
+  for (auto i = 0; i < baseSize; ++i) {
+    base->set(i, valueAt(i));
+  }
+  base->setNull(baseSize - 1, true);
+  auto indices = AlignedBuffer::allocate<vector_size_t>(size, &pool);
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  for (auto i = 0; i < size; ++i) {
+    rawIndices[i] = (i * 7) % baseSize;
+  }
+  auto batch =
+      BaseVector::wrapInDictionary(BufferPtr(nullptr), indices, size, base);
+
+  auto config = std::make_shared<Config>();
+  WriterContext context{config, getDefaultScopedMemoryPool()};
+  auto rowType = ROW({type});
+  auto typeWithId = TypeWithId::create(type, 1);
+  auto writer = ColumnWriter::create(context, *typeWithId);
+  writer->write(batch, Ranges::of(0, size));
+  writer->createIndexEntry();
+
+  proto::StripeFooter sf;
+  writer->flush([&sf](uint32_t /* unused */) -> proto::ColumnEncoding& {
+    return *sf.add_encoding();
+  });
+  ASSERT_EQ(1, sf.encoding_size());
+  ASSERT_EQ(
+      proto::ColumnEncoding_Kind::ColumnEncoding_Kind_DICTIONARY,
+      sf.encoding(0).kind());
+  ASSERT_EQ(baseSize - 1, sf.encoding(0).dictionarysize());
+
+  TestStripeStreams streams(context, sf, rowType);
+  EXPECT_CALL(streams.getMockStrideIndexProvider(), getStrideIndex())
+      .WillRepeatedly(Return(0));
+  auto rowTypeWithId = TypeWithId::create(rowType);
+  auto reqType = rowTypeWithId->childAt(0);
+  auto reader = ColumnReader::build(reqType, reqType, streams);
+  VectorPtr out;
+  reader->next(size, out);
+  ASSERT_EQ(size, out->size());
+  for (auto i = 0; i < size; ++i) {
+    ASSERT_TRUE(out->equalValueAt(batch.get(), i, i)) << "at index " << i;
+  }
+}
+
+TEST(ColumnWriterTests, smallBaseDictionary) {
+  testSmallDictionary<int64_t>(
+      BIGINT(), [](vector_size_t i) { return i * 1000; });
+  testSmallDictionary<int32_t>(INTEGER(), [](vector_size_t i) { return -i; });
+  testSmallDictionary<StringView>(VARCHAR(), [](vector_size_t i) {
+    return StringView(std::string("str") + std::to_string(i));
+  });
+}
+
 TEST(ColumnWriterTests, rowDictionary) {
   // For complex data valueAt lambda is not set as the data is generated
   // randomly
@@ -378,6 +378,27 @@ ColumnStats<StringView>::makeRowGroupSkipRangeFilter(
       max, false, false, max, false, false, false);
 }
 
+template <>
+std::unique_ptr<Filter> ColumnStats<Timestamp>::makeRangeFilter(
+    float startPct,
+    float selectPct) {
+  if (values_.empty()) {
+    return std::make_unique<velox::common::IsNull>();
+  }
+  Timestamp lower = valueAtPct(startPct);
+  Timestamp upper = valueAtPct(startPct + selectPct);
+  return std::make_unique<velox::common::BigintRange>(
+      lower.toMillis(), upper.toMillis(), selectPct > 25);
+}
+
+template <>
+std::unique_ptr<velox::common::Filter>
+ColumnStats<Timestamp>::makeRowGroupSkipRangeFilter(
+    const std::vector<RowVectorPtr>& /*batches*/,
+    const Subfield& /*subfield*/) {
+  VELOX_NYI();
+}
+
 template <TypeKind Kind>
 std::unique_ptr<AbstractColumnStats> makeStats(TypePtr type) {
   using T = typename TypeTraits<Kind>::NativeType;
@@ -542,6 +563,9 @@ class E2EFilterTest : public testing::Test {
         case TypeKind::DOUBLE:
           stats = makeStats<TypeKind::DOUBLE>(vector->type());
           break;
+        case TypeKind::TIMESTAMP:
+          stats = makeStats<TypeKind::TIMESTAMP>(vector->type());
+          break;
         default:
           VELOX_CHECK(false, "Type not supported");
       }
@@ -704,6 +728,13 @@ class E2EFilterTest : public testing::Test {
     auto config = std::make_shared<dwrf::Config>();
     config->set(dwrf::Config::COMPRESSION, dwrf::CompressionKind_NONE);
     config->set(dwrf::Config::USE_VINTS, useVInts_);
+    if (!flatMapColumns_.empty()) {
+      config->set(dwrf::Config::FLATTEN_MAP, true);
+      config->set(dwrf::Config::MAP_FLAT_COLS, flatMapColumns_);
+    }
+    if (!bloomFilterColumns_.empty()) {
+      config->set(dwrf::Config::BLOOM_FILTER_COLS, bloomFilterColumns_);
+    }
     WriterOptions options;
     options.config = config;
     options.schema = type;
@@ -1123,6 +1154,10 @@ class E2EFilterTest : public testing::Test {
   int32_t flushEveryNBatches_{10};
   int32_t nextReadSizeIndex_{0};
   std::vector<int32_t> readSizes_;
+  // Top level columns written with flat map encoding.
+  std::vector<uint32_t> flatMapColumns_;
+  // Top level columns written with bloom filters.
+  std::vector<uint32_t> bloomFilterColumns_;
 };
 
 TEST_F(E2EFilterTest, integerDirect) {
@@ -1208,6 +1243,19 @@ TEST_F(E2EFilterTest, floatAndDouble) {
       false);
 }
 
+TEST_F(E2EFilterTest, timestamp) {
+  testWithTypes(
+      "timestamp_val:timestamp,"
+      "long_val:bigint,"
+      "timestamp_null:timestamp",
+      [&]() { makeAllNulls("timestamp_null"); },
+      true,
+      {"timestamp_val", "timestamp_null"},
+      20,
+      true,
+      false);
+}
+
 TEST_F(E2EFilterTest, stringDirect) {
   flushEveryNBatches_ = 1;
   testWithTypes(
@@ -1252,6 +1300,176 @@ TEST_F(E2EFilterTest, listAndMap) {
       10);
 }
 
+TEST_F(E2EFilterTest, flatMap) {
+  flatMapColumns_ = {1, 2};
+  testWithTypes(
+      "long_val:bigint,"
+      "long_map:map<bigint,bigint>,"
+      "string_map:map<string,int>",
+      [&]() {},
+      false,
+      {"long_val"},
+      10);
+
+  // Filters on the value of one key. All keys are returned.
+  auto maps = batches_[0]->childAt(1)->as<MapVector>();
+  vector_size_t firstMap = 0;
+  while (maps->isNullAt(firstMap) || maps->sizeAt(firstMap) == 0) {
+    ++firstMap;
+  }
+  auto keys = maps->mapKeys()->as<FlatVector<int64_t>>();
+  auto values = maps->mapValues()->as<FlatVector<int64_t>>();
+  auto key = keys->valueAt(maps->offsetAt(firstMap));
+  auto lower = values->isNullAt(maps->offsetAt(firstMap))
+      ? 0
+      : values->valueAt(maps->offsetAt(firstMap));
+  std::vector<uint32_t> hitRows;
+  for (auto batchIndex = 0; batchIndex < batches_.size(); ++batchIndex) {
+    auto batchMaps = batches_[batchIndex]->childAt(1)->as<MapVector>();
+    auto batchKeys = batchMaps->mapKeys()->as<FlatVector<int64_t>>();
+    auto batchValues = batchMaps->mapValues()->as<FlatVector<int64_t>>();
+    for (auto row = 0; row < batchMaps->size(); ++row) {
+      if (batchMaps->isNullAt(row)) {
+        continue;
+      }
+      auto offset = batchMaps->offsetAt(row);
+      for (auto i = offset; i < offset + batchMaps->sizeAt(row); ++i) {
+        if (batchKeys->valueAt(i) == key) {
+          if (!batchValues->isNullAt(i) && batchValues->valueAt(i) >= lower) {
+            hitRows.push_back(batchPosition(batchIndex, row));
+          }
+          break;
+        }
+      }
+    }
+  }
+  std::vector<std::unique_ptr<Subfield::PathElement>> path;
+  path.push_back(std::make_unique<Subfield::NestedField>("long_map"));
+  path.push_back(std::make_unique<Subfield::LongSubscript>(key));
+  SubfieldFilters filters;
+  filters[Subfield(std::move(path))] =
+      std::make_unique<velox::common::BigintRange>(
+          lower, std::numeric_limits<int64_t>::max(), false);
+  auto spec = makeScanSpec(std::move(filters));
+  uint64_t time = 0;
+  readWithFilter(spec.get(), batches_, hitRows, time, false);
+}
+
+TEST_F(E2EFilterTest, bloomFilter) {
+  bloomFilterColumns_ = {0, 1};
+  makeDataset(
+      "long_val:bigint,"
+      "string_val:string",
+      [&]() {
+        // Makes distinct values that cover the whole range of bigint in each
+        // row group, so that only the bloom filters can skip row groups.
+        uint64_t counter = 0;
+        for (auto& batch : batches_) {
+          auto values = batch->childAt(0)->as<FlatVector<int64_t>>();
+          for (auto row = 0; row < values->size(); ++row) {
+            if (!values->isNullAt(row)) {
+              values->set(row, ++counter * 0x9e3779b97f4a7c15UL);
+            }
+          }
+        }
+      },
+      false,
+      true);
+
+  auto longs = batches_[2]->childAt(0)->as<FlatVector<int64_t>>();
+  vector_size_t longRow = 100;
+  while (longs->isNullAt(longRow)) {
+    ++longRow;
+  }
+  auto value = longs->valueAt(longRow);
+  std::vector<uint32_t> hitRows;
+  for (auto batchIndex = 0; batchIndex < batches_.size(); ++batchIndex) {
+    auto batchLongs =
+        batches_[batchIndex]->childAt(0)->as<FlatVector<int64_t>>();
+    for (auto row = 0; row < batchLongs->size(); ++row) {
+      if (!batchLongs->isNullAt(row) && batchLongs->valueAt(row) == value) {
+        hitRows.push_back(batchPosition(batchIndex, row));
+      }
+    }
+  }
+  SubfieldFilters filters;
+  filters[Subfield("long_val")] =
+      std::make_unique<velox::common::BigintRange>(value, value, false);
+  auto spec = makeScanSpec(std::move(filters));
+  uint64_t time = 0;
+  readWithFilter(spec.get(), batches_, hitRows, time, false);
+  EXPECT_LT(0, runtimeStats_.skippedStrides);
+
+  auto strings = batches_[1]->childAt(1)->as<FlatVector<StringView>>();
+  std::vector<std::string> values;
+  // Picks long strings, which are rare enough to occur in few row groups.
+  for (auto row = 0; row < strings->size() && values.size() < 2; ++row) {
+    if (!strings->isNullAt(row) && strings->valueAt(row).size() >= 8) {
+      values.push_back(strings->valueAt(row).str());
+    }
+  }
+  hitRows.clear();
+  for (auto batchIndex = 0; batchIndex < batches_.size(); ++batchIndex) {
+    auto batchStrings =
+        batches_[batchIndex]->childAt(1)->as<FlatVector<StringView>>();
+    for (auto row = 0; row < batchStrings->size(); ++row) {
+      if (!batchStrings->isNullAt(row) &&
+          std::find(
+              values.begin(),
+              values.end(),
+              batchStrings->valueAt(row).str()) != values.end()) {
+        hitRows.push_back(batchPosition(batchIndex, row));
+      }
+    }
+  }
+  filters.clear();
+  filters[Subfield("string_val")] =
+      std::make_unique<velox::common::BytesValues>(values, false);
+  spec = makeScanSpec(std::move(filters));
+  readWithFilter(spec.get(), batches_, hitRows, time, false);
+  EXPECT_LT(0, runtimeStats_.skippedStrides);
+}
+
+TEST_F(E2EFilterTest, dictionaryNoMatch) {
+  makeDataset(
+      "long_val:bigint,"
+      "string_val:string",
+      [&]() {
+        // Makes low cardinality columns whose dictionaries do not contain
+        // the odd numbers and the suffixed strings filtered on below,
+        // although these are within the min and max of every row group.
+        static const char* kStrings[] = {"v0", "v2", "v4", "v6", "v8"};
+        for (auto& batch : batches_) {
+          auto longs = batch->childAt(0)->as<FlatVector<int64_t>>();
+          auto strings = batch->childAt(1)->as<FlatVector<StringView>>();
+          for (auto row = 0; row < batch->size(); ++row) {
+            if (!longs->isNullAt(row)) {
+              longs->set(row, 10 + (row % 10) * 2);
+            }
+            if (!strings->isNullAt(row)) {
+              strings->set(row, StringView(kStrings[row % 5]));
+            }
+          }
+        }
+      },
+      false);
+
+  std::vector<uint32_t> hitRows;
+  uint64_t time = 0;
+  SubfieldFilters filters;
+  filters[Subfield("long_val")] =
+      velox::common::createBigintValues({11, 13, 15}, false);
+  auto spec = makeScanSpec(std::move(filters));
+  readWithFilter(spec.get(), batches_, hitRows, time, false);
+
+  filters.clear();
+  filters[Subfield("string_val")] =
+      std::make_unique<velox::common::BytesValues>(
+          std::vector<std::string>{"v1", "v3x"}, false);
+  spec = makeScanSpec(std::move(filters));
+  readWithFilter(spec.get(), batches_, hitRows, time, false);
+}
+
 TEST_F(E2EFilterTest, nullCompactRanges) {
   // Makes a dataset with nulls at the beginning. Tries different
   // filter ombinations on progressively larger batches. tests for a
@@ -15,6 +15,7 @@
  */
 
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include "velox/dwio/common/MemoryInputStream.h"
 #include "velox/dwio/common/Options.h"
 #include "velox/dwio/common/encryption/TestProvider.h"
@@ -148,6 +149,56 @@ TEST(E2EWriterTests, E2E) {
   E2EWriterTestUtil::testWriter(pool, type, batches, 1, 1, config);
 }
 
+TEST(E2EWriterTests, E2EWithExecutor) {
+  auto scopedPool = memory::getDefaultScopedMemoryPool();
+  auto& pool = *scopedPool;
+
+  HiveTypeParser parser;
+  auto type = parser.parse(
+      "struct<"
+      "bool_val:boolean,"
+      "int_val:int,"
+      "long_val:bigint,"
+      "double_val:double,"
+      "string_val:string,"
+      "timestamp_val:timestamp,"
+      "array_val:array<float>,"
+      "map_val:map<int,double>,"
+      "map_val:map<bigint,double>," /* this is column 8 */
+      "struct_val:struct<a:float,b:double>"
+      ">");
+
+  auto config = std::make_shared<Config>();
+  config->set(Config::ROW_INDEX_STRIDE, static_cast<uint32_t>(1000));
+  config->set(Config::COMPRESSION_BLOCK_SIZE, static_cast<uint64_t>(1024));
+  config->set(Config::FLATTEN_MAP, true);
+  config->set(Config::MAP_FLAT_COLS, {8});
+
+  std::vector<VectorPtr> batches;
+  size_t size = 1100;
+  for (size_t i = 0; i < 4; ++i) {
+    batches.push_back(BatchMaker::createBatch(type, size, pool));
+    size = 200;
+  }
+
+  // The columns are written concurrently with each other and with the flat
+  // map on the calling thread. The content must be the same as when written
+  // serially.
+  folly::CPUThreadPoolExecutor executor(4);
+  E2EWriterTestUtil::testWriter(
+      pool,
+      type,
+      batches,
+      1,
+      1,
+      config,
+      nullptr,
+      nullptr,
+      std::numeric_limits<int64_t>::max(),
+      true,
+      &executor);
+}
+
 TEST(E2EWriterTests, MaxFlatMapKeys) {
   using keyType = int32_t;
   using valueType = int32_t;
@@ -367,6 +418,58 @@ TEST(E2EWriterTests, FlatMapWithNullsSharedDict) {
   testFlatMapWithNulls(true, true);
 }
 
+// Writes a stripe per batch. The value writers of keys 1 and 100'000 are
+// kept across stripes, the one of key 2 is removed for the stripe without it
+// and recreated for the next.
+void testFlatMapKeysAcrossStripes(bool shareDictionary) {
+  auto scopedPool = memory::getDefaultScopedMemoryPool();
+  auto& pool = *scopedPool;
+
+  using keyType = int32_t;
+  using valueType = int32_t;
+  using b = MapBuilder<keyType, valueType>;
+
+  const auto type = CppToType<Row<Map<keyType, valueType>>>::create();
+  std::vector<std::vector<keyType>> stripeKeys = {
+      {1, 2, 100'000}, {1, 100'000}, {1, 2, 3}};
+  std::vector<VectorPtr> batches;
+  for (auto& keys : stripeKeys) {
+    b::rows rows;
+    for (int32_t i = 0; i < 100; ++i) {
+      b::row row;
+      for (auto key : keys) {
+        if (i % 3 != key % 3) {
+          row.push_back(b::pair{key, Random::rand32(10)});
+        }
+      }
+      rows.push_back(std::move(row));
+    }
+    auto rowCount = rows.size();
+    batches.push_back(createRowVector(
+        &pool, type, rowCount, b::create(pool, std::move(rows))));
+  }
+
+  auto config = std::make_shared<Config>();
+  config->set(Config::FLATTEN_MAP, true);
+  config->set(Config::MAP_FLAT_COLS, {0});
+  config->set(Config::MAP_FLAT_DISABLE_DICT_ENCODING, false);
+  config->set(Config::MAP_FLAT_DICT_SHARE, shareDictionary);
+
+  E2EWriterTestUtil::testWriter(
+      pool,
+      type,
+      batches,
+      stripeKeys.size(),
+      stripeKeys.size(),
+      config,
+      E2EWriterTestUtil::simpleFlushPolicy(true));
+}
+
+TEST(E2EWriterTests, FlatMapKeysAcrossStripes) {
+  testFlatMapKeysAcrossStripes(false);
+  testFlatMapKeysAcrossStripes(true);
+}
+
 TEST(E2EWriterTests, FlatMapEmpty) {
   auto scopedPool = memory::getDefaultScopedMemoryPool();
   auto& pool = *scopedPool;
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "velox/dwio/common/MemoryInputStream.h"
+#include "velox/dwio/dwrf/reader/DwrfReader.h"
+#include "velox/dwio/dwrf/test/utils/BatchMaker.h"
+#include "velox/dwio/dwrf/test/utils/E2EWriterTestUtil.h"
+#include "velox/dwio/dwrf/writer/FileMerger.h"
+#include "velox/dwio/type/fbhive/HiveTypeParser.h"
+
+using namespace ::testing;
+using namespace facebook::velox::dwio::common;
+using namespace facebook::velox::dwrf;
+using namespace facebook::velox::dwio::type::fbhive;
+using namespace facebook::velox::test;
+using namespace facebook::velox;
+
+namespace {
+
+class FileMergerTest : public Test {
+ protected:
+  // Writes 'batches' to a file of a stripe per batch.
+  MemorySink& writeFile(
+      const std::shared_ptr<const Type>& type,
+      const std::vector<VectorPtr>& batches,
+      const std::shared_ptr<Config>& config) {
+    auto sink = std::make_unique<MemorySink>(pool_, 10 << 20);
+    auto sinkPtr = sink.get();
+    writers_.push_back(E2EWriterTestUtil::writeData(
+        std::move(sink),
+        type,
+        batches,
+        config,
+        E2EWriterTestUtil::simpleFlushPolicy(true)));
+    return *sinkPtr;
+  }
+
+  std::unique_ptr<ReaderBase> makeReader(const MemorySink& sink) {
+    return std::make_unique<ReaderBase>(
+        pool_,
+        std::make_unique<MemoryInputStream>(sink.getData(), sink.size()));
+  }
+
+  std::shared_ptr<memory::ScopedMemoryPool> scopedPool_{
+      memory::getDefaultScopedMemoryPool()};
+  memory::MemoryPool& pool_{*scopedPool_};
+  std::vector<std::unique_ptr<Writer>> writers_;
+};
+
+} // namespace
+
+TEST_F(FileMergerTest, merge) {
+  HiveTypeParser parser;
+  auto type = parser.parse(
+      "struct<a:bigint,b:string,c:map<int,double>,d:array<smallint>>");
+  auto config = std::make_shared<Config>();
+  config->set(Config::ROW_INDEX_STRIDE, 100u);
+
+  std::mt19937 gen{};
+  std::vector<std::vector<VectorPtr>> fileBatches(3);
+  std::vector<std::unique_ptr<ReaderBase>> readers;
+  for (auto i = 0; i < fileBatches.size(); ++i) {
+    for (auto j = 0; j <= i; ++j) {
+      fileBatches[i].push_back(BatchMaker::createBatch(type, 500, pool_, gen));
+    }
+    readers.push_back(makeReader(writeFile(type, fileBatches[i], config)));
+  }
+
+  auto output = std::make_unique<MemorySink>(pool_, 30 << 20);
+  auto outputPtr = output.get();
+  FileMerger merger{std::move(output), pool_};
+  for (auto& reader : readers) {
+    ASSERT_TRUE(merger.isCompatible(*reader));
+    merger.addFile(*reader);
+  }
+  merger.close();
+
+  ReaderOptions readerOpts;
+  RowReaderOptions rowReaderOpts;
+  DwrfReader reader{
+      readerOpts,
+      std::make_unique<MemoryInputStream>(
+          outputPtr->getData(), outputPtr->size())};
+  ASSERT_EQ(6, reader.getNumberOfStripes());
+  ASSERT_EQ(3'000, reader.getFooter().numberofrows());
+  uint64_t numValues = 0;
+  for (auto& fileReader : readers) {
+    numValues +=
+        fileReader->getColumnStatistics(1)->getNumberOfValues().value();
+  }
+  ASSERT_EQ(
+      numValues, reader.columnStatistics(1)->getNumberOfValues().value());
+
+  // The rows of the merged file are the rows of the inputs in order.
+  auto rowReader = reader.createRowReader(rowReaderOpts);
+  VectorPtr batch;
+  for (auto& batches : fileBatches) {
+    for (auto& expected : batches) {
+      ASSERT_TRUE(rowReader->next(expected->size(), batch));
+      ASSERT_EQ(expected->size(), batch->size());
+      for (auto row = 0; row < batch->size(); ++row) {
+        ASSERT_TRUE(expected->equalValueAt(batch.get(), row, row))
+            << "at " << row << ": " << expected->toString(row) << " vs. "
+            << batch->toString(row);
+      }
+    }
+  }
+  ASSERT_FALSE(rowReader->next(1, batch));
+}
+
+TEST_F(FileMergerTest, incompatible) {
+  HiveTypeParser parser;
+  auto type = parser.parse("struct<a:bigint,b:string>");
+  auto config = std::make_shared<Config>();
+  std::mt19937 gen{};
+  auto batch = BatchMaker::createBatch(type, 100, pool_, gen);
+  auto reader = makeReader(writeFile(type, {batch}, config));
+
+  auto otherType = parser.parse("struct<a:bigint,c:string>");
+  auto otherSchema = makeReader(writeFile(otherType, {batch}, config));
+
+  auto otherConfig = std::make_shared<Config>();
+  otherConfig->set(Config::COMPRESSION, CompressionKind::CompressionKind_NONE);
+  auto otherCompression = makeReader(writeFile(type, {batch}, otherConfig));
+
+  FileMerger merger{std::make_unique<MemorySink>(pool_, 1 << 20), pool_};
+  merger.addFile(*reader);
+  EXPECT_FALSE(merger.isCompatible(*otherSchema));
+  EXPECT_FALSE(merger.isCompatible(*otherCompression));
+  EXPECT_THROW(merger.addFile(*otherSchema), exception::LoggedException);
+  merger.close();
+}
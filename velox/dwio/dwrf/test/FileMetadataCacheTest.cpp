@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/dwio/dwrf/reader/FileMetadataCache.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox::dwrf;
+
+namespace {
+
+std::shared_ptr<FileTail> makeTail(int32_t numStripes) {
+  auto tail = std::make_shared<FileTail>();
+  tail->arena = std::make_unique<google::protobuf::Arena>();
+  auto footer =
+      google::protobuf::Arena::CreateMessage<proto::Footer>(tail->arena.get());
+  for (auto i = 0; i < numStripes; ++i) {
+    footer->add_stripes()->set_numberofrows(100);
+  }
+  tail->footer = footer;
+  tail->postScript = std::make_unique<proto::PostScript>();
+  tail->postScript->set_footerlength(10);
+  tail->psLength = 5;
+  return tail;
+}
+
+} // namespace
+
+TEST(FileMetadataCacheTest, tail) {
+  FileMetadataCache cache(1 << 20);
+  EXPECT_EQ(nullptr, cache.findTail(1, 1000));
+  cache.insertTail(1, 1000, makeTail(3));
+
+  auto tail = cache.findTail(1, 1000);
+  ASSERT_NE(nullptr, tail);
+  EXPECT_EQ(3, tail->footer->stripes_size());
+  EXPECT_EQ(10, tail->postScript->footerlength());
+  EXPECT_EQ(5, tail->psLength);
+
+  // A different length means the file was rewritten.
+  EXPECT_EQ(nullptr, cache.findTail(1, 2000));
+  EXPECT_EQ(nullptr, cache.findTail(2, 1000));
+  EXPECT_EQ(1, cache.numHits());
+  EXPECT_EQ(3, cache.numMisses());
+}
+
+TEST(FileMetadataCacheTest, stripeFooter) {
+  FileMetadataCache cache(1 << 20);
+  auto footer = std::make_shared<proto::StripeFooter>();
+  footer->add_streams()->set_length(123);
+  cache.insertStripeFooter(1, 1000, 2, footer);
+
+  EXPECT_EQ(nullptr, cache.findStripeFooter(1, 1000, 1));
+  EXPECT_EQ(nullptr, cache.findTail(1, 1000));
+  auto cached = cache.findStripeFooter(1, 1000, 2);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(123, cached->streams(0).length());
+}
+
+TEST(FileMetadataCacheTest, eviction) {
+  FileMetadataCache cache(10000);
+  cache.insertTail(1, 1000, makeTail(1));
+  auto first = cache.findTail(1, 1000);
+  ASSERT_NE(nullptr, first);
+
+  // Adding more than the budget drops the oldest entries. The tails that
+  // are referenced outside of the cache stay valid.
+  for (auto i = 2; i < 1000; ++i) {
+    cache.insertTail(i, 1000, makeTail(1));
+  }
+  EXPECT_EQ(nullptr, cache.findTail(1, 1000));
+  EXPECT_NE(nullptr, cache.findTail(999, 1000));
+  EXPECT_EQ(1, first->footer->stripes_size());
+}
+
+TEST(FileMetadataCacheTest, instance) {
+  EXPECT_EQ(nullptr, FileMetadataCache::getInstance());
+  FileMetadataCache cache(1 << 20);
+  FileMetadataCache::setInstance(&cache);
+  EXPECT_EQ(&cache, FileMetadataCache::getInstance());
+  FileMetadataCache::setInstance(nullptr);
+  EXPECT_EQ(nullptr, FileMetadataCache::getInstance());
+}
@@ -60,6 +60,33 @@ TEST(DefaultFlushPolicyTest, PredicateTest) {
   }
 }
 
+TEST(AdaptiveFlushPolicyTest, PredicateTest) {
+  AdaptiveFlushPolicy policy{200, 20, 0.25};
+  // Flushes on the same sizes as DefaultFlushPolicy.
+  EXPECT_FALSE(policy(40, 15, 0, 1000));
+  EXPECT_TRUE(policy(40, 21, 0, 1000));
+  EXPECT_TRUE(policy(400, 15, 0, 1000));
+  // Flushes small stripes when a flush would leave less than a quarter of the
+  // budget free.
+  EXPECT_FALSE(policy(40, 15, 750, 1000));
+  EXPECT_TRUE(policy(40, 15, 751, 1000));
+  EXPECT_FALSE(policy(
+      40,
+      15,
+      std::numeric_limits<int64_t>::max() / 2,
+      std::numeric_limits<int64_t>::max()));
+}
+
+TEST(AdaptiveFlushPolicyTest, ContextTest) {
+  AdaptiveFlushPolicy policy{1024, 1024};
+  auto config = std::make_shared<Config>();
+  WriterContext context{config, getDefaultScopedMemoryPool()};
+  EXPECT_FALSE(policy(false, context));
+  EXPECT_TRUE(policy(true, context));
+  context.stripeRawSize = 1024 * 1024;
+  EXPECT_TRUE(policy(false, context));
+}
+
 TEST(RowsPerStripeFlushPolicyTest, EmptyFile) {
   // Empty vector creation succeeds.
   RowsPerStripeFlushPolicy policy({});
@@ -47,6 +47,12 @@ std::vector<uint64_t> randomInts_u64;
 std::vector<uint64_t> randomInts_u64_result;
 std::vector<char> buffer_u64;
 
+// Mostly 1 and 2 byte varints, like lengths and small integers.
+static size_t len_short = 0;
+std::vector<uint64_t> randomInts_short;
+std::vector<uint64_t> randomInts_short_result;
+std::vector<char> buffer_short;
+
 uint64_t readVuLong(const char* buffer, size_t& len) {
   if (LIKELY(len >= folly::kMaxVarintLength64)) {
     const char* p = buffer;
@@ -873,6 +879,32 @@ BENCHMARK_RELATIVE(decodeNew_64) {
       randomInts_u64.size(), buffer_u64.data(), randomInts_u64_result.data());
 }
 
+BENCHMARK(decodeOld_short) {
+  size_t currentLen = len_short;
+  const size_t startingLen = len_short;
+  while (currentLen != 0) {
+    auto result = readVuLong(
+        buffer_short.data() + (startingLen - currentLen), currentLen);
+    folly::doNotOptimizeAway(result);
+  }
+}
+
+BENCHMARK_RELATIVE(decodeNew_short) {
+  readVuLongOptimized(
+      randomInts_short.size(),
+      buffer_short.data(),
+      randomInts_short_result.data());
+}
+
+BENCHMARK_RELATIVE(decodeBulkRead_short) {
+  auto decoder = IntDecoder<false>::createDirect(
+      std::make_unique<SeekableArrayInputStream>(
+          buffer_short.data(), len_short),
+      true,
+      sizeof(uint64_t));
+  decoder->bulkRead(randomInts_short.size(), randomInts_short_result.data());
+}
+
 int32_t main(int32_t argc, char* argv[]) {
   folly::init(&argc, &argv);
 
@@ -909,6 +941,19 @@ int32_t main(int32_t argc, char* argv[]) {
   randomInts_u64_result.resize(randomInts_u64.size());
   len_u64 = pos;
 
+  // Populate short varint buffer, 1 in 16 values is longer than 2 bytes.
+  buffer_short.resize(kNumElements);
+  pos = 0;
+  for (int32_t i = 0; i < 400000; i++) {
+    auto randomInt = folly::Random::rand32();
+    auto mask = randomInt % 16 == 0 ? 0xffffff : randomInt % 2 ? 0x3fff : 0x7f;
+    randomInts_short.push_back(folly::Random::rand32() & mask);
+    pos =
+        writeVulongToBuffer(randomInts_short.back(), buffer_short.data(), pos);
+  }
+  randomInts_short_result.resize(randomInts_short.size());
+  len_short = pos;
+
   folly::runBenchmarks();
   return 0;
 }
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fmt/format.h>
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <numeric>
+
+#include "velox/dwio/common/MemoryInputStream.h"
+#include "velox/dwio/common/ScanSpec.h"
+#include "velox/dwio/dwrf/reader/DwrfReader.h"
+#include "velox/dwio/dwrf/writer/Writer.h"
+#include "velox/type/Filter.h"
+#include "velox/type/Subfield.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+// Scans 1M rows of a DWRF file in memory with a range filter on a BIGINT
+// column and reads a payload column of a given shape for the passing rows.
+// The file is written with direct or dictionary encoding and a fraction of
+// null payloads. The payload is read eagerly, loaded from a LazyVector or
+// pushed into a ValueHook. Each benchmark counts one iteration per scanned
+// row, so that folly reports the time per row.
+
+using namespace facebook::velox;
+using namespace facebook::velox::dwrf;
+using namespace facebook::velox::common;
+
+using dwio::common::MemoryInputStream;
+using dwio::common::MemorySink;
+
+namespace {
+
+constexpr int32_t kNumBatches = 100;
+constexpr int32_t kRowsPerBatch = 10'000;
+constexpr int32_t kNumRows = kNumBatches * kRowsPerBatch;
+constexpr int32_t kNumDistinct = 1'000;
+
+enum class Payload {
+  kBigint,
+  // Strings that fit inline in a StringView.
+  kShortVarchar,
+  // 32 character strings.
+  kLongVarchar,
+  // ARRAY<BIGINT> of 0 to 4 elements.
+  kArray,
+  // ROW<BIGINT, VARCHAR> with short strings.
+  kStruct,
+};
+
+enum class Encoding { kDirect, kDictionary };
+
+enum class ReadMode {
+  // The payload is materialized by the reader.
+  kEager,
+  // The payload is a LazyVector loaded after the filter.
+  kLazy,
+  // The payload is a LazyVector whose values go to a ValueHook. Only for
+  // scalar payloads.
+  kHook,
+};
+
+// Sums the BIGINT values of a column.
+class SumHook : public ValueHook {
+ public:
+  void addValue(vector_size_t /*row*/, const void* value) override {
+    sum_ += *reinterpret_cast<const int64_t*>(value);
+  }
+
+  void addValues(
+      const vector_size_t* /*rows*/,
+      const void* values,
+      vector_size_t size,
+      uint8_t /*valueWidth*/) override {
+    auto typedValues = reinterpret_cast<const int64_t*>(values);
+    for (auto i = 0; i < size; ++i) {
+      sum_ += typedValues[i];
+    }
+  }
+
+  int64_t sum() const {
+    return sum_;
+  }
+
+ private:
+  int64_t sum_ = 0;
+};
+
+// Sums the lengths of the VARCHAR values of a column.
+class LengthHook : public ValueHook {
+ public:
+  void addValue(vector_size_t /*row*/, const void* value) override {
+    sum_ += reinterpret_cast<const folly::StringPiece*>(value)->size();
+  }
+
+  int64_t sum() const {
+    return sum_;
+  }
+
+ private:
+  int64_t sum_ = 0;
+};
+
+class SelectiveReaderBenchmark {
+ public:
+  SelectiveReaderBenchmark()
+      : pool_(memory::getDefaultScopedMemoryPool()), vectorMaker_(pool_.get()) {
+    for (auto i = 0; i < kNumDistinct; ++i) {
+      shortStrings_.push_back(fmt::format("s{}", i));
+      longStrings_.push_back(fmt::format("{:0>32}", i * 7'919));
+    }
+  }
+
+  // Scans the file for 'payload', 'encoding' and 'nullPct' with a filter
+  // that passes 'selectPct' percent of the rows and returns the number of
+  // scanned rows.
+  unsigned run(
+      Payload payload,
+      Encoding encoding,
+      int32_t nullPct,
+      int32_t selectPct,
+      ReadMode mode) {
+    folly::BenchmarkSuspender suspender;
+    prepare(payload, encoding, nullPct);
+    auto spec = makeScanSpec(selectPct, mode != ReadMode::kEager);
+    suspender.dismiss();
+
+    auto input =
+        std::make_unique<MemoryInputStream>(sink_->getData(), sink_->size());
+    dwio::common::ReaderOptions readerOpts;
+    dwio::common::RowReaderOptions rowReaderOpts;
+    auto reader = std::make_unique<DwrfReader>(readerOpts, std::move(input));
+    // The spec must stay live over the lifetime of the reader.
+    rowReaderOpts.setScanSpec(spec.get());
+    auto rowReader = reader->createRowReader(rowReaderOpts);
+    auto batch = BaseVector::create(rowType_, 1, pool_.get());
+    int64_t checksum = 0;
+    while (rowReader->next(kRowsPerBatch, batch)) {
+      if (batch->size() == 0) {
+        continue;
+      }
+      auto rowVector = batch->asUnchecked<RowVector>();
+      if (mode == ReadMode::kHook) {
+        checksum += loadWithHook(rowVector->childAt(1));
+      } else {
+        checksum += rowVector->loadedChildAt(1)->size();
+      }
+    }
+    folly::doNotOptimizeAway(checksum);
+    return kNumRows;
+  }
+
+ private:
+  // Writes the file for 'payload', 'encoding' and 'nullPct' unless it is
+  // the file of the previous run.
+  void prepare(Payload payload, Encoding encoding, int32_t nullPct) {
+    auto key = fmt::format(
+        "{}-{}-{}",
+        static_cast<int32_t>(payload),
+        static_cast<int32_t>(encoding),
+        nullPct);
+    if (key == dataKey_) {
+      return;
+    }
+    dataKey_ = key;
+    std::vector<RowVectorPtr> batches;
+    for (auto i = 0; i < kNumBatches; ++i) {
+      batches.push_back(makeBatch(payload, nullPct, i * kRowsPerBatch));
+    }
+    rowType_ = batches[0]->type();
+
+    auto config = std::make_shared<Config>();
+    config->set(Config::COMPRESSION, CompressionKind_NONE);
+    // A threshold of 0 turns off dictionaries and 1 keeps them for the
+    // 1000 distinct values of the payloads.
+    float threshold = encoding == Encoding::kDictionary ? 1.0 : 0.0;
+    config->set(Config::DICTIONARY_NUMERIC_KEY_SIZE_THRESHOLD, threshold);
+    config->set(Config::DICTIONARY_STRING_KEY_SIZE_THRESHOLD, threshold);
+    WriterOptions options;
+    options.config = config;
+    options.schema = rowType_;
+    auto sink = std::make_unique<MemorySink>(*pool_, 200 * 1024 * 1024);
+    sink_ = sink.get();
+    writer_ = std::make_unique<Writer>(options, std::move(sink), *pool_);
+    for (auto& batch : batches) {
+      writer_->write(batch);
+    }
+    writer_->close();
+  }
+
+  // Makes a batch of a filter column c0 with uniform values in [0, 1000)
+  // and a payload column c1 with 'nullPct' percent nulls.
+  RowVectorPtr makeBatch(Payload payload, int32_t nullPct, int32_t offset) {
+    auto value = [offset](vector_size_t row) -> int64_t {
+      return (int64_t{offset} + row) * 7'919 % kNumDistinct;
+    };
+    auto isNull = [nullPct, offset](vector_size_t row) {
+      return (int64_t{offset} + row) * 31 % 100 < nullPct;
+    };
+    auto filterColumn = vectorMaker_.flatVector<int64_t>(
+        kRowsPerBatch, [offset](vector_size_t row) -> int64_t {
+          return (int64_t{offset} + row) * 104'729 % kNumDistinct;
+        });
+    auto shortString = [&](vector_size_t row) {
+      return StringView(shortStrings_[value(row)]);
+    };
+    VectorPtr payloadColumn;
+    switch (payload) {
+      case Payload::kBigint:
+        payloadColumn = vectorMaker_.flatVector<int64_t>(
+            kRowsPerBatch, value, isNull);
+        break;
+      case Payload::kShortVarchar:
+        payloadColumn = vectorMaker_.flatVector<StringView>(
+            kRowsPerBatch, shortString, isNull);
+        break;
+      case Payload::kLongVarchar:
+        payloadColumn = vectorMaker_.flatVector<StringView>(
+            kRowsPerBatch,
+            [&](vector_size_t row) {
+              return StringView(longStrings_[value(row)]);
+            },
+            isNull);
+        break;
+      case Payload::kArray:
+        payloadColumn = vectorMaker_.arrayVector<int64_t>(
+            kRowsPerBatch,
+            [&](vector_size_t row) { return value(row) % 5; },
+            [](vector_size_t index) { return index % kNumDistinct; },
+            isNull);
+        break;
+      case Payload::kStruct:
+        payloadColumn = vectorMaker_.rowVector(
+            {"s0", "s1"},
+            {vectorMaker_.flatVector<int64_t>(kRowsPerBatch, value, isNull),
+             vectorMaker_.flatVector<StringView>(
+                 kRowsPerBatch, shortString, isNull)});
+        break;
+    }
+    return vectorMaker_.rowVector({"c0", "c1"}, {filterColumn, payloadColumn});
+  }
+
+  // Projects out c0 and c1 with a filter on c0 that passes 'selectPct'
+  // percent of the rows. If 'lazy' is true, c1 is produced as a LazyVector.
+  std::unique_ptr<ScanSpec> makeScanSpec(int32_t selectPct, bool lazy) {
+    auto spec = std::make_unique<ScanSpec>("root");
+    makeFieldSpecs("", 0, rowType_, spec.get());
+    auto filterSpec = spec->getOrCreateChild(Subfield("c0"));
+    filterSpec->setFilter(std::make_unique<BigintRange>(
+        0, kNumDistinct * selectPct / 100 - 1, false));
+    if (lazy) {
+      spec->getOrCreateChild(Subfield("c1"))->setExtractValues(false);
+    }
+    return spec;
+  }
+
+  static void makeFieldSpecs(
+      const std::string& pathPrefix,
+      int32_t level,
+      const TypePtr& type,
+      ScanSpec* spec) {
+    switch (type->kind()) {
+      case TypeKind::ROW: {
+        auto rowType = dynamic_cast<const RowType*>(type.get());
+        for (auto i = 0; i < type->size(); ++i) {
+          auto path = level == 0 ? rowType->nameOf(i)
+                                 : pathPrefix + "." + rowType->nameOf(i);
+          auto fieldSpec = spec->getOrCreateChild(Subfield(path));
+          fieldSpec->setProjectOut(true);
+          fieldSpec->setExtractValues(true);
+          fieldSpec->setChannel(i);
+          makeFieldSpecs(path, level + 1, type->childAt(i), spec);
+        }
+        break;
+      }
+      case TypeKind::ARRAY: {
+        auto path = pathPrefix + ".elements";
+        auto childSpec = spec->getOrCreateChild(Subfield(path));
+        childSpec->setProjectOut(true);
+        childSpec->setExtractValues(true);
+        makeFieldSpecs(path, level + 1, type->childAt(0), spec);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  // Loads all rows of the LazyVector 'child' into a hook and returns the
+  // sum the hook computes.
+  int64_t loadWithHook(const VectorPtr& child) {
+    VELOX_CHECK_EQ(child->encoding(), VectorEncoding::Simple::LAZY);
+    rows_.resize(child->size());
+    std::iota(rows_.begin(), rows_.end(), 0);
+    if (child->typeKind() == TypeKind::BIGINT) {
+      SumHook hook;
+      child->as<LazyVector>()->load(rows_, &hook);
+      return hook.sum();
+    }
+    VELOX_CHECK_EQ(child->typeKind(), TypeKind::VARCHAR);
+    LengthHook hook;
+    child->as<LazyVector>()->load(rows_, &hook);
+    return hook.sum();
+  }
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  test::VectorMaker vectorMaker_;
+  std::vector<std::string> shortStrings_;
+  std::vector<std::string> longStrings_;
+  // Identifies the payload, encoding and null ratio of the file in 'sink_'.
+  std::string dataKey_;
+  TypePtr rowType_;
+  std::unique_ptr<Writer> writer_;
+  // Owned by 'writer_'.
+  MemorySink* sink_{nullptr};
+  std::vector<vector_size_t> rows_;
+};
+
+std::unique_ptr<SelectiveReaderBenchmark> benchmark;
+
+unsigned scan(
+    unsigned /*iters*/,
+    Payload payload,
+    Encoding encoding,
+    int32_t nullPct,
+    int32_t selectPct,
+    ReadMode mode) {
+  return benchmark->run(payload, encoding, nullPct, selectPct, mode);
+}
+
+#define SCAN_BENCHMARK(name, payload, encoding, nullPct, selectPct, mode) \
+  BENCHMARK_NAMED_PARAM_MULTI(                                            \
+      scan,                                                               \
+      name,                                                               \
+      Payload::payload,                                                   \
+      Encoding::encoding,                                                 \
+      nullPct,                                                            \
+      selectPct,                                                          \
+      ReadMode::mode)
+
+// Selectivity and read mode over a direct BIGINT payload.
+SCAN_BENCHMARK(BIGINT_100_EAGER, kBigint, kDirect, 0, 100, kEager);
+SCAN_BENCHMARK(BIGINT_50_EAGER, kBigint, kDirect, 0, 50, kEager);
+SCAN_BENCHMARK(BIGINT_10_EAGER, kBigint, kDirect, 0, 10, kEager);
+SCAN_BENCHMARK(BIGINT_1_EAGER, kBigint, kDirect, 0, 1, kEager);
+SCAN_BENCHMARK(BIGINT_100_LAZY, kBigint, kDirect, 0, 100, kLazy);
+SCAN_BENCHMARK(BIGINT_10_LAZY, kBigint, kDirect, 0, 10, kLazy);
+SCAN_BENCHMARK(BIGINT_1_LAZY, kBigint, kDirect, 0, 1, kLazy);
+SCAN_BENCHMARK(BIGINT_100_HOOK, kBigint, kDirect, 0, 100, kHook);
+SCAN_BENCHMARK(BIGINT_10_HOOK, kBigint, kDirect, 0, 10, kHook);
+SCAN_BENCHMARK(BIGINT_1_HOOK, kBigint, kDirect, 0, 1, kHook);
+BENCHMARK_DRAW_LINE();
+
+// Nulls and dictionary encoding.
+SCAN_BENCHMARK(BIGINT_NULLS_10_EAGER, kBigint, kDirect, 20, 10, kEager);
+SCAN_BENCHMARK(BIGINT_NULLS_10_HOOK, kBigint, kDirect, 20, 10, kHook);
+SCAN_BENCHMARK(BIGINT_DICT_100_EAGER, kBigint, kDictionary, 0, 100, kEager);
+SCAN_BENCHMARK(BIGINT_DICT_10_EAGER, kBigint, kDictionary, 0, 10, kEager);
+SCAN_BENCHMARK(BIGINT_DICT_10_HOOK, kBigint, kDictionary, 0, 10, kHook);
+BENCHMARK_DRAW_LINE();
+
+// String lengths and encodings.
+SCAN_BENCHMARK(SHORT_100_EAGER, kShortVarchar, kDirect, 0, 100, kEager);
+SCAN_BENCHMARK(SHORT_10_EAGER, kShortVarchar, kDirect, 0, 10, kEager);
+SCAN_BENCHMARK(SHORT_10_HOOK, kShortVarchar, kDirect, 0, 10, kHook);
+SCAN_BENCHMARK(LONG_100_EAGER, kLongVarchar, kDirect, 0, 100, kEager);
+SCAN_BENCHMARK(LONG_10_EAGER, kLongVarchar, kDirect, 0, 10, kEager);
+SCAN_BENCHMARK(LONG_10_LAZY, kLongVarchar, kDirect, 0, 10, kLazy);
+SCAN_BENCHMARK(LONG_10_HOOK, kLongVarchar, kDirect, 0, 10, kHook);
+SCAN_BENCHMARK(LONG_NULLS_10_EAGER, kLongVarchar, kDirect, 20, 10, kEager);
+SCAN_BENCHMARK(LONG_DICT_100_EAGER, kLongVarchar, kDictionary, 0, 100, kEager);
+SCAN_BENCHMARK(LONG_DICT_10_EAGER, kLongVarchar, kDictionary, 0, 10, kEager);
+SCAN_BENCHMARK(LONG_DICT_10_HOOK, kLongVarchar, kDictionary, 0, 10, kHook);
+BENCHMARK_DRAW_LINE();
+
+// Nested payloads.
+SCAN_BENCHMARK(ARRAY_100_EAGER, kArray, kDirect, 0, 100, kEager);
+SCAN_BENCHMARK(ARRAY_10_EAGER, kArray, kDirect, 0, 10, kEager);
+SCAN_BENCHMARK(ARRAY_10_LAZY, kArray, kDirect, 0, 10, kLazy);
+SCAN_BENCHMARK(ARRAY_NULLS_10_EAGER, kArray, kDirect, 20, 10, kEager);
+SCAN_BENCHMARK(STRUCT_100_EAGER, kStruct, kDirect, 0, 100, kEager);
+SCAN_BENCHMARK(STRUCT_10_EAGER, kStruct, kDirect, 0, 10, kEager);
+SCAN_BENCHMARK(STRUCT_10_LAZY, kStruct, kDirect, 0, 10, kLazy);
+SCAN_BENCHMARK(STRUCT_DICT_10_EAGER, kStruct, kDictionary, 0, 10, kEager);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  benchmark = std::make_unique<SelectiveReaderBenchmark>();
+  folly::runBenchmarks();
+  benchmark.reset();
+  return 0;
+}
@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 #include "velox/dwio/common/MemoryInputStream.h"
 #include "velox/dwio/dwrf/common/BufferedInput.h"
+#include "velox/dwio/dwrf/common/MappedBufferedInput.h"
 
 using namespace facebook::velox::dwio::common;
 using namespace facebook::velox::dwrf;
@@ -33,3 +34,32 @@ TEST(TestBufferedInput, ZeroLengthStream) {
   EXPECT_FALSE(ret->Next(&buf, &size));
   EXPECT_EQ(size, 0);
 }
+
+TEST(TestBufferedInput, mapped) {
+  std::string data = "aaaaabbbbbccccc";
+  facebook::velox::InMemoryReadFile file(data);
+  ReadFileInputStream stream(&file);
+  auto scopedPool = facebook::velox::memory::getDefaultScopedMemoryPool();
+  auto& pool = scopedPool->getPool();
+  MappedBufferedInputFactory factory;
+  auto input = factory.create(stream, pool);
+  ASSERT_NE(dynamic_cast<MappedBufferedInput*>(input.get()), nullptr);
+  auto enqueued = input->enqueue({5, 5});
+  input->load(LogType::TEST);
+  const void* buf = nullptr;
+  int32_t size = 0;
+  ASSERT_TRUE(enqueued->Next(&buf, &size));
+  // The stream is a view of the file's memory.
+  EXPECT_EQ(data.data() + 5, buf);
+  EXPECT_EQ(5, size);
+  EXPECT_TRUE(input->isBuffered(10, 5));
+  EXPECT_FALSE(input->isBuffered(10, 6));
+  auto read = input->read(10, 5, LogType::TEST);
+  ASSERT_TRUE(read->Next(&buf, &size));
+  EXPECT_EQ("ccccc", std::string_view(static_cast<const char*>(buf), size));
+
+  // Inputs without mapped data get a plain BufferedInput.
+  MemoryInputStream memoryStream{data.data(), data.size()};
+  input = factory.create(memoryStream, pool);
+  EXPECT_EQ(dynamic_cast<MappedBufferedInput*>(input.get()), nullptr);
+}
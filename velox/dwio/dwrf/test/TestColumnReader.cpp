@@ -3176,10 +3176,6 @@ TEST_P(TestColumnReader, testDoubleSkipWithNulls) {
 }
 
 TEST_P(TestColumnReader, testTimestampSkipWithNulls) {
-  if (useSelectiveReader()) {
-    GTEST_SKIP() << "SelectiveColumnReader doesn't support timestamps yet";
-  }
-
   // set getEncoding
   proto::ColumnEncoding directEncoding;
   directEncoding.set_kind(proto::ColumnEncoding_Kind_DIRECT);
@@ -3285,10 +3281,6 @@ TEST_P(TestColumnReader, testTimestampSkipWithNulls) {
 }
 
 TEST_P(TestColumnReader, testTimestamp) {
-  if (useSelectiveReader()) {
-    GTEST_SKIP() << "SelectiveColumnReader doesn't support timestamps yet";
-  }
-
   // set getEncoding
   proto::ColumnEncoding directEncoding;
   directEncoding.set_kind(proto::ColumnEncoding_Kind_DIRECT);
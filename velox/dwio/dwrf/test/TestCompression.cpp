@@ -20,7 +20,9 @@
 #include "velox/dwio/dwrf/common/wrap/dwrf-proto-wrapper.h"
 #include "velox/dwio/dwrf/test/OrcTest.h"
 
+#include <fmt/format.h>
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <gtest/gtest.h>
 
 #include <algorithm>
@@ -74,7 +76,9 @@ void decompressAndVerify(
     const char* data,
     size_t size,
     MemoryPool& pool,
-    const Decrypter* decrypter) {
+    const Decrypter* decrypter,
+    folly::Executor* executor = nullptr,
+    const ZstdDecompressionDictionaries* zstdDictionaries = nullptr) {
   std::unique_ptr<SeekableInputStream> inputStream(
       new SeekableArrayInputStream(memSink.getData(), memSink.size()));
 
@@ -84,7 +88,9 @@ void decompressAndVerify(
       blockSize,
       pool,
       "Test Comrpession",
-      decrypter);
+      decrypter,
+      executor,
+      zstdDictionaries);
 
   const char* decompressedBuffer;
   int32_t decompressedSize;
@@ -107,14 +113,15 @@ void compressAndVerify(
     MemoryPool& pool,
     const char* data,
     size_t dataSize,
-    const Encrypter* encrypter) {
+    const Encrypter* encrypter,
+    std::shared_ptr<ZstdStreamState> zstdState = nullptr) {
   TestBufferPool bufferPool(pool, block);
   DataBufferHolder holder{
       pool, block, 0, DEFAULT_PAGE_GROW_RATIO, std::addressof(sink)};
   Config config;
   config.set<uint32_t>(Config::COMPRESSION_THRESHOLD, 128);
-  std::unique_ptr<BufferedOutputStream> compressStream =
-      createCompressor(kind, bufferPool, holder, config, encrypter);
+  std::unique_ptr<BufferedOutputStream> compressStream = createCompressor(
+      kind, bufferPool, holder, config, encrypter, std::move(zstdState));
 
   size_t pos = 0;
   char* compressBuffer;
@@ -237,6 +244,31 @@ TEST_P(CompressionTest, compressRandomBytes) {
       memSink, kind_, block, testData, dataSize, pool, decrypter_);
 }
 
+TEST_P(CompressionTest, readAhead) {
+  auto scopedPool = getDefaultScopedMemoryPool();
+  auto& pool = scopedPool->getPool();
+  MemorySink memSink(pool, DEFAULT_MEM_STREAM_SIZE);
+
+  uint64_t block = 1024;
+  constexpr size_t dataSize = 256 * 1024;
+
+  // Blocks are decrypted and decompressed on the executor.
+  std::vector<char> testData(dataSize);
+  generateRandomData(testData.data(), dataSize, true);
+  compressAndVerify(
+      kind_, memSink, block, pool, testData.data(), dataSize, encrypter_);
+  folly::CPUThreadPoolExecutor executor(4);
+  decompressAndVerify(
+      memSink,
+      kind_,
+      block,
+      testData.data(),
+      dataSize,
+      pool,
+      decrypter_,
+      &executor);
+}
+
 void verifyProto(
     const MemorySink& memSink,
     CompressionKind kind,
@@ -388,3 +420,140 @@ VELOX_INSTANTIATE_TEST_SUITE_P(
         std::make_tuple(CompressionKind_ZSTD, nullptr),
         std::make_tuple(CompressionKind_ZSTD, &testEncrypter),
         std::make_tuple(CompressionKind_NONE, &testEncrypter)));
+
+namespace {
+
+// Text with repeated structure, as in the string streams of a column.
+std::string makeRecords(int32_t numRecords) {
+  std::string data;
+  for (auto i = 0; i < numRecords; ++i) {
+    data += fmt::format(
+        "{{\"user\": \"user_{}\", \"country\": \"{}\", \"score\": {}}}",
+        folly::Random::rand32(100'000),
+        i % 3 == 0 ? "US" : "DE",
+        folly::Random::rand32(1'000));
+  }
+  return data;
+}
+
+} // namespace
+
+TEST(ZstdDictionaryTest, trainAndDecompress) {
+  auto scopedPool = getDefaultScopedMemoryPool();
+  auto& pool = scopedPool->getPool();
+  constexpr uint64_t block = 4096;
+
+  auto dictionary = std::make_shared<ZstdDictionary>(4096, 1 << 20);
+  auto state = std::make_shared<ZstdStreamState>(3, dictionary);
+
+  // The first stripe adds samples and is compressed without the dictionary.
+  auto first = makeRecords(20'000);
+  MemorySink firstSink(pool, DEFAULT_MEM_STREAM_SIZE);
+  compressAndVerify(
+      CompressionKind_ZSTD,
+      firstSink,
+      block,
+      pool,
+      first.data(),
+      first.size(),
+      nullptr,
+      state);
+  auto [rawSize, compressedSize] = state->takeBlockSizes();
+  EXPECT_GT(rawSize, first.size() - block);
+  EXPECT_LT(compressedSize, rawSize);
+  EXPECT_EQ(state->takeBlockSizes(), std::make_pair(0UL, 0UL));
+  decompressAndVerify(
+      firstSink,
+      CompressionKind_ZSTD,
+      block,
+      first.data(),
+      first.size(),
+      pool,
+      nullptr);
+
+  ASSERT_TRUE(dictionary->train());
+  EXPECT_FALSE(dictionary->isActive());
+  dictionary->activate();
+  EXPECT_NE(dictionary->id(), 0);
+  EXPECT_LE(dictionary->bytes().size(), 4096);
+
+  auto second = makeRecords(5'000);
+  MemorySink secondSink(pool, DEFAULT_MEM_STREAM_SIZE);
+  compressAndVerify(
+      CompressionKind_ZSTD,
+      secondSink,
+      block,
+      pool,
+      second.data(),
+      second.size(),
+      nullptr,
+      state);
+  // A quarter of the data in blocks of the same size compresses better.
+  EXPECT_LT(state->takeBlockSizes().second, compressedSize / 4);
+
+  ZstdDecompressionDictionaries dictionaries;
+  EXPECT_TRUE(dictionaries.empty());
+  dictionaries.add(dictionary->bytes());
+  EXPECT_NE(dictionaries.find(dictionary->id()), nullptr);
+  EXPECT_EQ(dictionaries.find(dictionary->id() + 1), nullptr);
+  decompressAndVerify(
+      secondSink,
+      CompressionKind_ZSTD,
+      block,
+      second.data(),
+      second.size(),
+      pool,
+      nullptr,
+      nullptr,
+      &dictionaries);
+  VELOX_ASSERT_THROW(
+      decompressAndVerify(
+          secondSink,
+          CompressionKind_ZSTD,
+          block,
+          second.data(),
+          second.size(),
+          pool,
+          nullptr),
+      "Missing ZSTD dictionary");
+}
+
+TEST(ZstdDictionaryTest, tooFewSamples) {
+  ZstdDictionary dictionary(4096, 1 << 20);
+  std::string sample = "hello world";
+  dictionary.addSample(sample.data(), sample.size());
+  EXPECT_FALSE(dictionary.train());
+  EXPECT_FALSE(dictionary.isActive());
+  EXPECT_TRUE(dictionary.bytes().empty());
+}
+
+TEST(ZstdDictionaryTest, levelChange) {
+  auto scopedPool = getDefaultScopedMemoryPool();
+  auto& pool = scopedPool->getPool();
+  constexpr uint64_t block = 4096;
+  auto state = std::make_shared<ZstdStreamState>(19, nullptr);
+
+  // The level may change between stripes of the same stream.
+  auto data = makeRecords(2'000);
+  for (auto level : {19, 1, 7}) {
+    state->setLevel(level);
+    MemorySink sink(pool, DEFAULT_MEM_STREAM_SIZE);
+    compressAndVerify(
+        CompressionKind_ZSTD,
+        sink,
+        block,
+        pool,
+        data.data(),
+        data.size(),
+        nullptr,
+        state);
+    decompressAndVerify(
+        sink,
+        CompressionKind_ZSTD,
+        block,
+        data.data(),
+        data.size(),
+        pool,
+        nullptr);
+  }
+}
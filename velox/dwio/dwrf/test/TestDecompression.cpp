@@ -15,6 +15,7 @@
  */
 
 #include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <folly/String.h>
 #include <folly/compression/Compression.h>
 #include <folly/compression/Zlib.h>
@@ -797,7 +798,10 @@ compress(char* buf, size_t size, char* output, size_t offset, Codec& codec) {
 class TestSeek : public ::testing::Test {
  public:
   ~TestSeek() override {}
-  static void runTest(Codec& codec, CompressionKind kind) {
+  static void runTest(
+      Codec& codec,
+      CompressionKind kind,
+      folly::Executor* executor = nullptr) {
     constexpr size_t inputSize = 1024;
     constexpr size_t outputSize = 4096;
     char output[outputSize];
@@ -816,7 +820,8 @@ class TestSeek : public ::testing::Test {
         outputSize,
         pool,
         "TestSeek Decompressor",
-        nullptr);
+        nullptr,
+        executor);
 
     const void* data;
     int32_t size;
@@ -869,3 +874,68 @@ TEST_F(TestSeek, Snappy) {
   auto codec = getCodec(CodecType::SNAPPY);
   runTest(*codec, CompressionKind_SNAPPY);
 }
+
+TEST_F(TestSeek, readAhead) {
+  folly::CPUThreadPoolExecutor executor(4);
+  auto zstd = getCodec(CodecType::ZSTD);
+  runTest(*zstd, CompressionKind_ZSTD, &executor);
+  auto snappy = getCodec(CodecType::SNAPPY);
+  runTest(*snappy, CompressionKind_SNAPPY, &executor);
+}
+
+TEST(TestDecompression, readAheadManyBlocks) {
+  constexpr size_t kBlockSize = 1000;
+  constexpr int32_t kNumBlocks = 20;
+  std::vector<char> input(kBlockSize * kNumBlocks);
+  fillInput(input.data(), input.size());
+  // Every fifth block is stored uncompressed.
+  auto codec = getCodec(CodecType::ZSTD);
+  std::vector<char> file(input.size() * 2);
+  std::vector<uint64_t> blockOffsets;
+  size_t offset = 0;
+  for (auto i = 0; i < kNumBlocks; ++i) {
+    blockOffsets.push_back(offset);
+    auto block = input.data() + i * kBlockSize;
+    if (i % 5 == 4) {
+      writeHeader(file.data() + offset, kBlockSize, true);
+      memcpy(file.data() + offset + 3, block, kBlockSize);
+      offset += kBlockSize + 3;
+    } else {
+      offset = compress(block, kBlockSize, file.data(), offset, *codec);
+    }
+  }
+
+  auto scopedPool = getDefaultScopedMemoryPool();
+  folly::CPUThreadPoolExecutor executor(4);
+  // Reads the input in small pieces so that blocks span several of them.
+  auto stream = createDecompressor(
+      CompressionKind_ZSTD,
+      std::make_unique<SeekableArrayInputStream>(file.data(), offset, 300),
+      kBlockSize,
+      scopedPool->getPool(),
+      "readAheadManyBlocks",
+      nullptr,
+      &executor);
+
+  const void* data;
+  int32_t size;
+  for (auto i = 0; i < kNumBlocks; ++i) {
+    ASSERT_TRUE(stream->Next(&data, &size));
+    ASSERT_EQ(kBlockSize, size);
+    EXPECT_EQ(0, memcmp(data, input.data() + i * kBlockSize, size));
+  }
+  EXPECT_FALSE(stream->Next(&data, &size));
+
+  // Seeks across blocks and within a block with read ahead in flight.
+  for (auto i : {3, 4, 0, 12, 13, 19, 7, 7}) {
+    std::vector<uint64_t> positions{blockOffsets[i], 10};
+    PositionProvider provider(positions);
+    stream->seekToRowGroup(provider);
+    ASSERT_TRUE(stream->Next(&data, &size));
+    ASSERT_EQ(kBlockSize - 10, size);
+    EXPECT_EQ(0, memcmp(data, input.data() + i * kBlockSize + 10, size));
+  }
+  // Destroys the stream while blocks are being decompressed.
+  stream.reset();
+  executor.join();
+}
@@ -193,6 +193,26 @@ TEST(TestDirect, vIntUnsignedLong) {
   });
 }
 
+TEST(TestDirect, vIntShort) {
+  folly::Random::DefaultGenerator rng;
+  rng.seed(3);
+  int32_t count = 0;
+  // Mostly 1 and 2 byte varints, which are bulk decoded 8 bytes at a time,
+  // with runs of longer ones in between.
+  testInts<int64_t, false, true>([&]() -> int64_t {
+    auto mod = ++count % 64;
+    auto numBytes = mod < 30 ? 1 : mod < 55 ? 2 : mod % 9 + 1;
+    return folly::Random::rand64(rng) & ((1UL << (7 * numBytes)) - 1);
+  });
+  count = 0;
+  testInts<int64_t, true, true>([&]() -> int64_t {
+    auto mod = ++count % 64;
+    auto numBytes = mod < 40 ? 1 : mod < 60 ? 2 : 3;
+    auto value = folly::Random::rand64(rng) & ((1UL << (7 * numBytes - 1)) - 1);
+    return folly::Random::rand32(rng) & 1 ? -value : value;
+  });
+}
+
 template <bool isSigned>
 void testCorruptedVarInts() {
   std::vector<uint8_t> invalidInt{
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <folly/Random.h>
 #include "velox/common/base/Nulls.h"
 #include "velox/dwio/dwrf/common/Compression.h"
 #include "velox/dwio/dwrf/common/IntDecoder.h"
@@ -662,6 +663,146 @@ TEST(RLEv2, bitsLeftByPreviousStream) {
   }
 };
 
+// Returns the 5 bit code of 'width' in the header of a DIRECT run.
+uint32_t encodeBitWidth(uint32_t width) {
+  if (width <= 24) {
+    return width - 1;
+  }
+  switch (width) {
+    case 26:
+      return 24;
+    case 28:
+      return 25;
+    case 30:
+      return 26;
+    case 32:
+      return 27;
+    case 40:
+      return 28;
+    case 48:
+      return 29;
+    case 56:
+      return 30;
+    default:
+      return 31;
+  }
+}
+
+// Appends a DIRECT run of 'values' bit packed in 'width' bits to 'bytes'.
+void appendDirectRun(
+    const std::vector<uint64_t>& values,
+    uint32_t width,
+    std::vector<unsigned char>& bytes) {
+  auto length = values.size() - 1;
+  bytes.push_back(0x40 | (encodeBitWidth(width) << 1) | (length >> 8));
+  bytes.push_back(length & 0xff);
+  uint32_t numBits = 0;
+  unsigned char current = 0;
+  for (auto value : values) {
+    for (int32_t bit = width - 1; bit >= 0; --bit) {
+      current = (current << 1) | ((value >> bit) & 1);
+      if (++numBits == 8) {
+        bytes.push_back(current);
+        current = 0;
+        numBits = 0;
+      }
+    }
+  }
+  if (numBits) {
+    bytes.push_back(current << (8 - numBits));
+  }
+}
+
+TEST(RLEv2, directAllWidths) {
+  auto scopedPool = memory::getDefaultScopedMemoryPool();
+  folly::Random::DefaultGenerator rng;
+  rng.seed(1);
+  std::vector<uint32_t> widths;
+  for (uint32_t width = 1; width <= 24; ++width) {
+    widths.push_back(width);
+  }
+  for (uint32_t width : {26, 28, 30, 32, 40, 48, 56, 64}) {
+    widths.push_back(width);
+  }
+  for (auto width : widths) {
+    // Two runs of lengths that leave the first run partially filling its
+    // last byte.
+    std::vector<unsigned char> bytes;
+    std::vector<uint64_t> expected;
+    for (auto length : {501, 403}) {
+      std::vector<uint64_t> values;
+      for (auto i = 0; i < length; ++i) {
+        values.push_back(folly::Random::rand64(rng) >> (64 - width));
+      }
+      appendDirectRun(values, width, bytes);
+      expected.insert(expected.end(), values.begin(), values.end());
+    }
+    auto makeDecoder = [&](uint64_t blockSize) {
+      return IntDecoder<false>::createRle(
+          std::make_unique<SeekableArrayInputStream>(
+              bytes.data(), bytes.size(), blockSize),
+          RleVersion_2,
+          *scopedPool,
+          true /* doesn't matter */,
+          INT_BYTE_SIZE /* doesn't matter */);
+    };
+
+    // Reads in batches, with and without buffer boundaries inside runs.
+    for (auto blockSize : {0, 100}) {
+      for (auto batch : {1, 7, 1000}) {
+        auto rle = makeDecoder(blockSize);
+        std::vector<int64_t> data(expected.size());
+        for (size_t i = 0; i < data.size(); i += batch) {
+          rle->next(
+              data.data() + i, std::min<size_t>(batch, data.size() - i), 0);
+        }
+        for (size_t i = 0; i < data.size(); ++i) {
+          ASSERT_EQ(expected[i], data[i]) << "width " << width << " at " << i;
+        }
+      }
+    }
+
+    // Alternates skips, which jump over the packed bits, and reads.
+    auto rle = makeDecoder(100);
+    size_t row = 0;
+    int32_t skip = 0;
+    for (;;) {
+      skip = (skip * 3 + 1) % 37;
+      if (row + skip >= expected.size()) {
+        break;
+      }
+      rle->skip(skip);
+      row += skip;
+      int64_t value;
+      rle->next(&value, 1, nullptr);
+      ASSERT_EQ(expected[row], value) << "width " << width << " at " << row;
+      ++row;
+    }
+  }
+}
+
+TEST(RLEv2, skipFixedDelta) {
+  auto scopedPool = memory::getDefaultScopedMemoryPool();
+  // 0 to 19 with a fixed delta of 1, then 0x42 repeated 3 times.
+  const unsigned char bytes[] = {0xc0, 0x13, 0x00, 0x02, 0x00, 0x84};
+  std::unique_ptr<IntDecoder<true>> rle = IntDecoder<true>::createRle(
+      std::make_unique<SeekableArrayInputStream>(bytes, sizeof(bytes)),
+      RleVersion_2,
+      *scopedPool,
+      true /* doesn't matter */,
+      INT_BYTE_SIZE /* doesn't matter */);
+  int64_t value;
+  rle->skip(5);
+  rle->next(&value, 1, nullptr);
+  EXPECT_EQ(5, value);
+  rle->skip(10);
+  rle->next(&value, 1, nullptr);
+  EXPECT_EQ(16, value);
+  rle->skip(4);
+  rle->next(&value, 1, nullptr);
+  EXPECT_EQ(0x42, value);
+}
+
 TEST(RLEv1, simpleTest) {
   auto scopedPool = memory::getDefaultScopedMemoryPool();
   const unsigned char buffer[] = {
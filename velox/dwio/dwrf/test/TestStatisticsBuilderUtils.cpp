@@ -309,3 +309,64 @@ TEST(TestStatisticsBuilderUtils, addBinaryValues) {
     EXPECT_EQ(106, binStats->getTotalLength().value());
   }
 }
+
+TEST(TestStatisticsBuilderUtils, addBatchMatchesAddValues) {
+  auto scopedPool = memory::getDefaultScopedMemoryPool();
+  auto& pool = *scopedPool;
+  size_t size = 100;
+
+  auto values = AlignedBuffer::allocate<int64_t>(size, &pool);
+  auto* valuesPtr = values->asMutable<int64_t>();
+  for (size_t i = 0; i < size; ++i) {
+    valuesPtr[i] = (i % 7) * 1000 - static_cast<int64_t>(i);
+  }
+  auto nulls = allocateNulls(size, &pool);
+  for (size_t i = 0; i < size; i += 9) {
+    bits::setNull(nulls->asMutable<uint64_t>(), i);
+  }
+  auto vec = makeFlatVector<int64_t>(&pool, nulls, 12, size, values);
+
+  Ranges ranges;
+  ranges.add(3, 40);
+  ranges.add(55, size);
+
+  IntegerStatisticsBuilder batch{options};
+  IntegerStatisticsBuilder single{options};
+  StatisticsBuilderUtils::addValues<int64_t>(batch, vec, ranges);
+  for (auto pos : ranges) {
+    if (bits::isBitNull(nulls->as<uint64_t>(), pos)) {
+      single.setHasNull();
+    } else {
+      single.addValues(valuesPtr[pos]);
+    }
+  }
+  auto batchStats = batch.build();
+  auto singleStats = single.build();
+  auto batchInt = dynamic_cast<IntegerColumnStatistics*>(batchStats.get());
+  auto singleInt = dynamic_cast<IntegerColumnStatistics*>(singleStats.get());
+  EXPECT_EQ(singleInt->getNumberOfValues(), batchInt->getNumberOfValues());
+  EXPECT_EQ(singleInt->hasNull(), batchInt->hasNull());
+  EXPECT_EQ(singleInt->getMinimum(), batchInt->getMinimum());
+  EXPECT_EQ(singleInt->getMaximum(), batchInt->getMaximum());
+  EXPECT_EQ(singleInt->getSum(), batchInt->getSum());
+
+  // int64 sum overflow invalidates the sum only
+  std::vector<int64_t> large{std::numeric_limits<int64_t>::max(), 1};
+  batch.addBatch(large.data(), large.size());
+  EXPECT_FALSE(batch.getSum().has_value());
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), batch.getMaximum().value());
+
+  // NaN clears min/max/sum
+  DoubleStatisticsBuilder doubles{options};
+  std::vector<float> floats{1.5, -2.0, 4.25};
+  doubles.addBatch(floats.data(), floats.size());
+  EXPECT_EQ(3, doubles.getNumberOfValues());
+  EXPECT_EQ(-2.0, doubles.getMinimum().value());
+  EXPECT_EQ(4.25, doubles.getMaximum().value());
+  EXPECT_EQ(3.75, doubles.getSum().value());
+  floats.push_back(std::nanf(""));
+  doubles.addBatch(floats.data(), floats.size());
+  EXPECT_EQ(7, doubles.getNumberOfValues());
+  EXPECT_FALSE(doubles.getMinimum().has_value());
+  EXPECT_FALSE(doubles.getSum().has_value());
+}
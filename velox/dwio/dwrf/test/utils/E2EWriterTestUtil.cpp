@@ -38,7 +38,8 @@ namespace facebook::velox::dwrf {
     std::function<
         std::unique_ptr<LayoutPlanner>(StreamList, const EncodingContainer&)>
         layoutPlannerFactory,
-    const int64_t writerMemoryCap) {
+    const int64_t writerMemoryCap,
+    folly::Executor* executor) {
   // write file to memory
   WriterOptions options;
   options.config = config;
@@ -46,6 +47,7 @@ namespace facebook::velox::dwrf {
   options.memoryBudget = writerMemoryCap;
   options.flushPolicy = flushPolicy;
   options.layoutPlannerFactory = layoutPlannerFactory;
+  options.executor = executor;
 
   auto writer = std::make_unique<Writer>(
       options,
@@ -74,7 +76,8 @@ namespace facebook::velox::dwrf {
         std::unique_ptr<LayoutPlanner>(StreamList, const EncodingContainer&)>
         layoutPlannerFactory,
     const int64_t writerMemoryCap,
-    const bool verifyContent) {
+    const bool verifyContent,
+    folly::Executor* executor) {
   // write file to memory
   auto sink = std::make_unique<MemorySink>(pool, 200 * 1024 * 1024);
   auto sinkPtr = sink.get();
@@ -87,7 +90,8 @@ namespace facebook::velox::dwrf {
       config,
       flushPolicy,
       layoutPlannerFactory,
-      writerMemoryCap);
+      writerMemoryCap,
+      executor);
   // read it back and compare
   auto input =
       std::make_unique<MemoryInputStream>(sinkPtr->getData(), sinkPtr->size());
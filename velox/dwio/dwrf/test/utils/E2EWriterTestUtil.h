@@ -36,6 +36,8 @@ class E2EWriterTestUtil {
    *    layoutPlannerFactory    supplies the layout planner and determine how
    *                            order of the data streams prior to flush
    *    writerMemoryCap         total memory budget for the writer
+   *    executor                if set, the writer encodes the top level
+   *                            columns concurrently on it
    */
   static std::unique_ptr<Writer> writeData(
       std::unique_ptr<dwio::common::DataSink> sink,
@@ -46,7 +48,8 @@ class E2EWriterTestUtil {
       std::function<
           std::unique_ptr<LayoutPlanner>(StreamList, const EncodingContainer&)>
           layoutPlannerFactory = nullptr,
-      const int64_t writerMemoryCap = std::numeric_limits<int64_t>::max());
+      const int64_t writerMemoryCap = std::numeric_limits<int64_t>::max(),
+      folly::Executor* executor = nullptr);
 
   /**
    * Creates a writer with the supplied configuration and check the IO
@@ -67,7 +70,8 @@ class E2EWriterTestUtil {
           std::unique_ptr<LayoutPlanner>(StreamList, const EncodingContainer&)>
           layoutPlannerFactory = nullptr,
       const int64_t writerMemoryCap = std::numeric_limits<int64_t>::max(),
-      const bool verifyContent = true);
+      const bool verifyContent = true,
+      folly::Executor* executor = nullptr);
 
   static std::vector<VectorPtr> generateBatches(
       const std::shared_ptr<const Type>& type,
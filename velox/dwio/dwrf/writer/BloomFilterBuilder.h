@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/dwio/dwrf/common/OutputStream.h"
+#include "velox/dwio/dwrf/common/RowGroupBloomFilter.h"
+
+namespace facebook::velox::dwrf {
+
+// Builds the bloom filters of the row groups of a column and writes them to
+// a BLOOM_FILTER_UTF8 stream. The values are added through the
+// StatisticsBuilder of the row group.
+class BloomFilterBuilder {
+ public:
+  // 'capacity' is the expected number of values in a row group.
+  BloomFilterBuilder(
+      std::unique_ptr<BufferedOutputStream> out,
+      int32_t capacity)
+      : out_{std::move(out)}, capacity_{capacity} {
+    bloomFilter_.reset(capacity_);
+  }
+
+  BloomFilter<false>& bloomFilter() {
+    return bloomFilter_;
+  }
+
+  // Ends the row group. 'numValues' is the number of non-null values in the
+  // row group. The filter is shrunk to fit this number, so that small row
+  // groups take less space.
+  void addEntry(uint64_t numValues) {
+    bloomFilter_.shrink(std::min<uint64_t>(numValues, capacity_));
+    bloomFilterToProto(bloomFilter_, *index_.add_bloomfilter());
+    bloomFilter_.reset(capacity_);
+  }
+
+  void flush() {
+    index_.SerializeToZeroCopyStream(out_.get());
+    out_->flush();
+    index_.Clear();
+  }
+
+ private:
+  std::unique_ptr<BufferedOutputStream> out_;
+  const int32_t capacity_;
+  BloomFilter<false> bloomFilter_;
+  proto::BloomFilterIndex index_;
+};
+
+} // namespace facebook::velox::dwrf
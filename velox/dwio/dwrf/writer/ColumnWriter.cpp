@@ -15,6 +15,9 @@
  */
 
 #include "velox/dwio/dwrf/writer/ColumnWriter.h"
+
+#include <condition_variable>
+
 #include "velox/dwio/common/ChainedBuffer.h"
 #include "velox/dwio/dwrf/writer/DictionaryEncodingUtils.h"
 #include "velox/dwio/dwrf/writer/EntropyEncodingSelector.h"
@@ -33,7 +36,8 @@ namespace facebook::velox::dwrf {
 WriterContext::LocalDecodedVector ColumnWriter::decode(
     const VectorPtr& slice,
     const Ranges& ranges) {
-  auto& selected = context_.getSharedSelectivityVector(slice->size());
+  auto localSelected = context_.getLocalSelectivityVector(slice->size());
+  auto& selected = localSelected.get();
   // initialize
   selected.clearAll();
   for (auto& range : ranges.getRanges()) {
@@ -48,6 +52,44 @@ WriterContext::LocalDecodedVector ColumnWriter::decode(
 
 namespace {
 
+// Dictionary-encoded input with a base no larger than the rows being written
+// is cheaper to encode by looking up each distinct base value once and
+// remapping the row indices than by hashing every row.
+bool canRemapDictionary(const DecodedVector& decoded, const Ranges& ranges) {
+  return !decoded.isIdentityMapping() && !decoded.isConstantMapping() &&
+      decoded.base() && decoded.base()->size() <= ranges.size();
+}
+
+// Calls addKey(baseIndex, count) once per distinct base index referenced by
+// the non-null rows, in first seen order, and records the returned dictionary
+// id in ids[baseIndex]. Returns the number of null rows.
+template <typename AddKey>
+uint64_t remapDictionary(
+    const DecodedVector& decoded,
+    const Ranges& ranges,
+    std::vector<uint32_t>& ids,
+    AddKey addKey) {
+  auto baseSize = decoded.base()->size();
+  std::vector<uint32_t> counts(baseSize, 0);
+  std::vector<vector_size_t> order;
+  uint64_t nullCount = 0;
+  for (auto& pos : ranges) {
+    if (decoded.isNullAt(pos)) {
+      ++nullCount;
+      continue;
+    }
+    auto baseIndex = decoded.index(pos);
+    if (counts[baseIndex]++ == 0) {
+      order.push_back(baseIndex);
+    }
+  }
+  ids.resize(baseSize);
+  for (auto baseIndex : order) {
+    ids[baseIndex] = addKey(baseIndex, counts[baseIndex]);
+  }
+  return nullCount;
+}
+
 template <typename T>
 class ByteRleColumnWriter : public ColumnWriter {
  public:
@@ -207,6 +249,12 @@ class IntegerColumnWriter : public ColumnWriter {
         dictionaryKeySizeThreshold_{
             getConfig(Config::DICTIONARY_NUMERIC_KEY_SIZE_THRESHOLD)},
         sort_{getConfig(Config::DICTIONARY_SORT_KEYS)},
+        // A dictionary shared by the values of a flat map sees the values of
+        // all the keys, so no single writer can decide from a sample.
+        dictionarySampleRows_{
+            context.shareFlatMapDictionaries && sequence != 0
+                ? 0
+                : getConfig(Config::DICTIONARY_SAMPLE_ROWS)},
         useDictionaryEncoding_{useDictionaryEncoding()},
         strideOffsets_{getMemoryPool(MemoryUsageCategory::GENERAL)} {
     DWIO_ENSURE_GE(dictionaryKeySizeThreshold_, 0.0);
@@ -320,6 +368,7 @@ class IntegerColumnWriter : public ColumnWriter {
     fileStatsBuilder_->merge(*indexStatsBuilder_);
     // Add entry with stats for either case.
     indexBuilder_->addEntry(*indexStatsBuilder_);
+    addBloomFilterEntry();
     indexStatsBuilder_->reset();
     ColumnWriter::recordPosition();
     // TODO: the only way useDictionaryEncoding_ right now is
@@ -400,6 +449,21 @@ class IntegerColumnWriter : public ColumnWriter {
     ensureValidStreamWriters(dictEncoding);
   }
 
+  // Once the first stripe has 'dictionarySampleRows_' values, switches to
+  // direct encoding if the dictionary is not efficient for them, so that a
+  // high cardinality column stops growing its dictionary. The decision
+  // carries over to the later stripes like the one made at flush.
+  void decideEncodingFromSample() {
+    if (dictionarySampleRows_ == 0 || sampleDecided_ || !firstStripe_ ||
+        dictEncoder_.getTotalCount() < dictionarySampleRows_) {
+      return;
+    }
+    sampleDecided_ = true;
+    if (!shouldKeepDictionary()) {
+      abandonDictionaries();
+    }
+  }
+
   // NOTE: This should be called *before* clearing the rows_ buffer.
   bool shouldKeepDictionary() const {
     // TODO(T91508412): Move the dictionary efficiency based decision into
@@ -461,11 +525,13 @@ class IntegerColumnWriter : public ColumnWriter {
   size_t finalDictionarySize_;
   const float dictionaryKeySizeThreshold_;
   const bool sort_;
+  const uint32_t dictionarySampleRows_;
   // This value could change if we are writing with low memory mode or if we
   // determine with the first stripe that the data is not fit for dictionary
   // encoding.
   bool useDictionaryEncoding_;
   bool firstStripe_{true};
+  bool sampleDecided_{false};
   DataBuffer<size_t> strideOffsets_;
 };
 
@@ -477,7 +543,9 @@ uint64_t IntegerColumnWriter<T>::write(
     // Decode and then write
     auto localDecoded = decode(slice, ranges);
     auto& decodedVector = localDecoded.get();
-    return writeDict(decodedVector, ranges);
+    auto rawSize = writeDict(decodedVector, ranges);
+    decideEncodingFromSample();
+    return rawSize;
   } else {
     // If the input is not a flat vector we make a complete copy and convert
     // it to flat vector
@@ -512,7 +580,20 @@ uint64_t IntegerColumnWriter<T>::writeDict(
   };
 
   uint64_t nullCount = 0;
-  if (decodedVector.mayHaveNulls()) {
+  if (canRemapDictionary(decodedVector, ranges)) {
+    std::vector<uint32_t> ids;
+    auto values = decodedVector.values<T>();
+    nullCount = remapDictionary(
+        decodedVector, ranges, ids, [&](auto baseIndex, auto count) {
+          statsBuilder.addValues(values[baseIndex], count);
+          return dictEncoder_.addKey(values[baseIndex], count);
+        });
+    for (auto& pos : ranges) {
+      if (!decodedVector.isNullAt(pos)) {
+        rows_.unsafeAppend(ids[decodedVector.index(pos)]);
+      }
+    }
+  } else if (decodedVector.mayHaveNulls()) {
     for (auto& pos : ranges) {
       if (decodedVector.isNullAt(pos)) {
         ++nullCount;
@@ -802,6 +883,7 @@ class StringColumnWriter : public ColumnWriter {
             getConfig(Config::ENTROPY_STRING_DICT_SAMPLE_FRACTION),
             getConfig(Config::ENTROPY_STRING_THRESHOLD)},
         sort_{getConfig(Config::DICTIONARY_SORT_KEYS)},
+        dictionarySampleRows_{getConfig(Config::DICTIONARY_SAMPLE_ROWS)},
         useDictionaryEncoding_{useDictionaryEncoding()},
         strideOffsets_{getMemoryPool(MemoryUsageCategory::GENERAL)} {
     DWIO_ENSURE(firstStripe_);
@@ -902,6 +984,7 @@ class StringColumnWriter : public ColumnWriter {
     fileStatsBuilder_->merge(*indexStatsBuilder_);
     // Add entry with stats for either case.
     indexBuilder_->addEntry(*indexStatsBuilder_);
+    addBloomFilterEntry();
     indexStatsBuilder_->reset();
     ColumnWriter::recordPosition();
     // TODO: the only way useDictionaryEncoding_ right now is
@@ -1018,6 +1101,18 @@ class StringColumnWriter : public ColumnWriter {
     ensureValidStreamWriters(dictEncoding);
   }
 
+  // See IntegerColumnWriter::decideEncodingFromSample().
+  void decideEncodingFromSample() {
+    if (dictionarySampleRows_ == 0 || sampleDecided_ || !firstStripe_ ||
+        rows_.size() < dictionarySampleRows_) {
+      return;
+    }
+    sampleDecided_ = true;
+    if (!shouldKeepDictionary()) {
+      abandonDictionaries();
+    }
+  }
+
   // NOTE: This should be called *before* clearing the rows_ buffer.
   bool shouldKeepDictionary() const {
     return rows_.size() != 0 &&
@@ -1079,11 +1174,13 @@ class StringColumnWriter : public ColumnWriter {
   size_t finalDictionarySize_;
   EntropyEncodingSelector encodingSelector_;
   const bool sort_;
+  const uint32_t dictionarySampleRows_;
   // This value could change if we are writing with low memory mode or if we
   // determine with the first stripe that the data is not fit for dictionary
   // encoding.
   bool useDictionaryEncoding_;
   bool firstStripe_{true};
+  bool sampleDecided_{false};
   DataBuffer<size_t> strideOffsets_;
 };
 
@@ -1094,7 +1191,9 @@ uint64_t StringColumnWriter::write(
   auto& decodedVector = localDecoded.get();
 
   if (useDictionaryEncoding_) {
-    return writeDict(decodedVector, ranges);
+    auto rawSize = writeDict(decodedVector, ranges);
+    decideEncodingFromSample();
+    return rawSize;
   } else {
     return writeDirect(decodedVector, ranges);
   }
@@ -1118,7 +1217,22 @@ uint64_t StringColumnWriter::writeDict(
   };
 
   uint64_t nullCount = 0;
-  if (decodedVector.mayHaveNulls()) {
+  if (canRemapDictionary(decodedVector, ranges)) {
+    std::vector<uint32_t> ids;
+    auto values = decodedVector.values<StringView>();
+    nullCount = remapDictionary(
+        decodedVector, ranges, ids, [&](auto baseIndex, auto count) {
+          auto sp = values[baseIndex];
+          statsBuilder.addValues(sp, count);
+          rawSize += sp.size() * count;
+          return dictEncoder_.addKey(sp, strideIndex, count);
+        });
+    for (auto& pos : ranges) {
+      if (!decodedVector.isNullAt(pos)) {
+        rows_.unsafeAppend(ids[decodedVector.index(pos)]);
+      }
+    }
+  } else if (decodedVector.mayHaveNulls()) {
     for (auto& pos : ranges) {
       if (decodedVector.isNullAt(pos)) {
         ++nullCount;
@@ -1377,6 +1491,7 @@ uint64_t FloatColumnWriter<T>::write(
     ColumnWriter::write(slice, ranges);
     auto nulls = slice->rawNulls();
     auto data = flatVector->rawValues();
+    StatisticsBuilderUtils::addValues<T>(statsBuilder, slice, ranges);
     if (slice->mayHaveNulls()) {
       // higher throughput is achieved through this local buffer
       auto writer = createBufferedWriter<T>(
@@ -1386,23 +1501,14 @@ uint64_t FloatColumnWriter<T>::write(
             data_.write(reinterpret_cast<const char*>(buf), size * sizeof(T));
           });
 
-      auto processRow = [&](size_t pos) {
-        auto val = data[pos];
-        writer.add(val);
-        statsBuilder.addValues(val);
-      };
-
       for (auto& pos : ranges) {
         if (bits::isBitNull(nulls, pos)) {
           ++nullCount;
         } else {
-          processRow(pos);
+          writer.add(data[pos]);
         }
       }
     } else {
-      for (auto& pos : ranges) {
-        statsBuilder.addValues(data[pos]);
-      }
       for (const auto& [start, end] : ranges.getRanges()) {
         const char* srcPtr = reinterpret_cast<const char*>(data + start);
         size_t sz = end - start;
@@ -1571,6 +1677,27 @@ uint64_t BinaryColumnWriter::write(
   return rawSize;
 }
 
+namespace {
+
+// The state of writing the children of the root on an executor. Each child is
+// written by the first thread that claims it, the executor or the writing
+// thread. Tasks that find their child claimed do nothing, but may still run
+// after the write returns, so they share the state.
+struct ConcurrentWriteState {
+  explicit ConcurrentWriteState(size_t numChildren)
+      : claimed(numChildren), rawSizes(numChildren), errors(numChildren) {}
+
+  std::vector<std::atomic<bool>> claimed;
+  std::vector<uint64_t> rawSizes;
+  std::vector<std::exception_ptr> errors;
+  std::mutex mutex;
+  std::condition_variable allFinished;
+  // The number of children written on the executor.
+  size_t numFinished{0};
+};
+
+} // namespace
+
 class StructColumnWriter : public ColumnWriter {
  public:
   StructColumnWriter(
@@ -1598,6 +1725,19 @@ class StructColumnWriter : public ColumnWriter {
       const RowVector* rowSlice,
       const Ranges& ranges,
       uint64_t nullCount);
+
+  // Writes the children of the root concurrently on 'executor' and returns
+  // the sum of their raw sizes.
+  uint64_t writeChildrenConcurrently(
+      folly::Executor& executor,
+      const RowVector* rowSlice,
+      const Ranges& ranges);
+
+  void writeChild(
+      ConcurrentWriteState& state,
+      size_t i,
+      const RowVector* rowSlice,
+      const Ranges& ranges);
 };
 
 uint64_t StructColumnWriter::writeChildrenAndStats(
@@ -1606,8 +1746,13 @@ uint64_t StructColumnWriter::writeChildrenAndStats(
     uint64_t nullCount) {
   uint64_t rawSize = 0;
   if (ranges.size() > 0) {
-    for (size_t i = 0; i < children_.size(); ++i) {
-      rawSize += children_.at(i)->write(rowSlice->childAt(i), ranges);
+    auto executor = isRoot() ? context_.executor() : nullptr;
+    if (executor && children_.size() > 1) {
+      rawSize = writeChildrenConcurrently(*executor, rowSlice, ranges);
+    } else {
+      for (size_t i = 0; i < children_.size(); ++i) {
+        rawSize += children_.at(i)->write(rowSlice->childAt(i), ranges);
+      }
     }
   }
   if (nullCount) {
@@ -1619,6 +1764,80 @@ uint64_t StructColumnWriter::writeChildrenAndStats(
   return rawSize;
 }
 
+void StructColumnWriter::writeChild(
+    ConcurrentWriteState& state,
+    size_t i,
+    const RowVector* rowSlice,
+    const Ranges& ranges) {
+  try {
+    state.rawSizes[i] = children_.at(i)->write(rowSlice->childAt(i), ranges);
+  } catch (...) {
+    state.errors[i] = std::current_exception();
+  }
+}
+
+uint64_t StructColumnWriter::writeChildrenConcurrently(
+    folly::Executor& executor,
+    const RowVector* rowSlice,
+    const Ranges& ranges) {
+  // Loading a LazyVector is not thread safe, so the children are loaded
+  // before they are written.
+  for (auto& child : rowSlice->children()) {
+    if (child) {
+      child->loadedVector();
+    }
+  }
+  auto state = std::make_shared<ConcurrentWriteState>(children_.size());
+  // Flat map writers add streams to the context while writing, so maps are
+  // written on this thread.
+  std::vector<size_t> concurrent;
+  std::vector<size_t> serial;
+  for (size_t i = 0; i < children_.size(); ++i) {
+    if (type_.childAt(i)->type->kind() == TypeKind::MAP) {
+      serial.push_back(i);
+    } else {
+      concurrent.push_back(i);
+    }
+  }
+  for (auto i : concurrent) {
+    executor.add([this, state, i, rowSlice, &ranges]() {
+      if (state->claimed[i].exchange(true)) {
+        return;
+      }
+      writeChild(*state, i, rowSlice, ranges);
+      std::lock_guard<std::mutex> l(state->mutex);
+      ++state->numFinished;
+      state->allFinished.notify_all();
+    });
+  }
+  for (auto i : serial) {
+    writeChild(*state, i, rowSlice, ranges);
+  }
+  // Writes the children the executor has not started, so that a saturated
+  // executor does not hold up the write.
+  size_t numOnExecutor = 0;
+  for (auto i : concurrent) {
+    if (state->claimed[i].exchange(true)) {
+      ++numOnExecutor;
+    } else {
+      writeChild(*state, i, rowSlice, ranges);
+    }
+  }
+  {
+    std::unique_lock<std::mutex> l(state->mutex);
+    state->allFinished.wait(
+        l, [&]() { return state->numFinished == numOnExecutor; });
+  }
+  uint64_t rawSize = 0;
+  for (size_t i = 0; i < children_.size(); ++i) {
+    if (state->errors[i]) {
+      std::rethrow_exception(state->errors[i]);
+    }
+    rawSize += state->rawSizes[i];
+  }
+  return rawSize;
+}
+
 uint64_t StructColumnWriter::write(
     const VectorPtr& slice,
     const Ranges& ranges) {
@@ -22,6 +22,7 @@
 #include "velox/dwio/dwrf/common/Common.h"
 #include "velox/dwio/dwrf/common/IntEncoder.h"
 #include "velox/dwio/dwrf/common/OutputStream.h"
+#include "velox/dwio/dwrf/writer/BloomFilterBuilder.h"
 #include "velox/dwio/dwrf/writer/IndexBuilder.h"
 #include "velox/dwio/dwrf/writer/StatisticsBuilder.h"
 #include "velox/dwio/dwrf/writer/WriterContext.h"
@@ -71,6 +72,7 @@ class ColumnWriter {
     hasNull_ = hasNull_ || indexStatsBuilder_->hasNull().value();
     fileStatsBuilder_->merge(*indexStatsBuilder_);
     indexBuilder_->addEntry(*indexStatsBuilder_);
+    addBloomFilterEntry();
     indexStatsBuilder_->reset();
     recordPosition();
     for (auto& child : children_) {
@@ -105,6 +107,9 @@ class ColumnWriter {
     setEncoding(encoding);
     encodingOverride(encoding);
     indexBuilder_->flush();
+    if (bloomFilterBuilder_) {
+      bloomFilterBuilder_->flush();
+    }
   }
 
   virtual uint64_t writeFileStats(
@@ -151,6 +156,40 @@ class ColumnWriter {
     auto options = StatisticsBuilderOptions::fromConfig(context.getConfigs());
     indexStatsBuilder_ = StatisticsBuilder::create(type.type->kind(), options);
     fileStatsBuilder_ = StatisticsBuilder::create(type.type->kind(), options);
+    if (needsBloomFilter()) {
+      bloomFilterBuilder_ = std::make_unique<BloomFilterBuilder>(
+          newStream(StreamKind::StreamKind_BLOOM_FILTER_UTF8),
+          context_.indexStride);
+      indexStatsBuilder_->setBloomFilter(&bloomFilterBuilder_->bloomFilter());
+    }
+  }
+
+  // True if the column is configured to have bloom filters and its type
+  // supports them.
+  bool needsBloomFilter() const {
+    if (sequence_ != 0 || !type_.parent || type_.parent->id != 0) {
+      return false;
+    }
+    switch (type_.type->kind()) {
+      case TypeKind::TINYINT:
+      case TypeKind::SMALLINT:
+      case TypeKind::INTEGER:
+      case TypeKind::BIGINT:
+      case TypeKind::VARCHAR:
+        break;
+      default:
+        return false;
+    }
+    const auto& columns = getConfig(Config::BLOOM_FILTER_COLS);
+    return std::find(columns.begin(), columns.end(), type_.column) !=
+        columns.end();
+  }
+
+  void addBloomFilterEntry() {
+    if (bloomFilterBuilder_) {
+      bloomFilterBuilder_->addEntry(
+          indexStatsBuilder_->getNumberOfValues().value());
+    }
   }
 
   virtual void recordPosition() {
@@ -213,6 +252,8 @@ class ColumnWriter {
   std::unique_ptr<IndexBuilder> indexBuilder_;
   std::unique_ptr<StatisticsBuilder> indexStatsBuilder_;
   std::unique_ptr<StatisticsBuilder> fileStatsBuilder_;
+  // Set if the column has bloom filters.
+  std::unique_ptr<BloomFilterBuilder> bloomFilterBuilder_;
 
   std::unique_ptr<ByteRleEncoder> present_;
   bool hasNull_ = false;
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/dwio/dwrf/writer/FileMerger.h"
+
+#include <folly/Random.h>
+
+namespace facebook::velox::dwrf {
+
+using dwio::common::LogType;
+
+FileMerger::FileMerger(
+    std::unique_ptr<dwio::common::DataSink> sink,
+    memory::MemoryPool& pool)
+    : WriterBase{std::move(sink)}, pool_{pool} {}
+
+bool FileMerger::isCompatible(const ReaderBase& reader) const {
+  if (reader.getDecryptionHandler().isEncrypted()) {
+    return false;
+  }
+  if (!schema_) {
+    return true;
+  }
+  auto& context = getContext();
+  auto& footer = reader.getFooter();
+  auto checksum = footer.has_checksumalgorithm()
+      ? footer.checksumalgorithm()
+      : proto::ChecksumAlgorithm::NULL_;
+  return *reader.getSchema() == *schema_ &&
+      reader.getCompressionKind() == context.compression &&
+      (context.compression == CompressionKind::CompressionKind_NONE ||
+       reader.getCompressionBlockSize() == context.compressionBlockSize) &&
+      footer.rowindexstride() == context.indexStride &&
+      reader.getWriterVersion() ==
+      context.getConfig(Config::WRITER_VERSION) &&
+      checksum == context.getConfig(Config::CHECKSUM_ALGORITHM);
+}
+
+void FileMerger::init(const ReaderBase& reader) {
+  auto& footer = reader.getFooter();
+  schema_ = reader.getSchema();
+  config_ = std::make_shared<Config>();
+  config_->set(Config::COMPRESSION, reader.getCompressionKind());
+  config_->set(
+      Config::COMPRESSION_BLOCK_SIZE, reader.getCompressionBlockSize());
+  config_->set(Config::ROW_INDEX_STRIDE, footer.rowindexstride());
+  config_->set(Config::WRITER_VERSION, reader.getWriterVersion());
+  config_->set(
+      Config::CHECKSUM_ALGORITHM,
+      footer.has_checksumalgorithm() ? footer.checksumalgorithm()
+                                     : proto::ChecksumAlgorithm::NULL_);
+  // The stripes are copied without their stripe cache entries.
+  config_->set(Config::STRIPE_CACHE_MODE, proto::StripeCacheMode::NA);
+  initContext(
+      config_,
+      pool_.addScopedChild(fmt::format(
+          "file_merger_{}", folly::to<std::string>(folly::Random::rand64()))));
+
+  StatisticsBuilder::createTree(
+      statsBuilders_, *schema_, StatisticsBuilderOptions::fromConfig(*config_));
+  nodeSizes_.resize(statsBuilders_.size());
+}
+
+void FileMerger::addFile(const ReaderBase& reader) {
+  DWIO_ENSURE(!closed_, "Cannot add a file to a closed merger");
+  DWIO_ENSURE(
+      isCompatible(reader),
+      "File ",
+      reader.getStream().getName(),
+      " cannot be merged without rewriting it");
+  if (!schema_) {
+    init(reader);
+  }
+
+  auto& context = getContext();
+  auto& sink = getSink();
+  auto& footer = reader.getFooter();
+  auto& input = reader.getStream();
+  auto& pool = context.getMemoryPool(MemoryUsageCategory::OUTPUT_STREAM);
+  for (auto& stripe : footer.stripes()) {
+    auto& stripeInfo = *getFooter().add_stripes();
+    stripeInfo = stripe;
+    stripeInfo.set_offset(sink.size());
+
+    auto offset = stripe.offset();
+    auto remaining =
+        stripe.indexlength() + stripe.datalength() + stripe.footerlength();
+    while (remaining > 0) {
+      auto length = std::min<uint64_t>(remaining, kCopyBufferSize);
+      dwio::common::DataBuffer<char> buffer{pool, length};
+      input.read(buffer.data(), length, offset, LogType::STRIPE);
+      sink.addBuffer(std::move(buffer));
+      offset += length;
+      remaining -= length;
+    }
+    // Keeps at most a stripe in memory if the sink buffers.
+    sink.flush();
+  }
+
+  context.fileRowCount += footer.numberofrows();
+  context.fileRawSize += footer.rawdatasize();
+
+  DWIO_ENSURE_EQ(footer.statistics_size(), statsBuilders_.size());
+  for (auto i = 0; i < statsBuilders_.size(); ++i) {
+    statsBuilders_[i]->merge(*reader.getColumnStatistics(i));
+    nodeSizes_[i] += footer.statistics(i).size();
+  }
+}
+
+void FileMerger::close() {
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  // The footer takes the schema from the first file.
+  DWIO_ENSURE_NOT_NULL(schema_, "No files to merge");
+
+  auto& footer = getFooter();
+  for (auto i = 0; i < statsBuilders_.size(); ++i) {
+    auto& stats = *footer.add_statistics();
+    statsBuilders_[i]->toProto(stats);
+    stats.set_size(nodeSizes_[i]);
+  }
+  writeFooter(*schema_);
+  getSink().flush();
+  WriterBase::close();
+}
+
+} // namespace facebook::velox::dwrf
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/dwio/dwrf/reader/ReaderBase.h"
+#include "velox/dwio/dwrf/writer/StatisticsBuilder.h"
+#include "velox/dwio/dwrf/writer/WriterBase.h"
+
+namespace facebook::velox::dwrf {
+
+// Concatenates DWRF files into one without decoding them. The stripes of
+// each input, with their indices and footers, are copied as they are. The
+// file footer lists the stripes of all inputs and merges their file level
+// statistics.
+//
+// The inputs must have the same schema, compression, row index stride and
+// writer version, and must not be encrypted. isCompatible() tells whether a
+// file can be added, so that the caller can rewrite the others with a
+// Writer instead.
+class FileMerger : public WriterBase {
+ public:
+  // Bytes of stripe data read and written at a time.
+  static constexpr uint64_t kCopyBufferSize = 8 << 20;
+
+  FileMerger(
+      std::unique_ptr<dwio::common::DataSink> sink,
+      memory::MemoryPool& pool);
+
+  // True if the stripes of 'reader' can be copied into the output. Any file
+  // that is not encrypted is compatible with an empty merger.
+  bool isCompatible(const ReaderBase& reader) const;
+
+  // Appends the stripes of 'reader'. Throws if it is not compatible.
+  void addFile(const ReaderBase& reader);
+
+  void close() override;
+
+ private:
+  // Sets up the output for files like 'reader'.
+  void init(const ReaderBase& reader);
+
+  memory::MemoryPool& pool_;
+  std::shared_ptr<const RowType> schema_;
+  std::shared_ptr<Config> config_;
+  // Statistics of the added files, indexed by node id.
+  std::vector<std::unique_ptr<StatisticsBuilder>> statsBuilders_;
+  // Sizes of the columns of the added files, indexed by node id.
+  std::vector<uint64_t> nodeSizes_;
+  bool closed_{false};
+};
+
+} // namespace facebook::velox::dwrf
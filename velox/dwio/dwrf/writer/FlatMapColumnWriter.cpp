@@ -15,6 +15,7 @@
  */
 
 #include "velox/dwio/dwrf/writer/FlatMapColumnWriter.h"
+#include <folly/container/F14Set.h>
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/FlatVector.h"
 
@@ -55,8 +56,10 @@ void FlatMapColumnWriter<K>::flush(
     std::function<void(proto::ColumnEncoding&)> encodingOverride) {
   ColumnWriter::flush(encodingFactory, encodingOverride);
 
-  for (auto& pair : valueWriters_) {
-    pair.second.flush(encodingFactory);
+  // Keys missing from the stripe have no streams or encodings in it.
+  removeUnusedValueWriters();
+  for (auto* valueWriter : stripeValueWriters_) {
+    valueWriter->flush(encodingFactory);
   }
 
   // Reset is being called after flush, so no need to explicitly
@@ -69,8 +72,8 @@ void FlatMapColumnWriter<K>::createIndexEntry() {
   rowsInStrides_.push_back(rowsInCurrentStride_);
   rowsInCurrentStride_ = 0;
 
-  for (auto& pair : valueWriters_) {
-    pair.second.createIndexEntry(*valueFileStatsBuilder_);
+  for (auto* valueWriter : stripeValueWriters_) {
+    valueWriter->createIndexEntry(*valueFileStatsBuilder_);
   }
 }
 
@@ -93,27 +96,55 @@ uint64_t FlatMapColumnWriter<K>::writeFileStats(
 }
 
 template <TypeKind K>
-void FlatMapColumnWriter<K>::clearNodes() {
-  // TODO: If we are writing shared dictionaries, the shared dictionary data
-  // stream should be reused. Even when the stream is not actually used, we
-  // should keep it around in case of future encoding decision changes.
-  context_.removeAllIntDictionaryEncodersOnNode([this](uint32_t nodeId) {
-    return nodeId >= valueType_.id && nodeId <= valueType_.maxId;
-  });
+void FlatMapColumnWriter<K>::removeUnusedValueWriters() {
+  if (stripeValueWriters_.size() == valueWriters_.size()) {
+    return;
+  }
+  folly::F14FastSet<uint32_t> sequences;
+  auto it = valueWriters_.begin();
+  while (it != valueWriters_.end()) {
+    if (it->second.isInStripe()) {
+      ++it;
+      continue;
+    }
+    auto sequence = it->second.getSequence();
+    sequences.insert(sequence);
+    freeSequences_.push_back(sequence);
+    if constexpr (std::is_integral_v<KeyType>) {
+      auto key = it->first;
+      if (key >= 0 && static_cast<uint64_t>(key) < denseValueWriters_.size()) {
+        denseValueWriters_[key] = nullptr;
+      }
+    }
+    it = valueWriters_.erase(it);
+  }
 
-  context_.removeStreams([this](auto& identifier) {
-    return identifier.node >= valueType_.id &&
-        identifier.node <= valueType_.maxId &&
-        (identifier.kind == StreamKind::StreamKind_DICTIONARY_DATA ||
-         identifier.sequence > 0);
+  auto inValue = [this](uint32_t node) {
+    return node >= valueType_.id && node <= valueType_.maxId;
+  };
+  context_.removeStreams([&](auto& identifier) {
+    return inValue(identifier.node) && sequences.count(identifier.sequence);
   });
+  if (context_.shareFlatMapDictionaries) {
+    for (size_t i = 0; i < sequences.size(); ++i) {
+      for (auto node = valueType_.id; node <= valueType_.maxId; ++node) {
+        context_.releaseIntDictionaryEncoder({node, 0});
+      }
+    }
+  } else {
+    context_.removeIntDictionaryEncoders([&](const EncodingKey& ek) {
+      return inValue(ek.node) && sequences.count(ek.sequence);
+    });
+  }
 }
 
 template <TypeKind K>
 void FlatMapColumnWriter<K>::reset() {
   ColumnWriter::reset();
-  clearNodes();
-  valueWriters_.clear();
+  for (auto* valueWriter : stripeValueWriters_) {
+    valueWriter->reset();
+  }
+  stripeValueWriters_.clear();
   rowsInStrides_.clear();
   rowsInCurrentStride_ = 0;
 }
@@ -130,45 +161,89 @@ KeyInfo getKeyInfo(StringView key) {
   return keyInfo;
 }
 
+template <TypeKind K>
+ValueWriter* FlatMapColumnWriter<K>::findValueWriter(KeyType key) {
+  if constexpr (std::is_integral_v<KeyType>) {
+    if (key >= 0 && static_cast<uint64_t>(key) < kMaxDenseKey) {
+      return static_cast<uint64_t>(key) < denseValueWriters_.size()
+          ? denseValueWriters_[key]
+          : nullptr;
+    }
+  }
+  auto it = valueWriters_.find(key);
+  return it == valueWriters_.end() ? nullptr : &it->second;
+}
+
 template <TypeKind K>
 ValueWriter& FlatMapColumnWriter<K>::getValueWriter(
     KeyType key,
     uint32_t inMapSize) {
-  auto it = valueWriters_.find(key);
-  if (it != valueWriters_.end()) {
-    return it->second;
+  auto* valueWriter = findValueWriter(key);
+  if (LIKELY(valueWriter != nullptr) && valueWriter->isInStripe()) {
+    return *valueWriter;
   }
 
-  if (valueWriters_.size() >= maxKeyCount_) {
+  if (stripeValueWriters_.size() >= maxKeyCount_) {
     DWIO_RAISE("Too many map keys requested. Allowed: ", maxKeyCount_);
   }
 
-  auto keyInfo = getKeyInfo(key);
-
-  it = valueWriters_
-           .emplace(
-               std::piecewise_construct,
-               std::forward_as_tuple(key),
-               std::forward_as_tuple(
-                   valueWriters_.size() + 1, /* sequence */
-                   keyInfo,
-                   this->context_,
-                   this->valueType_,
-                   inMapSize))
-           .first;
+  if (!valueWriter) {
+    uint32_t sequence;
+    if (freeSequences_.empty()) {
+      sequence = valueWriters_.size() + 1;
+    } else {
+      sequence = freeSequences_.back();
+      freeSequences_.pop_back();
+    }
+    if constexpr (std::is_same_v<KeyType, StringView>) {
+      if (keyStrings_.size() < sequence) {
+        keyStrings_.resize(sequence);
+      }
+      auto& keyString = keyStrings_[sequence - 1];
+      keyString.assign(key.data(), key.size());
+      key = StringView(keyString.data(), keyString.size());
+    }
 
-  ValueWriter& valueWriter = it->second;
+    auto keyInfo = getKeyInfo(key);
+
+    auto it = valueWriters_
+                  .emplace(
+                      std::piecewise_construct,
+                      std::forward_as_tuple(key),
+                      std::forward_as_tuple(
+                          sequence,
+                          keyInfo,
+                          this->context_,
+                          this->valueType_,
+                          inMapSize))
+                  .first;
+    valueWriter = &it->second;
+
+    if constexpr (std::is_integral_v<KeyType>) {
+      if (key >= 0 && static_cast<uint64_t>(key) < kMaxDenseKey) {
+        if (static_cast<uint64_t>(key) >= denseValueWriters_.size()) {
+          denseValueWriters_.resize(key + 1);
+        }
+        denseValueWriters_[key] = valueWriter;
+      }
+    }
+  }
+  valueWriter->setInStripe();
+  stripeValueWriters_.push_back(valueWriter);
 
   // Back fill previous strides with not-in-map indication
   for (auto& rows : rowsInStrides_) {
-    valueWriter.backfill(rows);
-    valueWriter.createIndexEntry(*valueFileStatsBuilder_);
+    valueWriter->backfill(rows);
+    valueWriter->createIndexEntry(*valueFileStatsBuilder_);
   }
 
   // Back fill current (partial) stride with not-in-map indication
-  valueWriter.backfill(rowsInCurrentStride_);
+  valueWriter->backfill(rowsInCurrentStride_);
 
-  return valueWriter;
+  // The buffers were not reset for the current write, since the key did not
+  // occur in the stripe yet.
+  valueWriter->resizeBuffers(inMapSize);
+  return *valueWriter;
 }
 
 template <TypeKind K>
@@ -334,11 +409,11 @@ uint64_t FlatMapColumnWriter<K>::write(
     }
   };
 
-  // Reset all existing value writer buffers
-  // This includes existing value writers that are not used in this batch
+  // Reset the buffers of the value writers of the stripe
+  // This includes value writers that are not used in this batch
   // (their buffers will be set to empty buffers)
-  for (auto& pair : valueWriters_) {
-    pair.second.resizeBuffers(ranges.size());
+  for (auto* valueWriter : stripeValueWriters_) {
+    valueWriter->resizeBuffers(ranges.size());
   }
 
   // Fill value buffers per key
@@ -366,8 +441,8 @@ uint64_t FlatMapColumnWriter<K>::write(
   auto& values = mapSlice->mapValues();
   // Write all accumulated buffers (this includes value writers that weren't
   // used in this write. This is how we backfill unused value writers)
-  for (auto& pair : valueWriters_) {
-    rawSize += pair.second.writeBuffers(values, mapCount);
+  for (auto* valueWriter : stripeValueWriters_) {
+    rawSize += valueWriter->writeBuffers(values, mapCount);
   }
 
   if (nullCount > 0) {
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "velox/dwio/dwrf/writer/ColumnWriter.h"
 
 namespace facebook::velox::dwrf {
@@ -162,6 +164,7 @@ class ValueWriter {
 
   void reset() {
     columnWriter_->reset();
+    inStripe_ = false;
   }
 
   void resizeBuffers(size_t inMap) {
@@ -170,6 +173,16 @@ class ValueWriter {
     ranges_.clear();
   }
 
+  // True if the key occurs in the current stripe. A writer is kept across
+  // stripes and only writes the stripes that have its key.
+  bool isInStripe() const {
+    return inStripe_;
+  }
+
+  void setInStripe() {
+    inStripe_ = true;
+  }
+
  private:
   uint32_t sequence_;
   const proto::KeyInfo keyInfo_;
@@ -177,6 +190,7 @@ class ValueWriter {
   std::unique_ptr<ColumnWriter> columnWriter_;
   dwio::common::DataBuffer<char> inMapBuffer_;
   Ranges ranges_;
+  bool inStripe_{false};
 };
 
 namespace {
@@ -242,15 +256,39 @@ class FlatMapColumnWriter : public ColumnWriter {
 
   void setEncoding(proto::ColumnEncoding& encoding) const override;
 
+  // Keys in [0, kMaxDenseKey) are looked up in 'denseValueWriters_'
+  // instead of hashed.
+  static constexpr uint64_t kMaxDenseKey = 1 << 16;
+
   ValueWriter& getValueWriter(KeyType key, uint32_t inMapSize);
 
-  void clearNodes();
+  ValueWriter* findValueWriter(KeyType key);
+
+  // Destroys the value writers whose key does not occur in the current
+  // stripe, along with their streams and dictionaries.
+  void removeUnusedValueWriters();
 
   // Map of value writers for each key in the dictionary. Needs referential
   // stability because a member variable is captured by reference by lambda
-  // function passed to another class.
+  // function passed to another class. The writers are kept across stripes
+  // while their keys keep occurring, so their state and dictionaries are
+  // reset instead of rebuilt.
   folly::F14NodeMap<KeyType, ValueWriter, folly::Hash> valueWriters_;
 
+  // Value writers of integer keys in [0, kMaxDenseKey), indexed by key.
+  std::vector<ValueWriter*> denseValueWriters_;
+
+  // Value writers of the keys in the current stripe, in order of first
+  // occurrence.
+  std::vector<ValueWriter*> stripeValueWriters_;
+
+  // Sequences of removed value writers, reused by new ones.
+  std::vector<uint32_t> freeSequences_;
+
+  // Copies of string keys, indexed by sequence - 1. The map keys point here
+  // since the key vectors do not outlive a write.
+  std::deque<std::string> keyStrings_;
+
   // Captures row count for each completed stride in current stripe
   std::vector<size_t> rowsInStrides_;
 
@@ -58,6 +58,60 @@ bool DefaultFlushPolicy::operator()(
       estimatedStripeSize >= stripeSizeThreshold_;
 }
 
+AdaptiveFlushPolicy::AdaptiveFlushPolicy(
+    uint64_t stripeSizeThreshold,
+    uint64_t dictionarySizeThreshold,
+    float minHeadroomRatio)
+    : sizePolicy_{stripeSizeThreshold, dictionarySizeThreshold},
+      minHeadroomRatio_{minHeadroomRatio} {
+  DWIO_ENSURE_GE(minHeadroomRatio_, 0.0);
+  DWIO_ENSURE_LT(minHeadroomRatio_, 1.0);
+}
+
+bool AdaptiveFlushPolicy::operator()(
+    bool overMemoryBudget,
+    const WriterContext& context) const {
+  if (overMemoryBudget) {
+    return true;
+  }
+  const int64_t dictionaryMemUsage =
+      context.getMemoryUsage(MemoryUsageCategory::DICTIONARY).getCurrentBytes();
+  // Before the first flush there is no observed compression ratio, so the
+  // buffered output bounds the estimate from below.
+  const int64_t estimatedStripeSize = std::max(
+      context.getEstimatedStripeSize(context.stripeRawSize),
+      context.stripeIndex == 0 ? context.getEstimatedOutputStreamSize() : 0);
+  const int64_t flushMemoryUsage = context.getTotalMemoryUsage() +
+      context.getEstimatedFlushOverhead(context.stripeRawSize);
+  const bool decision = operator()(
+      estimatedStripeSize,
+      dictionaryMemUsage,
+      flushMemoryUsage,
+      context.getMemoryBudget());
+  if (decision) {
+    LOG(INFO) << fmt::format(
+        "dictionaryMemUsage: {}, estimatedStripeSize: {}, flushMemoryUsage: {}, memoryBudget: {}",
+        dictionaryMemUsage,
+        estimatedStripeSize,
+        flushMemoryUsage,
+        context.getMemoryBudget());
+  }
+  return decision;
+}
+
+bool AdaptiveFlushPolicy::operator()(
+    uint64_t estimatedStripeSize,
+    uint64_t dictionarySize,
+    int64_t flushMemoryUsage,
+    int64_t memoryBudget) const {
+  if (sizePolicy_(estimatedStripeSize, dictionarySize)) {
+    return true;
+  }
+  // Computed in double since an unlimited budget is the max int64_t.
+  return flushMemoryUsage >
+      static_cast<double>(memoryBudget) * (1.0 - minHeadroomRatio_);
+}
+
 RowsPerStripeFlushPolicy::RowsPerStripeFlushPolicy(
     std::vector<uint64_t> rowsPerStripe)
     : rowsPerStripe_{std::move(rowsPerStripe)} {
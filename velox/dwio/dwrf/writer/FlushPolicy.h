@@ -37,6 +37,33 @@ class DefaultFlushPolicy {
   const uint64_t dictionarySizeThreshold_;
 };
 
+// Flushes when the estimated compressed size of the stripe reaches
+// 'stripeSizeThreshold' or the dictionaries reach 'dictionarySizeThreshold',
+// like DefaultFlushPolicy, and also when the memory the writer would use to
+// flush the stripe leaves less than 'minHeadroomRatio' of its budget free.
+// The stripe size estimate uses the compression ratio observed on the
+// previous stripes. Under memory pressure the stripes get smaller instead of
+// the writer exceeding its budget.
+class AdaptiveFlushPolicy {
+ public:
+  AdaptiveFlushPolicy(
+      uint64_t stripeSizeThreshold,
+      uint64_t dictionarySizeThreshold,
+      float minHeadroomRatio = 0.2);
+
+  bool operator()(bool overMemoryBudget, const WriterContext& context) const;
+
+  bool operator()(
+      uint64_t estimatedStripeSize,
+      uint64_t dictionarySize,
+      int64_t flushMemoryUsage,
+      int64_t memoryBudget) const;
+
+ private:
+  const DefaultFlushPolicy sizePolicy_;
+  const float minHeadroomRatio_;
+};
+
 class RowsPerStripeFlushPolicy {
  public:
   explicit RowsPerStripeFlushPolicy(std::vector<uint64_t> rowsPerStripe);
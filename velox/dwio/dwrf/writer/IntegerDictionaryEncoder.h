@@ -29,6 +29,9 @@ class AbstractIntegerDictionaryEncoder {
  public:
   virtual ~AbstractIntegerDictionaryEncoder() = default;
   virtual void bumpRefCount() = 0;
+  // Drops the reference of a writer destroyed before the end of the file.
+  // Returns the number of remaining references.
+  virtual uint32_t dropRefCount() = 0;
   virtual uint32_t size() const = 0;
 };
 
@@ -262,6 +265,11 @@ class IntegerDictionaryEncoder : public AbstractIntegerDictionaryEncoder {
     ++refCount_;
   }
 
+  uint32_t dropRefCount() override {
+    DWIO_ENSURE_GT(refCount_, 0);
+    return --refCount_;
+  }
+
   void clear() {
     DWIO_ENSURE(clearCount_ <= refCount_);
     if (++clearCount_ == refCount_) {
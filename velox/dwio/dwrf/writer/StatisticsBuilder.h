@@ -17,6 +17,7 @@
 #pragma once
 
 #include "velox/dwio/dwrf/common/Config.h"
+#include "velox/dwio/dwrf/common/RowGroupBloomFilter.h"
 #include "velox/dwio/dwrf/common/Statistics.h"
 #include "velox/type/Type.h"
 
@@ -92,6 +93,12 @@ class StatisticsBuilder : public virtual dwio::common::ColumnStatistics {
     rawSize_.reset();
   }
 
+  // Also adds the values to 'bloomFilter', which is owned by the caller.
+  // Only integer and string values are added.
+  void setBloomFilter(BloomFilter<false>* bloomFilter) {
+    bloomFilter_ = bloomFilter;
+  }
+
   /*
    * Merge stats of same type. This is used in writer to aggregate file level
    * stats.
@@ -122,6 +129,9 @@ class StatisticsBuilder : public virtual dwio::common::ColumnStatistics {
       const Type& type,
       const StatisticsBuilderOptions& options);
 
+ protected:
+  BloomFilter<false>* bloomFilter_{nullptr};
+
  private:
   void init() {
     valueCount_ = 0;
@@ -184,6 +194,61 @@ class IntegerStatisticsBuilder : public StatisticsBuilder,
       max_ = value;
     }
     addWithOverflowCheck(sum_, value, count);
+    if (bloomFilter_) {
+      bloomFilter_->insert(bloomFilterHash(value));
+    }
+  }
+
+  // Adds a run of non-null values. Equivalent to calling addValues() for each
+  // of them, but min/max/sum are accumulated in locals so the loops can be
+  // vectorized.
+  template <typename T>
+  void addBatch(const T* values, uint64_t count) {
+    if (count == 0) {
+      return;
+    }
+    increaseValueCount(count);
+    int64_t min = std::numeric_limits<int64_t>::max();
+    int64_t max = std::numeric_limits<int64_t>::min();
+    for (uint64_t i = 0; i < count; ++i) {
+      int64_t value = values[i];
+      min = value < min ? value : min;
+      max = value > max ? value : max;
+    }
+    if (min_.has_value() && min < min_.value()) {
+      min_ = min;
+    }
+    if (max_.has_value() && max > max_.value()) {
+      max_ = max;
+    }
+    if (sum_.has_value()) {
+      if constexpr (sizeof(T) < sizeof(int64_t)) {
+        // Narrower values can't overflow a 64 bit accumulator within a batch
+        // (batches are well below 2^32 values), so only the final add needs
+        // the overflow check.
+        int64_t sum = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+          sum += values[i];
+        }
+        addWithOverflowCheck<int64_t>(sum_, sum, 1);
+      } else {
+        int64_t sum = sum_.value();
+        bool overflow = false;
+        for (uint64_t i = 0; i < count; ++i) {
+          overflow |= __builtin_add_overflow(sum, values[i], &sum);
+        }
+        if (overflow) {
+          sum_.reset();
+        } else {
+          sum_ = sum;
+        }
+      }
+    }
+    if (bloomFilter_) {
+      for (uint64_t i = 0; i < count; ++i) {
+        bloomFilter_->insert(bloomFilterHash(static_cast<int64_t>(values[i])));
+      }
+    }
   }
 
   void merge(const dwio::common::ColumnStatistics& other) override;
@@ -243,6 +308,50 @@ class DoubleStatisticsBuilder : public StatisticsBuilder,
     }
   }
 
+  // Adds a run of non-null values. Equivalent to calling addValues() for each
+  // of them. The sum is still accumulated in order so results match exactly.
+  template <typename T>
+  void addBatch(const T* values, uint64_t count) {
+    if (count == 0) {
+      return;
+    }
+    increaseValueCount(count);
+    if (!min_.has_value() && !sum_.has_value()) {
+      // A NaN has already been seen, nothing else to track.
+      return;
+    }
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    bool hasNan = false;
+    for (uint64_t i = 0; i < count; ++i) {
+      double value = values[i];
+      hasNan |= std::isnan(value);
+      min = value < min ? value : min;
+      max = value > max ? value : max;
+    }
+    if (hasNan) {
+      clear();
+      return;
+    }
+    if (min_.has_value() && min < min_.value()) {
+      min_ = min;
+    }
+    if (max_.has_value() && max > max_.value()) {
+      max_ = max;
+    }
+    if (sum_.has_value()) {
+      double sum = sum_.value();
+      for (uint64_t i = 0; i < count; ++i) {
+        sum += values[i];
+      }
+      if (std::isnan(sum)) {
+        sum_.reset();
+      } else {
+        sum_ = sum;
+      }
+    }
+  }
+
   void merge(const dwio::common::ColumnStatistics& other) override;
 
   void reset() override {
@@ -295,6 +404,9 @@ class StringStatisticsBuilder : public StatisticsBuilder,
     }
 
     addWithOverflowCheck<uint64_t>(length_, value.size(), count);
+    if (bloomFilter_) {
+      bloomFilter_->insert(bloomFilterHash(value));
+    }
   }
 
   void merge(const dwio::common::ColumnStatistics& other) override;
@@ -67,28 +67,49 @@ class StatisticsBuilderUtils {
       BinaryStatisticsBuilder& builder,
       const VectorPtr& vector,
       const Ranges& ranges);
+
+ private:
+  // Feeds each range to builder.addBatch(). Ranges containing nulls are
+  // split into their non-null runs.
+  template <typename Builder, typename T>
+  static void addFlatValues(
+      Builder& builder,
+      const T* vals,
+      const uint64_t* nulls,
+      const Ranges& ranges);
 };
 
+template <typename Builder, typename T>
+void StatisticsBuilderUtils::addFlatValues(
+    Builder& builder,
+    const T* vals,
+    const uint64_t* nulls,
+    const Ranges& ranges) {
+  for (const auto& [begin, end] : ranges.getRanges()) {
+    if (!nulls || bits::isAllSet(nulls, begin, end, true)) {
+      builder.addBatch(vals + begin, end - begin);
+      continue;
+    }
+    builder.setHasNull();
+    auto runBegin = begin;
+    for (auto pos = begin; pos < end; ++pos) {
+      if (bits::isBitNull(nulls, pos)) {
+        builder.addBatch(vals + runBegin, pos - runBegin);
+        runBegin = pos + 1;
+      }
+    }
+    builder.addBatch(vals + runBegin, end - runBegin);
+  }
+}
+
 template <typename INT>
 void StatisticsBuilderUtils::addValues(
     IntegerStatisticsBuilder& builder,
     const VectorPtr& vector,
     const Ranges& ranges) {
-  auto nulls = vector->rawNulls();
   auto vals = vector->asFlatVector<INT>()->rawValues();
-  if (vector->mayHaveNulls()) {
-    for (auto& pos : ranges) {
-      if (bits::isBitNull(nulls, pos)) {
-        builder.setHasNull();
-      } else {
-        builder.addValues(vals[pos]);
-      }
-    }
-  } else {
-    for (auto& pos : ranges) {
-      builder.addValues(vals[pos]);
-    }
-  }
+  auto nulls = vector->mayHaveNulls() ? vector->rawNulls() : nullptr;
+  addFlatValues(builder, vals, nulls, ranges);
 }
 
 template <typename INT>
@@ -116,21 +137,9 @@ void StatisticsBuilderUtils::addValues(
     DoubleStatisticsBuilder& builder,
     const VectorPtr& vector,
     const Ranges& ranges) {
-  auto nulls = vector->rawNulls();
   auto vals = vector->asFlatVector<FLOAT>()->rawValues();
-  if (vector->mayHaveNulls()) {
-    for (auto& pos : ranges) {
-      if (bits::isBitNull(nulls, pos)) {
-        builder.setHasNull();
-      } else {
-        builder.addValues(vals[pos]);
-      }
-    }
-  } else {
-    for (auto& pos : ranges) {
-      builder.addValues(vals[pos]);
-    }
-  }
+  auto nulls = vector->mayHaveNulls() ? vector->rawNulls() : nullptr;
+  addFlatValues(builder, vals, nulls, ranges);
 }
 
 } // namespace facebook::velox::dwrf
@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <mutex>
+
+#include <folly/Executor.h>
+#include <folly/container/F14Set.h>
 #include <gtest/gtest_prod.h>
 
 #include "velox/dwio/dwrf/common/Compression.h"
@@ -69,8 +73,7 @@ class WriterContext : public CompressionBufferPool {
     }
     validateConfigs();
     LOG(INFO) << fmt::format("Compression config: {}", compression);
-    compressionBuffer_ = std::make_unique<dwio::common::DataBuffer<char>>(
-        generalPool_, compressionBlockSize + PAGE_HEADER_SIZE);
+    compressionBuffers_.push_back(newCompressionBuffer());
   }
 
   bool hasStream(const StreamIdentifier& stream) const {
@@ -95,6 +98,9 @@ class WriterContext : public CompressionBufferPool {
   // flush policy evaluation and would be more accurate after flush.
   std::unique_ptr<BufferedOutputStream> newStream(
       const StreamIdentifier& stream) {
+    // Column writers that switch encoding while writing add streams, and the
+    // columns may be written concurrently.
+    std::unique_lock<std::mutex> l(streamsMutex_);
     DWIO_ENSURE(
         !hasStream(stream), "Stream already exists ", stream.toString());
     streams_.emplace(
@@ -109,7 +115,10 @@ class WriterContext : public CompressionBufferPool {
     auto encrypter = handler_->isEncrypted(stream.node)
         ? std::addressof(handler_->getEncryptionProvider(stream.node))
         : nullptr;
-    return newStream(compression, holder, encrypter);
+    auto zstdState = newZstdStreamState(stream.node, encrypter != nullptr);
+    l.unlock();
+    return createCompressor(
+        compression, *this, holder, *config_, encrypter, std::move(zstdState));
   }
 
   std::unique_ptr<DataBufferHolder> newDataBufferHolder(
@@ -186,6 +195,26 @@ class WriterContext : public CompressionBufferPool {
     for (auto& pair : streams_) {
       pair.second.reset();
     }
+    if (adaptiveZstdLevel_) {
+      adaptZstdLevels();
+    }
+  }
+
+  // Trains the ZSTD dictionaries of the columns on the first stripe. Returns
+  // the serialized dictionaries by node, which must be stored in the file
+  // metadata.
+  std::vector<std::pair<uint32_t, std::string>> trainZstdDictionaries() {
+    std::vector<std::pair<uint32_t, std::string>> dictionaries;
+    folly::F14FastSet<uint32_t> ids;
+    std::lock_guard<std::mutex> l(streamsMutex_);
+    for (auto& [node, dictionary] : zstdDictionaries_) {
+      // The reader finds a dictionary by its id, which must be unique.
+      if (dictionary->train() && ids.insert(dictionary->id()).second) {
+        dictionary->activate();
+        dictionaries.emplace_back(node, dictionary->bytes());
+      }
+    }
+    return dictionaries;
   }
 
   void incRowCount(uint64_t count) {
@@ -264,12 +293,18 @@ class WriterContext : public CompressionBufferPool {
 
   // Used by FlatMapColumnWriter to remove previously registered
   // dictionary encoders. This logic exists due to how FlatMapColumnWriter
-  // cleans up its value writer streams upon reset().
+  // cleans up the streams of the value writers it removes.
   void removeAllIntDictionaryEncodersOnNode(
       std::function<bool(uint32_t)> predicate) {
+    removeIntDictionaryEncoders(
+        [&](const EncodingKey& ek) { return predicate(ek.node); });
+  }
+
+  void removeIntDictionaryEncoders(
+      std::function<bool(const EncodingKey&)> predicate) {
     auto iter = dictEncoders_.begin();
     while (iter != dictEncoders_.end()) {
-      if (predicate(iter->first.node)) {
+      if (predicate(iter->first)) {
         iter = dictEncoders_.erase(iter);
       } else {
         ++iter;
@@ -277,6 +312,23 @@ class WriterContext : public CompressionBufferPool {
     }
   }
 
+  // Drops the reference of a destroyed writer to the dictionary encoder of
+  // 'ek', if any. The encoder and its stream are removed with the last
+  // reference, so that a flat map dictionary shared by value writers is
+  // cleared after each stripe by the writers that remain.
+  void releaseIntDictionaryEncoder(const EncodingKey& ek) {
+    auto iter = dictEncoders_.find(ek);
+    if (iter == dictEncoders_.end() || iter->second->dropRefCount() > 0) {
+      return;
+    }
+    dictEncoders_.erase(iter);
+    removeStreams([&](const StreamIdentifier& identifier) {
+      return identifier.node == ek.node &&
+          identifier.sequence == ek.sequence &&
+          identifier.kind == StreamKind::StreamKind_DICTIONARY_DATA;
+    });
+  }
+
   virtual void removeStreams(
       std::function<bool(const StreamIdentifier&)> predicate) {
     auto it = streams_.begin();
@@ -289,18 +341,40 @@ class WriterContext : public CompressionBufferPool {
     }
   }
 
+  // Compression buffers are pooled, since the columns are written
+  // concurrently when there is an executor. A serial writer uses only one.
   std::unique_ptr<dwio::common::DataBuffer<char>> getBuffer(
       uint64_t size) override {
-    DWIO_ENSURE_NOT_NULL(compressionBuffer_);
-    DWIO_ENSURE_GE(compressionBuffer_->size(), size);
-    return std::move(compressionBuffer_);
+    std::unique_ptr<dwio::common::DataBuffer<char>> buffer;
+    {
+      std::lock_guard<std::mutex> l(poolMutex_);
+      if (!compressionBuffers_.empty()) {
+        buffer = std::move(compressionBuffers_.back());
+        compressionBuffers_.pop_back();
+      }
+    }
+    if (!buffer) {
+      buffer = newCompressionBuffer();
+    }
+    DWIO_ENSURE_GE(buffer->size(), size);
+    return buffer;
   }
 
   void returnBuffer(
       std::unique_ptr<dwio::common::DataBuffer<char>> buffer) override {
     DWIO_ENSURE_NOT_NULL(buffer);
-    DWIO_ENSURE(!compressionBuffer_);
-    compressionBuffer_ = std::move(buffer);
+    std::lock_guard<std::mutex> l(poolMutex_);
+    compressionBuffers_.push_back(std::move(buffer));
+  }
+
+  // Sets the executor on which the root writer writes its children
+  // concurrently. nullptr writes them on the calling thread.
+  void setExecutor(folly::Executor* FOLLY_NULLABLE executor) {
+    executor_ = executor;
+  }
+
+  folly::Executor* FOLLY_NULLABLE executor() const {
+    return executor_;
   }
 
   void incrementNodeSize(uint32_t node, uint64_t size) {
@@ -414,19 +488,101 @@ class WriterContext : public CompressionBufferPool {
     return LocalDecodedVector{*this};
   }
 
-  SelectivityVector& getSharedSelectivityVector(velox::vector_size_t size) {
-    if (UNLIKELY(!selectivityVector_)) {
-      selectivityVector_ = std::make_unique<velox::SelectivityVector>(size);
-    } else {
-      selectivityVector_->resize(size);
+  class LocalSelectivityVector {
+   public:
+    LocalSelectivityVector(WriterContext& context, velox::vector_size_t size)
+        : context_(context), vector_(context_.getSelectivityVector(size)) {}
+
+    LocalSelectivityVector(LocalSelectivityVector&& other) noexcept
+        : context_{other.context_}, vector_{std::move(other.vector_)} {}
+
+    LocalSelectivityVector& operator=(LocalSelectivityVector&& other) =
+        delete;
+
+    ~LocalSelectivityVector() {
+      if (vector_) {
+        context_.releaseSelectivityVector(std::move(vector_));
+      }
+    }
+
+    SelectivityVector& get() {
+      return *vector_;
     }
-    return *selectivityVector_;
+
+   private:
+    WriterContext& context_;
+    std::unique_ptr<velox::SelectivityVector> vector_;
+  };
+
+  LocalSelectivityVector getLocalSelectivityVector(
+      velox::vector_size_t size) {
+    return LocalSelectivityVector{*this, size};
   }
 
  private:
   void validateConfigs() const;
 
+  // Returns the state of the ZSTD compressor of a new stream of 'node' or
+  // nullptr if the stream only uses the configured level. The dictionary of
+  // an encrypted column would leak its content into the file metadata, so
+  // these compress without one.
+  std::shared_ptr<ZstdStreamState> newZstdStreamState(
+      uint32_t node,
+      bool encrypted) {
+    if (compression != CompressionKind::CompressionKind_ZSTD ||
+        (zstdDictionarySize_ == 0 && !adaptiveZstdLevel_)) {
+      return nullptr;
+    }
+    std::shared_ptr<ZstdDictionary> dictionary;
+    // Only the streams of the first stripe train dictionaries.
+    if (zstdDictionarySize_ > 0 && !encrypted &&
+        (stripeIndex == 0 || zstdDictionaries_.count(node))) {
+      auto& entry = zstdDictionaries_[node];
+      if (!entry) {
+        entry = std::make_shared<ZstdDictionary>(
+            zstdDictionarySize_,
+            uint64_t{zstdDictionarySize_} * kZstdSampleBytesPerDictionaryByte);
+      }
+      dictionary = entry;
+    }
+    auto state = std::make_shared<ZstdStreamState>(
+        getConfig(Config::ZSTD_COMPRESSION_LEVEL), std::move(dictionary));
+    if (adaptiveZstdLevel_) {
+      zstdStreams_.push_back({state, CompressionRatioTracker{}});
+    }
+    return state;
+  }
+
+  // Compresses the streams whose compression ratio over the stripes so far
+  // is poor with the fast level.
+  void adaptZstdLevels() {
+    auto level = getConfig(Config::ZSTD_COMPRESSION_LEVEL);
+    std::lock_guard<std::mutex> l(streamsMutex_);
+    auto it = zstdStreams_.begin();
+    while (it != zstdStreams_.end()) {
+      auto state = it->state.lock();
+      if (!state) {
+        it = zstdStreams_.erase(it);
+        continue;
+      }
+      auto [rawSize, compressedSize] = state->takeBlockSizes();
+      it->ratio.takeSample(rawSize, compressedSize);
+      state->setLevel(
+          it->ratio.getSampleSize() > 0 &&
+                  it->ratio.getEstimatedRatio() > kPoorZstdCompressionRatio
+              ? std::min(level, kFastZstdLevel)
+              : level);
+      ++it;
+    }
+  }
+
+  std::unique_ptr<dwio::common::DataBuffer<char>> newCompressionBuffer() {
+    return std::make_unique<dwio::common::DataBuffer<char>>(
+        generalPool_, compressionBlockSize + PAGE_HEADER_SIZE);
+  }
+
   std::unique_ptr<velox::DecodedVector> getDecodedVector() {
+    std::lock_guard<std::mutex> l(poolMutex_);
     if (decodedVectorPool_.empty()) {
       return std::make_unique<velox::DecodedVector>();
     }
@@ -436,9 +592,33 @@ class WriterContext : public CompressionBufferPool {
   }
 
   void releaseDecodedVector(std::unique_ptr<velox::DecodedVector>&& vector) {
+    std::lock_guard<std::mutex> l(poolMutex_);
     decodedVectorPool_.push_back(std::move(vector));
   }
 
+  std::unique_ptr<velox::SelectivityVector> getSelectivityVector(
+      velox::vector_size_t size) {
+    std::unique_ptr<velox::SelectivityVector> vector;
+    {
+      std::lock_guard<std::mutex> l(poolMutex_);
+      if (!selectivityVectorPool_.empty()) {
+        vector = std::move(selectivityVectorPool_.back());
+        selectivityVectorPool_.pop_back();
+      }
+    }
+    if (!vector) {
+      return std::make_unique<velox::SelectivityVector>(size);
+    }
+    vector->resize(size);
+    return vector;
+  }
+
+  void releaseSelectivityVector(
+      std::unique_ptr<velox::SelectivityVector>&& vector) {
+    std::lock_guard<std::mutex> l(poolMutex_);
+    selectivityVectorPool_.push_back(std::move(vector));
+  }
+
   std::shared_ptr<const Config> config_;
   std::unique_ptr<memory::ScopedMemoryPool> scopedPool_;
   memory::MemoryPool& pool_;
@@ -449,6 +629,7 @@ class WriterContext : public CompressionBufferPool {
   // another class.
   folly::F14NodeMap<StreamIdentifier, DataBufferHolder, StreamIdentifierHash>
       streams_;
+  std::mutex streamsMutex_;
   folly::F14FastMap<
       EncodingKey,
       std::unique_ptr<AbstractIntegerDictionaryEncoder>,
@@ -457,13 +638,40 @@ class WriterContext : public CompressionBufferPool {
   std::function<std::unique_ptr<IndexBuilder>(
       std::unique_ptr<BufferedOutputStream>)>
       indexBuilderFactory_;
-  std::unique_ptr<dwio::common::DataBuffer<char>> compressionBuffer_;
+  folly::Executor* FOLLY_NULLABLE executor_{nullptr};
+  // Serializes access to the pools below, which the column writers share.
+  std::mutex poolMutex_;
+  std::vector<std::unique_ptr<dwio::common::DataBuffer<char>>>
+      compressionBuffers_;
   // A pool of reusable DecodedVectors.
   std::vector<std::unique_ptr<velox::DecodedVector>> decodedVectorPool_;
-  // Reusable SelectivityVector
-  std::unique_ptr<velox::SelectivityVector> selectivityVector_;
+  // A pool of reusable SelectivityVectors.
+  std::vector<std::unique_ptr<velox::SelectivityVector>>
+      selectivityVectorPool_;
 
   std::unique_ptr<encryption::EncryptionHandler> handler_;
+
+  // Samples of the first stripe per dictionary byte.
+  static constexpr uint64_t kZstdSampleBytesPerDictionaryByte = 100;
+  // Streams that compress worse than this use kFastZstdLevel.
+  static constexpr float kPoorZstdCompressionRatio = 0.9f;
+  static constexpr int32_t kFastZstdLevel = 1;
+
+  struct ZstdStream {
+    // Expires when the stream is removed.
+    std::weak_ptr<ZstdStreamState> state;
+    CompressionRatioTracker ratio;
+  };
+
+  const uint32_t zstdDictionarySize_{
+      getConfig(Config::ZSTD_DICTIONARY_SIZE)};
+  const bool adaptiveZstdLevel_{getConfig(Config::ZSTD_ADAPTIVE_LEVEL)};
+  // The ZSTD dictionaries by node. Guarded by 'streamsMutex_'.
+  folly::F14FastMap<uint32_t, std::shared_ptr<ZstdDictionary>>
+      zstdDictionaries_;
+  // The streams whose level adapts to their compression ratio. Guarded by
+  // 'streamsMutex_'.
+  std::vector<ZstdStream> zstdStreams_;
   folly::F14FastMap<uint32_t, uint64_t> nodeSize;
   CompressionRatioTracker compressionRatioTracker_;
   FlushOverheadRatioTracker flushOverheadRatioTracker_;
@@ -359,11 +359,8 @@ void WriterShared::flushStripe(bool close) {
   auto planner = layoutPlannerFactory_(getStreamList(context), encodingManager);
   planner->plan();
   planner->iterateIndexStreams([&](auto& streamId, auto& content) {
-    DWIO_ENSURE_EQ(
-        streamId.kind,
-        StreamKind::StreamKind_ROW_INDEX,
-        "unexpected stream kind ",
-        streamId.kind);
+    DWIO_ENSURE(
+        isIndexStream(streamId.kind), "unexpected stream kind ", streamId.kind);
     indexLength += content.size();
     addStream(streamId, content);
     sink.addBuffers(content);
@@ -372,9 +369,8 @@ void WriterShared::flushStripe(bool close) {
   uint64_t dataLength = 0;
   sink.setMode(WriterSink::Mode::Data);
   planner->iterateDataStreams([&](auto& streamId, auto& content) {
-    DWIO_ENSURE_NE(
-        streamId.kind,
-        StreamKind::StreamKind_ROW_INDEX,
+    DWIO_ENSURE(
+        !isIndexStream(streamId.kind),
         "unexpected stream kind ",
         streamId.kind);
     dataLength += content.size();
@@ -446,6 +442,14 @@ void WriterShared::flushStripe(bool close) {
   // Add flush overhead and other ratio logging.
   context.metricLogger->logStripeFlush(metrics);
 
+  // The first stripe trains the ZSTD dictionaries of the later ones.
+  if (context.stripeIndex == 0 && !close) {
+    for (auto& [node, dictionary] : context.trainZstdDictionaries()) {
+      addUserMetadata(
+          kZstdDictionaryKeyPrefix.str() + std::to_string(node), dictionary);
+    }
+  }
+
   // prepare for next stripe
   context.nextStripe();
   resetImpl();
@@ -119,6 +119,9 @@ struct WriterOptionsShared {
   std::shared_ptr<encryption::EncryptionSpecification> encryptionSpec;
   std::shared_ptr<dwio::common::encryption::EncrypterFactory> encrypterFactory;
   int64_t memoryBudget = std::numeric_limits<int64_t>::max();
+  // If set, the top level columns are encoded and compressed concurrently on
+  // this executor. Flat maps are always written on the calling thread.
+  folly::Executor* executor = nullptr;
 };
 
 class WriterShared : public WriterBase {
@@ -145,6 +148,7 @@ class WriterShared : public WriterBase {
                 folly::to<std::string>(folly::Random::rand64())),
             std::min(options.memoryBudget, parentPool.getCap())),
         std::move(handler));
+    getContext().setExecutor(options.executor);
     if (!flushPolicy_) {
       auto& context = getContext();
       flushPolicy_ = DefaultFlushPolicy(
@@ -25,6 +25,10 @@ namespace {
 
 ::duckdb::Value makeValue(::duckdb::LogicalType type, int64_t val) {
   switch (type.id()) {
+    case ::duckdb::LogicalTypeId::TINYINT:
+      return ::duckdb::Value::TINYINT(val);
+    case ::duckdb::LogicalTypeId::SMALLINT:
+      return ::duckdb::Value::SMALLINT(val);
     case ::duckdb::LogicalTypeId::INTEGER:
       return ::duckdb::Value::INTEGER(val);
     case ::duckdb::LogicalTypeId::BIGINT:
@@ -37,57 +41,275 @@ namespace {
   }
 }
 
-void toDuckDbFilter(
-    uint64_t colIdx,
+::duckdb::Value makeValue(::duckdb::LogicalType type, double val) {
+  switch (type.id()) {
+    case ::duckdb::LogicalTypeId::FLOAT:
+      return ::duckdb::Value::FLOAT(val);
+    case ::duckdb::LogicalTypeId::DOUBLE:
+      return ::duckdb::Value::DOUBLE(val);
+    default:
+      VELOX_UNSUPPORTED(
+          "Unsupported column type for floating point filter: {}",
+          type.ToString());
+  }
+}
+
+::duckdb::Value makeValue(::duckdb::LogicalType type, const std::string& val) {
+  switch (type.id()) {
+    case ::duckdb::LogicalTypeId::VARCHAR:
+      return ::duckdb::Value(val);
+    case ::duckdb::LogicalTypeId::BLOB:
+      return ::duckdb::Value::BLOB_RAW(val);
+    default:
+      VELOX_UNSUPPORTED(
+          "Unsupported column type for string filter: {}", type.ToString());
+  }
+}
+
+std::unique_ptr<::duckdb::TableFilter> makeComparison(
+    ::duckdb::ExpressionType comparison,
+    ::duckdb::Value value) {
+  return std::make_unique<::duckdb::ConstantFilter>(
+      comparison, std::move(value));
+}
+
+// Returns the conjunction of 'filters' or nullptr if 'filters' is empty.
+std::unique_ptr<::duckdb::TableFilter> makeAnd(
+    std::vector<std::unique_ptr<::duckdb::TableFilter>> filters) {
+  if (filters.empty()) {
+    return nullptr;
+  }
+  if (filters.size() == 1) {
+    return std::move(filters[0]);
+  }
+  auto conjunction = std::make_unique<::duckdb::ConjunctionAndFilter>();
+  for (auto& filter : filters) {
+    conjunction->child_filters.push_back(std::move(filter));
+  }
+  return conjunction;
+}
+
+std::unique_ptr<::duckdb::TableFilter> makeOr(
+    std::vector<std::unique_ptr<::duckdb::TableFilter>> filters) {
+  VELOX_CHECK(!filters.empty());
+  if (filters.size() == 1) {
+    return std::move(filters[0]);
+  }
+  auto disjunction = std::make_unique<::duckdb::ConjunctionOrFilter>();
+  for (auto& filter : filters) {
+    disjunction->child_filters.push_back(std::move(filter));
+  }
+  return disjunction;
+}
+
+// Returns the comparisons for a range. Exclusive bounds are used only
+// for types where a filter cannot adjust the bound to the neighboring
+// value.
+template <typename T>
+std::unique_ptr<::duckdb::TableFilter> makeRange(
     ::duckdb::LogicalType type,
-    common::Filter* filter,
-    ::duckdb::TableFilterSet& filters) {
-  switch (filter->kind()) {
-    case common::FilterKind::kBigintRange: {
-      auto rangeFilter = static_cast<common::BigintRange*>(filter);
-      if (rangeFilter->lower() == rangeFilter->upper()) {
-        filters.PushFilter(
-            colIdx,
-            std::make_unique<::duckdb::ConstantFilter>(
-                ::duckdb::ExpressionType::COMPARE_EQUAL,
-                makeValue(type, rangeFilter->lower())));
-      } else {
-        if (rangeFilter->lower() != std::numeric_limits<int64_t>::min()) {
-          filters.PushFilter(
-              colIdx,
-              std::make_unique<::duckdb::ConstantFilter>(
-                  ::duckdb::ExpressionType::COMPARE_GREATERTHANOREQUALTO,
-                  makeValue(type, rangeFilter->lower())));
-        }
-        if (rangeFilter->upper() != std::numeric_limits<int64_t>::max()) {
-          filters.PushFilter(
-              colIdx,
-              std::make_unique<::duckdb::ConstantFilter>(
-                  ::duckdb::ExpressionType::COMPARE_LESSTHANOREQUALTO,
-                  makeValue(type, rangeFilter->upper())));
-        }
-      }
-    } break;
+    const T& lower,
+    bool lowerUnbounded,
+    bool lowerExclusive,
+    const T& upper,
+    bool upperUnbounded,
+    bool upperExclusive) {
+  std::vector<std::unique_ptr<::duckdb::TableFilter>> bounds;
+  if (!lowerUnbounded) {
+    bounds.push_back(makeComparison(
+        lowerExclusive
+            ? ::duckdb::ExpressionType::COMPARE_GREATERTHAN
+            : ::duckdb::ExpressionType::COMPARE_GREATERTHANOREQUALTO,
+        makeValue(type, lower)));
+  }
+  if (!upperUnbounded) {
+    bounds.push_back(makeComparison(
+        upperExclusive ? ::duckdb::ExpressionType::COMPARE_LESSTHAN
+                       : ::duckdb::ExpressionType::COMPARE_LESSTHANOREQUALTO,
+        makeValue(type, upper)));
+  }
+  return makeAnd(std::move(bounds));
+}
 
-    case common::FilterKind::kAlwaysFalse:
+template <typename T>
+std::unique_ptr<::duckdb::TableFilter> makeIn(
+    ::duckdb::LogicalType type,
+    const T& values) {
+  std::vector<std::unique_ptr<::duckdb::TableFilter>> equals;
+  for (const auto& value : values) {
+    equals.push_back(makeComparison(
+        ::duckdb::ExpressionType::COMPARE_EQUAL, makeValue(type, value)));
+  }
+  return makeOr(std::move(equals));
+}
+
+// Translates the condition 'filter' places on non-null values of a
+// column of 'type'. DuckDB comparisons pass nulls, so the caller adds
+// the null check. Returns nullptr if all non-null values pass.
+std::unique_ptr<::duckdb::TableFilter> toDuckDbValueFilter(
+    ::duckdb::LogicalType type,
+    const common::Filter* filter) {
+  switch (filter->kind()) {
     case common::FilterKind::kAlwaysTrue:
-    case common::FilterKind::kIsNull:
     case common::FilterKind::kIsNotNull:
+      return nullptr;
+
+    case common::FilterKind::kAlwaysFalse:
+    case common::FilterKind::kIsNull: {
+      // No non-null value passes.
+      std::vector<std::unique_ptr<::duckdb::TableFilter>> filters;
+      filters.push_back(std::make_unique<::duckdb::IsNullFilter>());
+      filters.push_back(std::make_unique<::duckdb::IsNotNullFilter>());
+      return makeAnd(std::move(filters));
+    }
+
     case common::FilterKind::kBoolValue:
+      return makeComparison(
+          ::duckdb::ExpressionType::COMPARE_EQUAL,
+          ::duckdb::Value::BOOLEAN(filter->testBool(true)));
+
+    case common::FilterKind::kBigintRange: {
+      auto rangeFilter = static_cast<const common::BigintRange*>(filter);
+      if (rangeFilter->isSingleValue()) {
+        return makeComparison(
+            ::duckdb::ExpressionType::COMPARE_EQUAL,
+            makeValue(type, rangeFilter->lower()));
+      }
+      return makeRange<int64_t>(
+          type,
+          rangeFilter->lower(),
+          rangeFilter->lower() == std::numeric_limits<int64_t>::min(),
+          false,
+          rangeFilter->upper(),
+          rangeFilter->upper() == std::numeric_limits<int64_t>::max(),
+          false);
+    }
+
     case common::FilterKind::kBigintValuesUsingHashTable:
+      return makeIn(
+          type,
+          static_cast<const common::BigintValuesUsingHashTable*>(filter)
+              ->values());
+
     case common::FilterKind::kBigintValuesUsingBitmask:
-    case common::FilterKind::kDoubleRange:
-    case common::FilterKind::kFloatRange:
-    case common::FilterKind::kBytesRange:
+      return makeIn(
+          type,
+          static_cast<const common::BigintValuesUsingBitmask*>(filter)
+              ->values());
+
+    case common::FilterKind::kBigintValuesUsingBloomFilter: {
+      // Passes the range of the values. The Bloom filter passes a superset
+      // of the values anyway.
+      auto bloomFilter =
+          static_cast<const common::BigintValuesUsingBloomFilter*>(filter);
+      return makeRange<int64_t>(
+          type,
+          bloomFilter->min(),
+          false,
+          false,
+          bloomFilter->max(),
+          false,
+          false);
+    }
+
+    case common::FilterKind::kDoubleRange: {
+      auto range = static_cast<const common::DoubleRange*>(filter);
+      return makeRange<double>(
+          type,
+          range->lower(),
+          range->isLowerUnbounded(),
+          range->isLowerExclusive(),
+          range->upper(),
+          range->isUpperUnbounded(),
+          range->isUpperExclusive());
+    }
+
+    case common::FilterKind::kFloatRange: {
+      auto range = static_cast<const common::FloatRange*>(filter);
+      return makeRange<double>(
+          type,
+          range->lower(),
+          range->isLowerUnbounded(),
+          range->isLowerExclusive(),
+          range->upper(),
+          range->isUpperUnbounded(),
+          range->isUpperExclusive());
+    }
+
+    case common::FilterKind::kBytesRange: {
+      auto range = static_cast<const common::BytesRange*>(filter);
+      if (range->isSingleValue()) {
+        return makeComparison(
+            ::duckdb::ExpressionType::COMPARE_EQUAL,
+            makeValue(type, range->lower()));
+      }
+      return makeRange<std::string>(
+          type,
+          range->lower(),
+          range->isLowerUnbounded(),
+          range->isLowerExclusive(),
+          range->upper(),
+          range->isUpperUnbounded(),
+          range->isUpperExclusive());
+    }
+
     case common::FilterKind::kBytesValues:
-    case common::FilterKind::kBigintMultiRange:
-    case common::FilterKind::kMultiRange:
+      return makeIn(
+          type, static_cast<const common::BytesValues*>(filter)->values());
+
+    case common::FilterKind::kBigintMultiRange: {
+      std::vector<std::unique_ptr<::duckdb::TableFilter>> ranges;
+      for (auto& range :
+           static_cast<const common::BigintMultiRange*>(filter)->ranges()) {
+        auto duckRange = toDuckDbValueFilter(type, range.get());
+        if (!duckRange) {
+          return nullptr;
+        }
+        ranges.push_back(std::move(duckRange));
+      }
+      return makeOr(std::move(ranges));
+    }
+
+    case common::FilterKind::kMultiRange: {
+      auto multiRange = static_cast<const common::MultiRange*>(filter);
+      VELOX_CHECK(
+          !multiRange->nanAllowed(),
+          "NaN passing filters are NYI in parquet reader: {}",
+          filter->toString());
+      std::vector<std::unique_ptr<::duckdb::TableFilter>> ranges;
+      for (auto& child : multiRange->filters()) {
+        auto duckChild = toDuckDbValueFilter(type, child.get());
+        if (!duckChild) {
+          return nullptr;
+        }
+        ranges.push_back(std::move(duckChild));
+      }
+      return makeOr(std::move(ranges));
+    }
+
     default:
       VELOX_UNSUPPORTED(
           "Unsupported filter in parquet reader: {}", filter->toString());
   }
 }
 
+void toDuckDbFilter(
+    uint64_t colIdx,
+    ::duckdb::LogicalType type,
+    common::Filter* filter,
+    ::duckdb::TableFilterSet& filters) {
+  if (filter->kind() == common::FilterKind::kIsNull) {
+    filters.PushFilter(colIdx, std::make_unique<::duckdb::IsNullFilter>());
+    return;
+  }
+  if (auto valueFilter = toDuckDbValueFilter(type, filter)) {
+    filters.PushFilter(colIdx, std::move(valueFilter));
+  }
+  if (!filter->testNull()) {
+    filters.PushFilter(colIdx, std::make_unique<::duckdb::IsNotNullFilter>());
+  }
+}
+
 } // anonymous namespace
 
 ParquetRowReader::ParquetRowReader(
@@ -233,6 +233,48 @@ TEST_F(ParquetReaderTest, testReadSampleEqualFilter) {
   assertReadExpected(*rowReader, expected);
 }
 
+TEST_F(ParquetReaderTest, testReadSampleDoubleAndInFilters) {
+  const std::string sample(getExampleFilePath("sample.parquet"));
+
+  ReaderOptions readerOptions;
+  ParquetReader reader(
+      std::make_unique<FileInputStream>(sample), readerOptions);
+
+  RowReaderOptions rowReaderOpts = getSampleReaderOpts();
+  common::ScanSpec scanSpec("");
+  scanSpec.getOrCreateChild(common::Subfield("a"))
+      ->setFilter(common::test::in({2, 5, 17, 19, 20}));
+  scanSpec.getOrCreateChild(common::Subfield("b"))
+      ->setFilter(common::test::greaterThanDouble(17.0));
+  rowReaderOpts.setScanSpec(&scanSpec);
+  auto rowReader = reader.createRowReader(rowReaderOpts);
+  auto expected = vectorMaker_->rowVector(
+      {vectorMaker_->flatVector<int64_t>({19, 20}),
+       vectorMaker_->flatVector<double>({19.0, 20.0})});
+  assertReadExpected(*rowReader, expected);
+}
+
+TEST_F(ParquetReaderTest, testReadSampleMultiRangeFilter) {
+  const std::string sample(getExampleFilePath("sample.parquet"));
+
+  ReaderOptions readerOptions;
+  ParquetReader reader(
+      std::make_unique<FileInputStream>(sample), readerOptions);
+
+  RowReaderOptions rowReaderOpts = getSampleReaderOpts();
+  common::ScanSpec scanSpec("");
+  scanSpec.getOrCreateChild(common::Subfield("a"))
+      ->setFilter(common::test::bigintOr(
+          common::test::lessThan(3), common::test::greaterThan(18)));
+  scanSpec.getOrCreateChild(common::Subfield("b"));
+  rowReaderOpts.setScanSpec(&scanSpec);
+  auto rowReader = reader.createRowReader(rowReaderOpts);
+  auto expected = vectorMaker_->rowVector(
+      {vectorMaker_->flatVector<int64_t>({1, 2, 19, 20}),
+       vectorMaker_->flatVector<double>({1.0, 2.0, 19.0, 20.0})});
+  assertReadExpected(*rowReader, expected);
+}
+
 TEST_F(ParquetReaderTest, testDateRead) {
   // date.parquet holds a single column (date: DATE) and
   // 25 rows.
@@ -0,0 +1,563 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/dwio/text/reader/TextReader.h"
+
+#include <folly/Conv.h>
+#include <cctype>
+#include <cstring>
+#include <numeric>
+#include "velox/dwio/common/ScanSpec.h"
+#include "velox/dwio/common/exception/Exception.h"
+#include "velox/type/Filter.h"
+#include "velox/type/StringToNumber.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::text {
+
+namespace {
+
+// Bytes read from the file at a time. The buffer grows for longer lines.
+constexpr uint64_t kBlockSize = 1 << 20;
+
+// Bytes read at a time past the end of the range for its last line.
+constexpr uint64_t kMinReadSize = 64 << 10;
+
+// Used for estimatedRowSize() before the first batch.
+constexpr size_t kDefaultRowSize = 100;
+
+bool parseValue(std::string_view text, bool& value) {
+  auto equals = [&](const char* word) {
+    auto size = strlen(word);
+    if (text.size() != size) {
+      return false;
+    }
+    for (size_t i = 0; i < size; ++i) {
+      if (tolower(text[i]) != word[i]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (equals("true")) {
+    value = true;
+    return true;
+  }
+  if (equals("false")) {
+    value = false;
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+std::enable_if_t<std::is_integral_v<T>, bool> parseValue(
+    std::string_view text,
+    T& value) {
+  return util::tryParseInteger(text.data(), text.data() + text.size(), value);
+}
+
+bool parseValue(std::string_view text, double& value) {
+  if (util::tryParseSimpleDouble(
+          text.data(), text.data() + text.size(), value)) {
+    return true;
+  }
+  auto result = folly::tryTo<double>(folly::StringPiece(text));
+  if (result.hasValue()) {
+    value = result.value();
+    return true;
+  }
+  return false;
+}
+
+bool parseValue(std::string_view text, float& value) {
+  auto result = folly::tryTo<float>(folly::StringPiece(text));
+  if (result.hasValue()) {
+    value = result.value();
+    return true;
+  }
+  return false;
+}
+
+// True if row 'index' of 'vector' passes 'filter'.
+bool testFilter(
+    const velox::common::Filter& filter,
+    const BaseVector& vector,
+    vector_size_t index) {
+  if (vector.isNullAt(index)) {
+    return filter.testNull();
+  }
+  switch (vector.typeKind()) {
+    case TypeKind::BOOLEAN:
+      return filter.testBool(
+          vector.asUnchecked<SimpleVector<bool>>()->valueAt(index));
+    case TypeKind::TINYINT:
+      return filter.testInt64(
+          vector.asUnchecked<SimpleVector<int8_t>>()->valueAt(index));
+    case TypeKind::SMALLINT:
+      return filter.testInt64(
+          vector.asUnchecked<SimpleVector<int16_t>>()->valueAt(index));
+    case TypeKind::INTEGER:
+      return filter.testInt64(
+          vector.asUnchecked<SimpleVector<int32_t>>()->valueAt(index));
+    case TypeKind::BIGINT:
+      return filter.testInt64(
+          vector.asUnchecked<SimpleVector<int64_t>>()->valueAt(index));
+    case TypeKind::REAL:
+      return filter.testFloat(
+          vector.asUnchecked<SimpleVector<float>>()->valueAt(index));
+    case TypeKind::DOUBLE:
+      return filter.testDouble(
+          vector.asUnchecked<SimpleVector<double>>()->valueAt(index));
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY: {
+      auto value =
+          vector.asUnchecked<SimpleVector<StringView>>()->valueAt(index);
+      return filter.testBytes(value.data(), value.size());
+    }
+    default:
+      VELOX_NYI("Text reader does not filter {}", vector.type()->toString());
+  }
+}
+
+} // namespace
+
+TextRowReader::TextRowReader(
+    dwio::common::InputStream& input,
+    RowTypePtr fileType,
+    const dwio::common::SerDeOptions& serDeOptions,
+    const dwio::common::RowReaderOptions& options,
+    memory::MemoryPool& pool)
+    : input_(input),
+      fileType_(std::move(fileType)),
+      serDeOptions_(serDeOptions),
+      scanSpec_(options.getScanSpec()),
+      pool_(pool),
+      fileLength_(input_.getLength()),
+      begin_(std::min(options.getOffset(), fileLength_)),
+      end_(
+          options.getLength() < fileLength_ - begin_
+              ? begin_ + options.getLength()
+              : fileLength_),
+      buffer_(pool) {
+  std::vector<bool> isRead(fileType_->size(), false);
+  if (scanSpec_) {
+    for (auto& spec : scanSpec_->children()) {
+      if (!spec->isConstant() && (spec->filter() || spec->projectOut())) {
+        isRead[fileColumn(spec->fieldName())] = true;
+      }
+    }
+  } else {
+    auto& selector = options.getSelector();
+    if (selector) {
+      selectedType_ = selector->buildSelectedReordered();
+      for (auto& node : selector->getProjection()) {
+        selectedColumns_.push_back(node.column);
+      }
+    } else {
+      selectedType_ = fileType_;
+      selectedColumns_.resize(fileType_->size());
+      std::iota(selectedColumns_.begin(), selectedColumns_.end(), 0);
+    }
+    for (auto column : selectedColumns_) {
+      VELOX_CHECK_LT(column, fileType_->size());
+      isRead[column] = true;
+    }
+  }
+  slots_.resize(fileType_->size(), -1);
+  for (auto i = 0; i < isRead.size(); ++i) {
+    if (isRead[i]) {
+      slots_[i] = columns_.size();
+      columns_.push_back(i);
+    }
+  }
+  // Starts one byte early so that a range that starts right after a
+  // newline does not skip its first line.
+  bufferOffset_ = begin_ > 0 ? begin_ - 1 : 0;
+}
+
+int32_t TextRowReader::fileColumn(const std::string& name) const {
+  auto index = fileType_->getChildIdxIfExists(name);
+  VELOX_CHECK(
+      index.has_value(), "Column {} is not in the text file schema", name);
+  return index.value();
+}
+
+bool TextRowReader::readMore() {
+  auto unread = bufferSize_ - cursor_;
+  if (cursor_ > 0 && unread > 0) {
+    memmove(buffer_.data(), buffer_.data() + cursor_, unread);
+  }
+  bufferOffset_ += cursor_;
+  bufferSize_ = unread;
+  cursor_ = 0;
+  auto fileOffset = bufferOffset_ + bufferSize_;
+  if (fileOffset >= fileLength_) {
+    return false;
+  }
+  // Reads to the end of the range, so that a small range does not read
+  // much of the next one.
+  auto wanted = end_ > fileOffset ? std::min(end_ - fileOffset, kBlockSize) : 0;
+  auto size =
+      std::min(fileLength_ - fileOffset, std::max(wanted, kMinReadSize));
+  if (buffer_.capacity() < bufferSize_ + size) {
+    buffer_.reserve(std::max(bufferSize_ + size, 2 * buffer_.capacity()));
+  }
+  input_.read(
+      buffer_.data() + bufferSize_,
+      size,
+      fileOffset,
+      dwio::common::LogType::BLOCK);
+  bufferSize_ += size;
+  return true;
+}
+
+void TextRowReader::skipPartialLine() {
+  if (begin_ == 0) {
+    return;
+  }
+  for (;;) {
+    auto begin = buffer_.data() + cursor_;
+    auto newline = static_cast<const char*>(
+        memchr(begin, '\n', bufferSize_ - cursor_));
+    if (newline) {
+      cursor_ += newline - begin + 1;
+      return;
+    }
+    cursor_ = bufferSize_;
+    if (!readMore()) {
+      atEnd_ = true;
+      return;
+    }
+  }
+}
+
+bool TextRowReader::nextLine(std::string_view& line, bool mayRefill) {
+  for (;;) {
+    if (atEnd_ || bufferOffset_ + cursor_ >= end_) {
+      atEnd_ = true;
+      return false;
+    }
+    auto begin = buffer_.data() + cursor_;
+    auto available = bufferSize_ - cursor_;
+    // memchr compares 16 or 32 bytes per instruction.
+    auto newline = static_cast<const char*>(memchr(begin, '\n', available));
+    uint64_t size;
+    if (newline) {
+      size = newline - begin;
+      cursor_ += size + 1;
+    } else if (bufferOffset_ + bufferSize_ < fileLength_) {
+      if (!mayRefill) {
+        return false;
+      }
+      readMore();
+      continue;
+    } else if (available > 0) {
+      // The last line of the file has no newline.
+      size = available;
+      cursor_ += size;
+    } else {
+      atEnd_ = true;
+      return false;
+    }
+    if (size > 0 && begin[size - 1] == '\r') {
+      --size;
+    }
+    line = std::string_view(begin, size);
+    return true;
+  }
+}
+
+void TextRowReader::splitFields(std::string_view line, int32_t index) {
+  if (columns_.empty()) {
+    return;
+  }
+  auto fields = &fields_[index * columns_.size()];
+  std::fill(fields, fields + columns_.size(), std::string_view());
+  const char separator = serDeOptions_.separators[0];
+  const int32_t lastColumn = fileType_->size() - 1;
+  const int32_t maxColumn = columns_.back();
+  auto begin = line.data();
+  auto end = begin + line.size();
+  for (int32_t column = 0; column <= maxColumn; ++column) {
+    const char* fieldEnd;
+    if (column == lastColumn && serDeOptions_.lastColumnTakesRest) {
+      fieldEnd = end;
+    } else if (serDeOptions_.isEscaped) {
+      fieldEnd = begin;
+      while (fieldEnd < end && *fieldEnd != separator) {
+        fieldEnd += *fieldEnd == serDeOptions_.escapeChar ? 2 : 1;
+      }
+      fieldEnd = std::min(fieldEnd, end);
+    } else {
+      fieldEnd =
+          static_cast<const char*>(memchr(begin, separator, end - begin));
+      if (!fieldEnd) {
+        fieldEnd = end;
+      }
+    }
+    if (slots_[column] >= 0) {
+      fields[slots_[column]] = std::string_view(begin, fieldEnd - begin);
+    }
+    if (fieldEnd == end) {
+      break;
+    }
+    begin = fieldEnd + 1;
+  }
+}
+
+template <TypeKind Kind>
+VectorPtr TextRowReader::readColumnTyped(
+    int32_t column,
+    const TypePtr& type,
+    const std::vector<vector_size_t>& rows) {
+  using T = typename TypeTraits<Kind>::NativeType;
+  auto vector = BaseVector::create(type, rows.size(), &pool_);
+  auto flat = vector->asUnchecked<FlatVector<T>>();
+  for (auto i = 0; i < rows.size(); ++i) {
+    auto text = field(column, rows[i]);
+    T value;
+    if (isNullField(text) || !parseValue(text, value)) {
+      flat->setNull(i, true);
+    } else {
+      flat->set(i, value);
+    }
+  }
+  return vector;
+}
+
+template <>
+VectorPtr TextRowReader::readColumnTyped<TypeKind::VARCHAR>(
+    int32_t column,
+    const TypePtr& type,
+    const std::vector<vector_size_t>& rows) {
+  auto vector = BaseVector::create(type, rows.size(), &pool_);
+  auto flat = vector->asUnchecked<FlatVector<StringView>>();
+  const char escape = serDeOptions_.escapeChar;
+  for (auto i = 0; i < rows.size(); ++i) {
+    auto text = field(column, rows[i]);
+    if (isNullField(text)) {
+      flat->setNull(i, true);
+      continue;
+    }
+    if (serDeOptions_.isEscaped && memchr(text.data(), escape, text.size())) {
+      unescaped_.clear();
+      for (auto j = 0; j < text.size(); ++j) {
+        if (text[j] == escape && j + 1 < text.size()) {
+          auto c = text[++j];
+          unescaped_.push_back(c == 'n' ? '\n' : c == 'r' ? '\r' : c);
+        } else {
+          unescaped_.push_back(text[j]);
+        }
+      }
+      text = unescaped_;
+    }
+    // Copies 'text', which points into the read buffer.
+    flat->set(i, StringView(text.data(), text.size()));
+  }
+  return vector;
+}
+
+template <>
+VectorPtr TextRowReader::readColumnTyped<TypeKind::VARBINARY>(
+    int32_t column,
+    const TypePtr& type,
+    const std::vector<vector_size_t>& rows) {
+  return readColumnTyped<TypeKind::VARCHAR>(column, type, rows);
+}
+
+VectorPtr TextRowReader::readColumn(
+    int32_t column,
+    const TypePtr& type,
+    const std::vector<vector_size_t>& rows) {
+  switch (type->kind()) {
+    case TypeKind::BOOLEAN:
+      return readColumnTyped<TypeKind::BOOLEAN>(column, type, rows);
+    case TypeKind::TINYINT:
+      return readColumnTyped<TypeKind::TINYINT>(column, type, rows);
+    case TypeKind::SMALLINT:
+      return readColumnTyped<TypeKind::SMALLINT>(column, type, rows);
+    case TypeKind::INTEGER:
+      return readColumnTyped<TypeKind::INTEGER>(column, type, rows);
+    case TypeKind::BIGINT:
+      return readColumnTyped<TypeKind::BIGINT>(column, type, rows);
+    case TypeKind::REAL:
+      return readColumnTyped<TypeKind::REAL>(column, type, rows);
+    case TypeKind::DOUBLE:
+      return readColumnTyped<TypeKind::DOUBLE>(column, type, rows);
+    case TypeKind::VARCHAR:
+      return readColumnTyped<TypeKind::VARCHAR>(column, type, rows);
+    case TypeKind::VARBINARY:
+      return readColumnTyped<TypeKind::VARBINARY>(column, type, rows);
+    default:
+      VELOX_NYI("Text reader does not read {}", type->toString());
+  }
+}
+
+void TextRowReader::filterColumn(
+    int32_t column,
+    const TypePtr& type,
+    const velox::common::Filter& filter) {
+  auto values = readColumn(column, type, rows_);
+  vector_size_t numPassed = 0;
+  for (auto i = 0; i < rows_.size(); ++i) {
+    if (testFilter(filter, *values, i)) {
+      rows_[numPassed++] = rows_[i];
+    }
+  }
+  rows_.resize(numPassed);
+}
+
+VectorPtr TextRowReader::readWithScanSpec(
+    vector_size_t numLines,
+    const VectorPtr& result) {
+  VELOX_CHECK(result, "Text reader with a ScanSpec needs a result type");
+  auto& outputType = result->type()->asRow();
+  rows_.resize(numLines);
+  std::iota(rows_.begin(), rows_.end(), 0);
+  for (auto& spec : scanSpec_->children()) {
+    if (!spec->filter() || rows_.empty()) {
+      continue;
+    }
+    if (spec->isConstant()) {
+      if (!testFilter(*spec->filter(), *spec->constantValue(), 0)) {
+        rows_.clear();
+      }
+      continue;
+    }
+    auto column = fileColumn(spec->fieldName());
+    filterColumn(column, fileType_->childAt(column), *spec->filter());
+  }
+  vector_size_t numRows = rows_.size();
+  std::vector<VectorPtr> children(outputType.size());
+  for (auto& spec : scanSpec_->children()) {
+    if (!spec->projectOut()) {
+      continue;
+    }
+    auto channel = spec->channel();
+    VELOX_CHECK_LT(channel, children.size());
+    if (spec->isConstant()) {
+      children[channel] =
+          BaseVector::wrapInConstant(numRows, 0, spec->constantValue());
+    } else {
+      auto column = fileColumn(spec->fieldName());
+      children[channel] =
+          readColumn(column, outputType.childAt(channel), rows_);
+    }
+  }
+  for (auto i = 0; i < children.size(); ++i) {
+    if (!children[i]) {
+      children[i] = BaseVector::createNullConstant(
+          outputType.childAt(i), numRows, &pool_);
+    }
+  }
+  return std::make_shared<RowVector>(
+      &pool_, result->type(), BufferPtr(nullptr), numRows, children);
+}
+
+uint64_t TextRowReader::next(uint64_t size, velox::VectorPtr& result) {
+  if (!started_) {
+    started_ = true;
+    readMore();
+    skipPartialLine();
+  }
+  lines_.clear();
+  std::string_view line;
+  while (lines_.size() < size && nextLine(line, lines_.empty())) {
+    lines_.push_back(line);
+  }
+  vector_size_t numLines = lines_.size();
+  if (numLines == 0) {
+    return 0;
+  }
+  fields_.resize(numLines * columns_.size());
+  for (auto i = 0; i < numLines; ++i) {
+    splitFields(lines_[i], i);
+    numBytes_ += lines_[i].size() + 1;
+  }
+  numLines_ += numLines;
+
+  if (scanSpec_) {
+    result = readWithScanSpec(numLines, result);
+    return numLines;
+  }
+  rows_.resize(numLines);
+  std::iota(rows_.begin(), rows_.end(), 0);
+  std::vector<VectorPtr> children(selectedColumns_.size());
+  for (auto i = 0; i < children.size(); ++i) {
+    children[i] =
+        readColumn(selectedColumns_[i], selectedType_->childAt(i), rows_);
+  }
+  result = std::make_shared<RowVector>(
+      &pool_, selectedType_, BufferPtr(nullptr), numLines, children);
+  return numLines;
+}
+
+void TextRowReader::updateRuntimeStats(
+    dwio::common::RuntimeStatistics& /*stats*/) const {}
+
+size_t TextRowReader::estimatedRowSize() const {
+  return numLines_ > 0 ? numBytes_ / numLines_ : kDefaultRowSize;
+}
+
+TextReader::TextReader(
+    std::unique_ptr<dwio::common::InputStream> stream,
+    const dwio::common::ReaderOptions& options)
+    : stream_(std::move(stream)),
+      serDeOptions_(options.getSerDeOptions()),
+      pool_(options.getMemoryPool()),
+      type_(options.getFileSchema()) {
+  VELOX_USER_CHECK_NOT_NULL(type_, "Text files need a file schema");
+}
+
+std::optional<uint64_t> TextReader::numberOfRows() const {
+  return std::nullopt;
+}
+
+std::unique_ptr<dwio::common::ColumnStatistics> TextReader::columnStatistics(
+    uint32_t /*index*/) const {
+  return std::make_unique<dwio::common::ColumnStatistics>(
+      std::nullopt, std::nullopt, std::nullopt, std::nullopt);
+}
+
+const velox::RowTypePtr& TextReader::rowType() const {
+  return type_;
+}
+
+const std::shared_ptr<const dwio::common::TypeWithId>&
+TextReader::typeWithId() const {
+  if (!typeWithId_) {
+    typeWithId_ = dwio::common::TypeWithId::create(type_);
+  }
+  return typeWithId_;
+}
+
+std::unique_ptr<dwio::common::RowReader> TextReader::createRowReader(
+    const dwio::common::RowReaderOptions& options) const {
+  return std::make_unique<TextRowReader>(
+      *stream_, type_, serDeOptions_, options, pool_);
+}
+
+void registerTextReaderFactory() {
+  dwio::common::registerReaderFactory(std::make_shared<TextReaderFactory>());
+}
+
+void unregisterTextReaderFactory() {
+  dwio::common::unregisterReaderFactory(dwio::common::FileFormat::TEXT);
+}
+
+} // namespace facebook::velox::text
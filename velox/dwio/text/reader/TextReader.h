@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "velox/dwio/common/DataBuffer.h"
+#include "velox/dwio/common/Reader.h"
+#include "velox/dwio/common/ReaderFactory.h"
+
+namespace facebook::velox::text {
+
+// Reads the lines of a delimited text file from the byte range given by the
+// offset and length of the RowReaderOptions. A line belongs to the range
+// that contains its first byte, so that the splits of a file read each line
+// once. The fields of a line are separated by the first of the
+// SerDeOptions::separators and are the columns of the file schema in order.
+// A field equal to SerDeOptions::nullString is null, as are missing fields
+// and fields that do not parse as their type.
+class TextRowReader : public dwio::common::RowReader {
+ public:
+  TextRowReader(
+      dwio::common::InputStream& input,
+      RowTypePtr fileType,
+      const dwio::common::SerDeOptions& serDeOptions,
+      const dwio::common::RowReaderOptions& options,
+      memory::MemoryPool& pool);
+  ~TextRowReader() override = default;
+
+  // Reads up to 'size' lines. With a ScanSpec, 'result' is set to a
+  // RowVector of the type of 'result' with the lines that pass the filters
+  // and the number of lines read is returned.
+  uint64_t next(uint64_t size, velox::VectorPtr& result) override;
+
+  void updateRuntimeStats(
+      dwio::common::RuntimeStatistics& stats) const override;
+
+  void resetFilterCaches() override {}
+
+  size_t estimatedRowSize() const override;
+
+ private:
+  // Reads more of the file after the unread bytes in 'buffer_', which move
+  // to its start. Returns false at the end of the file.
+  bool readMore();
+
+  // Skips the line that started in the previous range.
+  void skipPartialLine();
+
+  // Sets 'line' to the next line of the range. Lines point into 'buffer_',
+  // which is refilled only if 'mayRefill' is true.
+  bool nextLine(std::string_view& line, bool mayRefill);
+
+  // Sets the fields of the file columns in 'slots_' for line 'index'.
+  void splitFields(std::string_view line, int32_t index);
+
+  std::string_view field(int32_t column, vector_size_t row) const {
+    return fields_[row * columns_.size() + slots_[column]];
+  }
+
+  // True if the field is missing or is the null string.
+  bool isNullField(std::string_view field) const {
+    return field.data() == nullptr || field == serDeOptions_.nullString;
+  }
+
+  // Returns the file column of 'name'.
+  int32_t fileColumn(const std::string& name) const;
+
+  // Parses 'column' of 'rows' of the current lines as 'type'.
+  VectorPtr readColumn(
+      int32_t column,
+      const TypePtr& type,
+      const std::vector<vector_size_t>& rows);
+
+  template <TypeKind Kind>
+  VectorPtr readColumnTyped(
+      int32_t column,
+      const TypePtr& type,
+      const std::vector<vector_size_t>& rows);
+
+  // Removes from 'rows_' the lines whose 'column' fails 'filter'.
+  void filterColumn(
+      int32_t column,
+      const TypePtr& type,
+      const velox::common::Filter& filter);
+
+  // Reads the lines of a batch with 'scanSpec_'.
+  VectorPtr readWithScanSpec(vector_size_t numLines, const VectorPtr& result);
+
+  dwio::common::InputStream& input_;
+  const RowTypePtr fileType_;
+  const dwio::common::SerDeOptions serDeOptions_;
+  velox::common::ScanSpec* const scanSpec_;
+  memory::MemoryPool& pool_;
+
+  // The type of the result without a ScanSpec.
+  RowTypePtr selectedType_;
+  // The file columns of 'selectedType_'.
+  std::vector<int32_t> selectedColumns_;
+
+  // The file columns that are read, in file order, and the index of each
+  // file column in them or -1.
+  std::vector<int32_t> columns_;
+  std::vector<int32_t> slots_;
+
+  const uint64_t fileLength_;
+  // The lines that start in [begin_, end_) are read.
+  const uint64_t begin_;
+  const uint64_t end_;
+
+  dwio::common::DataBuffer<char> buffer_;
+  // File offset of the first byte of 'buffer_'.
+  uint64_t bufferOffset_{0};
+  // Number of valid bytes in 'buffer_'.
+  uint64_t bufferSize_{0};
+  // Index of the first unread byte in 'buffer_'.
+  uint64_t cursor_{0};
+  bool started_{false};
+  bool atEnd_{false};
+
+  // The lines of the current batch and their fields, 'columns_.size()' per
+  // line. A missing field has a null data pointer.
+  std::vector<std::string_view> lines_;
+  std::vector<std::string_view> fields_;
+  // The lines of the current batch that passed the filters so far.
+  std::vector<vector_size_t> rows_;
+  // Scratch for unescaping a field.
+  std::string unescaped_;
+
+  uint64_t numLines_{0};
+  uint64_t numBytes_{0};
+};
+
+class TextReader : public dwio::common::Reader {
+ public:
+  // The options must have the file schema.
+  TextReader(
+      std::unique_ptr<dwio::common::InputStream> stream,
+      const dwio::common::ReaderOptions& options);
+  ~TextReader() override = default;
+
+  // A text file has no footer. Returns std::nullopt.
+  std::optional<uint64_t> numberOfRows() const override;
+
+  // Returns statistics without values.
+  std::unique_ptr<dwio::common::ColumnStatistics> columnStatistics(
+      uint32_t index) const override;
+
+  const velox::RowTypePtr& rowType() const override;
+
+  const std::shared_ptr<const dwio::common::TypeWithId>& typeWithId()
+      const override;
+
+  std::unique_ptr<dwio::common::RowReader> createRowReader(
+      const dwio::common::RowReaderOptions& options = {}) const override;
+
+ private:
+  std::unique_ptr<dwio::common::InputStream> stream_;
+  const dwio::common::SerDeOptions serDeOptions_;
+  memory::MemoryPool& pool_;
+
+  RowTypePtr type_;
+  mutable std::shared_ptr<const dwio::common::TypeWithId> typeWithId_;
+};
+
+class TextReaderFactory : public dwio::common::ReaderFactory {
+ public:
+  TextReaderFactory() : ReaderFactory(dwio::common::FileFormat::TEXT) {}
+
+  std::unique_ptr<dwio::common::Reader> createReader(
+      std::unique_ptr<dwio::common::InputStream> stream,
+      const dwio::common::ReaderOptions& options) override {
+    return std::make_unique<TextReader>(std::move(stream), options);
+  }
+};
+
+void registerTextReaderFactory();
+
+void unregisterTextReaderFactory();
+
+} // namespace facebook::velox::text
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/dwio/text/reader/TextReader.h"
+
+#include <gtest/gtest.h>
+#include "velox/dwio/common/MemoryInputStream.h"
+#include "velox/dwio/common/ScanSpec.h"
+#include "velox/type/Filter.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::dwio::common;
+using namespace facebook::velox::text;
+
+class TextReaderTest : public testing::Test {
+ protected:
+  std::unique_ptr<TextReader> makeReader(
+      const std::string& data,
+      const RowTypePtr& type,
+      const SerDeOptions& serDeOptions = SerDeOptions(',')) {
+    ReaderOptions readerOptions(pool_.get());
+    readerOptions.setFileSchema(type);
+    readerOptions.setSerDeOptions(serDeOptions);
+    return std::make_unique<TextReader>(
+        std::make_unique<MemoryInputStream>(data.data(), data.size()),
+        readerOptions);
+  }
+
+  // Reads all batches of 'rowReader' into one vector.
+  RowVectorPtr readAll(RowReader& rowReader, uint64_t batchSize = 1000) {
+    RowVectorPtr all;
+    VectorPtr batch;
+    while (rowReader.next(batchSize, batch) > 0) {
+      if (!all) {
+        all = std::static_pointer_cast<RowVector>(
+            BaseVector::create(batch->type(), 0, pool_.get()));
+      }
+      auto size = all->size();
+      all->resize(size + batch->size());
+      all->copy(batch.get(), size, 0, batch->size());
+    }
+    return all;
+  }
+
+  void assertEqual(const VectorPtr& expected, const VectorPtr& actual) {
+    ASSERT_TRUE(actual != nullptr);
+    ASSERT_EQ(expected->size(), actual->size());
+    for (auto i = 0; i < expected->size(); ++i) {
+      ASSERT_TRUE(expected->equalValueAt(actual.get(), i, i))
+          << "at " << i << ": " << expected->toString(i) << " vs "
+          << actual->toString(i);
+    }
+  }
+
+  std::unique_ptr<memory::ScopedMemoryPool> pool_{
+      memory::getDefaultScopedMemoryPool()};
+  test::VectorMaker vectorMaker_{pool_.get()};
+};
+
+TEST_F(TextReaderTest, types) {
+  auto type =
+      ROW({"b", "i", "d", "s", "r"},
+          {BOOLEAN(), INTEGER(), DOUBLE(), VARCHAR(), REAL()});
+  auto reader = makeReader(
+      "true,1,1.5,abc,2.5\n"
+      "FALSE,-20,1e3,,x\n"
+      "\\N,\\N,\\N,\\N,\\N\n"
+      "yes,99999999999,12.25x,a long string value\r\n"
+      ",12",
+      type);
+  EXPECT_FALSE(reader->numberOfRows().has_value());
+  EXPECT_EQ(*type, *reader->rowType());
+
+  auto rowReader = reader->createRowReader();
+  auto expected = vectorMaker_.rowVector(
+      {"b", "i", "d", "s", "r"},
+      {vectorMaker_.flatVectorNullable<bool>(
+           {true, false, std::nullopt, std::nullopt, std::nullopt}),
+       vectorMaker_.flatVectorNullable<int32_t>(
+           {1, -20, std::nullopt, std::nullopt, 12}),
+       vectorMaker_.flatVectorNullable<double>(
+           {1.5, 1000, std::nullopt, std::nullopt, std::nullopt}),
+       vectorMaker_.flatVectorNullable<StringView>(
+           {"abc", "", std::nullopt, "a long string value", std::nullopt}),
+       vectorMaker_.flatVectorNullable<float>(
+           {2.5, std::nullopt, std::nullopt, std::nullopt, std::nullopt})});
+  assertEqual(expected, readAll(*rowReader));
+}
+
+TEST_F(TextReaderTest, escapes) {
+  auto type = ROW({"a", "b"}, {VARCHAR(), VARCHAR()});
+  SerDeOptions serDeOptions(',', '\2', '\3', '\\', true);
+  serDeOptions.lastColumnTakesRest = true;
+  auto reader =
+      makeReader("x\\,y,z,w\nline\\nbreak,\\\\\n", type, serDeOptions);
+  auto expected = vectorMaker_.rowVector(
+      {"a", "b"},
+      {vectorMaker_.flatVector<StringView>({"x,y", "line\nbreak"}),
+       vectorMaker_.flatVector<StringView>({"z,w", "\\"})});
+  assertEqual(expected, readAll(*reader->createRowReader()));
+}
+
+TEST_F(TextReaderTest, splits) {
+  // Each line must be read by exactly one split, whatever the split size.
+  constexpr int32_t kNumLines = 1'000;
+  std::string data;
+  for (auto i = 0; i < kNumLines; ++i) {
+    data += fmt::format("{},{}\n", i, std::string(i % 17, 'x'));
+  }
+  auto type = ROW({"n", "s"}, {BIGINT(), VARCHAR()});
+  auto expected = vectorMaker_.flatVector<int64_t>(
+      kNumLines, [](auto row) { return row; });
+  for (uint64_t splitSize : {1, 2, 7, 100, 4'096, 1 << 30}) {
+    SCOPED_TRACE(fmt::format("split size {}", splitSize));
+    auto reader = makeReader(data, type);
+    std::vector<int64_t> values;
+    for (uint64_t offset = 0; offset < data.size(); offset += splitSize) {
+      RowReaderOptions options;
+      options.range(offset, splitSize);
+      auto result = readAll(*reader->createRowReader(options), 33);
+      if (!result) {
+        continue;
+      }
+      auto column = result->childAt(0)->asFlatVector<int64_t>();
+      for (auto i = 0; i < result->size(); ++i) {
+        values.push_back(column->valueAt(i));
+      }
+    }
+    assertEqual(expected, vectorMaker_.flatVector(values));
+  }
+}
+
+TEST_F(TextReaderTest, longLine) {
+  // A line longer than the read buffer.
+  std::string longValue(3 << 20, 'a');
+  auto reader = makeReader(
+      fmt::format("1,short\n2,{}\n3,end", longValue),
+      ROW({"n", "s"}, {BIGINT(), VARCHAR()}));
+  auto expected = vectorMaker_.rowVector(
+      {"n", "s"},
+      {vectorMaker_.flatVector<int64_t>({1, 2, 3}),
+       vectorMaker_.flatVector<StringView>(
+           {"short", StringView(longValue), "end"})});
+  assertEqual(expected, readAll(*reader->createRowReader(), 2));
+}
+
+TEST_F(TextReaderTest, scanSpec) {
+  std::string data;
+  for (auto i = 0; i < 100; ++i) {
+    data += fmt::format("{},name {},{}\n", i, i, i * 0.5);
+  }
+  auto reader =
+      makeReader(data, ROW({"n", "s", "d"}, {BIGINT(), VARCHAR(), DOUBLE()}));
+
+  // Reads 's' and a constant for 'n > 90', in the order of 'outputType'.
+  common::ScanSpec spec("root");
+  auto filterSpec = spec.getOrCreateChild(common::Subfield("n"));
+  filterSpec->setFilter(
+      std::make_unique<common::BigintRange>(91, 1'000, false));
+  auto stringSpec = spec.getOrCreateChild(common::Subfield("s"));
+  stringSpec->setProjectOut(true);
+  stringSpec->setChannel(1);
+  auto constantSpec = spec.getOrCreateChild(common::Subfield("c"));
+  constantSpec->setProjectOut(true);
+  constantSpec->setChannel(0);
+  constantSpec->setConstantValue(
+      BaseVector::createConstant(int64_t(7), 1, pool_.get()));
+  RowReaderOptions options;
+  options.setScanSpec(&spec);
+  auto rowReader = reader->createRowReader(options);
+
+  auto outputType = ROW({"c", "s"}, {BIGINT(), VARCHAR()});
+  VectorPtr result = BaseVector::create(outputType, 0, pool_.get());
+  EXPECT_EQ(100, rowReader->next(1'000, result));
+  std::vector<std::string> names;
+  for (auto i = 91; i < 100; ++i) {
+    names.push_back(fmt::format("name {}", i));
+  }
+  auto expected = vectorMaker_.rowVector(
+      {"c", "s"},
+      {vectorMaker_.flatVector<int64_t>(9, [](auto) { return 7; }),
+       vectorMaker_.flatVector(names)});
+  assertEqual(expected, result);
+  EXPECT_EQ(0, rowReader->next(1'000, result));
+
+  // A constant that fails its filter drops all lines.
+  constantSpec->setFilter(std::make_unique<common::BigintRange>(0, 1, false));
+  rowReader = reader->createRowReader(options);
+  EXPECT_EQ(100, rowReader->next(1'000, result));
+  EXPECT_EQ(0, result->size());
+}
+
+TEST_F(TextReaderTest, missingSchema) {
+  std::string data = "1\n";
+  ReaderOptions readerOptions(pool_.get());
+  EXPECT_THROW(
+      TextReader(
+          std::make_unique<MemoryInputStream>(data.data(), data.size()),
+          readerOptions),
+      VeloxUserError);
+}
@@ -34,6 +34,7 @@ class AggregationHook : public ValueHook {
   static constexpr Kind kFloatMin = 8;
   static constexpr Kind kDoubleMax = 9;
   static constexpr Kind kDoubleMin = 10;
+  static constexpr Kind kCount = 11;
 
   // Make null behavior known at compile time. This is useful when
   // templating a column decoding loop with a hook.
@@ -50,6 +51,23 @@ class AggregationHook : public ValueHook {
         nullMask_(nullMask),
         clearNullMask_(~nullMask_),
         groups_(groups),
+        group_(nullptr),
+        numNulls_(numNulls) {}
+
+  // Constructor for a single group, e.g. a global aggregation. All values
+  // go to 'group'.
+  AggregationHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char* group,
+      uint64_t* numNulls)
+      : offset_(offset),
+        nullByte_(nullByte),
+        nullMask_(nullMask),
+        clearNullMask_(~nullMask_),
+        groups_(nullptr),
+        group_(group),
         numNulls_(numNulls) {}
 
   bool acceptsNulls() const override final {
@@ -71,7 +89,7 @@ class AggregationHook : public ValueHook {
 
  protected:
   inline char* findGroup(vector_size_t row) {
-    return groups_[row];
+    return groups_ ? groups_[row] : group_;
   }
 
   inline bool clearNull(char* group) {
@@ -91,7 +109,9 @@ class AggregationHook : public ValueHook {
   const int32_t nullByte_;
   const uint8_t nullMask_;
   const uint8_t clearNullMask_;
+  // The group of each row, or nullptr if all rows go to 'group_'.
   char* const* const groups_;
+  char* const group_;
   uint64_t* numNulls_;
 };
 
@@ -106,6 +126,14 @@ class SumHook final : public AggregationHook {
       uint64_t* numNulls)
       : AggregationHook(offset, nullByte, nullMask, groups, numNulls) {}
 
+  SumHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char* group,
+      uint64_t* numNulls)
+      : AggregationHook(offset, nullByte, nullMask, group, numNulls) {}
+
   Kind kind() const override {
     if (std::is_same<TAggregate, double>::value) {
       if (std::is_same<TValue, double>::value) {
@@ -173,6 +201,14 @@ class MinMaxHook final : public AggregationHook {
       uint64_t* numNulls)
       : AggregationHook(offset, nullByte, nullMask, groups, numNulls) {}
 
+  MinMaxHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char* group,
+      uint64_t* numNulls)
+      : AggregationHook(offset, nullByte, nullMask, group, numNulls) {}
+
   Kind kind() const override {
     if (isMin) {
       if (std::is_same<T, int64_t>::value) {
@@ -209,4 +245,46 @@ class MinMaxHook final : public AggregationHook {
   }
 };
 
+// Counts the non-null values, as in count(x). The accumulator is never null.
+class CountHook final : public AggregationHook {
+ public:
+  CountHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char** groups,
+      uint64_t* numNulls)
+      : AggregationHook(offset, nullByte, nullMask, groups, numNulls) {}
+
+  CountHook(
+      int32_t offset,
+      int32_t nullByte,
+      uint8_t nullMask,
+      char* group,
+      uint64_t* numNulls)
+      : AggregationHook(offset, nullByte, nullMask, group, numNulls) {}
+
+  Kind kind() const override {
+    return kCount;
+  }
+
+  void addValue(vector_size_t row, const void* /*value*/) override {
+    ++*reinterpret_cast<int64_t*>(findGroup(row) + offset_);
+  }
+
+  void addValues(
+      const vector_size_t* rows,
+      const void* /*values*/,
+      vector_size_t size,
+      uint8_t /*valueWidth*/) override {
+    if (!groups_) {
+      *reinterpret_cast<int64_t*>(group_ + offset_) += size;
+      return;
+    }
+    for (auto i = 0; i < size; ++i) {
+      ++*reinterpret_cast<int64_t*>(groups_[rows[i]] + offset_);
+    }
+  }
+};
+
 } // namespace facebook::velox::aggregate
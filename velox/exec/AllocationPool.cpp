@@ -22,6 +22,7 @@ void AllocationPool::clear() {
   // Trigger Allocation's destructor to free allocated memory
   auto copy = std::move(allocation_);
   allocations_.clear();
+  nextPages_ = kMinPages;
 }
 
 char* AllocationPool::allocateFixed(uint64_t bytes) {
@@ -47,13 +48,14 @@ void AllocationPool::newRun(int32_t preferredSize) {
         bits::roundUp(preferredSize, memory::MappedMemory::kPageSize) /
         memory::MappedMemory::kPageSize;
     if (!mappedMemory_->allocate(
-            std::max<int32_t>(16, numPages),
+            std::max<int32_t>(nextPages_, numPages),
             owner_,
             allocation_,
             nullptr,
             numPages)) {
       throw std::bad_alloc();
     }
+    nextPages_ = std::min(2 * nextPages_, kMaxPages);
     currentRun_ = 0;
   }
   currentOffset_ = 0;
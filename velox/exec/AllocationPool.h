@@ -29,6 +29,14 @@ class AllocationPool {
  public:
   static constexpr int32_t kHashTableOwner = -3;
 
+  // Bounds for the number of pages requested from MappedMemory at a
+  // time. Each request doubles the size of the next one up to
+  // kMaxPages, so that a growing pool makes few calls to MappedMemory
+  // and the MemoryUsageTrackers behind it. kMaxPages matches the MB
+  // granularity at which trackers propagate usage to their parents.
+  static constexpr int32_t kMinPages = 16;
+  static constexpr int32_t kMaxPages = 256;
+
   explicit AllocationPool(
       memory::MappedMemory* mappedMemory,
       int32_t owner = kHashTableOwner)
@@ -107,6 +115,8 @@ class AllocationPool {
   memory::MappedMemory::Allocation allocation_;
   int32_t currentRun_ = 0;
   int32_t currentOffset_ = 0;
+  // Number of pages to request on the next allocation.
+  int32_t nextPages_ = kMinPages;
   const int32_t owner_;
 };
 
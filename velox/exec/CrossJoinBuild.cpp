@@ -50,9 +50,10 @@ CrossJoinBuild::CrossJoinBuild(
 
 void CrossJoinBuild::addInput(RowVectorPtr input) {
   if (input->size() > 0) {
-    // Load lazy vectors before storing.
-    for (auto& child : input->children()) {
-      child->loadedVector();
+    // Load lazy vectors before storing. The probe side wraps the loaded
+    // vectors in dictionaries and constants.
+    for (auto i = 0; i < input->childrenSize(); ++i) {
+      input->loadedChildAt(i);
     }
     data_.emplace_back(std::move(input));
   }
@@ -97,7 +98,8 @@ void CrossJoinBuild::finish() {
   }
 
   operatorCtx_->task()
-      ->getCrossJoinBridge(planNodeId())
+      ->getCrossJoinBridge(
+          operatorCtx_->driverCtx()->splitGroupId, planNodeId())
       ->setData(std::move(data_));
 }
 } // namespace facebook::velox::exec
@@ -55,6 +55,42 @@ CrossJoinProbe::CrossJoinProbe(
   if (isIdentityProjection && buildProjections_.empty()) {
     isIdentityProjection_ = true;
   }
+
+  if (joinNode->filter()) {
+    initializeFilter(joinNode->filter(), probeType, buildType);
+  }
+}
+
+void CrossJoinProbe::initializeFilter(
+    const std::shared_ptr<const core::ITypedExpr>& filter,
+    const RowTypePtr& probeType,
+    const RowTypePtr& buildType) {
+  std::vector<std::shared_ptr<const core::ITypedExpr>> filters = {filter};
+  filter_ =
+      std::make_unique<ExprSet>(std::move(filters), operatorCtx_->execCtx());
+  ChannelIndex filterChannel = 0;
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  for (auto& field : filter_->expr(0)->distinctFields()) {
+    const auto& name = field->field();
+    auto channel = probeType->getChildIdxIfExists(name);
+    if (channel.has_value()) {
+      filterProbeInputs_.emplace_back(channel.value(), filterChannel++);
+      names.emplace_back(name);
+      types.emplace_back(probeType->childAt(channel.value()));
+      continue;
+    }
+    channel = buildType->getChildIdxIfExists(name);
+    if (channel.has_value()) {
+      filterBuildInputs_.emplace_back(channel.value(), filterChannel++);
+      names.emplace_back(name);
+      types.emplace_back(buildType->childAt(channel.value()));
+      continue;
+    }
+    VELOX_FAIL(
+        "Join filter field {} not in probe or build input", field->toString());
+  }
+  filterInputType_ = ROW(std::move(names), std::move(types));
 }
 
 BlockingReason CrossJoinProbe::isBlocked(ContinueFuture* future) {
@@ -62,9 +98,11 @@ BlockingReason CrossJoinProbe::isBlocked(ContinueFuture* future) {
     return BlockingReason::kNotBlocked;
   }
 
-  auto buildData = operatorCtx_->task()
-                       ->getCrossJoinBridge(planNodeId())
-                       ->dataOrFuture(future);
+  auto buildData =
+      operatorCtx_->task()
+          ->getCrossJoinBridge(
+              operatorCtx_->driverCtx()->splitGroupId, planNodeId())
+          ->dataOrFuture(future);
   if (!buildData.has_value()) {
     return BlockingReason::kWaitForJoinBuild;
   }
@@ -84,65 +122,143 @@ void CrossJoinProbe::addInput(RowVectorPtr input) {
   // In getOutput(), we are going to wrap input in dictionaries a few rows at a
   // time. Since lazy vectors cannot be wrapped in different dictionaries, we
   // are going to load them here.
-  for (auto& child : input->children()) {
-    child->loadedVector();
+  for (auto i = 0; i < input->childrenSize(); ++i) {
+    input->loadedChildAt(i);
   }
   input_ = std::move(input);
 }
 
-RowVectorPtr CrossJoinProbe::getOutput() {
-  if (!input_) {
-    return nullptr;
-  }
-
-  const auto inputSize = input_->size();
+RowVectorPtr CrossJoinProbe::wrapCrossProduct(
+    const RowTypePtr& type,
+    const std::vector<IdentityProjection>& probeProjections,
+    const std::vector<IdentityProjection>& buildProjections,
+    const RowVectorPtr& build,
+    vector_size_t numProbeRows,
+    vector_size_t numBuildRows) {
+  const auto size = numProbeRows * numBuildRows;
+  std::vector<VectorPtr> columns(type->size());
 
-  auto buildSize = buildData_.value()[buildIndex_]->size();
-  vector_size_t probeCnt;
-  if (buildSize > outputBatchSize_) {
-    probeCnt = 1;
-  } else {
-    probeCnt = std::min(
-        (vector_size_t)outputBatchSize_ / buildSize, inputSize - probeRow_);
+  // A single probe row is a constant.
+  BufferPtr probeIndices;
+  if (numProbeRows > 1 && !probeProjections.empty()) {
+    probeIndices = allocateIndices(size, pool());
+    auto* rawProbeIndices = probeIndices->asMutable<vector_size_t>();
+    for (auto i = 0; i < numProbeRows; ++i) {
+      std::fill(
+          rawProbeIndices + i * numBuildRows,
+          rawProbeIndices + (i + 1) * numBuildRows,
+          probeRow_ + i);
+    }
   }
-
-  auto size = probeCnt * buildSize;
-  BufferPtr indices = allocateIndices(size, pool());
-  auto* rawIndices = indices->asMutable<vector_size_t>();
-  for (auto i = 0; i < probeCnt; ++i) {
-    std::fill(
-        rawIndices + i * buildSize,
-        rawIndices + (i + 1) * buildSize,
-        probeRow_ + i);
+  for (const auto& projection : probeProjections) {
+    const auto& probeVector = input_->childAt(projection.inputChannel);
+    columns[projection.outputChannel] = probeIndices
+        ? BaseVector::wrapInDictionary(
+              BufferPtr(nullptr), probeIndices, size, probeVector)
+        : BaseVector::wrapInConstant(size, probeRow_, probeVector);
   }
-  auto output = fillOutput(size, indices);
 
-  BufferPtr buildIndices = nullptr;
-  if (probeCnt > 1) {
+  // A whole build side vector repeated once is passed through.
+  BufferPtr buildIndices;
+  if ((numProbeRows > 1 || numBuildRows < build->size()) &&
+      !buildProjections.empty()) {
     buildIndices = allocateIndices(size, pool());
     auto* rawBuildIndices = buildIndices->asMutable<vector_size_t>();
-    for (auto i = 0; i < probeCnt; ++i) {
+    for (auto i = 0; i < numProbeRows; ++i) {
       std::iota(
-          rawBuildIndices + i * buildSize,
-          rawBuildIndices + (i + 1) * buildSize,
-          0);
+          rawBuildIndices + i * numBuildRows,
+          rawBuildIndices + (i + 1) * numBuildRows,
+          buildRow_);
     }
   }
+  for (const auto& projection : buildProjections) {
+    const auto& buildVector = build->childAt(projection.inputChannel);
+    columns[projection.outputChannel] = buildIndices
+        ? BaseVector::wrapInDictionary(
+              BufferPtr(nullptr), buildIndices, size, buildVector)
+        : buildVector;
+  }
 
-  auto buildRowVector =
-      buildData_.value()[buildIndex_]->asUnchecked<RowVector>();
-  for (const auto& projection : buildProjections_) {
-    VectorPtr buildVector = buildRowVector->childAt(projection.inputChannel);
+  return std::make_shared<RowVector>(
+      pool(), type, BufferPtr(nullptr), size, std::move(columns));
+}
+
+RowVectorPtr CrossJoinProbe::filterCrossProduct(
+    const RowVectorPtr& build,
+    vector_size_t numProbeRows,
+    vector_size_t numBuildRows) {
+  const auto size = numProbeRows * numBuildRows;
+  auto filterInput = wrapCrossProduct(
+      filterInputType_,
+      filterProbeInputs_,
+      filterBuildInputs_,
+      build,
+      numProbeRows,
+      numBuildRows);
+  filterRows_.resize(size);
+  filterRows_.setAll();
+  EvalCtx evalCtx(operatorCtx_->execCtx(), filter_.get(), filterInput.get());
+  filter_->eval(0, 1, true, filterRows_, &evalCtx, &filterResult_);
+  decodedFilterResult_.decode(*filterResult_[0], filterRows_);
 
-    if (buildIndices) {
-      buildVector = BaseVector::wrapInDictionary(
-          BufferPtr(nullptr), buildIndices, size, buildVector);
+  BufferPtr probeIndices = allocateIndices(size, pool());
+  auto* rawProbeIndices = probeIndices->asMutable<vector_size_t>();
+  BufferPtr buildIndices = allocateIndices(size, pool());
+  auto* rawBuildIndices = buildIndices->asMutable<vector_size_t>();
+  vector_size_t numPassed = 0;
+  for (auto i = 0; i < size; ++i) {
+    if (!decodedFilterResult_.isNullAt(i) &&
+        decodedFilterResult_.valueAt<bool>(i)) {
+      rawProbeIndices[numPassed] = probeRow_ + i / numBuildRows;
+      rawBuildIndices[numPassed] = buildRow_ + i % numBuildRows;
+      ++numPassed;
     }
-    output->childAt(projection.outputChannel) = buildVector;
+  }
+  if (numPassed == 0) {
+    return nullptr;
+  }
+  if (numPassed == size) {
+    return wrapCrossProduct(
+        outputType_,
+        identityProjections_,
+        buildProjections_,
+        build,
+        numProbeRows,
+        numBuildRows);
   }
 
-  probeRow_ += probeCnt;
-  if (probeRow_ == inputSize) {
+  // The passing rows refer to the input vectors directly, not to the
+  // wrappers the filter was evaluated on.
+  std::vector<VectorPtr> columns(outputType_->size());
+  for (const auto& projection : identityProjections_) {
+    columns[projection.outputChannel] = BaseVector::wrapInDictionary(
+        BufferPtr(nullptr),
+        probeIndices,
+        numPassed,
+        input_->childAt(projection.inputChannel));
+  }
+  for (const auto& projection : buildProjections_) {
+    columns[projection.outputChannel] = BaseVector::wrapInDictionary(
+        BufferPtr(nullptr),
+        buildIndices,
+        numPassed,
+        build->childAt(projection.inputChannel));
+  }
+  return std::make_shared<RowVector>(
+      pool(), outputType_, BufferPtr(nullptr), numPassed, std::move(columns));
+}
+
+void CrossJoinProbe::advance(
+    vector_size_t numProbeRows,
+    vector_size_t numBuildRows,
+    vector_size_t buildSize) {
+  buildRow_ += numBuildRows;
+  if (buildRow_ < buildSize) {
+    return;
+  }
+  buildRow_ = 0;
+  probeRow_ += numProbeRows;
+  if (probeRow_ == input_->size()) {
     probeRow_ = 0;
     ++buildIndex_;
     if (buildIndex_ == buildData_->size()) {
@@ -150,7 +266,43 @@ RowVectorPtr CrossJoinProbe::getOutput() {
       input_.reset();
     }
   }
-  return output;
+}
+
+RowVectorPtr CrossJoinProbe::getOutput() {
+  // Loops until some row passes the filter or the input is consumed.
+  while (input_) {
+    auto build = std::static_pointer_cast<RowVector>(
+        buildData_.value()[buildIndex_]);
+    const vector_size_t buildSize = build->size();
+
+    // A build side vector of at least 'outputBatchSize_' rows is output in
+    // ranges paired with one probe row. Smaller ones are repeated for as
+    // many probe rows as fit.
+    vector_size_t numProbeRows = 1;
+    vector_size_t numBuildRows = buildSize;
+    if (buildSize >= outputBatchSize_) {
+      numBuildRows =
+          std::min<vector_size_t>(outputBatchSize_, buildSize - buildRow_);
+    } else {
+      numProbeRows = std::min<vector_size_t>(
+          outputBatchSize_ / buildSize, input_->size() - probeRow_);
+    }
+
+    auto output = filter_
+        ? filterCrossProduct(build, numProbeRows, numBuildRows)
+        : wrapCrossProduct(
+              outputType_,
+              identityProjections_,
+              buildProjections_,
+              build,
+              numProbeRows,
+              numBuildRows);
+    advance(numProbeRows, numBuildRows, buildSize);
+    if (output) {
+      return output;
+    }
+  }
+  return nullptr;
 }
 
 void CrossJoinProbe::close() {
@@ -17,6 +17,7 @@
 
 #include "velox/exec/CrossJoinBuild.h"
 #include "velox/exec/Operator.h"
+#include "velox/expression/Expr.h"
 
 namespace facebook::velox::exec {
 class CrossJoinProbe : public Operator {
@@ -39,6 +40,39 @@ class CrossJoinProbe : public Operator {
   void close() override;
 
  private:
+  // Sets up 'filter_' and related members.
+  void initializeFilter(
+      const std::shared_ptr<const core::ITypedExpr>& filter,
+      const RowTypePtr& probeType,
+      const RowTypePtr& buildType);
+
+  // Returns the cross product of 'numProbeRows' rows of 'input_' starting
+  // at 'probeRow_' and 'numBuildRows' rows of 'build' starting at
+  // 'buildRow_', with the columns given by 'probeProjections' and
+  // 'buildProjections'. The probe rows vary slowest. The columns wrap the
+  // input columns in constant or dictionary encodings without copying.
+  RowVectorPtr wrapCrossProduct(
+      const RowTypePtr& type,
+      const std::vector<IdentityProjection>& probeProjections,
+      const std::vector<IdentityProjection>& buildProjections,
+      const RowVectorPtr& build,
+      vector_size_t numProbeRows,
+      vector_size_t numBuildRows);
+
+  // Evaluates 'filter_' on the cross product described in
+  // wrapCrossProduct() and returns the output for the passing rows or
+  // nullptr if no row passes.
+  RowVectorPtr filterCrossProduct(
+      const RowVectorPtr& build,
+      vector_size_t numProbeRows,
+      vector_size_t numBuildRows);
+
+  // Moves past 'numProbeRows' x 'numBuildRows' rows of the cross product.
+  void advance(
+      vector_size_t numProbeRows,
+      vector_size_t numBuildRows,
+      vector_size_t buildSize);
+
   /// Maximum number of rows in the output batch.
   const uint32_t outputBatchSize_;
 
@@ -52,5 +86,26 @@ class CrossJoinProbe : public Operator {
 
   // Input row to process on next call to getOutput().
   vector_size_t probeRow_{0};
+
+  // First row of the build side vector to process on next call to
+  // getOutput(). Non-zero only for build side vectors larger than
+  // 'outputBatchSize_', which are output a range of rows at a time.
+  vector_size_t buildRow_{0};
+
+  // Join filter.
+  std::unique_ptr<ExprSet> filter_;
+
+  // Type of the RowVector for filter inputs.
+  RowTypePtr filterInputType_;
+
+  // Maps probe input channels to channels in 'filterInputType_'.
+  std::vector<IdentityProjection> filterProbeInputs_;
+
+  // Maps build side channels to channels in 'filterInputType_'.
+  std::vector<IdentityProjection> filterBuildInputs_;
+
+  SelectivityVector filterRows_;
+  std::vector<VectorPtr> filterResult_;
+  DecodedVector decodedFilterResult_;
 };
 } // namespace facebook::velox::exec
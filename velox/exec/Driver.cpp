@@ -16,9 +16,12 @@
 
 #include <folly/ScopeGuard.h>
 #include <folly/executors/QueuedImmediateExecutor.h>
+#include <folly/executors/task_queue/PriorityUnboundedBlockingQueue.h>
 #include <folly/executors/task_queue/UnboundedBlockingQueue.h>
 #include <folly/executors/thread_factory/InitThreadFactory.h>
 #include <gflags/gflags.h>
+#include "velox/common/process/PerfCounters.h"
+#include "velox/common/process/ProcessBase.h"
 #include "velox/common/time/Timer.h"
 #include "velox/exec/Operator.h"
 #include "velox/exec/Task.h"
@@ -29,8 +32,66 @@ DEFINE_int32(
     std::thread::hardware_concurrency(),
     "Process-wide number of query execution threads");
 
+DEFINE_int32(
+    velox_driver_time_slice_ms,
+    0,
+    "Time after which a Driver that is on thread yields to the queued "
+    "Drivers. 0 means that Drivers run until they block or finish");
+
+DEFINE_int32(
+    velox_num_driver_priority_levels,
+    1,
+    "Number of priority levels of the query execution threads. Drivers of "
+    "Tasks that have used less CPU run first. 1 means first come first served");
+
+DEFINE_int32(
+    velox_operator_timing_sample_rate,
+    1,
+    "Times 1 in this many addInput, getOutput and finish calls of each "
+    "Operator and extrapolates the CPU and wall time of the others. 1 times "
+    "every call");
+
+DEFINE_int32(
+    velox_memory_timeline_interval_ms,
+    0,
+    "Records the memory reservation of each Operator over time in samples "
+    "of at least this many ms, reported in MemoryStats::timeline. 0 means "
+    "no timeline");
+
+DEFINE_bool(
+    velox_operator_perf_counters,
+    false,
+    "Counts the cycles, instructions, last level cache misses and branch "
+    "misses of each addInput, getOutput and finish call with the hardware "
+    "counters of the thread and adds them to the runtime stats of the "
+    "Operator. Needs perf_event_open() permission. Not sampled");
+
 namespace facebook::velox::exec {
 namespace {
+// Task CPU time at which the Drivers of the Task move to the next lower
+// priority level. Short queries complete at the highest level while long
+// ones drop to lower levels as they accumulate CPU.
+constexpr uint64_t kPriorityLevelCpuNanos[] = {
+    1'000'000'000,
+    10'000'000'000,
+    60'000'000'000,
+    300'000'000'000};
+
+constexpr int32_t kMaxPriorityLevels =
+    sizeof(kPriorityLevelCpuNanos) / sizeof(kPriorityLevelCpuNanos[0]) + 1;
+
+// Returns the executor priority for a Driver of a Task that has used
+// 'taskCpuNanos'. folly executors run higher priorities first and the
+// priorities of an executor with n levels are [n / 2 - n + 1, n / 2].
+int8_t driverPriority(uint64_t taskCpuNanos, int32_t numPriorities) {
+  int32_t level = 0;
+  while (level < numPriorities - 1 &&
+         taskCpuNanos >= kPriorityLevelCpuNanos[level]) {
+    ++level;
+  }
+  return numPriorities / 2 - level;
+}
+
 // Basic implementation of the connector::ExpressionEvaluator interface.
 class SimpleExpressionEvaluator : public connector::ExpressionEvaluator {
  public:
@@ -66,7 +127,8 @@ DriverCtx::DriverCtx(
     std::shared_ptr<Task> _task,
     int _driverId,
     int _pipelineId,
-    int32_t _numDrivers)
+    int32_t _numDrivers,
+    int32_t _splitGroupId)
     : task(_task),
       execCtx(std::make_unique<core::ExecCtx>(
           task->addDriverPool(),
@@ -75,10 +137,20 @@ DriverCtx::DriverCtx(
           std::make_unique<SimpleExpressionEvaluator>(execCtx.get())),
       driverId(_driverId),
       pipelineId(_pipelineId),
-      numDrivers(_numDrivers) {}
+      numDrivers(_numDrivers),
+      splitGroupId(_splitGroupId),
+      vectorPool(execCtx->pool()) {}
 
 velox::memory::MemoryPool* FOLLY_NONNULL DriverCtx::addOperatorPool() {
-  return task->addOperatorPool(execCtx->pool());
+  auto pool = task->addOperatorPool(execCtx->pool());
+  if (FLAGS_velox_memory_timeline_interval_ms > 0) {
+    if (auto& tracker = pool->getMemoryUsageTracker()) {
+      tracker->enableTimeline(
+          FLAGS_velox_memory_timeline_interval_ms,
+          MemoryStats::kMaxTimelineSamples);
+    }
+  }
+  return pool;
 }
 
 std::unique_ptr<connector::ConnectorQueryCtx>
@@ -110,6 +182,26 @@ BlockingState::BlockingState(
   driver_->state().hasBlockingFuture = true;
 }
 
+const char* blockingReasonName(BlockingReason reason) {
+  switch (reason) {
+    case BlockingReason::kNotBlocked:
+      return "NotBlocked";
+    case BlockingReason::kWaitForConsumer:
+      return "WaitForConsumer";
+    case BlockingReason::kWaitForSplit:
+      return "WaitForSplit";
+    case BlockingReason::kWaitForExchange:
+      return "WaitForExchange";
+    case BlockingReason::kWaitForJoinBuild:
+      return "WaitForJoinBuild";
+    case BlockingReason::kWaitForMemory:
+      return "WaitForMemory";
+    case BlockingReason::kWaitForPeers:
+      return "WaitForPeers";
+  }
+  return "Unknown";
+}
+
 // static
 void BlockingState::setResume(std::shared_ptr<BlockingState> state) {
   VELOX_CHECK(!state->driver_->isOnThread());
@@ -117,7 +209,13 @@ void BlockingState::setResume(std::shared_ptr<BlockingState> state) {
   std::move(state->future_)
       .via(&exec)
       .thenValue([state](bool /* unused */) {
-        state->operator_->recordBlockingTime(state->sinceMicros_);
+        state->operator_->recordBlockingTime(
+            state->sinceMicros_, state->reason_);
+        uint64_t blockedMicros =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now().time_since_epoch())
+                .count() -
+            state->sinceMicros_;
         auto driver = state->driver_;
         auto task = driver->task();
         if (!task) {
@@ -125,6 +223,14 @@ void BlockingState::setResume(std::shared_ptr<BlockingState> state) {
           // references.
           return;
         }
+        if (DriverTracer::enabled()) {
+          driver->trace(
+              DriverTraceEventKind::kBlocked,
+              state->operator_->stats().operatorId,
+              DriverTracer::nowNanos() - blockedMicros * 1'000,
+              blockedMicros * 1'000,
+              static_cast<uint8_t>(state->reason_));
+        }
         {
           std::lock_guard<std::mutex> l(task->mutex());
           VELOX_CHECK(!driver->state().isSuspended);
@@ -134,6 +240,11 @@ void BlockingState::setResume(std::shared_ptr<BlockingState> state) {
             // The thread will be enqueued at resume.
             return;
           }
+          if (task->maybeParkDriverLocked(
+                  driver, state->reason_, blockedMicros)) {
+            state->operator_->stats().addRuntimeStat("parkedDrivers", 1);
+            return;
+          }
           Driver::enqueue(state->driver_);
         }
       })
@@ -200,8 +311,18 @@ folly::CPUThreadPoolExecutor* Driver::executor(int32_t threads) {
   std::lock_guard<std::mutex> l(mutex);
   if (!getExecutor().get()) {
     auto numThreads = threads > 0 ? threads : FLAGS_velox_num_query_threads;
-    auto queue = std::make_unique<
-        folly::UnboundedBlockingQueue<folly::CPUThreadPoolExecutor::CPUTask>>();
+    auto numLevels =
+        std::min(FLAGS_velox_num_driver_priority_levels, kMaxPriorityLevels);
+    std::unique_ptr<
+        folly::BlockingQueue<folly::CPUThreadPoolExecutor::CPUTask>>
+        queue;
+    if (numLevels > 1) {
+      queue = std::make_unique<folly::PriorityUnboundedBlockingQueue<
+          folly::CPUThreadPoolExecutor::CPUTask>>(numLevels);
+    } else {
+      queue = std::make_unique<folly::UnboundedBlockingQueue<
+          folly::CPUThreadPoolExecutor::CPUTask>>();
+    }
     getExecutor().reset(new folly::CPUThreadPoolExecutor(
         numThreads,
         std::move(queue),
@@ -226,6 +347,13 @@ void Driver::enqueue(std::shared_ptr<Driver> driver) {
   if (!executor) {
     executor = Driver::executor();
   }
+  auto numPriorities = executor->getNumPriorities();
+  if (task && numPriorities > 1) {
+    executor->addWithPriority(
+        [driver]() { Driver::run(driver); },
+        driverPriority(task->driverCpuNanos(), numPriorities));
+    return;
+  }
   executor->add([driver]() { Driver::run(driver); });
 }
 
@@ -255,14 +383,60 @@ std::optional<ChannelIndex> getIdentityProjection(
 }
 } // namespace
 
+int32_t Driver::multiColumnFilterTarget(
+    int32_t operatorIndex,
+    std::vector<ChannelIndex>& channels) const {
+  for (auto i = operatorIndex - 1; i >= 0; --i) {
+    auto prevOp = operators_[i].get();
+    if (i == 0) {
+      // Source operator.
+      return prevOp->canAddDynamicFilter() ? i : -1;
+    }
+
+    // Continue walking upstream while all the channels are identity
+    // projections. Stop where none is.
+    const auto& identityProjections = prevOp->identityProjections();
+    std::vector<ChannelIndex> inputChannels;
+    for (auto channel : channels) {
+      auto inputChannel = getIdentityProjection(identityProjections, channel);
+      if (inputChannel.has_value()) {
+        inputChannels.push_back(inputChannel.value());
+      }
+    }
+    if (inputChannels.empty()) {
+      return prevOp->canAddDynamicFilter() ? i : -1;
+    }
+    if (inputChannels.size() < channels.size()) {
+      return -1;
+    }
+    channels = std::move(inputChannels);
+  }
+  return -1;
+}
+
 void Driver::pushdownFilters(int operatorIndex) {
   auto op = operators_[operatorIndex].get();
   const auto& filters = op->getDynamicFilters();
-  if (filters.empty()) {
+  const auto& multiColumnFilters = op->getMultiColumnDynamicFilters();
+  if (filters.empty() && multiColumnFilters.empty()) {
     return;
   }
 
-  op->stats().addRuntimeStat("dynamicFiltersProduced", filters.size());
+  op->stats().addRuntimeStat(
+      "dynamicFiltersProduced", filters.size() + multiColumnFilters.size());
+
+  for (const auto& entry : multiColumnFilters) {
+    auto channels = entry.channels;
+    auto target = multiColumnFilterTarget(operatorIndex, channels);
+    VELOX_CHECK_GE(
+        target,
+        0,
+        "Cannot push down dynamic filters produced by {}",
+        op->toString());
+    auto targetOp = operators_[target].get();
+    targetOp->addDynamicFilter(channels, entry.filter);
+    targetOp->stats().addRuntimeStat("dynamicFiltersAccepted", 1);
+  }
 
   // Walk operator list upstream and find a place to install the filters.
   for (const auto& entry : filters) {
@@ -302,6 +476,76 @@ void Driver::pushdownFilters(int operatorIndex) {
   op->clearDynamicFilters();
 }
 
+class Driver::CallTimer {
+ public:
+  CallTimer(Driver& driver, int32_t operatorIndex, DriverTraceEventKind kind)
+      : driver_(driver),
+        operatorIndex_(operatorIndex),
+        kind_(kind),
+        timer_(
+            timing(driver.operators_[operatorIndex]->stats(), kind),
+            driver.timingSampleRate_),
+        startNanos_(DriverTracer::enabled() ? DriverTracer::nowNanos() : 0) {
+    if (FLAGS_velox_operator_perf_counters) {
+      hasPerfStart_ = process::PerfCounters::read(perfStart_);
+    }
+  }
+
+  ~CallTimer() {
+    if (startNanos_) {
+      driver_.trace(
+          kind_,
+          operatorIndex_,
+          startNanos_,
+          DriverTracer::nowNanos() - startNanos_);
+    }
+    if (hasPerfStart_) {
+      addPerfCounters();
+    }
+  }
+
+ private:
+  static CpuWallTiming& timing(
+      OperatorStats& stats,
+      DriverTraceEventKind kind) {
+    switch (kind) {
+      case DriverTraceEventKind::kAddInput:
+        return stats.addInputTiming;
+      case DriverTraceEventKind::kFinish:
+        return stats.finishTiming;
+      default:
+        return stats.getOutputTiming;
+    }
+  }
+
+  void addPerfCounters() {
+    process::PerfCounterValues end;
+    if (!process::PerfCounters::read(end)) {
+      return;
+    }
+    auto& stats = driver_.operators_[operatorIndex_]->stats();
+    const auto available = process::PerfCounters::available();
+    for (auto i = 0; i < process::kNumPerfEvents; ++i) {
+      if (available & (1U << i)) {
+        stats.addRuntimeStat(
+            process::perfEventName(static_cast<process::PerfEvent>(i)),
+            end.values[i] - perfStart_.values[i]);
+      }
+    }
+  }
+
+  Driver& driver_;
+  const int32_t operatorIndex_;
+  const DriverTraceEventKind kind_;
+  CpuWallTimer timer_;
+  // 0 if not tracing.
+  const uint64_t startNanos_;
+  // The hardware counters at construction if
+  // FLAGS_velox_operator_perf_counters is set and they could be read.
+  bool hasPerfStart_{false};
+  process::PerfCounterValues perfStart_;
+};
+
 void Driver::enqueueInternal() {
   VELOX_CHECK(!state_.isEnqueued);
   state_.isEnqueued = true;
@@ -314,10 +558,20 @@ StopReason Driver::runInternal(
     std::shared_ptr<BlockingState>* blockingState) {
   // Update the next operator's queueTime.
   if (curOpIndex_ < operators_.size()) {
-    operators_[curOpIndex_]->stats().addRuntimeStat(
-        "queuedWallNanos",
-        (getCurrentTimeMicro() - queueTimeStartMicros_) * 1'000);
+    const uint64_t queuedNanos =
+        (getCurrentTimeMicro() - queueTimeStartMicros_) * 1'000;
+    auto& stats = operators_[curOpIndex_]->stats();
+    stats.addRuntimeStat("queuedWallNanos", queuedNanos);
+    stats.queuedWallNanos += queuedNanos;
+    if (DriverTracer::enabled()) {
+      trace(
+          DriverTraceEventKind::kQueued,
+          curOpIndex_,
+          DriverTracer::nowNanos() - queuedNanos,
+          queuedNanos);
+    }
   }
+  timingSampleRate_ = std::max(1, FLAGS_velox_operator_timing_sample_rate);
   // Get 'task_' into a local because this could be unhooked from it on another
   // thread.
   auto task = task_;
@@ -363,6 +617,14 @@ StopReason Driver::runInternal(
   const auto statWriterGuard =
       folly::makeGuard([]() { setRunTimeStatWriter(nullptr); });
 
+  // Charges the CPU time of this time slice to the Task for scheduling.
+  const auto startCpuNanos = process::threadCpuNanos();
+  const auto cpuGuard = folly::makeGuard([&]() {
+    task->addDriverCpuNanos(process::threadCpuNanos() - startCpuNanos);
+  });
+  const uint64_t timeSliceMicros = FLAGS_velox_driver_time_slice_ms * 1'000;
+  const uint64_t startMicros = timeSliceMicros ? getCurrentTimeMicro() : 0;
+
   try {
     int32_t numOperators = operators_.size();
     ContinueFuture future(false);
@@ -370,6 +632,15 @@ StopReason Driver::runInternal(
     for (;;) {
       for (int32_t i = numOperators - 1; i >= 0; --i) {
         stop = task_->shouldStop();
+        if (stop == StopReason::kNone && timeSliceMicros &&
+            getCurrentTimeMicro() - startMicros >= timeSliceMicros) {
+          // Goes to the back of the queue so that other Drivers get the
+          // thread.
+          stop = StopReason::kYield;
+          if (DriverTracer::enabled()) {
+            trace(DriverTraceEventKind::kYield, i, DriverTracer::nowNanos(), 0);
+          }
+        }
         if (stop != StopReason::kNone) {
           guard.notThrown();
           return stop;
@@ -405,7 +676,7 @@ StopReason Driver::runInternal(
             uint64_t resultBytes = 0;
             RowVectorPtr result;
             {
-              CpuWallTimer timer(op->stats().getOutputTiming);
+              CallTimer timer(*this, i, DriverTraceEventKind::kGetOutput);
               result = op->getOutput();
               if (result) {
                 op->stats().outputPositions += result->size();
@@ -415,7 +686,7 @@ StopReason Driver::runInternal(
             }
             pushdownFilters(i);
             if (result) {
-              CpuWallTimer timer(nextOp->stats().addInputTiming);
+              CallTimer timer(*this, i + 1, DriverTraceEventKind::kAddInput);
               nextOp->stats().inputPositions += result->size();
               nextOp->stats().inputBytes += resultBytes;
               nextOp->addInput(result);
@@ -444,7 +715,7 @@ StopReason Driver::runInternal(
               }
               if (op->isFinishing()) {
                 if (!nextOp->isFinishing()) {
-                  CpuWallTimer timer(nextOp->stats().finishTiming);
+                  CallTimer timer(*this, i + 1, DriverTraceEventKind::kFinish);
                   nextOp->finish();
                   break;
                 }
@@ -457,7 +728,7 @@ StopReason Driver::runInternal(
           // this will be detected when trying to add input and we
           // will come back here after this is again on thread.
           {
-            CpuWallTimer timer(op->stats().getOutputTiming);
+            CallTimer timer(*this, i, DriverTraceEventKind::kGetOutput);
             op->getOutput();
           }
           pushdownFilters(i);
@@ -470,7 +741,7 @@ StopReason Driver::runInternal(
             close();
             return StopReason::kAtEnd;
           }
-          CpuWallTimer timer(op->stats().finishTiming);
+          CallTimer timer(*this, i, DriverTraceEventKind::kFinish);
           op->finish();
           break;
         }
@@ -545,6 +816,7 @@ void Driver::close() {
   for (auto& op : operators_) {
     op->close();
   }
+  ctx_->vectorPool.clear();
   Task::removeDriver(task_, this);
   task_ = nullptr;
 }
@@ -573,6 +845,22 @@ bool Driver::mayPushdownAggregation(Operator* aggregation) const {
       aggregation->toString());
 }
 
+Operator* Driver::streamingScanSource(Operator* op) const {
+  if (operators_.empty() ||
+      operators_[0]->stats().operatorType != "TableScan") {
+    return nullptr;
+  }
+  for (auto i = 1; i < operators_.size(); ++i) {
+    if (operators_[i].get() == op) {
+      return operators_[0].get();
+    }
+    if (!operators_[i]->isFilter()) {
+      return nullptr;
+    }
+  }
+  VELOX_FAIL("Operator not found in its Driver: {}", op->toString());
+}
+
 std::unordered_set<ChannelIndex> Driver::canPushdownFilters(
     Operator* FOLLY_NONNULL filterSource,
     const std::vector<ChannelIndex>& channels) const {
@@ -622,6 +910,18 @@ std::unordered_set<ChannelIndex> Driver::canPushdownFilters(
   return supportedChannels;
 }
 
+bool Driver::canPushdownMultiColumnFilter(
+    Operator* FOLLY_NONNULL filterSource,
+    const std::vector<ChannelIndex>& channels) const {
+  for (auto i = 0; i < operators_.size(); ++i) {
+    if (operators_[i].get() == filterSource) {
+      auto targetChannels = channels;
+      return multiColumnFilterTarget(i, targetChannels) >= 0;
+    }
+  }
+  VELOX_FAIL("Operator not found in its Driver: {}", filterSource->toString());
+}
+
 Operator* FOLLY_NULLABLE
 Driver::findOperator(std::string_view planNodeId) const {
   for (auto& op : operators_) {
@@ -663,6 +963,52 @@ SuspendedSection::~SuspendedSection() {
   }
 }
 
+int64_t Driver::reclaim(int64_t targetBytes) {
+  VELOX_CHECK(!isOnThread());
+  int64_t freed = 0;
+  for (auto& op : operators_) {
+    if (freed >= targetBytes) {
+      break;
+    }
+    freed += op->reclaim(targetBytes - freed);
+  }
+  return freed;
+}
+
+void Driver::trace(
+    DriverTraceEventKind kind,
+    int32_t operatorIndex,
+    uint64_t startNanos,
+    uint64_t durationNanos,
+    uint8_t detail) {
+  if (!DriverTracer::enabled()) {
+    return;
+  }
+  auto generation = DriverTracer::generation();
+  if (traceGeneration_ != generation) {
+    traceTaskNameId_ = DriverTracer::nameId(ctx_->task->taskId());
+    traceOperatorNameIds_.clear();
+    for (const auto& op : operators_) {
+      traceOperatorNameIds_.push_back(DriverTracer::nameId(fmt::format(
+          "{} {}", op->stats().operatorType, op->stats().planNodeId)));
+    }
+    traceGeneration_ = generation;
+  }
+  DriverTraceEvent event;
+  event.startNanos = startNanos;
+  event.durationNanos = durationNanos;
+  event.kind = kind;
+  event.detail = detail;
+  event.operatorId = operatorIndex;
+  event.pipelineId = ctx_->pipelineId;
+  event.driverId = ctx_->driverId;
+  if (operatorIndex < traceOperatorNameIds_.size()) {
+    event.operatorNameId = traceOperatorNameIds_[operatorIndex];
+  }
+  event.taskNameId = traceTaskNameId_;
+  DriverTracer::record(event);
+}
+
 std::string Driver::label() const {
   return fmt::format("<Driver {}:{}>", ctx_->task->taskId(), ctx_->driverId);
 }
@@ -22,6 +22,9 @@
 #include "velox/connectors/Connector.h"
 #include "velox/core/PlanNode.h"
 #include "velox/core/QueryCtx.h"
+#include "velox/exec/DriverTracer.h"
+#include "velox/exec/Split.h"
+#include "velox/vector/VectorPool.h"
 
 namespace facebook::velox::exec {
 
@@ -98,6 +101,9 @@ struct ThreadState {
   // memory, which a third party can revoke while the thread is in
   // this state.
   bool isSuspended{false};
+  // True if taken off the executor by its Task to reduce the parallelism
+  // of its pipeline. The Task enqueues it when it is needed again.
+  bool isParked{false};
 
   bool isOnThread() const {
     return thread != std::thread::id();
@@ -124,9 +130,16 @@ enum class BlockingReason {
   kWaitForSplit,
   kWaitForExchange,
   kWaitForJoinBuild,
-  kWaitForMemory
+  kWaitForMemory,
+  // Waiting for the other Drivers of the pipeline to reach a barrier.
+  kWaitForPeers
 };
 
+constexpr int32_t kNumBlockingReasons =
+    static_cast<int32_t>(BlockingReason::kWaitForPeers) + 1;
+
+const char* blockingReasonName(BlockingReason reason);
+
 using ContinueFuture = folly::SemiFuture<bool>;
 
 class BlockingState {
@@ -163,12 +176,20 @@ struct DriverCtx {
   const int pipelineId;
   Driver* FOLLY_NONNULL driver;
   int32_t numDrivers;
+  // The split group the Driver runs for in grouped execution, otherwise
+  // kUngroupedGroupId.
+  const int32_t splitGroupId;
+  // Vectors released by the Operators of the Driver for reuse in later
+  // batches. A vector consumed by one Operator is typically reused for
+  // the output of another Operator of the same Driver.
+  VectorPool vectorPool;
 
   explicit DriverCtx(
       std::shared_ptr<Task> _task,
       int _driverId,
       int _pipelineId,
-      int32_t numDrivers);
+      int32_t numDrivers,
+      int32_t _splitGroupId = kUngroupedGroupId);
 
   velox::memory::MemoryPool* FOLLY_NONNULL addOperatorPool();
 
@@ -231,12 +252,24 @@ class Driver {
   // order-preserving and do not increase cardinality.
   bool mayPushdownAggregation(Operator* FOLLY_NONNULL aggregation) const;
 
+  // Returns the TableScan at the start of 'this' if all operators between it
+  // and 'op' are filters, so that 'op' may stop the scan once it needs no
+  // more rows. Returns nullptr otherwise.
+  Operator* FOLLY_NULLABLE
+  streamingScanSource(Operator* FOLLY_NONNULL op) const;
+
   // Returns a subset of channels for which there are operators upstream from
   // filterSource that accept dynamically generated filters.
   std::unordered_set<ChannelIndex> canPushdownFilters(
       Operator* FOLLY_NONNULL filterSource,
       const std::vector<ChannelIndex>& channels) const;
 
+  // Returns true if there is an operator upstream from filterSource that
+  // accepts a dynamically generated filter on all of 'channels' together.
+  bool canPushdownMultiColumnFilter(
+      Operator* FOLLY_NONNULL filterSource,
+      const std::vector<ChannelIndex>& channels) const;
+
   // Returns the Operator with 'planNodeId.' or nullptr if not
   // found. For example, hash join probe accesses the corresponding
   // build by id.
@@ -244,6 +277,11 @@ class Driver {
 
   void setError(std::exception_ptr exception);
 
+  // Asks the Operators of 'this' to free up to 'targetBytes' of
+  // memory. 'this' must be off thread. Returns the number of bytes
+  // freed.
+  int64_t reclaim(int64_t targetBytes);
+
   std::string toString();
 
   DriverCtx* FOLLY_NONNULL driverCtx() const {
@@ -254,7 +292,19 @@ class Driver {
     return task_;
   }
 
+  // Records an event of 'kind' for the Operator at 'operatorIndex' with the
+  // DriverTracer if tracing is on. 'detail' depends on 'kind'.
+  void trace(
+      DriverTraceEventKind kind,
+      int32_t operatorIndex,
+      uint64_t startNanos,
+      uint64_t durationNanos,
+      uint8_t detail = 0);
+
  private:
+  // Times an Operator call for OperatorStats and the DriverTracer.
+  class CallTimer;
+
   void enqueueInternal();
 
   StopReason runInternal(
@@ -267,6 +317,14 @@ class Driver {
   // position in the pipeline.
   void pushdownFilters(int operatorIndex);
 
+  // Returns the index of the operator upstream from the one at
+  // 'operatorIndex' that receives a filter on all of 'channels' together and
+  // translates 'channels' to the output channels of that operator. Returns -1
+  // if the columns do not reach an operator that accepts filters together.
+  int32_t multiColumnFilterTarget(
+      int32_t operatorIndex,
+      std::vector<ChannelIndex>& channels) const;
+
   std::unique_ptr<DriverCtx> ctx_;
   std::shared_ptr<Task> task_;
 
@@ -282,6 +340,17 @@ class Driver {
   std::vector<std::unique_ptr<Operator>> operators_;
 
   BlockingReason blockingReason_{BlockingReason::kNotBlocked};
+
+  // Operator calls are timed 1 in this many times in the current time
+  // slice.
+  uint32_t timingSampleRate_{1};
+
+  // The DriverTracer generation of the trace name ids below. 0 if there are
+  // none.
+  uint64_t traceGeneration_{0};
+  uint32_t traceTaskNameId_{0};
+  // The name id of each of 'operators_'.
+  std::vector<uint32_t> traceOperatorNameIds_;
 };
 
 using OperatorSupplier = std::function<std::unique_ptr<Operator>(
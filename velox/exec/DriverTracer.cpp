@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/DriverTracer.h"
+
+#include <fmt/format.h>
+#include <folly/json.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include "velox/exec/Driver.h"
+
+DEFINE_bool(
+    velox_driver_trace,
+    false,
+    "Records the Operator calls, blocking and queueing of Drivers for "
+    "export in the Chrome trace format");
+
+DEFINE_int32(
+    velox_driver_trace_events_per_thread,
+    64 << 10,
+    "Number of Driver trace events each thread keeps");
+
+namespace facebook::velox::exec {
+namespace {
+
+constexpr int32_t kWordsPerEvent = 4;
+
+// The trace events of one thread. Only the owning thread writes. The events
+// are stored as relaxed atomic words, so that readers on other threads do
+// not race with the writer. A reader drops the events that the writer may
+// have overwritten while they were copied.
+class EventRing {
+ public:
+  EventRing(uint32_t capacity, uint32_t threadIndex)
+      : capacity_(capacity),
+        threadIndex_(threadIndex),
+        words_(new std::atomic<uint64_t>[capacity * kWordsPerEvent]()) {}
+
+  void record(const DriverTraceEvent& event) {
+    auto index = numStarted_.load(std::memory_order_relaxed);
+    numStarted_.store(index + 1, std::memory_order_relaxed);
+    // Orders the count above before the words below for readers.
+    std::atomic_thread_fence(std::memory_order_release);
+    auto words = &words_[(index % capacity_) * kWordsPerEvent];
+    words[0].store(event.startNanos, std::memory_order_relaxed);
+    words[1].store(event.durationNanos, std::memory_order_relaxed);
+    words[2].store(
+        uint64_t{event.operatorNameId} << 32 |
+            uint64_t{event.operatorId} << 16 |
+            static_cast<uint64_t>(event.kind) << 8 | event.detail,
+        std::memory_order_relaxed);
+    words[3].store(
+        uint64_t{event.taskNameId} << 32 | uint64_t{event.pipelineId} << 16 |
+            event.driverId,
+        std::memory_order_relaxed);
+    numDone_.store(index + 1, std::memory_order_release);
+  }
+
+  void appendEvents(std::vector<DriverTraceEvent>& events) const {
+    auto end = numDone_.load(std::memory_order_acquire);
+    auto begin = std::max(
+        clearedBefore_.load(std::memory_order_relaxed),
+        end > capacity_ ? end - capacity_ : 0);
+    std::vector<DriverTraceEvent> copied;
+    copied.reserve(end - begin);
+    for (auto index = begin; index < end; ++index) {
+      auto words = &words_[(index % capacity_) * kWordsPerEvent];
+      DriverTraceEvent event;
+      event.startNanos = words[0].load(std::memory_order_relaxed);
+      event.durationNanos = words[1].load(std::memory_order_relaxed);
+      auto word = words[2].load(std::memory_order_relaxed);
+      event.operatorNameId = word >> 32;
+      event.operatorId = word >> 16;
+      event.kind = static_cast<DriverTraceEventKind>(word >> 8 & 0xff);
+      event.detail = word;
+      word = words[3].load(std::memory_order_relaxed);
+      event.taskNameId = word >> 32;
+      event.pipelineId = word >> 16;
+      event.driverId = word;
+      event.threadIndex = threadIndex_;
+      copied.push_back(event);
+    }
+    // The writer overwrote the events that are 'capacity_' or more before
+    // the last one it started.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto started = numStarted_.load(std::memory_order_relaxed);
+    auto firstValid = std::min(
+        end, std::max(begin, started > capacity_ ? started - capacity_ : 0));
+    events.insert(
+        events.end(), copied.begin() + (firstValid - begin), copied.end());
+  }
+
+  void clear() {
+    clearedBefore_.store(
+        numDone_.load(std::memory_order_acquire), std::memory_order_relaxed);
+  }
+
+ private:
+  const uint64_t capacity_;
+  const uint32_t threadIndex_;
+  const std::unique_ptr<std::atomic<uint64_t>[]> words_;
+  std::atomic<uint64_t> numStarted_{0};
+  std::atomic<uint64_t> numDone_{0};
+  // Events before this were dropped by clear().
+  std::atomic<uint64_t> clearedBefore_{0};
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<EventRing>> rings;
+  std::unordered_map<std::string, uint32_t> nameIds;
+  std::vector<std::string> names;
+  std::atomic<uint64_t> generation{1};
+};
+
+Registry& registry() {
+  // Never deleted, so that threads can record while the process exits.
+  static auto instance = new Registry();
+  return *instance;
+}
+
+EventRing& threadRing() {
+  thread_local std::shared_ptr<EventRing> ring;
+  if (!ring) {
+    auto& instance = registry();
+    std::lock_guard<std::mutex> l(instance.mutex);
+    ring = std::make_shared<EventRing>(
+        std::max(1, FLAGS_velox_driver_trace_events_per_thread),
+        instance.rings.size());
+    instance.rings.push_back(ring);
+  }
+  return *ring;
+}
+
+} // namespace
+
+const char* driverTraceEventKindName(DriverTraceEventKind kind) {
+  switch (kind) {
+    case DriverTraceEventKind::kAddInput:
+      return "addInput";
+    case DriverTraceEventKind::kGetOutput:
+      return "getOutput";
+    case DriverTraceEventKind::kFinish:
+      return "finish";
+    case DriverTraceEventKind::kBlocked:
+      return "blocked";
+    case DriverTraceEventKind::kQueued:
+      return "queued";
+    case DriverTraceEventKind::kYield:
+      return "yield";
+  }
+  return "unknown";
+}
+
+// static
+uint32_t DriverTracer::nameId(const std::string& name) {
+  auto& instance = registry();
+  std::lock_guard<std::mutex> l(instance.mutex);
+  auto it = instance.nameIds.find(name);
+  if (it != instance.nameIds.end()) {
+    return it->second;
+  }
+  uint32_t id = instance.names.size();
+  instance.names.push_back(name);
+  instance.nameIds[name] = id;
+  return id;
+}
+
+// static
+uint64_t DriverTracer::generation() {
+  return registry().generation.load(std::memory_order_acquire);
+}
+
+// static
+void DriverTracer::record(const DriverTraceEvent& event) {
+  threadRing().record(event);
+}
+
+// static
+std::vector<DriverTraceEvent> DriverTracer::events() {
+  std::vector<std::shared_ptr<EventRing>> rings;
+  {
+    auto& instance = registry();
+    std::lock_guard<std::mutex> l(instance.mutex);
+    rings = instance.rings;
+  }
+  std::vector<DriverTraceEvent> events;
+  for (const auto& ring : rings) {
+    ring->appendEvents(events);
+  }
+  return events;
+}
+
+// static
+std::string DriverTracer::toChromeTrace() {
+  auto traceEvents = events();
+  std::vector<std::string> names;
+  {
+    auto& instance = registry();
+    std::lock_guard<std::mutex> l(instance.mutex);
+    names = instance.names;
+  }
+  auto name = [&](uint32_t id) -> std::string {
+    return id < names.size() ? names[id] : "unknown";
+  };
+
+  folly::dynamic result = folly::dynamic::array;
+  // Tasks by pid and Drivers by pid and tid.
+  std::set<uint32_t> tasks;
+  std::set<std::pair<uint32_t, uint32_t>> drivers;
+  for (const auto& event : traceEvents) {
+    uint32_t tid = uint32_t{event.pipelineId} << 16 | event.driverId;
+    tasks.insert(event.taskNameId);
+    drivers.emplace(event.taskNameId, tid);
+    folly::dynamic args = folly::dynamic::object("thread", event.threadIndex);
+    std::string eventName;
+    switch (event.kind) {
+      case DriverTraceEventKind::kAddInput:
+      case DriverTraceEventKind::kGetOutput:
+      case DriverTraceEventKind::kFinish:
+        eventName = name(event.operatorNameId);
+        args["operatorId"] = event.operatorId;
+        break;
+      case DriverTraceEventKind::kBlocked:
+        eventName = fmt::format(
+            "blocked {}",
+            blockingReasonName(static_cast<BlockingReason>(event.detail)));
+        args["operator"] = name(event.operatorNameId);
+        break;
+      default:
+        eventName = driverTraceEventKindName(event.kind);
+        break;
+    }
+    folly::dynamic traceEvent = folly::dynamic::object("name", eventName)(
+        "cat", driverTraceEventKindName(event.kind))(
+        "ts", event.startNanos / 1'000.0)("pid", event.taskNameId)(
+        "tid", tid)("args", std::move(args));
+    if (event.kind == DriverTraceEventKind::kYield) {
+      traceEvent["ph"] = "i";
+      traceEvent["s"] = "t";
+    } else {
+      traceEvent["ph"] = "X";
+      traceEvent["dur"] = event.durationNanos / 1'000.0;
+    }
+    result.push_back(std::move(traceEvent));
+  }
+  for (auto task : tasks) {
+    result.push_back(folly::dynamic::object("name", "process_name")(
+        "ph", "M")("pid", task)(
+        "args", folly::dynamic::object("name", name(task))));
+  }
+  for (const auto& [task, tid] : drivers) {
+    result.push_back(folly::dynamic::object("name", "thread_name")(
+        "ph", "M")("pid", task)("tid", tid)(
+        "args",
+        folly::dynamic::object(
+            "name",
+            fmt::format("pipeline {} driver {}", tid >> 16, tid & 0xffff))));
+  }
+  return folly::toJson(folly::dynamic::object("traceEvents", result));
+}
+
+// static
+void DriverTracer::clear() {
+  auto& instance = registry();
+  std::lock_guard<std::mutex> l(instance.mutex);
+  for (auto& ring : instance.rings) {
+    ring->clear();
+  }
+  instance.names.clear();
+  instance.nameIds.clear();
+  ++instance.generation;
+}
+
+} // namespace facebook::velox::exec
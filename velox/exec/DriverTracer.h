@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <gflags/gflags.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+DECLARE_bool(velox_driver_trace);
+DECLARE_int32(velox_driver_trace_events_per_thread);
+
+namespace facebook::velox::exec {
+
+enum class DriverTraceEventKind : uint8_t {
+  // Calls of Operator::addInput(), getOutput() and finish().
+  kAddInput,
+  kGetOutput,
+  kFinish,
+  // The Driver waited for the future of a blocked Operator. 'detail' is the
+  // BlockingReason.
+  kBlocked,
+  // The Driver waited in the executor queue for a thread.
+  kQueued,
+  // The Driver left its thread at the end of its time slice.
+  kYield,
+};
+
+const char* driverTraceEventKindName(DriverTraceEventKind kind);
+
+// An interval in the life of a Driver. Names are ids from
+// DriverTracer::nameId().
+struct DriverTraceEvent {
+  // Steady clock time of the start.
+  uint64_t startNanos{0};
+  uint64_t durationNanos{0};
+  DriverTraceEventKind kind{DriverTraceEventKind::kGetOutput};
+  uint8_t detail{0};
+  uint16_t operatorId{0};
+  uint16_t pipelineId{0};
+  uint16_t driverId{0};
+  // The type and plan node id of the Operator.
+  uint32_t operatorNameId{0};
+  uint32_t taskNameId{0};
+  // Index of the thread that recorded the event. Set by events().
+  uint32_t threadIndex{0};
+};
+
+// Records DriverTraceEvents while FLAGS_velox_driver_trace is true. Each
+// thread writes to its own ring buffer of
+// FLAGS_velox_driver_trace_events_per_thread events without locks. When the
+// buffer is full, the thread overwrites its oldest events. The events can be
+// read at any time from any thread and exported in the Chrome trace format
+// to show pipeline stalls and blocking over time.
+class DriverTracer {
+ public:
+  static bool enabled() {
+    return FLAGS_velox_driver_trace;
+  }
+
+  static uint64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Returns the id of 'name'. Ids stay valid until clear(). Takes a lock,
+  // so callers intern their names once and keep the ids for
+  // generation().
+  static uint32_t nameId(const std::string& name);
+
+  // Incremented by clear(). Ids from nameId() of an older generation are
+  // invalid.
+  static uint64_t generation();
+
+  // Appends 'event' to the ring buffer of the calling thread.
+  static void record(const DriverTraceEvent& event);
+
+  // Returns the events of all threads, oldest first per thread.
+  static std::vector<DriverTraceEvent> events();
+
+  // Returns events() as a JSON object in the Chrome trace event format, as
+  // read by chrome://tracing and Perfetto. Each Task is a process and each
+  // Driver of the Task is a thread of it.
+  static std::string toChromeTrace();
+
+  // Drops all events and names.
+  static void clear();
+};
+
+} // namespace facebook::velox::exec
@@ -46,10 +46,53 @@ SerializedPage::SerializedPage(
   VELOX_CHECK_EQ(toRead, 0);
 }
 
+SerializedPage::SerializedPage(std::shared_ptr<VectorStreamGroup> group)
+    : allocation_(group->mappedMemory()) {
+  rowVectorGroup_ = std::dynamic_pointer_cast<RowVectorGroup>(group);
+  if (rowVectorGroup_) {
+    return;
+  }
+  group_ = std::move(group);
+  group_->flush(&writer_);
+  ranges_ = writer_.takeRanges();
+}
+
 void SerializedPage::prepareStreamForDeserialize(ByteStream* input) {
+  VELOX_CHECK_NULL(
+      rowVectorGroup_, "A page of unserialized rows cannot be deserialized");
   input->resetInput(std::move(ranges_));
 }
 
+void RowVectorGroup::append(
+    const RowVectorPtr& vector,
+    const folly::Range<const IndexRange*>& ranges) {
+  if (vectors_.empty() || vectors_.back().first != vector) {
+    vectors_.emplace_back(vector, std::vector<IndexRange>{});
+  }
+  auto& vectorRanges = vectors_.back().second;
+  for (const auto& range : ranges) {
+    vectorRanges.push_back(range);
+    numRows_ += range.size;
+  }
+}
+
+void RowVectorGroup::copyTo(RowVector& result, vector_size_t offset) const {
+  VELOX_CHECK_LE(offset + numRows_, result.size());
+  for (const auto& [vector, ranges] : vectors_) {
+    for (const auto& range : ranges) {
+      result.copy(vector.get(), offset, range.begin, range.size);
+      offset += range.size;
+    }
+  }
+}
+
+VectorSerde::Options exchangeSerdeOptions(const core::QueryConfig& config) {
+  VectorSerde::Options options;
+  options.compressionKind =
+      common::stringToCompressionKind(config.exchangeCompressionCodec());
+  return options;
+}
+
 std::shared_ptr<ExchangeSource> ExchangeSource::create(
     const std::string& taskId,
     int destination,
@@ -79,7 +122,9 @@ class LocalExchangeSource : public ExchangeSource {
       : ExchangeSource(taskId, destination, queue) {}
 
   bool shouldRequestLocked() override {
-    if (atEnd_ && queue_->empty()) {
+    // Requests may be issued while 'queue_' has pages, so a source at end
+    // is never requested again.
+    if (atEnd_) {
       return false;
     }
     bool pending = requestPending_;
@@ -87,7 +132,7 @@ class LocalExchangeSource : public ExchangeSource {
     return !pending;
   }
 
-  void request() override {
+  void request(uint64_t maxBytes) override {
     auto buffers = PartitionedOutputBufferManager::getInstance().lock();
     VELOX_CHECK_NOT_NULL(buffers, "invalid PartitionedOutputBufferManager");
     VELOX_CHECK(requestPending_);
@@ -96,11 +141,11 @@ class LocalExchangeSource : public ExchangeSource {
     buffers->getData(
         taskId_,
         destination_,
-        kMaxBytes,
+        maxBytes,
         sequence_,
         // Since this lambda may outlive 'this', we need to capture a
         // shared_ptr to the current object (self).
-        [self, requestedSequence, buffers, this](
+        [self, requestedSequence, maxBytes, buffers, this](
             std::vector<std::shared_ptr<VectorStreamGroup>>& data,
             int64_t sequence) {
           if (requestedSequence > sequence) {
@@ -121,13 +166,14 @@ class LocalExchangeSource : public ExchangeSource {
               // Keep looping, there could be extra end markers.
               continue;
             }
-            pages.push_back(SerializedPage::fromVectorStreamGroup(group.get()));
-            group = nullptr;
+            pages.push_back(
+                SerializedPage::fromVectorStreamGroup(std::move(group)));
           }
           int64_t ackSequence;
           {
             std::lock_guard<std::mutex> l(queue_->mutex());
             requestPending_ = false;
+            queue_->removePendingBytes(maxBytes);
             for (auto& page : pages) {
               queue_->enqueue(std::move(page));
             }
@@ -147,9 +193,6 @@ class LocalExchangeSource : public ExchangeSource {
   }
 
   void close() override {}
-
- private:
-  static constexpr uint64_t kMaxBytes = 32 * 1024 * 1024; // 32 MB
 };
 
 std::unique_ptr<ExchangeSource> createLocalExchangeSource(
@@ -166,7 +209,8 @@ std::unique_ptr<ExchangeSource> createLocalExchangeSource(
 } // namespace
 
 void ExchangeClient::addRemoteTaskId(const std::string& taskId) {
-  std::shared_ptr<ExchangeSource> toRequest;
+  std::vector<std::shared_ptr<ExchangeSource>> toRequest;
+  uint64_t requestBytes;
   {
     std::lock_guard<std::mutex> l(queue_->mutex());
     bool duplicate = !taskIds_.insert(taskId).second;
@@ -178,12 +222,12 @@ void ExchangeClient::addRemoteTaskId(const std::string& taskId) {
     auto source = ExchangeSource::create(taskId, destination_, queue_);
     sources_.push_back(source);
     queue_->addSource();
-    if (source->shouldRequestLocked()) {
-      toRequest = source;
-    }
+    requestBytes = pickSourcesToRequestLocked(toRequest);
   }
   // Outside of lock
-  toRequest->request();
+  for (auto& source : toRequest) {
+    source->request(requestBytes);
+  }
 }
 
 void ExchangeClient::noMoreRemoteTasks() {
@@ -191,30 +235,62 @@ void ExchangeClient::noMoreRemoteTasks() {
   queue_->noMoreSources();
 }
 
+uint64_t ExchangeClient::pickSourcesToRequestLocked(
+    std::vector<std::shared_ptr<ExchangeSource>>& toRequest) {
+  auto pageSize = std::max(queue_->averagePageSize(), kMinRequestBytes);
+  auto usedBytes = queue_->totalBytes() + queue_->pendingBytes();
+  auto availableBytes =
+      usedBytes < maxQueuedBytes_ ? maxQueuedBytes_ - usedBytes : 0;
+  auto maxSources = availableBytes / pageSize;
+  if (maxSources == 0) {
+    if (usedBytes > 0) {
+      // The consumer has data in the queue or on the way.
+      return 0;
+    }
+    // A page is larger than the budget. Requests one at a time.
+    maxSources = 1;
+  }
+  for (auto& source : sources_) {
+    if (toRequest.size() == maxSources) {
+      break;
+    }
+    if (source->shouldRequestLocked()) {
+      toRequest.push_back(source);
+    }
+  }
+  if (toRequest.empty()) {
+    return 0;
+  }
+  auto requestBytes = std::min(
+      kMaxRequestBytes,
+      std::max<uint64_t>(pageSize, availableBytes / toRequest.size()));
+  queue_->addPendingBytes(requestBytes * toRequest.size());
+  return requestBytes;
+}
+
 std::unique_ptr<SerializedPage> ExchangeClient::next(
     bool* atEnd,
     ContinueFuture* future) {
   std::vector<std::shared_ptr<ExchangeSource>> toRequest;
+  std::unique_ptr<SerializedPage> page;
+  uint64_t requestBytes;
   {
     std::lock_guard<std::mutex> l(queue_->mutex());
     *atEnd = false;
-    auto page = queue_->dequeue(atEnd, future);
-    if (*atEnd || page) {
+    page = queue_->dequeue(atEnd, future);
+    if (*atEnd) {
       return page;
     }
-    // There is no data to return, send out more requests.
-    for (auto& source : sources_) {
-      if (source->shouldRequestLocked()) {
-        toRequest.push_back(source);
-      }
-    }
+    // Keeps requesting while there is room in the budget so that the
+    // sources produce the next pages while the consumer works on this one.
+    requestBytes = pickSourcesToRequestLocked(toRequest);
   }
 
   // Outside of lock
   for (auto& source : toRequest) {
-    source->request();
+    source->request(requestBytes);
   }
-  return nullptr;
+  return page;
 }
 
 ExchangeClient::~ExchangeClient() {
@@ -242,8 +318,8 @@ BlockingReason Exchange::getSplits(ContinueFuture* future) {
   }
   for (;;) {
     exec::Split split;
-    auto reason =
-        operatorCtx_->task()->getSplitOrFuture(planNodeId_, split, *future);
+    auto reason = operatorCtx_->task()->getSplitOrFuture(
+        operatorCtx_->driverCtx()->splitGroupId, planNodeId_, split, *future);
     if (reason == BlockingReason::kNotBlocked) {
       if (split.hasConnectorSplit()) {
         auto remoteSplit = std::dynamic_pointer_cast<RemoteConnectorSplit>(
@@ -289,12 +365,62 @@ void Exchange::finish() {
   operatorCtx_->task()->multipleSplitsFinished(numSplits_);
 }
 
+void Exchange::prepareOutput(vector_size_t numRows) {
+  if (numOutputRows_ == 0) {
+    if (output_ && output_.unique()) {
+      for (auto i = 0; i < output_->childrenSize(); ++i) {
+        auto& child = output_->childAt(i);
+        if (child.unique()) {
+          child->resize(0);
+        } else {
+          child = BaseVector::create(
+              outputType_->childAt(i), 0, operatorCtx_->pool());
+        }
+      }
+    } else {
+      output_ = std::static_pointer_cast<RowVector>(
+          BaseVector::create(outputType_, 0, operatorCtx_->pool()));
+    }
+  }
+  output_->resize(numOutputRows_ + numRows);
+}
+
+void Exchange::appendToOutput() {
+  auto numRows = result_->size();
+  prepareOutput(numRows);
+  output_->copy(result_.get(), numOutputRows_, 0, numRows);
+  numOutputRows_ += numRows;
+}
+
+void Exchange::appendToOutput(const RowVectorGroup& group) {
+  prepareOutput(group.numRows());
+  group.copyTo(*output_, numOutputRows_);
+  numOutputRows_ += group.numRows();
+}
+
+RowVectorPtr Exchange::takeOutput() {
+  numOutputRows_ = 0;
+  return output_;
+}
+
 RowVectorPtr Exchange::getOutput() {
   blockingReason_ = getSplits(&future_);
   if (blockingReason_ != BlockingReason::kNotBlocked) {
     return nullptr;
   }
   for (;;) {
+    if (currentPage_ && currentPage_->rowVectorGroup()) {
+      auto group = currentPage_->rowVectorGroup();
+      stats_.rawInputBytes += currentPage_->byteSize();
+      stats_.inputPositions += group->numRows();
+      stats_.inputBytes += currentPage_->byteSize();
+      appendToOutput(*group);
+      currentPage_ = nullptr;
+      if (numOutputRows_ >= outputBatchSize_) {
+        return takeOutput();
+      }
+      continue;
+    }
     if (currentPage_) {
       if (!inputStream_) {
         inputStream_ = std::make_unique<ByteStream>();
@@ -303,7 +429,11 @@ RowVectorPtr Exchange::getOutput() {
       }
 
       VectorStreamGroup::read(
-          inputStream_.get(), operatorCtx_->pool(), outputType_, &result_);
+          inputStream_.get(),
+          operatorCtx_->pool(),
+          outputType_,
+          &result_,
+          &serdeOptions_);
 
       stats_.inputPositions += result_->size();
       stats_.inputBytes += result_->retainedSize();
@@ -313,17 +443,31 @@ RowVectorPtr Exchange::getOutput() {
         inputStream_ = nullptr;
       }
 
-      return result_;
+      // A full size page is produced as is, without copying.
+      if (numOutputRows_ == 0 && result_->size() >= outputBatchSize_) {
+        return result_;
+      }
+      appendToOutput();
+      if (numOutputRows_ >= outputBatchSize_) {
+        return takeOutput();
+      }
+      continue;
     }
     bool atEnd = false;
     currentPage_ = exchangeClient_->next(&atEnd, &future_);
     if (!currentPage_) {
+      if (numOutputRows_ > 0) {
+        // Produces the rows of the small pages so far instead of waiting
+        // for more. The next call gets a new future if still blocked.
+        return takeOutput();
+      }
       blockingReason_ = atEnd ? BlockingReason::kNotBlocked
                               : BlockingReason::kWaitForExchange;
       return nullptr;
     }
   }
 }
+
 VELOX_REGISTER_EXCHANGE_SOURCE_METHOD_DEFINITION(
     ExchangeSource,
     createLocalExchangeSource);
@@ -20,6 +20,44 @@
 
 namespace facebook::velox::exec {
 
+// A page of an exchange between Tasks of this process that holds ranges of
+// RowVectors instead of serializing them. size() is the estimated
+// serialized size of the rows, so that the output buffers apply the same
+// flow control as to serialized pages. Keeps the producer Task live, since
+// its memory pools own the memory of the vectors.
+class RowVectorGroup : public VectorStreamGroup {
+ public:
+  RowVectorGroup(memory::MappedMemory* memory, std::shared_ptr<Task> producer)
+      : VectorStreamGroup(memory), producer_(std::move(producer)) {}
+
+  // Adds 'ranges' of 'vector' without copying them.
+  void append(
+      const RowVectorPtr& vector,
+      const folly::Range<const IndexRange*>& ranges);
+
+  void setSize(uint64_t bytes) {
+    size_ = bytes;
+  }
+
+  size_t size() const override {
+    return size_;
+  }
+
+  vector_size_t numRows() const {
+    return numRows_;
+  }
+
+  // Copies the rows of 'this' into 'result' starting at row 'offset'.
+  // 'result' must have space for them.
+  void copyTo(RowVector& result, vector_size_t offset) const;
+
+ private:
+  const std::shared_ptr<Task> producer_;
+  std::vector<std::pair<RowVectorPtr, std::vector<IndexRange>>> vectors_;
+  vector_size_t numRows_{0};
+  uint64_t size_{0};
+};
+
 // Corresponds to Presto SerializedPage, i.e. a container for
 // serialize vectors in Presto wire format.
 class SerializedPage {
@@ -32,10 +70,24 @@ class SerializedPage {
       uint64_t size,
       memory::MappedMemory* memory);
 
+  // Construct from the serialized contents of 'group' without copying
+  // them. 'this' keeps 'group' live until destruction. A RowVectorGroup is
+  // kept as is for rowVectorGroup().
+  explicit SerializedPage(std::shared_ptr<VectorStreamGroup> group);
+
   ~SerializedPage() = default;
 
   uint64_t byteSize() const {
-    return allocation_.byteSize();
+    if (rowVectorGroup_) {
+      return rowVectorGroup_->size();
+    }
+    return group_ ? writer_.size() : allocation_.byteSize();
+  }
+
+  // Returns the unserialized rows of a page from a Task of this process or
+  // nullptr if 'this' holds serialized bytes.
+  const RowVectorGroup* FOLLY_NULLABLE rowVectorGroup() const {
+    return rowVectorGroup_.get();
   }
 
   // Makes 'input' ready for deserializing 'this' with
@@ -43,18 +95,26 @@ class SerializedPage {
   void prepareStreamForDeserialize(ByteStream* input);
 
   static std::unique_ptr<SerializedPage> fromVectorStreamGroup(
-      VectorStreamGroup* group) {
-    std::stringstream out;
-    group->flush(&out);
-    return std::make_unique<SerializedPage>(
-        &out, out.tellp(), group->mappedMemory());
+      std::shared_ptr<VectorStreamGroup> group) {
+    return std::make_unique<SerializedPage>(std::move(group));
   }
 
  private:
   memory::MappedMemory::Allocation allocation_;
   std::vector<ByteRange> ranges_;
+
+  // Set if 'ranges_' refer to the streams of 'group_' and the headers in
+  // 'writer_' instead of 'allocation_'.
+  std::shared_ptr<VectorStreamGroup> group_;
+  ByteRangeWriter writer_;
+
+  std::shared_ptr<RowVectorGroup> rowVectorGroup_;
 };
 
+// Returns the serde options for the pages of the remote exchanges of a query
+// with 'config'.
+VectorSerde::Options exchangeSerdeOptions(const core::QueryConfig& config);
+
 // Queue of results retrieved from source. Owned by shared_ptr by
 // Exchange and client threads and registered callbacks waiting
 // for input.
@@ -73,12 +133,42 @@ class ExchangeQueue {
     return queue_.empty();
   }
 
+  // Total bytes of the pages in the queue.
+  uint64_t totalBytes() const {
+    return totalBytes_;
+  }
+
+  // Moving average of the sizes of the recently enqueued pages. 0 before
+  // the first page.
+  uint64_t averagePageSize() const {
+    return averagePageSize_;
+  }
+
+  // Bytes requested from the sources and not yet received.
+  uint64_t pendingBytes() const {
+    return pendingBytes_;
+  }
+
+  void addPendingBytes(uint64_t bytes) {
+    pendingBytes_ += bytes;
+  }
+
+  void removePendingBytes(uint64_t bytes) {
+    VELOX_CHECK_GE(pendingBytes_, bytes);
+    pendingBytes_ -= bytes;
+  }
+
   void enqueue(std::unique_ptr<SerializedPage>&& page) {
     if (!page) {
       ++numCompleted_;
       checkComplete();
       return;
     }
+    auto pageSize = page->byteSize();
+    totalBytes_ += pageSize;
+    averagePageSize_ = averagePageSize_ == 0
+        ? pageSize
+        : (averagePageSize_ * 7 + pageSize) / 8;
     queue_.push_back(std::move(page));
     if (!promises_.empty()) {
       // Resume one of the waiting drivers.
@@ -117,6 +207,7 @@ class ExchangeQueue {
     }
     auto page = std::move(queue_.front());
     queue_.pop_front();
+    totalBytes_ -= page->byteSize();
     *atEnd = false;
     return page;
   }
@@ -152,6 +243,9 @@ class ExchangeQueue {
   bool atEnd_ = false;
   std::mutex mutex_;
   std::deque<std::unique_ptr<SerializedPage>> queue_;
+  uint64_t totalBytes_ = 0;
+  uint64_t averagePageSize_ = 0;
+  uint64_t pendingBytes_ = 0;
   std::vector<VeloxPromise<bool>> promises_;
   // When set, all promises will be realized and the next dequeue will
   // throw an exception with this message.
@@ -187,10 +281,13 @@ class ExchangeSource : public std::enable_shared_from_this<ExchangeSource> {
   // threads from issuing the same request.
   virtual bool shouldRequestLocked() = 0;
 
-  // Requests the producer to generate more data. Call only if shouldRequest()
-  // was true. The object handles its own lifetime by acquiring a
+  // Requests the producer to generate more data, about 'maxBytes' of
+  // pages. The producer returns at least one page if it has any. Call only
+  // if shouldRequest() was true. 'maxBytes' is added to the pending bytes
+  // of 'queue_' by the caller and the source removes it when the response
+  // arrives. The object handles its own lifetime by acquiring a
   // shared_from_this() pointer if needed.
-  virtual void request() = 0;
+  virtual void request(uint64_t maxBytes) = 0;
 
   // Close the exchange source. May be called before all data
   // has been received and proessed. This can happen in case
@@ -232,11 +329,20 @@ struct RemoteConnectorSplit : public connector::ConnectorSplit {
 };
 
 // Handle for a set of producers. This may be shared by multiple Exchanges, one
-// per consumer thread.
+// per consumer thread. The pages in the queue and the pages requested from
+// the sources are limited to 'maxQueuedBytes'. Each request asks for an equal
+// share of the remaining budget, but for at least one page of the recent
+// average size.
 class ExchangeClient {
  public:
-  explicit ExchangeClient(int destination)
-      : destination_(destination), queue_(std::make_shared<ExchangeQueue>()) {
+  static constexpr uint64_t kDefaultMaxQueuedBytes = 32 << 20; // 32 MB
+
+  explicit ExchangeClient(
+      int destination,
+      uint64_t maxQueuedBytes = kDefaultMaxQueuedBytes)
+      : destination_(destination),
+        maxQueuedBytes_(maxQueuedBytes),
+        queue_(std::make_shared<ExchangeQueue>()) {
     VELOX_CHECK(
         destination >= 0,
         "Exchange client destination must be greater than zero, got {}",
@@ -258,7 +364,19 @@ class ExchangeClient {
   std::string toString();
 
  private:
+  // Smallest and largest request to a single source.
+  static constexpr uint64_t kMinRequestBytes = 64 << 10; // 64 KB
+  static constexpr uint64_t kMaxRequestBytes = 32 << 20; // 32 MB
+
+  // Selects the idle sources to request data from, as many as fit in the
+  // budget. Returns the bytes to request from each and adds them to the
+  // pending bytes of 'queue_'. Call while holding a lock over
+  // queue_->mutex().
+  uint64_t pickSourcesToRequestLocked(
+      std::vector<std::shared_ptr<ExchangeSource>>& toRequest);
+
   const int destination_;
+  const uint64_t maxQueuedBytes_;
   std::shared_ptr<ExchangeQueue> queue_;
   std::unordered_set<std::string> taskIds_;
   std::vector<std::shared_ptr<ExchangeSource>> sources_;
@@ -278,6 +396,10 @@ class Exchange : public SourceOperator {
             exchangeNode->id(),
             "Exchange"),
         planNodeId_(exchangeNode->id()),
+        serdeOptions_(exchangeSerdeOptions(
+            ctx->execCtx->queryCtx()->config())),
+        outputBatchSize_{
+            ctx->execCtx->queryCtx()->config().preferredOutputBatchSize()},
         future_(false),
         exchangeClient_(std::move(exchangeClient)) {}
 
@@ -292,6 +414,7 @@ class Exchange : public SourceOperator {
   void close() override {
     currentPage_ = nullptr;
     result_ = nullptr;
+    output_ = nullptr;
     exchangeClient_ = nullptr;
   }
 
@@ -300,11 +423,34 @@ class Exchange : public SourceOperator {
  private:
   BlockingReason getSplits(ContinueFuture* future);
 
+  // Makes 'output_' ready for 'numRows' more rows. Starts a new 'output_'
+  // or reuses the previous one if the consumer has released it.
+  void prepareOutput(vector_size_t numRows);
+
+  // Appends the rows of 'result_' to 'output_'.
+  void appendToOutput();
+
+  // Copies the rows of 'group' to 'output_'. These are from a Task of this
+  // process and are not kept referenced, since the memory of the rows
+  // belongs to the producer.
+  void appendToOutput(const RowVectorGroup& group);
+
+  // Returns the rows accumulated in 'output_'. 'output_' stays referenced
+  // so that its memory can be reused for the next batch.
+  RowVectorPtr takeOutput();
+
   const core::PlanNodeId planNodeId_;
+  const VectorSerde::Options serdeOptions_;
+  // Number of rows to accumulate from small pages before producing output.
+  const uint32_t outputBatchSize_;
   bool noMoreSplits_ = false;
   BlockingReason blockingReason_{BlockingReason::kNotBlocked};
   ContinueFuture future_;
+  // The vector deserialized from the current page.
   RowVectorPtr result_;
+  // Rows of consecutive small pages, up to 'outputBatchSize_'.
+  RowVectorPtr output_;
+  vector_size_t numOutputRows_{0};
   std::shared_ptr<ExchangeClient> exchangeClient_;
   std::unique_ptr<SerializedPage> currentPage_;
   std::unique_ptr<ByteStream> inputStream_;
@@ -15,6 +15,8 @@
  */
 #include "velox/exec/FilterProject.h"
 #include "velox/core/Expressions.h"
+#include "velox/exec/Task.h"
+#include "velox/exec/TaskTemplate.h"
 #include "velox/expression/Expr.h"
 
 namespace facebook::velox::exec {
@@ -41,14 +43,20 @@ FilterProject::FilterProject(
     int32_t operatorId,
     DriverCtx* driverCtx,
     const std::shared_ptr<const core::FilterNode>& filter,
-    const std::shared_ptr<const core::ProjectNode>& project)
+    const std::shared_ptr<const core::ProjectNode>& project,
+    bool coalesceOutput)
     : Operator(
           driverCtx,
           project ? project->outputType() : filter->outputType(),
           operatorId,
           project ? project->id() : filter->id(),
           "FilterProject"),
-      hasFilter_(filter != nullptr) {
+      hasFilter_(filter != nullptr),
+      trackExprStats_(
+          driverCtx->execCtx->queryCtx()->config().exprTrackStats()),
+      coalesceOutput_(coalesceOutput && filter != nullptr),
+      outputBatchSize_(
+          driverCtx->execCtx->queryCtx()->config().preferredOutputBatchSize()) {
   std::vector<std::shared_ptr<const core::ITypedExpr>> allExprs;
   if (hasFilter_) {
     allExprs.push_back(filter->filter());
@@ -71,7 +79,58 @@ FilterProject::FilterProject(
     isIdentityProjection_ = true;
   }
   numExprs_ = allExprs.size();
+  // The identity projections pass input columns through to the output, so
+  // these must be loaded for all rows. The other columns may be loaded for
+  // only the rows that reach the branches of IF, AND or OR that use them.
+  const auto& inputType =
+      project ? project->sources()[0]->outputType() : filter->outputType();
+  auto initExprSet = [&](ExprSet& exprSet) {
+    std::unordered_set<std::string> readColumns;
+    for (const auto& projection : identityProjections_) {
+      readColumns.insert(inputType->nameOf(projection.inputChannel));
+    }
+    exprSet.enableLazyLoadingInBranches(readColumns);
+  };
+  // The ExprSets of a TaskTemplate are reused by its later Tasks. Stats
+  // would add up over the Tasks, so these are compiled per operator.
+  if (!trackExprStats_ && driverCtx->task->taskTemplate()) {
+    taskTemplate_ = driverCtx->task->taskTemplate();
+    exprs_ = taskTemplate_->getExprSet(
+        planNodeId(), std::move(allExprs), initExprSet);
+    return;
+  }
   exprs_ = makeExprSetFromFlag(std::move(allExprs), operatorCtx_->execCtx());
+  initExprSet(*exprs_);
+  if (trackExprStats_) {
+    exprs_->setTrackStats(true);
+  }
+}
+
+void FilterProject::close() {
+  Operator::close();
+  if (taskTemplate_ && exprs_) {
+    taskTemplate_->releaseExprSet(planNodeId(), std::move(exprs_));
+  } else if (exprs_) {
+    exprs_->clear();
+  }
+}
+
+void FilterProject::finish() {
+  Operator::finish();
+  if (trackExprStats_) {
+    addExprStats();
+  }
+}
+
+void FilterProject::addExprStats() {
+  for (const auto& [path, exprStats] : exprs_->stats()) {
+    auto prefix = fmt::format("expr.{}.", path);
+    stats_.addRuntimeStat(prefix + "numCalls", exprStats.timing.count);
+    stats_.addRuntimeStat(prefix + "cpuNanos", exprStats.timing.cpuNanos);
+    stats_.addRuntimeStat(prefix + "numRows", exprStats.numProcessedRows);
+    stats_.addRuntimeStat(prefix + "numPeeled", exprStats.numPeeled);
+    stats_.addRuntimeStat(prefix + "numMemoized", exprStats.numMemoized);
+  }
 }
 
 void FilterProject::addInput(RowVectorPtr input) {
@@ -111,6 +170,10 @@ RowVectorPtr FilterProject::getOutput() {
   if (allInputProcessed()) {
     clearIdentityProjectedOutput();
     clearNonReusableOutput();
+    if (isFinishing_ && coalesced_) {
+      stats_.addRuntimeStat("coalescedBatches", 1);
+      return std::move(coalesced_);
+    }
     return nullptr;
   }
   vector_size_t size = input_->size();
@@ -140,6 +203,8 @@ RowVectorPtr FilterProject::getOutput() {
   // evaluate filter
   auto numOut = filter(&evalCtx, *rows);
   numProcessedInputRows_ = size;
+  numFilterInputRows_ += size;
+  numFilterOutputRows_ += numOut;
   if (numOut == 0) { // no rows passed the filer
     inputProcessed();
     return nullptr;
@@ -155,8 +220,43 @@ RowVectorPtr FilterProject::getOutput() {
     project(*rows, &evalCtx);
   }
 
-  return fillOutput(
+  auto output = fillOutput(
       numOut, allRowsSelected ? nullptr : filterEvalCtx_.selectedIndices);
+  if (coalesceOutput_) {
+    return maybeCoalesce(std::move(output));
+  }
+  return output;
+}
+
+RowVectorPtr FilterProject::maybeCoalesce(RowVectorPtr output) {
+  bool coalesce = output->size() < outputBatchSize_ &&
+      numFilterOutputRows_ <= numFilterInputRows_ * kMaxCoalescedSelectivity;
+  if (!coalesce && !coalesced_) {
+    return output;
+  }
+  // Rows already in 'coalesced_' precede 'output', so 'output' is added
+  // to these even if it is not small.
+  appendCoalesced(output);
+  if (!coalesce || coalesced_->size() >= outputBatchSize_) {
+    stats_.addRuntimeStat("coalescedBatches", 1);
+    return std::move(coalesced_);
+  }
+  return nullptr;
+}
+
+void FilterProject::appendCoalesced(const RowVectorPtr& output) {
+  if (!coalesced_) {
+    coalesced_ = std::static_pointer_cast<RowVector>(
+        BaseVector::create(outputType_, 0, pool()));
+  }
+  auto offset = coalesced_->size();
+  auto numRows = output->size();
+  coalesced_->resize(offset + numRows);
+  for (auto i = 0; i < outputType_->size(); ++i) {
+    auto& child = coalesced_->childAt(i);
+    child->resize(offset + numRows);
+    child->copy(output->loadedChildAt(i).get(), offset, 0, numRows);
+  }
 }
 
 void FilterProject::clearNonReusableOutput() {
@@ -185,9 +285,8 @@ void FilterProject::project(const SelectivityVector& rows, EvalCtx* evalCtx) {
   // will load b only for rows where f(a) is true. However, h(b) projection
   // needs all rows for "b".
   //
-  // This works, but may load more rows than necessary. E.g. if we only have
-  // f(a) AND g(b) expression and b is not used anywhere else, it is sufficient
-  // to load b for a subset of rows where f(a) is true.
+  // If b is not used anywhere else, the AND loads b only for the rows where
+  // f(a) is true, see ExprSet::enableLazyLoadingInBranches().
   *evalCtx->mutableIsFinalSelection() = false;
   *evalCtx->mutableFinalSelection() = &rows;
 
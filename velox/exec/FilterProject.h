@@ -21,13 +21,16 @@
 #include "velox/expression/Expr.h"
 
 namespace facebook::velox::exec {
+class TaskTemplate;
+
 class FilterProject : public Operator {
  public:
   FilterProject(
       int32_t operatorId,
       DriverCtx* driverCtx,
       const std::shared_ptr<const core::FilterNode>& filter,
-      const std::shared_ptr<const core::ProjectNode>& project);
+      const std::shared_ptr<const core::ProjectNode>& project,
+      bool coalesceOutput = false);
 
   bool isFilter() const override {
     return true;
@@ -45,14 +48,17 @@ class FilterProject : public Operator {
 
   RowVectorPtr getOutput() override;
 
+  void finish() override;
+
+  bool isFinishing() override {
+    return isFinishing_ && !coalesced_;
+  }
+
   BlockingReason isBlocked(ContinueFuture* /* unused */) override {
     return BlockingReason::kNotBlocked;
   }
 
-  void close() override {
-    Operator::close();
-    exprs_->clear();
-  }
+  void close() override;
 
  private:
   // Tests if 'numProcessedRows_' equals to the length of input_ and clears
@@ -77,13 +83,43 @@ class FilterProject : public Operator {
   // pre-condition: !isIdentityProjection_
   void project(const SelectivityVector& rows, EvalCtx* evalCtx);
 
+  // Adds the ExprStats of 'exprs_' to the runtime stats, keyed on
+  // "expr.<path>.<stat>".
+  void addExprStats();
+
+  // Returns 'output' if coalescing does not apply. Otherwise copies
+  // 'output' to 'coalesced_' and returns 'coalesced_' if it has at least
+  // 'outputBatchSize_' rows, nullptr if not. Coalescing applies while at
+  // most kMaxCoalescedSelectivity of the input so far has passed.
+  RowVectorPtr maybeCoalesce(RowVectorPtr output);
+
+  void appendCoalesced(const RowVectorPtr& output);
+
+  static constexpr double kMaxCoalescedSelectivity = 0.25;
+
   // If true exprs_[0] is a filter and the other expressions are projections
   const bool hasFilter_{false};
+
+  const bool trackExprStats_;
+  // Set if 'exprs_' comes from and goes back to the template of the Task.
+  std::shared_ptr<TaskTemplate> taskTemplate_;
   std::unique_ptr<ExprSet> exprs_;
   int32_t numExprs_;
 
   FilterEvalCtx filterEvalCtx_;
 
   vector_size_t numProcessedInputRows_{0};
+
+  // True if small filtered batches are copied into 'coalesced_'.
+  const bool coalesceOutput_;
+
+  const vector_size_t outputBatchSize_;
+
+  // Rows seen and passed by the filter, for deciding whether to coalesce.
+  uint64_t numFilterInputRows_{0};
+  uint64_t numFilterOutputRows_{0};
+
+  // Flat copies of the rows of filtered batches not yet returned.
+  RowVectorPtr coalesced_;
 };
 } // namespace facebook::velox::exec
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/FragmentResultCache.h"
+
+#include <sstream>
+#include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/SsdCache.h"
+#include "velox/vector/VectorStream.h"
+
+namespace facebook::velox::exec {
+
+namespace {
+// The entry at 'kHeaderOffset' of a key holds the size of the entry at
+// 'kDataOffset', which holds the serialized results.
+constexpr uint64_t kHeaderOffset = 0;
+constexpr uint64_t kDataOffset = 1;
+
+// Size of the length prefix that precedes each serialized batch.
+constexpr int32_t kBatchHeaderSize = sizeof(int64_t);
+
+StringIdLease fileId(const std::string& key) {
+  return StringIdLease(fileIds(), "velox.fragment:" + key);
+}
+
+// Copies the first 'size' bytes of the memory of 'entry' to 'out'.
+void copyFrom(
+    const cache::AsyncDataCacheEntry& entry,
+    uint64_t size,
+    char* out) {
+  auto& allocation = entry.data();
+  if (allocation.numPages() == 0) {
+    memcpy(out, entry.tinyData(), size);
+    return;
+  }
+  uint64_t offset = 0;
+  for (int32_t i = 0; i < allocation.numRuns() && offset < size; ++i) {
+    auto run = allocation.runAt(i);
+    auto bytes = std::min<uint64_t>(run.numBytes(), size - offset);
+    memcpy(out + offset, run.data<char>(), bytes);
+    offset += bytes;
+  }
+  VELOX_CHECK_EQ(offset, size);
+}
+
+// Copies 'data' to the memory of 'entry'.
+void copyTo(std::string_view data, cache::AsyncDataCacheEntry& entry) {
+  auto& allocation = entry.data();
+  if (allocation.numPages() == 0) {
+    memcpy(entry.tinyData(), data.data(), data.size());
+    return;
+  }
+  uint64_t offset = 0;
+  for (int32_t i = 0; i < allocation.numRuns() && offset < data.size();
+       ++i) {
+    auto run = allocation.runAt(i);
+    auto bytes = std::min<uint64_t>(run.numBytes(), data.size() - offset);
+    memcpy(run.data<char>(), data.data() + offset, bytes);
+    offset += bytes;
+  }
+  VELOX_CHECK_EQ(offset, data.size());
+}
+} // namespace
+
+bool FragmentResultCache::get(
+    const std::string& key,
+    const RowTypePtr& type,
+    memory::MemoryPool* pool,
+    std::vector<RowVectorPtr>& results) {
+  auto id = fileId(key);
+  auto headerPin = findEntry(id.id(), kHeaderOffset, sizeof(int64_t));
+  if (headerPin.empty()) {
+    return false;
+  }
+  int64_t size;
+  copyFrom(*headerPin.entry(), sizeof(size), reinterpret_cast<char*>(&size));
+  headerPin.clear();
+  results.clear();
+  if (size == 0) {
+    return true;
+  }
+  auto dataPin = findEntry(id.id(), kDataOffset, size);
+  if (dataPin.empty()) {
+    return false;
+  }
+  std::string data(size, '\0');
+  copyFrom(*dataPin.entry(), size, data.data());
+  dataPin.clear();
+
+  int64_t offset = 0;
+  while (offset < size) {
+    int64_t length;
+    memcpy(&length, data.data() + offset, sizeof(length));
+    offset += kBatchHeaderSize;
+    VELOX_CHECK_LE(offset + length, size);
+    ByteStream stream;
+    std::vector<ByteRange> ranges;
+    ranges.push_back(ByteRange{
+        reinterpret_cast<uint8_t*>(data.data() + offset),
+        static_cast<int32_t>(length),
+        0});
+    stream.resetInput(std::move(ranges));
+    RowVectorPtr result;
+    VectorStreamGroup::read(&stream, pool, type, &result);
+    results.push_back(std::move(result));
+    offset += length;
+  }
+  return true;
+}
+
+bool FragmentResultCache::put(
+    const std::string& key,
+    const std::vector<RowVectorPtr>& results) {
+  std::string data;
+  for (const auto& rows : results) {
+    if (rows->size() == 0) {
+      continue;
+    }
+    VectorStreamGroup group(cache_);
+    group.createStreamTree(asRowType(rows->type()), rows->size());
+    IndexRange range{0, rows->size()};
+    group.append(rows, folly::Range<const IndexRange*>(&range, 1));
+    std::stringstream out;
+    group.flush(&out);
+    auto batch = out.str();
+    int64_t length = batch.size();
+    data.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    data.append(batch);
+    if (data.size() > kMaxEntryBytes) {
+      return false;
+    }
+  }
+  auto id = fileId(key);
+  // The data goes first, so that a reader that finds the header finds the
+  // data unless it has been evicted since. Empty results have no data.
+  if (!data.empty() && !putEntry(id.id(), kDataOffset, data)) {
+    return false;
+  }
+  int64_t size = data.size();
+  return putEntry(
+      id.id(),
+      kHeaderOffset,
+      std::string_view(reinterpret_cast<const char*>(&size), sizeof(size)));
+}
+
+cache::CachePin FragmentResultCache::findEntry(
+    uint64_t fileNum,
+    uint64_t offset,
+    uint64_t size) {
+  cache::RawFileCacheKey key{fileNum, offset};
+  cache::CachePin pin;
+  try {
+    pin = cache_->findOrCreate(key, size);
+  } catch (const VeloxException& e) {
+    if (e.errorCode() != error_code::kNoCacheSpace.c_str()) {
+      throw;
+    }
+    return cache::CachePin();
+  }
+  // An entry being written by another thread counts as a miss.
+  if (pin.empty()) {
+    return pin;
+  }
+  auto entry = pin.entry();
+  if (!entry->isExclusive()) {
+    if (!entry->dataValid() || entry->size() < size) {
+      return cache::CachePin();
+    }
+    return pin;
+  }
+  auto ssdCache = cache_->ssdCache();
+  cache::SsdPin ssdPin;
+  if (ssdCache) {
+    ssdPin = ssdCache->file(fileNum).find(key);
+  }
+  if (!ssdPin.empty() && ssdPin.run().size() >= size &&
+      ssdPin.file()->load(ssdPin.run(), *entry)) {
+    entry->setValid(true);
+    entry->setExclusiveToShared();
+    return pin;
+  }
+  // Releasing the new entry without valid data removes it.
+  return cache::CachePin();
+}
+
+bool FragmentResultCache::putEntry(
+    uint64_t fileNum,
+    uint64_t offset,
+    std::string_view data) {
+  cache::CachePin pin;
+  try {
+    pin = cache_->findOrCreate({fileNum, offset}, data.size());
+  } catch (const VeloxException& e) {
+    if (e.errorCode() != error_code::kNoCacheSpace.c_str()) {
+      throw;
+    }
+    return false;
+  }
+  // The entry exists or is being written by another thread. Results of
+  // the same key are the same, so these are left in place. The header is
+  // written last, so an existing header entry has its data written.
+  if (pin.empty() || !pin.entry()->isExclusive()) {
+    return !pin.empty() && pin.entry()->size() == data.size();
+  }
+  copyTo(data, *pin.entry());
+  pin.entry()->setValid(true);
+  pin.entry()->setExclusiveToShared();
+  return true;
+}
+
+} // namespace facebook::velox::exec
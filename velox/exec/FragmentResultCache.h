@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/common/caching/AsyncDataCache.h"
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox::exec {
+
+// Keeps the results of a plan fragment over a split, e.g. the partial
+// aggregation of the rows of a file, so that running the fragment again
+// over the same split can reuse them instead of reading the split. The
+// results of a key are serialized into entries of an AsyncDataCache, which
+// moves them to its SSD cache on eviction and reads them back from there.
+class FragmentResultCache {
+ public:
+  // Results that serialize to more bytes are not cached.
+  static constexpr uint64_t kMaxEntryBytes = 16 << 20;
+
+  explicit FragmentResultCache(cache::AsyncDataCache* cache) : cache_(cache) {}
+
+  // Sets 'results' to the vectors of 'type' stored under 'key' and returns
+  // true if these are in memory or on SSD.
+  bool get(
+      const std::string& key,
+      const RowTypePtr& type,
+      memory::MemoryPool* pool,
+      std::vector<RowVectorPtr>& results);
+
+  // Stores 'results' under 'key'. Returns false if they are not stored,
+  // e.g. because they are over kMaxEntryBytes or the cache has no space.
+  bool put(const std::string& key, const std::vector<RowVectorPtr>& results);
+
+ private:
+  // Returns a shared pin on the valid entry of at least 'size' bytes at
+  // 'offset' of 'fileNum'. Loads the entry from SSD if it is not in memory.
+  // Returns an empty pin if the entry is in neither.
+  cache::CachePin findEntry(uint64_t fileNum, uint64_t offset, uint64_t size);
+
+  // Stores 'data' in the entry at 'offset' of 'fileNum'.
+  bool putEntry(uint64_t fileNum, uint64_t offset, std::string_view data);
+
+  cache::AsyncDataCache* const cache_;
+};
+
+// An Operator whose output over each split of the TableScan at the start
+// of its pipeline is kept in a FragmentResultCache. The TableScan calls
+// these around each split that has a cache key.
+class SplitResultCacheClient {
+ public:
+  virtual ~SplitResultCacheClient() = default;
+
+  // Called before the first input of the split with cache key 'splitKey'.
+  // Returns true if the output over the split is cached. The output is
+  // then produced without the input of the split, which is skipped.
+  virtual bool startSplit(const std::string& splitKey) = 0;
+
+  // Called after the input of the split of the last startSplit() that
+  // returned false has been added.
+  virtual void finishSplit() = 0;
+};
+
+} // namespace facebook::velox::exec
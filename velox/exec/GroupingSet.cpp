@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/exec/GroupingSet.h"
+#include "velox/exec/ContainerRowSerde.h"
 #include "velox/exec/OperatorUtils.h"
 #include "velox/exec/Task.h"
 
@@ -35,6 +36,50 @@ bool areAllLazyNotLoaded(const std::vector<VectorPtr>& vectors) {
     return isLazyNotLoaded(*vector);
   });
 }
+
+// Sorts 'rows' of 'container' on 'keys', which are at the columns after the
+// first. Rows with equal keys keep their order. Like OrderBy, compares the
+// normalized keys first if there are any.
+void sortOrderedRows(
+    RowContainer& container,
+    bool hasNormalizedKeys,
+    const std::vector<std::pair<ChannelIndex, core::SortOrder>>& keys,
+    std::vector<char*>& rows) {
+  auto compareRows = [&](const char* left, const char* right) {
+    for (auto i = 0; i < keys.size(); ++i) {
+      const auto& order = keys[i].second;
+      if (auto result = container.compare(
+              left,
+              right,
+              i + 1,
+              {order.isNullsFirst(), order.isAscending(), false})) {
+        return result < 0;
+      }
+    }
+    return false;
+  };
+  if (!hasNormalizedKeys) {
+    std::stable_sort(rows.begin(), rows.end(), compareRows);
+    return;
+  }
+  std::vector<std::pair<normalized_key_t, char*>> entries(rows.size());
+  for (auto i = 0; i < rows.size(); ++i) {
+    entries[i] = {RowContainer::normalizedKey(rows[i]), rows[i]};
+  }
+  std::stable_sort(
+      entries.begin(),
+      entries.end(),
+      [&](const std::pair<normalized_key_t, char*>& left,
+          const std::pair<normalized_key_t, char*>& right) {
+        if (left.first != right.first) {
+          return left.first < right.first;
+        }
+        return compareRows(left.second, right.second);
+      });
+  for (auto i = 0; i < rows.size(); ++i) {
+    rows[i] = entries[i].second;
+  }
+}
 } // namespace
 
 GroupingSet::GroupingSet(
@@ -43,9 +88,15 @@ GroupingSet::GroupingSet(
     std::vector<std::optional<ChannelIndex>>&& aggrMaskChannels,
     std::vector<std::vector<ChannelIndex>>&& channelLists,
     std::vector<std::vector<VectorPtr>>&& constantLists,
+    std::vector<bool>&& distinctAggregates,
+    std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>&&
+        sortingKeys,
+    std::vector<TypePtr>&& intermediateTypes,
     bool ignoreNullKeys,
     bool isRawInput,
-    OperatorCtx* operatorCtx)
+    uint64_t spillMemoryThreshold,
+    OperatorCtx* operatorCtx,
+    bool shared)
     : hashers_(std::move(hashers)),
       isGlobal_(hashers_.empty()),
       isRawInput_(isRawInput),
@@ -53,15 +104,72 @@ GroupingSet::GroupingSet(
       aggrMaskChannels_(std::move(aggrMaskChannels)),
       channelLists_(std::move(channelLists)),
       constantLists_(std::move(constantLists)),
+      distinctAggregates_(std::move(distinctAggregates)),
+      sortingKeys_(std::move(sortingKeys)),
       ignoreNullKeys_(ignoreNullKeys),
-      mappedMemory_(operatorCtx->mappedMemory()),
+      mappedMemory_(
+          shared ? operatorCtx->task()->queryCtx()->mappedMemory()
+                 : operatorCtx->mappedMemory()),
       stringAllocator_(mappedMemory_),
       rows_(mappedMemory_),
       isAdaptive_(
-          operatorCtx->task()->queryCtx()->config().hashAdaptivityEnabled()) {
+          operatorCtx->task()->queryCtx()->config().hashAdaptivityEnabled()),
+      packTimestamps_(operatorCtx->task()
+                          ->queryCtx()
+                          ->config()
+                          .hashTablePackTimestamps()),
+      pool_(shared ? operatorCtx->task()->pool() : operatorCtx->pool()),
+      spillMemoryThreshold_(spillMemoryThreshold),
+      spillPath_(operatorCtx->task()->queryCtx()->config().spillPath()) {
   for (auto& hasher : hashers_) {
     keyChannels_.push_back(hasher->channel());
   }
+  VELOX_CHECK_EQ(distinctAggregates_.size(), aggregates_.size());
+  VELOX_CHECK_EQ(sortingKeys_.size(), aggregates_.size());
+  distinctSets_.resize(aggregates_.size());
+  orderedInputs_.resize(aggregates_.size());
+  const bool hasDistinct = std::find(
+                               distinctAggregates_.begin(),
+                               distinctAggregates_.end(),
+                               true) != distinctAggregates_.end();
+  VELOX_CHECK(
+      !hasDistinct || isRawInput_,
+      "DISTINCT aggregates require raw input");
+  const bool hasOrdered = std::any_of(
+      sortingKeys_.begin(), sortingKeys_.end(), [](const auto& keys) {
+        return !keys.empty();
+      });
+  VELOX_CHECK(
+      !hasOrdered || isRawInput_, "Ordered aggregates require raw input");
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    if (distinctAggregates_[i] && isGlobal_) {
+      const auto& channels = channelLists_[i];
+      VELOX_CHECK(
+          std::any_of(
+              channels.begin(),
+              channels.end(),
+              [](auto channel) { return channel != kConstantChannel; }),
+          "DISTINCT aggregate without grouping keys needs a column argument");
+    }
+  }
+  if (spillMemoryThreshold_ != 0) {
+    VELOX_CHECK(!isGlobal_, "Global aggregation does not spill");
+    VELOX_CHECK(!hasDistinct, "DISTINCT aggregates do not spill");
+    VELOX_CHECK(!hasOrdered, "Ordered aggregates do not spill");
+    VELOX_CHECK_EQ(intermediateTypes.size(), aggregates_.size());
+    std::vector<std::string> names;
+    std::vector<TypePtr> types;
+    for (auto i = 0; i < hashers_.size(); ++i) {
+      names.push_back(fmt::format("k{}", i));
+      types.push_back(hashers_[i]->type());
+      spillKeyChannels_.push_back(i);
+    }
+    for (auto i = 0; i < intermediateTypes.size(); ++i) {
+      names.push_back(fmt::format("a{}", i));
+      types.push_back(std::move(intermediateTypes[i]));
+    }
+    spillType_ = ROW(std::move(names), std::move(types));
+  }
   std::unordered_map<ChannelIndex, int> channelUseCount;
   for (const std::vector<ChannelIndex>& argList : channelLists_) {
     for (ChannelIndex channel : argList) {
@@ -71,6 +179,18 @@ GroupingSet::GroupingSet(
   for (const std::vector<ChannelIndex>& argList : channelLists_) {
     mayPushdown_.push_back(allAreSinglyReferenced(argList, channelUseCount));
   }
+  useRowBlocks_ = !isGlobal_ &&
+      aggregates_.size() >= kMinAggregatesForRowBlocks &&
+      std::all_of(aggregates_.begin(), aggregates_.end(), [](auto& aggregate) {
+        return aggregate->isFixedSize();
+      }) &&
+      std::none_of(
+          distinctAggregates_.begin(),
+          distinctAggregates_.end(),
+          [](bool distinct) { return distinct; }) &&
+      std::all_of(sortingKeys_.begin(), sortingKeys_.end(), [](auto& keys) {
+        return keys.empty();
+      });
 }
 
 void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
@@ -85,45 +205,126 @@ void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
     prepareMaskedSelectivityVectors(input);
     numAdded_ += numRows;
     for (auto i = 0; i < aggregates_.size(); ++i) {
+      const SelectivityVector* rows = &getSelectivityVector(i);
+      if (distinctAggregates_[i]) {
+        rows = &selectDistinctRows(i, input, *rows);
+        if (!rows->hasSelections()) {
+          continue;
+        }
+      }
+      if (!sortingKeys_[i].empty()) {
+        storeOrderedInput(i, input, *rows);
+        continue;
+      }
       populateTempVectors(i, input);
-      const SelectivityVector& rows = getSelectivityVector(i);
-      const bool canPushdown =
-          mayPushdown && mayPushdown_[i] && areAllLazyNotLoaded(tempVectors_);
+      const bool canPushdown = !distinctAggregates_[i] && mayPushdown &&
+          mayPushdown_[i] && areAllLazyNotLoaded(tempVectors_);
       if (isRawInput_) {
         aggregates_[i]->addSingleGroupRawInput(
-            lookup_->hits[0], rows, tempVectors_, canPushdown);
+            lookup_->hits[0], *rows, tempVectors_, canPushdown);
       } else {
         aggregates_[i]->addSingleGroupIntermediateResults(
-            lookup_->hits[0], rows, tempVectors_, canPushdown);
+            lookup_->hits[0], *rows, tempVectors_, canPushdown);
       }
     }
     tempVectors_.clear();
     return;
   }
 
+  if (!probeKeys(input, keyChannels_)) {
+    addInput(input, mayPushdown);
+    return;
+  }
+  numAdded_ += lookup_->rows.size();
+  if (evictColdGroups_) {
+    auto flagOffset = table_->rows()->probedFlagOffset();
+    for (auto row : lookup_->rows) {
+      bits::setBit(lookup_->hits[row], flagOffset);
+    }
+  }
+  prepareMaskedSelectivityVectors(input);
+  if (auto blockSize = rowBlockSize(input->size())) {
+    addInputInRowBlocks(input, blockSize);
+  } else {
+    for (auto i = 0; i < aggregates_.size(); ++i) {
+      const SelectivityVector* rows = &getSelectivityVector(i);
+      if (distinctAggregates_[i]) {
+        rows = &selectDistinctRows(i, input, *rows);
+        if (!rows->hasSelections()) {
+          continue;
+        }
+      }
+      if (!sortingKeys_[i].empty()) {
+        storeOrderedInput(i, input, *rows);
+        continue;
+      }
+      // TODO(spershin): We disable the pushdown at the moment if selectivity
+      // vector has changed after groups generation, we might want to revisit
+      // this. A ValueHook gets the position of a value among the loaded rows,
+      // so the rows must also not have gaps for the position to index
+      // 'lookup_->hits'.
+      const bool canPushdown = (rows == &activeRows_) &&
+          activeRows_.isAllSelected() && mayPushdown && mayPushdown_[i] &&
+          areAllLazyNotLoaded(tempVectors_);
+      populateTempVectors(i, input);
+      if (isRawInput_) {
+        aggregates_[i]->addRawInput(
+            lookup_->hits.data(), *rows, tempVectors_, canPushdown);
+      } else {
+        aggregates_[i]->addIntermediateResults(
+            lookup_->hits.data(), *rows, tempVectors_, canPushdown);
+      }
+    }
+    tempVectors_.clear();
+  }
+
+  if (spillMemoryThreshold_ != 0 &&
+      table_->allocatedBytes() > spillMemoryThreshold_) {
+    spill();
+  }
+}
+
+void GroupingSet::createHashTable() {
+  if (ignoreNullKeys_) {
+    table_ = HashTable<true>::createForAggregation(
+        std::move(hashers_),
+        aggregates_,
+        mappedMemory_,
+        evictColdGroups_,
+        packTimestamps_);
+  } else {
+    table_ = HashTable<false>::createForAggregation(
+        std::move(hashers_),
+        aggregates_,
+        mappedMemory_,
+        evictColdGroups_,
+        packTimestamps_);
+  }
+  if (numGroupsHint_) {
+    table_->setNumDistinctHint(numGroupsHint_);
+  }
+  lookup_ = std::make_unique<HashLookup>(table_->hashers());
+  if (!isAdaptive_ && table_->hashMode() != BaseHashTable::HashMode::kHash) {
+    table_->forceGenericHashMode();
+  }
+}
+
+bool GroupingSet::probeKeys(
+    const RowVectorPtr& input,
+    const std::vector<ChannelIndex>& keyChannels) {
   bool rehash = false;
   if (!table_) {
     rehash = true;
-    if (ignoreNullKeys_) {
-      table_ = HashTable<true>::createForAggregation(
-          std::move(hashers_), aggregates_, mappedMemory_);
-    } else {
-      table_ = HashTable<false>::createForAggregation(
-          std::move(hashers_), aggregates_, mappedMemory_);
-    }
-    lookup_ = std::make_unique<HashLookup>(table_->hashers());
-    if (!isAdaptive_ && table_->hashMode() != BaseHashTable::HashMode::kHash) {
-      table_->forceGenericHashMode();
-    }
+    createHashTable();
   }
   auto& hashers = lookup_->hashers;
-  lookup_->reset(numRows);
+  lookup_->reset(input->size());
   auto mode = table_->hashMode();
   if (ignoreNullKeys_) {
     // A null in any of the keys disables the row.
-    deselectRowsWithNulls(*input, keyChannels_, activeRows_);
+    deselectRowsWithNulls(*input, keyChannels, activeRows_);
     for (int32_t i = 0; i < hashers.size(); ++i) {
-      auto key = input->loadedChildAt(hashers[i]->channel());
+      auto key = input->loadedChildAt(keyChannels[i]);
       if (mode != BaseHashTable::HashMode::kHash) {
         if (!hashers[i]->computeValueIds(*key, activeRows_, lookup_->hashes)) {
           rehash = true;
@@ -140,7 +341,7 @@ void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
         [&](vector_size_t row) { lookup_->rows.push_back(row); });
   } else {
     for (int32_t i = 0; i < hashers.size(); ++i) {
-      auto key = input->loadedChildAt(hashers[i]->channel());
+      auto key = input->loadedChildAt(keyChannels[i]);
       if (mode != BaseHashTable::HashMode::kHash) {
         if (!hashers[i]->computeValueIds(*key, activeRows_, lookup_->hashes)) {
           rehash = true;
@@ -155,28 +356,112 @@ void GroupingSet::addInput(const RowVectorPtr& input, bool mayPushdown) {
     if (table_->hashMode() != BaseHashTable::HashMode::kHash) {
       table_->decideHashMode(input->size());
     }
-    addInput(input, mayPushdown);
-    return;
+    return false;
   }
-  numAdded_ += lookup_->rows.size();
   table_->groupProbe(*lookup_);
-  prepareMaskedSelectivityVectors(input);
-  for (auto i = 0; i < aggregates_.size(); ++i) {
-    const SelectivityVector& rows = getSelectivityVector(i);
-    // TODO(spershin): We disable the pushdown at the moment if selectivity
-    // vector has changed after groups generation, we might want to revisit
-    // this.
-    const bool canPushdown = (&rows != &activeRows_) && mayPushdown &&
-        mayPushdown_[i] && areAllLazyNotLoaded(tempVectors_);
-    populateTempVectors(i, input);
-    if (isRawInput_) {
-      aggregates_[i]->addRawInput(
-          lookup_->hits.data(), rows, tempVectors_, canPushdown);
-    } else {
-      aggregates_[i]->addIntermediateResults(
-          lookup_->hits.data(), rows, tempVectors_, canPushdown);
+  return true;
+}
+
+void GroupingSet::spill() {
+  if (spillPartitions_.empty()) {
+    for (auto i = 0; i < kNumSpillPartitions; ++i) {
+      spillPartitions_.push_back(std::make_unique<SpillFile>(
+          spillType_, spillPath_, mappedMemory_, pool_));
     }
   }
+  constexpr int32_t kBatchSize = 1024;
+  auto rows = table_->rows();
+  auto numKeys = spillKeyChannels_.size();
+  RowContainerIterator iterator;
+  std::vector<char*> groups(kBatchSize);
+  std::vector<uint64_t> hashes(kBatchSize);
+  std::vector<std::vector<char*>> partitionGroups(kNumSpillPartitions);
+  for (;;) {
+    auto numGroups = rows->listRows(&iterator, kBatchSize, groups.data());
+    if (!numGroups) {
+      break;
+    }
+    for (auto i = 0; i < numKeys; ++i) {
+      rows->hash(
+          i,
+          folly::Range<char**>(groups.data(), numGroups),
+          i > 0,
+          hashes.data());
+    }
+    for (auto& partition : partitionGroups) {
+      partition.clear();
+    }
+    for (auto i = 0; i < numGroups; ++i) {
+      partitionGroups[(hashes[i] >> kSpillPartitionShift) &
+                      (kNumSpillPartitions - 1)]
+          .push_back(groups[i]);
+    }
+    for (auto partition = 0; partition < kNumSpillPartitions; ++partition) {
+      auto& partitionRows = partitionGroups[partition];
+      if (partitionRows.empty()) {
+        continue;
+      }
+      auto size = partitionRows.size();
+      auto batch = std::static_pointer_cast<RowVector>(
+          BaseVector::create(spillType_, size, pool_));
+      for (auto i = 0; i < numKeys; ++i) {
+        rows->extractColumn(partitionRows.data(), size, i, batch->childAt(i));
+      }
+      for (auto i = 0; i < aggregates_.size(); ++i) {
+        aggregates_[i]->finalize(partitionRows.data(), size);
+        aggregates_[i]->extractAccumulators(
+            partitionRows.data(), size, &batch->childAt(numKeys + i));
+      }
+      spillPartitions_[partition]->append(batch);
+      spilledRows_ += size;
+    }
+  }
+  spilledBytes_ = 0;
+  for (auto& partition : spillPartitions_) {
+    spilledBytes_ += partition->size();
+  }
+  table_->clear();
+}
+
+int64_t GroupingSet::reclaim() {
+  if (spillMemoryThreshold_ == 0 || outputPartition_ >= 0 || !table_ ||
+      table_->numDistinct() == 0) {
+    return 0;
+  }
+  auto bytes = table_->allocatedBytes();
+  spill();
+  return bytes - table_->allocatedBytes();
+}
+
+bool GroupingSet::loadNextSpillPartition() {
+  table_->clear();
+  if (outputPartition_ >= 0) {
+    // Removes the file of the partition that has been returned.
+    spillPartitions_[outputPartition_].reset();
+  }
+  if (++outputPartition_ >= spillPartitions_.size()) {
+    return false;
+  }
+  auto& partition = spillPartitions_[outputPartition_];
+  while (auto batch = partition->nextBatch()) {
+    addSpilledInput(batch);
+  }
+  return true;
+}
+
+void GroupingSet::addSpilledInput(const RowVectorPtr& input) {
+  activeRows_.resize(input->size());
+  activeRows_.setAll();
+  if (!probeKeys(input, spillKeyChannels_)) {
+    addSpilledInput(input);
+    return;
+  }
+  auto numKeys = spillKeyChannels_.size();
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    tempVectors_ = {input->childAt(numKeys + i)};
+    aggregates_[i]->addIntermediateResults(
+        lookup_->hits.data(), activeRows_, tempVectors_, false);
+  }
   tempVectors_.clear();
 }
 
@@ -229,6 +514,54 @@ void GroupingSet::populateTempVectors(
   }
 }
 
+vector_size_t GroupingSet::rowBlockSize(vector_size_t numRows) const {
+  if (!useRowBlocks_) {
+    return 0;
+  }
+  auto blockSize = std::max<vector_size_t>(
+      kMinRowBlockSize, kRowBlockBytes / table_->rows()->fixedRowSize());
+  return blockSize < numRows ? blockSize : 0;
+}
+
+void GroupingSet::addInputInRowBlocks(
+    const RowVectorPtr& input,
+    vector_size_t blockSize) {
+  blockArgs_.resize(aggregates_.size());
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    populateTempVectors(i, input);
+    // The blocks load different rows, so lazy vectors are loaded whole.
+    for (auto& arg : tempVectors_) {
+      arg = BaseVector::loadedVectorShared(arg);
+    }
+    blockArgs_[i] = std::move(tempVectors_);
+  }
+  tempVectors_.clear();
+
+  auto groups = lookup_->hits.data();
+  auto numRows = input->size();
+  for (vector_size_t begin = 0; begin < numRows; begin += blockSize) {
+    auto end = std::min(begin + blockSize, numRows);
+    for (auto i = 0; i < aggregates_.size(); ++i) {
+      blockRows_ = getSelectivityVector(i);
+      blockRows_.setValidRange(0, begin, false);
+      blockRows_.setValidRange(end, blockRows_.size(), false);
+      blockRows_.updateBounds();
+      if (!blockRows_.hasSelections()) {
+        continue;
+      }
+      if (isRawInput_) {
+        aggregates_[i]->addRawInput(groups, blockRows_, blockArgs_[i], false);
+      } else {
+        aggregates_[i]->addIntermediateResults(
+            groups, blockRows_, blockArgs_[i], false);
+      }
+    }
+  }
+  for (auto& args : blockArgs_) {
+    args.clear();
+  }
+}
+
 void GroupingSet::prepareMaskedSelectivityVectors(const RowVectorPtr& input) {
   // Clear the flag for existing selectivity vectors (from the previous batch),
   // so we know if we need to recalculate them.
@@ -274,6 +607,180 @@ const SelectivityVector& GroupingSet::getSelectivityVector(
   return it->second.rows;
 }
 
+const SelectivityVector& GroupingSet::selectDistinctRows(
+    int32_t aggregateIndex,
+    const RowVectorPtr& input,
+    const SelectivityVector& rows) {
+  auto& distinct = distinctSets_[aggregateIndex];
+  if (!distinct) {
+    std::vector<std::unique_ptr<VectorHasher>> hashers;
+    auto addHasher = [&](ChannelIndex channel) {
+      hashers.push_back(
+          VectorHasher::create(input->childAt(channel)->type(), channel));
+    };
+    for (auto channel : keyChannels_) {
+      addHasher(channel);
+    }
+    for (auto channel : channelLists_[aggregateIndex]) {
+      if (channel != kConstantChannel) {
+        addHasher(channel);
+      }
+    }
+    distinct = std::make_unique<DistinctSet>();
+    distinct->table = HashTable<false>::createForAggregation(
+        std::move(hashers), {}, mappedMemory_);
+    distinct->table->forceGenericHashMode();
+    distinct->lookup =
+        std::make_unique<HashLookup>(distinct->table->hashers());
+  }
+
+  auto& lookup = *distinct->lookup;
+  auto& hashers = lookup.hashers;
+  lookup.reset(input->size());
+  for (auto i = 0; i < hashers.size(); ++i) {
+    auto key = input->loadedChildAt(hashers[i]->channel());
+    hashers[i]->hash(*key, rows, i > 0, lookup.hashes);
+  }
+  lookup.rows.clear();
+  rows.applyToSelected([&](vector_size_t row) { lookup.rows.push_back(row); });
+  distinct->table->groupProbe(lookup);
+
+  auto& newRows = distinct->newRows;
+  newRows.resize(input->size());
+  newRows.clearAll();
+  for (auto row : lookup.newGroups) {
+    newRows.setValid(row, true);
+  }
+  newRows.updateBounds();
+  return newRows;
+}
+
+void GroupingSet::storeOrderedInput(
+    int32_t aggregateIndex,
+    const RowVectorPtr& input,
+    const SelectivityVector& rows) {
+  const auto& keys = sortingKeys_[aggregateIndex];
+  auto& ordered = orderedInputs_[aggregateIndex];
+  if (!ordered) {
+    ordered = std::make_unique<OrderedInput>();
+    for (const auto& key : keys) {
+      ordered->channels.push_back(key.first);
+    }
+    for (auto channel : channelLists_[aggregateIndex]) {
+      if (channel != kConstantChannel) {
+        ordered->channels.push_back(channel);
+      }
+    }
+    std::vector<std::string> names{"group"};
+    std::vector<TypePtr> types{BIGINT()};
+    for (auto i = 0; i < ordered->channels.size(); ++i) {
+      names.push_back(fmt::format("c{}", i));
+      types.push_back(input->childAt(ordered->channels[i])->type());
+    }
+    ordered->type = ROW(std::move(names), std::move(types));
+
+    std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> fields;
+    std::vector<core::SortOrder> orders;
+    for (auto i = 0; i < keys.size(); ++i) {
+      fields.push_back(std::make_shared<core::FieldAccessTypedExpr>(
+          ordered->type->childAt(i + 1), ordered->type->nameOf(i + 1)));
+      orders.push_back(keys[i].second);
+    }
+    ordered->encoder =
+        NormalizedKeyEncoder::create(ordered->type, fields, orders);
+    ordered->rows = std::make_unique<RowContainer>(
+        ordered->type->children(),
+        true, // nullableKeys
+        std::vector<std::unique_ptr<Aggregate>>{},
+        std::vector<TypePtr>{},
+        false, // hasNext
+        false, // isJoinBuild
+        false, // hasProbedFlag
+        ordered->encoder != nullptr, // hasNormalizedKey
+        mappedMemory_,
+        ContainerRowSerde::instance());
+    ordered->decoded.resize(ordered->type->size());
+  }
+
+  // The group of each row goes in the first column.
+  auto numRows = input->size();
+  auto groups = BaseVector::create(BIGINT(), numRows, pool_);
+  auto rawGroups = groups->asFlatVector<int64_t>()->mutableRawValues();
+  rows.applyToSelected([&](vector_size_t row) {
+    rawGroups[row] = reinterpret_cast<int64_t>(
+        isGlobal_ ? lookup_->hits[0] : lookup_->hits[row]);
+  });
+  auto& decoded = ordered->decoded;
+  decoded[0].decode(*groups, rows);
+  for (auto i = 0; i < ordered->channels.size(); ++i) {
+    decoded[i + 1].decode(*input->loadedChildAt(ordered->channels[i]), rows);
+  }
+
+  auto& container = *ordered->rows;
+  rows.applyToSelected([&](vector_size_t row) {
+    auto newRow = container.newRow();
+    for (auto column = 0; column < decoded.size(); ++column) {
+      container.store(decoded[column], row, newRow, column);
+    }
+    if (ordered->encoder) {
+      RowContainer::normalizedKey(newRow) =
+          ordered->encoder->encode(decoded, row);
+    }
+  });
+}
+
+void GroupingSet::addOrderedInputs() {
+  orderedInputsAdded_ = true;
+  constexpr int32_t kBatchSize = 1024;
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    auto& ordered = orderedInputs_[i];
+    if (!ordered) {
+      continue;
+    }
+    auto& container = *ordered->rows;
+    std::vector<char*> rows(container.numRows());
+    RowContainerIterator iterator;
+    container.listRows(&iterator, rows.size(), rows.data());
+    sortOrderedRows(
+        container, ordered->encoder != nullptr, sortingKeys_[i], rows);
+
+    auto& channels = channelLists_[i];
+    std::vector<char*> groups(kBatchSize);
+    SelectivityVector batchRows;
+    for (auto offset = 0; offset < rows.size(); offset += kBatchSize) {
+      auto numRows = std::min<int32_t>(kBatchSize, rows.size() - offset);
+      auto batch = rows.data() + offset;
+      auto groupVector = BaseVector::create(BIGINT(), numRows, pool_);
+      container.extractColumn(batch, numRows, 0, groupVector);
+      auto rawGroups = groupVector->asFlatVector<int64_t>()->rawValues();
+      for (auto row = 0; row < numRows; ++row) {
+        groups[row] = reinterpret_cast<char*>(rawGroups[row]);
+      }
+
+      // The arguments follow the group and the sorting keys.
+      auto column = 1 + sortingKeys_[i].size();
+      tempVectors_.resize(channels.size());
+      for (auto j = 0; j < channels.size(); ++j) {
+        if (channels[j] == kConstantChannel) {
+          tempVectors_[j] =
+              BaseVector::wrapInConstant(numRows, 0, constantLists_[i][j]);
+        } else {
+          tempVectors_[j] = BaseVector::create(
+              ordered->type->childAt(column), numRows, pool_);
+          container.extractColumn(batch, numRows, column, tempVectors_[j]);
+          ++column;
+        }
+      }
+      batchRows.resize(numRows);
+      batchRows.setAll();
+      aggregates_[i]->addRawInput(
+          groups.data(), batchRows, tempVectors_, false);
+    }
+    tempVectors_.clear();
+    ordered.reset();
+  }
+}
+
 bool GroupingSet::getOutput(
     int32_t batchSize,
     bool isPartial,
@@ -289,6 +796,9 @@ bool GroupingSet::getOutput(
     if (numAdded_ == 0) {
       initializeGlobalAggregation();
     }
+    if (!orderedInputsAdded_) {
+      addOrderedInputs();
+    }
 
     auto groups = lookup_->hits.data();
     for (int32_t i = 0; i < aggregates_.size(); ++i) {
@@ -303,13 +813,42 @@ bool GroupingSet::getOutput(
     return true;
   }
 
+  if (!orderedInputsAdded_) {
+    addOrderedInputs();
+  }
+
+  if (!isPartial && !spillPartitions_.empty() && outputPartition_ < 0) {
+    // Spills the groups still in memory so that each group is in exactly one
+    // partition. The partitions are then aggregated and returned one at a
+    // time.
+    spill();
+    for (auto& partition : spillPartitions_) {
+      partition->finishWrite();
+    }
+    loadNextSpillPartition();
+    iterator->reset();
+  }
+
   // @lint-ignore CLANGTIDY
   char* groups[batchSize];
   int32_t numGroups =
       table_ ? table_->rows()->listRows(iterator, batchSize, groups) : 0;
+  while (!numGroups && outputPartition_ >= 0 && loadNextSpillPartition()) {
+    iterator->reset();
+    numGroups = table_->rows()->listRows(iterator, batchSize, groups);
+  }
   if (!numGroups) {
     return false;
   }
+  extractGroups(groups, numGroups, isPartial, result);
+  return true;
+}
+
+void GroupingSet::extractGroups(
+    char** groups,
+    int32_t numGroups,
+    bool isPartial,
+    const RowVectorPtr& result) {
   result->resize(numGroups);
   auto totalKeys = lookup_->hashers.size();
   for (int32_t i = 0; i < totalKeys; ++i) {
@@ -325,21 +864,148 @@ bool GroupingSet::getOutput(
       aggregates_[i]->extractValues(groups, numGroups, &aggregateVector);
     }
   }
+}
+
+bool GroupingSet::enableColdGroupEviction() {
+  VELOX_CHECK_NULL(table_, "Eviction must be enabled before the first input");
+  evictColdGroups_ = !isGlobal_ &&
+      std::none_of(
+          distinctAggregates_.begin(),
+          distinctAggregates_.end(),
+          [](bool distinct) { return distinct; }) &&
+      std::all_of(sortingKeys_.begin(), sortingKeys_.end(), [](auto& keys) {
+        return keys.empty();
+      });
+  return evictColdGroups_;
+}
+
+void GroupingSet::markGroupsCold() {
+  VELOX_CHECK(evictColdGroups_);
+  if (!table_) {
+    return;
+  }
+  auto rows = table_->rows();
+  auto flagOffset = rows->probedFlagOffset();
+  constexpr int32_t kBatchSize = 1'000;
+  char* groups[kBatchSize];
+  RowContainerIterator iterator;
+  while (auto numGroups = rows->listRows(&iterator, kBatchSize, groups)) {
+    for (auto i = 0; i < numGroups; ++i) {
+      bits::clearBit(groups[i], flagOffset);
+    }
+  }
+}
+
+bool GroupingSet::getColdOutput(
+    int32_t batchSize,
+    RowContainerIterator* iterator,
+    RowVectorPtr& result) {
+  VELOX_CHECK(evictColdGroups_);
+  eraseEvictedGroups();
+  if (!table_) {
+    return false;
+  }
+  evictedGroups_.resize(batchSize);
+  auto numGroups = table_->rows()->listNotProbedRows(
+      iterator, batchSize, RowContainer::kUnlimited, evictedGroups_.data());
+  evictedGroups_.resize(numGroups);
+  if (!numGroups) {
+    markGroupsCold();
+    return false;
+  }
+  extractGroups(evictedGroups_.data(), numGroups, true, result);
   return true;
 }
 
+void GroupingSet::eraseEvictedGroups() {
+  if (evictedGroups_.empty()) {
+    return;
+  }
+  table_->erase(
+      folly::Range<char**>(evictedGroups_.data(), evictedGroups_.size()));
+  evictedGroups_.clear();
+}
+
+RowVectorPtr GroupingSet::toIntermediate(
+    const RowVectorPtr& input,
+    const RowTypePtr& outputType) {
+  VELOX_CHECK(isRawInput_ && !isGlobal_);
+  VELOX_CHECK_NOT_NULL(table_);
+  auto rows = table_->rows();
+  VELOX_CHECK_EQ(
+      rows->numRows(), 0, "toIntermediate requires an empty hash table");
+  auto numRows = input->size();
+  activeRows_.resize(numRows);
+  activeRows_.setAll();
+  intermediateGroups_.resize(numRows);
+  for (auto i = 0; i < numRows; ++i) {
+    intermediateGroups_[i] = rows->newRow();
+  }
+  intermediateIndices_.resize(numRows);
+  std::iota(intermediateIndices_.begin(), intermediateIndices_.end(), 0);
+  auto groups = intermediateGroups_.data();
+
+  auto numKeys = keyChannels_.size();
+  std::vector<VectorPtr> children(outputType->size());
+  for (auto i = 0; i < numKeys; ++i) {
+    children[i] = input->loadedChildAt(keyChannels_[i]);
+  }
+  prepareMaskedSelectivityVectors(input);
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    aggregates_[i]->initializeNewGroups(
+        groups,
+        folly::Range<const vector_size_t*>(
+            intermediateIndices_.data(), numRows));
+    populateTempVectors(i, input);
+    aggregates_[i]->addRawInput(
+        groups, getSelectivityVector(i), tempVectors_, false);
+    aggregates_[i]->finalize(groups, numRows);
+    auto& result = children[numKeys + i];
+    result =
+        BaseVector::create(outputType->childAt(numKeys + i), numRows, pool_);
+    aggregates_[i]->extractAccumulators(groups, numRows, &result);
+  }
+  tempVectors_.clear();
+  rows->clear();
+  return std::make_shared<RowVector>(
+      pool_, outputType, BufferPtr(nullptr), numRows, std::move(children));
+}
+
 void GroupingSet::resetPartial() {
+  evictedGroups_.clear();
   if (table_) {
     table_->clear();
   }
 }
 
 uint64_t GroupingSet::allocatedBytes() const {
+  // The values seen by DISTINCT aggregates and the buffered input of
+  // ordered aggregates.
+  uint64_t extraBytes = 0;
+  for (const auto& distinct : distinctSets_) {
+    if (distinct) {
+      extraBytes += distinct->table->allocatedBytes();
+    }
+  }
+  for (const auto& ordered : orderedInputs_) {
+    if (ordered) {
+      extraBytes += ordered->rows->allocatedBytes();
+    }
+  }
   if (table_) {
-    return table_->allocatedBytes();
+    return table_->allocatedBytes() + extraBytes;
   }
 
-  return stringAllocator_.retainedSize() + rows_.allocatedBytes();
+  return stringAllocator_.retainedSize() + rows_.allocatedBytes() +
+      extraBytes;
+}
+
+uint64_t GroupingSet::usedBytes() const {
+  auto bytes = allocatedBytes();
+  if (table_) {
+    bytes -= table_->rows()->freeBytes();
+  }
+  return bytes;
 }
 
 const HashLookup& GroupingSet::hashLookup() const {
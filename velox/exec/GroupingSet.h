@@ -16,6 +16,8 @@
 #pragma once
 
 #include "velox/exec/HashTable.h"
+#include "velox/exec/NormalizedKey.h"
+#include "velox/exec/Spill.h"
 #include "velox/exec/VectorHasher.h"
 
 namespace facebook::velox::exec {
@@ -24,15 +26,33 @@ class Aggregate;
 
 class GroupingSet {
  public:
+  // 'intermediateTypes' gives the accumulator type of each aggregate. These
+  // are used for spilling. 'spillMemoryThreshold' is the hash table size in
+  // bytes after which the groups are spilled to disk. 0 disables spilling.
+  // Spilling is only supported for grouped aggregations that produce final
+  // results. 'distinctAggregates' flags the aggregates that only see the
+  // distinct values of their arguments in each group. 'sortingKeys' gives
+  // for each aggregate the input channels and orders of the keys its input
+  // is sorted on, or nothing if the aggregate takes its input in any
+  // order. DISTINCT and ordered aggregates require raw input and no
+  // spilling. If 'shared', the groups are shared by the Drivers of the
+  // Task and their memory comes from the Task and query instead of the
+  // Operator of 'operatorCtx', which may be destroyed before them.
   GroupingSet(
       std::vector<std::unique_ptr<VectorHasher>>&& hashers,
       std::vector<std::unique_ptr<Aggregate>>&& aggregates,
       std::vector<std::optional<ChannelIndex>>&& aggrMaskChannels,
       std::vector<std::vector<ChannelIndex>>&& channelLists,
       std::vector<std::vector<VectorPtr>>&& constantLists,
+      std::vector<bool>&& distinctAggregates,
+      std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>&&
+          sortingKeys,
+      std::vector<TypePtr>&& intermediateTypes,
       bool ignoreNullKeys,
       bool isRawInput,
-      OperatorCtx* driverCtx);
+      uint64_t spillMemoryThreshold,
+      OperatorCtx* operatorCtx,
+      bool shared = false);
 
   void addInput(const RowVectorPtr& input, bool mayPushdown);
 
@@ -44,15 +64,136 @@ class GroupingSet {
 
   uint64_t allocatedBytes() const;
 
+  // Returns allocatedBytes() minus the memory of evicted groups, which is
+  // kept for new groups.
+  uint64_t usedBytes() const;
+
+  // Makes a partial aggregation flag the groups it updates so that it can
+  // evict the groups not updated recently instead of flushing all groups.
+  // Must be called before the first input. Returns false and has no effect
+  // for a global aggregation and with DISTINCT or ordered aggregates.
+  bool enableColdGroupEviction();
+
+  // Clears the flags of all groups. The groups updated after this are kept
+  // by the next getColdOutput().
+  void markGroupsCold();
+
+  // Produces the next batch of keys and intermediate results of the groups
+  // not updated since the last markGroupsCold(). The groups of a batch are
+  // erased from the hash table on the next call, after the consumer of
+  // 'result' is done with the keys that point into the table. Returns false
+  // when no cold groups are left, after which the groups still in the table
+  // are marked cold.
+  bool getColdOutput(
+      int32_t batchSize,
+      RowContainerIterator* iterator,
+      RowVectorPtr& result);
+
+  // Number of groups in the hash table.
+  uint64_t numDistinct() const {
+    return table_ ? table_->numDistinct() : 0;
+  }
+
+  // Returns the keys of 'input' followed by the intermediate results of
+  // each row as a group of its own. Used by a partial aggregation that
+  // reduces its input too little to be worth grouping it. The hash table
+  // must be empty.
+  RowVectorPtr toIntermediate(
+      const RowVectorPtr& input,
+      const RowTypePtr& outputType);
+
+  // Sets the expected number of groups. The hash table is sized for this
+  // many groups when it is created.
+  void setNumGroupsHint(uint64_t numGroups) {
+    numGroupsHint_ = numGroups;
+  }
+
   void resetPartial();
 
   const HashLookup& hashLookup() const;
 
+  // Spills the groups in memory to free their memory if spilling is
+  // enabled and output has not started. Returns the number of bytes
+  // freed.
+  int64_t reclaim();
+
+  // Total bytes written to spill files.
+  uint64_t spilledBytes() const {
+    return spilledBytes_;
+  }
+
+  // Total number of groups written to spill files. A group may be counted
+  // once per spill.
+  int64_t spilledRows() const {
+    return spilledRows_;
+  }
+
  private:
+  // Number of hash partitions the groups are spilled into. Each partition is
+  // re-aggregated separately, so that the groups of one partition must fit
+  // in memory at a time.
+  static constexpr int32_t kNumSpillPartitionBits = 3;
+  static constexpr int32_t kNumSpillPartitions = 1 << kNumSpillPartitionBits;
+  // Position of the hash bits that select the spill partition. These are
+  // above the bits used for hash table tags and bucket numbers.
+  static constexpr int32_t kSpillPartitionShift = 40;
+  // Minimum number of aggregates for updating group rows in blocks of
+  // input rows. See addInputInRowBlocks().
+  static constexpr int32_t kMinAggregatesForRowBlocks = 4;
+  // Target size in bytes of the group rows touched by one block of input
+  // rows. About the size of an L1 cache.
+  static constexpr int32_t kRowBlockBytes = 32 << 10;
+  static constexpr vector_size_t kMinRowBlockSize = 64;
+
   void initializeGlobalAggregation();
 
+  // Sets 'result' to the keys of 'groups' followed by their intermediate
+  // results if 'isPartial' or final results otherwise.
+  void extractGroups(
+      char** groups,
+      int32_t numGroups,
+      bool isPartial,
+      const RowVectorPtr& result);
+
+  // Erases the groups produced by the last getColdOutput().
+  void eraseEvictedGroups();
+
+  void createHashTable();
+
+  // Probes 'table_' with the keys of 'input' at 'keyChannels'. Returns
+  // false if the hash mode changed and the probe must be retried.
+  bool probeKeys(
+      const RowVectorPtr& input,
+      const std::vector<ChannelIndex>& keyChannels);
+
+  // Writes the groups in 'table_' to the spill partition files as keys
+  // followed by intermediate results and clears 'table_'.
+  void spill();
+
+  // Clears 'table_' and re-aggregates the spilled groups of the next
+  // partition into it. Returns false if there are no more partitions.
+  bool loadNextSpillPartition();
+
+  // Adds a batch of keys and intermediate results read from a spill file to
+  // 'table_'.
+  void addSpilledInput(const RowVectorPtr& input);
+
   void populateTempVectors(int32_t aggregateIndex, const RowVectorPtr& input);
 
+  // Returns the number of input rows to update all aggregates with before
+  // moving on to the next rows, or 0 if the aggregates are updated one at a
+  // time over the whole input.
+  vector_size_t rowBlockSize(vector_size_t numRows) const;
+
+  // Updates the accumulators of 'lookup_->hits' from 'input' one block of
+  // 'blockSize' rows at a time, all aggregates for each block. With many
+  // fixed width accumulators on each group row, updating one aggregate at
+  // a time over the whole input brings each group row into cache once per
+  // aggregate. With blocks, the group rows of a block stay in cache while
+  // all the aggregates update them. Loads lazy arguments up front, so there
+  // is no pushdown.
+  void addInputInRowBlocks(const RowVectorPtr& input, vector_size_t blockSize);
+
   // For each aggregation, if that aggregation has mask, the method prepares the
   // selectivity vector by copying activeRows_ and then updating it from the
   // mask column. The selectivity vectors are reused, if more than one
@@ -64,6 +205,25 @@ class GroupingSet {
   // index for this aggregation), otherwise it returns reference to activeRows_.
   const SelectivityVector& getSelectivityVector(size_t aggregateIndex) const;
 
+  // Returns the subset of 'rows' of 'input' whose combination of grouping
+  // keys and arguments of the DISTINCT aggregate 'aggregateIndex' has not
+  // been seen before, and remembers these combinations.
+  const SelectivityVector& selectDistinctRows(
+      int32_t aggregateIndex,
+      const RowVectorPtr& input,
+      const SelectivityVector& rows);
+
+  // Buffers 'rows' of 'input' with their groups for the ordered aggregate
+  // 'aggregateIndex'.
+  void storeOrderedInput(
+      int32_t aggregateIndex,
+      const RowVectorPtr& input,
+      const SelectivityVector& rows);
+
+  // Sorts the buffered rows of each ordered aggregate and adds them to the
+  // aggregate in that order. Called once after all input is seen.
+  void addOrderedInputs();
+
   std::vector<ChannelIndex> keyChannels_;
   std::vector<std::unique_ptr<VectorHasher>> hashers_;
   const bool isGlobal_;
@@ -78,13 +238,40 @@ class GroupingSet {
   // 'channelLists_'. This is used when channelLists_[i][j] ==
   // kConstantChannel.
   const std::vector<std::vector<VectorPtr>> constantLists_;
+  // True for the aggregates that only see distinct arguments in each group.
+  const std::vector<bool> distinctAggregates_;
+  // Sorting keys of each aggregate. Empty for the aggregates that take
+  // their input in any order.
+  const std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>
+      sortingKeys_;
   const bool ignoreNullKeys_;
   memory::MappedMemory* const mappedMemory_;
 
   std::vector<bool> mayPushdown_;
 
+  // True if all aggregates have fixed width accumulators and there are
+  // enough of them to update the group rows in blocks of input rows.
+  bool useRowBlocks_{false};
+
+  // The arguments of all aggregates and the rows of one block for
+  // addInputInRowBlocks().
+  std::vector<std::vector<VectorPtr>> blockArgs_;
+  SelectivityVector blockRows_;
+
+  // True if the groups updated since the last markGroupsCold() are flagged
+  // so that the others can be evicted. See enableColdGroupEviction().
+  bool evictColdGroups_{false};
+
+  // The groups of the last batch of getColdOutput(), to erase on the next
+  // call.
+  std::vector<char*> evictedGroups_;
+
   // Place for the arguments of the aggregate being updated.
   std::vector<VectorPtr> tempVectors_;
+
+  // The single row groups and their indices for toIntermediate().
+  std::vector<char*> intermediateGroups_;
+  std::vector<vector_size_t> intermediateIndices_;
   std::unique_ptr<BaseHashTable> table_;
   std::unique_ptr<HashLookup> lookup_;
   uint64_t numAdded_ = 0;
@@ -101,11 +288,73 @@ class GroupingSet {
   // masks.
   DecodedVector decodedMask_;
 
+  // The combinations of grouping keys and arguments seen by a DISTINCT
+  // aggregate. Null keys and arguments are values of their own here; the
+  // aggregate decides whether to ignore nulls.
+  struct DistinctSet {
+    std::unique_ptr<BaseHashTable> table;
+    std::unique_ptr<HashLookup> lookup;
+    // Rows of the current input that have a new combination.
+    SelectivityVector newRows;
+  };
+
+  // One per aggregate. nullptr for the aggregates that are not DISTINCT and
+  // until the first input.
+  std::vector<std::unique_ptr<DistinctSet>> distinctSets_;
+
+  // The input rows of an ordered aggregate, kept until all input is seen.
+  // The columns are the group as a BIGINT, the sorting keys and the
+  // non-constant arguments.
+  struct OrderedInput {
+    RowTypePtr type;
+    std::unique_ptr<RowContainer> rows;
+    // nullptr if the first sorting key cannot be encoded.
+    std::unique_ptr<NormalizedKeyEncoder> encoder;
+    // Input channels of the sorting keys followed by the arguments.
+    std::vector<ChannelIndex> channels;
+    // One per column of 'type'.
+    std::vector<DecodedVector> decoded;
+  };
+
+  // One per aggregate. nullptr for the aggregates that are not ordered and
+  // until the first input.
+  std::vector<std::unique_ptr<OrderedInput>> orderedInputs_;
+
+  // True once the ordered inputs have been added to their aggregates.
+  bool orderedInputsAdded_{false};
+
   // Used to allocate memory for a single row accumulating results of global
   // aggregation
   HashStringAllocator stringAllocator_;
   AllocationPool rows_;
   const bool isAdaptive_;
+  // Stores timestamp keys in 8 bytes in 'table_'.
+  const bool packTimestamps_;
+
+  // Expected number of groups, 0 if unknown.
+  uint64_t numGroupsHint_{0};
+
+  memory::MemoryPool* const pool_;
+  const uint64_t spillMemoryThreshold_;
+  const std::string spillPath_;
+
+  // Type of spilled rows: the grouping keys followed by the intermediate
+  // results of 'aggregates_'.
+  RowTypePtr spillType_;
+
+  // Channels of the grouping keys in 'spillType_'.
+  std::vector<ChannelIndex> spillKeyChannels_;
+
+  // Spilled groups, one file per hash partition. Empty if nothing was
+  // spilled.
+  std::vector<std::unique_ptr<SpillFile>> spillPartitions_;
+
+  // Index of the partition currently held in 'table_' while producing
+  // output. -1 if output has not started.
+  int32_t outputPartition_ = -1;
+
+  uint64_t spilledBytes_ = 0;
+  int64_t spilledRows_ = 0;
 };
 
 } // namespace facebook::velox::exec
@@ -19,6 +19,34 @@
 
 namespace facebook::velox::exec {
 
+SharedAggregationTable::SharedAggregationTable(
+    std::vector<std::unique_ptr<GroupingSet>> partitions)
+    : partitions_(partitions.size()) {
+  for (auto i = 0; i < partitions.size(); ++i) {
+    partitions_[i].groups = std::move(partitions[i]);
+  }
+}
+
+bool SharedAggregationTable::tryAddInput(
+    int32_t partition,
+    const RowVectorPtr& input) {
+  auto& entry = partitions_[partition];
+  std::unique_lock<std::mutex> l(entry.mutex, std::try_to_lock);
+  if (!l.owns_lock()) {
+    return false;
+  }
+  entry.groups->addInput(input, false);
+  return true;
+}
+
+void SharedAggregationTable::addInput(
+    int32_t partition,
+    const RowVectorPtr& input) {
+  auto& entry = partitions_[partition];
+  std::lock_guard<std::mutex> l(entry.mutex);
+  entry.groups->addInput(input, false);
+}
+
 HashAggregation::HashAggregation(
     int32_t operatorId,
     DriverCtx* driverCtx,
@@ -37,15 +65,127 @@ HashAggregation::HashAggregation(
           driverCtx->execCtx->queryCtx()
               ->config()
               .maxPartialAggregationMemoryUsage()),
+      abandonPartialAggregationMinRows_(
+          driverCtx->execCtx->queryCtx()
+              ->config()
+              .abandonPartialAggregationMinRows()),
+      abandonPartialAggregationMinPct_(
+          driverCtx->execCtx->queryCtx()
+              ->config()
+              .abandonPartialAggregationMinPct()),
       isPartialOutput_(isPartialOutput(aggregationNode->step())),
       isDistinct_(aggregationNode->aggregates().empty()),
-      isGlobal_(aggregationNode->groupingKeys().empty()) {
+      isGlobal_(aggregationNode->groupingKeys().empty()),
+      mayCacheSplitResults_(
+          aggregationNode->step() == core::AggregationNode::Step::kPartial &&
+          !isDistinct_ && !isGlobal_ &&
+          !aggregationNode->hasDistinctAggregates() &&
+          !aggregationNode->hasOrderedAggregates()) {
   auto inputType = aggregationNode->sources()[0]->outputType();
+  // A row with null keys would be dropped when ignoring null keys, so each
+  // row can become a group of its own only if null keys are kept.
+  mayAbandonPartialAggregation_ =
+      aggregationNode->step() == core::AggregationNode::Step::kPartial &&
+      !isDistinct_ && !isGlobal_ && !aggregationNode->ignoreNullKeys();
+
+  if (isDistinct_) {
+    for (ChannelIndex i = 0; i < aggregationNode->groupingKeys().size();
+         ++i) {
+      identityProjections_.emplace_back(
+          exprToChannel(aggregationNode->groupingKeys()[i].get(), inputType),
+          i);
+    }
+  }
+
+  // Only grouped aggregations that produce final results spill. Partial
+  // aggregations flush instead and distinct aggregations produce their
+  // output as new keys arrive. The values seen by DISTINCT aggregates and
+  // the input of ordered aggregates are not spilled.
+  const auto& config = driverCtx->execCtx->queryCtx()->config();
+  uint64_t spillMemoryThreshold = 0;
+  if (config.spillEnabled() && !isPartialOutput_ && !isDistinct_ &&
+      !isGlobal_ && !aggregationNode->hasDistinctAggregates() &&
+      !aggregationNode->hasOrderedAggregates()) {
+    spillMemoryThreshold = config.aggregationSpillMemoryThreshold();
+  }
+
+  if (driverCtx->numDrivers > 1 && config.sharedFinalAggregationEnabled() &&
+      supportsSharedTable(*aggregationNode)) {
+    // A power of two of partitions, several per Driver, so that the Drivers
+    // seldom wait for each other and get about equal shares of the output.
+    int32_t numPartitions = 1;
+    while (numPartitions < 4 * driverCtx->numDrivers &&
+           numPartitions < kMaxSharedPartitions) {
+      numPartitions *= 2;
+    }
+    outputPartition_ = driverCtx->driverId;
+    sharedTable_ = operatorCtx_->task()->getSharedAggregationTable(
+        driverCtx->splitGroupId, planNodeId(), [&]() {
+          std::vector<std::unique_ptr<GroupingSet>> partitions;
+          partitions.reserve(numPartitions);
+          for (auto i = 0; i < numPartitions; ++i) {
+            partitions.push_back(makeGroupingSet(*aggregationNode, 0, true));
+            if (aggregationNode->numGroupsHint()) {
+              partitions.back()->setNumGroupsHint(
+                  aggregationNode->numGroupsHint() / numPartitions);
+            }
+          }
+          return std::make_shared<SharedAggregationTable>(
+              std::move(partitions));
+        });
+    std::vector<ChannelIndex> keyChannels;
+    for (const auto& key : aggregationNode->groupingKeys()) {
+      keyChannels.push_back(exprToChannel(key.get(), inputType));
+    }
+    partitionFunction_ = std::make_unique<HashPartitionFunction>(
+        sharedTable_->numPartitions(), inputType, std::move(keyChannels));
+    stats_.addRuntimeStat("sharedAggregationTable", 1);
+    return;
+  }
+
+  groupingSet_ =
+      makeGroupingSet(*aggregationNode, spillMemoryThreshold, false);
+
+  // A final or single aggregation ends up holding all its groups, so its
+  // table is sized for them upfront. Partial aggregations are bounded by
+  // their flush threshold instead. The drivers are assumed to see about an
+  // equal share of the groups.
+  if (!isPartialOutput_ && !isGlobal_ && aggregationNode->numGroupsHint()) {
+    groupingSet_->setNumGroupsHint(
+        aggregationNode->numGroupsHint() / driverCtx->numDrivers);
+  }
+
+  // A full partial aggregation evicts the groups it has not updated
+  // recently and keeps the others, which are likely to be updated again.
+  if (isPartialOutput_ && !isDistinct_) {
+    evictColdGroups_ = groupingSet_->enableColdGroupEviction();
+  }
+}
+
+// static
+bool HashAggregation::supportsSharedTable(
+    const core::AggregationNode& aggregationNode) {
+  // DISTINCT and ordered aggregates keep state beside the groups. A
+  // pre-grouped aggregation streams its groups in input order.
+  return (aggregationNode.step() == core::AggregationNode::Step::kFinal ||
+          aggregationNode.step() == core::AggregationNode::Step::kSingle) &&
+      !aggregationNode.groupingKeys().empty() &&
+      !aggregationNode.aggregates().empty() &&
+      !aggregationNode.hasDistinctAggregates() &&
+      !aggregationNode.hasOrderedAggregates() &&
+      !aggregationNode.isPreGrouped();
+}
 
-  auto numHashers = aggregationNode->groupingKeys().size();
+std::unique_ptr<GroupingSet> HashAggregation::makeGroupingSet(
+    const core::AggregationNode& aggregationNode,
+    uint64_t spillMemoryThreshold,
+    bool shared) {
+  auto inputType = aggregationNode.sources()[0]->outputType();
+  auto pool = shared ? operatorCtx_->task()->pool() : operatorCtx_->pool();
+  auto numHashers = aggregationNode.groupingKeys().size();
   std::vector<std::unique_ptr<VectorHasher>> hashers;
   hashers.reserve(numHashers);
-  for (const auto& key : aggregationNode->groupingKeys()) {
+  for (const auto& key : aggregationNode.groupingKeys()) {
     auto channel = exprToChannel(key.get(), inputType);
     VELOX_CHECK_NE(
         channel,
@@ -54,15 +194,19 @@ HashAggregation::HashAggregation(
     hashers.push_back(VectorHasher::create(key->type(), channel));
   }
 
-  auto numAggregates = aggregationNode->aggregates().size();
+  auto numAggregates = aggregationNode.aggregates().size();
   std::vector<std::unique_ptr<Aggregate>> aggregates;
   aggregates.reserve(numAggregates);
   std::vector<std::optional<uint32_t>> aggrMaskChannels;
   aggrMaskChannels.reserve(numAggregates);
   std::vector<std::vector<ChannelIndex>> args;
   std::vector<std::vector<VectorPtr>> constantLists;
+  std::vector<bool> distinctAggregates;
+  std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>
+      sortingKeys;
+  std::vector<TypePtr> intermediateTypes;
   for (auto i = 0; i < numAggregates; i++) {
-    const auto& aggregate = aggregationNode->aggregates()[i];
+    const auto& aggregate = aggregationNode.aggregates()[i];
 
     std::vector<ChannelIndex> channels;
     std::vector<VectorPtr> constants;
@@ -73,7 +217,7 @@ HashAggregation::HashAggregation(
       if (channels.back() == kConstantChannel) {
         auto constant = dynamic_cast<const core::ConstantTypedExpr*>(arg.get());
         constants.push_back(BaseVector::createConstant(
-            constant->value(), 1, operatorCtx_->pool()));
+            constant->value(), 1, pool));
       } else {
         constants.push_back(nullptr);
       }
@@ -81,7 +225,7 @@ HashAggregation::HashAggregation(
 
     // Setup aggregation mask: convert the Variable Reference name to the
     // channel (projection) index, if there is a mask.
-    const auto& aggrMask = aggregationNode->aggregateMasks()[i];
+    const auto& aggrMask = aggregationNode.aggregateMasks()[i];
     if (aggrMask == nullptr) {
       aggrMaskChannels.emplace_back(std::optional<ChannelIndex>{});
     } else {
@@ -91,9 +235,37 @@ HashAggregation::HashAggregation(
 
     const auto& resultType = outputType_->childAt(numHashers + i);
     aggregates.push_back(Aggregate::create(
-        aggregate->name(), aggregationNode->step(), argTypes, resultType));
+        aggregate->name(), aggregationNode.step(), argTypes, resultType));
+    // The intermediate results are the input of a final aggregation. For raw
+    // input, these are the result type of the partial step.
+    if (isRawInput(aggregationNode.step())) {
+      intermediateTypes.push_back(
+          Aggregate::create(
+              aggregate->name(),
+              core::AggregationNode::Step::kPartial,
+              argTypes,
+              UNKNOWN())
+              ->resultType());
+    } else {
+      intermediateTypes.push_back(argTypes[0]);
+    }
     args.push_back(channels);
     constantLists.push_back(constants);
+    distinctAggregates.push_back(aggregationNode.isDistinctAggregate(i));
+
+    std::vector<std::pair<ChannelIndex, core::SortOrder>> keys;
+    if (aggregationNode.isOrderedAggregate(i)) {
+      const auto& ordering = aggregationNode.aggregateOrdering(i);
+      for (auto j = 0; j < ordering.sortingKeys.size(); ++j) {
+        auto channel = exprToChannel(ordering.sortingKeys[j].get(), inputType);
+        VELOX_CHECK_NE(
+            channel,
+            kConstantChannel,
+            "Aggregation doesn't allow constant sorting keys");
+        keys.emplace_back(channel, ordering.sortingOrders[j]);
+      }
+    }
+    sortingKeys.push_back(std::move(keys));
   }
 
   // Check that aggregate result type match the output type
@@ -107,38 +279,304 @@ HashAggregation::HashAggregation(
         expectedType->toString());
   }
 
-  if (isDistinct_) {
-    for (ChannelIndex i = 0; i < hashers.size(); ++i) {
-      identityProjections_.emplace_back(hashers[i]->channel(), i);
-    }
-  }
-
-  groupingSet_ = std::make_unique<GroupingSet>(
+  return std::make_unique<GroupingSet>(
       std::move(hashers),
       std::move(aggregates),
       std::move(aggrMaskChannels),
       std::move(args),
       std::move(constantLists),
-      aggregationNode->ignoreNullKeys(),
-      isRawInput(aggregationNode->step()),
-      operatorCtx_.get());
+      std::move(distinctAggregates),
+      std::move(sortingKeys),
+      std::move(intermediateTypes),
+      aggregationNode.ignoreNullKeys(),
+      isRawInput(aggregationNode.step()),
+      spillMemoryThreshold,
+      operatorCtx_.get(),
+      shared);
 }
 
 void HashAggregation::addInput(RowVectorPtr input) {
+  if (abandonedPartialAggregation_) {
+    passthroughInput_ = std::move(input);
+    return;
+  }
+  if (sharedTable_) {
+    addSharedInput(input);
+    return;
+  }
   input_ = input;
   if (!pushdownChecked_) {
     mayPushdown_ = operatorCtx_->driver()->mayPushdownAggregation(this);
     pushdownChecked_ = true;
   }
   groupingSet_->addInput(input_, mayPushdown_);
-  if (isPartialOutput_ &&
+  if (evictColdGroups_) {
+    // The memory of evicted groups is kept for new groups, so only the
+    // memory in use counts towards the limit.
+    auto usedBytes = groupingSet_->usedBytes();
+    if (!groupsMarkedCold_ &&
+        usedBytes > maxPartialAggregationMemoryUsage_ / 2) {
+      // The groups updated from here until the limit is reached are kept.
+      groupingSet_->markGroupsCold();
+      groupsMarkedCold_ = true;
+    }
+    if (usedBytes > maxPartialAggregationMemoryUsage_) {
+      partialFull_ = true;
+    }
+  } else if (
+      isPartialOutput_ &&
       groupingSet_->allocatedBytes() > maxPartialAggregationMemoryUsage_) {
     partialFull_ = true;
   }
+  if (mayAbandonPartialAggregation_) {
+    numPartialInputRows_ += input_->size();
+    if (numPartialInputRows_ >= abandonPartialAggregationMinRows_ &&
+        groupingSet_->numDistinct() * 100 >=
+            numPartialInputRows_ * abandonPartialAggregationMinPct_) {
+      // Flushes the groups so far. The input after that goes straight to
+      // the output.
+      abandonedPartialAggregation_ = true;
+      partialFull_ = true;
+      stats_.addRuntimeStat("abandonedPartialAggregation", 1);
+    }
+  }
   newDistincts_ = isDistinct_ && !groupingSet_->hashLookup().newGroups.empty();
 }
 
+void HashAggregation::addSharedInput(const RowVectorPtr& input) {
+  // The parts share the loaded children of 'input'.
+  auto numRows = input->size();
+  std::vector<VectorPtr> children;
+  children.reserve(input->childrenSize());
+  for (auto& child : input->children()) {
+    children.push_back(BaseVector::loadedVectorShared(child));
+  }
+  auto loaded = std::make_shared<RowVector>(
+      operatorCtx_->pool(),
+      input->type(),
+      input->nulls(),
+      numRows,
+      children);
+  partitionFunction_->partition(*loaded, partitions_);
+
+  auto numPartitions = sharedTable_->numPartitions();
+  partitionSizes_.assign(numPartitions, 0);
+  for (auto i = 0; i < numRows; ++i) {
+    ++partitionSizes_[partitions_[i]];
+  }
+  std::vector<BufferPtr> indices(numPartitions);
+  std::vector<vector_size_t*> rawIndices(numPartitions);
+  for (auto partition = 0; partition < numPartitions; ++partition) {
+    auto size = partitionSizes_[partition];
+    if (size == numRows) {
+      // All rows are in one partition.
+      if (!sharedTable_->tryAddInput(partition, loaded)) {
+        sharedTable_->addInput(partition, loaded);
+      }
+      return;
+    }
+    if (size > 0) {
+      indices[partition] = allocateIndices(size, operatorCtx_->pool());
+      rawIndices[partition] =
+          indices[partition]->asMutable<vector_size_t>();
+    }
+  }
+  for (auto i = 0; i < numRows; ++i) {
+    *rawIndices[partitions_[i]]++ = i;
+  }
+
+  std::vector<std::pair<int32_t, RowVectorPtr>> busy;
+  for (auto partition = 0; partition < numPartitions; ++partition) {
+    auto size = partitionSizes_[partition];
+    if (size == 0) {
+      continue;
+    }
+    std::vector<VectorPtr> wrapped;
+    wrapped.reserve(children.size());
+    for (auto& child : children) {
+      wrapped.push_back(BaseVector::wrapInDictionary(
+          nullptr, indices[partition], size, child));
+    }
+    auto part = std::make_shared<RowVector>(
+        operatorCtx_->pool(),
+        input->type(),
+        BufferPtr(nullptr),
+        size,
+        std::move(wrapped));
+    if (!sharedTable_->tryAddInput(partition, part)) {
+      busy.emplace_back(partition, std::move(part));
+    }
+  }
+  for (auto& [partition, part] : busy) {
+    sharedTable_->addInput(partition, part);
+  }
+}
+
+int64_t HashAggregation::reclaim(int64_t /*targetBytes*/) {
+  if (finished_ || isFinishing_ || !groupingSet_) {
+    return 0;
+  }
+  if (isPartialOutput_) {
+    if (!isDistinct_) {
+      partialFull_ = true;
+      flushAllGroups_ = true;
+    }
+    return 0;
+  }
+  return groupingSet_->reclaim();
+}
+
+void HashAggregation::finish() {
+  Operator::finish();
+  if (!sharedTable_) {
+    return;
+  }
+  // The output starts once all the Drivers have added their input. The last
+  // Driver to finish continues the others.
+  std::vector<VeloxPromise<bool>> promises;
+  std::vector<std::shared_ptr<Driver>> peers;
+  if (!operatorCtx_->task()->allPeersFinished(
+          planNodeId(), operatorCtx_->driver(), &future_, promises, peers)) {
+    hasFuture_ = true;
+    return;
+  }
+  peers.clear();
+  for (auto& promise : promises) {
+    promise.setValue(true);
+  }
+}
+
+BlockingReason HashAggregation::isBlocked(ContinueFuture* future) {
+  if (!hasFuture_) {
+    return BlockingReason::kNotBlocked;
+  }
+  *future = std::move(future_);
+  hasFuture_ = false;
+  return BlockingReason::kWaitForPeers;
+}
+
+RowVectorPtr HashAggregation::getSharedOutput() {
+  // A Driver that waited for its peers gets here after its future is
+  // realized.
+  if (finished_ || !isFinishing_ || hasFuture_) {
+    return nullptr;
+  }
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(outputType_, outputBatchSize_, operatorCtx_->pool()));
+  auto numDrivers = operatorCtx_->driverCtx()->numDrivers;
+  while (outputPartition_ < sharedTable_->numPartitions()) {
+    if (sharedTable_->groups(outputPartition_)
+            .getOutput(outputBatchSize_, false, &resultIterator_, result)) {
+      return result;
+    }
+    resultIterator_.reset();
+    outputPartition_ += numDrivers;
+  }
+  finished_ = true;
+  return nullptr;
+}
+
+bool HashAggregation::enableSplitResultCache(
+    cache::AsyncDataCache* cache,
+    const std::string& fingerprint) {
+  if (!mayCacheSplitResults_ || !groupingSet_) {
+    return false;
+  }
+  resultCache_ = std::make_unique<FragmentResultCache>(cache);
+  resultCacheFingerprint_ = fingerprint;
+  return true;
+}
+
+bool HashAggregation::startSplit(const std::string& splitKey) {
+  VELOX_CHECK(splitKey_.empty());
+  // Groups of splits that are not cached stay out of the cached results.
+  flushSplitGroups();
+  std::vector<RowVectorPtr> results;
+  if (resultCache_->get(
+          resultCacheFingerprint_ + splitKey,
+          outputType_,
+          operatorCtx_->pool(),
+          results)) {
+    pendingOutput_.insert(pendingOutput_.end(), results.begin(), results.end());
+    stats_.addRuntimeStat("fragmentCacheHits", 1);
+    return true;
+  }
+  stats_.addRuntimeStat("fragmentCacheMisses", 1);
+  splitKey_ = splitKey;
+  splitResults_.clear();
+  splitResultBytes_ = 0;
+  return false;
+}
+
+void HashAggregation::finishSplit() {
+  flushSplitGroups();
+  if (!splitKey_.empty()) {
+    resultCache_->put(resultCacheFingerprint_ + splitKey_, splitResults_);
+  }
+  splitKey_.clear();
+  splitResults_.clear();
+  splitResultBytes_ = 0;
+}
+
+void HashAggregation::recordSplitOutput(const RowVectorPtr& output) {
+  if (splitKey_.empty() || !output) {
+    return;
+  }
+  splitResultBytes_ += output->retainedSize();
+  if (splitResultBytes_ > FragmentResultCache::kMaxEntryBytes) {
+    // Too large to cache. The rest of the split is not recorded.
+    splitKey_.clear();
+    splitResults_.clear();
+    return;
+  }
+  splitResults_.push_back(output);
+}
+
+void HashAggregation::flushSplitGroups() {
+  if (passthroughInput_) {
+    auto output = groupingSet_->toIntermediate(passthroughInput_, outputType_);
+    passthroughInput_ = nullptr;
+    recordSplitOutput(output);
+    pendingOutput_.push_back(std::move(output));
+  }
+  for (;;) {
+    auto result = std::static_pointer_cast<RowVector>(BaseVector::create(
+        outputType_, outputBatchSize_, operatorCtx_->pool()));
+    if (!groupingSet_->getOutput(
+            outputBatchSize_, true, &resultIterator_, result)) {
+      break;
+    }
+    recordSplitOutput(result);
+    pendingOutput_.push_back(std::move(result));
+  }
+  resultIterator_.reset();
+  groupingSet_->resetPartial();
+  partialFull_ = false;
+  flushAllGroups_ = false;
+  groupsMarkedCold_ = false;
+  numPartialInputRows_ = 0;
+}
+
 RowVectorPtr HashAggregation::getOutput() {
+  if (sharedTable_) {
+    return getSharedOutput();
+  }
+  if (!pendingOutput_.empty()) {
+    auto output = std::move(pendingOutput_.front());
+    pendingOutput_.pop_front();
+    return output;
+  }
+  auto output = getGroupOutput();
+  recordSplitOutput(output);
+  return output;
+}
+
+RowVectorPtr HashAggregation::getGroupOutput() {
+  if (passthroughInput_) {
+    auto output = groupingSet_->toIntermediate(passthroughInput_, outputType_);
+    passthroughInput_ = nullptr;
+    return output;
+  }
   if (finished_ || (!isFinishing_ && !partialFull_ && !newDistincts_)) {
     input_ = nullptr;
     return nullptr;
@@ -177,18 +615,47 @@ RowVectorPtr HashAggregation::getOutput() {
   auto result = std::static_pointer_cast<RowVector>(
       BaseVector::create(outputType_, batchSize, operatorCtx_->pool()));
 
+  // Once started, an eviction runs to the end, also if the input ends
+  // meanwhile, since its iterator does not cover the groups it keeps.
+  if (evictingColdGroups_ ||
+      (evictColdGroups_ && partialFull_ && !flushAllGroups_ &&
+       !isFinishing_ && !abandonedPartialAggregation_)) {
+    evictingColdGroups_ = true;
+    if (groupingSet_->getColdOutput(batchSize, &resultIterator_, result)) {
+      stats_.addRuntimeStat("evictedPartialGroups", result->size());
+      return result;
+    }
+    evictingColdGroups_ = false;
+    resultIterator_.reset();
+    if (!flushAllGroups_ && !isFinishing_ &&
+        groupingSet_->usedBytes() <= maxPartialAggregationMemoryUsage_ / 2) {
+      partialFull_ = false;
+      return nullptr;
+    }
+    // The recently updated groups take most of the memory, so that
+    // evicting the others makes room for little input. Flushes all groups.
+    flushAllGroups_ = true;
+  }
+
   bool hasData = groupingSet_->getOutput(
       batchSize, isPartialOutput_, &resultIterator_, result);
   if (!hasData) {
     resultIterator_.reset();
     if (isPartialOutput_) {
       partialFull_ = false;
+      flushAllGroups_ = false;
+      groupsMarkedCold_ = false;
+      numPartialInputRows_ = 0;
       groupingSet_->resetPartial();
       if (isFinishing_) {
         finished_ = true;
       }
     } else {
       finished_ = true;
+      if (groupingSet_->spilledRows() != 0) {
+        stats_.addRuntimeStat("spilledBytes", groupingSet_->spilledBytes());
+        stats_.addRuntimeStat("spilledRows", groupingSet_->spilledRows());
+      }
     }
     return nullptr;
   }
@@ -15,57 +15,199 @@
  */
 #pragma once
 
+#include <deque>
+#include "velox/exec/FragmentResultCache.h"
 #include "velox/exec/GroupingSet.h"
+#include "velox/exec/HashPartitionFunction.h"
 #include "velox/exec/Operator.h"
 
 namespace facebook::velox::exec {
 
-class HashAggregation : public Operator {
+// The groups of a final aggregation that all the Drivers of its pipeline add
+// their input to. The groups are split in hash partitions, each with its own
+// GroupingSet and mutex, so that Drivers adding input at the same time
+// mostly update different partitions. Once all the Drivers have added their
+// input, each produces the output of its share of the partitions.
+class SharedAggregationTable {
+ public:
+  explicit SharedAggregationTable(
+      std::vector<std::unique_ptr<GroupingSet>> partitions);
+
+  int32_t numPartitions() const {
+    return partitions_.size();
+  }
+
+  // Adds 'input' to the groups of 'partition' unless another Driver is
+  // updating them. Returns false without adding 'input' in that case.
+  bool tryAddInput(int32_t partition, const RowVectorPtr& input);
+
+  // Adds 'input' to the groups of 'partition', waiting for other Drivers to
+  // finish updating them.
+  void addInput(int32_t partition, const RowVectorPtr& input);
+
+  // Returns the groups of 'partition' without locking. Only for use after
+  // all Drivers have added their input.
+  GroupingSet& groups(int32_t partition) {
+    return *partitions_[partition].groups;
+  }
+
+ private:
+  struct Partition {
+    std::mutex mutex;
+    std::unique_ptr<GroupingSet> groups;
+  };
+
+  std::vector<Partition> partitions_;
+};
+
+class HashAggregation : public Operator, public SplitResultCacheClient {
  public:
   HashAggregation(
       int32_t operatorId,
       DriverCtx* driverCtx,
       const std::shared_ptr<const core::AggregationNode>& aggregationNode);
 
+  // Returns true if the Drivers of 'aggregationNode' can share their groups
+  // and so run on more than one Driver. See
+  // QueryConfig::kSharedFinalAggregationEnabled.
+  static bool supportsSharedTable(const core::AggregationNode& aggregationNode);
+
   void addInput(RowVectorPtr input) override;
 
   RowVectorPtr getOutput() override;
 
   bool needsInput() const override {
-    return !isFinishing_ && !partialFull_;
+    return !isFinishing_ && !partialFull_ && !passthroughInput_ &&
+        pendingOutput_.empty();
   }
 
-  void finish() override {
-    Operator::finish();
-  }
+  void finish() override;
 
-  BlockingReason isBlocked(ContinueFuture* /* unused */) override {
-    return BlockingReason::kNotBlocked;
-  }
+  BlockingReason isBlocked(ContinueFuture* future) override;
 
   void close() override {
     Operator::close();
     groupingSet_.reset();
+    sharedTable_.reset();
   }
 
+  // Spills the groups of a final aggregation if spilling is enabled. A
+  // partial aggregation instead flushes its groups on the next
+  // getOutput(), which frees their memory after the call returns.
+  int64_t reclaim(int64_t targetBytes) override;
+
+  // Keeps the output over each split in 'cache' under 'fingerprint' and
+  // the cache key of the split. Returns false if the output of this does
+  // not depend on the split alone, e.g. for a final or global aggregation.
+  // See QueryConfig::kFragmentResultCacheEnabled.
+  bool enableSplitResultCache(
+      cache::AsyncDataCache* cache,
+      const std::string& fingerprint);
+
+  bool startSplit(const std::string& splitKey) override;
+
+  void finishSplit() override;
+
  private:
+  // Maximum number of partitions of a SharedAggregationTable.
+  static constexpr int32_t kMaxSharedPartitions = 256;
+
+  // Returns the groups of the aggregation. If 'shared', their memory is
+  // not owned by this Operator.
+  std::unique_ptr<GroupingSet> makeGroupingSet(
+      const core::AggregationNode& aggregationNode,
+      uint64_t spillMemoryThreshold,
+      bool shared);
+
+  // Splits 'input' by partition of 'sharedTable_' and adds each part to its
+  // partition. Adds to the partitions that other Drivers are not updating
+  // first.
+  void addSharedInput(const RowVectorPtr& input);
+
+  // Produces the groups of the next one of the partitions of 'sharedTable_'
+  // that belong to this Driver.
+  RowVectorPtr getSharedOutput();
+
+  // Produces the next batch of groups or of the input passed through.
+  RowVectorPtr getGroupOutput();
+
+  // Moves the remaining groups and input passed through to
+  // 'pendingOutput_' and resets the groups. If the output of a split is
+  // being cached, also adds them to 'splitResults_'.
+  void flushSplitGroups();
+
+  // Adds 'output' to the results of the split being cached, if any.
+  void recordSplitOutput(const RowVectorPtr& output);
+
   /// Maximum number of rows in the output batch.
   const uint32_t outputBatchSize_;
 
   const int64_t maxPartialAggregationMemoryUsage_;
 
+  // See QueryConfig::kAbandonPartialAggregationMinRows.
+  const int64_t abandonPartialAggregationMinRows_;
+  const int32_t abandonPartialAggregationMinPct_;
+
   const bool isPartialOutput_;
   const bool isDistinct_;
   const bool isGlobal_;
+  // True for a partial aggregation whose output over a split depends only
+  // on the rows of the split.
+  const bool mayCacheSplitResults_;
 
   std::unique_ptr<GroupingSet> groupingSet_;
 
   bool partialFull_ = false;
+
+  // True if a full partial aggregation evicts the groups not updated since
+  // the groups were last marked cold instead of flushing all groups.
+  bool evictColdGroups_ = false;
+  // True once the groups have been marked cold after the last flush.
+  bool groupsMarkedCold_ = false;
+  // True while getOutput() produces the evicted groups.
+  bool evictingColdGroups_ = false;
+  // True if the next flush produces all groups, e.g. after an eviction
+  // freed too little memory or to release memory.
+  bool flushAllGroups_ = false;
   bool newDistincts_ = false;
   bool finished_ = false;
   RowContainerIterator resultIterator_;
   bool pushdownChecked_ = false;
   bool mayPushdown_ = false;
+
+  // True for a partial aggregation over raw input that may stop grouping
+  // when it does not reduce its input enough.
+  bool mayAbandonPartialAggregation_ = false;
+  bool abandonedPartialAggregation_ = false;
+  // Input rows since the last flush of the partial groups.
+  int64_t numPartialInputRows_ = 0;
+  // Input to convert to intermediate results in the next getOutput() after
+  // the partial aggregation is abandoned.
+  RowVectorPtr passthroughInput_;
+
+  // The groups shared with the other Drivers of the pipeline. If set,
+  // 'groupingSet_' is nullptr.
+  std::shared_ptr<SharedAggregationTable> sharedTable_;
+  // Maps the input rows to partitions of 'sharedTable_'.
+  std::unique_ptr<HashPartitionFunction> partitionFunction_;
+  std::vector<uint32_t> partitions_;
+  std::vector<vector_size_t> partitionSizes_;
+  // The next partition of 'sharedTable_' to produce output from. The
+  // partitions are dealt round robin to the Drivers.
+  int32_t outputPartition_ = 0;
+  // Realized when all the Drivers have added their input to 'sharedTable_'.
+  ContinueFuture future_{false};
+  bool hasFuture_ = false;
+
+  // Set by enableSplitResultCache().
+  std::unique_ptr<FragmentResultCache> resultCache_;
+  std::string resultCacheFingerprint_;
+  // Cache key of the split whose output is being recorded. Empty if none.
+  std::string splitKey_;
+  std::vector<RowVectorPtr> splitResults_;
+  uint64_t splitResultBytes_ = 0;
+  // Output to return before any other, e.g. the cached output of a split.
+  std::deque<RowVectorPtr> pendingOutput_;
 };
 
 } // namespace facebook::velox::exec
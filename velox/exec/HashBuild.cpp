@@ -20,13 +20,27 @@
 
 namespace facebook::velox::exec {
 
-void HashJoinBridge::setHashTable(std::unique_ptr<BaseHashTable> table) {
+void HashJoinBridge::setHashTable(
+    std::unique_ptr<BaseHashTable> table,
+    SpillPartitions spilledPartitions,
+    std::vector<std::shared_ptr<common::Filter>> bloomFilters,
+    std::shared_ptr<common::BigintTuplesUsingBloomFilter> tupleFilter,
+    std::vector<ChannelIndex> tupleFilterKeys) {
   VELOX_CHECK(table, "setHashTable called with null table");
 
   std::lock_guard<std::mutex> l(mutex_);
   VELOX_CHECK(!table_, "setHashTable may be called only once");
   // Ownership becomes shared.
   table_.reset(table.release());
+  bloomFilters_ = std::move(bloomFilters);
+  tupleFilter_ = std::move(tupleFilter);
+  tupleFilterKeys_ = std::move(tupleFilterKeys);
+  buildSpillFiles_ = std::move(spilledPartitions);
+  for (auto& files : buildSpillFiles_) {
+    if (!files.empty()) {
+      ++numSpilledPartitions_;
+    }
+  }
   notifyConsumersLocked();
 }
 
@@ -46,13 +60,171 @@ std::optional<HashJoinBridge::HashBuildResult> HashJoinBridge::tableOrFuture(
   VELOX_CHECK(
       !cancelled_, "Getting hash table after the build side is aborted");
   if (table_ || antiJoinHasNullKeys_) {
-    return HashBuildResult{table_, antiJoinHasNullKeys_};
+    return HashBuildResult{
+        table_,
+        antiJoinHasNullKeys_,
+        numSpilledPartitions_,
+        bloomFilters_,
+        tupleFilter_,
+        tupleFilterKeys_};
   }
   promises_.emplace_back("HashJoinBridge::tableOrFuture");
   *future = promises_.back().getSemiFuture();
   return std::nullopt;
 }
 
+void HashJoinBridge::setSharedResult(const HashBuildResult& result) {
+  std::lock_guard<std::mutex> l(mutex_);
+  VELOX_CHECK(
+      !table_ && !antiJoinHasNullKeys_,
+      "setSharedResult may be called only once");
+  VELOX_CHECK_EQ(
+      result.numSpilledPartitions, 0, "A shared hash table cannot spill");
+  table_ = result.table;
+  antiJoinHasNullKeys_ = result.antiJoinHasNullKeys;
+  bloomFilters_ = result.bloomFilters;
+  tupleFilter_ = result.tupleFilter;
+  tupleFilterKeys_ = result.tupleFilterKeys;
+  notifyConsumersLocked();
+}
+
+void HashJoinBridge::setSharedTable(
+    std::shared_ptr<SharedHashTable> sharedTable) {
+  std::lock_guard<std::mutex> l(mutex_);
+  sharedTable_ = std::move(sharedTable);
+}
+
+bool SharedHashTable::isBuilder(const std::string& taskId) {
+  std::lock_guard<std::mutex> l(mutex_);
+  if (builderTaskId_.empty()) {
+    builderTaskId_ = taskId;
+  }
+  return builderTaskId_ == taskId;
+}
+
+void SharedHashTable::setResult(
+    const HashJoinBridge::HashBuildResult& result) {
+  std::vector<std::weak_ptr<HashJoinBridge>> consumers;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    VELOX_CHECK(!result_, "SharedHashTable::setResult may be called only once");
+    result_ = result;
+    consumers = std::move(consumers_);
+  }
+  for (auto& consumer : consumers) {
+    if (auto bridge = consumer.lock()) {
+      bridge->setSharedResult(result);
+    }
+  }
+}
+
+void SharedHashTable::addConsumer(
+    const std::shared_ptr<HashJoinBridge>& bridge) {
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (!result_) {
+      consumers_.push_back(bridge);
+      return;
+    }
+  }
+  bridge->setSharedResult(result_.value());
+}
+
+// static
+HashTableCache& HashTableCache::instance() {
+  static HashTableCache cache;
+  return cache;
+}
+
+std::shared_ptr<SharedHashTable> HashTableCache::get(
+    const core::QueryCtx* queryCtx,
+    const core::PlanNodeId& planNodeId) {
+  auto key =
+      fmt::format("{}:{}", static_cast<const void*>(queryCtx), planNodeId);
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = tables_.find(key);
+  if (it != tables_.end()) {
+    if (auto table = it->second.lock()) {
+      return table;
+    }
+  }
+  // Drop the entries of finished queries before adding one.
+  for (auto iter = tables_.begin(); iter != tables_.end();) {
+    if (iter->second.expired()) {
+      iter = tables_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  auto table = std::make_shared<SharedHashTable>();
+  tables_[key] = table;
+  return table;
+}
+
+void HashJoinBridge::addProbeSpillFiles(SpillPartitions files) {
+  std::lock_guard<std::mutex> l(mutex_);
+  probeSpillFiles_.resize(kNumSpillPartitions);
+  for (auto partition = 0; partition < files.size(); ++partition) {
+    for (auto& file : files[partition]) {
+      probeSpillFiles_[partition].push_back(std::move(file));
+    }
+  }
+}
+
+void HashJoinBridge::takeSpilledPartitions(
+    SpillPartitions& build,
+    SpillPartitions& probe) {
+  std::lock_guard<std::mutex> l(mutex_);
+  build = std::move(buildSpillFiles_);
+  probe = std::move(probeSpillFiles_);
+  build.resize(kNumSpillPartitions);
+  probe.resize(kNumSpillPartitions);
+}
+
+void spillJoinInput(
+    const RowVectorPtr& input,
+    const raw_vector<uint64_t>& hashes,
+    std::vector<std::unique_ptr<SpillFile>>& files,
+    SelectivityVector& rows,
+    memory::MemoryPool* pool) {
+  std::vector<BufferPtr> indices(files.size());
+  std::vector<vector_size_t> numIndices(files.size(), 0);
+  rows.applyToSelected([&](auto row) {
+    auto partition = HashJoinBridge::spillPartition(hashes[row]);
+    if (!files[partition]) {
+      return;
+    }
+    if (!indices[partition]) {
+      indices[partition] = allocateIndices(input->size(), pool);
+    }
+    indices[partition]
+        ->asMutable<vector_size_t>()[numIndices[partition]++] = row;
+  });
+
+  bool spilled = false;
+  for (auto partition = 0; partition < files.size(); ++partition) {
+    auto numRows = numIndices[partition];
+    if (!numRows) {
+      continue;
+    }
+    if (!spilled) {
+      // Lazy vectors cannot be serialized.
+      for (auto i = 0; i < input->childrenSize(); ++i) {
+        input->loadedChildAt(i);
+      }
+      spilled = true;
+    }
+    auto rawIndices = indices[partition]->as<vector_size_t>();
+    for (auto i = 0; i < numRows; ++i) {
+      rows.setValid(rawIndices[i], false);
+    }
+    files[partition]->append(wrap(numRows, indices[partition], input));
+  }
+  if (spilled) {
+    rows.updateBounds();
+  }
+}
+
 HashBuild::HashBuild(
     int32_t operatorId,
     DriverCtx* driverCtx,
@@ -66,6 +238,22 @@ HashBuild::HashBuild(
   keyChannels_.reserve(numKeys);
   folly::F14FastSet<ChannelIndex> keyChannelSet;
   keyChannelSet.reserve(numKeys);
+  // The Tasks of a broadcast join share one table unless the probe sets
+  // probed flags in it. In grouped execution each split group builds its
+  // own table.
+  const auto splitGroupId = operatorCtx_->driverCtx()->splitGroupId;
+  if (joinNode->isBroadcast() && !joinNode->isRightJoin() &&
+      !joinNode->isFullJoin() && splitGroupId == kUngroupedGroupId) {
+    auto task = operatorCtx_->task();
+    sharedTable_ =
+        HashTableCache::instance().get(task->queryCtx().get(), planNodeId());
+    task->getHashJoinBridge(splitGroupId, planNodeId())
+        ->setSharedTable(sharedTable_);
+    buildsTable_ = sharedTable_->isBuilder(task->taskId());
+    // The table may outlive the Task that builds it.
+    mappedMemory_ = task->queryCtx()->mappedMemory();
+  }
+
   std::vector<std::unique_ptr<VectorHasher>> keyHashers;
   keyHashers.reserve(numKeys);
   for (auto& key : joinNode->rightKeys()) {
@@ -76,13 +264,28 @@ HashBuild::HashBuild(
         std::make_unique<VectorHasher>(type->childAt(channel), channel));
   }
 
+  // Semi and anti joins without a filter only need to know whether a probe
+  // row has a match. Unless the output refers to the build side, the table
+  // then holds just the distinct keys.
+  if ((joinNode->isSemiJoin() || joinNode->isAntiJoin()) &&
+      !joinNode->filter()) {
+    const auto& outputType = joinNode->outputType();
+    distinctKeysOnly_ = true;
+    for (auto i = 0; i < outputType->size(); ++i) {
+      if (type->containsChild(outputType->nameOf(i))) {
+        distinctKeysOnly_ = false;
+        break;
+      }
+    }
+  }
+
   // Identify the non-key build side columns and make a decoder for each.
-  auto numDependents = type->size() - numKeys;
+  auto numDependents = distinctKeysOnly_ ? 0 : type->size() - numKeys;
   dependentChannels_.reserve(numDependents);
   decoders_.reserve(numDependents);
   std::vector<TypePtr> dependentTypes;
   dependentTypes.reserve(numDependents);
-  for (auto i = 0; i < type->size(); ++i) {
+  for (auto i = 0; numDependents > 0 && i < type->size(); ++i) {
     if (keyChannelSet.find(i) == keyChannelSet.end()) {
       dependentTypes.emplace_back(type->childAt(i));
       dependentChannels_.emplace_back(i);
@@ -90,6 +293,8 @@ HashBuild::HashBuild(
     }
   }
 
+  const bool packTimestamps =
+      driverCtx->execCtx->queryCtx()->config().hashTablePackTimestamps();
   if (joinNode->isRightJoin()) {
     // Do not ignore null keys.
     table_ = HashTable<false>::createForJoin(
@@ -97,7 +302,8 @@ HashBuild::HashBuild(
         dependentTypes,
         true, // allowDuplicates
         true, // hasProbedFlag
-        mappedMemory_);
+        mappedMemory_,
+        packTimestamps);
   } else {
     // Semi and anti join only needs to know whether there is a match. Hence, no
     // need to store entries with duplicate keys.
@@ -109,12 +315,61 @@ HashBuild::HashBuild(
         dependentTypes,
         allowDuplicates,
         false, // hasProbedFlag
-        mappedMemory_);
+        mappedMemory_,
+        packTimestamps);
+    if (distinctKeysOnly_) {
+      lookup_ = std::make_unique<HashLookup>(table_->hashers());
+    }
   }
   analyzeKeys_ = table_->hashMode() != BaseHashTable::HashMode::kHash;
+
+  std::vector<TypePtr> keyTypes;
+  keyTypes.reserve(numKeys);
+  for (auto channel : keyChannels_) {
+    keyTypes.push_back(type->childAt(channel));
+  }
+  const auto& config = driverCtx->execCtx->queryCtx()->config();
+  if (config.spillEnabled() && !sharedTable_ &&
+      canSpill(*joinNode, keyTypes)) {
+    spillMemoryThreshold_ = config.joinSpillMemoryThreshold();
+    spillPath_ = config.spillPath();
+    std::vector<std::string> names;
+    names.reserve(type->size());
+    for (auto channel : keyChannels_) {
+      names.push_back(type->nameOf(channel));
+    }
+    for (auto channel : dependentChannels_) {
+      names.push_back(type->nameOf(channel));
+    }
+    keyTypes.insert(
+        keyTypes.end(), dependentTypes.begin(), dependentTypes.end());
+    spillType_ = ROW(std::move(names), std::move(keyTypes));
+    spillFiles_.resize(HashJoinBridge::kNumSpillPartitions);
+  }
+}
+
+// static
+bool HashBuild::canSpill(
+    const core::HashJoinNode& joinNode,
+    const std::vector<TypePtr>& keyTypes) {
+  // Spilled probe rows are joined after all other probe rows, so the join
+  // must not depend on seeing all matches of a build row in one pass.
+  if (!joinNode.isInnerJoin()) {
+    return false;
+  }
+  // Complex type keys hash differently in RowContainer and in vectors.
+  for (auto& type : keyTypes) {
+    if (!type->isPrimitiveType()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void HashBuild::addInput(RowVectorPtr input) {
+  if (!buildsTable_) {
+    return;
+  }
   activeRows_.resize(input->size());
   activeRows_.setAll();
   if (!isRightJoin(joinType_)) {
@@ -131,6 +386,18 @@ void HashBuild::addInput(RowVectorPtr input) {
     }
   }
 
+  if (distinctKeysOnly_) {
+    addDistinctKeys(input);
+    return;
+  }
+
+  if (numSpilledPartitions_ > 0) {
+    spillInput(input);
+    if (!activeRows_.hasSelections()) {
+      return;
+    }
+  }
+
   if (analyzeKeys_ && hashes_.size() < activeRows_.size()) {
     hashes_.resize(activeRows_.size());
   }
@@ -174,6 +441,121 @@ void HashBuild::addInput(RowVectorPtr input) {
       rows->store(*decoders_[i], rowIndex, newRow, i + hashers.size());
     }
   });
+
+  if (spillMemoryThreshold_ != 0 &&
+      rows->allocatedBytes() >
+          std::max(spillMemoryThreshold_, spilledAllocatedBytes_)) {
+    spill();
+  }
+}
+
+void HashBuild::addDistinctKeys(const RowVectorPtr& input) {
+  auto& hashers = lookup_->hashers;
+  // The first batch and batches with keys outside of the ranges of the
+  // value ids let the table decide its hash mode and hash again.
+  bool rehash = !tableProbed_;
+  tableProbed_ = true;
+  for (;;) {
+    lookup_->reset(input->size());
+    auto mode = table_->hashMode();
+    for (auto i = 0; i < hashers.size(); ++i) {
+      auto key = input->loadedChildAt(hashers[i]->channel());
+      if (mode != BaseHashTable::HashMode::kHash) {
+        if (!hashers[i]->computeValueIds(*key, activeRows_, lookup_->hashes)) {
+          rehash = true;
+        }
+      } else {
+        hashers[i]->hash(*key, activeRows_, i > 0, lookup_->hashes);
+      }
+    }
+    if (!rehash) {
+      break;
+    }
+    if (table_->hashMode() != BaseHashTable::HashMode::kHash) {
+      table_->decideHashMode(input->size());
+    }
+    rehash = false;
+  }
+  lookup_->rows.clear();
+  activeRows_.applyToSelected(
+      [&](auto row) { lookup_->rows.push_back(row); });
+  // Inserts the keys that are not yet in the table. The table is rebuilt
+  // with the keys of the other Drivers in prepareJoinTable().
+  table_->groupProbe(*lookup_);
+}
+
+void HashBuild::spillInput(const RowVectorPtr& input) {
+  spillHashes_.resize(input->size());
+  auto& hashers = table_->hashers();
+  std::vector<VectorPtr> children;
+  children.reserve(spillType_->size());
+  for (auto i = 0; i < hashers.size(); ++i) {
+    auto& key = input->loadedChildAt(hashers[i]->channel());
+    hashers[i]->hash(*key, activeRows_, i > 0, spillHashes_);
+    children.push_back(key);
+  }
+  for (auto channel : dependentChannels_) {
+    children.push_back(input->childAt(channel));
+  }
+  // Reorder the columns to match 'spillType_'.
+  auto spillInput = std::make_shared<RowVector>(
+      pool(), spillType_, BufferPtr(nullptr), input->size(), children);
+  spillJoinInput(spillInput, spillHashes_, spillFiles_, activeRows_, pool());
+}
+
+void HashBuild::spill() {
+  if (numSpilledPartitions_ == HashJoinBridge::kNumSpillPartitions) {
+    return;
+  }
+  const auto partition =
+      HashJoinBridge::kNumSpillPartitions - 1 - numSpilledPartitions_;
+  ++numSpilledPartitions_;
+  auto& file = spillFiles_[partition];
+  file = std::make_unique<SpillFile>(
+      spillType_, spillPath_, mappedMemory_, pool());
+
+  constexpr int32_t kBatchSize = 1024;
+  auto rows = table_->rows();
+  const auto numKeys = table_->hashers().size();
+  RowContainerIterator iter;
+  std::vector<char*> batch(kBatchSize);
+  std::vector<char*> partitionRows;
+  partitionRows.reserve(kBatchSize);
+  spillHashes_.resize(kBatchSize);
+  for (;;) {
+    auto numRows = rows->listRows(&iter, kBatchSize, batch.data());
+    if (!numRows) {
+      break;
+    }
+    folly::Range<char**> listed(batch.data(), numRows);
+    for (auto i = 0; i < numKeys; ++i) {
+      rows->hash(i, listed, i > 0, spillHashes_.data());
+    }
+    partitionRows.clear();
+    for (auto i = 0; i < numRows; ++i) {
+      if (HashJoinBridge::spillPartition(spillHashes_[i]) == partition) {
+        partitionRows.push_back(batch[i]);
+      }
+    }
+    if (partitionRows.empty()) {
+      continue;
+    }
+    auto spillRows = std::static_pointer_cast<RowVector>(
+        BaseVector::create(spillType_, partitionRows.size(), pool()));
+    for (auto i = 0; i < spillType_->size(); ++i) {
+      rows->extractColumn(
+          partitionRows.data(),
+          partitionRows.size(),
+          i,
+          spillRows->childAt(i));
+    }
+    file->append(spillRows);
+    // The listed rows are behind 'iter', so erasing these does not affect
+    // the rest of the listing.
+    rows->eraseRows(
+        folly::Range<char**>(partitionRows.data(), partitionRows.size()));
+  }
+  spilledAllocatedBytes_ = rows->allocatedBytes();
 }
 
 void HashBuild::finish() {
@@ -191,10 +573,25 @@ void HashBuild::finish() {
     return;
   }
 
+  auto bridge = operatorCtx_->task()->getHashJoinBridge(
+      operatorCtx_->driverCtx()->splitGroupId, planNodeId());
+  if (!buildsTable_) {
+    // The table of another Task of the query goes to 'bridge' when ready.
+    peers.clear();
+    for (auto& promise : promises) {
+      promise.setValue(true);
+    }
+    stats_.addRuntimeStat("sharedHashTable", 1);
+    sharedTable_->addConsumer(bridge);
+    return;
+  }
+
   std::vector<std::unique_ptr<BaseHashTable>> otherTables;
   otherTables.reserve(peers.size());
+  HashJoinBridge::SpillPartitions spilledPartitions;
 
   if (!antiJoinHasNullKeys_) {
+    std::vector<HashBuild*> builds{this};
     for (auto& peer : peers) {
       auto op = peer->findOperator(planNodeId());
       HashBuild* build = dynamic_cast<HashBuild*>(op);
@@ -203,7 +600,42 @@ void HashBuild::finish() {
         antiJoinHasNullKeys_ = true;
         break;
       }
-      otherTables.push_back(std::move(build->table_));
+      builds.push_back(build);
+    }
+    if (!antiJoinHasNullKeys_) {
+      // All Drivers must spill the same partitions. Since partitions are
+      // spilled in order, all spill as many as the one that spilled most.
+      int32_t numSpilledPartitions = 0;
+      for (auto build : builds) {
+        numSpilledPartitions =
+            std::max(numSpilledPartitions, build->numSpilledPartitions_);
+      }
+      if (numSpilledPartitions > 0) {
+        spilledPartitions.resize(HashJoinBridge::kNumSpillPartitions);
+        uint64_t spilledBytes = 0;
+        int64_t spilledRows = 0;
+        for (auto build : builds) {
+          while (build->numSpilledPartitions_ < numSpilledPartitions) {
+            build->spill();
+          }
+          for (auto partition = 0; partition < build->spillFiles_.size();
+               ++partition) {
+            auto& file = build->spillFiles_[partition];
+            if (file) {
+              file->finishWrite();
+              spilledBytes += file->size();
+              spilledRows += file->numRows();
+              spilledPartitions[partition].push_back(std::move(file));
+            }
+          }
+        }
+        stats_.addRuntimeStat("spilledPartitions", numSpilledPartitions);
+        stats_.addRuntimeStat("spilledBytes", spilledBytes);
+        stats_.addRuntimeStat("spilledRows", spilledRows);
+      }
+      for (auto i = 1; i < builds.size(); ++i) {
+        otherTables.push_back(std::move(builds[i]->table_));
+      }
     }
   }
 
@@ -215,19 +647,214 @@ void HashBuild::finish() {
   }
 
   if (antiJoinHasNullKeys_) {
-    operatorCtx_->task()
-        ->getHashJoinBridge(planNodeId())
-        ->setAntiJoinHasNullKeys();
+    bridge->setAntiJoinHasNullKeys();
   } else {
-    table_->prepareJoinTable(std::move(otherTables));
+    std::vector<RowContainer*> containers{table_->rows()};
+    for (auto& other : otherTables) {
+      containers.push_back(other->rows());
+    }
+    table_->prepareJoinTable(
+        std::move(otherTables), operatorCtx_->task()->queryCtx()->executor());
 
     addRuntimeStats();
 
-    operatorCtx_->task()
-        ->getHashJoinBridge(planNodeId())
-        ->setHashTable(std::move(table_));
+    std::vector<std::shared_ptr<common::Filter>> bloomFilters;
+    std::shared_ptr<common::BigintTuplesUsingBloomFilter> tupleFilter;
+    std::vector<ChannelIndex> tupleFilterKeys;
+    if (spilledPartitions.empty()) {
+      bloomFilters = makeBloomFilters(containers);
+      tupleFilter = makeTupleFilter(containers, tupleFilterKeys);
+    }
+    // In grouped execution, each split group builds a table of its own. A
+    // spilled table has no filters.
+    if ((isInnerJoin(joinType_) || isSemiJoin(joinType_)) &&
+        operatorCtx_->driverCtx()->splitGroupId == kUngroupedGroupId) {
+      operatorCtx_->task()->setJoinBuildFilters(
+          planNodeId(),
+          spilledPartitions.empty()
+              ? makeJoinBuildFilters(bloomFilters)
+              : std::vector<std::shared_ptr<common::Filter>>(
+                    table_->hashers().size()));
+    }
+    bridge->setHashTable(
+        std::move(table_),
+        std::move(spilledPartitions),
+        std::move(bloomFilters),
+        std::move(tupleFilter),
+        std::move(tupleFilterKeys));
+  }
+  if (sharedTable_) {
+    // The result is set, so this returns it without a future.
+    ContinueFuture future(false);
+    sharedTable_->setResult(bridge->tableOrFuture(&future).value());
+  }
+}
+
+namespace {
+bool isIntegerKind(TypeKind kind) {
+  return kind == TypeKind::TINYINT || kind == TypeKind::SMALLINT ||
+      kind == TypeKind::INTEGER || kind == TypeKind::BIGINT;
+}
+
+int64_t integerAt(TypeKind kind, const char* row, int32_t offset) {
+  switch (kind) {
+    case TypeKind::TINYINT:
+      return RowContainer::valueAt<int8_t>(row, offset);
+    case TypeKind::SMALLINT:
+      return RowContainer::valueAt<int16_t>(row, offset);
+    case TypeKind::INTEGER:
+      return RowContainer::valueAt<int32_t>(row, offset);
+    case TypeKind::BIGINT:
+      return RowContainer::valueAt<int64_t>(row, offset);
+    default:
+      VELOX_UNREACHABLE();
   }
 }
+} // namespace
+
+std::vector<std::shared_ptr<common::Filter>> HashBuild::makeBloomFilters(
+    const std::vector<RowContainer*>& containers) {
+  std::vector<std::shared_ptr<common::Filter>> filters;
+  // HashProbe pushes down filters only for inner and semi joins.
+  if (!isInnerJoin(joinType_) && !isSemiJoin(joinType_)) {
+    return filters;
+  }
+  int64_t numRows = 0;
+  for (auto* container : containers) {
+    numRows += container->numRows();
+  }
+  if (numRows == 0 || numRows > kMaxBloomFilterRows) {
+    return filters;
+  }
+
+  const auto& hashers = table_->hashers();
+  // Outside of kHash mode the VectorHashers have seen all keys and make an
+  // exact filter unless there are too many distinct values.
+  bool hashMode = table_->hashMode() == BaseHashTable::HashMode::kHash;
+  filters.resize(hashers.size());
+  std::vector<char*> rows(1024);
+  for (auto i = 0; i < hashers.size(); ++i) {
+    auto kind = hashers[i]->typeKind();
+    if (!isIntegerKind(kind)) {
+      continue;
+    }
+    if (!hashMode && !hashers[i]->distinctOverflow()) {
+      continue;
+    }
+    auto bloomFilter = std::make_shared<BloomFilter<false>>();
+    bloomFilter->reset(numRows);
+    auto min = std::numeric_limits<int64_t>::max();
+    auto max = std::numeric_limits<int64_t>::min();
+    for (auto* container : containers) {
+      // The keys are the leading columns of the join table.
+      auto column = container->columnAt(i);
+      RowContainerIterator iter;
+      while (auto numListed =
+                 container->listRows(&iter, rows.size(), rows.data())) {
+        for (auto j = 0; j < numListed; ++j) {
+          if (RowContainer::isNullAt(
+                  rows[j], column.nullByte(), column.nullMask())) {
+            continue;
+          }
+          auto value = integerAt(kind, rows[j], column.offset());
+          min = std::min(min, value);
+          max = std::max(max, value);
+          bloomFilter->insert(
+              common::BigintValuesUsingBloomFilter::hashValue(value));
+        }
+      }
+    }
+    if (min > max) {
+      continue;
+    }
+    filters[i] = std::make_shared<common::BigintValuesUsingBloomFilter>(
+        min, max, std::move(bloomFilter), false);
+  }
+  return filters;
+}
+
+std::vector<std::shared_ptr<common::Filter>> HashBuild::makeJoinBuildFilters(
+    const std::vector<std::shared_ptr<common::Filter>>& bloomFilters) {
+  const auto& hashers = table_->hashers();
+  std::vector<std::shared_ptr<common::Filter>> filters(hashers.size());
+  bool empty = table_->numDistinct() == 0;
+  bool hashMode = table_->hashMode() == BaseHashTable::HashMode::kHash;
+  for (auto i = 0; i < hashers.size(); ++i) {
+    if (empty) {
+      filters[i] = std::make_shared<common::AlwaysFalse>();
+      continue;
+    }
+    if (!hashMode) {
+      filters[i] = hashers[i]->getFilter(false);
+    }
+    if (!filters[i] && !bloomFilters.empty()) {
+      filters[i] = bloomFilters[i];
+    }
+  }
+  return filters;
+}
+
+std::shared_ptr<common::BigintTuplesUsingBloomFilter>
+HashBuild::makeTupleFilter(
+    const std::vector<RowContainer*>& containers,
+    std::vector<ChannelIndex>& keys) {
+  keys.clear();
+  if (!isInnerJoin(joinType_) && !isSemiJoin(joinType_)) {
+    return nullptr;
+  }
+  int64_t numRows = 0;
+  for (auto* container : containers) {
+    numRows += container->numRows();
+  }
+  if (numRows == 0 || numRows > kMaxBloomFilterRows) {
+    return nullptr;
+  }
+
+  const auto& hashers = table_->hashers();
+  std::vector<TypeKind> kinds;
+  for (auto i = 0; i < hashers.size(); ++i) {
+    if (isIntegerKind(hashers[i]->typeKind())) {
+      keys.push_back(i);
+      kinds.push_back(hashers[i]->typeKind());
+    }
+  }
+  if (keys.size() < 2) {
+    keys.clear();
+    return nullptr;
+  }
+
+  auto bloomFilter = std::make_shared<BloomFilter<false>>();
+  bloomFilter->reset(numRows);
+  std::vector<int64_t> values(keys.size());
+  std::vector<char*> rows(1024);
+  for (auto* container : containers) {
+    std::vector<RowColumn> columns;
+    for (auto key : keys) {
+      columns.push_back(container->columnAt(key));
+    }
+    RowContainerIterator iter;
+    while (auto numListed =
+               container->listRows(&iter, rows.size(), rows.data())) {
+      for (auto j = 0; j < numListed; ++j) {
+        bool hasNull = false;
+        for (auto k = 0; k < keys.size(); ++k) {
+          if (RowContainer::isNullAt(
+                  rows[j], columns[k].nullByte(), columns[k].nullMask())) {
+            hasNull = true;
+            break;
+          }
+          values[k] = integerAt(kinds[k], rows[j], columns[k].offset());
+        }
+        if (!hasNull) {
+          bloomFilter->insert(common::BigintTuplesUsingBloomFilter::hashTuple(
+              values.data(), keys.size()));
+        }
+      }
+    }
+  }
+  return std::make_shared<common::BigintTuplesUsingBloomFilter>(
+      keys.size(), std::move(bloomFilter));
+}
 
 void HashBuild::addRuntimeStats() {
   // Report range sizes and number of distinct values for the join keys.
@@ -243,6 +870,18 @@ void HashBuild::addRuntimeStats() {
       stats_.addRuntimeStat(fmt::format("distinctKey{}", i), asDistinct);
     }
   }
+  // Report the share of free space in variable width data, in percent,
+  // and the compactions spilling has triggered.
+  auto rows = table_->rows();
+  stats_.addRuntimeStat(
+      "stringFragmentationPct",
+      static_cast<int64_t>(100 * rows->stringFragmentation()));
+  if (rows->numStringCompactions()) {
+    stats_.addRuntimeStat(
+        "numStringCompactions", rows->numStringCompactions());
+    stats_.addRuntimeStat(
+        "compactedStringBytes", rows->compactedStringBytes());
+  }
 }
 
 BlockingReason HashBuild::isBlocked(ContinueFuture* future) {
@@ -18,18 +18,52 @@
 #include "velox/exec/HashTable.h"
 #include "velox/exec/JoinBridge.h"
 #include "velox/exec/Operator.h"
+#include "velox/exec/Spill.h"
 #include "velox/exec/VectorHasher.h"
 #include "velox/expression/Expr.h"
 
 namespace facebook::velox::exec {
 
+class SharedHashTable;
+
 // Hands over a hash table from a multi-threaded build pipeline to a
 // multi-threaded probe pipeline. This is owned by shared_ptr by all the build
 // and probe Operator instances concerned. Corresponds to the Presto concept of
 // the same name.
+//
+// If the build side is larger than its memory budget, the build rows are
+// divided into kNumSpillPartitions hash partitions and some of these are
+// spilled to disk. The table then covers only the partitions that stayed in
+// memory and the probe side writes its rows of the spilled partitions to
+// disk. Each pair of spilled build and probe partitions is joined after the
+// probe input is consumed.
 class HashJoinBridge : public JoinBridge {
  public:
-  void setHashTable(std::unique_ptr<BaseHashTable> table);
+  static constexpr int32_t kNumSpillPartitions = 8;
+
+  // Spill files for each of the kNumSpillPartitions partitions. The entry for
+  // a partition that is not spilled is empty.
+  using SpillPartitions = std::vector<std::vector<std::unique_ptr<SpillFile>>>;
+
+  // Returns the spill partition for a row with join key hash 'hash'. Build
+  // and probe use the same function so that matching rows end up in the same
+  // partition. Uses bits that are not used for table bucketing.
+  static int32_t spillPartition(uint64_t hash) {
+    return (hash >> kSpillPartitionShift) & (kNumSpillPartitions - 1);
+  }
+
+  // Sets the table for the in-memory partitions. 'spilledPartitions' has the
+  // build side files of the spilled partitions, if any. 'bloomFilters' has
+  // an entry per join key, see HashBuild::makeBloomFilters(). 'tupleFilter'
+  // is on the keys at 'tupleFilterKeys' together, see
+  // HashBuild::makeTupleFilter().
+  void setHashTable(
+      std::unique_ptr<BaseHashTable> table,
+      SpillPartitions spilledPartitions = {},
+      std::vector<std::shared_ptr<common::Filter>> bloomFilters = {},
+      std::shared_ptr<common::BigintTuplesUsingBloomFilter> tupleFilter =
+          nullptr,
+      std::vector<ChannelIndex> tupleFilterKeys = {});
 
   void setAntiJoinHasNullKeys();
 
@@ -40,15 +74,105 @@ class HashJoinBridge : public JoinBridge {
   struct HashBuildResult {
     std::shared_ptr<BaseHashTable> table;
     bool antiJoinHasNullKeys;
+    // Number of build side partitions that are spilled and not in 'table'.
+    int32_t numSpilledPartitions;
+    // Approximate filters on the join keys for pushdown into the probe
+    // side. Empty or aligned with the keys, with nullptr for a key without
+    // filter.
+    std::vector<std::shared_ptr<common::Filter>> bloomFilters;
+    // Approximate filter on the keys at 'tupleFilterKeys' together. nullptr
+    // if there are fewer than 2 integer keys.
+    std::shared_ptr<common::BigintTuplesUsingBloomFilter> tupleFilter;
+    std::vector<ChannelIndex> tupleFilterKeys;
   };
 
   std::optional<HashBuildResult> tableOrFuture(ContinueFuture* future);
 
+  // Sets the result of the HashBuild of another Task of the same query. The
+  // table is shared with the probes of that Task.
+  void setSharedResult(const HashBuildResult& result);
+
+  // Keeps 'sharedTable' alive as long as 'this', so that the Tasks that
+  // start later find the table of the first Task.
+  void setSharedTable(std::shared_ptr<SharedHashTable> sharedTable);
+
+  // Adds the probe side spill files of a probe Driver. Called by each probe
+  // Driver before it finishes.
+  void addProbeSpillFiles(SpillPartitions files);
+
+  // Moves the build and probe side spill files to 'build' and 'probe'.
+  // Called by the last probe Driver to finish, which then joins the spilled
+  // partitions.
+  void takeSpilledPartitions(SpillPartitions& build, SpillPartitions& probe);
+
  private:
+  static constexpr int32_t kSpillPartitionShift = 40;
+
   std::shared_ptr<BaseHashTable> table_;
   bool antiJoinHasNullKeys_{false};
+  int32_t numSpilledPartitions_{0};
+  std::vector<std::shared_ptr<common::Filter>> bloomFilters_;
+  std::shared_ptr<common::BigintTuplesUsingBloomFilter> tupleFilter_;
+  std::vector<ChannelIndex> tupleFilterKeys_;
+  SpillPartitions buildSpillFiles_;
+  SpillPartitions probeSpillFiles_;
+  std::shared_ptr<SharedHashTable> sharedTable_;
+};
+
+// A join table that is built once for all Tasks of a query on the node,
+// e.g. the build side of a broadcast join. The Task that gets here first
+// builds the table. The other Tasks drop their copy of the build input and
+// get the table of the first Task through their HashJoinBridge. A join that
+// does not set probed flags in the table does not modify it after the
+// build, so the probes of all Tasks can share it.
+class SharedHashTable {
+ public:
+  // Returns true if 'taskId' builds the table. The first Task to ask builds
+  // it.
+  bool isBuilder(const std::string& taskId);
+
+  // Hands 'result' to the bridges added so far and to the ones added later.
+  void setResult(const HashJoinBridge::HashBuildResult& result);
+
+  // Sets the result of 'bridge' when the build is done.
+  void addConsumer(const std::shared_ptr<HashJoinBridge>& bridge);
+
+ private:
+  std::mutex mutex_;
+  std::string builderTaskId_;
+  std::optional<HashJoinBridge::HashBuildResult> result_;
+  // The bridges own 'this', see HashJoinBridge::setSharedTable().
+  std::vector<std::weak_ptr<HashJoinBridge>> consumers_;
+};
+
+// Node-wide map from query and join plan node to SharedHashTable. An entry
+// lives as long as a HashJoinBridge of a Task of the query refers to it.
+class HashTableCache {
+ public:
+  static HashTableCache& instance();
+
+  // Returns the SharedHashTable for the join 'planNodeId' of the query of
+  // 'queryCtx'. The Tasks of a query on the node share the QueryCtx.
+  std::shared_ptr<SharedHashTable> get(
+      const core::QueryCtx* queryCtx,
+      const core::PlanNodeId& planNodeId);
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<SharedHashTable>> tables_;
 };
 
+// Writes the rows of 'input' that are selected in 'rows' and fall into a
+// partition with a non-null entry in 'files' to the file of that partition.
+// 'hashes' has the hash of the join keys for each row of 'input'. Deselects
+// the written rows from 'rows'.
+void spillJoinInput(
+    const RowVectorPtr& input,
+    const raw_vector<uint64_t>& hashes,
+    std::vector<std::unique_ptr<SpillFile>>& files,
+    SelectivityVector& rows,
+    memory::MemoryPool* pool);
+
 // Builds a hash table for use in HashProbe. This is the final
 // Operator in a build side Driver. The build side pipeline has
 // multiple Drivers, each with its own HashBuild. The build finishes
@@ -82,8 +206,53 @@ class HashBuild final : public Operator {
   void close() override {}
 
  private:
+  // Bloom filters are not made for more build side rows than this.
+  static constexpr int64_t kMaxBloomFilterRows = 1 << 24;
+
   void addRuntimeStats();
 
+  // Returns a BigintValuesUsingBloomFilter for each integer join key whose
+  // VectorHasher cannot produce an exact filter and nullptr for the other
+  // keys. 'containers' has the rows of the join table. Returns no filters if
+  // a pushed down filter cannot drop probe rows for the join type.
+  std::vector<std::shared_ptr<common::Filter>> makeBloomFilters(
+      const std::vector<RowContainer*>& containers);
+
+  // Returns the filters on the join keys that HashBuild publishes through
+  // Task::setJoinBuildFilters() for the Tasks that scan the probe side.
+  // These are the exact filters of the VectorHashers, else 'bloomFilters'
+  // from makeBloomFilters(). A filter is nullptr if its key has neither.
+  // All are AlwaysFalse if the build side is empty.
+  std::vector<std::shared_ptr<common::Filter>> makeJoinBuildFilters(
+      const std::vector<std::shared_ptr<common::Filter>>& bloomFilters);
+
+  // Returns a BigintTuplesUsingBloomFilter on the integer join keys together
+  // and sets 'keys' to the indices of these keys. Returns nullptr if there
+  // are fewer than 2 integer keys or under the conditions of
+  // makeBloomFilters().
+  std::shared_ptr<common::BigintTuplesUsingBloomFilter> makeTupleFilter(
+      const std::vector<RowContainer*>& containers,
+      std::vector<ChannelIndex>& keys);
+
+  // Returns true if the keys in 'keyTypes' allow spilling for 'joinNode'.
+  // Rows in the table and in the input vectors must hash identically for
+  // build and probe to agree on the partition of a row.
+  static bool canSpill(
+      const core::HashJoinNode& joinNode,
+      const std::vector<TypePtr>& keyTypes);
+
+  // Moves the rows of the next in-memory partition from 'table_' to a spill
+  // file. Partitions are spilled from last to first.
+  void spill();
+
+  // Writes the rows of 'input' in spilled partitions to their spill files
+  // and removes them from 'activeRows_'.
+  void spillInput(const RowVectorPtr& input);
+
+  // Adds the keys of the active rows of 'input' that are not yet in 'table_'
+  // when 'distinctKeysOnly_' is true.
+  void addDistinctKeys(const RowVectorPtr& input);
+
   const core::JoinType joinType_;
 
   // Container for the rows being accumulated.
@@ -101,6 +270,12 @@ class HashBuild final : public Operator {
   // Holds the areas in RowContainer of 'table_'
   memory::MappedMemory* mappedMemory_;
 
+  // Set if the Tasks of the query on the node share the table. If
+  // 'buildsTable_' is false, another Task builds the table and this drops
+  // its input.
+  std::shared_ptr<SharedHashTable> sharedTable_;
+  bool buildsTable_{true};
+
   // Future for synchronizing with other Drivers of the same pipeline. All build
   // Drivers must be completed before making the hash table.
   ContinueFuture future_{false};
@@ -116,9 +291,42 @@ class HashBuild final : public Operator {
   // Set of active rows during addInput().
   SelectivityVector activeRows_;
 
+  // True if 'table_' holds only the distinct keys, with no dependent
+  // columns and no duplicate rows. The keys are then inserted as they
+  // arrive, like the groups of a distinct aggregation.
+  bool distinctKeysOnly_{false};
+
+  // Lookup for inserting keys when 'distinctKeysOnly_' is true.
+  std::unique_ptr<HashLookup> lookup_;
+  bool tableProbed_{false};
+
   // True if this is a build side of an anti join and has at least one entry
   // with null join keys.
   bool antiJoinHasNullKeys_{false};
+
+  // Bytes of RowContainer memory after which partitions of 'table_' are
+  // spilled. 0 if spilling is disabled.
+  uint64_t spillMemoryThreshold_{0};
+
+  std::string spillPath_;
+
+  // Type of the spilled rows. Same as the rows of 'table_': keys followed by
+  // dependent columns.
+  RowTypePtr spillType_;
+
+  // Number of spilled partitions. These are the last partitions.
+  int32_t numSpilledPartitions_{0};
+
+  // Spill file for each spilled partition, nullptr for the others.
+  std::vector<std::unique_ptr<SpillFile>> spillFiles_;
+
+  // RowContainer memory after the last spill. The rows freed by a spill are
+  // reused before the container grows, so the next spill waits until memory
+  // is above this.
+  uint64_t spilledAllocatedBytes_{0};
+
+  // Partitioning hashes of the input rows.
+  raw_vector<uint64_t> spillHashes_;
 };
 
 } // namespace facebook::velox::exec
@@ -42,9 +42,16 @@ void HashPartitionFunction::partition(
     hashers_[i]->hash(*input.childAt(keyChannels_[i]), rows_, i > 0, hashes_);
   }
 
+  // Maps the hashes to [0, numPartitions_) with multiplies and a shift
+  // instead of a 64 bit division. The result depends on the high bits of
+  // the product. Multiplying by the golden ratio first moves the entropy of
+  // hashes that vary only in the low bits into the high bits.
+  constexpr uint64_t kGoldenRatio = 0x9E3779B97F4A7C15ULL;
   partitions.resize(size);
   for (auto i = 0; i < size; ++i) {
-    partitions[i] = hashes_[i] % numPartitions_;
+    partitions[i] = (static_cast<__uint128_t>(hashes_[i] * kGoldenRatio) *
+                     numPartitions_) >>
+        64;
   }
 }
 } // namespace facebook::velox::exec
@@ -32,6 +32,11 @@ class HashPartitionFunction : public core::PartitionFunction {
   void partition(const RowVector& input, std::vector<uint32_t>& partitions)
       override;
 
+  // Returns the hashes of the keys of the rows of the last partition().
+  const raw_vector<uint64_t>& hashes() const {
+    return hashes_;
+  }
+
  private:
   const int numPartitions_;
   const std::vector<ChannelIndex> keyChannels_;
@@ -18,6 +18,7 @@
 #include "velox/exec/OperatorUtils.h"
 #include "velox/exec/Task.h"
 #include "velox/expression/ControlExpr.h"
+#include "velox/vector/LazyVector.h"
 
 namespace facebook::velox::exec {
 
@@ -166,9 +167,11 @@ BlockingReason HashProbe::isBlocked(ContinueFuture* future) {
     return BlockingReason::kNotBlocked;
   }
 
-  auto hashBuildResult = operatorCtx_->task()
-                             ->getHashJoinBridge(planNodeId())
-                             ->tableOrFuture(future);
+  auto hashBuildResult =
+      operatorCtx_->task()
+          ->getHashJoinBridge(
+              operatorCtx_->driverCtx()->splitGroupId, planNodeId())
+          ->tableOrFuture(future);
   if (!hashBuildResult.has_value()) {
     return BlockingReason::kWaitForJoinBuild;
   }
@@ -179,29 +182,53 @@ BlockingReason HashProbe::isBlocked(ContinueFuture* future) {
     isFinishing_ = true;
   } else {
     table_ = hashBuildResult->table;
-    if (table_->numDistinct() == 0) {
+    numSpilledPartitions_ = hashBuildResult->numSpilledPartitions;
+    if (numSpilledPartitions_ > 0) {
+      // The table does not have the build rows of the spilled partitions.
+      // Hence, the join can neither finish early because the table is empty
+      // nor push down filters made from the table's keys.
+    } else if (table_->numDistinct() == 0) {
       // Build side is empty. Inner, right and semi joins return nothing in this
       // case, hence, we can terminate the pipeline early.
       if (isInnerJoin(joinType_) || isSemiJoin(joinType_) ||
           isRightJoin(joinType_)) {
         isFinishing_ = true;
       }
-    } else if (
-        (isInnerJoin(joinType_) || isSemiJoin(joinType_)) &&
-        table_->hashMode() != BaseHashTable::HashMode::kHash) {
+    } else if (isInnerJoin(joinType_) || isSemiJoin(joinType_)) {
       // Find out whether there are any upstream operators that can accept
       // dynamic filters on all or a subset of the join keys. Setup dynamic
       // filter builders to track join selectivity for these keys and generate
-      // dynamic filters to push down.
+      // dynamic filters to push down. A kHash mode table has no exact filters
+      // and offers only the Bloom filters made by HashBuild.
       const auto& buildHashers = table_->hashers();
+      const auto& bloomFilters = hashBuildResult->bloomFilters;
+      bool hashMode = table_->hashMode() == BaseHashTable::HashMode::kHash;
       auto channels = operatorCtx_->driverCtx()->driver->canPushdownFilters(
           this, keyChannels_);
+      if (hashBuildResult->tupleFilter) {
+        std::vector<ChannelIndex> tupleChannels;
+        for (auto key : hashBuildResult->tupleFilterKeys) {
+          tupleChannels.push_back(keyChannels_[key]);
+        }
+        if (operatorCtx_->driverCtx()->driver->canPushdownMultiColumnFilter(
+                this, tupleChannels)) {
+          tupleFilter_ = hashBuildResult->tupleFilter;
+          tupleFilterChannels_ = std::move(tupleChannels);
+        }
+      }
       dynamicFilterBuilders_.resize(keyChannels_.size());
       for (auto i = 0; i < keyChannels_.size(); i++) {
+        auto bloomFilter = bloomFilters.empty() ? nullptr : bloomFilters[i];
+        if (hashMode && !bloomFilter) {
+          continue;
+        }
         auto it = channels.find(keyChannels_[i]);
         if (it != channels.end()) {
           dynamicFilterBuilders_[i].emplace(DynamicFilterBuilder(
-              *(buildHashers[i].get()), keyChannels_[i], dynamicFilters_));
+              hashMode ? nullptr : buildHashers[i].get(),
+              std::move(bloomFilter),
+              keyChannels_[i],
+              dynamicFilters_));
         }
       }
     }
@@ -214,9 +241,12 @@ void HashProbe::clearDynamicFilters() {
   // The join can be completely replaced with a pushed down
   // filter when the following conditions are met:
   //  * hash table has a single key with unique values,
-  //  * build side has no dependent columns.
+  //  * build side has no dependent columns,
+  //  * the pushed down filter is exact, i.e. not a Bloom filter.
   if (keyChannels_.size() == 1 && !table_->hasDuplicateKeys() &&
-      tableResultProjections_.empty() && !filter_ && !dynamicFilters_.empty()) {
+      tableResultProjections_.empty() && !filter_ && !dynamicFilters_.empty() &&
+      dynamicFilters_.begin()->second->kind() !=
+          common::FilterKind::kBigintValuesUsingBloomFilter) {
     canReplaceWithDynamicFilter_ = true;
   }
 
@@ -232,7 +262,7 @@ void HashProbe::addInput(RowVectorPtr input) {
     return;
   }
 
-  if (table_->numDistinct() == 0) {
+  if (table_->numDistinct() == 0 && numSpilledPartitions_ == 0) {
     // Build side is empty. This state is valid only for anti and left joins.
     VELOX_CHECK(isAntiJoin(joinType_) || isLeftJoin(joinType_));
     return;
@@ -253,6 +283,14 @@ void HashProbe::addInput(RowVectorPtr input) {
   };
 
   activeRows_ = nonNullRows_;
+  if (numSpilledPartitions_ > 0 && !probingSpilledPartitions_) {
+    spillInput();
+    if (table_->numDistinct() == 0) {
+      input_ = nullptr;
+      return;
+    }
+  }
+
   lookup_->hashes.resize(input_->size());
   auto mode = table_->hashMode();
   auto& buildHashers = table_->hashers();
@@ -286,6 +324,9 @@ void HashProbe::addInput(RowVectorPtr input) {
         [&](vector_size_t row) { lookup_->rows.push_back(row); });
   }
   if (lookup_->rows.empty()) {
+    if (tupleFilter_) {
+      updateTupleFilter(input_->size(), 0);
+    }
     if (joinType_ != core::JoinType::kAnti) {
       input_ = nullptr;
     }
@@ -293,9 +334,186 @@ void HashProbe::addInput(RowVectorPtr input) {
   }
   lookup_->hits.resize(lookup_->rows.back() + 1);
   table_->joinProbe(*lookup_);
+  bool hashModeFilters = mode == BaseHashTable::HashMode::kHash &&
+      !dynamicFilterBuilders_.empty();
+  if (hashModeFilters || tupleFilter_) {
+    // The filters on the keys together and, in kHash mode, the dynamic filter
+    // builders count the input and the hits of the whole join.
+    uint64_t numHits = 0;
+    for (auto row : lookup_->rows) {
+      if (lookup_->hits[row]) {
+        ++numHits;
+      }
+    }
+    if (hashModeFilters) {
+      for (auto i = 0; i < keyChannels_.size(); ++i) {
+        if (auto* dynamicFilterBuilder = getDynamicFilterBuilder(i)) {
+          dynamicFilterBuilder->addInput(lookup_->rows.size());
+          dynamicFilterBuilder->addOutput(numHits);
+        }
+      }
+    }
+    if (tupleFilter_) {
+      updateTupleFilter(input_->size(), numHits);
+    }
+  }
   results_.reset(*lookup_);
 }
 
+void HashProbe::updateTupleFilter(uint64_t numIn, uint64_t numOut) {
+  tupleFilterNumIn_ += numIn;
+  tupleFilterNumOut_ += numOut;
+  // Same thresholds as in DynamicFilterBuilder.
+  if (tupleFilterNumIn_ >= 10'000 &&
+      tupleFilterNumOut_ < 0.66 * tupleFilterNumIn_) {
+    multiColumnDynamicFilters_.push_back(
+        {tupleFilterChannels_, std::move(tupleFilter_)});
+    tupleFilter_ = nullptr;
+  }
+}
+
+void HashProbe::spillInput() {
+  if (spillFiles_.empty()) {
+    const auto& config =
+        operatorCtx_->driverCtx()->execCtx->queryCtx()->config();
+    spillFiles_.resize(HashJoinBridge::kNumSpillPartitions);
+    for (auto partition =
+             HashJoinBridge::kNumSpillPartitions - numSpilledPartitions_;
+         partition < HashJoinBridge::kNumSpillPartitions;
+         ++partition) {
+      spillFiles_[partition] = std::make_unique<SpillFile>(
+          std::static_pointer_cast<const RowType>(input_->type()),
+          config.spillPath(),
+          operatorCtx_->mappedMemory(),
+          pool());
+    }
+  }
+  spillHashes_.resize(input_->size());
+  for (auto i = 0; i < keyChannels_.size(); ++i) {
+    hashers_[i]->hash(
+        *input_->loadedChildAt(keyChannels_[i]),
+        activeRows_,
+        i > 0,
+        spillHashes_);
+  }
+  spillJoinInput(input_, spillHashes_, spillFiles_, activeRows_, pool());
+}
+
+std::shared_ptr<BaseHashTable> HashProbe::makeSpilledTable(
+    std::vector<std::unique_ptr<SpillFile>>& files) {
+  // The spilled rows have the layout of the table: keys followed by
+  // dependent columns.
+  const auto& type = files[0]->type();
+  const auto numKeys = keyChannels_.size();
+  std::vector<std::unique_ptr<VectorHasher>> keyHashers;
+  keyHashers.reserve(numKeys);
+  for (ChannelIndex i = 0; i < numKeys; ++i) {
+    keyHashers.push_back(std::make_unique<VectorHasher>(type->childAt(i), i));
+  }
+  std::vector<TypePtr> dependentTypes(
+      type->children().begin() + numKeys, type->children().end());
+  auto table = HashTable<true>::createForJoin(
+      std::move(keyHashers),
+      dependentTypes,
+      true, // allowDuplicates
+      false, // hasProbedFlag
+      operatorCtx_->mappedMemory());
+
+  auto& hashers = table->hashers();
+  auto rows = table->rows();
+  auto nextOffset = rows->nextOffset();
+  bool analyzeKeys = table->hashMode() != BaseHashTable::HashMode::kHash;
+  raw_vector<uint64_t> hashes;
+  SelectivityVector allRows;
+  std::vector<DecodedVector> decoders(dependentTypes.size());
+  for (auto& file : files) {
+    file->setPool(pool());
+    while (auto batch = file->nextBatch()) {
+      allRows.resize(batch->size());
+      allRows.setAll();
+      if (analyzeKeys && hashes.size() < batch->size()) {
+        hashes.resize(batch->size());
+      }
+      for (auto& hasher : hashers) {
+        if (analyzeKeys) {
+          hasher->computeValueIds(
+              *batch->childAt(hasher->channel()), allRows, hashes);
+          analyzeKeys = hasher->mayUseValueIds();
+        } else {
+          hasher->decode(*batch->childAt(hasher->channel()), allRows);
+        }
+      }
+      for (auto i = 0; i < decoders.size(); ++i) {
+        decoders[i].decode(*batch->childAt(i + numKeys), allRows);
+      }
+      for (auto row = 0; row < batch->size(); ++row) {
+        char* newRow = rows->newRow();
+        if (nextOffset) {
+          *reinterpret_cast<char**>(newRow + nextOffset) = nullptr;
+        }
+        for (auto i = 0; i < numKeys; ++i) {
+          rows->store(hashers[i]->decodedVector(), row, newRow, i);
+        }
+        for (auto i = 0; i < decoders.size(); ++i) {
+          rows->store(decoders[i], row, newRow, i + numKeys);
+        }
+      }
+    }
+    file.reset();
+  }
+  files.clear();
+  table->prepareJoinTable({});
+  return table;
+}
+
+bool HashProbe::nextSpilledInput() {
+  for (;;) {
+    if (spillPartition_ >= 0) {
+      auto& files = probeSpillPartitions_[spillPartition_];
+      while (spillFileIndex_ < files.size()) {
+        auto batch = files[spillFileIndex_]->nextBatch();
+        if (!batch) {
+          files[spillFileIndex_++].reset();
+          continue;
+        }
+        addInput(std::move(batch));
+        if (input_) {
+          return true;
+        }
+      }
+    }
+    if (++spillPartition_ == HashJoinBridge::kNumSpillPartitions) {
+      return false;
+    }
+    spillFileIndex_ = 0;
+    auto& buildFiles = buildSpillPartitions_[spillPartition_];
+    auto& probeFiles = probeSpillPartitions_[spillPartition_];
+    if (buildFiles.empty() || probeFiles.empty()) {
+      // The partition is not spilled or one side is empty. An inner join
+      // produces nothing for it.
+      buildFiles.clear();
+      probeFiles.clear();
+      continue;
+    }
+    table_ = makeSpilledTable(buildFiles);
+    if (table_->numDistinct() == 0) {
+      probeFiles.clear();
+    }
+  }
+}
+
+RowVectorPtr HashProbe::getOutputFromSpill() {
+  for (;;) {
+    if (!input_ && !nextSpilledInput()) {
+      probingSpilledPartitions_ = false;
+      return nullptr;
+    }
+    if (auto output = getOutputForInput()) {
+      return output;
+    }
+  }
+}
+
 namespace {
 // Copy values from 'rows' of 'table' according to 'projections' in
 // 'result'. Reuses 'result' children where possible.
@@ -303,14 +521,14 @@ void extractColumns(
     BaseHashTable* table,
     folly::Range<char**> rows,
     folly::Range<const IdentityProjection*> projections,
-    memory::MemoryPool* pool,
+    VectorPool& vectorPool,
     const RowVectorPtr& result) {
   for (auto projection : projections) {
     auto& child = result->childAt(projection.outputChannel);
     // TODO: Consider reuse of complex types.
     if (!child || !BaseVector::isReusableFlatVector(child)) {
-      child = BaseVector::create(
-          result->type()->childAt(projection.outputChannel), rows.size(), pool);
+      child = vectorPool.get(
+          result->type()->childAt(projection.outputChannel), rows.size());
     }
     child->resize(rows.size());
     table->rows()->extractColumn(
@@ -318,6 +536,73 @@ void extractColumns(
   }
 }
 
+template <TypeKind Kind>
+void addHookValues(
+    const BaseVector& values,
+    RowSet rows,
+    ValueHook* hook) {
+  using T = typename TypeTraits<Kind>::NativeType;
+  auto flatValues = values.asUnchecked<FlatVector<T>>();
+  for (auto row : rows) {
+    if (flatValues->isNullAt(row)) {
+      if (hook->acceptsNulls()) {
+        hook->addNull(row);
+      }
+    } else {
+      T value = flatValues->valueAt(row);
+      hook->addValue(row, &value);
+    }
+  }
+}
+
+// Extracts a build side column from the hash table rows of a batch of join
+// output on first use. Positions that are not loaded are left null. Holds a
+// reference to the table so that the rows stay valid after the probe moves
+// on to another table.
+class RowContainerLoader : public VectorLoader {
+ public:
+  RowContainerLoader(
+      std::shared_ptr<BaseHashTable> table,
+      std::shared_ptr<const std::vector<char*>> rows,
+      int32_t column,
+      TypePtr type,
+      memory::MemoryPool* pool)
+      : table_(std::move(table)),
+        rows_(std::move(rows)),
+        column_(column),
+        type_(std::move(type)),
+        pool_(pool) {}
+
+ protected:
+  void loadInternal(RowSet rows, ValueHook* hook, VectorPtr* result) override {
+    auto numRows = rows.back() + 1;
+    const char* const* extractRows = rows_->data();
+    std::vector<char*> selectedRows;
+    if (static_cast<vector_size_t>(rows.size()) != numRows) {
+      selectedRows.resize(numRows, nullptr);
+      for (auto row : rows) {
+        selectedRows[row] = (*rows_)[row];
+      }
+      extractRows = selectedRows.data();
+    }
+    auto values = BaseVector::create(type_, numRows, pool_);
+    table_->rows()->extractColumn(extractRows, numRows, column_, values);
+    if (!hook) {
+      *result = std::move(values);
+      return;
+    }
+    VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+        addHookValues, type_->kind(), *values, rows, hook);
+  }
+
+ private:
+  const std::shared_ptr<BaseHashTable> table_;
+  const std::shared_ptr<const std::vector<char*>> rows_;
+  const int32_t column_;
+  const TypePtr type_;
+  memory::MemoryPool* const pool_;
+};
+
 folly::Range<vector_size_t*> initializeRowNumberMapping(
     BufferPtr& mapping,
     vector_size_t size,
@@ -331,6 +616,18 @@ folly::Range<vector_size_t*> initializeRowNumberMapping(
 } // namespace
 
 void HashProbe::prepareOutput(vector_size_t size) {
+  if (output_ && !output_.unique()) {
+    output_ = nullptr;
+  } else if (output_) {
+    // The lazy build side columns of the previous batch can neither be
+    // reused nor made writable.
+    for (const auto& projection : tableResultProjections_) {
+      auto& child = output_->childAt(projection.outputChannel);
+      if (child && child->encoding() == VectorEncoding::Simple::LAZY) {
+        child = nullptr;
+      }
+    }
+  }
   VectorPtr outputAsBase = std::move(output_);
   BaseVector::ensureWritable(
       SelectivityVector::empty(), outputType_, pool(), &outputAsBase);
@@ -359,13 +656,21 @@ void HashProbe::fillOutput(vector_size_t size) {
           BaseVector::createNullConstant(
               outputType_->childAt(projection.outputChannel), size, pool());
     }
-  } else {
-    extractColumns(
-        table_.get(),
-        folly::Range<char**>(outputRows_.data(), size),
-        tableResultProjections_,
-        pool(),
-        output_);
+  } else if (!tableResultProjections_.empty()) {
+    // The build side columns are extracted from the table only for the
+    // rows that are accessed downstream, e.g. after a filter or a limit.
+    auto rows = std::make_shared<const std::vector<char*>>(
+        outputRows_.begin(), outputRows_.begin() + size);
+    for (const auto& projection : tableResultProjections_) {
+      const auto& type = outputType_->childAt(projection.outputChannel);
+      output_->childAt(projection.outputChannel) =
+          std::make_shared<LazyVector>(
+              pool(),
+              type,
+              size,
+              std::make_unique<RowContainerLoader>(
+                  table_, rows, projection.inputChannel, type, pool()));
+    }
   }
 }
 
@@ -396,20 +701,26 @@ RowVectorPtr HashProbe::getNonMatchingOutputForRightJoin() {
       table_.get(),
       folly::Range<char**>(outputRows_.data(), numOut),
       tableResultProjections_,
-      pool(),
+      operatorCtx_->vectorPool(),
       output_);
   return output_;
 }
 
 RowVectorPtr HashProbe::getOutput() {
   clearIdentityProjectedOutput();
+  if (probingSpilledPartitions_) {
+    return getOutputFromSpill();
+  }
   if (!input_) {
     if (isFinishing_ && isRightJoin(joinType_)) {
       return getNonMatchingOutputForRightJoin();
     }
     return nullptr;
   }
+  return getOutputForInput();
+}
 
+RowVectorPtr HashProbe::getOutputForInput() {
   const auto inputSize = input_->size();
 
   if (replacedWithDynamicFilter_) {
@@ -441,6 +752,16 @@ RowVectorPtr HashProbe::getOutput() {
       // rows, including ones with null join keys.
       std::iota(mapping.begin(), mapping.end(), 0);
       numOut = inputSize;
+    } else if (isSemiJoin(joinType_) && !filter_) {
+      // The probe stopped at the first match of each row. A semi join
+      // without a filter returns each row with a match once, so the
+      // matches need not be listed.
+      for (auto i = 0; i < inputSize; i++) {
+        if (activeRows_.isValid(i) && lookup_->hits[i]) {
+          mapping[numOut] = i;
+          ++numOut;
+        }
+      }
     } else if (isAntiJoin(joinType_)) {
       // When build side is not empty, anti join returns probe rows with no
       // nulls in the join key and no match in the build side.
@@ -521,7 +842,7 @@ void HashProbe::fillFilterInput(vector_size_t size) {
       table_.get(),
       folly::Range<char**>(outputRows_.data(), size),
       filterBuildInputs_,
-      pool(),
+      operatorCtx_->vectorPool(),
       filterInput_);
 }
 
@@ -572,6 +893,40 @@ int32_t HashProbe::evalFilter(int32_t numRows) {
 
 void HashProbe::finish() {
   Operator::finish();
+  if (numSpilledPartitions_ > 0) {
+    auto bridge = operatorCtx_->task()->getHashJoinBridge(
+        operatorCtx_->driverCtx()->splitGroupId, planNodeId());
+    HashJoinBridge::SpillPartitions files(HashJoinBridge::kNumSpillPartitions);
+    for (auto partition = 0; partition < spillFiles_.size(); ++partition) {
+      if (auto& file = spillFiles_[partition]) {
+        file->finishWrite();
+        stats_.addRuntimeStat("spilledBytes", file->size());
+        stats_.addRuntimeStat("spilledRows", file->numRows());
+        files[partition].push_back(std::move(file));
+      }
+    }
+    spillFiles_.clear();
+    bridge->addProbeSpillFiles(std::move(files));
+
+    std::vector<VeloxPromise<bool>> promises;
+    std::vector<std::shared_ptr<Driver>> peers;
+    // The last Driver to hit HashProbe::finish joins the spilled partitions
+    // of all Drivers.
+    ContinueFuture future{false};
+    if (!operatorCtx_->task()->allPeersFinished(
+            planNodeId(), operatorCtx_->driver(), &future, promises, peers)) {
+      return;
+    }
+    bridge->takeSpilledPartitions(
+        buildSpillPartitions_, probeSpillPartitions_);
+    for (auto& partition : probeSpillPartitions_) {
+      for (auto& file : partition) {
+        file->setPool(pool());
+      }
+    }
+    probingSpilledPartitions_ = true;
+    return;
+  }
   if (isRightJoin(joinType_)) {
     std::vector<VeloxPromise<bool>> promises;
     std::vector<std::shared_ptr<Driver>> peers;
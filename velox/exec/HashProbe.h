@@ -59,6 +59,26 @@ class HashProbe : public Operator {
   // Populate output columns.
   void fillOutput(vector_size_t size);
 
+  // Produces the next batch of output for 'input_'.
+  RowVectorPtr getOutputForInput();
+
+  // Writes the rows of 'input_' in spilled build side partitions to probe
+  // side spill files and removes them from 'activeRows_'.
+  void spillInput();
+
+  // Produces the output of joining the spilled build and probe side
+  // partitions. Called in the last Driver to finish.
+  RowVectorPtr getOutputFromSpill();
+
+  // Sets 'input_' to the next batch of spilled probe rows and probes it
+  // against the table of its partition. Returns false if there are no
+  // spilled rows left.
+  bool nextSpilledInput();
+
+  // Makes a join table from the spilled build side rows in 'files'.
+  std::shared_ptr<BaseHashTable> makeSpilledTable(
+      std::vector<std::unique_ptr<SpillFile>>& files);
+
   // Populate output columns with build-side rows that didn't match join
   // condition.
   RowVectorPtr getNonMatchingOutputForRightJoin();
@@ -81,15 +101,20 @@ class HashProbe : public Operator {
   std::vector<ChannelIndex> keyChannels_;
 
   // Tracks selectivity of a given VectorHasher from the build side and creates
-  // a filter to push down upstream if the hasher is somewhat selective.
+  // a filter to push down upstream if the hasher is somewhat selective. Falls
+  // back to 'bloomFilter', if any, when the hasher has no exact filter.
+  // 'buildHasher' is nullptr if the table is in kHash mode. The counts then
+  // refer to the whole join instead of the one key.
   class DynamicFilterBuilder {
    public:
     DynamicFilterBuilder(
-        const VectorHasher& buildHasher,
+        const VectorHasher* buildHasher,
+        std::shared_ptr<common::Filter> bloomFilter,
         ChannelIndex channel,
         std::unordered_map<ChannelIndex, std::shared_ptr<common::Filter>>&
             dynamicFilters)
         : buildHasher_{buildHasher},
+          bloomFilter_{std::move(bloomFilter)},
           channel_{channel},
           dynamicFilters_{dynamicFilters} {}
 
@@ -107,7 +132,14 @@ class HashProbe : public Operator {
       // Add filter if VectorHasher is somewhat selective, e.g. dropped at least
       // 1/3 of the rows. Make sure we have seen at least 10K rows.
       if (isActive_ && numIn_ >= 10'000 && numOut_ < 0.66 * numIn_) {
-        if (auto filter = buildHasher_.getFilter(false)) {
+        std::shared_ptr<common::Filter> filter;
+        if (buildHasher_) {
+          filter = buildHasher_->getFilter(false);
+        }
+        if (!filter) {
+          filter = bloomFilter_;
+        }
+        if (filter) {
           dynamicFilters_.emplace(channel_, std::move(filter));
         }
         isActive_ = false;
@@ -115,7 +147,8 @@ class HashProbe : public Operator {
     }
 
    private:
-    const VectorHasher& buildHasher_;
+    const VectorHasher* const buildHasher_;
+    const std::shared_ptr<common::Filter> bloomFilter_;
     const ChannelIndex channel_;
     std::unordered_map<ChannelIndex, std::shared_ptr<common::Filter>>&
         dynamicFilters_;
@@ -128,6 +161,17 @@ class HashProbe : public Operator {
   // entry if the driver can push down a filter on the corresponding join key.
   std::vector<std::optional<DynamicFilterBuilder>> dynamicFilterBuilders_;
 
+  // Counts the input and output of the join for 'tupleFilter_' and pushes
+  // the filter down once the join is selective enough.
+  void updateTupleFilter(uint64_t numIn, uint64_t numOut);
+
+  // Approximate filter on the keys at 'tupleFilterChannels_' together. Set if
+  // it can be pushed down and reset after it is.
+  std::shared_ptr<common::BigintTuplesUsingBloomFilter> tupleFilter_;
+  std::vector<ChannelIndex> tupleFilterChannels_;
+  uint64_t tupleFilterNumIn_{0};
+  uint64_t tupleFilterNumOut_{0};
+
   // True if the join can become a no-op starting with the next batch of input.
   bool canReplaceWithDynamicFilter_{false};
 
@@ -235,6 +279,31 @@ class HashProbe : public Operator {
   // Input rows with a hash match. This is a subset of rows with no nulls in the
   // join keys and a superset of rows that have a match on the build side.
   SelectivityVector activeRows_;
+
+  // Number of build side partitions that are spilled and not in 'table_'.
+  // These are the last partitions.
+  int32_t numSpilledPartitions_{0};
+
+  // Probe side spill file for each spilled partition.
+  std::vector<std::unique_ptr<SpillFile>> spillFiles_;
+
+  // Partitioning hashes of the input rows.
+  raw_vector<uint64_t> spillHashes_;
+
+  // True if this is the last HashProbe to finish and joins the spilled
+  // partitions.
+  bool probingSpilledPartitions_{false};
+
+  // Spilled build and probe side files for each partition. Set in the last
+  // HashProbe to finish.
+  HashJoinBridge::SpillPartitions buildSpillPartitions_;
+  HashJoinBridge::SpillPartitions probeSpillPartitions_;
+
+  // The spilled partition being joined.
+  int32_t spillPartition_{-1};
+
+  // Index of the probe file of 'spillPartition_' being read.
+  int32_t spillFileIndex_{0};
 };
 
 } // namespace facebook::velox::exec
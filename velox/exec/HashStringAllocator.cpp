@@ -76,6 +76,31 @@ void HashStringAllocator::prepareRead(const Header* begin, ByteStream& stream) {
   stream.resetInput(std::move(ranges));
 }
 
+HashStringAllocator::Position HashStringAllocator::copyAllocation(
+    const Header* header) {
+  int64_t numBytes = 0;
+  for (auto source = const_cast<Header*>(header);;
+       source = getNextContinued(source)) {
+    numBytes +=
+        source->size() - (source->isContinued() ? sizeof(void*) : 0);
+    if (!source->isContinued()) {
+      break;
+    }
+  }
+  ByteStream stream(this, false, false);
+  auto position = newWrite(stream, numBytes);
+  for (auto source = const_cast<Header*>(header);;
+       source = getNextContinued(source)) {
+    auto size = source->size() - (source->isContinued() ? sizeof(void*) : 0);
+    stream.appendStringPiece(folly::StringPiece(source->begin(), size));
+    if (!source->isContinued()) {
+      break;
+    }
+  }
+  finishWrite(stream, 0);
+  return position;
+}
+
 HashStringAllocator::Position HashStringAllocator::newWrite(
     ByteStream& stream,
     int32_t preferredSize) {
@@ -165,6 +165,13 @@ class HashStringAllocator : public StreamArena {
     *string = StringView(reinterpret_cast<char*>(position.position), numBytes);
   }
 
+  // Copies the allocation of 'header' and its possible continuations
+  // into a possibly multipart allocation in 'this'. 'header' may belong
+  // to another HashStringAllocator. Returns the position of the first
+  // byte of the copy. Used for moving live data out of a fragmented
+  // HashStringAllocator.
+  Position copyAllocation(const Header* FOLLY_NONNULL header);
+
   // Returns a contiguous view on 'view', where 'view' comes from
   // copyMultipart(). Uses 'storage' to own a possible temporary
   // copy. Making a temporary copy only happens for non-contiguous
@@ -238,6 +245,19 @@ class HashStringAllocator : public StreamArena {
     return minFree;
   }
 
+  // Returns the sum of the sizes of free blocks, excluding headers.
+  uint64_t freeBytes() const {
+    return freeBytes_;
+  }
+
+  // Returns the fraction of the footprint of 'this' that is in free
+  // blocks. A value close to 1 after many frees means that the live data
+  // would fit in a small fraction of the footprint.
+  double fragmentation() const {
+    auto retained = retainedSize();
+    return retained == 0 ? 0 : static_cast<double>(freeBytes_) / retained;
+  }
+
   // Frees all memory associated with 'this' and leaves 'this' ready for reuse.
   void clear() {
     numFree_ = 0;
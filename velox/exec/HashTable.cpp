@@ -20,6 +20,12 @@
 #include "velox/exec/ContainerRowSerde.h"
 #include "velox/vector/VectorTypeUtils.h"
 
+#include <folly/Executor.h>
+#include <folly/ScopeGuard.h>
+
+#include <condition_variable>
+#include <mutex>
+
 namespace facebook::velox::exec {
 
 template <TypeKind Kind>
@@ -39,7 +45,8 @@ HashTable<ignoreNullKeys>::HashTable(
     bool allowDuplicates,
     bool isJoinBuild,
     bool hasProbedFlag,
-    memory::MappedMemory* mappedMemory)
+    memory::MappedMemory* mappedMemory,
+    bool packTimestamps)
     : BaseHashTable(std::move(hashers)),
       aggregates_(aggregates),
       isJoinBuild_(isJoinBuild) {
@@ -60,7 +67,8 @@ HashTable<ignoreNullKeys>::HashTable(
       hasProbedFlag,
       hashMode_ != HashMode::kHash,
       mappedMemory,
-      ContainerRowSerde::instance());
+      ContainerRowSerde::instance(),
+      packTimestamps);
   nextOffset_ = rows_->nextOffset();
 }
 
@@ -92,6 +100,12 @@ class ProbeState {
     return row_;
   }
 
+  // The row of the first tag match after firstProbe(), nullptr if no
+  // tag matched.
+  char* FOLLY_NULLABLE firstHit() const {
+    return group_;
+  }
+
   // Use one instruction to load 16 tags
   // Use another instruction to make 16 copies of the tag being searched for
   inline void
@@ -349,8 +363,32 @@ inline uint64_t mixNormalizedKey(uint64_t k, uint8_t bits) {
   auto h = (k ^ ((k >> 32))) * prime1;
   return h + (h >> bits) * prime2 + (h >> (2 * bits)) * prime3;
 }
+
+// Number of probes a join probe starts before resolving the first of
+// them. Group by probes prefetch the tags this many probes ahead.
+constexpr int32_t kProbeBatch = 64;
+
+// Largest number of distinct keys a hash table is pre-sized for from a
+// cardinality hint.
+constexpr uint64_t kMaxNumDistinctHint = 16 << 20;
 } // namespace
 
+template <bool ignoreNullKeys>
+void HashTable<ignoreNullKeys>::prefetchProbes(
+    const HashLookup& lookup,
+    int32_t begin,
+    int32_t end) {
+  auto rows = lookup.rows.data();
+  auto hashes = lookup.hashes.data();
+  for (auto i = begin; i < end; ++i) {
+    auto tagIndex = ProbeState::tagsByteOffset(hashes[rows[i]], sizeMask_);
+    __builtin_prefetch(tags_ + tagIndex);
+    // The row pointers of a group of 16 tags take 2 cache lines.
+    __builtin_prefetch(table_ + tagIndex);
+    __builtin_prefetch(table_ + tagIndex + 8);
+  }
+}
+
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::groupProbe(HashLookup& lookup) {
   if (hashMode_ == HashMode::kArray) {
@@ -380,7 +418,14 @@ void HashTable<ignoreNullKeys>::groupProbe(HashLookup& lookup) {
   int32_t probeIndex = 0;
   int32_t numProbes = lookup.rows.size();
   auto rows = lookup.rows.data();
+  prefetchProbes(lookup, 0, std::min(numProbes, kProbeBatch));
   for (; probeIndex + 4 <= numProbes; probeIndex += 4) {
+    // Inserts change the tags, so the probes can't be started long before
+    // they are resolved. The tags of later probes are only prefetched.
+    if (probeIndex + kProbeBatch + 4 <= numProbes) {
+      prefetchProbes(
+          lookup, probeIndex + kProbeBatch, probeIndex + kProbeBatch + 4);
+    }
     int32_t row = rows[probeIndex];
     state1.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
     row = rows[probeIndex + 1];
@@ -478,36 +523,62 @@ void HashTable<ignoreNullKeys>::joinProbe(HashLookup& lookup) {
       hashes[row] = mixNormalizedKey(hash, sizeBits_);
     }
   }
-  int32_t probeIndex = 0;
   int32_t numProbes = lookup.rows.size();
   const vector_size_t* rows = lookup.rows.data();
-  ProbeState state1;
-  ProbeState state2;
-  ProbeState state3;
-  ProbeState state4;
-  for (; probeIndex + 4 <= numProbes; probeIndex += 4) {
-    int32_t row = rows[probeIndex];
-    state1.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
-    row = rows[probeIndex + 1];
-    state2.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
-    row = rows[probeIndex + 2];
-    state3.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
-    row = rows[probeIndex + 3];
-    state4.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
-    state1.firstProbe(table_, 0);
-    state2.firstProbe(table_, 0);
-    state3.firstProbe(table_, 0);
-    state4.firstProbe(table_, 0);
-    fullProbe<true>(lookup, state1, false);
-    fullProbe<true>(lookup, state2, false);
-    fullProbe<true>(lookup, state3, false);
-    fullProbe<true>(lookup, state4, false);
-  }
-  for (; probeIndex < numProbes; ++probeIndex) {
-    int32_t row = rows[probeIndex];
-    state1.preProbe(tags_, sizeMask_, lookup.hashes[row], row);
-    state1.firstProbe(table_, 0);
-    fullProbe<true>(lookup, state1, false);
+  const bool normalizedKeys = hashMode_ == HashMode::kNormalizedKey;
+  const int32_t firstKey =
+      normalizedKeys ? -static_cast<int32_t>(sizeof(normalized_key_t)) : 0;
+  // The probes go in batches. The tags and row pointers of a batch are
+  // prefetched while the previous batch is resolved. The tags of all probes
+  // of a batch are compared and the rows of their first matches are
+  // prefetched before any key is compared.
+  ProbeState states[kProbeBatch];
+  alignas(simd::kPadding) char* firstHits[kProbeBatch];
+  prefetchProbes(lookup, 0, std::min(numProbes, kProbeBatch));
+  for (auto start = 0; start < numProbes; start += kProbeBatch) {
+    const int32_t batchSize = std::min(kProbeBatch, numProbes - start);
+    for (auto i = 0; i < batchSize; ++i) {
+      int32_t row = rows[start + i];
+      states[i].preProbe(tags_, sizeMask_, lookup.hashes[row], row);
+      states[i].firstProbe(table_, firstKey);
+      firstHits[i] = states[i].firstHit();
+    }
+    auto nextStart = start + batchSize;
+    prefetchProbes(
+        lookup, nextStart, std::min(numProbes, nextStart + kProbeBatch));
+    int32_t i = 0;
+    if (normalizedKeys && process::hasAvx2()) {
+      // Compares the normalized keys of 4 first matches at a time. A probe
+      // whose first match is not its key goes to fullProbe().
+      using V64 = simd::Vectors<int64_t>;
+      static_assert(sizeof(char*) == sizeof(int64_t));
+      auto allZero = V64::setAll(0);
+      auto keyOffset = V64::setAll(sizeof(normalized_key_t));
+      for (; i + V64::VSize <= batchSize; i += V64::VSize) {
+        auto groups = V64::load(firstHits + i);
+        uint8_t matches = 0;
+        if (!V64::compareResult(V64::compareEq(groups, allZero))) {
+          // The normalized key is in the word below the row.
+          auto tableKeys = V64::gather64<1>(
+              nullptr, _mm256_sub_epi64(groups, keyOffset));
+          auto probeKeys = V64::gather32(
+              lookup.normalizedKeys.data(),
+              V64::loadGather32Indices(rows + start + i));
+          matches = V64::compareBitMask(
+              V64::compareResult(V64::compareEq(tableKeys, probeKeys)));
+        }
+        for (auto lane = 0; lane < V64::VSize; ++lane) {
+          if (matches & (1 << lane)) {
+            lookup.hits[states[i + lane].row()] = firstHits[i + lane];
+          } else {
+            fullProbe<true>(lookup, states[i + lane], false);
+          }
+        }
+      }
+    }
+    for (; i < batchSize; ++i) {
+      fullProbe<true>(lookup, states[i], false);
+    }
   }
 }
 
@@ -565,6 +636,17 @@ void HashTable<ignoreNullKeys>::checkSize(int32_t numNew) {
     // hashing.
     auto newSize = std::max(
         (uint64_t)2048, bits::nextPowerOfTwo(numNew * 2 + numDistinct_));
+    if (joinRowsCounted_) {
+      // prepareJoinTable() counted all the build rows. The table is made
+      // once for them at the F14 load factor and is not grown after.
+      newSize = std::max(
+          (uint64_t)2048, bits::nextPowerOfTwo(numDistinct_ * 8 / 7 + 1));
+    } else if (numDistinctHint_) {
+      // Size for the expected cardinality at the F14 load factor. The hint
+      // is an estimate, so it is capped to bound the upfront allocation.
+      auto hint = std::min<uint64_t>(numDistinctHint_, kMaxNumDistinctHint);
+      newSize = std::max(newSize, bits::nextPowerOfTwo(hint * 8 / 7 + 1));
+    }
     allocateTables(newSize);
     if (numDistinct_) {
       rehash();
@@ -596,7 +678,8 @@ bool HashTable<ignoreNullKeys>::insertBatch(
               column.offset(),
               column.nullByte(),
               ignoreNullKeys ? 0 : column.nullMask(),
-              hashes)) {
+              hashes,
+              column.packedTimestamp())) {
         // Must reconsider 'hashMode_' and start over.
         return false;
       }
@@ -761,6 +844,13 @@ void HashTable<ignoreNullKeys>::insertForJoin(
 
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::rehash() {
+  // Minimum number of rows for running the join build in parallel.
+  constexpr int64_t kMinParallelBuildRows = 100'000;
+  if (buildExecutor_ && isJoinBuild_ && hashMode_ == HashMode::kHash &&
+      !otherTables_.empty() && numDistinct_ >= kMinParallelBuildRows) {
+    parallelJoinBuild();
+    return;
+  }
   constexpr int32_t kHashBatchSize = 1024;
   // @lint-ignore CLANGTIDY
   raw_vector<uint64_t> hashes;
@@ -785,6 +875,190 @@ void HashTable<ignoreNullKeys>::rehash() {
   }
 }
 
+namespace {
+// Runs 'func' for each number in [0, numTasks) on 'executor' and in the
+// calling thread. Returns after all calls are done. The calling thread takes
+// part so that this completes even if no executor thread is free. Rethrows
+// the first exception thrown by 'func'.
+void runParallel(
+    folly::Executor* executor,
+    int32_t numTasks,
+    std::function<void(int32_t)> func) {
+  struct State {
+    std::function<void(int32_t)> func;
+    int32_t numTasks;
+    std::atomic<int32_t> nextTask{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    int32_t numDone{0};
+    std::exception_ptr error;
+
+    // Runs tasks until none are left. May be called after the caller of
+    // runParallel has returned, in which case there is nothing to run.
+    void run() {
+      for (;;) {
+        auto task = nextTask++;
+        if (task >= numTasks) {
+          return;
+        }
+        std::exception_ptr taskError;
+        try {
+          func(task);
+        } catch (...) {
+          taskError = std::current_exception();
+        }
+        std::lock_guard<std::mutex> l(mutex);
+        if (taskError && !error) {
+          error = taskError;
+        }
+        if (++numDone == numTasks) {
+          done.notify_all();
+        }
+      }
+    }
+  };
+  auto state = std::make_shared<State>();
+  state->func = std::move(func);
+  state->numTasks = numTasks;
+  for (auto i = 1; i < numTasks; ++i) {
+    executor->add([state]() { state->run(); });
+  }
+  state->run();
+  std::unique_lock<std::mutex> l(state->mutex);
+  state->done.wait(l, [&]() { return state->numDone == numTasks; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+} // namespace
+
+template <bool ignoreNullKeys>
+void HashTable<ignoreNullKeys>::parallelJoinBuild() {
+  constexpr int32_t kHashBatchSize = 1024;
+  const int32_t numTables = otherTables_.size() + 1;
+  // Slices are a power of two and each covers at least a few cache lines of
+  // tags.
+  const int32_t numSliceBits = std::min<int32_t>(
+      __builtin_ctzll(bits::nextPowerOfTwo(numTables)),
+      std::max<int32_t>(0, sizeBits_ - 10));
+  const int32_t numSlices = 1 << numSliceBits;
+  const int64_t sliceSize = size_ >> numSliceBits;
+  auto tableAt = [&](int32_t i) -> HashTable<ignoreNullKeys>* {
+    return i == 0 ? this : otherTables_[i - 1].get();
+  };
+
+  // Rows and their hashes for each table and slice.
+  struct SliceRows {
+    std::vector<char*> rows;
+    std::vector<uint64_t> hashes;
+  };
+  std::vector<std::vector<SliceRows>> tableRows(numTables);
+  runParallel(buildExecutor_, numTables, [&](int32_t i) {
+    auto& slices = tableRows[i];
+    slices.resize(numSlices);
+    auto rows = tableAt(i)->rows();
+    raw_vector<uint64_t> hashes;
+    hashes.resize(kHashBatchSize);
+    char* groups[kHashBatchSize];
+    RowContainerIterator iterator;
+    for (;;) {
+      auto numGroups = rows->listRows(&iterator, kHashBatchSize, groups);
+      if (!numGroups) {
+        break;
+      }
+      for (auto key = 0; key < hashers_.size(); ++key) {
+        rows->hash(
+            key,
+            folly::Range<char**>(groups, numGroups),
+            key > 0,
+            hashes.data());
+      }
+      for (auto row = 0; row < numGroups; ++row) {
+        auto slice =
+            ProbeState::tagsByteOffset(hashes[row], sizeMask_) / sliceSize;
+        slices[slice].rows.push_back(groups[row]);
+        slices[slice].hashes.push_back(hashes[row]);
+      }
+    }
+  });
+
+  std::vector<SliceRows> overflows(numSlices);
+  std::vector<char> sliceHasDuplicates(numSlices, false);
+  runParallel(buildExecutor_, numSlices, [&](int32_t slice) {
+    const int64_t begin = slice * sliceSize;
+    const int64_t end = begin + sliceSize;
+    bool hasDuplicates = false;
+    auto& overflow = overflows[slice];
+    for (auto& slices : tableRows) {
+      auto& sliceRows = slices[slice];
+      for (auto i = 0; i < sliceRows.rows.size(); ++i) {
+        if (!insertForJoinInSlice(
+                sliceRows.rows[i],
+                sliceRows.hashes[i],
+                begin,
+                end,
+                hasDuplicates)) {
+          overflow.rows.push_back(sliceRows.rows[i]);
+          overflow.hashes.push_back(sliceRows.hashes[i]);
+        }
+      }
+      // Free the memory as soon as the rows are in the table.
+      sliceRows = SliceRows();
+    }
+    sliceHasDuplicates[slice] = hasDuplicates;
+  });
+
+  for (auto slice = 0; slice < numSlices; ++slice) {
+    hasDuplicates_ |= sliceHasDuplicates[slice];
+    auto& overflow = overflows[slice];
+    if (!overflow.rows.empty()) {
+      insertForJoin(
+          overflow.rows.data(), overflow.hashes.data(), overflow.rows.size());
+    }
+  }
+}
+
+template <bool ignoreNullKeys>
+bool HashTable<ignoreNullKeys>::insertForJoinInSlice(
+    char* row,
+    uint64_t hash,
+    int64_t begin,
+    int64_t end,
+    bool& hasDuplicates) {
+  // The table is freshly allocated, so there are no tombstones.
+  auto tagIndex = ProbeState::tagsByteOffset(hash, sizeMask_);
+  auto wantedTags = _mm_set1_epi8(hashTag(hash));
+  for (;;) {
+    auto tagsInTable = loadTags(tags_, tagIndex);
+    MaskType hits = _mm_movemask_epi8(_mm_cmpeq_epi8(tagsInTable, wantedTags)) &
+        ProbeState::kFullMask;
+    while (hits) {
+      auto hit = bits::getAndClearLastSetBit(hits);
+      auto existing = table_[tagIndex + hit];
+      if (compareKeys(existing, row)) {
+        if (nextOffset_) {
+          nextRow(row) = nextRow(existing);
+          nextRow(existing) = row;
+          hasDuplicates = true;
+        }
+        return true;
+      }
+    }
+    MaskType empty =
+        _mm_movemask_epi8(_mm_cmpeq_epi8(tagsInTable, ProbeState::kEmptyGroup)) &
+        ProbeState::kFullMask;
+    if (empty) {
+      storeRowPointer(
+          tagIndex + bits::getAndClearLastSetBit(empty), hash, row);
+      return true;
+    }
+    tagIndex += sizeof(TagVector);
+    if (tagIndex >= end) {
+      return false;
+    }
+  }
+}
+
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::setHashMode(HashMode mode, int32_t numNew) {
   VELOX_CHECK(hashMode_ != HashMode::kHash);
@@ -840,7 +1114,8 @@ bool HashTable<ignoreNullKeys>::analyze() {
           numGroups,
           column.offset(),
           ignoreNullKeys ? 0 : column.nullByte(),
-          ignoreNullKeys ? 0 : column.nullMask());
+          ignoreNullKeys ? 0 : column.nullMask(),
+          column.packedTimestamp());
     }
   } while (numGroups > 0);
   return true;
@@ -971,13 +1246,18 @@ void HashTable<ignoreNullKeys>::decideHashMode(int32_t numNew) {
     setHashMode(HashMode::kArray, numNew);
     return;
   }
-  if (hashers_.size() == 1 && distinctsWithReserve > 10000) {
+  if (!isJoinBuild_ && hashers_.size() == 1 && distinctsWithReserve > 10000) {
     // A single part group by that does not become an array does not
     // make sense as a normalized key unless it is very
     // small.
     setHashMode(HashMode::kHash, numNew);
     return;
   }
+  // Sparse keys with few distinct values are remapped to the ordinals
+  // of their distinct values. A join build gets no new keys after the
+  // build, so even a single key with up to VectorHasher::kMaxDistinct
+  // values makes an array: a probe is one lookup in the hasher's
+  // distinct values and one load from the array, with no collisions.
   if (distinctsWithReserve < kArrayHashMaxSize) {
     useRange.clear();
     size_ = setHasherMode(hashers_, useRange, rangeSizes, distinctSizes);
@@ -1026,7 +1306,12 @@ bool mayUseValueIds(const BaseHashTable& table) {
 
 template <bool ignoreNullKeys>
 void HashTable<ignoreNullKeys>::prepareJoinTable(
-    std::vector<std::unique_ptr<BaseHashTable>> tables) {
+    std::vector<std::unique_ptr<BaseHashTable>> tables,
+    folly::Executor* executor) {
+  buildExecutor_ = executor;
+  SCOPE_EXIT {
+    buildExecutor_ = nullptr;
+  };
   otherTables_.reserve(tables.size());
   for (auto& table : tables) {
     otherTables_.emplace_back(std::unique_ptr<HashTable<ignoreNullKeys>>(
@@ -1059,6 +1344,12 @@ void HashTable<ignoreNullKeys>::prepareJoinTable(
   for (auto& other : otherTables_) {
     numDistinct_ += other->rows()->numRows();
   }
+  joinRowsCounted_ = true;
+  if (table_) {
+    // The distinct keys were inserted with groupProbe() during the build.
+    // The table is made again with the rows of all the tables.
+    allocateTables(0);
+  }
   if (!useValueIds) {
     if (hashMode_ != HashMode::kHash) {
       setHashMode(HashMode::kHash, 0);
@@ -1154,7 +1445,8 @@ void HashTable<ignoreNullKeys>::erase(folly::Range<char**> rows) {
               column.offset(),
               column.nullByte(),
               ignoreNullKeys ? 0 : column.nullMask(),
-              hashes)) {
+              hashes,
+              column.packedTimestamp())) {
         VELOX_FAIL("Value ids in erase must exist for all keys");
       }
     }
@@ -123,8 +123,11 @@ class BaseHashTable {
       uint64_t maxBytes,
       char** rows) = 0;
 
+  /// Combines 'tables' into 'this' for use in a hash join probe. If
+  /// 'executor' is given, the merge of large tables runs in parallel on it.
   virtual void prepareJoinTable(
-      std::vector<std::unique_ptr<BaseHashTable>> tables) = 0;
+      std::vector<std::unique_ptr<BaseHashTable>> tables,
+      folly::Executor* executor = nullptr) = 0;
 
   /// Returns the memory footprint in bytes for any data structures
   /// owned by 'this'.
@@ -138,6 +141,11 @@ class BaseHashTable {
   /// side. This is used for sizing the internal hash table.
   virtual uint64_t numDistinct() const = 0;
 
+  /// Sets the expected number of distinct keys, e.g. an estimate from the
+  /// plan. The table is sized for this many keys at its first allocation
+  /// instead of growing by repeated rehashing.
+  virtual void setNumDistinctHint(uint64_t numDistinct) = 0;
+
   /// Returns true if the hash table contains rows with duplicate keys.
   virtual bool hasDuplicateKeys() const = 0;
 
@@ -222,7 +230,9 @@ class HashTable : public BaseHashTable {
   // second occurrences of a key are to be silently ignored or will
   // not occur. In this case the row does not need a link to the next
   // match. 'hasProbedFlag' adds an extra bit in every row for tracking rows
-  // that matches join condition for right and full outer joins.
+  // that matches join condition for right and full outer joins. A partial
+  // aggregation uses the same bit to flag the recently updated groups.
+  // 'packTimestamps' stores timestamps in 8 bytes, see RowContainer.
   HashTable(
       std::vector<std::unique_ptr<VectorHasher>>&& hashers,
       const std::vector<std::unique_ptr<Aggregate>>& aggregates,
@@ -230,20 +240,24 @@ class HashTable : public BaseHashTable {
       bool allowDuplicates,
       bool isJoinBuild,
       bool hasProbedFlag,
-      memory::MappedMemory* memory);
+      memory::MappedMemory* memory,
+      bool packTimestamps = false);
 
   static std::unique_ptr<HashTable> createForAggregation(
       std::vector<std::unique_ptr<VectorHasher>>&& hashers,
       const std::vector<std::unique_ptr<Aggregate>>& aggregates,
-      memory::MappedMemory* memory) {
+      memory::MappedMemory* memory,
+      bool hasProbedFlag = false,
+      bool packTimestamps = false) {
     return std::make_unique<HashTable>(
         std::move(hashers),
         aggregates,
         std::vector<TypePtr>{},
         false, // allowDuplicates
         false, // isJoinBuild
-        false, // hasProbedFlag
-        memory);
+        hasProbedFlag,
+        memory,
+        packTimestamps);
   }
 
   static std::unique_ptr<HashTable> createForJoin(
@@ -251,7 +265,8 @@ class HashTable : public BaseHashTable {
       const std::vector<TypePtr>& dependentTypes,
       bool allowDuplicates,
       bool hasProbedFlag,
-      memory::MappedMemory* memory) {
+      memory::MappedMemory* memory,
+      bool packTimestamps = false) {
     static const std::vector<std::unique_ptr<Aggregate>> kNoAggregates;
     return std::make_unique<HashTable>(
         std::move(hashers),
@@ -260,7 +275,8 @@ class HashTable : public BaseHashTable {
         allowDuplicates,
         true, // isJoinBuild
         hasProbedFlag,
-        memory);
+        memory,
+        packTimestamps);
   }
 
   virtual ~HashTable() override {
@@ -298,6 +314,10 @@ class HashTable : public BaseHashTable {
     return numDistinct_;
   }
 
+  void setNumDistinctHint(uint64_t numDistinct) override {
+    numDistinctHint_ = numDistinct;
+  }
+
   bool hasDuplicateKeys() const override {
     return hasDuplicates_;
   }
@@ -320,8 +340,16 @@ class HashTable : public BaseHashTable {
   // tables are filled, they are combined into one top level table
   // with prepareJoinTable. This then takes ownership of all the data
   // and VectorHashers and decides the hash mode and representation.
+  // In kHash mode, the rows of multiple tables are inserted in parallel on
+  // 'executor' if it is given. The table is divided into slices by hash
+  // range and each slice is filled by one thread. A build that keeps only
+  // distinct keys inserts them with groupProbe() as they arrive. The table
+  // of 'this' is then made again together with the other tables. The rows
+  // of all the tables are counted first, so the table is allocated once at
+  // its final size and filled without rehashing.
   void prepareJoinTable(
-      std::vector<std::unique_ptr<BaseHashTable>> tables) override;
+      std::vector<std::unique_ptr<BaseHashTable>> tables,
+      folly::Executor* executor = nullptr) override;
 
   std::string toString() override;
 
@@ -354,6 +382,24 @@ class HashTable : public BaseHashTable {
       const std::vector<uint64_t>& distinctSizes);
 
   void rehash();
+
+  // Inserts the rows of 'this' and 'otherTables_' on 'buildExecutor_'.
+  // Hashing is parallel over the tables, inserting is parallel over slices
+  // of the hash table. Rows whose probe sequence would cross into the next
+  // slice are inserted at the end by the calling thread.
+  void parallelJoinBuild();
+
+  // Inserts 'row' with 'hash' into a kHash mode join table if this can be
+  // done without leaving the slice of tags between 'begin' and 'end'.
+  // Returns false if the row was not inserted. Sets 'hasDuplicates' if
+  // 'row' is added to an existing entry.
+  bool insertForJoinInSlice(
+      char* row,
+      uint64_t hash,
+      int64_t begin,
+      int64_t end,
+      bool& hasDuplicates);
+
   void initializeNewGroups(HashLookup& lookup);
   void storeKeys(HashLookup& lookup, vector_size_t row);
 
@@ -393,6 +439,10 @@ class HashTable : public BaseHashTable {
   template <bool isJoin>
   void fullProbe(HashLookup& lookup, ProbeState& state, bool extraCheck);
 
+  // Issues prefetches for the tag groups and row pointer slots of the
+  // probes at positions [begin, end) of 'lookup.rows'.
+  void prefetchProbes(const HashLookup& lookup, int32_t begin, int32_t end);
+
   // Adds a row to a hash join table in kArray hash mode. Returns true
   // if a new entry was made and false if the row was added to an
   // existing set of rows with the same key.
@@ -430,10 +480,18 @@ class HashTable : public BaseHashTable {
   int64_t size_ = 0;
   int64_t sizeMask_ = 0;
   int64_t numDistinct_ = 0;
+  // Expected number of distinct keys, 0 if unknown. See setNumDistinctHint().
+  uint64_t numDistinctHint_ = 0;
+  // True after prepareJoinTable() has set 'numDistinct_' to the number of
+  // rows of all the build tables. checkSize() then sizes the table exactly.
+  bool joinRowsCounted_ = false;
   HashMode hashMode_ = HashMode::kArray;
   // Owns the memory of multiple build side hash join tables that are
   // combined into a single probe hash table.
   std::vector<std::unique_ptr<HashTable<ignoreNullKeys>>> otherTables_;
+
+  // Executor for parallelJoinBuild(). Set only inside prepareJoinTable().
+  folly::Executor* buildExecutor_ = nullptr;
 };
 
 } // namespace facebook::velox::exec
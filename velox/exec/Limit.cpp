@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/exec/Limit.h"
+#include "velox/exec/Task.h"
 
 namespace facebook::velox::exec {
 Limit::Limit(
@@ -46,6 +47,24 @@ void Limit::addInput(RowVectorPtr input) {
   input_ = input;
 }
 
+bool Limit::hasLazyChildren() const {
+  for (const auto& child : input_->children()) {
+    if (child && isLazyNotLoaded(*child)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Limit::finishSourceEarly() {
+  // A partial Limit feeds a final Limit, which gets enough rows from this
+  // one alone. A final Limit runs in a single Driver.
+  auto scan = operatorCtx_->driver()->streamingScanSource(this);
+  if (scan) {
+    operatorCtx_->task()->finishSourceEarly(scan->planNodeId());
+  }
+}
+
 RowVectorPtr Limit::getOutput() {
   if (input_ == nullptr || (remainingOffset_ == 0 && remainingLimit_ == 0)) {
     return nullptr;
@@ -63,22 +82,32 @@ RowVectorPtr Limit::getOutput() {
     // Return a subset of input_ rows.
     auto outputSize = std::min(inputSize - remainingOffset_, remainingLimit_);
 
-    BufferPtr indices = allocateIndices(outputSize, pool());
-    auto rawIndices = indices->asMutable<vector_size_t>();
-    std::iota(rawIndices, rawIndices + outputSize, remainingOffset_);
-
-    auto output = fillOutput(outputSize, indices);
+    // The rows are contiguous. Slicing shares the buffers of the input.
+    // Columns that are not loaded yet are wrapped in a dictionary instead
+    // so that only the returned rows get loaded.
+    RowVectorPtr output;
+    if (hasLazyChildren()) {
+      BufferPtr indices = allocateIndices(outputSize, pool());
+      auto rawIndices = indices->asMutable<vector_size_t>();
+      std::iota(rawIndices, rawIndices + outputSize, remainingOffset_);
+      output = fillOutput(outputSize, indices);
+    } else {
+      output = std::static_pointer_cast<RowVector>(
+          input_->slice(remainingOffset_, outputSize));
+    }
     remainingOffset_ = 0;
     remainingLimit_ -= outputSize;
     input_ = nullptr;
     if (remainingLimit_ == 0) {
       isFinishing_ = true;
+      finishSourceEarly();
     }
     return output;
   }
 
   if (remainingLimit_ <= inputSize) {
     isFinishing_ = true;
+    finishSourceEarly();
   }
 
   if (remainingLimit_ >= inputSize) {
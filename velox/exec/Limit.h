@@ -35,6 +35,13 @@ class Limit : public Operator {
   }
 
  private:
+  // True if a column of 'input_' is a LazyVector that is not loaded.
+  bool hasLazyChildren() const;
+
+  // Stops the TableScan that streams to 'this' in all Drivers of the
+  // pipeline, since 'this' needs no more rows.
+  void finishSourceEarly();
+
   int32_t remainingOffset_;
   int32_t remainingLimit_;
 };
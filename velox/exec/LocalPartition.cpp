@@ -57,28 +57,35 @@ void LocalExchangeMemoryManager::decreaseMemoryUsage(int64_t removed) {
 }
 
 void LocalExchangeSource::addProducer() {
-  queue_.withWLock([&](auto& /*queue*/) {
-    VELOX_CHECK(!noMoreProducers_, "addProducer called after noMoreProducers");
-    ++pendingProducers_;
-  });
+  std::lock_guard<std::mutex> l(mutex_);
+  VELOX_CHECK(!noMoreProducers_, "addProducer called after noMoreProducers");
+  ++pendingProducers_;
+}
+
+std::vector<VeloxPromise<bool>>
+LocalExchangeSource::takeConsumerPromisesLocked() {
+  numWaitingConsumers_ = 0;
+  return std::move(consumerPromises_);
 }
 
 void LocalExchangeSource::noMoreProducers() {
   std::vector<VeloxPromise<bool>> consumerPromises;
   std::vector<VeloxPromise<bool>> producerPromises;
-  queue_.withWLock([&](auto& queue) {
+  {
+    std::lock_guard<std::mutex> l(mutex_);
     VELOX_CHECK(!noMoreProducers_, "noMoreProducers can be called only once");
     noMoreProducers_ = true;
     if (pendingProducers_ == 0) {
       // No more data will be produced.
-      consumerPromises = std::move(consumerPromises_);
+      allProducersDone_ = true;
+      consumerPromises = takeConsumerPromisesLocked();
 
-      if (queue.empty()) {
+      if (queue_.empty()) {
         // All data has been consumed.
         producerPromises = std::move(producerPromises_);
       }
     }
-  });
+  }
   notify(consumerPromises);
   notify(producerPromises);
 }
@@ -88,12 +95,20 @@ BlockingReason LocalExchangeSource::enqueue(
     ContinueFuture* future) {
   auto inputBytes = input->retainedSize();
 
-  std::vector<VeloxPromise<bool>> consumerPromises;
-  queue_.withWLock([&](auto& queue) {
-    queue.push(std::move(input));
-    consumerPromises = std::move(consumerPromises_);
-  });
-  notify(consumerPromises);
+  queue_.enqueue(std::move(input));
+  // Orders the enqueue before reading 'numWaitingConsumers_'. Pairs with
+  // the fence in next(), so that either the consumer finds the data or the
+  // producer finds the consumer waiting.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (numWaitingConsumers_.load(std::memory_order_relaxed) > 0) {
+    // Wakes all waiting consumers at once.
+    std::vector<VeloxPromise<bool>> consumerPromises;
+    {
+      std::lock_guard<std::mutex> l(mutex_);
+      consumerPromises = takeConsumerPromisesLocked();
+    }
+    notify(consumerPromises);
+  }
 
   if (memoryManager_->increaseMemoryUsage(future, inputBytes)) {
     return BlockingReason::kWaitForConsumer;
@@ -105,29 +120,48 @@ BlockingReason LocalExchangeSource::enqueue(
 void LocalExchangeSource::noMoreData() {
   std::vector<VeloxPromise<bool>> consumerPromises;
   std::vector<VeloxPromise<bool>> producerPromises;
-  queue_.withWLock([&](auto queue) {
+  {
+    std::lock_guard<std::mutex> l(mutex_);
     VELOX_CHECK_GT(pendingProducers_, 0);
     --pendingProducers_;
-    if (noMoreProducers_ && pendingProducers_ == 0) {
-      consumerPromises = std::move(consumerPromises_);
-      if (queue.empty()) {
+    if (allProducersDoneLocked()) {
+      allProducersDone_ = true;
+      consumerPromises = takeConsumerPromisesLocked();
+      if (queue_.empty()) {
         producerPromises = std::move(producerPromises_);
       }
     }
-  });
+  }
   notify(consumerPromises);
   notify(producerPromises);
 }
 
+void LocalExchangeSource::maybeNotifyProducers() {
+  std::vector<VeloxPromise<bool>> producerPromises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (queue_.empty()) {
+      producerPromises = std::move(producerPromises_);
+    }
+  }
+  notify(producerPromises);
+}
+
 BlockingReason LocalExchangeSource::next(
     ContinueFuture* future,
-    memory::MemoryPool* pool,
+    memory::MemoryPool* /*pool*/,
     RowVectorPtr* data) {
-  std::vector<VeloxPromise<bool>> producerPromises;
-  auto blockingReason = queue_.withWLock([&](auto& queue) {
-    *data = nullptr;
-    if (queue.empty()) {
-      if (noMoreProducers_ && pendingProducers_ == 0) {
+  *data = nullptr;
+  if (!queue_.try_dequeue(*data)) {
+    std::lock_guard<std::mutex> l(mutex_);
+    ++numWaitingConsumers_;
+    // Pairs with the fence in enqueue().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // The producers enqueue before they finish under 'mutex_', so all their
+    // data is visible here if they are done.
+    if (!queue_.try_dequeue(*data)) {
+      if (allProducersDoneLocked()) {
+        --numWaitingConsumers_;
         return BlockingReason::kNotBlocked;
       }
 
@@ -136,33 +170,28 @@ BlockingReason LocalExchangeSource::next(
 
       return BlockingReason::kWaitForExchange;
     }
+    --numWaitingConsumers_;
+  }
 
-    *data = queue.front();
-    queue.pop();
-
-    memoryManager_->decreaseMemoryUsage((*data)->retainedSize());
+  memoryManager_->decreaseMemoryUsage((*data)->retainedSize());
 
-    if (noMoreProducers_ && pendingProducers_ == 0 && queue.empty()) {
-      producerPromises = std::move(producerPromises_);
-    }
+  if (allProducersDone_ && queue_.empty()) {
+    maybeNotifyProducers();
+  }
 
-    return BlockingReason::kNotBlocked;
-  });
-  notify(producerPromises);
-  return blockingReason;
+  return BlockingReason::kNotBlocked;
 }
 
 BlockingReason LocalExchangeSource::isFinished(ContinueFuture* future) {
-  return queue_.withWLock([&](auto& queue) {
-    if (noMoreProducers_ && pendingProducers_ == 0 && queue.empty()) {
-      return BlockingReason::kNotBlocked;
-    }
+  std::lock_guard<std::mutex> l(mutex_);
+  if (allProducersDoneLocked() && queue_.empty()) {
+    return BlockingReason::kNotBlocked;
+  }
 
-    producerPromises_.emplace_back("LocalExchangeSource::isFinished");
-    *future = producerPromises_.back().getSemiFuture();
+  producerPromises_.emplace_back("LocalExchangeSource::isFinished");
+  *future = producerPromises_.back().getSemiFuture();
 
-    return BlockingReason::kWaitForConsumer;
-  });
+  return BlockingReason::kWaitForConsumer;
 }
 
 LocalExchangeSourceOperator::LocalExchangeSourceOperator(
@@ -178,8 +207,10 @@ LocalExchangeSourceOperator::LocalExchangeSourceOperator(
           planNodeId,
           "LocalExchangeSource"),
       partition_{partition},
-      source_{
-          operatorCtx_->task()->getLocalExchangeSource(planNodeId, partition)} {
+      source_{operatorCtx_->task()->getLocalExchangeSource(
+          operatorCtx_->driverCtx()->splitGroupId,
+          planNodeId,
+          partition)} {
 }
 
 BlockingReason LocalExchangeSourceOperator::isBlocked(ContinueFuture* future) {
@@ -216,17 +247,31 @@ LocalPartition::LocalPartition(
           operatorId,
           planNode->id(),
           "LocalPartition"),
-      localExchangeSources_{ctx->task->getLocalExchangeSources(planNode->id())},
+      localExchangeSources_{ctx->task->getLocalExchangeSources(
+          ctx->splitGroupId,
+          planNode->id())},
       numPartitions_{localExchangeSources_.size()},
+      scaleWriters_{planNode->scaleWriters()},
+      writerMinBytes_(ctx->execCtx->queryCtx()
+                          ->config()
+                          .scaleWriterMinBytesPerWriter()),
       partitionFunction_(
-          numPartitions_ == 1
+          numPartitions_ == 1 || scaleWriters_
               ? nullptr
               : planNode->partitionFunctionFactory()(numPartitions_)),
       outputChannels_{calculateOutputChannels(
           planNode->inputType(),
           planNode->outputType())},
+      coalesce_{!scaleWriters_ && numPartitions_ > 1 &&
+                ctx->execCtx->queryCtx()
+                    ->config()
+                    .localExchangeCoalesceEnabled()},
+      outputBatchSize_(static_cast<vector_size_t>(
+          ctx->execCtx->queryCtx()->config().preferredOutputBatchSize())),
+      coalesced_(coalesce_ ? numPartitions_ : 0),
       blockingReasons_{numPartitions_} {
-  VELOX_CHECK(numPartitions_ == 1 || partitionFunction_ != nullptr);
+  VELOX_CHECK(
+      numPartitions_ == 1 || scaleWriters_ || partitionFunction_ != nullptr);
 
   for (auto& source : localExchangeSources_) {
     source->addProducer();
@@ -294,6 +339,51 @@ wrapChildren(const RowVectorPtr& input, vector_size_t size, BufferPtr indices) {
 }
 } // namespace
 
+int LocalPartition::nextWriter() {
+  auto memoryManager = localExchangeSources_[0]->memoryManager();
+  if (numWriters_ < numPartitions_ &&
+      processedBytes_ >= numWriters_ * writerMinBytes_ &&
+      memoryManager->bufferedBytes() > memoryManager->maxBufferSize() / 2) {
+    ++numWriters_;
+    stats_.addRuntimeStat("scaledWriters", 1);
+  }
+  auto writer = nextWriter_;
+  nextWriter_ = (nextWriter_ + 1) % numWriters_;
+  return writer;
+}
+
+void LocalPartition::enqueue(int partition, RowVectorPtr data) {
+  ContinueFuture future{false};
+  auto reason = localExchangeSources_[partition]->enqueue(data, &future);
+  if (reason != BlockingReason::kNotBlocked) {
+    if (numBlockedPartitions_ == blockingReasons_.size()) {
+      // finish() can block on flushing the coalesced data of each partition
+      // in addition to the blocking of the last input.
+      blockingReasons_.emplace_back();
+      futures_.emplace_back(false);
+    }
+    blockingReasons_[numBlockedPartitions_] = reason;
+    futures_[numBlockedPartitions_] = std::move(future);
+    ++numBlockedPartitions_;
+  }
+}
+
+void LocalPartition::appendCoalesced(int partition, const RowVectorPtr& data) {
+  auto& coalesced = coalesced_[partition];
+  if (!coalesced) {
+    coalesced = std::static_pointer_cast<RowVector>(
+        BaseVector::create(outputType_, 0, pool()));
+  }
+  auto offset = coalesced->size();
+  auto numRows = data->size();
+  coalesced->resize(offset + numRows);
+  for (auto i = 0; i < outputType_->size(); ++i) {
+    auto& child = coalesced->childAt(i);
+    child->resize(offset + numRows);
+    child->copy(data->childAt(i).get(), offset, 0, numRows);
+  }
+}
+
 void LocalPartition::addInput(RowVectorPtr input) {
   stats_.outputBytes += input->retainedSize();
   stats_.outputPositions += input->size();
@@ -309,9 +399,11 @@ void LocalPartition::addInput(RowVectorPtr input) {
     input_ = project(input, outputType_, outputChannels_);
   }
 
-  if (numPartitions_ == 1) {
+  if (numPartitions_ == 1 || scaleWriters_) {
+    auto partition = numPartitions_ == 1 ? 0 : nextWriter();
+    processedBytes_ += input_->retainedSize();
     blockingReasons_[0] =
-        localExchangeSources_[0]->enqueue(input_, &futures_[0]);
+        localExchangeSources_[partition]->enqueue(input_, &futures_[0]);
     if (blockingReasons_[0] != BlockingReason::kNotBlocked) {
       numBlockedPartitions_ = 1;
     }
@@ -325,6 +417,12 @@ void LocalPartition::addInput(RowVectorPtr input) {
     std::vector<vector_size_t> maxIndex(numPartitions_, 0);
     for (auto i = 0; i < numInput; ++i) {
       auto partition = partitions_[i];
+      if (partition == core::PartitionFunction::kAllPartitions) {
+        for (auto j = 0; j < numPartitions_; ++j) {
+          rawIndices[j][maxIndex[j]++] = i;
+        }
+        continue;
+      }
       rawIndices[partition][maxIndex[partition]] = i;
       ++maxIndex[partition];
     }
@@ -339,13 +437,15 @@ void LocalPartition::addInput(RowVectorPtr input) {
       auto partitionData =
           wrapChildren(input_, partitionSize, std::move(indexBuffers[i]));
 
-      ContinueFuture future{false};
-      auto reason = localExchangeSources_[i]->enqueue(partitionData, &future);
-      if (reason != BlockingReason::kNotBlocked) {
-        blockingReasons_[numBlockedPartitions_] = reason;
-        futures_[numBlockedPartitions_] = std::move(future);
-        ++numBlockedPartitions_;
+      if (coalesce_ && (partitionSize < outputBatchSize_ || coalesced_[i])) {
+        appendCoalesced(i, partitionData);
+        if (coalesced_[i]->size() < outputBatchSize_) {
+          continue;
+        }
+        stats_.addRuntimeStat("coalescedBatches", 1);
+        partitionData = std::move(coalesced_[i]);
       }
+      enqueue(i, std::move(partitionData));
     }
   }
 }
@@ -371,6 +471,12 @@ BlockingReason LocalPartition::isBlocked(ContinueFuture* future) {
 
 void LocalPartition::finish() {
   Operator::finish();
+  for (auto i = 0; i < coalesced_.size(); ++i) {
+    if (coalesced_[i]) {
+      stats_.addRuntimeStat("coalescedBatches", 1);
+      enqueue(i, std::move(coalesced_[i]));
+    }
+  }
   for (const auto& source : localExchangeSources_) {
     source->noMoreData();
   }
@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <folly/concurrency/UnboundedQueue.h>
 #include "velox/exec/Operator.h"
 #include "velox/exec/VectorHasher.h"
 
@@ -33,6 +34,15 @@ class LocalExchangeMemoryManager {
 
   void decreaseMemoryUsage(int64_t removed);
 
+  int64_t maxBufferSize() const {
+    return maxBufferSize_;
+  }
+
+  int64_t bufferedBytes() {
+    std::lock_guard<std::mutex> l(mutex_);
+    return bufferedBytes_;
+  }
+
  private:
   const int64_t maxBufferSize_;
   std::mutex mutex_;
@@ -55,6 +65,10 @@ class LocalExchangeSource {
     return fmt::format("LocalExchangeSource({})", partition_);
   }
 
+  LocalExchangeMemoryManager* memoryManager() const {
+    return memoryManager_;
+  }
+
   void addProducer();
 
   void noMoreProducers();
@@ -86,17 +100,37 @@ class LocalExchangeSource {
   BlockingReason isFinished(ContinueFuture* future);
 
   void close() {
-    queue_.withWLock([](auto& queue) {
-      while (!queue.empty()) {
-        queue.pop();
-      }
-    });
+    RowVectorPtr data;
+    while (queue_.try_dequeue(data)) {
+    }
   }
 
  private:
+  // Returns the consumer promises to notify and resets the count of waiting
+  // consumers. Must be called under 'mutex_'.
+  std::vector<VeloxPromise<bool>> takeConsumerPromisesLocked();
+
+  // Notifies the waiting producers if all data has been fetched.
+  void maybeNotifyProducers();
+
+  // True if no more data will be produced. Must be called under 'mutex_'.
+  bool allProducersDoneLocked() const {
+    return noMoreProducers_ && pendingProducers_ == 0;
+  }
+
   LocalExchangeMemoryManager* memoryManager_;
   const int partition_;
-  folly::Synchronized<std::queue<RowVectorPtr>> queue_;
+  // Producers add and consumers take data without locks. The total size of
+  // the data is bounded by 'memoryManager_', which blocks the producers.
+  folly::UMPMCQueue<RowVectorPtr, false> queue_;
+  // The size of 'consumerPromises_'. A producer takes 'mutex_' to notify the
+  // consumers only if this is not 0, so that producers do not contend on
+  // 'mutex_' while consumers keep up.
+  std::atomic<int32_t> numWaitingConsumers_{0};
+  // Set when allProducersDoneLocked() becomes true.
+  std::atomic<bool> allProducersDone_{false};
+  // Serializes the promises and the producer counts below.
+  std::mutex mutex_;
   // Satisfied when data becomes available or all producers report that they
   // finished producing, e.g. queue_ is not empty or noMoreProducers_ is true
   // and pendingProducers_ is zero.
@@ -136,7 +170,14 @@ class LocalExchangeSourceOperator : public SourceOperator {
 };
 
 /// Hash partitions the data using specified keys. The number of partitions is
-/// determined by the number of LocalExchangeSources(s) found in the task.
+/// determined by the number of LocalExchangeSources(s) found in the task. If
+/// QueryConfig::kLocalExchangeCoalesceEnabled is set, the slices of the input
+/// for a partition that are smaller than preferred_output_batch_size are
+/// copied together into batches of that size before they are enqueued. In
+/// scale writers mode, sends whole batches round-robin to the first
+/// 'numWriters_' partitions and adds a writer when the buffered data exceeds
+/// half of the local exchange memory limit, i.e. the writers do not keep up,
+/// and each writer got at least 'writerMinBytes_' on average.
 class LocalPartition : public Operator {
  public:
   LocalPartition(
@@ -172,12 +213,33 @@ class LocalPartition : public Operator {
   }
 
  private:
+  // Returns the partition for the next batch in scale writers mode.
+  int nextWriter();
+
+  // Enqueues 'data' for 'partition' and records the blocking, if any.
+  void enqueue(int partition, RowVectorPtr data);
+
+  // Copies 'data' to the end of 'coalesced_[partition]'.
+  void appendCoalesced(int partition, const RowVectorPtr& data);
+
   const std::vector<std::shared_ptr<LocalExchangeSource>> localExchangeSources_;
   const size_t numPartitions_;
+  const bool scaleWriters_;
+  const int64_t writerMinBytes_;
   std::unique_ptr<core::PartitionFunction> partitionFunction_;
   // Empty if column order in the output is exactly the same as in input.
   const std::vector<ChannelIndex> outputChannels_;
 
+  const bool coalesce_;
+  const vector_size_t outputBatchSize_;
+  // Small slices of the input per partition, if 'coalesce_'.
+  std::vector<RowVectorPtr> coalesced_;
+
+  // Scale writers state.
+  uint32_t numWriters_{1};
+  uint32_t nextWriter_{0};
+  int64_t processedBytes_{0};
+
   uint32_t numBlockedPartitions_{0};
   std::vector<BlockingReason> blockingReasons_;
   std::vector<ContinueFuture> futures_;
@@ -30,11 +30,14 @@
 #include "velox/exec/MergeJoin.h"
 #include "velox/exec/OrderBy.h"
 #include "velox/exec/PartitionedOutput.h"
+#include "velox/exec/StreamingAggregation.h"
 #include "velox/exec/TableScan.h"
 #include "velox/exec/TableWriter.h"
 #include "velox/exec/TopN.h"
+#include "velox/exec/TopNRowNumber.h"
 #include "velox/exec/Unnest.h"
 #include "velox/exec/Values.h"
+#include "velox/exec/Window.h"
 
 namespace facebook::velox::exec {
 
@@ -117,11 +120,97 @@ OperatorSupplier makeConsumerSupplier(
   return nullptr;
 }
 
+/// Counts the final OrderBy and the LocalMerge nodes in the plan.
+void countSortNodes(
+    const std::shared_ptr<const core::PlanNode>& planNode,
+    int32_t& numFinalOrderBys,
+    int32_t& numLocalMerges) {
+  if (auto orderBy =
+          std::dynamic_pointer_cast<const core::OrderByNode>(planNode)) {
+    if (!orderBy->isPartial()) {
+      ++numFinalOrderBys;
+    }
+  } else if (std::dynamic_pointer_cast<const core::LocalMergeNode>(planNode)) {
+    ++numLocalMerges;
+  }
+  for (auto& source : planNode->sources()) {
+    countSortNodes(source, numFinalOrderBys, numLocalMerges);
+  }
+}
+
+/// Returns a LocalMerge over a partial OrderBy equivalent to the final
+/// 'orderBy'. The partial OrderBy runs on its own multi-threaded pipeline.
+/// Both report under the plan node id of 'orderBy'.
+std::shared_ptr<const core::PlanNode> makeParallelOrderBy(
+    const std::shared_ptr<const core::OrderByNode>& orderBy) {
+  auto partialOrderBy = std::make_shared<core::OrderByNode>(
+      orderBy->id(),
+      orderBy->sortingKeys(),
+      orderBy->sortingOrders(),
+      true, // isPartial
+      orderBy->sources()[0]);
+  return std::make_shared<core::LocalMergeNode>(
+      orderBy->id(),
+      orderBy->sortingKeys(),
+      orderBy->sortingOrders(),
+      partialOrderBy);
+}
+
+/// Returns a TableWrite without sorting keys over a partial OrderBy on the
+/// sorting keys of 'tableWrite'. The OrderBy is in the pipeline of the
+/// TableWrite, so each writer sorts the rows of the file it writes. Both
+/// report under the plan node id of 'tableWrite'.
+std::shared_ptr<const core::PlanNode> makeSortedTableWrite(
+    const std::shared_ptr<const core::TableWriteNode>& tableWrite) {
+  auto orderBy = std::make_shared<core::OrderByNode>(
+      tableWrite->id(),
+      tableWrite->sortingKeys(),
+      tableWrite->sortingOrders(),
+      true, // isPartial
+      tableWrite->sources()[0]);
+  return std::make_shared<core::TableWriteNode>(
+      tableWrite->id(),
+      tableWrite->columns(),
+      tableWrite->columnNames(),
+      tableWrite->insertTableHandle(),
+      tableWrite->outputType(),
+      orderBy);
+}
+
 void plan(
     const std::shared_ptr<const core::PlanNode>& planNode,
     std::vector<std::shared_ptr<const core::PlanNode>>* currentPlanNodes,
     OperatorSupplier consumerSupplier,
+    bool parallelOrderBy,
     std::vector<std::unique_ptr<DriverFactory>>* driverFactories) {
+  if (auto tableWrite =
+          std::dynamic_pointer_cast<const core::TableWriteNode>(planNode)) {
+    if (!tableWrite->sortingKeys().empty()) {
+      plan(
+          makeSortedTableWrite(tableWrite),
+          currentPlanNodes,
+          consumerSupplier,
+          parallelOrderBy,
+          driverFactories);
+      return;
+    }
+  }
+
+  if (parallelOrderBy) {
+    if (auto orderBy =
+            std::dynamic_pointer_cast<const core::OrderByNode>(planNode)) {
+      if (!orderBy->isPartial()) {
+        plan(
+            makeParallelOrderBy(orderBy),
+            currentPlanNodes,
+            consumerSupplier,
+            false,
+            driverFactories);
+        return;
+      }
+    }
+  }
+
   if (!currentPlanNodes) {
     driverFactories->push_back(std::make_unique<DriverFactory>());
     currentPlanNodes = &driverFactories->back()->planNodes;
@@ -137,6 +226,7 @@ void plan(
           sources[i],
           mustStartNewPipeline(planNode, i) ? nullptr : currentPlanNodes,
           makeConsumerSupplier(planNode),
+          parallelOrderBy,
           driverFactories);
     }
   }
@@ -144,14 +234,19 @@ void plan(
   currentPlanNodes->push_back(planNode);
 }
 
+// 'sharedFinalAggregation' allows the final aggregations that share their
+// groups between drivers to run multi-threaded.
 uint32_t maxDrivers(
-    const std::vector<std::shared_ptr<const core::PlanNode>>& planNodes) {
+    const std::vector<std::shared_ptr<const core::PlanNode>>& planNodes,
+    bool sharedFinalAggregation) {
   uint32_t count = std::numeric_limits<uint32_t>::max();
   for (auto& node : planNodes) {
     if (auto aggregation =
             std::dynamic_pointer_cast<const core::AggregationNode>(node)) {
-      if (aggregation->step() == core::AggregationNode::Step::kFinal ||
-          aggregation->step() == core::AggregationNode::Step::kSingle) {
+      if ((aggregation->step() == core::AggregationNode::Step::kFinal ||
+           aggregation->step() == core::AggregationNode::Step::kSingle) &&
+          !(sharedFinalAggregation &&
+            HashAggregation::supportsSharedTable(*aggregation))) {
         // final aggregations must run single-threaded
         return 1;
       }
@@ -180,6 +275,15 @@ uint32_t maxDrivers(
       if (!orderBy->isPartial()) {
         return 1;
       }
+    } else if (
+        auto topNRowNumber =
+            std::dynamic_pointer_cast<const core::TopNRowNumberNode>(node)) {
+      // All rows of a partition must go to the same heap.
+      return 1;
+    } else if (
+        auto window = std::dynamic_pointer_cast<const core::WindowNode>(node)) {
+      // Window must see all rows of a partition in a single Driver.
+      return 1;
     } else if (
         auto localMerge =
             std::dynamic_pointer_cast<const core::LocalMergeNode>(node)) {
@@ -220,20 +324,66 @@ uint32_t maxDrivers(
 // static
 void LocalPlanner::plan(
     const std::shared_ptr<const core::PlanNode>& planNode,
+    const core::QueryConfig& queryConfig,
     ConsumerSupplier consumerSupplier,
     std::vector<std::unique_ptr<DriverFactory>>* driverFactories) {
+  bool parallelOrderBy = false;
+  if (queryConfig.parallelOrderByEnabled()) {
+    // A Task supports a single LocalMerge.
+    int32_t numFinalOrderBys = 0;
+    int32_t numLocalMerges = 0;
+    detail::countSortNodes(planNode, numFinalOrderBys, numLocalMerges);
+    parallelOrderBy = numFinalOrderBys == 1 && numLocalMerges == 0;
+  }
   detail::plan(
       planNode,
       nullptr,
       detail::makeConsumerSupplier(consumerSupplier),
+      parallelOrderBy,
       driverFactories);
 
   (*driverFactories)[0]->outputDriver = true;
 
   for (auto& factory : *driverFactories) {
-    factory->maxDrivers = detail::maxDrivers(factory->planNodes);
+    factory->maxDrivers = detail::maxDrivers(
+        factory->planNodes, queryConfig.sharedFinalAggregationEnabled());
+  }
+}
+
+namespace {
+// Caches the output of the first HashAggregation of a pipeline that starts
+// with a TableScan followed by filters and projections, if the scan has a
+// result cache fingerprint. See QueryConfig::kFragmentResultCacheEnabled.
+void enableSplitResultCache(
+    const DriverCtx& ctx,
+    const std::vector<std::shared_ptr<const core::PlanNode>>& planNodes,
+    std::vector<std::unique_ptr<Operator>>& operators) {
+  auto queryCtx = ctx.execCtx->queryCtx();
+  if (!queryCtx->config().fragmentResultCacheEnabled() || operators.empty()) {
+    return;
+  }
+  auto scanNode =
+      std::dynamic_pointer_cast<const core::TableScanNode>(planNodes[0]);
+  auto dataCache =
+      dynamic_cast<cache::AsyncDataCache*>(queryCtx->mappedMemory());
+  if (!scanNode || scanNode->resultCacheFingerprint().empty() || !dataCache) {
+    return;
+  }
+  auto tableScan = dynamic_cast<TableScan*>(operators[0].get());
+  for (auto i = 1; i < operators.size(); ++i) {
+    if (dynamic_cast<FilterProject*>(operators[i].get())) {
+      continue;
+    }
+    if (auto aggregation = dynamic_cast<HashAggregation*>(operators[i].get())) {
+      if (aggregation->enableSplitResultCache(
+              dataCache, scanNode->resultCacheFingerprint())) {
+        tableScan->setSplitResultCacheClient(aggregation);
+      }
+    }
+    return;
   }
 }
+} // namespace
 
 std::shared_ptr<Driver> DriverFactory::createDriver(
     std::unique_ptr<DriverCtx> ctx,
@@ -242,6 +392,19 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
   std::vector<std::unique_ptr<Operator>> operators;
   operators.reserve(planNodes.size());
 
+  const bool coalesceFilterOutput =
+      ctx->execCtx->queryCtx()->config().coalesceFilterOutputEnabled();
+  // Returns true if the output of a filter that ends at plan node 'last'
+  // is to be coalesced.
+  auto shouldCoalesce = [&](int32_t last) {
+    if (!coalesceFilterOutput || last + 1 >= planNodes.size()) {
+      return false;
+    }
+    const auto& consumer = planNodes[last + 1];
+    return std::dynamic_pointer_cast<const core::HashJoinNode>(consumer) ||
+        std::dynamic_pointer_cast<const core::PartitionedOutputNode>(consumer);
+  };
+
   for (int32_t i = 0; i < planNodes.size(); i++) {
     // Id of the Operator being made. This is not the same as 'i'
     // because some PlanNodes may get fused.
@@ -254,13 +417,13 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
         if (auto projectNode =
                 std::dynamic_pointer_cast<const core::ProjectNode>(next)) {
           operators.push_back(std::make_unique<FilterProject>(
-              id, ctx.get(), filterNode, projectNode));
+              id, ctx.get(), filterNode, projectNode, shouldCoalesce(i + 1)));
           i++;
           continue;
         }
       }
-      operators.push_back(
-          std::make_unique<FilterProject>(id, ctx.get(), filterNode, nullptr));
+      operators.push_back(std::make_unique<FilterProject>(
+          id, ctx.get(), filterNode, nullptr, shouldCoalesce(i)));
     } else if (
         auto projectNode =
             std::dynamic_pointer_cast<const core::ProjectNode>(planNode)) {
@@ -309,8 +472,26 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
     } else if (
         auto aggregationNode =
             std::dynamic_pointer_cast<const core::AggregationNode>(planNode)) {
+      // DISTINCT and ordered aggregates need all input of their groups.
+      if (aggregationNode->isPreGrouped() &&
+          !aggregationNode->hasDistinctAggregates() &&
+          !aggregationNode->hasOrderedAggregates()) {
+        operators.push_back(std::make_unique<StreamingAggregation>(
+            id, ctx.get(), aggregationNode));
+      } else {
+        operators.push_back(
+            std::make_unique<HashAggregation>(id, ctx.get(), aggregationNode));
+      }
+    } else if (
+        auto windowNode =
+            std::dynamic_pointer_cast<const core::WindowNode>(planNode)) {
+      operators.push_back(std::make_unique<Window>(id, ctx.get(), windowNode));
+    } else if (
+        auto topNRowNumberNode =
+            std::dynamic_pointer_cast<const core::TopNRowNumberNode>(
+                planNode)) {
       operators.push_back(
-          std::make_unique<HashAggregation>(id, ctx.get(), aggregationNode));
+          std::make_unique<TopNRowNumber>(id, ctx.get(), topNRowNumberNode));
     } else if (
         auto topNNode =
             std::dynamic_pointer_cast<const core::TopNNode>(planNode)) {
@@ -330,8 +511,7 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
       auto numSources = numDrivers(ctx->pipelineId + 1);
       auto localMergeOp =
           std::make_unique<LocalMerge>(id, ctx.get(), numSources, localMerge);
-      ctx->task->createLocalMergeSources(
-          numSources, localMergeOp->outputType(), localMergeOp->mappedMemory());
+      ctx->task->createLocalMergeSources(numSources);
       operators.push_back(std::move(localMergeOp));
     } else if (
         auto mergeJoin =
@@ -378,6 +558,7 @@ std::shared_ptr<Driver> DriverFactory::createDriver(
   if (consumerSupplier) {
     operators.push_back(consumerSupplier(operators.size(), ctx.get()));
   }
+  enableSplitResultCache(*ctx, planNodes, operators);
 
   return std::make_shared<Driver>(std::move(ctx), std::move(operators));
 }
@@ -24,6 +24,7 @@ class LocalPlanner {
  public:
   static void plan(
       const std::shared_ptr<const core::PlanNode>& planNode,
+      const core::QueryConfig& queryConfig,
       ConsumerSupplier consumerSupplier,
       std::vector<std::unique_ptr<DriverFactory>>* driverFactories);
 };
@@ -16,7 +16,6 @@
 
 #include <boost/circular_buffer.hpp>
 
-#include "velox/exec/ContainerRowSerde.h"
 #include "velox/exec/Merge.h"
 #include "velox/exec/Task.h"
 
@@ -33,17 +32,31 @@ Merge::Merge(
     const std::string& operatorType)
     : SourceOperator(ctx, outputType, operatorId, planNodeId, operatorType),
       planNodeId_(planNodeId),
-      rowContainer_(std::make_unique<RowContainer>(
-          outputType_->children(),
-          operatorCtx_->mappedMemory())),
-      candidates_(Comparator(
-          outputType_,
-          sortingKeys,
-          sortingOrders,
-          rowContainer_.get())),
-      extractedCols_(std::dynamic_pointer_cast<RowVector>(
-          BaseVector::create(outputType_, 1, operatorCtx_->pool()))),
-      future_(false) {}
+      outputBatchSize_{
+          ctx->execCtx->queryCtx()->config().preferredOutputBatchSize()},
+      future_(false) {
+  auto numKeys = sortingKeys.size();
+  for (int i = 0; i < numKeys; ++i) {
+    auto channel = exprToChannel(sortingKeys[i].get(), outputType_);
+    VELOX_CHECK(
+        channel != kConstantChannel,
+        "Merge doesn't allow constant grouping keys");
+    keyInfo_.emplace_back(channel, sortingOrders[i]);
+  }
+  if (!keyInfo_.empty()) {
+    switch (outputType_->childAt(keyInfo_[0].first)->kind()) {
+      case TypeKind::BOOLEAN:
+      case TypeKind::TINYINT:
+      case TypeKind::SMALLINT:
+      case TypeKind::INTEGER:
+      case TypeKind::BIGINT:
+        hasPrefix_ = true;
+        break;
+      default:
+        break;
+    }
+  }
+}
 
 BlockingReason Merge::isBlocked(ContinueFuture* future) {
   BlockingReason reason = blockingReason_;
@@ -56,105 +69,214 @@ BlockingReason Merge::isBlocked(ContinueFuture* future) {
   return reason;
 }
 
-BlockingReason Merge::pushSource(ContinueFuture* future, size_t sourceId) {
-  char* row = nullptr;
-  auto reason = sources_[sourceId]->next(future, &row);
-  if (reason == BlockingReason::kNotBlocked && row) {
-    candidates_.emplace(sourceId, row);
+BlockingReason Merge::fetchBatch(ContinueFuture* future, size_t sourceId) {
+  auto& cursor = cursors_[sourceId];
+  for (;;) {
+    RowVectorPtr data;
+    auto reason = sources_[sourceId]->next(future, &data);
+    if (reason != BlockingReason::kNotBlocked) {
+      return reason;
+    }
+    if (data && data->size() == 0) {
+      continue;
+    }
+    cursor.data = std::move(data);
+    cursor.index = 0;
+    cursor.keys.clear();
+    if (cursor.data) {
+      for (auto& key : keyInfo_) {
+        cursor.keys.push_back(cursor.data->childAt(key.first)->loadedVector());
+      }
+      if (hasPrefix_) {
+        SelectivityVector rows(cursor.data->size());
+        cursor.firstKey.decode(*cursor.keys[0], rows);
+        updatePrefix(cursor);
+      }
+    }
+    return BlockingReason::kNotBlocked;
+  }
+}
+
+void Merge::updatePrefix(SourceCursor& cursor) {
+  auto& decoded = cursor.firstKey;
+  cursor.prefixNull = decoded.isNullAt(cursor.index);
+  if (cursor.prefixNull) {
+    return;
+  }
+  switch (decoded.base()->typeKind()) {
+    case TypeKind::BOOLEAN:
+      cursor.prefix = decoded.valueAt<bool>(cursor.index);
+      break;
+    case TypeKind::TINYINT:
+      cursor.prefix = decoded.valueAt<int8_t>(cursor.index);
+      break;
+    case TypeKind::SMALLINT:
+      cursor.prefix = decoded.valueAt<int16_t>(cursor.index);
+      break;
+    case TypeKind::INTEGER:
+      cursor.prefix = decoded.valueAt<int32_t>(cursor.index);
+      break;
+    case TypeKind::BIGINT:
+      cursor.prefix = decoded.valueAt<int64_t>(cursor.index);
+      break;
+    default:
+      VELOX_UNREACHABLE();
   }
-  return reason;
 }
 
-// Returns kNotBlocked if all sources ready and the priority queue has
-// their top rows.
+bool Merge::isBefore(int32_t left, int32_t right) {
+  auto& leftCursor = cursors_[left];
+  auto& rightCursor = cursors_[right];
+  if (!leftCursor.data) {
+    return false;
+  }
+  if (!rightCursor.data) {
+    return true;
+  }
+  size_t firstKey = 0;
+  if (hasPrefix_) {
+    auto& order = keyInfo_[0].second;
+    if (leftCursor.prefixNull != rightCursor.prefixNull) {
+      return leftCursor.prefixNull == order.isNullsFirst();
+    }
+    if (!leftCursor.prefixNull && leftCursor.prefix != rightCursor.prefix) {
+      return (leftCursor.prefix < rightCursor.prefix) == order.isAscending();
+    }
+    firstKey = 1;
+  }
+  for (auto i = firstKey; i < keyInfo_.size(); ++i) {
+    auto& order = keyInfo_[i].second;
+    auto leftKey = leftCursor.keys[i];
+    auto rightKey = rightCursor.keys[i];
+    // BaseVector::compare orders nulls by the flags but ignores the
+    // direction, so the nulls are handled here.
+    bool leftNull = leftKey->isNullAt(leftCursor.index);
+    bool rightNull = rightKey->isNullAt(rightCursor.index);
+    if (leftNull || rightNull) {
+      if (leftNull && rightNull) {
+        continue;
+      }
+      return leftNull == order.isNullsFirst();
+    }
+    if (auto result =
+            leftKey->compare(rightKey, leftCursor.index, rightCursor.index)) {
+      return order.isAscending() ? result < 0 : result > 0;
+    }
+  }
+  return false;
+}
+
+// Returns kNotBlocked if all sources are ready and the tree has their
+// current rows.
 BlockingReason Merge::ensureSourcesReady(ContinueFuture* future) {
   auto reason = addMergeSources(future);
   if (reason != BlockingReason::kNotBlocked) {
     return reason;
   }
 
-  if (numSourcesAdded_ < sources_.size()) {
-    // We have not considered some of the sources yet. Push top rows of
-    // sources into the priority queue. If they are not available yet, then
+  auto less = [this](int32_t left, int32_t right) {
+    return isBefore(left, right);
+  };
+  if (!tree_) {
+    // Get the first batch of each source. If it is not available yet, then
     // block.
+    cursors_.resize(sources_.size());
     while (currentSourcePos_ < sources_.size()) {
-      reason = pushSource(future, currentSourcePos_);
+      reason = fetchBatch(future, currentSourcePos_);
       if (reason != BlockingReason::kNotBlocked) {
         return reason;
       }
       ++currentSourcePos_;
-      ++numSourcesAdded_;
     }
+    if (!sources_.empty()) {
+      tree_ = std::make_unique<LoserTree>(sources_.size());
+      tree_->initialize(less);
+    }
+    return BlockingReason::kNotBlocked;
   }
 
-  // Finally, push any outstanding rows into the priority queue.
-  if (currentSourcePos_ < sources_.size()) {
-    reason = pushSource(future, currentSourcePos_);
+  // Finally, get the batch the merge blocked on.
+  if (pendingSource_.has_value()) {
+    reason = fetchBatch(future, pendingSource_.value());
     if (reason != BlockingReason::kNotBlocked) {
       return reason;
     }
-    currentSourcePos_ = sources_.size();
+    pendingSource_.reset();
+    tree_->update(less);
   }
-
   return BlockingReason::kNotBlocked;
 }
 
+void Merge::addOutputRow(const SourceCursor& cursor) {
+  if (!outputRuns_.empty()) {
+    auto& run = outputRuns_.back();
+    if (run.data == cursor.data && run.start + run.count == cursor.index) {
+      ++run.count;
+      ++numOutputRows_;
+      return;
+    }
+  }
+  outputRuns_.push_back({cursor.data, cursor.index, 1});
+  ++numOutputRows_;
+}
+
+RowVectorPtr Merge::makeOutput() {
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(outputType_, numOutputRows_, operatorCtx_->pool()));
+  for (auto i = 0; i < outputType_->size(); ++i) {
+    auto& child = result->childAt(i);
+    vector_size_t offset = 0;
+    for (auto& run : outputRuns_) {
+      child->copy(
+          run.data->childAt(i)->loadedVector(), offset, run.start, run.count);
+      offset += run.count;
+    }
+  }
+  outputRuns_.clear();
+  numOutputRows_ = 0;
+  return result;
+}
+
 RowVectorPtr Merge::getOutput() {
   blockingReason_ = ensureSourcesReady(&future_);
-  if (blockingReason_ != BlockingReason::kNotBlocked) {
+  if (blockingReason_ != BlockingReason::kNotBlocked || !tree_) {
     return nullptr;
   }
 
-  const auto numRowsPerBatch =
-      rowContainer_->estimatedNumRowsPerBatch(kBatchSizeInBytes);
-  rows_.reserve(numRowsPerBatch);
-
-  while (!candidates_.empty()) {
-    auto entry = candidates_.top();
-    candidates_.pop();
-
-    rows_.push_back(rowContainer_->addRow(entry.second, extractedCols_));
-
-    blockingReason_ = pushSource(&future_, entry.first);
-    if (blockingReason_ != BlockingReason::kNotBlocked) {
-      currentSourcePos_ = entry.first;
+  auto less = [this](int32_t left, int32_t right) {
+    return isBefore(left, right);
+  };
+  bool atEnd = false;
+  while (numOutputRows_ < outputBatchSize_) {
+    auto winner = tree_->winner();
+    auto& cursor = cursors_[winner];
+    if (!cursor.data) {
+      // The winner is at end only if all the sources are.
+      atEnd = true;
       break;
     }
-    if (rows_.size() >= numRowsPerBatch) {
-      break;
+    addOutputRow(cursor);
+
+    if (++cursor.index < cursor.data->size()) {
+      if (hasPrefix_) {
+        updatePrefix(cursor);
+      }
+    } else {
+      blockingReason_ = fetchBatch(&future_, winner);
+      if (blockingReason_ != BlockingReason::kNotBlocked) {
+        pendingSource_ = winner;
+        break;
+      }
     }
+    tree_->update(less);
   }
 
-  if (rows_.size() >= numRowsPerBatch ||
-      (!rows_.empty() && candidates_.empty())) {
-    auto result = std::dynamic_pointer_cast<RowVector>(
-        BaseVector::create(outputType_, rows_.size(), operatorCtx_->pool()));
-
-    rowContainer_->extractRows(rows_, result);
-    rowContainer_->clear();
-    rows_.clear();
-    return result;
+  if (numOutputRows_ >= outputBatchSize_ || (numOutputRows_ > 0 && atEnd)) {
+    return makeOutput();
   }
   return nullptr;
 }
 
-Merge::Comparator::Comparator(
-    std::shared_ptr<const RowType> type,
-    const std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>&
-        sortingKeys,
-    const std::vector<core::SortOrder>& sortingOrders,
-    RowContainer* rowContainer)
-    : rowContainer_(rowContainer) {
-  auto numKeys = sortingKeys.size();
-  for (int i = 0; i < numKeys; ++i) {
-    auto channel = exprToChannel(sortingKeys[i].get(), type);
-    VELOX_CHECK(
-        channel != kConstantChannel,
-        "Merge doesn't allow constant grouping keys");
-    keyInfo_.emplace_back(channel, sortingOrders[i]);
-  }
-}
-
 LocalMerge::LocalMerge(
     int32_t operatorId,
     DriverCtx* driverCtx,
@@ -196,7 +318,9 @@ MergeExchange::MergeExchange(
           mergeExchangeNode->sortingKeys(),
           mergeExchangeNode->sortingOrders(),
           mergeExchangeNode->id(),
-          "MergeExchange") {}
+          "MergeExchange"),
+      serdeOptions_(exchangeSerdeOptions(
+          driverCtx->execCtx->queryCtx()->config())) {}
 
 void MergeExchange::finish() {
   Merge::finish();
@@ -214,8 +338,8 @@ BlockingReason MergeExchange::addMergeSources(ContinueFuture* future) {
   }
   for (;;) {
     exec::Split split;
-    auto reason =
-        operatorCtx_->task()->getSplitOrFuture(planNodeId_, split, *future);
+    auto reason = operatorCtx_->task()->getSplitOrFuture(
+        operatorCtx_->driverCtx()->splitGroupId, planNodeId_, split, *future);
     if (reason == BlockingReason::kNotBlocked) {
       if (split.hasConnectorSplit()) {
         auto remoteSplit = std::dynamic_pointer_cast<RemoteConnectorSplit>(
@@ -18,13 +18,17 @@
 #include <memory>
 #include "velox/exec/Exchange.h"
 #include "velox/exec/MergeSource.h"
-#include "velox/exec/RowContainer.h"
+#include "velox/exec/TreeOfLosers.h"
+#include "velox/vector/DecodedVector.h"
 
 namespace facebook::velox::exec {
 
-// Merge operator Implementation: This implementation uses priority queue
-// to perform a k-way merge of its inputs. It stops merging if any one of
-// its inputs is blocked.
+// Merge operator Implementation: This implementation uses a tree of losers
+// to perform a k-way merge of its inputs. The sources produce sorted
+// batches. The output rows are copied straight from these batches. The
+// first sorting key is cached per source as an integer prefix if it is of
+// an integer type, so that most comparisons do not go through the vectors.
+// It stops merging if any one of its inputs is blocked.
 class Merge : public SourceOperator {
  public:
   Merge(
@@ -45,61 +49,73 @@ class Merge : public SourceOperator {
     return outputType_;
   }
 
-  memory::MappedMemory* mappedMemory() const {
-    return operatorCtx_->mappedMemory();
-  }
-
  protected:
   virtual BlockingReason addMergeSources(ContinueFuture* future) = 0;
   std::vector<std::shared_ptr<MergeSource>> sources_;
   const core::PlanNodeId planNodeId_;
 
  private:
-  static const size_t kBatchSizeInBytes{2 * 1024 * 1024};
-  using SourceRow = std::pair<size_t, char*>;
-
-  class Comparator {
-   public:
-    Comparator(
-        std::shared_ptr<const RowType> outputType,
-        const std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>&
-            sortingKeys,
-        const std::vector<core::SortOrder>& sortingOrders,
-        RowContainer* rowContainer);
-
-    // Returns true if lhs > rhs, false otherwise.
-    bool operator()(const SourceRow& lhs, const SourceRow& rhs) {
-      for (auto& key : keyInfo_) {
-        if (auto result = rowContainer_->compare(
-                lhs.second,
-                rhs.second,
-                key.first,
-                {key.second.isNullsFirst(), key.second.isAscending(), false})) {
-          return result > 0;
-        }
-      }
-      return false;
-    }
-
-   private:
-    std::vector<std::pair<ChannelIndex, core::SortOrder>> keyInfo_;
-    RowContainer* rowContainer_;
+  // The current row of a source.
+  struct SourceCursor {
+    // The batch being consumed. nullptr if the source is at end.
+    RowVectorPtr data;
+    vector_size_t index{0};
+
+    // The sorting key columns of 'data'.
+    std::vector<const BaseVector*> keys;
+
+    // The first sorting key at 'index' if 'hasPrefix_'.
+    DecodedVector firstKey;
+    int64_t prefix{0};
+    bool prefixNull{false};
+  };
+
+  // A range of consecutive rows of a source batch that goes to the output.
+  struct OutputRun {
+    RowVectorPtr data;
+    vector_size_t start;
+    vector_size_t count;
   };
 
-  BlockingReason pushSource(ContinueFuture* future, size_t sourceId);
   BlockingReason ensureSourcesReady(ContinueFuture* future);
 
-  std::vector<char*> rows_;
-  std::unique_ptr<RowContainer> rowContainer_;
-  std::priority_queue<SourceRow, std::vector<SourceRow>, Comparator>
-      candidates_;
+  // Sets the cursor of 'sourceId' to the first row of the next non-empty
+  // batch of the source, or to end.
+  BlockingReason fetchBatch(ContinueFuture* future, size_t sourceId);
+
+  void updatePrefix(SourceCursor& cursor);
+
+  // Returns true if the current row of 'left' goes before the current row
+  // of 'right'. Sources at end go last.
+  bool isBefore(int32_t left, int32_t right);
+
+  void addOutputRow(const SourceCursor& cursor);
+
+  RowVectorPtr makeOutput();
 
-  RowVectorPtr extractedCols_;
+  // Maximum number of rows in the output batch.
+  const uint32_t outputBatchSize_;
+
+  std::vector<std::pair<ChannelIndex, core::SortOrder>> keyInfo_;
+
+  // True if the first sorting key is of an integer type.
+  bool hasPrefix_{false};
+
+  std::vector<SourceCursor> cursors_;
+
+  // Created once all the sources have their first batch.
+  std::unique_ptr<LoserTree> tree_;
+
+  // A source whose batch ran out while its next batch was not available.
+  // The tree is updated once the next batch arrives.
+  std::optional<size_t> pendingSource_;
+
+  std::vector<OutputRun> outputRuns_;
+  vector_size_t numOutputRows_{0};
 
   BlockingReason blockingReason_{BlockingReason::kNotBlocked};
   ContinueFuture future_;
 
-  size_t numSourcesAdded_ = 0;
   size_t currentSourcePos_ = 0;
 };
 
@@ -133,10 +149,15 @@ class MergeExchange : public Merge {
 
   void finish() override;
 
+  const VectorSerde::Options& serdeOptions() const {
+    return serdeOptions_;
+  }
+
  protected:
   BlockingReason addMergeSources(ContinueFuture* future) override;
 
  private:
+  const VectorSerde::Options serdeOptions_;
   bool noMoreSplits_ = false;
   size_t numSplits_{0}; // Number of splits we took to process so far.
 };
@@ -18,6 +18,65 @@
 
 namespace facebook::velox::exec {
 
+namespace {
+template <TypeKind Kind>
+int32_t compareKeys(
+    const DecodedVector& keys,
+    vector_size_t index,
+    const DecodedVector& otherKeys,
+    vector_size_t otherIndex) {
+  using T = typename TypeTraits<Kind>::NativeType;
+  auto value = keys.valueAt<T>(index);
+  auto otherValue = otherKeys.valueAt<T>(otherIndex);
+  return value < otherValue ? -1 : (value == otherValue ? 0 : 1);
+}
+
+template <TypeKind Kind>
+vector_size_t findKeyRunEnd(
+    const DecodedVector& keys,
+    vector_size_t start,
+    vector_size_t end) {
+  using T = typename TypeTraits<Kind>::NativeType;
+  if (keys.isConstantMapping()) {
+    return end;
+  }
+  const auto* values = keys.data<T>();
+  auto value = values[keys.index(start)];
+  if (keys.isIdentityMapping()) {
+    for (auto i = start + 1; i < end; ++i) {
+      if (values[i] != value) {
+        return i;
+      }
+    }
+    return end;
+  }
+  for (auto i = start + 1; i < end; ++i) {
+    if (values[keys.index(i)] != value) {
+      return i;
+    }
+  }
+  return end;
+}
+} // namespace
+
+// static
+std::pair<MergeJoin::CompareFn, MergeJoin::RunEndFn> MergeJoin::keyFunctions(
+    TypeKind kind) {
+  switch (kind) {
+    case TypeKind::TINYINT:
+      return {compareKeys<TypeKind::TINYINT>, findKeyRunEnd<TypeKind::TINYINT>};
+    case TypeKind::SMALLINT:
+      return {
+          compareKeys<TypeKind::SMALLINT>, findKeyRunEnd<TypeKind::SMALLINT>};
+    case TypeKind::INTEGER:
+      return {compareKeys<TypeKind::INTEGER>, findKeyRunEnd<TypeKind::INTEGER>};
+    case TypeKind::BIGINT:
+      return {compareKeys<TypeKind::BIGINT>, findKeyRunEnd<TypeKind::BIGINT>};
+    default:
+      return {nullptr, nullptr};
+  }
+}
+
 MergeJoin::MergeJoin(
     int32_t operatorId,
     DriverCtx* driverCtx,
@@ -37,8 +96,8 @@ MergeJoin::MergeJoin(
   VELOX_USER_CHECK_NULL(
       joinNode->filter(), "Merge join doesn't support filter yet.");
 
-  leftKeys_.resize(numKeys_);
-  rightKeys_.resize(numKeys_);
+  leftKeys_.reserve(numKeys_);
+  rightKeys_.reserve(numKeys_);
 
   auto leftType = joinNode->sources()[0]->outputType();
   for (auto& key : joinNode->leftKeys()) {
@@ -50,6 +109,18 @@ MergeJoin::MergeJoin(
     rightKeys_.push_back(rightType->getChildIdx(key->name()));
   }
 
+  for (auto i = 0; i < numKeys_; ++i) {
+    auto kind = leftType->childAt(leftKeys_[i])->kind();
+    auto [compareFn, runEndFn] = keyFunctions(kind);
+    if (!compareFn || rightType->childAt(rightKeys_[i])->kind() != kind) {
+      compareFns_.clear();
+      runEndFns_.clear();
+      break;
+    }
+    compareFns_.push_back(compareFn);
+    runEndFns_.push_back(runEndFn);
+  }
+
   for (auto i = 0; i < leftType->size(); ++i) {
     auto name = leftType->nameOf(i);
     auto outIndex = outputType_->getChildIdxIfExists(name);
@@ -84,6 +155,66 @@ bool MergeJoin::needsInput() const {
 void MergeJoin::addInput(RowVectorPtr input) {
   input_ = std::move(input);
   index_ = 0;
+  decodeKeys(input_, leftKeys_, leftDecoded_);
+}
+
+void MergeJoin::decodeKeys(
+    const RowVectorPtr& batch,
+    const std::vector<ChannelIndex>& keys,
+    DecodedKeys& decoded) {
+  decoded.fastPath = false;
+  if (compareFns_.empty()) {
+    return;
+  }
+  allRows_.resize(batch->size());
+  allRows_.setAll();
+  decoded.keys.resize(numKeys_);
+  for (auto i = 0; i < numKeys_; ++i) {
+    auto& key = decoded.keys[i];
+    key.decode(*batch->childAt(keys[i]), allRows_);
+    if (key.mayHaveNulls() || !key.data<char>()) {
+      return;
+    }
+  }
+  decoded.fastPath = true;
+}
+
+int32_t MergeJoin::compare() const {
+  if (leftDecoded_.fastPath && rightDecoded_.fastPath) {
+    for (auto i = 0; i < numKeys_; ++i) {
+      if (auto result = compareFns_[i](
+              leftDecoded_.keys[i],
+              index_,
+              rightDecoded_.keys[i],
+              rightIndex_)) {
+        return result;
+      }
+    }
+    return 0;
+  }
+  return compare(
+      leftKeys_, input_, index_, rightKeys_, rightInput_, rightIndex_);
+}
+
+vector_size_t MergeJoin::findRunEnd(
+    const std::vector<ChannelIndex>& keys,
+    const DecodedKeys& decoded,
+    const RowVectorPtr& batch,
+    vector_size_t start) const {
+  vector_size_t end = batch->size();
+  if (decoded.fastPath) {
+    // Each key narrows the run of the previous keys.
+    for (auto i = 0; i < numKeys_ && end > start + 1; ++i) {
+      end = runEndFns_[i](decoded.keys[i], start, end);
+    }
+    return end;
+  }
+  auto runEnd = start + 1;
+  while (runEnd < end &&
+         compare(keys, batch, start, keys, batch, runEnd) == 0) {
+    ++runEnd;
+  }
+  return runEnd;
 }
 
 // static
@@ -105,7 +236,11 @@ int32_t MergeJoin::compare(
   return 0;
 }
 
-bool MergeJoin::findEndOfMatch(Match& match, const RowVectorPtr& input) {
+bool MergeJoin::findEndOfMatch(
+    Match& match,
+    const RowVectorPtr& input,
+    const std::vector<ChannelIndex>& keys,
+    const DecodedKeys& decoded) {
   if (match.complete) {
     return true;
   }
@@ -116,9 +251,9 @@ bool MergeJoin::findEndOfMatch(Match& match, const RowVectorPtr& input) {
   auto numInput = input->size();
 
   vector_size_t endIndex = 0;
-  while (endIndex < numInput &&
-         compareLeft(input, endIndex, prevInput, prevIndex) == 0) {
-    ++endIndex;
+  if (numInput > 0 &&
+      compare(keys, input, 0, keys, prevInput, prevIndex) == 0) {
+    endIndex = findRunEnd(keys, decoded, input, 0);
   }
 
   if (endIndex == numInput) {
@@ -136,44 +271,59 @@ bool MergeJoin::findEndOfMatch(Match& match, const RowVectorPtr& input) {
   return true;
 }
 
-void MergeJoin::addOutputRow(
+bool MergeJoin::prepareOutput(
     const RowVectorPtr& left,
-    vector_size_t leftIndex,
-    const RowVectorPtr& right,
-    vector_size_t rightIndex) {
-  for (auto& projection : leftProjections_) {
-    auto source = left->childAt(projection.inputChannel);
-    auto target = output_->childAt(projection.outputChannel);
-    target->copy(source.get(), outputSize_, leftIndex, 1);
+    const RowVectorPtr& right) {
+  if (outputSize_ > 0) {
+    return left == outputLeft_ && right == outputRight_;
+  }
+  if (!leftIndices_) {
+    leftIndices_ = allocateIndices(outputBatchSize_, operatorCtx_->pool());
+    rawLeftIndices_ = leftIndices_->asMutable<vector_size_t>();
+    rightIndices_ = allocateIndices(outputBatchSize_, operatorCtx_->pool());
+    rawRightIndices_ = rightIndices_->asMutable<vector_size_t>();
   }
+  outputLeft_ = left;
+  outputRight_ = right;
+  return true;
+}
 
+RowVectorPtr MergeJoin::produceOutput() {
+  if (outputSize_ == 0) {
+    return nullptr;
+  }
+  std::vector<VectorPtr> columns(outputType_->size());
+  for (auto& projection : leftProjections_) {
+    columns[projection.outputChannel] = BaseVector::wrapInDictionary(
+        BufferPtr(nullptr),
+        leftIndices_,
+        outputSize_,
+        outputLeft_->loadedChildAt(projection.inputChannel));
+  }
   for (auto& projection : rightProjections_) {
-    auto source = right->childAt(projection.inputChannel);
-    auto target = output_->childAt(projection.outputChannel);
-    target->copy(source.get(), outputSize_, rightIndex, 1);
+    columns[projection.outputChannel] = BaseVector::wrapInDictionary(
+        BufferPtr(nullptr),
+        rightIndices_,
+        outputSize_,
+        outputRight_->loadedChildAt(projection.inputChannel));
   }
-
-  ++outputSize_;
+  auto output = std::make_shared<RowVector>(
+      operatorCtx_->pool(),
+      outputType_,
+      nullptr,
+      outputSize_,
+      std::move(columns));
+
+  // The output owns the indices. The next output gets new ones.
+  leftIndices_ = nullptr;
+  rightIndices_ = nullptr;
+  outputLeft_ = nullptr;
+  outputRight_ = nullptr;
+  outputSize_ = 0;
+  return output;
 }
 
 bool MergeJoin::addToOutput() {
-  // Prepare output vector.
-  if (output_ == nullptr) {
-    std::vector<VectorPtr> localColumns(outputType_->size());
-    for (auto i = 0; i < outputType_->size(); ++i) {
-      localColumns[i] = BaseVector::create(
-          outputType_->childAt(i), outputBatchSize_, operatorCtx_->pool());
-    }
-
-    output_ = std::make_shared<RowVector>(
-        operatorCtx_->pool(),
-        outputType_,
-        nullptr,
-        outputBatchSize_,
-        std::move(localColumns));
-    outputSize_ = 0;
-  }
-
   size_t firstLeftBatch;
   vector_size_t leftStartIndex;
   if (leftMatch_->cursor) {
@@ -208,13 +358,25 @@ bool MergeJoin::addToOutput() {
         auto rightEnd =
             r == numRights - 1 ? rightMatch_->endIndex : right->size();
 
-        for (auto j = rightStart; j < rightEnd; ++j) {
-          if (outputSize_ == outputBatchSize_) {
+        for (auto j = rightStart; j < rightEnd;) {
+          if (outputSize_ == outputBatchSize_ || !prepareOutput(left, right)) {
             leftMatch_->setCursor(l, i);
             rightMatch_->setCursor(r, j);
             return true;
           }
-          addOutputRow(left, i, right, j);
+          // Pairs row 'i' on the left with a run of rows on the right.
+          auto numRows = std::min<vector_size_t>(
+              rightEnd - j, outputBatchSize_ - outputSize_);
+          std::fill(
+              rawLeftIndices_ + outputSize_,
+              rawLeftIndices_ + outputSize_ + numRows,
+              i);
+          std::iota(
+              rawRightIndices_ + outputSize_,
+              rawRightIndices_ + outputSize_ + numRows,
+              j);
+          outputSize_ += numRows;
+          j += numRows;
         }
       }
     }
@@ -254,6 +416,7 @@ RowVectorPtr MergeJoin::getOutput() {
 
       if (rightInput_) {
         rightIndex_ = 0;
+        decodeKeys(rightInput_, rightKeys_, rightDecoded_);
       } else {
         noMoreRightInput_ = true;
       }
@@ -273,7 +436,7 @@ RowVectorPtr MergeJoin::doGetOutput() {
     // Not all rows from the last match fit in the output. Continue producing
     // results from the current match.
     if (addToOutput()) {
-      return std::move(output_);
+      return produceOutput();
     }
   }
 
@@ -284,7 +447,8 @@ RowVectorPtr MergeJoin::doGetOutput() {
 
     if (input_) {
       // Look for continuation of a match on the left and/or right sides.
-      if (!findEndOfMatch(leftMatch_.value(), input_)) {
+      if (!findEndOfMatch(
+              leftMatch_.value(), input_, leftKeys_, leftDecoded_)) {
         // Continue looking for the end of the match.
         input_ = nullptr;
         return nullptr;
@@ -301,7 +465,8 @@ RowVectorPtr MergeJoin::doGetOutput() {
     }
 
     if (rightInput_) {
-      if (!findEndOfMatch(rightMatch_.value(), rightInput_)) {
+      if (!findEndOfMatch(
+              rightMatch_.value(), rightInput_, rightKeys_, rightDecoded_)) {
         // Continue looking for the end of the match.
         rightInput_ = nullptr;
         return nullptr;
@@ -324,15 +489,14 @@ RowVectorPtr MergeJoin::doGetOutput() {
     VELOX_CHECK(rightMatch_ && rightMatch_->complete);
 
     if (addToOutput()) {
-      return std::move(output_);
+      return produceOutput();
     }
   }
 
   if (!input_ || !rightInput_) {
     if (isFinishing() || noMoreRightInput_) {
-      if (output_) {
-        output_->resize(outputSize_);
-        return std::move(output_);
+      if (outputSize_ > 0) {
+        return produceOutput();
       }
     }
 
@@ -369,19 +533,13 @@ RowVectorPtr MergeJoin::doGetOutput() {
     if (compareResult == 0) {
       // Found a match. Identify all rows on the left and right that have the
       // matching keys.
-      vector_size_t endIndex = index_ + 1;
-      while (endIndex < input_->size() && compareLeft(endIndex) == 0) {
-        ++endIndex;
-      }
+      auto endIndex = findRunEnd(leftKeys_, leftDecoded_, input_, index_);
 
       leftMatch_ = Match{
           {input_}, index_, endIndex, endIndex < input_->size(), std::nullopt};
 
-      vector_size_t endRightIndex = rightIndex_ + 1;
-      while (endRightIndex < rightInput_->size() &&
-             compareRight(endRightIndex) == 0) {
-        ++endRightIndex;
-      }
+      auto endRightIndex =
+          findRunEnd(rightKeys_, rightDecoded_, rightInput_, rightIndex_);
 
       rightMatch_ = Match{
           {rightInput_},
@@ -407,7 +565,7 @@ RowVectorPtr MergeJoin::doGetOutput() {
       rightIndex_ = endRightIndex;
 
       if (addToOutput()) {
-        return std::move(output_);
+        return produceOutput();
       }
 
       compareResult = compare();
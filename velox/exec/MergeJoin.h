@@ -16,6 +16,7 @@
 #pragma once
 #include "velox/exec/MergeSource.h"
 #include "velox/exec/Operator.h"
+#include "velox/vector/DecodedVector.h"
 
 namespace facebook::velox::exec {
 class MergeJoin : public Operator {
@@ -43,49 +44,56 @@ class MergeJoin : public Operator {
  private:
   RowVectorPtr doGetOutput();
 
-  static int32_t compare(
-      const std::vector<ChannelIndex>& keys,
-      const RowVectorPtr& batch,
+  // Compares row 'index' of 'keys' with row 'otherIndex' of 'otherKeys'.
+  using CompareFn = int32_t (*)(
+      const DecodedVector& keys,
       vector_size_t index,
-      const std::vector<ChannelIndex>& otherKeys,
-      const RowVectorPtr& otherBatch,
+      const DecodedVector& otherKeys,
       vector_size_t otherIndex);
 
-  // Compare rows on the left and right at index_ and rightIndex_ respectively.
-  int32_t compare() const {
-    return compare(
-        leftKeys_, input_, index_, rightKeys_, rightInput_, rightIndex_);
-  }
-
-  // Compare two rows on the left: index_ and index.
-  int32_t compareLeft(vector_size_t index) const {
-    return compare(leftKeys_, input_, index_, leftKeys_, input_, index);
-  }
+  // Returns the first row in (start, end) that differs from row 'start' or
+  // 'end' if there is none.
+  using RunEndFn = vector_size_t (*)(
+      const DecodedVector& keys,
+      vector_size_t start,
+      vector_size_t end);
+
+  // Returns the typed comparisons for join keys of 'kind' or nullptrs if
+  // there are none.
+  static std::pair<CompareFn, RunEndFn> keyFunctions(TypeKind kind);
+
+  // Join keys of a batch of input decoded for typed comparisons. The fast
+  // path applies if all keys are integers without nulls. Other keys are
+  // compared row by row through BaseVector::compare().
+  struct DecodedKeys {
+    std::vector<DecodedVector> keys;
+    bool fastPath{false};
+  };
 
-  // Compare two rows on the right: rightIndex_ and index.
-  int32_t compareRight(vector_size_t index) const {
-    return compare(
-        rightKeys_, rightInput_, rightIndex_, rightKeys_, rightInput_, index);
-  }
+  // Decodes the 'keys' columns of 'batch' into 'decoded'.
+  void decodeKeys(
+      const RowVectorPtr& batch,
+      const std::vector<ChannelIndex>& keys,
+      DecodedKeys& decoded);
 
-  // Compare two rows from the left side.
-  int32_t compareLeft(
+  // Returns the first row after 'start' in 'batch' whose keys differ from
+  // row 'start'. 'decoded' are the keys of 'batch'.
+  vector_size_t findRunEnd(
+      const std::vector<ChannelIndex>& keys,
+      const DecodedKeys& decoded,
       const RowVectorPtr& batch,
-      vector_size_t index,
-      const RowVectorPtr& otherBatch,
-      vector_size_t otherIndex) const {
-    return compare(leftKeys_, batch, index, leftKeys_, otherBatch, otherIndex);
-  }
+      vector_size_t start) const;
 
-  // Compare two rows from the right side.
-  int32_t compareRight(
+  static int32_t compare(
+      const std::vector<ChannelIndex>& keys,
       const RowVectorPtr& batch,
       vector_size_t index,
+      const std::vector<ChannelIndex>& otherKeys,
       const RowVectorPtr& otherBatch,
-      vector_size_t otherIndex) const {
-    return compare(
-        rightKeys_, batch, index, rightKeys_, otherBatch, otherIndex);
-  }
+      vector_size_t otherIndex);
+
+  // Compare rows on the left and right at index_ and rightIndex_ respectively.
+  int32_t compare() const;
 
   /// Describes a contiguous set of rows on the left or right side of the join
   /// with all join keys being the same. The set of rows may span multiple
@@ -133,11 +141,18 @@ class MergeJoin : public Operator {
   /// 'match' to include the newly identified rows. Returns true if found the
   /// last matching row and set match.complete to true. If all rows in 'input'
   /// have matching keys, add 'input' to 'match' and returns false to ensure
-  /// that next batch of input is checked for more matching rows.
-  bool findEndOfMatch(Match& match, const RowVectorPtr& input);
+  /// that next batch of input is checked for more matching rows. 'keys' and
+  /// 'decoded' are the join keys of the side of 'input'.
+  bool findEndOfMatch(
+      Match& match,
+      const RowVectorPtr& input,
+      const std::vector<ChannelIndex>& keys,
+      const DecodedKeys& decoded);
 
   // Appends a cartesian product of the current set of matching rows, leftMatch_
-  // x rightMatch_, to output_. Returns true if output_ is full. Sets
+  // x rightMatch_, to the output. Returns true if the output is full or if
+  // the next rows come from a different batch than the rows in the output.
+  // Sets
   // leftMatchCursor_ and rightMatchCursor_ if output_ filled up before all the
   // rows were added. Fills up output starting from leftMatchCursor_ and
   // rightMatchCursor_ positions if these are set. Clears leftMatch_ and
@@ -145,18 +160,16 @@ class MergeJoin : public Operator {
   // rightMatchCursor_ if output_ filled up before all rows were added.
   bool addToOutput();
 
-  // Adds one row of output by copying values from left and right batches at the
-  // specified rows. Advances outputSize_. Assumes that output_ has room.
-  //
-  // TODO: Copying is inefficient especially for complex type values. Consider
-  // an optimization of using dictionary wrapping when full batch of output can
-  // be produced using single batch of input from the left side and single batch
-  // of input from the right side.
-  void addOutputRow(
-      const RowVectorPtr& left,
-      vector_size_t leftIndex,
-      const RowVectorPtr& right,
-      vector_size_t rightIndex);
+  // Returns true if rows of 'left' and 'right' can be added to the output.
+  // The output wraps one batch of each side in dictionaries, so it can
+  // take rows from other batches only once it is produced. Starts a new
+  // output if there is none.
+  bool prepareOutput(const RowVectorPtr& left, const RowVectorPtr& right);
+
+  // Returns the rows added since the last call, as dictionaries over the
+  // columns of 'outputLeft_' and 'outputRight_', or nullptr if there are no
+  // rows.
+  RowVectorPtr produceOutput();
 
   /// Maximum number of rows in the output batch.
   const uint32_t outputBatchSize_;
@@ -187,8 +200,29 @@ class MergeJoin : public Operator {
   /// A set of rows with matching keys on the right side.
   std::optional<Match> rightMatch_;
 
-  /// Number of rows accumulated in the output_.
-  vector_size_t outputSize_;
+  /// Typed comparisons for each join key. Empty if some key is not an
+  /// integer or differs in type between the sides.
+  std::vector<CompareFn> compareFns_;
+  std::vector<RunEndFn> runEndFns_;
+
+  SelectivityVector allRows_;
+
+  /// Join keys of 'input_' and 'rightInput_'.
+  DecodedKeys leftDecoded_;
+  DecodedKeys rightDecoded_;
+
+  /// The batches on the left and right sides the output rows come from.
+  RowVectorPtr outputLeft_;
+  RowVectorPtr outputRight_;
+
+  /// Indices into 'outputLeft_' and 'outputRight_' for the output rows.
+  BufferPtr leftIndices_;
+  BufferPtr rightIndices_;
+  vector_size_t* rawLeftIndices_{nullptr};
+  vector_size_t* rawRightIndices_{nullptr};
+
+  /// Number of rows accumulated in the output.
+  vector_size_t outputSize_{0};
 
   /// A future that will be completed when right side input becomes available.
   ContinueFuture future_{false};
@@ -21,66 +21,14 @@
 
 namespace facebook::velox::exec {
 namespace {
-class MergeSourceData {
- public:
-  MergeSourceData(
-      const std::shared_ptr<const RowType>& type,
-      memory::MappedMemory* mappedMemory,
-      const RowVectorPtr& input)
-      : data_(std::make_unique<RowContainer>(type->children(), mappedMemory)) {
-    if (input) {
-      fetchRows(input);
-    }
-  }
-
-  void clear() {
-    rows_.clear();
-    data_->clear();
-    currentPos_ = 0;
-  }
-
-  void fetchRows(const RowVectorPtr& input) {
-    SelectivityVector allRows(input->size());
-    rows_.reserve(input->size());
-    for (int i = 0; i < input->size(); ++i) {
-      rows_.emplace_back(data_->newRow());
-    }
-
-    DecodedVector decoded;
-    for (int col = 0; col < input->childrenSize(); ++col) {
-      decoded.decode(*input->childAt(col), allRows);
-      for (int i = 0; i < input->size(); ++i) {
-        data_->store(decoded, i, rows_[i], col);
-      }
-    }
-  }
-
-  bool hasNext() const {
-    return currentPos_ < rows_.size();
-  }
-
-  char* next() {
-    VELOX_DCHECK_LE(currentPos_, rows_.size());
-    return rows_[currentPos_++];
-  }
-
- private:
-  size_t currentPos_ = 0;
-  std::unique_ptr<RowContainer> data_;
-  std::vector<char*> rows_;
-};
-
 class LocalMergeSource : public MergeSource {
  public:
-  LocalMergeSource(
-      const std::shared_ptr<const RowType>& rowType,
-      memory::MappedMemory* mappedMemory,
-      int queueSize)
-      : queue_(LocalMergeSourceQueue(rowType, mappedMemory, queueSize)) {}
+  explicit LocalMergeSource(int queueSize)
+      : queue_(LocalMergeSourceQueue(queueSize)) {}
 
-  BlockingReason next(ContinueFuture* future, char** row) override {
+  BlockingReason next(ContinueFuture* future, RowVectorPtr* data) override {
     return queue_.withWLock(
-        [&](auto& queue) { return queue.next(future, row); });
+        [&](auto& queue) { return queue.next(future, data); });
   }
 
   BlockingReason enqueue(RowVectorPtr input, ContinueFuture* future) override {
@@ -91,18 +39,10 @@ class LocalMergeSource : public MergeSource {
  private:
   class LocalMergeSourceQueue {
    public:
-    LocalMergeSourceQueue(
-        const std::shared_ptr<const RowType>& rowType,
-        memory::MappedMemory* mappedMemory,
-        int queueSize)
-        : rowType_(rowType),
-          mappedMemory_(mappedMemory->sharedPtr()),
-          data_(queueSize) {
-      VELOX_CHECK(mappedMemory_);
-    }
+    explicit LocalMergeSourceQueue(int queueSize) : data_(queueSize) {}
 
-    BlockingReason next(ContinueFuture* future, char** row) {
-      *row = nullptr;
+    BlockingReason next(ContinueFuture* future, RowVectorPtr* data) {
+      *data = nullptr;
 
       if (data_.empty()) {
         if (atEnd_) {
@@ -113,18 +53,12 @@ class LocalMergeSource : public MergeSource {
         return BlockingReason::kWaitForExchange;
       }
 
-      if (data_.front().hasNext()) {
-        *row = data_.front().next();
-        return BlockingReason::kNotBlocked;
-      }
-
-      // advance to next batch.
+      *data = std::move(data_.front());
       data_.pop_front();
 
       // Notify any producers.
       notifyProducers();
-
-      return next(future, row);
+      return BlockingReason::kNotBlocked;
     }
 
     BlockingReason enqueue(RowVectorPtr input, ContinueFuture* future) {
@@ -134,7 +68,7 @@ class LocalMergeSource : public MergeSource {
         return BlockingReason::kNotBlocked;
       }
       VELOX_CHECK(!data_.full(), "LocalMergeSourceQueue is full");
-      data_.push_back(MergeSourceData(rowType_, mappedMemory_.get(), input));
+      data_.push_back(std::move(input));
       notifyConsumers();
 
       if (data_.full()) {
@@ -146,14 +80,10 @@ class LocalMergeSource : public MergeSource {
     }
 
    private:
-    const std::shared_ptr<const RowType> rowType_;
-    // Since LocalMergeSource's lifetime is same as Tasks, keep mappedMemory's
-    // shared pointer to prevent prematurely when the LocalMerge operator is
-    // destroyed.
-    std::shared_ptr<memory::MappedMemory> mappedMemory_;
-
     bool atEnd_ = false;
-    boost::circular_buffer<MergeSourceData> data_;
+    // The batches are handed to the consumer as they are. The merge copies
+    // the rows it outputs from them.
+    boost::circular_buffer<RowVectorPtr> data_;
     std::vector<VeloxPromise<bool>> consumerPromises_;
     std::vector<VeloxPromise<bool>> producerPromises_;
 
@@ -179,67 +109,67 @@ class MergeExchangeSource : public MergeSource {
  public:
   MergeExchangeSource(MergeExchange* mergeExchange, const std::string& taskId)
       : mergeExchange_(mergeExchange),
-        client_(std::make_shared<ExchangeClient>(0)),
-        data_(
-            mergeExchange->outputType(),
-            mergeExchange->mappedMemory(),
-            nullptr) {
+        client_(std::make_shared<ExchangeClient>(0)) {
     client_->addRemoteTaskId(taskId);
     client_->noMoreRemoteTasks();
   }
 
-  BlockingReason next(ContinueFuture* future, char** row) override {
-    *row = nullptr;
-    if (atEnd_) {
-      return BlockingReason::kNotBlocked;
-    }
-    if (data_.hasNext()) {
-      *row = data_.next();
-      return BlockingReason::kNotBlocked;
-    }
+  BlockingReason next(ContinueFuture* future, RowVectorPtr* data) override {
+    *data = nullptr;
+    while (!atEnd_) {
+      if (!currentPage_) {
+        currentPage_ = client_->next(&atEnd_, future);
+        if (atEnd_) {
+          return BlockingReason::kNotBlocked;
+        }
 
-    if (!currentPage_) {
-      currentPage_ = client_->next(&atEnd_, future);
-      if (atEnd_) {
+        if (!currentPage_) {
+          return BlockingReason::kWaitForExchange;
+        }
+      }
+      if (auto group = currentPage_->rowVectorGroup()) {
+        // Copies the rows of a page from a Task of this process, since the
+        // producer owns their memory.
+        *data = std::static_pointer_cast<RowVector>(BaseVector::create(
+            mergeExchange_->outputType(),
+            group->numRows(),
+            mergeExchange_->pool()));
+        group->copyTo(**data, 0);
+        mergeExchange_->stats().rawInputBytes += currentPage_->byteSize();
+        mergeExchange_->stats().inputPositions += group->numRows();
+        mergeExchange_->stats().inputBytes += (*data)->retainedSize();
+        currentPage_ = nullptr;
         return BlockingReason::kNotBlocked;
       }
-
-      if (!currentPage_) {
-        return BlockingReason::kWaitForExchange;
+      if (!inputStream_) {
+        inputStream_ = std::make_unique<ByteStream>();
+        mergeExchange_->stats().rawInputBytes += currentPage_->byteSize();
+        currentPage_->prepareStreamForDeserialize(inputStream_.get());
       }
-    }
-    if (!inputStream_) {
-      inputStream_ = std::make_unique<ByteStream>();
-      mergeExchange_->stats().rawInputBytes += currentPage_->byteSize();
-      currentPage_->prepareStreamForDeserialize(inputStream_.get());
-    }
-
-    data_.clear();
-
-    if (!inputStream_->atEnd()) {
-      RowVectorPtr result;
-      VectorStreamGroup::read(
-          inputStream_.get(),
-          mergeExchange_->pool(),
-          mergeExchange_->outputType(),
-          &result);
 
-      mergeExchange_->stats().inputPositions += result->size();
-      mergeExchange_->stats().inputBytes += result->retainedSize();
+      if (!inputStream_->atEnd()) {
+        VectorStreamGroup::read(
+            inputStream_.get(),
+            mergeExchange_->pool(),
+            mergeExchange_->outputType(),
+            data,
+            &mergeExchange_->serdeOptions());
 
-      data_.fetchRows(result);
-    }
+        mergeExchange_->stats().inputPositions += (*data)->size();
+        mergeExchange_->stats().inputBytes += (*data)->retainedSize();
+      }
 
-    // Since VectorStreamGroup::read() may cause inputStream to be at end,
-    // check again and reset currentPage_ and inputStream_ here.
-    if (inputStream_->atEnd()) {
-      // Reached end of the stream.
-      currentPage_ = nullptr;
-      inputStream_ = nullptr;
-    }
+      // Since VectorStreamGroup::read() may cause inputStream to be at end,
+      // check again and reset currentPage_ and inputStream_ here.
+      if (inputStream_->atEnd()) {
+        // Reached end of the stream.
+        currentPage_ = nullptr;
+        inputStream_ = nullptr;
+      }
 
-    if (data_.hasNext()) {
-      *row = data_.next();
+      if (*data) {
+        return BlockingReason::kNotBlocked;
+      }
     }
     return BlockingReason::kNotBlocked;
   }
@@ -249,7 +179,6 @@ class MergeExchangeSource : public MergeSource {
   std::shared_ptr<ExchangeClient> client_;
   std::unique_ptr<ByteStream> inputStream_;
   std::unique_ptr<SerializedPage> currentPage_;
-  MergeSourceData data_;
   bool atEnd_ = false;
 
   BlockingReason enqueue(RowVectorPtr input, ContinueFuture* future) override {
@@ -258,14 +187,11 @@ class MergeExchangeSource : public MergeSource {
 };
 } // namespace
 
-std::shared_ptr<MergeSource> MergeSource::createLocalMergeSource(
-    const std::shared_ptr<const RowType>& rowType,
-    memory::MappedMemory* mappedMemory) {
+std::shared_ptr<MergeSource> MergeSource::createLocalMergeSource() {
   // Buffer up to 2 vectors from each source before blocking to wait
   // for consumers.
   static const int kDefaultQueueSize = 2;
-  return std::make_shared<LocalMergeSource>(
-      rowType, mappedMemory, kDefaultQueueSize);
+  return std::make_shared<LocalMergeSource>(kDefaultQueueSize);
 }
 
 std::shared_ptr<MergeSource> MergeSource::createMergeExchangeSource(
@@ -24,15 +24,17 @@ class MergeExchange;
 class MergeSource {
  public:
   virtual ~MergeSource() {}
-  virtual BlockingReason next(ContinueFuture* future, char** row) = 0;
+
+  // Sets 'data' to the next sorted batch or to nullptr if the source is at
+  // end.
+  virtual BlockingReason next(ContinueFuture* future, RowVectorPtr* data) = 0;
+
   virtual BlockingReason enqueue(
       RowVectorPtr input,
       ContinueFuture* future) = 0;
 
   // Factory methods to create MergeSources.
-  static std::shared_ptr<MergeSource> createLocalMergeSource(
-      const std::shared_ptr<const RowType>& rowType,
-      memory::MappedMemory* mappedMemory);
+  static std::shared_ptr<MergeSource> createLocalMergeSource();
   static std::shared_ptr<MergeSource> createMergeExchangeSource(
       MergeExchange* mergeExchange,
       const std::string& taskId);
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/NormalizedKey.h"
+#include "velox/exec/Operator.h"
+
+namespace facebook::velox::exec {
+
+namespace {
+// Accumulates big-endian bytes into a normalized_key_t.
+class KeyWriter {
+ public:
+  // Appends the low 'width' bytes of 'value'. Keeps only the high bytes if
+  // fewer than 'width' bytes are left. Returns false if the key is full.
+  bool append(uint64_t value, int32_t width) {
+    if (width < sizeof(uint64_t)) {
+      value &= (1UL << (8 * width)) - 1;
+    }
+    if (width >= remaining_) {
+      key_ = shift(key_, remaining_) | (value >> (8 * (width - remaining_)));
+      remaining_ = 0;
+      return false;
+    }
+    key_ = shift(key_, width) | value;
+    remaining_ -= width;
+    return true;
+  }
+
+  int32_t remaining() const {
+    return remaining_;
+  }
+
+  // Returns the key with the bytes not written set to 'pad'.
+  normalized_key_t finish(uint8_t pad = 0) const {
+    auto padding = pad ? std::numeric_limits<uint64_t>::max() : 0;
+    return shift(key_, remaining_) | (padding & ~shift(~0UL, remaining_));
+  }
+
+ private:
+  static uint64_t shift(uint64_t value, int32_t bytes) {
+    return bytes >= sizeof(uint64_t) ? 0 : value << (8 * bytes);
+  }
+
+  uint64_t key_{0};
+  int32_t remaining_{sizeof(normalized_key_t)};
+};
+
+int32_t fixedWidth(TypeKind kind) {
+  switch (kind) {
+    case TypeKind::BOOLEAN:
+    case TypeKind::TINYINT:
+      return 1;
+    case TypeKind::SMALLINT:
+      return 2;
+    case TypeKind::INTEGER:
+      return 4;
+    case TypeKind::BIGINT:
+      return 8;
+    default:
+      VELOX_UNREACHABLE();
+  }
+}
+
+// Returns the value as an unsigned integer of 'width' bytes that orders
+// like the signed value.
+template <typename T>
+uint64_t flipSign(T value) {
+  using Unsigned = std::make_unsigned_t<T>;
+  return static_cast<Unsigned>(value) ^
+      (static_cast<Unsigned>(1) << (sizeof(T) * 8 - 1));
+}
+
+uint64_t integerBytes(
+    const DecodedVector& decoded,
+    TypeKind kind,
+    vector_size_t index) {
+  switch (kind) {
+    case TypeKind::BOOLEAN:
+      return decoded.valueAt<bool>(index) ? 1 : 0;
+    case TypeKind::TINYINT:
+      return flipSign(decoded.valueAt<int8_t>(index));
+    case TypeKind::SMALLINT:
+      return flipSign(decoded.valueAt<int16_t>(index));
+    case TypeKind::INTEGER:
+      return flipSign(decoded.valueAt<int32_t>(index));
+    case TypeKind::BIGINT:
+      return flipSign(decoded.valueAt<int64_t>(index));
+    default:
+      VELOX_UNREACHABLE();
+  }
+}
+} // namespace
+
+// static
+bool NormalizedKeyEncoder::isSupported(TypeKind kind) {
+  switch (kind) {
+    case TypeKind::BOOLEAN:
+    case TypeKind::TINYINT:
+    case TypeKind::SMALLINT:
+    case TypeKind::INTEGER:
+    case TypeKind::BIGINT:
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// static
+std::unique_ptr<NormalizedKeyEncoder> NormalizedKeyEncoder::create(
+    const RowTypePtr& type,
+    const std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>&
+        sortingKeys,
+    const std::vector<core::SortOrder>& sortingOrders) {
+  std::vector<Key> keys;
+  for (auto i = 0; i < sortingKeys.size(); ++i) {
+    auto channel = exprToChannel(sortingKeys[i].get(), type);
+    auto kind = type->childAt(channel)->kind();
+    if (!isSupported(kind)) {
+      break;
+    }
+    keys.push_back({channel, kind, sortingOrders[i]});
+    if (kind == TypeKind::VARCHAR || kind == TypeKind::VARBINARY) {
+      break;
+    }
+  }
+  if (keys.empty()) {
+    return nullptr;
+  }
+  return std::unique_ptr<NormalizedKeyEncoder>(
+      new NormalizedKeyEncoder(std::move(keys)));
+}
+
+normalized_key_t NormalizedKeyEncoder::encode(
+    const std::vector<DecodedVector>& decodedVectors,
+    vector_size_t index) const {
+  KeyWriter writer;
+  for (auto& key : keys_) {
+    auto& decoded = decodedVectors[key.channel];
+    bool isNull = decoded.isNullAt(index);
+    // Nulls get the lowest or highest value. Ties with non-null values are
+    // resolved by comparing the full keys.
+    uint8_t nullPad = key.order.isNullsFirst() ? 0 : 0xff;
+    if (key.kind == TypeKind::VARCHAR || key.kind == TypeKind::VARBINARY) {
+      if (isNull) {
+        return writer.finish(nullPad);
+      }
+      auto value = decoded.valueAt<StringView>(index);
+      auto data = reinterpret_cast<const uint8_t*>(value.data());
+      auto size = std::min<int32_t>(value.size(), writer.remaining());
+      uint8_t mask = key.order.isAscending() ? 0 : 0xff;
+      for (auto i = 0; i < size; ++i) {
+        writer.append(data[i] ^ mask, 1);
+      }
+      // A string that is a prefix of another goes first in ascending order
+      // and last in descending order.
+      return writer.finish(mask);
+    }
+    uint64_t bytes;
+    if (isNull) {
+      bytes = nullPad ? std::numeric_limits<uint64_t>::max() : 0;
+    } else {
+      bytes = integerBytes(decoded, key.kind, index);
+      if (!key.order.isAscending()) {
+        bytes = ~bytes;
+      }
+    }
+    if (!writer.append(bytes, fixedWidth(key.kind))) {
+      break;
+    }
+  }
+  return writer.finish();
+}
+
+} // namespace facebook::velox::exec
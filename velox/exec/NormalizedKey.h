@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/core/PlanNode.h"
+#include "velox/exec/RowContainer.h"
+#include "velox/vector/DecodedVector.h"
+
+namespace facebook::velox::exec {
+
+// Encodes a prefix of the sorting keys of a row into a normalized_key_t so
+// that comparing two normalized keys as unsigned integers agrees with the
+// order of the rows: if a row goes before another, its normalized key is
+// less or equal to the other's. Rows with equal normalized keys must be
+// compared on the full keys.
+//
+// Each key is encoded as the big-endian bytes of its value with the sign
+// bit flipped, inverted for descending order. A null is encoded as all
+// zeros or all ones depending on the null order, so that it ties at worst
+// with the lowest or highest value. Integer and boolean keys have a fixed
+// width, so the next key follows. A string key is truncated to the
+// remaining bytes and ends the prefix, as does a key of any other type. The
+// encoding stops when the 8 bytes are full.
+class NormalizedKeyEncoder {
+ public:
+  // Returns nullptr if the first sorting key is not of a type that can be
+  // encoded.
+  static std::unique_ptr<NormalizedKeyEncoder> create(
+      const RowTypePtr& type,
+      const std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>&
+          sortingKeys,
+      const std::vector<core::SortOrder>& sortingOrders);
+
+  // Returns the normalized key of row 'index'. 'decodedVectors' are the
+  // decoded columns of the input, indexed by channel.
+  normalized_key_t encode(
+      const std::vector<DecodedVector>& decodedVectors,
+      vector_size_t index) const;
+
+ private:
+  struct Key {
+    ChannelIndex channel;
+    TypeKind kind;
+    core::SortOrder order;
+  };
+
+  explicit NormalizedKeyEncoder(std::vector<Key> keys)
+      : keys_(std::move(keys)) {}
+
+  // Returns true if a key of 'kind' can be encoded.
+  static bool isSupported(TypeKind kind);
+
+  // The keys that are encoded, at most up to the first string key.
+  const std::vector<Key> keys_;
+};
+
+} // namespace facebook::velox::exec
@@ -152,15 +152,20 @@ RowVectorPtr Operator::fillOutput(vector_size_t size, BufferPtr mapping) {
 }
 
 void Operator::inputProcessed() {
-  input_ = nullptr;
   if (!output_.unique()) {
     output_ = nullptr;
-    return;
+  } else {
+    auto& columns = output_->children();
+    for (auto& projection : identityProjections_) {
+      columns[projection.outputChannel] = nullptr;
+    }
   }
-  auto& columns = output_->children();
-  for (auto& projection : identityProjections_) {
-    columns[projection.outputChannel] = nullptr;
+  // The columns of a singly referenced input that are not referenced
+  // from 'output_' or elsewhere can be reused for a later batch.
+  if (input_.unique()) {
+    operatorCtx_->vectorPool().release(input_->children());
   }
+  input_ = nullptr;
 }
 
 void Operator::clearIdentityProjectedOutput() {
@@ -172,12 +177,15 @@ void Operator::clearIdentityProjectedOutput() {
   }
 }
 
-void Operator::recordBlockingTime(uint64_t start) {
+void Operator::recordBlockingTime(uint64_t start, BlockingReason reason) {
   uint64_t now =
       std::chrono::duration_cast<std::chrono::microseconds>(
           std::chrono::high_resolution_clock::now().time_since_epoch())
           .count();
-  stats_.blockedWallNanos += (now - start) * 1000;
+  const uint64_t blockedNanos = (now - start) * 1000;
+  stats_.blockedWallNanos += blockedNanos;
+  stats_.blockedWallNanosByReason[static_cast<int32_t>(reason)] +=
+      blockedNanos;
 }
 
 std::string Operator::toString() {
@@ -255,6 +263,10 @@ void OperatorStats::add(const OperatorStats& other) {
   physicalWrittenBytes += other.physicalWrittenBytes;
 
   blockedWallNanos += other.blockedWallNanos;
+  for (auto i = 0; i < kNumBlockingReasons; ++i) {
+    blockedWallNanosByReason[i] += other.blockedWallNanosByReason[i];
+  }
+  queuedWallNanos += other.queuedWallNanos;
 
   finishTiming.add(other.finishTiming);
 
@@ -281,6 +293,8 @@ void OperatorStats::clear() {
   physicalWrittenBytes = 0;
 
   blockedWallNanos = 0;
+  blockedWallNanosByReason.fill(0);
+  queuedWallNanos = 0;
 
   finishTiming.clear();
 
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <array>
 #include "velox/common/time/CpuWallTimer.h"
 #include "velox/core/PlanNode.h"
 #include "velox/exec/Driver.h"
@@ -31,13 +32,30 @@ struct IdentityProjection {
   const ChannelIndex outputChannel;
 };
 
+// A dynamically generated filter on several columns together.
+struct MultiColumnDynamicFilter {
+  std::vector<ChannelIndex> channels;
+  std::shared_ptr<common::BigintTuplesUsingBloomFilter> filter;
+};
+
 struct MemoryStats {
+  // Maximum number of samples in 'timeline'.
+  static constexpr int32_t kMaxTimelineSamples = 256;
+
   uint64_t userMemoryReservation = {};
   uint64_t revocableMemoryReservation = {};
   uint64_t systemMemoryReservation = {};
   uint64_t peakUserMemoryReservation = {};
   uint64_t peakSystemMemoryReservation = {};
   uint64_t peakTotalMemoryReservation = {};
+  // Total reservation over time if the MemoryUsageTracker records a
+  // timeline. For stats of several Drivers, this is the sum of their
+  // timelines. See FLAGS_velox_memory_timeline_interval_ms.
+  std::vector<memory::MemoryUsageSample> timeline;
+  // The reservation at the time of the query's peak memory usage,
+  // TaskStats::peakTotalMemoryTimeMs. Set by Task::taskStats() from
+  // 'timeline'.
+  uint64_t reservationAtQueryPeak = {};
 
   void update(const std::shared_ptr<memory::MemoryUsageTracker>& tracker) {
     if (!tracker) {
@@ -48,6 +66,7 @@ struct MemoryStats {
     peakUserMemoryReservation = tracker->getPeakUserBytes();
     peakSystemMemoryReservation = tracker->getPeakSystemBytes();
     peakTotalMemoryReservation = tracker->getPeakTotalBytes();
+    timeline = tracker->timeline();
   }
 
   void add(const MemoryStats& other) {
@@ -60,6 +79,11 @@ struct MemoryStats {
         peakSystemMemoryReservation, other.peakSystemMemoryReservation);
     peakTotalMemoryReservation =
         std::max(peakTotalMemoryReservation, other.peakTotalMemoryReservation);
+    if (!other.timeline.empty()) {
+      timeline = memory::addMemoryTimelines(
+          timeline, other.timeline, kMaxTimelineSamples);
+    }
+    reservationAtQueryPeak += other.reservationAtQueryPeak;
   }
 
   void clear() {
@@ -69,6 +93,8 @@ struct MemoryStats {
     peakUserMemoryReservation = 0;
     peakSystemMemoryReservation = 0;
     peakTotalMemoryReservation = 0;
+    timeline.clear();
+    reservationAtQueryPeak = 0;
   }
 };
 
@@ -122,7 +148,14 @@ struct OperatorStats {
 
   uint64_t physicalWrittenBytes = 0;
 
+  // Total time the Driver waited for the futures of this Operator.
   uint64_t blockedWallNanos = 0;
+  // 'blockedWallNanos' by BlockingReason. The subscript is the reason.
+  std::array<uint64_t, kNumBlockingReasons> blockedWallNanosByReason{};
+
+  // Time the Driver spent in the executor queue before continuing at this
+  // Operator.
+  uint64_t queuedWallNanos = 0;
 
   CpuWallTiming finishTiming;
 
@@ -180,6 +213,11 @@ class OperatorCtx {
     return driverCtx_;
   }
 
+  // Returns the pool of vectors shared by the Operators of the Driver.
+  VectorPool& vectorPool() const {
+    return driverCtx_->vectorPool;
+  }
+
  private:
   DriverCtx* driverCtx_;
   velox::memory::MemoryPool* pool_;
@@ -273,10 +311,18 @@ class Operator {
     return dynamicFilters_;
   }
 
+  // Returns dynamically generated filters on several columns together, e.g.
+  // on a composite join key, with the channels of the columns.
+  const std::vector<MultiColumnDynamicFilter>& getMultiColumnDynamicFilters()
+      const {
+    return multiColumnDynamicFilters_;
+  }
+
   // Clears dynamically generated filters. Called after filters were pushed
   // down.
   virtual void clearDynamicFilters() {
     dynamicFilters_.clear();
+    multiColumnDynamicFilters_.clear();
   }
 
   // Returns true if this operator would accept a filter dynamically generated
@@ -295,6 +341,17 @@ class Operator {
         toString());
   }
 
+  // Adds a filter on the columns at 'outputChannels' together. Called only if
+  // canAddFilter() returns true.
+  virtual void addDynamicFilter(
+      const std::vector<ChannelIndex>& /*outputChannels*/,
+      const std::shared_ptr<common::BigintTuplesUsingBloomFilter>&
+      /*filter*/) {
+    VELOX_UNSUPPORTED(
+        "This operator doesn't support dynamic filter pushdown: {}",
+        toString());
+  }
+
   // Returns a list of identify projections, e.g. columns that are projected
   // as-is possibly after applying a filter.
   const std::vector<IdentityProjection>& identityProjections() const {
@@ -309,6 +366,13 @@ class Operator {
     results_.clear();
   }
 
+  // Frees up to 'targetBytes' of memory held by 'this', e.g. by
+  // spilling its state to disk. Called by memory arbitration while the
+  // Driver of 'this' is paused. Returns the number of bytes freed.
+  virtual int64_t reclaim(int64_t /*targetBytes*/) {
+    return 0;
+  }
+
   // Returns true if 'this' never has more output rows than input rows.
   virtual bool isFilter() const {
     return false;
@@ -322,7 +386,9 @@ class Operator {
     return stats_;
   }
 
-  void recordBlockingTime(uint64_t start);
+  // Adds the time since 'start' in microseconds to the blocked time for
+  // 'reason'.
+  void recordBlockingTime(uint64_t start, BlockingReason reason);
 
   virtual std::string toString();
 
@@ -408,6 +474,8 @@ class Operator {
 
   std::unordered_map<ChannelIndex, std::shared_ptr<common::Filter>>
       dynamicFilters_;
+
+  std::vector<MultiColumnDynamicFilter> multiColumnDynamicFilters_;
 };
 
 constexpr ChannelIndex kConstantChannel =
@@ -28,9 +28,29 @@ OrderBy::OrderBy(
           operatorId,
           orderByNode->id(),
           "OrderBy"),
+      normalizedKeyEncoder_(NormalizedKeyEncoder::create(
+          outputType_,
+          orderByNode->sortingKeys(),
+          orderByNode->sortingOrders())),
       data_(std::make_unique<RowContainer>(
           outputType_->as<TypeKind::ROW>().children(),
-          operatorCtx_->mappedMemory())) {
+          true, // nullableKeys
+          std::vector<std::unique_ptr<Aggregate>>{},
+          std::vector<TypePtr>{},
+          false, // hasNext
+          false, // isJoinBuild
+          false, // hasProbedFlag
+          normalizedKeyEncoder_ != nullptr, // hasNormalizedKey
+          operatorCtx_->mappedMemory(),
+          ContainerRowSerde::instance())),
+      spillMemoryThreshold_(
+          driverCtx->execCtx->queryCtx()->config().spillEnabled()
+              ? driverCtx->execCtx->queryCtx()
+                    ->config()
+                    .orderBySpillMemoryThreshold()
+              : 0),
+      spillPath_(driverCtx->execCtx->queryCtx()->config().spillPath()),
+      decodedVectors_(outputType_->size()) {
   auto type = orderByNode->outputType();
   auto numKeys = orderByNode->sortingKeys().size();
   for (int i = 0; i < numKeys; ++i) {
@@ -49,51 +69,188 @@ void OrderBy::addInput(RowVectorPtr input) {
     rows[row] = data_->newRow();
   }
   for (size_t col = 0; col < input->childrenSize(); ++col) {
-    DecodedVector decoded(*input->childAt(col), allRows);
+    auto& decoded = decodedVectors_[col];
+    decoded.decode(*input->childAt(col), allRows);
     for (int i = 0; i < input->size(); ++i) {
       data_->store(decoded, i, rows[i], col);
     }
   }
+  if (normalizedKeyEncoder_) {
+    for (int i = 0; i < input->size(); ++i) {
+      RowContainer::normalizedKey(rows[i]) =
+          normalizedKeyEncoder_->encode(decodedVectors_, i);
+    }
+  }
 
   numRows_ += allRows.size();
+
+  if (spillMemoryThreshold_ != 0 &&
+      data_->allocatedBytes() > spillMemoryThreshold_) {
+    spill();
+  }
 }
 
 void OrderBy::finish() {
   Operator::finish();
 
+  if (!spillRuns_.empty()) {
+    // The rows still in memory become the last run so that all output comes
+    // from the merge.
+    spill();
+    std::vector<std::unique_ptr<SpillStream>> streams;
+    streams.reserve(spillRuns_.size());
+    for (auto& run : spillRuns_) {
+      run->finishWrite();
+      streams.push_back(std::make_unique<SpillStream>(std::move(run)));
+    }
+    spillRuns_.clear();
+    spillMerge_ = std::make_unique<TreeOfLosers<SpillRow, SpillStream>>(
+        std::move(streams));
+    return;
+  }
+
   // No data.
   if (numRows_ == 0) {
     finished_ = true;
     return;
   }
 
+  sortRows();
+}
+
+void OrderBy::sortRows() {
   // Sort the pointers to the rows in RowContainer (data_) instead of sorting
   // the rows.
   returningRows_.resize(numRows_);
   RowContainerIterator iter;
   data_->listRows(&iter, numRows_, returningRows_.data());
 
+  auto compareRows = [this](const char* leftRow, const char* rightRow) {
+    for (auto& key : keyInfo_) {
+      if (auto result = data_->compare(
+              leftRow,
+              rightRow,
+              key.first,
+              {key.second.isNullsFirst(), key.second.isAscending(), false})) {
+        return result < 0;
+      }
+    }
+    return false; // lhs == rhs.
+  };
+  if (!normalizedKeyEncoder_) {
+    std::sort(returningRows_.begin(), returningRows_.end(), compareRows);
+    return;
+  }
+
+  // Sorts the normalized keys next to the row pointers, so that the rows
+  // are only accessed when the normalized keys are equal.
+  std::vector<std::pair<normalized_key_t, char*>> entries(numRows_);
+  for (auto i = 0; i < numRows_; ++i) {
+    entries[i] = {
+        RowContainer::normalizedKey(returningRows_[i]), returningRows_[i]};
+  }
   std::sort(
-      returningRows_.begin(),
-      returningRows_.end(),
-      [this](const char* leftRow, const char* rightRow) {
-        for (auto& key : keyInfo_) {
-          if (auto result = data_->compare(
-                  leftRow,
-                  rightRow,
-                  key.first,
-                  {key.second.isNullsFirst(),
-                   key.second.isAscending(),
-                   false})) {
-            return result < 0;
-          }
+      entries.begin(),
+      entries.end(),
+      [&](const std::pair<normalized_key_t, char*>& left,
+          const std::pair<normalized_key_t, char*>& right) {
+        if (left.first != right.first) {
+          return left.first < right.first;
         }
-        return false; // lhs == rhs.
+        return compareRows(left.second, right.second);
       });
+  for (auto i = 0; i < numRows_; ++i) {
+    returningRows_[i] = entries[i].second;
+  }
+}
+
+void OrderBy::spill() {
+  if (numRows_ == 0) {
+    return;
+  }
+  sortRows();
+  auto run = std::make_unique<SpillFile>(
+      outputType_, spillPath_, operatorCtx_->mappedMemory(), pool());
+  auto batchSize = data_->estimatedNumRowsPerBatch(kBatchSizeInBytes);
+  for (size_t offset = 0; offset < returningRows_.size();
+       offset += batchSize) {
+    auto numRows = std::min<size_t>(batchSize, returningRows_.size() - offset);
+    auto batch = std::static_pointer_cast<RowVector>(
+        BaseVector::create(outputType_, numRows, pool()));
+    for (int i = 0; i < outputType_->size(); ++i) {
+      data_->extractColumn(
+          returningRows_.data() + offset, numRows, i, batch->childAt(i));
+    }
+    run->append(batch);
+  }
+  stats_.addRuntimeStat("spilledBytes", run->size());
+  stats_.addRuntimeStat("spilledRows", run->numRows());
+  spillRuns_.push_back(std::move(run));
+
+  returningRows_.clear();
+  numRows_ = 0;
+  data_->clear();
+}
+
+int64_t OrderBy::reclaim(int64_t /*targetBytes*/) {
+  if (spillMemoryThreshold_ == 0 || isFinishing_ || numRows_ == 0) {
+    return 0;
+  }
+  auto bytes = data_->allocatedBytes();
+  spill();
+  return bytes - data_->allocatedBytes();
+}
+
+RowVectorPtr OrderBy::getOutputFromSpill() {
+  auto maxRows = data_->estimatedNumRowsPerBatch(kBatchSizeInBytes);
+  std::vector<SpillRow> rows;
+  rows.reserve(maxRows);
+  auto compare = [this](const SpillRow& left, const SpillRow& right) {
+    return compareSpillRows(left, right, keyInfo_);
+  };
+  while (rows.size() < maxRows) {
+    auto row = spillMerge_->next(compare);
+    if (!row.has_value()) {
+      break;
+    }
+    rows.push_back(std::move(row.value()));
+  }
+  if (rows.empty()) {
+    finished_ = true;
+    spillMerge_.reset();
+    return nullptr;
+  }
+
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(outputType_, rows.size(), pool()));
+  // Copies runs of consecutive rows from the same batch at a time.
+  vector_size_t start = 0;
+  while (start < rows.size()) {
+    vector_size_t end = start + 1;
+    while (end < rows.size() && rows[end].rows == rows[start].rows &&
+           rows[end].index == rows[start].index + (end - start)) {
+      ++end;
+    }
+    for (int i = 0; i < outputType_->size(); ++i) {
+      result->childAt(i)->copy(
+          rows[start].rows->childAt(i).get(),
+          start,
+          rows[start].index,
+          end - start);
+    }
+    start = end;
+  }
+  return result;
 }
 
 RowVectorPtr OrderBy::getOutput() {
-  if (finished_ || !isFinishing_ || returningRows_.size() == numRowsReturned_) {
+  if (finished_ || !isFinishing_) {
+    return nullptr;
+  }
+  if (spillMerge_) {
+    return getOutputFromSpill();
+  }
+  if (returningRows_.size() == numRowsReturned_) {
     return nullptr;
   }
 
@@ -16,8 +16,11 @@
 #pragma once
 
 #include "velox/exec/ContainerRowSerde.h"
+#include "velox/exec/NormalizedKey.h"
 #include "velox/exec/Operator.h"
 #include "velox/exec/RowContainer.h"
+#include "velox/exec/Spill.h"
+#include "velox/exec/TreeOfLosers.h"
 
 namespace facebook::velox::exec {
 
@@ -27,11 +30,20 @@ namespace facebook::velox::exec {
 // to the rows using the RowContainer's compare() function. And finally it
 // constructs and returns the sorted output RowVector using the data in the
 // RowContainer.
+// If the first sorting key is an integer or a string, each row gets a
+// normalized key that encodes a prefix of the sorting keys. The sort then
+// compares the normalized keys and only compares the rows on ties.
+// If spilling is enabled and the RowContainer grows past the configured
+// threshold, the accumulated rows are sorted into a run that is written to a
+// SpillFile and the RowContainer is cleared. At finish(), the rows still in
+// memory become the last run and the runs are merged with a TreeOfLosers
+// while producing output. In this way the memory used is bounded by the
+// threshold plus one batch per run.
 // Limitations:
 // * It memcopies twice: 1) input to RowContainer and 2) RowContainer to
 // output.
-// * It does not support spilling. For now, if memory limit exceeds, it will
-// throw an exception: VeloxMemoryCapExceeded.
+// * Without spilling, if memory limit exceeds, it will throw an exception:
+// VeloxMemoryCapExceeded.
 class OrderBy : public Operator {
  public:
   OrderBy(
@@ -53,9 +65,26 @@ class OrderBy : public Operator {
     return BlockingReason::kNotBlocked;
   }
 
+  // Spills the accumulated rows if spilling is enabled and input is still
+  // being added.
+  int64_t reclaim(int64_t targetBytes) override;
+
  private:
   static const int32_t kBatchSizeInBytes{2 * 1024 * 1024};
 
+  // Sorts the pointers to the rows in 'data_' into 'returningRows_'.
+  void sortRows();
+
+  // Sorts the rows in 'data_' and writes them to a new SpillFile. Clears
+  // 'data_' afterwards.
+  void spill();
+
+  // Returns the next batch of output from merging the spilled runs.
+  RowVectorPtr getOutputFromSpill();
+
+  // Set if the sorting keys have a normalized key prefix.
+  const std::unique_ptr<NormalizedKeyEncoder> normalizedKeyEncoder_;
+
   std::unique_ptr<RowContainer> data_;
   std::vector<std::pair<ChannelIndex, core::SortOrder>> keyInfo_;
 
@@ -63,6 +92,21 @@ class OrderBy : public Operator {
   size_t numRowsReturned_ = 0;
   std::vector<char*> returningRows_;
 
+  // Spill 'data_' when its allocated bytes exceed this. 0 if spilling is
+  // disabled.
+  const uint64_t spillMemoryThreshold_;
+
+  const std::string spillPath_;
+
+  // Sorted runs spilled so far.
+  std::vector<std::unique_ptr<SpillFile>> spillRuns_;
+
+  // Merges the spilled runs. Set in finish() if anything was spilled.
+  std::unique_ptr<TreeOfLosers<SpillRow, SpillStream>> spillMerge_;
+
+  // The decoded columns of the input being added.
+  std::vector<DecodedVector> decodedVectors_;
+
   bool finished_ = false;
 };
 } // namespace facebook::velox::exec
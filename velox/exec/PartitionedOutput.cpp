@@ -35,17 +35,26 @@ BlockingReason Destination::advance(
   }
   auto firstRow = row_;
   for (; row_ < rows_.size(); ++row_) {
-    // TODO Add support for serializing partial ranges if
-    //  the full range is too big
-    for (vector_size_t i = 0; i < rows_[row_].size; i++) {
-      bytesInCurrent_ += sizes[rows_[row_].begin + i];
-    }
-    if (bytesInCurrent_ >= maxBytes) {
-      serialize(output, firstRow, row_ + 1);
-      if (row_ == rows_.size() - 1) {
-        *atEnd = true;
+    auto& range = rows_[row_];
+    for (vector_size_t i = 0; i < range.size; i++) {
+      bytesInCurrent_ += sizes[range.begin + i];
+      if (bytesInCurrent_ < maxBytes) {
+        continue;
+      }
+      if (i + 1 < range.size) {
+        // Serializes the head of the range and leaves the rest for the
+        // next page.
+        IndexRange rest{range.begin + i + 1, range.size - i - 1};
+        range.size = i + 1;
+        serialize(output, firstRow, row_ + 1);
+        range = rest;
+      } else {
+        serialize(output, firstRow, row_ + 1);
+        ++row_;
+        if (row_ == rows_.size()) {
+          *atEnd = true;
+        }
       }
-      ++row_;
       return flush(bufferManager, future);
     }
   }
@@ -58,6 +67,16 @@ void Destination::serialize(
     const RowVectorPtr& output,
     vector_size_t begin,
     vector_size_t end) {
+  if (unserialized_) {
+    if (!current_) {
+      auto producer = unserializedProducer_.lock();
+      VELOX_CHECK_NOT_NULL(producer, "The producer Task was destructed");
+      current_ = std::make_unique<RowVectorGroup>(memory_, producer);
+    }
+    static_cast<RowVectorGroup*>(current_.get())
+        ->append(output, folly::Range(&rows_[begin], end - begin));
+    return;
+  }
   if (!current_) {
     current_ = std::make_unique<VectorStreamGroup>(memory_);
     auto rowType = std::dynamic_pointer_cast<const RowType>(output->type());
@@ -65,7 +84,7 @@ void Destination::serialize(
     for (vector_size_t i = begin; i < end; i++) {
       numRows += rows_[i].size;
     }
-    current_->createStreamTree(rowType, numRows);
+    current_->createStreamTree(rowType, numRows, serdeOptions_);
   }
   current_->append(output, folly::Range(&rows_[begin], end - begin));
 }
@@ -76,6 +95,9 @@ BlockingReason Destination::flush(
   if (!current_) {
     return BlockingReason::kNotBlocked;
   }
+  if (unserialized_) {
+    static_cast<RowVectorGroup*>(current_.get())->setSize(bytesInCurrent_);
+  }
   bytesInCurrent_ = 0;
   return bufferManager.enqueue(
       taskId_, destination_, std::move(current_), future);
@@ -106,8 +128,13 @@ void PartitionedOutput::initializeDestinations() {
   if (destinations_.empty()) {
     auto memory = operatorCtx_->mappedMemory();
     auto taskId = operatorCtx_->taskId();
+    std::weak_ptr<Task> producer;
+    if (unserialized_) {
+      producer = operatorCtx_->task();
+    }
     for (int i = 0; i < numDestinations_; ++i) {
-      destinations_.push_back(std::make_unique<Destination>(taskId, i, memory));
+      destinations_.push_back(std::make_unique<Destination>(
+          taskId, i, memory, &serdeOptions_, producer));
     }
   }
 }
@@ -175,7 +202,8 @@ void PartitionedOutput::addInput(RowVectorPtr input) {
         start = 1;
       }
       for (auto i = start; i < numInput; ++i) {
-        if (nullRows_.isValid(i)) {
+        if (nullRows_.isValid(i) ||
+            partitions_[i] == core::PartitionFunction::kAllPartitions) {
           for (auto& destination : destinations_) {
             destination->addRow(i);
           }
@@ -185,7 +213,13 @@ void PartitionedOutput::addInput(RowVectorPtr input) {
       }
     } else {
       for (vector_size_t i = 0; i < numInput; ++i) {
-        destinations_[partitions_[i]]->addRow(i);
+        if (partitions_[i] == core::PartitionFunction::kAllPartitions) {
+          for (auto& destination : destinations_) {
+            destination->addRow(i);
+          }
+        } else {
+          destinations_[partitions_[i]]->addRow(i);
+        }
       }
     }
   }
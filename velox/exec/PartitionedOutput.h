@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include "velox/exec/Exchange.h"
 #include "velox/exec/Operator.h"
 #include "velox/exec/PartitionedOutputBufferManager.h"
 
@@ -27,8 +28,15 @@ class Destination {
   Destination(
       const std::string& taskId,
       int destination,
-      memory::MappedMemory* memory)
-      : taskId_(taskId), destination_(destination), memory_(memory) {}
+      memory::MappedMemory* memory,
+      const VectorSerde::Options* serdeOptions,
+      std::weak_ptr<Task> unserializedProducer = {})
+      : taskId_(taskId),
+        destination_(destination),
+        memory_(memory),
+        serdeOptions_(serdeOptions),
+        unserialized_(!unserializedProducer.expired()),
+        unserializedProducer_(std::move(unserializedProducer)) {}
 
   // Resets the destination before starting a new batch.
   void beginBatch() {
@@ -36,8 +44,14 @@ class Destination {
     row_ = 0;
   }
 
+  // Adds 'row' to the rows to serialize. Extends the last range if 'row'
+  // follows it, so that clustered partitions serialize as few ranges.
   void addRow(vector_size_t row) {
-    rows_.push_back(IndexRange{row, 1});
+    if (!rows_.empty() && rows_.back().begin + rows_.back().size == row) {
+      ++rows_.back().size;
+    } else {
+      rows_.push_back(IndexRange{row, 1});
+    }
   }
 
   void addRows(const IndexRange& rows) {
@@ -75,6 +89,12 @@ class Destination {
   const std::string taskId_;
   const int destination_;
   memory::MappedMemory* const memory_;
+  const VectorSerde::Options* const serdeOptions_;
+  // True if the pages are RowVectorGroups for consumers in this process.
+  // The pages keep 'unserializedProducer_', which owns the memory of their
+  // rows, live.
+  const bool unserialized_;
+  const std::weak_ptr<Task> unserializedProducer_;
   uint64_t bytesInCurrent_{0};
   std::vector<IndexRange> rows_;
 
@@ -115,6 +135,11 @@ class PartitionedOutput : public Operator {
         outputChannels_(calculateOutputChannels(
             planNode->inputType(),
             planNode->outputType())),
+        serdeOptions_(
+            exchangeSerdeOptions(ctx->execCtx->queryCtx()->config())),
+        unserialized_(ctx->execCtx->queryCtx()
+                          ->config()
+                          .exchangeLocalBypassEnabled()),
         future_(false),
         bufferManager_(PartitionedOutputBufferManager::getInstance(
             operatorCtx_->task()->queryCtx()->host())) {
@@ -171,6 +196,10 @@ class PartitionedOutput : public Operator {
   std::unique_ptr<core::PartitionFunction> partitionFunction_;
   // Empty if column order in the output is exactly the same as in input.
   const std::vector<ChannelIndex> outputChannels_;
+  const VectorSerde::Options serdeOptions_;
+  // True if the pages hold the rows unserialized. See
+  // QueryConfig::exchangeLocalBypassEnabled().
+  const bool unserialized_;
   BlockingReason blockingReason_{BlockingReason::kNotBlocked};
   ContinueFuture future_;
   bool isFinished_{false};
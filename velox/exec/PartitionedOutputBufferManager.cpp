@@ -17,6 +17,17 @@
 
 namespace facebook::velox::exec {
 
+std::vector<std::shared_ptr<VectorStreamGroup>> BroadcastBuffer::release(
+    int64_t sequence) {
+  std::vector<std::shared_ptr<VectorStreamGroup>> freed;
+  while (sequence_ < sequence && !data_.empty() && data_.front()) {
+    freed.push_back(std::move(data_.front()));
+    data_.pop_front();
+    ++sequence_;
+  }
+  return freed;
+}
+
 void DestinationBuffer::getData(
     uint64_t maxBytes,
     int64_t sequence,
@@ -25,7 +36,7 @@ void DestinationBuffer::getData(
   VELOX_CHECK_GE(
       sequence, sequence_, "Get received for an already acknowledged item");
 
-  if (sequence - sequence_ > data_.size()) {
+  if (sequence - sequence_ > numAvailable()) {
     VLOG(0) << this << " Out of order get: " << sequence << " over "
             << sequence_ << " Setting second notify " << notifySequence_
             << " / " << sequence;
@@ -34,7 +45,7 @@ void DestinationBuffer::getData(
     notifyMaxBytes_ = maxBytes;
     return;
   }
-  if (sequence - sequence_ == data_.size()) {
+  if (sequence - sequence_ == numAvailable()) {
     notify_ = notify;
     notifySequence_ = sequence;
     notifyMaxBytes_ = maxBytes;
@@ -42,15 +53,17 @@ void DestinationBuffer::getData(
   }
 
   uint64_t resultBytes = 0;
-  for (auto i = sequence - sequence_; i < data_.size(); i++) {
+  auto numItems = numAvailable();
+  for (auto i = sequence - sequence_; i < numItems; i++) {
+    const auto& item = at(i);
     // nullptr is used as end marker
-    if (!data_[i]) {
-      VELOX_CHECK_EQ(i, data_.size() - 1, "null marker found in the middle");
+    if (!item) {
+      VELOX_CHECK_EQ(i, numItems - 1, "null marker found in the middle");
       result.push_back(nullptr);
       break;
     }
-    result.push_back(data_[i]);
-    resultBytes += data_[i]->size();
+    result.push_back(item);
+    resultBytes += item->size();
     if (resultBytes >= maxBytes) {
       break;
     }
@@ -93,7 +106,12 @@ std::vector<std::shared_ptr<VectorStreamGroup>> DestinationBuffer::acknowledge(
   }
 
   VELOX_CHECK_LE(
-      numDeleted, data_.size(), "Ack received for a not yet produced item");
+      numDeleted, numAvailable(), "Ack received for a not yet produced item");
+  if (broadcast_) {
+    // The owner frees the pages all destinations have passed.
+    sequence_ += numDeleted;
+    return {};
+  }
   std::vector<std::shared_ptr<VectorStreamGroup>> freed;
   for (auto i = 0; i < numDeleted; ++i) {
     if (!data_[i]) {
@@ -151,6 +169,7 @@ void PartitionedOutputBuffer::updateBroadcastOutputBuffers(
     bool noMoreBuffers) {
   VELOX_CHECK(broadcast_);
 
+  std::vector<std::shared_ptr<VectorStreamGroup>> freed;
   std::vector<VeloxPromise<bool>> promises;
   {
     std::lock_guard<std::mutex> l(mutex_);
@@ -164,24 +183,36 @@ void PartitionedOutputBuffer::updateBroadcastOutputBuffers(
     }
 
     noMoreBroadcastBuffers_ = true;
-    updateAfterAcknowledgeLocked(dataToBroadcast_, promises);
+    releaseBroadcastLocked(freed);
+    updateAfterAcknowledgeLocked(freed, promises);
   }
 
-  releaseAfterAcknowledge(dataToBroadcast_, promises);
+  releaseAfterAcknowledge(freed, promises);
 }
 
 void PartitionedOutputBuffer::addBroadcastOutputBuffersLocked(int numBuffers) {
   VELOX_CHECK(!noMoreBroadcastBuffers_)
   buffers_.reserve(numBuffers);
   for (auto i = buffers_.size(); i < numBuffers; i++) {
-    auto buffer = std::make_unique<DestinationBuffer>();
-    for (const auto& data : dataToBroadcast_) {
-      buffer->enqueue(data);
-    }
-    if (atEnd_) {
-      buffer->enqueue(nullptr);
+    buffers_.emplace_back(
+        std::make_unique<DestinationBuffer>(&broadcastBuffer_));
+  }
+}
+
+void PartitionedOutputBuffer::releaseBroadcastLocked(
+    std::vector<std::shared_ptr<VectorStreamGroup>>& freed) {
+  if (!broadcast_ || !noMoreBroadcastBuffers_) {
+    return;
+  }
+  // Deleted destinations do not hold pages.
+  auto sequence = broadcastBuffer_.endSequence();
+  for (const auto& buffer : buffers_) {
+    if (buffer) {
+      sequence = std::min(sequence, buffer->sequence());
     }
-    buffers_.emplace_back(std::move(buffer));
+  }
+  for (auto& page : broadcastBuffer_.release(sequence)) {
+    freed.push_back(std::move(page));
   }
 }
 
@@ -201,14 +232,11 @@ BlockingReason PartitionedOutputBuffer::enqueue(
 
     totalSize_ += data->size();
     if (broadcast_) {
-      std::shared_ptr<VectorStreamGroup> shared = std::move(data);
+      broadcastBuffer_.enqueue(std::move(data));
       for (auto& buffer : buffers_) {
-        buffer->enqueue(shared);
-        dataAvailableCallbacks.emplace_back(buffer->getAndClearNotify());
-      }
-
-      if (!noMoreBroadcastBuffers_) {
-        dataToBroadcast_.emplace_back(shared);
+        if (buffer) {
+          dataAvailableCallbacks.emplace_back(buffer->getAndClearNotify());
+        }
       }
     } else {
       auto buffer = buffers_[destination].get();
@@ -243,9 +271,14 @@ void PartitionedOutputBuffer::noMoreData() {
         "Each driver should call noMoreData exactly once");
     atEnd_ = numFinished_ == numDrivers_;
     if (atEnd_) {
+      if (broadcast_) {
+        broadcastBuffer_.enqueue(nullptr);
+      }
       for (auto& buffer : buffers_) {
         if (buffer) {
-          buffer->enqueue(nullptr);
+          if (!broadcast_) {
+            buffer->enqueue(nullptr);
+          }
           finished.push_back(buffer->getAndClearNotify());
         }
       }
@@ -290,6 +323,7 @@ void PartitionedOutputBuffer::acknowledge(int destination, int64_t sequence) {
       return;
     }
     freed = buffer->acknowledge(sequence, false);
+    releaseBroadcastLocked(freed);
     updateAfterAcknowledgeLocked(freed, promises);
   }
   releaseAfterAcknowledge(freed, promises);
@@ -298,11 +332,11 @@ void PartitionedOutputBuffer::acknowledge(int destination, int64_t sequence) {
 void PartitionedOutputBuffer::updateAfterAcknowledgeLocked(
     const std::vector<std::shared_ptr<VectorStreamGroup>>& freed,
     std::vector<VeloxPromise<bool>>& promises) {
+  // Each page is freed once, also for broadcast. The consumers may still
+  // reference the pages, so their use count says nothing about this.
   uint64_t totalFreed = 0;
   for (const auto& free : freed) {
-    if (free.unique()) {
-      totalFreed += free->size();
-    }
+    totalFreed += free->size();
   }
   if (totalFreed == 0) {
     return;
@@ -334,6 +368,7 @@ bool PartitionedOutputBuffer::deleteResults(int destination) {
     }
     freed = buffer->deleteResults();
     buffers_[destination] = nullptr;
+    releaseBroadcastLocked(freed);
     ++numFinalAcknowledges_;
     isFinished = isFinishedLocked();
     updateAfterAcknowledgeLocked(freed, promises);
@@ -372,6 +407,7 @@ void PartitionedOutputBuffer::getData(
         destination,
         sequence);
     freed = destinationBuffer->acknowledge(sequence, true);
+    releaseBroadcastLocked(freed);
     updateAfterAcknowledgeLocked(freed, promises);
     destinationBuffer->getData(maxBytes, sequence, notify, data);
   }
@@ -40,9 +40,48 @@ struct DataAvailable {
   }
 };
 
+// The pages of a broadcast output. Each page is kept once for all
+// destinations, which read it from their own position. The owner releases
+// the pages that all destinations have acknowledged.
+class BroadcastBuffer {
+ public:
+  void enqueue(std::shared_ptr<VectorStreamGroup> data) {
+    // drop duplicate end markers
+    if (data == nullptr && !data_.empty() && data_.back() == nullptr) {
+      return;
+    }
+
+    data_.push_back(std::move(data));
+  }
+
+  // The sequence number after the last page or end marker.
+  int64_t endSequence() const {
+    return sequence_ + data_.size();
+  }
+
+  const std::shared_ptr<VectorStreamGroup>& at(int64_t sequence) const {
+    VELOX_DCHECK_GE(sequence, sequence_);
+    return data_[sequence - sequence_];
+  }
+
+  // Removes and returns the pages before 'sequence'. The end marker stays.
+  std::vector<std::shared_ptr<VectorStreamGroup>> release(int64_t sequence);
+
+ private:
+  std::deque<std::shared_ptr<VectorStreamGroup>> data_;
+  // The sequence number of the first in 'data_'.
+  int64_t sequence_ = 0;
+};
+
 class DestinationBuffer {
  public:
+  // If 'broadcast' is set, 'this' reads the pages of 'broadcast' instead of
+  // holding its own.
+  explicit DestinationBuffer(const BroadcastBuffer* broadcast = nullptr)
+      : broadcast_(broadcast) {}
+
   void enqueue(std::shared_ptr<VectorStreamGroup> data) {
+    VELOX_CHECK_NULL(broadcast_);
     // drop duplicate end markers
     if (data == nullptr && !data_.empty() && data_.back() == nullptr) {
       return;
@@ -51,6 +90,11 @@ class DestinationBuffer {
     data_.push_back(std::move(data));
   }
 
+  // The sequence number of the first item not yet acknowledged.
+  int64_t sequence() const {
+    return sequence_;
+  }
+
   // Copies data starting at 'sequence' into 'result', stopping after
   // exceeding 'maxBytes'. If there is no data, 'notify' is installed
   // so that this gets called when data is added.
@@ -63,7 +107,8 @@ class DestinationBuffer {
   // Removes data from the queue. If 'fromGetData' we do not give a
   // warning for the case where no data is removed, otherwise we
   // expect that data does get freed. We cannot assert that data gets
-  // deleted because acknowledge messages can arrive out of order.
+  // deleted because acknowledge messages can arrive out of order. A
+  // broadcast destination only advances its position and returns nothing.
   std::vector<std::shared_ptr<VectorStreamGroup>> acknowledge(
       int64_t sequence,
       bool fromGetData);
@@ -79,6 +124,17 @@ class DestinationBuffer {
   std::string toString();
 
  private:
+  // Number of items after 'sequence_', including the end marker.
+  int64_t numAvailable() const {
+    return broadcast_ ? broadcast_->endSequence() - sequence_ : data_.size();
+  }
+
+  // Returns the item 'offset' positions after 'sequence_'.
+  const std::shared_ptr<VectorStreamGroup>& at(int64_t offset) const {
+    return broadcast_ ? broadcast_->at(sequence_ + offset) : data_[offset];
+  }
+
+  const BroadcastBuffer* const broadcast_;
   std::vector<std::shared_ptr<VectorStreamGroup>> data_;
   // The sequence number of the first in 'data_'.
   int64_t sequence_ = 0;
@@ -102,7 +158,8 @@ class PartitionedOutputBuffer {
         continueSize_(maxSize_ / 2) {
     buffers_.reserve(numDestinations);
     for (int i = 0; i < numDestinations; i++) {
-      buffers_.push_back(std::make_unique<DestinationBuffer>());
+      buffers_.push_back(std::make_unique<DestinationBuffer>(
+          broadcast_ ? &broadcastBuffer_ : nullptr));
     }
   }
 
@@ -149,10 +206,16 @@ class PartitionedOutputBuffer {
       const std::vector<std::shared_ptr<VectorStreamGroup>>& freed,
       std::vector<VeloxPromise<bool>>& promises);
 
-  /// Given an updated total number of broadcast buffers, add any missing ones
-  /// and enqueue data that has been produced so far (e.g. dataToBroadcast_).
+  /// Given an updated total number of broadcast buffers, add any missing ones.
+  /// They start reading at the first page of 'broadcastBuffer_'.
   void addBroadcastOutputBuffersLocked(int numBuffers);
 
+  // Appends to 'freed' the broadcast pages that all destinations have
+  // acknowledged. Nothing is released while destinations may be added,
+  // since a new destination reads from the first page.
+  void releaseBroadcastLocked(
+      std::vector<std::shared_ptr<VectorStreamGroup>>& freed);
+
   std::shared_ptr<Task> task_;
   const bool broadcast_;
   const int numDrivers_ = 0;
@@ -164,10 +227,10 @@ class PartitionedOutputBuffer {
 
   bool noMoreBroadcastBuffers_ = false;
 
-  // While noMoreBroadcastBuffers_ is false, stores the enqueued data to
-  // broadcast to destinations that have not yet been initialized. Cleared
-  // after receiving no-more-broadcast-buffers signal.
-  std::vector<std::shared_ptr<VectorStreamGroup>> dataToBroadcast_;
+  // The pages shared by all destinations if 'broadcast_'. A page is freed
+  // when the slowest destination has acknowledged it, so that memory is
+  // bounded by the lag between the fastest and the slowest destination.
+  BroadcastBuffer broadcastBuffer_;
 
   std::mutex mutex_;
   // Actual data size in 'buffers_'.
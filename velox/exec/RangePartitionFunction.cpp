@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/RangePartitionFunction.h"
+
+#include <numeric>
+
+namespace facebook::velox::exec {
+namespace {
+std::vector<CompareFlags> toCompareFlags(
+    const std::vector<core::SortOrder>& sortingOrders) {
+  std::vector<CompareFlags> flags;
+  flags.reserve(sortingOrders.size());
+  for (const auto& order : sortingOrders) {
+    flags.push_back({order.isNullsFirst(), order.isAscending(), false});
+  }
+  return flags;
+}
+} // namespace
+
+RangePartitionFunction::RangePartitionFunction(
+    int numPartitions,
+    std::vector<ChannelIndex> keyChannels,
+    std::vector<core::SortOrder> sortingOrders,
+    RowVectorPtr splitPoints)
+    : numPartitions_{numPartitions},
+      keyChannels_{std::move(keyChannels)},
+      compareFlags_{toCompareFlags(sortingOrders)},
+      splitPoints_{std::move(splitPoints)} {
+  VELOX_CHECK_EQ(keyChannels_.size(), compareFlags_.size());
+  VELOX_CHECK_EQ(splitPoints_->childrenSize(), keyChannels_.size());
+  VELOX_CHECK_EQ(
+      splitPoints_->size(),
+      numPartitions_ - 1,
+      "Range partitioning needs one split point less than partitions");
+}
+
+int32_t RangePartitionFunction::compare(
+    const std::vector<const BaseVector*>& keys,
+    vector_size_t row,
+    vector_size_t splitPoint) const {
+  for (auto i = 0; i < keys.size(); ++i) {
+    auto result = keys[i]->compare(
+        splitPoints_->childAt(i).get(), row, splitPoint, compareFlags_[i]);
+    if (result != 0) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+void RangePartitionFunction::partition(
+    const RowVector& input,
+    std::vector<uint32_t>& partitions) {
+  auto size = input.size();
+  std::vector<const BaseVector*> keys;
+  keys.reserve(keyChannels_.size());
+  for (auto channel : keyChannels_) {
+    keys.push_back(input.loadedChildAt(channel).get());
+  }
+
+  partitions.resize(size);
+  for (auto row = 0; row < size; ++row) {
+    // Binary search for the first split point that 'row' does not sort
+    // after.
+    uint32_t low = 0;
+    uint32_t high = splitPoints_->size();
+    while (low < high) {
+      auto middle = (low + high) / 2;
+      if (compare(keys, row, middle) > 0) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    partitions[row] = low;
+  }
+}
+
+// static
+RowVectorPtr RangePartitionFunction::splitPointsFromSample(
+    const RowVector& sample,
+    const std::vector<ChannelIndex>& keyChannels,
+    const std::vector<core::SortOrder>& sortingOrders,
+    int numPartitions,
+    memory::MemoryPool* pool) {
+  VELOX_CHECK_GT(numPartitions, 0);
+  VELOX_CHECK_EQ(keyChannels.size(), sortingOrders.size());
+  VELOX_USER_CHECK(
+      numPartitions == 1 || sample.size() > 0,
+      "Range partitioning needs a non-empty sample");
+  auto flags = toCompareFlags(sortingOrders);
+  std::vector<const BaseVector*> keys;
+  std::vector<std::string> names;
+  std::vector<TypePtr> types;
+  for (auto channel : keyChannels) {
+    keys.push_back(sample.loadedChildAt(channel).get());
+    names.push_back(sample.type()->as<TypeKind::ROW>().nameOf(channel));
+    types.push_back(keys.back()->type());
+  }
+
+  auto numRows = sample.size();
+  std::vector<vector_size_t> rows(numRows);
+  std::iota(rows.begin(), rows.end(), 0);
+  std::sort(rows.begin(), rows.end(), [&](auto left, auto right) {
+    for (auto i = 0; i < keys.size(); ++i) {
+      auto result = keys[i]->compare(keys[i], left, right, flags[i]);
+      if (result != 0) {
+        return result < 0;
+      }
+    }
+    return false;
+  });
+
+  // Split point i is the last row of the i-th of 'numPartitions' equal
+  // parts of the sorted sample.
+  auto numSplitPoints = numPartitions - 1;
+  std::vector<VectorPtr> columns;
+  for (auto i = 0; i < keys.size(); ++i) {
+    columns.push_back(BaseVector::create(types[i], numSplitPoints, pool));
+  }
+  for (auto i = 0; i < numSplitPoints; ++i) {
+    auto row = rows[std::max<int64_t>(
+        0, static_cast<int64_t>(numRows) * (i + 1) / numPartitions - 1)];
+    for (auto j = 0; j < keys.size(); ++j) {
+      columns[j]->copy(keys[j], i, row, 1);
+    }
+  }
+  return std::make_shared<RowVector>(
+      pool,
+      ROW(std::move(names), std::move(types)),
+      BufferPtr(nullptr),
+      numSplitPoints,
+      std::move(columns));
+}
+} // namespace facebook::velox::exec
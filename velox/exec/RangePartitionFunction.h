@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/core/PlanNode.h"
+
+namespace facebook::velox::exec {
+
+// Assigns rows to partitions by ranges of the sorting keys, so that the
+// partitions of a distributed sort hold disjoint key ranges and each can be
+// sorted independently. The ranges are bounded by 'numPartitions - 1' split
+// points. A row goes to partition i if it sorts after split point i - 1 and
+// not after split point i.
+class RangePartitionFunction : public core::PartitionFunction {
+ public:
+  // 'splitPoints' has one column per key in the order of 'keyChannels' and
+  // 'numPartitions - 1' rows sorted in 'sortingOrders'.
+  RangePartitionFunction(
+      int numPartitions,
+      std::vector<ChannelIndex> keyChannels,
+      std::vector<core::SortOrder> sortingOrders,
+      RowVectorPtr splitPoints);
+
+  ~RangePartitionFunction() override = default;
+
+  void partition(const RowVector& input, std::vector<uint32_t>& partitions)
+      override;
+
+  // Returns 'numPartitions - 1' split points that divide the rows of
+  // 'sample' into ranges of about the same number of rows. The result has
+  // the columns of 'sample' at 'keyChannels'.
+  static RowVectorPtr splitPointsFromSample(
+      const RowVector& sample,
+      const std::vector<ChannelIndex>& keyChannels,
+      const std::vector<core::SortOrder>& sortingOrders,
+      int numPartitions,
+      memory::MemoryPool* pool);
+
+ private:
+  // Compares the keys of 'input' at 'row' with split point 'splitPoint'.
+  int32_t compare(
+      const std::vector<const BaseVector*>& keys,
+      vector_size_t row,
+      vector_size_t splitPoint) const;
+
+  const int numPartitions_;
+  const std::vector<ChannelIndex> keyChannels_;
+  std::vector<CompareFlags> compareFlags_;
+  const RowVectorPtr splitPoints_;
+};
+} // namespace facebook::velox::exec
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/RemoteDynamicFilters.h"
+
+namespace facebook::velox::exec {
+
+namespace {
+// A union of more distinct values is a BloomFilter instead of a list.
+constexpr int32_t kMaxUnionValues = 100'000;
+
+// Returns the OR of 'filters' after shrinking them to the size of the
+// smallest, which keeps the values inserted into each.
+std::shared_ptr<const BloomFilter<false>> unionBloomFilters(
+    const std::vector<const BloomFilter<false>*>& filters) {
+  auto numWords = filters[0]->bits().size();
+  for (auto* filter : filters) {
+    numWords = std::min(numWords, filter->bits().size());
+  }
+  std::vector<uint64_t> bits(numWords);
+  for (auto* filter : filters) {
+    BloomFilter<false> shrunk;
+    shrunk.setBits(filter->bits());
+    // 4 entries per word, see BloomFilter::numWords().
+    shrunk.shrink(numWords * 4);
+    for (auto i = 0; i < numWords; ++i) {
+      bits[i] |= shrunk.bits()[i];
+    }
+  }
+  auto result = std::make_shared<BloomFilter<false>>();
+  result->setBits(std::move(bits));
+  return result;
+}
+} // namespace
+
+std::shared_ptr<common::Filter> unionDynamicFilters(
+    const std::vector<std::shared_ptr<common::Filter>>& filters) {
+  using common::FilterKind;
+  if (filters.empty()) {
+    return nullptr;
+  }
+  // A Task with an empty build side contributes AlwaysFalse.
+  std::vector<const common::Filter*> nonEmpty;
+  for (const auto& filter : filters) {
+    if (!filter) {
+      return nullptr;
+    }
+    if (filter->kind() != FilterKind::kAlwaysFalse) {
+      nonEmpty.push_back(filter.get());
+    }
+  }
+  if (nonEmpty.empty()) {
+    return std::make_shared<common::AlwaysFalse>();
+  }
+  if (nonEmpty.size() == 1) {
+    return nonEmpty[0]->clone();
+  }
+
+  auto min = std::numeric_limits<int64_t>::max();
+  auto max = std::numeric_limits<int64_t>::min();
+  std::vector<int64_t> values;
+  std::vector<const BloomFilter<false>*> bloomFilters;
+  bool isRange = false;
+  auto addValues = [&](const std::vector<int64_t>& more) {
+    values.insert(values.end(), more.begin(), more.end());
+    for (auto value : more) {
+      min = std::min(min, value);
+      max = std::max(max, value);
+    }
+  };
+  for (auto* filter : nonEmpty) {
+    switch (filter->kind()) {
+      case FilterKind::kBigintRange: {
+        auto range = static_cast<const common::BigintRange*>(filter);
+        min = std::min(min, range->lower());
+        max = std::max(max, range->upper());
+        if (range->lower() == range->upper()) {
+          values.push_back(range->lower());
+        } else {
+          isRange = true;
+        }
+        break;
+      }
+      case FilterKind::kBigintValuesUsingHashTable:
+        addValues(
+            static_cast<const common::BigintValuesUsingHashTable*>(filter)
+                ->values());
+        break;
+      case FilterKind::kBigintValuesUsingBitmask:
+        addValues(static_cast<const common::BigintValuesUsingBitmask*>(filter)
+                      ->values());
+        break;
+      case FilterKind::kBigintValuesUsingBloomFilter: {
+        auto bloom =
+            static_cast<const common::BigintValuesUsingBloomFilter*>(filter);
+        min = std::min(min, bloom->min());
+        max = std::max(max, bloom->max());
+        bloomFilters.push_back(bloom->bloomFilter().get());
+        break;
+      }
+      default:
+        return nullptr;
+    }
+  }
+
+  if (isRange) {
+    return std::make_shared<common::BigintRange>(min, max, false);
+  }
+  if (bloomFilters.empty()) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    if (values.size() <= kMaxUnionValues) {
+      return common::createBigintValues(values, false);
+    }
+  }
+  // The values of the lists go into the BloomFilter of the others, or into
+  // a new one if there are too many values for a list.
+  std::shared_ptr<BloomFilter<false>> valuesBloomFilter;
+  if (!values.empty()) {
+    valuesBloomFilter = std::make_shared<BloomFilter<false>>();
+    valuesBloomFilter->reset(values.size());
+    for (auto value : values) {
+      valuesBloomFilter->insert(
+          common::BigintValuesUsingBloomFilter::hashValue(value));
+    }
+    bloomFilters.push_back(valuesBloomFilter.get());
+  }
+  return std::make_shared<common::BigintValuesUsingBloomFilter>(
+      min, max, unionBloomFilters(bloomFilters), false);
+}
+
+} // namespace facebook::velox::exec
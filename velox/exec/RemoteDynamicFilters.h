@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/type/Filter.h"
+
+namespace facebook::velox::exec {
+
+// Returns a filter that passes the values that pass any of 'filters', e.g.
+// the build side filters of the same join key from several Tasks that each
+// build a partition of a hash join. The result may pass more values than
+// the union, e.g. a range or a BloomFilter over all the values, so it is
+// only usable where passing extra values is harmless. Returns nullptr if
+// any of 'filters' is nullptr or not a filter of integer values.
+std::shared_ptr<common::Filter> unionDynamicFilters(
+    const std::vector<std::shared_ptr<common::Filter>>& filters);
+
+} // namespace facebook::velox::exec
@@ -44,14 +44,17 @@ RowContainer::RowContainer(
     bool hasProbedFlag,
     bool hasNormalizedKeys,
     memory::MappedMemory* mappedMemory,
-    const RowSerde& serde)
+    const RowSerde& serde,
+    bool packTimestamps)
     : keyTypes_(keyTypes),
       nullableKeys_(nullableKeys),
       aggregates_(aggregates),
       isJoinBuild_(isJoinBuild),
+      packTimestamps_(packTimestamps),
       hasNormalizedKeys_(hasNormalizedKeys),
       rows_(mappedMemory),
-      stringAllocator_(mappedMemory),
+      stringAllocator_(
+          std::make_unique<HashStringAllocator>(mappedMemory)),
       serde_(serde) {
   // Compute the layout of the payload row.  The row has keys, null
   // flags, accumulators, dependent fields. All fields are fixed
@@ -78,6 +81,10 @@ RowContainer::RowContainer(
   // cardinality grows too large for packing all in 64
   // bits. 'numRowsWithNormalizedKey_' gives the number of rows with
   // the extra field.
+  auto columnSize = [&](TypeKind kind) -> int32_t {
+    return packTimestamps_ && kind == TypeKind::TIMESTAMP ? sizeof(int64_t)
+                                                          : typeKindSize(kind);
+  };
   int32_t offset = 0;
   int32_t nullOffset = 0;
   bool isVariableWidth = false;
@@ -85,7 +92,7 @@ RowContainer::RowContainer(
     typeKinds_.push_back(type->kind());
     types_.push_back(type);
     offsets_.push_back(offset);
-    offset += typeKindSize(type->kind());
+    offset += columnSize(type->kind());
     nullOffsets_.push_back(nullOffset);
     isVariableWidth |= !type->isFixedWidth();
     if (nullableKeys) {
@@ -108,7 +115,7 @@ RowContainer::RowContainer(
     types_.push_back(type);
     typeKinds_.push_back(type->kind());
     offsets_.push_back(offset);
-    offset += typeKindSize(type->kind());
+    offset += columnSize(type->kind());
     nullOffsets_.push_back(nullOffset);
     ++nullOffset;
     isVariableWidth |= !type->isFixedWidth();
@@ -141,7 +148,7 @@ RowContainer::RowContainer(
     offsets_[i + firstAggregate] += nullBytes;
     nullOffset = nullOffsets_[i + firstAggregate];
     if (i < aggregates.size()) {
-      aggregates_[i]->setAllocator(&stringAllocator_);
+      aggregates_[i]->setAllocator(stringAllocator_.get());
       aggregates_[i]->setOffsets(
           offsets_[i + firstAggregate],
           nullByte(nullOffset),
@@ -174,10 +181,19 @@ RowContainer::RowContainer(
   }
   normalizedKeySize_ = hasNormalizedKeys_ ? sizeof(normalized_key_t) : 0;
   for (auto i = 0; i < offsets_.size(); ++i) {
+    // Keys, then accumulators, then dependent columns.
+    bool isTimestamp = false;
+    if (i < keyTypes_.size()) {
+      isTimestamp = typeKinds_[i] == TypeKind::TIMESTAMP;
+    } else if (i >= firstAggregate + aggregates.size()) {
+      isTimestamp =
+          typeKinds_[i - aggregates.size()] == TypeKind::TIMESTAMP;
+    }
     rowColumns_.emplace_back(
         offsets_[i],
         (nullableKeys_ || i >= keyTypes_.size()) ? nullOffsets_[i]
-                                                 : RowColumn::kNotNullOffset);
+                                                 : RowColumn::kNotNullOffset,
+        packTimestamps_ && isTimestamp);
   }
 }
 
@@ -229,6 +245,7 @@ void RowContainer::eraseRows(folly::Range<char**> rows) {
     firstFreeRow_ = row;
   }
   numFreeRows_ += rows.size();
+  maybeCompactStrings();
 }
 
 void RowContainer::freeVariableWidthFields(folly::Range<char**> rows) {
@@ -244,7 +261,8 @@ void RowContainer::freeVariableWidthFields(folly::Range<char**> rows) {
           if (!isNullAt(row, column.nullByte(), column.nullMask())) {
             StringView view = valueAt<StringView>(row, column.offset());
             if (!view.isInline()) {
-              stringAllocator_.free(HashStringAllocator::headerOf(view.data()));
+              stringAllocator_->free(
+                  HashStringAllocator::headerOf(view.data()));
             }
           }
         }
@@ -293,6 +311,10 @@ void RowContainer::store(
     vector_size_t index,
     char* row,
     int32_t column) {
+  if (rowColumns_[column].packedTimestamp()) {
+    storePackedTimestamp(decoded, index, row, rowColumns_[column]);
+    return;
+  }
   auto numKeys = keyTypes_.size();
   if (column < numKeys && !nullableKeys_) {
     VELOX_DYNAMIC_TYPE_DISPATCH(
@@ -317,6 +339,47 @@ void RowContainer::store(
   }
 }
 
+// static
+void RowContainer::storePackedTimestamp(
+    const DecodedVector& decoded,
+    vector_size_t index,
+    char* row,
+    RowColumn column) {
+  auto offset = column.offset();
+  if (decoded.isNullAt(index)) {
+    row[column.nullByte()] |= column.nullMask();
+    valueAt<int64_t>(row, offset) = 0;
+    return;
+  }
+  auto value = decoded.valueAt<Timestamp>(index);
+  VELOX_USER_CHECK(
+      value.fitsInNanos(),
+      "Timestamp of {} seconds is out of the range of packed timestamps",
+      value.getSeconds());
+  valueAt<int64_t>(row, offset) = value.toNanos();
+}
+
+// static
+void RowContainer::extractPackedTimestamps(
+    const char* const* rows,
+    int32_t numRows,
+    RowColumn column,
+    FlatVector<Timestamp>* result) {
+  result->resize(numRows);
+  auto values = result->mutableValues(numRows)->asMutable<Timestamp>();
+  auto nullByte = column.nullByte();
+  auto nullMask = column.nullMask();
+  auto offset = column.offset();
+  for (int32_t i = 0; i < numRows; ++i) {
+    if (!rows[i] || isNullAt(rows[i], nullByte, nullMask)) {
+      result->setNull(i, true);
+    } else {
+      result->setNull(i, false);
+      values[i] = Timestamp::fromNanos(valueAt<int64_t>(rows[i], offset));
+    }
+  }
+}
+
 void RowContainer::prepareRead(
     const char* row,
     int32_t offset,
@@ -369,10 +432,10 @@ void RowContainer::storeComplexType(
     row[nullByte] |= nullMask;
     return;
   }
-  ByteStream stream(&stringAllocator_, false, false);
-  auto position = stringAllocator_.newWrite(stream);
+  ByteStream stream(stringAllocator_.get(), false, false);
+  auto position = stringAllocator_->newWrite(stream);
   serde_.serialize(*decoded.base(), decoded.index(index), stream);
-  stringAllocator_.finishWrite(stream, 0);
+  stringAllocator_->finishWrite(stream, 0);
   valueAt<StringView>(row, offset) =
       StringView(reinterpret_cast<char*>(position.position), stream.size());
 }
@@ -403,9 +466,12 @@ int32_t RowContainer::compareStringAsc(
     StringView left,
     const DecodedVector& decoded,
     vector_size_t index) {
+  auto right = decoded.valueAt<StringView>(index);
+  if (auto result = left.comparePrefix(right)) {
+    return result;
+  }
   std::string storage;
-  return HashStringAllocator::contiguousString(left, storage)
-      .compare(decoded.valueAt<StringView>(index));
+  return HashStringAllocator::contiguousString(left, storage).compare(right);
 }
 
 // static
@@ -421,6 +487,9 @@ int RowContainer::compareComplexType(
 }
 
 int32_t RowContainer::compareStringAsc(StringView left, StringView right) {
+  if (auto result = left.comparePrefix(right)) {
+    return result;
+  }
   std::string leftStorage;
   std::string rightStorage;
   return HashStringAllocator::contiguousString(left, leftStorage)
@@ -479,12 +548,39 @@ void RowContainer::hashTyped(
   }
 }
 
+void RowContainer::hashPackedTimestamps(
+    RowColumn column,
+    bool nullable,
+    folly::Range<char**> rows,
+    bool mix,
+    uint64_t* result) {
+  auto nullByte = column.nullByte();
+  auto nullMask = column.nullMask();
+  auto offset = column.offset();
+  for (int32_t i = 0; i < rows.size(); ++i) {
+    char* row = rows[i];
+    uint64_t hash;
+    if (nullable && isNullAt(row, nullByte, nullMask)) {
+      hash = BaseVector::kNullHash;
+    } else {
+      // Same as the hash of the Timestamp in a vector.
+      hash = folly::hasher<Timestamp>()(
+          Timestamp::fromNanos(valueAt<int64_t>(row, offset)));
+    }
+    result[i] = mix ? bits::hashMix(result[i], hash) : hash;
+  }
+}
+
 void RowContainer::hash(
     int32_t column,
     folly::Range<char**> rows,
     bool mix,
     uint64_t* result) {
   bool nullable = column >= keyTypes_.size() || nullableKeys_;
+  if (columnAt(column).packedTimestamp()) {
+    hashPackedTimestamps(columnAt(column), nullable, rows, mix, result);
+    return;
+  }
   VELOX_DYNAMIC_TYPE_DISPATCH(
       hashTyped,
       typeKinds_[column],
@@ -498,7 +594,7 @@ void RowContainer::hash(
 
 void RowContainer::clear() {
   rows_.clear();
-  stringAllocator_.clear();
+  stringAllocator_->clear();
   numRows_ = 0;
   numRowsWithNormalizedKey_ = 0;
   if (hasNormalizedKeys_) {
@@ -506,6 +602,66 @@ void RowContainer::clear() {
   }
 }
 
+bool RowContainer::maybeCompactStrings() {
+  if (!canCompactStrings() ||
+      stringAllocator_->retainedSize() < kMinCompactionBytes ||
+      stringAllocator_->fragmentation() <= kCompactionFragmentation) {
+    return false;
+  }
+  compactStrings();
+  return true;
+}
+
+void RowContainer::compactStrings() {
+  VELOX_CHECK(
+      canCompactStrings(),
+      "Cannot compact a RowContainer with accumulators");
+  std::vector<RowColumn> columns;
+  for (auto i = 0; i < types_.size(); ++i) {
+    switch (typeKinds_[i]) {
+      case TypeKind::VARCHAR:
+      case TypeKind::VARBINARY:
+      case TypeKind::ROW:
+      case TypeKind::ARRAY:
+      case TypeKind::MAP:
+        columns.push_back(columnAt(i));
+        break;
+      default:
+        break;
+    }
+  }
+  if (columns.empty()) {
+    return;
+  }
+  auto compacted =
+      std::make_unique<HashStringAllocator>(rows_.mappedMemory());
+  constexpr int32_t kBatch = 1000;
+  std::vector<char*> rows(kBatch);
+  RowContainerIterator iter;
+  while (auto numRows = listRows(&iter, kBatch, rows.data())) {
+    for (auto i = 0; i < numRows; ++i) {
+      auto row = rows[i];
+      for (auto& column : columns) {
+        if (isNullAt(row, column.nullByte(), column.nullMask())) {
+          continue;
+        }
+        auto& view = valueAt<StringView>(row, column.offset());
+        if (view.isInline()) {
+          continue;
+        }
+        auto position = compacted->copyAllocation(
+            HashStringAllocator::headerOf(view.data()));
+        view = StringView(
+            reinterpret_cast<char*>(position.position), view.size());
+      }
+    }
+  }
+  ++numStringCompactions_;
+  compactedStringBytes_ +=
+      stringAllocator_->retainedSize() - compacted->retainedSize();
+  stringAllocator_ = std::move(compacted);
+}
+
 void RowContainer::setProbedFlag(char** rows, int32_t numRows) {
   for (auto i = 0; i < numRows; i++) {
     bits::setBit(rows[i], probedFlagOffset_);
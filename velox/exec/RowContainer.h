@@ -46,21 +46,32 @@ class RowColumn {
   // Used as null offset for a non-null column.
   static constexpr int32_t kNotNullOffset = -1;
 
-  RowColumn(int32_t offset, int32_t nullOffset)
-      : packedOffsets_(PackOffsets(offset, nullOffset)) {}
+  // 'packedTimestamp' is true for a TIMESTAMP column stored as the int64_t
+  // Timestamp::toNanos().
+  RowColumn(int32_t offset, int32_t nullOffset, bool packedTimestamp = false)
+      : packedOffsets_(
+            PackOffsets(offset, nullOffset) |
+            (packedTimestamp ? kPackedTimestamp : 0)) {}
   int32_t offset() const {
     return packedOffsets_ >> 32;
   }
 
   int32_t nullByte() const {
-    return static_cast<uint32_t>(packedOffsets_) >> 8;
+    return (static_cast<uint32_t>(packedOffsets_) & ~kPackedTimestamp) >> 8;
   }
 
   uint8_t nullMask() const {
     return packedOffsets_ & 0xff;
   }
 
+  bool packedTimestamp() const {
+    return packedOffsets_ & kPackedTimestamp;
+  }
+
  private:
+  // Flag in the top bit of the low word, above the null byte.
+  static constexpr uint64_t kPackedTimestamp = 1UL << 31;
+
   static uint64_t PackOffsets(int32_t offset, int32_t nullOffset) {
     if (nullOffset == kNotNullOffset) {
       // If the column is not nullable, The low word is 0, meaning
@@ -115,7 +126,10 @@ class RowContainer {
   // below each row for a normlized key that collapses all parts
   // into one word for faster comparison. The bulk allocation is done
   // from 'mappedMemory'.  'serde_' is used for serializing complex
-  // type values into the container.
+  // type values into the container. If 'packTimestamps' is true, TIMESTAMP
+  // keys and dependent columns take 8 instead of 16 bytes: these are stored
+  // as Timestamp::toNanos() and converted back by extractColumn(). Storing
+  // a timestamp that does not fitsInNanos() then throws.
   RowContainer(
       const std::vector<TypePtr>& keyTypes,
       bool nullableKeys,
@@ -126,7 +140,8 @@ class RowContainer {
       bool hasProbedFlag,
       bool hasNormalizedKey,
       memory::MappedMemory* mappedMemory,
-      const RowSerde& serde);
+      const RowSerde& serde,
+      bool packTimestamps = false);
 
   // Allocates a new row and initializes possible aggregates to null.
   char* newRow();
@@ -162,9 +177,16 @@ class RowContainer {
       int32_t columnIndex);
 
   HashStringAllocator& stringAllocator() {
-    return stringAllocator_;
+    return *stringAllocator_;
   }
 
+  // Minimum footprint of variable width data for maybeCompactStrings().
+  static constexpr int64_t kMinCompactionBytes = 1 << 20;
+
+  // Fraction of free space in the variable width data above which
+  // maybeCompactStrings() compacts.
+  static constexpr double kCompactionFragmentation = 0.5;
+
   // Returns the number of used rows in 'this'. This is the number of
   // rows a RowContainerIterator would access.
   int64_t numRows() const {
@@ -284,6 +306,12 @@ class RowContainer {
     return rowSizeOffset_;
   }
 
+  // Returns the size of the fixed width part of a row, including the
+  // keys, accumulators and null flags.
+  int32_t fixedRowSize() const {
+    return fixedRowSize_;
+  }
+
   // For a hash join table with possible non-unique entries, the offset of
   // the pointer to the next row with the same key. 0 if keys are
   // guaranteed unique, e.g. for a group by or semijoin build.
@@ -300,12 +328,51 @@ class RowContainer {
       uint64_t* result);
 
   uint64_t allocatedBytes() const {
-    return rows_.allocatedBytes() + stringAllocator_.retainedSize();
+    return rows_.allocatedBytes() + stringAllocator_->retainedSize();
+  }
+
+  // Returns the bytes of erased rows and of free blocks in the string
+  // allocator. These are counted in allocatedBytes() and are reused before
+  // new memory is allocated.
+  uint64_t freeBytes() const {
+    return numFreeRows_ * fixedRowSize_ + stringAllocator_->freeBytes();
   }
 
   // Resets the state to be as after construction. Frees memory for payload.
   void clear();
 
+  // Returns the fraction of the footprint of variable width data that
+  // is in free blocks.
+  double stringFragmentation() const {
+    return stringAllocator_->fragmentation();
+  }
+
+  // True if compactStrings() may move the variable width data. The data
+  // of accumulators cannot be moved since only the Aggregate knows
+  // where it is referenced from.
+  bool canCompactStrings() const {
+    return aggregates_.empty();
+  }
+
+  // Moves the variable width data of all rows into a new
+  // HashStringAllocator and frees the old one. StringViews and
+  // HashStringAllocator pointers obtained from 'this' before the call
+  // are no longer valid.
+  void compactStrings();
+
+  // Calls compactStrings() if the footprint of variable width data is
+  // at least kMinCompactionBytes and more than
+  // kCompactionFragmentation of it is free. Returns true if compacted.
+  bool maybeCompactStrings();
+
+  int32_t numStringCompactions() const {
+    return numStringCompactions_;
+  }
+
+  int64_t compactedStringBytes() const {
+    return compactedStringBytes_;
+  }
+
   int32_t compareRows(const char* left, const char* right) {
     for (auto i = 0; i < keyTypes_.size(); ++i) {
       auto result = compare(left, right, i);
@@ -421,7 +488,7 @@ class RowContainer {
     }
     *reinterpret_cast<T*>(row + offset) = decoded.valueAt<T>(index);
     if constexpr (std::is_same<T, StringView>::value) {
-      stringAllocator_.copyMultipart(row, offset);
+      stringAllocator_->copyMultipart(row, offset);
     }
   }
 
@@ -434,7 +501,7 @@ class RowContainer {
     using T = typename TypeTraits<Kind>::NativeType;
     *reinterpret_cast<T*>(group + offset) = decoded.valueAt<T>(index);
     if constexpr (std::is_same<T, StringView>::value) {
-      stringAllocator_.copyMultipart(group, offset);
+      stringAllocator_->copyMultipart(group, offset);
     }
   }
 
@@ -511,8 +578,7 @@ class RowContainer {
       return compareComplexType(row, offset, decoded, index) == 0;
     }
     if (Kind == TypeKind::VARCHAR || Kind == TypeKind::VARBINARY) {
-      return compareStringAsc(
-                 valueAt<StringView>(row, offset), decoded, index) == 0;
+      return equalsString(valueAt<StringView>(row, offset), decoded, index);
     }
     return decoded.valueAt<T>(index) == valueAt<T>(row, offset);
   }
@@ -530,8 +596,7 @@ class RowContainer {
       return compareComplexType(row, offset, decoded, index) == 0;
     }
     if (Kind == TypeKind::VARCHAR || Kind == TypeKind::VARBINARY) {
-      return compareStringAsc(
-                 valueAt<StringView>(row, offset), decoded, index) == 0;
+      return equalsString(valueAt<StringView>(row, offset), decoded, index);
     }
 
     return decoded.valueAt<T>(index) == valueAt<T>(row, offset);
@@ -618,6 +683,69 @@ class RowContainer {
     return left < right ? -1 : left == right ? 0 : 1;
   }
 
+  // Counterparts of extractColumnTyped(), store(), compare() and hashTyped()
+  // for RowColumn::packedTimestamp() columns.
+  static void extractPackedTimestamps(
+      const char* const* rows,
+      int32_t numRows,
+      RowColumn column,
+      FlatVector<Timestamp>* result);
+
+  static void storePackedTimestamp(
+      const DecodedVector& decoded,
+      vector_size_t index,
+      char* row,
+      RowColumn column);
+
+  static int32_t comparePackedTimestamp(
+      const char* row,
+      RowColumn column,
+      const DecodedVector& decoded,
+      vector_size_t index,
+      CompareFlags flags) {
+    bool rowIsNull = isNullAt(row, column.nullByte(), column.nullMask());
+    bool indexIsNull = decoded.isNullAt(index);
+    if (rowIsNull) {
+      return indexIsNull ? 0 : flags.nullsFirst ? -1 : 1;
+    }
+    if (indexIsNull) {
+      return flags.nullsFirst ? 1 : -1;
+    }
+    // 'decoded' may have timestamps that do not fit in nanoseconds.
+    auto result = comparePrimitiveAsc(
+        Timestamp::fromNanos(valueAt<int64_t>(row, column.offset())),
+        decoded.valueAt<Timestamp>(index));
+    return flags.ascending ? result : result * -1;
+  }
+
+  static int32_t comparePackedTimestamps(
+      const char* left,
+      const char* right,
+      RowColumn column,
+      CompareFlags flags) {
+    auto nullByte = column.nullByte();
+    auto nullMask = column.nullMask();
+    bool leftIsNull = isNullAt(left, nullByte, nullMask);
+    bool rightIsNull = isNullAt(right, nullByte, nullMask);
+    if (leftIsNull) {
+      return rightIsNull ? 0 : flags.nullsFirst ? -1 : 1;
+    }
+    if (rightIsNull) {
+      return flags.nullsFirst ? 1 : -1;
+    }
+    auto result = comparePrimitiveAsc(
+        valueAt<int64_t>(left, column.offset()),
+        valueAt<int64_t>(right, column.offset()));
+    return flags.ascending ? result : result * -1;
+  }
+
+  void hashPackedTimestamps(
+      RowColumn column,
+      bool nullable,
+      folly::Range<char**> rows,
+      bool mix,
+      uint64_t* result);
+
   void storeComplexType(
       const DecodedVector& decoded,
       vector_size_t index,
@@ -706,6 +834,23 @@ class RowContainer {
       const DecodedVector& decoded,
       vector_size_t index);
 
+  // Returns true if 'left' from 'this' is equal to the string at 'index' in
+  // 'decoded'. Strings of a different size or prefix are rejected without
+  // reading the possibly non-contiguous 'left'.
+  static bool equalsString(
+      StringView left,
+      const DecodedVector& decoded,
+      vector_size_t index) {
+    auto right = decoded.valueAt<StringView>(index);
+    if (!left.sizeAndPrefixEquals(right)) {
+      return false;
+    }
+    if (left.isInline()) {
+      return left == right;
+    }
+    return compareStringAsc(left, decoded, index) == 0;
+  }
+
   static int32_t compareStringAsc(StringView left, StringView right);
 
   int32_t compareComplexType(
@@ -740,6 +885,7 @@ class RowContainer {
   std::vector<TypePtr> types_;
   std::vector<TypeKind> typeKinds_;
   const bool isJoinBuild_;
+  const bool packTimestamps_;
   int32_t nextOffset_ = 0;
   // Bit position of null bit  in the row. 0 if no null flag. Order is keys,
   // accumulators, dependent.
@@ -774,7 +920,11 @@ class RowContainer {
   uint64_t numFreeRows_ = 0;
 
   AllocationPool rows_;
-  HashStringAllocator stringAllocator_;
+  // Replaced by compactStrings().
+  std::unique_ptr<HashStringAllocator> stringAllocator_;
+  int32_t numStringCompactions_ = 0;
+  // Footprint of variable width data freed by compactStrings().
+  int64_t compactedStringBytes_ = 0;
   const RowSerde& serde_;
   // RowContainer requires a valid reference to a vector of aggregates. We use
   // a static constant to ensure the aggregates_ is valid throughout the
@@ -894,6 +1044,11 @@ inline void RowContainer::extractColumn(
     int32_t numRows,
     RowColumn column,
     VectorPtr result) {
+  if (column.packedTimestamp()) {
+    extractPackedTimestamps(
+        rows, numRows, column, result->as<FlatVector<Timestamp>>());
+    return;
+  }
   VELOX_DYNAMIC_TYPE_DISPATCH_ALL(
       extractColumnTyped, result->typeKind(), rows, numRows, column, result);
 }
@@ -904,6 +1059,10 @@ inline bool RowContainer::equals(
     RowColumn column,
     const DecodedVector& decoded,
     vector_size_t index) {
+  if (column.packedTimestamp()) {
+    return comparePackedTimestamp(
+               row, column, decoded, index, CompareFlags()) == 0;
+  }
   if (!mayHaveNulls) {
     return VELOX_DYNAMIC_TYPE_DISPATCH(
         equalsNoNulls,
@@ -931,6 +1090,9 @@ inline int RowContainer::compare(
     const DecodedVector& decoded,
     vector_size_t index,
     CompareFlags flags) {
+  if (column.packedTimestamp()) {
+    return comparePackedTimestamp(row, column, decoded, index, flags);
+  }
   return VELOX_DYNAMIC_TYPE_DISPATCH(
       compare, decoded.base()->typeKind(), row, column, decoded, index, flags);
 }
@@ -940,9 +1102,13 @@ inline int RowContainer::compare(
     const char* right,
     int columnIndex,
     CompareFlags flags) {
+  auto column = columnAt(columnIndex);
+  if (column.packedTimestamp()) {
+    return comparePackedTimestamps(left, right, column, flags);
+  }
   auto type = types_[columnIndex].get();
   return VELOX_DYNAMIC_TYPE_DISPATCH(
-      compare, type->kind(), left, right, type, columnAt(columnIndex), flags);
+      compare, type->kind(), left, right, type, column, flags);
 }
 
 } // namespace facebook::velox::exec
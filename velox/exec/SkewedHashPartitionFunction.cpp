@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/SkewedHashPartitionFunction.h"
+#include <folly/container/F14Map.h>
+
+namespace facebook::velox::exec {
+SkewedHashPartitionFunction::SkewedHashPartitionFunction(
+    int numPartitions,
+    RowTypePtr inputType,
+    std::vector<ChannelIndex> keyChannels,
+    std::shared_ptr<const HotKeyHashes> hotKeys,
+    bool replicateHotKeys)
+    : HashPartitionFunction(
+          numPartitions,
+          std::move(inputType),
+          std::move(keyChannels)),
+      numPartitions_{numPartitions},
+      hotKeys_{std::move(hotKeys)},
+      replicateHotKeys_{replicateHotKeys} {
+  VELOX_CHECK_NOT_NULL(hotKeys_);
+}
+
+void SkewedHashPartitionFunction::partition(
+    const RowVector& input,
+    std::vector<uint32_t>& partitions) {
+  HashPartitionFunction::partition(input, partitions);
+  if (hotKeys_->empty()) {
+    return;
+  }
+  const auto& keyHashes = hashes();
+  auto size = input.size();
+  for (auto i = 0; i < size; ++i) {
+    if (!hotKeys_->contains(keyHashes[i])) {
+      continue;
+    }
+    if (replicateHotKeys_) {
+      partitions[i] = kAllPartitions;
+    } else {
+      partitions[i] = counter_ % numPartitions_;
+      ++counter_;
+    }
+  }
+}
+
+// static
+std::shared_ptr<HotKeyHashes> SkewedHashPartitionFunction::hotKeysFromSample(
+    const RowVector& sample,
+    const std::vector<ChannelIndex>& keyChannels,
+    double minFraction) {
+  HashPartitionFunction hashFunction(1, asRowType(sample.type()), keyChannels);
+  std::vector<uint32_t> partitions;
+  hashFunction.partition(sample, partitions);
+  auto size = sample.size();
+  folly::F14FastMap<uint64_t, vector_size_t> counts;
+  for (auto i = 0; i < size; ++i) {
+    ++counts[hashFunction.hashes()[i]];
+  }
+  auto hotKeys = std::make_shared<HotKeyHashes>();
+  // A key of a single row is not hot even in a small sample.
+  auto minCount = std::max<double>(2, minFraction * size);
+  for (const auto& [hash, count] : counts) {
+    if (count >= minCount) {
+      hotKeys->insert(hash);
+    }
+  }
+  return hotKeys;
+}
+} // namespace facebook::velox::exec
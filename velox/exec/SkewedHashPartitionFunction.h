@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <folly/container/F14Set.h>
+#include "velox/exec/HashPartitionFunction.h"
+
+namespace facebook::velox::exec {
+
+// Hashes of the partitioning keys of hot keys, see
+// SkewedHashPartitionFunction.
+using HotKeyHashes = folly::F14FastSet<uint64_t>;
+
+// Assigns rows to partitions by the hash of their keys like
+// HashPartitionFunction, except for the rows of hot keys, which would make
+// the partition of their hash far larger than the others. Both sides of a
+// partitioned hash join use the same 'hotKeys': the probe side spreads the
+// rows of hot keys round-robin over all partitions and the build side sends
+// them to all partitions, i.e. returns kAllPartitions. Each probe row then
+// still meets all its matching build rows exactly once. This does not work
+// for joins that produce unmatched build rows, i.e. right and full outer
+// joins, or for right semi joins.
+//
+// Keys are identified by their hash. A key whose hash is the hash of a hot
+// key is hot on both sides as well, so the join result stays the same.
+class SkewedHashPartitionFunction : public HashPartitionFunction {
+ public:
+  // Replicates the rows of 'hotKeys' to all partitions if
+  // 'replicateHotKeys', else spreads them.
+  SkewedHashPartitionFunction(
+      int numPartitions,
+      RowTypePtr inputType,
+      std::vector<ChannelIndex> keyChannels,
+      std::shared_ptr<const HotKeyHashes> hotKeys,
+      bool replicateHotKeys);
+
+  ~SkewedHashPartitionFunction() override = default;
+
+  void partition(const RowVector& input, std::vector<uint32_t>& partitions)
+      override;
+
+  // Returns the hashes of the keys at 'keyChannels' that are in at least
+  // 'minFraction' of the rows of 'sample'. For a join, 'sample' holds rows
+  // of the probe side.
+  static std::shared_ptr<HotKeyHashes> hotKeysFromSample(
+      const RowVector& sample,
+      const std::vector<ChannelIndex>& keyChannels,
+      double minFraction);
+
+ private:
+  const int numPartitions_;
+  const std::shared_ptr<const HotKeyHashes> hotKeys_;
+  const bool replicateHotKeys_;
+  uint32_t counter_{0};
+};
+} // namespace facebook::velox::exec
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/Spill.h"
+
+#include <unistd.h>
+#include <sstream>
+
+namespace facebook::velox::exec {
+
+namespace {
+// Returns a file name that is unique within the process and distinct from
+// the names used by other processes spilling into the same directory.
+std::string makeSpillPath(const std::string& directory) {
+  static std::atomic<int64_t> sequence{0};
+  return fmt::format(
+      "{}/velox_spill_{}_{}", directory, getpid(), ++sequence);
+}
+
+// Size of the length prefix that precedes each serialized batch.
+constexpr int32_t kHeaderSize = sizeof(int64_t);
+} // namespace
+
+SpillFile::SpillFile(
+    RowTypePtr type,
+    const std::string& directory,
+    memory::MappedMemory* mappedMemory,
+    memory::MemoryPool* pool)
+    : type_(std::move(type)),
+      path_(makeSpillPath(directory)),
+      mappedMemory_(mappedMemory),
+      pool_(pool),
+      output_(std::make_unique<LocalWriteFile>(path_)) {}
+
+SpillFile::~SpillFile() {
+  output_.reset();
+  input_.reset();
+  if (unlink(path_.c_str()) != 0) {
+    LOG(WARNING) << "Failed to remove spill file " << path_;
+  }
+}
+
+void SpillFile::append(const RowVectorPtr& rows) {
+  VELOX_CHECK(output_, "SpillFile {} is not open for writing", path_);
+  if (rows->size() == 0) {
+    return;
+  }
+  VectorStreamGroup group(mappedMemory_);
+  group.createStreamTree(type_, rows->size());
+  IndexRange range{0, rows->size()};
+  group.append(rows, folly::Range<const IndexRange*>(&range, 1));
+  std::stringstream out;
+  group.flush(&out);
+  auto data = out.str();
+  int64_t length = data.size();
+  output_->append(std::string_view(
+      reinterpret_cast<const char*>(&length), sizeof(length)));
+  output_->append(data);
+  size_ += kHeaderSize + length;
+  numRows_ += rows->size();
+}
+
+void SpillFile::finishWrite() {
+  VELOX_CHECK(output_);
+  output_->flush();
+  output_.reset();
+  input_ = std::make_unique<LocalReadFile>(path_);
+}
+
+RowVectorPtr SpillFile::nextBatch() {
+  VELOX_CHECK(input_, "SpillFile {} is not finished for writing", path_);
+  if (readOffset_ >= size_) {
+    return nullptr;
+  }
+  int64_t length;
+  input_->pread(readOffset_, sizeof(length), &length);
+  readBuffer_.resize(length);
+  input_->pread(readOffset_ + kHeaderSize, length, readBuffer_.data());
+  readOffset_ += kHeaderSize + length;
+
+  ByteStream stream;
+  std::vector<ByteRange> ranges;
+  ranges.push_back(ByteRange{
+      reinterpret_cast<uint8_t*>(readBuffer_.data()),
+      static_cast<int32_t>(length),
+      0});
+  stream.resetInput(std::move(ranges));
+  RowVectorPtr result;
+  VectorStreamGroup::read(&stream, pool_, type_, &result);
+  return result;
+}
+
+SpillStream::SpillStream(std::unique_ptr<SpillFile> file)
+    : file_(std::move(file)) {
+  current_ = file_->nextBatch();
+}
+
+SpillRow SpillStream::next() {
+  VELOX_CHECK(current_);
+  SpillRow row{current_, index_};
+  if (++index_ >= current_->size()) {
+    index_ = 0;
+    current_ = file_->nextBatch();
+  }
+  return row;
+}
+
+int32_t compareSpillRows(
+    const SpillRow& left,
+    const SpillRow& right,
+    const std::vector<std::pair<ChannelIndex, core::SortOrder>>& keyInfo) {
+  for (auto& key : keyInfo) {
+    auto result = left.rows->childAt(key.first)
+                      ->compare(
+                          right.rows->childAt(key.first).get(),
+                          left.index,
+                          right.index,
+                          {key.second.isNullsFirst(),
+                           key.second.isAscending(),
+                           false});
+    if (result) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+} // namespace facebook::velox::exec
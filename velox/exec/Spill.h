@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/common/file/File.h"
+#include "velox/core/PlanNode.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/VectorStream.h"
+
+namespace facebook::velox::exec {
+
+/// A local file holding a sequence of RowVectors of the same type in
+/// serialized form. Operators that run out of their memory budget write
+/// their state to SpillFiles and read it back later. A file is first
+/// written with append() and then read sequentially with nextBatch(). The
+/// file is removed from disk when 'this' is destroyed.
+class SpillFile {
+ public:
+  /// Creates an empty file under the 'directory' with a unique name. Memory
+  /// for serialization comes from 'mappedMemory'. Vectors read back are
+  /// allocated from 'pool'.
+  SpillFile(
+      RowTypePtr type,
+      const std::string& directory,
+      memory::MappedMemory* mappedMemory,
+      memory::MemoryPool* pool);
+
+  ~SpillFile();
+
+  /// Serializes 'rows' and appends these to the end of the file.
+  void append(const RowVectorPtr& rows);
+
+  /// Closes the file for writing. Must be called before nextBatch().
+  void finishWrite();
+
+  /// Returns the next batch of rows in the order these were appended or
+  /// nullptr if all batches have been read.
+  RowVectorPtr nextBatch();
+
+  /// Sets the pool for the vectors returned by nextBatch(). Used when the
+  /// file is read by a different operator than the one that wrote it.
+  void setPool(memory::MemoryPool* pool) {
+    pool_ = pool;
+  }
+
+  const RowTypePtr& type() const {
+    return type_;
+  }
+
+  const std::string& path() const {
+    return path_;
+  }
+
+  /// Total bytes written to the file.
+  uint64_t size() const {
+    return size_;
+  }
+
+  int64_t numRows() const {
+    return numRows_;
+  }
+
+ private:
+  const RowTypePtr type_;
+  const std::string path_;
+  memory::MappedMemory* const mappedMemory_;
+  memory::MemoryPool* pool_;
+
+  std::unique_ptr<WriteFile> output_;
+  std::unique_ptr<ReadFile> input_;
+
+  // Read position in 'input_'.
+  uint64_t readOffset_{0};
+
+  // Holds the serialized bytes of the batch being deserialized.
+  std::string readBuffer_;
+
+  uint64_t size_{0};
+  int64_t numRows_{0};
+};
+
+/// A row in a batch read back from a SpillFile. Keeps a reference to the
+/// batch so that the row stays valid while the merge holds on to it.
+struct SpillRow {
+  RowVectorPtr rows;
+  vector_size_t index;
+};
+
+/// Sorted sequence of rows coming from a SpillFile. Serves as a source for
+/// the TreeOfLosers that merges sorted spill runs.
+class SpillStream {
+ public:
+  explicit SpillStream(std::unique_ptr<SpillFile> file);
+
+  bool atEnd() const {
+    return !current_;
+  }
+
+  SpillRow next();
+
+ private:
+  std::unique_ptr<SpillFile> file_;
+
+  // The batch being consumed. nullptr after the last row was returned.
+  RowVectorPtr current_;
+
+  vector_size_t index_{0};
+};
+
+/// Compares the sorting keys of two spilled rows. 'keyInfo' gives the
+/// channels and orders of the keys in order of significance.
+int32_t compareSpillRows(
+    const SpillRow& left,
+    const SpillRow& right,
+    const std::vector<std::pair<ChannelIndex, core::SortOrder>>& keyInfo);
+
+} // namespace facebook::velox::exec
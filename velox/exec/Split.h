@@ -19,6 +19,9 @@
 
 namespace facebook::velox::exec {
 
+// Group id of splits and Drivers that are not in a split group.
+constexpr int32_t kUngroupedGroupId = -1;
+
 struct Split {
   std::shared_ptr<velox::connector::ConnectorSplit> connectorSplit;
   int32_t groupId{-1}; // Bucketed group id (-1 means 'none').
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/StreamingAggregation.h"
+#include "velox/exec/ContainerRowSerde.h"
+#include "velox/exec/Task.h"
+
+namespace facebook::velox::exec {
+
+StreamingAggregation::StreamingAggregation(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::AggregationNode>& aggregationNode)
+    : Operator(
+          driverCtx,
+          aggregationNode->outputType(),
+          operatorId,
+          aggregationNode->id(),
+          aggregationNode->step() == core::AggregationNode::Step::kPartial
+              ? "PartialStreamingAggregation"
+              : "StreamingAggregation"),
+      outputBatchSize_{
+          driverCtx->execCtx->queryCtx()->config().preferredOutputBatchSize()},
+      isPartialOutput_(isPartialOutput(aggregationNode->step())),
+      isRawInput_(isRawInput(aggregationNode->step())),
+      ignoreNullKeys_(aggregationNode->ignoreNullKeys()) {
+  VELOX_CHECK(
+      aggregationNode->isPreGrouped(),
+      "Streaming aggregation requires input clustered on all grouping keys");
+  VELOX_CHECK(
+      !aggregationNode->hasDistinctAggregates(),
+      "Streaming aggregation does not support DISTINCT aggregates");
+  VELOX_CHECK(
+      !aggregationNode->hasOrderedAggregates(),
+      "Streaming aggregation does not support ordered aggregates");
+  auto inputType = aggregationNode->sources()[0]->outputType();
+
+  std::vector<TypePtr> keyTypes;
+  for (const auto& key : aggregationNode->groupingKeys()) {
+    auto channel = exprToChannel(key.get(), inputType);
+    VELOX_CHECK_NE(
+        channel,
+        kConstantChannel,
+        "Aggregation doesn't allow constant grouping keys");
+    keyChannels_.push_back(channel);
+    keyTypes.push_back(key->type());
+  }
+
+  auto numKeys = keyChannels_.size();
+  auto numAggregates = aggregationNode->aggregates().size();
+  aggregates_.reserve(numAggregates);
+  aggrMaskChannels_.reserve(numAggregates);
+  for (auto i = 0; i < numAggregates; i++) {
+    const auto& aggregate = aggregationNode->aggregates()[i];
+
+    std::vector<ChannelIndex> channels;
+    std::vector<VectorPtr> constants;
+    std::vector<TypePtr> argTypes;
+    for (auto& arg : aggregate->inputs()) {
+      argTypes.push_back(arg->type());
+      channels.push_back(exprToChannel(arg.get(), inputType));
+      if (channels.back() == kConstantChannel) {
+        auto constant = dynamic_cast<const core::ConstantTypedExpr*>(arg.get());
+        constants.push_back(BaseVector::createConstant(
+            constant->value(), 1, operatorCtx_->pool()));
+      } else {
+        constants.push_back(nullptr);
+      }
+    }
+
+    const auto& aggrMask = aggregationNode->aggregateMasks()[i];
+    if (aggrMask == nullptr) {
+      aggrMaskChannels_.emplace_back(std::optional<ChannelIndex>{});
+    } else {
+      aggrMaskChannels_.emplace_back(
+          inputType->asRow().getChildIdx(aggrMask->name()));
+    }
+
+    const auto& resultType = outputType_->childAt(numKeys + i);
+    aggregates_.push_back(Aggregate::create(
+        aggregate->name(), aggregationNode->step(), argTypes, resultType));
+    VELOX_CHECK(
+        aggregates_.back()->resultType()->kindEquals(resultType),
+        "Unexpected result type for an aggregation: {}, expected {}",
+        aggregates_.back()->resultType()->toString(),
+        resultType->toString());
+    channelLists_.push_back(std::move(channels));
+    constantLists_.push_back(std::move(constants));
+  }
+
+  rows_ = std::make_unique<RowContainer>(
+      keyTypes,
+      !ignoreNullKeys_,
+      aggregates_,
+      std::vector<TypePtr>{},
+      false, // hasNext
+      false, // isJoinBuild
+      false, // hasProbedFlag
+      false, // hasNormalizedKey
+      operatorCtx_->mappedMemory(),
+      ContainerRowSerde::instance());
+}
+
+bool StreamingAggregation::isSameGroup(
+    const char* group,
+    vector_size_t index) {
+  for (auto i = 0; i < keyChannels_.size(); ++i) {
+    if (!rows_->equals<true>(
+            group, rows_->columnAt(i), decodedKeys_[i], index)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StreamingAggregation::addInput(RowVectorPtr input) {
+  auto numInput = input->size();
+  activeRows_.resize(numInput);
+  activeRows_.setAll();
+
+  decodedKeys_.resize(keyChannels_.size());
+  for (auto i = 0; i < keyChannels_.size(); ++i) {
+    decodedKeys_[i].decode(*input->childAt(keyChannels_[i]), activeRows_);
+  }
+  if (ignoreNullKeys_) {
+    for (auto& decoded : decodedKeys_) {
+      if (!decoded.mayHaveNulls()) {
+        continue;
+      }
+      activeRows_.applyToSelected([&](vector_size_t row) {
+        if (decoded.isNullAt(row)) {
+          activeRows_.setValid(row, false);
+        }
+      });
+    }
+    activeRows_.updateBounds();
+  }
+
+  // Rows with the same keys are adjacent, so comparing with the last group
+  // suffices. The first row may continue the open group of the previous
+  // input.
+  inputGroups_.resize(numInput);
+  newGroups_.clear();
+  char* group = groups_.empty() ? nullptr : groups_.back();
+  activeRows_.applyToSelected([&](vector_size_t row) {
+    if (!group || !isSameGroup(group, row)) {
+      group = rows_->newRow();
+      for (auto i = 0; i < decodedKeys_.size(); ++i) {
+        rows_->store(decodedKeys_[i], row, group, i);
+      }
+      newGroups_.push_back(groups_.size());
+      groups_.push_back(group);
+    }
+    inputGroups_[row] = group;
+  });
+
+  if (!newGroups_.empty()) {
+    for (auto& aggregate : aggregates_) {
+      aggregate->initializeNewGroups(groups_.data(), newGroups_);
+    }
+  }
+
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    const auto& rows = maskedRows(i, input);
+    populateTempVectors(i, input);
+    if (isRawInput_) {
+      aggregates_[i]->addRawInput(
+          inputGroups_.data(), rows, tempVectors_, false);
+    } else {
+      aggregates_[i]->addIntermediateResults(
+          inputGroups_.data(), rows, tempVectors_, false);
+    }
+  }
+  tempVectors_.clear();
+}
+
+void StreamingAggregation::populateTempVectors(
+    int32_t aggregateIndex,
+    const RowVectorPtr& input) {
+  auto& channels = channelLists_[aggregateIndex];
+  tempVectors_.resize(channels.size());
+  for (auto i = 0; i < channels.size(); ++i) {
+    if (channels[i] == kConstantChannel) {
+      tempVectors_[i] = BaseVector::wrapInConstant(
+          input->size(), 0, constantLists_[aggregateIndex][i]);
+    } else {
+      tempVectors_[i] = input->childAt(channels[i]);
+    }
+  }
+}
+
+const SelectivityVector& StreamingAggregation::maskedRows(
+    int32_t aggregateIndex,
+    const RowVectorPtr& input) {
+  const auto& maskChannel = aggrMaskChannels_[aggregateIndex];
+  if (!maskChannel.has_value()) {
+    return activeRows_;
+  }
+  maskedRows_ = activeRows_;
+  decodedMask_.decode(*input->childAt(maskChannel.value()), activeRows_);
+  activeRows_.applyToSelected([&](vector_size_t row) {
+    if (decodedMask_.isNullAt(row) || !decodedMask_.valueAt<bool>(row)) {
+      maskedRows_.setValid(row, false);
+    }
+  });
+  maskedRows_.updateBounds();
+  return maskedRows_;
+}
+
+RowVectorPtr StreamingAggregation::getOutput() {
+  auto numGroups = numCompleteGroups();
+  if (numGroups == 0 || (!isFinishing_ && numGroups < outputBatchSize_)) {
+    return nullptr;
+  }
+  return createOutput(std::min<size_t>(numGroups, outputBatchSize_));
+}
+
+RowVectorPtr StreamingAggregation::createOutput(size_t numGroups) {
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(outputType_, numGroups, operatorCtx_->pool()));
+  auto groups = groups_.data();
+  auto numKeys = keyChannels_.size();
+  for (auto i = 0; i < numKeys; ++i) {
+    rows_->extractColumn(groups, numGroups, i, result->childAt(i));
+  }
+  for (auto i = 0; i < aggregates_.size(); ++i) {
+    aggregates_[i]->finalize(groups, numGroups);
+    auto& aggregateVector = result->childAt(numKeys + i);
+    if (isPartialOutput_) {
+      aggregates_[i]->extractAccumulators(groups, numGroups, &aggregateVector);
+    } else {
+      aggregates_[i]->extractValues(groups, numGroups, &aggregateVector);
+    }
+  }
+
+  // The produced groups are freed right away. Their rows are reused for the
+  // next groups, so that memory stays proportional to one output batch.
+  rows_->eraseRows(folly::Range<char**>(groups, numGroups));
+  groups_.erase(groups_.begin(), groups_.begin() + numGroups);
+  return result;
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/exec/Aggregate.h"
+#include "velox/exec/Operator.h"
+#include "velox/exec/RowContainer.h"
+
+namespace facebook::velox::exec {
+
+// Aggregation over input that is clustered on all grouping keys, i.e. all
+// rows of a group are adjacent. A group is complete as soon as a row with
+// different keys arrives. Complete groups are produced right away, so that
+// only the groups of about one output batch are held in memory instead of a
+// hash table of all groups.
+class StreamingAggregation : public Operator {
+ public:
+  StreamingAggregation(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::AggregationNode>& aggregationNode);
+
+  void addInput(RowVectorPtr input) override;
+
+  RowVectorPtr getOutput() override;
+
+  bool needsInput() const override {
+    return !isFinishing_ && numCompleteGroups() < outputBatchSize_;
+  }
+
+  BlockingReason isBlocked(ContinueFuture* /* unused */) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  void close() override {
+    Operator::close();
+    rows_.reset();
+    groups_.clear();
+  }
+
+ private:
+  // Returns the number of groups that can receive no more rows. The last
+  // group stays open until a row with different keys or the end of input
+  // arrives.
+  size_t numCompleteGroups() const {
+    if (groups_.empty()) {
+      return 0;
+    }
+    return isFinishing_ ? groups_.size() : groups_.size() - 1;
+  }
+
+  // Returns true if the keys of 'group' equal the keys of row 'index' of
+  // the input.
+  bool isSameGroup(const char* group, vector_size_t index);
+
+  // Sets 'tempVectors_' to the arguments of aggregate 'aggregateIndex'.
+  void populateTempVectors(int32_t aggregateIndex, const RowVectorPtr& input);
+
+  // Returns the rows of the input that aggregate 'aggregateIndex' applies
+  // to after applying its mask, if any.
+  const SelectivityVector& maskedRows(
+      int32_t aggregateIndex,
+      const RowVectorPtr& input);
+
+  // Produces the first 'numGroups' groups and frees them.
+  RowVectorPtr createOutput(size_t numGroups);
+
+  // Maximum number of rows in the output batch.
+  const uint32_t outputBatchSize_;
+
+  const bool isPartialOutput_;
+  const bool isRawInput_;
+  const bool ignoreNullKeys_;
+
+  std::vector<ChannelIndex> keyChannels_;
+  std::vector<std::unique_ptr<Aggregate>> aggregates_;
+  std::vector<std::optional<ChannelIndex>> aggrMaskChannels_;
+  std::vector<std::vector<ChannelIndex>> channelLists_;
+  std::vector<std::vector<VectorPtr>> constantLists_;
+
+  // Holds the keys and accumulators of the groups not yet produced.
+  std::unique_ptr<RowContainer> rows_;
+
+  // The groups not yet produced, in order of arrival. The last one is open.
+  std::vector<char*> groups_;
+
+  // The group of each input row.
+  std::vector<char*> inputGroups_;
+
+  // The groups created for the current input. Indices into 'groups_'.
+  std::vector<vector_size_t> newGroups_;
+
+  std::vector<DecodedVector> decodedKeys_;
+  SelectivityVector activeRows_;
+  SelectivityVector maskedRows_;
+  DecodedVector decodedMask_;
+  std::vector<VectorPtr> tempVectors_;
+};
+
+} // namespace facebook::velox::exec
@@ -34,18 +34,25 @@ TableScan::TableScan(
       tableHandle_(tableScanNode->tableHandle()),
       columnHandles_(tableScanNode->assignments()),
       driverCtx_(driverCtx),
-      blockingFuture_(false) {}
+      blockingFuture_(false),
+      preferredBatchBytes_(driverCtx->execCtx->queryCtx()
+                               ->config()
+                               .preferredOutputBatchBytes()),
+      maxPreloadedSplits_(driverCtx->execCtx->queryCtx()
+                              ->config()
+                              .maxSplitPreloadPerDriver()) {}
 
 RowVectorPtr TableScan::getOutput() {
   if (noMoreSplits_) {
     return nullptr;
   }
 
+  addRemoteDynamicFilters();
   for (;;) {
     if (needNewSplit_) {
       exec::Split split;
       auto reason = driverCtx_->task->getSplitOrFuture(
-          planNodeId_, split, blockingFuture_);
+          driverCtx_->splitGroupId, planNodeId_, split, blockingFuture_);
       if (reason != BlockingReason::kNotBlocked) {
         hasBlockingFuture_ = true;
         return nullptr;
@@ -53,13 +60,7 @@ RowVectorPtr TableScan::getOutput() {
 
       if (!split.hasConnectorSplit()) {
         noMoreSplits_ = true;
-
-        if (dataSource_) {
-          auto connectorStats = dataSource_->runtimeStats();
-          for (const auto& entry : connectorStats) {
-            stats_.runtimeStats[entry.first].addValue(entry.second);
-          }
-        }
+        addConnectorStats();
         return nullptr;
       }
 
@@ -80,15 +81,51 @@ RowVectorPtr TableScan::getOutput() {
           dataSource_->addDynamicFilter(entry.first, entry.second);
         }
         pendingDynamicFilters_.clear();
+        for (const auto& entry : pendingMultiColumnDynamicFilters_) {
+          dataSource_->addDynamicFilter(entry.channels, entry.filter);
+        }
+        pendingMultiColumnDynamicFilters_.clear();
       } else {
         VELOX_CHECK(
             connector_->connectorId() == connectorSplit->connectorId,
             "Got splits with different connector IDs");
       }
 
+      if (splitResultCacheClient_) {
+        auto cacheKey = connectorSplit->cacheKey();
+        if (!cacheKey.empty()) {
+          if (splitResultCacheClient_->startSplit(cacheKey)) {
+            // The client produces the results of the split without reading
+            // it. A preloaded reader of the split is dropped.
+            driverCtx_->task->splitFinished(planNodeId_, currentSplitGroupId_);
+            currentSplitGroupId_ = -1;
+            needNewSplit_ = true;
+            ++stats_.numSplits;
+            continue;
+          }
+          cachingSplitResults_ = true;
+        }
+      }
+
       dataSource_->addSplit(connectorSplit);
       ++stats_.numSplits;
-      setBatchSize();
+      estimatedRowSize_ = dataSource_->estimatedRowSize();
+      if (estimatedRowSize_ != connector::DataSource::kUnknownRowSize) {
+        setBatchSize(estimatedRowSize_);
+      }
+      preloadSplits();
+    }
+
+    if (driverCtx_->task->isSourceFinishedEarly(planNodeId_)) {
+      // A Limit downstream has all its rows. Drops the rest of the split
+      // and the reader with its prefetched data.
+      driverCtx_->task->splitFinished(planNodeId_, currentSplitGroupId_);
+      currentSplitGroupId_ = -1;
+      noMoreSplits_ = true;
+      stats_.addRuntimeStat("finishedEarly", 1);
+      addConnectorStats();
+      dataSource_ = nullptr;
+      return nullptr;
     }
 
     const auto ioTimeStartMicros = getCurrentTimeMicro();
@@ -102,29 +139,79 @@ RowVectorPtr TableScan::getOutput() {
       if (data->size() > 0) {
         stats_.inputPositions += data->size();
         stats_.inputBytes += data->retainedSize();
+        adaptBatchSize(*data);
         return data;
       }
       continue;
     }
 
+    if (cachingSplitResults_) {
+      cachingSplitResults_ = false;
+      splitResultCacheClient_->finishSplit();
+    }
     driverCtx_->task->splitFinished(planNodeId_, currentSplitGroupId_);
     currentSplitGroupId_ = -1;
     needNewSplit_ = true;
   }
 }
 
-void TableScan::setBatchSize() {
-  constexpr int64_t kMB = 1 << 20;
-  auto estimate = dataSource_->estimatedRowSize();
-  if (estimate == connector::DataSource::kUnknownRowSize) {
-    readBatchSize_ = kDefaultBatchSize;
+void TableScan::preloadSplits() {
+  auto executor = connector_->executor();
+  if (maxPreloadedSplits_ <= 0 || !executor) {
     return;
   }
-  if (estimate < 1024) {
-    readBatchSize_ = 10000; // No more than 10MB of data per batch.
+  driverCtx_->task->preloadSplits(
+      driverCtx_->splitGroupId,
+      planNodeId_,
+      maxPreloadedSplits_,
+      [&](const std::shared_ptr<connector::ConnectorSplit>& split) {
+        auto preparer = dataSource_->splitPreparer(split);
+        if (!preparer) {
+          return;
+        }
+        split->preload =
+            std::make_shared<connector::SplitPreload>(std::move(preparer));
+        // The Task keeps the memory pools of the DataSource alive while the
+        // preload runs. A split of a Task that is no longer running is
+        // prepared on first use, if ever.
+        executor->add([task = driverCtx_->task,
+                       planNodeId = planNodeId_,
+                       preload = split->preload]() {
+          if (task->state() == kRunning &&
+              !task->isSourceFinishedEarly(planNodeId)) {
+            preload->run();
+          }
+        });
+      });
+}
+
+void TableScan::addConnectorStats() {
+  if (!dataSource_) {
+    return;
+  }
+  auto connectorStats = dataSource_->runtimeStats();
+  for (const auto& entry : connectorStats) {
+    stats_.runtimeStats[entry.first].addValue(entry.second);
+  }
+}
+
+void TableScan::setBatchSize(int64_t rowSize) {
+  if (rowSize <= 0) {
+    readBatchSize_ = kMaxBatchSize;
     return;
   }
-  readBatchSize_ = std::min<int64_t>(100, 10 * kMB / estimate);
+  readBatchSize_ = std::clamp<int64_t>(
+      preferredBatchBytes_ / rowSize, kMinBatchSize, kMaxBatchSize);
+}
+
+void TableScan::adaptBatchSize(const RowVector& data) {
+  // The retained size does not cover columns that are not loaded yet, so
+  // the estimate of the DataSource is a lower bound.
+  int64_t rowSize = data.retainedSize() / data.size();
+  if (estimatedRowSize_ != connector::DataSource::kUnknownRowSize) {
+    rowSize = std::max(rowSize, estimatedRowSize_);
+  }
+  setBatchSize(rowSize);
 }
 
 void TableScan::addDynamicFilter(
@@ -133,7 +220,41 @@ void TableScan::addDynamicFilter(
   if (dataSource_) {
     dataSource_->addDynamicFilter(outputChannel, filter);
   } else {
-    pendingDynamicFilters_.emplace(outputChannel, filter);
+    auto it = pendingDynamicFilters_.find(outputChannel);
+    if (it == pendingDynamicFilters_.end()) {
+      pendingDynamicFilters_.emplace(outputChannel, filter);
+    } else {
+      it->second = it->second->mergeWith(filter.get());
+    }
+  }
+}
+
+void TableScan::addDynamicFilter(
+    const std::vector<ChannelIndex>& outputChannels,
+    const std::shared_ptr<common::BigintTuplesUsingBloomFilter>& filter) {
+  if (dataSource_) {
+    dataSource_->addDynamicFilter(outputChannels, filter);
+  } else {
+    pendingMultiColumnDynamicFilters_.push_back({outputChannels, filter});
+  }
+}
+
+void TableScan::addRemoteDynamicFilters() {
+  auto version = driverCtx_->task->remoteDynamicFilterVersion();
+  if (version == remoteFilterVersion_) {
+    return;
+  }
+  remoteFilterVersion_ = version;
+  auto filters =
+      driverCtx_->task->remoteDynamicFilters(planNodeId_, numRemoteFilters_);
+  numRemoteFilters_ += filters.size();
+  for (const auto& [column, filter] : filters) {
+    auto channel = outputType_->getChildIdxIfExists(column);
+    if (!channel.has_value()) {
+      continue;
+    }
+    addDynamicFilter(channel.value(), filter);
+    stats_.addRuntimeStat("remoteDynamicFiltersAccepted", 1);
   }
 }
 
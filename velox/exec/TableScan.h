@@ -16,6 +16,7 @@
 #pragma once
 
 #include "velox/core/PlanNode.h"
+#include "velox/exec/FragmentResultCache.h"
 #include "velox/exec/Operator.h"
 
 namespace facebook::velox::exec {
@@ -53,13 +54,49 @@ class TableScan : public SourceOperator {
       ChannelIndex outputChannel,
       const std::shared_ptr<common::Filter>& filter) override;
 
+  void addDynamicFilter(
+      const std::vector<ChannelIndex>& outputChannels,
+      const std::shared_ptr<common::BigintTuplesUsingBloomFilter>& filter)
+      override;
+
   void close() override;
 
+  // Tells 'client' about the splits that have a cache key and skips those
+  // whose results it has cached. 'client' is a later Operator of the same
+  // Driver. It has consumed all previous output of 'this' whenever
+  // getOutput() is called, so that its output of a split is complete when
+  // the split ends.
+  void setSplitResultCacheClient(SplitResultCacheClient* client) {
+    splitResultCacheClient_ = client;
+  }
+
  private:
   static constexpr int32_t kDefaultBatchSize = 1024;
 
-  // Adjust batch size according to split information.
-  void setBatchSize();
+  // Bounds for the number of rows requested from the DataSource.
+  static constexpr int32_t kMinBatchSize = 10;
+  static constexpr int32_t kMaxBatchSize = 10'000;
+
+  // Sets 'readBatchSize_' so that batches of rows of 'rowSize' bytes are
+  // about 'preferredBatchBytes_'.
+  void setBatchSize(int64_t rowSize);
+
+  // Adjusts 'readBatchSize_' to the size of the rows of 'data', a batch
+  // just produced by the DataSource.
+  void adaptBatchSize(const RowVector& data);
+
+  // Adds the runtime stats of 'dataSource_' to the stats of 'this'.
+  void addConnectorStats();
+
+  // Starts preparing the next queued splits on the connector's executor so
+  // that their files are open when this gets to them.
+  void preloadSplits();
+
+  // Adds the remote dynamic filters of the Task that became ready since
+  // the last call. Filters on columns that this does not produce are
+  // ignored.
+  void addRemoteDynamicFilters();
+
   const core::PlanNodeId planNodeId_;
   const std::shared_ptr<connector::ConnectorTableHandle> tableHandle_;
   const std::
@@ -78,6 +115,21 @@ class TableScan : public SourceOperator {
   // Dynamic filters to add to the data source when it gets created.
   std::unordered_map<ChannelIndex, std::shared_ptr<common::Filter>>
       pendingDynamicFilters_;
+  std::vector<MultiColumnDynamicFilter> pendingMultiColumnDynamicFilters_;
   int32_t readBatchSize_{kDefaultBatchSize};
+  const uint64_t preferredBatchBytes_;
+  // Row size estimate of the DataSource for the current split.
+  int64_t estimatedRowSize_{connector::DataSource::kUnknownRowSize};
+  // Maximum number of queued splits to prepare in the background.
+  const int32_t maxPreloadedSplits_;
+  SplitResultCacheClient* splitResultCacheClient_{nullptr};
+  // True if the current split was reported to 'splitResultCacheClient_'
+  // and was not cached.
+  bool cachingSplitResults_{false};
+  // Task::remoteDynamicFilterVersion() at the last
+  // addRemoteDynamicFilters().
+  int64_t remoteFilterVersion_{0};
+  // Number of remote dynamic filters of the Task seen so far.
+  int32_t numRemoteFilters_{0};
 };
 } // namespace facebook::velox::exec
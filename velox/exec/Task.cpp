@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/exec/Task.h"
+#include <folly/executors/QueuedImmediateExecutor.h>
 #include "velox/codegen/Codegen.h"
 #include "velox/common/time/Timer.h"
 #include "velox/exec/CrossJoinBuild.h"
@@ -22,12 +23,48 @@
 #include "velox/exec/LocalPlanner.h"
 #include "velox/exec/Merge.h"
 #include "velox/exec/PartitionedOutputBufferManager.h"
+#include "velox/exec/RemoteDynamicFilters.h"
+#include "velox/exec/TaskTemplate.h"
 #if CODEGEN_ENABLED == 1
 #include "velox/experimental/codegen/CodegenLogger.h"
 #endif
 
 namespace facebook::velox::exec {
 
+namespace {
+// Frees memory of a Task on request of the MemoryArbitrator of its
+// query.
+class TaskMemoryReclaimer : public memory::MemoryReclaimer {
+ public:
+  explicit TaskMemoryReclaimer(std::weak_ptr<Task> task)
+      : task_(std::move(task)) {}
+
+  std::shared_ptr<void> enterArbitration() override {
+    auto task = task_.lock();
+    if (!task) {
+      return nullptr;
+    }
+    auto driver = task->thisDriver();
+    if (!driver || driver->state().isSuspended) {
+      return nullptr;
+    }
+    // Lets the Task be paused while the Driver waits for arbitration.
+    return std::make_shared<SuspendedSection>(driver);
+  }
+
+  int64_t reclaim(int64_t targetBytes) override {
+    auto task = task_.lock();
+    if (!task) {
+      return 0;
+    }
+    return Task::reclaim(std::move(task), targetBytes);
+  }
+
+ private:
+  std::weak_ptr<Task> task_;
+};
+} // namespace
+
 Task::Task(
     const std::string& taskId,
     std::shared_ptr<const core::PlanNode> planNode,
@@ -47,6 +84,9 @@ Task::Task(
 
 Task::~Task() {
   try {
+    if (memoryReclaimer_) {
+      queryCtx_->memoryArbitrator()->removeReclaimer(memoryReclaimer_.get());
+    }
     if (hasPartitionedOutput_) {
       if (auto bufferManager = bufferManager_.lock()) {
         bufferManager->removeTask(taskId_);
@@ -57,33 +97,82 @@ Task::~Task() {
   }
 }
 
-void Task::start(std::shared_ptr<Task> self, uint32_t maxDrivers) {
+namespace {
+// Throws if the Drivers of 'factory' cannot run once per split group. In
+// grouped execution, each pipeline runs for each group, so its input must
+// come from the splits of the group or from another pipeline of the group.
+void checkGroupedExecutionSupported(const DriverFactory& factory) {
+  const auto& source = factory.planNodes.front();
+  VELOX_USER_CHECK(
+      std::dynamic_pointer_cast<const core::TableScanNode>(source) ||
+          std::dynamic_pointer_cast<const core::LocalPartitionNode>(source),
+      "Grouped execution requires pipelines that start with a TableScan or "
+      "a local exchange: {}",
+      source->toString());
+  for (const auto& planNode : factory.planNodes) {
+    VELOX_USER_CHECK(
+        !std::dynamic_pointer_cast<const core::MergeJoinNode>(planNode),
+        "Grouped execution does not support merge join: {}",
+        planNode->toString());
+  }
+}
+} // namespace
+
+void Task::start(
+    std::shared_ptr<Task> self,
+    uint32_t maxDrivers,
+    uint32_t numSplitGroups,
+    uint32_t concurrentSplitGroups) {
   VELOX_CHECK(self->drivers_.empty());
   {
     std::lock_guard<std::mutex> l(self->mutex_);
     self->taskStats_.executionStartTimeMs = getCurrentTimeMs();
   }
 
+  if (self->taskTemplate_) {
+    // The template planned the fragment once for all its Tasks.
+    for (const auto& factory : self->taskTemplate_->driverFactories()) {
+      self->driverFactories_.push_back(
+          std::make_unique<DriverFactory>(*factory));
+    }
+  } else {
 #if CODEGEN_ENABLED == 1
-  const auto& config = self->queryCtx()->config();
-  if (config.codegenEnabled() &&
-      config.codegenConfigurationFilePath().length() != 0) {
-    auto codegenLogger =
-        std::make_shared<codegen::DefaultLogger>(self->taskId_);
-    auto codegen = codegen::Codegen(codegenLogger);
-    auto lazyLoading = config.codegenLazyLoading();
-    codegen.initializeFromFile(
-        config.codegenConfigurationFilePath(), lazyLoading);
-    auto newPlanNode = codegen.compile(*(self->planNode_));
-    self->planNode_ = newPlanNode != nullptr ? newPlanNode : self->planNode_;
-  }
+    const auto& config = self->queryCtx()->config();
+    if (config.codegenEnabled() &&
+        config.codegenConfigurationFilePath().length() != 0) {
+      auto codegenLogger =
+          std::make_shared<codegen::DefaultLogger>(self->taskId_);
+      auto codegen = std::make_shared<codegen::Codegen>(codegenLogger);
+      auto lazyLoading = config.codegenLazyLoading();
+      codegen->initializeFromFile(
+          config.codegenConfigurationFilePath(), lazyLoading);
+      auto newPlanNode = config.codegenAsync()
+          ? codegen->compileAsync(self->planNode_)
+          : codegen->compile(*(self->planNode_));
+      self->planNode_ =
+          newPlanNode != nullptr ? newPlanNode : self->planNode_;
+    }
 #endif
 
-  LocalPlanner::plan(
-      self->planNode_, self->consumerSupplier(), &self->driverFactories_);
+    LocalPlanner::plan(
+        self->planNode_,
+        self->queryCtx()->config(),
+        self->consumerSupplier(),
+        &self->driverFactories_);
+  }
 
+  if (numSplitGroups) {
+    for (auto& factory : self->driverFactories_) {
+      checkGroupedExecutionSupported(*factory);
+    }
+  }
+  self->maxDrivers_ = maxDrivers;
+  // The Drivers of all split groups count towards 'numDrivers_', so that
+  // 'this' finishes after the last group.
+  const auto numDriverSets = std::max<uint32_t>(1, numSplitGroups);
   for (auto& factory : self->driverFactories_) {
-    self->numDrivers_ += std::min(factory->maxDrivers, maxDrivers);
+    self->numDrivers_ +=
+        std::min(factory->maxDrivers, maxDrivers) * numDriverSets;
   }
 
   const auto numDriverFactories = self->driverFactories_.size();
@@ -105,12 +194,23 @@ void Task::start(std::shared_ptr<Task> self, uint32_t maxDrivers) {
       "Unable to initialize task. "
       "PartitionedOutputBufferManager was already destructed");
 
-  std::vector<std::shared_ptr<Driver>> drivers;
-  drivers.reserve(self->numDrivers_);
+  // Parked Drivers would not be accounted to their split group, so
+  // adaptive driver count applies to ungrouped execution only.
+  const bool adaptiveDriverCount =
+      self->queryCtx()->config().adaptiveDriverCountEnabled() &&
+      !numSplitGroups;
+  if (adaptiveDriverCount) {
+    self->elasticPipelines_.resize(self->driverFactories_.size());
+  }
   for (auto pipeline = 0; pipeline < self->driverFactories_.size();
        ++pipeline) {
     auto& factory = self->driverFactories_[pipeline];
     auto numDrivers = std::min(factory->maxDrivers, maxDrivers);
+    if (adaptiveDriverCount && numDrivers > 1 &&
+        std::dynamic_pointer_cast<const core::TableScanNode>(
+            factory->planNodes.front())) {
+      self->elasticPipelines_[pipeline].numActive = numDrivers;
+    }
     auto partitionedOutputNode = factory->needsPartitionedOutput();
     if (partitionedOutputNode) {
       VELOX_CHECK(
@@ -121,8 +221,80 @@ void Task::start(std::shared_ptr<Task> self, uint32_t maxDrivers) {
           self,
           partitionedOutputNode->isBroadcast(),
           partitionedOutputNode->numPartitions(),
-          numDrivers);
+          numDrivers * numDriverSets);
     }
+  }
+
+  std::vector<std::shared_ptr<Driver>> drivers;
+  std::vector<int32_t> splitGroupIds;
+  int32_t numDriversPerGroup = 0;
+  if (numSplitGroups) {
+    {
+      std::lock_guard<std::mutex> l(self->mutex_);
+      self->numSplitGroups_ = numSplitGroups;
+      // Splits added before start go to the queues of their groups.
+      for (auto& [planNodeId, splitsState] : self->splitsStates_) {
+        for (auto& split : splitsState.splits) {
+          VELOX_USER_CHECK(
+              split.hasGroup(),
+              "Splits of grouped execution must have a split group id");
+          splitsState.groupSplits[split.groupId].splits.push_back(
+              std::move(split));
+        }
+        splitsState.splits.clear();
+      }
+      self->nextSplitGroupId_ =
+          std::min(numSplitGroups, std::max(1U, concurrentSplitGroups));
+      for (auto i = 0; i < self->nextSplitGroupId_; ++i) {
+        splitGroupIds.push_back(i);
+      }
+    }
+    for (auto splitGroupId : splitGroupIds) {
+      auto groupDrivers = createDrivers(self, splitGroupId);
+      numDriversPerGroup = groupDrivers.size();
+      drivers.insert(drivers.end(), groupDrivers.begin(), groupDrivers.end());
+    }
+  } else {
+    drivers = createDrivers(self, kUngroupedGroupId);
+  }
+
+  if (auto arbitrator = self->queryCtx_->memoryArbitrator()) {
+    auto tracker = self->pool_->getMemoryUsageTracker();
+    if (!tracker) {
+      tracker = self->queryCtx_->pool()->getMemoryUsageTracker();
+    }
+    VELOX_CHECK_NOT_NULL(
+        tracker, "Memory arbitration requires a MemoryUsageTracker");
+    self->memoryReclaimer_ = std::make_shared<TaskMemoryReclaimer>(self);
+    arbitrator->addReclaimer(*tracker, self->memoryReclaimer_);
+  }
+  // Set and start all Drivers together inside 'mutex_' so that
+  // cancellations and pauses have well
+  // defined timing. For example, do not pause and restart a task
+  // while it is still adding Drivers.
+  std::lock_guard<std::mutex> l(self->mutex_);
+  self->drivers_ = std::move(drivers);
+  for (auto splitGroupId : splitGroupIds) {
+    self->splitGroupStateLocked(splitGroupId).numRunningDrivers =
+        numDriversPerGroup;
+  }
+  for (auto& driver : self->drivers_) {
+    if (driver) {
+      Driver::enqueue(driver);
+    }
+  }
+}
+
+// static
+std::vector<std::shared_ptr<Driver>> Task::createDrivers(
+    const std::shared_ptr<Task>& self,
+    int32_t splitGroupId) {
+  std::vector<std::shared_ptr<Driver>> drivers;
+  const auto maxDrivers = self->maxDrivers_;
+  for (auto pipeline = 0; pipeline < self->driverFactories_.size();
+       ++pipeline) {
+    auto& factory = self->driverFactories_[pipeline];
+    auto numDrivers = std::min(factory->maxDrivers, maxDrivers);
 
     std::shared_ptr<ExchangeClient> exchangeClient = nullptr;
     if (factory->needsExchangeClient()) {
@@ -131,41 +303,85 @@ void Task::start(std::shared_ptr<Task> self, uint32_t maxDrivers) {
 
     auto exchangeId = factory->needsLocalExchangeSource();
     if (exchangeId.has_value()) {
-      self->createLocalExchangeSources(exchangeId.value(), numDrivers);
+      self->createLocalExchangeSources(
+          splitGroupId, exchangeId.value(), numDrivers);
     }
 
-    self->addHashJoinBridges(factory->needsHashJoinBridges());
-    self->addCrossJoinBridges(factory->needsCrossJoinBridges());
+    self->addHashJoinBridges(splitGroupId, factory->needsHashJoinBridges());
+    self->addCrossJoinBridges(splitGroupId, factory->needsCrossJoinBridges());
 
+    auto& operatorStats =
+        self->taskStats_.pipelineStats[pipeline].operatorStats;
     for (int32_t i = 0; i < numDrivers; ++i) {
       drivers.push_back(factory->createDriver(
-          std::make_unique<DriverCtx>(self, i, pipeline, numDrivers),
+          std::make_unique<DriverCtx>(
+              self, i, pipeline, numDrivers, splitGroupId),
           exchangeClient,
           [self, maxDrivers](size_t i) {
             return i < self->driverFactories_.size()
                 ? std::min(self->driverFactories_[i]->maxDrivers, maxDrivers)
                 : 0;
           }));
-      if (i == 0) {
-        drivers.back()->initializeOperatorStats(
-            self->taskStats_.pipelineStats[pipeline].operatorStats);
+      // The stats are initialized by the first Driver of the first split
+      // group.
+      if (i == 0 && operatorStats.empty()) {
+        drivers.back()->initializeOperatorStats(operatorStats);
       }
     }
   }
-  self->noMoreLocalExchangeProducers();
-  // Set and start all Drivers together inside 'mutex_' so that
-  // cancellations and pauses have well
-  // defined timing. For example, do not pause and restart a task
-  // while it is still adding Drivers.
-  std::lock_guard<std::mutex> l(self->mutex_);
-  self->drivers_ = std::move(drivers);
-  for (auto& driver : self->drivers_) {
-    if (driver) {
-      Driver::enqueue(driver);
+  self->noMoreLocalExchangeProducers(splitGroupId);
+  return drivers;
+}
+
+// static
+void Task::startSplitGroup(
+    const std::shared_ptr<Task>& self,
+    int32_t splitGroupId) {
+  auto drivers = createDrivers(self, splitGroupId);
+  bool running;
+  {
+    std::lock_guard<std::mutex> l(self->mutex_);
+    running = self->state_ == kRunning;
+    self->splitGroupStateLocked(splitGroupId).numRunningDrivers =
+        drivers.size();
+    for (auto& driver : drivers) {
+      self->drivers_.push_back(driver);
+      if (running && !self->pauseRequested_) {
+        // Otherwise resume() enqueues the Driver.
+        Driver::enqueue(driver);
+      }
+    }
+  }
+  if (!running) {
+    // terminate() has already gone over 'drivers_'. The Drivers are not
+    // on thread, so they close here.
+    for (auto& driver : drivers) {
+      driver->terminate();
     }
   }
 }
 
+int32_t Task::splitGroupFinishedLocked(int32_t splitGroupId) {
+  // Frees the hash tables and local exchange buffers of the group.
+  splitGroupStates_.erase(splitGroupId);
+  if (nextSplitGroupId_ >= numSplitGroups_ || state_ != kRunning) {
+    return kUngroupedGroupId;
+  }
+  return nextSplitGroupId_++;
+}
+
+Task::SplitGroupState& Task::splitGroupStateLocked(int32_t splitGroupId) {
+  auto it = splitGroupStates_.find(splitGroupId);
+  if (it == splitGroupStates_.end()) {
+    VELOX_CHECK(
+        splitGroupId == kUngroupedGroupId || numSplitGroups_,
+        "Split group {} in ungrouped execution",
+        splitGroupId);
+    it = splitGroupStates_.emplace(splitGroupId, SplitGroupState()).first;
+  }
+  return it->second;
+}
+
 // static
 void Task::resume(std::shared_ptr<Task> self) {
   VELOX_CHECK(!self->exception_, "Cannot resume failed task");
@@ -186,6 +402,9 @@ void Task::resume(std::shared_ptr<Task> self) {
         // enqueued twice.
         continue;
       }
+      if (driver->state().isParked) {
+        continue;
+      }
       VELOX_CHECK(!driver->isOnThread() && !driver->isTerminated());
       if (!driver->state().hasBlockingFuture) {
         // Do not continue a Driver that is blocked on external
@@ -196,26 +415,145 @@ void Task::resume(std::shared_ptr<Task> self) {
   }
 }
 
+// static
+int64_t Task::reclaim(std::shared_ptr<Task> self, int64_t targetBytes) {
+  if (self->state() != kRunning) {
+    return 0;
+  }
+  self->requestPause(true);
+  auto& executor = folly::QueuedImmediateExecutor::instance();
+  self->finishFuture().via(&executor).wait();
+
+  std::vector<std::shared_ptr<Driver>> drivers;
+  {
+    std::lock_guard<std::mutex> l(self->mutex_);
+    drivers = self->drivers_;
+  }
+  int64_t freed = 0;
+  try {
+    for (auto& driver : drivers) {
+      if (freed >= targetBytes) {
+        break;
+      }
+      if (!driver || driver->isTerminated() || driver->state().isSuspended) {
+        continue;
+      }
+      freed += driver->reclaim(targetBytes - freed);
+    }
+  } catch (const std::exception&) {
+    self->setError(std::current_exception());
+    return freed;
+  }
+  if (!self->error()) {
+    resume(self);
+  }
+  return freed;
+}
+
 // static
 void Task::removeDriver(std::shared_ptr<Task> self, Driver* driver) {
-  std::lock_guard<std::mutex> taskLock(self->mutex_);
-  for (auto& driverPtr : self->drivers_) {
+  auto nextSplitGroupId = kUngroupedGroupId;
+  {
+    std::lock_guard<std::mutex> taskLock(self->mutex_);
+    nextSplitGroupId = self->removeDriverLocked(driver);
+  }
+  if (nextSplitGroupId != kUngroupedGroupId) {
+    startSplitGroup(self, nextSplitGroupId);
+  }
+}
+
+int32_t Task::removeDriverLocked(Driver* driver) {
+  for (auto& driverPtr : drivers_) {
     if (driverPtr.get() == driver) {
       driverPtr = nullptr;
-      self->driverClosedLocked();
-      return;
+      driverClosedLocked();
+      auto splitGroupId = driver->driverCtx()->splitGroupId;
+      if (splitGroupId != kUngroupedGroupId &&
+          --splitGroupStateLocked(splitGroupId).numRunningDrivers == 0) {
+        return splitGroupFinishedLocked(splitGroupId);
+      }
+      auto pipelineId = driver->driverCtx()->pipelineId;
+      if (pipelineId < elasticPipelines_.size()) {
+        auto& pipeline = elasticPipelines_[pipelineId];
+        if (driver->state().isParked) {
+          // A parked Driver is closed by terminate.
+          auto it = std::find_if(
+              pipeline.parked.begin(),
+              pipeline.parked.end(),
+              [&](const auto& parked) { return parked.get() == driver; });
+          VELOX_CHECK(it != pipeline.parked.end());
+          pipeline.parked.erase(it);
+        } else if (pipeline.numActive) {
+          // A parked Driver takes the place of a finished one.
+          --pipeline.numActive;
+          unparkDriverLocked(pipelineId);
+        }
+      }
+      return kUngroupedGroupId;
     }
   }
   VELOX_FAIL("Trying to delete a Driver twice from its Task");
 }
 
+namespace {
+// A Driver of an elastic pipeline that waited at least this long for its
+// consumer is parked. If a Driver waited less than kUnparkMaxBlockedMicros,
+// the consumer keeps up and a parked Driver is taken back.
+constexpr uint64_t kParkMinBlockedMicros = 10'000;
+constexpr uint64_t kUnparkMaxBlockedMicros = 1'000;
+} // namespace
+
+bool Task::maybeParkDriverLocked(
+    const std::shared_ptr<Driver>& driver,
+    BlockingReason reason,
+    uint64_t blockedMicros) {
+  auto pipelineId = driver->driverCtx()->pipelineId;
+  if (reason != BlockingReason::kWaitForConsumer ||
+      pipelineId >= elasticPipelines_.size()) {
+    return false;
+  }
+  auto& pipeline = elasticPipelines_[pipelineId];
+  if (!pipeline.numActive) {
+    return false;
+  }
+  if (blockedMicros >= kParkMinBlockedMicros && pipeline.numActive > 1 &&
+      !terminateRequested_) {
+    driver->state().isParked = true;
+    pipeline.parked.push_back(driver);
+    --pipeline.numActive;
+    return true;
+  }
+  if (blockedMicros < kUnparkMaxBlockedMicros) {
+    unparkDriverLocked(pipelineId);
+  }
+  return false;
+}
+
+void Task::unparkDriverLocked(int32_t pipelineId) {
+  auto& pipeline = elasticPipelines_[pipelineId];
+  if (pipeline.parked.empty() || terminateRequested_) {
+    return;
+  }
+  auto driver = std::move(pipeline.parked.back());
+  pipeline.parked.pop_back();
+  driver->state().isParked = false;
+  ++pipeline.numActive;
+  if (!pauseRequested_) {
+    // Otherwise resume() enqueues the Driver.
+    Driver::enqueue(driver);
+  }
+}
+
 void Task::setMaxSplitSequenceId(
     const core::PlanNodeId& planNodeId,
     long maxSequenceId) {
   std::lock_guard<std::mutex> l(mutex_);
+  auto& splitsState = splitsStates_[planNodeId];
+  if (splitsState.finishedEarly) {
+    return;
+  }
   VELOX_CHECK(state_ == kRunning);
 
-  auto& splitsState = splitsStates_[planNodeId];
   // We could have been sent an old split again, so only change max id, when the
   // new one is greater.
   splitsState.maxSequenceId =
@@ -230,12 +568,15 @@ bool Task::addSplitWithSequence(
   bool added = false;
   {
     std::lock_guard<std::mutex> l(mutex_);
+    auto& splitsState = splitsStates_[planNodeId];
+    if (splitsState.finishedEarly) {
+      return false;
+    }
     VELOX_CHECK(state_ == kRunning);
 
     // The same split can be added again in some systems. The systems that want
     // 'one split processed once only' would use this method and duplicate
     // splits would be ignored.
-    auto& splitsState = splitsStates_[planNodeId];
     if (sequenceId > splitsState.maxSequenceId) {
       promise = addSplitLocked(splitsState, std::move(split));
       added = true;
@@ -251,9 +592,14 @@ void Task::addSplit(const core::PlanNodeId& planNodeId, exec::Split&& split) {
   std::unique_ptr<ContinuePromise> promise;
   {
     std::lock_guard<std::mutex> l(mutex_);
+    auto& splitsState = splitsStates_[planNodeId];
+    if (splitsState.finishedEarly) {
+      // The scan needs no more rows. The Task may be finished already.
+      return;
+    }
     VELOX_CHECK(state_ == kRunning);
 
-    promise = addSplitLocked(splitsStates_[planNodeId], std::move(split));
+    promise = addSplitLocked(splitsState, std::move(split));
   }
   if (promise) {
     promise->setValue(false);
@@ -266,6 +612,22 @@ std::unique_ptr<ContinuePromise> Task::addSplitLocked(
   ++taskStats_.numTotalSplits;
   ++taskStats_.numQueuedSplits;
 
+  if (numSplitGroups_) {
+    VELOX_USER_CHECK(
+        split.hasGroup(),
+        "Splits of grouped execution must have a split group id");
+    auto& group = splitsState.groupSplits[split.groupId];
+    ++group.numIncompleteSplits;
+    group.splits.push_back(std::move(split));
+    if (group.splitPromises.empty()) {
+      return nullptr;
+    }
+    auto promise = std::make_unique<ContinuePromise>(
+        std::move(group.splitPromises.back()));
+    group.splitPromises.pop_back();
+    return promise;
+  }
+
   splitsState.splits.push_back(split);
 
   if (split.hasGroup()) {
@@ -284,14 +646,20 @@ std::unique_ptr<ContinuePromise> Task::addSplitLocked(
 void Task::noMoreSplitsForGroup(
     const core::PlanNodeId& planNodeId,
     int32_t splitGroupId) {
-  std::lock_guard<std::mutex> l(mutex_);
+  std::vector<ContinuePromise> promises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
 
-  auto& splitsState = splitsStates_[planNodeId];
-  splitsState.groupSplits[splitGroupId].noMoreSplits = true;
-  checkGroupSplitsCompleteLocked(
-      splitsState.groupSplits,
-      splitGroupId,
-      splitsState.groupSplits.find(splitGroupId));
+    auto& splitsState = splitsStates_[planNodeId];
+    auto& group = splitsState.groupSplits[splitGroupId];
+    group.noMoreSplits = true;
+    promises = std::move(group.splitPromises);
+    checkGroupSplitsCompleteLocked(
+        splitsState, splitGroupId, splitsState.groupSplits.find(splitGroupId));
+  }
+  for (auto& promise : promises) {
+    promise.setValue(false);
+  }
 }
 
 void Task::noMoreSplits(const core::PlanNodeId& planNodeId) {
@@ -302,6 +670,12 @@ void Task::noMoreSplits(const core::PlanNodeId& planNodeId) {
     auto& splitsState = splitsStates_[planNodeId];
     splitsState.noMoreSplits = true;
     promises = std::move(splitsState.splitPromises);
+    for (auto& [splitGroupId, group] : splitsState.groupSplits) {
+      for (auto& promise : group.splitPromises) {
+        promises.push_back(std::move(promise));
+      }
+      group.splitPromises.clear();
+    }
   }
   for (auto& promise : promises) {
     promise.setValue(false);
@@ -321,12 +695,17 @@ bool Task::isAllSplitsFinishedLocked() {
 }
 
 BlockingReason Task::getSplitOrFuture(
+    int32_t splitGroupId,
     const core::PlanNodeId& planNodeId,
     exec::Split& split,
     ContinueFuture& future) {
   std::lock_guard<std::mutex> l(mutex_);
 
   auto& splitsState = splitsStates_[planNodeId];
+  if (splitGroupId != kUngroupedGroupId) {
+    return getGroupSplitOrFutureLocked(
+        splitsState, splitGroupId, split, future);
+  }
   if (splitsState.splits.empty()) {
     if (splitsState.noMoreSplits) {
       return BlockingReason::kNotBlocked;
@@ -352,6 +731,68 @@ BlockingReason Task::getSplitOrFuture(
   return BlockingReason::kNotBlocked;
 }
 
+BlockingReason Task::getGroupSplitOrFutureLocked(
+    SplitsState& splitsState,
+    int32_t splitGroupId,
+    exec::Split& split,
+    ContinueFuture& future) {
+  if (splitsState.completedGroups.count(splitGroupId)) {
+    return BlockingReason::kNotBlocked;
+  }
+  auto& group = splitsState.groupSplits[splitGroupId];
+  if (group.splits.empty()) {
+    if (group.noMoreSplits || splitsState.noMoreSplits) {
+      return BlockingReason::kNotBlocked;
+    }
+    auto [splitPromise, splitFuture] = makeVeloxPromiseContract<bool>(
+        fmt::format("Task::getSplitOrFuture {}", taskId_));
+    future = std::move(splitFuture);
+    group.splitPromises.push_back(std::move(splitPromise));
+    return BlockingReason::kWaitForSplit;
+  }
+
+  split = std::move(group.splits.front());
+  group.splits.pop_front();
+
+  --taskStats_.numQueuedSplits;
+  ++taskStats_.numRunningSplits;
+
+  if (taskStats_.firstSplitStartTimeMs == 0) {
+    taskStats_.firstSplitStartTimeMs = getCurrentTimeMs();
+  }
+  taskStats_.lastSplitStartTimeMs = getCurrentTimeMs();
+
+  return BlockingReason::kNotBlocked;
+}
+
+void Task::preloadSplits(
+    int32_t splitGroupId,
+    const core::PlanNodeId& planNodeId,
+    int32_t maxSplits,
+    const std::function<void(
+        const std::shared_ptr<connector::ConnectorSplit>&)>& preload) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = splitsStates_.find(planNodeId);
+  if (it == splitsStates_.end()) {
+    return;
+  }
+  std::deque<exec::Split>* splitsPtr = &it->second.splits;
+  if (splitGroupId != kUngroupedGroupId) {
+    auto groupIt = it->second.groupSplits.find(splitGroupId);
+    if (groupIt == it->second.groupSplits.end()) {
+      return;
+    }
+    splitsPtr = &groupIt->second.splits;
+  }
+  auto& splits = *splitsPtr;
+  for (auto i = 0; i < splits.size() && i < maxSplits; ++i) {
+    const auto& connectorSplit = splits[i].connectorSplit;
+    if (connectorSplit && !connectorSplit->preload) {
+      preload(connectorSplit);
+    }
+  }
+}
+
 void Task::splitFinished(
     const core::PlanNodeId& planNodeId,
     int32_t splitGroupId) {
@@ -378,9 +819,130 @@ void Task::splitFinished(
           "Number of incomplete splits in group {} is negative: {}!",
           splitGroupId,
           it->second.numIncompleteSplits);
-      checkGroupSplitsCompleteLocked(splitsState.groupSplits, splitGroupId, it);
+      checkGroupSplitsCompleteLocked(splitsState, splitGroupId, it);
+    }
+  }
+}
+
+void Task::finishSourceEarly(const core::PlanNodeId& planNodeId) {
+  std::vector<ContinuePromise> promises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    if (numSplitGroups_) {
+      return;
+    }
+    auto& splitsState = splitsStates_[planNodeId];
+    if (splitsState.finishedEarly) {
+      return;
+    }
+    splitsState.finishedEarly = true;
+    splitsState.noMoreSplits = true;
+    anySourceFinishedEarly_ = true;
+    // The dropped splits count as finished.
+    for (auto& split : splitsState.splits) {
+      --taskStats_.numQueuedSplits;
+      ++taskStats_.numFinishedSplits;
+      if (split.hasGroup()) {
+        auto it = splitsState.groupSplits.find(split.groupId);
+        if (it != splitsState.groupSplits.end()) {
+          --it->second.numIncompleteSplits;
+          checkGroupSplitsCompleteLocked(splitsState, split.groupId, it);
+        }
+      }
     }
+    splitsState.splits.clear();
+    if (isAllSplitsFinishedLocked()) {
+      taskStats_.executionEndTimeMs = getCurrentTimeMs();
+    }
+    promises = std::move(splitsState.splitPromises);
+  }
+  // Wakes up the scans waiting for splits, which then see the end.
+  for (auto& promise : promises) {
+    promise.setValue(false);
+  }
+}
+
+bool Task::isSourceFinishedEarly(const core::PlanNodeId& planNodeId) {
+  if (!anySourceFinishedEarly_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = splitsStates_.find(planNodeId);
+  return it != splitsStates_.end() && it->second.finishedEarly;
+}
+
+void Task::setJoinBuildFilters(
+    const core::PlanNodeId& planNodeId,
+    std::vector<std::shared_ptr<common::Filter>> filters) {
+  std::vector<ContinuePromise> promises;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    auto& state = joinBuildFilters_[planNodeId];
+    state.ready = true;
+    state.filters = std::move(filters);
+    promises = std::move(state.promises);
+  }
+  for (auto& promise : promises) {
+    promise.setValue(true);
+  }
+}
+
+std::optional<std::vector<std::shared_ptr<common::Filter>>>
+Task::getJoinBuildFilters(
+    const core::PlanNodeId& planNodeId,
+    ContinueFuture* future) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& state = joinBuildFilters_[planNodeId];
+  if (state.ready) {
+    return state.filters;
+  }
+  if (future) {
+    state.promises.emplace_back(
+        fmt::format("Task::getJoinBuildFilters {}", taskId_));
+    *future = state.promises.back().getSemiFuture();
   }
+  return std::nullopt;
+}
+
+void Task::addRemoteDynamicFilter(
+    const core::PlanNodeId& planNodeId,
+    const std::string& column,
+    const std::string& sourceTaskId,
+    int32_t numSources,
+    std::shared_ptr<common::Filter> filter) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& state = remoteDynamicFilters_[planNodeId];
+  if (state.readyColumns.count(column)) {
+    return;
+  }
+  auto& pending = state.pending[column];
+  if (!pending.sources.insert(sourceTaskId).second) {
+    return;
+  }
+  pending.filters.push_back(std::move(filter));
+  if (pending.sources.size() < numSources) {
+    return;
+  }
+  auto merged = unionDynamicFilters(pending.filters);
+  state.pending.erase(column);
+  state.readyColumns.insert(column);
+  if (merged) {
+    state.ready.emplace_back(column, std::move(merged));
+    ++remoteDynamicFilterVersion_;
+  }
+}
+
+std::vector<std::pair<std::string, std::shared_ptr<common::Filter>>>
+Task::remoteDynamicFilters(
+    const core::PlanNodeId& planNodeId,
+    int32_t firstIndex) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = remoteDynamicFilters_.find(planNodeId);
+  if (it == remoteDynamicFilters_.end() ||
+      firstIndex >= it->second.ready.size()) {
+    return {};
+  }
+  return {it->second.ready.begin() + firstIndex, it->second.ready.end()};
 }
 
 void Task::multipleSplitsFinished(int32_t numSplits) {
@@ -390,11 +952,12 @@ void Task::multipleSplitsFinished(int32_t numSplits) {
 }
 
 void Task::checkGroupSplitsCompleteLocked(
-    std::unordered_map<int32_t, GroupSplitsInfo>& mapGroupSplits,
+    SplitsState& splitsState,
     int32_t splitGroupId,
     std::unordered_map<int32_t, GroupSplitsInfo>::iterator it) {
   if (it->second.numIncompleteSplits == 0 and it->second.noMoreSplits) {
-    mapGroupSplits.erase(it);
+    splitsState.groupSplits.erase(it);
+    splitsState.completedGroups.insert(splitGroupId);
     taskStats_.completedSplitGroups.emplace(splitGroupId);
   }
 }
@@ -437,7 +1000,8 @@ void Task::driverClosedLocked() {
 }
 
 std::shared_ptr<ExchangeClient> Task::addExchangeClient() {
-  exchangeClients_.emplace_back(std::make_shared<ExchangeClient>(destination_));
+  exchangeClients_.emplace_back(std::make_shared<ExchangeClient>(
+      destination_, queryCtx_->config().maxExchangeBufferSize()));
   return exchangeClients_.back();
 }
 
@@ -451,12 +1015,14 @@ bool Task::allPeersFinished(
   if (exception_) {
     VELOX_FAIL("Task is terminating because of error: {}", errorMessage());
   }
-  auto& state = barriers_[planNodeId];
+  auto& barriers =
+      splitGroupStateLocked(caller->driverCtx()->splitGroupId).barriers;
+  auto& state = barriers[planNodeId];
 
   if (++state.numRequested == caller->driverCtx()->numDrivers) {
     peers = std::move(state.drivers);
     promises = std::move(state.promises);
-    barriers_.erase(planNodeId);
+    barriers.erase(planNodeId);
     return true;
   }
   std::shared_ptr<Driver> callerShared;
@@ -476,27 +1042,33 @@ bool Task::allPeersFinished(
 }
 
 void Task::addHashJoinBridges(
+    int32_t splitGroupId,
     const std::vector<core::PlanNodeId>& planNodeIds) {
   std::lock_guard<std::mutex> l(mutex_);
+  auto& bridges = splitGroupStateLocked(splitGroupId).bridges;
   for (const auto& planNodeId : planNodeIds) {
-    bridges_.emplace(planNodeId, std::make_shared<HashJoinBridge>());
+    bridges.emplace(planNodeId, std::make_shared<HashJoinBridge>());
   }
 }
 
 void Task::addCrossJoinBridges(
+    int32_t splitGroupId,
     const std::vector<core::PlanNodeId>& planNodeIds) {
   std::lock_guard<std::mutex> l(mutex_);
+  auto& bridges = splitGroupStateLocked(splitGroupId).bridges;
   for (const auto& planNodeId : planNodeIds) {
-    bridges_.emplace(planNodeId, std::make_shared<CrossJoinBridge>());
+    bridges.emplace(planNodeId, std::make_shared<CrossJoinBridge>());
   }
 }
 
 std::shared_ptr<HashJoinBridge> Task::getHashJoinBridge(
+    int32_t splitGroupId,
     const core::PlanNodeId& planNodeId) {
   std::lock_guard<std::mutex> l(mutex_);
-  auto it = bridges_.find(planNodeId);
+  auto& bridges = splitGroupStateLocked(splitGroupId).bridges;
+  auto it = bridges.find(planNodeId);
   VELOX_CHECK(
-      it != bridges_.end(),
+      it != bridges.end(),
       "Hash join bridge for plan node ID not found: {}",
       planNodeId);
   auto bridge = std::dynamic_pointer_cast<HashJoinBridge>(it->second);
@@ -507,12 +1079,27 @@ std::shared_ptr<HashJoinBridge> Task::getHashJoinBridge(
   return bridge;
 }
 
+std::shared_ptr<SharedAggregationTable> Task::getSharedAggregationTable(
+    int32_t splitGroupId,
+    const core::PlanNodeId& planNodeId,
+    const std::function<std::shared_ptr<SharedAggregationTable>()>& create) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& table =
+      splitGroupStateLocked(splitGroupId).sharedAggregations[planNodeId];
+  if (!table) {
+    table = create();
+  }
+  return table;
+}
+
 std::shared_ptr<CrossJoinBridge> Task::getCrossJoinBridge(
+    int32_t splitGroupId,
     const core::PlanNodeId& planNodeId) {
   std::lock_guard<std::mutex> l(mutex_);
-  auto it = bridges_.find(planNodeId);
+  auto& bridges = splitGroupStateLocked(splitGroupId).bridges;
+  auto it = bridges.find(planNodeId);
   VELOX_CHECK(
-      it != bridges_.end(),
+      it != bridges.end(),
       "Join bridge for plan node ID not found:{}",
       planNodeId);
   auto bridge = std::dynamic_pointer_cast<CrossJoinBridge>(it->second);
@@ -538,6 +1125,9 @@ std::string Task::shortId(const std::string& id) {
 }
 
 void Task::terminate(TaskState terminalState) {
+  // Split groups that start after this see the terminal state and
+  // terminate their own Drivers.
+  std::vector<std::shared_ptr<Driver>> drivers;
   {
     std::lock_guard<std::mutex> l(mutex_);
     if (taskStats_.executionEndTimeMs == 0) {
@@ -547,9 +1137,10 @@ void Task::terminate(TaskState terminalState) {
       return;
     }
     state_ = terminalState;
+    drivers = drivers_;
   }
   requestTerminate();
-  for (auto driver : drivers_) {
+  for (auto& driver : drivers) {
     // 'driver' is a  copy of the shared_ptr in
     // 'drivers_'. This is safe against a concurrent remove of the
     // Driver.
@@ -566,23 +1157,34 @@ void Task::terminate(TaskState terminalState) {
   // Release reference to exchange client, so that it will close exchange
   // sources and prevent resending requests for data.
   std::vector<ContinuePromise> promises;
-  std::unordered_map<std::string, std::shared_ptr<JoinBridge>> oldBridges;
+  std::vector<std::shared_ptr<JoinBridge>> oldBridges;
   {
     std::lock_guard<std::mutex> l(mutex_);
     exchangeClients_.clear();
-    oldBridges = std::move(bridges_);
+    for (auto& [splitGroupId, splitGroupState] : splitGroupStates_) {
+      for (auto& pair : splitGroupState.bridges) {
+        oldBridges.push_back(std::move(pair.second));
+      }
+      splitGroupState.bridges.clear();
+    }
     for (auto& pair : splitsStates_) {
       for (auto& promise : pair.second.splitPromises) {
         promises.push_back(std::move(promise));
       }
       pair.second.splitPromises.clear();
+      for (auto& [splitGroupId, group] : pair.second.groupSplits) {
+        for (auto& promise : group.splitPromises) {
+          promises.push_back(std::move(promise));
+        }
+        group.splitPromises.clear();
+      }
     }
   }
   for (auto& promise : promises) {
     promise.setValue(true);
   }
-  for (auto& pair : oldBridges) {
-    pair.second->cancel();
+  for (auto& bridge : oldBridges) {
+    bridge->cancel();
   }
   stateChangedLocked();
 }
@@ -596,12 +1198,43 @@ void Task::addOperatorStats(OperatorStats& stats) {
       stats.operatorId >= 0 &&
       stats.operatorId <
           taskStats_.pipelineStats[stats.pipelineId].operatorStats.size());
-  taskStats_.pipelineStats[stats.pipelineId]
-      .operatorStats[stats.operatorId]
-      .add(stats);
+  auto& pipelineStats = taskStats_.pipelineStats[stats.pipelineId];
+  pipelineStats.operatorStats[stats.operatorId].add(stats);
+  for (auto i = 0; i < kNumBlockingReasons; ++i) {
+    pipelineStats.blockedWallNanosByReason[i] +=
+        stats.blockedWallNanosByReason[i];
+    taskStats_.blockedWallNanosByReason[i] += stats.blockedWallNanosByReason[i];
+  }
+  pipelineStats.queuedWallNanos += stats.queuedWallNanos;
+  taskStats_.queuedWallNanos += stats.queuedWallNanos;
   stats.clear();
 }
 
+TaskStats Task::taskStats() const {
+  TaskStats stats;
+  {
+    std::lock_guard<std::mutex> l(mutex_);
+    stats = taskStats_;
+  }
+  auto tracker = queryCtx_->pool()->getMemoryUsageTracker();
+  if (!tracker) {
+    tracker = pool_->getMemoryUsageTracker();
+  }
+  if (tracker) {
+    stats.peakTotalMemoryBytes = tracker->getPeakTotalBytes();
+    stats.peakTotalMemoryTimeMs = tracker->getPeakTotalTimeMs();
+    // Attributes the peak to the operators by their timelines.
+    for (auto& pipelineStats : stats.pipelineStats) {
+      for (auto& operatorStats : pipelineStats.operatorStats) {
+        auto& memoryStats = operatorStats.memoryStats;
+        memoryStats.reservationAtQueryPeak = memory::memoryUsageAt(
+            memoryStats.timeline, stats.peakTotalMemoryTimeMs);
+      }
+    }
+  }
+  return stats;
+}
+
 uint64_t Task::timeSinceStartMs() const {
   std::lock_guard<std::mutex> l(mutex_);
   if (taskStats_.executionStartTimeMs == 0UL) {
@@ -687,17 +1320,13 @@ std::string Task::toString() {
   return out.str();
 }
 
-void Task::createLocalMergeSources(
-    unsigned numSources,
-    const std::shared_ptr<const RowType>& rowType,
-    memory::MappedMemory* mappedMemory) {
+void Task::createLocalMergeSources(unsigned numSources) {
   VELOX_CHECK(
       localMergeSources_.empty(),
       "Multiple local merges in a single task not supported");
   localMergeSources_.reserve(numSources);
   for (auto i = 0; i < numSources; ++i) {
-    localMergeSources_.emplace_back(
-        MergeSource::createLocalMergeSource(rowType, mappedMemory));
+    localMergeSources_.emplace_back(MergeSource::createLocalMergeSource());
   }
 }
 
@@ -721,10 +1350,13 @@ std::shared_ptr<MergeJoinSource> Task::getMergeJoinSource(
 }
 
 void Task::createLocalExchangeSources(
+    int32_t splitGroupId,
     const core::PlanNodeId& planNodeId,
     int numPartitions) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& localExchanges = splitGroupStateLocked(splitGroupId).localExchanges;
   VELOX_CHECK(
-      localExchanges_.find(planNodeId) == localExchanges_.end(),
+      localExchanges.find(planNodeId) == localExchanges.end(),
       "Local exchange already exists: {}",
       planNodeId);
 
@@ -738,11 +1370,12 @@ void Task::createLocalExchangeSources(
         std::make_shared<LocalExchangeSource>(exchange.memoryManager.get(), i));
   }
 
-  localExchanges_.insert({planNodeId, std::move(exchange)});
+  localExchanges.insert({planNodeId, std::move(exchange)});
 }
 
-void Task::noMoreLocalExchangeProducers() {
-  for (auto& exchange : localExchanges_) {
+void Task::noMoreLocalExchangeProducers(int32_t splitGroupId) {
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto& exchange : splitGroupStateLocked(splitGroupId).localExchanges) {
     for (auto& source : exchange.second.sources) {
       source->noMoreProducers();
     }
@@ -750,9 +1383,10 @@ void Task::noMoreLocalExchangeProducers() {
 }
 
 std::shared_ptr<LocalExchangeSource> Task::getLocalExchangeSource(
+    int32_t splitGroupId,
     const core::PlanNodeId& planNodeId,
     int partition) {
-  const auto& sources = getLocalExchangeSources(planNodeId);
+  const auto& sources = getLocalExchangeSources(splitGroupId, planNodeId);
   VELOX_CHECK_LT(
       partition,
       sources.size(),
@@ -762,12 +1396,17 @@ std::shared_ptr<LocalExchangeSource> Task::getLocalExchangeSource(
 }
 
 const std::vector<std::shared_ptr<LocalExchangeSource>>&
-Task::getLocalExchangeSources(const core::PlanNodeId& planNodeId) {
-  auto it = localExchanges_.find(planNodeId);
+Task::getLocalExchangeSources(
+    int32_t splitGroupId,
+    const core::PlanNodeId& planNodeId) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto& localExchanges = splitGroupStateLocked(splitGroupId).localExchanges;
+  auto it = localExchanges.find(planNodeId);
   VELOX_CHECK(
-      it != localExchanges_.end(),
+      it != localExchanges.end(),
       "Incorrect local exchange ID: {}",
       planNodeId);
+  // The sources stay in place until the split group finishes.
   return it->second.sources;
 }
 
@@ -876,6 +1515,17 @@ StopReason Task::leaveSuspended(ThreadState& state) {
   }
 }
 
+Driver* FOLLY_NULLABLE Task::thisDriver() const {
+  auto thisThread = std::this_thread::get_id();
+  std::lock_guard<std::mutex> l(mutex_);
+  for (auto& driver : drivers_) {
+    if (driver && driver->state().thread == thisThread) {
+      return driver.get();
+    }
+  }
+  return nullptr;
+}
+
 folly::SemiFuture<bool> Task::finishFuture() {
   auto [promise, future] =
       makeVeloxPromiseContract<bool>("CancelPool::finishFuture");
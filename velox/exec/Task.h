@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <array>
 #include <limits>
 #include "velox/core/QueryCtx.h"
 #include "velox/exec/Driver.h"
@@ -35,6 +36,11 @@ struct PipelineStats {
   // operator in the DriverFactory.
   std::vector<OperatorStats> operatorStats;
 
+  // Sums of the blocked and queued times of 'operatorStats'. The subscript
+  // of 'blockedWallNanosByReason' is the BlockingReason.
+  std::array<uint64_t, kNumBlockingReasons> blockedWallNanosByReason{};
+  uint64_t queuedWallNanos{0};
+
   // True if contains the source node for the task.
   bool inputPipeline;
 
@@ -57,6 +63,16 @@ struct TaskStats {
   // processed Splits for Drivers of this pipeline.
   std::vector<PipelineStats> pipelineStats;
 
+  // Sums of the blocked and queued times of 'pipelineStats'.
+  std::array<uint64_t, kNumBlockingReasons> blockedWallNanosByReason{};
+  uint64_t queuedWallNanos{0};
+
+  // Peak total memory of the query and the epoch time (ms) when it was
+  // reached. MemoryStats::reservationAtQueryPeak of each operator is its
+  // share of this peak.
+  uint64_t peakTotalMemoryBytes{0};
+  uint64_t peakTotalMemoryTimeMs{0};
+
   // Epoch time (ms) when task starts to run
   uint64_t executionStartTimeMs{0};
 
@@ -78,6 +94,8 @@ struct TaskStats {
 class JoinBridge;
 class HashJoinBridge;
 class CrossJoinBridge;
+class SharedAggregationTable;
+class TaskTemplate;
 
 using ContinuePromise = VeloxPromise<bool>;
 
@@ -130,12 +148,30 @@ class Task {
     return childPools_.back().get();
   }
 
-  static void start(std::shared_ptr<Task> self, uint32_t maxDrivers);
+  // Makes and starts the Drivers of 'self' with up to 'maxDrivers' Drivers
+  // per pipeline. If 'numSplitGroups' is not 0, runs grouped execution: the
+  // plan runs once for each split group 0..numSplitGroups - 1, on the splits
+  // of that group only, with at most 'concurrentSplitGroups' groups at a
+  // time. Each group has its own Drivers, join bridges and local exchanges,
+  // which are freed when the group finishes. This is used for joins and
+  // aggregations on co-bucketed tables, where each bucket is a split group.
+  static void start(
+      std::shared_ptr<Task> self,
+      uint32_t maxDrivers,
+      uint32_t numSplitGroups = 0,
+      uint32_t concurrentSplitGroups = 1);
 
   // Resumes execution of 'self' after a successful pause. All 'drivers_' must
   // be off-thread and there must be no 'exception_'
   static void resume(std::shared_ptr<Task> self);
 
+  // Pauses 'self', asks the Operators of its Drivers to free up to
+  // 'targetBytes' of memory and resumes 'self'. Drivers that are in a
+  // suspended section are skipped since their Operators are in the
+  // middle of a call. Returns the number of bytes freed. Used by the
+  // MemoryArbitrator of the query.
+  static int64_t reclaim(std::shared_ptr<Task> self, int64_t targetBytes);
+
   // Removes driver from the set of drivers in 'self'. The task will be kept
   // alive by 'self'. 'self' going out of scope may cause the Task to
   // be freed. This happens if a cancelled task is decoupled from the
@@ -144,6 +180,16 @@ class Task {
       std::shared_ptr<Task> self,
       Driver* FOLLY_NONNULL instance);
 
+  // Called inside 'mutex_' when 'driver' is unblocked after waiting
+  // 'blockedMicros' for 'reason'. Returns true if 'driver' is parked
+  // instead of being enqueued because its pipeline has more Drivers than
+  // its consumer keeps up with. May enqueue a parked Driver of the same
+  // pipeline if the consumer keeps up again.
+  bool maybeParkDriverLocked(
+      const std::shared_ptr<Driver>& driver,
+      BlockingReason reason,
+      uint64_t blockedMicros);
+
   // Sets the (so far) max split sequence id, so all splits with sequence id
   // equal or below that, will be ignored in the 'addSplitWithSequence' call.
   // Note, that 'addSplitWithSequence' does not update max split sequence id.
@@ -181,21 +227,85 @@ class Task {
   // received, sets split to null and returns kNotBlocked. Otherwise, returns
   // kWaitForSplit and sets a future that will complete when split becomes
   // available or no-more-splits signal is received.
+  // In grouped execution, 'splitGroupId' is the split group of the caller
+  // and only splits of that group are returned.
   BlockingReason getSplitOrFuture(
+      int32_t splitGroupId,
       const core::PlanNodeId& planNodeId,
       exec::Split& split,
       ContinueFuture& future);
 
+  // Calls 'preload' on the connector splits among the first 'maxSplits'
+  // queued splits for the source operator of 'planNodeId' that are not
+  // being preloaded yet. 'preload' is called under the Task's mutex and
+  // must not block.
+  void preloadSplits(
+      int32_t splitGroupId,
+      const core::PlanNodeId& planNodeId,
+      int32_t maxSplits,
+      const std::function<void(
+          const std::shared_ptr<connector::ConnectorSplit>&)>& preload);
+
   void splitFinished(const core::PlanNodeId& planNodeId, int32_t splitGroupId);
 
+  // Stops the TableScans of 'planNodeId' in all Drivers. Called by a Limit
+  // that has all the rows it needs from a scan that streams to it. The
+  // queued splits are dropped, splits added later are ignored and the scans
+  // finish at their next batch. Does nothing in grouped execution, where
+  // each split group has its own Limit.
+  void finishSourceEarly(const core::PlanNodeId& planNodeId);
+
+  // Returns true after finishSourceEarly() for 'planNodeId'.
+  bool isSourceFinishedEarly(const core::PlanNodeId& planNodeId);
+
   void multipleSplitsFinished(int32_t numSplits);
 
+  // Publishes the filters on the keys of the hash join 'planNodeId' that
+  // pass the build side keys of this Task. Called by HashBuild once the
+  // table is built. Realizes the futures of getJoinBuildFilters(). A
+  // filter is nullptr if its key has none.
+  void setJoinBuildFilters(
+      const core::PlanNodeId& planNodeId,
+      std::vector<std::shared_ptr<common::Filter>> filters);
+
+  // Returns the filters from setJoinBuildFilters() for 'planNodeId', or
+  // std::nullopt if they are not set yet. In that case, sets 'future', if
+  // given, to be realized when they are. Meant for the coordinator, which
+  // sends the filters of all the Tasks building a partitioned join to the
+  // Tasks that scan its probe side, see addRemoteDynamicFilter().
+  std::optional<std::vector<std::shared_ptr<common::Filter>>>
+  getJoinBuildFilters(
+      const core::PlanNodeId& planNodeId,
+      ContinueFuture* future = nullptr);
+
+  // Adds the build side filter on 'column' of the TableScan 'planNodeId'
+  // from 'sourceTaskId', one of 'numSources' Tasks that build a join with
+  // the scanned rows. Once the filters of all the sources are added, their
+  // union is added to the scans of 'planNodeId', also to scans in the
+  // middle of a split. A nullptr 'filter' means that its source has none
+  // and so there is no union. Filters added again by the same source are
+  // ignored.
+  void addRemoteDynamicFilter(
+      const core::PlanNodeId& planNodeId,
+      const std::string& column,
+      const std::string& sourceTaskId,
+      int32_t numSources,
+      std::shared_ptr<common::Filter> filter);
+
+  // Incremented whenever remote dynamic filters become ready. The scans
+  // call remoteDynamicFilters() only when this changes.
+  int64_t remoteDynamicFilterVersion() const {
+    return remoteDynamicFilterVersion_;
+  }
+
+  // Returns the ready remote dynamic filters of the TableScan 'planNodeId'
+  // with their columns, starting at the 'firstIndex'th.
+  std::vector<std::pair<std::string, std::shared_ptr<common::Filter>>>
+  remoteDynamicFilters(const core::PlanNodeId& planNodeId, int32_t firstIndex);
+
   void updateBroadcastOutputBuffers(int numBuffers, bool noMoreBuffers);
 
-  void createLocalMergeSources(
-      unsigned numSources,
-      const std::shared_ptr<const RowType>& rowType,
-      memory::MappedMemory* FOLLY_NONNULL mappedMemory);
+  void createLocalMergeSources(unsigned numSources);
 
   std::shared_ptr<MergeSource> getLocalMergeSource(int sourceId) {
     VELOX_CHECK_LT(sourceId, localMergeSources_.size(), "Incorrect source id ");
@@ -208,17 +318,21 @@ class Task {
       const core::PlanNodeId& planNodeId);
 
   void createLocalExchangeSources(
+      int32_t splitGroupId,
       const core::PlanNodeId& planNodeId,
       int numPartitions);
 
-  void noMoreLocalExchangeProducers();
+  void noMoreLocalExchangeProducers(int32_t splitGroupId);
 
   std::shared_ptr<LocalExchangeSource> getLocalExchangeSource(
+      int32_t splitGroupId,
       const core::PlanNodeId& planNodeId,
       int partition);
 
   const std::vector<std::shared_ptr<LocalExchangeSource>>&
-  getLocalExchangeSources(const core::PlanNodeId& planNodeId);
+  getLocalExchangeSources(
+      int32_t splitGroupId,
+      const core::PlanNodeId& planNodeId);
 
   std::exception_ptr error() const {
     return exception_;
@@ -275,6 +389,18 @@ class Task {
     return consumerSupplier_;
   }
 
+  // Makes start() take the plan of 'taskTemplate' instead of running the
+  // LocalPlanner. Set by TaskTemplate::createTask().
+  void setTaskTemplate(std::shared_ptr<TaskTemplate> taskTemplate) {
+    VELOX_CHECK(driverFactories_.empty(), "Task {} is started", taskId_);
+    taskTemplate_ = std::move(taskTemplate);
+  }
+
+  // The template of 'this' or nullptr.
+  const std::shared_ptr<TaskTemplate>& taskTemplate() const {
+    return taskTemplate_;
+  }
+
   // Synchronizes completion of an Operator across Drivers of 'this'.
   // 'planNodeId' identifies the Operator within all
   // Operators/pipelines of 'this'.  Each Operator instance calls this
@@ -287,8 +413,9 @@ class Task {
   // effects a synchronization barrier between Drivers of a pipeline
   // inside one worker. This is used for example for multithreaded
   // hash join build to ensure all build threads are completed before
-  // allowing the probe pipeline to proceed. Throws a cancelled error
-  // if 'this' is in an error state.
+  // allowing the probe pipeline to proceed. In grouped execution, the
+  // peers are the Drivers of the same split group. Throws a cancelled
+  // error if 'this' is in an error state.
   bool allPeersFinished(
       const core::PlanNodeId& planNodeId,
       Driver* FOLLY_NONNULL caller,
@@ -296,23 +423,40 @@ class Task {
       std::vector<VeloxPromise<bool>>& promises,
       std::vector<std::shared_ptr<Driver>>& peers);
 
-  // Adds HashJoinBridge's for all the specified plan node IDs.
-  void addHashJoinBridges(const std::vector<core::PlanNodeId>& planNodeIds);
+  // Adds HashJoinBridge's for all the specified plan node IDs to the
+  // split group 'splitGroupId'.
+  void addHashJoinBridges(
+      int32_t splitGroupId,
+      const std::vector<core::PlanNodeId>& planNodeIds);
 
-  // Adds CrossJoinBridge's for all the specified plan node IDs.
-  void addCrossJoinBridges(const std::vector<core::PlanNodeId>& planNodeIds);
+  // Adds CrossJoinBridge's for all the specified plan node IDs to the
+  // split group 'splitGroupId'.
+  void addCrossJoinBridges(
+      int32_t splitGroupId,
+      const std::vector<core::PlanNodeId>& planNodeIds);
 
   // Returns a HashJoinBridge for 'planNodeId'. This is used for synchronizing
   // start of probe with completion of build for a join that has a
   // separate probe and build. 'id' is the PlanNodeId shared between
-  // the probe and build Operators of the join.
+  // the probe and build Operators of the join. Each split group has
+  // its own bridges.
   std::shared_ptr<HashJoinBridge> getHashJoinBridge(
+      int32_t splitGroupId,
       const core::PlanNodeId& planNodeId);
 
   // Returns a CrossJoinBridge for 'planNodeId'.
   std::shared_ptr<CrossJoinBridge> getCrossJoinBridge(
+      int32_t splitGroupId,
       const core::PlanNodeId& planNodeId);
 
+  // Returns the groups that the Drivers of the aggregation 'planNodeId' in
+  // split group 'splitGroupId' share. The first caller makes them with
+  // 'create'.
+  std::shared_ptr<SharedAggregationTable> getSharedAggregationTable(
+      int32_t splitGroupId,
+      const core::PlanNodeId& planNodeId,
+      const std::function<std::shared_ptr<SharedAggregationTable>()>& create);
+
   // Sets this to a terminate requested
   // state and frees all resources of Drivers that are not presently
   // on thread. Unblocks all waiting Drivers, e.g. Drivers waiting for
@@ -332,10 +476,7 @@ class Task {
   void addOperatorStats(OperatorStats& stats);
 
   // Returns by copy as other threads might be updating the structure.
-  TaskStats taskStats() const {
-    std::lock_guard<std::mutex> l(mutex_);
-    return taskStats_;
-  }
+  TaskStats taskStats() const;
 
   /// Returns time (ms) since the task execution started.
   /// Returns zero, if not started.
@@ -440,6 +581,16 @@ class Task {
     toYield_ = numThreads_;
   }
 
+  // Adds on-thread CPU time of a Driver of 'this'. Drivers of Tasks that
+  // have used less CPU are scheduled first.
+  void addDriverCpuNanos(uint64_t nanos) {
+    driverCpuNanos_ += nanos;
+  }
+
+  uint64_t driverCpuNanos() const {
+    return driverCpuNanos_;
+  }
+
   // Once 'pauseRequested_' is set, it will not be cleared until
   // task::resume(). It is therefore OK to read it without a mutex
   // from a thread that this flag concerns.
@@ -467,6 +618,12 @@ class Task {
   struct GroupSplitsInfo {
     int32_t numIncompleteSplits{0};
     bool noMoreSplits{false};
+
+    // Queued splits and waiting Drivers of the group in grouped
+    // execution. In ungrouped execution the splits of all groups are
+    // queued in SplitsState::splits.
+    std::deque<exec::Split> splits;
+    std::vector<VeloxPromise<bool>> splitPromises;
   };
 
   // Structure contains the current info on splits.
@@ -480,9 +637,16 @@ class Task {
     // Singnal, that no more splits will arrive.
     bool noMoreSplits{false};
 
+    // Set by finishSourceEarly(). Splits added after this are dropped.
+    bool finishedEarly{false};
+
     // For splits, coming with group ids, we keep track of them.
     std::unordered_map<int32_t, GroupSplitsInfo> groupSplits;
 
+    // Groups whose splits are all finished. These are no longer in
+    // 'groupSplits'.
+    std::unordered_set<int32_t> completedGroups;
+
     // Keep the max added split's sequence id to deduplicate incoming splits.
     long maxSequenceId{std::numeric_limits<long>::min()};
 
@@ -492,8 +656,95 @@ class Task {
     SplitsState& operator=(SplitsState const&) = delete;
   };
 
+  // Filters published by setJoinBuildFilters().
+  struct JoinBuildFilters {
+    bool ready{false};
+    std::vector<std::shared_ptr<common::Filter>> filters;
+    std::vector<ContinuePromise> promises;
+  };
+
+  // The remote dynamic filters of a TableScan.
+  struct RemoteDynamicFilters {
+    // The filters added so far on each column that is not ready yet.
+    struct Pending {
+      std::unordered_set<std::string> sources;
+      std::vector<std::shared_ptr<common::Filter>> filters;
+    };
+    std::unordered_map<std::string, Pending> pending;
+
+    // Columns whose filters from all sources have been added.
+    std::unordered_set<std::string> readyColumns;
+
+    // The unions of the ready columns in the order they became ready.
+    std::vector<std::pair<std::string, std::shared_ptr<common::Filter>>>
+        ready;
+  };
+
+  struct LocalExchange {
+    std::unique_ptr<LocalExchangeMemoryManager> memoryManager;
+    std::vector<std::shared_ptr<LocalExchangeSource>> sources;
+  };
+
+  // State shared between the Drivers of a split group. An ungrouped Task
+  // has one group, kUngroupedGroupId.
+  struct SplitGroupState {
+    // Holds states for allPeersFinished().
+    std::unordered_map<std::string, BarrierState> barriers;
+
+    // Map from the plan node id of the join to the corresponding
+    // JoinBridge.
+    std::unordered_map<std::string, std::shared_ptr<JoinBridge>> bridges;
+
+    // Map of local exchanges keyed on LocalPartition plan node ID.
+    std::unordered_map<core::PlanNodeId, LocalExchange> localExchanges;
+
+    // Groups of final aggregations shared by their Drivers, keyed on the
+    // aggregation plan node ID.
+    std::unordered_map<
+        core::PlanNodeId,
+        std::shared_ptr<SharedAggregationTable>>
+        sharedAggregations;
+
+    // Number of Drivers of the group that are not finished. Maintained in
+    // grouped execution only.
+    int32_t numRunningDrivers{0};
+  };
+
+  // Makes the Drivers of all pipelines for 'splitGroupId' together with
+  // the join bridges and local exchanges they share.
+  static std::vector<std::shared_ptr<Driver>> createDrivers(
+      const std::shared_ptr<Task>& self,
+      int32_t splitGroupId);
+
+  // Makes and enqueues the Drivers of 'splitGroupId' in grouped execution.
+  static void startSplitGroup(
+      const std::shared_ptr<Task>& self,
+      int32_t splitGroupId);
+
+  // Called when the last Driver of 'splitGroupId' finishes in grouped
+  // execution. Frees the state of the group. Returns the next split group
+  // to start or kUngroupedGroupId if there is none.
+  int32_t splitGroupFinishedLocked(int32_t splitGroupId);
+
+  SplitGroupState& splitGroupStateLocked(int32_t splitGroupId);
+
+  // Returns the split for a Driver of 'splitGroupId' in grouped execution.
+  // See getSplitOrFuture().
+  BlockingReason getGroupSplitOrFutureLocked(
+      SplitsState& splitsState,
+      int32_t splitGroupId,
+      exec::Split& split,
+      ContinueFuture& future);
+
+  // Removes 'driver' from 'drivers_'. Returns the next split group to
+  // start if 'driver' is the last of its group, else kUngroupedGroupId.
+  int32_t removeDriverLocked(Driver* FOLLY_NONNULL driver);
+
   void driverClosedLocked();
 
+  // Enqueues a parked Driver of 'pipelineId' if there is one.
+  void unparkDriverLocked(int32_t pipelineId);
+
   std::shared_ptr<ExchangeClient> addExchangeClient();
 
   void stateChangedLocked();
@@ -503,7 +754,7 @@ class Task {
   bool isAllSplitsFinishedLocked();
 
   void checkGroupSplitsCompleteLocked(
-      std::unordered_map<int32_t, GroupSplitsInfo>& mapGroupSplits,
+      SplitsState& splitsState,
       int32_t splitGroupId,
       std::unordered_map<int32_t, GroupSplitsInfo>::iterator it);
 
@@ -535,20 +786,56 @@ class Task {
   ConsumerSupplier consumerSupplier_;
   std::function<void(std::exception_ptr)> onError_;
 
+  std::shared_ptr<TaskTemplate> taskTemplate_;
   std::vector<std::unique_ptr<DriverFactory>> driverFactories_;
   std::vector<std::shared_ptr<Driver>> drivers_;
   int32_t numDrivers_ = 0;
+
+  // Max Drivers per pipeline, as given to start().
+  uint32_t maxDrivers_{0};
+
+  // Number of split groups in grouped execution, 0 for ungrouped
+  // execution.
+  uint32_t numSplitGroups_{0};
+
+  // The next split group to start in grouped execution. Groups start in
+  // order of id.
+  uint32_t nextSplitGroupId_{0};
+
+  // Split group id -> state of the group. Holds the groups that are
+  // running. Guarded by 'mutex_'.
+  std::unordered_map<int32_t, SplitGroupState> splitGroupStates_;
+
+  // Parallelism of a pipeline that starts with a TableScan when adaptive
+  // driver count is enabled. Such a pipeline reads splits from a shared
+  // queue and its Drivers do not wait for each other, so any number of
+  // its Drivers may run.
+  struct ElasticPipeline {
+    // Number of Drivers that are not parked or finished. 0 if the
+    // pipeline is not elastic.
+    int32_t numActive{0};
+    std::vector<std::shared_ptr<Driver>> parked;
+  };
+
+  // Indexed by pipeline id. Empty unless adaptive driver count is
+  // enabled. Guarded by 'mutex_'.
+  std::vector<ElasticPipeline> elasticPipelines_;
   TaskState state_ = kRunning;
 
   // We store separate splits state for each plan node.
   std::unordered_map<core::PlanNodeId, SplitsState> splitsStates_;
 
-  // Holds states for pipelineBarrier(). Guarded by
-  // 'mutex_'.
-  std::unordered_map<std::string, BarrierState> barriers_;
-  // Map from the plan node id of the join to the corresponding JoinBridge.
-  // Guarded by 'mutex_'.
-  std::unordered_map<std::string, std::shared_ptr<JoinBridge>> bridges_;
+  // True after the first finishSourceEarly(), so that the TableScans check
+  // their SplitsState only after that.
+  std::atomic<bool> anySourceFinishedEarly_{false};
+
+  // Keyed on the plan node id of the join. Guarded by 'mutex_'.
+  std::unordered_map<core::PlanNodeId, JoinBuildFilters> joinBuildFilters_;
+
+  // Keyed on the plan node id of the TableScan. Guarded by 'mutex_'.
+  std::unordered_map<core::PlanNodeId, RemoteDynamicFilters>
+      remoteDynamicFilters_;
+  std::atomic<int64_t> remoteDynamicFilterVersion_{0};
 
   std::vector<VeloxPromise<bool>> stateChangePromises_;
 
@@ -564,16 +851,12 @@ class Task {
   std::unordered_map<core::PlanNodeId, std::shared_ptr<MergeJoinSource>>
       mergeJoinSources_;
 
-  struct LocalExchange {
-    std::unique_ptr<LocalExchangeMemoryManager> memoryManager;
-    std::vector<std::shared_ptr<LocalExchangeSource>> sources;
-  };
-
-  /// Map of local exchanges keyed on LocalPartition plan node ID.
-  std::unordered_map<core::PlanNodeId, LocalExchange> localExchanges_;
-
   std::weak_ptr<PartitionedOutputBufferManager> bufferManager_;
 
+  // Registered with the MemoryArbitrator of 'queryCtx_', if any, for the
+  // lifetime of 'this'.
+  std::shared_ptr<memory::MemoryReclaimer> memoryReclaimer_;
+
   void finished() {
     for (auto& promise : finishPromises_) {
       promise.setValue(true);
@@ -605,6 +888,8 @@ class Task {
   std::atomic<bool> terminateRequested_{false};
   std::atomic<int32_t> toYield_ = 0;
   int32_t numThreads_ = 0;
+  // Total CPU time of the Drivers of 'this'.
+  std::atomic<uint64_t> driverCpuNanos_{0};
   std::vector<VeloxPromise<bool>> finishPromises_;
 };
 
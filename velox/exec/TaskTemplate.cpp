@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/TaskTemplate.h"
+
+#include "velox/exec/CallbackSink.h"
+#include "velox/exec/LocalPlanner.h"
+#include "velox/exec/Task.h"
+
+namespace facebook::velox::exec {
+
+TaskTemplate::TaskTemplate(
+    std::shared_ptr<const core::PlanNode> planNode,
+    std::shared_ptr<core::QueryCtx> queryCtx)
+    : planNode_(std::move(planNode)),
+      queryCtx_(std::move(queryCtx)),
+      pool_(queryCtx_->pool()->addScopedChild("task_template")),
+      execCtx_(pool_.get(), queryCtx_.get()) {}
+
+// static
+std::shared_ptr<TaskTemplate> TaskTemplate::create(
+    std::shared_ptr<const core::PlanNode> planNode,
+    std::shared_ptr<core::QueryCtx> queryCtx,
+    bool hasConsumer) {
+  std::shared_ptr<TaskTemplate> taskTemplate(
+      new TaskTemplate(std::move(planNode), std::move(queryCtx)));
+  LocalPlanner::plan(
+      taskTemplate->planNode_,
+      taskTemplate->queryCtx_->config(),
+      nullptr,
+      &taskTemplate->driverFactories_);
+  if (hasConsumer) {
+    // The factories are shared, so the output pipeline gets the Consumer of
+    // the Task it runs for.
+    taskTemplate->driverFactories_[0]->consumerSupplier =
+        [](int32_t operatorId, DriverCtx* ctx) {
+          auto consumerSupplier = ctx->task->consumerSupplier();
+          VELOX_CHECK(
+              consumerSupplier,
+              "Task {} of a template with a consumer has no consumer",
+              ctx->task->taskId());
+          return std::make_unique<CallbackSink>(
+              operatorId, ctx, consumerSupplier());
+        };
+  }
+  return taskTemplate;
+}
+
+std::shared_ptr<Task> TaskTemplate::createTask(
+    const std::string& taskId,
+    int destination,
+    std::shared_ptr<core::QueryCtx> queryCtx,
+    Consumer consumer,
+    std::function<void(std::exception_ptr)> onError) {
+  auto task = std::make_shared<Task>(
+      taskId,
+      planNode_,
+      destination,
+      std::move(queryCtx),
+      std::move(consumer),
+      std::move(onError));
+  task->setTaskTemplate(shared_from_this());
+  return task;
+}
+
+std::unique_ptr<ExprSet> TaskTemplate::getExprSet(
+    const core::PlanNodeId& planNodeId,
+    std::vector<std::shared_ptr<const core::ITypedExpr>> exprs,
+    const std::function<void(ExprSet&)>& init) {
+  std::lock_guard<std::mutex> l(mutex_);
+  auto it = exprSets_.find(planNodeId);
+  if (it != exprSets_.end() && !it->second.empty()) {
+    auto exprSet = std::move(it->second.back());
+    it->second.pop_back();
+    ++numReusedExprSets_;
+    return exprSet;
+  }
+  auto exprSet = makeExprSetFromFlag(std::move(exprs), &execCtx_);
+  init(*exprSet);
+  ++numCompiledExprSets_;
+  return exprSet;
+}
+
+void TaskTemplate::releaseExprSet(
+    const core::PlanNodeId& planNodeId,
+    std::unique_ptr<ExprSet> exprSet) {
+  exprSet->clear();
+  std::lock_guard<std::mutex> l(mutex_);
+  exprSets_[planNodeId].push_back(std::move(exprSet));
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <folly/container/F14Map.h>
+#include <mutex>
+
+#include "velox/core/PlanNode.h"
+#include "velox/core/QueryCtx.h"
+#include "velox/exec/Driver.h"
+#include "velox/expression/Expr.h"
+
+namespace facebook::velox::exec {
+
+class Task;
+
+// A plan fragment that is set up once for running many short Tasks, e.g.
+// the point lookups of a service. The Tasks made by createTask() skip the
+// LocalPlanner and copy the DriverFactories of the template, and their
+// FilterProject operators reuse the ExprSets that earlier Tasks of the
+// template compiled and released at close. Each Task still gets its own
+// Drivers, Operators and memory pools and reads the splits added to it.
+//
+// The Tasks of a template must run with the same QueryConfig as the
+// 'queryCtx' of the template, since the plan and the compiled expressions
+// depend on it. Expressions are not reused while expression stats are
+// tracked.
+class TaskTemplate : public std::enable_shared_from_this<TaskTemplate> {
+ public:
+  // 'hasConsumer' tells whether the Tasks pass their results to a Consumer
+  // instead of a PartitionedOutput. 'queryCtx' provides the config and the
+  // memory of the expressions compiled for the template.
+  static std::shared_ptr<TaskTemplate> create(
+      std::shared_ptr<const core::PlanNode> planNode,
+      std::shared_ptr<core::QueryCtx> queryCtx,
+      bool hasConsumer);
+
+  // Makes a Task that runs the plan of 'this'. The Task is started with
+  // Task::start() as usual.
+  std::shared_ptr<Task> createTask(
+      const std::string& taskId,
+      int destination,
+      std::shared_ptr<core::QueryCtx> queryCtx,
+      Consumer consumer = nullptr,
+      std::function<void(std::exception_ptr)> onError = nullptr);
+
+  const std::shared_ptr<const core::PlanNode>& planNode() const {
+    return planNode_;
+  }
+
+  const std::vector<std::unique_ptr<DriverFactory>>& driverFactories() const {
+    return driverFactories_;
+  }
+
+  // Returns an ExprSet that an earlier Task compiled for 'planNodeId' or
+  // makes a new one from 'exprs' in the context of 'this'.
+  std::unique_ptr<ExprSet> getExprSet(
+      const core::PlanNodeId& planNodeId,
+      std::vector<std::shared_ptr<const core::ITypedExpr>> exprs,
+      const std::function<void(ExprSet&)>& init);
+
+  // Keeps 'exprSet' of a closed operator of 'planNodeId' for a later Task.
+  void releaseExprSet(
+      const core::PlanNodeId& planNodeId,
+      std::unique_ptr<ExprSet> exprSet);
+
+  // The number of ExprSets compiled and reused. For tests.
+  int64_t numCompiledExprSets() const {
+    return numCompiledExprSets_;
+  }
+
+  int64_t numReusedExprSets() const {
+    return numReusedExprSets_;
+  }
+
+ private:
+  TaskTemplate(
+      std::shared_ptr<const core::PlanNode> planNode,
+      std::shared_ptr<core::QueryCtx> queryCtx);
+
+  const std::shared_ptr<const core::PlanNode> planNode_;
+  const std::shared_ptr<core::QueryCtx> queryCtx_;
+  // Holds the constants folded while compiling expressions, so these outlive
+  // the Tasks.
+  const std::unique_ptr<memory::MemoryPool> pool_;
+  core::ExecCtx execCtx_;
+  std::vector<std::unique_ptr<DriverFactory>> driverFactories_;
+
+  // Serializes compiling, which uses 'execCtx_', and the access to
+  // 'exprSets_'.
+  std::mutex mutex_;
+  folly::F14FastMap<core::PlanNodeId, std::vector<std::unique_ptr<ExprSet>>>
+      exprSets_;
+  std::atomic<int64_t> numCompiledExprSets_{0};
+  std::atomic<int64_t> numReusedExprSets_{0};
+};
+
+} // namespace facebook::velox::exec
@@ -29,14 +29,30 @@ TopN::TopN(
           topNNode->id(),
           "TopN"),
       count_(topNNode->count()),
+      cutoffChannel_(
+          exprToChannel(topNNode->sortingKeys()[0].get(), outputType_)),
+      cutoffOrder_(topNNode->sortingOrders()[0]),
+      normalizedKeyEncoder_(NormalizedKeyEncoder::create(
+          outputType_,
+          topNNode->sortingKeys(),
+          topNNode->sortingOrders())),
       data_(std::make_unique<RowContainer>(
           outputType_->children(),
-          operatorCtx_->mappedMemory())),
+          true, // nullableKeys
+          std::vector<std::unique_ptr<Aggregate>>{},
+          std::vector<TypePtr>{},
+          false, // hasNext
+          false, // isJoinBuild
+          false, // hasProbedFlag
+          normalizedKeyEncoder_ != nullptr, // hasNormalizedKey
+          operatorCtx_->mappedMemory(),
+          ContainerRowSerde::instance())),
       comparator_(
           outputType_,
           topNNode->sortingKeys(),
           topNNode->sortingOrders(),
-          data_.get()),
+          data_.get(),
+          normalizedKeyEncoder_.get()),
       topRows_(comparator_),
       decodedVectors_(outputType_->children().size()) {}
 
@@ -45,8 +61,10 @@ TopN::Comparator::Comparator(
     const std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>&
         sortingKeys,
     const std::vector<core::SortOrder>& sortingOrders,
-    RowContainer* rowContainer)
-    : rowContainer_(rowContainer) {
+    RowContainer* rowContainer,
+    const NormalizedKeyEncoder* normalizedKeyEncoder)
+    : rowContainer_(rowContainer),
+      normalizedKeyEncoder_(normalizedKeyEncoder) {
   auto numKeys = sortingKeys.size();
   for (int i = 0; i < numKeys; ++i) {
     auto channel = exprToChannel(sortingKeys[i].get(), type);
@@ -66,13 +84,16 @@ void TopN::addInput(RowVectorPtr input) {
   }
 
   for (int row = 0; row < input->size(); ++row) {
+    normalized_key_t normalizedKey = normalizedKeyEncoder_
+        ? normalizedKeyEncoder_->encode(decodedVectors_, row)
+        : 0;
     char* newRow = nullptr;
     if (topRows_.size() < count_) {
       newRow = data_->newRow();
     } else {
       char* topRow = topRows_.top();
 
-      if (comparator_(topRow, decodedVectors_, row)) {
+      if (comparator_(topRow, decodedVectors_, row, normalizedKey)) {
         continue;
       }
       topRows_.pop();
@@ -83,9 +104,67 @@ void TopN::addInput(RowVectorPtr input) {
     for (int col = 0; col < input->childrenSize(); ++col) {
       data_->store(decodedVectors_[col], row, newRow, col);
     }
+    if (normalizedKeyEncoder_) {
+      RowContainer::normalizedKey(newRow) = normalizedKey;
+    }
 
     topRows_.push(newRow);
   }
+  pushdownCutoff();
+}
+
+void TopN::pushdownCutoff() {
+  if (!mayPushdownCutoff_ || topRows_.size() < count_) {
+    return;
+  }
+  const auto kind = outputType_->childAt(cutoffChannel_)->kind();
+  if (!cutoffChecked_) {
+    cutoffChecked_ = true;
+    mayPushdownCutoff_ =
+        (kind == TypeKind::TINYINT || kind == TypeKind::SMALLINT ||
+         kind == TypeKind::INTEGER || kind == TypeKind::BIGINT) &&
+        !operatorCtx_->driver()
+             ->canPushdownFilters(this, {cutoffChannel_})
+             .empty();
+    if (!mayPushdownCutoff_) {
+      return;
+    }
+  }
+  const char* row = topRows_.top();
+  const auto column = data_->columnAt(cutoffChannel_);
+  if (RowContainer::isNullAt(row, column.nullByte(), column.nullMask())) {
+    // A null last row leaves no range of values to skip.
+    return;
+  }
+  int64_t cutoff;
+  switch (kind) {
+    case TypeKind::TINYINT:
+      cutoff = RowContainer::valueAt<int8_t>(row, column.offset());
+      break;
+    case TypeKind::SMALLINT:
+      cutoff = RowContainer::valueAt<int16_t>(row, column.offset());
+      break;
+    case TypeKind::INTEGER:
+      cutoff = RowContainer::valueAt<int32_t>(row, column.offset());
+      break;
+    default:
+      cutoff = RowContainer::valueAt<int64_t>(row, column.offset());
+      break;
+  }
+  if (cutoff_ == cutoff) {
+    return;
+  }
+  cutoff_ = cutoff;
+  // Rows equal to the cutoff may still make it on a later sorting key. Null
+  // rows make it if they sort first.
+  const bool nullAllowed = cutoffOrder_.isNullsFirst();
+  if (cutoffOrder_.isAscending()) {
+    dynamicFilters_[cutoffChannel_] = std::make_shared<common::BigintRange>(
+        std::numeric_limits<int64_t>::min(), cutoff, nullAllowed);
+  } else {
+    dynamicFilters_[cutoffChannel_] = std::make_shared<common::BigintRange>(
+        cutoff, std::numeric_limits<int64_t>::max(), nullAllowed);
+  }
 }
 
 RowVectorPtr TopN::getOutput() {
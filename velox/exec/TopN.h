@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include "velox/exec/NormalizedKey.h"
 #include "velox/exec/Operator.h"
 #include "velox/exec/RowContainer.h"
 
@@ -41,8 +42,9 @@ class TopN : public Operator {
     return BlockingReason::kNotBlocked;
   }
 
- private:
-  static constexpr size_t kMaxNumRowsToReturn = 1024;
+  // Orders rows of a RowContainer on the sorting keys. The columns of the
+  // RowContainer are the columns of 'outputType'. If 'normalizedKeyEncoder'
+  // is set, the rows have normalized keys that are compared first.
   class Comparator {
    public:
     Comparator(
@@ -50,13 +52,21 @@ class TopN : public Operator {
         const std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>&
             sortingKeys,
         const std::vector<core::SortOrder>& sortingOrders,
-        RowContainer* rowContainer);
+        RowContainer* rowContainer,
+        const NormalizedKeyEncoder* normalizedKeyEncoder = nullptr);
 
     // Returns true if lhs < rhs, false otherwise.
     bool operator()(const char* lhs, const char* rhs) {
       if (lhs == rhs) {
         return false;
       }
+      if (normalizedKeyEncoder_) {
+        auto lhsKey = RowContainer::normalizedKey(const_cast<char*>(lhs));
+        auto rhsKey = RowContainer::normalizedKey(const_cast<char*>(rhs));
+        if (lhsKey != rhsKey) {
+          return lhsKey < rhsKey;
+        }
+      }
       for (auto& key : keyInfo_) {
         if (auto result = rowContainer_->compare(
                 lhs,
@@ -70,10 +80,19 @@ class TopN : public Operator {
     }
 
     // Returns true if lhs < decodeVectors[index], false otherwise.
+    // 'normalizedKey' is the normalized key of row 'index' if there is a
+    // 'normalizedKeyEncoder_'.
     bool operator()(
         const char* lhs,
         const std::vector<DecodedVector>& decodedVectors,
-        vector_size_t index) {
+        vector_size_t index,
+        normalized_key_t normalizedKey = 0) {
+      if (normalizedKeyEncoder_) {
+        auto lhsKey = RowContainer::normalizedKey(const_cast<char*>(lhs));
+        if (lhsKey != normalizedKey) {
+          return lhsKey < normalizedKey;
+        }
+      }
       for (auto& key : keyInfo_) {
         if (auto result = rowContainer_->compare(
                 lhs,
@@ -90,13 +109,36 @@ class TopN : public Operator {
    private:
     std::vector<std::pair<ChannelIndex, core::SortOrder>> keyInfo_;
     RowContainer* rowContainer_;
+    const NormalizedKeyEncoder* normalizedKeyEncoder_;
   };
 
+ private:
+  static constexpr size_t kMaxNumRowsToReturn = 1024;
+
+  // Pushes the first sorting key of the last of the top rows to the
+  // upstream TableScan as a range filter, so that the scan skips the rows
+  // that cannot make the top 'count_'. Only for integer keys.
+  void pushdownCutoff();
+
   const int32_t count_;
 
+  // Channel and order of the first sorting key.
+  const ChannelIndex cutoffChannel_;
+  const core::SortOrder cutoffOrder_;
+  // Cleared if the cutoff cannot be pushed down. Checked when the top rows
+  // first fill up.
+  bool mayPushdownCutoff_{true};
+  bool cutoffChecked_{false};
+  // The last cutoff pushed down. The scan keeps the previous filters, so
+  // only a tighter cutoff is pushed.
+  std::optional<int64_t> cutoff_;
+
   bool finished_ = false;
   uint32_t numRowsReturned_ = 0;
 
+  // Set if the sorting keys have a normalized key prefix.
+  const std::unique_ptr<NormalizedKeyEncoder> normalizedKeyEncoder_;
+
   // As the inputs are added to TopN operator, we use topRows_ (a priority
   // queue) to keep track of the pointers to rows stored in the
   // RowContainer (data_). We only update the RowContainer if a row is a
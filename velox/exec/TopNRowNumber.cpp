@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/TopNRowNumber.h"
+#include "velox/exec/Task.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::exec {
+
+TopNRowNumber::TopNRowNumber(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::TopNRowNumberNode>& node)
+    : Operator(
+          driverCtx,
+          node->outputType(),
+          operatorId,
+          node->id(),
+          "TopNRowNumber"),
+      outputBatchSize_{
+          driverCtx->execCtx->queryCtx()->config().preferredOutputBatchSize()},
+      limit_(node->limit()),
+      generateRowNumber_(node->generateRowNumber()),
+      numInputColumns_(node->sources()[0]->outputType()->size()),
+      data_(std::make_unique<RowContainer>(
+          node->sources()[0]->outputType()->children(),
+          operatorCtx_->mappedMemory())),
+      comparator_(
+          node->sources()[0]->outputType(),
+          node->sortingKeys(),
+          node->sortingOrders(),
+          data_.get()),
+      decodedVectors_(numInputColumns_) {
+  auto inputType = node->sources()[0]->outputType();
+  std::vector<std::unique_ptr<VectorHasher>> hashers;
+  for (const auto& key : node->partitionKeys()) {
+    auto channel = exprToChannel(key.get(), inputType);
+    VELOX_CHECK_NE(
+        channel,
+        kConstantChannel,
+        "TopNRowNumber doesn't allow constant partition keys");
+    partitionChannels_.push_back(channel);
+    hashers.push_back(VectorHasher::create(key->type(), channel));
+  }
+  auto numKeys = hashers.size();
+  table_ = std::make_unique<HashTable<false>>(
+      std::move(hashers),
+      std::vector<std::unique_ptr<Aggregate>>{},
+      std::vector<TypePtr>{BIGINT()},
+      false, // allowDuplicates
+      false, // isJoinBuild
+      false, // hasProbedFlag
+      operatorCtx_->mappedMemory());
+  lookup_ = std::make_unique<HashLookup>(table_->hashers());
+  partitionIndexOffset_ = table_->rows()->columnAt(numKeys).offset();
+}
+
+void TopNRowNumber::probePartitions(const RowVectorPtr& input) {
+  auto& hashers = lookup_->hashers;
+  // The first probe and probes that see keys outside of the ranges of the
+  // value ids let the table decide its hash mode and hash again.
+  bool rehash = !tableProbed_;
+  tableProbed_ = true;
+  for (;;) {
+    lookup_->reset(input->size());
+    auto mode = table_->hashMode();
+    for (auto i = 0; i < hashers.size(); ++i) {
+      auto key = input->loadedChildAt(partitionChannels_[i]);
+      if (mode != BaseHashTable::HashMode::kHash) {
+        if (!hashers[i]->computeValueIds(*key, activeRows_, lookup_->hashes)) {
+          rehash = true;
+        }
+      } else {
+        hashers[i]->hash(*key, activeRows_, i > 0, lookup_->hashes);
+      }
+    }
+    std::iota(lookup_->rows.begin(), lookup_->rows.end(), 0);
+    if (!rehash) {
+      break;
+    }
+    if (table_->hashMode() != BaseHashTable::HashMode::kHash) {
+      table_->decideHashMode(input->size());
+    }
+    rehash = false;
+  }
+  table_->groupProbe(*lookup_);
+
+  for (auto row : lookup_->newGroups) {
+    partitionIndex(lookup_->hits[row]) = partitions_.size();
+    partitions_.emplace_back();
+  }
+}
+
+void TopNRowNumber::addInput(RowVectorPtr input) {
+  auto numInput = input->size();
+  activeRows_.resize(numInput);
+  activeRows_.setAll();
+  probePartitions(input);
+
+  for (auto col = 0; col < numInputColumns_; ++col) {
+    decodedVectors_[col].decode(*input->childAt(col), activeRows_);
+  }
+
+  // Passes 'comparator_' by reference to the heap algorithms.
+  auto less = [&](const char* left, const char* right) {
+    return comparator_(left, right);
+  };
+  for (auto row = 0; row < numInput; ++row) {
+    auto& topRows = partitions_[partitionIndex(lookup_->hits[row])];
+    char* newRow = nullptr;
+    if (topRows.size() < limit_) {
+      newRow = data_->newRow();
+    } else {
+      if (comparator_(topRows.front(), decodedVectors_, row)) {
+        continue;
+      }
+      std::pop_heap(topRows.begin(), topRows.end(), less);
+      // Reuse the memory of the row that drops out.
+      newRow = data_->initializeRow(topRows.back(), true /* reuse */);
+      topRows.pop_back();
+    }
+
+    for (auto col = 0; col < numInputColumns_; ++col) {
+      data_->store(decodedVectors_[col], row, newRow, col);
+    }
+    topRows.push_back(newRow);
+    std::push_heap(topRows.begin(), topRows.end(), less);
+  }
+}
+
+void TopNRowNumber::finish() {
+  Operator::finish();
+  auto less = [&](const char* left, const char* right) {
+    return comparator_(left, right);
+  };
+  for (auto& topRows : partitions_) {
+    std::sort_heap(topRows.begin(), topRows.end(), less);
+  }
+}
+
+RowVectorPtr TopNRowNumber::getOutput() {
+  if (!isFinishing_ || outputPartition_ == partitions_.size()) {
+    return nullptr;
+  }
+
+  outputRows_.clear();
+  std::vector<int64_t> rowNumbers;
+  while (outputRows_.size() < outputBatchSize_ &&
+         outputPartition_ < partitions_.size()) {
+    auto& topRows = partitions_[outputPartition_];
+    auto numRows = std::min<size_t>(
+        outputBatchSize_ - outputRows_.size(), topRows.size() - outputOffset_);
+    for (auto i = 0; i < numRows; ++i) {
+      outputRows_.push_back(topRows[outputOffset_ + i]);
+      rowNumbers.push_back(outputOffset_ + i + 1);
+    }
+    outputOffset_ += numRows;
+    if (outputOffset_ == topRows.size()) {
+      ++outputPartition_;
+      outputOffset_ = 0;
+    }
+  }
+
+  auto numOutput = outputRows_.size();
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(outputType_, numOutput, operatorCtx_->pool()));
+  for (auto i = 0; i < numInputColumns_; ++i) {
+    data_->extractColumn(
+        outputRows_.data(), numOutput, i, result->childAt(i));
+  }
+  if (generateRowNumber_) {
+    auto rowNumberVector =
+        result->childAt(numInputColumns_)->asFlatVector<int64_t>();
+    for (auto i = 0; i < numOutput; ++i) {
+      rowNumberVector->set(i, rowNumbers[i]);
+    }
+  }
+  return result;
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/exec/HashTable.h"
+#include "velox/exec/Operator.h"
+#include "velox/exec/RowContainer.h"
+#include "velox/exec/TopN.h"
+
+namespace facebook::velox::exec {
+
+// Keeps the top 'limit' rows of each partition. The partitions are the
+// groups of a HashTable on the partition keys. Each group refers to a heap
+// of at most 'limit' rows, ordered like in TopN. The rows are stored in a
+// RowContainer. A row only enters the RowContainer if it is among the top
+// rows of its partition so far, so that memory is bounded by the number of
+// partitions times 'limit'. The output is produced after all input, one
+// partition after the other.
+class TopNRowNumber : public Operator {
+ public:
+  TopNRowNumber(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::TopNRowNumberNode>& node);
+
+  bool needsInput() const override {
+    return !isFinishing_;
+  }
+
+  void addInput(RowVectorPtr input) override;
+
+  RowVectorPtr getOutput() override;
+
+  void finish() override;
+
+  BlockingReason isBlocked(ContinueFuture* /*future*/) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  void close() override {
+    Operator::close();
+    table_.reset();
+    partitions_.clear();
+    data_.reset();
+  }
+
+ private:
+  // Sets 'lookup_->hits' to the group of the partition of each row of
+  // 'input'. Adds a heap for each new partition.
+  void probePartitions(const RowVectorPtr& input);
+
+  int64_t& partitionIndex(char* group) {
+    return *reinterpret_cast<int64_t*>(group + partitionIndexOffset_);
+  }
+
+  // Maximum number of rows in the output batch.
+  const uint32_t outputBatchSize_;
+
+  const int32_t limit_;
+
+  const bool generateRowNumber_;
+
+  const int32_t numInputColumns_;
+
+  std::vector<ChannelIndex> partitionChannels_;
+
+  // Holds the input rows that are among the top rows of their partition.
+  std::unique_ptr<RowContainer> data_;
+
+  TopN::Comparator comparator_;
+
+  // Groups rows on the partition keys. Each group has the index of its heap
+  // in 'partitions_' as a dependent column.
+  std::unique_ptr<HashTable<false>> table_;
+  std::unique_ptr<HashLookup> lookup_;
+  int32_t partitionIndexOffset_;
+  bool tableProbed_{false};
+
+  // The heap of top rows of each partition. The top of a heap is the last
+  // row of the partition in sorting order. The heaps are sorted at finish.
+  std::vector<std::vector<char*>> partitions_;
+
+  SelectivityVector activeRows_;
+  std::vector<DecodedVector> decodedVectors_;
+
+  // The position of the next row to produce.
+  size_t outputPartition_{0};
+  size_t outputOffset_{0};
+  std::vector<char*> outputRows_;
+};
+
+} // namespace facebook::velox::exec
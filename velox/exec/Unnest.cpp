@@ -27,16 +27,18 @@ Unnest::Unnest(
           unnestNode->outputType(),
           operatorId,
           unnestNode->id(),
-          "Unnest") {
+          "Unnest"),
+      outputBatchSize_{
+          driverCtx->execCtx->queryCtx()->config().preferredOutputBatchSize()} {
   if (unnestNode->unnestVariables().size() > 1) {
     VELOX_UNSUPPORTED(
         "Unnest operator doesn't support multiple unnest columns yet");
   }
 
   const auto& unnestVariable = unnestNode->unnestVariables()[0];
-  if (!unnestVariable->type()->isArray()) {
+  if (!unnestVariable->type()->isArray() && !unnestVariable->type()->isMap()) {
     VELOX_UNSUPPORTED(
-        "Unnest operator doesn't support non-ARRAY unnest variables yet: {}",
+        "Unnest operator supports only ARRAY and MAP unnest variables: {}",
         unnestVariable->type()->toString())
   }
 
@@ -55,89 +57,128 @@ Unnest::Unnest(
 }
 
 void Unnest::addInput(RowVectorPtr input) {
-  input_ = std::move(input);
-}
-
-RowVectorPtr Unnest::getOutput() {
-  if (!input_) {
-    return nullptr;
-  }
-
-  auto size = input_->size();
-
-  // Build repeated indices to apply to "replicated" columns.
-  const auto& unnestVector = input_->childAt(unnestChannel_);
-
+  auto size = input->size();
+  const auto& unnestVector = input->childAt(unnestChannel_);
   inputRows_.resize(size);
   unnestDecoded_.decode(*unnestVector, inputRows_);
 
-  auto unnestIndices = unnestDecoded_.indices();
-
-  auto unnestBase = unnestDecoded_.base()->as<ArrayVector>();
-  auto rawSizes = unnestBase->rawSizes();
-  auto rawOffsets = unnestBase->rawOffsets();
+  auto unnestBase = unnestDecoded_.base();
+  if (auto arrayBase = unnestBase->as<ArrayVector>()) {
+    rawOffsets_ = arrayBase->rawOffsets();
+    rawSizes_ = arrayBase->rawSizes();
+    unnestElements_ = {arrayBase->elements()};
+  } else {
+    auto mapBase = unnestBase->asUnchecked<MapVector>();
+    rawOffsets_ = mapBase->rawOffsets();
+    rawSizes_ = mapBase->rawSizes();
+    unnestElements_ = {mapBase->mapKeys(), mapBase->mapValues()};
+  }
 
   // Count number of elements.
-  vector_size_t numElements = 0;
+  numRemainingElements_ = 0;
   for (auto row = 0; row < size; ++row) {
     if (!unnestDecoded_.isNullAt(row)) {
-      numElements += rawSizes[unnestIndices[row]];
+      numRemainingElements_ += rawSizes_[unnestDecoded_.index(row)];
     }
   }
 
-  if (numElements == 0) {
+  if (numRemainingElements_ == 0) {
     // All arrays are null or empty.
-    input_ = nullptr;
-    return nullptr;
+    return;
   }
 
-  // Create "indices" buffer to repeat rows as many times as there are elements
-  // in the array.
-  BufferPtr repeatedIndices = allocateIndices(numElements, pool());
-  auto* rawIndices = repeatedIndices->asMutable<vector_size_t>();
-  vector_size_t index = 0;
-  for (auto row = 0; row < size; ++row) {
-    if (!unnestDecoded_.isNullAt(row)) {
-      auto unnestSize = rawSizes[unnestIndices[row]];
-      for (auto i = 0; i < unnestSize; i++) {
-        rawIndices[index++] = row;
-      }
+  if (numRemainingElements_ > static_cast<int64_t>(outputBatchSize_)) {
+    // The replicated columns are wrapped in a different dictionary for
+    // each batch of output, which lazy vectors do not allow.
+    for (const auto& projection : identityProjections_) {
+      input->loadedChildAt(projection.inputChannel);
     }
   }
+  input_ = std::move(input);
+  nextInputRow_ = 0;
+  nextElement_ = 0;
+}
 
-  // Wrap "replicated" columns in a dictionary using 'repeatedIndices'.
-  std::vector<VectorPtr> outputs(outputType_->size());
-  for (const auto& projection : identityProjections_) {
-    outputs[projection.outputChannel] = wrapChild(
-        numElements, repeatedIndices, input_->childAt(projection.inputChannel));
+RowVectorPtr Unnest::getOutput() {
+  if (!input_) {
+    return nullptr;
   }
 
-  // Make "elements" column. Elements may be out of order. Use a
-  // dictionary to ensure the right order.
+  auto size = input_->size();
+  auto numElements =
+      std::min<vector_size_t>(numRemainingElements_, outputBatchSize_);
+
+  // Build repeated indices to apply to "replicated" columns and indices of
+  // the unnested elements. Elements may be out of order. A row whose array
+  // does not fit continues in the next batch.
+  BufferPtr repeatedIndices = allocateIndices(numElements, pool());
+  auto* rawRepeatedIndices = repeatedIndices->asMutable<vector_size_t>();
   BufferPtr elementIndices = allocateIndices(numElements, pool());
   auto* rawElementIndices = elementIndices->asMutable<vector_size_t>();
-  index = 0;
-  bool identityMapping = true;
-  for (auto row = 0; row < size; ++row) {
-    if (!unnestDecoded_.isNullAt(row)) {
-      auto offset = rawOffsets[unnestIndices[row]];
-      auto unnestSize = rawSizes[unnestIndices[row]];
-
-      if (index != offset) {
+  // The first and last input rows with elements in the batch.
+  vector_size_t firstRow = -1;
+  vector_size_t lastRow = -1;
+  vector_size_t index = 0;
+  // True if the elements are output as is.
+  bool identityMapping = numElements == unnestElements_[0]->size();
+  while (index < numElements) {
+    auto row = nextInputRow_;
+    VELOX_CHECK_LT(row, size);
+    auto unnestSize = unnestDecoded_.isNullAt(row)
+        ? 0
+        : rawSizes_[unnestDecoded_.index(row)];
+    auto numRowElements =
+        std::min(unnestSize - nextElement_, numElements - index);
+    if (numRowElements > 0) {
+      auto offset = rawOffsets_[unnestDecoded_.index(row)] + nextElement_;
+      if (offset != index) {
         identityMapping = false;
       }
-
-      for (auto i = 0; i < unnestSize; i++) {
-        rawElementIndices[index++] = offset + i;
+      std::fill(
+          rawRepeatedIndices + index,
+          rawRepeatedIndices + index + numRowElements,
+          row);
+      std::iota(
+          rawElementIndices + index,
+          rawElementIndices + index + numRowElements,
+          offset);
+      if (index == 0) {
+        firstRow = row;
       }
+      index += numRowElements;
+      nextElement_ += numRowElements;
+      lastRow = row;
+    }
+    if (nextElement_ == unnestSize) {
+      ++nextInputRow_;
+      nextElement_ = 0;
     }
   }
 
-  outputs[identityProjections_.size()] = identityMapping
-      ? unnestBase->elements()
-      : wrapChild(numElements, elementIndices, unnestBase->elements());
+  // Wrap "replicated" columns in a dictionary using 'repeatedIndices' or in
+  // a constant if the batch has the elements of a single row.
+  std::vector<VectorPtr> outputs(outputType_->size());
+  for (const auto& projection : identityProjections_) {
+    const auto& child = input_->childAt(projection.inputChannel);
+    outputs[projection.outputChannel] = lastRow == firstRow &&
+            child->encoding() != VectorEncoding::Simple::LAZY
+        ? BaseVector::wrapInConstant(numElements, firstRow, child)
+        : wrapChild(numElements, repeatedIndices, child);
+  }
+
+  // The elements are passed through if they are output as is, else
+  // wrapped in a dictionary.
+  auto outputChannel = identityProjections_.size();
+  for (const auto& elements : unnestElements_) {
+    outputs[outputChannel++] = identityMapping
+        ? elements
+        : wrapChild(numElements, elementIndices, elements);
+  }
 
-  input_ = nullptr;
+  numRemainingElements_ -= numElements;
+  if (numRemainingElements_ == 0) {
+    input_ = nullptr;
+  }
 
   return std::make_shared<RowVector>(
       pool(), outputType_, BufferPtr(nullptr), numElements, std::move(outputs));
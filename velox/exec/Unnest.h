@@ -29,7 +29,7 @@ class Unnest : public Operator {
   }
 
   bool needsInput() const override {
-    return true;
+    return !input_;
   }
 
   void addInput(RowVectorPtr input) override;
@@ -37,9 +37,29 @@ class Unnest : public Operator {
   RowVectorPtr getOutput() override;
 
  private:
+  // Maximum number of rows in the output batch. An input whose arrays or
+  // maps have more elements is output in several batches.
+  const uint32_t outputBatchSize_;
+
   ChannelIndex unnestChannel_;
 
   SelectivityVector inputRows_;
   DecodedVector unnestDecoded_;
+
+  // Offsets and sizes of the base ArrayVector or MapVector of
+  // 'unnestDecoded_'.
+  const vector_size_t* rawOffsets_{nullptr};
+  const vector_size_t* rawSizes_{nullptr};
+
+  // Elements of the base ArrayVector or keys and values of the base
+  // MapVector.
+  std::vector<VectorPtr> unnestElements_;
+
+  // Next row of 'input_' to unnest and next element of that row.
+  vector_size_t nextInputRow_{0};
+  vector_size_t nextElement_{0};
+
+  // Number of elements of 'input_' not yet output.
+  vector_size_t numRemainingElements_{0};
 };
 } // namespace facebook::velox::exec
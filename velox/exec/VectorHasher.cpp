@@ -19,6 +19,7 @@
 #include "velox/common/base/Portability.h"
 #include "velox/common/base/SimdUtil.h"
 #include "velox/exec/HashStringAllocator.h"
+#include "velox/vector/ComplexVector.h"
 
 namespace facebook::velox::exec {
 
@@ -40,6 +41,9 @@ namespace facebook::velox::exec {
       case TypeKind::BIGINT: {                                           \
         return TEMPLATE_FUNC<TypeKind::BIGINT>(__VA_ARGS__);             \
       }                                                                  \
+      case TypeKind::TIMESTAMP: {                                        \
+        return TEMPLATE_FUNC<TypeKind::TIMESTAMP>(__VA_ARGS__);          \
+      }                                                                  \
       case TypeKind::VARCHAR:                                            \
       case TypeKind::VARBINARY: {                                        \
         return TEMPLATE_FUNC<TypeKind::VARCHAR>(__VA_ARGS__);            \
@@ -65,6 +69,39 @@ uint64_t hashOne(DecodedVector& decoded, vector_size_t index) {
   using T = typename KindToFlatVector<Kind>::HashRowType;
   return folly::hasher<T>()(decoded.valueAt<T>(index));
 }
+
+// True for the types whose flat values are hashed straight from the values
+// array.
+template <TypeKind Kind>
+constexpr bool isFlatHashable() {
+  return Kind == TypeKind::TINYINT || Kind == TypeKind::SMALLINT ||
+      Kind == TypeKind::INTEGER || Kind == TypeKind::BIGINT ||
+      Kind == TypeKind::REAL || Kind == TypeKind::DOUBLE ||
+      Kind == TypeKind::TIMESTAMP || Kind == TypeKind::DATE ||
+      Kind == TypeKind::VARCHAR || Kind == TypeKind::VARBINARY;
+}
+
+// Hashes 'values' in [begin, end) without nulls. The loops have no
+// per-row branches, so that the compiler can unroll and vectorize the
+// integer cases.
+template <typename T>
+void hashFlat(
+    const T* values,
+    vector_size_t begin,
+    vector_size_t end,
+    bool mix,
+    uint64_t* result) {
+  folly::hasher<T> hasher;
+  if (mix) {
+    for (auto row = begin; row < end; ++row) {
+      result[row] = bits::hashMix(result[row], hasher(values[row]));
+    }
+  } else {
+    for (auto row = begin; row < end; ++row) {
+      result[row] = hasher(values[row]);
+    }
+  }
+}
 } // namespace
 
 template <TypeKind Kind>
@@ -81,6 +118,13 @@ void VectorHasher::hashValues(
       result[row] = mix ? bits::hashMix(result[row], hash) : hash;
     });
   } else if (decoded_.isIdentityMapping()) {
+    if constexpr (isFlatHashable<Kind>()) {
+      if (!decoded_.mayHaveNulls() && rows.isAllSelected()) {
+        hashFlat(
+            decoded_.data<T>(), rows.begin(), rows.end(), mix, result);
+        return;
+      }
+    }
     rows.applyToSelected([&](vector_size_t row) {
       if (decoded_.isNullAt(row)) {
         result[row] = mix ? bits::hashMix(result[row], kNullHash) : kNullHash;
@@ -108,6 +152,126 @@ void VectorHasher::hashValues(
   }
 }
 
+void VectorHasher::hashComplex(
+    const SelectivityVector& rows,
+    bool mix,
+    uint64_t* result) {
+  auto base = decoded_.base();
+  baseRows_.resize(base->size());
+  baseRows_.clearAll();
+  rows.applyToSelected([&](vector_size_t row) {
+    if (!decoded_.isNullAt(row)) {
+      baseRows_.setValid(decoded_.index(row), true);
+    }
+  });
+  baseRows_.updateBounds();
+  if (baseRows_.hasSelections()) {
+    baseHashes_.resize(base->size());
+    hashComplexBase(*base, baseRows_, baseHashes_);
+  }
+  rows.applyToSelected([&](vector_size_t row) {
+    auto hash = decoded_.isNullAt(row) ? kNullHash
+                                       : baseHashes_[decoded_.index(row)];
+    result[row] = mix ? bits::hashMix(result[row], hash) : hash;
+  });
+}
+
+VectorHasher& VectorHasher::childHasher(int32_t index) {
+  if (childHashers_.empty()) {
+    for (auto i = 0; i < type_->size(); ++i) {
+      childHashers_.push_back(create(type_->childAt(i), i));
+    }
+    childHashes_.resize(type_->size());
+  }
+  return *childHashers_[index];
+}
+
+void VectorHasher::hashElements(
+    const SelectivityVector& rows,
+    const vector_size_t* offsets,
+    const vector_size_t* sizes,
+    const std::vector<VectorPtr>& elements,
+    raw_vector<uint64_t>& result) {
+  childHasher(0);
+  auto numElements = elements[0]->size();
+  elementRows_.resize(numElements);
+  elementRows_.clearAll();
+  rows.applyToSelected([&](vector_size_t row) {
+    elementRows_.setValidRange(offsets[row], offsets[row] + sizes[row], true);
+  });
+  elementRows_.updateBounds();
+  if (elementRows_.hasSelections()) {
+    for (auto i = 0; i < elements.size(); ++i) {
+      childHashes_[i].resize(numElements);
+      childHasher(i).hash(*elements[i], elementRows_, false, childHashes_[i]);
+    }
+  }
+  // Same as hashValueAt() of ArrayVector and MapVector: the hashes of the
+  // keys and then the values are folded with a commutative mix.
+  rows.applyToSelected([&](vector_size_t row) {
+    auto hash = kNullHash;
+    auto begin = offsets[row];
+    auto end = begin + sizes[row];
+    for (auto i = 0; i < elements.size(); ++i) {
+      auto hashes = childHashes_[i].data();
+      for (auto j = begin; j < end; ++j) {
+        hash = bits::commutativeHashMix(hash, hashes[j]);
+      }
+    }
+    result[row] = hash;
+  });
+}
+
+void VectorHasher::hashComplexBase(
+    const BaseVector& base,
+    const SelectivityVector& rows,
+    raw_vector<uint64_t>& result) {
+  switch (base.encoding()) {
+    case VectorEncoding::Simple::ARRAY: {
+      auto array = base.as<ArrayVector>();
+      hashElements(
+          rows,
+          array->rawOffsets(),
+          array->rawSizes(),
+          {array->elements()},
+          result);
+      return;
+    }
+    case VectorEncoding::Simple::MAP: {
+      auto map = base.as<MapVector>();
+      hashElements(
+          rows,
+          map->rawOffsets(),
+          map->rawSizes(),
+          {map->mapKeys(), map->mapValues()},
+          result);
+      return;
+    }
+    case VectorEncoding::Simple::ROW: {
+      // Same as RowVector::hashValueAt(): the first child's hash mixed with
+      // the hashes of the others.
+      auto row = base.as<RowVector>();
+      bool isFirst = true;
+      for (auto i = 0; i < row->childrenSize(); ++i) {
+        auto& child = row->childAt(i);
+        if (child) {
+          childHasher(i).hash(*child, rows, !isFirst, result);
+          isFirst = false;
+        }
+      }
+      if (isFirst) {
+        rows.applyToSelected(
+            [&](vector_size_t index) { result[index] = kNullHash; });
+      }
+      return;
+    }
+    default:
+      rows.applyToSelected([&](vector_size_t index) {
+        result[index] = base.hashValueAt(index);
+      });
+  }
+}
+
 template <TypeKind Kind>
 bool VectorHasher::makeValueIds(
     const SelectivityVector& rows,
@@ -334,7 +498,14 @@ bool VectorHasher::computeValueIdsForRows(
     int32_t offset,
     int32_t nullByte,
     uint8_t nullMask,
-    raw_vector<uint64_t>& result) {
+    raw_vector<uint64_t>& result,
+    bool packedTimestamps) {
+  if (packedTimestamps) {
+    // The ids of timestamps are those of their nanoseconds.
+    VELOX_DCHECK(typeKind_ == TypeKind::TIMESTAMP);
+    return makeValueIdsForRows<TypeKind::BIGINT>(
+        groups, numGroups, offset, nullByte, nullMask, result.data());
+  }
   return VALUE_ID_TYPE_DISPATCH(
       makeValueIdsForRows,
       typeKind_,
@@ -461,6 +632,11 @@ void VectorHasher::hash(
     bool mix,
     raw_vector<uint64_t>& result) {
   decoded_.decode(values, rows);
+  if (typeKind_ == TypeKind::ROW || typeKind_ == TypeKind::ARRAY ||
+      typeKind_ == TypeKind::MAP) {
+    hashComplex(rows, mix, result.data());
+    return;
+  }
   return VELOX_DYNAMIC_TYPE_DISPATCH(
       hashValues, typeKind_, rows, mix, result.data());
 }
@@ -470,7 +646,13 @@ void VectorHasher::analyze(
     int32_t numGroups,
     int32_t offset,
     int32_t nullByte,
-    uint8_t nullMask) {
+    uint8_t nullMask,
+    bool packedTimestamps) {
+  if (packedTimestamps) {
+    VELOX_DCHECK(typeKind_ == TypeKind::TIMESTAMP);
+    return analyzeTyped<TypeKind::BIGINT>(
+        groups, numGroups, offset, nullByte, nullMask);
+  }
   return VALUE_ID_TYPE_DISPATCH(
       analyzeTyped, typeKind_, groups, numGroups, offset, nullByte, nullMask);
 }
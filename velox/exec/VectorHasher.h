@@ -177,13 +177,16 @@ class VectorHasher {
       raw_vector<uint64_t>& result);
 
   // Same as computeValueIds, but takes input stored row-wise.
+  // 'packedTimestamps' is true if the rows store TIMESTAMP values as their
+  // Timestamp::toNanos().
   bool computeValueIdsForRows(
       char** groups,
       int32_t numGroups,
       int32_t offset,
       int32_t nullByte,
       uint8_t nullMask,
-      raw_vector<uint64_t>& result);
+      raw_vector<uint64_t>& result,
+      bool packedTimestamps = false);
 
   struct ScratchMemory {
     DecodedVector decoded;
@@ -208,6 +211,11 @@ class VectorHasher {
     return hasRange_ || !distinctOverflow_;
   }
 
+  // Returns true if there were too many distinct values to keep them all.
+  bool distinctOverflow() const {
+    return distinctOverflow_;
+  }
+
   // Returns an instance of the filter corresponding to a set of unique values.
   // Returns null if distinctOverflow_ is true.
   std::unique_ptr<common::Filter> getFilter(bool nullAllowed) const;
@@ -230,7 +238,8 @@ class VectorHasher {
       int32_t numGroups,
       int32_t offset,
       int32_t nullByte,
-      uint8_t nullMask);
+      uint8_t nullMask,
+      bool packedTimestamps = false);
 
   bool isRange() const {
     return isRange_;
@@ -251,6 +260,7 @@ class VectorHasher {
       case TypeKind::SMALLINT:
       case TypeKind::INTEGER:
       case TypeKind::BIGINT:
+      case TypeKind::TIMESTAMP:
       case TypeKind::VARCHAR:
       case TypeKind::VARBINARY:
         return true;
@@ -460,6 +470,32 @@ class VectorHasher {
   template <TypeKind Kind>
   void hashValues(const SelectivityVector& rows, bool mix, uint64_t* result);
 
+  // Hashes the ROW, ARRAY or MAP values of 'decoded_' a column at a time:
+  // each distinct base value is hashed once and the children are hashed in
+  // bulk by child VectorHashers instead of one value at a time by
+  // BaseVector::hashValueAt(). The hashes are the same as hashValueAt().
+  void hashComplex(const SelectivityVector& rows, bool mix, uint64_t* result);
+
+  // Sets 'result' at 'rows' to the hashes of the non-null 'rows' of the
+  // flat complex vector 'base'.
+  void hashComplexBase(
+      const BaseVector& base,
+      const SelectivityVector& rows,
+      raw_vector<uint64_t>& result);
+
+  // Hashes the arrays or maps at 'rows' from the hashes of the 'elements',
+  // which are [elements] or [keys, values].
+  void hashElements(
+      const SelectivityVector& rows,
+      const vector_size_t* offsets,
+      const vector_size_t* sizes,
+      const std::vector<VectorPtr>& elements,
+      raw_vector<uint64_t>& result);
+
+  // Returns the hasher of the child 'index' of 'type_', making the hashers
+  // of all children on first use.
+  VectorHasher& childHasher(int32_t index);
+
   const ChannelIndex channel_;
   const TypePtr type_;
   const TypeKind typeKind_;
@@ -467,6 +503,13 @@ class VectorHasher {
   DecodedVector decoded_;
   raw_vector<uint64_t> cachedHashes_;
 
+  // State for hashComplex(). Nested types recurse into 'childHashers_'.
+  std::vector<std::unique_ptr<VectorHasher>> childHashers_;
+  std::vector<raw_vector<uint64_t>> childHashes_;
+  SelectivityVector baseRows_;
+  SelectivityVector elementRows_;
+  raw_vector<uint64_t> baseHashes_;
+
   // Members for fast map to int domain for array/normalized key.
   // Maximum integer mapping. If distinct count exceeds this,
   // array/normalized key mapping fails.
@@ -574,6 +617,42 @@ inline uint64_t VectorHasher::lookupValueId(StringView value) const {
   return kUnmappable;
 }
 
+// Timestamps are mapped by their nanoseconds. The first timestamp
+// that does not fit in nanoseconds makes 'this' unmappable.
+template <>
+inline void VectorHasher::analyzeValue(Timestamp value) {
+  if (!value.fitsInNanos()) {
+    rangeOverflow_ = true;
+    distinctOverflow_ = true;
+    return;
+  }
+  analyzeValue(value.toNanos());
+}
+
+template <>
+inline bool VectorHasher::tryMapToRange(
+    const Timestamp* /*values*/,
+    const SelectivityVector& /*rows*/,
+    uint64_t* /*result*/) {
+  return false;
+}
+
+template <>
+inline uint64_t VectorHasher::valueId(Timestamp value) {
+  if (!value.fitsInNanos()) {
+    return kUnmappable;
+  }
+  return valueId(value.toNanos());
+}
+
+template <>
+inline uint64_t VectorHasher::lookupValueId(Timestamp value) const {
+  if (!value.fitsInNanos()) {
+    return kUnmappable;
+  }
+  return lookupValueId(value.toNanos());
+}
+
 template <>
 inline uint64_t VectorHasher::valueId(bool value) {
   return value ? 2 : 1;
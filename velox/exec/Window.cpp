@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/Window.h"
+#include "velox/exec/Task.h"
+
+namespace facebook::velox::exec {
+
+Window::Window(
+    int32_t operatorId,
+    DriverCtx* driverCtx,
+    const std::shared_ptr<const core::WindowNode>& windowNode)
+    : Operator(
+          driverCtx,
+          windowNode->outputType(),
+          operatorId,
+          windowNode->id(),
+          "Window"),
+      outputBatchSize_{
+          driverCtx->execCtx->queryCtx()->config().preferredOutputBatchSize()},
+      inputsSorted_(windowNode->inputsSorted()),
+      numInputColumns_(windowNode->sources()[0]->outputType()->size()) {
+  auto inputType = windowNode->sources()[0]->outputType();
+  for (const auto& key : windowNode->partitionKeys()) {
+    auto channel = exprToChannel(key.get(), inputType);
+    VELOX_CHECK_NE(
+        channel,
+        kConstantChannel,
+        "Window doesn't allow constant partition keys");
+    partitionKeys_.push_back(channel);
+  }
+  for (auto i = 0; i < windowNode->sortingKeys().size(); ++i) {
+    auto channel =
+        exprToChannel(windowNode->sortingKeys()[i].get(), inputType);
+    VELOX_CHECK_NE(
+        channel, kConstantChannel, "Window doesn't allow constant sorting keys");
+    sortingKeys_.emplace_back(channel, windowNode->sortingOrders()[i]);
+  }
+
+  data_ = std::make_unique<RowContainer>(
+      inputType->children(), operatorCtx_->mappedMemory());
+  partition_.data = data_.get();
+
+  for (const auto& function : windowNode->windowFunctions()) {
+    functions_.push_back(WindowFunction::create(
+        function,
+        inputType,
+        operatorCtx_->pool(),
+        operatorCtx_->mappedMemory()));
+  }
+}
+
+bool Window::isSamePartition(const char* left, const char* right) {
+  for (auto channel : partitionKeys_) {
+    if (data_->compare(left, right, channel) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Window::isSamePeerGroup(const char* left, const char* right) {
+  for (auto& key : sortingKeys_) {
+    if (data_->compare(left, right, key.first) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Window::addInput(RowVectorPtr input) {
+  auto numInput = input->size();
+  SelectivityVector allRows(numInput);
+  auto firstNewRow = rows_.size();
+  for (auto i = 0; i < numInput; ++i) {
+    rows_.push_back(data_->newRow());
+  }
+  for (auto col = 0; col < input->childrenSize(); ++col) {
+    DecodedVector decoded(*input->childAt(col), allRows);
+    for (auto i = 0; i < numInput; ++i) {
+      data_->store(decoded, i, rows_[firstNewRow + i], col);
+    }
+  }
+
+  if (inputsSorted_) {
+    // The partitions before the last partition start are complete.
+    int64_t lowest = std::max<int64_t>(firstNewRow, numCompleteRows_ + 1);
+    for (int64_t i = rows_.size() - 1; i >= lowest; --i) {
+      if (!isSamePartition(rows_[i - 1], rows_[i])) {
+        numCompleteRows_ = i;
+        break;
+      }
+    }
+  }
+}
+
+void Window::finish() {
+  Operator::finish();
+  if (!inputsSorted_) {
+    sortRows();
+  }
+  numCompleteRows_ = rows_.size();
+}
+
+void Window::sortRows() {
+  std::sort(
+      rows_.begin(),
+      rows_.end(),
+      [this](const char* leftRow, const char* rightRow) {
+        for (auto channel : partitionKeys_) {
+          if (auto result = data_->compare(leftRow, rightRow, channel)) {
+            return result < 0;
+          }
+        }
+        for (auto& key : sortingKeys_) {
+          if (auto result = data_->compare(
+                  leftRow,
+                  rightRow,
+                  key.first,
+                  {key.second.isNullsFirst(),
+                   key.second.isAscending(),
+                   false})) {
+            return result < 0;
+          }
+        }
+        return false;
+      });
+}
+
+void Window::startPartition() {
+  partitionStart_ = nextRow_;
+  partitionEnd_ = nextRow_ + 1;
+  while (partitionEnd_ < numCompleteRows_ &&
+         isSamePartition(rows_[partitionStart_], rows_[partitionEnd_])) {
+    ++partitionEnd_;
+  }
+
+  auto size = partitionEnd_ - partitionStart_;
+  partition_.rows.assign(
+      rows_.begin() + partitionStart_, rows_.begin() + partitionEnd_);
+  partition_.peerStarts.resize(size);
+  partition_.peerEnds.resize(size);
+  vector_size_t peerStart = 0;
+  for (auto i = 0; i < size; ++i) {
+    if (i > 0 &&
+        !isSamePeerGroup(partition_.rows[i - 1], partition_.rows[i])) {
+      std::fill(
+          partition_.peerEnds.begin() + peerStart,
+          partition_.peerEnds.begin() + i,
+          i);
+      peerStart = i;
+    }
+    partition_.peerStarts[i] = peerStart;
+  }
+  std::fill(
+      partition_.peerEnds.begin() + peerStart, partition_.peerEnds.end(), size);
+
+  for (auto& function : functions_) {
+    function->resetPartition(&partition_);
+  }
+}
+
+RowVectorPtr Window::getOutput() {
+  auto numAvailable = numCompleteRows_ - nextRow_;
+  if (numAvailable == 0 ||
+      (!isFinishing_ && numAvailable < outputBatchSize_)) {
+    return nullptr;
+  }
+
+  auto numOutput = std::min<size_t>(numAvailable, outputBatchSize_);
+  auto result = std::static_pointer_cast<RowVector>(
+      BaseVector::create(outputType_, numOutput, operatorCtx_->pool()));
+  for (auto i = 0; i < numInputColumns_; ++i) {
+    data_->extractColumn(
+        rows_.data() + nextRow_, numOutput, i, result->childAt(i));
+  }
+
+  // A batch may span several partitions and a partition several batches.
+  vector_size_t resultOffset = 0;
+  while (resultOffset < numOutput) {
+    if (nextRow_ == partitionEnd_) {
+      startPartition();
+    }
+    auto numRows = std::min<size_t>(
+        numOutput - resultOffset, partitionEnd_ - nextRow_);
+    for (auto i = 0; i < functions_.size(); ++i) {
+      functions_[i]->apply(
+          nextRow_ - partitionStart_,
+          numRows,
+          resultOffset,
+          result->childAt(numInputColumns_ + i));
+    }
+    resultOffset += numRows;
+    nextRow_ += numRows;
+  }
+
+  if (inputsSorted_) {
+    eraseProducedRows();
+  }
+  return result;
+}
+
+void Window::eraseProducedRows() {
+  // The rows of the current partition stay until it is complete since the
+  // window functions may refer to any of them.
+  auto numErased = nextRow_ == partitionEnd_ ? partitionEnd_ : partitionStart_;
+  if (numErased == 0) {
+    return;
+  }
+  data_->eraseRows(folly::Range<char**>(rows_.data(), numErased));
+  rows_.erase(rows_.begin(), rows_.begin() + numErased);
+  numCompleteRows_ -= numErased;
+  nextRow_ -= numErased;
+  partitionStart_ -= std::min(partitionStart_, numErased);
+  partitionEnd_ -= numErased;
+}
+
+} // namespace facebook::velox::exec
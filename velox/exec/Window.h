@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/exec/Operator.h"
+#include "velox/exec/RowContainer.h"
+#include "velox/exec/WindowFunction.h"
+
+namespace facebook::velox::exec {
+
+// Window operator implementation: Window stores its input in a RowContainer.
+// Unless the input is already sorted, it waits for all input and sorts the
+// rows on the partition and sorting keys, using the RowContainer's compare()
+// like OrderBy. It then produces the input columns plus one column per
+// window function, one partition after the other. If the input is sorted,
+// a partition is complete when the first row of the next partition arrives,
+// so that only about one partition is held in memory.
+class Window : public Operator {
+ public:
+  Window(
+      int32_t operatorId,
+      DriverCtx* driverCtx,
+      const std::shared_ptr<const core::WindowNode>& windowNode);
+
+  bool needsInput() const override {
+    return !isFinishing_ &&
+        (!inputsSorted_ || numCompleteRows_ - nextRow_ < outputBatchSize_);
+  }
+
+  void addInput(RowVectorPtr input) override;
+
+  void finish() override;
+
+  RowVectorPtr getOutput() override;
+
+  BlockingReason isBlocked(ContinueFuture* /*future*/) override {
+    return BlockingReason::kNotBlocked;
+  }
+
+  void close() override {
+    Operator::close();
+    functions_.clear();
+    data_.reset();
+  }
+
+ private:
+  bool isSamePartition(const char* left, const char* right);
+
+  bool isSamePeerGroup(const char* left, const char* right);
+
+  // Sorts 'rows_' on the partition and sorting keys.
+  void sortRows();
+
+  // Makes the partition that starts at 'nextRow_' the current partition.
+  void startPartition();
+
+  // Frees the rows of the partitions before the current one. Called only
+  // for sorted input, where 'rows_' holds about one partition.
+  void eraseProducedRows();
+
+  // Maximum number of rows in the output batch.
+  const uint32_t outputBatchSize_;
+
+  const bool inputsSorted_;
+
+  const int32_t numInputColumns_;
+
+  std::vector<ChannelIndex> partitionKeys_;
+
+  std::vector<std::pair<ChannelIndex, core::SortOrder>> sortingKeys_;
+
+  std::unique_ptr<RowContainer> data_;
+
+  std::vector<std::unique_ptr<WindowFunction>> functions_;
+
+  // The rows in window order, starting with the rows of the current
+  // partition.
+  std::vector<char*> rows_;
+
+  // Number of leading rows in 'rows_' that belong to complete partitions.
+  size_t numCompleteRows_{0};
+
+  // Index in 'rows_' of the next row to produce.
+  size_t nextRow_{0};
+
+  // Range of the current partition in 'rows_'.
+  size_t partitionStart_{0};
+  size_t partitionEnd_{0};
+
+  WindowPartition partition_;
+};
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/WindowFunction.h"
+#include "velox/exec/Aggregate.h"
+#include "velox/exec/AllocationPool.h"
+#include "velox/exec/HashStringAllocator.h"
+#include "velox/exec/Operator.h"
+
+namespace facebook::velox::exec {
+
+namespace {
+
+class RowNumberFunction : public WindowFunction {
+ public:
+  RowNumberFunction() : WindowFunction(BIGINT()) {}
+
+  void resetPartition(const WindowPartition* /*partition*/) override {}
+
+  void apply(
+      vector_size_t start,
+      vector_size_t numRows,
+      vector_size_t resultOffset,
+      const VectorPtr& result) override {
+    auto values = result->asFlatVector<int64_t>();
+    for (auto i = 0; i < numRows; ++i) {
+      values->set(resultOffset + i, start + i + 1);
+    }
+  }
+};
+
+// rank() and dense_rank(). Peers, i.e. rows with the same sorting keys, get
+// the same rank.
+class RankFunction : public WindowFunction {
+ public:
+  explicit RankFunction(bool dense) : WindowFunction(BIGINT()), dense_(dense) {}
+
+  void resetPartition(const WindowPartition* partition) override {
+    partition_ = partition;
+    denseRank_ = 0;
+  }
+
+  void apply(
+      vector_size_t start,
+      vector_size_t numRows,
+      vector_size_t resultOffset,
+      const VectorPtr& result) override {
+    auto values = result->asFlatVector<int64_t>();
+    for (auto i = 0; i < numRows; ++i) {
+      auto row = start + i;
+      auto peerStart = partition_->peerStarts[row];
+      if (dense_) {
+        if (peerStart == row) {
+          ++denseRank_;
+        }
+        values->set(resultOffset + i, denseRank_);
+      } else {
+        values->set(resultOffset + i, peerStart + 1);
+      }
+    }
+  }
+
+ private:
+  const bool dense_;
+  const WindowPartition* partition_{nullptr};
+  int64_t denseRank_{0};
+};
+
+// lag() and lead(). The value of the row 'offset' rows before or after the
+// current row in the partition, null if there is no such row.
+class LagLeadFunction : public WindowFunction {
+ public:
+  LagLeadFunction(
+      TypePtr resultType,
+      ChannelIndex channel,
+      int64_t offset,
+      bool isLag,
+      memory::MemoryPool* pool)
+      : WindowFunction(std::move(resultType)),
+        channel_(channel),
+        offset_(isLag ? -offset : offset),
+        pool_(pool) {}
+
+  void resetPartition(const WindowPartition* partition) override {
+    partition_ = partition;
+  }
+
+  void apply(
+      vector_size_t start,
+      vector_size_t numRows,
+      vector_size_t resultOffset,
+      const VectorPtr& result) override {
+    sourceRows_.resize(numRows);
+    auto size = partition_->size();
+    for (auto i = 0; i < numRows; ++i) {
+      int64_t source = start + i + offset_;
+      sourceRows_[i] =
+          source >= 0 && source < size ? partition_->rows[source] : nullptr;
+    }
+    if (!values_) {
+      values_ = BaseVector::create(resultType_, numRows, pool_);
+    }
+    partition_->data->extractColumn(
+        sourceRows_.data(), numRows, channel_, values_);
+    result->copy(values_.get(), resultOffset, 0, numRows);
+  }
+
+ private:
+  const ChannelIndex channel_;
+  const int64_t offset_;
+  memory::MemoryPool* const pool_;
+  const WindowPartition* partition_{nullptr};
+  std::vector<char*> sourceRows_;
+  VectorPtr values_;
+};
+
+// An aggregate over a frame that starts at the start of the partition. The
+// rows are added to a single accumulator as the frame end advances, so that
+// each row of the partition is added once.
+class AggregateWindowFunction : public WindowFunction {
+ public:
+  AggregateWindowFunction(
+      std::unique_ptr<Aggregate> aggregate,
+      std::vector<ChannelIndex> channels,
+      std::vector<VectorPtr> constants,
+      std::vector<TypePtr> argTypes,
+      const core::WindowNode::Frame& frame,
+      memory::MemoryPool* pool,
+      memory::MappedMemory* mappedMemory)
+      : WindowFunction(aggregate->resultType()),
+        aggregate_(std::move(aggregate)),
+        channels_(std::move(channels)),
+        constants_(std::move(constants)),
+        argTypes_(std::move(argTypes)),
+        frame_(frame),
+        pool_(pool),
+        stringAllocator_(mappedMemory),
+        groupPool_(mappedMemory) {
+    // The accumulator is laid out like the single group of a global
+    // aggregation: a null flag, a row size and the fixed-width part.
+    int32_t rowSizeOffset = bits::nbytes(1);
+    int32_t offset = rowSizeOffset + sizeof(int32_t);
+    aggregate_->setAllocator(&stringAllocator_);
+    aggregate_->setOffsets(
+        offset,
+        RowContainer::nullByte(0),
+        RowContainer::nullMask(0),
+        rowSizeOffset);
+    group_ = groupPool_.allocateFixed(
+        offset + aggregate_->accumulatorFixedWidthSize());
+  }
+
+  ~AggregateWindowFunction() override {
+    if (partition_) {
+      aggregate_->destroy(folly::Range<char**>(&group_, 1));
+    }
+  }
+
+  void resetPartition(const WindowPartition* partition) override {
+    if (partition_) {
+      aggregate_->destroy(folly::Range<char**>(&group_, 1));
+    }
+    partition_ = partition;
+    static const std::vector<vector_size_t> kSingleGroup{0};
+    aggregate_->initializeNewGroups(&group_, kSingleGroup);
+    numAdded_ = 0;
+    valueFrameEnd_ = -1;
+  }
+
+  void apply(
+      vector_size_t start,
+      vector_size_t numRows,
+      vector_size_t resultOffset,
+      const VectorPtr& result) override {
+    for (auto i = 0; i < numRows; ++i) {
+      auto end = frameEnd(start + i);
+      if (end != valueFrameEnd_) {
+        addRows(end);
+        aggregate_->finalize(&group_, 1);
+        if (!value_) {
+          value_ = BaseVector::create(resultType_, 1, pool_);
+        }
+        aggregate_->extractValues(&group_, 1, &value_);
+        valueFrameEnd_ = end;
+      }
+      result->copy(value_.get(), resultOffset + i, 0, 1);
+    }
+  }
+
+ private:
+  // Returns the index of the first row after the frame of 'row'.
+  vector_size_t frameEnd(vector_size_t row) const {
+    if (frame_.endType == core::WindowNode::BoundType::kUnboundedFollowing) {
+      return partition_->size();
+    }
+    if (frame_.type == core::WindowNode::WindowType::kRows) {
+      return row + 1;
+    }
+    return partition_->peerEnds[row];
+  }
+
+  // Adds the rows up to 'end' to the accumulator.
+  void addRows(vector_size_t end) {
+    if (end <= numAdded_) {
+      return;
+    }
+    auto numRows = end - numAdded_;
+    args_.resize(channels_.size());
+    for (auto i = 0; i < channels_.size(); ++i) {
+      if (channels_[i] == kConstantChannel) {
+        args_[i] = BaseVector::wrapInConstant(numRows, 0, constants_[i]);
+      } else {
+        args_[i] = BaseVector::create(argTypes_[i], numRows, pool_);
+        partition_->data->extractColumn(
+            partition_->rows.data() + numAdded_,
+            numRows,
+            channels_[i],
+            args_[i]);
+      }
+    }
+    SelectivityVector rows(numRows);
+    aggregate_->addSingleGroupRawInput(group_, rows, args_, false);
+    args_.clear();
+    numAdded_ = end;
+  }
+
+  std::unique_ptr<Aggregate> aggregate_;
+  const std::vector<ChannelIndex> channels_;
+  const std::vector<VectorPtr> constants_;
+  const std::vector<TypePtr> argTypes_;
+  const core::WindowNode::Frame frame_;
+  memory::MemoryPool* const pool_;
+  HashStringAllocator stringAllocator_;
+  AllocationPool groupPool_;
+  char* group_;
+  const WindowPartition* partition_{nullptr};
+
+  // Number of leading rows of the partition added to the accumulator.
+  vector_size_t numAdded_{0};
+
+  // The frame end of the rows for which 'value_' was extracted.
+  vector_size_t valueFrameEnd_{-1};
+  VectorPtr value_;
+  std::vector<VectorPtr> args_;
+};
+
+int64_t integerValue(const variant& value) {
+  switch (value.kind()) {
+    case TypeKind::TINYINT:
+      return value.value<TypeKind::TINYINT>();
+    case TypeKind::SMALLINT:
+      return value.value<TypeKind::SMALLINT>();
+    case TypeKind::INTEGER:
+      return value.value<TypeKind::INTEGER>();
+    case TypeKind::BIGINT:
+      return value.value<TypeKind::BIGINT>();
+    default:
+      VELOX_USER_FAIL("Expected an integer constant: {}", value.toJson());
+  }
+}
+
+} // namespace
+
+// static
+std::unique_ptr<WindowFunction> WindowFunction::create(
+    const core::WindowNode::Function& function,
+    const RowTypePtr& inputType,
+    memory::MemoryPool* pool,
+    memory::MappedMemory* mappedMemory) {
+  const auto& call = function.functionCall;
+  const auto& name = call->name();
+
+  std::vector<ChannelIndex> channels;
+  std::vector<VectorPtr> constants;
+  std::vector<TypePtr> argTypes;
+  for (auto& arg : call->inputs()) {
+    argTypes.push_back(arg->type());
+    channels.push_back(exprToChannel(arg.get(), inputType));
+    if (channels.back() == kConstantChannel) {
+      auto constant = dynamic_cast<const core::ConstantTypedExpr*>(arg.get());
+      constants.push_back(
+          BaseVector::createConstant(constant->value(), 1, pool));
+    } else {
+      constants.push_back(nullptr);
+    }
+  }
+
+  if (name == "row_number" || name == "rank" || name == "dense_rank") {
+    VELOX_USER_CHECK(channels.empty(), "{} takes no arguments", name);
+    if (name == "row_number") {
+      return std::make_unique<RowNumberFunction>();
+    }
+    return std::make_unique<RankFunction>(name == "dense_rank");
+  }
+
+  if (name == "lag" || name == "lead") {
+    VELOX_USER_CHECK(
+        channels.size() == 1 || channels.size() == 2,
+        "{} takes a column and an optional offset",
+        name);
+    VELOX_USER_CHECK_NE(
+        channels[0], kConstantChannel, "{} requires a column", name);
+    int64_t offset = 1;
+    if (channels.size() == 2) {
+      auto constant =
+          dynamic_cast<const core::ConstantTypedExpr*>(call->inputs()[1].get());
+      VELOX_USER_CHECK_NOT_NULL(constant, "{} requires a constant offset", name);
+      offset = integerValue(constant->value());
+      VELOX_USER_CHECK_GE(offset, 0, "{} requires a non-negative offset", name);
+    }
+    return std::make_unique<LagLeadFunction>(
+        call->type(), channels[0], offset, name == "lag", pool);
+  }
+
+  const auto& frame = function.frame;
+  if (frame.startType != core::WindowNode::BoundType::kUnboundedPreceding ||
+      frame.endType == core::WindowNode::BoundType::kUnboundedPreceding) {
+    VELOX_UNSUPPORTED(
+        "Aggregate window functions support only frames that start at UNBOUNDED PRECEDING");
+  }
+  auto aggregate = Aggregate::create(
+      name, core::AggregationNode::Step::kSingle, argTypes, call->type());
+  return std::make_unique<AggregateWindowFunction>(
+      std::move(aggregate),
+      std::move(channels),
+      std::move(constants),
+      std::move(argTypes),
+      frame,
+      pool,
+      mappedMemory);
+}
+
+} // namespace facebook::velox::exec
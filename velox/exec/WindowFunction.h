@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/core/PlanNode.h"
+#include "velox/exec/RowContainer.h"
+
+namespace facebook::velox::exec {
+
+// The rows of one partition of a Window in window order. The columns of the
+// rows in 'data' are the input columns of the Window.
+struct WindowPartition {
+  RowContainer* data{nullptr};
+
+  std::vector<char*> rows;
+
+  // For each row, the index of the first row of its peer group, i.e. of the
+  // rows with the same sorting keys.
+  std::vector<vector_size_t> peerStarts;
+
+  // For each row, the index of the first row after its peer group.
+  std::vector<vector_size_t> peerEnds;
+
+  vector_size_t size() const {
+    return rows.size();
+  }
+};
+
+// Computes a window function over the rows of a partition. The rows are
+// processed in order, so that a function can keep running state, e.g. a
+// running aggregate, instead of recomputing its frame for each row.
+class WindowFunction {
+ public:
+  explicit WindowFunction(TypePtr resultType)
+      : resultType_(std::move(resultType)) {}
+
+  virtual ~WindowFunction() = default;
+
+  const TypePtr& resultType() const {
+    return resultType_;
+  }
+
+  // Starts processing 'partition'. 'partition' stays valid until the next
+  // call.
+  virtual void resetPartition(const WindowPartition* partition) = 0;
+
+  // Sets rows [resultOffset, resultOffset + numRows) of 'result' to the
+  // values for rows [start, start + numRows) of the partition. Consecutive
+  // calls cover consecutive rows.
+  virtual void apply(
+      vector_size_t start,
+      vector_size_t numRows,
+      vector_size_t resultOffset,
+      const VectorPtr& result) = 0;
+
+  // Creates the function for 'function' over input of 'inputType'. The
+  // aggregate functions are supported as window functions besides
+  // row_number, rank, dense_rank, lag and lead.
+  static std::unique_ptr<WindowFunction> create(
+      const core::WindowNode::Function& function,
+      const RowTypePtr& inputType,
+      memory::MemoryPool* pool,
+      memory::MappedMemory* mappedMemory);
+
+ protected:
+  const TypePtr resultType_;
+};
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/WorkStealingExecutor.h"
+#include <glog/logging.h>
+#include "velox/common/base/Exceptions.h"
+
+namespace facebook::velox::exec {
+namespace {
+// The executor and queue of the calling thread if it is a thread of a
+// WorkStealingExecutor.
+thread_local const WorkStealingExecutor* currentExecutor = nullptr;
+thread_local int32_t currentWorker = -1;
+} // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(int32_t numThreads) {
+  VELOX_CHECK_GT(numThreads, 0);
+  for (auto i = 0; i < numThreads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (auto i = 0; i < numThreads; ++i) {
+    threads_.emplace_back([this, i]() { run(i); });
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  {
+    std::lock_guard<std::mutex> l(sleepMutex_);
+    stop_ = true;
+  }
+  sleepCondition_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkStealingExecutor::add(folly::Func func) {
+  int32_t index = currentExecutor == this
+      ? currentWorker
+      : nextWorker_++ % workers_.size();
+  {
+    auto& worker = *workers_[index];
+    std::lock_guard<std::mutex> l(worker.mutex);
+    worker.queue.push_back(std::move(func));
+  }
+  // A thread that goes to sleep increments 'numSleeping_' and then checks
+  // 'numQueued_' under 'sleepMutex_', so that either it sees the new work
+  // or this sees it sleeping.
+  ++numQueued_;
+  if (numSleeping_ > 0) {
+    std::lock_guard<std::mutex> l(sleepMutex_);
+    sleepCondition_.notify_one();
+  }
+}
+
+bool WorkStealingExecutor::take(int32_t index, folly::Func& func) {
+  auto& worker = *workers_[index];
+  std::lock_guard<std::mutex> l(worker.mutex);
+  if (worker.queue.empty()) {
+    return false;
+  }
+  func = std::move(worker.queue.front());
+  worker.queue.pop_front();
+  --numQueued_;
+  return true;
+}
+
+bool WorkStealingExecutor::steal(int32_t index, folly::Func& func) {
+  for (auto i = 1; i < workers_.size(); ++i) {
+    if (take((index + i) % workers_.size(), func)) {
+      ++numStolen_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingExecutor::run(int32_t index) {
+  currentExecutor = this;
+  currentWorker = index;
+  for (;;) {
+    folly::Func func;
+    if (take(index, func) || steal(index, func)) {
+      try {
+        func();
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Exception in WorkStealingExecutor: " << e.what();
+      }
+      continue;
+    }
+    std::unique_lock<std::mutex> l(sleepMutex_);
+    ++numSleeping_;
+    sleepCondition_.wait(l, [&]() { return stop_ || numQueued_ > 0; });
+    --numSleeping_;
+    if (stop_ && numQueued_ == 0) {
+      return;
+    }
+  }
+}
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <folly/Executor.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace facebook::velox::exec {
+
+// Executor with a queue per thread. Work added from one of the threads of
+// 'this' goes to the queue of that thread, so that a Driver that yields or
+// is unblocked by a Driver on the same thread continues where its data is
+// in cache. Work added from other threads is spread round robin over the
+// queues. A thread with an empty queue takes work from the other queues
+// before it goes to sleep. Can be given to QueryCtx as its executor in
+// place of the process-wide Driver::executor().
+class WorkStealingExecutor : public folly::Executor {
+ public:
+  explicit WorkStealingExecutor(int32_t numThreads);
+
+  // Runs the queued work and joins the threads. Must not be called from a
+  // thread of 'this'.
+  ~WorkStealingExecutor() override;
+
+  void add(folly::Func func) override;
+
+  int32_t numThreads() const {
+    return workers_.size();
+  }
+
+  // Number of functions a thread took from the queue of another thread.
+  int64_t numStolen() const {
+    return numStolen_;
+  }
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<folly::Func> queue;
+  };
+
+  // Takes the first function in the queue of the worker at 'index'.
+  bool take(int32_t index, folly::Func& func);
+
+  // Takes the first function in the queue of another worker than 'index'.
+  bool steal(int32_t index, folly::Func& func);
+
+  void run(int32_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  // Number of functions in all queues.
+  std::atomic<int64_t> numQueued_{0};
+  std::atomic<int64_t> numStolen_{0};
+  std::atomic<uint32_t> nextWorker_{0};
+
+  // Idle threads wait on 'sleepCondition_'. 'numSleeping_' is checked
+  // without 'sleepMutex_' for the common case of no sleeping thread.
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCondition_;
+  std::atomic<int32_t> numSleeping_{0};
+  bool stop_{false};
+};
+
+} // namespace facebook::velox::exec
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fmt/format.h>
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "velox/exec/Exchange.h"
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/exec/tests/utils/QueryAssertions.h"
+#include "velox/serializers/PrestoSerializer.h"
+
+// Measures the shuffle of 1M rows of a number of column shapes. The SERDE
+// benchmarks serialize the vectors into Presto pages and deserialize them
+// again. They count one iteration per byte of the pages, so that folly
+// reports the bytes per second. The EXCHANGE benchmarks run a
+// PartitionedOutput in each of 4 producer Tasks, which partitions the rows
+// on the first column for a number of consumer Tasks that read them with an
+// Exchange. They count one iteration per row. The peak memory of the
+// PartitionedOutput and Exchange operators is printed after the benchmarks.
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+constexpr int32_t kNumVectors = 100;
+constexpr int32_t kRowsPerVector = 10'000;
+constexpr int32_t kNumRows = kNumVectors * kRowsPerVector;
+constexpr int32_t kNumProducers = 4;
+constexpr int32_t kNumDistinctStrings = 1'000;
+
+// Each shape has a BIGINT partitioning key in c0, followed by:
+enum class VectorShape {
+  // BIGINT and DOUBLE columns.
+  kFlat,
+  // A VARCHAR column of short strings and one of 40 character strings.
+  kStrings,
+  // Dictionaries over a BIGINT and a VARCHAR column, as produced by
+  // filters and joins.
+  kDictionary,
+  // ARRAY<BIGINT>, MAP<BIGINT, DOUBLE> and ROW<BIGINT, VARCHAR> columns.
+  kNested,
+};
+
+// Peak memory over the runs of an EXCHANGE benchmark.
+struct ExchangeStats {
+  uint64_t partitionedOutputBytes{0};
+  uint64_t exchangeBytes{0};
+};
+
+class ExchangeBenchmark : public OperatorTestBase {
+ public:
+  ExchangeBenchmark() {
+    OperatorTestBase::SetUpTestCase();
+    OperatorTestBase::SetUp();
+    for (auto i = 0; i < kNumDistinctStrings; ++i) {
+      shortStrings_.push_back(fmt::format("s{}", i));
+      longStrings_.push_back(fmt::format("{:0>40}", i * 7'919));
+    }
+  }
+
+  void TestBody() override {}
+
+  // Serializes the vectors of 'shape' and returns the serialized bytes.
+  unsigned serialize(VectorShape shape) {
+    folly::BenchmarkSuspender suspender;
+    prepare(shape);
+    suspender.dismiss();
+
+    uint64_t numBytes = 0;
+    for (const auto& vector : vectors_) {
+      numBytes += serializeVector(vector).size();
+    }
+    return numBytes;
+  }
+
+  // Deserializes the pages of 'shape' and returns their bytes.
+  unsigned deserialize(VectorShape shape) {
+    folly::BenchmarkSuspender suspender;
+    prepare(shape);
+    suspender.dismiss();
+
+    uint64_t numBytes = 0;
+    for (auto& page : pages_) {
+      ByteStream input;
+      ByteRange range{
+          reinterpret_cast<uint8_t*>(page.data()),
+          static_cast<int32_t>(page.size()),
+          0};
+      input.resetInput({range});
+      RowVectorPtr result;
+      serde_.deserialize(&input, pool_.get(), rowType_, &result);
+      numBytes += page.size();
+    }
+    return numBytes;
+  }
+
+  // Shuffles the vectors of 'shape' from 'kNumProducers' Tasks to
+  // 'numConsumers' Tasks and returns the number of rows. Each consumer
+  // counts its rows, which a TaskCursor gathers.
+  unsigned shuffle(
+      const std::string& name,
+      VectorShape shape,
+      int32_t numConsumers) {
+    folly::BenchmarkSuspender suspender;
+    prepare(shape);
+    std::vector<std::shared_ptr<const core::PlanNode>> producerPlans;
+    auto vectorsPerProducer = kNumVectors / kNumProducers;
+    for (auto i = 0; i < kNumProducers; ++i) {
+      std::vector<RowVectorPtr> vectors(
+          vectors_.begin() + i * vectorsPerProducer,
+          vectors_.begin() + (i + 1) * vectorsPerProducer);
+      producerPlans.push_back(PlanBuilder()
+                                  .values(vectors)
+                                  .partitionedOutput({0}, numConsumers)
+                                  .planNode());
+    }
+    auto consumerPlan = PlanBuilder()
+                            .exchange(rowType_)
+                            .singleAggregation({}, {"count(1)"})
+                            .partitionedOutput({}, 1)
+                            .planNode();
+    CursorParameters params;
+    params.planNode =
+        PlanBuilder().exchange(consumerPlan->outputType()).planNode();
+    suspender.dismiss();
+
+    std::vector<std::shared_ptr<Task>> producers;
+    std::vector<std::string> producerIds;
+    for (auto i = 0; i < kNumProducers; ++i) {
+      producerIds.push_back(makeTaskId("producer", i));
+      producers.push_back(makeTask(producerIds.back(), producerPlans[i], 0));
+      Task::start(producers.back(), 1);
+    }
+    std::vector<std::shared_ptr<Task>> consumers;
+    std::vector<std::string> consumerIds;
+    for (auto i = 0; i < numConsumers; ++i) {
+      consumerIds.push_back(makeTaskId("consumer", i));
+      consumers.push_back(makeTask(consumerIds.back(), consumerPlan, i));
+      Task::start(consumers.back(), 1);
+      addRemoteSplits(consumers.back().get(), producerIds);
+    }
+    bool noMoreSplits = false;
+    auto result = readCursor(params, [&](Task* task) {
+      if (!noMoreSplits) {
+        addRemoteSplits(task, consumerIds);
+        noMoreSplits = true;
+      }
+    });
+    int64_t numRows = 0;
+    for (const auto& vector : result.second) {
+      auto counts = vector->childAt(0)->asFlatVector<int64_t>();
+      for (auto i = 0; i < counts->size(); ++i) {
+        numRows += counts->valueAt(i);
+      }
+    }
+    VELOX_CHECK_EQ(numRows, kNumRows);
+
+    suspender.rehire();
+    recordStats(name, producers, consumers);
+    ++runId_;
+    return kNumRows;
+  }
+
+  void printStats() const {
+    std::cout << fmt::format(
+                     "{:<40}{:>20}{:>16}",
+                     "Peak bytes:",
+                     "PartitionedOutput",
+                     "Exchange")
+              << std::endl;
+    for (const auto& [name, stats] : stats_) {
+      std::cout << fmt::format(
+                       "{:<40}{:>20}{:>16}",
+                       name,
+                       stats.partitionedOutputBytes,
+                       stats.exchangeBytes)
+                << std::endl;
+    }
+  }
+
+ private:
+  // Makes the vectors and pages of 'shape' unless they are those of the
+  // previous run.
+  void prepare(VectorShape shape) {
+    if (shape_.has_value() && shape_.value() == shape) {
+      return;
+    }
+    shape_ = shape;
+    vectors_.clear();
+    pages_.clear();
+    for (auto i = 0; i < kNumVectors; ++i) {
+      vectors_.push_back(makeVector(shape, i * kRowsPerVector));
+    }
+    rowType_ = std::dynamic_pointer_cast<const RowType>(vectors_[0]->type());
+    for (const auto& vector : vectors_) {
+      pages_.push_back(serializeVector(vector));
+    }
+  }
+
+  RowVectorPtr makeVector(VectorShape shape, int32_t offset) {
+    auto value = [offset](vector_size_t row) -> int64_t {
+      return (int64_t{offset} + row) * 7'919 % kNumDistinctStrings;
+    };
+    auto shortString = [&](vector_size_t row) {
+      return StringView(shortStrings_[value(row)]);
+    };
+    auto longString = [&](vector_size_t row) {
+      return StringView(longStrings_[value(row)]);
+    };
+    std::vector<VectorPtr> children = {
+        makeFlatVector<int64_t>(kRowsPerVector, [offset](vector_size_t row) {
+          return (int64_t{offset} + row) * 104'729;
+        })};
+    switch (shape) {
+      case VectorShape::kFlat:
+        children.push_back(makeFlatVector<int64_t>(kRowsPerVector, value));
+        children.push_back(makeFlatVector<double>(
+            kRowsPerVector,
+            [&](vector_size_t row) { return value(row) * 0.1; }));
+        break;
+      case VectorShape::kStrings:
+        children.push_back(
+            makeFlatVector<StringView>(kRowsPerVector, shortString));
+        children.push_back(
+            makeFlatVector<StringView>(kRowsPerVector, longString));
+        break;
+      case VectorShape::kDictionary: {
+        // Every other row of base vectors of twice the size.
+        auto indices = makeIndices(
+            kRowsPerVector, [](vector_size_t row) { return row * 2; });
+        children.push_back(wrapInDictionary(
+            indices,
+            kRowsPerVector,
+            makeFlatVector<int64_t>(2 * kRowsPerVector, value)));
+        children.push_back(wrapInDictionary(
+            indices,
+            kRowsPerVector,
+            makeFlatVector<StringView>(2 * kRowsPerVector, longString)));
+        break;
+      }
+      case VectorShape::kNested:
+        children.push_back(makeArrayVector<int64_t>(
+            kRowsPerVector,
+            [&](vector_size_t row) { return value(row) % 5; },
+            [](vector_size_t row, vector_size_t index) {
+              return row + index;
+            }));
+        children.push_back(makeMapVector<int64_t, double>(
+            kRowsPerVector,
+            [&](vector_size_t row) { return value(row) % 3; },
+            [](vector_size_t index) { return index % 3; },
+            [](vector_size_t index) { return index * 0.1; }));
+        children.push_back(makeRowVector(
+            {makeFlatVector<int64_t>(kRowsPerVector, value),
+             makeFlatVector<StringView>(kRowsPerVector, shortString)}));
+        break;
+    }
+    return makeRowVector(children);
+  }
+
+  std::string serializeVector(const RowVectorPtr& vector) {
+    IndexRange range{0, vector->size()};
+    StreamArena arena(memory::MappedMemory::getInstance());
+    auto serializer = serde_.createSerializer(
+        std::dynamic_pointer_cast<const RowType>(vector->type()),
+        vector->size(),
+        &arena);
+    serializer->append(vector, folly::Range(&range, 1));
+    std::ostringstream out;
+    serializer->flush(&out);
+    return out.str();
+  }
+
+  std::string makeTaskId(const std::string& prefix, int32_t num) const {
+    return fmt::format("local://{}-{}-{}", prefix, runId_, num);
+  }
+
+  std::shared_ptr<Task> makeTask(
+      const std::string& taskId,
+      std::shared_ptr<const core::PlanNode> planNode,
+      int32_t destination) {
+    return std::make_shared<Task>(
+        taskId, std::move(planNode), destination, core::QueryCtx::create());
+  }
+
+  static void addRemoteSplits(
+      Task* task,
+      const std::vector<std::string>& remoteTaskIds) {
+    for (const auto& taskId : remoteTaskIds) {
+      task->addSplit(
+          "0", Split(std::make_shared<RemoteConnectorSplit>(taskId), -1));
+    }
+    task->noMoreSplits("0");
+  }
+
+  void recordStats(
+      const std::string& name,
+      const std::vector<std::shared_ptr<Task>>& producers,
+      const std::vector<std::shared_ptr<Task>>& consumers) {
+    auto peakBytes = [](const std::vector<std::shared_ptr<Task>>& tasks,
+                        const std::string& operatorType) {
+      uint64_t bytes = 0;
+      for (const auto& task : tasks) {
+        for (const auto& pipelineStats : task->taskStats().pipelineStats) {
+          for (const auto& stats : pipelineStats.operatorStats) {
+            if (stats.operatorType == operatorType) {
+              bytes += stats.memoryStats.peakTotalMemoryReservation;
+            }
+          }
+        }
+      }
+      return bytes;
+    };
+    auto it = std::find_if(stats_.begin(), stats_.end(), [&](auto& entry) {
+      return entry.first == name;
+    });
+    if (it == stats_.end()) {
+      stats_.emplace_back(name, ExchangeStats{});
+      it = stats_.end() - 1;
+    }
+    auto& exchangeStats = it->second;
+    exchangeStats.partitionedOutputBytes = std::max(
+        exchangeStats.partitionedOutputBytes,
+        peakBytes(producers, "PartitionedOutput"));
+    exchangeStats.exchangeBytes =
+        std::max(exchangeStats.exchangeBytes, peakBytes(consumers, "Exchange"));
+  }
+
+  serializer::presto::PrestoVectorSerde serde_;
+  std::vector<std::string> shortStrings_;
+  std::vector<std::string> longStrings_;
+  // The shape of 'vectors_' and 'pages_'.
+  std::optional<VectorShape> shape_;
+  std::vector<RowVectorPtr> vectors_;
+  // 'vectors_' serialized one page per vector.
+  std::vector<std::string> pages_;
+  RowTypePtr rowType_;
+  // Makes the Task ids of each run unique.
+  int32_t runId_{0};
+  // Stats of each EXCHANGE benchmark in the order of the first run.
+  std::vector<std::pair<std::string, ExchangeStats>> stats_;
+};
+
+std::unique_ptr<ExchangeBenchmark> benchmark;
+
+unsigned serialize(unsigned /*iters*/, VectorShape shape) {
+  return benchmark->serialize(shape);
+}
+
+unsigned deserialize(unsigned /*iters*/, VectorShape shape) {
+  return benchmark->deserialize(shape);
+}
+
+unsigned shuffle(
+    unsigned /*iters*/,
+    const std::string& name,
+    VectorShape shape,
+    int32_t numConsumers) {
+  return benchmark->shuffle(name, shape, numConsumers);
+}
+
+#define SERDE_BENCHMARK(name, shape)                   \
+  BENCHMARK_NAMED_PARAM_MULTI(                         \
+      serialize, SERIALIZE_##name, VectorShape::shape); \
+  BENCHMARK_NAMED_PARAM_MULTI(                         \
+      deserialize, DESERIALIZE_##name, VectorShape::shape)
+
+#define EXCHANGE_BENCHMARK(name, shape, numConsumers) \
+  BENCHMARK_NAMED_PARAM_MULTI(                        \
+      shuffle,                                        \
+      name,                                           \
+      #name,                                          \
+      VectorShape::shape,                             \
+      numConsumers)
+
+SERDE_BENCHMARK(FLAT, kFlat);
+SERDE_BENCHMARK(STRINGS, kStrings);
+SERDE_BENCHMARK(DICTIONARY, kDictionary);
+SERDE_BENCHMARK(NESTED, kNested);
+BENCHMARK_DRAW_LINE();
+
+EXCHANGE_BENCHMARK(EXCHANGE_FLAT_1, kFlat, 1);
+EXCHANGE_BENCHMARK(EXCHANGE_FLAT_4, kFlat, 4);
+EXCHANGE_BENCHMARK(EXCHANGE_FLAT_16, kFlat, 16);
+EXCHANGE_BENCHMARK(EXCHANGE_FLAT_64, kFlat, 64);
+EXCHANGE_BENCHMARK(EXCHANGE_STRINGS_4, kStrings, 4);
+EXCHANGE_BENCHMARK(EXCHANGE_STRINGS_64, kStrings, 64);
+EXCHANGE_BENCHMARK(EXCHANGE_DICTIONARY_4, kDictionary, 4);
+EXCHANGE_BENCHMARK(EXCHANGE_DICTIONARY_64, kDictionary, 64);
+EXCHANGE_BENCHMARK(EXCHANGE_NESTED_4, kNested, 4);
+EXCHANGE_BENCHMARK(EXCHANGE_NESTED_64, kNested, 64);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  benchmark = std::make_unique<ExchangeBenchmark>();
+  folly::runBenchmarks();
+  benchmark->printStats();
+  benchmark.reset();
+  return 0;
+}
@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fmt/format.h>
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/init/Init.h>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include "velox/exec/tests/utils/Cursor.h"
+#include "velox/exec/tests/utils/HiveConnectorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/exec/tests/utils/TempFilePath.h"
+
+// Runs an inner hash join of 2M probe rows with a build side of a number of
+// key shapes and sizes. Each benchmark counts one iteration per probe row,
+// so that folly reports the time per probe row and probe rows per second of
+// the whole query. The build and probe rows per second of the CPU time of
+// HashBuild and HashProbe are printed after the benchmarks.
+//
+// The build sizes range from 10K keys, whose table stays in the L2 cache,
+// over 1M keys, about the size of a last level cache, to 10M keys, about 10
+// times that. Each key shape runs at the sizes for which HashBuild picks
+// the hash mode in its name. The probe keys are random and match a build key
+// with a given percentage. Each build key has 'fanout' rows.
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+constexpr int32_t kProbeRows = 2'000'000;
+constexpr int32_t kRowsPerVector = 10'000;
+
+enum class KeyShape {
+  // One dense BIGINT key. kArray up to HashTable::kArrayHashMaxSize keys.
+  kArray,
+  // Two BIGINT keys that each have fewer than VectorHasher::kMaxDistinct
+  // values but whose distinct values multiply past kArrayHashMaxSize.
+  // kNormalizedKey from 1M keys.
+  kNormalizedKey,
+  // One sparse BIGINT key. kHash past VectorHasher::kMaxDistinct keys.
+  kHash,
+  // Two VARCHAR keys, the first a distinct non-inline string per key. kHash
+  // past VectorHasher::kMaxDistinct keys and kArray on value ids below.
+  kTwoVarchar,
+};
+
+enum class ProbeSource {
+  kValues,
+  // A TableScan that receives no dynamic filters, because a projection that
+  // is not an identity separates it from the join.
+  kScan,
+  // A TableScan that receives the dynamic filters of the join.
+  kScanWithDynamicFilter,
+};
+
+int32_t numKeyColumns(KeyShape shape) {
+  return shape == KeyShape::kArray || shape == KeyShape::kHash ? 1 : 2;
+}
+
+// The rows of the build and probe sides of a join. The key columns come
+// first, followed by a BIGINT payload.
+struct JoinData {
+  std::vector<RowVectorPtr> build;
+  std::vector<RowVectorPtr> probe;
+  // The probe rows in a DWRF file if the probe side is a TableScan.
+  std::shared_ptr<TempFilePath> probeFile;
+};
+
+// The rows and CPU time of HashBuild and HashProbe over the runs of a
+// benchmark.
+struct JoinStats {
+  uint64_t buildRows{0};
+  uint64_t buildNanos{0};
+  uint64_t probeRows{0};
+  uint64_t probeNanos{0};
+};
+
+class HashJoinBenchmark : public HiveConnectorTestBase {
+ public:
+  HashJoinBenchmark() {
+    HiveConnectorTestBase::SetUpTestCase();
+    HiveConnectorTestBase::SetUp();
+  }
+
+  ~HashJoinBenchmark() override {
+    data_ = JoinData{};
+    HiveConnectorTestBase::TearDown();
+  }
+
+  void TestBody() override {}
+
+  // Joins 'kProbeRows' probe rows with 'numKeys' build keys of 'fanout' rows
+  // each and returns the number of probe rows. 'matchPct' percent of the
+  // probe rows have a match. The data is made on the first run of 'name'.
+  unsigned run(
+      const std::string& name,
+      KeyShape shape,
+      int32_t numKeys,
+      int32_t fanout,
+      int32_t matchPct,
+      ProbeSource source) {
+    folly::BenchmarkSuspender suspender;
+    if (name != dataName_) {
+      data_ = JoinData{};
+      data_ = makeData(shape, numKeys, fanout, matchPct, source);
+      dataName_ = name;
+    }
+    CursorParameters params;
+    params.planNode = makePlan(shape, source);
+    suspender.dismiss();
+
+    TaskCursor cursor(params);
+    if (data_.probeFile) {
+      addSplit(cursor.task().get(), "0", makeHiveSplit(data_.probeFile->path));
+      cursor.task()->noMoreSplits("0");
+    }
+    uint64_t numRows = 0;
+    while (cursor.moveNext()) {
+      numRows += cursor.current()->size();
+    }
+    folly::doNotOptimizeAway(numRows);
+
+    suspender.rehire();
+    recordStats(name, cursor.task()->taskStats());
+    return kProbeRows;
+  }
+
+  void printStats() const {
+    std::cout << fmt::format(
+                     "{:<40}{:>16}{:>16}",
+                     "Rows per second of CPU time:",
+                     "build",
+                     "probe")
+              << std::endl;
+    for (const auto& [name, stats] : stats_) {
+      std::cout << fmt::format(
+                       "{:<40}{:>16.0f}{:>16.0f}",
+                       name,
+                       perSecond(stats.buildRows, stats.buildNanos),
+                       perSecond(stats.probeRows, stats.probeNanos))
+                << std::endl;
+    }
+  }
+
+ private:
+  static double perSecond(uint64_t rows, uint64_t nanos) {
+    return rows * 1e9 / std::max<uint64_t>(1, nanos);
+  }
+
+  // Returns the key columns of the keys with ordinals 'keys'. Ordinals of
+  // at least the number of build keys make keys that are not in the build.
+  std::vector<VectorPtr> makeKeys(
+      KeyShape shape,
+      const std::vector<int64_t>& keys) {
+    auto size = keys.size();
+    switch (shape) {
+      case KeyShape::kArray:
+        return {makeFlatVector<int64_t>(
+            size, [&](auto row) { return keys[row]; })};
+      case KeyShape::kNormalizedKey:
+        // The second key has 3000 values, so that 1M keys have 3M
+        // combinations of distinct values.
+        return {
+            makeFlatVector<int64_t>(
+                size, [&](auto row) { return keys[row] / 1'000; }),
+            makeFlatVector<int64_t>(size, [&](auto row) {
+              return keys[row] % 1'000 + keys[row] / 1'000 % 3 * 1'000;
+            })};
+      case KeyShape::kHash:
+        return {makeFlatVector<int64_t>(
+            size, [&](auto row) { return keys[row] * 1'000'003; })};
+      case KeyShape::kTwoVarchar:
+        return {
+            makeFlatVector<StringView>(
+                size,
+                [&](auto row) {
+                  return StringView(
+                      fmt::format("customer#{:012}", keys[row]));
+                }),
+            makeFlatVector<StringView>(size, [&](auto row) {
+              return StringView(fmt::format("{}", keys[row] % 100));
+            })};
+    }
+    VELOX_UNREACHABLE();
+  }
+
+  // Returns vectors of 'keys.size()' rows with the key columns of 'keys'
+  // named 'prefix'0, 'prefix'1... and a payload column named 'prefix'p.
+  std::vector<RowVectorPtr> makeRows(
+      KeyShape shape,
+      const std::vector<int64_t>& keys,
+      const std::string& prefix) {
+    std::vector<RowVectorPtr> result;
+    for (auto offset = 0; offset < keys.size(); offset += kRowsPerVector) {
+      std::vector<int64_t> vectorKeys(
+          keys.begin() + offset,
+          keys.begin() +
+              std::min<size_t>(offset + kRowsPerVector, keys.size()));
+      auto columns = makeKeys(shape, vectorKeys);
+      std::vector<std::string> names;
+      for (auto i = 0; i < columns.size(); ++i) {
+        names.push_back(fmt::format("{}{}", prefix, i));
+      }
+      names.push_back(prefix + "p");
+      columns.push_back(makeFlatVector<int64_t>(
+          vectorKeys.size(), [&](auto row) { return offset + row; }));
+      result.push_back(makeRowVector(names, columns));
+    }
+    return result;
+  }
+
+  JoinData makeData(
+      KeyShape shape,
+      int32_t numKeys,
+      int32_t fanout,
+      int32_t matchPct,
+      ProbeSource source) {
+    // The build rows come in a scattered order of keys. 7919 is a prime
+    // that divides none of the build sizes.
+    int64_t numBuildRows = static_cast<int64_t>(numKeys) * fanout;
+    std::vector<int64_t> buildKeys(numBuildRows);
+    for (int64_t i = 0; i < numBuildRows; ++i) {
+      buildKeys[i] = i * 7'919 % numBuildRows / fanout;
+    }
+    folly::Random::DefaultGenerator rng;
+    rng.seed(1);
+    int64_t probeRange = static_cast<int64_t>(numKeys) * 100 / matchPct;
+    std::vector<int64_t> probeKeys(kProbeRows);
+    for (auto& key : probeKeys) {
+      key = folly::Random::rand64(probeRange, rng);
+    }
+
+    JoinData data;
+    data.build = makeRows(shape, buildKeys, "b");
+    data.probe = makeRows(shape, probeKeys, "p");
+    if (source != ProbeSource::kValues) {
+      VELOX_CHECK(
+          shape != KeyShape::kTwoVarchar,
+          "A TableScan probe needs BIGINT keys");
+      data.probeFile = TempFilePath::create();
+      writeToFile(data.probeFile->path, "probe", data.probe);
+    }
+    return data;
+  }
+
+  std::shared_ptr<const core::PlanNode> makePlan(
+      KeyShape shape,
+      ProbeSource source) {
+    auto numKeys = numKeyColumns(shape);
+    std::vector<ChannelIndex> keys(numKeys);
+    std::iota(keys.begin(), keys.end(), 0);
+    auto build = PlanBuilder(100).values(data_.build).planNode();
+
+    PlanBuilder probe(0);
+    if (source == ProbeSource::kValues) {
+      probe.values(data_.probe);
+    } else {
+      const auto& probeType = data_.probe[0]->type();
+      probe.tableScan(std::dynamic_pointer_cast<const RowType>(probeType));
+      if (source == ProbeSource::kScan) {
+        std::vector<std::string> projections;
+        for (auto i = 0; i < numKeys; ++i) {
+          projections.push_back(fmt::format("p{} + 0", i));
+        }
+        projections.push_back("pp");
+        probe.project(projections);
+      }
+    }
+    // The output is the payloads of both sides.
+    ChannelIndex probePayload = numKeys;
+    ChannelIndex buildPayload = 2 * numKeys + 1;
+    return probe.hashJoin(keys, keys, build, "", {probePayload, buildPayload})
+        .planNode();
+  }
+
+  void recordStats(const std::string& name, const TaskStats& taskStats) {
+    auto it = std::find_if(stats_.begin(), stats_.end(), [&](auto& entry) {
+      return entry.first == name;
+    });
+    if (it == stats_.end()) {
+      stats_.emplace_back(name, JoinStats{});
+      it = stats_.end() - 1;
+    }
+    auto& joinStats = it->second;
+    for (const auto& pipelineStats : taskStats.pipelineStats) {
+      for (const auto& stats : pipelineStats.operatorStats) {
+        auto cpuNanos = stats.addInputTiming.cpuNanos +
+            stats.getOutputTiming.cpuNanos + stats.finishTiming.cpuNanos;
+        if (stats.operatorType == "HashBuild") {
+          joinStats.buildRows += stats.inputPositions;
+          joinStats.buildNanos += cpuNanos;
+        } else if (stats.operatorType == "HashProbe") {
+          joinStats.probeRows += stats.inputPositions;
+          joinStats.probeNanos += cpuNanos;
+        }
+      }
+    }
+  }
+
+  // The data of the benchmark named 'dataName_'. Made again when the next
+  // benchmark starts, so that at most one build side is in memory.
+  std::string dataName_;
+  JoinData data_;
+  // Stats of each benchmark in the order of the first run.
+  std::vector<std::pair<std::string, JoinStats>> stats_;
+};
+
+std::unique_ptr<HashJoinBenchmark> benchmark;
+
+unsigned hashJoin(
+    unsigned /*iters*/,
+    const std::string& name,
+    KeyShape shape,
+    int32_t numKeys,
+    int32_t fanout,
+    int32_t matchPct,
+    ProbeSource source) {
+  return benchmark->run(name, shape, numKeys, fanout, matchPct, source);
+}
+
+#define JOIN_BENCHMARK(name, shape, numKeys, fanout, matchPct, source) \
+  BENCHMARK_NAMED_PARAM_MULTI(                                         \
+      hashJoin,                                                        \
+      name,                                                            \
+      #name,                                                           \
+      KeyShape::shape,                                                 \
+      numKeys,                                                         \
+      fanout,                                                          \
+      matchPct,                                                        \
+      ProbeSource::source)
+
+// Build sizes and match rates per hash mode.
+JOIN_BENCHMARK(ARRAY_10K, kArray, 10'000, 1, 100, kValues);
+JOIN_BENCHMARK(ARRAY_1M, kArray, 1'000'000, 1, 100, kValues);
+JOIN_BENCHMARK(ARRAY_1M_MATCH_10, kArray, 1'000'000, 1, 10, kValues);
+JOIN_BENCHMARK(NORMALIZED_1M, kNormalizedKey, 1'000'000, 1, 100, kValues);
+JOIN_BENCHMARK(NORMALIZED_10M, kNormalizedKey, 10'000'000, 1, 100, kValues);
+JOIN_BENCHMARK(
+    NORMALIZED_1M_MATCH_10,
+    kNormalizedKey,
+    1'000'000,
+    1,
+    10,
+    kValues);
+JOIN_BENCHMARK(HASH_1M, kHash, 1'000'000, 1, 100, kValues);
+JOIN_BENCHMARK(HASH_10M, kHash, 10'000'000, 1, 100, kValues);
+JOIN_BENCHMARK(HASH_1M_MATCH_10, kHash, 1'000'000, 1, 10, kValues);
+BENCHMARK_DRAW_LINE();
+
+// Duplicate build keys.
+JOIN_BENCHMARK(ARRAY_1M_FANOUT_4, kArray, 1'000'000, 4, 100, kValues);
+JOIN_BENCHMARK(
+    NORMALIZED_1M_FANOUT_4,
+    kNormalizedKey,
+    1'000'000,
+    4,
+    100,
+    kValues);
+JOIN_BENCHMARK(HASH_1M_FANOUT_4, kHash, 1'000'000, 4, 100, kValues);
+BENCHMARK_DRAW_LINE();
+
+// Multi-key string joins.
+JOIN_BENCHMARK(VARCHAR_10K, kTwoVarchar, 10'000, 1, 100, kValues);
+JOIN_BENCHMARK(VARCHAR_1M, kTwoVarchar, 1'000'000, 1, 100, kValues);
+JOIN_BENCHMARK(VARCHAR_1M_MATCH_10, kTwoVarchar, 1'000'000, 1, 10, kValues);
+BENCHMARK_DRAW_LINE();
+
+// Probes from a TableScan without and with dynamic filters.
+JOIN_BENCHMARK(ARRAY_1M_MATCH_10_SCAN, kArray, 1'000'000, 1, 10, kScan);
+JOIN_BENCHMARK(
+    ARRAY_1M_MATCH_10_SCAN_FILTER,
+    kArray,
+    1'000'000,
+    1,
+    10,
+    kScanWithDynamicFilter);
+JOIN_BENCHMARK(
+    NORMALIZED_1M_MATCH_10_SCAN,
+    kNormalizedKey,
+    1'000'000,
+    1,
+    10,
+    kScan);
+JOIN_BENCHMARK(
+    NORMALIZED_1M_MATCH_10_SCAN_FILTER,
+    kNormalizedKey,
+    1'000'000,
+    1,
+    10,
+    kScanWithDynamicFilter);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  benchmark = std::make_unique<HashJoinBenchmark>();
+  folly::runBenchmarks();
+  benchmark->printStats();
+  benchmark.reset();
+  return 0;
+}
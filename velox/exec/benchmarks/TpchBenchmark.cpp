@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fmt/format.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include <iostream>
+#include <string>
+
+#if __has_include("filesystem")
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+#include "velox/common/time/Timer.h"
+#include "velox/connectors/hive/HiveConnectorSplit.h"
+#include "velox/duckdb/conversion/DuckWrapper.h"
+#include "velox/dwio/dwrf/writer/Writer.h"
+#include "velox/exec/benchmarks/TpchQueryBuilder.h"
+#include "velox/exec/tests/utils/HiveConnectorTestBase.h"
+#include "velox/exec/tests/utils/QueryAssertions.h"
+
+#ifdef VELOX_ENABLE_PARQUET
+#include "velox/dwio/parquet/reader/ParquetReader.h"
+#include "velox/external/duckdb/duckdb.hpp"
+#include "velox/external/duckdb/tpch/include/tpch-extension.hpp"
+
+namespace duckdb {
+// Defined in the Parquet amalgamation, which has no header declaring it.
+class ParquetExtension : public Extension {
+ public:
+  void Load(DuckDB& db) override;
+};
+} // namespace duckdb
+#endif
+
+// Runs the TPC-H queries on data generated by DuckDB at --scale_factor. The
+// tables are written once under --data_path in DWRF or Parquet and reused
+// by later runs. Each query runs --num_repeats times with --num_drivers
+// Drivers per pipeline. After each run, the wall time, the CPU time and the
+// peak memory of the query are printed, followed by the OperatorStats of
+// each operator if --print_operator_stats is set.
+
+DEFINE_string(
+    data_path,
+    "",
+    "Directory of the tables, one subdirectory per table. Missing tables "
+    "are generated. Defaults to a directory under the system temporary "
+    "directory named after the format and the scale factor.");
+DEFINE_string(
+    data_format,
+    "dwrf",
+    "File format of the tables: dwrf or parquet");
+DEFINE_double(scale_factor, 0.1, "TPC-H scale factor of the generated data");
+DEFINE_int32(num_drivers, 4, "Number of Drivers per pipeline");
+DEFINE_int32(run_query, 0, "Query to run, or 0 to run all the queries");
+DEFINE_int32(num_repeats, 1, "Number of times to run each query");
+DEFINE_int64(
+    rows_per_file,
+    1'000'000,
+    "Number of rows in each generated file of a table");
+DEFINE_bool(
+    print_operator_stats,
+    true,
+    "Print the OperatorStats of each operator after each run");
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+dwio::common::FileFormat toFileFormat(const std::string& format) {
+  if (format == "dwrf") {
+    return dwio::common::FileFormat::ORC;
+  }
+  if (format == "parquet") {
+#ifdef VELOX_ENABLE_PARQUET
+    return dwio::common::FileFormat::PARQUET;
+#else
+    VELOX_USER_FAIL("Parquet requires building with VELOX_ENABLE_PARQUET");
+#endif
+  }
+  VELOX_USER_FAIL("Unknown data format: {}", format);
+}
+
+// Returns the DuckDB query that reads 'table' with the column types that
+// the plans expect.
+std::string selectSql(const std::string& table) {
+  const auto& type = TpchQueryBuilder::getRowType(table);
+  std::string columns;
+  for (auto i = 0; i < type->size(); ++i) {
+    columns += fmt::format(
+        "{}cast({} as {}) as {}",
+        i == 0 ? "" : ", ",
+        type->nameOf(i),
+        type->childAt(i)->toString(),
+        type->nameOf(i));
+  }
+  return fmt::format("SELECT {} FROM {}", columns, table);
+}
+
+std::string nanosToString(uint64_t nanos) {
+  return fmt::format("{:.3f}ms", nanos / 1'000'000.0);
+}
+
+std::string timingToString(const CpuWallTiming& timing) {
+  return fmt::format(
+      "{} calls, wall {}, cpu {}",
+      timing.count,
+      nanosToString(timing.wallNanos),
+      nanosToString(timing.cpuNanos));
+}
+
+class TpchBenchmark : public HiveConnectorTestBase {
+ public:
+  TpchBenchmark() {
+    HiveConnectorTestBase::SetUpTestCase();
+    HiveConnectorTestBase::SetUp();
+#ifdef VELOX_ENABLE_PARQUET
+    parquet::registerParquetReaderFactory();
+#endif
+  }
+
+  ~TpchBenchmark() override {
+#ifdef VELOX_ENABLE_PARQUET
+    parquet::unregisterParquetReaderFactory();
+#endif
+    HiveConnectorTestBase::TearDown();
+  }
+
+  void TestBody() override {}
+
+  // Generates the tables that are missing under 'dataPath'.
+  void generateData(
+      const std::string& dataPath,
+      dwio::common::FileFormat format) {
+    std::vector<std::string> missingTables;
+    for (const auto& table : TpchQueryBuilder::tableNames()) {
+      auto tablePath = fs::path(dataPath) / table;
+      if (!fs::is_directory(tablePath) || fs::is_empty(tablePath)) {
+        fs::create_directories(tablePath);
+        missingTables.push_back(table);
+      }
+    }
+    if (missingTables.empty()) {
+      return;
+    }
+    std::cout << fmt::format(
+                     "Generating TPC-H data at scale factor {} in {}",
+                     FLAGS_scale_factor,
+                     dataPath)
+              << std::endl;
+    if (format == dwio::common::FileFormat::PARQUET) {
+      writeParquet(dataPath, missingTables);
+    } else {
+      writeDwrf(dataPath, missingTables);
+    }
+  }
+
+  // Runs query 'queryId' and prints its stats.
+  void run(const TpchQueryBuilder& queryBuilder, int32_t queryId) {
+    auto tpchPlan = queryBuilder.getQueryPlan(queryId);
+    CursorParameters params;
+    params.planNode = tpchPlan.plan;
+    params.maxDrivers = FLAGS_num_drivers;
+    bool noMoreSplits = false;
+    auto addSplits = [&](Task* task) {
+      if (noMoreSplits) {
+        return;
+      }
+      for (const auto& [planNodeId, files] : tpchPlan.dataFiles) {
+        for (const auto& file : files) {
+          addConnectorSplit(
+              task,
+              planNodeId,
+              std::make_shared<connector::hive::HiveConnectorSplit>(
+                  kHiveConnectorId, "file:" + file, tpchPlan.dataFileFormat));
+        }
+        task->noMoreSplits(planNodeId);
+      }
+      noMoreSplits = true;
+    };
+
+    auto startMicros = getCurrentTimeMicro();
+    auto [cursor, results] = readCursor(params, addSplits);
+    auto wallMicros = getCurrentTimeMicro() - startMicros;
+
+    uint64_t numRows = 0;
+    for (const auto& result : results) {
+      numRows += result->size();
+    }
+    // The Task has no memory tracker of its own, so the peak of the query is
+    // approximated by the sum of the peaks of its operators.
+    uint64_t cpuNanos = 0;
+    uint64_t peakBytes = 0;
+    auto taskStats = cursor->task()->taskStats();
+    for (const auto& pipelineStats : taskStats.pipelineStats) {
+      for (const auto& stats : pipelineStats.operatorStats) {
+        cpuNanos += stats.addInputTiming.cpuNanos +
+            stats.getOutputTiming.cpuNanos + stats.finishTiming.cpuNanos;
+        peakBytes += stats.memoryStats.peakTotalMemoryReservation;
+      }
+    }
+    std::cout << fmt::format(
+                     "Q{}: {} rows, wall {}, cpu {}, peak memory {}MB",
+                     queryId,
+                     numRows,
+                     nanosToString(wallMicros * 1'000),
+                     nanosToString(cpuNanos),
+                     peakBytes >> 20)
+              << std::endl;
+    if (FLAGS_print_operator_stats) {
+      printOperatorStats(taskStats);
+    }
+  }
+
+ private:
+  static void printOperatorStats(const TaskStats& taskStats) {
+    for (auto i = 0; i < taskStats.pipelineStats.size(); ++i) {
+      std::cout << fmt::format("  Pipeline {}:", i) << std::endl;
+      for (const auto& stats : taskStats.pipelineStats[i].operatorStats) {
+        std::cout << fmt::format(
+                         "    {} {}: input {} rows, output {} rows, "
+                         "raw input {} bytes, peak memory {} bytes",
+                         stats.operatorType,
+                         stats.planNodeId,
+                         stats.inputPositions,
+                         stats.outputPositions,
+                         stats.rawInputBytes,
+                         stats.memoryStats.peakTotalMemoryReservation)
+                  << std::endl;
+        std::cout << fmt::format(
+                         "      addInput: {}; getOutput: {}; finish: {}; "
+                         "blocked wall {}",
+                         timingToString(stats.addInputTiming),
+                         timingToString(stats.getOutputTiming),
+                         timingToString(stats.finishTiming),
+                         nanosToString(stats.blockedWallNanos))
+                  << std::endl;
+      }
+    }
+  }
+
+  // Reads the tables from DuckDB and writes them with the DWRF writer,
+  // starting a new file every --rows_per_file rows.
+  void writeDwrf(
+      const std::string& dataPath,
+      const std::vector<std::string>& tables) {
+    auto queryCtx = core::QueryCtx::create();
+    core::ExecCtx execCtx(pool_.get(), queryCtx.get());
+    duckdb::DuckDBWrapper db(&execCtx);
+    checkDuckResult(
+        *db.execute(fmt::format("CALL dbgen(sf={})", FLAGS_scale_factor)));
+    for (const auto& table : tables) {
+      auto result = db.execute(selectSql(table));
+      checkDuckResult(*result);
+      std::unique_ptr<dwrf::Writer> writer;
+      int32_t numFiles = 0;
+      int64_t numRowsInFile = 0;
+      while (result->next()) {
+        auto vector = result->getVector();
+        if (!writer) {
+          dwrf::WriterOptions options;
+          options.config = std::make_shared<dwrf::Config>();
+          options.schema = TpchQueryBuilder::getRowType(table);
+          auto path = fs::path(dataPath) / table /
+              fmt::format("{}-{}.dwrf", table, numFiles++);
+          writer = std::make_unique<dwrf::Writer>(
+              options,
+              std::make_unique<dwio::common::FileSink>(path.string()),
+              pool_->addChild(table, std::numeric_limits<int64_t>::max()));
+        }
+        writer->write(vector);
+        numRowsInFile += vector->size();
+        if (numRowsInFile >= FLAGS_rows_per_file) {
+          writer->close();
+          writer.reset();
+          numRowsInFile = 0;
+        }
+      }
+      if (writer) {
+        writer->close();
+      }
+    }
+  }
+
+  static void checkDuckResult(duckdb::DuckResult& result) {
+    VELOX_CHECK(result.success(), "{}", result.errorMessage());
+  }
+
+#ifdef VELOX_ENABLE_PARQUET
+  // Velox has no Parquet writer, so DuckDB writes the Parquet files. Each
+  // file has --rows_per_file consecutive rows of the table.
+  static void writeParquet(
+      const std::string& dataPath,
+      const std::vector<std::string>& tables) {
+    ::duckdb::DuckDB db(nullptr);
+    db.LoadExtension<::duckdb::TPCHExtension>();
+    db.LoadExtension<::duckdb::ParquetExtension>();
+    ::duckdb::Connection connection(db);
+    auto query = [&](const std::string& sql) {
+      auto result = connection.Query(sql);
+      VELOX_CHECK(result->success, "{}", result->error);
+      return result;
+    };
+    query(fmt::format("CALL dbgen(sf={})", FLAGS_scale_factor));
+    for (const auto& table : tables) {
+      auto numRows = query(fmt::format("SELECT count(*) FROM {}", table))
+                         ->GetValue(0, 0)
+                         .GetValue<int64_t>();
+      for (int64_t start = 0, file = 0; start < numRows;
+           start += FLAGS_rows_per_file, ++file) {
+        auto path = fs::path(dataPath) / table /
+            fmt::format("{}-{}.parquet", table, file);
+        query(fmt::format(
+            "COPY ({} WHERE rowid >= {} AND rowid < {}) TO '{}' "
+            "(FORMAT PARQUET)",
+            selectSql(table),
+            start,
+            start + FLAGS_rows_per_file,
+            path.string()));
+      }
+    }
+  }
+#else
+  static void writeParquet(
+      const std::string& /*dataPath*/,
+      const std::vector<std::string>& /*tables*/) {
+    VELOX_UNREACHABLE();
+  }
+#endif
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  auto format = toFileFormat(FLAGS_data_format);
+  auto dataPath = FLAGS_data_path;
+  if (dataPath.empty()) {
+    auto name = fmt::format(
+        "velox_tpch_{}_sf{}", FLAGS_data_format, FLAGS_scale_factor);
+    dataPath = (fs::temp_directory_path() / name).string();
+  }
+  VELOX_CHECK(
+      FLAGS_run_query >= 0 && FLAGS_run_query <= TpchQueryBuilder::kNumQueries,
+      "No TPC-H query {}",
+      FLAGS_run_query);
+
+  auto benchmark = std::make_unique<TpchBenchmark>();
+  benchmark->generateData(dataPath, format);
+  TpchQueryBuilder queryBuilder(format, FLAGS_scale_factor);
+  queryBuilder.initialize(dataPath);
+  for (auto queryId = 1; queryId <= TpchQueryBuilder::kNumQueries; ++queryId) {
+    if (FLAGS_run_query != 0 && queryId != FLAGS_run_query) {
+      continue;
+    }
+    for (auto i = 0; i < FLAGS_num_repeats; ++i) {
+      benchmark->run(queryBuilder, queryId);
+    }
+  }
+  benchmark.reset();
+  return 0;
+}
@@ -0,0 +1,1508 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/benchmarks/TpchQueryBuilder.h"
+
+#include <algorithm>
+
+#if __has_include("filesystem")
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+#include "velox/connectors/hive/HiveConnector.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+
+using namespace facebook::velox::connector::hive;
+
+namespace facebook::velox::exec::test {
+
+namespace {
+
+// Plan node ids are numbered from a multiple of this in each PlanBuilder of
+// a query, so that the ids are unique in the plan.
+constexpr int32_t kNodeIdsPerBuilder = 1000;
+
+const core::SortOrder kAsc(true, false);
+const core::SortOrder kDesc(false, false);
+
+std::vector<ChannelIndex> channels(
+    const RowTypePtr& type,
+    const std::vector<std::string>& names) {
+  std::vector<ChannelIndex> result;
+  result.reserve(names.size());
+  for (const auto& name : names) {
+    result.push_back(type->getChildIdx(name));
+  }
+  return result;
+}
+
+// Returns the channels of the columns 'names' in the output of 'plan'.
+std::vector<ChannelIndex> channels(
+    const PlanBuilder& plan,
+    const std::vector<std::string>& names) {
+  return channels(plan.planNode()->outputType(), names);
+}
+
+// Returns the channels of the columns 'names' in the concatenation of the
+// outputs of 'left' and 'right', as the join nodes expect.
+std::vector<ChannelIndex> joinChannels(
+    const PlanBuilder& left,
+    const PlanBuilder& right,
+    const std::vector<std::string>& names) {
+  const auto& leftType = left.planNode()->outputType();
+  const auto& rightType = right.planNode()->outputType();
+  std::vector<ChannelIndex> result;
+  result.reserve(names.size());
+  for (const auto& name : names) {
+    if (auto index = leftType->getChildIdxIfExists(name)) {
+      result.push_back(*index);
+    } else {
+      result.push_back(leftType->size() + rightType->getChildIdx(name));
+    }
+  }
+  return result;
+}
+
+// Joins 'probe' with 'build' on 'probeKeys' = 'buildKeys'. The result has
+// the columns 'output' of either side. Semi and anti joins may only output
+// columns of 'probe'.
+void hashJoin(
+    PlanBuilder& probe,
+    const std::vector<std::string>& probeKeys,
+    const PlanBuilder& build,
+    const std::vector<std::string>& buildKeys,
+    const std::vector<std::string>& output,
+    core::JoinType joinType = core::JoinType::kInner,
+    const std::string& filter = "") {
+  probe.hashJoin(
+      channels(probe, probeKeys),
+      channels(build, buildKeys),
+      build.planNode(),
+      filter,
+      joinChannels(probe, build, output),
+      joinType);
+}
+
+void crossJoin(
+    PlanBuilder& probe,
+    const PlanBuilder& build,
+    const std::vector<std::string>& output) {
+  probe.crossJoin(build.planNode(), joinChannels(probe, build, output));
+}
+
+// Renames the grouping keys and the aggregates of the aggregation at the
+// root of 'plan' to 'keys' followed by 'names'.
+void nameAggregates(
+    PlanBuilder& plan,
+    const std::vector<std::string>& keys,
+    const std::vector<std::string>& names) {
+  auto projections = keys;
+  auto outputNames = keys;
+  for (auto i = 0; i < names.size(); ++i) {
+    projections.push_back(fmt::format("a{}", i));
+    outputNames.push_back(names[i]);
+  }
+  plan.project(projections, outputNames);
+}
+
+// Aggregates 'plan' in place. Used when 'plan' runs in a single Driver.
+void singleAggregate(
+    PlanBuilder& plan,
+    const std::vector<std::string>& keys,
+    const std::vector<std::string>& aggregates,
+    const std::vector<std::string>& names) {
+  VELOX_CHECK_EQ(aggregates.size(), names.size());
+  plan.singleAggregation(channels(plan, keys), aggregates);
+  nameAggregates(plan, keys, names);
+}
+
+void orderBy(
+    PlanBuilder& plan,
+    const std::vector<std::string>& keys,
+    const std::vector<core::SortOrder>& orders) {
+  plan.orderBy(channels(plan, keys), orders, false);
+}
+
+void topN(
+    PlanBuilder& plan,
+    const std::vector<std::string>& keys,
+    const std::vector<core::SortOrder>& orders,
+    int32_t count) {
+  plan.topN(channels(plan, keys), orders, count, false);
+}
+
+} // namespace
+
+// The state of building the plan of one query.
+class TpchQueryBuilder::PlanContext {
+ public:
+  explicit PlanContext(const TpchQueryBuilder& builder) : builder_(builder) {}
+
+  // Returns a PlanBuilder whose node ids do not collide with those of the
+  // other PlanBuilders of the query.
+  PlanBuilder plan() {
+    return PlanBuilder(kNodeIdsPerBuilder * numPlans_++);
+  }
+
+  // Returns a plan that scans 'columns' of 'table'. The columns are named
+  // 'outputNames' if given, so that a query can scan a table more than once.
+  PlanBuilder scan(
+      const std::string& table,
+      const std::vector<std::string>& columns,
+      const std::vector<std::string>& outputNames = {}) {
+    const auto& names = outputNames.empty() ? columns : outputNames;
+    VELOX_CHECK_EQ(names.size(), columns.size());
+    const auto& tableType = getRowType(table);
+    std::vector<TypePtr> types;
+    std::unordered_map<std::string, std::shared_ptr<connector::ColumnHandle>>
+        assignments;
+    for (auto i = 0; i < columns.size(); ++i) {
+      const auto& type = tableType->findChild(columns[i]);
+      types.push_back(type);
+      assignments[names[i]] = std::make_shared<HiveColumnHandle>(
+          columns[i], HiveColumnHandle::ColumnType::kRegular, type);
+    }
+    auto files = builder_.tableFiles_.find(table);
+    VELOX_CHECK(
+        files != builder_.tableFiles_.end(), "No data files for {}", table);
+
+    auto result = plan();
+    result.tableScan(
+        ROW(std::vector<std::string>(names), std::move(types)),
+        std::make_shared<HiveTableHandle>(true, SubfieldFilters{}, nullptr),
+        assignments);
+    dataFiles_[result.planNode()->id()] = files->second;
+    return result;
+  }
+
+  // Returns a plan that gathers the rows of 'source' into one Driver.
+  PlanBuilder gather(const PlanBuilder& source) {
+    auto result = plan();
+    result.localPartition({}, {source.planNode()});
+    return result;
+  }
+
+  // Aggregates 'source' in partial aggregations in its Drivers and a final
+  // aggregation in one Driver. 'aggregates' are calls of functions on
+  // columns, e.g. sum(c0). The result has the grouping keys followed by the
+  // aggregates named 'names'.
+  PlanBuilder aggregate(
+      PlanBuilder& source,
+      const std::vector<std::string>& keys,
+      const std::vector<std::string>& aggregates,
+      const std::vector<std::string>& names) {
+    VELOX_CHECK_EQ(aggregates.size(), names.size());
+    source.partialAggregation(channels(source, keys), aggregates);
+    std::vector<std::string> finalAggregates;
+    finalAggregates.reserve(aggregates.size());
+    for (auto i = 0; i < aggregates.size(); ++i) {
+      const auto& aggregate = aggregates[i];
+      finalAggregates.push_back(fmt::format(
+          "{}(a{})", aggregate.substr(0, aggregate.find('(')), i));
+    }
+    auto result = gather(source);
+    result.finalAggregation(channels(result, keys), finalAggregates);
+    nameAggregates(result, keys, names);
+    return result;
+  }
+
+  // Keeps the first 'count' rows of 'source' in the order of 'keys'. Each
+  // Driver of 'source' keeps its first rows, which are then merged in one
+  // Driver.
+  PlanBuilder topN(
+      PlanBuilder& source,
+      const std::vector<std::string>& keys,
+      const std::vector<core::SortOrder>& orders,
+      int32_t count) {
+    source.topN(channels(source, keys), orders, count, true);
+    auto result = gather(source);
+    test::topN(result, keys, orders, count);
+    return result;
+  }
+
+  TpchPlan finish(const PlanBuilder& root) {
+    return TpchPlan{root.planNode(), std::move(dataFiles_), builder_.format_};
+  }
+
+ private:
+  const TpchQueryBuilder& builder_;
+  int32_t numPlans_{0};
+  std::unordered_map<core::PlanNodeId, std::vector<std::string>> dataFiles_;
+};
+
+void TpchQueryBuilder::initialize(const std::string& dataPath) {
+  for (const auto& table : tableNames()) {
+    auto tablePath = fs::path(dataPath) / table;
+    std::vector<std::string> files;
+    if (fs::is_directory(tablePath)) {
+      for (const auto& entry : fs::directory_iterator(tablePath)) {
+        if (fs::is_regular_file(entry.path())) {
+          files.push_back(entry.path().string());
+        }
+      }
+    }
+    VELOX_CHECK(!files.empty(), "No data files in {}", tablePath.string());
+    std::sort(files.begin(), files.end());
+    tableFiles_[table] = std::move(files);
+  }
+}
+
+// static
+const std::vector<std::string>& TpchQueryBuilder::tableNames() {
+  static const std::vector<std::string> kTableNames = {
+      "lineitem",
+      "orders",
+      "customer",
+      "part",
+      "partsupp",
+      "supplier",
+      "nation",
+      "region"};
+  return kTableNames;
+}
+
+// static
+const RowTypePtr& TpchQueryBuilder::getRowType(const std::string& table) {
+  static const std::unordered_map<std::string, RowTypePtr> kRowTypes = {
+      {"lineitem",
+       ROW({{"l_orderkey", BIGINT()},
+            {"l_partkey", BIGINT()},
+            {"l_suppkey", BIGINT()},
+            {"l_linenumber", BIGINT()},
+            {"l_quantity", DOUBLE()},
+            {"l_extendedprice", DOUBLE()},
+            {"l_discount", DOUBLE()},
+            {"l_tax", DOUBLE()},
+            {"l_returnflag", VARCHAR()},
+            {"l_linestatus", VARCHAR()},
+            {"l_shipdate", VARCHAR()},
+            {"l_commitdate", VARCHAR()},
+            {"l_receiptdate", VARCHAR()},
+            {"l_shipinstruct", VARCHAR()},
+            {"l_shipmode", VARCHAR()},
+            {"l_comment", VARCHAR()}})},
+      {"orders",
+       ROW({{"o_orderkey", BIGINT()},
+            {"o_custkey", BIGINT()},
+            {"o_orderstatus", VARCHAR()},
+            {"o_totalprice", DOUBLE()},
+            {"o_orderdate", VARCHAR()},
+            {"o_orderpriority", VARCHAR()},
+            {"o_clerk", VARCHAR()},
+            {"o_shippriority", BIGINT()},
+            {"o_comment", VARCHAR()}})},
+      {"customer",
+       ROW({{"c_custkey", BIGINT()},
+            {"c_name", VARCHAR()},
+            {"c_address", VARCHAR()},
+            {"c_nationkey", BIGINT()},
+            {"c_phone", VARCHAR()},
+            {"c_acctbal", DOUBLE()},
+            {"c_mktsegment", VARCHAR()},
+            {"c_comment", VARCHAR()}})},
+      {"part",
+       ROW({{"p_partkey", BIGINT()},
+            {"p_name", VARCHAR()},
+            {"p_mfgr", VARCHAR()},
+            {"p_brand", VARCHAR()},
+            {"p_type", VARCHAR()},
+            {"p_size", BIGINT()},
+            {"p_container", VARCHAR()},
+            {"p_retailprice", DOUBLE()},
+            {"p_comment", VARCHAR()}})},
+      {"partsupp",
+       ROW({{"ps_partkey", BIGINT()},
+            {"ps_suppkey", BIGINT()},
+            {"ps_availqty", BIGINT()},
+            {"ps_supplycost", DOUBLE()},
+            {"ps_comment", VARCHAR()}})},
+      {"supplier",
+       ROW({{"s_suppkey", BIGINT()},
+            {"s_name", VARCHAR()},
+            {"s_address", VARCHAR()},
+            {"s_nationkey", BIGINT()},
+            {"s_phone", VARCHAR()},
+            {"s_acctbal", DOUBLE()},
+            {"s_comment", VARCHAR()}})},
+      {"nation",
+       ROW({{"n_nationkey", BIGINT()},
+            {"n_name", VARCHAR()},
+            {"n_regionkey", BIGINT()},
+            {"n_comment", VARCHAR()}})},
+      {"region",
+       ROW({{"r_regionkey", BIGINT()},
+            {"r_name", VARCHAR()},
+            {"r_comment", VARCHAR()}})}};
+  auto it = kRowTypes.find(table);
+  VELOX_CHECK(it != kRowTypes.end(), "Unknown TPC-H table {}", table);
+  return it->second;
+}
+
+TpchPlan TpchQueryBuilder::getQueryPlan(int32_t queryId) const {
+  switch (queryId) {
+    case 1:
+      return getQ1Plan();
+    case 2:
+      return getQ2Plan();
+    case 3:
+      return getQ3Plan();
+    case 4:
+      return getQ4Plan();
+    case 5:
+      return getQ5Plan();
+    case 6:
+      return getQ6Plan();
+    case 7:
+      return getQ7Plan();
+    case 8:
+      return getQ8Plan();
+    case 9:
+      return getQ9Plan();
+    case 10:
+      return getQ10Plan();
+    case 11:
+      return getQ11Plan();
+    case 12:
+      return getQ12Plan();
+    case 13:
+      return getQ13Plan();
+    case 14:
+      return getQ14Plan();
+    case 15:
+      return getQ15Plan();
+    case 16:
+      return getQ16Plan();
+    case 17:
+      return getQ17Plan();
+    case 18:
+      return getQ18Plan();
+    case 19:
+      return getQ19Plan();
+    case 20:
+      return getQ20Plan();
+    case 21:
+      return getQ21Plan();
+    case 22:
+      return getQ22Plan();
+    default:
+      VELOX_USER_FAIL("TPC-H query {} does not exist", queryId);
+  }
+}
+
+TpchPlan TpchQueryBuilder::getQ1Plan() const {
+  PlanContext ctx(*this);
+  auto lineitem = ctx.scan(
+      "lineitem",
+      {"l_returnflag",
+       "l_linestatus",
+       "l_quantity",
+       "l_extendedprice",
+       "l_discount",
+       "l_tax",
+       "l_shipdate"});
+  lineitem.filter("l_shipdate <= '1998-09-02'")
+      .project(
+          {"l_returnflag",
+           "l_linestatus",
+           "l_quantity",
+           "l_extendedprice",
+           "l_discount",
+           "l_extendedprice * (1.0 - l_discount)",
+           "l_extendedprice * (1.0 - l_discount) * (1.0 + l_tax)"},
+          {"l_returnflag",
+           "l_linestatus",
+           "l_quantity",
+           "l_extendedprice",
+           "l_discount",
+           "disc_price",
+           "charge"});
+  auto plan = ctx.aggregate(
+      lineitem,
+      {"l_returnflag", "l_linestatus"},
+      {"sum(l_quantity)",
+       "sum(l_extendedprice)",
+       "sum(disc_price)",
+       "sum(charge)",
+       "sum(l_discount)",
+       "count(1)"},
+      {"sum_qty",
+       "sum_base_price",
+       "sum_disc_price",
+       "sum_charge",
+       "sum_disc",
+       "count_order"});
+  plan.project(
+      {"l_returnflag",
+       "l_linestatus",
+       "sum_qty",
+       "sum_base_price",
+       "sum_disc_price",
+       "sum_charge",
+       "sum_qty / cast(count_order as double)",
+       "sum_base_price / cast(count_order as double)",
+       "sum_disc / cast(count_order as double)",
+       "count_order"},
+      {"l_returnflag",
+       "l_linestatus",
+       "sum_qty",
+       "sum_base_price",
+       "sum_disc_price",
+       "sum_charge",
+       "avg_qty",
+       "avg_price",
+       "avg_disc",
+       "count_order"});
+  orderBy(plan, {"l_returnflag", "l_linestatus"}, {kAsc, kAsc});
+  return ctx.finish(plan);
+}
+
+TpchPlan TpchQueryBuilder::getQ2Plan() const {
+  PlanContext ctx(*this);
+  // The suppliers in Europe with the name of their nation. Built twice, for
+  // the query and for the subquery.
+  auto europeSuppliers = [&]() {
+    auto region = ctx.scan("region", {"r_regionkey", "r_name"});
+    region.filter("r_name = 'EUROPE'");
+    auto nation = ctx.scan("nation", {"n_nationkey", "n_name", "n_regionkey"});
+    hashJoin(
+        nation,
+        {"n_regionkey"},
+        region,
+        {"r_regionkey"},
+        {"n_nationkey", "n_name"});
+    auto supplier = ctx.scan(
+        "supplier",
+        {"s_suppkey",
+         "s_name",
+         "s_address",
+         "s_nationkey",
+         "s_phone",
+         "s_acctbal",
+         "s_comment"});
+    hashJoin(
+        supplier,
+        {"s_nationkey"},
+        nation,
+        {"n_nationkey"},
+        {"s_suppkey",
+         "s_name",
+         "s_address",
+         "s_phone",
+         "s_acctbal",
+         "s_comment",
+         "n_name"});
+    return supplier;
+  };
+
+  // The lowest supply cost of each part in Europe.
+  auto minCost =
+      ctx.scan("partsupp", {"ps_partkey", "ps_suppkey", "ps_supplycost"});
+  hashJoin(
+      minCost,
+      {"ps_suppkey"},
+      europeSuppliers(),
+      {"s_suppkey"},
+      {"ps_partkey", "ps_supplycost"});
+  auto minCostPlan = ctx.aggregate(
+      minCost, {"ps_partkey"}, {"min(ps_supplycost)"}, {"min_cost"});
+  minCostPlan.project(
+      {"ps_partkey", "min_cost"}, {"min_cost_partkey", "min_cost"});
+
+  auto part = ctx.scan("part", {"p_partkey", "p_mfgr", "p_size", "p_type"});
+  part.filter("p_size = 15 and like(p_type, '%BRASS')");
+  auto plan =
+      ctx.scan("partsupp", {"ps_partkey", "ps_suppkey", "ps_supplycost"});
+  hashJoin(
+      plan,
+      {"ps_partkey"},
+      part,
+      {"p_partkey"},
+      {"ps_suppkey", "ps_supplycost", "p_partkey", "p_mfgr"});
+  hashJoin(
+      plan,
+      {"ps_suppkey"},
+      europeSuppliers(),
+      {"s_suppkey"},
+      {"ps_supplycost",
+       "p_partkey",
+       "p_mfgr",
+       "s_name",
+       "s_address",
+       "s_phone",
+       "s_acctbal",
+       "s_comment",
+       "n_name"});
+  hashJoin(
+      plan,
+      {"p_partkey", "ps_supplycost"},
+      minCostPlan,
+      {"min_cost_partkey", "min_cost"},
+      {"s_acctbal",
+       "s_name",
+       "n_name",
+       "p_partkey",
+       "p_mfgr",
+       "s_address",
+       "s_phone",
+       "s_comment"});
+  auto result = ctx.topN(
+      plan,
+      {"s_acctbal", "n_name", "s_name", "p_partkey"},
+      {kDesc, kAsc, kAsc, kAsc},
+      100);
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ3Plan() const {
+  PlanContext ctx(*this);
+  auto customer = ctx.scan("customer", {"c_custkey", "c_mktsegment"});
+  customer.filter("c_mktsegment = 'BUILDING'");
+  auto orders = ctx.scan(
+      "orders", {"o_orderkey", "o_custkey", "o_orderdate", "o_shippriority"});
+  orders.filter("o_orderdate < '1995-03-15'");
+  hashJoin(
+      orders,
+      {"o_custkey"},
+      customer,
+      {"c_custkey"},
+      {"o_orderkey", "o_orderdate", "o_shippriority"});
+  auto plan = ctx.scan(
+      "lineitem",
+      {"l_orderkey", "l_extendedprice", "l_discount", "l_shipdate"});
+  plan.filter("l_shipdate > '1995-03-15'")
+      .project(
+          {"l_orderkey", "l_extendedprice * (1.0 - l_discount)"},
+          {"l_orderkey", "volume"});
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      orders,
+      {"o_orderkey"},
+      {"l_orderkey", "o_orderdate", "o_shippriority", "volume"});
+  auto result = ctx.aggregate(
+      plan,
+      {"l_orderkey", "o_orderdate", "o_shippriority"},
+      {"sum(volume)"},
+      {"revenue"});
+  topN(result, {"revenue", "o_orderdate"}, {kDesc, kAsc}, 10);
+  result.project(
+      {"l_orderkey", "revenue", "o_orderdate", "o_shippriority"},
+      {"l_orderkey", "revenue", "o_orderdate", "o_shippriority"});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ4Plan() const {
+  PlanContext ctx(*this);
+  auto lineitem =
+      ctx.scan("lineitem", {"l_orderkey", "l_commitdate", "l_receiptdate"});
+  lineitem.filter("l_commitdate < l_receiptdate");
+  auto plan =
+      ctx.scan("orders", {"o_orderkey", "o_orderdate", "o_orderpriority"});
+  plan.filter("o_orderdate >= '1993-07-01' and o_orderdate < '1993-10-01'");
+  hashJoin(
+      plan,
+      {"o_orderkey"},
+      lineitem,
+      {"l_orderkey"},
+      {"o_orderpriority"},
+      core::JoinType::kSemi);
+  auto result = ctx.aggregate(
+      plan, {"o_orderpriority"}, {"count(1)"}, {"order_count"});
+  orderBy(result, {"o_orderpriority"}, {kAsc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ5Plan() const {
+  PlanContext ctx(*this);
+  auto region = ctx.scan("region", {"r_regionkey", "r_name"});
+  region.filter("r_name = 'ASIA'");
+  auto nation = ctx.scan("nation", {"n_nationkey", "n_name", "n_regionkey"});
+  hashJoin(
+      nation,
+      {"n_regionkey"},
+      region,
+      {"r_regionkey"},
+      {"n_nationkey", "n_name"});
+  auto supplier = ctx.scan("supplier", {"s_suppkey", "s_nationkey"});
+  hashJoin(
+      supplier,
+      {"s_nationkey"},
+      nation,
+      {"n_nationkey"},
+      {"s_suppkey", "s_nationkey", "n_name"});
+
+  auto customer = ctx.scan("customer", {"c_custkey", "c_nationkey"});
+  auto orders = ctx.scan("orders", {"o_orderkey", "o_custkey", "o_orderdate"});
+  orders.filter("o_orderdate >= '1994-01-01' and o_orderdate < '1995-01-01'");
+  hashJoin(
+      orders,
+      {"o_custkey"},
+      customer,
+      {"c_custkey"},
+      {"o_orderkey", "c_nationkey"});
+
+  auto plan = ctx.scan(
+      "lineitem", {"l_orderkey", "l_suppkey", "l_extendedprice", "l_discount"});
+  plan.project(
+      {"l_orderkey", "l_suppkey", "l_extendedprice * (1.0 - l_discount)"},
+      {"l_orderkey", "l_suppkey", "volume"});
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      orders,
+      {"o_orderkey"},
+      {"l_suppkey", "volume", "c_nationkey"});
+  // The customer and the supplier are in the same nation.
+  hashJoin(
+      plan,
+      {"l_suppkey", "c_nationkey"},
+      supplier,
+      {"s_suppkey", "s_nationkey"},
+      {"n_name", "volume"});
+  auto result = ctx.aggregate(plan, {"n_name"}, {"sum(volume)"}, {"revenue"});
+  orderBy(result, {"revenue"}, {kDesc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ6Plan() const {
+  PlanContext ctx(*this);
+  auto plan = ctx.scan(
+      "lineitem",
+      {"l_shipdate", "l_discount", "l_quantity", "l_extendedprice"});
+  plan.filter(
+          "l_shipdate >= '1994-01-01' and l_shipdate < '1995-01-01' and "
+          "l_discount between 0.05 and 0.07 and l_quantity < 24.0")
+      .project({"l_extendedprice * l_discount"}, {"volume"});
+  auto result = ctx.aggregate(plan, {}, {"sum(volume)"}, {"revenue"});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ7Plan() const {
+  PlanContext ctx(*this);
+  auto supplierNation =
+      ctx.scan("nation", {"n_nationkey", "n_name"}, {"n1_key", "supp_nation"});
+  supplierNation.filter("supp_nation in ('FRANCE', 'GERMANY')");
+  auto supplier = ctx.scan("supplier", {"s_suppkey", "s_nationkey"});
+  hashJoin(
+      supplier,
+      {"s_nationkey"},
+      supplierNation,
+      {"n1_key"},
+      {"s_suppkey", "supp_nation"});
+
+  auto customerNation =
+      ctx.scan("nation", {"n_nationkey", "n_name"}, {"n2_key", "cust_nation"});
+  customerNation.filter("cust_nation in ('FRANCE', 'GERMANY')");
+  auto customer = ctx.scan("customer", {"c_custkey", "c_nationkey"});
+  hashJoin(
+      customer,
+      {"c_nationkey"},
+      customerNation,
+      {"n2_key"},
+      {"c_custkey", "cust_nation"});
+  auto orders = ctx.scan("orders", {"o_orderkey", "o_custkey"});
+  hashJoin(
+      orders,
+      {"o_custkey"},
+      customer,
+      {"c_custkey"},
+      {"o_orderkey", "cust_nation"});
+
+  auto plan = ctx.scan(
+      "lineitem",
+      {"l_orderkey",
+       "l_suppkey",
+       "l_extendedprice",
+       "l_discount",
+       "l_shipdate"});
+  plan.filter("l_shipdate between '1995-01-01' and '1996-12-31'")
+      .project(
+          {"l_orderkey",
+           "l_suppkey",
+           "cast(substr(l_shipdate, 1, 4) as bigint)",
+           "l_extendedprice * (1.0 - l_discount)"},
+          {"l_orderkey", "l_suppkey", "l_year", "volume"});
+  hashJoin(
+      plan,
+      {"l_suppkey"},
+      supplier,
+      {"s_suppkey"},
+      {"l_orderkey", "l_year", "volume", "supp_nation"});
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      orders,
+      {"o_orderkey"},
+      {"supp_nation", "cust_nation", "l_year", "volume"});
+  plan.filter(
+      "(supp_nation = 'FRANCE' and cust_nation = 'GERMANY') or "
+      "(supp_nation = 'GERMANY' and cust_nation = 'FRANCE')");
+  auto result = ctx.aggregate(
+      plan,
+      {"supp_nation", "cust_nation", "l_year"},
+      {"sum(volume)"},
+      {"revenue"});
+  orderBy(result, {"supp_nation", "cust_nation", "l_year"}, {kAsc, kAsc, kAsc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ8Plan() const {
+  PlanContext ctx(*this);
+  auto part = ctx.scan("part", {"p_partkey", "p_type"});
+  part.filter("p_type = 'ECONOMY ANODIZED STEEL'");
+
+  auto region = ctx.scan("region", {"r_regionkey", "r_name"});
+  region.filter("r_name = 'AMERICA'");
+  auto customerNation = ctx.scan(
+      "nation", {"n_nationkey", "n_regionkey"}, {"n1_key", "n1_region"});
+  hashJoin(
+      customerNation, {"n1_region"}, region, {"r_regionkey"}, {"n1_key"});
+  auto customer = ctx.scan("customer", {"c_custkey", "c_nationkey"});
+  hashJoin(
+      customer,
+      {"c_nationkey"},
+      customerNation,
+      {"n1_key"},
+      {"c_custkey"});
+  auto orders = ctx.scan("orders", {"o_orderkey", "o_custkey", "o_orderdate"});
+  orders.filter("o_orderdate between '1995-01-01' and '1996-12-31'")
+      .project(
+          {"o_orderkey",
+           "o_custkey",
+           "cast(substr(o_orderdate, 1, 4) as bigint)"},
+          {"o_orderkey", "o_custkey", "o_year"});
+  hashJoin(
+      orders, {"o_custkey"}, customer, {"c_custkey"}, {"o_orderkey", "o_year"});
+
+  auto supplierNation =
+      ctx.scan("nation", {"n_nationkey", "n_name"}, {"n2_key", "nation"});
+  auto supplier = ctx.scan("supplier", {"s_suppkey", "s_nationkey"});
+  hashJoin(
+      supplier,
+      {"s_nationkey"},
+      supplierNation,
+      {"n2_key"},
+      {"s_suppkey", "nation"});
+
+  auto plan = ctx.scan(
+      "lineitem",
+      {"l_orderkey",
+       "l_partkey",
+       "l_suppkey",
+       "l_extendedprice",
+       "l_discount"});
+  plan.project(
+      {"l_orderkey",
+       "l_partkey",
+       "l_suppkey",
+       "l_extendedprice * (1.0 - l_discount)"},
+      {"l_orderkey", "l_partkey", "l_suppkey", "volume"});
+  hashJoin(
+      plan,
+      {"l_partkey"},
+      part,
+      {"p_partkey"},
+      {"l_orderkey", "l_suppkey", "volume"});
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      orders,
+      {"o_orderkey"},
+      {"l_suppkey", "volume", "o_year"});
+  hashJoin(
+      plan,
+      {"l_suppkey"},
+      supplier,
+      {"s_suppkey"},
+      {"o_year", "volume", "nation"});
+  plan.project(
+      {"o_year",
+       "volume",
+       "case when nation = 'BRAZIL' then volume else 0.0 end"},
+      {"o_year", "volume", "brazil_volume"});
+  auto result = ctx.aggregate(
+      plan,
+      {"o_year"},
+      {"sum(brazil_volume)", "sum(volume)"},
+      {"brazil_volume", "volume"});
+  result.project(
+      {"o_year", "brazil_volume / volume"}, {"o_year", "mkt_share"});
+  orderBy(result, {"o_year"}, {kAsc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ9Plan() const {
+  PlanContext ctx(*this);
+  auto part = ctx.scan("part", {"p_partkey", "p_name"});
+  part.filter("like(p_name, '%green%')");
+  auto nation = ctx.scan("nation", {"n_nationkey", "n_name"});
+  auto supplier = ctx.scan("supplier", {"s_suppkey", "s_nationkey"});
+  hashJoin(
+      supplier,
+      {"s_nationkey"},
+      nation,
+      {"n_nationkey"},
+      {"s_suppkey", "n_name"});
+  auto partsupp =
+      ctx.scan("partsupp", {"ps_partkey", "ps_suppkey", "ps_supplycost"});
+  auto orders = ctx.scan("orders", {"o_orderkey", "o_orderdate"});
+  orders.project(
+      {"o_orderkey", "cast(substr(o_orderdate, 1, 4) as bigint)"},
+      {"o_orderkey", "o_year"});
+
+  auto plan = ctx.scan(
+      "lineitem",
+      {"l_orderkey",
+       "l_partkey",
+       "l_suppkey",
+       "l_quantity",
+       "l_extendedprice",
+       "l_discount"});
+  hashJoin(
+      plan,
+      {"l_partkey"},
+      part,
+      {"p_partkey"},
+      {"l_orderkey",
+       "l_partkey",
+       "l_suppkey",
+       "l_quantity",
+       "l_extendedprice",
+       "l_discount"});
+  hashJoin(
+      plan,
+      {"l_partkey", "l_suppkey"},
+      partsupp,
+      {"ps_partkey", "ps_suppkey"},
+      {"l_orderkey",
+       "l_suppkey",
+       "l_quantity",
+       "l_extendedprice",
+       "l_discount",
+       "ps_supplycost"});
+  hashJoin(
+      plan,
+      {"l_suppkey"},
+      supplier,
+      {"s_suppkey"},
+      {"l_orderkey",
+       "l_quantity",
+       "l_extendedprice",
+       "l_discount",
+       "ps_supplycost",
+       "n_name"});
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      orders,
+      {"o_orderkey"},
+      {"l_quantity",
+       "l_extendedprice",
+       "l_discount",
+       "ps_supplycost",
+       "n_name",
+       "o_year"});
+  plan.project(
+      {"n_name",
+       "o_year",
+       "l_extendedprice * (1.0 - l_discount) - ps_supplycost * l_quantity"},
+      {"nation", "o_year", "amount"});
+  auto result = ctx.aggregate(
+      plan, {"nation", "o_year"}, {"sum(amount)"}, {"sum_profit"});
+  orderBy(result, {"nation", "o_year"}, {kAsc, kDesc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ10Plan() const {
+  PlanContext ctx(*this);
+  auto orders = ctx.scan("orders", {"o_orderkey", "o_custkey", "o_orderdate"});
+  orders.filter("o_orderdate >= '1993-10-01' and o_orderdate < '1994-01-01'");
+  auto nation = ctx.scan("nation", {"n_nationkey", "n_name"});
+  auto customer = ctx.scan(
+      "customer",
+      {"c_custkey",
+       "c_name",
+       "c_address",
+       "c_nationkey",
+       "c_phone",
+       "c_acctbal",
+       "c_comment"});
+  hashJoin(
+      customer,
+      {"c_nationkey"},
+      nation,
+      {"n_nationkey"},
+      {"c_custkey",
+       "c_name",
+       "c_address",
+       "c_phone",
+       "c_acctbal",
+       "c_comment",
+       "n_name"});
+
+  auto plan = ctx.scan(
+      "lineitem",
+      {"l_orderkey", "l_extendedprice", "l_discount", "l_returnflag"});
+  plan.filter("l_returnflag = 'R'")
+      .project(
+          {"l_orderkey", "l_extendedprice * (1.0 - l_discount)"},
+          {"l_orderkey", "volume"});
+  hashJoin(
+      plan, {"l_orderkey"}, orders, {"o_orderkey"}, {"o_custkey", "volume"});
+  hashJoin(
+      plan,
+      {"o_custkey"},
+      customer,
+      {"c_custkey"},
+      {"c_custkey",
+       "c_name",
+       "c_acctbal",
+       "c_phone",
+       "n_name",
+       "c_address",
+       "c_comment",
+       "volume"});
+  auto result = ctx.aggregate(
+      plan,
+      {"c_custkey",
+       "c_name",
+       "c_acctbal",
+       "c_phone",
+       "n_name",
+       "c_address",
+       "c_comment"},
+      {"sum(volume)"},
+      {"revenue"});
+  topN(result, {"revenue"}, {kDesc}, 20);
+  result.project(
+      {"c_custkey",
+       "c_name",
+       "revenue",
+       "c_acctbal",
+       "n_name",
+       "c_address",
+       "c_phone",
+       "c_comment"},
+      {"c_custkey",
+       "c_name",
+       "revenue",
+       "c_acctbal",
+       "n_name",
+       "c_address",
+       "c_phone",
+       "c_comment"});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ11Plan() const {
+  PlanContext ctx(*this);
+  // The stock value of each part in Germany. Built twice, per part and for
+  // the total.
+  auto germanStock = [&]() {
+    auto nation = ctx.scan("nation", {"n_nationkey", "n_name"});
+    nation.filter("n_name = 'GERMANY'");
+    auto supplier = ctx.scan("supplier", {"s_suppkey", "s_nationkey"});
+    hashJoin(
+        supplier, {"s_nationkey"}, nation, {"n_nationkey"}, {"s_suppkey"});
+    auto partsupp = ctx.scan(
+        "partsupp",
+        {"ps_partkey", "ps_suppkey", "ps_availqty", "ps_supplycost"});
+    hashJoin(
+        partsupp,
+        {"ps_suppkey"},
+        supplier,
+        {"s_suppkey"},
+        {"ps_partkey", "ps_availqty", "ps_supplycost"});
+    partsupp.project(
+        {"ps_partkey", "ps_supplycost * cast(ps_availqty as double)"},
+        {"ps_partkey", "value"});
+    return partsupp;
+  };
+
+  auto stock = germanStock();
+  auto total = ctx.aggregate(stock, {}, {"sum(value)"}, {"total_value"});
+  total.project(
+      {fmt::format("total_value * {}", 0.0001 / scaleFactor_)},
+      {"threshold"});
+
+  auto partStock = germanStock();
+  auto result =
+      ctx.aggregate(partStock, {"ps_partkey"}, {"sum(value)"}, {"value"});
+  crossJoin(result, total, {"ps_partkey", "value", "threshold"});
+  result.filter("value > threshold");
+  orderBy(result, {"value"}, {kDesc});
+  result.project({"ps_partkey", "value"}, {"ps_partkey", "value"});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ12Plan() const {
+  PlanContext ctx(*this);
+  auto lineitem = ctx.scan(
+      "lineitem",
+      {"l_orderkey",
+       "l_shipmode",
+       "l_commitdate",
+       "l_receiptdate",
+       "l_shipdate"});
+  lineitem.filter(
+      "l_shipmode in ('MAIL', 'SHIP') and l_commitdate < l_receiptdate and "
+      "l_shipdate < l_commitdate and l_receiptdate >= '1994-01-01' and "
+      "l_receiptdate < '1995-01-01'");
+  // The qualifying line items are few, so they are the build side.
+  auto plan = ctx.scan("orders", {"o_orderkey", "o_orderpriority"});
+  hashJoin(
+      plan,
+      {"o_orderkey"},
+      lineitem,
+      {"l_orderkey"},
+      {"l_shipmode", "o_orderpriority"});
+  plan.project(
+      {"l_shipmode",
+       "case when o_orderpriority = '1-URGENT' or "
+       "o_orderpriority = '2-HIGH' then 1 else 0 end",
+       "case when o_orderpriority <> '1-URGENT' and "
+       "o_orderpriority <> '2-HIGH' then 1 else 0 end"},
+      {"l_shipmode", "high_line", "low_line"});
+  auto result = ctx.aggregate(
+      plan,
+      {"l_shipmode"},
+      {"sum(high_line)", "sum(low_line)"},
+      {"high_line_count", "low_line_count"});
+  orderBy(result, {"l_shipmode"}, {kAsc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ13Plan() const {
+  PlanContext ctx(*this);
+  auto orders = ctx.scan("orders", {"o_orderkey", "o_custkey", "o_comment"});
+  orders.filter("not like(o_comment, '%special%requests%')");
+  auto plan = ctx.scan("customer", {"c_custkey"});
+  hashJoin(
+      plan,
+      {"c_custkey"},
+      orders,
+      {"o_custkey"},
+      {"c_custkey", "o_orderkey"},
+      core::JoinType::kLeft);
+  auto result =
+      ctx.aggregate(plan, {"c_custkey"}, {"count(o_orderkey)"}, {"c_count"});
+  singleAggregate(result, {"c_count"}, {"count(1)"}, {"custdist"});
+  orderBy(result, {"custdist", "c_count"}, {kDesc, kDesc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ14Plan() const {
+  PlanContext ctx(*this);
+  auto part = ctx.scan("part", {"p_partkey", "p_type"});
+  auto plan = ctx.scan(
+      "lineitem", {"l_partkey", "l_extendedprice", "l_discount", "l_shipdate"});
+  plan.filter("l_shipdate >= '1995-09-01' and l_shipdate < '1995-10-01'")
+      .project(
+          {"l_partkey", "l_extendedprice * (1.0 - l_discount)"},
+          {"l_partkey", "volume"});
+  hashJoin(plan, {"l_partkey"}, part, {"p_partkey"}, {"p_type", "volume"});
+  plan.project(
+      {"case when like(p_type, 'PROMO%') then volume else 0.0 end", "volume"},
+      {"promo_volume", "volume"});
+  auto result = ctx.aggregate(
+      plan,
+      {},
+      {"sum(promo_volume)", "sum(volume)"},
+      {"promo_volume", "volume"});
+  result.project({"100.0 * promo_volume / volume"}, {"promo_revenue"});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ15Plan() const {
+  PlanContext ctx(*this);
+  auto lineitem = ctx.scan(
+      "lineitem", {"l_suppkey", "l_extendedprice", "l_discount", "l_shipdate"});
+  lineitem.filter("l_shipdate >= '1996-01-01' and l_shipdate < '1996-04-01'")
+      .project(
+          {"l_suppkey", "l_extendedprice * (1.0 - l_discount)"},
+          {"l_suppkey", "volume"});
+  auto revenue = ctx.aggregate(
+      lineitem, {"l_suppkey"}, {"sum(volume)"}, {"total_revenue"});
+  // The supplier with the highest revenue. Comparing the revenue with a
+  // separately computed maximum would depend on the order of the additions
+  // of the floating point sums. The query data has a single top supplier.
+  topN(revenue, {"total_revenue"}, {kDesc}, 1);
+
+  auto plan =
+      ctx.scan("supplier", {"s_suppkey", "s_name", "s_address", "s_phone"});
+  hashJoin(
+      plan,
+      {"s_suppkey"},
+      revenue,
+      {"l_suppkey"},
+      {"s_suppkey", "s_name", "s_address", "s_phone", "total_revenue"});
+  auto result = ctx.gather(plan);
+  orderBy(result, {"s_suppkey"}, {kAsc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ16Plan() const {
+  PlanContext ctx(*this);
+  auto part = ctx.scan("part", {"p_partkey", "p_brand", "p_type", "p_size"});
+  part.filter(
+      "p_brand <> 'Brand#45' and not like(p_type, 'MEDIUM POLISHED%') and "
+      "p_size in (49, 14, 23, 45, 19, 3, 36, 9)");
+  auto complaints = ctx.scan("supplier", {"s_suppkey", "s_comment"});
+  complaints.filter("like(s_comment, '%Customer%Complaints%')");
+
+  auto plan = ctx.scan("partsupp", {"ps_partkey", "ps_suppkey"});
+  hashJoin(
+      plan,
+      {"ps_suppkey"},
+      complaints,
+      {"s_suppkey"},
+      {"ps_partkey", "ps_suppkey"},
+      core::JoinType::kAnti);
+  hashJoin(
+      plan,
+      {"ps_partkey"},
+      part,
+      {"p_partkey"},
+      {"p_brand", "p_type", "p_size", "ps_suppkey"});
+  // count(distinct ps_suppkey) counts the groups of the distinct suppliers.
+  auto result = ctx.aggregate(
+      plan, {"p_brand", "p_type", "p_size", "ps_suppkey"}, {}, {});
+  singleAggregate(
+      result, {"p_brand", "p_type", "p_size"}, {"count(1)"}, {"supplier_cnt"});
+  orderBy(
+      result,
+      {"supplier_cnt", "p_brand", "p_type", "p_size"},
+      {kDesc, kAsc, kAsc, kAsc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ17Plan() const {
+  PlanContext ctx(*this);
+  auto selectedParts = [&]() {
+    auto part = ctx.scan("part", {"p_partkey", "p_brand", "p_container"});
+    part.filter("p_brand = 'Brand#23' and p_container = 'MED BOX'");
+    return part;
+  };
+
+  // A fifth of the average quantity of each selected part.
+  auto quantities = ctx.scan("lineitem", {"l_partkey", "l_quantity"});
+  hashJoin(
+      quantities,
+      {"l_partkey"},
+      selectedParts(),
+      {"p_partkey"},
+      {"l_partkey", "l_quantity"});
+  auto limits = ctx.aggregate(
+      quantities,
+      {"l_partkey"},
+      {"sum(l_quantity)", "count(1)"},
+      {"sum_quantity", "count_quantity"});
+  limits.project(
+      {"l_partkey", "0.2 * sum_quantity / cast(count_quantity as double)"},
+      {"limit_partkey", "limit_quantity"});
+
+  auto plan =
+      ctx.scan("lineitem", {"l_partkey", "l_quantity", "l_extendedprice"});
+  hashJoin(
+      plan,
+      {"l_partkey"},
+      selectedParts(),
+      {"p_partkey"},
+      {"l_partkey", "l_quantity", "l_extendedprice"});
+  hashJoin(
+      plan,
+      {"l_partkey"},
+      limits,
+      {"limit_partkey"},
+      {"l_quantity", "l_extendedprice", "limit_quantity"});
+  plan.filter("l_quantity < limit_quantity");
+  auto result =
+      ctx.aggregate(plan, {}, {"sum(l_extendedprice)"}, {"sum_price"});
+  result.project({"sum_price / 7.0"}, {"avg_yearly"});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ18Plan() const {
+  PlanContext ctx(*this);
+  auto quantities = ctx.scan("lineitem", {"l_orderkey", "l_quantity"});
+  auto largeOrders = ctx.aggregate(
+      quantities, {"l_orderkey"}, {"sum(l_quantity)"}, {"sum_quantity"});
+  largeOrders.filter("sum_quantity > 300.0")
+      .project({"l_orderkey"}, {"large_orderkey"});
+
+  auto customer = ctx.scan("customer", {"c_custkey", "c_name"});
+  auto orders = ctx.scan(
+      "orders", {"o_orderkey", "o_custkey", "o_orderdate", "o_totalprice"});
+  hashJoin(
+      orders,
+      {"o_orderkey"},
+      largeOrders,
+      {"large_orderkey"},
+      {"o_orderkey", "o_custkey", "o_orderdate", "o_totalprice"},
+      core::JoinType::kSemi);
+  hashJoin(
+      orders,
+      {"o_custkey"},
+      customer,
+      {"c_custkey"},
+      {"o_orderkey", "o_orderdate", "o_totalprice", "c_custkey", "c_name"});
+
+  auto plan = ctx.scan("lineitem", {"l_orderkey", "l_quantity"});
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      orders,
+      {"o_orderkey"},
+      {"c_name",
+       "c_custkey",
+       "o_orderkey",
+       "o_orderdate",
+       "o_totalprice",
+       "l_quantity"});
+  auto result = ctx.aggregate(
+      plan,
+      {"c_name", "c_custkey", "o_orderkey", "o_orderdate", "o_totalprice"},
+      {"sum(l_quantity)"},
+      {"sum_quantity"});
+  topN(result, {"o_totalprice", "o_orderdate"}, {kDesc, kAsc}, 100);
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ19Plan() const {
+  PlanContext ctx(*this);
+  auto part =
+      ctx.scan("part", {"p_partkey", "p_brand", "p_container", "p_size"});
+  part.filter("p_size >= 1");
+  auto plan = ctx.scan(
+      "lineitem",
+      {"l_partkey",
+       "l_quantity",
+       "l_extendedprice",
+       "l_discount",
+       "l_shipmode",
+       "l_shipinstruct"});
+  plan.filter(
+      "l_shipmode in ('AIR', 'AIR REG') and "
+      "l_shipinstruct = 'DELIVER IN PERSON'");
+  hashJoin(
+      plan,
+      {"l_partkey"},
+      part,
+      {"p_partkey"},
+      {"l_extendedprice", "l_discount"},
+      core::JoinType::kInner,
+      "(p_brand = 'Brand#12' and "
+      "p_container in ('SM CASE', 'SM BOX', 'SM PACK', 'SM PKG') and "
+      "l_quantity between 1.0 and 11.0 and p_size between 1 and 5) or "
+      "(p_brand = 'Brand#23' and "
+      "p_container in ('MED BAG', 'MED BOX', 'MED PKG', 'MED PACK') and "
+      "l_quantity between 10.0 and 20.0 and p_size between 1 and 10) or "
+      "(p_brand = 'Brand#34' and "
+      "p_container in ('LG CASE', 'LG BOX', 'LG PACK', 'LG PKG') and "
+      "l_quantity between 20.0 and 30.0 and p_size between 1 and 15)");
+  plan.project({"l_extendedprice * (1.0 - l_discount)"}, {"volume"});
+  auto result = ctx.aggregate(plan, {}, {"sum(volume)"}, {"revenue"});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ20Plan() const {
+  PlanContext ctx(*this);
+  auto forestParts = [&]() {
+    auto part = ctx.scan("part", {"p_partkey", "p_name"});
+    part.filter("like(p_name, 'forest%')");
+    return part;
+  };
+
+  // Half of the quantity of each forest part shipped by each supplier in
+  // 1994.
+  auto lineitem = ctx.scan(
+      "lineitem", {"l_partkey", "l_suppkey", "l_quantity", "l_shipdate"});
+  lineitem.filter("l_shipdate >= '1994-01-01' and l_shipdate < '1995-01-01'");
+  hashJoin(
+      lineitem,
+      {"l_partkey"},
+      forestParts(),
+      {"p_partkey"},
+      {"l_partkey", "l_suppkey", "l_quantity"},
+      core::JoinType::kSemi);
+  auto shipped = ctx.aggregate(
+      lineitem,
+      {"l_partkey", "l_suppkey"},
+      {"sum(l_quantity)"},
+      {"sum_quantity"});
+  shipped.project(
+      {"l_partkey", "l_suppkey", "0.5 * sum_quantity"},
+      {"l_partkey", "l_suppkey", "limit_quantity"});
+
+  // The suppliers with excess stock of a forest part.
+  auto partsupp =
+      ctx.scan("partsupp", {"ps_partkey", "ps_suppkey", "ps_availqty"});
+  hashJoin(
+      partsupp,
+      {"ps_partkey"},
+      forestParts(),
+      {"p_partkey"},
+      {"ps_partkey", "ps_suppkey", "ps_availqty"},
+      core::JoinType::kSemi);
+  hashJoin(
+      partsupp,
+      {"ps_partkey", "ps_suppkey"},
+      shipped,
+      {"l_partkey", "l_suppkey"},
+      {"ps_suppkey", "ps_availqty", "limit_quantity"});
+  partsupp.filter("cast(ps_availqty as double) > limit_quantity");
+
+  auto nation = ctx.scan("nation", {"n_nationkey", "n_name"});
+  nation.filter("n_name = 'CANADA'");
+  auto plan =
+      ctx.scan("supplier", {"s_suppkey", "s_name", "s_address", "s_nationkey"});
+  hashJoin(
+      plan,
+      {"s_nationkey"},
+      nation,
+      {"n_nationkey"},
+      {"s_suppkey", "s_name", "s_address"});
+  hashJoin(
+      plan,
+      {"s_suppkey"},
+      partsupp,
+      {"ps_suppkey"},
+      {"s_name", "s_address"},
+      core::JoinType::kSemi);
+  auto result = ctx.gather(plan);
+  orderBy(result, {"s_name"}, {kAsc});
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ21Plan() const {
+  PlanContext ctx(*this);
+  // The orders with line items of more than one supplier. The suppliers of
+  // an order differ if the smallest and the largest differ.
+  auto allSuppliers = ctx.scan("lineitem", {"l_orderkey", "l_suppkey"});
+  auto multiSupplierOrders = ctx.aggregate(
+      allSuppliers,
+      {"l_orderkey"},
+      {"min(l_suppkey)", "max(l_suppkey)"},
+      {"min_suppkey", "max_suppkey"});
+  multiSupplierOrders.filter("min_suppkey <> max_suppkey")
+      .project({"l_orderkey"}, {"multi_orderkey"});
+
+  // The orders whose late line items are all from one supplier.
+  auto lateSuppliers = ctx.scan(
+      "lineitem", {"l_orderkey", "l_suppkey", "l_commitdate", "l_receiptdate"});
+  lateSuppliers.filter("l_receiptdate > l_commitdate");
+  auto singleLateOrders = ctx.aggregate(
+      lateSuppliers,
+      {"l_orderkey"},
+      {"min(l_suppkey)", "max(l_suppkey)"},
+      {"min_suppkey", "max_suppkey"});
+  singleLateOrders.filter("min_suppkey = max_suppkey")
+      .project({"l_orderkey"}, {"single_orderkey"});
+
+  auto nation = ctx.scan("nation", {"n_nationkey", "n_name"});
+  nation.filter("n_name = 'SAUDI ARABIA'");
+  auto supplier = ctx.scan("supplier", {"s_suppkey", "s_name", "s_nationkey"});
+  hashJoin(
+      supplier,
+      {"s_nationkey"},
+      nation,
+      {"n_nationkey"},
+      {"s_suppkey", "s_name"});
+  auto orders = ctx.scan("orders", {"o_orderkey", "o_orderstatus"});
+  orders.filter("o_orderstatus = 'F'");
+
+  auto plan = ctx.scan(
+      "lineitem", {"l_orderkey", "l_suppkey", "l_commitdate", "l_receiptdate"});
+  plan.filter("l_receiptdate > l_commitdate");
+  hashJoin(
+      plan,
+      {"l_suppkey"},
+      supplier,
+      {"s_suppkey"},
+      {"l_orderkey", "s_name"});
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      orders,
+      {"o_orderkey"},
+      {"l_orderkey", "s_name"},
+      core::JoinType::kSemi);
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      multiSupplierOrders,
+      {"multi_orderkey"},
+      {"l_orderkey", "s_name"},
+      core::JoinType::kSemi);
+  hashJoin(
+      plan,
+      {"l_orderkey"},
+      singleLateOrders,
+      {"single_orderkey"},
+      {"s_name"},
+      core::JoinType::kSemi);
+  auto result = ctx.aggregate(plan, {"s_name"}, {"count(1)"}, {"numwait"});
+  topN(result, {"numwait", "s_name"}, {kDesc, kAsc}, 100);
+  return ctx.finish(result);
+}
+
+TpchPlan TpchQueryBuilder::getQ22Plan() const {
+  PlanContext ctx(*this);
+  auto customers = [&]() {
+    auto customer = ctx.scan("customer", {"c_custkey", "c_phone", "c_acctbal"});
+    customer
+        .project(
+            {"c_custkey", "substr(c_phone, 1, 2)", "c_acctbal"},
+            {"c_custkey", "cntrycode", "c_acctbal"})
+        .filter("cntrycode in ('13', '31', '23', '29', '30', '18', '17')");
+    return customer;
+  };
+
+  auto positive = customers();
+  positive.filter("c_acctbal > 0.0");
+  auto average = ctx.aggregate(
+      positive,
+      {},
+      {"sum(c_acctbal)", "count(1)"},
+      {"sum_acctbal", "count_acctbal"});
+  average.project(
+      {"sum_acctbal / cast(count_acctbal as double)"}, {"avg_acctbal"});
+
+  auto orders = ctx.scan("orders", {"o_custkey"});
+  auto plan = customers();
+  crossJoin(
+      plan, average, {"c_custkey", "cntrycode", "c_acctbal", "avg_acctbal"});
+  plan.filter("c_acctbal > avg_acctbal");
+  hashJoin(
+      plan,
+      {"c_custkey"},
+      orders,
+      {"o_custkey"},
+      {"cntrycode", "c_acctbal"},
+      core::JoinType::kAnti);
+  auto result = ctx.aggregate(
+      plan,
+      {"cntrycode"},
+      {"count(1)", "sum(c_acctbal)"},
+      {"numcust", "totacctbal"});
+  orderBy(result, {"cntrycode"}, {kAsc});
+  return ctx.finish(result);
+}
+
+} // namespace facebook::velox::exec::test
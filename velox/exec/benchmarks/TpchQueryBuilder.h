@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/core/PlanNode.h"
+#include "velox/dwio/common/Options.h"
+
+namespace facebook::velox::exec::test {
+
+// The plan of a TPC-H query and the data files that its table scans read.
+struct TpchPlan {
+  std::shared_ptr<const core::PlanNode> plan;
+  // The files of the table read by each TableScan node.
+  std::unordered_map<core::PlanNodeId, std::vector<std::string>> dataFiles;
+  dwio::common::FileFormat dataFileFormat;
+};
+
+// Builds the plans of the 22 TPC-H queries with the substitution parameters
+// of the query validation. Each table is a directory of files named after
+// the table. Subqueries are decorrelated into joins and aggregations. The
+// plans gather the rows into a single Driver for final aggregations and
+// sorts, so they run with any number of Drivers per pipeline.
+class TpchQueryBuilder {
+ public:
+  TpchQueryBuilder(dwio::common::FileFormat format, double scaleFactor)
+      : format_(format), scaleFactor_(scaleFactor) {}
+
+  // Finds the files of each table under 'dataPath'.
+  void initialize(const std::string& dataPath);
+
+  // Returns the plan of query 'queryId' in [1, 22].
+  TpchPlan getQueryPlan(int32_t queryId) const;
+
+  // The TPC-H tables.
+  static const std::vector<std::string>& tableNames();
+
+  // Returns the columns of 'table' with the types the plans expect. Keys
+  // and other integers are BIGINT, decimals are DOUBLE and dates are
+  // VARCHAR in ISO format, which DWRF can store and which compare in date
+  // order.
+  static const RowTypePtr& getRowType(const std::string& table);
+
+  static constexpr int32_t kNumQueries = 22;
+
+ private:
+  class PlanContext;
+
+  TpchPlan getQ1Plan() const;
+  TpchPlan getQ2Plan() const;
+  TpchPlan getQ3Plan() const;
+  TpchPlan getQ4Plan() const;
+  TpchPlan getQ5Plan() const;
+  TpchPlan getQ6Plan() const;
+  TpchPlan getQ7Plan() const;
+  TpchPlan getQ8Plan() const;
+  TpchPlan getQ9Plan() const;
+  TpchPlan getQ10Plan() const;
+  TpchPlan getQ11Plan() const;
+  TpchPlan getQ12Plan() const;
+  TpchPlan getQ13Plan() const;
+  TpchPlan getQ14Plan() const;
+  TpchPlan getQ15Plan() const;
+  TpchPlan getQ16Plan() const;
+  TpchPlan getQ17Plan() const;
+  TpchPlan getQ18Plan() const;
+  TpchPlan getQ19Plan() const;
+  TpchPlan getQ20Plan() const;
+  TpchPlan getQ21Plan() const;
+  TpchPlan getQ22Plan() const;
+
+  const dwio::common::FileFormat format_;
+  const double scaleFactor_;
+  std::unordered_map<std::string, std::vector<std::string>> tableFiles_;
+};
+
+} // namespace facebook::velox::exec::test
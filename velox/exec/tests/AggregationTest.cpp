@@ -16,6 +16,7 @@
 #include "velox/dwio/dwrf/test/utils/BatchMaker.h"
 #include "velox/exec/tests/utils/OperatorTestBase.h"
 #include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/exec/tests/utils/TempDirectoryPath.h"
 
 using facebook::velox::test::BatchMaker;
 
@@ -446,5 +447,361 @@ TEST_F(AggregationTest, partialAggregationMemoryLimit) {
   assertQuery(params, "SELECT c0, count(1) FROM tmp GROUP BY 1");
 }
 
+TEST_F(AggregationTest, partialAggregationEviction) {
+  // Every other row has one of 10 hot keys. The other rows have keys that
+  // occur once.
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(
+             10'000,
+             [&](auto row) {
+               return row % 2 ? 100 + row + i * 10'000 : row % 20;
+             }),
+         makeFlatVector<int32_t>(
+             10'000, [](auto row) { return row; }, nullEvery(11))}));
+  }
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kMaxPartialAggregationMemory, "1000000"},
+  });
+  params.planNode = PlanBuilder()
+                        .values(vectors)
+                        .partialAggregation({0}, {"sum(c1)", "count(c1)"})
+                        .finalAggregation({0}, {"sum(a0)", "sum(a1)"})
+                        .planNode();
+  auto task = assertQuery(
+      params, "SELECT c0, sum(c1), count(c1) FROM tmp GROUP BY 1");
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  EXPECT_LT(0, stats[1].runtimeStats["evictedPartialGroups"].sum);
+}
+
+TEST_F(AggregationTest, abandonPartialAggregation) {
+  // The first batch has few groups. The others have a new key in almost
+  // every row.
+  std::vector<RowVectorPtr> vectors;
+  vectors.push_back(makeRowVector(
+      {makeFlatVector<int64_t>(1'000, [](auto row) { return row % 10; }),
+       makeFlatVector<int32_t>(
+           1'000, [](auto row) { return row; }, nullEvery(11))}));
+  for (int32_t i = 1; i < 10; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(
+             1'000,
+             [&](auto row) { return (row + i * 1'000) / 2; },
+             nullEvery(97)),
+         makeFlatVector<int32_t>(
+             1'000, [](auto row) { return row; }, nullEvery(11))}));
+  }
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kAbandonPartialAggregationMinRows, "3000"},
+      {core::QueryConfig::kAbandonPartialAggregationMinPct, "30"},
+  });
+  params.planNode =
+      PlanBuilder()
+          .values(vectors)
+          .partialAggregation({0}, {"sum(c1)", "count(c1)", "max(c1)"})
+          .finalAggregation({0}, {"sum(a0)", "sum(a1)", "max(a2)"})
+          .planNode();
+  auto task = assertQuery(
+      params,
+      "SELECT c0, sum(c1), count(c1), max(c1) FROM tmp GROUP BY 1");
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  EXPECT_EQ(1, stats[1].runtimeStats["abandonedPartialAggregation"].sum);
+  // Once abandoned, the partial aggregation produces a row per input row.
+  EXPECT_GT(stats[1].outputPositions, 6'000);
+
+  // A partial aggregation that reduces its input keeps grouping.
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kAbandonPartialAggregationMinRows, "3000"},
+      {core::QueryConfig::kAbandonPartialAggregationMinPct, "80"},
+  });
+  task = assertQuery(
+      params,
+      "SELECT c0, sum(c1), count(c1), max(c1) FROM tmp GROUP BY 1");
+  stats = task->taskStats().pipelineStats[0].operatorStats;
+  EXPECT_EQ(0, stats[1].runtimeStats["abandonedPartialAggregation"].count);
+}
+
+TEST_F(AggregationTest, spill) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(
+             1'000, [&](auto row) { return (row * 7 + i * 1'000) % 5'003; }),
+         makeFlatVector<int32_t>(
+             1'000, [](auto row) { return row; }, nullEvery(11)),
+         makeFlatVector<StringView>(1'000, [](auto row) {
+           return StringView(fmt::format("string value {}", row % 113));
+         })}));
+  }
+  createDuckDbTable(vectors);
+
+  auto spillDirectory = TempDirectoryPath::create();
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  // Set a threshold low enough to spill several times.
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kSpillEnabled, "true"},
+      {core::QueryConfig::kSpillPath, spillDirectory->path},
+      {core::QueryConfig::kAggregationSpillMemoryThreshold, "100000"},
+  });
+
+  // Single aggregation spills accumulators produced from raw input.
+  params.planNode =
+      PlanBuilder()
+          .values(vectors)
+          .singleAggregation(
+              {0}, {"sum(c1)", "count(1)", "min(c2)", "max(c1)"})
+          .planNode();
+  auto task = assertQuery(
+      params,
+      "SELECT c0, sum(c1), count(1), min(c2), max(c1) FROM tmp GROUP BY 1");
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  ASSERT_GT(stats[1].runtimeStats["spilledRows"].sum, 0);
+
+  // Final aggregation spills intermediate results received from the partial
+  // aggregation.
+  params.planNode = PlanBuilder()
+                        .values(vectors)
+                        .partialAggregation({0}, {"sum(c1)", "max(c2)"})
+                        .finalAggregation({0}, {"sum(a0)", "max(a1)"})
+                        .planNode();
+  task = assertQuery(
+      params, "SELECT c0, sum(c1), max(c2) FROM tmp GROUP BY 1");
+  stats = task->taskStats().pipelineStats[0].operatorStats;
+  ASSERT_GT(stats[2].runtimeStats["spilledRows"].sum, 0);
+}
+
+TEST_F(AggregationTest, sharedFinalAggregation) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(
+             1'000,
+             [&](auto row) { return (row * 7 + i * 1'000) % 5'003; },
+             nullEvery(101)),
+         makeFlatVector<int32_t>(
+             1'000, [](auto row) { return row; }, nullEvery(11)),
+         makeFlatVector<StringView>(1'000, [](auto row) {
+           return StringView(fmt::format("string value {}", row % 113));
+         })}));
+  }
+  createDuckDbTable(vectors);
+
+  constexpr int32_t kNumDrivers = 4;
+  CursorParameters params;
+  params.maxDrivers = kNumDrivers;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kSharedFinalAggregationEnabled, "true"},
+  });
+  // Each driver of a parallelizable Values produces all the vectors.
+  const std::string allInput =
+      "(SELECT * FROM tmp UNION ALL SELECT * FROM tmp "
+      "UNION ALL SELECT * FROM tmp UNION ALL SELECT * FROM tmp)";
+
+  params.planNode =
+      PlanBuilder()
+          .values(vectors, true)
+          .singleAggregation(
+              {0, 2}, {"sum(c1)", "count(1)", "min(c2)", "max(c1)"})
+          .planNode();
+  auto task = assertQuery(
+      params,
+      "SELECT c0, c2, sum(c1), count(1), min(c2), max(c1) FROM " + allInput +
+          " GROUP BY 1, 2");
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  EXPECT_EQ(kNumDrivers, stats[1].runtimeStats["sharedAggregationTable"].sum);
+
+  params.planNode = PlanBuilder()
+                        .values(vectors, true)
+                        .partialAggregation({0}, {"sum(c1)", "max(c2)"})
+                        .finalAggregation({0}, {"sum(a0)", "max(a1)"})
+                        .planNode();
+  task = assertQuery(
+      params,
+      "SELECT c0, sum(c1), max(c2) FROM " + allInput + " GROUP BY 1");
+  stats = task->taskStats().pipelineStats[0].operatorStats;
+  EXPECT_EQ(kNumDrivers, stats[2].runtimeStats["sharedAggregationTable"].sum);
+
+  // DISTINCT aggregates keep running on a single Driver, which produces the
+  // vectors once.
+  params.planNode = PlanBuilder()
+                        .values(vectors, true)
+                        .aggregation(
+                            {0},
+                            {"count(c1)"},
+                            {},
+                            core::AggregationNode::Step::kSingle,
+                            false,
+                            {},
+                            {true})
+                        .planNode();
+  task = assertQuery(
+      params,
+      "SELECT c0, count(DISTINCT c1) FROM tmp GROUP BY 1");
+  stats = task->taskStats().pipelineStats[0].operatorStats;
+  EXPECT_EQ(0, stats[1].runtimeStats["sharedAggregationTable"].count);
+}
+
+TEST_F(AggregationTest, manyFixedWidthAggregates) {
+  // Batches larger than a block of rows with many groups, so that the
+  // accumulators are updated one block of rows at a time.
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 4; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int32_t>(
+             5'000, [&](auto row) { return (row * 7 + i) % 3'001; }),
+         makeFlatVector<int64_t>(
+             5'000, [&](auto row) { return row * i; }, nullEvery(5)),
+         makeFlatVector<double>(5'000, [](auto row) { return row * 0.25; }),
+         makeFlatVector<bool>(5'000, [](auto row) { return row % 3 == 0; }),
+         makeFlatVector<bool>(5'000, [](auto row) { return row % 4 == 0; })}));
+  }
+  createDuckDbTable(vectors);
+
+  std::vector<std::string> aggregates = {
+      "sum(c1)",
+      "min(c1)",
+      "max(c1)",
+      "count(c1)",
+      "sum(c2)",
+      "min(c2)",
+      "max(c2)",
+      "avg(c2)",
+      "count(1)"};
+  auto sql =
+      "SELECT c0, sum(c1), min(c1), max(c1), count(c1), sum(c2), min(c2), "
+      "max(c2), avg(c2), count(1) FROM tmp GROUP BY 1";
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .aggregation(
+                      {0},
+                      aggregates,
+                      {},
+                      core::AggregationNode::Step::kSingle,
+                      false)
+                  .planNode();
+  assertQuery(plan, sql);
+
+  plan = PlanBuilder()
+             .values(vectors)
+             .partialAggregation({0}, aggregates)
+             .finalAggregation(
+                 {0},
+                 {"sum(a0)",
+                  "min(a1)",
+                  "max(a2)",
+                  "count(a3)",
+                  "sum(a4)",
+                  "min(a5)",
+                  "max(a6)",
+                  "avg(a7)",
+                  "count(a8)"},
+                 {BIGINT(),
+                  BIGINT(),
+                  BIGINT(),
+                  BIGINT(),
+                  DOUBLE(),
+                  DOUBLE(),
+                  DOUBLE(),
+                  DOUBLE(),
+                  BIGINT()})
+             .planNode();
+  assertQuery(plan, sql);
+
+  // Masks select different rows of each block for different aggregates.
+  std::vector<std::string> masks;
+  for (auto i = 0; i < aggregates.size(); ++i) {
+    masks.push_back(i % 2 ? "c4" : "c3");
+  }
+  plan = PlanBuilder()
+             .values(vectors)
+             .aggregation(
+                 {0},
+                 aggregates,
+                 masks,
+                 core::AggregationNode::Step::kSingle,
+                 false)
+             .planNode();
+  assertQuery(
+      plan,
+      "SELECT c0, sum(c1) filter (where c3), min(c1) filter (where c4), "
+      "max(c1) filter (where c3), count(c1) filter (where c4), "
+      "sum(c2) filter (where c3), min(c2) filter (where c4), "
+      "max(c2) filter (where c3), avg(c2) filter (where c4), "
+      "count(1) filter (where c3) FROM tmp GROUP BY 1");
+}
+
+TEST_F(AggregationTest, distinctAggregates) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 5; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(1'000, [](auto row) { return row % 17; }),
+         makeFlatVector<int32_t>(
+             1'000, [&](auto row) { return (row + i) % 23; }, nullEvery(7)),
+         makeFlatVector<StringView>(1'000, [](auto row) {
+           return StringView(fmt::format("string value {}", row % 13));
+         })}));
+  }
+  createDuckDbTable(vectors);
+
+  // Mixes DISTINCT and plain aggregates over the same and different
+  // columns.
+  auto plan =
+      PlanBuilder()
+          .values(vectors)
+          .aggregation(
+              {0},
+              {"count(c1)", "sum(c1)", "sum(c1)", "count(c2)", "count(1)"},
+              {},
+              core::AggregationNode::Step::kSingle,
+              false,
+              {},
+              {true, true, false, true, false})
+          .planNode();
+  assertQuery(
+      plan,
+      "SELECT c0, count(DISTINCT c1), sum(DISTINCT c1), sum(c1), "
+      "count(DISTINCT c2), count(1) FROM tmp GROUP BY 1");
+
+  plan = PlanBuilder()
+             .values(vectors)
+             .aggregation(
+                 {},
+                 {"count(c1)", "sum(c0)", "max(c2)"},
+                 {},
+                 core::AggregationNode::Step::kSingle,
+                 false,
+                 {},
+                 {true, true, false})
+             .planNode();
+  assertQuery(
+      plan,
+      "SELECT count(DISTINCT c1), sum(DISTINCT c0), max(c2) FROM tmp");
+
+  // Partial aggregation cannot drop duplicates.
+  EXPECT_THROW(
+      PlanBuilder()
+          .values(vectors)
+          .aggregation(
+              {0},
+              {"count(c1)"},
+              {},
+              core::AggregationNode::Step::kPartial,
+              false,
+              {},
+              {true}),
+      VeloxRuntimeError);
+}
+
 } // namespace
 } // namespace facebook::velox::exec::test
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/AllocationPool.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+
+TEST(AllocationPoolTest, geometricGrowth) {
+  auto tracker = memory::MemoryUsageTracker::create();
+  auto mappedMemory = memory::MappedMemory::getInstance()->addChild(tracker);
+  AllocationPool pool(mappedMemory.get());
+  constexpr int64_t kPageSize = memory::MappedMemory::kPageSize;
+
+  // Each new allocation is twice the size of the previous one until
+  // kMaxPages.
+  int64_t expectedBytes = 0;
+  int32_t numPages = AllocationPool::kMinPages;
+  for (auto i = 0; i < 8; ++i) {
+    auto allocated = pool.allocatedBytes();
+    // Fills the current allocation and starts a new one.
+    while (pool.allocatedBytes() == allocated) {
+      pool.allocateFixed(kPageSize);
+    }
+    expectedBytes += numPages * kPageSize;
+    EXPECT_EQ(expectedBytes, pool.allocatedBytes());
+    numPages = std::min(2 * numPages, AllocationPool::kMaxPages);
+  }
+  EXPECT_EQ(expectedBytes, tracker->getCurrentTotalBytes());
+
+  // Clearing starts over from the minimum.
+  pool.clear();
+  EXPECT_EQ(0, tracker->getCurrentTotalBytes());
+  pool.allocateFixed(kPageSize);
+  EXPECT_EQ(AllocationPool::kMinPages * kPageSize, pool.allocatedBytes());
+}
@@ -220,3 +220,72 @@ TEST_F(CrossJoinTest, zeroColumnBuild) {
 
   assertQuery(op, "SELECT * FROM t");
 }
+
+TEST_F(CrossJoinTest, largeBuild) {
+  auto leftVectors = {makeRowVector({sequence<int32_t>(10)})};
+  auto rightVectors = {
+      makeRowVector({sequence<int32_t>(3'000)}),
+      makeRowVector({sequence<int32_t>(100, 3'000)}),
+  };
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  CursorParameters params;
+  params.planNode = PlanBuilder(10)
+                        .values({leftVectors})
+                        .crossJoin(
+                            PlanBuilder(0)
+                                .values({rightVectors})
+                                .project({"c0"}, {"u_c0"})
+                                .planNode(),
+                            {0, 1})
+                        .planNode();
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe(
+      {{core::QueryConfig::kPreferredOutputBatchSize, "1000"}});
+
+  // The large build side vector is output in ranges of rows.
+  auto [cursor, results] = readCursor(params, [](Task*) {});
+  for (const auto& result : results) {
+    EXPECT_LE(result->size(), 1'000);
+  }
+  OperatorTestBase::assertQuery(params, "SELECT * FROM t, u");
+}
+
+TEST_F(CrossJoinTest, filter) {
+  auto leftVectors = {
+      makeRowVector({sequence<int32_t>(10)}),
+      makeRowVector({sequence<int32_t>(100, 10)}),
+  };
+  auto rightVectors = {
+      makeRowVector({sequence<int32_t>(7)}),
+      makeRowVector({sequence<int32_t>(2'000, 7)}),
+  };
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto buildSide =
+      PlanBuilder(0).values({rightVectors}).project({"c0"}, {"u_c0"});
+
+  auto op = PlanBuilder(10)
+                .values({leftVectors})
+                .crossJoin(buildSide.planNode(), {0, 1}, "c0 + u_c0 < 100")
+                .planNode();
+  assertQuery(op, "SELECT * FROM t, u WHERE t.c0 + u.c0 < 100");
+
+  // The filter refers to a build side column that is not in the output.
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .crossJoin(buildSide.planNode(), {0}, "u_c0 % 500 = c0")
+           .planNode();
+  assertQuery(op, "SELECT t.c0 FROM t, u WHERE u.c0 % 500 = t.c0");
+
+  // No row passes.
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .crossJoin(buildSide.planNode(), {0, 1}, "c0 > u_c0 + 10000")
+           .planNode();
+  assertQueryReturnsEmptyResult(op);
+}
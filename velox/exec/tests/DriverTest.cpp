@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 #include <folly/init/Init.h>
+#include <folly/json.h>
+#include <gflags/gflags.h>
+#include "velox/common/process/PerfCounters.h"
 #include "velox/dwio/dwrf/test/utils/BatchMaker.h"
 #include "velox/exec/tests/utils/Cursor.h"
 #include "velox/exec/tests/utils/OperatorTestBase.h"
@@ -25,6 +28,11 @@ using namespace facebook::velox::exec::test;
 
 using facebook::velox::test::BatchMaker;
 
+DECLARE_int32(velox_driver_time_slice_ms);
+DECLARE_int32(velox_num_driver_priority_levels);
+DECLARE_int32(velox_operator_timing_sample_rate);
+DECLARE_bool(velox_operator_perf_counters);
+
 // A PlanNode that passes its input to its output and makes variable
 // memory reservations.
 // A PlanNode that passes its input to its output and periodically
@@ -416,7 +424,23 @@ TEST_F(DriverTest, slow) {
   ASSERT_TRUE(!stats.empty() && !stats[0].operatorStats.empty());
   // Check that the blocking of the CallbackSink at the end of the pipeline is
   // recorded.
-  EXPECT_GT(stats[0].operatorStats.back().blockedWallNanos, 0);
+  const auto& sinkStats = stats[0].operatorStats.back();
+  EXPECT_GT(sinkStats.blockedWallNanos, 0);
+  // The blocked time is split by reason and summed per pipeline and Task.
+  const auto consumer = static_cast<int32_t>(BlockingReason::kWaitForConsumer);
+  EXPECT_GT(sinkStats.blockedWallNanosByReason[consumer], 0);
+  uint64_t sum = 0;
+  for (auto nanos : sinkStats.blockedWallNanosByReason) {
+    sum += nanos;
+  }
+  EXPECT_EQ(sinkStats.blockedWallNanos, sum);
+  EXPECT_GE(
+      stats[0].blockedWallNanosByReason[consumer],
+      sinkStats.blockedWallNanosByReason[consumer]);
+  EXPECT_EQ(
+      tasks_[0]->taskStats().blockedWallNanosByReason[consumer],
+      stats[0].blockedWallNanosByReason[consumer]);
+  EXPECT_GT(tasks_[0]->taskStats().queuedWallNanos, 0);
   EXPECT_TRUE(stateFutures_.at(0).isReady());
   // The future was realized by timeout.
   EXPECT_TRUE(stateFutures_.at(0).hasException());
@@ -484,6 +508,168 @@ TEST_F(DriverTest, yield) {
   }
 }
 
+TEST_F(DriverTest, timeSlice) {
+  constexpr int32_t kNumTasks = 10;
+  constexpr int32_t kThreadsPerTask = 4;
+  {
+    gflags::FlagSaver flagSaver;
+    // Drivers yield after 1ms on thread and are queued by the CPU time of
+    // their Task.
+    FLAGS_velox_driver_time_slice_ms = 1;
+    FLAGS_velox_num_driver_priority_levels = 3;
+    Driver::testingJoinAndReinitializeExecutor(4);
+
+    std::vector<int32_t> counters(kNumTasks, 0);
+    std::vector<CursorParameters> params(kNumTasks);
+    int32_t hits;
+    for (int32_t i = 0; i < kNumTasks; ++i) {
+      params[i].planNode = makeValuesFilterProject(
+          rowType_,
+          "m1 % 10 > 0",
+          "m1 % 3 + m2 % 5 + m3 % 7 + m4 % 11 + m5 % 13 + m6 % 17 + m7 % 19",
+          100,
+          2'000,
+          [](int64_t num) { return num % 10 > 0; },
+          &hits);
+      params[i].maxDrivers = kThreadsPerTask;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(kNumTasks);
+    for (int32_t i = 0; i < kNumTasks; ++i) {
+      threads.push_back(std::thread([this, &params, &counters, i]() {
+        readResults(
+            params[i], ResultOperation::kRead, 1'000'000, &counters[i], i);
+      }));
+    }
+    for (int32_t i = 0; i < kNumTasks; ++i) {
+      threads[i].join();
+      EXPECT_WITH_DELAY(stateFutures_.at(i).isReady());
+      EXPECT_EQ(counters[i], kThreadsPerTask * hits);
+    }
+    for (auto& task : tasks_) {
+      EXPECT_GT(task->driverCpuNanos(), 0);
+    }
+  }
+  // Goes back to the executor without priorities for the other tests.
+  Driver::testingJoinAndReinitializeExecutor();
+}
+
+TEST_F(DriverTest, sampledTiming) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_velox_operator_timing_sample_rate = 10;
+  CursorParameters params;
+  params.planNode = makeValuesFilterProject(
+      rowType_, "m1 % 10 > 0", "m1 % 3 + m2 % 5", 100, 1'000);
+  int32_t numRead = 0;
+  readResults(params, ResultOperation::kRead, 1'000'000, &numRead);
+  auto& executor = folly::QueuedImmediateExecutor::instance();
+  tasks_[0]->finishFuture().via(&executor).wait();
+  EXPECT_WITH_DELAY(tasks_[0]->numDrivers() == 0);
+  const auto stats = tasks_[0]->taskStats().pipelineStats;
+  ASSERT_TRUE(!stats.empty() && !stats[0].operatorStats.empty());
+  // Every call is counted. 1 in 10 is timed and stands for 10.
+  const auto& timing = stats[0].operatorStats[0].getOutputTiming;
+  EXPECT_GT(timing.count, 100);
+  EXPECT_GT(timing.wallNanos, 0);
+}
+
+TEST_F(DriverTest, perfCounters) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_velox_operator_perf_counters = true;
+  CursorParameters params;
+  params.planNode = makeValuesFilterProject(
+      rowType_, "m1 % 10 > 0", "m1 % 3 + m2 % 5", 100, 1'000);
+  int32_t numRead = 0;
+  readResults(params, ResultOperation::kRead, 1'000'000, &numRead);
+  auto& executor = folly::QueuedImmediateExecutor::instance();
+  tasks_[0]->finishFuture().via(&executor).wait();
+  EXPECT_WITH_DELAY(tasks_[0]->numDrivers() == 0);
+  const auto stats = tasks_[0]->taskStats().pipelineStats;
+  ASSERT_TRUE(!stats.empty() && !stats[0].operatorStats.empty());
+  const auto& runtimeStats = stats[0].operatorStats[0].runtimeStats;
+  const auto available = process::PerfCounters::available();
+  // Perf events may not be permitted where the test runs.
+  for (auto i = 0; i < process::kNumPerfEvents; ++i) {
+    auto name = process::perfEventName(static_cast<process::PerfEvent>(i));
+    if (available & (1U << i)) {
+      ASSERT_EQ(1, runtimeStats.count(name)) << name;
+      EXPECT_GT(runtimeStats.at(name).count, 0);
+    } else {
+      EXPECT_EQ(0, runtimeStats.count(name)) << name;
+    }
+  }
+}
+
+TEST_F(DriverTest, trace) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_velox_driver_trace = true;
+  DriverTracer::clear();
+  CursorParameters params;
+  params.planNode = makeValuesFilterProject(
+      rowType_, "m1 % 10 > 0", "m1 % 3 + m2 % 5", 100, 1'000);
+  params.maxDrivers = 2;
+  int32_t numRead = 0;
+  readResults(params, ResultOperation::kRead, 1'000'000, &numRead);
+  auto& executor = folly::QueuedImmediateExecutor::instance();
+  tasks_[0]->finishFuture().via(&executor).wait();
+  EXPECT_WITH_DELAY(tasks_[0]->numDrivers() == 0);
+  FLAGS_velox_driver_trace = false;
+
+  auto taskNameId = DriverTracer::nameId(tasks_[0]->taskId());
+  int32_t numGetOutput = 0;
+  for (const auto& event : DriverTracer::events()) {
+    if (event.taskNameId == taskNameId &&
+        event.kind == DriverTraceEventKind::kGetOutput) {
+      EXPECT_EQ(event.pipelineId, 0);
+      EXPECT_LT(event.driverId, 2);
+      ++numGetOutput;
+    }
+  }
+  EXPECT_GT(numGetOutput, 100);
+
+  auto trace = folly::parseJson(DriverTracer::toChromeTrace());
+  bool hasTask = false;
+  bool hasCall = false;
+  for (const auto& event : trace["traceEvents"]) {
+    if (event["ph"] == "M" && event["name"] == "process_name" &&
+        event["args"]["name"] == tasks_[0]->taskId()) {
+      hasTask = true;
+    }
+    if (event["ph"] == "X" && event["cat"] == "getOutput" &&
+        event["pid"] == taskNameId) {
+      hasCall = true;
+    }
+  }
+  EXPECT_TRUE(hasTask);
+  EXPECT_TRUE(hasCall);
+  DriverTracer::clear();
+}
+
+TEST_F(DriverTest, traceRingBuffer) {
+  gflags::FlagSaver flagSaver;
+  FLAGS_velox_driver_trace_events_per_thread = 4;
+  DriverTracer::clear();
+  auto taskNameId = DriverTracer::nameId("traceRingBuffer");
+  // A new thread gets a buffer of 4 events and keeps the last 4 of 10.
+  std::thread([&]() {
+    for (auto i = 0; i < 10; ++i) {
+      DriverTraceEvent event;
+      event.startNanos = i;
+      event.taskNameId = taskNameId;
+      DriverTracer::record(event);
+    }
+  }).join();
+  std::vector<uint64_t> starts;
+  for (const auto& event : DriverTracer::events()) {
+    if (event.taskNameId == taskNameId) {
+      starts.push_back(event.startNanos);
+    }
+  }
+  EXPECT_EQ(starts, (std::vector<uint64_t>{6, 7, 8, 9}));
+  DriverTracer::clear();
+  EXPECT_TRUE(DriverTracer::events().empty());
+}
+
 // A testing Operator that periodically does one of the following:
 //
 // 1. Blocks and registers a resume that continues the Driver after a timed
@@ -310,3 +310,96 @@ TEST_F(FilterProjectTest, filterProjectFused) {
       plan,
       "SELECT c0, c1, c0 %100 + c1 % 50, c0 % 100 FROM tmp WHERE c0 % 10 < 5");
 }
+
+TEST_F(FilterProjectTest, exprStats) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector({makeFlatVector<int64_t>(
+        100, [&](auto row) { return i * 100 + row; })}));
+  }
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe(
+      {{core::QueryConfig::kExprTrackStats, "true"}});
+  params.planNode = PlanBuilder()
+                        .values(vectors)
+                        .filter("c0 % 10 < 9")
+                        .project(std::vector<std::string>{"c0 % 100 + c0"})
+                        .planNode();
+  auto sql = "SELECT c0 % 100 + c0 FROM tmp WHERE c0 % 10 < 9";
+  auto task = assertQuery(params, sql);
+
+  // The filter is the first expression and the projection the second.
+  auto runtimeStats =
+      task->taskStats().pipelineStats[0].operatorStats[1].runtimeStats;
+  EXPECT_EQ(10, runtimeStats.at("expr.0:lt.numCalls").sum);
+  EXPECT_EQ(1'000, runtimeStats.at("expr.0:lt.numRows").sum);
+  EXPECT_EQ(1'000, runtimeStats.at("expr.0.0:mod.numRows").sum);
+  EXPECT_EQ(10, runtimeStats.at("expr.1:plus.numCalls").sum);
+  EXPECT_EQ(900, runtimeStats.at("expr.1:plus.numRows").sum);
+  EXPECT_EQ(900, runtimeStats.at("expr.1.0:mod.numRows").sum);
+  EXPECT_EQ(1, runtimeStats.count("expr.1.0:mod.cpuNanos"));
+
+  // Stats are not collected by default.
+  params.queryCtx = core::QueryCtx::create();
+  task = assertQuery(params, sql);
+  runtimeStats =
+      task->taskStats().pipelineStats[0].operatorStats[1].runtimeStats;
+  EXPECT_EQ(0, runtimeStats.count("expr.0:lt.numCalls"));
+}
+
+TEST_F(FilterProjectTest, coalesceOutput) {
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 20; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(
+             1'000, [&](auto row) { return i * 1'000 + row; }),
+         makeFlatVector<int64_t>(1'000, [](auto row) { return row % 7; })}));
+  }
+  auto build = makeRowVector(
+      {"u0"},
+      {makeFlatVector<int64_t>(7, [](auto row) { return row; })});
+  createDuckDbTable("t", vectors);
+  createDuckDbTable("u", {build});
+
+  // Returns the FilterProject stats of a filter feeding a HashProbe.
+  auto runJoin = [&](const std::string& filter, bool coalesce) {
+    CursorParameters params;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe(
+        {{core::QueryConfig::kCoalesceFilterOutputEnabled,
+          coalesce ? "true" : "false"}});
+    params.planNode =
+        PlanBuilder()
+            .values(vectors)
+            .filter(filter)
+            .hashJoin(
+                {1}, {0}, PlanBuilder(10).values({build}).planNode(), "", {0})
+            .planNode();
+    auto task = assertQuery(
+        params, "SELECT c0 FROM t, u WHERE c1 = u0 AND " + filter);
+    for (auto& pipeline : task->taskStats().pipelineStats) {
+      for (auto& op : pipeline.operatorStats) {
+        if (op.operatorType == "FilterProject") {
+          return op;
+        }
+      }
+    }
+    VELOX_FAIL("No FilterProject");
+  };
+
+  // 1% of the rows pass. The 200 rows come out in a single batch.
+  auto stats = runJoin("c0 % 100 = 0", true);
+  EXPECT_EQ(200, stats.outputPositions);
+  EXPECT_EQ(1, stats.runtimeStats.at("coalescedBatches").sum);
+
+  stats = runJoin("c0 % 100 = 0", false);
+  EXPECT_EQ(0, stats.runtimeStats.count("coalescedBatches"));
+
+  // Most rows pass. The batches are not copied.
+  stats = runJoin("c0 % 10 > 0", true);
+  EXPECT_EQ(18'000, stats.outputPositions);
+  EXPECT_EQ(0, stats.runtimeStats.count("coalescedBatches"));
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/FragmentResultCache.h"
+#include "velox/common/caching/FileIds.h"
+#include "velox/common/caching/SsdCache.h"
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+
+#include <unistd.h>
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+using facebook::velox::memory::MappedMemory;
+
+class FragmentResultCacheTest : public OperatorTestBase {
+ protected:
+  void initializeCache(int64_t maxBytes, int64_t ssdBytes = 0) {
+    std::unique_ptr<cache::SsdCache> ssdCache;
+    if (ssdBytes) {
+      ssdCache = std::make_unique<cache::SsdCache>(
+          fmt::format("/tmp/fragment_result_cache_test_{}_", getpid()),
+          ssdBytes,
+          1,
+          nullptr);
+    }
+    cache_ = std::make_unique<cache::AsyncDataCache>(
+        MappedMemory::createDefaultInstance(), maxBytes, std::move(ssdCache));
+  }
+
+  std::vector<RowVectorPtr> makeResults(int32_t numBatches, int32_t size) {
+    std::vector<RowVectorPtr> results;
+    for (auto i = 0; i < numBatches; ++i) {
+      results.push_back(makeRowVector({
+          makeFlatVector<int64_t>(size, [&](auto row) { return i + row; }),
+          makeFlatVector<StringView>(
+              size,
+              [&](auto row) {
+                return StringView(fmt::format("group {} {}", i, row));
+              },
+              [](auto row) { return row % 7 == 0; }),
+      }));
+    }
+    return results;
+  }
+
+  void assertResults(
+      const std::vector<RowVectorPtr>& expected,
+      const std::vector<RowVectorPtr>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (auto i = 0; i < expected.size(); ++i) {
+      assertEqualVectors(expected[i], actual[i]);
+    }
+  }
+
+  std::unique_ptr<cache::AsyncDataCache> cache_;
+};
+
+TEST_F(FragmentResultCacheTest, putAndGet) {
+  initializeCache(64 << 20);
+  FragmentResultCache resultCache(cache_.get());
+  auto results = makeResults(3, 1'000);
+  auto type = asRowType(results[0]->type());
+  std::vector<RowVectorPtr> cached;
+  EXPECT_FALSE(resultCache.get("large", type, pool_.get(), cached));
+  EXPECT_TRUE(resultCache.put("large", results));
+  EXPECT_TRUE(resultCache.get("large", type, pool_.get(), cached));
+  assertResults(results, cached);
+
+  // Results under kTinyDataSize and empty results.
+  auto small = makeResults(1, 3);
+  EXPECT_TRUE(resultCache.put("small", small));
+  EXPECT_TRUE(resultCache.get("small", type, pool_.get(), cached));
+  assertResults(small, cached);
+  EXPECT_TRUE(resultCache.put("empty", {}));
+  EXPECT_TRUE(resultCache.get("empty", type, pool_.get(), cached));
+  EXPECT_TRUE(cached.empty());
+
+  EXPECT_FALSE(resultCache.get("other", type, pool_.get(), cached));
+
+  // Results over kMaxEntryBytes are not kept.
+  auto tooLarge = makeResults(1, FragmentResultCache::kMaxEntryBytes / 8);
+  EXPECT_FALSE(resultCache.put("tooLarge", tooLarge));
+  EXPECT_FALSE(resultCache.get("tooLarge", type, pool_.get(), cached));
+}
+
+TEST_F(FragmentResultCacheTest, ssd) {
+  constexpr int32_t kSize = 1 << 20;
+  initializeCache(16 << 20, cache::SsdFile::kRegionSize);
+  FragmentResultCache resultCache(cache_.get());
+  auto results = makeResults(3, 1'000);
+  auto type = asRowType(results[0]->type());
+  EXPECT_TRUE(resultCache.put("results", results));
+
+  // Fills the cache with other entries, so that the entries of the results
+  // move to SSD.
+  StringIdLease filler(fileIds(), "fragment_result_cache_test_filler");
+  for (auto i = 0; i < 40; ++i) {
+    auto pin = cache_->findOrCreate(
+        {filler.id(), static_cast<uint64_t>(i) * kSize}, kSize);
+    ASSERT_FALSE(pin.empty());
+    pin.entry()->setValid();
+  }
+  EXPECT_LT(0, cache_->ssdCache()->stats().entriesWritten);
+
+  std::vector<RowVectorPtr> cached;
+  EXPECT_TRUE(resultCache.get("results", type, pool_.get(), cached));
+  assertResults(results, cached);
+  EXPECT_LT(0, cache_->ssdCache()->stats().entriesRead);
+}
@@ -18,6 +18,7 @@
 #include "velox/exec/tests/utils/Cursor.h"
 #include "velox/exec/tests/utils/HiveConnectorTestBase.h"
 #include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/exec/tests/utils/TempDirectoryPath.h"
 #include "velox/type/tests/FilterBuilder.h"
 #include "velox/type/tests/SubfieldFiltersBuilder.h"
 
@@ -280,6 +281,65 @@ TEST_F(HashJoinTest, lazyVectors) {
       "SELECT t.c1 + 1 FROM t, u WHERE t.c0 = u.c0");
 }
 
+TEST_F(HashJoinTest, lazyBuildOutput) {
+  auto leftVectors = makeRowVector({
+      makeFlatVector<int32_t>(1'000, [](auto row) { return row % 23; }),
+      makeFlatVector<int64_t>(1'000, [](auto row) { return row; }),
+  });
+
+  auto rightVectors = makeRowVector({
+      makeFlatVector<int32_t>(1'000, [](auto row) { return row % 31; }),
+      makeFlatVector<int64_t>(
+          1'000, [](auto row) { return row * 3; }, nullEvery(9)),
+      makeFlatVector<StringView>(1'000, [](auto row) {
+        return StringView(std::string(row % 17 + 10, 'a' + row % 26));
+      }),
+  });
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto buildSide = PlanBuilder(0)
+                       .values({rightVectors})
+                       .project({"c0", "c1", "c2"}, {"u_c0", "u_c1", "u_c2"})
+                       .planNode();
+
+  // The build side columns are loaded only for the rows that pass the
+  // filter after the join.
+  auto op = PlanBuilder(10)
+                .values({leftVectors})
+                .hashJoin({0}, {0}, buildSide, "", {1, 3, 4})
+                .filter("c1 % 7 = 0")
+                .planNode();
+  assertQuery(
+      op,
+      "SELECT t.c1, u.c1, u.c2 FROM t, u WHERE t.c0 = u.c0 AND t.c1 % 7 = 0");
+
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .hashJoin({0}, {0}, buildSide, "", {1, 3, 4})
+           .project({"c1 + u_c1"})
+           .planNode();
+  assertQuery(op, "SELECT t.c1 + u.c1 FROM t, u WHERE t.c0 = u.c0");
+
+  // Left join with a filter on a subset of the build side columns. The
+  // misses have null build side columns.
+  op = PlanBuilder(10)
+           .values({leftVectors})
+           .hashJoin(
+               {0},
+               {0},
+               buildSide,
+               "u_c1 % 5 = 0",
+               {1, 3, 4},
+               core::JoinType::kLeft)
+           .planNode();
+  assertQuery(
+      op,
+      "SELECT t.c1, u.c1, u.c2 FROM t LEFT JOIN u "
+      "ON t.c0 = u.c0 AND u.c1 % 5 = 0");
+}
+
 /// Test hash join where build-side keys come from a small range and allow for
 /// array-based lookup instead of a hash table.
 TEST_F(HashJoinTest, arrayBasedLookup) {
@@ -357,6 +417,85 @@ TEST_F(HashJoinTest, innerJoinWithEmptyBuild) {
   assertQueryReturnsEmptyResult(op);
 }
 
+TEST_F(HashJoinTest, spill) {
+  std::vector<RowVectorPtr> leftVectors;
+  std::vector<RowVectorPtr> rightVectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    leftVectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            1'000,
+            [&](auto row) { return (row * 11 + i * 1'000) % 3'001; },
+            nullEvery(17)),
+        makeFlatVector<int32_t>(1'000, [](auto row) { return row; }),
+    }));
+    rightVectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            1'000, [&](auto row) { return (row * 7 + i * 1'000) % 5'003; }),
+        makeFlatVector<StringView>(1'000, [](auto row) {
+          return StringView(fmt::format("string value {}", row % 113));
+        }),
+    }));
+  }
+  createDuckDbTable("t", leftVectors);
+  createDuckDbTable("u", rightVectors);
+
+  auto spillDirectory = TempDirectoryPath::create();
+  CursorParameters params;
+  params.maxDrivers = 4;
+  params.queryCtx = core::QueryCtx::create();
+  // Set a threshold low enough to spill most partitions.
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kSpillEnabled, "true"},
+      {core::QueryConfig::kSpillPath, spillDirectory->path},
+      {core::QueryConfig::kJoinSpillMemoryThreshold, "100000"},
+  });
+
+  auto assertSpilled = [](const std::shared_ptr<Task>& task) {
+    int64_t spilledRows = 0;
+    for (auto& pipeline : task->taskStats().pipelineStats) {
+      for (auto& op : pipeline.operatorStats) {
+        if (op.operatorType == "HashBuild") {
+          spilledRows += op.runtimeStats["spilledRows"].sum;
+        }
+      }
+    }
+    ASSERT_GT(spilledRows, 0);
+  };
+
+  // Rename the build side columns to keep the join output names unique.
+  auto buildSide = PlanBuilder(0)
+                       .values(rightVectors, true)
+                       .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                       .planNode();
+  params.planNode = PlanBuilder(10)
+                        .values(leftVectors, true)
+                        .hashJoin(
+                            {0},
+                            {0},
+                            buildSide,
+                            "",
+                            {0, 1, 3})
+                        .planNode();
+  auto task = assertQuery(
+      params, "SELECT t.c0, t.c1, u.c1 FROM t, u WHERE t.c0 = u.c0");
+  assertSpilled(task);
+
+  // The join filter applies to the rows of the spilled partitions too.
+  params.planNode = PlanBuilder(10)
+                        .values(leftVectors, true)
+                        .hashJoin(
+                            {0},
+                            {0},
+                            buildSide,
+                            "c1 % 3 = 0",
+                            {0, 1, 3})
+                        .planNode();
+  task = assertQuery(
+      params,
+      "SELECT t.c0, t.c1, u.c1 FROM t, u WHERE t.c0 = u.c0 AND t.c1 % 3 = 0");
+  assertSpilled(task);
+}
+
 TEST_F(HashJoinTest, semiJoin) {
   auto leftVectors = makeRowVector({
       makeFlatVector<int32_t>(
@@ -402,6 +541,63 @@ TEST_F(HashJoinTest, semiJoin) {
       op, "SELECT t.c1 FROM t WHERE t.c0 IN (SELECT c0 FROM u WHERE c0 < 0)");
 }
 
+TEST_F(HashJoinTest, semiJoinDistinctKeys) {
+  // The build side has many duplicate keys and a payload column that the
+  // table does not store.
+  std::vector<RowVectorPtr> leftVectors;
+  std::vector<RowVectorPtr> rightVectors;
+  for (auto i = 0; i < 5; ++i) {
+    leftVectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            1'000, [&](auto row) { return (row + i * 1'000) * 13; }),
+        makeFlatVector<int64_t>(1'000, [&](auto row) { return row + i; }),
+    }));
+    rightVectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            1'000,
+            [&](auto row) { return (row * 7 + i * 1'000) % 3'001 * 26; },
+            nullEvery(17)),
+        makeFlatVector<StringView>(1'000, [](auto row) {
+          return StringView(fmt::format("payload {}", row));
+        }),
+    }));
+  }
+  createDuckDbTable("t", leftVectors);
+  createDuckDbTable("u", rightVectors);
+
+  CursorParameters params;
+  params.maxDrivers = 4;
+
+  // Each of the 4 Drivers on either side reads all the vectors, so that
+  // the build side tables of the Drivers have the same keys.
+  auto makePlan = [&](core::JoinType joinType) {
+    // Anti join returns nothing if the build side has null keys.
+    auto buildSide = PlanBuilder(0).values(rightVectors, true);
+    if (joinType == core::JoinType::kAnti) {
+      buildSide.filter("c0 IS NOT NULL");
+    }
+    return PlanBuilder(10)
+        .values(leftVectors, true)
+        .hashJoin({0}, {0}, buildSide.planNode(), "", {1}, joinType)
+        .planNode();
+  };
+
+  auto repeat = [](const std::string& sql) {
+    return fmt::format(
+        "{} UNION ALL {} UNION ALL {} UNION ALL {}", sql, sql, sql, sql);
+  };
+
+  params.planNode = makePlan(core::JoinType::kSemi);
+  OperatorTestBase::assertQuery(
+      params, repeat("SELECT t.c1 FROM t WHERE t.c0 IN (SELECT c0 FROM u)"));
+
+  params.planNode = makePlan(core::JoinType::kAnti);
+  OperatorTestBase::assertQuery(
+      params,
+      repeat("SELECT t.c1 FROM t WHERE t.c0 NOT IN "
+             "(SELECT c0 FROM u WHERE c0 IS NOT NULL)"));
+}
+
 TEST_F(HashJoinTest, antiJoin) {
   auto leftVectors = makeRowVector({
       makeFlatVector<int32_t>(
@@ -704,6 +900,158 @@ TEST_F(HashJoinTest, dynamicFilters) {
   }
 }
 
+TEST_F(HashJoinTest, bloomFilterDynamicFilter) {
+  std::vector<RowVectorPtr> leftVectors;
+  auto leftFiles = makeFilePaths(20);
+  for (int i = 0; i < 20; i++) {
+    auto rowVector = makeRowVector({
+        makeFlatVector<int64_t>(
+            1'024, [&](auto row) { return (i * 1'024 + row) * 7; }),
+        makeFlatVector<int64_t>(1'024, [](auto row) { return row; }),
+    });
+    leftVectors.push_back(rowVector);
+    writeToFile(leftFiles[i]->path, kWriter, rowVector);
+  }
+
+  // Too many distinct keys for an exact filter. Every 1000th probe row has
+  // a match.
+  auto rightVectors = {makeRowVector({
+      makeFlatVector<int64_t>(120'000, [](auto row) { return row * 7'000; }),
+      makeFlatVector<int64_t>(120'000, [](auto row) { return row; }),
+  })};
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto probeType = ROW({"c0", "c1"}, {BIGINT(), BIGINT()});
+  auto buildSide = PlanBuilder(0)
+                       .values(rightVectors)
+                       .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                       .planNode();
+
+  auto op =
+      PlanBuilder(10)
+          .tableScan(probeType)
+          .hashJoin(
+              {0}, {0}, buildSide, "", {0, 1, 3}, core::JoinType::kInner)
+          .project({"c0", "c1 + 1", "c1 + u_c1"})
+          .planNode();
+
+  auto task = assertQuery(
+      op,
+      {{10, leftFiles}},
+      "SELECT t.c0, t.c1 + 1, t.c1 + u.c1 FROM t, u WHERE t.c0 = u.c0");
+  EXPECT_EQ(1, getFiltersProduced(task, 1).sum);
+  EXPECT_EQ(1, getFiltersAccepted(task, 0).sum);
+  // A Bloom filter may pass extra rows, so the join stays.
+  EXPECT_EQ(0, getReplacedWithFilterRows(task, 1).sum);
+  EXPECT_LT(getInputPositions(task, 1), 1024 * 20);
+}
+
+TEST_F(HashJoinTest, multiColumnDynamicFilter) {
+  std::vector<RowVectorPtr> leftVectors;
+  auto leftFiles = makeFilePaths(20);
+  for (int i = 0; i < 20; i++) {
+    auto rowVector = makeRowVector({
+        makeFlatVector<int32_t>(
+            1'024, [&](auto row) { return (i * 1'024 + row) % 100; }),
+        makeFlatVector<int64_t>(
+            1'024, [&](auto row) { return (i * 1'024 + row) / 100 % 100; }),
+        makeFlatVector<int64_t>(1'024, [](auto row) { return row; }),
+    });
+    leftVectors.push_back(rowVector);
+    writeToFile(leftFiles[i]->path, kWriter, rowVector);
+  }
+
+  // Each key alone matches every probe row. The pair matches 1% of them.
+  auto rightVectors = {makeRowVector({
+      makeFlatVector<int32_t>(100, [](auto row) { return row; }),
+      makeFlatVector<int64_t>(100, [](auto row) { return row; }),
+      makeFlatVector<int64_t>(100, [](auto row) { return row * 10; }),
+  })};
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto probeType = ROW({"c0", "c1", "c2"}, {INTEGER(), BIGINT(), BIGINT()});
+  auto buildSide = PlanBuilder(0)
+                       .values(rightVectors)
+                       .project({"c0", "c1", "c2"}, {"u_c0", "u_c1", "u_c2"})
+                       .planNode();
+
+  auto op = PlanBuilder(10)
+                .tableScan(probeType)
+                .hashJoin(
+                    {0, 1},
+                    {0, 1},
+                    buildSide,
+                    "",
+                    {0, 1, 2, 5},
+                    core::JoinType::kInner)
+                .project({"c0", "c1", "c2 + u_c2"})
+                .planNode();
+
+  auto task = assertQuery(
+      op,
+      {{10, leftFiles}},
+      "SELECT t.c0, t.c1, t.c2 + u.c2 FROM t, u "
+      "WHERE t.c0 = u.c0 AND t.c1 = u.c1");
+  EXPECT_EQ(1, getFiltersProduced(task, 1).sum);
+  EXPECT_EQ(1, getFiltersAccepted(task, 0).sum);
+  EXPECT_EQ(0, getReplacedWithFilterRows(task, 1).sum);
+  EXPECT_LT(getInputPositions(task, 1), 1024 * 20);
+}
+
+TEST_F(HashJoinTest, broadcastTableReuse) {
+  auto leftVectors = {makeRowVector({
+      makeFlatVector<int32_t>(1'000, [](auto row) { return row % 23; }),
+      makeFlatVector<int64_t>(1'000, [](auto row) { return row; }),
+  })};
+  auto rightVectors = {makeRowVector({
+      makeFlatVector<int32_t>(100, [](auto row) { return row * 2; }),
+      makeFlatVector<int64_t>(100, [](auto row) { return row * 10; }),
+  })};
+
+  createDuckDbTable("t", {leftVectors});
+  createDuckDbTable("u", {rightVectors});
+
+  auto buildSide = PlanBuilder(0)
+                       .values(rightVectors)
+                       .project({"c0", "c1"}, {"u_c0", "u_c1"})
+                       .planNode();
+  auto op = PlanBuilder(10)
+                .values(leftVectors)
+                .hashJoin(
+                    {0},
+                    {0},
+                    buildSide,
+                    "",
+                    {0, 1, 3},
+                    core::JoinType::kInner,
+                    true) // isBroadcast
+                .planNode();
+
+  // The Tasks of a query share the QueryCtx. The first Task builds the
+  // table and the second one probes the same table.
+  CursorParameters params;
+  params.planNode = op;
+  params.queryCtx = core::QueryCtx::create();
+  auto sharedHashTable = [](const std::shared_ptr<Task>& task) {
+    auto& buildStats = task->taskStats().pipelineStats[1].operatorStats;
+    return buildStats.back().runtimeStats["sharedHashTable"].sum;
+  };
+  auto sql = "SELECT t.c0, t.c1, u.c1 FROM t, u WHERE t.c0 = u.c0";
+  auto buildTask = assertQuery(params, sql);
+  auto reuseTask = assertQuery(params, sql);
+  EXPECT_EQ(0, sharedHashTable(buildTask));
+  EXPECT_EQ(1, sharedHashTable(reuseTask));
+
+  // Another query builds its own table.
+  params.queryCtx = core::QueryCtx::create();
+  auto otherTask = assertQuery(params, sql);
+  EXPECT_EQ(0, sharedHashTable(otherTask));
+}
+
 TEST_F(HashJoinTest, leftJoin) {
   // Left side keys are [0, 1, 2,..10].
   auto leftVectors = {
@@ -908,3 +1256,78 @@ TEST_F(HashJoinTest, rightJoin) {
       op,
       "SELECT t.c0, t.c1, u.c1 FROM t RIGHT JOIN u ON t.c0 = u.c0 AND (t.c1 + u.c1) % 2 = 3");
 }
+
+TEST_F(HashJoinTest, groupedExecution) {
+  // Both sides are bucketed on c0 % 3. Each bucket is a split group and
+  // joins and aggregates its rows separately.
+  constexpr int32_t kNumSplitGroups = 3;
+  std::vector<RowVectorPtr> leftVectors;
+  std::vector<RowVectorPtr> rightVectors;
+  std::vector<std::shared_ptr<TempFilePath>> leftFiles;
+  std::vector<std::shared_ptr<TempFilePath>> rightFiles;
+  for (auto group = 0; group < kNumSplitGroups; ++group) {
+    leftVectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            1'000, [&](auto row) { return (row % 41) * 3 + group; }),
+        makeFlatVector<int64_t>(1'000, [](auto row) { return row; }),
+    }));
+    rightVectors.push_back(makeRowVector({
+        makeFlatVector<int32_t>(
+            100, [&](auto row) { return (row % 29) * 3 + group; }),
+    }));
+    leftFiles.push_back(TempFilePath::create());
+    writeToFile(leftFiles.back()->path, kWriter, {leftVectors.back()});
+    rightFiles.push_back(TempFilePath::create());
+    writeToFile(rightFiles.back()->path, kWriter, {rightVectors.back()});
+  }
+  createDuckDbTable("t", leftVectors);
+  createDuckDbTable("u", rightVectors);
+
+  auto op =
+      PlanBuilder(10)
+          .tableScan(ROW({"c0", "c1"}, {INTEGER(), BIGINT()}))
+          .hashJoin(
+              {0},
+              {0},
+              PlanBuilder(0).tableScan(ROW({"c0"}, {INTEGER()})).planNode(),
+              "",
+              {0, 1})
+          .singleAggregation({0}, {"sum(c1)"})
+          .planNode();
+
+  bool noMoreSplits = false;
+  auto addSplits = [&](Task* task) {
+    if (noMoreSplits) {
+      return;
+    }
+    for (auto group = 0; group < kNumSplitGroups; ++group) {
+      task->addSplit(
+          "10",
+          exec::Split(makeHiveConnectorSplit(leftFiles[group]->path), group));
+      task->addSplit(
+          "0",
+          exec::Split(makeHiveConnectorSplit(rightFiles[group]->path), group));
+      task->noMoreSplitsForGroup("10", group);
+      task->noMoreSplitsForGroup("0", group);
+    }
+    task->noMoreSplits("10");
+    task->noMoreSplits("0");
+    noMoreSplits = true;
+  };
+
+  for (auto concurrentSplitGroups : {1, 2}) {
+    CursorParameters params;
+    params.planNode = op;
+    params.numSplitGroups = kNumSplitGroups;
+    params.concurrentSplitGroups = concurrentSplitGroups;
+    noMoreSplits = false;
+    auto task = ::assertQuery(
+        params,
+        addSplits,
+        "SELECT t.c0, sum(t.c1) FROM t, u WHERE t.c0 = u.c0 GROUP BY 1",
+        duckDbQueryRunner_);
+    EXPECT_EQ(
+        (std::unordered_set<int32_t>{0, 1, 2}),
+        task->taskStats().completedSplitGroups);
+  }
+}
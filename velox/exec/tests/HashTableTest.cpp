@@ -19,6 +19,8 @@
 #include "velox/exec/VectorHasher.h"
 #include "velox/vector/tests/VectorMaker.h"
 
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
 #include <gtest/gtest.h>
 #include <memory>
 
@@ -81,7 +83,7 @@ class HashTableTest : public testing::Test {
       batches_.insert(batches_.end(), batches.begin(), batches.end());
       startOffset += size;
     }
-    topTable_->prepareJoinTable(std::move(otherTables));
+    topTable_->prepareJoinTable(std::move(otherTables), executor_.get());
     EXPECT_EQ(topTable_->hashMode(), mode);
     LOG(INFO) << "Made table " << describeTable();
     testProbe();
@@ -431,6 +433,9 @@ class HashTableTest : public testing::Test {
   // Spacing between consecutive generated keys. Affects whether
   // Vectorhashers make ranges or ids of distinct values.
   int32_t keySpacing_ = 1;
+  // Executor for building the join table in parallel. nullptr for a serial
+  // build.
+  std::unique_ptr<folly::Executor> executor_;
 };
 
 TEST_F(HashTableTest, int2DenseArray) {
@@ -448,6 +453,14 @@ TEST_F(HashTableTest, string2Normalized) {
   testCycle(BaseHashTable::HashMode::kNormalizedKey, 50000, 2, type, 2);
 }
 
+TEST_F(HashTableTest, int1SparseArray) {
+  // 80K distinct keys over a range of 80M become an array indexed by
+  // the ordinals of the distinct values.
+  auto type = ROW({"k1"}, {BIGINT()});
+  keySpacing_ = 1000;
+  testCycle(BaseHashTable::HashMode::kArray, 40000, 2, type, 1);
+}
+
 TEST_F(HashTableTest, int2SparseArray) {
   auto type = ROW({"k1", "k2"}, {BIGINT(), BIGINT()});
   keySpacing_ = 1000;
@@ -482,6 +495,39 @@ TEST_F(HashTableTest, mixed6Sparse) {
   testCycle(BaseHashTable::HashMode::kHash, 1000000, 2, type, 6);
 }
 
+TEST_F(HashTableTest, mixed6SparseMostMiss) {
+  auto type =
+      ROW({"k1", "k2", "k3", "k4", "k5", "k6"},
+          {BIGINT(), BIGINT(), BIGINT(), BIGINT(), BIGINT(), VARCHAR()});
+  keySpacing_ = 1000;
+  insertPct_ = 10;
+  testCycle(BaseHashTable::HashMode::kHash, 100000, 2, type, 6);
+}
+
+TEST_F(HashTableTest, mixed6SparseParallel) {
+  auto type =
+      ROW({"k1", "k2", "k3", "k4", "k5", "k6"},
+          {BIGINT(), BIGINT(), BIGINT(), BIGINT(), BIGINT(), VARCHAR()});
+  keySpacing_ = 1000;
+  executor_ = std::make_unique<folly::CPUThreadPoolExecutor>(4);
+  testCycle(BaseHashTable::HashMode::kHash, 250000, 4, type, 6);
+}
+
+TEST_F(HashTableTest, joinTableSizedForRows) {
+  auto type =
+      ROW({"k1", "k2", "k3", "k4", "k5", "k6"},
+          {BIGINT(), BIGINT(), BIGINT(), BIGINT(), BIGINT(), VARCHAR()});
+  keySpacing_ = 1000;
+  executor_ = std::make_unique<folly::CPUThreadPoolExecutor>(4);
+  testCycle(BaseHashTable::HashMode::kHash, 150000, 4, type, 6);
+  // Tags and row pointers for the 600K build rows at a load factor of 7/8,
+  // half the size of a table for double the rows.
+  const int64_t tableBytes = (1 + sizeof(char*)) * (1 << 20);
+  EXPECT_EQ(
+      tableBytes,
+      topTable_->allocatedBytes() - topTable_->rows()->allocatedBytes());
+}
+
 // It should be safe to call clear() before we insert any data into HashTable
 TEST_F(HashTableTest, clear) {
   std::vector<std::unique_ptr<VectorHasher>> keyHashers;
@@ -496,3 +542,29 @@ TEST_F(HashTableTest, clear) {
       std::move(keyHashers), aggregates, mappedMemory_);
   table->clear();
 }
+
+TEST_F(HashTableTest, numDistinctHint) {
+  auto type = ROW({"k1", "k2"}, {BIGINT(), VARCHAR()});
+  auto table = createHashTableForAggregation(type, 2);
+  table->setNumDistinctHint(100'000);
+  table->forceGenericHashMode();
+  // Tags and row pointers for 100K keys at a load factor of 7/8.
+  const int64_t tableBytes = (1 + sizeof(char*)) * 131072;
+  EXPECT_EQ(
+      tableBytes, table->allocatedBytes() - table->rows()->allocatedBytes());
+
+  constexpr int32_t kBatchSize = 1000;
+  auto lookup = std::make_unique<HashLookup>(table->hashers());
+  std::vector<RowVectorPtr> batches;
+  int32_t sequence = 0;
+  for (auto i = 0; i < 100; ++i) {
+    makeRows(kBatchSize, 1, sequence, type, batches);
+    sequence += kBatchSize;
+    lookup->reset(kBatchSize);
+    insertGroups(*batches.back(), *lookup, *table);
+  }
+  EXPECT_EQ(100'000, table->numDistinct());
+  // The table was sized upfront and did not grow.
+  EXPECT_EQ(
+      tableBytes, table->allocatedBytes() - table->rows()->allocatedBytes());
+}
@@ -13,6 +13,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <thread>
+#include "velox/exec/LocalPartition.h"
+#include "velox/exec/SkewedHashPartitionFunction.h"
 #include "velox/exec/tests/utils/HiveConnectorTestBase.h"
 #include "velox/exec/tests/utils/PlanBuilder.h"
 
@@ -174,6 +177,44 @@ TEST_F(LocalPartitionTest, partition) {
   verifyExchangeSourceOperatorStats(task, 300);
 }
 
+TEST_F(LocalPartitionTest, skewedKeys) {
+  // Key 7 is in a third of the rows.
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 3; ++i) {
+    vectors.push_back(makeRowVector({makeFlatVector<int64_t>(
+        300, [i](auto row) { return row % 3 == 0 ? 7 : i * 1'000 + row; })}));
+  }
+  auto hotKeys = exec::SkewedHashPartitionFunction::hotKeysFromSample(
+      *vectors[0], {0}, 0.1);
+  createDuckDbTable(vectors);
+
+  auto makePlan = [&](bool replicateHotKeys) {
+    return PlanBuilder(1)
+        .localPartitionSkewed(
+            {0},
+            hotKeys,
+            replicateHotKeys,
+            {PlanBuilder(0).values(vectors).planNode()})
+        .planNode();
+  };
+  CursorParameters params;
+  params.maxDrivers = 3;
+
+  // The rows of the hot key are spread over the partitions.
+  params.planNode = makePlan(false);
+  ::assertQuery(
+      params, [](auto* /*task*/) {}, "SELECT * FROM tmp", duckDbQueryRunner_);
+
+  // Each partition gets all the rows of the hot key.
+  params.planNode = makePlan(true);
+  ::assertQuery(
+      params,
+      [](auto* /*task*/) {},
+      "SELECT * FROM tmp UNION ALL SELECT * FROM tmp WHERE c0 = 7 "
+      "UNION ALL SELECT * FROM tmp WHERE c0 = 7",
+      duckDbQueryRunner_);
+}
+
 TEST_F(LocalPartitionTest, maxBufferSizeGather) {
   std::vector<RowVectorPtr> vectors;
   for (auto i = 0; i < 21; i++) {
@@ -285,6 +326,100 @@ TEST_F(LocalPartitionTest, maxBufferSizePartition) {
   verifyExchangeSourceOperatorStats(task, 2100);
 }
 
+TEST_F(LocalPartitionTest, adaptiveDriverCount) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 40; i++) {
+    vectors.emplace_back(makeRowVector({makeFlatVector<int32_t>(
+        1'000, [i](auto row) { return i * 1'000 + row; })}));
+  }
+  auto filePaths = writeToFiles(vectors);
+  auto rowType = getRowType(vectors[0]);
+
+  CursorParameters params;
+  params.planNode =
+      PlanBuilder(1)
+          .localPartition({0}, {PlanBuilder(0).tableScan(rowType).planNode()})
+          .planNode();
+  params.maxDrivers = 4;
+  // Each result vector fills the result queue so that the reader below
+  // paces the whole query.
+  params.bufferedBytes = 1'024;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kMaxLocalExchangeBufferSize, "100"},
+      {core::QueryConfig::kAdaptiveDriverCountEnabled, "true"},
+  });
+
+  auto cursor = std::make_unique<TaskCursor>(params);
+  auto task = cursor->task();
+  for (auto& filePath : filePaths) {
+    addSplit(task.get(), "0", makeHiveSplit(filePath->path));
+  }
+  task->noMoreSplits("0");
+
+  // A slow consumer makes the scan Drivers wait for the local exchange.
+  int64_t numRows = 0;
+  while (cursor->moveNext()) {
+    numRows += cursor->current()->size();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(40'000, numRows);
+
+  // The scan pipeline parked Drivers while they were waiting and
+  // finished all of them.
+  auto& stats = task->taskStats().pipelineStats[1].operatorStats.back();
+  EXPECT_EQ("LocalPartition", stats.operatorType);
+  EXPECT_GT(stats.runtimeStats["parkedDrivers"].sum, 0);
+  EXPECT_EQ(40'000, stats.inputPositions);
+}
+
+TEST_F(LocalPartitionTest, scaleWriters) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 40; i++) {
+    vectors.emplace_back(makeRowVector({makeFlatVector<int32_t>(
+        1'000, [i](auto row) { return i * 1'000 + row; })}));
+  }
+
+  auto makeParams = [&](const std::string& minBytesPerWriter) {
+    CursorParameters params;
+    params.planNode = PlanBuilder(1)
+                          .localPartitionScaleWriters(
+                              {PlanBuilder(0).values(vectors).planNode()})
+                          .planNode();
+    params.maxDrivers = 4;
+    params.bufferedBytes = 1'024;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe({
+        {core::QueryConfig::kMaxLocalExchangeBufferSize, "100"},
+        {core::QueryConfig::kScaleWriterMinBytesPerWriter, minBytesPerWriter},
+    });
+    return params;
+  };
+
+  auto readAll = [&](const CursorParameters& params) {
+    auto cursor = std::make_unique<TaskCursor>(params);
+    int64_t numRows = 0;
+    while (cursor->moveNext()) {
+      numRows += cursor->current()->size();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(40'000, numRows);
+    auto& stats =
+        cursor->task()->taskStats().pipelineStats[1].operatorStats.back();
+    EXPECT_EQ("LocalPartition", stats.operatorType);
+    return stats.runtimeStats.count("scaledWriters")
+        ? stats.runtimeStats.at("scaledWriters").sum
+        : 0;
+  };
+
+  // The writers fall behind while each has written little. The data goes
+  // to a single writer.
+  EXPECT_EQ(0, readAll(makeParams("1000000000")));
+
+  // The slow consumer makes the LocalPartition add writers.
+  EXPECT_GT(readAll(makeParams("1")), 0);
+}
+
 TEST_F(LocalPartitionTest, outputLayout) {
   std::vector<RowVectorPtr> vectors = {
       makeRowVector({
@@ -424,3 +559,93 @@ TEST_F(LocalPartitionTest, multipleExchanges) {
       ") t GROUP BY 1",
       duckDbQueryRunner_);
 }
+
+TEST_F(LocalPartitionTest, coalescePartitions) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 20; ++i) {
+    vectors.push_back(makeRowVector({makeFlatSequence<int32_t>(i * 7, 100)}));
+  }
+  createDuckDbTable(vectors);
+
+  auto valuesNode = [&](int planNodeId) {
+    return PlanBuilder(planNodeId).values(vectors).planNode();
+  };
+
+  CursorParameters params;
+  params.planNode = PlanBuilder(10)
+                        .localPartition({0}, {valuesNode(0), valuesNode(1)})
+                        .partialAggregation({0}, {"count(1)"})
+                        .planNode();
+  params.maxDrivers = 4;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kLocalExchangeCoalesceEnabled, "true"},
+      {core::QueryConfig::kPreferredOutputBatchSize, "256"},
+  });
+
+  auto task = assertQuery(params, "SELECT c0, count(1) FROM tmp GROUP BY 1");
+
+  // Each input of 100 rows is split 4 ways and sent in batches of 256 rows.
+  int64_t numCoalesced = 0;
+  for (const auto& pipeline : task->taskStats().pipelineStats) {
+    for (const auto& op : pipeline.operatorStats) {
+      auto it = op.runtimeStats.find("coalescedBatches");
+      if (op.operatorType == "LocalPartition" && it != op.runtimeStats.end()) {
+        numCoalesced += it->second.sum;
+      }
+    }
+  }
+  EXPECT_GT(numCoalesced, 0);
+  EXPECT_LT(numCoalesced, 2 * 20 * 4);
+}
+
+TEST_F(LocalPartitionTest, concurrentSource) {
+  constexpr int32_t kNumProducers = 4;
+  constexpr int32_t kNumConsumers = 4;
+  constexpr int32_t kNumBatches = 2'000;
+  LocalExchangeMemoryManager memoryManager(1 << 30);
+  LocalExchangeSource source(&memoryManager, 0);
+  for (auto i = 0; i < kNumProducers; ++i) {
+    source.addProducer();
+  }
+  source.noMoreProducers();
+  auto data = makeRowVector({makeFlatSequence<int32_t>(0, 10)});
+
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < kNumProducers; ++i) {
+    threads.emplace_back([&]() {
+      for (auto j = 0; j < kNumBatches; ++j) {
+        ContinueFuture future{false};
+        if (source.enqueue(data, &future) != BlockingReason::kNotBlocked) {
+          future.wait();
+        }
+      }
+      source.noMoreData();
+    });
+  }
+  std::atomic<int64_t> numRows{0};
+  for (auto i = 0; i < kNumConsumers; ++i) {
+    threads.emplace_back([&]() {
+      for (;;) {
+        ContinueFuture future{false};
+        RowVectorPtr batch;
+        auto reason = source.next(&future, pool_.get(), &batch);
+        if (reason != BlockingReason::kNotBlocked) {
+          future.wait();
+          continue;
+        }
+        if (!batch) {
+          break;
+        }
+        numRows += batch->size();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(kNumProducers * kNumBatches * 10, numRows);
+  EXPECT_EQ(0, memoryManager.bufferedBytes());
+  ContinueFuture future{false};
+  EXPECT_EQ(BlockingReason::kNotBlocked, source.isFinished(&future));
+}
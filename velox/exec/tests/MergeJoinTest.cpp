@@ -167,6 +167,36 @@ TEST_F(MergeJoinTest, duplicateMatch) {
       [](auto row) { return row / 2; }, [](auto row) { return row / 3; });
 }
 
+TEST_F(MergeJoinTest, bigintKeys) {
+  testJoin<int64_t>(
+      [](auto row) { return row / 3 * 1'000'000'000'000; },
+      [](auto row) { return row / 2 * 1'000'000'000'000; });
+}
+
+TEST_F(MergeJoinTest, dictionaryKeys) {
+  // The keys are sorted after decoding the dictionary. The base vectors
+  // are in reverse order.
+  auto makeKeys = [&](vector_size_t size, auto keyAt) {
+    return wrapInDictionary(
+        makeIndices(size, [size](auto row) { return size - 1 - row; }),
+        size,
+        makeFlatVector<int32_t>(
+            size, [&](auto row) { return keyAt(size - 1 - row); }));
+  };
+  std::vector<VectorPtr> leftKeys = {
+      makeKeys(500, [](auto row) { return row / 2; }),
+      makeKeys(700, [](auto row) { return 250 + row / 3; }),
+  };
+  std::vector<VectorPtr> rightKeys = {
+      makeKeys(300, [](auto row) { return row; }),
+      makeFlatVector<int32_t>(600, [](auto row) { return 300 + row / 4; }),
+  };
+
+  testJoin(leftKeys, rightKeys);
+
+  testJoin(rightKeys, leftKeys);
+}
+
 TEST_F(MergeJoinTest, allRowsMatch) {
   std::vector<VectorPtr> leftKeys = {
       makeFlatVector<int32_t>(2, [](auto /* row */) { return 5; }),
@@ -109,4 +109,6 @@ TEST_F(MergeTest, localMerge) {
 
   testTwoKeys(vectors, "c0", "c3");
   testTwoKeys(vectors, "c3", "c0");
+  // c1 has duplicates, so that ties on the first key go to the second key.
+  testTwoKeys(vectors, "c1", "c3");
 }
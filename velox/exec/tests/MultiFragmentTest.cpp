@@ -21,6 +21,7 @@
 #include "velox/dwio/dwrf/test/utils/BatchMaker.h"
 #include "velox/dwio/dwrf/writer/Writer.h"
 #include "velox/exec/Exchange.h"
+#include "velox/exec/RangePartitionFunction.h"
 #include "velox/exec/tests/utils/HiveConnectorTestBase.h"
 #include "velox/exec/tests/utils/OperatorTestBase.h"
 #include "velox/exec/tests/utils/PlanBuilder.h"
@@ -415,6 +416,122 @@ TEST_F(MultiFragmentTest, partitionedOutput) {
   }
 }
 
+TEST_F(MultiFragmentTest, smallPages) {
+  // Each leaf task produces a page of a few rows. The final Exchange merges
+  // them into batches of up to the preferred output batch size.
+  std::vector<RowVectorPtr> vectors;
+  std::vector<std::string> leafTaskIds;
+  std::shared_ptr<const core::PlanNode> leafPlan;
+  for (auto i = 0; i < 20; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(7, [&](auto row) { return i * 7 + row; }),
+         makeFlatVector<StringView>(
+             7,
+             [&](auto row) {
+               return StringView(std::string(row % 3 * 10, 'x'));
+             },
+             nullEvery(5))}));
+    leafTaskIds.push_back(makeTaskId("leaf", i));
+    leafPlan = PlanBuilder()
+                   .values({vectors.back()})
+                   .partitionedOutput({}, 1)
+                   .planNode();
+    Task::start(makeTask(leafTaskIds.back(), leafPlan, 0), 1);
+  }
+  createDuckDbTable(vectors);
+
+  auto op = PlanBuilder().exchange(leafPlan->outputType()).planNode();
+  assertQuery(op, leafTaskIds, "SELECT * FROM tmp");
+}
+
+TEST_F(MultiFragmentTest, exchangeBufferLimit) {
+  setupSources(10, 1000);
+
+  // The leaf tasks produce pages larger than the budget of the intermediate
+  // Exchange, which then requests one page at a time.
+  std::vector<std::string> leafTaskIds;
+  std::shared_ptr<const core::PlanNode> leafPlan;
+  for (auto i = 0; i < 4; ++i) {
+    leafTaskIds.push_back(makeTaskId("leaf", i));
+    leafPlan = PlanBuilder()
+                   .values(vectors_)
+                   .partitionedOutput({}, 1)
+                   .planNode();
+    Task::start(makeTask(leafTaskIds.back(), leafPlan, 0), 1);
+  }
+
+  configSettings_[core::QueryConfig::kMaxExchangeBufferSize] = "1024";
+  auto intermediateTaskId = makeTaskId("intermediate", 0);
+  auto intermediatePlan = PlanBuilder()
+                              .exchange(leafPlan->outputType())
+                              .partitionedOutput({}, 1)
+                              .planNode();
+  auto intermediateTask = makeTask(intermediateTaskId, intermediatePlan, 0);
+  Task::start(intermediateTask, 1);
+  addRemoteSplits(intermediateTask, leafTaskIds);
+
+  auto op = PlanBuilder().exchange(intermediatePlan->outputType()).planNode();
+  assertQuery(
+      op,
+      {intermediateTaskId},
+      "SELECT * FROM tmp UNION ALL SELECT * FROM tmp "
+      "UNION ALL SELECT * FROM tmp UNION ALL SELECT * FROM tmp");
+}
+
+TEST_F(MultiFragmentTest, rangePartitionedSort) {
+  static const core::SortOrder kAscNullsLast(true, false);
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(
+             100, [&](auto row) { return (i * 100 + row) * 7919 % 1'000; }),
+         makeFlatVector<int32_t>(100, [&](auto row) { return row; })}));
+  }
+  createDuckDbTable(vectors);
+
+  // The leaf task splits the key range into 3 partitions. Each
+  // intermediate task sorts one of them.
+  constexpr int32_t kFanout = 3;
+  auto splitPoints = RangePartitionFunction::splitPointsFromSample(
+      *vectors[0], {0}, {kAscNullsLast}, kFanout, pool_.get());
+  auto leafTaskId = makeTaskId("leaf", 0);
+  auto leafPlan =
+      PlanBuilder()
+          .values(vectors)
+          .partitionedOutputRange({0}, {kAscNullsLast}, splitPoints)
+          .planNode();
+  Task::start(makeTask(leafTaskId, leafPlan, 0), 1);
+
+  auto intermediatePlan = PlanBuilder()
+                              .exchange(leafPlan->outputType())
+                              .orderBy({0}, {kAscNullsLast}, false)
+                              .partitionedOutput({}, 1)
+                              .planNode();
+  auto bounds = splitPoints->childAt(0)->asFlatVector<int64_t>();
+  for (auto i = 0; i < kFanout; ++i) {
+    auto taskId = makeTaskId("intermediate", i);
+    auto task = makeTask(taskId, intermediatePlan, i);
+    Task::start(task, 1);
+    addRemoteSplits(task, {leafTaskId});
+
+    // Partition i has the keys after split point i - 1 and up to split
+    // point i.
+    std::string condition = "true";
+    if (i > 0) {
+      condition += fmt::format(" AND c0 > {}", bounds->valueAt(i - 1));
+    }
+    if (i < kFanout - 1) {
+      condition += fmt::format(" AND c0 <= {}", bounds->valueAt(i));
+    }
+    auto op = PlanBuilder().exchange(intermediatePlan->outputType()).planNode();
+    assertQueryOrdered(
+        op,
+        {taskId},
+        fmt::format("SELECT * FROM tmp WHERE {} ORDER BY c0", condition),
+        {0});
+  }
+}
+
 TEST_F(MultiFragmentTest, broadcast) {
   auto data = makeRowVector(
       {makeFlatVector<int32_t>(1'000, [](auto row) { return row; })});
@@ -503,3 +620,77 @@ TEST_F(MultiFragmentTest, replicateNullsAndAny) {
       finalAggTaskIds,
       "SELECT 3 * ceil(1000.0 / 7) /* number of null rows */, 1000 + 2 * ceil(1000.0 / 7) /* total number of rows */");
 }
+
+TEST_F(MultiFragmentTest, localBypass) {
+  setupSources(10, 1000);
+  configSettings_[core::QueryConfig::kExchangeLocalBypassEnabled] = "true";
+  // A small output buffer blocks the leaf task until the consumers catch
+  // up, as with serialized pages.
+  configSettings_[core::QueryConfig::kMaxPartitionedOutputBufferSize] =
+      "4096";
+
+  std::vector<std::shared_ptr<Task>> tasks;
+  auto leafTaskId = makeTaskId("leaf", 0);
+  auto leafPlan =
+      PlanBuilder().values(vectors_).partitionedOutput({0}, 3).planNode();
+  auto leafTask = makeTask(leafTaskId, leafPlan, 0);
+  tasks.push_back(leafTask);
+  Task::start(leafTask, 1);
+
+  std::shared_ptr<core::PlanNode> intermediatePlan;
+  std::vector<std::string> intermediateTaskIds;
+  for (int i = 0; i < 3; i++) {
+    intermediatePlan = PlanBuilder()
+                           .exchange(leafPlan->outputType())
+                           .partitionedOutput({}, 1)
+                           .planNode();
+    intermediateTaskIds.push_back(makeTaskId("intermediate", i));
+    auto task = makeTask(intermediateTaskIds.back(), intermediatePlan, i);
+    tasks.push_back(task);
+    Task::start(task, 1);
+    addRemoteSplits(task, {leafTaskId});
+  }
+
+  auto op = PlanBuilder().exchange(intermediatePlan->outputType()).planNode();
+  assertQuery(op, intermediateTaskIds, "SELECT * FROM tmp");
+}
+
+TEST_F(MultiFragmentTest, localBypassMergeExchange) {
+  setupSources(10, 1000);
+  configSettings_[core::QueryConfig::kExchangeLocalBypassEnabled] = "true";
+  static const core::SortOrder kAscNullsLast(true, false);
+
+  std::vector<std::shared_ptr<Task>> tasks;
+  std::vector<std::string> sortTaskIds;
+  std::shared_ptr<const RowType> outputType;
+  for (int i = 0; i < 2; ++i) {
+    sortTaskIds.push_back(makeTaskId("orderby", i));
+    auto sortPlan = PlanBuilder()
+                        .values(vectors_)
+                        .orderBy({0}, {kAscNullsLast}, true)
+                        .partitionedOutput({}, 1)
+                        .planNode();
+    auto sortTask = makeTask(sortTaskIds.back(), sortPlan, 0);
+    tasks.push_back(sortTask);
+    Task::start(sortTask, 1);
+    outputType = sortPlan->outputType();
+  }
+
+  auto mergeTaskId = makeTaskId("merge", 0);
+  auto mergePlan = PlanBuilder()
+                       .mergeExchange(outputType, {0}, {kAscNullsLast})
+                       .partitionedOutput({}, 1)
+                       .planNode();
+  auto mergeTask = makeTask(mergeTaskId, mergePlan, 0);
+  tasks.push_back(mergeTask);
+  Task::start(mergeTask, 1);
+  addRemoteSplits(mergeTask, sortTaskIds);
+
+  auto op = PlanBuilder().exchange(outputType).planNode();
+  assertQueryOrdered(
+      op,
+      {mergeTaskId},
+      "SELECT * FROM (SELECT * FROM tmp UNION ALL SELECT * FROM tmp) "
+      "ORDER BY 1 NULLS LAST",
+      {0});
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/NormalizedKey.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::test;
+
+class NormalizedKeyTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pool_ = memory::getDefaultScopedMemoryPool();
+    vectorMaker_ = std::make_unique<VectorMaker>(pool_.get());
+
+    // c0 has small values, extremes and nulls. c1 has strings that are
+    // prefixes of each other and strings longer than a normalized key. c2
+    // and c3 have many duplicates so that later keys matter.
+    std::vector<int64_t> bigints = {
+        0,
+        -1,
+        1,
+        255,
+        256,
+        std::numeric_limits<int64_t>::min(),
+        std::numeric_limits<int64_t>::max()};
+    std::vector<std::string> strings = {
+        "", "a", "ab", "abc", "abcdefghij", "abcdefghik", "b", "\xff"};
+    data_ = vectorMaker_->rowVector({
+        vectorMaker_->flatVector<int64_t>(
+            kSize,
+            [&](auto row) { return bigints[row % bigints.size()]; },
+            VectorMaker::nullEvery(11)),
+        vectorMaker_->flatVector<StringView>(
+            kSize,
+            [&](auto row) {
+              return StringView(strings[row % strings.size()]);
+            },
+            VectorMaker::nullEvery(13)),
+        vectorMaker_->flatVector<int32_t>(
+            kSize, [](auto row) { return row % 5 - 2; }),
+        vectorMaker_->flatVector<bool>(
+            kSize,
+            [](auto row) { return row % 3 == 0; },
+            VectorMaker::nullEvery(7)),
+    });
+    SelectivityVector rows(kSize);
+    decodedVectors_.resize(data_->childrenSize());
+    for (auto i = 0; i < data_->childrenSize(); ++i) {
+      decodedVectors_[i].decode(*data_->childAt(i), rows);
+    }
+  }
+
+  std::shared_ptr<const core::FieldAccessTypedExpr> field(
+      ChannelIndex channel) {
+    auto& rowType = data_->type()->asRow();
+    return std::make_shared<core::FieldAccessTypedExpr>(
+        rowType.childAt(channel), rowType.nameOf(channel));
+  }
+
+  // Checks that the normalized keys do not decrease when the rows are in
+  // the order of the full keys.
+  void testOrder(
+      const std::vector<ChannelIndex>& channels,
+      const std::vector<core::SortOrder>& orders) {
+    std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> keys;
+    for (auto channel : channels) {
+      keys.push_back(field(channel));
+    }
+    auto rowType = std::dynamic_pointer_cast<const RowType>(data_->type());
+    auto encoder = NormalizedKeyEncoder::create(rowType, keys, orders);
+    ASSERT_TRUE(encoder != nullptr);
+
+    std::vector<vector_size_t> rows(kSize);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::sort(rows.begin(), rows.end(), [&](auto left, auto right) {
+      for (auto i = 0; i < channels.size(); ++i) {
+        auto& child = data_->childAt(channels[i]);
+        bool leftNull = child->isNullAt(left);
+        bool rightNull = child->isNullAt(right);
+        if (leftNull || rightNull) {
+          if (leftNull && rightNull) {
+            continue;
+          }
+          return leftNull == orders[i].isNullsFirst();
+        }
+        if (auto result = child->compare(child.get(), left, right)) {
+          return orders[i].isAscending() ? result < 0 : result > 0;
+        }
+      }
+      return false;
+    });
+
+    for (auto i = 1; i < kSize; ++i) {
+      ASSERT_LE(
+          encoder->encode(decodedVectors_, rows[i - 1]),
+          encoder->encode(decodedVectors_, rows[i]))
+          << "Rows " << rows[i - 1] << " and " << rows[i];
+    }
+  }
+
+  static constexpr vector_size_t kSize = 1000;
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::unique_ptr<VectorMaker> vectorMaker_;
+  RowVectorPtr data_;
+  std::vector<DecodedVector> decodedVectors_;
+};
+
+TEST_F(NormalizedKeyTest, order) {
+  std::vector<core::SortOrder> orders = {
+      {true, true}, {true, false}, {false, true}, {false, false}};
+  for (auto& first : orders) {
+    testOrder({0}, {first});
+    testOrder({1}, {first});
+    for (auto& second : orders) {
+      testOrder({2, 3}, {first, second});
+      testOrder({3, 1}, {first, second});
+      testOrder({0, 2}, {first, second});
+    }
+  }
+}
+
+TEST_F(NormalizedKeyTest, exactBigint) {
+  // A single bigint key uses all 8 bytes, so that distinct non-null
+  // values have distinct normalized keys. Row 0 is null.
+  auto rowType = std::dynamic_pointer_cast<const RowType>(data_->type());
+  auto encoder = NormalizedKeyEncoder::create(
+      rowType, {field(0)}, {core::SortOrder(true, true)});
+  ASSERT_TRUE(encoder != nullptr);
+  auto key = [&](vector_size_t row) {
+    return encoder->encode(decodedVectors_, row);
+  };
+  // null <= min < -1 < 1 < 255 < 256 < max.
+  ASSERT_LE(key(0), key(5));
+  ASSERT_LT(key(5), key(1));
+  ASSERT_LT(key(1), key(2));
+  ASSERT_LT(key(2), key(3));
+  ASSERT_LT(key(3), key(4));
+  ASSERT_LT(key(4), key(6));
+}
+
+TEST_F(NormalizedKeyTest, unsupportedFirstKey) {
+  auto data = vectorMaker_->rowVector(
+      {vectorMaker_->flatVector<double>(10, [](auto row) { return row; })});
+  auto rowType = std::dynamic_pointer_cast<const RowType>(data->type());
+  auto key = std::make_shared<core::FieldAccessTypedExpr>(DOUBLE(), "c0");
+  ASSERT_TRUE(
+      NormalizedKeyEncoder::create(
+          rowType, {key}, {core::SortOrder(true, true)}) == nullptr);
+}
@@ -15,6 +15,7 @@
  */
 #include "velox/exec/tests/utils/OperatorTestBase.h"
 #include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/exec/tests/utils/TempDirectoryPath.h"
 #include "velox/vector/tests/VectorMaker.h"
 
 using namespace facebook::velox;
@@ -266,3 +267,95 @@ TEST_F(OrderByTest, unknown) {
   assertQueryOrdered(
       plan, "SELECT *, null FROM tmp ORDER BY c0 DESC NULLS LAST", {0});
 }
+
+TEST_F(OrderByTest, spill) {
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 10; ++i) {
+    auto c0 = makeFlatVector<int64_t>(
+        batchSize,
+        [&](vector_size_t row) { return (row * 17 + i * 31) % 2011; },
+        nullEvery(7));
+    auto c1 = makeFlatVector<double>(
+        batchSize, [](vector_size_t row) { return row * 0.1; }, nullEvery(11));
+    auto c2 = makeFlatVector<StringView>(
+        batchSize,
+        [](vector_size_t row) { return StringView(std::to_string(row)); },
+        nullEvery(17));
+    vectors.push_back(makeRowVector({c0, c1, c2}));
+  }
+  createDuckDbTable(vectors);
+
+  auto spillDirectory = exec::test::TempDirectoryPath::create();
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create();
+  // Set a threshold low enough to spill every few input batches.
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kSpillEnabled, "true"},
+      {core::QueryConfig::kSpillPath, spillDirectory->path},
+      {core::QueryConfig::kOrderBySpillMemoryThreshold, "100000"},
+  });
+  params.planNode = PlanBuilder()
+                        .values(vectors)
+                        .orderBy({0, 1}, {kAscNullsLast, kDescNullsFirst}, false)
+                        .planNode();
+
+  auto task = exec::test::assertQuery(
+      params,
+      [](exec::Task* /*task*/) {},
+      "SELECT * FROM tmp ORDER BY c0 NULLS LAST, c1 DESC NULLS FIRST",
+      duckDbQueryRunner_,
+      std::vector<uint32_t>{0, 1});
+  auto stats = task->taskStats().pipelineStats[0].operatorStats;
+  ASSERT_GT(stats[1].runtimeStats["spilledRows"].count, 1);
+  ASSERT_EQ(stats[1].runtimeStats["spilledRows"].sum, 10 * batchSize);
+}
+
+TEST_F(OrderByTest, parallel) {
+  vector_size_t batchSize = 1000;
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < 5; ++i) {
+    auto c0 = makeFlatVector<int64_t>(
+        batchSize,
+        [&](vector_size_t row) { return (row * 17 + i * 31) % 2011; },
+        nullEvery(7));
+    auto c1 = makeFlatVector<StringView>(
+        batchSize,
+        [](vector_size_t row) { return StringView(std::to_string(row)); },
+        nullEvery(17));
+    vectors.push_back(makeRowVector({c0, c1}));
+  }
+  createDuckDbTable(vectors);
+
+  constexpr int32_t kNumDrivers = 4;
+  CursorParameters params;
+  params.maxDrivers = kNumDrivers;
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe({
+      {core::QueryConfig::kParallelOrderByEnabled, "true"},
+  });
+  // Each driver of a parallelizable Values produces all the vectors.
+  params.planNode = PlanBuilder()
+                        .values(vectors, true)
+                        .orderBy({0, 1}, {kAscNullsLast, kDescNullsFirst}, false)
+                        .planNode();
+
+  auto task = exec::test::assertQuery(
+      params,
+      [](exec::Task* /*task*/) {},
+      "SELECT * FROM (SELECT * FROM tmp UNION ALL SELECT * FROM tmp "
+      "UNION ALL SELECT * FROM tmp UNION ALL SELECT * FROM tmp) "
+      "ORDER BY c0 NULLS LAST, c1 DESC NULLS FIRST",
+      duckDbQueryRunner_,
+      std::vector<uint32_t>{0, 1});
+
+  // The planner puts a LocalMerge in place of the OrderBy and sorts on all
+  // the drivers of the source pipeline.
+  auto& pipelineStats = task->taskStats().pipelineStats;
+  ASSERT_EQ(pipelineStats.size(), 2);
+  ASSERT_EQ(pipelineStats[0].operatorStats[0].operatorType, "LocalMerge");
+  ASSERT_EQ(pipelineStats[1].operatorStats[1].operatorType, "OrderBy");
+  ASSERT_EQ(
+      pipelineStats[1].operatorStats[1].inputPositions,
+      kNumDrivers * vectors.size() * batchSize);
+}
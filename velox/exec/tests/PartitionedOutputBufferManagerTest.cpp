@@ -311,6 +311,56 @@ TEST_F(PartitionedOutputBufferManagerTest, maxBytes) {
   }
 }
 
+TEST_F(PartitionedOutputBufferManagerTest, broadcast) {
+  std::vector<std::string> names = {"c0", "c1"};
+  std::vector<TypePtr> types = {BIGINT(), VARCHAR()};
+  auto rowType = ROW(std::move(names), std::move(types));
+  vector_size_t size = 100;
+  auto pageSize = makeVectorStreamGroup(rowType, size)->size();
+
+  // The producer blocks above 2 pages and continues below 1.
+  std::string taskId = "t0";
+  bufferManager_->removeTask(taskId);
+  auto queryCtx = core::QueryCtx::create();
+  queryCtx->setConfigOverridesUnsafe(
+      {{core::QueryConfig::kMaxPartitionedOutputBufferSize,
+        std::to_string(2 * pageSize)}});
+  auto task = std::make_shared<Task>(taskId, nullptr, 0, std::move(queryCtx));
+  bufferManager_->initializeTask(task, true, 2, 1);
+
+  // A broadcast page counts once for all destinations.
+  enqueue(taskId, 0, rowType, size);
+  enqueue(taskId, 0, rowType, size);
+  ContinueFuture future(false);
+  ASSERT_EQ(
+      BlockingReason::kWaitForConsumer,
+      bufferManager_->enqueue(
+          taskId, 0, makeVectorStreamGroup(rowType, size), &future));
+
+  // The pages stay until the slowest destination is past them.
+  fetch(taskId, 0, 0, std::numeric_limits<uint64_t>::max(), 3);
+  acknowledge(taskId, 0, 3);
+  fetch(taskId, 1, 0, std::numeric_limits<uint64_t>::max(), 3);
+  acknowledge(taskId, 1, 3);
+  EXPECT_FALSE(future.isReady());
+
+  // A late destination reads from the first page. The pages are freed once
+  // no destination can be added anymore.
+  bufferManager_->updateBroadcastOutputBuffers(taskId, 3, false);
+  fetch(taskId, 2, 0, std::numeric_limits<uint64_t>::max(), 3);
+  acknowledge(taskId, 2, 2);
+  bufferManager_->updateBroadcastOutputBuffers(taskId, 3, true);
+  EXPECT_FALSE(future.isReady());
+  acknowledge(taskId, 2, 3);
+  EXPECT_TRUE(future.isReady());
+
+  noMoreData(taskId);
+  for (int destination = 0; destination < 3; destination++) {
+    fetchEndMarker(taskId, destination, 3);
+  }
+  EXPECT_EQ(task->state(), kFinished);
+}
+
 TEST_F(PartitionedOutputBufferManagerTest, outOfOrderAcks) {
   std::vector<std::string> names = {"c0", "c1"};
   std::vector<TypePtr> types = {BIGINT(), VARCHAR()};
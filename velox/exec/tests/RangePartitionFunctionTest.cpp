@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/RangePartitionFunction.h"
+#include <gtest/gtest.h>
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+
+class RangePartitionFunctionTest : public testing::Test {
+ protected:
+  std::unique_ptr<memory::MemoryPool> pool_{
+      memory::getDefaultScopedMemoryPool()};
+  test::VectorMaker vm_{pool_.get()};
+};
+
+TEST_F(RangePartitionFunctionTest, singleKey) {
+  auto splitPoints = vm_.rowVector({vm_.flatVector<int64_t>({10, 20, 30})});
+  exec::RangePartitionFunction partitionFunction(
+      4, {1}, {core::SortOrder(true, true)}, splitPoints);
+
+  auto data = vm_.rowVector(
+      {vm_.flatVector<int32_t>(100, [](auto row) { return row; }),
+       vm_.flatVector<int64_t>(
+           100,
+           [](auto row) { return row % 40; },
+           test::VectorMaker::nullEvery(7))});
+  std::vector<uint32_t> partitions;
+  partitionFunction.partition(*data, partitions);
+  ASSERT_EQ(100, partitions.size());
+  for (auto i = 0; i < 100; ++i) {
+    if (i % 7 == 0) {
+      // Nulls sort first.
+      ASSERT_EQ(0, partitions[i]) << "at " << i;
+      continue;
+    }
+    auto key = i % 40;
+    uint32_t expected = key <= 10 ? 0 : key <= 20 ? 1 : key <= 30 ? 2 : 3;
+    ASSERT_EQ(expected, partitions[i]) << "at " << i;
+  }
+}
+
+TEST_F(RangePartitionFunctionTest, multipleKeys) {
+  // Descending on c0, ascending on c1.
+  auto splitPoints = vm_.rowVector(
+      {vm_.flatVector<int64_t>({5, 5, 2}), vm_.flatVector<int64_t>({3, 7, 0})});
+  exec::RangePartitionFunction partitionFunction(
+      4,
+      {0, 1},
+      {core::SortOrder(false, false), core::SortOrder(true, false)},
+      splitPoints);
+
+  auto data = vm_.rowVector(
+      {vm_.flatVector<int64_t>({9, 5, 5, 5, 5, 3, 2, 2, 1}),
+       vm_.flatVector<int64_t>({0, 1, 3, 4, 8, 9, 0, 1, 0})});
+  std::vector<uint32_t> partitions;
+  partitionFunction.partition(*data, partitions);
+  std::vector<uint32_t> expected{0, 0, 0, 1, 2, 2, 2, 3, 3};
+  ASSERT_EQ(expected, partitions);
+}
+
+TEST_F(RangePartitionFunctionTest, splitPointsFromSample) {
+  auto sample = vm_.rowVector({vm_.flatVector<int64_t>(
+      1'000, [](auto row) { return (row * 7919) % 1'000; })});
+  auto splitPoints = exec::RangePartitionFunction::splitPointsFromSample(
+      *sample, {0}, {core::SortOrder(true, true)}, 4, pool_.get());
+  ASSERT_EQ(3, splitPoints->size());
+  auto values = splitPoints->childAt(0)->asFlatVector<int64_t>();
+  EXPECT_EQ(249, values->valueAt(0));
+  EXPECT_EQ(499, values->valueAt(1));
+  EXPECT_EQ(749, values->valueAt(2));
+
+  // Each partition gets a quarter of the sample.
+  exec::RangePartitionFunction partitionFunction(
+      4, {0}, {core::SortOrder(true, true)}, splitPoints);
+  std::vector<uint32_t> partitions;
+  partitionFunction.partition(*sample, partitions);
+  std::vector<int32_t> counts(4);
+  for (auto partition : partitions) {
+    ++counts[partition];
+  }
+  EXPECT_EQ(std::vector<int32_t>(4, 250), counts);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/RemoteDynamicFilters.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+
+namespace {
+std::shared_ptr<common::Filter> values(const std::vector<int64_t>& values) {
+  return common::createBigintValues(values, false);
+}
+
+std::shared_ptr<common::Filter> bloomFilter(
+    const std::vector<int64_t>& values,
+    int32_t capacity) {
+  auto bloom = std::make_shared<BloomFilter<false>>();
+  bloom->reset(capacity);
+  for (auto value : values) {
+    bloom->insert(common::BigintValuesUsingBloomFilter::hashValue(value));
+  }
+  return std::make_shared<common::BigintValuesUsingBloomFilter>(
+      *std::min_element(values.begin(), values.end()),
+      *std::max_element(values.begin(), values.end()),
+      bloom,
+      false);
+}
+} // namespace
+
+TEST(RemoteDynamicFiltersTest, values) {
+  auto merged = unionDynamicFilters(
+      {values({1, 5, 9}), values({100, 200}), values({5, 7})});
+  ASSERT_TRUE(merged);
+  for (auto value : {1, 5, 7, 9, 100, 200}) {
+    EXPECT_TRUE(merged->testInt64(value)) << value;
+  }
+  for (auto value : {0, 2, 8, 150, 201}) {
+    EXPECT_FALSE(merged->testInt64(value)) << value;
+  }
+
+  auto single = values({3});
+  merged = unionDynamicFilters({single});
+  EXPECT_NE(single.get(), merged.get());
+  EXPECT_TRUE(merged->testInt64(3));
+  EXPECT_FALSE(merged->testInt64(4));
+}
+
+TEST(RemoteDynamicFiltersTest, range) {
+  auto merged = unionDynamicFilters(
+      {std::make_shared<common::BigintRange>(10, 20, false),
+       values({30, 40})});
+  ASSERT_EQ(common::FilterKind::kBigintRange, merged->kind());
+  EXPECT_TRUE(merged->testInt64(10));
+  EXPECT_TRUE(merged->testInt64(40));
+  EXPECT_FALSE(merged->testInt64(9));
+  EXPECT_FALSE(merged->testInt64(41));
+}
+
+TEST(RemoteDynamicFiltersTest, bloomFilter) {
+  std::vector<int64_t> small;
+  std::vector<int64_t> large;
+  for (auto i = 0; i < 1'000; ++i) {
+    small.push_back(i * 7);
+    large.push_back(1'000'000 + i * 13);
+  }
+  auto merged = unionDynamicFilters(
+      {bloomFilter(small, small.size()),
+       bloomFilter(large, large.size() * 8),
+       values({-5, -3})});
+  ASSERT_EQ(common::FilterKind::kBigintValuesUsingBloomFilter, merged->kind());
+  for (auto value : small) {
+    EXPECT_TRUE(merged->testInt64(value)) << value;
+  }
+  for (auto value : large) {
+    EXPECT_TRUE(merged->testInt64(value)) << value;
+  }
+  EXPECT_TRUE(merged->testInt64(-5));
+  EXPECT_TRUE(merged->testInt64(-3));
+  EXPECT_FALSE(merged->testInt64(-6));
+  EXPECT_FALSE(merged->testInt64(2'000'000));
+}
+
+TEST(RemoteDynamicFiltersTest, alwaysFalseAndNull) {
+  auto merged = unionDynamicFilters(
+      {std::make_shared<common::AlwaysFalse>(), values({1, 2})});
+  EXPECT_TRUE(merged->testInt64(1));
+  EXPECT_FALSE(merged->testInt64(3));
+
+  merged = unionDynamicFilters(
+      {std::make_shared<common::AlwaysFalse>(),
+       std::make_shared<common::AlwaysFalse>()});
+  EXPECT_EQ(common::FilterKind::kAlwaysFalse, merged->kind());
+
+  EXPECT_FALSE(unionDynamicFilters({values({1, 2}), nullptr}));
+  EXPECT_FALSE(unionDynamicFilters(
+      {values({1, 2}), std::make_shared<common::DoubleRange>(
+                           0, false, false, 1, false, false, false)}));
+  EXPECT_FALSE(unionDynamicFilters({}));
+}
@@ -440,6 +440,72 @@ TEST_F(RowContainerTest, erase) {
   data->checkConsistency();
 }
 
+TEST_F(RowContainerTest, compactStrings) {
+  constexpr int32_t kNumRows = 20'000;
+  auto data = makeRowContainer({BIGINT()}, {VARCHAR(), ARRAY(VARCHAR())});
+  facebook::velox::test::VectorMaker vectorMaker{pool_.get()};
+  std::vector<std::string> strings;
+  for (auto i = 0; i < kNumRows; ++i) {
+    strings.push_back(fmt::format("{}{}", std::string(100, 'x'), i));
+  }
+  auto keys = vectorMaker.flatVector<int64_t>(
+      kNumRows, [](vector_size_t row) { return row; });
+  auto varchars = vectorMaker.flatVector(strings);
+  auto arrays = vectorMaker.arrayVector<StringView>(
+      kNumRows,
+      [](vector_size_t /*row*/) { return 2; },
+      [&](vector_size_t row, vector_size_t index) {
+        return StringView(strings[(row + index) % kNumRows]);
+      });
+  std::vector<VectorPtr> columns{keys, varchars, arrays};
+  SelectivityVector allRows(kNumRows);
+  std::vector<char*> rows(kNumRows);
+  for (auto i = 0; i < kNumRows; ++i) {
+    rows[i] = data->newRow();
+  }
+  for (auto column = 0; column < columns.size(); ++column) {
+    DecodedVector decoded(*columns[column], allRows);
+    for (auto i = 0; i < kNumRows; ++i) {
+      data->store(decoded, i, rows[i], column);
+    }
+  }
+  EXPECT_TRUE(data->canCompactStrings());
+  EXPECT_EQ(0, data->numStringCompactions());
+
+  // Erasing most rows leaves their variable width data as free space.
+  // The erase compacts the rest into a new allocator.
+  std::vector<char*> erased;
+  std::vector<char*> kept;
+  std::vector<vector_size_t> keptIndices;
+  for (auto i = 0; i < kNumRows; ++i) {
+    if (i % 10 == 0) {
+      kept.push_back(rows[i]);
+      keptIndices.push_back(i);
+    } else {
+      erased.push_back(rows[i]);
+    }
+  }
+  auto bytesBefore = data->allocatedBytes();
+  data->eraseRows(folly::Range<char**>(erased.data(), erased.size()));
+  EXPECT_EQ(1, data->numStringCompactions());
+  EXPECT_LT(0, data->compactedStringBytes());
+  EXPECT_LT(data->allocatedBytes(), bytesBefore);
+  EXPECT_GT(0.5, data->stringFragmentation());
+  data->stringAllocator().checkConsistency();
+
+  auto indices =
+      AlignedBuffer::allocate<vector_size_t>(kept.size(), pool_.get());
+  std::copy(
+      keptIndices.begin(),
+      keptIndices.end(),
+      indices->asMutable<vector_size_t>());
+  for (auto column = 0; column < columns.size(); ++column) {
+    auto expected = BaseVector::wrapInDictionary(
+        nullptr, indices, kept.size(), columns[column]);
+    testExtractColumnForAllRows(*data, kept, column, expected);
+  }
+}
+
 TEST_F(RowContainerTest, rowSize) {
   constexpr int32_t kNumRows = 100;
   auto data = makeRowContainer({SMALLINT()}, {VARCHAR()});
@@ -495,3 +561,144 @@ TEST_F(RowContainerTest, compareDouble) {
   // Verify descending order
   testCompareFloats<double>(DOUBLE(), false);
 }
+
+// Verify string comparisons that are decided on the size and prefix and
+// those that need the full strings.
+TEST_F(RowContainerTest, compareStrings) {
+  std::vector<std::string> strings = {
+      "",
+      "a",
+      "abc",
+      "abcd",
+      "abce",
+      "abcdefghijkl",
+      "abcdefghijkm",
+      "abcdefghijklmnopqrstuvwxyz",
+      "abcdefghijklmnopqrstuvwxyZ",
+      "abcdefghijklmnopqrstuvwxyz0",
+      "abd",
+      "b"};
+  auto rowContainer = makeRowContainer({VARCHAR()}, std::vector<TypePtr>{});
+  facebook::velox::test::VectorMaker vectorMaker{pool_.get()};
+  std::vector<StringView> views;
+  for (const auto& string : strings) {
+    views.emplace_back(string);
+  }
+  auto values = vectorMaker.flatVector<StringView>(views);
+  auto numRows = values->size();
+  SelectivityVector allRows(numRows);
+  DecodedVector decoded(*values, allRows);
+  std::vector<char*> rows(numRows);
+  for (auto i = 0; i < numRows; ++i) {
+    rows[i] = rowContainer->newRow();
+    rowContainer->store(decoded, i, rows[i], 0);
+  }
+  auto column = rowContainer->columnAt(0);
+  for (auto i = 0; i < numRows; ++i) {
+    for (auto j = 0; j < numRows; ++j) {
+      auto expected = sign(strings[i].compare(strings[j]));
+      EXPECT_EQ(expected, sign(rowContainer->compare(rows[i], rows[j], 0)))
+          << strings[i] << " vs " << strings[j];
+      EXPECT_EQ(
+          expected, sign(rowContainer->compare(rows[i], column, decoded, j)))
+          << strings[i] << " vs " << strings[j];
+      EXPECT_EQ(
+          i == j, rowContainer->equals<false>(rows[i], column, decoded, j));
+      EXPECT_EQ(
+          i == j, rowContainer->equals<true>(rows[i], column, decoded, j));
+    }
+  }
+}
+
+// Verifies that timestamps stored as nanoseconds read, compare and hash the
+// same as those stored as Timestamp.
+TEST_F(RowContainerTest, packedTimestamps) {
+  static const std::vector<std::unique_ptr<Aggregate>> kEmptyAggregates;
+  auto makeContainer = [&](bool packTimestamps) {
+    return std::make_unique<RowContainer>(
+        std::vector<TypePtr>{TIMESTAMP()},
+        true, // nullableKeys
+        kEmptyAggregates,
+        std::vector<TypePtr>{TIMESTAMP()},
+        false, // hasNext
+        false, // isJoinBuild
+        false, // hasProbedFlag
+        false, // hasNormalizedKey
+        mappedMemory_,
+        ContainerRowSerde::instance(),
+        packTimestamps);
+  };
+  auto packed = makeContainer(true);
+  auto unpacked = makeContainer(false);
+  // The key and the dependent column take 8 instead of 16 bytes each.
+  EXPECT_EQ(unpacked->fixedRowSize() - 16, packed->fixedRowSize());
+  EXPECT_TRUE(packed->columnAt(0).packedTimestamp());
+  EXPECT_TRUE(packed->columnAt(1).packedTimestamp());
+  EXPECT_FALSE(unpacked->columnAt(0).packedTimestamp());
+
+  facebook::velox::test::VectorMaker vectorMaker{pool_.get()};
+  auto values = vectorMaker.flatVectorNullable<Timestamp>(
+      {Timestamp(0, 0),
+       std::nullopt,
+       Timestamp(-1, 999'999'999),
+       Timestamp(1'600'000'000, 123'456'789),
+       Timestamp(-1'600'000'000, 1),
+       Timestamp(1'600'000'000, 123'456'789)});
+  auto numRows = values->size();
+  SelectivityVector allRows(numRows);
+  DecodedVector decoded(*values, allRows);
+  std::vector<char*> packedRows(numRows);
+  std::vector<char*> unpackedRows(numRows);
+  for (auto i = 0; i < numRows; ++i) {
+    packedRows[i] = packed->newRow();
+    unpackedRows[i] = unpacked->newRow();
+    for (auto column = 0; column < 2; ++column) {
+      packed->store(decoded, i, packedRows[i], column);
+      unpacked->store(decoded, i, unpackedRows[i], column);
+    }
+  }
+
+  for (auto column = 0; column < 2; ++column) {
+    testExtractColumnForAllRows(*packed, packedRows, column, values);
+    testExtractColumnForOddRows(*packed, packedRows, column, values);
+  }
+
+  auto column = packed->columnAt(0);
+  auto unpackedColumn = unpacked->columnAt(0);
+  for (auto i = 0; i < numRows; ++i) {
+    for (auto j = 0; j < numRows; ++j) {
+      EXPECT_EQ(
+          unpacked->compare(unpackedRows[i], unpackedRows[j], 0),
+          packed->compare(packedRows[i], packedRows[j], 0));
+      EXPECT_EQ(
+          unpacked->compare(unpackedRows[i], unpackedColumn, decoded, j),
+          packed->compare(packedRows[i], column, decoded, j));
+      EXPECT_EQ(
+          unpacked->equals<true>(unpackedRows[i], unpackedColumn, decoded, j),
+          packed->equals<true>(packedRows[i], column, decoded, j));
+    }
+  }
+
+  std::vector<uint64_t> packedHashes(numRows);
+  std::vector<uint64_t> unpackedHashes(numRows);
+  packed->hash(
+      0,
+      folly::Range<char**>(packedRows.data(), numRows),
+      false,
+      packedHashes.data());
+  unpacked->hash(
+      0,
+      folly::Range<char**>(unpackedRows.data(), numRows),
+      false,
+      unpackedHashes.data());
+  EXPECT_EQ(unpackedHashes, packedHashes);
+
+  // A timestamp that does not fit in nanoseconds cannot be stored.
+  auto outOfRange = vectorMaker.flatVector<Timestamp>(
+      {Timestamp(Timestamp::kMaxNanosSeconds + 1, 0)});
+  SelectivityVector oneRow(1);
+  DecodedVector decodedOutOfRange(*outOfRange, oneRow);
+  EXPECT_THROW(
+      packed->store(decodedOutOfRange, 0, packed->newRow(), 0),
+      VeloxUserError);
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/SkewedHashPartitionFunction.h"
+#include <gtest/gtest.h>
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+
+class SkewedHashPartitionFunctionTest : public testing::Test {
+ protected:
+  std::unique_ptr<memory::MemoryPool> pool_{
+      memory::getDefaultScopedMemoryPool()};
+  test::VectorMaker vm_{pool_.get()};
+};
+
+TEST_F(SkewedHashPartitionFunctionTest, hotKeysFromSample) {
+  // Key 7 is in half of the rows and key 3 in a tenth.
+  auto sample = vm_.rowVector(
+      {vm_.flatVector<int32_t>(1'000, [](auto row) { return row; }),
+       vm_.flatVector<int64_t>(1'000, [](auto row) {
+         return row % 2 == 0 ? 7 : row % 10 == 1 ? 3 : row;
+       })});
+  auto hotKeys = exec::SkewedHashPartitionFunction::hotKeysFromSample(
+      *sample, {1}, 0.05);
+  ASSERT_EQ(2, hotKeys->size());
+  hotKeys = exec::SkewedHashPartitionFunction::hotKeysFromSample(
+      *sample, {1}, 0.2);
+  ASSERT_EQ(1, hotKeys->size());
+  hotKeys = exec::SkewedHashPartitionFunction::hotKeysFromSample(
+      *sample, {0}, 0.0);
+  ASSERT_TRUE(hotKeys->empty());
+}
+
+TEST_F(SkewedHashPartitionFunctionTest, partition) {
+  auto rowType = ROW({"c0"}, {BIGINT()});
+  auto data = vm_.rowVector({vm_.flatVector<int64_t>(
+      1'000, [](auto row) { return row % 4 == 0 ? 7 : row; })});
+  std::shared_ptr<const exec::HotKeyHashes> hotKeys =
+      exec::SkewedHashPartitionFunction::hotKeysFromSample(*data, {0}, 0.1);
+  ASSERT_EQ(1, hotKeys->size());
+
+  exec::HashPartitionFunction hashFunction(8, rowType, {0});
+  exec::SkewedHashPartitionFunction spread(8, rowType, {0}, hotKeys, false);
+  exec::SkewedHashPartitionFunction replicate(8, rowType, {0}, hotKeys, true);
+  std::vector<uint32_t> expected;
+  std::vector<uint32_t> spreadPartitions;
+  std::vector<uint32_t> replicatePartitions;
+  hashFunction.partition(*data, expected);
+  spread.partition(*data, spreadPartitions);
+  replicate.partition(*data, replicatePartitions);
+
+  std::vector<int32_t> hotRowsPerPartition(8);
+  for (auto i = 0; i < data->size(); ++i) {
+    if (i % 4 != 0) {
+      ASSERT_EQ(expected[i], spreadPartitions[i]) << "at " << i;
+      ASSERT_EQ(expected[i], replicatePartitions[i]) << "at " << i;
+      continue;
+    }
+    ASSERT_EQ(
+        core::PartitionFunction::kAllPartitions, replicatePartitions[i])
+        << "at " << i;
+    ASSERT_LT(spreadPartitions[i], 8);
+    ++hotRowsPerPartition[spreadPartitions[i]];
+  }
+  // The 250 rows of the hot key are spread round-robin.
+  for (auto count : hotRowsPerPartition) {
+    EXPECT_GE(count, 31);
+    EXPECT_LE(count, 32);
+  }
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+class StreamingAggregationTest : public OperatorTestBase {
+ protected:
+  static CursorParameters makeCursorParameters(
+      const std::shared_ptr<const core::PlanNode>& planNode,
+      uint32_t preferredOutputBatchSize) {
+    CursorParameters params;
+    params.planNode = planNode;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe(
+        {{core::QueryConfig::kPreferredOutputBatchSize,
+          std::to_string(preferredOutputBatchSize)}});
+    return params;
+  }
+
+  static void assertStreaming(const std::shared_ptr<Task>& task) {
+    int32_t numStreaming = 0;
+    for (auto& pipeline : task->taskStats().pipelineStats) {
+      for (auto& op : pipeline.operatorStats) {
+        if (op.operatorType == "StreamingAggregation" ||
+            op.operatorType == "PartialStreamingAggregation") {
+          ++numStreaming;
+        }
+      }
+    }
+    ASSERT_GT(numStreaming, 0);
+  }
+
+  void testAggregation(
+      const std::vector<RowVectorPtr>& data,
+      bool ignoreNullKeys,
+      const std::string& duckDbSql) {
+    createDuckDbTable(data);
+
+    auto plan = PlanBuilder()
+                    .values(data)
+                    .streamingAggregation(
+                        {0},
+                        {"count(c1)", "sum(c1)", "max(c1)"},
+                        {},
+                        core::AggregationNode::Step::kSingle,
+                        ignoreNullKeys)
+                    .planNode();
+
+    // Small output batches complete in the middle of an input batch.
+    for (auto batchSize : {1, 7, 1024}) {
+      assertStreaming(
+          assertQuery(makeCursorParameters(plan, batchSize), duckDbSql));
+    }
+
+    // Partial and final aggregation both stream since the partial results
+    // stay clustered on the grouping keys.
+    plan = PlanBuilder()
+               .values(data)
+               .streamingAggregation(
+                   {0},
+                   {"count(c1)", "sum(c1)", "max(c1)"},
+                   {},
+                   core::AggregationNode::Step::kPartial,
+                   ignoreNullKeys)
+               .streamingAggregation(
+                   {0},
+                   {"count(a0)", "sum(a1)", "max(a2)"},
+                   {},
+                   core::AggregationNode::Step::kFinal,
+                   ignoreNullKeys)
+               .planNode();
+    assertStreaming(assertQuery(makeCursorParameters(plan, 7), duckDbSql));
+  }
+};
+
+TEST_F(StreamingAggregationTest, bigintKey) {
+  // Groups of 7 rows, some of which span two input batches.
+  std::vector<RowVectorPtr> data;
+  for (auto i = 0; i < 3; ++i) {
+    data.push_back(makeRowVector({
+        makeFlatVector<int64_t>(
+            100, [&](auto row) { return (i * 100 + row) / 7; }),
+        makeFlatVector<int64_t>(100, [&](auto row) { return i * 100 + row; }),
+    }));
+  }
+
+  testAggregation(
+      data,
+      false,
+      "SELECT c0, count(c1), sum(c1), max(c1) FROM tmp GROUP BY 1");
+}
+
+TEST_F(StreamingAggregationTest, varcharKeyWithNulls) {
+  // The null keys form the last group.
+  std::vector<RowVectorPtr> data;
+  for (auto i = 0; i < 3; ++i) {
+    std::vector<std::optional<std::string>> keys;
+    for (auto row = 0; row < 100; ++row) {
+      auto n = i * 100 + row;
+      if (n >= 250) {
+        keys.push_back(std::nullopt);
+      } else {
+        keys.push_back("grouping key " + std::to_string(n / 11));
+      }
+    }
+    data.push_back(makeRowVector({
+        makeNullableFlatVector(keys),
+        makeFlatVector<int64_t>(100, [&](auto row) { return row % 13; }),
+    }));
+  }
+
+  testAggregation(
+      data,
+      false,
+      "SELECT c0, count(c1), sum(c1), max(c1) FROM tmp GROUP BY 1");
+  testAggregation(
+      data,
+      true,
+      "SELECT c0, count(c1), sum(c1), max(c1) FROM tmp "
+      "WHERE c0 IS NOT NULL GROUP BY 1");
+}
+
+TEST_F(StreamingAggregationTest, rejectsUngroupedKeys) {
+  auto data = makeRowVector({
+      makeFlatVector<int64_t>(10, [](auto row) { return row; }),
+      makeFlatVector<int64_t>(10, [](auto row) { return row; }),
+  });
+  auto keys = std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>{
+      std::make_shared<core::FieldAccessTypedExpr>(BIGINT(), "c0")};
+  auto preGroupedKeys =
+      std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>{
+          std::make_shared<core::FieldAccessTypedExpr>(BIGINT(), "c1")};
+  auto values = PlanBuilder().values({data}).planNode();
+  EXPECT_THROW(
+      std::make_shared<core::AggregationNode>(
+          "1",
+          core::AggregationNode::Step::kSingle,
+          keys,
+          preGroupedKeys,
+          std::vector<std::string>{},
+          std::vector<std::shared_ptr<const core::CallTypedExpr>>{},
+          std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>>{},
+          false,
+          values),
+      VeloxException);
+}
@@ -40,6 +40,8 @@ using namespace facebook::velox::exec::test;
 
 static const std::string kNodeSelectionStrategy = "node_selection_strategy";
 static const std::string kSoftAffinity = "SOFT_AFFINITY";
+static const std::string kReturnRunLengthEncoded = "return_run_length_encoded";
+static const std::string kReturnIntegerDictionary = "return_integer_dictionary";
 static const std::string kTableScanTest = "TableScanTest.Writer";
 
 class TableScanTest : public virtual HiveConnectorTestBase,
@@ -338,7 +340,7 @@ TEST_P(TableScanTest, constDictLazy) {
 
   // Orchestrate a Const(Dict(Lazy)) for a complex type (map)
   tableHandle =
-      makeTableHandle(SubfieldFilters{}, parseExpr("c0 = 0", rowType));
+      makeTableHandle(SubfieldFilters{}, parseExpr("c0 % 1000 = 0", rowType));
   op = PlanBuilder()
            .tableScan(rowType, tableHandle, assignments)
            .project({"cardinality(c2)"})
@@ -347,7 +349,7 @@ TEST_P(TableScanTest, constDictLazy) {
   assertQuery(op, {filePath}, "SELECT 0 FROM tmp WHERE c0 = 5");
 
   tableHandle =
-      makeTableHandle(SubfieldFilters{}, parseExpr("c0 = 2", rowType));
+      makeTableHandle(SubfieldFilters{}, parseExpr("c0 % 1000 = 2", rowType));
   op = PlanBuilder()
            .tableScan(rowType, tableHandle, assignments)
            .project({"cardinality(c2)"})
@@ -468,6 +470,60 @@ TEST_P(TableScanTest, splitDoubleRead) {
   }
 }
 
+TEST_P(TableScanTest, metadataOnlySplits) {
+  auto filePaths = makeFilePaths(3);
+  auto vectors = makeVectors(3, 1'000);
+  for (int32_t i = 0; i < vectors.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors[i]);
+  }
+  createDuckDbTable(vectors);
+
+  // The row counts come from the footers.
+  auto op = PlanBuilder()
+                .tableScan(ROW({}, {}))
+                .finalAggregation({}, {"sum(1)"})
+                .planNode();
+  auto task = assertQuery(op, filePaths, "SELECT count(*) FROM tmp");
+  EXPECT_EQ(3, getTableScanStats(task).runtimeStats["metadataOnlySplits"].sum);
+
+  // Partition keys are constant for each split.
+  std::vector<std::shared_ptr<connector::ConnectorSplit>> splits;
+  for (auto i = 0; i < filePaths.size(); ++i) {
+    std::unordered_map<std::string, std::optional<std::string>>
+        partitionKeys = {{"ds", fmt::format("2022-01-0{}", i + 1)}};
+    splits.push_back(std::make_shared<HiveConnectorSplit>(
+        kHiveConnectorId,
+        filePaths[i]->path,
+        facebook::velox::dwio::common::FileFormat::ORC,
+        0,
+        fs::file_size(filePaths[i]->path),
+        partitionKeys));
+  }
+  op = PlanBuilder()
+           .tableScan(
+               ROW({"ds"}, {VARCHAR()}),
+               makeTableHandle(SubfieldFilters{}),
+               {{"ds", partitionKey("ds", VARCHAR())}})
+           .singleAggregation({}, {"max(ds)", "count(1)"})
+           .planNode();
+  task = OperatorTestBase::assertQuery(
+      op, splits, "SELECT '2022-01-03', count(*) FROM tmp");
+  EXPECT_EQ(3, getTableScanStats(task).runtimeStats["metadataOnlySplits"].sum);
+
+  // A split of part of a file is read. The one stripe of the file starts in
+  // the first half.
+  op = PlanBuilder()
+           .tableScan(ROW({}, {}))
+           .finalAggregation({}, {"sum(1)"})
+           .planNode();
+  task = assertQuery(
+      op,
+      makeHiveConnectorSplit(
+          filePaths[0]->path, 0, fs::file_size(filePaths[0]->path) / 2),
+      "SELECT 1000::BIGINT");
+  EXPECT_EQ(0, getTableScanStats(task).runtimeStats["metadataOnlySplits"].sum);
+}
+
 TEST_P(TableScanTest, multipleSplits) {
   auto filePaths = makeFilePaths(10);
   auto vectors = makeVectors(10, 1'000);
@@ -479,6 +535,360 @@ TEST_P(TableScanTest, multipleSplits) {
   assertQuery(tableScanNode(), filePaths, "SELECT * FROM tmp");
 }
 
+TEST_P(TableScanTest, splitPreload) {
+  auto filePaths = makeFilePaths(10);
+  auto vectors = makeVectors(10, 1'000);
+  for (int32_t i = 0; i < vectors.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors[i]);
+  }
+  createDuckDbTable(vectors);
+
+  auto task = assertQuery(tableScanNode(), filePaths, "SELECT * FROM tmp");
+  // All splits are queued before the scan starts. Each split after the
+  // first is preloaded while the previous one is read if the connector has
+  // an executor, which is the case with the AsyncDataCache.
+  EXPECT_EQ(
+      GetParam() ? static_cast<int64_t>(filePaths.size()) - 1 : 0,
+      getTableScanStats(task).runtimeStats["preloadedSplits"].sum);
+}
+
+TEST_P(TableScanTest, fragmentResultCache) {
+  auto filePaths = makeFilePaths(4);
+  auto vectors = makeVectors(4, 1'000);
+  for (int32_t i = 0; i < vectors.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors[i]);
+  }
+  createDuckDbTable(vectors);
+
+  auto assignments = allRegularColumns(rowType_);
+  auto tableHandle = makeTableHandle(SubfieldFilters(), nullptr);
+  auto fingerprint = fmt::format("fragmentResultCache:{}", filePaths[0]->path);
+  auto plan = PlanBuilder()
+                  .addNode([&](std::string id, auto /*source*/) {
+                    return std::make_shared<core::TableScanNode>(
+                        id, rowType_, tableHandle, assignments, fingerprint);
+                  })
+                  .filter("c1 % 3 <> 0")
+                  .partialAggregation({6}, {"count(1)", "sum(c1)"})
+                  .finalAggregation({0}, {"sum(a0)", "sum(a1)"})
+                  .planNode();
+  // The splits have a modification time and so a cache key.
+  auto addSplits = [&](Task* task) {
+    for (const auto& filePath : filePaths) {
+      addSplit(
+          task,
+          "0",
+          exec::Split(std::make_shared<HiveConnectorSplit>(
+              kHiveConnectorId,
+              filePath->path,
+              facebook::velox::dwio::common::FileFormat::ORC,
+              0,
+              fs::file_size(filePath->path),
+              std::unordered_map<std::string, std::optional<std::string>>{},
+              std::nullopt,
+              1)));
+    }
+    task->noMoreSplits("0");
+  };
+  auto run = [&]() {
+    CursorParameters params;
+    params.planNode = plan;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe(
+        {{core::QueryConfig::kFragmentResultCacheEnabled, "true"}});
+    return test::assertQuery(
+        params,
+        addSplits,
+        "SELECT c6, count(1), sum(c1) FROM tmp WHERE c1 % 3 <> 0 GROUP BY 1",
+        duckDbQueryRunner_);
+  };
+
+  // The results are kept in the AsyncDataCache. The second run reads none
+  // of the splits.
+  auto task = run();
+  auto aggregationStats = task->taskStats().pipelineStats[0].operatorStats[2];
+  EXPECT_EQ(0, aggregationStats.runtimeStats["fragmentCacheHits"].sum);
+  EXPECT_EQ(
+      GetParam() ? 4 : 0,
+      aggregationStats.runtimeStats["fragmentCacheMisses"].sum);
+
+  task = run();
+  aggregationStats = task->taskStats().pipelineStats[0].operatorStats[2];
+  EXPECT_EQ(
+      GetParam() ? 4 : 0,
+      aggregationStats.runtimeStats["fragmentCacheHits"].sum);
+  EXPECT_EQ(0, aggregationStats.runtimeStats["fragmentCacheMisses"].sum);
+  EXPECT_EQ(GetParam() ? 0 : 4'000, getTableScanStats(task).inputPositions);
+}
+
+TEST_P(TableScanTest, remoteDynamicFilters) {
+  auto filePath = TempFilePath::create();
+  std::vector<RowVectorPtr> vectors = {makeRowVector(
+      {makeFlatVector<int64_t>(10'000, [](auto row) { return row; }),
+       makeFlatVector<int64_t>(10'000, [](auto row) { return row * 3; })})};
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+
+  // Two Tasks build the join with the scanned rows. The filter on c0 is
+  // ready once both have reported it. The filter on 'x', a column the scan
+  // does not produce, is ignored.
+  auto plan = tableScanNode(ROW({"c0", "c1"}, {BIGINT(), BIGINT()}));
+  bool splitsAdded = false;
+  auto task = ::assertQuery(
+      plan,
+      [&](Task* task) {
+        if (splitsAdded) {
+          return;
+        }
+        task->addRemoteDynamicFilter(
+            "0",
+            "c0",
+            "build.1",
+            2,
+            common::createBigintValues({5, 17}, false));
+        // Added again by the same source.
+        task->addRemoteDynamicFilter(
+            "0", "c0", "build.1", 2, common::createBigintValues({1, 2}, false));
+        EXPECT_EQ(0, task->remoteDynamicFilterVersion());
+        task->addRemoteDynamicFilter(
+            "0",
+            "c0",
+            "build.2",
+            2,
+            common::createBigintValues({300, 9'999}, false));
+        for (const auto& source : {"build.1", "build.2"}) {
+          task->addRemoteDynamicFilter(
+              "0",
+              "x",
+              source,
+              2,
+              std::make_shared<common::BigintRange>(0, 10, false));
+        }
+        EXPECT_EQ(2, task->remoteDynamicFilterVersion());
+        addSplit(task, "0", makeHiveSplit(filePath->path));
+        task->noMoreSplits("0");
+        splitsAdded = true;
+      },
+      "SELECT * FROM tmp WHERE c0 IN (5, 17, 300, 9999)",
+      duckDbQueryRunner_);
+  EXPECT_EQ(
+      1,
+      getTableScanStats(task).runtimeStats["remoteDynamicFiltersAccepted"].sum);
+}
+
+TEST_P(TableScanTest, limitFinishesScanEarly) {
+  auto filePaths = makeFilePaths(10);
+  auto vectors = makeVectors(10, 1'000);
+  for (int32_t i = 0; i < vectors.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors[i]);
+  }
+
+  CursorParameters params;
+  params.planNode =
+      PlanBuilder().tableScan(rowType_).limit(0, 10, true).planNode();
+  params.maxDrivers = 2;
+  auto cursor = std::make_unique<TaskCursor>(params);
+  auto task = cursor->task();
+  for (const auto& filePath : filePaths) {
+    addSplit(task.get(), "0", makeHiveSplit(filePath->path));
+  }
+  task->noMoreSplits("0");
+
+  int32_t numRead = 0;
+  while (cursor->moveNext()) {
+    numRead += cursor->current()->size();
+  }
+  // Each Driver has a partial Limit of 10 rows. The first one to get them
+  // stops the scans of both, so that most splits are never read.
+  EXPECT_GE(numRead, 10);
+  EXPECT_LE(numRead, 20);
+  EXPECT_LE(getTableScanStats(task).numSplits, 2);
+  EXPECT_TRUE(task->isSourceFinishedEarly("0"));
+
+  // Splits added after the scan finished are ignored.
+  addSplit(task.get(), "0", makeHiveSplit(filePaths[0]->path));
+}
+
+TEST_P(TableScanTest, topNCutoffPushdown) {
+  auto rowType = ROW({"c0", "c1"}, {BIGINT(), INTEGER()});
+  auto filePaths = makeFilePaths(10);
+  std::vector<RowVectorPtr> vectors;
+  for (int32_t i = 0; i < filePaths.size(); i++) {
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int64_t>(
+             1'000,
+             [&](auto row) { return (row * 7 + i * 13) % 5'000; },
+             nullEvery(997)),
+         makeFlatVector<int32_t>(1'000, [&](auto row) { return row + i; })}));
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors.back());
+  }
+  createDuckDbTable(vectors);
+
+  const std::vector<core::SortOrder> sortOrders = {
+      {true, true}, {true, false}, {false, true}, {false, false}};
+  const std::vector<std::string> sortOrderSqls = {
+      "NULLS FIRST", "NULLS LAST", "DESC NULLS FIRST", "DESC NULLS LAST"};
+  for (auto i = 0; i < sortOrders.size(); ++i) {
+    auto plan = PlanBuilder()
+                    .tableScan(rowType)
+                    .topN({0, 1}, {sortOrders[i], sortOrders[i]}, 100, false)
+                    .planNode();
+    auto task = assertQueryOrdered(
+        plan,
+        makeHiveSplits(filePaths),
+        fmt::format(
+            "SELECT * FROM tmp ORDER BY c0 {0}, c1 {0} LIMIT 100",
+            sortOrderSqls[i]),
+        {0, 1});
+    // The cutoff tightens as the top rows get replaced.
+    EXPECT_LT(
+        0,
+        getTableScanStats(task).runtimeStats["dynamicFiltersAccepted"].sum);
+  }
+}
+
+TEST_P(TableScanTest, preferredBatchBytes) {
+  auto vectors = makeVectors(10, 1'000);
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.planNode = tableScanNode();
+  params.queryCtx = core::QueryCtx::create();
+  // Rows of 'rowType_' are more than 30 bytes, so that batches after the
+  // first stay under 100 rows. The first batch is sized from the estimate
+  // of the reader.
+  params.queryCtx->setConfigOverridesUnsafe(
+      {{core::QueryConfig::kPreferredOutputBatchBytes, "3000"}});
+
+  auto cursor = std::make_unique<TaskCursor>(params);
+  addSplit(cursor->task().get(), "0", makeHiveSplit(filePath->path));
+  cursor->task()->noMoreSplits("0");
+
+  int32_t numRead = 0;
+  int32_t numBatches = 0;
+  while (cursor->moveNext()) {
+    auto vector = cursor->current();
+    if (numBatches++ > 0) {
+      EXPECT_LE(vector->size(), 100);
+    }
+    numRead += vector->size();
+  }
+  EXPECT_EQ(10'000, numRead);
+  EXPECT_LT(100, numBatches);
+}
+
+TEST_P(TableScanTest, runLengthEncoded) {
+  // 'c0' has runs of 100 equal values, 'c1' has no runs.
+  std::vector<RowVectorPtr> vectors = {makeRowVector({
+      makeFlatVector<int64_t>(10'000, [](auto row) { return row / 100; }),
+      makeFlatVector<double>(10'000, [](auto row) { return row * 0.1; }),
+  })};
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.planNode = tableScanNode(ROW({"c0", "c1"}, {BIGINT(), DOUBLE()}));
+  params.queryCtx = core::QueryCtx::create(
+      std::make_shared<core::MemConfig>(),
+      {{kHiveConnectorId,
+        std::make_shared<core::MemConfig>(
+            std::unordered_map<std::string, std::string>{
+                {kReturnRunLengthEncoded, "true"}})}},
+      memory::MappedMemory::getInstance());
+
+  auto cursor = std::make_unique<TaskCursor>(params);
+  addSplit(cursor->task().get(), "0", makeHiveSplit(filePath->path));
+  cursor->task()->noMoreSplits("0");
+  int32_t numRead = 0;
+  while (cursor->moveNext()) {
+    auto vector = cursor->current();
+    EXPECT_EQ(
+        VectorEncoding::Simple::SEQUENCE,
+        vector->childAt(0)->loadedVector()->encoding());
+    EXPECT_EQ(
+        VectorEncoding::Simple::FLAT,
+        vector->childAt(1)->loadedVector()->encoding());
+    numRead += vector->size();
+  }
+  EXPECT_EQ(10'000, numRead);
+
+  // Expressions over the runs are evaluated once per run.
+  params.planNode = PlanBuilder()
+                        .tableScan(ROW({"c0", "c1"}, {BIGINT(), DOUBLE()}))
+                        .project({"c0 * 2", "c1"})
+                        .planNode();
+  bool noMoreSplits = false;
+  ::assertQuery(
+      params,
+      [&](Task* task) {
+        if (!noMoreSplits) {
+          addSplit(task, "0", makeHiveSplit(filePath->path));
+          task->noMoreSplits("0");
+          noMoreSplits = true;
+        }
+      },
+      "SELECT c0 * 2, c1 FROM tmp",
+      duckDbQueryRunner_);
+}
+
+TEST_P(TableScanTest, integerDictionary) {
+  // 'c0' has 7 distinct values and is dictionary encoded, 'c1' is not.
+  std::vector<RowVectorPtr> vectors = {makeRowVector({
+      makeFlatVector<int64_t>(
+          10'000, [](auto row) { return row % 7 * 1'000; }, nullEvery(11)),
+      makeFlatVector<int64_t>(10'000, [](auto row) { return row; }),
+  })};
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+
+  CursorParameters params;
+  params.planNode = tableScanNode(ROW({"c0", "c1"}, {BIGINT(), BIGINT()}));
+  params.queryCtx = core::QueryCtx::create(
+      std::make_shared<core::MemConfig>(),
+      {{kHiveConnectorId,
+        std::make_shared<core::MemConfig>(
+            std::unordered_map<std::string, std::string>{
+                {kReturnIntegerDictionary, "true"}})}},
+      memory::MappedMemory::getInstance());
+
+  auto cursor = std::make_unique<TaskCursor>(params);
+  addSplit(cursor->task().get(), "0", makeHiveSplit(filePath->path));
+  cursor->task()->noMoreSplits("0");
+  int32_t numRead = 0;
+  while (cursor->moveNext()) {
+    auto vector = cursor->current();
+    EXPECT_EQ(
+        VectorEncoding::Simple::DICTIONARY,
+        vector->childAt(0)->loadedVector()->encoding());
+    EXPECT_EQ(
+        VectorEncoding::Simple::FLAT,
+        vector->childAt(1)->loadedVector()->encoding());
+    numRead += vector->size();
+  }
+  EXPECT_EQ(10'000, numRead);
+
+  params.planNode = PlanBuilder()
+                        .tableScan(ROW({"c0", "c1"}, {BIGINT(), BIGINT()}))
+                        .project({"c0 + 1", "c1"})
+                        .planNode();
+  bool noMoreSplits = false;
+  ::assertQuery(
+      params,
+      [&](Task* task) {
+        if (!noMoreSplits) {
+          addSplit(task, "0", makeHiveSplit(filePath->path));
+          task->noMoreSplits("0");
+          noMoreSplits = true;
+        }
+      },
+      "SELECT c0 + 1, c1 FROM tmp",
+      duckDbQueryRunner_);
+}
+
 TEST_P(TableScanTest, waitForSplit) {
   auto filePaths = makeFilePaths(10);
   auto vectors = makeVectors(10, 1'000);
@@ -1584,6 +1994,44 @@ TEST_P(TableScanTest, remainingFilter) {
       "SELECT c1, c2 FROM tmp WHERE c1 > c0");
 }
 
+// Conjuncts of the remaining filter on a single column become filters in
+// the column readers.
+TEST_P(TableScanTest, remainingFilterToSubfieldFilters) {
+  auto rowType = ROW({"c0", "c1", "c2"}, {BIGINT(), BIGINT(), INTEGER()});
+  auto filePaths = makeFilePaths(5);
+  auto vectors = makeVectors(5, 1'000, rowType);
+  for (int32_t i = 0; i < vectors.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableScanTest, vectors[i]);
+  }
+  createDuckDbTable(vectors);
+  auto assignments = allRegularColumns(rowType);
+
+  for (const auto& filter :
+       {"c0 % 3 = 1 and (c1 is null or c1 not in (1, 2, 3))",
+        "not (c0 between -100 and 100 or c0 is null) and c0 < c1",
+        "(c0 < 0 or c0 > 1000) and c1 % 2 = 0"}) {
+    auto tableHandle =
+        makeTableHandle(SubfieldFilters{}, parseExpr(filter, rowType));
+    assertQuery(
+        PlanBuilder().tableScan(rowType, tableHandle, assignments).planNode(),
+        filePaths,
+        fmt::format("SELECT * FROM tmp WHERE {}", filter));
+  }
+
+  // The filter on a column that is not projected out.
+  auto tableHandle = makeTableHandle(
+      SubfieldFilters{}, parseExpr("c1 > 0 and c0 % 2 = 0", rowType));
+  assertQuery(
+      PlanBuilder()
+          .tableScan(
+              ROW({"c0"}, {BIGINT()}),
+              tableHandle,
+              {{"c0", regularColumn("c0", BIGINT())}})
+          .planNode(),
+      filePaths,
+      "SELECT c0 FROM tmp WHERE c1 > 0 and c0 % 2 = 0");
+}
+
 TEST_P(TableScanTest, aggregationPushdown) {
   auto vectors = makeVectors(10, 1'000);
   auto filePath = TempFilePath::create();
@@ -1665,6 +2113,56 @@ TEST_P(TableScanTest, aggregationPushdown) {
       op, {filePath}, "SELECT c5, min(c0), max(c0 + c1) FROM tmp GROUP BY 1");
 }
 
+TEST_P(TableScanTest, globalAggregationPushdown) {
+  auto vectors = makeVectors(10, 1'000);
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, vectors);
+  createDuckDbTable(vectors);
+  auto assignments = allRegularColumns(rowType_);
+
+  auto tableHandle = makeTableHandle(SubfieldFilters(), nullptr);
+  auto op = PlanBuilder()
+                .tableScan(rowType_, tableHandle, assignments)
+                .singleAggregation(
+                    {},
+                    {"sum(c0)",
+                     "max(c1)",
+                     "min(c2)",
+                     "sum(c3)",
+                     "max(c4)",
+                     "count(c5)"})
+                .planNode();
+  assertQuery(
+      op,
+      {filePath},
+      "SELECT sum(c0), max(c1), min(c2), sum(c3), max(c4), count(c5) "
+      "FROM tmp");
+
+  // The filtered column is loaded. The others are aggregated while decoding
+  // the rows that pass.
+  tableHandle = makeTableHandle(
+      singleSubfieldFilter("c0", lessThanOrEqual(1'000)), nullptr);
+  op = PlanBuilder()
+           .tableScan(rowType_, tableHandle, assignments)
+           .singleAggregation(
+               {}, {"count(c1)", "sum(c1)", "min(c4)", "count(c5)"})
+           .planNode();
+  assertQuery(
+      op,
+      {filePath},
+      "SELECT count(c1), sum(c1), min(c4), count(c5) FROM tmp "
+      "WHERE c0 <= 1000");
+
+  op = PlanBuilder()
+           .tableScan(rowType_, tableHandle, assignments)
+           .singleAggregation({5}, {"count(c1)", "max(c2)"})
+           .planNode();
+  assertQuery(
+      op,
+      {filePath},
+      "SELECT c5, count(c1), max(c2) FROM tmp WHERE c0 <= 1000 GROUP BY 1");
+}
+
 TEST_P(TableScanTest, bitwiseAggregationPushdown) {
   auto vectors = makeVectors(10, 1'000);
   auto filePath = TempFilePath::create();
@@ -1735,6 +2233,67 @@ TEST_P(TableScanTest, structLazy) {
   assertQuery(op, {filePath}, "select c0 % 3 from tmp");
 }
 
+TEST_P(TableScanTest, lengthsOnly) {
+  vector_size_t size = 1'000;
+  auto isNullAt = [](auto row) { return row % 7 == 0; };
+  auto rowVector = makeRowVector(
+      {makeFlatVector<int64_t>(size, [](auto row) { return row; }),
+       makeArrayVector<int64_t>(
+           size,
+           [](auto row) { return row % 5; },
+           [](auto row, auto index) { return row + index; },
+           isNullAt),
+       makeMapVector<int64_t, double>(
+           size,
+           [](auto row) { return row % 3; },
+           [](auto index) { return index; },
+           [](auto index) { return index * 0.1; },
+           isNullAt)});
+
+  auto filePath = TempFilePath::create();
+  writeToFile(filePath->path, kTableScanTest, {rowVector});
+  // Exclude the complex columns as DuckDB doesn't support these yet.
+  createDuckDbTable({makeRowVector({rowVector->childAt(0)})});
+
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+  ColumnHandleMap assignments = {
+      {"c0", regularColumn("c0", BIGINT())},
+      {"c1",
+       std::make_shared<connector::hive::HiveColumnHandle>(
+           "c1",
+           connector::hive::HiveColumnHandle::ColumnType::kRegular,
+           rowType->childAt(1),
+           true)},
+      {"c2",
+       std::make_shared<connector::hive::HiveColumnHandle>(
+           "c2",
+           connector::hive::HiveColumnHandle::ColumnType::kRegular,
+           rowType->childAt(2),
+           true)}};
+
+  // Only the lengths of c1 and c2 are read. The elements, keys and values
+  // are nulls.
+  auto tableHandle = makeTableHandle(SubfieldFilters{});
+  auto op = PlanBuilder()
+                .tableScan(rowType, tableHandle, assignments)
+                .project({"c0", "cardinality(c1)", "cardinality(c2)"})
+                .planNode();
+  assertQuery(
+      op,
+      {filePath},
+      "SELECT c0, CASE WHEN c0 % 7 = 0 THEN NULL ELSE c0 % 5 END, "
+      "CASE WHEN c0 % 7 = 0 THEN NULL ELSE c0 % 3 END FROM tmp");
+
+  // Lengths only applies to arrays and maps.
+  assignments["c0"] = std::make_shared<connector::hive::HiveColumnHandle>(
+      "c0",
+      connector::hive::HiveColumnHandle::ColumnType::kRegular,
+      BIGINT(),
+      true);
+  op = PlanBuilder().tableScan(rowType, tableHandle, assignments).planNode();
+  EXPECT_THROW(assertQuery(op, {filePath}, "SELECT 1"), VeloxException);
+}
+
 VELOX_INSTANTIATE_TEST_SUITE_P(
     TableScanTests,
     TableScanTest,
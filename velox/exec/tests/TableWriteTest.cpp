@@ -16,6 +16,7 @@
 #include "velox/dwio/common/DataSink.h"
 #include "velox/exec/tests/utils/HiveConnectorTestBase.h"
 #include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/exec/tests/utils/TempDirectoryPath.h"
 
 #if __has_include("filesystem")
 #include <filesystem>
@@ -165,6 +166,41 @@ TEST_F(TableWriteTest, directReadWrite) {
       "SELECT * FROM tmp");
 }
 
+// Runs a pipeline with read + write that sorts the written file
+TEST_F(TableWriteTest, sortedWrite) {
+  auto filePaths = makeFilePaths(10);
+  auto vectors = makeVectors(rowType_, filePaths.size(), 1000);
+  for (int i = 0; i < filePaths.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableWriterTest, vectors[i]);
+  }
+
+  auto outputFile = TempFilePath::create();
+  createDuckDbTable(vectors);
+
+  auto plan =
+      PlanBuilder()
+          .tableScan(rowType_)
+          .sortedTableWrite(
+              rowType_->names(),
+              {0},
+              {core::SortOrder(true, false)},
+              std::make_shared<core::InsertTableHandle>(
+                  kHiveConnectorId,
+                  std::make_shared<HiveInsertTableHandle>(outputFile->path)),
+              "rows")
+          .project({"rows"})
+          .planNode();
+
+  assertQuery(plan, filePaths, "SELECT count(*) FROM tmp");
+
+  // The file is read back in the order it was written.
+  assertQueryOrdered(
+      PlanBuilder().tableScan(rowType_).planNode(),
+      makeHiveSplits({outputFile}),
+      "SELECT * FROM tmp ORDER BY c0 NULLS LAST",
+      {0});
+}
+
 // Tests writing constant vectors
 TEST_F(TableWriteTest, constantVectors) {
   vector_size_t size = 1'000;
@@ -211,6 +247,61 @@ TEST_F(TableWriteTest, constantVectors) {
       "SELECT * FROM tmp");
 }
 
+// Runs a pipeline with read + project + write that writes a file per
+// partition and bucket
+TEST_F(TableWriteTest, partitionedWrite) {
+  auto filePaths = makeFilePaths(10);
+  auto vectors = makeVectors(rowType_, filePaths.size(), 1000);
+  for (int i = 0; i < filePaths.size(); i++) {
+    writeToFile(filePaths[i]->path, kTableWriterTest, vectors[i]);
+  }
+
+  auto outputDirectory = TempDirectoryPath::create();
+  createDuckDbTable(vectors);
+
+  std::vector<std::string> columnNames = {
+      "c0", "c1", "c2", "c3", "c4", "c5", "p"};
+  auto plan = PlanBuilder()
+                  .tableScan(rowType_)
+                  .project({"c0", "c1", "c2", "c3", "c4", "c5", "c0 % 3"})
+                  .tableWrite(
+                      columnNames,
+                      std::make_shared<core::InsertTableHandle>(
+                          kHiveConnectorId,
+                          std::make_shared<HiveInsertTableHandle>(
+                              outputDirectory->path,
+                              std::vector<std::string>{"p"},
+                              HiveBucketProperty{4, {"c0"}})),
+                      "rows")
+                  .project({"rows"})
+                  .planNode();
+
+  assertQuery(plan, filePaths, "SELECT count(*) FROM tmp");
+
+  // Each partition directory holds at most one file per bucket and only the
+  // rows of its partition.
+  int32_t numPartitions = 0;
+  for (const auto& partition : fs::directory_iterator(outputDirectory->path)) {
+    auto name = partition.path().filename().string();
+    ASSERT_EQ(0, name.find("p="));
+    auto value = name.substr(2);
+    std::vector<exec::Split> splits;
+    for (const auto& file : fs::directory_iterator(partition.path())) {
+      splits.push_back(makeHiveSplit(file.path().string()));
+    }
+    ASSERT_LE(splits.size(), 4);
+    auto filter = value == HiveDataSink::kDefaultPartitionValue
+        ? std::string("c0 IS NULL")
+        : fmt::format("c0 % 3 = {}", value);
+    assertQuery(
+        PlanBuilder().tableScan(rowType_).planNode(),
+        std::move(splits),
+        "SELECT * FROM tmp WHERE " + filter);
+    ++numPartitions;
+  }
+  ASSERT_LE(numPartitions, 6);
+}
+
 // Test TableWriter create empty ORC or not based on the config
 TEST_F(TableWriteTest, writeEmptyFile) {
   std::string outputFile = "/tmp/velox-TableWriteTest-writeEmptyFile";
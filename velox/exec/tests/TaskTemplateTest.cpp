@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/TaskTemplate.h"
+#include <folly/executors/QueuedImmediateExecutor.h>
+#include "velox/exec/Task.h"
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/vector/DecodedVector.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+class TaskTemplateTest : public OperatorTestBase {
+ protected:
+  // Runs a Task of 'taskTemplate' to completion and returns the number of
+  // result rows and the sum of the first result column.
+  std::pair<int64_t, int64_t> runTask(
+      const std::shared_ptr<TaskTemplate>& taskTemplate,
+      const std::string& taskId) {
+    int64_t numRows = 0;
+    int64_t sum = 0;
+    auto task = taskTemplate->createTask(
+        taskId,
+        0,
+        core::QueryCtx::create(),
+        [&](RowVectorPtr vector, ContinueFuture* /*future*/) {
+          if (vector) {
+            SelectivityVector rows(vector->size());
+            DecodedVector decoded(*vector->childAt(0), rows);
+            for (auto i = 0; i < vector->size(); ++i) {
+              sum += decoded.valueAt<int64_t>(i);
+            }
+            numRows += vector->size();
+          }
+          return BlockingReason::kNotBlocked;
+        });
+    Task::start(task, 1);
+    auto& executor = folly::QueuedImmediateExecutor::instance();
+    task->stateChangeFuture(0).via(&executor).wait();
+    EXPECT_EQ(kFinished, task->state());
+    return {numRows, sum};
+  }
+};
+
+TEST_F(TaskTemplateTest, reuseExprSets) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 4; ++i) {
+    vectors.push_back(makeRowVector({makeFlatVector<int64_t>(
+        250, [i](auto row) { return i * 250 + row; })}));
+  }
+  auto plan = PlanBuilder()
+                  .values(vectors)
+                  .filter("c0 % 3 = 0")
+                  .project(std::vector<std::string>{"c0 * 2"})
+                  .planNode();
+
+  auto taskTemplate =
+      TaskTemplate::create(plan, core::QueryCtx::create(), true);
+  ASSERT_EQ(1, taskTemplate->driverFactories().size());
+
+  // 334 multiples of 3 in [0, 1000) with 2 * 3 * (0 + ... + 333) as the sum.
+  std::pair<int64_t, int64_t> expected{334, 333'666};
+  EXPECT_EQ(expected, runTask(taskTemplate, "0"));
+  EXPECT_EQ(1, taskTemplate->numCompiledExprSets());
+  EXPECT_EQ(0, taskTemplate->numReusedExprSets());
+
+  for (auto i = 1; i < 4; ++i) {
+    EXPECT_EQ(expected, runTask(taskTemplate, std::to_string(i)));
+  }
+  EXPECT_EQ(1, taskTemplate->numCompiledExprSets());
+  EXPECT_EQ(3, taskTemplate->numReusedExprSets());
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+class TopNRowNumberTest : public OperatorTestBase {
+ protected:
+  // c0 and c1 are partition keys. c2 is a unique sorting key. c3 has nulls.
+  std::vector<RowVectorPtr> makeVectors() {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < 5; ++i) {
+      auto base = i * 1000;
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int64_t>(
+              1000, [&](auto row) { return (base + row) % 17; }),
+          makeFlatVector<StringView>(
+              1000,
+              [&](auto row) {
+                return StringView(
+                    (base + row) % 3 == 0 ? "partition a" : "partition b");
+              }),
+          makeFlatVector<int64_t>(
+              1000, [&](auto row) { return (base + row) * 7919 % 5003; }),
+          makeFlatVector<int32_t>(
+              1000, [&](auto row) { return row; }, nullEvery(7)),
+      }));
+    }
+    return vectors;
+  }
+
+  static CursorParameters makeCursorParameters(
+      const std::shared_ptr<const core::PlanNode>& planNode,
+      uint32_t preferredOutputBatchSize) {
+    CursorParameters params;
+    params.planNode = planNode;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe(
+        {{core::QueryConfig::kPreferredOutputBatchSize,
+          std::to_string(preferredOutputBatchSize)}});
+    return params;
+  }
+
+  void testTopNRowNumber(
+      const std::vector<RowVectorPtr>& vectors,
+      const std::vector<ChannelIndex>& partitionKeys,
+      const std::string& partitionSql,
+      const core::SortOrder& sortOrder,
+      const std::string& sortSql,
+      int32_t limit) {
+    for (auto generateRowNumber : {true, false}) {
+      auto plan = PlanBuilder()
+                      .values(vectors)
+                      .topNRowNumber(
+                          partitionKeys,
+                          {2},
+                          {sortOrder},
+                          limit,
+                          generateRowNumber)
+                      .planNode();
+      auto sql = fmt::format(
+          "SELECT {} FROM (SELECT *, row_number() OVER "
+          "(PARTITION BY {} ORDER BY c2 {}) AS rn FROM tmp) WHERE rn <= {}",
+          generateRowNumber ? "*" : "c0, c1, c2, c3",
+          partitionSql,
+          sortSql,
+          limit);
+      for (auto batchSize : {1, 7, 1024}) {
+        assertQuery(makeCursorParameters(plan, batchSize), sql);
+      }
+    }
+  }
+};
+
+TEST_F(TopNRowNumberTest, singleKey) {
+  auto vectors = makeVectors();
+  createDuckDbTable(vectors);
+
+  testTopNRowNumber(vectors, {0}, "c0", {true, false}, "", 1);
+  testTopNRowNumber(vectors, {0}, "c0", {true, false}, "", 10);
+  testTopNRowNumber(vectors, {0}, "c0", {false, false}, "DESC", 5);
+}
+
+TEST_F(TopNRowNumberTest, multipleKeys) {
+  auto vectors = makeVectors();
+  createDuckDbTable(vectors);
+
+  testTopNRowNumber(vectors, {0, 1}, "c0, c1", {true, false}, "", 3);
+  testTopNRowNumber(vectors, {1}, "c1", {false, false}, "DESC", 20);
+}
+
+TEST_F(TopNRowNumberTest, limitAbovePartitionSize) {
+  auto vectors = makeVectors();
+  createDuckDbTable(vectors);
+
+  // Each partition of c0 has fewer than 500 rows, so all rows are produced.
+  testTopNRowNumber(vectors, {0}, "c0", {true, false}, "", 500);
+}
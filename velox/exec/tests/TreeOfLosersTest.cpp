@@ -25,15 +25,6 @@
 
 using namespace facebook::velox;
 
-class TreeOfLosersTest : public testing::Test {
- protected:
-  void SetUp() override {
-    rng_.seed(1);
-  }
-
-  folly::Random::DefaultGenerator rng_;
-};
-
 struct Value {
   uint32_t value;
 
@@ -68,39 +59,81 @@ int compare(Value left, Value right) {
   return left < right ? -1 : left == right ? 0 : 1;
 }
 
-TEST_F(TreeOfLosersTest, merge) {
-  constexpr int32_t kNumValues = 1000000;
-  constexpr int32_t kNumRuns = 17;
-  std::vector<uint32_t> data;
-  for (auto i = 0; i < kNumValues; ++i) {
-    data.push_back(folly::Random::rand32(rng_));
+class TreeOfLosersTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    rng_.seed(1);
   }
-  std::vector<std::vector<uint32_t>> runs;
-  int32_t offset = 0;
-  for (auto i = 0; i < kNumRuns; ++i) {
-    int size =
-        i == kNumRuns - 1 ? data.size() - offset : data.size() / kNumRuns;
-    runs.emplace_back();
-    runs.back().insert(
-        runs.back().begin(),
-        data.begin() + offset,
-        data.begin() + offset + size);
-    std::sort(
-        runs.back().begin(),
-        runs.back().end(),
-        [](uint32_t left, uint32_t right) { return left > right; });
-    offset += size;
+
+  // Merges 'numValues' random values split into 'numRuns' sorted runs.
+  // Runs may be empty if there are more runs than values.
+  void testMerge(int32_t numValues, int32_t numRuns) {
+    std::vector<uint32_t> data;
+    for (auto i = 0; i < numValues; ++i) {
+      data.push_back(folly::Random::rand32(rng_));
+    }
+    std::vector<std::vector<uint32_t>> runs;
+    int32_t offset = 0;
+    for (auto i = 0; i < numRuns; ++i) {
+      int size =
+          i == numRuns - 1 ? data.size() - offset : data.size() / numRuns;
+      runs.emplace_back();
+      runs.back().insert(
+          runs.back().begin(),
+          data.begin() + offset,
+          data.begin() + offset + size);
+      std::sort(
+          runs.back().begin(),
+          runs.back().end(),
+          [](uint32_t left, uint32_t right) { return left > right; });
+      offset += size;
+    }
+    std::sort(data.begin(), data.end());
+
+    std::vector<std::unique_ptr<Source>> sources;
+    for (auto& run : runs) {
+      sources.push_back(std::make_unique<Source>(std::move(run)));
+    }
+    TreeOfLosers<Value, Source> tree(std::move(sources));
+    for (auto expected : data) {
+      auto result = tree.next(compare);
+      ASSERT_EQ(result.value().value, expected);
+    }
+    ASSERT_FALSE(tree.next(compare).has_value());
   }
-  std::sort(data.begin(), data.end());
 
-  std::vector<std::unique_ptr<Source>> sources;
-  for (auto& run : runs) {
-    sources.push_back(std::make_unique<Source>(std::move(run)));
+  folly::Random::DefaultGenerator rng_;
+};
+
+TEST_F(TreeOfLosersTest, merge) {
+  testMerge(1000000, 17);
+}
+
+TEST_F(TreeOfLosersTest, numSources) {
+  // Covers a single source, powers of two and unbalanced trees.
+  for (auto numRuns : {1, 2, 3, 8, 31, 300}) {
+    testMerge(10000, numRuns);
   }
-  TreeOfLosers<Value, Source> tree(std::move(sources));
-  for (auto expected : data) {
-    auto result = tree.next(compare);
-    ASSERT_EQ(result.value().value, expected);
+  testMerge(5, 20);
+}
+
+TEST_F(TreeOfLosersTest, loserTree) {
+  // The values of each source, consumed from the back.
+  std::vector<std::vector<int32_t>> values = {
+      {9, 5, 1}, {}, {8, 2}, {7, 6, 3}, {4}};
+  LoserTree tree(values.size());
+  auto less = [&](int32_t left, int32_t right) {
+    if (values[left].empty()) {
+      return false;
+    }
+    return values[right].empty() || values[left].back() < values[right].back();
+  };
+  tree.initialize(less);
+  std::vector<int32_t> result;
+  while (!values[tree.winner()].empty()) {
+    result.push_back(values[tree.winner()].back());
+    values[tree.winner()].pop_back();
+    tree.update(less);
   }
-  ASSERT_FALSE(tree.next(compare).has_value());
+  ASSERT_EQ(result, (std::vector<int32_t>{1, 2, 3, 4, 5, 6, 7, 8, 9}));
 }
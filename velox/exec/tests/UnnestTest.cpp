@@ -52,3 +52,52 @@ TEST_F(UnnestTest, allEmptyOrNullArrays) {
   auto op = PlanBuilder().values({vector}).unnest({"c0"}, {"c1"}).planNode();
   assertQueryReturnsEmptyResult(op);
 }
+
+TEST_F(UnnestTest, map) {
+  auto vector = makeRowVector({
+      makeFlatVector<int64_t>(100, [](auto row) { return row; }),
+      makeMapVector<int64_t, double>(
+          100,
+          [](auto /* row */) { return 2; },
+          [](auto index) { return index; },
+          [](auto index) { return index * 0.1; }),
+  });
+
+  auto op = PlanBuilder().values({vector}).unnest({"c0"}, {"c1"}).planNode();
+
+  auto expected = makeRowVector({
+      makeFlatVector<int64_t>(200, [](auto row) { return row / 2; }),
+      makeFlatVector<int64_t>(200, [](auto row) { return row; }),
+      makeFlatVector<double>(200, [](auto row) { return row * 0.1; }),
+  });
+  assertQuery(op, expected);
+}
+
+TEST_F(UnnestTest, batchSize) {
+  // Arrays of up to 25 elements, so that arrays span several batches and
+  // batches several arrays.
+  auto vector = makeRowVector({
+      makeFlatVector<int64_t>(100, [](auto row) { return row; }),
+      makeArrayVector<int32_t>(
+          100,
+          [](auto row) { return row % 26; },
+          [](auto row, auto index) { return row * 100 + index; },
+          nullEvery(11)),
+  });
+
+  createDuckDbTable({vector});
+
+  CursorParameters params;
+  params.planNode =
+      PlanBuilder().values({vector}).unnest({"c0"}, {"c1"}).planNode();
+  params.queryCtx = core::QueryCtx::create();
+  params.queryCtx->setConfigOverridesUnsafe(
+      {{core::QueryConfig::kPreferredOutputBatchSize, "10"}});
+
+  auto result = readCursor(params, [](auto /*task*/) {});
+  for (const auto& batch : result.second) {
+    ASSERT_LE(batch->size(), 10);
+  }
+
+  assertQuery(params, "SELECT c0, UNNEST(c1) FROM tmp WHERE c0 % 11 > 0");
+}
@@ -15,6 +15,7 @@
  */
 #include "velox/exec/VectorHasher.h"
 #include <gtest/gtest.h>
+#include <array>
 #include "velox/type/Type.h"
 #include "velox/vector/tests/VectorMaker.h"
 
@@ -270,6 +271,70 @@ TEST_F(VectorHasherTest, dictionary) {
   }
 }
 
+TEST_F(VectorHasherTest, complexTypes) {
+  auto nullEvery7 = test::VectorMaker::nullEvery(7);
+  auto array = vectorMaker_->arrayVector<int64_t>(
+      100,
+      [](vector_size_t row) { return row % 5; },
+      [](vector_size_t idx) { return idx % 11; },
+      nullEvery7);
+  auto map = vectorMaker_->mapVector<int32_t, double>(
+      100,
+      [](vector_size_t row) { return row % 3; },
+      [](vector_size_t idx) { return idx; },
+      [](vector_size_t idx) { return idx * 0.5; },
+      test::VectorMaker::nullEvery(5),
+      test::VectorMaker::nullEvery(4));
+  auto row = vectorMaker_->rowVector(
+      {array,
+       map,
+       vectorMaker_->flatVector<int64_t>(
+           100, [](vector_size_t row) { return row; }, nullEvery7)});
+  for (auto i = 0; i < 100; i += 9) {
+    row->setNull(i, true);
+  }
+  // Arrays of two rows each, with repeated rows.
+  auto nested = std::make_shared<ArrayVector>(
+      pool_.get(),
+      ARRAY(row->type()),
+      BufferPtr(nullptr),
+      100,
+      makeIndices(100, [](vector_size_t row) { return row % 50; }),
+      makeIndices(100, [](vector_size_t /*row*/) { return 2; }),
+      row);
+
+  // The bulk hashes must equal hashValueAt() so that they match the hashes
+  // of the same values in a RowContainer.
+  auto testHashes = [&](const VectorPtr& vector) {
+    auto hasher = exec::VectorHasher::create(vector->type(), 0);
+    for (const auto* rows : {&allRows_, &oddRows_}) {
+      raw_vector<uint64_t> hashes(100);
+      std::fill(hashes.begin(), hashes.end(), 0);
+      hasher->hash(*vector, *rows, false, hashes);
+      for (auto i = 0; i < 100; i++) {
+        auto expected = rows->isValid(i) ? vector->hashValueAt(i) : 0;
+        ASSERT_EQ(expected, hashes[i]) << vector->toString() << " at " << i;
+      }
+
+      std::fill(hashes.begin(), hashes.end(), 1);
+      hasher->hash(*vector, *rows, true, hashes);
+      for (auto i = 0; i < 100; i++) {
+        auto expected =
+            rows->isValid(i) ? bits::hashMix(1, vector->hashValueAt(i)) : 1;
+        ASSERT_EQ(expected, hashes[i]) << vector->toString() << " at " << i;
+      }
+    }
+  };
+
+  for (const VectorPtr& vector :
+       std::vector<VectorPtr>{array, map, row, nested}) {
+    testHashes(vector);
+    testHashes(makeDictionary(100, vector));
+    testHashes(BaseVector::wrapInConstant(100, 3, vector));
+    testHashes(BaseVector::wrapInConstant(100, 0, vector));
+  }
+}
+
 // Tests how strings are mapped to uint64_t (if they fit) and to
 // consecutive ids of distinct values for the general case.
 TEST_F(VectorHasherTest, stringIds) {
@@ -407,6 +472,74 @@ TEST_F(VectorHasherTest, integerIds) {
   EXPECT_EQ(numDistinct, VectorHasher::kRangeTooLarge);
 }
 
+TEST_F(VectorHasherTest, timestampIds) {
+  std::vector<std::optional<Timestamp>> timestamps = {
+      std::nullopt,
+      Timestamp(0, 0),
+      Timestamp(-1, 999'999'999),
+      Timestamp(1'600'000'000, 123'456'789),
+      Timestamp(0, 0),
+      Timestamp(1'600'000'000, 123'456'789)};
+  auto vector = vectorMaker_->flatVectorNullable<Timestamp>(timestamps);
+  auto size = vector->size();
+  SelectivityVector rows(size);
+  raw_vector<uint64_t> ids(size);
+  auto hasher = exec::VectorHasher::create(TIMESTAMP(), 0);
+  EXPECT_FALSE(hasher->computeValueIds(*vector, rows, ids));
+  uint64_t numRange;
+  uint64_t numDistinct;
+  hasher->cardinality(numRange, numDistinct);
+  // 3 values and null.
+  EXPECT_EQ(4, numDistinct);
+
+  hasher->enableValueIds(1, 0);
+  EXPECT_TRUE(hasher->computeValueIds(*vector, rows, ids));
+  EXPECT_EQ(0, ids[0]);
+  EXPECT_EQ(ids[1], ids[4]);
+  EXPECT_EQ(ids[3], ids[5]);
+  EXPECT_NE(ids[1], ids[2]);
+  EXPECT_NE(ids[1], ids[3]);
+  EXPECT_NE(ids[2], ids[3]);
+
+  // The same ids for rows that store the timestamps as nanoseconds, with a
+  // null flag after them.
+  std::vector<std::array<char, 9>> storage(size);
+  std::vector<char*> groups(size);
+  for (auto i = 0; i < size; ++i) {
+    auto nanos = timestamps[i].has_value() ? timestamps[i]->toNanos() : 0;
+    memcpy(storage[i].data(), &nanos, sizeof(nanos));
+    storage[i][8] = timestamps[i].has_value() ? 0 : 1;
+    groups[i] = storage[i].data();
+  }
+  raw_vector<uint64_t> rowIds(size);
+  EXPECT_TRUE(hasher->computeValueIdsForRows(
+      groups.data(), size, 0, 8, 1, rowIds, true));
+  for (auto i = 0; i < size; ++i) {
+    EXPECT_EQ(ids[i], rowIds[i]) << i;
+  }
+
+  // New and out of range timestamps have no id.
+  auto probe = vectorMaker_->flatVector<Timestamp>(
+      {Timestamp(-1, 999'999'999),
+       Timestamp(-1, 999'999'998),
+       Timestamp(Timestamp::kMaxNanosSeconds + 1, 0)});
+  SelectivityVector probeRows(probe->size());
+  VectorHasher::ScratchMemory scratchMemory;
+  raw_vector<uint64_t> probeIds(probe->size());
+  hasher->lookupValueIds(*probe, probeRows, scratchMemory, probeIds);
+  EXPECT_EQ(1, probeRows.countSelected());
+  EXPECT_TRUE(probeRows.isValid(0));
+  EXPECT_EQ(ids[2], probeIds[0]);
+
+  // A timestamp that does not fit in nanoseconds leaves only hashing.
+  hasher = exec::VectorHasher::create(TIMESTAMP(), 0);
+  probeRows.setAll();
+  EXPECT_FALSE(hasher->computeValueIds(*probe, probeRows, probeIds));
+  hasher->cardinality(numRange, numDistinct);
+  EXPECT_EQ(VectorHasher::kRangeTooLarge, numRange);
+  EXPECT_EQ(VectorHasher::kRangeTooLarge, numDistinct);
+}
+
 TEST_F(VectorHasherTest, boolNoNulls) {
   auto vector = BaseVector::create(BOOLEAN(), 100, pool_.get());
   auto bools = vector->as<FlatVector<bool>>();
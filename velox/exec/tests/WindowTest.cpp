@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+class WindowTest : public OperatorTestBase {
+ protected:
+  // c0 is the partition key. c1 is unique. c2 has ties within a partition.
+  // If 'sorted' is true, the rows are clustered on c0 and sorted on c1 and
+  // c2 within each partition, and partitions span several batches.
+  std::vector<RowVectorPtr> makeVectors(bool sorted) {
+    std::vector<RowVectorPtr> vectors;
+    for (auto i = 0; i < 4; ++i) {
+      auto base = i * 100;
+      vectors.push_back(makeRowVector({
+          makeFlatVector<int64_t>(
+              100,
+              [&](auto row) {
+                return sorted ? (base + row) / 37 : (base + row) % 7;
+              }),
+          makeFlatVector<int64_t>(100, [&](auto row) { return base + row; }),
+          makeFlatVector<int64_t>(
+              100, [&](auto row) { return (base + row) / 3; }),
+          makeFlatVector<int64_t>(
+              100, [&](auto row) { return (base + row) * 7 % 101; }),
+      }));
+    }
+    return vectors;
+  }
+
+  static CursorParameters makeCursorParameters(
+      const std::shared_ptr<const core::PlanNode>& planNode,
+      uint32_t preferredOutputBatchSize) {
+    CursorParameters params;
+    params.planNode = planNode;
+    params.queryCtx = core::QueryCtx::create();
+    params.queryCtx->setConfigOverridesUnsafe(
+        {{core::QueryConfig::kPreferredOutputBatchSize,
+          std::to_string(preferredOutputBatchSize)}});
+    return params;
+  }
+
+  void testWindow(
+      const std::vector<RowVectorPtr>& vectors,
+      ChannelIndex sortingKey,
+      const std::vector<std::string>& functions,
+      const core::WindowNode::Frame& frame,
+      bool inputsSorted,
+      const std::string& duckDbSql) {
+    auto plan = PlanBuilder()
+                    .values(vectors)
+                    .window(
+                        {0},
+                        {sortingKey},
+                        {core::SortOrder(true, false)},
+                        functions,
+                        frame,
+                        inputsSorted)
+                    .planNode();
+    // Small batches split partitions. Large batches have several
+    // partitions.
+    for (auto batchSize : {1, 13, 1024}) {
+      assertQuery(makeCursorParameters(plan, batchSize), duckDbSql);
+    }
+  }
+};
+
+TEST_F(WindowTest, ranking) {
+  auto vectors = makeVectors(false);
+  createDuckDbTable(vectors);
+
+  testWindow(
+      vectors,
+      1,
+      {"row_number()"},
+      {},
+      false,
+      "SELECT *, row_number() OVER (PARTITION BY c0 ORDER BY c1) FROM tmp");
+  testWindow(
+      vectors,
+      2,
+      {"rank()", "dense_rank()"},
+      {},
+      false,
+      "SELECT *, rank() OVER (PARTITION BY c0 ORDER BY c2), "
+      "dense_rank() OVER (PARTITION BY c0 ORDER BY c2) FROM tmp");
+}
+
+TEST_F(WindowTest, lagLead) {
+  auto vectors = makeVectors(false);
+  createDuckDbTable(vectors);
+
+  testWindow(
+      vectors,
+      1,
+      {"lag(c3)", "lead(c3, 2)"},
+      {},
+      false,
+      "SELECT *, lag(c3) OVER (PARTITION BY c0 ORDER BY c1), "
+      "lead(c3, 2) OVER (PARTITION BY c0 ORDER BY c1) FROM tmp");
+}
+
+TEST_F(WindowTest, aggregates) {
+  auto vectors = makeVectors(false);
+  createDuckDbTable(vectors);
+
+  // Peers share the running aggregate in RANGE mode.
+  testWindow(
+      vectors,
+      2,
+      {"sum(c3)", "count(c3)", "max(c3)"},
+      {},
+      false,
+      "SELECT *, sum(c3) OVER w, count(c3) OVER w, max(c3) OVER w FROM tmp "
+      "WINDOW w AS (PARTITION BY c0 ORDER BY c2)");
+
+  core::WindowNode::Frame rows;
+  rows.type = core::WindowNode::WindowType::kRows;
+  testWindow(
+      vectors,
+      1,
+      {"sum(c3)", "min(c3)"},
+      rows,
+      false,
+      "SELECT *, sum(c3) OVER w, min(c3) OVER w FROM tmp "
+      "WINDOW w AS (PARTITION BY c0 ORDER BY c1 "
+      "ROWS BETWEEN UNBOUNDED PRECEDING AND CURRENT ROW)");
+
+  core::WindowNode::Frame partition;
+  partition.endType = core::WindowNode::BoundType::kUnboundedFollowing;
+  testWindow(
+      vectors,
+      2,
+      {"sum(c3)", "count(c3)"},
+      partition,
+      false,
+      "SELECT *, sum(c3) OVER w, count(c3) OVER w FROM tmp "
+      "WINDOW w AS (PARTITION BY c0 ORDER BY c2 "
+      "RANGE BETWEEN UNBOUNDED PRECEDING AND UNBOUNDED FOLLOWING)");
+}
+
+TEST_F(WindowTest, sortedInput) {
+  auto vectors = makeVectors(true);
+  createDuckDbTable(vectors);
+
+  testWindow(
+      vectors,
+      1,
+      {"row_number()", "lag(c3)", "sum(c3)"},
+      {},
+      true,
+      "SELECT *, row_number() OVER w, lag(c3) OVER w, sum(c3) OVER w "
+      "FROM tmp WINDOW w AS (PARTITION BY c0 ORDER BY c1)");
+  testWindow(
+      vectors,
+      2,
+      {"rank()", "sum(c3)"},
+      {},
+      true,
+      "SELECT *, rank() OVER w, sum(c3) OVER w "
+      "FROM tmp WINDOW w AS (PARTITION BY c0 ORDER BY c2)");
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/WorkStealingExecutor.h"
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+class WorkStealingExecutorTest : public OperatorTestBase {};
+
+TEST_F(WorkStealingExecutorTest, addFromOutside) {
+  std::atomic<int32_t> counter{0};
+  {
+    WorkStealingExecutor executor(4);
+    for (auto i = 0; i < 10'000; ++i) {
+      executor.add([&]() { ++counter; });
+    }
+  }
+  // The destructor runs the queued work.
+  EXPECT_EQ(10'000, counter);
+}
+
+TEST_F(WorkStealingExecutorTest, steal) {
+  std::atomic<int32_t> counter{0};
+  WorkStealingExecutor executor(4);
+  // Work added on a thread of the executor goes to the queue of that
+  // thread. The idle threads take it from there.
+  executor.add([&]() {
+    for (auto i = 0; i < 100; ++i) {
+      executor.add([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++counter;
+      });
+    }
+  });
+  while (counter < 100) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_GT(executor.numStolen(), 0);
+}
+
+TEST_F(WorkStealingExecutorTest, query) {
+  std::vector<RowVectorPtr> vectors;
+  for (auto i = 0; i < 10; ++i) {
+    vectors.push_back(makeRowVector({
+        makeFlatVector<int64_t>(1'000, [&](auto row) { return row % 17; }),
+        makeFlatVector<int64_t>(1'000, [&](auto row) { return row + i; }),
+    }));
+  }
+  createDuckDbTable(vectors);
+
+  // Holds a reference so that the executor is not destroyed on one of its
+  // own threads when the QueryCtx goes away.
+  auto executor = std::make_shared<WorkStealingExecutor>(4);
+  CursorParameters params;
+  params.queryCtx = core::QueryCtx::create(
+      std::make_shared<core::MemConfig>(),
+      {},
+      memory::MappedMemory::getInstance(),
+      memory::getProcessDefaultMemoryManager().getRoot().addScopedChild(
+          "query_root"),
+      executor);
+  params.maxDrivers = 4;
+  // Each of the 4 Drivers of the source pipeline reads all of 'vectors'.
+  auto partialAgg = PlanBuilder()
+                        .values(vectors, true)
+                        .filter("c1 % 3 = 0")
+                        .partialAggregation({0}, {"sum(c1)"})
+                        .planNode();
+  params.planNode = PlanBuilder(10)
+                        .localPartition({0}, {partialAgg})
+                        .finalAggregation({0}, {"sum(a0)"})
+                        .planNode();
+  assertQuery(
+      params, "SELECT c0, sum(c1) * 4 FROM tmp WHERE c1 % 3 = 0 GROUP BY 1");
+}
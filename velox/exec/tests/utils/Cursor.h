@@ -29,6 +29,11 @@ struct CursorParameters {
   // Number of drivers for the pipeline that produces task results. Cannot
   // exceed numThreads, but can be less.
   std::optional<int32_t> numResultDrivers;
+  // If non-zero, the Task runs its pipelines once per split group. Splits
+  // must then carry a group id in [0, numSplitGroups).
+  int32_t numSplitGroups = 0;
+  // Number of split groups that run at the same time.
+  int32_t concurrentSplitGroups = 1;
   // Optional, created if not present.
   std::shared_ptr<core::QueryCtx> queryCtx;
   uint64_t bufferedBytes = 512 * 1024;
@@ -109,6 +114,8 @@ class TaskCursor {
 
  private:
   const int32_t maxDrivers_;
+  const int32_t numSplitGroups_;
+  const int32_t concurrentSplitGroups_;
   bool started_ = false;
   std::shared_ptr<TaskQueue> queue_;
   std::shared_ptr<exec::Task> task_;
@@ -17,6 +17,7 @@
 #include "velox/exec/tests/utils/PlanBuilder.h"
 #include <velox/exec/Aggregate.h>
 #include <velox/exec/HashPartitionFunction.h>
+#include <velox/exec/RangePartitionFunction.h>
 #include "velox/connectors/hive/HiveConnector.h"
 #include "velox/parse/Expressions.h"
 #include "velox/parse/ExpressionsParser.h"
@@ -163,6 +164,31 @@ PlanBuilder& PlanBuilder::tableWrite(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::sortedTableWrite(
+    const std::vector<std::string>& columnNames,
+    const std::vector<ChannelIndex>& keyIndices,
+    const std::vector<core::SortOrder>& sortOrder,
+    const std::shared_ptr<core::InsertTableHandle>& insertHandle,
+    const std::string& rowCountColumnName) {
+  std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> sortingKeys;
+  for (auto index : keyIndices) {
+    sortingKeys.emplace_back(field(index));
+  }
+  auto outputType =
+      ROW({rowCountColumnName, "fragments", "commitcontext"},
+          {BIGINT(), VARBINARY(), VARBINARY()});
+  planNode_ = std::make_shared<core::TableWriteNode>(
+      nextPlanNodeId(),
+      planNode_->outputType(),
+      columnNames,
+      insertHandle,
+      outputType,
+      planNode_,
+      sortingKeys,
+      sortOrder);
+  return *this;
+}
+
 namespace {
 
 template <TypeKind Kind>
@@ -219,12 +245,55 @@ class AggregateTypeResolver {
 } // namespace
 
 PlanBuilder& PlanBuilder::aggregation(
+    const std::vector<ChannelIndex>& groupingKeys,
+    const std::vector<std::string>& aggregates,
+    const std::vector<std::string>& masks,
+    core::AggregationNode::Step step,
+    bool ignoreNullKeys,
+    const std::vector<TypePtr>& resultTypes,
+    const std::vector<bool>& distinctAggregates,
+    const std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>&
+        aggregateOrderings) {
+  return addAggregation(
+      groupingKeys,
+      {},
+      aggregates,
+      masks,
+      step,
+      ignoreNullKeys,
+      resultTypes,
+      distinctAggregates,
+      aggregateOrderings);
+}
+
+PlanBuilder& PlanBuilder::streamingAggregation(
     const std::vector<ChannelIndex>& groupingKeys,
     const std::vector<std::string>& aggregates,
     const std::vector<std::string>& masks,
     core::AggregationNode::Step step,
     bool ignoreNullKeys,
     const std::vector<TypePtr>& resultTypes) {
+  return addAggregation(
+      groupingKeys,
+      groupingKeys,
+      aggregates,
+      masks,
+      step,
+      ignoreNullKeys,
+      resultTypes);
+}
+
+PlanBuilder& PlanBuilder::addAggregation(
+    const std::vector<ChannelIndex>& groupingKeys,
+    const std::vector<ChannelIndex>& preGroupedKeys,
+    const std::vector<std::string>& aggregates,
+    const std::vector<std::string>& masks,
+    core::AggregationNode::Step step,
+    bool ignoreNullKeys,
+    const std::vector<TypePtr>& resultTypes,
+    const std::vector<bool>& distinctAggregates,
+    const std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>&
+        aggregateOrderings) {
   AggregateTypeResolver resolver(step);
   std::vector<std::shared_ptr<const core::CallTypedExpr>> aggregateExprs;
   aggregateExprs.reserve(aggregates.size());
@@ -252,14 +321,103 @@ PlanBuilder& PlanBuilder::aggregation(
     }
   }
 
+  std::vector<core::AggregationNode::AggregateOrdering> orderings;
+  for (const auto& keys : aggregateOrderings) {
+    core::AggregationNode::AggregateOrdering ordering;
+    for (const auto& key : keys) {
+      ordering.sortingKeys.push_back(field(key.first));
+      ordering.sortingOrders.push_back(key.second);
+    }
+    orderings.push_back(std::move(ordering));
+  }
+
   planNode_ = std::make_shared<core::AggregationNode>(
       nextPlanNodeId(),
       step,
       groupingExpr,
+      fields(preGroupedKeys),
       names,
       aggregateExprs,
       aggregateMasks,
       ignoreNullKeys,
+      planNode_,
+      /*numGroupsHint=*/0,
+      distinctAggregates,
+      orderings);
+  return *this;
+}
+
+namespace {
+
+// Resolves the result types of window functions. The aggregate functions
+// produce the result of a single aggregation.
+class WindowTypeResolver {
+ public:
+  WindowTypeResolver() : previousHook_(core::Expressions::getResolverHook()) {
+    core::Expressions::setTypeResolverHook(
+        [&](const auto& inputs, const auto& expr) {
+          return resolveType(inputs, expr);
+        });
+  }
+
+  ~WindowTypeResolver() {
+    core::Expressions::setTypeResolverHook(previousHook_);
+  }
+
+ private:
+  std::shared_ptr<const Type> resolveType(
+      const std::vector<std::shared_ptr<const core::ITypedExpr>>& inputs,
+      const std::shared_ptr<const core::CallExpr>& expr) const {
+    auto functionName = expr->getFunctionName();
+    if (functionName == "row_number" || functionName == "rank" ||
+        functionName == "dense_rank") {
+      return BIGINT();
+    }
+    if ((functionName == "lag" || functionName == "lead") && !inputs.empty()) {
+      return inputs[0]->type();
+    }
+
+    std::vector<TypePtr> types;
+    for (auto& input : inputs) {
+      types.push_back(input->type());
+    }
+    auto aggregate = exec::Aggregate::create(
+        functionName, core::AggregationNode::Step::kSingle, types, UNKNOWN());
+    if (aggregate) {
+      return aggregate->resultType();
+    }
+    return nullptr;
+  }
+
+  const core::Expressions::TypeResolverHook previousHook_;
+};
+
+} // namespace
+
+PlanBuilder& PlanBuilder::window(
+    const std::vector<ChannelIndex>& partitionKeys,
+    const std::vector<ChannelIndex>& sortingKeys,
+    const std::vector<core::SortOrder>& sortingOrders,
+    const std::vector<std::string>& functions,
+    const core::WindowNode::Frame& frame,
+    bool inputsSorted) {
+  WindowTypeResolver resolver;
+  std::vector<core::WindowNode::Function> windowFunctions;
+  windowFunctions.reserve(functions.size());
+  for (auto& function : functions) {
+    auto expr = std::dynamic_pointer_cast<const core::CallTypedExpr>(
+        parseExpr(function, planNode_->outputType(), pool_));
+    windowFunctions.push_back({expr, frame});
+  }
+
+  planNode_ = std::make_shared<core::WindowNode>(
+      nextPlanNodeId(),
+      fields(partitionKeys),
+      fields(sortingKeys),
+      sortingOrders,
+      makeNames("w", functions.size()),
+      windowFunctions,
+      inputsSorted,
       planNode_);
   return *this;
 }
@@ -316,6 +474,24 @@ PlanBuilder& PlanBuilder::topN(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::topNRowNumber(
+    const std::vector<ChannelIndex>& partitionKeys,
+    const std::vector<ChannelIndex>& sortingKeys,
+    const std::vector<core::SortOrder>& sortingOrders,
+    int32_t limit,
+    bool generateRowNumber) {
+  planNode_ = std::make_shared<core::TopNRowNumberNode>(
+      nextPlanNodeId(),
+      fields(partitionKeys),
+      fields(sortingKeys),
+      sortingOrders,
+      generateRowNumber ? std::make_optional<std::string>("row_number")
+                        : std::nullopt,
+      limit,
+      planNode_);
+  return *this;
+}
+
 PlanBuilder& PlanBuilder::limit(int32_t offset, int32_t count, bool isPartial) {
   planNode_ = std::make_shared<core::LimitNode>(
       nextPlanNodeId(), offset, count, isPartial, planNode_);
@@ -403,6 +579,44 @@ PlanBuilder& PlanBuilder::partitionedOutput(
   return *this;
 }
 
+namespace {
+core::PartitionFunctionFactory createSkewedPartitionFunctionFactory(
+    const RowTypePtr& inputType,
+    const std::vector<ChannelIndex>& keyIndices,
+    std::shared_ptr<const HotKeyHashes> hotKeys,
+    bool replicateHotKeys) {
+  VELOX_CHECK(!keyIndices.empty());
+  return [inputType, keyIndices, hotKeys, replicateHotKeys](
+             auto numPartitions) -> std::unique_ptr<core::PartitionFunction> {
+    return std::make_unique<exec::SkewedHashPartitionFunction>(
+        numPartitions, inputType, keyIndices, hotKeys, replicateHotKeys);
+  };
+}
+} // namespace
+
+PlanBuilder& PlanBuilder::partitionedOutputSkewed(
+    const std::vector<ChannelIndex>& keyIndices,
+    int numPartitions,
+    std::shared_ptr<const HotKeyHashes> hotKeys,
+    bool replicateHotKeys,
+    const std::vector<ChannelIndex>& outputLayout) {
+  auto outputType = toRowType(planNode_->outputType(), outputLayout);
+  planNode_ = std::make_shared<core::PartitionedOutputNode>(
+      nextPlanNodeId(),
+      fields(keyIndices),
+      numPartitions,
+      false,
+      false,
+      createSkewedPartitionFunctionFactory(
+          planNode_->outputType(),
+          keyIndices,
+          std::move(hotKeys),
+          replicateHotKeys),
+      outputType,
+      planNode_);
+  return *this;
+}
+
 PlanBuilder& PlanBuilder::partitionedOutputBroadcast(
     const std::vector<ChannelIndex>& outputLayout) {
   auto outputType = toRowType(planNode_->outputType(), outputLayout);
@@ -411,6 +625,29 @@ PlanBuilder& PlanBuilder::partitionedOutputBroadcast(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::partitionedOutputRange(
+    const std::vector<ChannelIndex>& keyIndices,
+    const std::vector<core::SortOrder>& sortOrder,
+    const RowVectorPtr& splitPoints,
+    const std::vector<ChannelIndex>& outputLayout) {
+  auto outputType = toRowType(planNode_->outputType(), outputLayout);
+  auto numPartitions = splitPoints->size() + 1;
+  planNode_ = std::make_shared<core::PartitionedOutputNode>(
+      nextPlanNodeId(),
+      fields(keyIndices),
+      numPartitions,
+      false,
+      false,
+      [keyIndices, sortOrder, splitPoints](
+          auto numPartitions) -> std::unique_ptr<core::PartitionFunction> {
+        return std::make_unique<exec::RangePartitionFunction>(
+            numPartitions, keyIndices, sortOrder, splitPoints);
+      },
+      outputType,
+      planNode_);
+  return *this;
+}
+
 PlanBuilder& PlanBuilder::localPartition(
     const std::vector<ChannelIndex>& keyIndices,
     const std::vector<std::shared_ptr<const core::PlanNode>>& sources,
@@ -425,6 +662,32 @@ PlanBuilder& PlanBuilder::localPartition(
   return *this;
 }
 
+PlanBuilder& PlanBuilder::localPartitionSkewed(
+    const std::vector<ChannelIndex>& keyIndices,
+    std::shared_ptr<const HotKeyHashes> hotKeys,
+    bool replicateHotKeys,
+    const std::vector<std::shared_ptr<const core::PlanNode>>& sources,
+    const std::vector<ChannelIndex>& outputLayout) {
+  auto inputType = sources[0]->outputType();
+  auto outputType = toRowType(inputType, outputLayout);
+  planNode_ = std::make_shared<core::LocalPartitionNode>(
+      nextPlanNodeId(),
+      createSkewedPartitionFunctionFactory(
+          inputType, keyIndices, std::move(hotKeys), replicateHotKeys),
+      outputType,
+      sources);
+  return *this;
+}
+
+PlanBuilder& PlanBuilder::localPartitionScaleWriters(
+    const std::vector<std::shared_ptr<const core::PlanNode>>& sources,
+    const std::vector<ChannelIndex>& outputLayout) {
+  auto outputType = toRowType(sources[0]->outputType(), outputLayout);
+  planNode_ = core::LocalPartitionNode::scaleWriters(
+      nextPlanNodeId(), outputType, sources);
+  return *this;
+}
+
 namespace {
 RowTypePtr concat(const RowTypePtr& a, const RowTypePtr& b) {
   std::vector<std::string> names = a->names();
@@ -455,7 +718,8 @@ PlanBuilder& PlanBuilder::hashJoin(
     const std::shared_ptr<facebook::velox::core::PlanNode>& build,
     const std::string& filterText,
     const std::vector<ChannelIndex>& output,
-    core::JoinType joinType) {
+    core::JoinType joinType,
+    bool isBroadcast) {
   VELOX_CHECK_EQ(leftKeys.size(), rightKeys.size());
 
   auto leftType = planNode_->outputType();
@@ -477,7 +741,8 @@ PlanBuilder& PlanBuilder::hashJoin(
       std::move(filterExpr),
       std::move(planNode_),
       build,
-      outputType);
+      outputType,
+      isBroadcast);
   return *this;
 }
 
@@ -515,12 +780,21 @@ PlanBuilder& PlanBuilder::mergeJoin(
 
 PlanBuilder& PlanBuilder::crossJoin(
     const std::shared_ptr<core::PlanNode>& build,
-    const std::vector<ChannelIndex>& output) {
+    const std::vector<ChannelIndex>& output,
+    const std::string& filterText) {
   auto resultType = concat(planNode_->outputType(), build->outputType());
+  std::shared_ptr<const core::ITypedExpr> filterExpr;
+  if (!filterText.empty()) {
+    filterExpr = parseExpr(filterText, resultType, pool_);
+  }
   auto outputType = extract(resultType, output);
 
   planNode_ = std::make_shared<core::CrossJoinNode>(
-      nextPlanNodeId(), std::move(planNode_), build, outputType);
+      nextPlanNodeId(),
+      std::move(planNode_),
+      build,
+      outputType,
+      std::move(filterExpr));
   return *this;
 }
 
@@ -18,6 +18,7 @@
 #include <velox/core/ITypedExpr.h>
 #include <velox/core/PlanNode.h>
 #include "velox/common/memory/Memory.h"
+#include "velox/exec/SkewedHashPartitionFunction.h"
 
 namespace facebook::velox::exec::test {
 
@@ -66,6 +67,15 @@ class PlanBuilder {
       const std::shared_ptr<core::InsertTableHandle>& insertHandle,
       const std::string& rowCountColumnName = "rowCount");
 
+  // Writes the rows of each file sorted on the columns at 'keyIndices' of the
+  // input.
+  PlanBuilder& sortedTableWrite(
+      const std::vector<std::string>& columnNames,
+      const std::vector<ChannelIndex>& keyIndices,
+      const std::vector<core::SortOrder>& sortOrder,
+      const std::shared_ptr<core::InsertTableHandle>& insertHandle,
+      const std::string& rowCountColumnName = "rowCount");
+
   PlanBuilder& partialAggregation(
       const std::vector<ChannelIndex>& groupingKeys,
       const std::vector<std::string>& aggregates,
@@ -122,7 +132,26 @@ class PlanBuilder {
         resultTypes);
   }
 
+  // @param distinctAggregates Empty or one flag per aggregate. A flagged
+  // aggregate sees only the distinct values of its arguments in each group,
+  // e.g. count(DISTINCT c1). Requires the single step.
+  // @param aggregateOrderings Empty or the input channels and orders of the
+  // sorting keys of each aggregate, e.g. array_agg(c1 ORDER BY c2). Requires
+  // the single step.
   PlanBuilder& aggregation(
+      const std::vector<ChannelIndex>& groupingKeys,
+      const std::vector<std::string>& aggregates,
+      const std::vector<std::string>& masks,
+      core::AggregationNode::Step step,
+      bool ignoreNullKeys,
+      const std::vector<TypePtr>& resultTypes = {},
+      const std::vector<bool>& distinctAggregates = {},
+      const std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>&
+          aggregateOrderings = {});
+
+  // Adds an aggregation over input that is clustered on all 'groupingKeys'.
+  // Runs as a StreamingAggregation.
+  PlanBuilder& streamingAggregation(
       const std::vector<ChannelIndex>& groupingKeys,
       const std::vector<std::string>& aggregates,
       const std::vector<std::string>& masks,
@@ -130,6 +159,16 @@ class PlanBuilder {
       bool ignoreNullKeys,
       const std::vector<TypePtr>& resultTypes = {});
 
+  // Adds a Window over 'functions', e.g. "row_number()" or "sum(c1)". All
+  // functions use 'frame'. The window columns are named w0, w1, etc.
+  PlanBuilder& window(
+      const std::vector<ChannelIndex>& partitionKeys,
+      const std::vector<ChannelIndex>& sortingKeys,
+      const std::vector<core::SortOrder>& sortingOrders,
+      const std::vector<std::string>& functions,
+      const core::WindowNode::Frame& frame = {},
+      bool inputsSorted = false);
+
   PlanBuilder& localMerge(
       const std::vector<ChannelIndex>& keyIndices,
       const std::vector<core::SortOrder>& sortOrder);
@@ -145,6 +184,15 @@ class PlanBuilder {
       int32_t count,
       bool isPartial);
 
+  // Keeps the first 'limit' rows of each partition in the order of
+  // 'sortingKeys'. Adds a "row_number" column if 'generateRowNumber' is true.
+  PlanBuilder& topNRowNumber(
+      const std::vector<ChannelIndex>& partitionKeys,
+      const std::vector<ChannelIndex>& sortingKeys,
+      const std::vector<core::SortOrder>& sortingOrders,
+      int32_t limit,
+      bool generateRowNumber);
+
   PlanBuilder& limit(int32_t offset, int32_t count, bool isPartial);
 
   PlanBuilder& enforceSingleRow();
@@ -166,17 +214,50 @@ class PlanBuilder {
   PlanBuilder& partitionedOutputBroadcast(
       const std::vector<ChannelIndex>& outputLayout = {});
 
+  // Partitions the rows by ranges of the keys at 'keyIndices', sorted in
+  // 'sortOrder'. 'splitPoints' bounds the ranges, see RangePartitionFunction.
+  // The number of partitions is the number of split points plus one.
+  PlanBuilder& partitionedOutputRange(
+      const std::vector<ChannelIndex>& keyIndices,
+      const std::vector<core::SortOrder>& sortOrder,
+      const RowVectorPtr& splitPoints,
+      const std::vector<ChannelIndex>& outputLayout = {});
+
   PlanBuilder& partitionedOutput(
       const std::vector<ChannelIndex>& keyIndices,
       int numPartitions,
       bool replicateNullsAndAny,
       const std::vector<ChannelIndex>& outputLayout = {});
 
+  // Partitions the rows by hash of the keys at 'keyIndices' except for the
+  // rows of 'hotKeys', which go to all partitions if 'replicateHotKeys' and
+  // round-robin otherwise, see SkewedHashPartitionFunction.
+  PlanBuilder& partitionedOutputSkewed(
+      const std::vector<ChannelIndex>& keyIndices,
+      int numPartitions,
+      std::shared_ptr<const HotKeyHashes> hotKeys,
+      bool replicateHotKeys,
+      const std::vector<ChannelIndex>& outputLayout = {});
+
   PlanBuilder& localPartition(
       const std::vector<ChannelIndex>& keyIndices,
       const std::vector<std::shared_ptr<const core::PlanNode>>& sources,
       const std::vector<ChannelIndex>& outputLayout = {});
 
+  // Like partitionedOutputSkewed() for a LocalPartitionNode.
+  PlanBuilder& localPartitionSkewed(
+      const std::vector<ChannelIndex>& keyIndices,
+      std::shared_ptr<const HotKeyHashes> hotKeys,
+      bool replicateHotKeys,
+      const std::vector<std::shared_ptr<const core::PlanNode>>& sources,
+      const std::vector<ChannelIndex>& outputLayout = {});
+
+  // Adds a LocalPartitionNode in scale writers mode, which sends the input
+  // to a growing number of consumer Drivers.
+  PlanBuilder& localPartitionScaleWriters(
+      const std::vector<std::shared_ptr<const core::PlanNode>>& sources,
+      const std::vector<ChannelIndex>& outputLayout = {});
+
   // 'leftKeys' and 'rightKeys' are indices into the output type of the
   // previous PlanNode and 'build', respectively.  'output' is indices
   // into the concatenation of the previous node's output and the
@@ -189,7 +270,8 @@ class PlanBuilder {
       const std::shared_ptr<core::PlanNode>& build,
       const std::string& filterText,
       const std::vector<ChannelIndex>& output,
-      core::JoinType joinType = core::JoinType::kInner);
+      core::JoinType joinType = core::JoinType::kInner,
+      bool isBroadcast = false);
 
   PlanBuilder& mergeJoin(
       const std::vector<ChannelIndex>& leftKeys,
@@ -201,7 +283,8 @@ class PlanBuilder {
 
   PlanBuilder& crossJoin(
       const std::shared_ptr<core::PlanNode>& build,
-      const std::vector<ChannelIndex>& output);
+      const std::vector<ChannelIndex>& output,
+      const std::string& filterText = "");
 
   PlanBuilder& unnest(
       const std::vector<std::string>& replicateColumns,
@@ -224,6 +307,18 @@ class PlanBuilder {
  private:
   std::string nextPlanNodeId();
 
+  PlanBuilder& addAggregation(
+      const std::vector<ChannelIndex>& groupingKeys,
+      const std::vector<ChannelIndex>& preGroupedKeys,
+      const std::vector<std::string>& aggregates,
+      const std::vector<std::string>& masks,
+      core::AggregationNode::Step step,
+      bool ignoreNullKeys,
+      const std::vector<TypePtr>& resultTypes,
+      const std::vector<bool>& distinctAggregates = {},
+      const std::vector<std::vector<std::pair<ChannelIndex, core::SortOrder>>>&
+          aggregateOrderings = {});
+
   std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> fields(
       const std::vector<ChannelIndex>& indices);
   std::vector<std::shared_ptr<const core::FieldAccessTypedExpr>> fields(
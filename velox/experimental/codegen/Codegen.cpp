@@ -15,8 +15,11 @@
  */
 
 #include "velox/experimental/codegen/Codegen.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include <glog/logging.h>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "velox/core/PlanNode.h"
 #include "velox/experimental/codegen/CodegenCompiledExpressionTransform.h"
 #include "velox/experimental/codegen/CodegenExceptions.h"
@@ -30,11 +33,43 @@ namespace facebook {
 namespace velox {
 namespace codegen {
 
+namespace {
+// The state of an asynchronous compilation of a plan. 'planNode' is the
+// compiled plan, or nullptr if the compilation failed.
+struct AsyncCompilation {
+  bool done{false};
+  std::shared_ptr<const core::PlanNode> planNode;
+};
+
+// Guards 'asyncCompilations()'.
+std::mutex& asyncCompilationsMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Maps the options and the description of a plan to its compilation. The
+// entries live for the process, like the loaded libraries they refer to.
+std::unordered_map<std::string, std::shared_ptr<AsyncCompilation>>&
+asyncCompilations() {
+  static std::unordered_map<std::string, std::shared_ptr<AsyncCompilation>>
+      compilations;
+  return compilations;
+}
+
+// Runs the asynchronous compilations. A single thread keeps the external
+// compiler processes from competing with the queries for all cores.
+folly::Executor& compilationExecutor() {
+  static folly::CPUThreadPoolExecutor executor(1);
+  return executor;
+}
+} // namespace
+
 bool Codegen::initialize(
     const std::string_view& codegenOptionsJson,
     bool lazyLoading) {
   try {
     codegenLogger_->onInitialize(lazyLoading);
+    codegenOptionsJson_ = codegenOptionsJson;
     auto codegenOptionsProto = proto::proto_utils::ProtoUtils<
         proto::CodegenOptionsProto>::loadProtoFromJson(codegenOptionsJson);
 
@@ -73,6 +108,35 @@ std::shared_ptr<const core::PlanNode> Codegen::compile(
   return transformedPlanNode;
 }
 
+std::shared_ptr<const core::PlanNode> Codegen::compileAsync(
+    const std::shared_ptr<const core::PlanNode>& planNode) {
+  auto key = codegenOptionsJson_ + planNode->toString(true, true);
+  std::shared_ptr<AsyncCompilation> compilation;
+  {
+    std::lock_guard<std::mutex> l(asyncCompilationsMutex());
+    auto& entry = asyncCompilations()[key];
+    if (entry) {
+      return entry->done ? entry->planNode : nullptr;
+    }
+    entry = std::make_shared<AsyncCompilation>();
+    compilation = entry;
+  }
+  compilationExecutor().add(
+      [self = shared_from_this(), planNode, compilation]() {
+        std::shared_ptr<const core::PlanNode> compiled;
+        try {
+          compiled = self->compile(*planNode);
+        } catch (const std::exception& e) {
+          LOG(WARNING) << "Codegen: asynchronous compilation failed, the plan "
+                       << "stays interpreted: " << e.what();
+        }
+        std::lock_guard<std::mutex> l(asyncCompilationsMutex());
+        compilation->planNode = std::move(compiled);
+        compilation->done = true;
+      });
+  return nullptr;
+}
+
 bool Codegen::initializeCodeManager(
     const proto::CompilerOptionsProto& compilerOptionsProto) {
   LOG(INFO) << "Codegen: initializing CodeManager";
@@ -33,7 +33,7 @@ class ICodegenLogger;
 
 /// Main interface/entry point with the  code generation system.
 /// The init method has to be called before any other method on this object.
-class Codegen {
+class Codegen : public std::enable_shared_from_this<Codegen> {
  public:
   explicit Codegen(std::shared_ptr<ICodegenLogger> codegenLogger)
       : codegenLogger_(codegenLogger) {}
@@ -48,6 +48,15 @@ class Codegen {
 
   std::shared_ptr<const core::PlanNode> compile(const core::PlanNode& planNode);
 
+  /// Returns the compiled version of 'planNode' if an earlier call in this
+  /// process compiled the same plan with the same options. Otherwise starts
+  /// compiling 'planNode' on a background thread, unless that is already in
+  /// progress, and returns nullptr, so that the caller runs the interpreted
+  /// plan instead of waiting for the compiler. A plan that fails to compile
+  /// stays interpreted. Requires this object to be owned by a shared_ptr.
+  std::shared_ptr<const core::PlanNode> compileAsync(
+      const std::shared_ptr<const core::PlanNode>& planNode);
+
  private:
   std::shared_ptr<ICodegenLogger> codegenLogger_;
 
@@ -59,6 +68,9 @@ class Codegen {
   // NestedScopedTimer.h
   std::shared_ptr<void /*DefaultEventSequence*/> eventSequence_;
 
+  // The options passed to initialize(). Part of the key of compileAsync().
+  std::string codegenOptionsJson_;
+
   // Follows Velox, defaults to false
   bool useSymbolsForArithmetic_ = false;
 
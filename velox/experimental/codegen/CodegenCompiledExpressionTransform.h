@@ -84,9 +84,20 @@ class CompiledExpressionTransformVisitor {
           std::placeholders::_1,
           std::placeholders::_1,
           std::placeholders::_1,
-          *ranges::begin(transformedChildren));
+          *ranges::begin(transformedChildren),
+          std::placeholders::_1,
+          std::placeholders::_1);
     };
 
+    if (auto aggregationNode =
+            dynamic_cast<const core::AggregationNode*>(&planNode)) {
+      // The aggregation stays interpreted and consumes the output of its
+      // compiled source, e.g. a filter and projection over a scan fused
+      // into one compiled expression.
+      return copyAggregation(
+          *aggregationNode, *ranges::begin(transformedChildren));
+    }
+
     if (auto tableScanNode =
             dynamic_cast<const core::TableScanNode*>(&planNode)) {
       // Return a copy.
@@ -109,6 +120,40 @@ class CompiledExpressionTransformVisitor {
   bool compileFilter_;
   bool mergeFilter_;
 
+  /// Returns a copy of 'aggregation' over 'source'.
+  std::shared_ptr<core::PlanNode> copyAggregation(
+      const core::AggregationNode& aggregation,
+      std::shared_ptr<const core::PlanNode> source) {
+    std::vector<bool> distinctAggregates;
+    if (aggregation.hasDistinctAggregates()) {
+      for (size_t i = 0; i < aggregation.aggregates().size(); ++i) {
+        distinctAggregates.push_back(aggregation.isDistinctAggregate(i));
+      }
+    }
+    std::vector<core::AggregationNode::AggregateOrdering> orderings;
+    if (aggregation.hasOrderedAggregates()) {
+      for (size_t i = 0; i < aggregation.aggregates().size(); ++i) {
+        orderings.push_back(
+            aggregation.isOrderedAggregate(i)
+                ? aggregation.aggregateOrdering(i)
+                : core::AggregationNode::AggregateOrdering{});
+      }
+    }
+    return std::make_shared<core::AggregationNode>(
+        aggregation.id(),
+        aggregation.step(),
+        aggregation.groupingKeys(),
+        aggregation.preGroupedKeys(),
+        aggregation.aggregateNames(),
+        aggregation.aggregates(),
+        aggregation.aggregateMasks(),
+        aggregation.ignoreNullKeys(),
+        std::move(source),
+        aggregation.numGroupsHint(),
+        distinctAggregates,
+        orderings);
+  }
+
   std::optional<std::reference_wrapper<const GeneratedExpressionStruct>>
   getGeneratedCode(const std::shared_ptr<const ITypedExpr>& expression) {
     auto it = compiledExprAnalysisResult_.generatedCode_.find(expression);
@@ -486,8 +531,8 @@ class CompiledExpressionTransformVisitor {
             "isDefaultNullStrict",
             isDefaultNullStrict(filter.id()) ? "true" : "false"));
 
-    auto compiledObject = codeManager_.compiler().compileString({}, fileString);
-    auto dynamicObject = codeManager_.compiler().link({}, {compiledObject});
+    auto dynamicObject =
+        codeManager_.compiler().compileAndLinkCached({}, fileString);
 
     // Extract the row input expression from the current filter
     const auto inputType = filter.sources()[0]->outputType();
@@ -583,8 +628,8 @@ class CompiledExpressionTransformVisitor {
         fmt::arg(
             "isDefaultNullStrict", isDefaultNullStrict ? "true" : "false"));
 
-    auto compiledObject = codeManager_.compiler().compileString({}, fileString);
-    auto dynamicObject = codeManager_.compiler().link({}, {compiledObject});
+    auto dynamicObject =
+        codeManager_.compiler().compileAndLinkCached({}, fileString);
     std::vector<std::shared_ptr<const ITypedExpr>> newProjections;
 
     // Extract the row input expression from the current projection
@@ -73,7 +73,8 @@ class GenerateCompiledExpressionVisitor {
         auto valueNode = dynamic_cast<const core::ValuesNode*>(&planNode)) {
     } else if (
         dynamic_cast<const core::TableWriteNode*>(&planNode) ||
-        dynamic_cast<const core::TableScanNode*>(&planNode)) {
+        dynamic_cast<const core::TableScanNode*>(&planNode) ||
+        dynamic_cast<const core::AggregationNode*>(&planNode)) {
       // Those plan nodes do not have expressions to transform
     } else {
       throw std::logic_error("Unknown node type:\n" + planNode.toString());
@@ -189,6 +189,40 @@ class Compiler {
     return dynamicLibPath;
   }
 
+  /// Compiles and links a given c++ string into a dynamic library, reusing
+  /// the library of an earlier call with the same content and options. The
+  /// libraries are kept in the "codegen_cache" sub directory of the temp
+  /// directory, under the hash of the content and the compile and link
+  /// commands, so that they are reused across queries and processes.
+  /// Without a temp directory this is compileString() followed by link().
+  /// \param additionalLibraries
+  /// \param cppContent  c++ file content
+  /// \return path to the dynamic library
+  std::filesystem::path compileAndLinkCached(
+      const std::vector<LibraryDescriptor>& additionalLibraries,
+      const std::string& cppContent) {
+    if (compilerOptions_.tempDirectory.empty()) {
+      auto objectPath = compileString(additionalLibraries, cppContent);
+      return link(additionalLibraries, {objectPath});
+    }
+    auto cacheDirectory = compilerOptions_.tempDirectory / "codegen_cache";
+    auto cachedPath = cacheDirectory /
+        fmt::format("{:016x}.so", cacheKey(additionalLibraries, cppContent));
+    if (std::filesystem::exists(cachedPath)) {
+      DefaultScopedTimer timer("CompileCacheHit", eventSequence_);
+      return cachedPath;
+    }
+    std::filesystem::create_directories(cacheDirectory);
+    auto objectPath = compileString(additionalLibraries, cppContent);
+    // Links into a unique file of the cache directory and renames it, so that
+    // concurrent compilations of the same content never expose a partial
+    // library.
+    auto linkedPath = pathGenerator_.tempPath(cacheDirectory, "dyn", ".so");
+    link(additionalLibraries, {objectPath}, linkedPath);
+    std::filesystem::rename(linkedPath, cachedPath);
+    return cachedPath;
+  }
+
   /// Construct a command object which execution would compile the give files.
   /// \param additionalLibraries
   /// \param cppFile
@@ -267,6 +301,24 @@ class Compiler {
   }
 
  private:
+  // Hashes 'cppContent' together with the compiler and all arguments that
+  // affect the generated library.
+  size_t cacheKey(
+      const std::vector<LibraryDescriptor>& additionalLibraries,
+      const std::string& cppContent) {
+    std::string key(cppContent);
+    auto append = [&](const external_process::Command& command) {
+      key.append(command.executablePath.string());
+      for (const auto& arg : command.arguments) {
+        key.push_back('\0');
+        key.append(arg);
+      }
+    };
+    append(compileCommand(additionalLibraries, "", ""));
+    append(linkCommand(additionalLibraries, {}, ""));
+    return std::hash<std::string>{}(key);
+  }
+
   void includePathArgs(
       const LibraryDescriptor& library,
       std::vector<std::string>& args) {
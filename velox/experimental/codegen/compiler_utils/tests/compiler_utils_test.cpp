@@ -290,4 +290,48 @@ TEST(Compiler, CompileAndLink) {
   ASSERT_EQ(dlerror(), nullptr);
   ASSERT_EQ(f(), 24);
 };
+
+TEST(Compiler, CompileAndLinkCached) {
+  auto sourceCode = R"a(
+  extern "C" {
+  int f() {
+    return 24;
+  };
+  }
+  )a";
+
+  auto options = testCompilerOptions();
+  options.tempDirectory =
+      boost::filesystem::unique_path(
+          fmt::format(
+              "{}/%%%%-%%%%",
+              boost::filesystem::temp_directory_path().string()))
+          .string();
+
+  DefaultScopedTimer::EventSequence eventSequence;
+  Compiler compiler(options, eventSequence);
+
+  auto sharedObject = compiler.compileAndLinkCached({}, sourceCode);
+  ASSERT_TRUE(std::filesystem::exists(sharedObject));
+  ASSERT_EQ(sharedObject.parent_path().parent_path(), options.tempDirectory);
+  auto writeTime = std::filesystem::last_write_time(sharedObject);
+
+  // The same content resolves to the cached library without compiling.
+  Compiler otherCompiler(options, eventSequence);
+  ASSERT_EQ(otherCompiler.compileAndLinkCached({}, sourceCode), sharedObject);
+  ASSERT_EQ(std::filesystem::last_write_time(sharedObject), writeTime);
+
+  // Different content gets a different library.
+  auto otherObject =
+      compiler.compileAndLinkCached({}, std::string(sourceCode) + "\n");
+  ASSERT_NE(otherObject, sharedObject);
+
+  auto libraryPtr =
+      native_loader::NativeLibraryLoader::loadLibraryInternal(sharedObject);
+  auto f = (int (*)())dlsym(libraryPtr, "f");
+  ASSERT_EQ(dlerror(), nullptr);
+  ASSERT_EQ(f(), 24);
+
+  std::filesystem::remove_all(options.tempDirectory);
+}
 } // namespace facebook::velox::codegen::compiler_utils::test
@@ -105,4 +105,35 @@ TEST_F(CodegenTest, stringCompound) {
   testExpressions<VarcharType>({"lower(upper(a))"}, inputRowType, 10, 100);
 };
 
+TEST_F(CodegenTest, projectionUnderAggregation) {
+  auto inputRowType = ROW({"a", "b"}, std::vector<TypePtr>{DOUBLE(), DOUBLE()});
+  auto inputVectors = createRowVector(
+      10, 100, inputRowType, [](vector_size_t index) { return index % 10; });
+  auto plan = PlanBuilder()
+                  .values(inputVectors)
+                  .project({"a + b", "a - b"})
+                  .partialAggregation({}, {"sum(p0)", "max(p1)"})
+                  .finalAggregation({}, {"sum(a0)", "max(a1)"})
+                  .planNode();
+
+  std::unique_ptr<TaskCursor> referenceTaskCursor;
+  auto references = runQuery(plan, referenceTaskCursor);
+
+  // The projection under the aggregation is compiled.
+  auto compiledPlan = codegenTransformation_->transform(*plan);
+  auto compiledProject = std::dynamic_pointer_cast<const core::ProjectNode>(
+      compiledPlan->sources()[0]->sources()[0]);
+  ASSERT_TRUE(compiledProject != nullptr);
+  ASSERT_TRUE(
+      std::dynamic_pointer_cast<const core::FieldAccessTypedExpr>(
+          compiledProject->projections()[0]) != nullptr);
+
+  std::unique_ptr<TaskCursor> compiledTaskCursor;
+  auto results = runQuery(compiledPlan, compiledTaskCursor);
+  ASSERT_EQ(references.size(), 1);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_FALSE((compareRowVector<double, double>(
+      references[0], results[0], std::index_sequence_for<double, double>())));
+};
+
 } // namespace facebook::velox::codegen
@@ -181,7 +181,9 @@ struct TableWriteNodeReader {
         node.columnNames(),
         node.insertTableHandle(),
         node.outputType(),
-        node.sources()[0]);
+        node.sources()[0],
+        node.sortingKeys(),
+        node.sortingOrders());
   }
 };
 
@@ -84,6 +84,11 @@ void populateNestedRows(
   nestedRows.updateBounds();
 }
 
+std::exception_ptr makeCastError(vector_size_t row) {
+  return std::make_exception_ptr(
+      std::invalid_argument("Cast error for input #" + std::to_string(row)));
+}
+
 } // namespace
 
 template <typename To, typename From>
@@ -91,76 +96,42 @@ void CastExpr::applyCastWithTry(
     const SelectivityVector& rows,
     exec::EvalCtx* context,
     const DecodedVector& input,
-    FlatVector<To>* resultFlatVector) {
+    FlatVector<To>* resultFlatVector,
+    SelectivityVector* failedRows) {
   const auto& queryConfig = context->execCtx()->queryCtx()->config();
   auto isCastIntByTruncate = queryConfig.isCastIntByTruncate();
 
-  if (!nullOnFailure_) {
-    if (!isCastIntByTruncate) {
-      rows.applyToSelected([&](int row) {
-        // Passing a false truncate flag
-        try {
-          bool nullOutput = false;
-          applyCastKernel<To, From, false>(
-              row, input, resultFlatVector, nullOutput);
-          if (nullOutput) {
-            context->setError(
-                row,
-                std::make_exception_ptr(std::invalid_argument(
-                    "Cast error for input #" + std::to_string(row))));
-          }
-        } catch (const std::exception& e) {
-          context->setError(
-              row,
-              std::make_exception_ptr(std::invalid_argument(
-                  "Cast error for input #" + std::to_string(row))));
-        }
-      });
-    } else {
-      rows.applyToSelected([&](int row) {
-        // Passing a true truncate flag
-        try {
-          bool nullOutput = false;
-          applyCastKernel<To, From, true>(
-              row, input, resultFlatVector, nullOutput);
-          if (nullOutput) {
-            context->setError(row, std::current_exception());
-          }
-        } catch (const std::exception& e) {
-          context->setError(row, std::current_exception());
-        }
-      });
-    }
+  // The Converters report invalid input in 'nullOutput' instead of throwing,
+  // so that a bad row under TRY or TRY_CAST costs no exception unwinding. The
+  // catch is for the conversions that still throw.
+  auto castRows = [&](auto truncate) {
+    rows.applyToSelected([&](int row) {
+      bool nullOutput = false;
+      try {
+        applyCastKernel<To, From, decltype(truncate)::value>(
+            row, input, resultFlatVector, nullOutput);
+      } catch (const std::exception&) {
+        nullOutput = true;
+      }
+      if (!nullOutput) {
+        return;
+      }
+      if (nullOnFailure_) {
+        resultFlatVector->setNull(row, true);
+      } else if (failedRows) {
+        resultFlatVector->setNull(row, true);
+        failedRows->setValid(row, true);
+      } else {
+        // Throws unless errors are captured, e.g. by TRY. The exception_ptr
+        // is made without throwing.
+        context->setError(row, makeCastError(row));
+      }
+    });
+  };
+  if (isCastIntByTruncate) {
+    castRows(std::true_type{});
   } else {
-    if (!isCastIntByTruncate) {
-      rows.applyToSelected([&](int row) {
-        // TRY_CAST implementation
-        try {
-          bool nullOutput = false;
-          applyCastKernel<To, From, false>(
-              row, input, resultFlatVector, nullOutput);
-          if (nullOutput) {
-            resultFlatVector->setNull(row, true);
-          }
-        } catch (...) {
-          resultFlatVector->setNull(row, true);
-        }
-      });
-    } else {
-      rows.applyToSelected([&](int row) {
-        // TRY_CAST implementation
-        try {
-          bool nullOutput = false;
-          applyCastKernel<To, From, true>(
-              row, input, resultFlatVector, nullOutput);
-          if (nullOutput) {
-            resultFlatVector->setNull(row, true);
-          }
-        } catch (...) {
-          resultFlatVector->setNull(row, true);
-        }
-      });
-    }
+    castRows(std::false_type{});
   }
 
   // If we're converting to a TIMESTAMP, check if we need to adjust the current
@@ -188,7 +159,8 @@ void CastExpr::applyCast(
     const SelectivityVector& rows,
     exec::EvalCtx* context,
     const DecodedVector& input,
-    VectorPtr* result) {
+    VectorPtr* result,
+    SelectivityVector* failedRows) {
   using To = typename TypeTraits<Kind>::NativeType;
   auto* resultFlatVector = (*result)->as<FlatVector<To>>();
 
@@ -198,35 +170,36 @@ void CastExpr::applyCast(
   switch (fromType) {
     case TypeKind::TINYINT: {
       return applyCastWithTry<To, int8_t>(
-          rows, context, input, resultFlatVector);
+          rows, context, input, resultFlatVector, failedRows);
     }
     case TypeKind::SMALLINT: {
       return applyCastWithTry<To, int16_t>(
-          rows, context, input, resultFlatVector);
+          rows, context, input, resultFlatVector, failedRows);
     }
     case TypeKind::INTEGER: {
       return applyCastWithTry<To, int32_t>(
-          rows, context, input, resultFlatVector);
+          rows, context, input, resultFlatVector, failedRows);
     }
     case TypeKind::BIGINT: {
       return applyCastWithTry<To, int64_t>(
-          rows, context, input, resultFlatVector);
+          rows, context, input, resultFlatVector, failedRows);
     }
     case TypeKind::BOOLEAN: {
-      return applyCastWithTry<To, bool>(rows, context, input, resultFlatVector);
+      return applyCastWithTry<To, bool>(
+          rows, context, input, resultFlatVector, failedRows);
     }
     case TypeKind::REAL: {
       return applyCastWithTry<To, float>(
-          rows, context, input, resultFlatVector);
+          rows, context, input, resultFlatVector, failedRows);
     }
     case TypeKind::DOUBLE: {
       return applyCastWithTry<To, double>(
-          rows, context, input, resultFlatVector);
+          rows, context, input, resultFlatVector, failedRows);
     }
     case TypeKind::VARCHAR:
     case TypeKind::VARBINARY: {
       return applyCastWithTry<To, StringView>(
-          rows, context, input, resultFlatVector);
+          rows, context, input, resultFlatVector, failedRows);
     }
     // TODO(beroy2000): Will add support for TimeStamp after the converters are
     // fixed
@@ -490,6 +463,45 @@ void CastExpr::apply(
     }
 
     context->moveOrCopyResult(localResult, rows, result);
+  } else if (
+      !decoded->isIdentityMapping() && !decoded->isConstantMapping() &&
+      decoded->base()->size() <= rows.end()) {
+    // Casts each distinct value of a dictionary once, e.g. the strings of a
+    // low cardinality column, and copies the results to the rows.
+    auto* base = decoded->base();
+    LocalSelectivityVector baseRows(context->execCtx(), base->size());
+    baseRows->clearAll();
+    nonNullRows->applyToSelected(
+        [&](auto row) { baseRows->setValid(decoded->index(row), true); });
+    baseRows->updateBounds();
+    LocalDecodedVector decodedBase(context, *base, *baseRows);
+
+    // Failures are reported for the rows, not for the distinct values.
+    LocalSelectivityVector failedRows(context->execCtx(), base->size());
+    failedRows->clearAll();
+    VectorPtr baseResult;
+    BaseVector::ensureWritable(
+        *baseRows, toType, context->pool(), &baseResult);
+    VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+        applyCast,
+        toType->kind(),
+        fromType->kind(),
+        *baseRows,
+        context,
+        *decodedBase,
+        &baseResult,
+        failedRows.get());
+
+    BaseVector::ensureWritable(rows, toType, context->pool(), result);
+    (*result)->copy(baseResult.get(), *nonNullRows, decoded->indices());
+    failedRows->updateBounds();
+    if (failedRows->hasSelections()) {
+      nonNullRows->applyToSelected([&](auto row) {
+        if (failedRows->isValid(decoded->index(row))) {
+          context->setError(row, makeCastError(row));
+        }
+      });
+    }
   } else {
     // Handling primitive type conversions
     BaseVector::ensureWritable(rows, toType, context->pool(), result);
@@ -502,7 +514,8 @@ void CastExpr::apply(
         *nonNullRows,
         context,
         *decoded,
-        result);
+        result,
+        nullptr);
   }
 
   // Copy nulls from "input".
@@ -47,12 +47,15 @@ class CastExpr : public SpecialForm {
   /// @param context The context
   /// @param input The input vector (of type From)
   /// @param resultFlatVector The output vector (of type To)
+  /// @param failedRows If not null, the rows that fail to cast are set to
+  /// null and added to 'failedRows' instead of being reported to 'context'
   template <typename To, typename From>
   void applyCastWithTry(
       const SelectivityVector& rows,
       exec::EvalCtx* context,
       const DecodedVector& input,
-      FlatVector<To>* resultFlatVector);
+      FlatVector<To>* resultFlatVector,
+      SelectivityVector* failedRows);
 
   /// @tparam To The target template
   /// @param fromType The source type pointer
@@ -60,13 +63,15 @@ class CastExpr : public SpecialForm {
   /// @param context The context
   /// @param input The input vector (of type From)
   /// @param result The output vector (of type To)
+  /// @param failedRows See applyCastWithTry()
   template <TypeKind To>
   void applyCast(
       const TypeKind fromType,
       const SelectivityVector& rows,
       exec::EvalCtx* context,
       const DecodedVector& input,
-      VectorPtr* result);
+      VectorPtr* result,
+      SelectivityVector* failedRows);
 
   /// Apply the cast after generating the input vectors
   /// @param rows The list of rows being processed
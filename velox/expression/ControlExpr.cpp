@@ -155,6 +155,7 @@ void SwitchExpr::evalSpecialForm(
     }
 
     // evaluate the case condition
+    loadBranchFields(2 * i, *remainingRows.get(), context);
     inputs_[2 * i]->eval(*remainingRows.get(), context, &condition);
 
     auto booleanMix = getFlatBool(
@@ -168,6 +169,7 @@ void SwitchExpr::evalSpecialForm(
         nullptr);
     switch (booleanMix) {
       case BooleanMix::kAllTrue:
+        loadBranchFields(2 * i + 1, *remainingRows.get(), context);
         inputs_[2 * i + 1]->eval(*remainingRows.get(), context, result);
         return;
       case BooleanMix::kAllNull:
@@ -188,6 +190,7 @@ void SwitchExpr::evalSpecialForm(
                 *thenRows.get(), (*result)->type(), context->pool(), result);
           }
 
+          loadBranchFields(2 * i + 1, *thenRows.get(), context);
           inputs_[2 * i + 1]->eval(*thenRows.get(), context, result);
           remainingRows.get()->deselect(*thenRows.get());
         }
@@ -203,6 +206,7 @@ void SwitchExpr::evalSpecialForm(
     }
 
     if (hasElseClause_) {
+      loadBranchFields(inputs_.size() - 1, *remainingRows.get(), context);
       inputs_.back()->eval(*remainingRows.get(), context, result);
 
     } else {
@@ -376,6 +380,7 @@ void ConjunctExpr::evalSpecialForm(
         isAnd_ && context->isFinalSelection());
 
     SelectivityTimer timer(selectivity_[inputOrder_[i]], numActive);
+    loadBranchFields(inputOrder_[i], *activeRows, context);
     inputs_[inputOrder_[i]]->eval(*activeRows, context, &inputResult);
     if (context->errors()) {
       handleErrors = true;
@@ -414,22 +419,33 @@ void ConjunctExpr::evalSpecialForm(
   }
 }
 
+float ConjunctExpr::inputCost(int32_t input) const {
+  const auto& selectivity = selectivity_[input];
+  // An input that has not seen rows, e.g. because the inputs before it
+  // decided all rows, has no cost yet. It stays behind the measured inputs
+  // instead of looking free.
+  if (selectivity.numIn() == 0) {
+    return std::numeric_limits<float>::max();
+  }
+  return selectivity.timeToDropValue();
+}
+
 void ConjunctExpr::maybeReorderInputs() {
   bool reorder = false;
   for (auto i = 1; i < inputs_.size(); ++i) {
-    if (selectivity_[inputOrder_[i - 1]].timeToDropValue() >
-        selectivity_[inputOrder_[i]].timeToDropValue()) {
+    if (inputCost(inputOrder_[i - 1]) > inputCost(inputOrder_[i])) {
       reorder = true;
       break;
     }
   }
   if (reorder) {
-    std::sort(
+    // Stable, so that inputs of equal cost, e.g. the unmeasured ones, keep
+    // their order.
+    std::stable_sort(
         inputOrder_.begin(),
         inputOrder_.end(),
-        [this](size_t left, size_t right) {
-          return selectivity_[left].timeToDropValue() <
-              selectivity_[right].timeToDropValue();
+        [this](int32_t left, int32_t right) {
+          return inputCost(left) < inputCost(right);
         });
   }
 }
@@ -666,6 +682,14 @@ class ExprCallable : public Callable {
     body_->eval(rows, &lambdaCtx, result);
   }
 
+  const Expr* body() const override {
+    return body_.get();
+  }
+
+  std::shared_ptr<const RowType> signature() const override {
+    return signature_;
+  }
+
  private:
   std::shared_ptr<const RowType> signature_;
   RowVectorPtr capture_;
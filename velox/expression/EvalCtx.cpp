@@ -207,6 +207,50 @@ void EvalCtx::setErrors(
   rows.applyToSelected([&](auto row) { setError(row, exceptionPtr); });
 }
 
+bool EvalCtx::isField(const BaseVector* vector) const {
+  auto matches = [&](const VectorPtr& field) {
+    if (field.get() == vector) {
+      return true;
+    }
+    return field->isLazy() && field->asUnchecked<LazyVector>()->isLoaded() &&
+        field->loadedVector() == vector;
+  };
+  for (const auto& field : peeledFields_) {
+    if (field && matches(field)) {
+      return true;
+    }
+  }
+  for (const auto& field : row_->children()) {
+    if (field && matches(field)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+DecodedVector* EvalCtx::decodedField(
+    const VectorPtr& vector,
+    const SelectivityVector& rows) {
+  // Flat and constant vectors decode without copying indices.
+  if (vector->encoding() == VectorEncoding::Simple::FLAT ||
+      vector->isConstantEncoding() || !row_ || !isField(vector.get())) {
+    return nullptr;
+  }
+  for (auto& field : decodedFields_) {
+    if (field.vector == vector) {
+      if (!rows.isSubset(field.rows)) {
+        field.rows = rows;
+        field.decoded->decode(*vector, rows);
+      }
+      return field.decoded.get();
+    }
+  }
+  auto decoded = std::make_unique<DecodedVector>(*vector, rows);
+  auto* result = decoded.get();
+  decodedFields_.push_back({vector, rows, std::move(decoded)});
+  return result;
+}
+
 VectorPtr EvalCtx::getField(int32_t index) const {
   VectorPtr field;
   if (!peeledFields_.empty()) {
@@ -234,10 +278,14 @@ BaseVector* EvalCtx::getRawField(int32_t index) const {
 }
 
 void EvalCtx::ensureFieldLoaded(int32_t index, const SelectivityVector& rows) {
+  ensureFieldLoadedForRows(index, isFinalSelection_ ? rows : *finalSelection_);
+}
+
+void EvalCtx::ensureFieldLoadedForRows(
+    int32_t index,
+    const SelectivityVector& rowsToLoad) {
   auto field = getRawField(index);
   if (isLazyNotLoaded(*field)) {
-    const auto& rowsToLoad = isFinalSelection_ ? rows : *finalSelection_;
-
     LocalDecodedVector holder(this);
     auto decoded = holder.get();
     decoded->decode(*field, rowsToLoad, false);
@@ -250,8 +298,8 @@ void EvalCtx::ensureFieldLoaded(int32_t index, const SelectivityVector& rows) {
     if (decoded->isConstantMapping()) {
       rowNumbers.push_back(decoded->index(rowsToLoad.begin()));
     } else if (decoded->isIdentityMapping()) {
-      if (rows.isAllSelected()) {
-        auto iota = velox::iota(rows.end(), rowNumbers);
+      if (rowsToLoad.isAllSelected()) {
+        auto iota = velox::iota(rowsToLoad.end(), rowNumbers);
         rowSet = RowSet(iota, rowsToLoad.end());
       } else {
         rowNumbers.reserve(rowsToLoad.end());
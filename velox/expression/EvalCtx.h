@@ -18,6 +18,7 @@
 
 #include "velox/core/QueryCtx.h"
 #include "velox/vector/ComplexVector.h"
+#include "velox/vector/DecodedVector.h"
 #include "velox/vector/FlatVector.h"
 
 namespace facebook::velox::exec {
@@ -49,6 +50,20 @@ class EvalCtx {
 
   void ensureFieldLoaded(int32_t index, const SelectivityVector& rows);
 
+  // Returns 'vector' decoded for at least 'rows' if 'vector' is a non-flat
+  // field of row() or a peeled field, nullptr otherwise. The decoding is
+  // shared by all functions that take the field as an argument during the
+  // evaluation with 'this', so that a column feeding many functions is
+  // decoded once. The result is valid until the next call.
+  DecodedVector* decodedField(
+      const VectorPtr& vector,
+      const SelectivityVector& rows);
+
+  // Loads the field at 'index' for 'rows' only, also under an IF, AND or OR.
+  // The caller must ensure that no other rows of the field are accessed
+  // afterwards, since a LazyVector is loaded at most once.
+  void ensureFieldLoadedForRows(int32_t index, const SelectivityVector& rows);
+
   void setPeeled(int32_t index, const VectorPtr& vector) {
     if (peeledFields_.size() <= index) {
       peeledFields_.resize(index + 1);
@@ -158,6 +173,13 @@ class EvalCtx {
     return execCtx_;
   }
 
+  // Returns scratch memory that is freed when the evaluation of the
+  // ExprSet ends. Not for the data of results.
+  Arena& arena() const {
+    VELOX_DCHECK(execCtx_->inEval(), "Arena used outside of ExprSet::eval");
+    return execCtx_->arena();
+  }
+
   ExprSet* exprSet() const {
     return exprSet_;
   }
@@ -222,6 +244,19 @@ class EvalCtx {
   // in a opaque flat vector, which will translate to a
   // std::shared_ptr<std::exception_ptr>.
   ErrorVectorPtr errors_;
+
+  // A field decoded by decodedField(). 'vector' is held so that its address
+  // is not reused by another vector while 'this' lives.
+  struct DecodedField {
+    VectorPtr vector;
+    SelectivityVector rows;
+    std::unique_ptr<DecodedVector> decoded;
+  };
+
+  // Returns true if 'vector' is a field of 'row_' or of 'peeledFields_'.
+  bool isField(const BaseVector* vector) const;
+
+  std::vector<DecodedField> decodedFields_;
 };
 
 struct ContextSaver {
@@ -15,6 +15,8 @@
  */
 
 #include "velox/expression/Expr.h"
+#include <folly/ScopeGuard.h>
+#include <map>
 #include "velox/core/Expressions.h"
 #include "velox/expression/ControlExpr.h"
 #include "velox/expression/ExprCompiler.h"
@@ -222,6 +224,12 @@ void Expr::eval(
     return;
   }
 
+  std::optional<CpuWallTimer> timer;
+  if (trackStats_) {
+    stats_.numProcessedRows += rows.countSelected();
+    timer.emplace(stats_.timing);
+  }
+
   // Check if there are any IFs, ANDs or ORs. These expressions are special
   // because not all of their sub-expressions get evaluated on all the rows all
   // the time. Therefore, we should delay loading lazy vectors until we know the
@@ -234,8 +242,12 @@ void Expr::eval(
   //
   // TODO: Re-work the logic of deciding when to load which field.
   if (!hasConditionals_ || distinctFields_.size() == 1) {
-    // Load lazy vectors if any.
+    // Load lazy vectors if any. A column that is loaded in a branch of a
+    // conditional below 'this' is left to that branch.
     for (const auto& field : distinctFields_) {
+      if (hasConditionals_ && field->isLoadedInBranch()) {
+        continue;
+      }
       context->ensureFieldLoaded(field->index(context), rows);
     }
   }
@@ -256,6 +268,24 @@ void Expr::eval(
   checkUpdateSharedSubexprValues(rows, context, *result);
 }
 
+void Expr::addBranchField(int32_t input, FieldReference* field) {
+  VELOX_CHECK_LT(input, inputs_.size());
+  branchFields_.resize(inputs_.size());
+  branchFields_[input].push_back(field);
+}
+
+void Expr::loadBranchFields(
+    int32_t input,
+    const SelectivityVector& rows,
+    EvalCtx* context) {
+  if (input >= branchFields_.size()) {
+    return;
+  }
+  for (auto* field : branchFields_[input]) {
+    context->ensureFieldLoadedForRows(field->index(context), rows);
+  }
+}
+
 bool Expr::checkGetSharedSubexprValues(
     const SelectivityVector& rows,
     EvalCtx* context,
@@ -310,11 +340,15 @@ void Expr::checkUpdateSharedSubexprValues(
 }
 
 namespace {
+// Vector in the scratch memory of an ExprSet::eval.
+template <typename T>
+using ScratchVector = std::vector<T, ArenaAllocator<T>>;
+
 inline void setPeeled(
     const VectorPtr& leaf,
     int32_t fieldIndex,
     EvalCtx* context,
-    std::vector<VectorPtr>& peeled) {
+    ScratchVector<VectorPtr>& peeled) {
   if (peeled.size() <= fieldIndex) {
     peeled.resize(context->row()->childrenSize());
   }
@@ -396,9 +430,10 @@ Expr::PeelEncodingsResult Expr::peelEncodings(
   if (context->wrapEncoding() == VectorEncoding::Simple::CONSTANT) {
     return Expr::PeelEncodingsResult::empty();
   }
-  std::vector<VectorPtr> peeledVectors;
-  std::vector<VectorPtr> maybePeeled;
-  std::vector<bool> constantFields;
+  ArenaAllocator<VectorPtr> allocator(&context->arena());
+  ScratchVector<VectorPtr> peeledVectors(allocator);
+  ScratchVector<VectorPtr> maybePeeled(allocator);
+  ScratchVector<bool> constantFields(allocator);
   int numLevels = 0;
   bool peeled;
   bool nonConstant = false;
@@ -560,6 +595,7 @@ void Expr::evalEncodings(
           finalRowsHolder);
       auto* newRows = peelEncodingsResult.newRows;
       if (newRows) {
+        ++stats_.numPeeled;
         VectorPtr peeledResult;
         // peelEncodings() can potentially produce an empty selectivity vector
         // if all selected values we are waiting for are nulls. So, here we
@@ -687,6 +723,7 @@ void Expr::evalWithMemo(
   ++numCachableInput_;
   if (baseDictionary_ == base) {
     ++numCacheableRepeats_;
+    ++stats_.numMemoized;
     if (cachedDictionaryIndices_) {
       LocalSelectivityVector cachedHolder(context, rows);
       auto cached = cachedHolder.get();
@@ -773,8 +810,9 @@ namespace {
 void computeIsAsciiForInputs(
     const VectorFunction* vectorFunction,
     const std::vector<VectorPtr>& inputValues,
-    const SelectivityVector& rows) {
-  std::vector<size_t> indices;
+    const SelectivityVector& rows,
+    Arena& arena) {
+  ScratchVector<size_t> indices{ArenaAllocator<size_t>(&arena)};
   if (vectorFunction->ensureStringEncodingSetAtAllInputs()) {
     for (auto i = 0; i < inputValues.size(); i++) {
       indices.push_back(i);
@@ -802,14 +840,16 @@ void computeIsAsciiForInputs(
 std::optional<bool> computeIsAsciiForResult(
     const VectorFunction* vectorFunction,
     const std::vector<VectorPtr>& inputValues,
-    const SelectivityVector& rows) {
-  std::vector<size_t> indices;
+    const SelectivityVector& rows,
+    Arena& arena) {
+  ScratchVector<size_t> indices{ArenaAllocator<size_t>(&arena)};
   if (vectorFunction->propagateStringEncodingFromAllInputs()) {
     for (auto i = 0; i < inputValues.size(); i++) {
       indices.push_back(i);
     }
   } else if (vectorFunction->propagateStringEncodingFrom().has_value()) {
-    indices = vectorFunction->propagateStringEncodingFrom().value();
+    auto from = vectorFunction->propagateStringEncodingFrom();
+    indices.assign(from->begin(), from->end());
   }
 
   if (indices.empty()) {
@@ -924,7 +964,7 @@ bool Expr::applyFunctionWithPeeling(
   // Holds the outermost wrapper. This may be the last reference after
   // peeling for a temporary dictionary, hence use a shared_ptr.
   VectorPtr firstWrapper = nullptr;
-  std::vector<bool> constantArgs;
+  ScratchVector<bool> constantArgs{ArenaAllocator<bool>(&context->arena())};
   do {
     peeled = true;
     BufferPtr firstIndices;
@@ -1019,6 +1059,7 @@ bool Expr::applyFunctionWithPeeling(
     setDictionaryWrapping(*decoded, rows, *firstWrapper, context);
   }
 
+  ++stats_.numPeeled;
   VectorPtr peeledResult;
   applyFunction(*newRows, context, &peeledResult);
   context->setWrapped(this, peeledResult, rows, result);
@@ -1029,9 +1070,11 @@ void Expr::applyFunction(
     const SelectivityVector& rows,
     EvalCtx* context,
     VectorPtr* result) {
-  computeIsAsciiForInputs(vectorFunction_.get(), inputValues_, rows);
+  auto& arena = context->arena();
+  computeIsAsciiForInputs(vectorFunction_.get(), inputValues_, rows, arena);
   auto isAscii = type()->isVarchar()
-      ? computeIsAsciiForResult(vectorFunction_.get(), inputValues_, rows)
+      ? computeIsAsciiForResult(
+            vectorFunction_.get(), inputValues_, rows, arena)
       : std::nullopt;
   applyVectorFunction(rows, context, result);
   if (isAscii.has_value()) {
@@ -1128,6 +1171,11 @@ void ExprSet::eval(
     const SelectivityVector& rows,
     EvalCtx* context,
     std::vector<VectorPtr>* result) {
+  auto execCtx = context->execCtx();
+  execCtx->enterEval();
+  SCOPE_EXIT {
+    execCtx->leaveEval();
+  };
   result->resize(exprs_.size());
   if (initialize) {
     clearSharedSubexprs();
@@ -1143,6 +1191,131 @@ void ExprSet::clearSharedSubexprs() {
   }
 }
 
+namespace {
+void addExprStats(
+    const Expr& expr,
+    const std::string& path,
+    std::unordered_set<const Expr*>& visited,
+    std::unordered_map<std::string, ExprStats>& stats) {
+  if (expr.inputs().empty() || !visited.insert(&expr).second) {
+    return;
+  }
+  stats[fmt::format("{}:{}", path, expr.name())] = expr.stats();
+  for (auto i = 0; i < expr.inputs().size(); ++i) {
+    addExprStats(
+        *expr.inputs()[i], fmt::format("{}.{}", path, i), visited, stats);
+  }
+}
+} // namespace
+
+namespace {
+// An input of an IF, AND or OR that may be evaluated on a subset of the
+// rows of the IF, AND or OR.
+using Branch = std::pair<Expr*, int32_t>;
+
+struct BranchReferences {
+  // The innermost-last path of Branches that are common to all references
+  // to the column.
+  std::vector<Branch> path;
+
+  std::vector<FieldReference*> fields;
+};
+
+// Adds the references to columns in 'expr' to 'columns'. 'path' is the
+// Branches that 'expr' is under. 'numVisits' counts the times a Branch is
+// reached. A Branch in a shared subexpression is reached several times.
+void addBranchReferences(
+    Expr* expr,
+    std::vector<Branch>& path,
+    std::unordered_map<std::string, BranchReferences>& columns,
+    std::map<Branch, int32_t>& numVisits) {
+  auto addReference = [&](FieldReference* field, bool inPath) {
+    auto [it, isNew] = columns.try_emplace(field->field());
+    auto& references = it->second;
+    if (isNew) {
+      if (inPath) {
+        references.path = path;
+      }
+    } else {
+      size_t common = 0;
+      auto maxCommon =
+          inPath ? std::min(references.path.size(), path.size()) : 0;
+      while (common < maxCommon && references.path[common] == path[common]) {
+        ++common;
+      }
+      references.path.resize(common);
+    }
+    if (!isMember(references.fields, field)) {
+      references.fields.push_back(field);
+    }
+  };
+
+  if (auto field = dynamic_cast<FieldReference*>(expr)) {
+    if (field->inputs().empty()) {
+      addReference(field, true);
+      return;
+    }
+  }
+  if (auto lambda = dynamic_cast<LambdaExpr*>(expr)) {
+    // The captures are read wherever the lambda is applied.
+    for (const auto& field : lambda->capture()) {
+      addReference(field.get(), false);
+    }
+    return;
+  }
+  const bool isSwitch = dynamic_cast<SwitchExpr*>(expr) != nullptr;
+  const bool isConjunct = dynamic_cast<ConjunctExpr*>(expr) != nullptr;
+  for (auto i = 0; i < expr->inputs().size(); ++i) {
+    // The first condition of an IF is evaluated on all its rows. Any input
+    // of an AND or OR may be evaluated first, on all its rows, but then
+    // loading for the input's rows is the same as loading for all rows.
+    const bool isBranch = isConjunct || (isSwitch && i > 0);
+    if (isBranch) {
+      path.emplace_back(expr, i);
+      ++numVisits[path.back()];
+    }
+    addBranchReferences(expr->inputs()[i].get(), path, columns, numVisits);
+    if (isBranch) {
+      path.pop_back();
+    }
+  }
+}
+} // namespace
+
+void ExprSet::enableLazyLoadingInBranches(
+    const std::unordered_set<std::string>& readColumns) {
+  std::unordered_map<std::string, BranchReferences> columns;
+  std::map<Branch, int32_t> numVisits;
+  std::vector<Branch> path;
+  for (auto& expr : exprs_) {
+    addBranchReferences(expr.get(), path, columns, numVisits);
+  }
+  for (auto& [name, references] : columns) {
+    if (references.path.empty() || readColumns.count(name)) {
+      continue;
+    }
+    // A Branch that is reached more than once may be evaluated on
+    // different rows each time.
+    const auto& branch = references.path.back();
+    if (numVisits[branch] > 1) {
+      continue;
+    }
+    branch.first->addBranchField(branch.second, references.fields[0]);
+    for (auto* field : references.fields) {
+      field->setLoadedInBranch();
+    }
+  }
+}
+
+std::unordered_map<std::string, ExprStats> ExprSet::stats() const {
+  std::unordered_map<std::string, ExprStats> stats;
+  std::unordered_set<const Expr*> visited;
+  for (auto i = 0; i < exprs_.size(); ++i) {
+    addExprStats(*exprs_[i], std::to_string(i), visited, stats);
+  }
+  return stats;
+}
+
 void ExprSet::clear() {
   clearSharedSubexprs();
   for (auto* memo : memoizingExprs_) {
@@ -1157,6 +1330,11 @@ void ExprSetSimplified::eval(
     const SelectivityVector& rows,
     EvalCtx* context,
     std::vector<VectorPtr>* result) {
+  auto execCtx = context->execCtx();
+  execCtx->enterEval();
+  SCOPE_EXIT {
+    execCtx->leaveEval();
+  };
   result->resize(exprs_.size());
   if (initialize) {
     clearSharedSubexprs();
@@ -20,6 +20,7 @@
 
 #include <folly/container/F14Map.h>
 
+#include "velox/common/time/CpuWallTimer.h"
 #include "velox/core/Expressions.h"
 #include "velox/expression/EvalCtx.h"
 #include "velox/vector/SimpleVector.h"
@@ -44,22 +45,49 @@ class DecodedArgs {
       const std::vector<VectorPtr>& args,
       exec::EvalCtx* context) {
     for (auto& arg : args) {
-      holders_.emplace_back(context, *arg.get(), rows);
+      // Fields of the input are decoded once per evaluation and shared.
+      auto decoded = context->decodedField(arg, rows);
+      if (!decoded) {
+        holders_.emplace_back(context, *arg.get(), rows);
+        decoded = holders_.back().get();
+      }
+      decoded_.push_back(decoded);
     }
   }
 
   DecodedVector* at(int i) const {
-    return const_cast<exec::LocalDecodedVector*>(&holders_[i])->get();
+    return decoded_[i];
   }
 
  private:
   std::vector<exec::LocalDecodedVector> holders_;
+  std::vector<DecodedVector*> decoded_;
 };
 
 class ExprSet;
 class FieldReference;
 class VectorFunction;
 
+// Runtime statistics of an Expr. The timing and row counts are collected
+// only after setTrackStats(true). They are taken once per call, i.e. once
+// per batch, not per row.
+struct ExprStats {
+  // Number of calls to eval() and their CPU and wall time, including the
+  // time spent in the inputs.
+  CpuWallTiming timing;
+
+  // Number of rows over all calls.
+  uint64_t numProcessedRows{0};
+
+  // Number of calls that ran on peeled dictionary or constant encodings
+  // instead of on all rows.
+  uint64_t numPeeled{0};
+
+  // Number of calls that reused the results memoized for a repeated
+  // dictionary.
+  uint64_t numMemoized{0};
+};
+
 // An executable expression.
 class Expr {
  public:
@@ -135,6 +163,22 @@ class Expr {
     return type_;
   }
 
+  const std::string& name() const {
+    return name_;
+  }
+
+  // Turns collecting 'stats_' on or off for 'this' and all inputs.
+  void setTrackStats(bool track) {
+    trackStats_ = track;
+    for (auto& input : inputs_) {
+      input->setTrackStats(track);
+    }
+  }
+
+  const ExprStats& stats() const {
+    return stats_;
+  }
+
   bool isString() const {
     return type()->kind() == TypeKind::VARCHAR;
   }
@@ -169,6 +213,11 @@ class Expr {
     return distinctFields_;
   }
 
+  // Makes 'this' load the column of 'field' for the rows of
+  // 'inputs_[input]' before evaluating the input. See
+  // ExprSet::enableLazyLoadingInBranches().
+  void addBranchField(int32_t input, FieldReference* field);
+
   static bool isSameFields(
       const std::vector<FieldReference*>& fields1,
       const std::vector<FieldReference*>& fields2);
@@ -298,6 +347,13 @@ class Expr {
       VectorPtr* result);
 
  protected:
+  // Loads the columns in 'branchFields_[input]' for 'rows'. Called by IF,
+  // AND and OR before evaluating 'inputs_[input]' on a subset of their rows.
+  void loadBranchFields(
+      int32_t input,
+      const SelectivityVector& rows,
+      EvalCtx* context);
+
   const std::shared_ptr<const Type> type_;
   const std::vector<std::shared_ptr<Expr>> inputs_;
   const std::string name_;
@@ -323,6 +379,11 @@ class Expr {
 
   bool isMultiplyReferenced_ = false;
 
+  // For each input, the columns that are referenced only under the input
+  // and that are loaded for the rows the input is evaluated on. Empty if
+  // there are no such columns.
+  std::vector<std::vector<FieldReference*>> branchFields_;
+
   std::vector<VectorPtr> inputValues_;
 
   // If multiply referenced or literal, these are the values.
@@ -346,6 +407,10 @@ class Expr {
 
   // Count of times the cacheable vector is seen for a non-first time.
   int32_t numCacheableRepeats_{0};
+
+  bool trackStats_{false};
+
+  ExprStats stats_;
 };
 
 using ExprPtr = std::shared_ptr<Expr>;
@@ -405,6 +470,30 @@ class ExprSet {
     memoizingExprs_.insert(expr);
   }
 
+  // Lets IF, AND and OR load a LazyVector column for the rows that reach
+  // one of their inputs instead of for all their rows, if all references
+  // to the column in 'this' are under that input. By default a column is
+  // loaded for all the rows of the upper-most IF or OR, since the caller
+  // may read the column after eval(). 'readColumns' are the columns the
+  // caller reads after eval(), e.g. the identity projections of a
+  // FilterProject. These are always loaded for all rows.
+  void enableLazyLoadingInBranches(
+      const std::unordered_set<std::string>& readColumns);
+
+  // Turns collecting ExprStats on or off for all Exprs in 'this'.
+  void setTrackStats(bool track) {
+    for (auto& expr : exprs_) {
+      expr->setTrackStats(track);
+    }
+  }
+
+  // Returns the stats of the Exprs that have inputs, i.e. of the function
+  // calls and special forms, keyed on the path of the Expr: the index of
+  // the top level Expr and the input index at each level, followed by the
+  // name, e.g. "1.0:regexp_extract". A subexpression shared by several
+  // Exprs is reported once, under its first path.
+  std::unordered_map<std::string, ExprStats> stats() const;
+
  protected:
   void clearSharedSubexprs();
 
@@ -47,6 +47,25 @@ using ExprDedupMap = folly::F14FastMap<
     ITypedExprHasher,
     ITypedExprComparer>;
 
+// json_extract_scalar calls with constant paths on the same json argument.
+// Calls with at least two distinct paths are evaluated by one shared
+// json_extract_scalar_multi Expr, which gets each document parsed once.
+struct JsonExtractGroup {
+  // Distinct paths in order of first appearance.
+  std::vector<std::string> paths;
+  // The shared json_extract_scalar_multi Expr, made on first use.
+  ExprPtr fused;
+};
+
+using JsonExtractGroups = folly::F14FastMap<
+    const ITypedExpr*,
+    JsonExtractGroup,
+    ITypedExprHasher,
+    ITypedExprComparer>;
+
+const char* const kJsonExtractScalar = "json_extract_scalar";
+const char* const kJsonExtractScalarMulti = "json_extract_scalar_multi";
+
 /// Represents a lexical scope. A top level scope corresponds to a top
 /// level Expr and is shared among the Exprs of the ExprSet. Each
 /// lambda introduces a new Scope where the 'locals' are the formal
@@ -71,6 +90,8 @@ struct Scope {
   std::vector<const ITypedExpr*> captureFieldAccesses;
   // Deduplicatable ITypedExprs. Only applies within the one scope.
   ExprDedupMap visited;
+  // Fusable json extractions. Only collected for the top level scope.
+  JsonExtractGroups jsonExtractGroups;
 
   Scope(std::vector<std::string>&& _locals, Scope* _parent, ExprSet* _exprSet)
       : locals(_locals), parent(_parent), exprSet(_exprSet) {}
@@ -118,6 +139,40 @@ void flattenInput(
   }
 }
 
+// Returns the path of a json_extract_scalar call with a constant path, or
+// nullptr if 'expr' is not such a call.
+const std::string* getFusableJsonPath(const ITypedExpr* expr) {
+  auto call = dynamic_cast<const core::CallTypedExpr*>(expr);
+  if (!call || call->name() != kJsonExtractScalar ||
+      call->inputs().size() != 2 ||
+      dynamic_cast<const core::ConstantTypedExpr*>(call->inputs()[0].get())) {
+    return nullptr;
+  }
+  auto path =
+      dynamic_cast<const core::ConstantTypedExpr*>(call->inputs()[1].get());
+  if (!path || path->hasValueVector() || path->value().isNull() ||
+      path->type()->kind() != TypeKind::VARCHAR) {
+    return nullptr;
+  }
+  return &path->value().value<TypeKind::VARCHAR>();
+}
+
+// Adds the fusable json extractions in 'expr' to 'groups'. Lambda bodies are
+// not visited since they are compiled in their own Scope.
+void collectJsonExtractions(
+    const TypedExprPtr& expr,
+    JsonExtractGroups& groups) {
+  if (auto path = getFusableJsonPath(expr.get())) {
+    auto& paths = groups[expr->inputs()[0].get()].paths;
+    if (std::find(paths.begin(), paths.end(), *path) == paths.end()) {
+      paths.push_back(*path);
+    }
+  }
+  for (auto& input : expr->inputs()) {
+    collectJsonExtractions(input, groups);
+  }
+}
+
 ExprPtr getAlreadyCompiled(const ITypedExpr* expr, ExprDedupMap* visited) {
   auto iter = visited->find(expr);
   return iter == visited->end() ? nullptr : iter->second;
@@ -305,6 +360,73 @@ std::vector<VectorPtr> getConstantInputs(const std::vector<ExprPtr>& exprs) {
   return constants;
 }
 
+std::string fusedJsonFieldName(size_t index) {
+  return fmt::format("path{}", index);
+}
+
+// Compiles a json_extract_scalar call that is part of a JsonExtractGroup into
+// a reference to its field of the group's shared json_extract_scalar_multi
+// Expr. Returns nullptr if 'expr' is not fused.
+ExprPtr compileFusedJsonExtract(
+    const TypedExprPtr& expr,
+    Scope* scope,
+    const core::QueryConfig& config,
+    memory::MemoryPool* pool,
+    bool enableConstantFolding) {
+  auto path = getFusableJsonPath(expr.get());
+  if (!path) {
+    return nullptr;
+  }
+  auto it = scope->jsonExtractGroups.find(expr->inputs()[0].get());
+  if (it == scope->jsonExtractGroups.end()) {
+    return nullptr;
+  }
+  auto& group = it->second;
+  if (group.paths.size() < 2) {
+    return nullptr;
+  }
+
+  if (!group.fused) {
+    std::vector<ExprPtr> inputs;
+    inputs.push_back(compileExpression(
+        expr->inputs()[0], scope, config, pool, enableConstantFolding));
+    std::vector<std::string> names;
+    std::vector<TypePtr> types;
+    for (size_t i = 0; i < group.paths.size(); ++i) {
+      inputs.push_back(std::make_shared<ConstantExpr>(
+          BaseVector::createConstant(variant(group.paths[i]), 1, pool)));
+      names.push_back(fusedJsonFieldName(i));
+      types.push_back(VARCHAR());
+    }
+    auto func = getVectorFunction(
+        kJsonExtractScalarMulti, getTypes(inputs), getConstantInputs(inputs));
+    if (!func) {
+      // Not registered, compile the calls one by one.
+      group.paths.clear();
+      return nullptr;
+    }
+    group.fused = std::make_shared<Expr>(
+        ROW(std::move(names), std::move(types)),
+        std::move(inputs),
+        func,
+        kJsonExtractScalarMulti);
+    group.fused->computeMetadata();
+    // Make the fused results shared by all the calls like those of a common
+    // subexpression.
+    group.fused->setMultiplyReferenced();
+    scope->exprSet->addToReset(group.fused);
+  }
+
+  auto index = std::find(group.paths.begin(), group.paths.end(), *path) -
+      group.paths.begin();
+  auto field = std::make_shared<FieldReference>(
+      expr->type(),
+      std::vector<ExprPtr>{group.fused},
+      fusedJsonFieldName(index));
+  field->computeMetadata();
+  return field;
+}
+
 ExprPtr compileExpression(
     const TypedExprPtr& expr,
     Scope* scope,
@@ -320,6 +442,12 @@ ExprPtr compileExpression(
     return alreadyCompiled;
   }
 
+  if (auto fused = compileFusedJsonExtract(
+          expr, scope, config, pool, enableConstantFolding)) {
+    scope->visited[expr.get()] = fused;
+    return fused;
+  }
+
   ExprPtr result;
   auto resultType = expr->type();
   auto compiledInputs =
@@ -405,6 +533,9 @@ std::vector<std::shared_ptr<Expr>> compileExpressions(
     ExprSet* exprSet,
     bool enableConstantFolding) {
   Scope scope({}, nullptr, exprSet);
+  for (auto& source : sources) {
+    collectJsonExtractions(source, scope.jsonExtractGroups);
+  }
   std::vector<std::shared_ptr<Expr>> exprs;
   exprs.reserve(sources.size());
 
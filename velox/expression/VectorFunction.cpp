@@ -17,6 +17,8 @@
 #include <unordered_map>
 #include "folly/Singleton.h"
 #include "folly/Synchronized.h"
+#include "velox/common/memory/Memory.h"
+#include "velox/vector/ConstantVector.h"
 
 namespace facebook::velox::exec {
 
@@ -25,6 +27,114 @@ VectorFunctionMap& vectorFunctionFactories() {
   return factories;
 }
 
+namespace {
+// Identifies a VectorFunction made by a factory: the function name, the input
+// types and the values of the constant inputs.
+struct FunctionCacheKey {
+  std::string name;
+  std::vector<VectorFunctionArg> args;
+
+  bool operator==(const FunctionCacheKey& other) const {
+    if (name != other.name || args.size() != other.args.size()) {
+      return false;
+    }
+    for (auto i = 0; i < args.size(); ++i) {
+      const auto& arg = args[i];
+      const auto& otherArg = other.args[i];
+      if (*arg.type != *otherArg.type ||
+          (arg.constantValue == nullptr) !=
+              (otherArg.constantValue == nullptr)) {
+        return false;
+      }
+      if (arg.constantValue &&
+          !arg.constantValue->equalValueAt(
+              otherArg.constantValue.get(), 0, 0)) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+struct FunctionCacheKeyHasher {
+  size_t operator()(const FunctionCacheKey& key) const {
+    auto hash = std::hash<std::string>()(key.name);
+    for (const auto& arg : key.args) {
+      hash = bits::hashMix(hash, arg.type->hashKind());
+      if (arg.constantValue) {
+        hash = bits::hashMix(hash, arg.constantValue->hashValueAt(0));
+      }
+    }
+    return hash;
+  }
+};
+
+// Maximum number of functions in the cache. The cache is cleared when full.
+constexpr size_t kMaxCachedFunctions = 10'000;
+
+using FunctionCache = folly::Synchronized<std::unordered_map<
+    FunctionCacheKey,
+    std::shared_ptr<VectorFunction>,
+    FunctionCacheKeyHasher>>;
+
+// Functions made by the factories, shared by all the expressions that call
+// the same function on the same types and constants. This saves making the
+// function, e.g. compiling a regular expression, for each Driver of each
+// query.
+FunctionCache& functionCache() {
+  static FunctionCache cache;
+  return cache;
+}
+
+// Constants of complex types are not cached since they are costly to hash
+// and compare.
+bool isCacheable(const std::vector<VectorFunctionArg>& inputArgs) {
+  for (const auto& arg : inputArgs) {
+    if (arg.constantValue &&
+        (!arg.type->isPrimitiveType() ||
+         arg.type->kind() == TypeKind::UNKNOWN)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Holds the constants of the cached functions. The constants of an
+// expression are allocated from the pool of its query, which may end before
+// the cached function.
+memory::MemoryPool* cachePool() {
+  static auto pool = memory::getDefaultScopedMemoryPool();
+  return pool.get();
+}
+
+template <TypeKind kind>
+VectorPtr copyConstant(const VectorPtr& constant) {
+  using T = typename TypeTraits<kind>::NativeType;
+  auto isNull = constant->isNullAt(0);
+  T value = isNull ? T() : constant->as<SimpleVector<T>>()->valueAt(0);
+  // ConstantVector copies the bytes of a string value.
+  return std::make_shared<ConstantVector<T>>(
+      cachePool(), 1, isNull, constant->type(), std::move(value));
+}
+
+// Returns 'inputArgs' with the constants copied to the cache's pool.
+std::vector<VectorFunctionArg> copyArgs(
+    const std::vector<VectorFunctionArg>& inputArgs) {
+  std::vector<VectorFunctionArg> args;
+  args.reserve(inputArgs.size());
+  for (const auto& arg : inputArgs) {
+    args.push_back(
+        {arg.type,
+         arg.constantValue ? VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+                                 copyConstant,
+                                 arg.type->kind(),
+                                 arg.constantValue)
+                           : nullptr});
+  }
+  return args;
+}
+} // namespace
+
 std::optional<std::vector<std::shared_ptr<FunctionSignature>>>
 getVectorFunctionSignatures(const std::string& name) {
   return vectorFunctionFactories().withRLock([&name](auto& functions) -> auto {
@@ -54,13 +164,42 @@ std::shared_ptr<VectorFunction> getVectorFunction(
     });
   }
 
-  return vectorFunctionFactories().withRLock(
-      [&name, &inputArgs ](auto& functionMap) -> auto {
-        auto functionIterator = functionMap.find(name);
+  if (!isCacheable(inputArgs)) {
+    return vectorFunctionFactories().withRLock(
+        [&name, &inputArgs ](auto& functionMap) -> auto {
+          auto functionIterator = functionMap.find(name);
+          return functionIterator == functionMap.end()
+              ? nullptr
+              : functionIterator->second.factory(name, inputArgs);
+        });
+  }
+
+  FunctionCacheKey key{name, copyArgs(inputArgs)};
+  auto cached = functionCache().withRLock(
+      [&key](auto& cache) -> std::shared_ptr<VectorFunction> {
+        auto it = cache.find(key);
+        return it == cache.end() ? nullptr : it->second;
+      });
+  if (cached) {
+    return cached;
+  }
+
+  auto function = vectorFunctionFactories().withRLock(
+      [&key](auto& functionMap) -> std::shared_ptr<VectorFunction> {
+        auto functionIterator = functionMap.find(key.name);
         return functionIterator == functionMap.end()
             ? nullptr
-            : functionIterator->second.factory(name, inputArgs);
+            : functionIterator->second.factory(key.name, key.args);
       });
+  if (function) {
+    functionCache().withWLock([&](auto& cache) {
+      if (cache.size() >= kMaxCachedFunctions) {
+        cache.clear();
+      }
+      cache.emplace(std::move(key), function);
+    });
+  }
+  return function;
 }
 
 /// Registers a new vector function. When overwrite = true, previous functions
@@ -76,6 +215,8 @@ bool registerStatefulVectorFunction(
       // Insert/overwrite.
       functionMap[name] = {std::move(signatures), std::move(factory)};
     });
+    // Drops the functions made by the replaced factory.
+    functionCache().withWLock([](auto& cache) { cache.clear(); });
     return true;
   }
 
@@ -193,7 +193,11 @@ VectorFunctionFactory makeVectorFunctionFactory() {
 }
 
 // Registers stateful VectorFunction. New instance is created for each
-// expression using input types and optionally constant values for some inputs.
+// combination of input types and optionally constant values for some inputs.
+// Unless a constant is of a complex type, the instance is cached and shared by
+// all expressions, also across queries and threads, that call the function on
+// the same types and constants. The function must therefore be immutable and
+// not refer to the memory of the constant vectors it was made with.
 // When overwrite is true, any previously registered VectorFunction with the
 // name is replaced.
 // Returns true iff the function was inserted
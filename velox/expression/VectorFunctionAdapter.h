@@ -37,6 +37,26 @@ class VectorAdapter : public VectorFunction {
       typename TypeToFlatVector<typename FUNC::return_type>::type;
   std::unique_ptr<FUNC> fn_;
 
+  template <typename U>
+  static constexpr bool isFixedWidthArg() {
+    using traits = CppToType<U>;
+    return traits::isPrimitiveType && traits::isFixedWidth &&
+        traits::typeKind != TypeKind::BOOLEAN;
+  }
+
+  template <size_t... I>
+  static constexpr bool allFixedWidthArgs(std::index_sequence<I...>) {
+    return (isFixedWidthArg<arg_at<I>>() && ...);
+  }
+
+  // True if applyFlat() may run the function. The arguments must have a
+  // fixed width representation in their flat vectors. Booleans are
+  // excluded since their flat vectors are bit packed.
+  static constexpr bool kFlatFastPath = FUNC::num_args > 0 &&
+      return_type_traits::isPrimitiveType &&
+      return_type_traits::isFixedWidth &&
+      allFixedWidthArgs(std::make_index_sequence<FUNC::num_args>{});
+
   struct ApplyContext {
     ApplyContext(
         const SelectivityVector* _rows,
@@ -121,6 +141,15 @@ class VectorAdapter : public VectorFunction {
       applyContext.allAscii = isAsciiArgs(rows, args);
     }
 
+    if constexpr (kFlatFastPath) {
+      if (applyFlat(
+              applyContext,
+              decodedArgs,
+              std::make_index_sequence<FUNC::num_args>{})) {
+        return;
+      }
+    }
+
     unpack<0>(applyContext, true, decodedArgs);
 
     // Check if the function reuses input strings for the result, and add
@@ -192,6 +221,125 @@ class VectorAdapter : public VectorFunction {
     return hasStringArgs && allAscii;
   }
 
+  // Reads an argument of applyFlat() from the raw values of a flat vector
+  // or from the value of a constant.
+  template <typename U>
+  struct FlatArg {
+    explicit FlatArg(const DecodedVector& decoded)
+        : values{decoded.data<U>()},
+          isConstant{decoded.isConstantMapping()},
+          constant{isConstant ? decoded.valueAt<U>(0) : U()} {}
+
+    FOLLY_ALWAYS_INLINE const U& operator[](vector_size_t row) const {
+      return isConstant ? constant : values[row];
+    }
+
+    const U* const values;
+    const bool isConstant;
+    const U constant;
+  };
+
+  // Runs the function in a tight loop over the raw values of its arguments
+  // if all rows are selected and all arguments are flat or non-null
+  // constants. This avoids the per-row decoding, row selection and
+  // exception handling of iterate() and lets the compiler vectorize simple
+  // functions. The nulls of the arguments are merged into the result a
+  // word at a time and the function is not called for null rows. Returns
+  // false if the arguments do not qualify or if the function throws for
+  // some row. iterate() then evaluates all rows again and records the
+  // errors per row.
+  template <size_t... I>
+  bool applyFlat(
+      ApplyContext& applyContext,
+      const DecodedArgs& args,
+      std::index_sequence<I...>) const {
+    const auto& rows = *applyContext.rows;
+    if (!rows.isAllSelected()) {
+      return false;
+    }
+    bool mayHaveNulls = false;
+    for (auto i = 0; i < FUNC::num_args; ++i) {
+      auto* arg = args.at(i);
+      if (arg->isConstantMapping()) {
+        if (arg->isNullAt(0)) {
+          return false;
+        }
+      } else if (!arg->isIdentityMapping()) {
+        return false;
+      } else if (arg->nulls()) {
+        mayHaveNulls = true;
+      }
+    }
+    if (mayHaveNulls && !FUNC::is_default_null_behavior) {
+      return false;
+    }
+
+    auto* result = applyContext.result;
+    uint64_t* nulls = nullptr;
+    // The rows where an argument is null. The function is not called for
+    // these.
+    const uint64_t* argNulls = nullptr;
+    if (mayHaveNulls) {
+      // A row of the result is null if any argument is null for the row.
+      nulls = result->mutableRawNulls();
+      bits::fillBits(nulls, rows.begin(), rows.end(), bits::kNotNull);
+      for (auto i = 0; i < FUNC::num_args; ++i) {
+        auto* arg = args.at(i);
+        if (arg->isIdentityMapping() && arg->nulls()) {
+          bits::andBits(nulls, arg->nulls(), rows.begin(), rows.end());
+        }
+      }
+      argNulls = nulls;
+    }
+
+    std::tuple<FlatArg<exec_arg_at<I>>...> flatArgs{
+        FlatArg<exec_arg_at<I>>(*args.at(I))...};
+    try {
+      if constexpr (return_type_traits::typeKind == TypeKind::BOOLEAN) {
+        // Collects the results for 64 rows at a time into a word.
+        auto* rawBits = result->template mutableRawValues<uint64_t>();
+        for (auto begin = rows.begin(); begin < rows.end(); begin += 64) {
+          auto end = std::min<vector_size_t>(begin + 64, rows.end());
+          uint64_t word = 0;
+          for (auto row = begin; row < end; ++row) {
+            if (argNulls && bits::isBitNull(argNulls, row)) {
+              continue;
+            }
+            bool out = false;
+            if (UNLIKELY(!(*fn_).call(out, std::get<I>(flatArgs)[row]...))) {
+              setNullAt(result, nulls, row);
+            }
+            word |= static_cast<uint64_t>(out) << (row - begin);
+          }
+          auto mask = end - begin == 64 ? ~0UL : bits::lowMask(end - begin);
+          rawBits[begin / 64] = (rawBits[begin / 64] & ~mask) | (word & mask);
+        }
+      } else {
+        auto* data = result->mutableRawValues();
+        for (auto row = rows.begin(); row < rows.end(); ++row) {
+          if (argNulls && bits::isBitNull(argNulls, row)) {
+            continue;
+          }
+          if (UNLIKELY(
+                  !(*fn_).call(data[row], std::get<I>(flatArgs)[row]...))) {
+            setNullAt(result, nulls, row);
+          }
+        }
+      }
+    } catch (const std::exception&) {
+      return false;
+    }
+    return true;
+  }
+
+  static void
+  setNullAt(result_vector_t* result, uint64_t*& nulls, vector_size_t row) {
+    if (!nulls) {
+      nulls = result->mutableRawNulls();
+    }
+    bits::setNull(nulls, row);
+  }
+
   template <
       int32_t POSITION,
       typename... TReader,
@@ -465,6 +465,60 @@ TEST_F(CastExprTest, errorHandling) {
       "tinyint", {"1", "2", "3", "100", "-100.5"}, {1, 2, 3, 100, -100}, true);
 }
 
+TEST_F(CastExprTest, tryErrors) {
+  // Invalid input under TRY produces nulls, with and without truncation.
+  auto strings = makeRowVector({makeNullableFlatVector<std::string>(
+      {"1", "2x", "", "-", "127", "128", std::nullopt})});
+  auto expected = makeNullableFlatVector<int8_t>(
+      {1, std::nullopt, std::nullopt, std::nullopt, 127, std::nullopt,
+       std::nullopt});
+  for (auto truncate : {false, true}) {
+    setCastIntByTruncate(truncate);
+    auto result =
+        evaluate<FlatVector<int8_t>>("try(cast(c0 as tinyint))", strings);
+    assertEqualVectors(expected, result);
+    EXPECT_THROW(
+        evaluate<FlatVector<int8_t>>("cast(c0 as tinyint)", strings),
+        std::exception);
+  }
+  setCastIntByTruncate(false);
+
+  // NaN and out of range values have no integral value.
+  auto doubles = makeRowVector({makeFlatVector<double>(
+      {1.5, std::nan(""), 1e10, -2.4})});
+  auto result =
+      evaluate<FlatVector<int32_t>>("try(cast(c0 as integer))", doubles);
+  assertEqualVectors(
+      makeNullableFlatVector<int32_t>({2, std::nullopt, std::nullopt, -2}),
+      result);
+}
+
+TEST_F(CastExprTest, dictionaryInput) {
+  // Casts the distinct values of a dictionary once. The errors are reported
+  // for the rows that refer to an invalid value.
+  auto data = makeRowVector({makeNullableFlatVector<std::string>(
+      {"1", " 2", "x", std::nullopt, "-5", "1.5", "100000"})});
+  auto expected = makeNullableFlatVector<int32_t>(
+      {100000, std::nullopt, -5, std::nullopt, std::nullopt, 2, 1});
+  auto result = evaluate<FlatVector<int32_t>>(
+      "try(cast(testing_dictionary(c0) as integer))", data);
+  assertEqualVectors(expected, result);
+  result = evaluate<FlatVector<int32_t>>(
+      "try_cast(testing_dictionary(c0) as integer)", data);
+  assertEqualVectors(expected, result);
+  EXPECT_THROW(
+      evaluate<FlatVector<int32_t>>(
+          "cast(testing_dictionary(c0) as integer)", data),
+      std::exception);
+
+  auto doubles = evaluate<FlatVector<double>>(
+      "try(cast(testing_dictionary(c0) as double))", data);
+  assertEqualVectors(
+      makeNullableFlatVector<double>(
+          {100000, 1.5, -5, std::nullopt, std::nullopt, 2, 1}),
+      doubles);
+}
+
 constexpr vector_size_t kVectorSize = 1'000;
 
 TEST_F(CastExprTest, mapCast) {
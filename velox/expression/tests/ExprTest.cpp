@@ -930,6 +930,28 @@ TEST_F(ExprTest, reorder) {
   }
 }
 
+TEST_F(ExprTest, reorderUnmeasured) {
+  // The first conjunct is false for all rows, so the others never see any
+  // rows. They must not move in front of it for looking free.
+  auto data = makeRowVector(
+      {makeFlatVector<int64_t>(1'000, [](auto row) { return row; })});
+  auto exprSet = compileExpression(
+      "c0 < 0 and c0 % 7 = 1 and c0 % 11 = 2",
+      std::dynamic_pointer_cast<const RowType>(data->type()));
+  auto condition =
+      std::dynamic_pointer_cast<exec::ConjunctExpr>(exprSet->expr(0));
+  ASSERT_TRUE(condition != nullptr);
+  for (auto i = 0; i < 3; ++i) {
+    auto result = evaluate(exprSet.get(), data);
+    assertEqualVectors(
+        makeFlatVector<bool>(1'000, [](auto /*row*/) { return false; }),
+        result);
+  }
+  EXPECT_EQ(3'000, condition->selectivityAt(0).numIn());
+  EXPECT_EQ(0, condition->selectivityAt(1).numIn());
+  EXPECT_EQ(0, condition->selectivityAt(2).numIn());
+}
+
 TEST_F(ExprTest, constant) {
   auto expr = compileExpression("1 + 2 + 3 + 4");
   auto constExpr = dynamic_cast<exec::ConstantExpr*>(expr);
@@ -1328,6 +1350,48 @@ TEST_F(ExprTest, cseEncodings) {
   assertEqualVectors(expected, results[1]);
 }
 
+TEST_F(ExprTest, fusedJsonExtract) {
+  auto json = makeNullableFlatVector<std::string>(
+      {"{\"a\": 1, \"b\": \"x\"}",
+       std::nullopt,
+       "{\"b\": [1], \"c\": {\"d\": 2.5}}",
+       "not json"});
+  auto input = makeRowVector({json});
+  std::vector<std::string> texts = {
+      "json_extract_scalar(c0, '$.a')",
+      "concat(json_extract_scalar(c0, '$.b'), '!')",
+      "json_extract_scalar(c0, '$.c.d')",
+      "json_extract_scalar(c0, '$.a')"};
+
+  auto rowType = std::dynamic_pointer_cast<const RowType>(input->type());
+  std::vector<std::shared_ptr<const core::ITypedExpr>> expressions;
+  for (const auto& text : texts) {
+    expressions.emplace_back(parseExpression(text, rowType));
+  }
+  exec::ExprSet exprSet(std::move(expressions), execCtx_.get());
+  // The calls share one json_extract_scalar_multi.
+  auto fused = exprSet.expr(0)->inputs()[0];
+  ASSERT_EQ("json_extract_scalar_multi", fused->name());
+  ASSERT_EQ(fused, exprSet.expr(1)->inputs()[0]->inputs()[0]);
+  ASSERT_EQ(fused, exprSet.expr(2)->inputs()[0]);
+  ASSERT_EQ(exprSet.expr(0), exprSet.expr(3));
+
+  auto results = evaluateMultiple(texts, input);
+  assertEqualVectors(
+      makeNullableFlatVector<std::string>(
+          {"1", std::nullopt, std::nullopt, std::nullopt}),
+      results[0]);
+  assertEqualVectors(
+      makeNullableFlatVector<std::string>(
+          {"x!", std::nullopt, std::nullopt, std::nullopt}),
+      results[1]);
+  assertEqualVectors(
+      makeNullableFlatVector<std::string>(
+          {std::nullopt, std::nullopt, "2.5", std::nullopt}),
+      results[2]);
+  assertEqualVectors(results[0], results[3]);
+}
+
 namespace {
 class AddSuffixFunction : public exec::VectorFunction {
  public:
@@ -1590,6 +1654,41 @@ TEST_F(ExprTest, selectiveLazyLoadingIf) {
   assertEqualVectors(expected, result);
 }
 
+TEST_F(ExprTest, lazyLoadingInBranches) {
+  const vector_size_t size = 1'000;
+  auto valueAt = [](auto row) { return row; };
+  auto rowType = ROW(
+      {"c0", "c1", "c2", "c3"}, {BIGINT(), BIGINT(), BIGINT(), BIGINT()});
+  auto exprSet = compileExpression(
+      "if (c0 % 2 = 0, c1 + c2, if (c0 % 3 = 0, c3, c2 / 3))", rowType);
+  exprSet->enableLazyLoadingInBranches({});
+
+  // c1 is loaded only for the even rows and c3 only for the odd multiples
+  // of 3. c0 and c2 are referenced outside of a single branch and are
+  // loaded for all rows.
+  auto all = [](auto row) { return row; };
+  auto c0 = makeLazyFlatVector<int64_t>(size, valueAt, nullptr, size, all);
+  auto c1 = makeLazyFlatVector<int64_t>(
+      size, valueAt, nullptr, size / 2, [](auto row) { return row * 2; });
+  auto c2 = makeLazyFlatVector<int64_t>(size, valueAt, nullptr, size, all);
+  auto c3 = makeLazyFlatVector<int64_t>(
+      size, valueAt, nullptr, 167, [](auto row) { return row * 6 + 3; });
+
+  auto result = evaluate(exprSet.get(), makeRowVector({c0, c1, c2, c3}));
+  auto expected = makeFlatVector<int64_t>(size, [](auto row) {
+    return row % 2 == 0 ? row + row : (row % 3 == 0 ? row : row / 3);
+  });
+  assertEqualVectors(expected, result);
+
+  // A column that the caller reads after evaluation is loaded for all rows.
+  exprSet = compileExpression("if (c0 % 2 = 0, c1, c0)", rowType);
+  exprSet->enableLazyLoadingInBranches({"c1"});
+  c0 = makeLazyFlatVector<int64_t>(size, valueAt, nullptr, size, all);
+  c1 = makeLazyFlatVector<int64_t>(size, valueAt, nullptr, size, all);
+  result = evaluate(exprSet.get(), makeRowVector({c0, c1, c2, c3}));
+  assertEqualVectors(makeFlatVector<int64_t>(size, valueAt), result);
+}
+
 namespace {
 class StatefulVectorFunction : public exec::VectorFunction {
  public:
@@ -1659,6 +1758,41 @@ TEST_F(ExprTest, statefulVectorFunctions) {
   }
 }
 
+TEST_F(ExprTest, cachedStatefulVectorFunctions) {
+  static int32_t numCreated;
+  numCreated = 0;
+  exec::registerStatefulVectorFunction(
+      "counted_function",
+      StatefulVectorFunction::signatures(),
+      [](const auto& name, const auto& inputArgs) {
+        ++numCreated;
+        return std::make_shared<StatefulVectorFunction>(name, inputArgs);
+      });
+
+  auto row = makeRowVector({
+      makeFlatVector<int64_t>(100, [](auto row) { return row; }),
+      makeFlatVector<int64_t>(100, [](auto row) { return row * 2; }),
+  });
+
+  // Expressions that call the function on the same types and constants share
+  // the function instance.
+  evaluate("counted_function(c0)", row);
+  evaluate("counted_function(c0)", row);
+  EXPECT_EQ(1, numCreated);
+
+  evaluate("counted_function(c0, c1)", row);
+  EXPECT_EQ(2, numCreated);
+
+  evaluate("counted_function(c0, 'abc')", row);
+  evaluate("counted_function(c0, 'abc')", row);
+  EXPECT_EQ(3, numCreated);
+
+  auto result = evaluate("counted_function(c0, 'abcd')", row);
+  EXPECT_EQ(4, numCreated);
+  assertEqualVectors(
+      makeFlatVector<int32_t>(100, [](auto /*row*/) { return 2; }), result);
+}
+
 struct OpaqueState {
   static int constructed;
   static int destructed;
@@ -2352,6 +2486,44 @@ TEST_F(ExprTest, accessNestedDictionaryEncoding) {
   assertEqualVectors(makeFlatVector<int32_t>({5, 4, 3, 2, 1}), result);
 }
 
+TEST_F(ExprTest, decodedFieldSharing) {
+  vector_size_t size = 100;
+  auto flat = makeFlatVector<int32_t>(size, [](auto row) { return row; });
+  auto dictionary = wrapInDictionary(
+      makeIndices(size, [&](auto row) { return size - 1 - row; }), size, flat);
+  auto other = wrapInDictionary(
+      makeIndices(size, [](auto row) { return row; }), size, flat);
+  auto data = makeRowVector({flat, dictionary});
+  exec::EvalCtx context(execCtx_.get(), nullptr, data.get());
+
+  // Flat fields and vectors that are not fields are not shared.
+  SelectivityVector rows(size / 2);
+  EXPECT_EQ(nullptr, context.decodedField(flat, rows));
+  EXPECT_EQ(nullptr, context.decodedField(other, rows));
+
+  // A dictionary field is decoded once for all rows seen so far.
+  auto decoded = context.decodedField(dictionary, rows);
+  ASSERT_NE(nullptr, decoded);
+  EXPECT_EQ(decoded, context.decodedField(dictionary, rows));
+  SelectivityVector someRows(size / 2, false);
+  someRows.setValid(10, true);
+  someRows.updateBounds();
+  EXPECT_EQ(decoded, context.decodedField(dictionary, someRows));
+  EXPECT_EQ(size - 11, decoded->valueAt<int32_t>(10));
+
+  SelectivityVector allRows(size);
+  decoded = context.decodedField(dictionary, allRows);
+  for (auto i = 0; i < size; ++i) {
+    EXPECT_EQ(size - 1 - i, decoded->valueAt<int32_t>(i));
+  }
+
+  auto result = evaluate("c1 + c1 * 2", data);
+  assertEqualVectors(
+      makeFlatVector<int32_t>(
+          size, [&](auto row) { return (size - 1 - row) * 3; }),
+      result);
+}
+
 TEST_F(ExprTest, accessNestedConstantEncoding) {
   // Construct Row(Row(Row(int))) vector
   VectorPtr base = makeFlatVector<int32_t>({1, 2, 3, 4, 5});
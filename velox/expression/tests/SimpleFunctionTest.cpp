@@ -728,3 +728,70 @@ TEST_F(SimpleFunctionTest, arrayStringReuse) {
 }
 
 } // namespace
+
+// Returns null for odd results. Throws for a negative first argument.
+template <typename T>
+struct EvenSumFunction {
+  VELOX_DEFINE_FUNCTION_TYPES(T);
+
+  FOLLY_ALWAYS_INLINE bool
+  call(int64_t& out, const int64_t& left, const int64_t& right) {
+    VELOX_USER_CHECK_GE(left, 0);
+    out = left + right;
+    return out % 2 == 0;
+  }
+};
+
+template <typename T>
+struct LessThanFunction {
+  VELOX_DEFINE_FUNCTION_TYPES(T);
+
+  FOLLY_ALWAYS_INLINE bool
+  call(bool& out, const int64_t& left, const int64_t& right) {
+    out = left < right;
+    return true;
+  }
+};
+
+// Covers the loop over the raw values of flat and constant arguments.
+TEST_F(SimpleFunctionTest, flatArguments) {
+  registerFunction<EvenSumFunction, int64_t, int64_t, int64_t>({"even_sum"});
+  registerFunction<LessThanFunction, bool, int64_t, int64_t>({"less_than"});
+
+  auto data = makeRowVector({
+      makeFlatVector<int64_t>(
+          1'000, [](auto row) { return row; }, nullEvery(7)),
+      makeFlatVector<int64_t>(1'000, [](auto row) { return row * 2; }),
+  });
+
+  auto result = evaluate("even_sum(c0, c1)", data);
+  assertEqualVectors(
+      makeFlatVector<int64_t>(
+          1'000,
+          [](auto row) { return row * 3; },
+          [](auto row) { return row % 7 == 0 || row % 2 == 1; }),
+      result);
+
+  result = evaluate("even_sum(c0, 10)", data);
+  assertEqualVectors(
+      makeFlatVector<int64_t>(
+          1'000,
+          [](auto row) { return row + 10; },
+          [](auto row) { return row % 7 == 0 || row % 2 == 1; }),
+      result);
+
+  // The boolean results span several words.
+  result = evaluate("less_than(c0, 500)", data);
+  assertEqualVectors(
+      makeFlatVector<bool>(
+          1'000, [](auto row) { return row < 500; }, nullEvery(7)),
+      result);
+
+  // An error in one row is reported like without the loop.
+  auto negative = makeRowVector({
+      makeFlatVector<int64_t>(
+          1'000, [](auto row) { return row == 123 ? -1 : row; }),
+      makeFlatVector<int64_t>(1'000, [](auto row) { return row; }),
+  });
+  EXPECT_THROW(evaluate("even_sum(c0, c1)", negative), VeloxUserError);
+}
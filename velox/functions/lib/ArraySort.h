@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace facebook::velox::functions {
+
+namespace detail {
+
+template <typename T>
+using RadixKey = std::conditional_t<
+    sizeof(T) == 8,
+    uint64_t,
+    std::conditional_t<
+        sizeof(T) == 4,
+        uint32_t,
+        std::conditional_t<sizeof(T) == 2, uint16_t, uint8_t>>>;
+
+template <typename T>
+constexpr RadixKey<T> kRadixSignBit = RadixKey<T>{1} << (sizeof(T) * 8 - 1);
+
+// Maps 'value' to an unsigned key with the same order. NaNs are not
+// expected.
+template <typename T>
+RadixKey<T> toRadixKey(T value) {
+  RadixKey<T> bits;
+  memcpy(&bits, &value, sizeof(T));
+  if constexpr (std::is_floating_point_v<T>) {
+    return (bits & kRadixSignBit<T>) ? static_cast<RadixKey<T>>(~bits)
+                                     : bits | kRadixSignBit<T>;
+  } else if constexpr (std::is_signed_v<T>) {
+    return bits ^ kRadixSignBit<T>;
+  } else {
+    return bits;
+  }
+}
+
+template <typename T>
+T fromRadixKey(RadixKey<T> key) {
+  RadixKey<T> bits;
+  if constexpr (std::is_floating_point_v<T>) {
+    bits = (key & kRadixSignBit<T>) ? key & ~kRadixSignBit<T>
+                                    : static_cast<RadixKey<T>>(~key);
+  } else if constexpr (std::is_signed_v<T>) {
+    bits = key ^ kRadixSignBit<T>;
+  } else {
+    bits = key;
+  }
+  T value;
+  memcpy(&value, &bits, sizeof(T));
+  return value;
+}
+
+// Sorting networks of Batcher's odd-even merge sort.
+constexpr std::pair<uint8_t, uint8_t> kSortNetwork8[] = {
+    {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6},
+    {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5},
+    {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+
+constexpr std::pair<uint8_t, uint8_t> kSortNetwork16[] = {
+    {0, 1},   {2, 3},   {4, 5},   {6, 7},   {8, 9},   {10, 11}, {12, 13},
+    {14, 15}, {0, 2},   {1, 3},   {4, 6},   {5, 7},   {8, 10},  {9, 11},
+    {12, 14}, {13, 15}, {1, 2},   {5, 6},   {9, 10},  {13, 14}, {0, 4},
+    {1, 5},   {2, 6},   {3, 7},   {8, 12},  {9, 13},  {10, 14}, {11, 15},
+    {2, 4},   {3, 5},   {10, 12}, {11, 13}, {1, 2},   {3, 4},   {5, 6},
+    {9, 10},  {11, 12}, {13, 14}, {0, 8},   {1, 9},   {2, 10},  {3, 11},
+    {4, 12},  {5, 13},  {6, 14},  {7, 15},  {4, 8},   {5, 9},   {6, 10},
+    {7, 11},  {2, 4},   {3, 5},   {6, 8},   {7, 9},   {10, 12}, {11, 13},
+    {1, 2},   {3, 4},   {5, 6},   {7, 8},   {9, 10},  {11, 12}, {13, 14}};
+
+// Sorts 'size' <= N values with the sorting network for N values. The
+// missing values are padded with the largest value of T, which sorts after
+// all others. The compare and exchange steps compile to conditional moves.
+template <int32_t N, typename T, size_t M>
+void networkSort(
+    T* values,
+    size_t size,
+    const std::pair<uint8_t, uint8_t> (&network)[M]) {
+  T padded[N];
+  std::copy(values, values + size, padded);
+  std::fill(
+      padded + size,
+      padded + N,
+      std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                           : std::numeric_limits<T>::max());
+  for (auto [i, j] : network) {
+    auto a = padded[i];
+    auto b = padded[j];
+    // Not std::min and std::max, which would turn 0.0 and -0.0 into two
+    // copies of the same one.
+    bool swap = b < a;
+    padded[i] = swap ? b : a;
+    padded[j] = swap ? a : b;
+  }
+  std::copy(padded, padded + size, values);
+}
+
+} // namespace detail
+
+// Sorts arrays of fixed width numbers without calls through comparators.
+// NaNs order after all other values, as in both Presto and Spark. Nulls are
+// left to the caller, since the dialects place them differently. Arrays of
+// at most 16 values use sorting networks, long ones a radix sort and the
+// others std::sort with plain '<' once the NaNs are moved aside. Meant to be
+// kept for all rows of a vector, so that the radix sort reuses its memory.
+template <typename T>
+class FixedWidthSorter {
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+
+ public:
+  // Arrays of at least this many values use the radix sort.
+  static constexpr size_t kMinRadixSortSize{256};
+
+  void sort(T* begin, T* end, bool descending) {
+    auto numbersEnd = end;
+    if constexpr (std::is_floating_point_v<T>) {
+      numbersEnd = std::partition(
+          begin, end, [](T value) { return !std::isnan(value); });
+    }
+    sortAscending(begin, numbersEnd - begin);
+    if (descending) {
+      std::reverse(begin, end);
+    }
+  }
+
+ private:
+  void sortAscending(T* values, size_t size) {
+    if (size <= 1) {
+      return;
+    }
+    if (size <= 8) {
+      detail::networkSort<8>(values, size, detail::kSortNetwork8);
+    } else if (size <= 16) {
+      detail::networkSort<16>(values, size, detail::kSortNetwork16);
+    } else if (size >= kMinRadixSortSize) {
+      radixSort(values, size);
+    } else {
+      std::sort(values, values + size);
+    }
+  }
+
+  // Least significant digit first radix sort on bytes. Skips the bytes that
+  // are the same in all values, e.g. the high bytes of small integers.
+  void radixSort(T* values, size_t size) {
+    keys_.resize(size);
+    temp_.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+      keys_[i] = detail::toRadixKey(values[i]);
+    }
+    auto* from = keys_.data();
+    auto* to = temp_.data();
+    for (size_t shift = 0; shift < sizeof(T) * 8; shift += 8) {
+      std::array<size_t, 256> counts{};
+      for (size_t i = 0; i < size; ++i) {
+        ++counts[(from[i] >> shift) & 0xff];
+      }
+      if (counts[(from[0] >> shift) & 0xff] == size) {
+        continue;
+      }
+      size_t offset = 0;
+      for (auto& count : counts) {
+        auto next = offset + count;
+        count = offset;
+        offset = next;
+      }
+      for (size_t i = 0; i < size; ++i) {
+        to[counts[(from[i] >> shift) & 0xff]++] = from[i];
+      }
+      std::swap(from, to);
+    }
+    for (size_t i = 0; i < size; ++i) {
+      values[i] = detail::fromRadixKey<T>(from[i]);
+    }
+  }
+
+  std::vector<detail::RadixKey<T>> keys_;
+  std::vector<detail::RadixKey<T>> temp_;
+};
+
+} // namespace facebook::velox::functions
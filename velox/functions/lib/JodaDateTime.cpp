@@ -65,6 +65,44 @@ inline JodaFormatSpecifier getSpecifier(char c) {
   return it->second;
 }
 
+inline bool isFixedWidthSpecifier(JodaFormatSpecifier specifier) {
+  switch (specifier) {
+    case JodaFormatSpecifier::YEAR_OF_ERA:
+    case JodaFormatSpecifier::MONTH_OF_YEAR:
+    case JodaFormatSpecifier::DAY_OF_MONTH:
+    case JodaFormatSpecifier::HOUR_OF_DAY:
+    case JodaFormatSpecifier::MINUTE_OF_HOUR:
+    case JodaFormatSpecifier::SECOND_OF_MINUTE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if inputs matching the format width can be parsed by reading
+// exactly `count` digits per pattern token. Since the generic parser consumes
+// digits greedily, this only holds when every pattern is followed by the end
+// of the input or by a literal which doesn't start with a digit.
+bool isFixedWidth(
+    const std::vector<std::string_view>& literals,
+    const std::vector<JodaFormatSpecifier>& patterns,
+    const std::vector<size_t>& counts) {
+  if (patterns.empty()) {
+    return false;
+  }
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    // Keep the accumulated value within the range of int32_t.
+    if (!isFixedWidthSpecifier(patterns[i]) || counts[i] > 9) {
+      return false;
+    }
+    const auto& next = literals[i + 1];
+    if (next.empty() ? i + 1 < patterns.size() : characterIsDigit(next[0])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 } // namespace
 
 void JodaFormatter::initialize() {
@@ -114,6 +152,10 @@ void JodaFormatter::initialize() {
     literalTokens_.emplace_back("");
   }
   VELOX_CHECK_EQ(literalTokens_.size(), patternTokens_.size() + 1);
+
+  if (isFixedWidth(literalTokens_, patternTokens_, patternTokensCount_)) {
+    fixedWidthSize_ = format_.size();
+  }
 }
 
 namespace {
@@ -176,10 +218,139 @@ parseTimezoneOffset(const char* cur, const char* end, JodaDate& jodaDate) {
   throw std::runtime_error("Unable to parse timezone offset id.");
 }
 
+void applyNumber(
+    JodaFormatSpecifier specifier,
+    uint64_t number,
+    JodaDate& jodaDate) {
+  switch (specifier) {
+    case JodaFormatSpecifier::YEAR_OF_ERA:
+      jodaDate.year = number;
+      break;
+
+    case JodaFormatSpecifier::MONTH_OF_YEAR:
+      jodaDate.month = number;
+
+      // Joda has this weird behavior where it returns 1970 as the year by
+      // default (if no year is specified), but if either day or month are
+      // specified, it fallsback to 2000.
+      if (jodaDate.year == -1) {
+        jodaDate.year = 2000;
+      }
+      break;
+
+    case JodaFormatSpecifier::DAY_OF_MONTH:
+      jodaDate.day = number;
+      if (jodaDate.year == -1) {
+        jodaDate.year = 2000;
+      }
+      break;
+
+    case JodaFormatSpecifier::HOUR_OF_DAY:
+      jodaDate.hour = number;
+      break;
+
+    case JodaFormatSpecifier::MINUTE_OF_HOUR:
+      jodaDate.minute = number;
+      break;
+
+    case JodaFormatSpecifier::SECOND_OF_MINUTE:
+      jodaDate.second = number;
+      break;
+
+    default:
+      VELOX_NYI("Numeric Joda specifier not implemented yet.");
+  }
+}
+
+// Fast path for fixed width formats (see isFixedWidth()). Expects the input
+// size to match the format size; returns false if any literal or digit
+// doesn't match, in which case the generic parser produces the error.
+bool parseFixedWidth(
+    const std::vector<std::string_view>& literals,
+    const std::vector<JodaFormatSpecifier>& patterns,
+    const std::vector<size_t>& counts,
+    const std::string& input,
+    JodaDate& jodaDate) {
+  const char* cur = input.data();
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    const auto& literal = literals[i];
+    if (std::memcmp(cur, literal.data(), literal.size()) != 0) {
+      return false;
+    }
+    cur += literal.size();
+
+    uint64_t number = 0;
+    for (size_t j = 0; j < counts[i]; ++j) {
+      uint8_t digit = cur[j] - '0';
+      if (digit > 9) {
+        return false;
+      }
+      number = number * 10 + digit;
+    }
+    cur += counts[i];
+    applyNumber(patterns[i], number, jodaDate);
+  }
+  const auto& last = literals.back();
+  return std::memcmp(cur, last.data(), last.size()) == 0;
+}
+
+JodaResult toJodaResult(JodaDate& jodaDate) {
+  // Date time validations for Joda compatibility. Additional date checks will
+  // be performed below when converting it to timestamp.
+  if (jodaDate.year == -1) {
+    jodaDate.year = 1970;
+  }
+
+  // Enforce Joda's year range.
+  if (jodaDate.year > 294247 || jodaDate.year < 1) {
+    VELOX_USER_FAIL(
+        "Value {} for yearOfEra must be in the range [1,294247]",
+        jodaDate.year);
+  }
+
+  if (jodaDate.hour > 23 || jodaDate.hour < 0) {
+    VELOX_USER_FAIL(
+        "Value {} for hourOfDay must be in the range [0,23]", jodaDate.hour);
+  }
+
+  if (jodaDate.minute > 59 || jodaDate.minute < 0) {
+    VELOX_USER_FAIL(
+        "Value {} for minuteOfHour must be in the range [0,59]",
+        jodaDate.minute);
+  }
+
+  if (jodaDate.second > 59 || jodaDate.second < 0) {
+    VELOX_USER_FAIL(
+        "Value {} for secondOfMinute must be in the range [0,59]",
+        jodaDate.second);
+  }
+
+  // Convert the parsed date/time into a timestamp.
+  int32_t daysSinceEpoch =
+      util::fromDate(jodaDate.year, jodaDate.month, jodaDate.day);
+  int64_t microsSinceMidnight = util::fromTime(
+      jodaDate.hour, jodaDate.minute, jodaDate.second, jodaDate.microsecond);
+  return {
+      util::fromDatetime(daysSinceEpoch, microsSinceMidnight),
+      jodaDate.timezoneId};
+}
+
 } // namespace
 
 JodaResult JodaFormatter::parse(const std::string& input) {
   JodaDate jodaDate;
+  if (fixedWidthSize_ != 0 && input.size() == fixedWidthSize_ &&
+      parseFixedWidth(
+          literalTokens_,
+          patternTokens_,
+          patternTokensCount_,
+          input,
+          jodaDate)) {
+    return toJodaResult(jodaDate);
+  }
+
+  // Fall back to the generic path, discarding anything set by the fast path.
+  jodaDate = JodaDate();
   const char* cur = input.data();
   const char* end = cur + input.size();
 
@@ -213,44 +384,7 @@ JodaResult JodaFormatter::parse(const std::string& input) {
           parseFail(input, cur, end);
         }
 
-        switch (curPattern) {
-          case JodaFormatSpecifier::YEAR_OF_ERA:
-            jodaDate.year = number;
-            break;
-
-          case JodaFormatSpecifier::MONTH_OF_YEAR:
-            jodaDate.month = number;
-
-            // Joda has this weird behavior where it returns 1970 as the year by
-            // default (if no year is specified), but if either day or month are
-            // specified, it fallsback to 2000.
-            if (jodaDate.year == -1) {
-              jodaDate.year = 2000;
-            }
-            break;
-
-          case JodaFormatSpecifier::DAY_OF_MONTH:
-            jodaDate.day = number;
-            if (jodaDate.year == -1) {
-              jodaDate.year = 2000;
-            }
-            break;
-
-          case JodaFormatSpecifier::HOUR_OF_DAY:
-            jodaDate.hour = number;
-            break;
-
-          case JodaFormatSpecifier::MINUTE_OF_HOUR:
-            jodaDate.minute = number;
-            break;
-
-          case JodaFormatSpecifier::SECOND_OF_MINUTE:
-            jodaDate.second = number;
-            break;
-
-          default:
-            VELOX_NYI("Numeric Joda specifier not implemented yet.");
-        }
+        applyNumber(curPattern, number, jodaDate);
       } else {
         try {
           cur += parseTimezoneOffset(cur, end, jodaDate);
@@ -265,45 +399,7 @@ JodaResult JodaFormatter::parse(const std::string& input) {
   if (cur < end) {
     parseFail(input, cur, end);
   }
-
-  // Date time validations for Joda compatibility. Additional date checks will
-  // be performed below when converting it to timestamp.
-  if (jodaDate.year == -1) {
-    jodaDate.year = 1970;
-  }
-
-  // Enforce Joda's year range.
-  if (jodaDate.year > 294247 || jodaDate.year < 1) {
-    VELOX_USER_FAIL(
-        "Value {} for yearOfEra must be in the range [1,294247]",
-        jodaDate.year);
-  }
-
-  if (jodaDate.hour > 23 || jodaDate.hour < 0) {
-    VELOX_USER_FAIL(
-        "Value {} for hourOfDay must be in the range [0,23]", jodaDate.hour);
-  }
-
-  if (jodaDate.minute > 59 || jodaDate.minute < 0) {
-    VELOX_USER_FAIL(
-        "Value {} for minuteOfHour must be in the range [0,59]",
-        jodaDate.minute);
-  }
-
-  if (jodaDate.second > 59 || jodaDate.second < 0) {
-    VELOX_USER_FAIL(
-        "Value {} for secondOfMinute must be in the range [0,59]",
-        jodaDate.second);
-  }
-
-  // Convert the parsed date/time into a timestamp.
-  int32_t daysSinceEpoch =
-      util::fromDate(jodaDate.year, jodaDate.month, jodaDate.day);
-  int64_t microsSinceMidnight = util::fromTime(
-      jodaDate.hour, jodaDate.minute, jodaDate.second, jodaDate.microsecond);
-  return {
-      util::fromDatetime(daysSinceEpoch, microsSinceMidnight),
-      jodaDate.timezoneId};
+  return toJodaResult(jodaDate);
 }
 
 } // namespace facebook::velox::functions
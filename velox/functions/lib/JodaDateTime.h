@@ -145,6 +145,12 @@ class JodaFormatter {
   // Stores the number of times each pattern token was read, e.g: "Y" (1) vs
   // "YYYY" (4).
   std::vector<size_t> patternTokensCount_;
+
+  // If every pattern token is numeric and followed by a literal starting with
+  // a non-digit (or the end of the format), inputs of exactly this size are
+  // parsed by a straight-line fast path which reads `patternTokensCount_`
+  // digits per token. Zero if the format doesn't qualify.
+  size_t fixedWidthSize_{0};
 };
 
 } // namespace facebook::velox::functions
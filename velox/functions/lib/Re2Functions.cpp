@@ -15,9 +15,13 @@
  */
 #include "velox/functions/lib/Re2Functions.h"
 
+#include <folly/container/F14Map.h>
 #include <re2/re2.h>
+#include <cstring>
+#include <list>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "velox/expression/EvalCtx.h"
 #include "velox/expression/Expr.h"
@@ -68,6 +72,58 @@ void checkForBadPattern(const RE2& re) {
   }
 }
 
+// Compiled patterns of a non-constant pattern argument, kept in least
+// recently used order. Patterns tend to repeat across rows, e.g. when they
+// come from a small dimension table, so this avoids compiling the same
+// pattern for every row. The cache is bounded by an estimate of the memory
+// held by the compiled programs. Instances are not thread-safe; each
+// function instance owns its own cache.
+class Re2Cache {
+ public:
+  // Returns the compiled 'pattern'. Throws on an invalid pattern, which is
+  // not cached.
+  const RE2& get(StringView pattern) {
+    std::string_view key(pattern.data(), pattern.size());
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return *it->second->re;
+    }
+
+    auto re = std::make_unique<RE2>(toStringPiece(pattern), RE2::Quiet);
+    checkForBadPattern(*re);
+    auto bytes = pattern.size() + re->ProgramSize() * kBytesPerInstruction;
+    entries_.push_front({std::string(key), std::move(re), bytes});
+    index_[entries_.front().pattern] = entries_.begin();
+    totalBytes_ += bytes;
+
+    // Evict the least recently used patterns, but always keep the new one.
+    while (totalBytes_ > kMaxBytes && entries_.size() > 1) {
+      auto& last = entries_.back();
+      totalBytes_ -= last.bytes;
+      index_.erase(last.pattern);
+      entries_.pop_back();
+    }
+    return *entries_.front().re;
+  }
+
+ private:
+  // Rough size of one instruction of a compiled RE2 program.
+  static constexpr size_t kBytesPerInstruction = 16;
+  static constexpr size_t kMaxBytes = 8 << 20;
+
+  struct Entry {
+    std::string pattern;
+    std::unique_ptr<RE2> re;
+    size_t bytes;
+  };
+
+  std::list<Entry> entries_;
+  // Keys point to the patterns in 'entries_'.
+  folly::F14FastMap<std::string_view, std::list<Entry>::iterator> index_;
+  size_t totalBytes_{0};
+};
+
 FlatVector<bool>& ensureWritableBool(
     const SelectivityVector& rows,
     velox::memory::MemoryPool* pool,
@@ -229,11 +285,13 @@ class Re2Match final : public VectorFunction {
     exec::LocalDecodedVector toSearch(context, *args[0], rows);
     exec::LocalDecodedVector pattern(context, *args[1], rows);
     rows.applyToSelected([&](vector_size_t row) {
-      RE2 re(toStringPiece(pattern->valueAt<StringView>(row)), RE2::Quiet);
-      checkForBadPattern(re);
+      const RE2& re = cache_.get(pattern->valueAt<StringView>(row));
       result.set(row, Fn(toSearch->valueAt<StringView>(row), re));
     });
   }
+
+ private:
+  mutable Re2Cache cache_;
 };
 
 void checkForBadGroupId(int groupId, const RE2& re) {
@@ -351,8 +409,7 @@ class Re2SearchAndExtract final : public VectorFunction {
     if (args.size() == 2) {
       groups.resize(1);
       rows.applyToSelected([&](vector_size_t i) {
-        RE2 re(toStringPiece(pattern->valueAt<StringView>(i)), RE2::Quiet);
-        checkForBadPattern(re);
+        const RE2& re = cache_.get(pattern->valueAt<StringView>(i));
         mustRefSourceStrings |=
             re2Extract(result, i, re, toSearch, groups, 0, emptyNoMatch_);
       });
@@ -360,8 +417,7 @@ class Re2SearchAndExtract final : public VectorFunction {
       exec::LocalDecodedVector groupIds(context, *args[2], rows);
       rows.applyToSelected([&](vector_size_t i) {
         const auto groupId = groupIds->valueAt<T>(i);
-        RE2 re(toStringPiece(pattern->valueAt<StringView>(i)), RE2::Quiet);
-        checkForBadPattern(re);
+        const RE2& re = cache_.get(pattern->valueAt<StringView>(i));
         checkForBadGroupId(groupId, re);
         groups.resize(groupId + 1);
         mustRefSourceStrings |=
@@ -375,6 +431,7 @@ class Re2SearchAndExtract final : public VectorFunction {
 
  private:
   const bool emptyNoMatch_;
+  mutable Re2Cache cache_;
 };
 
 class LikeConstantPattern final : public VectorFunction {
@@ -430,6 +487,121 @@ class LikeConstantPattern final : public VectorFunction {
   bool validPattern_;
 };
 
+// Kinds of LIKE patterns that are matched without RE2. The fixed pattern is
+// the pattern without its leading and trailing '%' and with the escapes
+// resolved.
+enum class PatternKind {
+  // No wildcards, e.g. 'abc'.
+  kExact,
+  // Only trailing '%', e.g. 'abc%'.
+  kPrefix,
+  // Only leading '%', e.g. '%abc'. A pattern of only '%' is a suffix of
+  // length 0.
+  kSuffix,
+  // Leading and trailing '%', e.g. '%abc%'.
+  kSubstring,
+  // Any other pattern, including patterns with '_' or invalid escapes.
+  kGeneric,
+};
+
+// Returns the kind of 'pattern' and sets 'fixedPattern' for the kinds other
+// than kGeneric.
+PatternKind determinePatternKind(
+    StringView pattern,
+    std::optional<char> escapeChar,
+    std::string& fixedPattern) {
+  fixedPattern.clear();
+  bool leadingWildcard = false;
+  bool trailingWildcard = false;
+  bool escaped = false;
+  for (const char c : pattern) {
+    if (!escaped && c == escapeChar) {
+      escaped = true;
+      continue;
+    }
+    if (escaped) {
+      if (!(c == '%' || c == '_' || c == escapeChar)) {
+        return PatternKind::kGeneric;
+      }
+      escaped = false;
+    } else if (c == '_') {
+      return PatternKind::kGeneric;
+    } else if (c == '%') {
+      if (fixedPattern.empty() && !trailingWildcard) {
+        leadingWildcard = true;
+      } else {
+        trailingWildcard = true;
+      }
+      continue;
+    }
+    if (trailingWildcard) {
+      // A '%' between fixed characters.
+      return PatternKind::kGeneric;
+    }
+    fixedPattern.push_back(c);
+  }
+  if (escaped) {
+    return PatternKind::kGeneric;
+  }
+  if (leadingWildcard) {
+    return trailingWildcard ? PatternKind::kSubstring : PatternKind::kSuffix;
+  }
+  return trailingWildcard ? PatternKind::kPrefix : PatternKind::kExact;
+}
+
+// LIKE with a pattern of kind other than kGeneric. Compares the strings
+// with the fixed pattern using memcmp or a substring search.
+template <PatternKind kind>
+class LikeFixedPattern final : public VectorFunction {
+ public:
+  explicit LikeFixedPattern(std::string fixedPattern)
+      : fixedPattern_(std::move(fixedPattern)) {}
+
+  void apply(
+      const SelectivityVector& rows,
+      std::vector<VectorPtr>& args,
+      const TypePtr& /* outputType */,
+      EvalCtx* context,
+      VectorPtr* resultRef) const final {
+    VELOX_CHECK(args.size() == 2 || args.size() == 3);
+    FlatVector<bool>& result =
+        ensureWritableBool(rows, context->pool(), resultRef);
+
+    exec::LocalDecodedVector toSearch(context, *args[0], rows);
+    if (toSearch->isConstantMapping()) {
+      bool match = matches(toSearch->valueAt<StringView>(0));
+      rows.applyToSelected([&](vector_size_t i) { result.set(i, match); });
+      return;
+    }
+    rows.applyToSelected([&](vector_size_t i) {
+      result.set(i, matches(toSearch->valueAt<StringView>(i)));
+    });
+  }
+
+ private:
+  bool matches(StringView input) const {
+    const auto size = fixedPattern_.size();
+    if constexpr (kind == PatternKind::kExact) {
+      return input == StringView(fixedPattern_);
+    } else if constexpr (kind == PatternKind::kPrefix) {
+      return input.size() >= size &&
+          std::memcmp(input.data(), fixedPattern_.data(), size) == 0;
+    } else if constexpr (kind == PatternKind::kSuffix) {
+      return input.size() >= size &&
+          std::memcmp(
+              input.data() + input.size() - size,
+              fixedPattern_.data(),
+              size) == 0;
+    } else {
+      static_assert(kind == PatternKind::kSubstring);
+      return std::string_view(input.data(), input.size())
+                 .find(fixedPattern_) != std::string_view::npos;
+    }
+  }
+
+  const std::string fixedPattern_;
+};
+
 void re2ExtractAll(
     ArrayBuilder<Varchar>& builder,
     const RE2& re,
@@ -553,8 +725,7 @@ class Re2ExtractAll final : public VectorFunction {
       //
       groups.resize(1);
       context->applyToSelectedNoThrow(rows, [&](vector_size_t row) {
-        RE2 re(toStringPiece(pattern->valueAt<StringView>(row)), RE2::Quiet);
-        checkForBadPattern(re);
+        const RE2& re = cache_.get(pattern->valueAt<StringView>(row));
         re2ExtractAll(builder, re, inputStrs, row, groups, 0);
       });
     } else {
@@ -563,8 +734,7 @@ class Re2ExtractAll final : public VectorFunction {
       exec::LocalDecodedVector groupIds(context, *args[2], rows);
       context->applyToSelectedNoThrow(rows, [&](vector_size_t row) {
         const T groupId = groupIds->valueAt<T>(row);
-        RE2 re(toStringPiece(pattern->valueAt<StringView>(row)), RE2::Quiet);
-        checkForBadPattern(re);
+        const RE2& re = cache_.get(pattern->valueAt<StringView>(row));
         checkForBadGroupId(groupId, re);
         groups.resize(groupId + 1);
         re2ExtractAll(builder, re, inputStrs, row, groups, groupId);
@@ -578,6 +748,9 @@ class Re2ExtractAll final : public VectorFunction {
         std::move(builder).finish(context->pool());
     context->moveOrCopyResult(arrayVector, rows, resultRef);
   }
+
+ private:
+  mutable Re2Cache cache_;
 };
 
 template <bool (*Fn)(StringView, const RE2&)>
@@ -598,9 +771,9 @@ std::shared_ptr<VectorFunction> makeRe2MatchImpl(
     return std::make_shared<Re2MatchConstantPattern<Fn>>(
         constantPattern->as<ConstantVector<StringView>>()->valueAt(0));
   }
-  static std::shared_ptr<Re2Match<Fn>> kMatchExpr =
-      std::make_shared<Re2Match<Fn>>();
-  return kMatchExpr;
+  // Not shared between expressions, since each instance caches the patterns
+  // it compiles.
+  return std::make_shared<Re2Match<Fn>>();
 }
 
 } // namespace
@@ -771,6 +944,23 @@ std::shared_ptr<exec::VectorFunction> makeLike(
       name,
       inputArgs[1].type->toString());
   auto pattern = constantPattern->as<ConstantVector<StringView>>()->valueAt(0);
+  std::string fixedPattern;
+  switch (determinePatternKind(pattern, escapeChar, fixedPattern)) {
+    case PatternKind::kExact:
+      return std::make_shared<LikeFixedPattern<PatternKind::kExact>>(
+          std::move(fixedPattern));
+    case PatternKind::kPrefix:
+      return std::make_shared<LikeFixedPattern<PatternKind::kPrefix>>(
+          std::move(fixedPattern));
+    case PatternKind::kSuffix:
+      return std::make_shared<LikeFixedPattern<PatternKind::kSuffix>>(
+          std::move(fixedPattern));
+    case PatternKind::kSubstring:
+      return std::make_shared<LikeFixedPattern<PatternKind::kSubstring>>(
+          std::move(fixedPattern));
+    case PatternKind::kGeneric:
+      break;
+  }
   return std::make_shared<LikeConstantPattern>(pattern, escapeChar);
 }
 
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <vector>
+
+#include <folly/container/F14Set.h>
+
+namespace facebook::velox::functions {
+
+// Set of distinct values meant to be cleared and refilled for every row of
+// an array function. The first kMaxLinearSize values are kept in a plain
+// vector which is scanned without early exit, so the comparisons vectorize;
+// this beats hashing for the small arrays that are most common. Larger sets
+// move to an F14 hash set. clear() keeps the allocated memory of both.
+template <typename T>
+class SmallValueSet {
+ public:
+  static constexpr size_t kMaxLinearSize{16};
+
+  SmallValueSet() {
+    values_.reserve(kMaxLinearSize);
+  }
+
+  void clear() {
+    values_.clear();
+    if (!set_.empty()) {
+      set_.clear();
+    }
+  }
+
+  bool contains(const T& value) const {
+    if (!set_.empty()) {
+      return set_.count(value) > 0;
+    }
+    bool found = false;
+    for (const auto& existing : values_) {
+      found |= existing == value;
+    }
+    return found;
+  }
+
+  // Adds 'value' and returns true if it was not in the set yet.
+  bool insert(const T& value) {
+    if (set_.empty()) {
+      if (contains(value)) {
+        return false;
+      }
+      if (values_.size() < kMaxLinearSize) {
+        values_.push_back(value);
+        return true;
+      }
+      set_.insert(values_.begin(), values_.end());
+    }
+    return set_.insert(value).second;
+  }
+
+ private:
+  std::vector<T> values_;
+  folly::F14FastSet<T> set_;
+};
+
+} // namespace facebook::velox::functions
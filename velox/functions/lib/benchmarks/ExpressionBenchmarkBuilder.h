@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <folly/Benchmark.h>
+#include "velox/expression/tests/VectorFuzzer.h"
+#include "velox/functions/lib/benchmarks/FunctionBenchmarkBase.h"
+
+namespace facebook::velox::functions::test {
+
+// Input encoding of an expression benchmark. kFuzz lets VectorFuzzer pick
+// random, possibly nested, encodings.
+enum class InputEncoding { kFlat, kDictionary, kConstant, kFuzz };
+
+inline const char* inputEncodingName(InputEncoding encoding) {
+  switch (encoding) {
+    case InputEncoding::kFlat:
+      return "flat";
+    case InputEncoding::kDictionary:
+      return "dictionary";
+    case InputEncoding::kConstant:
+      return "constant";
+    case InputEncoding::kFuzz:
+      return "fuzz";
+  }
+  return "unknown";
+}
+
+struct ExpressionBenchmarkSpec {
+  // Prefix of the benchmark names.
+  std::string name;
+  // SQL text of the expression over the columns of 'rowType'.
+  std::string expression;
+  RowTypePtr rowType;
+  // Null chance, string and container sizes of the input. 'vectorSize' is
+  // the batch size.
+  VectorFuzzer::Options fuzzerOptions;
+  std::vector<InputEncoding> encodings{
+      InputEncoding::kFlat,
+      InputEncoding::kDictionary};
+  // Number of input batches evaluated per iteration of the benchmark.
+  int32_t numBatches{10};
+  size_t seed{123456};
+};
+
+// Registers folly benchmarks for an expression given as SQL text. For each
+// encoding of the input, evaluates the expression with ExprSet and, relative
+// to that, with ExprSetSimplified. Each benchmark counts one iteration per
+// row, so folly reports the time per row and rows per second. The input is
+// generated once per encoding before the benchmarks run.
+class ExpressionBenchmarkBuilder : public FunctionBenchmarkBase {
+ public:
+  void addBenchmarks(const ExpressionBenchmarkSpec& spec) {
+    for (auto encoding : spec.encodings) {
+      auto input = std::make_shared<std::vector<RowVectorPtr>>(
+          makeInput(spec, encoding));
+      auto name = fmt::format("{}_{}", spec.name, inputEncodingName(encoding));
+      addBenchmark(name, spec, input, false);
+      addBenchmark(name, spec, input, true);
+    }
+  }
+
+ private:
+  std::vector<RowVectorPtr> makeInput(
+      const ExpressionBenchmarkSpec& spec,
+      InputEncoding encoding) {
+    VectorFuzzer fuzzer(spec.fuzzerOptions, pool(), spec.seed);
+    const auto size = spec.fuzzerOptions.vectorSize;
+    std::vector<RowVectorPtr> batches;
+    for (auto i = 0; i < spec.numBatches; ++i) {
+      std::vector<VectorPtr> children;
+      for (auto& type : spec.rowType->children()) {
+        VectorPtr child;
+        if (encoding == InputEncoding::kFuzz) {
+          child = fuzzer.fuzz(type);
+        } else {
+          child = type->isPrimitiveType() ? fuzzer.fuzzFlat(type)
+                                          : fuzzer.fuzzComplex(type);
+          if (encoding == InputEncoding::kDictionary) {
+            child = fuzzer.fuzzDictionary(child);
+          } else if (encoding == InputEncoding::kConstant) {
+            child = BaseVector::wrapInConstant(size, 0, child);
+          }
+        }
+        children.push_back(std::move(child));
+      }
+      batches.push_back(std::make_shared<RowVector>(
+          pool(), spec.rowType, nullptr, size, std::move(children)));
+    }
+    return batches;
+  }
+
+  void addBenchmark(
+      const std::string& name,
+      const ExpressionBenchmarkSpec& spec,
+      std::shared_ptr<std::vector<RowVectorPtr>> input,
+      bool simplified) {
+    // A leading '%' makes folly report the benchmark relative to the
+    // previous one.
+    auto benchmarkName = simplified ? fmt::format("%{}_simplified", name)
+                                    : fmt::format("{}_common", name);
+    folly::addBenchmark(
+        __FILE__,
+        benchmarkName,
+        [this, expression = spec.expression, rowType = spec.rowType, input,
+         simplified](unsigned iterations) {
+          folly::BenchmarkSuspender suspender;
+          auto typed = core::Expressions::inferTypes(
+              parse::parseExpr(expression), rowType, pool());
+          std::unique_ptr<exec::ExprSet> exprSet;
+          if (simplified) {
+            exprSet = std::make_unique<exec::ExprSetSimplified>(
+                std::vector<core::TypedExprPtr>{typed}, &execCtx_);
+          } else {
+            exprSet = std::make_unique<exec::ExprSet>(
+                std::vector<core::TypedExprPtr>{typed}, &execCtx_);
+          }
+          suspender.dismiss();
+
+          unsigned numRows = 0;
+          for (unsigned i = 0; i < iterations; ++i) {
+            for (auto& batch : *input) {
+              numRows += evaluate(*exprSet, batch)->size();
+            }
+          }
+          return numRows;
+        });
+  }
+};
+
+} // namespace facebook::velox::functions::test
@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <immintrin.h>
 #include <cstring>
 #include <string>
 #include <string_view>
@@ -47,7 +48,22 @@ namespace stringCore {
 static bool isAscii(const char* str, size_t length);
 
 FOLLY_ALWAYS_INLINE bool isAscii(const char* str, size_t length) {
-  for (auto i = 0; i < length; i++) {
+  size_t i = 0;
+  // Check 32 bytes at a time. movemask collects the high bit of each byte.
+  for (; i + 32 <= length; i += 32) {
+    auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+    if (_mm256_movemask_epi8(bytes) != 0) {
+      return false;
+    }
+  }
+  for (; i + 8 <= length; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, str + i, sizeof(word));
+    if (word & 0x8080808080808080ULL) {
+      return false;
+    }
+  }
+  for (; i < length; i++) {
     if (str[i] & 0x80) {
       return false;
     }
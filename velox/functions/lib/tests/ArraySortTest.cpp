@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "velox/functions/lib/ArraySort.h"
+
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+
+namespace facebook::velox::functions {
+namespace {
+
+// NaNs last, as the sorter orders them.
+template <typename T>
+bool nanLast(T a, T b) {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(a)) {
+      return false;
+    }
+    if (std::isnan(b)) {
+      return true;
+    }
+  }
+  return a < b;
+}
+
+template <typename T>
+T randomValue(folly::Random::DefaultGenerator& rng, bool smallRange) {
+  if constexpr (std::is_floating_point_v<T>) {
+    switch (folly::Random::rand32(8, rng)) {
+      case 0:
+        return std::numeric_limits<T>::quiet_NaN();
+      case 1:
+        return std::numeric_limits<T>::infinity();
+      case 2:
+        return -std::numeric_limits<T>::infinity();
+      case 3:
+        return -0.0;
+      default:
+        return static_cast<T>(
+            static_cast<int32_t>(folly::Random::rand32(2'000, rng)) - 1'000) /
+            7;
+    }
+  } else {
+    auto value = static_cast<T>(folly::Random::rand64(rng));
+    return smallRange ? static_cast<T>(value % 10) : value;
+  }
+}
+
+template <typename T>
+void testSort() {
+  folly::Random::DefaultGenerator rng(1);
+  FixedWidthSorter<T> sorter;
+  for (auto size : {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 100, 255, 256, 5'000}) {
+    for (auto descending : {false, true}) {
+      for (auto smallRange : {false, true}) {
+        std::vector<T> values(size);
+        for (auto& value : values) {
+          value = randomValue<T>(rng, smallRange);
+        }
+        auto expected = values;
+        std::sort(expected.begin(), expected.end(), nanLast<T>);
+        if (descending) {
+          std::reverse(expected.begin(), expected.end());
+        }
+        sorter.sort(values.data(), values.data() + size, descending);
+        for (auto i = 0; i < size; ++i) {
+          if constexpr (std::is_floating_point_v<T>) {
+            if (std::isnan(expected[i])) {
+              ASSERT_TRUE(std::isnan(values[i])) << size << " " << i;
+              continue;
+            }
+          }
+          ASSERT_EQ(expected[i], values[i]) << size << " " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(FixedWidthSorterTest, integers) {
+  testSort<int8_t>();
+  testSort<int16_t>();
+  testSort<int32_t>();
+  testSort<int64_t>();
+}
+
+TEST(FixedWidthSorterTest, floatingPoint) {
+  testSort<float>();
+  testSort<double>();
+}
+
+TEST(FixedWidthSorterTest, signedZeros) {
+  // The sorting network keeps both zeros.
+  std::vector<double> values = {0.0, -0.0, 1.0, -0.0, 0.0};
+  FixedWidthSorter<double> sorter;
+  sorter.sort(values.data(), values.data() + values.size(), false);
+  EXPECT_EQ(
+      std::count_if(
+          values.begin(), values.end(), [](auto v) { return std::signbit(v); }),
+      2);
+  EXPECT_EQ(values.back(), 1.0);
+}
+
+} // namespace
+} // namespace facebook::velox::functions
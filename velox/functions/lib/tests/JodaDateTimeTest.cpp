@@ -282,6 +282,30 @@ TEST_F(JodaDateTimeTest, parseMixed) {
   EXPECT_EQ("-07:23", util::getTimeZoneName(result.timezoneId));
 }
 
+TEST_F(JodaDateTimeTest, parseFixedWidth) {
+  // Inputs matching the format width take the fast path; anything else falls
+  // back to the generic parser, with the same results and errors.
+  JodaFormatter formatter("YYYY-MM-dd HH:mm:ss");
+  EXPECT_EQ(
+      util::fromTimestampString("2019-07-03 11:04:10"),
+      formatter.parse("2019-07-03 11:04:10").timestamp);
+  EXPECT_EQ(
+      util::fromTimestampString("2019-07-03 11:04:10"),
+      formatter.parse("2019-7-3 11:4:10").timestamp);
+  EXPECT_EQ(
+      util::fromTimestampString("0019-07-03 11:04:10"),
+      formatter.parse("019-07-03 011:04:10").timestamp);
+  EXPECT_THROW(formatter.parse("2019-07-03 11:04:1x"), VeloxUserError);
+  EXPECT_THROW(formatter.parse("2019-07-03 11:04-10"), VeloxUserError);
+  EXPECT_THROW(formatter.parse("2019-07-03 24:04:10"), VeloxUserError);
+
+  // Month and day without a year still default to year 2000.
+  EXPECT_EQ(util::fromTimestampString("2000-07-03"), parse("07/03", "MM/dd"));
+
+  // Adjacent patterns are read greedily, so they never take the fast path.
+  EXPECT_THROW(parse("20190703", "YYYYMMdd"), VeloxUserError);
+}
+
 } // namespace
 
 } // namespace facebook::velox::functions
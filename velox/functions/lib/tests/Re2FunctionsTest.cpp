@@ -212,6 +212,44 @@ TEST_F(Re2FunctionsTest, regexMatchBatch) {
   re2Match.testBatchAll();
 }
 
+TEST_F(Re2FunctionsTest, repeatedVariablePatterns) {
+  // Few distinct patterns over many rows, which are compiled once and then
+  // looked up in the per-function cache.
+  const vector_size_t size = 1'000;
+  const std::vector<std::string> patterns = {"a+b", "\\d+", "[a-c]+"};
+  auto input = makeFlatVector<StringView>(
+      size, [](auto row) { return row % 2 == 0 ? "aab" : "123"; });
+  auto pattern = makeFlatVector<StringView>(size, [&](auto row) {
+    return StringView(patterns[row % patterns.size()]);
+  });
+  auto data = makeRowVector({input, pattern});
+
+  // Rows alternate inputs and cycle through patterns: 'aab' matches the first
+  // and last pattern, '123' only matches the second.
+  auto matches = [](auto row) {
+    return row % 2 == 0 ? row % 3 != 1 : row % 3 == 1;
+  };
+  auto result = evaluate<SimpleVector<bool>>("re2_match(c0, c1)", data);
+  assertEqualVectors(makeFlatVector<bool>(size, matches), result);
+
+  // re2_extract returns null for rows that do not match.
+  auto extracted =
+      evaluate<SimpleVector<StringView>>("re2_extract(c0, c1)", data);
+  auto expected = makeFlatVector<StringView>(
+      size,
+      [](auto row) { return row % 2 == 0 ? "aab" : "123"; },
+      [&](auto row) { return !matches(row); });
+  assertEqualVectors(expected, extracted);
+
+  // An invalid pattern still fails after valid ones are cached.
+  auto badPattern = makeFlatVector<StringView>(
+      size, [](auto row) { return row < size - 1 ? "a+b" : "*"; });
+  EXPECT_THROW(
+      evaluate<SimpleVector<bool>>(
+          "re2_match(c0, c1)", makeRowVector({input, badPattern})),
+      VeloxException);
+}
+
 template <typename F>
 void testRe2Search(F&& regexSearch) {
   // Empty string cases.
@@ -411,6 +449,52 @@ TEST_F(Re2FunctionsTest, likePatternAndEscape) {
   EXPECT_THROW(like("abcd", "a#}#+", '#'), std::exception);
 }
 
+// Patterns of only fixed characters and leading or trailing '%' are
+// matched without RE2.
+TEST_F(Re2FunctionsTest, likeFixedPattern) {
+  auto like = [&](std::optional<std::string> str, const std::string& pattern) {
+    return evaluateOnce<bool>("like(c0, '" + pattern + "')", str);
+  };
+
+  EXPECT_EQ(like("abc", "abc"), true);
+  EXPECT_EQ(like("abcd", "abc"), false);
+  EXPECT_EQ(like("", ""), true);
+  EXPECT_EQ(like("a", ""), false);
+
+  EXPECT_EQ(like("abcd", "abc%"), true);
+  EXPECT_EQ(like("ab", "abc%"), false);
+  EXPECT_EQ(like("abc", "abc%%"), true);
+
+  EXPECT_EQ(like("dabc", "%abc"), true);
+  EXPECT_EQ(like("abcd", "%abc"), false);
+  EXPECT_EQ(like("bc", "%abc"), false);
+
+  EXPECT_EQ(like("xxabcxx", "%abc%"), true);
+  EXPECT_EQ(like("abc", "%abc%"), true);
+  EXPECT_EQ(like("xxabxcxx", "%abc%"), false);
+  EXPECT_EQ(like("", "%"), true);
+  EXPECT_EQ(like("abc", "%%"), true);
+
+  EXPECT_EQ(like("stringwithmorethan16chars", "%morethan%"), true);
+  EXPECT_EQ(like("stringwithmorethan16chars", "%16chars"), true);
+  EXPECT_EQ(like("stringwithmorethan16chars", "%lessthan%"), false);
+
+  // A '%' between fixed characters needs RE2.
+  EXPECT_EQ(like("abxc", "ab%c"), true);
+  EXPECT_EQ(like("abxd", "ab%c"), false);
+
+  EXPECT_EQ(like(std::nullopt, "abc%"), std::nullopt);
+
+  auto likeEscape = [&](const std::string& str, const std::string& pattern) {
+    return evaluateOnce<bool>(
+        "like(c0, '" + pattern + "', '#')", std::optional(str));
+  };
+  EXPECT_EQ(likeEscape("a%", "a#%"), true);
+  EXPECT_EQ(likeEscape("ab", "a#%"), false);
+  EXPECT_EQ(likeEscape("a_b", "%#_%"), true);
+  EXPECT_EQ(likeEscape("a#b", "%a##b"), true);
+}
+
 template <typename T>
 void Re2FunctionsTest::testRe2ExtractAll(
     const std::vector<std::optional<std::string>>& inputs,
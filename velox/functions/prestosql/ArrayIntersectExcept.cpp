@@ -16,25 +16,20 @@
 #include "velox/expression/EvalCtx.h"
 #include "velox/expression/VectorFunction.h"
 #include "velox/functions/lib/LambdaFunctionUtil.h"
+#include "velox/functions/lib/SmallValueSet.h"
 
 namespace facebook::velox::functions {
 namespace {
 
 template <typename T>
 struct SetWithNull {
-  SetWithNull(vector_size_t initialSetSize = kInitialSetSize) {
-    set.reserve(initialSetSize);
-  }
-
   void reset() {
     set.clear();
     hasNull = false;
   }
 
-  std::unordered_set<T> set;
+  SmallValueSet<T> set;
   bool hasNull{false};
-
-  static constexpr vector_size_t kInitialSetSize{128};
 };
 
 // Generates a set based on the elements of an ArrayVector. Note that we take
@@ -197,13 +192,12 @@ class ArrayIntersectExceptFunction : public exec::VectorFunction {
           // (check outputSet).
           bool addValue = false;
           if constexpr (isIntersect) {
-            addValue = rightSet.set.count(val) > 0;
+            addValue = rightSet.set.contains(val);
           } else {
-            addValue = rightSet.set.count(val) == 0;
+            addValue = !rightSet.set.contains(val);
           }
           if (addValue) {
-            auto it = outputSet.set.insert(val);
-            if (it.second) {
+            if (outputSet.set.insert(val)) {
               rawNewIndices[indicesCursor++] = i;
             }
           }
@@ -65,6 +65,43 @@ FOLLY_ALWAYS_INLINE const date::time_zone* getTimeZoneFromConfig(
   return nullptr;
 }
 
+// A time zone with the UTC offset of its last lookup. The offset is kept
+// together with the interval between the time zone's transitions it applies
+// to, so that consecutive timestamps in one interval, the common case, skip
+// the search over the transition table.
+class SessionTimeZone {
+ public:
+  void set(const date::time_zone* timeZone) {
+    timeZone_ = timeZone;
+    begin_ = 0;
+    end_ = 0;
+  }
+
+  const date::time_zone* get() const {
+    return timeZone_;
+  }
+
+  // Returns the offset in seconds of local time from UTC at 'seconds' since
+  // the epoch in UTC.
+  FOLLY_ALWAYS_INLINE int64_t offsetAt(int64_t seconds) {
+    if (UNLIKELY(seconds < begin_ || seconds >= end_)) {
+      auto info = timeZone_->get_info(
+          date::sys_seconds{std::chrono::seconds{seconds}});
+      begin_ = info.begin.time_since_epoch().count();
+      end_ = info.end.time_since_epoch().count();
+      offset_ = info.offset.count();
+    }
+    return offset_;
+  }
+
+ private:
+  const date::time_zone* timeZone_{nullptr};
+  // [begin_, end_) is the interval in UTC seconds 'offset_' applies to.
+  int64_t begin_{0};
+  int64_t end_{0};
+  int64_t offset_{0};
+};
+
 FOLLY_ALWAYS_INLINE int64_t
 getSeconds(Timestamp timestamp, const date::time_zone* timeZone) {
   if (timeZone != nullptr) {
@@ -75,31 +112,85 @@ getSeconds(Timestamp timestamp, const date::time_zone* timeZone) {
   }
 }
 
+// Same as above with the offset looked up through 'timeZone'.
+FOLLY_ALWAYS_INLINE int64_t
+getSeconds(Timestamp timestamp, SessionTimeZone& timeZone) {
+  auto seconds = timestamp.getSeconds();
+  if (timeZone.get() != nullptr) {
+    return seconds + timeZone.offsetAt(seconds);
+  }
+  return seconds;
+}
+
+FOLLY_ALWAYS_INLINE bool isLeapYear(int64_t year) {
+  return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+// Breaks down 'seconds' since the epoch like gmtime_r(), with plain integer
+// arithmetic instead of a library call. The date uses the days-to-civil
+// algorithm from http://howardhinnant.github.io/date_algorithms.html.
+FOLLY_ALWAYS_INLINE std::tm toDateTime(int64_t seconds) {
+  int64_t days = seconds / kSecondsInDay;
+  int64_t secondsOfDay = seconds % kSecondsInDay;
+  if (secondsOfDay < 0) {
+    secondsOfDay += kSecondsInDay;
+    --days;
+  }
+
+  // Days since 0000-03-01, split into 400 year eras.
+  const int64_t shifted = days + 719'468;
+  const int64_t era = (shifted >= 0 ? shifted : shifted - 146'096) / 146'097;
+  const int64_t dayOfEra = shifted - era * 146'097;
+  const int64_t yearOfEra = (dayOfEra - dayOfEra / 1'460 +
+                             dayOfEra / 36'524 - dayOfEra / 146'096) /
+      365;
+  // Day of the year starting at March 1.
+  const int64_t dayOfYear =
+      dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  const int64_t shiftedMonth = (5 * dayOfYear + 2) / 153;
+  const int64_t month =
+      shiftedMonth < 10 ? shiftedMonth + 2 : shiftedMonth - 10;
+  const int64_t year = yearOfEra + era * 400 + (month <= 1 ? 1 : 0);
+
+  std::tm dateTime{};
+  dateTime.tm_year = year - 1900;
+  dateTime.tm_mon = month;
+  dateTime.tm_mday = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+  dateTime.tm_yday =
+      month <= 1 ? dayOfYear - 306 : dayOfYear + 59 + isLeapYear(year);
+  // 1970-01-01 was a Thursday.
+  const int64_t weekDay = (days + 4) % 7;
+  dateTime.tm_wday = weekDay < 0 ? weekDay + 7 : weekDay;
+  dateTime.tm_hour = secondsOfDay / 3'600;
+  dateTime.tm_min = secondsOfDay % 3'600 / 60;
+  dateTime.tm_sec = secondsOfDay % 60;
+  return dateTime;
+}
+
 FOLLY_ALWAYS_INLINE
 std::tm getDateTime(Timestamp timestamp, const date::time_zone* timeZone) {
-  int64_t seconds = getSeconds(timestamp, timeZone);
-  std::tm dateTime;
-  gmtime_r((const time_t*)&seconds, &dateTime);
-  return dateTime;
+  return toDateTime(getSeconds(timestamp, timeZone));
+}
+
+FOLLY_ALWAYS_INLINE
+std::tm getDateTime(Timestamp timestamp, SessionTimeZone& timeZone) {
+  return toDateTime(getSeconds(timestamp, timeZone));
 }
 
 FOLLY_ALWAYS_INLINE
 std::tm getDateTime(Date date) {
-  int64_t seconds = date.days() * kSecondsInDay;
-  std::tm dateTime;
-  gmtime_r((const time_t*)&seconds, &dateTime);
-  return dateTime;
+  return toDateTime(date.days() * kSecondsInDay);
 }
 
 template <typename T>
 struct InitSessionTimezone {
   VELOX_DEFINE_FUNCTION_TYPES(T);
-  const date::time_zone* timeZone_{nullptr};
+  SessionTimeZone timeZone_;
 
   FOLLY_ALWAYS_INLINE void initialize(
       const core::QueryConfig& config,
       const arg_type<Timestamp>* /*timestamp*/) {
-    timeZone_ = getTimeZoneFromConfig(config);
+    timeZone_.set(getTimeZoneFromConfig(config));
   }
 };
 
@@ -375,14 +466,14 @@ template <typename T>
 struct DateTruncFunction {
   VELOX_DEFINE_FUNCTION_TYPES(T);
 
-  const date::time_zone* timeZone_ = nullptr;
+  SessionTimeZone timeZone_;
   std::optional<DateTimeUnit> unit_;
 
   FOLLY_ALWAYS_INLINE void initialize(
       const core::QueryConfig& config,
       const arg_type<Varchar>* unitString,
       const arg_type<Timestamp>* /*timestamp*/) {
-    timeZone_ = getTimeZoneFromConfig(config);
+    timeZone_.set(getTimeZoneFromConfig(config));
     if (unitString != nullptr) {
       unit_ = fromDateTimeUnitString(*unitString, false /*throwIfInvalid*/);
     }
@@ -441,8 +532,10 @@ struct DateTruncFunction {
     adjustDateTime(dateTime, unit);
 
     result = Timestamp(timegm(&dateTime), 0);
-    if (timeZone_ != nullptr) {
-      result.toTimezone(*timeZone_);
+    if (timeZone_.get() != nullptr) {
+      // Same as result.toTimezone(*timeZone_.get()).
+      result = Timestamp(
+          result.getSeconds() - timeZone_.offsetAt(result.getSeconds()), 0);
     }
     return true;
   }
@@ -244,24 +244,36 @@ class InPredicate : public exec::VectorFunction {
 
     auto rawResults = boolResult->mutableRawValues<uint64_t>();
 
-    if (flatArg->mayHaveNulls() || passOrNull) {
-      rows.applyToSelected([&](auto row) {
-        if (flatArg->isNullAt(row)) {
-          boolResult->setNull(row, true);
-        } else {
-          bool pass = testFunction(rawValues[row]);
-          if (!pass && passOrNull) {
+    auto setResults = [&](auto testRow) {
+      if (flatArg->mayHaveNulls() || passOrNull) {
+        rows.applyToSelected([&](auto row) {
+          if (flatArg->isNullAt(row)) {
             boolResult->setNull(row, true);
           } else {
-            bits::setBit(rawResults, row, pass);
+            bool pass = testRow(row);
+            if (!pass && passOrNull) {
+              boolResult->setNull(row, true);
+            } else {
+              bits::setBit(rawResults, row, pass);
+            }
           }
-        }
-      });
+        });
+      } else {
+        rows.applyToSelected([&](auto row) {
+          bool pass = testRow(row);
+          bits::setBit(rawResults, row, pass);
+        });
+      }
+    };
+
+    if constexpr (std::is_same_v<T, int64_t>) {
+      // Tests all values up to the last selected row in one batch so that
+      // filters with a SIMD implementation process 4 values at a time.
+      std::vector<uint64_t> passed(bits::nwords(rows.end()));
+      filter_->testInt64Values(rawValues, rows.end(), passed.data());
+      setResults([&](auto row) { return bits::isBitSet(passed.data(), row); });
     } else {
-      rows.applyToSelected([&](auto row) {
-        bool pass = testFunction(rawValues[row]);
-        bits::setBit(rawResults, row, pass);
-      });
+      setResults([&](auto row) { return testFunction(rawValues[row]); });
     }
   }
 
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/expression/VectorFunction.h"
+#include "folly/String.h"
+#include "velox/expression/VectorFunction.h"
+#include "velox/functions/prestosql/json/JsonExtractor.h"
+
+namespace facebook::velox::functions {
+namespace {
+
+// json_extract_scalar_multi(json, path1, path2, ...) -> row(varchar, ...)
+// Evaluates json_extract_scalar(json, pathN) for all the constant paths at
+// once, so that each document is parsed at most once. Field N of the result
+// is the value at pathN. Not meant to be called directly: the expression
+// compiler substitutes it for sibling json_extract_scalar calls on the same
+// input.
+class JsonExtractScalarMulti : public exec::VectorFunction {
+ public:
+  JsonExtractScalarMulti(
+      const std::string& /*name*/,
+      const std::vector<exec::VectorFunctionArg>& inputArgs) {
+    VELOX_CHECK_GE(inputArgs.size(), 2);
+    for (size_t i = 1; i < inputArgs.size(); ++i) {
+      auto path = std::dynamic_pointer_cast<ConstantVector<StringView>>(
+          inputArgs[i].constantValue);
+      VELOX_CHECK(
+          path && !path->isNullAt(0),
+          "json_extract_scalar_multi requires constant paths");
+      extractors_.push_back(std::make_shared<JsonExtractor>(
+          folly::trimWhitespace(path->valueAt(0)).str()));
+    }
+  }
+
+  bool isDefaultNullBehavior() const override {
+    return false;
+  }
+
+  void apply(
+      const SelectivityVector& rows,
+      std::vector<VectorPtr>& args,
+      const TypePtr& outputType,
+      exec::EvalCtx* context,
+      VectorPtr* result) const override {
+    BaseVector::ensureWritable(rows, outputType, context->pool(), result);
+    auto rowResult = (*result)->as<RowVector>();
+    std::vector<FlatVector<StringView>*> children;
+    for (size_t i = 0; i < extractors_.size(); ++i) {
+      auto& child = rowResult->childAt(i);
+      BaseVector::ensureWritable(rows, VARCHAR(), context->pool(), &child);
+      children.push_back(child->asFlatVector<StringView>());
+    }
+
+    exec::LocalDecodedVector decodedJson(context, *args[0], rows);
+    std::vector<folly::Optional<std::string>> values;
+    context->applyToSelectedNoThrow(rows, [&](vector_size_t row) {
+      rowResult->setNull(row, false);
+      if (decodedJson->isNullAt(row)) {
+        for (auto* child : children) {
+          child->setNull(row, true);
+        }
+        return;
+      }
+      folly::StringPiece json = decodedJson->valueAt<StringView>(row);
+      jsonExtractScalars(json, extractors_, values);
+      for (size_t i = 0; i < children.size(); ++i) {
+        if (values[i].has_value()) {
+          children[i]->set(row, StringView(values[i].value()));
+        } else {
+          children[i]->setNull(row, true);
+        }
+      }
+    });
+  }
+
+  // The result type depends on the number of paths, which a signature can't
+  // express. The function is only bound by the expression compiler, so it
+  // declares no signatures.
+  static std::vector<std::shared_ptr<exec::FunctionSignature>> signatures() {
+    return {};
+  }
+
+ private:
+  std::vector<std::shared_ptr<JsonExtractor>> extractors_;
+};
+
+} // namespace
+
+VELOX_DECLARE_STATEFUL_VECTOR_FUNCTION(
+    udf_json_extract_scalar_multi,
+    JsonExtractScalarMulti::signatures(),
+    exec::makeVectorFunctionFactory<JsonExtractScalarMulti>());
+
+} // namespace facebook::velox::functions
@@ -13,6 +13,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <cmath>
+#include <optional>
+#include "velox/expression/ControlExpr.h"
 #include "velox/expression/VarSetter.h"
 #include "velox/expression/VectorFunction.h"
 #include "velox/functions/lib/LambdaFunctionUtil.h"
@@ -54,6 +57,192 @@ bool toNthElementRows(
   return arrayRows.hasSelections();
 }
 
+enum class Reduction { kSum, kMin, kMax, kConcat };
+
+/// Returns the reduction if the body of 'callable' is plus(s, x),
+/// greatest(s, x), least(s, x) or concat(s, x) of the state 's' and the
+/// element 'x' of the same type. plus() may also take x first.
+std::optional<Reduction> findReduction(
+    const Callable& callable,
+    const TypePtr& stateType,
+    const TypePtr& elementType) {
+  auto* body = callable.body();
+  auto signature = callable.signature();
+  auto kind = stateType->kind();
+  if (!body || !signature || signature->size() != 2 ||
+      body->inputs().size() != 2 || elementType->kind() != kind ||
+      body->type()->kind() != kind) {
+    return std::nullopt;
+  }
+  auto fieldName = [](const exec::ExprPtr& input) -> const std::string* {
+    auto* field = dynamic_cast<const exec::FieldReference*>(input.get());
+    if (!field || !field->inputs().empty()) {
+      return nullptr;
+    }
+    return &field->field();
+  };
+  auto* first = fieldName(body->inputs()[0]);
+  auto* second = fieldName(body->inputs()[1]);
+  if (!first || !second) {
+    return std::nullopt;
+  }
+  const auto& state = signature->nameOf(0);
+  const auto& element = signature->nameOf(1);
+  bool inOrder = *first == state && *second == element;
+  bool reversed = *first == element && *second == state;
+  const auto& name = body->name();
+  if (name == "plus" && (inOrder || reversed)) {
+    switch (kind) {
+      case TypeKind::TINYINT:
+      case TypeKind::SMALLINT:
+      case TypeKind::INTEGER:
+      case TypeKind::BIGINT:
+      case TypeKind::REAL:
+      case TypeKind::DOUBLE:
+        return Reduction::kSum;
+      default:
+        return std::nullopt;
+    }
+  }
+  if (!inOrder) {
+    return std::nullopt;
+  }
+  if ((name == "greatest" || name == "least") &&
+      (kind == TypeKind::BIGINT || kind == TypeKind::DOUBLE)) {
+    return name == "greatest" ? Reduction::kMax : Reduction::kMin;
+  }
+  if (name == "concat" && kind == TypeKind::VARCHAR) {
+    return Reduction::kConcat;
+  }
+  return std::nullopt;
+}
+
+/// Applies 'reduction' to the non-empty arrays in 'rows' with one loop over
+/// the elements of each array and writes the results to 'partialResult'.
+/// Removes the computed rows from 'remainingRows'. The rows that would raise
+/// an error, i.e. on integer overflow or on NaN in greatest() or least(), are
+/// left to the interpreted lambda, so that the error is reported the same
+/// way.
+template <typename T>
+void reduceDirect(
+    Reduction reduction,
+    const SelectivityVector& rows,
+    const ArrayVector& array,
+    const DecodedVector& initialState,
+    const DecodedVector& elements,
+    FlatVector<T>& partialResult,
+    SelectivityVector& remainingRows) {
+  auto* rawNulls = array.rawNulls();
+  auto* rawSizes = array.rawSizes();
+  auto* rawOffsets = array.rawOffsets();
+  std::string concatenated;
+  rows.applyToSelected([&](auto row) {
+    if ((rawNulls && bits::isBitNull(rawNulls, row)) || rawSizes[row] == 0) {
+      // Set by the caller.
+      remainingRows.setValid(row, false);
+      return;
+    }
+    auto begin = rawOffsets[row];
+    auto end = begin + rawSizes[row];
+    bool isNull = initialState.isNullAt(row);
+    for (auto i = begin; i < end && !isNull; ++i) {
+      isNull = elements.isNullAt(i);
+    }
+    if (isNull) {
+      partialResult.setNull(row, true);
+      remainingRows.setValid(row, false);
+      return;
+    }
+    T value = initialState.valueAt<T>(row);
+    if constexpr (std::is_same_v<T, StringView>) {
+      concatenated.assign(value.data(), value.size());
+      for (auto i = begin; i < end; ++i) {
+        auto x = elements.valueAt<StringView>(i);
+        concatenated.append(x.data(), x.size());
+      }
+      partialResult.set(row, StringView(concatenated));
+    } else {
+      if constexpr (std::is_floating_point_v<T>) {
+        if (reduction != Reduction::kSum && std::isnan(value)) {
+          return;
+        }
+      }
+      for (auto i = begin; i < end; ++i) {
+        auto x = elements.valueAt<T>(i);
+        if (reduction == Reduction::kSum) {
+          if constexpr (std::is_integral_v<T>) {
+            if (__builtin_add_overflow(value, x, &value)) {
+              return;
+            }
+          } else {
+            value += x;
+          }
+          continue;
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+          if (std::isnan(x)) {
+            return;
+          }
+        }
+        if (reduction == Reduction::kMax ? x > value : x < value) {
+          value = x;
+        }
+      }
+      partialResult.set(row, value);
+    }
+    remainingRows.setValid(row, false);
+  });
+  remainingRows.updateBounds();
+}
+
+/// Applies 'reduction' to 'rows' with reduceDirect() above. Sets
+/// 'remainingRows' to the rows that are left for the interpreted lambda.
+void reduceDirect(
+    Reduction reduction,
+    const SelectivityVector& rows,
+    const ArrayVectorPtr& array,
+    const VectorPtr& initialState,
+    exec::EvalCtx* context,
+    VectorPtr& partialResult,
+    SelectivityVector& remainingRows) {
+  BaseVector::ensureWritable(
+      rows, initialState->type(), context->pool(), &partialResult);
+  exec::LocalDecodedVector initialStateDecoder(context, *initialState, rows);
+  const auto& elements = array->elements();
+  SelectivityVector elementRows(elements->size());
+  exec::LocalDecodedVector elementsDecoder(context, *elements, elementRows);
+
+  remainingRows = rows;
+  auto reduce = [&](auto* typedResult) {
+    reduceDirect(
+        reduction,
+        rows,
+        *array,
+        *initialStateDecoder.get(),
+        *elementsDecoder.get(),
+        *typedResult,
+        remainingRows);
+  };
+  switch (initialState->typeKind()) {
+    case TypeKind::TINYINT:
+      return reduce(partialResult->asUnchecked<FlatVector<int8_t>>());
+    case TypeKind::SMALLINT:
+      return reduce(partialResult->asUnchecked<FlatVector<int16_t>>());
+    case TypeKind::INTEGER:
+      return reduce(partialResult->asUnchecked<FlatVector<int32_t>>());
+    case TypeKind::BIGINT:
+      return reduce(partialResult->asUnchecked<FlatVector<int64_t>>());
+    case TypeKind::REAL:
+      return reduce(partialResult->asUnchecked<FlatVector<float>>());
+    case TypeKind::DOUBLE:
+      return reduce(partialResult->asUnchecked<FlatVector<double>>());
+    case TypeKind::VARCHAR:
+      return reduce(partialResult->asUnchecked<FlatVector<StringView>>());
+    default:
+      VELOX_UNREACHABLE();
+  }
+}
+
 /// See documentation at
 /// https://prestodb.io/docs/current/functions/array.html#reduce
 class ReduceFunction : public exec::VectorFunction {
@@ -114,13 +303,36 @@ class ReduceFunction : public exec::VectorFunction {
     // And so on until all elements of all arrays have been processed.
     // At each step the number of arrays being processed will get smaller as
     // some arrays will run out of elements.
+    //
+    // Sums, minimums, maximums and concatenations of the elements are
+    // computed with one loop per array instead.
+    SelectivityVector remainingRows;
     while (auto entry = inputFuncIt.next()) {
+      auto* reduceRows = entry.rows;
+      if (auto reduction = findReduction(
+              *entry.callable,
+              initialState->type(),
+              flatArray->type()->childAt(0))) {
+        reduceDirect(
+            *reduction,
+            *entry.rows,
+            flatArray,
+            initialState,
+            context,
+            partialResult,
+            remainingRows);
+        if (!remainingRows.hasSelections()) {
+          continue;
+        }
+        reduceRows = &remainingRows;
+      }
+
       VectorPtr state = initialState;
 
       int n = 0;
       while (true) {
         if (!toNthElementRows(
-                flatArray, *entry.rows, n, arrayRows, elementIndices)) {
+                flatArray, *reduceRows, n, arrayRows, elementIndices)) {
           break; // Ran out of elements in all arrays.
         }
 
@@ -19,38 +19,72 @@
 
 namespace facebook::velox::functions {
 
-bool matchAuthorityAndPath(
-    const boost::cmatch& urlMatch,
-    boost::cmatch& authAndPathMatch,
-    boost::cmatch& authorityMatch,
-    bool& hasAuthority) {
-  static const boost::regex kAuthorityAndPathRegex("//([^/]*)(/.*)?");
-  auto authorityAndPath = submatch(urlMatch, 2);
-  if (!boost::regex_match(
-          authorityAndPath.begin(),
-          authorityAndPath.end(),
-          authAndPathMatch,
-          kAuthorityAndPathRegex)) {
-    // Does not start with //, doesn't have authority.
-    hasAuthority = false;
+namespace {
+// Parses [begin, end) as host[:port], where host is either an IP literal in
+// brackets or a run of characters other than '[' and ':'.
+bool parseHostAndPort(
+    const char* begin,
+    const char* end,
+    UrlAuthority& result) {
+  const char* cur = begin;
+  if (cur < end && *cur == '[') {
+    auto close = static_cast<const char*>(std::memchr(cur, ']', end - cur));
+    if (!close) {
+      return false;
+    }
+    cur = close + 1;
+  } else {
+    while (cur < end && *cur != '[' && *cur != ':') {
+      ++cur;
+    }
+  }
+  result.host = StringView(begin, cur - begin);
+  result.port = StringView();
+  if (cur == end) {
     return true;
   }
+  if (*cur != ':') {
+    return false;
+  }
+  const char* portBegin = ++cur;
+  while (cur < end && *cur >= '0' && *cur <= '9') {
+    ++cur;
+  }
+  if (cur != end) {
+    return false;
+  }
+  result.port = StringView(portBegin, end - portBegin);
+  return true;
+}
+} // namespace
 
-  static const boost::regex kAuthorityRegex(
-      "(?:([^@:]*)(?::([^@]*))?@)?" // username, password.
-      "(\\[[^\\]]*\\]|[^\\[:]*)" // host (IP-literal (e.g. '['+IPv6+']',
-      // dotted-IPv4, or named host).
-      "(?::(\\d*))?"); // port.
-
-  const auto authority = authAndPathMatch[1];
-  if (!boost::regex_match(
-          authority.first, authority.second, authorityMatch, kAuthorityRegex)) {
-    return false; // Invalid URI Authority.
+bool parseAuthorityAndPath(StringView authorityAndPath, UrlAuthority& result) {
+  const char* begin = authorityAndPath.data();
+  const char* end = begin + authorityAndPath.size();
+  if (end - begin < 2 || begin[0] != '/' || begin[1] != '/') {
+    // Does not start with //, doesn't have authority.
+    result.hasAuthority = false;
+    result.path = authorityAndPath;
+    return true;
   }
 
-  hasAuthority = true;
+  const char* authorityBegin = begin + 2;
+  auto slash = static_cast<const char*>(
+      std::memchr(authorityBegin, '/', end - authorityBegin));
+  const char* authorityEnd = slash ? slash : end;
+  result.path = StringView(authorityEnd, end - authorityEnd);
 
-  return true;
+  // User info ends at the first '@'. If what follows is not a valid host and
+  // port, the '@' may still be part of the host, so retry on the whole
+  // authority.
+  auto at = static_cast<const char*>(
+      std::memchr(authorityBegin, '@', authorityEnd - authorityBegin));
+  if ((at && parseHostAndPort(at + 1, authorityEnd, result)) ||
+      parseHostAndPort(authorityBegin, authorityEnd, result)) {
+    result.hasAuthority = true;
+    return true;
+  }
+  return false; // Invalid URI Authority.
 }
 
 } // namespace facebook::velox::functions
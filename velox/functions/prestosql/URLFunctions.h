@@ -15,37 +15,86 @@
  */
 #pragma once
 
-#include <boost/regex.hpp>
-#include <cctype>
+#include <cstring>
 #include "velox/functions/Macros.h"
 
 namespace facebook::velox::functions {
 
+// Components of a URL of the form scheme:authorityAndPath[?query][#fragment].
+// All components point into the URL string. Missing components are empty.
+struct UrlParts {
+  StringView scheme;
+  StringView authorityAndPath;
+  StringView query;
+  StringView fragment;
+};
+
+// Components of 'authorityAndPath' of the form [//authority]path, with the
+// authority further split into [userInfo@]host[:port].
+struct UrlAuthority {
+  bool hasAuthority{false};
+  StringView host;
+  StringView port;
+  StringView path;
+};
+
 namespace {
-FOLLY_ALWAYS_INLINE StringView submatch(const boost::cmatch& match, int idx) {
-  const auto& sub = match[idx];
-  return StringView(sub.first, sub.length());
+FOLLY_ALWAYS_INLINE bool isSchemeStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+FOLLY_ALWAYS_INLINE bool isSchemeChar(char c) {
+  return isSchemeStart(c) || (c >= '0' && c <= '9') || c == '+' || c == '.' ||
+      c == '-';
 }
 
+// Splits a URL into its components in a single pass. Returns false if the
+// URL doesn't start with a valid scheme followed by ':'.
 template <typename TInString>
-bool parse(const TInString& rawUrl, boost::cmatch& match) {
-  static const boost::regex kUriRegex(
-      "([a-zA-Z][a-zA-Z0-9+.-]*):" // scheme:
-      "([^?#]*)" // authority and path
-      "(?:\\?([^#]*))?" // ?query
-      "(?:#(.*))?"); // #fragment
-
-  return boost::regex_match(
-      rawUrl.data(), rawUrl.data() + rawUrl.size(), match, kUriRegex);
+bool parse(const TInString& rawUrl, UrlParts& parts) {
+  const char* begin = rawUrl.data();
+  const char* end = begin + rawUrl.size();
+  if (begin == end || !isSchemeStart(*begin)) {
+    return false;
+  }
+  const char* cur = begin + 1;
+  while (cur < end && isSchemeChar(*cur)) {
+    ++cur;
+  }
+  if (cur == end || *cur != ':') {
+    return false;
+  }
+  parts.scheme = StringView(begin, cur - begin);
+
+  const char* pathBegin = ++cur;
+  while (cur < end && *cur != '?' && *cur != '#') {
+    ++cur;
+  }
+  parts.authorityAndPath = StringView(pathBegin, cur - pathBegin);
+
+  parts.query = StringView();
+  if (cur < end && *cur == '?') {
+    const char* queryBegin = ++cur;
+    while (cur < end && *cur != '#') {
+      ++cur;
+    }
+    parts.query = StringView(queryBegin, cur - queryBegin);
+  }
+
+  parts.fragment = StringView();
+  if (cur < end) {
+    // 'cur' is at '#'.
+    ++cur;
+    parts.fragment = StringView(cur, end - cur);
+  }
+  return true;
 }
 
 } // namespace
 
-bool matchAuthorityAndPath(
-    const boost::cmatch& urlMatch,
-    boost::cmatch& authAndPathMatch,
-    boost::cmatch& authorityMatch,
-    bool& hasAuthority);
+// Splits 'authorityAndPath' of a parsed URL. Returns false if there is an
+// authority but it is not valid.
+bool parseAuthorityAndPath(StringView authorityAndPath, UrlAuthority& result);
 
 template <typename T>
 struct UrlExtractProtocolFunction {
@@ -60,11 +109,11 @@ struct UrlExtractProtocolFunction {
   FOLLY_ALWAYS_INLINE bool call(
       out_type<Varchar>& result,
       const arg_type<Varchar>& url) {
-    boost::cmatch match;
-    if (!parse(url, match)) {
+    UrlParts parts;
+    if (!parse(url, parts)) {
       result.setEmpty();
     } else {
-      result.setNoCopy(submatch(match, 1));
+      result.setNoCopy(parts.scheme);
     }
     return true;
   }
@@ -83,11 +132,11 @@ struct UrlExtractFragmentFunction {
   FOLLY_ALWAYS_INLINE bool call(
       out_type<Varchar>& result,
       const arg_type<Varchar>& url) {
-    boost::cmatch match;
-    if (!parse(url, match)) {
+    UrlParts parts;
+    if (!parse(url, parts)) {
       result.setEmpty();
     } else {
-      result.setNoCopy(submatch(match, 4));
+      result.setNoCopy(parts.fragment);
     }
     return true;
   }
@@ -106,19 +155,16 @@ struct UrlExtractHostFunction {
   FOLLY_ALWAYS_INLINE bool call(
       out_type<Varchar>& result,
       const arg_type<Varchar>& url) {
-    boost::cmatch match;
-    if (!parse(url, match)) {
+    UrlParts parts;
+    if (!parse(url, parts)) {
       result.setEmpty();
       return true;
     }
-    boost::cmatch authAndPathMatch;
-    boost::cmatch authorityMatch;
-    bool hasAuthority;
-
-    if (matchAuthorityAndPath(
-            match, authAndPathMatch, authorityMatch, hasAuthority) &&
-        hasAuthority) {
-      result.setNoCopy(submatch(authorityMatch, 3));
+
+    UrlAuthority authority;
+    if (parseAuthorityAndPath(parts.authorityAndPath, authority) &&
+        authority.hasAuthority) {
+      result.setNoCopy(authority.host);
     } else {
       result.setEmpty();
     }
@@ -131,18 +177,15 @@ struct UrlExtractPortFunction {
   VELOX_DEFINE_FUNCTION_TYPES(T);
 
   FOLLY_ALWAYS_INLINE bool call(int64_t& result, const arg_type<Varchar>& url) {
-    boost::cmatch match;
-    if (!parse(url, match)) {
+    UrlParts parts;
+    if (!parse(url, parts)) {
       return false;
     }
 
-    boost::cmatch authAndPathMatch;
-    boost::cmatch authorityMatch;
-    bool hasAuthority;
-    if (matchAuthorityAndPath(
-            match, authAndPathMatch, authorityMatch, hasAuthority) &&
-        hasAuthority) {
-      auto port = submatch(authorityMatch, 4);
+    UrlAuthority authority;
+    if (parseAuthorityAndPath(parts.authorityAndPath, authority) &&
+        authority.hasAuthority) {
+      auto port = authority.port;
       if (!port.empty()) {
         try {
           result = to<int64_t>(port);
@@ -168,23 +211,15 @@ struct UrlExtractPathFunction {
   FOLLY_ALWAYS_INLINE bool call(
       out_type<Varchar>& result,
       const arg_type<Varchar>& url) {
-    boost::cmatch match;
-    if (!parse(url, match)) {
+    UrlParts parts;
+    if (!parse(url, parts)) {
       result.setEmpty();
       return true;
     }
 
-    boost::cmatch authAndPathMatch;
-    boost::cmatch authorityMatch;
-    bool hasAuthority;
-
-    if (matchAuthorityAndPath(
-            match, authAndPathMatch, authorityMatch, hasAuthority)) {
-      if (hasAuthority) {
-        result.setNoCopy(submatch(authAndPathMatch, 2));
-      } else {
-        result.setNoCopy(submatch(match, 2));
-      }
+    UrlAuthority authority;
+    if (parseAuthorityAndPath(parts.authorityAndPath, authority)) {
+      result.setNoCopy(authority.path);
     }
 
     return true;
@@ -204,14 +239,13 @@ struct UrlExtractQueryFunction {
   FOLLY_ALWAYS_INLINE bool call(
       out_type<Varchar>& result,
       const arg_type<Varchar>& url) {
-    boost::cmatch match;
-    if (!parse(url, match)) {
+    UrlParts parts;
+    if (!parse(url, parts)) {
       result.setEmpty();
       return true;
     }
 
-    auto query = submatch(match, 3);
-    result.setNoCopy(query);
+    result.setNoCopy(parts.query);
     return true;
   }
 };
@@ -230,37 +264,37 @@ struct UrlExtractParameterFunction {
       out_type<Varchar>& result,
       const arg_type<Varchar>& url,
       const arg_type<Varchar>& param) {
-    boost::cmatch match;
-    if (!parse(url, match)) {
+    UrlParts parts;
+    if (!parse(url, parts)) {
       result.setEmpty();
       return false;
     }
 
-    auto query = submatch(match, 3);
-    if (!query.empty()) {
-      // Parse query string.
-      static const boost::regex kQueryParamRegex(
-          "(^|&)" // start of query or start of parameter "&"
-          "([^=&]*)=?" // parameter name and "=" if value is expected
-          "([^=&]*)" // parameter value
-          "(?=(&|$))" // forward reference, next should be end of query or
-                      // start of next parameter
-      );
-
-      const boost::cregex_iterator begin(
-          query.data(), query.data() + query.size(), kQueryParamRegex);
-      boost::cregex_iterator end;
-
-      for (auto it = begin; it != end; ++it) {
-        if (it->length(2) != 0) { // key shouldnt be empty.
-          auto key = submatch((*it), 2);
-          if (param.compare(key) == 0) {
-            auto value = submatch((*it), 3);
-            result.setNoCopy(value);
-            return true;
-          }
+    // The query is a list of '&' separated "key[=value]" parameters.
+    // Parameters with an empty key or more than one '=' never match.
+    const char* cur = parts.query.data();
+    const char* end = cur + parts.query.size();
+    while (cur < end) {
+      auto next = static_cast<const char*>(std::memchr(cur, '&', end - cur));
+      const char* paramEnd = next ? next : end;
+      auto equals =
+          static_cast<const char*>(std::memchr(cur, '=', paramEnd - cur));
+      const char* keyEnd = equals ? equals : paramEnd;
+      bool valid = !equals ||
+          !std::memchr(equals + 1, '=', paramEnd - equals - 1);
+      if (valid && keyEnd > cur &&
+          param.compare(StringView(cur, keyEnd - cur)) == 0) {
+        if (equals) {
+          result.setNoCopy(StringView(equals + 1, paramEnd - equals - 1));
+        } else {
+          result.setEmpty();
         }
+        return true;
+      }
+      if (!next) {
+        break;
       }
+      cur = next + 1;
     }
 
     return false;
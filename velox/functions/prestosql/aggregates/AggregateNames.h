@@ -19,6 +19,7 @@
 namespace facebook::velox::aggregate {
 
 const char* const kApproxDistinct = "approx_distinct";
+const char* const kApproxMostFrequent = "approx_most_frequent";
 const char* const kApproxSet = "approx_set";
 const char* const kApproxPercentile = "approx_percentile";
 const char* const kArbitrary = "arbitrary";
@@ -31,11 +32,13 @@ const char* const kBoolOr = "bool_or";
 const char* const kCount = "count";
 const char* const kCountIf = "count_if";
 const char* const kMapAgg = "map_agg";
+const char* const kMapUnion = "map_union";
 const char* const kMax = "max";
 const char* const kMaxBy = "max_by";
 const char* const kMerge = "merge";
 const char* const kMin = "min";
 const char* const kMinBy = "min_by";
+const char* const kMultimapAgg = "multimap_agg";
 const char* const kStdDev = "stddev"; // Alias for stddev_samp.
 const char* const kStdDevPop = "stddev_pop";
 const char* const kStdDevSamp = "stddev_samp";
@@ -47,6 +47,18 @@ struct HllAccumulator {
     }
   }
 
+  // Appends 'numHashes' hashes. Once the HLL is dense the rest go to
+  // DenseHll::insertHashes() without a check per hash.
+  void append(const uint64_t* hashes, int32_t numHashes) {
+    int32_t i = 0;
+    for (; isSparse_ && i < numHashes; ++i) {
+      append(hashes[i]);
+    }
+    if (i < numHashes) {
+      denseHll_.insertHashes(hashes + i, numHashes - i);
+    }
+  }
+
   int64_t cardinality() const {
     return isSparse_ ? sparseHll_.cardinality() : denseHll_.cardinality();
   }
@@ -243,19 +255,22 @@ class ApproxDistinctAggregate : public exec::Aggregate {
     } else {
       decodeArguments(rows, args);
 
+      hashes_.clear();
+      hashes_.reserve(rows.countSelected());
       rows.applyToSelected([&](auto row) {
-        if (decodedValue_.isNullAt(row)) {
-          return;
+        if (!decodedValue_.isNullAt(row)) {
+          hashes_.push_back(hashOne(decodedValue_.valueAt<T>(row)));
         }
-
-        auto accumulator = value<HllAccumulator>(group);
-        if (clearNull(group)) {
-          accumulator->setIndexBitLength(indexBitLength_);
-        }
-
-        auto hash = hashOne(decodedValue_.valueAt<T>(row));
-        accumulator->append(hash);
       });
+      if (hashes_.empty()) {
+        return;
+      }
+
+      auto accumulator = value<HllAccumulator>(group);
+      if (clearNull(group)) {
+        accumulator->setIndexBitLength(indexBitLength_);
+      }
+      accumulator->append(hashes_.data(), hashes_.size());
     }
   }
 
@@ -357,6 +372,8 @@ class ApproxDistinctAggregate : public exec::Aggregate {
   DecodedVector decodedValue_;
   DecodedVector decodedMaxStandardError_;
   DecodedVector decodedHll_;
+  /// Hashes of the non-null values of a batch for a single group.
+  std::vector<uint64_t> hashes_;
 };
 
 template <TypeKind kind>
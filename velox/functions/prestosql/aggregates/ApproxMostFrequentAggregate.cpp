@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/Aggregate.h"
+#include "velox/functions/prestosql/aggregates/AggregateNames.h"
+#include "velox/functions/prestosql/aggregates/StreamSummary.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/DecodedVector.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::aggregate {
+namespace {
+
+// approx_most_frequent(buckets, value, capacity) returns a map from up to
+// 'buckets' most frequent values to their approximate counts. Counts are
+// kept for up to 'capacity' distinct values in a StreamSummary. Both
+// 'buckets' and 'capacity' must be constant.
+//
+// The intermediate result is a ROW(buckets BIGINT, capacity BIGINT,
+// summary MAP(T, BIGINT)) with all the counted values of the summary.
+template <typename T>
+class ApproxMostFrequentAggregate : public exec::Aggregate {
+ public:
+  explicit ApproxMostFrequentAggregate(const TypePtr& resultType)
+      : exec::Aggregate(resultType) {}
+
+  int32_t accumulatorFixedWidthSize() const override {
+    return sizeof(StreamSummary<T>);
+  }
+
+  void initializeNewGroups(
+      char** groups,
+      folly::Range<const vector_size_t*> indices) override {
+    setAllNulls(groups, indices);
+    for (auto i : indices) {
+      new (groups[i] + offset_) StreamSummary<T>(allocator_);
+    }
+  }
+
+  void destroy(folly::Range<char**> groups) override {
+    for (auto group : groups) {
+      value<StreamSummary<T>>(group)->~StreamSummary<T>();
+    }
+  }
+
+  void finalize(char** /*groups*/, int32_t /*numGroups*/) override {}
+
+  void extractValues(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto mapVector = (*result)->as<MapVector>();
+    VELOX_CHECK(mapVector);
+    extractMaps(groups, numGroups, mapVector, true);
+  }
+
+  void extractAccumulators(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto rowVector = (*result)->as<RowVector>();
+    VELOX_CHECK(rowVector);
+    rowVector->resize(numGroups);
+    auto buckets = rowVector->childAt(0)->asFlatVector<int64_t>();
+    auto capacities = rowVector->childAt(1)->asFlatVector<int64_t>();
+    auto mapVector = rowVector->childAt(2)->as<MapVector>();
+    VELOX_CHECK(buckets);
+    VELOX_CHECK(capacities);
+
+    auto* rawNulls = getRawNulls(rowVector);
+    for (auto i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      if (isNull(group)) {
+        rowVector->setNull(i, true);
+      } else {
+        clearNull(rawNulls, i);
+        buckets->set(i, buckets_);
+        capacities->set(i, value<StreamSummary<T>>(group)->capacity());
+      }
+    }
+    extractMaps(groups, numGroups, mapVector, false);
+  }
+
+  void addRawInput(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodeArguments(rows, args);
+    rows.applyToSelected([&](auto row) {
+      if (decodedValue_.isNullAt(row)) {
+        return;
+      }
+      auto group = groups[row];
+      auto summary = value<StreamSummary<T>>(group);
+      if (clearNull(group)) {
+        summary->setCapacity(capacity_);
+      }
+      summary->insert(decodedValue_.valueAt<T>(row));
+    });
+  }
+
+  void addIntermediateResults(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodedSummary_.decode(*args[0], rows, true);
+    auto rowVector = dynamic_cast<const RowVector*>(decodedSummary_.base());
+    VELOX_CHECK(rowVector);
+    auto buckets = rowVector->childAt(0)->as<SimpleVector<int64_t>>();
+    auto capacities = rowVector->childAt(1)->as<SimpleVector<int64_t>>();
+    auto mapVector = rowVector->childAt(2)->as<MapVector>();
+    VELOX_CHECK(mapVector);
+    auto keys = mapVector->mapKeys()->as<SimpleVector<T>>();
+    auto counts = mapVector->mapValues()->as<SimpleVector<int64_t>>();
+
+    rows.applyToSelected([&](auto row) {
+      if (decodedSummary_.isNullAt(row)) {
+        return;
+      }
+      auto group = groups[row];
+      auto index = decodedSummary_.index(row);
+      checkSetBuckets(buckets->valueAt(index));
+      auto summary = value<StreamSummary<T>>(group);
+      clearNull(group);
+      summary->setCapacity(capacities->valueAt(index));
+      auto offset = mapVector->offsetAt(index);
+      auto size = mapVector->sizeAt(index);
+      for (auto i = offset; i < offset + size; ++i) {
+        summary->insert(keys->valueAt(i), counts->valueAt(i));
+      }
+    });
+  }
+
+  void addSingleGroupRawInput(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    decodeArguments(rows, args);
+    auto summary = value<StreamSummary<T>>(group);
+    rows.applyToSelected([&](auto row) {
+      if (decodedValue_.isNullAt(row)) {
+        return;
+      }
+      if (clearNull(group)) {
+        summary->setCapacity(capacity_);
+      }
+      summary->insert(decodedValue_.valueAt<T>(row));
+    });
+  }
+
+  void addSingleGroupIntermediateResults(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool mayPushdown) override {
+    std::vector<char*> groups(rows.end(), group);
+    addIntermediateResults(groups.data(), rows, args, mayPushdown);
+  }
+
+ private:
+  // Writes the counted values of each group into 'mapVector'. Only the top
+  // 'buckets_' of each group if 'topOnly'.
+  void extractMaps(
+      char** groups,
+      int32_t numGroups,
+      MapVector* mapVector,
+      bool topOnly) {
+    mapVector->resize(numGroups);
+    auto keys = mapVector->mapKeys()->asFlatVector<T>();
+    auto counts = mapVector->mapValues()->asFlatVector<int64_t>();
+    VELOX_CHECK(keys);
+    VELOX_CHECK(counts);
+
+    vector_size_t numEntries = 0;
+    for (auto i = 0; i < numGroups; ++i) {
+      if (!isNull(groups[i])) {
+        auto size = value<StreamSummary<T>>(groups[i])->size();
+        numEntries += topOnly ? std::min(size, buckets_) : size;
+      }
+    }
+    keys->resize(numEntries);
+    counts->resize(numEntries);
+
+    auto* rawNulls = getRawNulls(mapVector);
+    vector_size_t offset = 0;
+    for (auto i = 0; i < numGroups; ++i) {
+      char* group = groups[i];
+      if (isNull(group)) {
+        mapVector->setNull(i, true);
+        mapVector->setOffsetAndSize(i, offset, 0);
+        continue;
+      }
+      clearNull(rawNulls, i);
+
+      auto summary = value<StreamSummary<T>>(group);
+      vector_size_t size;
+      if (topOnly) {
+        auto topK = summary->topK(buckets_);
+        size = topK.size();
+        for (auto j = 0; j < size; ++j) {
+          keys->set(offset + j, topK[j].first);
+          counts->set(offset + j, topK[j].second);
+        }
+      } else {
+        size = summary->size();
+        for (auto j = 0; j < size; ++j) {
+          keys->set(offset + j, summary->valueAt(j));
+          counts->set(offset + j, summary->countAt(j));
+        }
+      }
+      mapVector->setOffsetAndSize(i, offset, size);
+      offset += size;
+    }
+  }
+
+  void decodeArguments(
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args) {
+    VELOX_CHECK_EQ(args.size(), 3);
+    decodedBuckets_.decode(*args[0], rows, true);
+    decodedValue_.decode(*args[1], rows, true);
+    decodedCapacity_.decode(*args[2], rows, true);
+
+    VELOX_USER_CHECK(
+        decodedBuckets_.isConstantMapping() &&
+            !decodedBuckets_.isNullAt(rows.begin()),
+        "Number of buckets must be constant and not null");
+    VELOX_USER_CHECK(
+        decodedCapacity_.isConstantMapping() &&
+            !decodedCapacity_.isNullAt(rows.begin()),
+        "Capacity must be constant and not null");
+    auto buckets = decodedBuckets_.valueAt<int64_t>(rows.begin());
+    auto capacity = decodedCapacity_.valueAt<int64_t>(rows.begin());
+    VELOX_USER_CHECK_GE(buckets, 2, "Number of buckets must be at least 2");
+    VELOX_USER_CHECK_GE(
+        capacity, buckets, "Capacity must be at least the number of buckets");
+    VELOX_USER_CHECK_LE(
+        capacity,
+        std::numeric_limits<int32_t>::max(),
+        "Capacity is too large");
+    checkSetBuckets(buckets);
+    capacity_ = capacity;
+  }
+
+  void checkSetBuckets(int64_t buckets) {
+    if (buckets_ == 0) {
+      buckets_ = buckets;
+    } else {
+      VELOX_USER_CHECK_EQ(
+          buckets,
+          buckets_,
+          "Number of buckets must be constant for all input rows");
+    }
+  }
+
+  int32_t buckets_{0};
+  int32_t capacity_{0};
+  DecodedVector decodedBuckets_;
+  DecodedVector decodedValue_;
+  DecodedVector decodedCapacity_;
+  DecodedVector decodedSummary_;
+};
+
+bool registerApproxMostFrequent(const std::string& name) {
+  exec::AggregateFunctions().Register(
+      name,
+      [name](
+          core::AggregationNode::Step step,
+          const std::vector<TypePtr>& argTypes,
+          const TypePtr& resultType) -> std::unique_ptr<exec::Aggregate> {
+        auto isRawInput = exec::isRawInput(step);
+        TypePtr valueType;
+        if (isRawInput) {
+          VELOX_USER_CHECK_EQ(
+              argTypes.size(), 3, "{} takes 3 arguments", name);
+          VELOX_USER_CHECK_EQ(
+              argTypes[0]->kind(),
+              TypeKind::BIGINT,
+              "The number of buckets of {} must be BIGINT",
+              name);
+          VELOX_USER_CHECK_EQ(
+              argTypes[2]->kind(),
+              TypeKind::BIGINT,
+              "The capacity of {} must be BIGINT",
+              name);
+          valueType = argTypes[1];
+        } else {
+          VELOX_USER_CHECK(
+              argTypes.size() == 1 && argTypes[0]->kind() == TypeKind::ROW &&
+                  argTypes[0]->size() == 3,
+              "Unexpected partial result type for {}",
+              name);
+          valueType = argTypes[0]->childAt(2)->childAt(0);
+        }
+
+        auto aggResultType = exec::isPartialOutput(step)
+            ? ROW({"buckets", "capacity", "summary"},
+                  {BIGINT(), BIGINT(), MAP(valueType, BIGINT())})
+            : MAP(valueType, BIGINT());
+        switch (valueType->kind()) {
+          case TypeKind::TINYINT:
+            return std::make_unique<ApproxMostFrequentAggregate<int8_t>>(
+                aggResultType);
+          case TypeKind::SMALLINT:
+            return std::make_unique<ApproxMostFrequentAggregate<int16_t>>(
+                aggResultType);
+          case TypeKind::INTEGER:
+            return std::make_unique<ApproxMostFrequentAggregate<int32_t>>(
+                aggResultType);
+          case TypeKind::BIGINT:
+            return std::make_unique<ApproxMostFrequentAggregate<int64_t>>(
+                aggResultType);
+          case TypeKind::VARCHAR:
+            return std::make_unique<ApproxMostFrequentAggregate<StringView>>(
+                aggResultType);
+          default:
+            VELOX_USER_FAIL(
+                "Unsupported value type for {} aggregation {}",
+                name,
+                valueType->toString());
+        }
+      });
+  return true;
+}
+
+static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
+    registerApproxMostFrequent(kApproxMostFrequent);
+
+} // namespace
+} // namespace facebook::velox::aggregate
@@ -13,193 +13,32 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#include <folly/stats/TDigest.h>
 #include "velox/exec/Aggregate.h"
 #include "velox/exec/HashStringAllocator.h"
 #include "velox/functions/prestosql/aggregates/AggregateNames.h"
 #include "velox/functions/prestosql/aggregates/IOUtils.h"
+#include "velox/functions/prestosql/aggregates/KllSketch.h"
+#include "velox/vector/ComplexVector.h"
 #include "velox/vector/DecodedVector.h"
 #include "velox/vector/FlatVector.h"
 
 namespace facebook::velox::aggregate {
 namespace {
-int32_t serializedSize(const folly::TDigest& digest) {
-  return sizeof(size_t) + // maxSize
-      4 * sizeof(double) + // sum, count, min, max
-      sizeof(size_t) + // number of centroids
-      2 * sizeof(double) * digest.getCentroids().size();
-}
-
-template <typename TByteStream>
-void serialize(const folly::TDigest& digest, TByteStream& output) {
-  output.appendOne(digest.maxSize());
-  output.appendOne(digest.sum());
-  output.appendOne(digest.count());
-  output.appendOne(digest.min());
-  output.appendOne(digest.max());
-
-  const auto& centroids = digest.getCentroids();
-  output.appendOne(centroids.size());
-  for (const auto& centroid : centroids) {
-    output.appendOne(centroid.mean());
-    output.appendOne(centroid.weight());
-  }
-}
-
-template <typename TByteStream>
-folly::TDigest deserialize(TByteStream& input) {
-  auto maxSize = input.template read<size_t>();
-  auto sum = input.template read<double>();
-  auto count = input.template read<double>();
-  auto min = input.template read<double>();
-  auto max = input.template read<double>();
-
-  auto centroidCount = input.template read<size_t>();
-  std::vector<folly::TDigest::Centroid> centroids;
-  centroids.reserve(centroidCount);
-  for (auto i = 0; i < centroidCount; i++) {
-    auto mean = input.template read<double>();
-    auto weight = input.template read<double>();
-    centroids.emplace_back(folly::TDigest::Centroid(mean, weight));
-  }
-
-  return folly::TDigest(std::move(centroids), sum, count, max, min, maxSize);
-}
-
-template <typename T>
-folly::TDigest singleValueDigest(T v, int64_t count) {
-  return folly::TDigest(
-      {folly::TDigest::Centroid(v, count)}, v * count, count, v, v);
-}
-
-struct TDigestAccumulator {
-  explicit TDigestAccumulator(exec::HashStringAllocator* allocator)
-      : values_{exec::StlAllocator<double>(allocator)},
-        largeCountValues_{exec::StlAllocator<double>(allocator)},
-        largeCounts_{exec::StlAllocator<int64_t>(allocator)} {}
-
-  void write(
-      const folly::TDigest& digest,
-      exec::HashStringAllocator* allocator) {
-    if (!begin_) {
-      begin_ = allocator->allocate(serializedSize(digest));
-    }
-
-    ByteStream stream(allocator);
-    allocator->extendWrite({begin_, begin_->begin()}, stream);
-    serialize(digest, stream);
-    allocator->finishWrite(stream, 0);
-  }
-
-  folly::TDigest read() const {
-    VELOX_CHECK(begin_);
-
-    ByteStream inStream;
-    exec::HashStringAllocator::prepareRead(begin_, inStream);
-    return deserialize(inStream);
-  }
-
-  bool hasValue() const {
-    return begin_ != nullptr;
-  }
-
-  void destroy(exec::HashStringAllocator* allocator) {
-    if (begin_) {
-      allocator->free(begin_);
-    }
-  }
-
-  template <typename T>
-  void append(T v, exec::HashStringAllocator* allocator) {
-    values_.emplace_back((double)v);
-
-    if (values_.size() >= kMaxBufferSize) {
-      flush(allocator);
-    }
-  }
-
-  template <typename T>
-  void append(T v, int64_t count, exec::HashStringAllocator* allocator) {
-    static const int64_t kMaxCountToBuffer = 99;
-
-    if (values_.size() + count <= kMaxBufferSize &&
-        count <= kMaxCountToBuffer) {
-      values_.reserve(values_.size() + count);
-      for (auto i = 0; i < count; i++) {
-        values_.emplace_back((double)v);
-      }
-
-      if (values_.size() >= kMaxBufferSize) {
-        flush(allocator);
-      }
-    } else {
-      largeCountValues_.emplace_back(v);
-      largeCounts_.emplace_back(count);
-      if (largeCountValues_.size() >= kMaxBufferSize) {
-        flush(allocator);
-      }
-    }
-  }
-
-  void append(folly::TDigest digest, exec::HashStringAllocator* allocator) {
-    if (hasValue()) {
-      auto currentDigest = read();
-      std::vector<folly::TDigest> digests = {
-          std::move(currentDigest), std::move(digest)};
-      auto combinedDigest =
-          folly::TDigest::merge(folly::Range(digests.data(), digests.size()));
-      write(combinedDigest, allocator);
-    } else {
-      write(digest, allocator);
-    }
-  }
-
-  void flush(exec::HashStringAllocator* allocator) {
-    if (!values_.empty()) {
-      folly::TDigest digest{hasValue() ? read() : folly::TDigest()};
-      digest = digest.merge(values_);
-      values_.clear();
-      write(digest, allocator);
-    }
-
-    if (!largeCountValues_.empty()) {
-      std::vector<folly::TDigest> digests;
-      digests.reserve(largeCountValues_.size() + 1);
-      for (auto i = 0; i < largeCountValues_.size(); i++) {
-        digests.emplace_back(
-            singleValueDigest(largeCountValues_[i], largeCounts_[i]));
-      }
-
-      if (hasValue()) {
-        digests.emplace_back(read());
-      }
-
-      auto combinedDigest =
-          folly::TDigest::merge(folly::Range(digests.data(), digests.size()));
-      largeCountValues_.clear();
-      largeCounts_.clear();
-
-      write(combinedDigest, allocator);
-    }
-  }
-
- private:
-  // Maximum number of values to accumulate before updating TDigest.
-  static const size_t kMaxBufferSize = 4096;
-
-  exec::HashStringAllocator::Header* begin_{nullptr};
-
-  std::vector<double, exec::StlAllocator<double>> values_;
-
-  std::vector<double, exec::StlAllocator<double>> largeCountValues_;
-  std::vector<int64_t, exec::StlAllocator<int64_t>> largeCounts_;
-};
+// Sketch kept in the group row. Its levels live in the HashStringAllocator.
+using KllSketchAccumulator = KllSketch<exec::StlAllocator<double>>;
 
 // The following variations are possible:
 //  x, percentile
 //  x, weight, percentile
 //  x, percentile, accuracy (not supported yet)
 //  x, weight, percentile, accuracy (not supported yet)
+//
+// 'percentile' is a DOUBLE or an ARRAY(DOUBLE). An array returns an array
+// with one result per percentile, all estimated from one sketch.
+//
+// The intermediate result is a VARBINARY: an int8 that is 1 for an array of
+// percentiles, the int32 number of percentiles, the percentiles as doubles
+// and then the serialized sketch.
 template <typename T>
 class ApproxPercentileAggregate : public exec::Aggregate {
  public:
@@ -207,7 +46,7 @@ class ApproxPercentileAggregate : public exec::Aggregate {
       : exec::Aggregate(resultType), hasWeight_{hasWeight} {}
 
   int32_t accumulatorFixedWidthSize() const override {
-    return sizeof(TDigestAccumulator);
+    return sizeof(KllSketchAccumulator);
   }
 
   void initializeNewGroups(
@@ -216,37 +55,36 @@ class ApproxPercentileAggregate : public exec::Aggregate {
     exec::Aggregate::setAllNulls(groups, indices);
     for (auto i : indices) {
       auto group = groups[i];
-      new (group + offset_) TDigestAccumulator(allocator_);
+      new (group + offset_)
+          KllSketchAccumulator(exec::StlAllocator<double>(allocator_));
     }
   }
 
   void destroy(folly::Range<char**> groups) override {
     for (auto group : groups) {
-      auto accumulator = value<TDigestAccumulator>(group);
-      accumulator->destroy(allocator_);
+      value<KllSketchAccumulator>(group)->~KllSketchAccumulator();
     }
   }
 
-  void finalize(char** groups, int32_t numGroups) override {
-    for (auto i = 0; i < numGroups; ++i) {
-      auto accumulator = value<TDigestAccumulator>(groups[i]);
-      accumulator->flush(allocator_);
-    }
-  }
+  void finalize(char** /*groups*/, int32_t /*numGroups*/) override {}
 
   void extractValues(char** groups, int32_t numGroups, VectorPtr* result)
       override {
     VELOX_CHECK(result);
-    auto flatResult = (*result)->asFlatVector<T>();
+    if (isArray_) {
+      extractArrays(groups, numGroups, (*result)->as<ArrayVector>());
+      return;
+    }
 
+    auto flatResult = (*result)->asFlatVector<T>();
     extract(
         groups,
         numGroups,
         flatResult,
-        [&](const folly::TDigest& digest,
+        [&](const KllSketchAccumulator& sketch,
             FlatVector<T>* result,
             vector_size_t index) {
-          result->set(index, (T)digest.estimateQuantile(percentile_));
+          result->set(index, (T)sketch.estimateQuantile(percentiles_[0]));
         });
   }
 
@@ -259,15 +97,20 @@ class ApproxPercentileAggregate : public exec::Aggregate {
         groups,
         numGroups,
         flatResult,
-        [&](const folly::TDigest& digest,
+        [&](const KllSketchAccumulator& sketch,
             FlatVector<StringView>* result,
             vector_size_t index) {
-          auto size = sizeof(double) /*percentile*/ + serializedSize(digest);
+          auto size = sizeof(int8_t) + sizeof(int32_t) +
+              sizeof(double) * percentiles_.size() + sketch.serializedSize();
           Buffer* buffer = flatResult->getBufferWithSpace(size);
           StringView serialized(buffer->as<char>() + buffer->size(), size);
           OutputByteStream stream(buffer->asMutable<char>() + buffer->size());
-          stream.appendOne(percentile_);
-          serialize(digest, stream);
+          stream.appendOne<int8_t>(isArray_);
+          stream.appendOne<int32_t>(percentiles_.size());
+          stream.append(
+              reinterpret_cast<const char*>(percentiles_.data()),
+              sizeof(double) * percentiles_.size());
+          sketch.serialize(stream);
           buffer->setSize(buffer->size() + size);
           result->setNoCopy(index, serialized);
         });
@@ -279,7 +122,7 @@ class ApproxPercentileAggregate : public exec::Aggregate {
       const std::vector<VectorPtr>& args,
       bool /*mayPushdown*/) override {
     decodeArguments(rows, args);
-    checkSetPercentile();
+    checkSetPercentiles(rows);
 
     if (hasWeight_) {
       rows.applyToSelected([&](auto row) {
@@ -287,31 +130,28 @@ class ApproxPercentileAggregate : public exec::Aggregate {
           return;
         }
 
-        auto accumulator = value<TDigestAccumulator>(groups[row]);
+        auto group = groups[row];
+        auto accumulator = value<KllSketchAccumulator>(group);
         auto value = decodedValue_.valueAt<T>(row);
         auto weight = decodedWeight_.valueAt<int64_t>(row);
         VELOX_USER_CHECK_GE(
             weight,
             1,
             "The value of the weight parameter must be greater than or equal to 1.");
-        accumulator->append(value, weight, allocator_);
+        clearNull(group);
+        accumulator->insert(value, weight);
       });
     } else {
-      if (decodedValue_.mayHaveNulls()) {
-        rows.applyToSelected([&](auto row) {
-          if (decodedValue_.isNullAt(row)) {
-            return;
-          }
+      rows.applyToSelected([&](auto row) {
+        if (decodedValue_.isNullAt(row)) {
+          return;
+        }
 
-          auto accumulator = value<TDigestAccumulator>(groups[row]);
-          accumulator->append(decodedValue_.valueAt<T>(row), allocator_);
-        });
-      } else {
-        rows.applyToSelected([&](auto row) {
-          auto accumulator = value<TDigestAccumulator>(groups[row]);
-          accumulator->append(decodedValue_.valueAt<T>(row), allocator_);
-        });
-      }
+        auto group = groups[row];
+        clearNull(group);
+        value<KllSketchAccumulator>(group)->insert(
+            decodedValue_.valueAt<T>(row));
+      });
     }
   }
 
@@ -320,21 +160,19 @@ class ApproxPercentileAggregate : public exec::Aggregate {
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
       bool /*mayPushdown*/) override {
-    decodedDigest_.decode(*args[0], rows, true);
+    decodedSketch_.decode(*args[0], rows, true);
 
     rows.applyToSelected([&](auto row) {
-      if (decodedDigest_.isNullAt(row)) {
+      if (decodedSketch_.isNullAt(row)) {
         return;
       }
 
-      auto serialized = decodedDigest_.valueAt<StringView>(row);
+      auto group = groups[row];
+      auto serialized = decodedSketch_.valueAt<StringView>(row);
       InputByteStream stream(serialized.data());
-      auto percentile = stream.read<double>();
-      checkSetPercentile(percentile);
-      auto digest = deserialize(stream);
-
-      auto accumulator = value<TDigestAccumulator>(groups[row]);
-      accumulator->append(std::move(digest), allocator_);
+      readPercentiles(stream);
+      clearNull(group);
+      value<KllSketchAccumulator>(group)->mergeSerialized(stream);
     });
   }
 
@@ -344,9 +182,9 @@ class ApproxPercentileAggregate : public exec::Aggregate {
       const std::vector<VectorPtr>& args,
       bool /*mayPushdown*/) override {
     decodeArguments(rows, args);
-    checkSetPercentile();
+    checkSetPercentiles(rows);
 
-    auto accumulator = value<TDigestAccumulator>(group);
+    auto accumulator = value<KllSketchAccumulator>(group);
 
     if (hasWeight_) {
       rows.applyToSelected([&](auto row) {
@@ -360,22 +198,29 @@ class ApproxPercentileAggregate : public exec::Aggregate {
             weight,
             1,
             "The value of the weight parameter must be greater than or equal to 1.");
-        accumulator->append(value, weight, allocator_);
+        clearNull(group);
+        accumulator->insert(value, weight);
       });
-    } else {
-      if (decodedValue_.mayHaveNulls()) {
-        rows.applyToSelected([&](auto row) {
-          if (decodedValue_.isNullAt(row)) {
-            return;
-          }
+      return;
+    }
 
-          accumulator->append(decodedValue_.valueAt<T>(row), allocator_);
-        });
-      } else {
-        rows.applyToSelected([&](auto row) {
-          accumulator->append(decodedValue_.valueAt<T>(row), allocator_);
-        });
-      }
+    // Collects the values of the batch and adds them to the sketch at once.
+    values_.clear();
+    values_.reserve(rows.countSelected());
+    if (decodedValue_.mayHaveNulls()) {
+      rows.applyToSelected([&](auto row) {
+        if (!decodedValue_.isNullAt(row)) {
+          values_.push_back(decodedValue_.valueAt<T>(row));
+        }
+      });
+    } else {
+      rows.applyToSelected([&](auto row) {
+        values_.push_back(decodedValue_.valueAt<T>(row));
+      });
+    }
+    if (!values_.empty()) {
+      clearNull(group);
+      accumulator->insert(values_.data(), values_.size());
     }
   }
 
@@ -383,34 +228,9 @@ class ApproxPercentileAggregate : public exec::Aggregate {
       char* group,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
-    decodedDigest_.decode(*args[0], rows, true);
-    auto accumulator = value<TDigestAccumulator>(group);
-
-    std::vector<folly::TDigest> digests;
-    digests.reserve(rows.end() + 1);
-    if (accumulator->hasValue()) {
-      digests.emplace_back(accumulator->read());
-    }
-
-    rows.applyToSelected([&](auto row) {
-      if (decodedDigest_.isNullAt(row)) {
-        return;
-      }
-
-      auto serialized = decodedDigest_.valueAt<StringView>(row);
-      InputByteStream stream(serialized.data());
-      auto percentile = stream.read<double>();
-      checkSetPercentile(percentile);
-
-      digests.emplace_back(deserialize(stream));
-    });
-
-    if (!digests.empty()) {
-      auto digest =
-          folly::TDigest::merge(folly::Range(digests.data(), digests.size()));
-      accumulator->write(digest, allocator_);
-    }
+      bool mayPushdown) override {
+    std::vector<char*> groups(rows.end(), group);
+    addIntermediateResults(groups.data(), rows, args, mayPushdown);
   }
 
  private:
@@ -423,25 +243,46 @@ class ApproxPercentileAggregate : public exec::Aggregate {
     VELOX_CHECK(result);
     result->resize(numGroups);
 
-    uint64_t* rawNulls = nullptr;
-    if (result->mayHaveNulls()) {
-      BufferPtr nulls = result->mutableNulls(result->size());
-      rawNulls = nulls->asMutable<uint64_t>();
+    uint64_t* rawNulls = getRawNulls(result);
+    for (auto i = 0; i < numGroups; ++i) {
+      auto sketch = value<KllSketchAccumulator>(groups[i]);
+      if (sketch->count() == 0) {
+        result->setNull(i, true);
+      } else {
+        clearNull(rawNulls, i);
+        extractFunction(*sketch, result, i);
+      }
     }
+  }
 
+  void extractArrays(char** groups, int32_t numGroups, ArrayVector* result) {
+    VELOX_CHECK(result);
+    result->resize(numGroups);
+    auto elements = result->elements()->asFlatVector<T>();
+    VELOX_CHECK(elements);
+    auto numPercentiles = percentiles_.size();
+    elements->resize(numGroups * numPercentiles);
+
+    uint64_t* rawNulls = getRawNulls(result);
+    std::vector<double> quantiles(numPercentiles);
+    vector_size_t offset = 0;
     for (auto i = 0; i < numGroups; ++i) {
-      char* group = groups[i];
-      auto accumulator = value<TDigestAccumulator>(group);
-      if (!accumulator->hasValue()) {
+      auto sketch = value<KllSketchAccumulator>(groups[i]);
+      if (sketch->count() == 0) {
         result->setNull(i, true);
-      } else {
-        if (rawNulls) {
-          bits::clearBit(rawNulls, i);
-        }
-        auto digest = accumulator->read();
-        extractFunction(digest, result, i);
+        result->setOffsetAndSize(i, offset, 0);
+        continue;
       }
+      clearNull(rawNulls, i);
+      sketch->estimateQuantiles(
+          percentiles_.data(), numPercentiles, quantiles.data());
+      for (auto j = 0; j < numPercentiles; ++j) {
+        elements->set(offset + j, (T)quantiles[j]);
+      }
+      result->setOffsetAndSize(i, offset, numPercentiles);
+      offset += numPercentiles;
     }
+    elements->resize(offset);
   }
 
   void decodeArguments(
@@ -458,35 +299,85 @@ class ApproxPercentileAggregate : public exec::Aggregate {
     VELOX_CHECK_EQ(argIndex, args.size());
   }
 
-  void checkSetPercentile() {
-    VELOX_CHECK(
-        decodedPercentile_.isConstantMapping(),
-        "Percentile argument must be constant for all input rows");
+  // Reads the percentiles from the percentile argument. An array of
+  // percentiles must be the same on all rows, a single percentile must be
+  // constant.
+  void checkSetPercentiles(const SelectivityVector& rows) {
+    if (decodedPercentile_.base()->typeKind() != TypeKind::ARRAY) {
+      VELOX_CHECK(
+          decodedPercentile_.isConstantMapping(),
+          "Percentile argument must be constant for all input rows");
+      auto percentile = decodedPercentile_.valueAt<double>(0);
+      checkSetPercentiles(false, &percentile, 1);
+      return;
+    }
 
-    auto percentile = decodedPercentile_.valueAt<double>(0);
-    checkSetPercentile(percentile);
+    auto arrays = decodedPercentile_.base()->as<ArrayVector>();
+    auto elements = arrays->elements()->asFlatVector<double>();
+    VELOX_CHECK(elements, "Percentile array elements must be flat");
+    auto checkRow = [&](vector_size_t row) {
+      VELOX_USER_CHECK(
+          !decodedPercentile_.isNullAt(row), "Percentile cannot be null");
+      auto index = decodedPercentile_.index(row);
+      auto offset = arrays->offsetAt(index);
+      auto size = arrays->sizeAt(index);
+      for (auto i = offset; i < offset + size; ++i) {
+        VELOX_USER_CHECK(!elements->isNullAt(i), "Percentile cannot be null");
+      }
+      checkSetPercentiles(true, elements->rawValues() + offset, size);
+    };
+    if (decodedPercentile_.isConstantMapping()) {
+      checkRow(rows.begin());
+    } else {
+      rows.applyToSelected(checkRow);
+    }
   }
 
-  void checkSetPercentile(double percentile) {
-    VELOX_USER_CHECK_GE(percentile, 0, "Percentile must be between 0 and 1");
-    VELOX_USER_CHECK_LE(percentile, 1, "Percentile must be between 0 and 1");
+  void readPercentiles(InputByteStream& stream) {
+    auto isArray = stream.read<int8_t>();
+    auto numPercentiles = stream.read<int32_t>();
+    checkSetPercentiles(
+        isArray, stream.read<double>(numPercentiles), numPercentiles);
+  }
+
+  void checkSetPercentiles(
+      bool isArray,
+      const double* percentiles,
+      size_t numPercentiles) {
+    for (auto i = 0; i < numPercentiles; ++i) {
+      VELOX_USER_CHECK_GE(
+          percentiles[i], 0, "Percentile must be between 0 and 1");
+      VELOX_USER_CHECK_LE(
+          percentiles[i], 1, "Percentile must be between 0 and 1");
+    }
 
-    if (percentile_ < 0) {
-      percentile_ = percentile;
+    if (!hasPercentiles_) {
+      VELOX_USER_CHECK(
+          isArray || numPercentiles == 1, "Expected a single percentile");
+      isArray_ = isArray;
+      percentiles_.assign(percentiles, percentiles + numPercentiles);
+      hasPercentiles_ = true;
     } else {
-      VELOX_USER_CHECK_EQ(
-          percentile,
-          percentile_,
+      VELOX_USER_CHECK(
+          isArray == isArray_ && numPercentiles == percentiles_.size() &&
+              std::equal(
+                  percentiles,
+                  percentiles + numPercentiles,
+                  percentiles_.begin()),
           "Percentile argument must be constant for all input rows");
     }
   }
 
   const bool hasWeight_;
-  double percentile_{-1.0};
+  bool hasPercentiles_{false};
+  bool isArray_{false};
+  std::vector<double> percentiles_;
+  // Values of a batch for a single group.
+  std::vector<double> values_;
   DecodedVector decodedValue_;
   DecodedVector decodedWeight_;
   DecodedVector decodedPercentile_;
-  DecodedVector decodedDigest_;
+  DecodedVector decodedSketch_;
 };
 
 bool registerApproxPercentile(const std::string& name) {
@@ -516,10 +407,13 @@ bool registerApproxPercentile(const std::string& name) {
                 name);
           }
 
-          VELOX_USER_CHECK_EQ(
-              argTypes.back()->kind(),
-              TypeKind::DOUBLE,
-              "The type of the percentile argument of {} must be DOUBLE",
+          const auto& percentileType = argTypes.back();
+          VELOX_USER_CHECK(
+              percentileType->kind() == TypeKind::DOUBLE ||
+                  (percentileType->kind() == TypeKind::ARRAY &&
+                   percentileType->childAt(0)->kind() == TypeKind::DOUBLE),
+              "The type of the percentile argument of {} must be DOUBLE or "
+              "ARRAY(DOUBLE)",
               name);
         } else {
           VELOX_USER_CHECK_EQ(
@@ -539,8 +433,19 @@ bool registerApproxPercentile(const std::string& name) {
               false, VARBINARY());
         }
 
-        auto aggResultType =
-            isPartialOutput ? VARBINARY() : (isRawInput ? type : resultType);
+        TypePtr aggResultType;
+        if (isPartialOutput) {
+          aggResultType = VARBINARY();
+        } else if (isRawInput) {
+          aggResultType = argTypes.back()->kind() == TypeKind::ARRAY
+              ? ARRAY(type)
+              : type;
+        } else {
+          aggResultType = resultType;
+          if (resultType->kind() == TypeKind::ARRAY) {
+            type = resultType->childAt(0);
+          }
+        }
 
         switch (type->kind()) {
           case TypeKind::TINYINT:
@@ -51,12 +51,18 @@ class CountAggregate : public SimpleNumericAggregate<bool, int64_t, int64_t> {
       char** groups,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
     if (args.empty()) {
       rows.applyToSelected([&](vector_size_t i) { addToGroup(groups[i], 1); });
       return;
     }
 
+    // Only the readers of scalar types pass their values to a ValueHook.
+    if (mayPushdown && args[0]->type()->isPrimitiveType()) {
+      BaseAggregate::template pushdown<CountHook>(groups, rows, args[0]);
+      return;
+    }
+
     DecodedVector decoded(*args[0], rows);
     if (decoded.isConstantMapping()) {
       if (!decoded.isNullAt(0)) {
@@ -93,12 +99,18 @@ class CountAggregate : public SimpleNumericAggregate<bool, int64_t, int64_t> {
       char* group,
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
-      bool /*mayPushdown*/) override {
+      bool mayPushdown) override {
     if (args.empty()) {
       addToGroup(group, rows.size());
       return;
     }
 
+    if (mayPushdown && args[0]->type()->isPrimitiveType()) {
+      BaseAggregate::template pushdownOneGroup<CountHook>(
+          group, rows, args[0]);
+      return;
+    }
+
     DecodedVector decoded(*args[0], rows);
     if (decoded.isConstantMapping()) {
       if (!decoded.isNullAt(0)) {
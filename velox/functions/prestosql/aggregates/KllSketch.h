@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "velox/common/base/Exceptions.h"
+#include "velox/functions/prestosql/aggregates/IOUtils.h"
+
+namespace facebook::velox::aggregate {
+
+// Quantile sketch of Karnin, Lang and Liberty, "Optimal Quantile
+// Approximation in Streams". The values are kept in levels, where a value at
+// level h stands for 2^h input values. When a level is full it is sorted and
+// every other value moves up a level. Which half moves alternates per level,
+// so the sketch is deterministic and the rank error of a quantile is about
+// 1.7 / 'k' of the count. Sketches with the same 'k' merge by concatenating
+// their levels, with the same error bound.
+//
+// 'Allocator' allocates doubles, e.g. exec::StlAllocator<double> to keep a
+// sketch per group in a HashStringAllocator.
+template <typename Allocator = std::allocator<double>>
+class KllSketch {
+ public:
+  static constexpr uint32_t kDefaultK = 200;
+
+  explicit KllSketch(
+      const Allocator& allocator = Allocator(),
+      uint32_t k = kDefaultK)
+      : allocator_(allocator), k_(k), levels_(LevelAllocator(allocator)) {
+    VELOX_CHECK_GE(k_, kMinWidth);
+  }
+
+  uint32_t k() const {
+    return k_;
+  }
+
+  // Number of values inserted, counting weights.
+  uint64_t count() const {
+    return count_;
+  }
+
+  void insert(double value) {
+    ensureLevels(1);
+    levels_[0].push_back(value);
+    updateMinMax(value);
+    ++count_;
+    if (++numRetained_ > maxRetained_) {
+      compress();
+    }
+  }
+
+  // Inserts 'value' as if it was inserted 'weight' times. A set bit h of
+  // 'weight' adds one copy at level h, which counts for 2^h values.
+  void insert(double value, uint64_t weight) {
+    VELOX_CHECK_GT(weight, 0);
+    ensureLevels(64 - __builtin_clzll(weight));
+    for (auto bits = weight; bits; bits &= bits - 1) {
+      levels_[__builtin_ctzll(bits)].push_back(value);
+      ++numRetained_;
+    }
+    updateMinMax(value);
+    count_ += weight;
+    if (numRetained_ > maxRetained_) {
+      compress();
+    }
+  }
+
+  // Inserts 'numValues' values. Appends them to level 0 in chunks that fit
+  // before compressing, so that the work per value is a copy.
+  void insert(const double* values, size_t numValues) {
+    ensureLevels(1);
+    size_t i = 0;
+    while (i < numValues) {
+      auto chunk = std::min<size_t>(
+          numValues - i, std::max<size_t>(1, maxRetained_ - numRetained_));
+      auto& level = levels_[0];
+      level.insert(level.end(), values + i, values + i + chunk);
+      for (auto j = i; j < i + chunk; ++j) {
+        updateMinMax(values[j]);
+      }
+      count_ += chunk;
+      numRetained_ += chunk;
+      i += chunk;
+      if (numRetained_ > maxRetained_) {
+        compress();
+      }
+    }
+  }
+
+  // Adds the values of 'other' to 'this'.
+  void merge(const KllSketch& other) {
+    VELOX_CHECK_EQ(k_, other.k_, "Cannot merge KLL sketches of different k");
+    if (other.count_ == 0) {
+      return;
+    }
+    ensureLevels(other.levels_.size());
+    for (size_t h = 0; h < other.levels_.size(); ++h) {
+      const auto& from = other.levels_[h];
+      levels_[h].insert(levels_[h].end(), from.begin(), from.end());
+      numRetained_ += from.size();
+    }
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    count_ += other.count_;
+    if (numRetained_ > maxRetained_) {
+      compress();
+    }
+  }
+
+  // Returns the smallest value whose rank, counting weights, is above
+  // 'quantile' * count(). Quantiles 0 and 1 return the exact minimum and
+  // maximum. The sketch must not be empty.
+  double estimateQuantile(double quantile) const {
+    double result;
+    estimateQuantiles(&quantile, 1, &result);
+    return result;
+  }
+
+  // Fills 'results' with the estimates of 'numQuantiles' 'quantiles'. Sorts
+  // the retained values once for all quantiles.
+  void estimateQuantiles(
+      const double* quantiles,
+      size_t numQuantiles,
+      double* results) const {
+    VELOX_CHECK_GT(count_, 0, "Quantile of an empty KLL sketch");
+    std::vector<std::pair<double, uint64_t>> entries;
+    entries.reserve(numRetained_);
+    for (size_t h = 0; h < levels_.size(); ++h) {
+      for (auto value : levels_[h]) {
+        entries.emplace_back(value, 1UL << h);
+      }
+    }
+    std::sort(entries.begin(), entries.end());
+    uint64_t rank = 0;
+    for (auto& entry : entries) {
+      rank += entry.second;
+      entry.second = rank;
+    }
+    for (size_t i = 0; i < numQuantiles; ++i) {
+      auto quantile = quantiles[i];
+      if (quantile <= 0) {
+        results[i] = min_;
+      } else if (quantile >= 1) {
+        results[i] = max_;
+      } else {
+        auto target = static_cast<uint64_t>(quantile * count_);
+        auto it = std::upper_bound(
+            entries.begin(),
+            entries.end(),
+            target,
+            [](uint64_t rank, const auto& entry) {
+              return rank < entry.second;
+            });
+        results[i] = it == entries.end() ? max_ : it->first;
+      }
+    }
+  }
+
+  int32_t serializedSize() const {
+    return sizeof(int32_t) + // k
+        sizeof(uint64_t) + // count
+        2 * sizeof(double) + // min, max
+        sizeof(int32_t) + // number of levels
+        sizeof(int32_t) * levels_.size() + // level sizes
+        sizeof(double) * numRetained_;
+  }
+
+  // Writes 'this' in serializedSize() bytes at 'output'.
+  void serialize(OutputByteStream& output) const {
+    output.appendOne<int32_t>(k_);
+    output.appendOne<uint64_t>(count_);
+    output.appendOne(min_);
+    output.appendOne(max_);
+    output.appendOne<int32_t>(levels_.size());
+    for (const auto& level : levels_) {
+      output.appendOne<int32_t>(level.size());
+      output.append(
+          reinterpret_cast<const char*>(level.data()),
+          level.size() * sizeof(double));
+    }
+  }
+
+  // Adds the serialized sketch at 'input' to 'this'. Same as merge() without
+  // materializing the other sketch.
+  void mergeSerialized(InputByteStream& input) {
+    auto k = input.read<int32_t>();
+    VELOX_CHECK_EQ(k_, k, "Cannot merge KLL sketches of different k");
+    auto count = input.read<uint64_t>();
+    auto min = input.read<double>();
+    auto max = input.read<double>();
+    auto numLevels = input.read<int32_t>();
+    ensureLevels(numLevels);
+    for (int32_t h = 0; h < numLevels; ++h) {
+      auto size = input.read<int32_t>();
+      auto values = input.read<double>(size);
+      levels_[h].insert(levels_[h].end(), values, values + size);
+      numRetained_ += size;
+    }
+    if (count == 0) {
+      return;
+    }
+    min_ = std::min(min_, min);
+    max_ = std::max(max_, max);
+    count_ += count;
+    if (numRetained_ > maxRetained_) {
+      compress();
+    }
+  }
+
+ private:
+  using Level = std::vector<double, Allocator>;
+  using LevelAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Level>;
+
+  // Smallest capacity of a level.
+  static constexpr uint32_t kMinWidth = 8;
+
+  // Capacity of level 'h'. The top level holds 'k_' values and each level
+  // below holds 2/3 of the one above.
+  size_t capacity(size_t h) const {
+    auto depth = levels_.size() - 1 - h;
+    return std::max<size_t>(
+        kMinWidth, std::ceil(k_ * std::pow(2.0 / 3.0, depth)));
+  }
+
+  void ensureLevels(size_t numLevels) {
+    if (levels_.size() >= numLevels) {
+      return;
+    }
+    while (levels_.size() < numLevels) {
+      levels_.emplace_back(allocator_);
+    }
+    updateMaxRetained();
+  }
+
+  void updateMaxRetained() {
+    maxRetained_ = 0;
+    for (size_t h = 0; h < levels_.size(); ++h) {
+      maxRetained_ += capacity(h);
+    }
+  }
+
+  void updateMinMax(double value) {
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  // Compacts the lowest full level until the sketch is within capacity.
+  // While it is above capacity, some level is above its own capacity.
+  void compress() {
+    while (numRetained_ > maxRetained_) {
+      for (size_t h = 0; h < levels_.size(); ++h) {
+        if (levels_[h].size() >= capacity(h)) {
+          compact(h);
+          break;
+        }
+      }
+    }
+  }
+
+  // Moves every other value of level 'h', sorted, to level h + 1. Keeps one
+  // value at 'h' if the level has an odd size.
+  void compact(size_t h) {
+    if (h + 1 == levels_.size()) {
+      ensureLevels(h + 2);
+    }
+    auto& level = levels_[h];
+    auto& next = levels_[h + 1];
+    std::sort(level.begin(), level.end());
+    // An odd value out stays, the rest pairs up.
+    auto begin = level.size() % 2;
+    auto offset = (compactionParity_ >> h) & 1;
+    compactionParity_ ^= 1UL << h;
+    auto numPairs = (level.size() - begin) / 2;
+    for (auto i = begin + offset; i < level.size(); i += 2) {
+      next.push_back(level[i]);
+    }
+    level.resize(begin);
+    numRetained_ -= numPairs;
+  }
+
+  Allocator allocator_;
+  const uint32_t k_;
+  std::vector<Level, LevelAllocator> levels_;
+  uint64_t count_{0};
+  uint64_t numRetained_{0};
+  uint64_t maxRetained_{0};
+  // Bit h selects whether the next compaction of level h keeps the even or
+  // the odd values.
+  uint64_t compactionParity_{0};
+  double min_{std::numeric_limits<double>::infinity()};
+  double max_{-std::numeric_limits<double>::infinity()};
+};
+
+} // namespace facebook::velox::aggregate
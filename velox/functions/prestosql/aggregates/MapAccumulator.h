@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <vector>
+
+#include "velox/exec/HashStringAllocator.h"
+#include "velox/functions/prestosql/aggregates/SingleValueAccumulator.h"
+#include "velox/functions/prestosql/aggregates/ValueList.h"
+#include "velox/vector/DecodedVector.h"
+#include "velox/vector/FlatVector.h"
+
+namespace facebook::velox::aggregate {
+
+// The distinct keys of a map being aggregated, in the order they were first
+// added. Keys of a scalar type T are stored as T, with non-inline strings
+// copied. Keys of other types have T = ComplexType and are stored
+// serialized. A key is found by comparing hashes and then keys, by a linear
+// scan while there are few keys and by an open addressing hash table after
+// that. All memory comes from the HashStringAllocator.
+template <typename T>
+class MapKeys {
+ public:
+  explicit MapKeys(exec::HashStringAllocator* allocator)
+      : keys_{exec::StlAllocator<Key>(allocator)},
+        hashes_{exec::StlAllocator<uint64_t>(allocator)},
+        table_{exec::StlAllocator<int32_t>(allocator)} {}
+
+  int32_t size() const {
+    return keys_.size();
+  }
+
+  // Returns the position of the non-null key at 'index' in 'decoded' and
+  // true if the key was added, false if it was there already.
+  std::pair<int32_t, bool> insert(
+      const DecodedVector& decoded,
+      vector_size_t index,
+      exec::HashStringAllocator* allocator) {
+    auto hash = hashAt(decoded, index);
+    if (table_.empty()) {
+      for (auto i = 0; i < keys_.size(); ++i) {
+        if (hashes_[i] == hash && equals(i, decoded, index)) {
+          return {i, false};
+        }
+      }
+      if (size() < kMaxLinearScan) {
+        return {addKey(decoded, index, hash, allocator), true};
+      }
+      rehash(kInitialTableSize);
+    } else if (2 * (keys_.size() + 1) > table_.size()) {
+      rehash(2 * table_.size());
+    }
+
+    auto mask = table_.size() - 1;
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+      auto position = table_[slot];
+      if (position == kEmpty) {
+        table_[slot] = keys_.size();
+        return {addKey(decoded, index, hash, allocator), true};
+      }
+      if (hashes_[position] == hash && equals(position, decoded, index)) {
+        return {position, false};
+      }
+    }
+  }
+
+  // Writes the keys to 'result' starting at 'offset'.
+  void extract(const VectorPtr& result, vector_size_t offset) const {
+    if constexpr (std::is_same_v<T, ComplexType>) {
+      for (auto i = 0; i < keys_.size(); ++i) {
+        keys_[i].read(result, offset + i);
+      }
+    } else {
+      auto flatResult = result->asFlatVector<T>();
+      for (auto i = 0; i < keys_.size(); ++i) {
+        flatResult->set(offset + i, keys_[i]);
+      }
+    }
+  }
+
+  // Frees the copies of the keys. The vectors free themselves.
+  void free(exec::HashStringAllocator* allocator) {
+    for (auto& key : keys_) {
+      if constexpr (std::is_same_v<T, ComplexType>) {
+        key.destroy(allocator);
+      } else if constexpr (std::is_same_v<T, StringView>) {
+        if (!key.isInline()) {
+          allocator->free(exec::HashStringAllocator::headerOf(key.data()));
+        }
+      }
+    }
+  }
+
+ private:
+  using Key = std::conditional_t<
+      std::is_same_v<T, ComplexType>,
+      SingleValueAccumulator,
+      T>;
+
+  static constexpr int32_t kEmpty = -1;
+  // Up to this many keys are found by comparing all hashes.
+  static constexpr int32_t kMaxLinearScan = 16;
+  static constexpr int32_t kInitialTableSize = 64;
+
+  static uint64_t hashAt(const DecodedVector& decoded, vector_size_t index) {
+    if constexpr (std::is_same_v<T, ComplexType>) {
+      return decoded.base()->hashValueAt(decoded.index(index));
+    } else {
+      return folly::hasher<T>{}(decoded.valueAt<T>(index));
+    }
+  }
+
+  bool equals(
+      int32_t position,
+      const DecodedVector& decoded,
+      vector_size_t index) const {
+    if constexpr (std::is_same_v<T, ComplexType>) {
+      return keys_[position].compare(decoded, index) == 0;
+    } else {
+      return keys_[position] == decoded.valueAt<T>(index);
+    }
+  }
+
+  int32_t addKey(
+      const DecodedVector& decoded,
+      vector_size_t index,
+      uint64_t hash,
+      exec::HashStringAllocator* allocator) {
+    if constexpr (std::is_same_v<T, ComplexType>) {
+      keys_.emplace_back();
+      keys_.back().write(decoded.base(), decoded.index(index), allocator);
+    } else if constexpr (std::is_same_v<T, StringView>) {
+      auto key = decoded.valueAt<StringView>(index);
+      if (!key.isInline()) {
+        auto header = allocator->allocate(key.size());
+        memcpy(header->begin(), key.data(), key.size());
+        key = StringView(header->begin(), key.size());
+      }
+      keys_.push_back(key);
+    } else {
+      keys_.push_back(decoded.valueAt<T>(index));
+    }
+    hashes_.push_back(hash);
+    return keys_.size() - 1;
+  }
+
+  void rehash(int32_t size) {
+    table_.assign(size, kEmpty);
+    auto mask = size - 1;
+    for (auto i = 0; i < hashes_.size(); ++i) {
+      auto slot = hashes_[i] & mask;
+      while (table_[slot] != kEmpty) {
+        slot = (slot + 1) & mask;
+      }
+      table_[slot] = i;
+    }
+  }
+
+  std::vector<Key, exec::StlAllocator<Key>> keys_;
+  std::vector<uint64_t, exec::StlAllocator<uint64_t>> hashes_;
+  // Positions in 'keys_' or kEmpty. The size is a power of 2 and at least
+  // twice the number of keys. Empty while there are few keys.
+  std::vector<int32_t, exec::StlAllocator<int32_t>> table_;
+};
+
+// Accumulator for map_agg and map_union. The value of a key is the first
+// one added with the key.
+template <typename T>
+struct MapAccumulator {
+  explicit MapAccumulator(exec::HashStringAllocator* allocator)
+      : keys{allocator} {}
+
+  // Adds the key at 'index' in 'decodedKeys' with the value at 'index' in
+  // 'decodedValues' if the key is new.
+  void insert(
+      const DecodedVector& decodedKeys,
+      const DecodedVector& decodedValues,
+      vector_size_t index,
+      exec::HashStringAllocator* allocator) {
+    if (keys.insert(decodedKeys, index, allocator).second) {
+      values.appendValue(decodedValues, index, allocator);
+    }
+  }
+
+  int32_t size() const {
+    return keys.size();
+  }
+
+  void free(exec::HashStringAllocator* allocator) {
+    keys.free(allocator);
+    values.free(allocator);
+  }
+
+  MapKeys<T> keys;
+  ValueList values;
+};
+
+// Accumulator for multimap_agg. Keeps all the values of each key.
+template <typename T>
+struct MultimapAccumulator {
+  explicit MultimapAccumulator(exec::HashStringAllocator* allocator)
+      : keys{allocator}, values{exec::StlAllocator<ValueList>(allocator)} {}
+
+  // Returns the values of the key at 'index' in 'decodedKeys', adding the
+  // key if new.
+  ValueList& valuesOf(
+      const DecodedVector& decodedKeys,
+      vector_size_t index,
+      exec::HashStringAllocator* allocator) {
+    auto [position, isNew] = keys.insert(decodedKeys, index, allocator);
+    if (isNew) {
+      values.emplace_back();
+    }
+    return values[position];
+  }
+
+  int32_t size() const {
+    return keys.size();
+  }
+
+  void free(exec::HashStringAllocator* allocator) {
+    keys.free(allocator);
+    for (auto& list : values) {
+      list.free(allocator);
+    }
+  }
+
+  MapKeys<T> keys;
+  std::vector<ValueList, exec::StlAllocator<ValueList>> values;
+};
+
+} // namespace facebook::velox::aggregate
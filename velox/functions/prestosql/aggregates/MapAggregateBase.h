@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "velox/exec/Aggregate.h"
+#include "velox/functions/prestosql/aggregates/MapAccumulator.h"
+#include "velox/vector/ComplexVector.h"
+
+namespace facebook::velox::aggregate {
+
+// Base of map_agg and map_union. The accumulator keeps the distinct keys of
+// type T with the first value seen for each. The intermediate and final
+// results are maps. Subclasses add the raw input.
+template <typename T>
+class MapAggregateBase : public exec::Aggregate {
+ public:
+  explicit MapAggregateBase(TypePtr resultType) : Aggregate(resultType) {}
+
+  using Accumulator = MapAccumulator<T>;
+
+  int32_t accumulatorFixedWidthSize() const override {
+    return sizeof(Accumulator);
+  }
+
+  void initializeNewGroups(
+      char** groups,
+      folly::Range<const vector_size_t*> indices) override {
+    for (auto index : indices) {
+      new (groups[index] + offset_) Accumulator(allocator_);
+    }
+  }
+
+  void finalize(char** groups, int32_t numGroups) override {
+    for (auto i = 0; i < numGroups; i++) {
+      value<Accumulator>(groups[i])->values.finalize(allocator_);
+    }
+  }
+
+  void extractValues(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto mapVector = (*result)->as<MapVector>();
+    VELOX_CHECK(mapVector);
+    mapVector->resize(numGroups);
+
+    auto& mapKeys = mapVector->mapKeys();
+    auto& mapValues = mapVector->mapValues();
+    auto numElements = countElements(groups, numGroups);
+    mapKeys->resize(numElements);
+    mapValues->resize(numElements);
+
+    auto* rawNulls = getRawNulls(mapVector);
+    vector_size_t offset = 0;
+    for (int32_t i = 0; i < numGroups; ++i) {
+      clearNull(rawNulls, i);
+
+      auto accumulator = value<Accumulator>(groups[i]);
+      auto mapSize = accumulator->size();
+      if (mapSize) {
+        accumulator->keys.extract(mapKeys, offset);
+        ValueListReader valuesReader(accumulator->values);
+        for (auto index = 0; index < mapSize; ++index) {
+          valuesReader.next(*mapValues, offset + index);
+        }
+      }
+      mapVector->setOffsetAndSize(i, offset, mapSize);
+      offset += mapSize;
+    }
+  }
+
+  void extractAccumulators(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    extractValues(groups, numGroups, result);
+  }
+
+  void addIntermediateResults(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    addMaps(rows, args[0], [&](vector_size_t row) { return groups[row]; });
+  }
+
+  void addSingleGroupIntermediateResults(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /* mayPushdown */) override {
+    addMaps(rows, args[0], [&](vector_size_t /*row*/) { return group; });
+  }
+
+  void destroy(folly::Range<char**> groups) override {
+    for (auto group : groups) {
+      auto accumulator = value<Accumulator>(group);
+      accumulator->free(allocator_);
+      accumulator->~Accumulator();
+    }
+  }
+
+ protected:
+  // Adds the entries of the non-null maps in 'rows' of 'maps' to the
+  // accumulators of 'groupAt(row)'.
+  template <typename GroupAt>
+  void addMaps(
+      const SelectivityVector& rows,
+      const VectorPtr& maps,
+      GroupAt groupAt) {
+    decodedMaps_.decode(*maps, rows);
+    auto mapVector = decodedMaps_.base()->as<MapVector>();
+    VELOX_CHECK(mapVector);
+    auto& mapKeys = mapVector->mapKeys();
+    elementRows_.resize(mapKeys->size());
+    elementRows_.setAll();
+    decodedKeys_.decode(*mapKeys, elementRows_);
+    decodedValues_.decode(*mapVector->mapValues(), elementRows_);
+
+    rows.applyToSelected([&](vector_size_t row) {
+      if (decodedMaps_.isNullAt(row)) {
+        return;
+      }
+      auto accumulator = value<Accumulator>(groupAt(row));
+      auto index = decodedMaps_.index(row);
+      auto offset = mapVector->offsetAt(index);
+      auto end = offset + mapVector->sizeAt(index);
+      for (auto i = offset; i < end; ++i) {
+        accumulator->insert(decodedKeys_, decodedValues_, i, allocator_);
+      }
+    });
+  }
+
+  DecodedVector decodedKeys_;
+  DecodedVector decodedValues_;
+
+ private:
+  vector_size_t countElements(char** groups, int32_t numGroups) const {
+    vector_size_t size = 0;
+    for (int32_t i = 0; i < numGroups; ++i) {
+      size += value<Accumulator>(groups[i])->size();
+    }
+    return size;
+  }
+
+  DecodedVector decodedMaps_;
+  SelectivityVector elementRows_;
+};
+
+// Returns TAggregate<T> for the C++ type T of keys of 'keyType'. Keys of
+// complex types have T = ComplexType.
+template <template <typename> class TAggregate>
+std::unique_ptr<exec::Aggregate> createMapAggregate(
+    const TypePtr& keyType,
+    const TypePtr& resultType) {
+  switch (keyType->kind()) {
+    case TypeKind::BOOLEAN:
+      return std::make_unique<TAggregate<bool>>(resultType);
+    case TypeKind::TINYINT:
+      return std::make_unique<TAggregate<int8_t>>(resultType);
+    case TypeKind::SMALLINT:
+      return std::make_unique<TAggregate<int16_t>>(resultType);
+    case TypeKind::INTEGER:
+      return std::make_unique<TAggregate<int32_t>>(resultType);
+    case TypeKind::BIGINT:
+      return std::make_unique<TAggregate<int64_t>>(resultType);
+    case TypeKind::REAL:
+      return std::make_unique<TAggregate<float>>(resultType);
+    case TypeKind::DOUBLE:
+      return std::make_unique<TAggregate<double>>(resultType);
+    case TypeKind::TIMESTAMP:
+      return std::make_unique<TAggregate<Timestamp>>(resultType);
+    case TypeKind::DATE:
+      return std::make_unique<TAggregate<Date>>(resultType);
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      return std::make_unique<TAggregate<StringView>>(resultType);
+    default:
+      return std::make_unique<TAggregate<ComplexType>>(resultType);
+  }
+}
+
+} // namespace facebook::velox::aggregate
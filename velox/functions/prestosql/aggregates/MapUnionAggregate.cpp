@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/functions/prestosql/aggregates/AggregateNames.h"
+#include "velox/functions/prestosql/aggregates/MapAggregateBase.h"
+
+namespace facebook::velox::aggregate {
+namespace {
+
+// Returns the union of the input maps. The value of a key that is in more
+// than one map is the first one seen. The raw input has the form of the
+// intermediate results.
+template <typename T>
+class MapUnionAggregate : public MapAggregateBase<T> {
+ public:
+  explicit MapUnionAggregate(TypePtr resultType)
+      : MapAggregateBase<T>(std::move(resultType)) {}
+
+  void addRawInput(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool mayPushdown) override {
+    this->addIntermediateResults(groups, rows, args, mayPushdown);
+  }
+
+  void addSingleGroupRawInput(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool mayPushdown) override {
+    this->addSingleGroupIntermediateResults(group, rows, args, mayPushdown);
+  }
+};
+
+bool registerMapUnionAggregate(const std::string& name) {
+  exec::AggregateFunctions().Register(
+      name,
+      [name](
+          core::AggregationNode::Step /*step*/,
+          const std::vector<TypePtr>& argTypes,
+          const TypePtr&
+          /*resultType*/) -> std::unique_ptr<exec::Aggregate> {
+        VELOX_CHECK_EQ(
+            argTypes.size(),
+            1,
+            "{} ({}): unexpected number of arguments",
+            name);
+        VELOX_USER_CHECK_EQ(
+            argTypes[0]->kind(),
+            TypeKind::MAP,
+            "{}: the argument must be a map",
+            name);
+        return createMapAggregate<MapUnionAggregate>(
+            argTypes[0]->childAt(0), argTypes[0]);
+      });
+  return true;
+}
+
+static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
+    registerMapUnionAggregate(kMapUnion);
+} // namespace
+} // namespace facebook::velox::aggregate
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/functions/prestosql/aggregates/AggregateNames.h"
+#include "velox/functions/prestosql/aggregates/MapAggregateBase.h"
+
+namespace facebook::velox::aggregate {
+namespace {
+
+// Returns a map from each distinct key to an array of all the values seen
+// with the key. The intermediate results have the same form.
+template <typename T>
+class MultimapAggAggregate : public exec::Aggregate {
+ public:
+  explicit MultimapAggAggregate(TypePtr resultType)
+      : Aggregate(std::move(resultType)) {}
+
+  using Accumulator = MultimapAccumulator<T>;
+
+  int32_t accumulatorFixedWidthSize() const override {
+    return sizeof(Accumulator);
+  }
+
+  void initializeNewGroups(
+      char** groups,
+      folly::Range<const vector_size_t*> indices) override {
+    for (auto index : indices) {
+      new (groups[index] + offset_) Accumulator(allocator_);
+    }
+  }
+
+  void finalize(char** groups, int32_t numGroups) override {
+    for (auto i = 0; i < numGroups; i++) {
+      for (auto& values : value<Accumulator>(groups[i])->values) {
+        values.finalize(allocator_);
+      }
+    }
+  }
+
+  void extractValues(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    auto mapVector = (*result)->as<MapVector>();
+    VELOX_CHECK(mapVector);
+    mapVector->resize(numGroups);
+
+    auto& mapKeys = mapVector->mapKeys();
+    auto arrays = mapVector->mapValues()->as<ArrayVector>();
+    VELOX_CHECK(arrays);
+    vector_size_t numKeys = 0;
+    vector_size_t numValues = 0;
+    for (int32_t i = 0; i < numGroups; ++i) {
+      auto accumulator = value<Accumulator>(groups[i]);
+      numKeys += accumulator->size();
+      for (const auto& values : accumulator->values) {
+        numValues += values.size();
+      }
+    }
+    mapKeys->resize(numKeys);
+    arrays->resize(numKeys);
+    auto& elements = arrays->elements();
+    elements->resize(numValues);
+
+    auto* rawNulls = getRawNulls(mapVector);
+    vector_size_t keyOffset = 0;
+    vector_size_t valueOffset = 0;
+    for (int32_t i = 0; i < numGroups; ++i) {
+      clearNull(rawNulls, i);
+
+      auto accumulator = value<Accumulator>(groups[i]);
+      auto mapSize = accumulator->size();
+      accumulator->keys.extract(mapKeys, keyOffset);
+      for (auto index = 0; index < mapSize; ++index) {
+        auto& values = accumulator->values[index];
+        auto arraySize = values.size();
+        ValueListReader reader(values);
+        for (auto j = 0; j < arraySize; ++j) {
+          reader.next(*elements, valueOffset + j);
+        }
+        arrays->setOffsetAndSize(keyOffset + index, valueOffset, arraySize);
+        valueOffset += arraySize;
+      }
+      mapVector->setOffsetAndSize(i, keyOffset, mapSize);
+      keyOffset += mapSize;
+    }
+  }
+
+  void extractAccumulators(char** groups, int32_t numGroups, VectorPtr* result)
+      override {
+    extractValues(groups, numGroups, result);
+  }
+
+  void addRawInput(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    addEntries(rows, args, [&](vector_size_t row) { return groups[row]; });
+  }
+
+  void addIntermediateResults(
+      char** groups,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /*mayPushdown*/) override {
+    addMaps(rows, args[0], [&](vector_size_t row) { return groups[row]; });
+  }
+
+  void addSingleGroupRawInput(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /* mayPushdown */) override {
+    addEntries(rows, args, [&](vector_size_t /*row*/) { return group; });
+  }
+
+  void addSingleGroupIntermediateResults(
+      char* group,
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      bool /* mayPushdown */) override {
+    addMaps(rows, args[0], [&](vector_size_t /*row*/) { return group; });
+  }
+
+  void destroy(folly::Range<char**> groups) override {
+    for (auto group : groups) {
+      auto accumulator = value<Accumulator>(group);
+      accumulator->free(allocator_);
+      accumulator->~Accumulator();
+    }
+  }
+
+ private:
+  template <typename GroupAt>
+  void addEntries(
+      const SelectivityVector& rows,
+      const std::vector<VectorPtr>& args,
+      GroupAt groupAt) {
+    decodedKeys_.decode(*args[0], rows);
+    decodedValues_.decode(*args[1], rows);
+
+    rows.applyToSelected([&](vector_size_t row) {
+      // Skip null keys
+      if (!decodedKeys_.isNullAt(row)) {
+        value<Accumulator>(groupAt(row))
+            ->valuesOf(decodedKeys_, row, allocator_)
+            .appendValue(decodedValues_, row, allocator_);
+      }
+    });
+  }
+
+  // Adds the values of the non-null maps in 'rows' of 'maps' to the values
+  // of their keys.
+  template <typename GroupAt>
+  void addMaps(
+      const SelectivityVector& rows,
+      const VectorPtr& maps,
+      GroupAt groupAt) {
+    decodedMaps_.decode(*maps, rows);
+    auto mapVector = decodedMaps_.base()->as<MapVector>();
+    VELOX_CHECK(mapVector);
+    auto& mapKeys = mapVector->mapKeys();
+    auto arrays = mapVector->mapValues()->as<ArrayVector>();
+    VELOX_CHECK(arrays);
+    elementRows_.resize(mapKeys->size());
+    elementRows_.setAll();
+    decodedKeys_.decode(*mapKeys, elementRows_);
+
+    rows.applyToSelected([&](vector_size_t row) {
+      if (decodedMaps_.isNullAt(row)) {
+        return;
+      }
+      auto accumulator = value<Accumulator>(groupAt(row));
+      auto index = decodedMaps_.index(row);
+      auto offset = mapVector->offsetAt(index);
+      auto end = offset + mapVector->sizeAt(index);
+      for (auto i = offset; i < end; ++i) {
+        accumulator->valuesOf(decodedKeys_, i, allocator_)
+            .appendRange(
+                arrays->elements(),
+                arrays->offsetAt(i),
+                arrays->sizeAt(i),
+                allocator_);
+      }
+    });
+  }
+
+  DecodedVector decodedKeys_;
+  DecodedVector decodedValues_;
+  DecodedVector decodedMaps_;
+  SelectivityVector elementRows_;
+};
+
+bool registerMultimapAggAggregate(const std::string& name) {
+  exec::AggregateFunctions().Register(
+      name,
+      [name](
+          core::AggregationNode::Step step,
+          const std::vector<TypePtr>& argTypes,
+          const TypePtr&
+          /*resultType*/) -> std::unique_ptr<exec::Aggregate> {
+        auto rawInput = exec::isRawInput(step);
+        VELOX_CHECK_EQ(
+            argTypes.size(),
+            rawInput ? 2 : 1,
+            "{} ({}): unexpected number of arguments",
+            name);
+        TypePtr returnType =
+            rawInput ? MAP(argTypes[0], ARRAY(argTypes[1])) : argTypes[0];
+        return createMapAggregate<MultimapAggAggregate>(
+            returnType->childAt(0), returnType);
+      });
+  return true;
+}
+
+static bool FB_ANONYMOUS_VARIABLE(g_AggregateFunction) =
+    registerMultimapAggAggregate(kMultimapAgg);
+} // namespace
+} // namespace facebook::velox::aggregate
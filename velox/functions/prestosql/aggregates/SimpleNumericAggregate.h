@@ -171,14 +171,38 @@ class SimpleNumericAggregate : public exec::Aggregate {
   template <typename THook>
   void
   pushdown(char** groups, const SelectivityVector& rows, const VectorPtr& arg) {
-    DecodedVector decoded(*arg, rows, false);
-    const vector_size_t* indices = decoded.indices();
     THook hook(
         exec::Aggregate::offset_,
         exec::Aggregate::nullByte_,
         exec::Aggregate::nullMask_,
         groups,
         &this->exec::Aggregate::numNulls_);
+    loadWithHook(rows, arg, hook);
+  }
+
+  // Same as pushdown() for a global aggregation, where all rows go to
+  // 'group'.
+  template <typename THook>
+  void pushdownOneGroup(
+      char* group,
+      const SelectivityVector& rows,
+      const VectorPtr& arg) {
+    THook hook(
+        exec::Aggregate::offset_,
+        exec::Aggregate::nullByte_,
+        exec::Aggregate::nullMask_,
+        group,
+        &this->exec::Aggregate::numNulls_);
+    loadWithHook(rows, arg, hook);
+  }
+
+  // Loads 'rows' of the LazyVector under 'arg', passing the values to 'hook'.
+  void loadWithHook(
+      const SelectivityVector& rows,
+      const VectorPtr& arg,
+      ValueHook& hook) {
+    DecodedVector decoded(*arg, rows, false);
+    const vector_size_t* indices = decoded.indices();
     // The decoded vector does not really keep the info from the 'rows', except
     // for the 'upper bound' of it. In case not all rows are selected we need to
     // generate proper indices, which we 'indirect' through the ones we got from
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "velox/exec/HashStringAllocator.h"
+#include "velox/type/StringView.h"
+
+namespace facebook::velox::aggregate {
+
+// Space-saving sketch of Metwally, Agrawal and El Abbadi, "Efficient
+// Computation of Frequent and Top-k Elements in Data Streams". Counts up to
+// 'capacity' distinct values. A value that is not counted replaces the value
+// with the smallest count and inherits that count, so a count may exceed the
+// true count by at most the smallest count. Any value more frequent than
+// 1 / capacity of the total is counted.
+//
+// The entries form a min-heap on count next to a map from value to position
+// in the heap. All memory, including copies of non-inline strings, comes
+// from the HashStringAllocator.
+template <typename T>
+class StreamSummary {
+ public:
+  explicit StreamSummary(exec::HashStringAllocator* allocator)
+      : allocator_{allocator},
+        entries_{exec::StlAllocator<Entry>(allocator)},
+        positions_{
+            0,
+            std::hash<T>(),
+            std::equal_to<T>(),
+            exec::StlAllocator<std::pair<const T, int32_t>>(allocator)} {}
+
+  ~StreamSummary() {
+    for (auto& entry : entries_) {
+      freeValue(entry.value);
+    }
+  }
+
+  int32_t capacity() const {
+    return capacity_;
+  }
+
+  void setCapacity(int32_t capacity) {
+    VELOX_CHECK_GT(capacity, 0);
+    VELOX_CHECK(
+        capacity_ == 0 || capacity_ == capacity,
+        "Cannot change the capacity of a stream summary");
+    capacity_ = capacity;
+  }
+
+  int32_t size() const {
+    return entries_.size();
+  }
+
+  // Adds 'count' occurrences of 'value'.
+  void insert(T value, int64_t count = 1) {
+    VELOX_DCHECK_GT(capacity_, 0);
+    auto it = positions_.find(value);
+    if (it != positions_.end()) {
+      auto position = it->second;
+      entries_[position].count += count;
+      siftDown(position);
+      return;
+    }
+
+    if (entries_.size() < static_cast<size_t>(capacity_)) {
+      auto position = entries_.size();
+      entries_.push_back({copyValue(value), count});
+      positions_.emplace(entries_.back().value, position);
+      siftUp(position);
+      return;
+    }
+
+    // Replaces the value with the smallest count.
+    auto& min = entries_[0];
+    positions_.erase(min.value);
+    freeValue(min.value);
+    min.value = copyValue(value);
+    min.count += count;
+    positions_.emplace(min.value, 0);
+    siftDown(0);
+  }
+
+  // Returns up to 'k' values with the largest counts, by descending count.
+  // Ties are broken by ascending value.
+  std::vector<std::pair<T, int64_t>> topK(int32_t k) const {
+    std::vector<std::pair<T, int64_t>> result;
+    result.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+      result.emplace_back(entry.value, entry.count);
+    }
+    auto end = result.begin() + std::min<size_t>(k, result.size());
+    std::partial_sort(
+        result.begin(), end, result.end(), [](const auto& a, const auto& b) {
+          return a.second > b.second ||
+              (a.second == b.second && a.first < b.first);
+        });
+    result.erase(end, result.end());
+    return result;
+  }
+
+  // Value and count of the entry at 'index' < size(), in no particular
+  // order.
+  T valueAt(int32_t index) const {
+    return entries_[index].value;
+  }
+
+  int64_t countAt(int32_t index) const {
+    return entries_[index].count;
+  }
+
+ private:
+  struct Entry {
+    T value;
+    int64_t count;
+  };
+
+  void swapEntries(int32_t i, int32_t j) {
+    std::swap(entries_[i], entries_[j]);
+    positions_[entries_[i].value] = i;
+    positions_[entries_[j].value] = j;
+  }
+
+  void siftUp(int32_t position) {
+    while (position > 0) {
+      auto parent = (position - 1) / 2;
+      if (entries_[parent].count <= entries_[position].count) {
+        break;
+      }
+      swapEntries(parent, position);
+      position = parent;
+    }
+  }
+
+  void siftDown(int32_t position) {
+    int32_t size = entries_.size();
+    for (;;) {
+      auto smallest = position;
+      auto left = 2 * position + 1;
+      auto right = left + 1;
+      if (left < size && entries_[left].count < entries_[smallest].count) {
+        smallest = left;
+      }
+      if (right < size && entries_[right].count < entries_[smallest].count) {
+        smallest = right;
+      }
+      if (smallest == position) {
+        break;
+      }
+      swapEntries(smallest, position);
+      position = smallest;
+    }
+  }
+
+  T copyValue(T value) {
+    if constexpr (std::is_same_v<T, StringView>) {
+      if (!value.isInline()) {
+        auto header = allocator_->allocate(value.size());
+        memcpy(header->begin(), value.data(), value.size());
+        return StringView(header->begin(), value.size());
+      }
+    }
+    return value;
+  }
+
+  void freeValue(T value) {
+    if constexpr (std::is_same_v<T, StringView>) {
+      if (!value.isInline()) {
+        allocator_->free(exec::HashStringAllocator::headerOf(value.data()));
+      }
+    }
+  }
+
+  exec::HashStringAllocator* const allocator_;
+  int32_t capacity_{0};
+  std::vector<Entry, exec::StlAllocator<Entry>> entries_;
+  std::unordered_map<
+      T,
+      int32_t,
+      std::hash<T>,
+      std::equal_to<T>,
+      exec::StlAllocator<std::pair<const T, int32_t>>>
+      positions_;
+};
+
+} // namespace facebook::velox::aggregate
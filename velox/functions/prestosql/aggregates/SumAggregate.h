@@ -78,6 +78,11 @@ class SumAggregate
       const SelectivityVector& rows,
       const std::vector<VectorPtr>& args,
       bool mayPushdown) override {
+    if (mayPushdown) {
+      BaseAggregate::template pushdownOneGroup<SumHook<TInput, TAccumulator>>(
+          group, rows, args[0]);
+      return;
+    }
     BaseAggregate::template updateOneGroup<TAccumulator>(
         group,
         rows,
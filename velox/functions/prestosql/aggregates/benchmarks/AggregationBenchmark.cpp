@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <fmt/format.h>
+#include <folly/Benchmark.h>
+#include <folly/init/Init.h>
+#include <iostream>
+#include <string>
+
+#include "velox/exec/tests/utils/Cursor.h"
+#include "velox/exec/tests/utils/OperatorTestBase.h"
+#include "velox/exec/tests/utils/PlanBuilder.h"
+
+// Runs a single step HashAggregation over 1M synthetic rows for a number of
+// grouping key shapes and accumulators. Each benchmark counts one iteration
+// per input row, so that folly reports the time per row and rows per
+// second. The peak memory of the aggregation divided by the number of
+// groups is printed after the benchmarks.
+
+using namespace facebook::velox;
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace {
+
+constexpr int32_t kNumVectors = 10;
+constexpr int32_t kRowsPerVector = 100'000;
+constexpr int64_t kNumHighGroups = 500'000;
+
+// Input columns. The low cardinality keys have 1000 values in a small range
+// and group in an array. The high cardinality keys have 500K values spread
+// over a range too wide for an array and group on a normalized key. The
+// high cardinality strings have too many values for value ids and group on
+// hashes. Aggregates refer to the columns by names c0 to c7.
+enum Column : ChannelIndex {
+  kLowBigint = 0,
+  kHighBigint = 1,
+  kLowBigint2 = 2,
+  kHighBigint2 = 3,
+  kLowVarchar = 4,
+  kHighVarchar = 5,
+  kBigintValue = 6,
+  kDoubleValue = 7,
+};
+
+const std::vector<ChannelIndex> kLowBigintKey = {kLowBigint};
+const std::vector<ChannelIndex> kHighBigintKey = {kHighBigint};
+const std::vector<ChannelIndex> kTwoLowBigintKeys = {kLowBigint, kLowBigint2};
+const std::vector<ChannelIndex> kTwoHighBigintKeys = {
+    kHighBigint,
+    kHighBigint2};
+const std::vector<ChannelIndex> kLowVarcharKey = {kLowVarchar};
+const std::vector<ChannelIndex> kHighVarcharKey = {kHighVarchar};
+const std::vector<ChannelIndex> kVarcharBigintKeys = {kLowVarchar, kLowBigint2};
+
+const std::vector<std::string> kSum = {"sum(c6)"};
+const std::vector<std::string> kAvg = {"avg(c7)"};
+const std::vector<std::string> kMinBy = {"min_by(c7, c6)"};
+const std::vector<std::string> kArrayAgg = {"array_agg(c6)"};
+const std::vector<std::string> kApproxDistinct = {"approx_distinct(c6)"};
+const std::vector<std::string> kMix = {
+    "sum(c6)",
+    "avg(c7)",
+    "min_by(c7, c6)",
+    "array_agg(c6)",
+    "approx_distinct(c6)"};
+
+class AggregationBenchmark : public OperatorTestBase {
+ public:
+  AggregationBenchmark() {
+    OperatorTestBase::SetUpTestCase();
+    OperatorTestBase::SetUp();
+    for (int32_t i = 0; i < kNumVectors; ++i) {
+      int64_t offset = i * kRowsPerVector;
+      auto high = [&](auto row) {
+        return (offset + row) * 7'919 % kNumHighGroups;
+      };
+      vectors_.push_back(makeRowVector({
+          makeFlatVector<int64_t>(
+              kRowsPerVector, [&](auto row) { return (offset + row) % 1'000; }),
+          makeFlatVector<int64_t>(
+              kRowsPerVector,
+              [&](auto row) { return high(row) * 1'000'003; }),
+          makeFlatVector<int64_t>(
+              kRowsPerVector,
+              [&](auto row) { return (offset + row) / 7 % 100; }),
+          makeFlatVector<int64_t>(
+              kRowsPerVector,
+              [&](auto row) {
+                return (offset + row) * 104'729 % 1'000 * 1'001;
+              }),
+          makeFlatVector<StringView>(
+              kRowsPerVector,
+              [&](auto row) {
+                return StringView(
+                    fmt::format("grouping key {}", (offset + row) % 1'000));
+              }),
+          makeFlatVector<StringView>(
+              kRowsPerVector,
+              [&](auto row) {
+                return StringView(fmt::format("grouping key {}", high(row)));
+              }),
+          makeFlatVector<int64_t>(
+              kRowsPerVector,
+              [&](auto row) { return (offset + row) * 31 % 10'007; }),
+          makeFlatVector<double>(
+              kRowsPerVector,
+              [&](auto row) { return (offset + row) % 977 * 0.1; }),
+      }));
+    }
+  }
+
+  void TestBody() override {}
+
+  // Groups the input on 'keys' and returns the number of input rows.
+  // Records the bytes per group under 'name'. 'hashAdaptivity' false
+  // forces grouping on hashes.
+  unsigned run(
+      const std::string& name,
+      const std::vector<ChannelIndex>& keys,
+      const std::vector<std::string>& aggregates,
+      bool hashAdaptivity) {
+    CursorParameters params;
+    params.queryCtx = core::QueryCtx::create();
+    if (!hashAdaptivity) {
+      params.queryCtx->setConfigOverridesUnsafe({
+          {core::QueryConfig::kHashAdaptivityEnabled, "false"},
+      });
+    }
+    params.planNode = PlanBuilder()
+                          .values(vectors_)
+                          .singleAggregation(keys, aggregates)
+                          .planNode();
+    auto result = readCursor(params, [](Task* /*task*/) {});
+    auto stats =
+        result.first->task()->taskStats().pipelineStats[0].operatorStats[1];
+    recordBytesPerGroup(
+        name,
+        stats.memoryStats.peakTotalMemoryReservation /
+            std::max<uint64_t>(1, stats.outputPositions));
+    return kNumVectors * kRowsPerVector;
+  }
+
+  void printBytesPerGroup() const {
+    std::cout << "Bytes per group:" << std::endl;
+    for (const auto& [name, bytes] : bytesPerGroup_) {
+      std::cout << fmt::format("{:<40}{:>12}", name, bytes) << std::endl;
+    }
+  }
+
+ private:
+  void recordBytesPerGroup(const std::string& name, uint64_t bytes) {
+    for (auto& entry : bytesPerGroup_) {
+      if (entry.first == name) {
+        entry.second = bytes;
+        return;
+      }
+    }
+    bytesPerGroup_.emplace_back(name, bytes);
+  }
+
+  std::vector<RowVectorPtr> vectors_;
+  // Bytes per group of each benchmark in the order of the first run.
+  std::vector<std::pair<std::string, uint64_t>> bytesPerGroup_;
+};
+
+std::unique_ptr<AggregationBenchmark> benchmark;
+
+unsigned aggregate(
+    unsigned /*iters*/,
+    const std::string& name,
+    const std::vector<ChannelIndex>& keys,
+    const std::vector<std::string>& aggregates,
+    bool hashAdaptivity) {
+  return benchmark->run(name, keys, aggregates, hashAdaptivity);
+}
+
+// Grouping key shapes with a cheap accumulator.
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    ARRAY_BIGINT,
+    "ARRAY_BIGINT",
+    kLowBigintKey,
+    kSum,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    ARRAY_TWO_BIGINT,
+    "ARRAY_TWO_BIGINT",
+    kTwoLowBigintKeys,
+    kSum,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    ARRAY_VARCHAR,
+    "ARRAY_VARCHAR",
+    kLowVarcharKey,
+    kSum,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    ARRAY_VARCHAR_BIGINT,
+    "ARRAY_VARCHAR_BIGINT",
+    kVarcharBigintKeys,
+    kSum,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    NORMALIZED_BIGINT,
+    "NORMALIZED_BIGINT",
+    kHighBigintKey,
+    kSum,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    NORMALIZED_TWO_BIGINT,
+    "NORMALIZED_TWO_BIGINT",
+    kTwoHighBigintKeys,
+    kSum,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HASH_LOW_BIGINT,
+    "HASH_LOW_BIGINT",
+    kLowBigintKey,
+    kSum,
+    false);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HASH_HIGH_BIGINT,
+    "HASH_HIGH_BIGINT",
+    kHighBigintKey,
+    kSum,
+    false);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HASH_TWO_BIGINT,
+    "HASH_TWO_BIGINT",
+    kTwoHighBigintKeys,
+    kSum,
+    false);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HASH_VARCHAR,
+    "HASH_VARCHAR",
+    kHighVarcharKey,
+    kSum,
+    true);
+BENCHMARK_DRAW_LINE();
+
+// Accumulators over few groups.
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    LOW_AVG,
+    "LOW_AVG",
+    kLowBigintKey,
+    kAvg,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    LOW_MIN_BY,
+    "LOW_MIN_BY",
+    kLowBigintKey,
+    kMinBy,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    LOW_ARRAY_AGG,
+    "LOW_ARRAY_AGG",
+    kLowBigintKey,
+    kArrayAgg,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    LOW_APPROX_DISTINCT,
+    "LOW_APPROX_DISTINCT",
+    kLowBigintKey,
+    kApproxDistinct,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    LOW_MIX,
+    "LOW_MIX",
+    kLowBigintKey,
+    kMix,
+    true);
+BENCHMARK_DRAW_LINE();
+
+// Accumulators over many groups.
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HIGH_AVG,
+    "HIGH_AVG",
+    kHighBigintKey,
+    kAvg,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HIGH_MIN_BY,
+    "HIGH_MIN_BY",
+    kHighBigintKey,
+    kMinBy,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HIGH_ARRAY_AGG,
+    "HIGH_ARRAY_AGG",
+    kHighBigintKey,
+    kArrayAgg,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HIGH_APPROX_DISTINCT,
+    "HIGH_APPROX_DISTINCT",
+    kHighBigintKey,
+    kApproxDistinct,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HIGH_MIX,
+    "HIGH_MIX",
+    kHighBigintKey,
+    kMix,
+    true);
+BENCHMARK_NAMED_PARAM_MULTI(
+    aggregate,
+    HIGH_VARCHAR_MIX,
+    "HIGH_VARCHAR_MIX",
+    kHighVarcharKey,
+    kMix,
+    true);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  benchmark = std::make_unique<AggregationBenchmark>();
+  folly::runBenchmarks();
+  benchmark->printBytesPerGroup();
+  benchmark.reset();
+  return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/functions/prestosql/aggregates/tests/AggregationTestBase.h"
+
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace facebook::velox::aggregate::test {
+
+namespace {
+
+class ApproxMostFrequentTest : public AggregationTestBase {
+ protected:
+  void testAgg(
+      const RowVectorPtr& input,
+      const std::vector<ChannelIndex>& groupingKeys,
+      const std::string& aggregate,
+      const RowVectorPtr& expectedResult) {
+    auto op = PlanBuilder()
+                  .values({input})
+                  .singleAggregation(groupingKeys, {aggregate})
+                  .planNode();
+    assertQuery(op, expectedResult);
+
+    std::vector<ChannelIndex> finalKeys(groupingKeys.size());
+    std::iota(finalKeys.begin(), finalKeys.end(), 0);
+    op = PlanBuilder()
+             .values({input})
+             .partialAggregation(groupingKeys, {aggregate})
+             .intermediateAggregation(
+                 finalKeys, {"approx_most_frequent(a0)"})
+             .finalAggregation(finalKeys, {"approx_most_frequent(a0)"})
+             .planNode();
+    assertQuery(op, expectedResult);
+  }
+};
+
+TEST_F(ApproxMostFrequentTest, global) {
+  vector_size_t size = 1'000;
+  // 1 occurs 500 times, 2 300 times, 3 100 times and 900..999 once. With a
+  // capacity of 100 the counts of the frequent values are exact.
+  auto values = makeFlatVector<int64_t>(size, [](auto row) -> int64_t {
+    if (row < 500) {
+      return 1;
+    }
+    if (row < 800) {
+      return 2;
+    }
+    return row < 900 ? 3 : row;
+  });
+  auto expectedResult = makeRowVector({makeMapVector<int64_t, int64_t>(
+      1,
+      [](auto /*row*/) { return 3; },
+      [](auto index) { return index + 1; },
+      [](auto index) { return std::vector<int64_t>{500, 300, 100}[index]; })});
+  testAgg(
+      makeRowVector({values}),
+      {},
+      "approx_most_frequent(3, c0, 100)",
+      expectedResult);
+}
+
+TEST_F(ApproxMostFrequentTest, groupBy) {
+  vector_size_t size = 900;
+  std::vector<std::string> strings;
+  for (auto i = 0; i < 15; ++i) {
+    // Longer than inline strings.
+    strings.push_back(fmt::format(
+        "string number {}",
+        i < 8 ? "x" : (i < 12 ? "y" : fmt::format("z{}", i))));
+  }
+  auto keys = makeFlatVector<int32_t>(size, [](auto row) { return row % 3; });
+  auto values = makeFlatVector<StringView>(
+      size, [&](auto row) { return StringView(strings[row % 15]); });
+
+  // Group 0 has x 180 times, y 60 times and z12 60 times. Group 1 has x 180
+  // times, y 60 times and z13 60 times. Group 2 has x 120 times, y 120 times
+  // and z14 60 times. Ties are broken by the smaller value.
+  auto expectedResult = makeRowVector(
+      {makeFlatVector(std::vector<int32_t>{0, 1, 2}),
+       makeMapVector<StringView, int64_t>(
+           3,
+           [](auto /*row*/) { return 2; },
+           [&](auto index) { return StringView(strings[index % 2 ? 8 : 0]); },
+           [](auto index) {
+             return std::vector<int64_t>{180, 60, 180, 60, 120, 120}[index];
+           })});
+  testAgg(
+      makeRowVector({keys, values}),
+      {0},
+      "approx_most_frequent(2, c1, 10)",
+      expectedResult);
+}
+
+TEST_F(ApproxMostFrequentTest, nulls) {
+  auto values = makeNullableFlatVector<int32_t>(
+      {1, std::nullopt, 2, 1, std::nullopt, 3, 1, 2});
+  auto expectedResult = makeRowVector({makeMapVector<int32_t, int64_t>(
+      1,
+      [](auto /*row*/) { return 2; },
+      [](auto index) { return index + 1; },
+      [](auto index) { return 3 - index; })});
+  testAgg(
+      makeRowVector({values}),
+      {},
+      "approx_most_frequent(2, c0, 10)",
+      expectedResult);
+}
+
+TEST_F(ApproxMostFrequentTest, invalidArguments) {
+  auto values = makeFlatVector<int64_t>(10, [](auto row) { return row; });
+  auto op = PlanBuilder()
+                .values({makeRowVector({values})})
+                .singleAggregation({}, {"approx_most_frequent(10, c0, 5)"})
+                .planNode();
+  EXPECT_THROW(assertQuery(op, "SELECT null"), VeloxException);
+}
+
+} // namespace
+} // namespace facebook::velox::aggregate::test
@@ -152,17 +152,17 @@ TEST_F(ApproxPercentileTest, globalAgg) {
   auto weights =
       makeFlatVector<int64_t>(size, [](auto row) { return row % 23 + 1; });
 
-  testGlobalAgg(values, 0.5, 10);
-  testGlobalAgg(values, weights, 0.5, 15);
+  testGlobalAgg(values, 0.5, 11);
+  testGlobalAgg(values, weights, 0.5, 16);
 
   auto valuesWithNulls = makeFlatVector<int32_t>(
       size, [](auto row) { return row % 23; }, nullEvery(7));
   auto weightsWithNulls = makeFlatVector<int64_t>(
       size, [](auto row) { return row % 23 + 1; }, nullEvery(11));
 
-  testGlobalAgg(valuesWithNulls, 0.5, 10);
-  testGlobalAgg(valuesWithNulls, weights, 0.5, 15);
-  testGlobalAgg(valuesWithNulls, weightsWithNulls, 0.5, 15);
+  testGlobalAgg(valuesWithNulls, 0.5, 11);
+  testGlobalAgg(valuesWithNulls, weights, 0.5, 16);
+  testGlobalAgg(valuesWithNulls, weightsWithNulls, 0.5, 16);
 }
 
 TEST_F(ApproxPercentileTest, groupByAgg) {
@@ -175,12 +175,12 @@ TEST_F(ApproxPercentileTest, groupByAgg) {
 
   auto expectedResult = makeRowVector(
       {makeFlatVector(std::vector<int32_t>{0, 1, 2, 3, 4, 5, 6}),
-       makeFlatVector(std::vector<int32_t>{10, 11, 12, 13, 14, 15, 16})});
+       makeFlatVector(std::vector<int32_t>{11, 12, 13, 14, 15, 16, 17})});
   testGroupByAgg(keys, values, 0.5, expectedResult);
 
   expectedResult = makeRowVector(
       {makeFlatVector(std::vector<int32_t>{0, 1, 2, 3, 4, 5, 6}),
-       makeFlatVector(std::vector<int32_t>{15, 16, 17, 18, 19, 20, 21})});
+       makeFlatVector(std::vector<int32_t>{16, 17, 18, 19, 20, 21, 22})});
   testGroupByAgg(keys, values, weights, 0.5, expectedResult);
 
   auto valuesWithNulls = makeFlatVector<int32_t>(
@@ -190,12 +190,12 @@ TEST_F(ApproxPercentileTest, groupByAgg) {
 
   expectedResult = makeRowVector(
       {makeFlatVector(std::vector<int32_t>{0, 1, 2, 3, 4, 5, 6}),
-       makeFlatVector(std::vector<int32_t>{10, 11, 12, 13, 14, 15, 16})});
+       makeFlatVector(std::vector<int32_t>{11, 12, 13, 14, 15, 16, 17})});
   testGroupByAgg(keys, valuesWithNulls, 0.5, expectedResult);
 
   expectedResult = makeRowVector(
       {makeFlatVector(std::vector<int32_t>{0, 1, 2, 3, 4, 5, 6}),
-       makeFlatVector(std::vector<int32_t>{15, 16, 17, 18, 19, 20, 22})});
+       makeFlatVector(std::vector<int32_t>{15, 17, 18, 18, 19, 21, 22})});
   testGroupByAgg(keys, valuesWithNulls, weightsWithNulls, 0.5, expectedResult);
 }
 
@@ -208,12 +208,12 @@ TEST_F(ApproxPercentileTest, largeWeightsGlobal) {
   // All weights are very large and are about the same.
   auto weights = makeFlatVector<int64_t>(
       size, [](auto row) { return 1'000'000 + row % 23 + 1; });
-  testGlobalAgg(values, weights, 0.5, 10);
+  testGlobalAgg(values, weights, 0.5, 11);
 
   // Weights are large, but different.
   weights = makeFlatVector<int64_t>(
       size, [](auto row) { return 1'000 * (row % 23 + 1); });
-  testGlobalAgg(values, weights, 0.5, 15);
+  testGlobalAgg(values, weights, 0.5, 16);
 }
 
 // Test large values of "weight" parameter used in group-by.
@@ -229,7 +229,7 @@ TEST_F(ApproxPercentileTest, largeWeightsGroupBy) {
 
   auto expectedResult = makeRowVector(
       {makeFlatVector(std::vector<int32_t>{0, 1, 2, 3, 4, 5, 6}),
-       makeFlatVector(std::vector<int32_t>{10, 11, 12, 13, 14, 15, 16})});
+       makeFlatVector(std::vector<int32_t>{11, 12, 13, 14, 15, 16, 17})});
   testGroupByAgg(keys, values, weights, 0.5, expectedResult);
 
   // Weights are large, but different.
@@ -237,9 +237,60 @@ TEST_F(ApproxPercentileTest, largeWeightsGroupBy) {
       size, [](auto row) { return 1'000 * ((row / 7) % 23 + 1); });
   expectedResult = makeRowVector(
       {makeFlatVector(std::vector<int32_t>{0, 1, 2, 3, 4, 5, 6}),
-       makeFlatVector(std::vector<int32_t>{15, 16, 17, 18, 19, 20, 21})});
+       makeFlatVector(std::vector<int32_t>{16, 17, 18, 19, 20, 21, 22})});
   testGroupByAgg(keys, values, weights, 0.5, expectedResult);
 }
 
+// Test an array of percentiles, all estimated from one sketch.
+TEST_F(ApproxPercentileTest, arrayOfPercentiles) {
+  vector_size_t size = 1'000;
+  auto keys = makeFlatVector<int32_t>(size, [](auto row) { return row % 7; });
+  auto values = makeFlatVector<int32_t>(
+      size, [](auto row) { return (row / 7) % 23 + row % 7; });
+  auto percentiles = makeArrayVector<double>(
+      size,
+      [](auto /*row*/) { return 3; },
+      [](auto /*row*/, auto index) { return 0.25 * (index + 1); });
+  auto rowVector = makeRowVector({keys, values, percentiles});
+
+  auto expectedResult = makeRowVector({makeArrayVector<int32_t>(
+      1,
+      [](auto /*row*/) { return 3; },
+      [](auto /*row*/, auto index) { return 8 + 6 * index; })});
+  auto op = PlanBuilder()
+                .values({rowVector})
+                .singleAggregation({}, {"approx_percentile(c1, c2)"})
+                .planNode();
+  assertQuery(op, expectedResult);
+
+  op = PlanBuilder()
+           .values({rowVector})
+           .partialAggregation({}, {"approx_percentile(c1, c2)"})
+           .finalAggregation(
+               {}, {"approx_percentile(a0)"}, {ARRAY(INTEGER())})
+           .planNode();
+  assertQuery(op, expectedResult);
+
+  expectedResult = makeRowVector(
+      {makeFlatVector<int32_t>(7, [](auto row) { return row; }),
+       makeArrayVector<int32_t>(
+           7,
+           [](auto /*row*/) { return 3; },
+           [](auto row, auto index) { return 5 + row + 6 * index; })});
+  op = PlanBuilder()
+           .values({rowVector})
+           .singleAggregation({0}, {"approx_percentile(c1, c2)"})
+           .planNode();
+  assertQuery(op, expectedResult);
+
+  op = PlanBuilder()
+           .values({rowVector})
+           .partialAggregation({0}, {"approx_percentile(c1, c2)"})
+           .finalAggregation(
+               {0}, {"approx_percentile(a0)"}, {ARRAY(INTEGER())})
+           .planNode();
+  assertQuery(op, expectedResult);
+}
+
 } // namespace
 } // namespace facebook::velox::aggregate::test
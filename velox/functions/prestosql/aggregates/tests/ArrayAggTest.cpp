@@ -105,5 +105,73 @@ TEST_F(ArrayAggTest, global) {
   ASSERT_EQ(velox::variant::array(expected), value);
 }
 
+TEST_F(ArrayAggTest, ordered) {
+  // Two batches of 20 rows in total. c1 is the row number and c2 sorts the
+  // rows in reverse.
+  std::vector<RowVectorPtr> vectors;
+  for (auto batch = 0; batch < 2; ++batch) {
+    auto offset = batch * 10;
+    vectors.push_back(makeRowVector(
+        {makeFlatVector<int32_t>(10, [](auto row) { return row % 3; }),
+         makeFlatVector<int32_t>(10, [&](auto row) { return offset + row; }),
+         makeFlatVector<int64_t>(
+             10, [&](auto row) { return 100 - offset - row; })}));
+  }
+
+  // array_agg(c1 ORDER BY c2) GROUP BY c0.
+  CursorParameters params;
+  params.planNode = PlanBuilder()
+                        .values(vectors)
+                        .aggregation(
+                            {0},
+                            {"array_agg(c1)"},
+                            {},
+                            core::AggregationNode::Step::kSingle,
+                            false,
+                            {},
+                            {},
+                            {{{2, core::SortOrder(true, false)}}})
+                        .planNode();
+  auto result = readCursor(params, [](Task*) {});
+  vector_size_t numGroups = 0;
+  for (const auto& rowVector : result.second) {
+    auto keys = rowVector->childAt(0)->as<FlatVector<int32_t>>();
+    auto arrays = rowVector->childAt(1)->as<ArrayVector>();
+    auto elements = arrays->elements()->as<FlatVector<int32_t>>();
+    for (auto i = 0; i < rowVector->size(); ++i) {
+      // Rows of group k are k, k + 3, ..., in reverse.
+      std::vector<int32_t> expected;
+      for (auto row = 19 - (19 - keys->valueAt(i)) % 3; row >= 0; row -= 3) {
+        expected.push_back(row);
+      }
+      ASSERT_EQ(expected.size(), arrays->sizeAt(i));
+      for (auto j = 0; j < expected.size(); ++j) {
+        ASSERT_EQ(expected[j], elements->valueAt(arrays->offsetAt(i) + j));
+      }
+      ++numGroups;
+    }
+  }
+  ASSERT_EQ(3, numGroups);
+
+  // array_agg(c1 ORDER BY c1 DESC) without grouping keys.
+  auto op = PlanBuilder()
+                .values(vectors)
+                .aggregation(
+                    {},
+                    {"array_agg(c1)"},
+                    {},
+                    core::AggregationNode::Step::kSingle,
+                    false,
+                    {},
+                    {},
+                    {{{1, core::SortOrder(false, false)}}})
+                .planNode();
+  std::vector<velox::variant> expected;
+  for (auto i = 19; i >= 0; --i) {
+    expected.emplace_back(i);
+  }
+  ASSERT_EQ(velox::variant::array(expected), readSingleValue(op));
+}
+
 } // namespace
 } // namespace facebook::velox::aggregate::test
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/functions/prestosql/aggregates/KllSketch.h"
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include "velox/exec/HashStringAllocator.h"
+
+using namespace facebook::velox;
+using namespace facebook::velox::aggregate;
+
+namespace {
+
+constexpr int kSize = 100'000;
+
+// Values 0..kSize - 1 in random order.
+std::vector<double> shuffledValues() {
+  std::vector<double> values(kSize);
+  std::iota(values.begin(), values.end(), 0);
+  std::mt19937 rng(1);
+  std::shuffle(values.begin(), values.end(), rng);
+  return values;
+}
+
+// Checks that the quantiles of a sketch of 0..kSize - 1 are within the rank
+// error bound.
+template <typename Sketch>
+void checkUniformQuantiles(const Sketch& sketch) {
+  ASSERT_EQ(sketch.count(), kSize);
+  for (auto i = 1; i < 100; ++i) {
+    double quantile = i / 100.0;
+    EXPECT_NEAR(
+        sketch.estimateQuantile(quantile), quantile * kSize, kSize / 100)
+        << quantile;
+  }
+  EXPECT_EQ(sketch.estimateQuantile(0), 0);
+  EXPECT_EQ(sketch.estimateQuantile(1), kSize - 1);
+}
+
+TEST(KllSketchTest, exact) {
+  // Fewer values than the capacity of the sketch are kept as is.
+  KllSketch<> sketch;
+  for (auto i = 0; i < 100; ++i) {
+    sketch.insert(99 - i);
+  }
+  EXPECT_EQ(sketch.estimateQuantile(0.5), 50);
+  EXPECT_EQ(sketch.estimateQuantile(0.25), 25);
+  EXPECT_EQ(sketch.estimateQuantile(0.999), 99);
+
+  std::vector<double> quantiles = {0.1, 0.5, 0.9};
+  std::vector<double> results(quantiles.size());
+  sketch.estimateQuantiles(quantiles.data(), quantiles.size(), results.data());
+  EXPECT_EQ(results, (std::vector<double>{10, 50, 90}));
+}
+
+TEST(KllSketchTest, accuracy) {
+  auto values = shuffledValues();
+  KllSketch<> sketch;
+  for (auto value : values) {
+    sketch.insert(value);
+  }
+  checkUniformQuantiles(sketch);
+
+  KllSketch<> batchSketch;
+  batchSketch.insert(values.data(), values.size());
+  checkUniformQuantiles(batchSketch);
+  // One value at a time and a batch compact at the same points.
+  for (auto i = 1; i < 10; ++i) {
+    EXPECT_EQ(
+        sketch.estimateQuantile(i / 10.0),
+        batchSketch.estimateQuantile(i / 10.0));
+  }
+}
+
+TEST(KllSketchTest, weights) {
+  KllSketch<> sketch;
+  // 'i' has weight i + 1.
+  for (auto i = 0; i < 1'000; ++i) {
+    sketch.insert(i, i + 1);
+  }
+  EXPECT_EQ(sketch.count(), 1'000 * 1'001 / 2);
+  // Half of the weight is at or above 1'000 / sqrt(2).
+  EXPECT_NEAR(sketch.estimateQuantile(0.5), 707, 10);
+  EXPECT_EQ(sketch.estimateQuantile(0), 0);
+  EXPECT_EQ(sketch.estimateQuantile(1), 999);
+
+  KllSketch<> largeWeights;
+  largeWeights.insert(1, 1'000'000'000'000);
+  largeWeights.insert(2, 3'000'000'000'000);
+  EXPECT_EQ(largeWeights.estimateQuantile(0.2), 1);
+  EXPECT_EQ(largeWeights.estimateQuantile(0.3), 2);
+}
+
+TEST(KllSketchTest, merge) {
+  auto values = shuffledValues();
+  std::vector<KllSketch<>> sketches(10);
+  for (auto i = 0; i < values.size(); ++i) {
+    sketches[i % sketches.size()].insert(values[i]);
+  }
+  KllSketch<> merged;
+  for (const auto& sketch : sketches) {
+    merged.merge(sketch);
+  }
+  checkUniformQuantiles(merged);
+
+  KllSketch<> other(std::allocator<double>(), 100);
+  EXPECT_THROW(merged.merge(other), VeloxRuntimeError);
+}
+
+TEST(KllSketchTest, serialize) {
+  auto values = shuffledValues();
+  std::vector<KllSketch<>> sketches(10);
+  for (auto i = 0; i < values.size(); ++i) {
+    sketches[i % sketches.size()].insert(values[i]);
+  }
+
+  KllSketch<> merged;
+  KllSketch<> deserialized;
+  for (const auto& sketch : sketches) {
+    merged.merge(sketch);
+
+    std::vector<char> data(sketch.serializedSize());
+    OutputByteStream output(data.data());
+    sketch.serialize(output);
+    InputByteStream input(data.data());
+    deserialized.mergeSerialized(input);
+    EXPECT_EQ(input.offset(), data.size());
+  }
+  checkUniformQuantiles(deserialized);
+  for (auto i = 1; i < 100; ++i) {
+    EXPECT_EQ(
+        merged.estimateQuantile(i / 100.0),
+        deserialized.estimateQuantile(i / 100.0));
+  }
+}
+
+TEST(KllSketchTest, hashStringAllocator) {
+  exec::HashStringAllocator allocator(memory::MappedMemory::getInstance());
+  auto values = shuffledValues();
+  KllSketch<exec::StlAllocator<double>> sketch(
+      exec::StlAllocator<double>(&allocator));
+  sketch.insert(values.data(), values.size());
+  checkUniformQuantiles(sketch);
+}
+
+} // namespace
@@ -140,5 +140,63 @@ TEST_F(MapAggTest, globalDuplicateKeys) {
   ASSERT_EQ(velox::variant::map(expected), value);
 }
 
+TEST_F(MapAggTest, manyDuplicateKeys) {
+  // 100 distinct keys, more than are found by a linear scan, 10 times each.
+  // The keys are longer than inline strings.
+  vector_size_t size = 1'000;
+  std::vector<std::string> keys;
+  for (auto i = 0; i < 100; ++i) {
+    keys.push_back(fmt::format("key number {}", i));
+  }
+  std::vector<RowVectorPtr> vectors = {makeRowVector(
+      {makeFlatVector<StringView>(
+           size, [&](auto row) { return StringView(keys[row % 100]); }),
+       makeFlatVector<int64_t>(size, [](auto row) { return row; })})};
+
+  std::map<velox::variant, velox::variant> expected;
+  for (auto i = 0; i < keys.size(); ++i) {
+    expected.insert({velox::variant(keys[i]), velox::variant(int64_t(i))});
+  }
+  const velox::variant mapExpected{velox::variant::map(expected)};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"map_agg(c0, c1)"})
+                .planNode();
+  ASSERT_EQ(mapExpected, readSingleValue(op));
+
+  op = PlanBuilder()
+           .values(vectors)
+           .partialAggregation({}, {"map_agg(c0, c1)"})
+           .finalAggregation({}, {"map_agg(a0)"})
+           .planNode();
+  ASSERT_EQ(mapExpected, readSingleValue(op));
+}
+
+TEST_F(MapAggTest, arrayKeys) {
+  // Keys are [i % 20, i % 20 + 1].
+  vector_size_t size = 100;
+  std::vector<RowVectorPtr> vectors = {makeRowVector(
+      {makeArrayVector<int32_t>(
+           size,
+           [](auto /*row*/) { return 2; },
+           [](auto row, auto index) { return row % 20 + index; }),
+       makeFlatVector<int32_t>(size, [](auto row) { return row; })})};
+
+  std::map<velox::variant, velox::variant> expected;
+  for (auto i = 0; i < 20; ++i) {
+    expected.insert(
+        {velox::variant::array({velox::variant(i), velox::variant(i + 1)}),
+         velox::variant(i)});
+  }
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .partialAggregation({}, {"map_agg(c0, c1)"})
+                .finalAggregation({}, {"map_agg(a0)"})
+                .planNode();
+  ASSERT_EQ(velox::variant::map(expected), readSingleValue(op));
+}
+
 } // namespace
 } // namespace facebook::velox::aggregate::test
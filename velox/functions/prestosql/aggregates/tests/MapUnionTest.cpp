@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/functions/prestosql/aggregates/tests/AggregationTestBase.h"
+
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace facebook::velox::aggregate::test {
+
+namespace {
+
+class MapUnionTest : public AggregationTestBase {};
+
+TEST_F(MapUnionTest, global) {
+  // 10 maps of 3 entries each. The keys are 0..6 and key k first occurs
+  // with value k.
+  vector_size_t size = 10;
+  std::vector<RowVectorPtr> vectors = {
+      makeRowVector({makeMapVector<int32_t, int64_t>(
+          size,
+          [](auto /*row*/) { return 3; },
+          [](auto index) { return index % 7; },
+          [](auto index) { return index; })})};
+
+  std::map<velox::variant, velox::variant> expected;
+  for (auto i = 0; i < 7; ++i) {
+    expected.insert({velox::variant(i), velox::variant(int64_t(i))});
+  }
+  const velox::variant mapExpected{velox::variant::map(expected)};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"map_union(c0)"})
+                .planNode();
+  ASSERT_EQ(mapExpected, readSingleValue(op));
+
+  op = PlanBuilder()
+           .values(vectors)
+           .partialAggregation({}, {"map_union(c0)"})
+           .intermediateAggregation({}, {"map_union(a0)"})
+           .finalAggregation({}, {"map_union(a0)"})
+           .planNode();
+  ASSERT_EQ(mapExpected, readSingleValue(op));
+}
+
+TEST_F(MapUnionTest, groupBy) {
+  // Group 0 has maps {0: 0, 1: 1} and {1: 10, 2: 20}. Group 1 has maps
+  // {0: 100} and {0: 200, 3: 300}.
+  auto keys = makeFlatVector<int32_t>({0, 1, 0, 1});
+  auto maps = makeMapVector<int32_t, int64_t>(
+      4,
+      [](auto row) { return std::vector<int32_t>{2, 1, 2, 2}[row]; },
+      [](auto index) {
+        return std::vector<int32_t>{0, 1, 0, 1, 2, 0, 3}[index];
+      },
+      [](auto index) {
+        return std::vector<int64_t>{0, 1, 100, 10, 20, 200, 300}[index];
+      });
+  auto expectedResult = makeRowVector(
+      {makeFlatVector<int32_t>({0, 1}),
+       makeMapVector<int32_t, int64_t>(
+           2,
+           [](auto row) { return row == 0 ? 3 : 2; },
+           [](auto index) {
+             return std::vector<int32_t>{0, 1, 2, 0, 3}[index];
+           },
+           [](auto index) {
+             return std::vector<int64_t>{0, 1, 20, 100, 300}[index];
+           })});
+  auto op = PlanBuilder()
+                .values({makeRowVector({keys, maps})})
+                .singleAggregation({0}, {"map_union(c1)"})
+                .planNode();
+  assertQuery(op, expectedResult);
+}
+
+} // namespace
+} // namespace facebook::velox::aggregate::test
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "velox/exec/tests/utils/PlanBuilder.h"
+#include "velox/functions/prestosql/aggregates/tests/AggregationTestBase.h"
+
+using namespace facebook::velox::exec;
+using namespace facebook::velox::exec::test;
+
+namespace facebook::velox::aggregate::test {
+
+namespace {
+
+class MultimapAggTest : public AggregationTestBase {};
+
+TEST_F(MultimapAggTest, global) {
+  // Key k has the values k, k + 3, k + 6, except that every 4th value is
+  // null. The 10th row has a null key and is ignored.
+  std::vector<RowVectorPtr> vectors = {makeRowVector(
+      {makeNullableFlatVector<int32_t>(
+           {0, 1, 2, 0, 1, 2, 0, 1, 2, std::nullopt}),
+       makeFlatVector<int32_t>(
+           10, [](auto row) { return row; }, nullEvery(4))})};
+
+  auto value = [](auto i) {
+    return i % 4 == 0 ? velox::variant(TypeKind::INTEGER) : velox::variant(i);
+  };
+  std::map<velox::variant, velox::variant> expected;
+  for (auto i = 0; i < 3; ++i) {
+    expected.insert(
+        {velox::variant(i),
+         velox::variant::array({value(i), value(i + 3), value(i + 6)})});
+  }
+  const velox::variant mapExpected{velox::variant::map(expected)};
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .singleAggregation({}, {"multimap_agg(c0, c1)"})
+                .planNode();
+  ASSERT_EQ(mapExpected, readSingleValue(op));
+
+  op = PlanBuilder()
+           .values(vectors)
+           .partialAggregation({}, {"multimap_agg(c0, c1)"})
+           .finalAggregation({}, {"multimap_agg(a0)"})
+           .planNode();
+  ASSERT_EQ(mapExpected, readSingleValue(op));
+}
+
+TEST_F(MultimapAggTest, manyKeys) {
+  // 100 distinct keys that are longer than inline strings. Key k has the
+  // values k, k + 100, ..., k + 900.
+  vector_size_t size = 1'000;
+  std::vector<std::string> keys;
+  for (auto i = 0; i < 100; ++i) {
+    keys.push_back(fmt::format("key number {}", i));
+  }
+  std::vector<RowVectorPtr> vectors = {makeRowVector(
+      {makeFlatVector<StringView>(
+           size, [&](auto row) { return StringView(keys[row % 100]); }),
+       makeFlatVector<int64_t>(size, [](auto row) { return row; })})};
+
+  std::map<velox::variant, velox::variant> expected;
+  for (auto i = 0; i < keys.size(); ++i) {
+    std::vector<velox::variant> values;
+    for (auto j = 0; j < 10; ++j) {
+      values.push_back(velox::variant(int64_t(i + 100 * j)));
+    }
+    expected.insert(
+        {velox::variant(keys[i]), velox::variant::array(std::move(values))});
+  }
+
+  auto op = PlanBuilder()
+                .values(vectors)
+                .partialAggregation({}, {"multimap_agg(c0, c1)"})
+                .intermediateAggregation({}, {"multimap_agg(a0)"})
+                .finalAggregation({}, {"multimap_agg(a0)"})
+                .planNode();
+  ASSERT_EQ(velox::variant::map(expected), readSingleValue(op));
+}
+
+} // namespace
+} // namespace facebook::velox::aggregate::test
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <folly/Benchmark.h>
+#include <folly/String.h>
+#include <folly/init/Init.h>
+#include <gflags/gflags.h>
+#include "velox/dwio/type/fbhive/HiveTypeParser.h"
+#include "velox/functions/lib/benchmarks/ExpressionBenchmarkBuilder.h"
+#include "velox/functions/prestosql/registration/RegistrationFunctions.h"
+#include "velox/functions/sparksql/Register.h"
+
+// Benchmarks any expression over registered Presto or Spark functions, e.g.
+//
+//   velox_functions_benchmarks_expression \
+//     --expression "substr(c0, 1, c1)" \
+//     --schema "struct<c0:string,c1:bigint>" --null_chance 10
+//
+// reports the time per row and rows per second of ExprSet and
+// ExprSetSimplified for each input encoding.
+
+DEFINE_string(expression, "c0 + c1", "SQL text of the expression");
+
+DEFINE_string(
+    schema,
+    "struct<c0:bigint,c1:bigint>",
+    "Input columns as a Hive struct type");
+
+DEFINE_string(
+    functions,
+    "presto",
+    "Functions to register: 'presto' or 'spark'");
+
+DEFINE_string(
+    encodings,
+    "flat,dictionary,constant,fuzz",
+    "Comma separated input encodings: flat, dictionary, constant or fuzz");
+
+DEFINE_int32(batch_size, 1'000, "Rows per input batch");
+
+DEFINE_int32(num_batches, 10, "Input batches per benchmark iteration");
+
+DEFINE_int32(
+    null_chance,
+    0,
+    "One in this many input values is null. 0 means no nulls");
+
+DEFINE_int32(string_length, 50, "Length of input strings");
+
+DEFINE_bool(
+    string_variable_length,
+    false,
+    "Makes string_length the maximum length of input strings");
+
+DEFINE_int32(container_length, 10, "Length of input arrays and maps");
+
+using namespace facebook::velox;
+using namespace facebook::velox::functions::test;
+
+namespace {
+
+InputEncoding parseEncoding(const std::string& name) {
+  for (auto encoding :
+       {InputEncoding::kFlat,
+        InputEncoding::kDictionary,
+        InputEncoding::kConstant,
+        InputEncoding::kFuzz}) {
+    if (name == inputEncodingName(encoding)) {
+      return encoding;
+    }
+  }
+  VELOX_USER_FAIL("Unknown input encoding: {}", name);
+}
+
+void registerFunctions(const std::string& name) {
+  if (name == "presto") {
+    functions::prestosql::registerAllFunctions();
+  } else if (name == "spark") {
+    functions::sparksql::registerFunctions("");
+  } else {
+    VELOX_USER_FAIL("Unknown functions: {}", name);
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  folly::init(&argc, &argv);
+  registerFunctions(FLAGS_functions);
+
+  ExpressionBenchmarkSpec spec;
+  spec.name = "expression";
+  spec.expression = FLAGS_expression;
+  spec.rowType = std::dynamic_pointer_cast<const RowType>(
+      dwio::type::fbhive::HiveTypeParser().parse(FLAGS_schema));
+  VELOX_USER_CHECK_NOT_NULL(spec.rowType, "The schema must be a struct");
+  spec.fuzzerOptions.vectorSize = FLAGS_batch_size;
+  spec.fuzzerOptions.nullChance = FLAGS_null_chance;
+  spec.fuzzerOptions.stringLength = FLAGS_string_length;
+  spec.fuzzerOptions.stringVariableLength = FLAGS_string_variable_length;
+  spec.fuzzerOptions.containerLength = FLAGS_container_length;
+  spec.numBatches = FLAGS_num_batches;
+  std::vector<std::string> encodings;
+  folly::split(',', FLAGS_encodings, encodings, true);
+  spec.encodings.clear();
+  for (const auto& encoding : encodings) {
+    spec.encodings.push_back(parseEncoding(encoding));
+  }
+
+  ExpressionBenchmarkBuilder builder;
+  builder.addBenchmarks(spec);
+  folly::runBenchmarks();
+  return 0;
+}
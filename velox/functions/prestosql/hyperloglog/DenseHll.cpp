@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/functions/prestosql/hyperloglog/DenseHll.h"
+#include <immintrin.h>
 #include "velox/functions/prestosql/aggregates/IOUtils.h"
 #include "velox/functions/prestosql/hyperloglog/BiasCorrection.h"
 #include "velox/functions/prestosql/hyperloglog/HllUtils.h"
@@ -114,6 +115,63 @@ double correctBias(double rawEstimate, int8_t indexBitLength) {
 
   return rawEstimate - bias;
 }
+
+/// Merges deltas of two HLLs without overflows. 'shift' and 'otherShift' are
+/// the differences between the new baseline and the baselines of 'deltas'
+/// and 'otherDeltas'. One of them is 0, so a delta below its shift loses to
+/// the other delta and saturates to 0. Without overflows the merged deltas
+/// fit in 4 bits. Writes the merged deltas to 'deltas' and returns the number
+/// of zero deltas.
+int32_t mergeDeltas(
+    int8_t* deltas,
+    const int8_t* otherDeltas,
+    int32_t numBytes,
+    uint8_t shift,
+    uint8_t otherShift) {
+  int32_t numZeros = 0;
+  int32_t i = 0;
+  const auto mask = _mm256_set1_epi8(kBucketMask);
+  const auto zero = _mm256_setzero_si256();
+  const auto shifts = _mm256_set1_epi8(shift);
+  const auto otherShifts = _mm256_set1_epi8(otherShift);
+  for (; i + 32 <= numBytes; i += 32) {
+    auto slots = _mm256_loadu_si256(reinterpret_cast<__m256i*>(deltas + i));
+    auto otherSlots =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(otherDeltas + i));
+    auto low = _mm256_max_epu8(
+        _mm256_subs_epu8(_mm256_and_si256(slots, mask), shifts),
+        _mm256_subs_epu8(_mm256_and_si256(otherSlots, mask), otherShifts));
+    auto high = _mm256_max_epu8(
+        _mm256_subs_epu8(
+            _mm256_and_si256(_mm256_srli_epi16(slots, 4), mask), shifts),
+        _mm256_subs_epu8(
+            _mm256_and_si256(_mm256_srli_epi16(otherSlots, 4), mask),
+            otherShifts));
+    numZeros += __builtin_popcount(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(low, zero)));
+    numZeros += __builtin_popcount(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(high, zero)));
+    // Both halves are at most 15, so the 16-bit shift stays within bytes.
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(deltas + i),
+        _mm256_or_si256(low, _mm256_slli_epi16(high, 4)));
+  }
+  for (; i < numBytes; ++i) {
+    uint8_t slot = deltas[i];
+    uint8_t otherSlot = otherDeltas[i];
+    auto mergeDelta = [&](int8_t bits) {
+      int8_t delta = std::max(
+          ((slot >> bits) & kBucketMask) - shift,
+          ((otherSlot >> bits) & kBucketMask) - otherShift);
+      numZeros += delta == 0;
+      return delta;
+    };
+    auto low = mergeDelta(0);
+    auto high = mergeDelta(4);
+    deltas[i] = (high << 4) | low;
+  }
+  return numZeros;
+}
 } // namespace
 
 DenseHll::DenseHll(int8_t indexBitLength, exec::HashStringAllocator* allocator)
@@ -140,6 +198,26 @@ void DenseHll::insertHash(uint64_t hash) {
   insert(index, value);
 }
 
+void DenseHll::insertHashes(const uint64_t* hashes, int32_t numHashes) {
+  constexpr int32_t kBatchSize = 64;
+  uint32_t indices[kBatchSize];
+  int8_t values[kBatchSize];
+  for (auto start = 0; start < numHashes; start += kBatchSize) {
+    auto batchSize = std::min(kBatchSize, numHashes - start);
+    for (auto i = 0; i < batchSize; ++i) {
+      indices[i] = computeIndex(hashes[start + i], indexBitLength_);
+      values[i] = computeValue(hashes[start + i], indexBitLength_);
+    }
+    for (auto i = 0; i < batchSize; ++i) {
+      // Once the HLL has seen some values, most values are not above their
+      // bucket. insert() checks the overflow of a bucket at kMaxDelta.
+      if (values[i] - baseline_ > getDelta(indices[i])) {
+        insert(indices[i], values[i]);
+      }
+    }
+  }
+}
+
 void DenseHll::insert(int32_t index, int8_t value) {
   auto delta = value - baseline_;
   auto oldDelta = getDelta(index);
@@ -507,6 +585,18 @@ void DenseHll::mergeWith(
     const uint16_t* otherOverflowBuckets,
     const int8_t* otherOverflowValues) {
   int8_t newBaseline = std::max(baseline_, otherBaseline);
+  if (overflows_ == 0 && otherOverflows == 0) {
+    baselineCount_ = mergeDeltas(
+        deltas_.data(),
+        otherDeltas,
+        deltas_.size(),
+        newBaseline - baseline_,
+        newBaseline - otherBaseline);
+    baseline_ = newBaseline;
+    adjustBaselineIfNeeded();
+    return;
+  }
+
   int32_t baselineCount = 0;
 
   int bucket = 0;
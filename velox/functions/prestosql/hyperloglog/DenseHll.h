@@ -48,6 +48,11 @@ class DenseHll {
 
   void insertHash(uint64_t hash);
 
+  /// Inserts 'numHashes' hashes. Computes the buckets and values of a batch
+  /// of hashes before updating the buckets, which skips the hashes that do
+  /// not raise their bucket without a call to insert().
+  void insertHashes(const uint64_t* hashes, int32_t numHashes);
+
   /// Inserts pre-computed {bucket, value} pair. These value must be compatible
   /// with computeIndex and computeValue methods called with the indexBitLength
   /// value of this HLL. Used by SparseHll.toDense().
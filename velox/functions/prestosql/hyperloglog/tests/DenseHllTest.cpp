@@ -144,6 +144,24 @@ TEST_P(DenseHllTest, highCardinality) {
   ASSERT_EQ(denseHll.cardinality(), DenseHll::cardinality(serialized.data()));
 }
 
+TEST_P(DenseHllTest, insertHashes) {
+  int8_t indexBitLength = GetParam();
+
+  for (auto size : {10, 1'000, 100'000}) {
+    std::vector<uint64_t> hashes(size);
+    DenseHll expected{indexBitLength, &allocator_};
+    for (int i = 0; i < size; i++) {
+      hashes[i] = hashOne(i);
+      expected.insertHash(hashes[i]);
+    }
+
+    DenseHll denseHll{indexBitLength, &allocator_};
+    denseHll.insertHashes(hashes.data(), size);
+    ASSERT_EQ(expected.cardinality(), denseHll.cardinality());
+    ASSERT_EQ(serialize(expected), serialize(denseHll));
+  }
+}
+
 namespace {
 template <typename T>
 std::vector<T> sequence(T start, T end) {
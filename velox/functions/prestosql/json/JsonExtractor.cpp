@@ -16,7 +16,9 @@
 
 #include "velox/functions/prestosql/json/JsonExtractor.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <unordered_map>
 #include <vector>
 
@@ -41,9 +43,7 @@ static const uint32_t kMaxCacheNum = 32;
 
 namespace {
 
-folly::Optional<folly::dynamic> jsonExtractInternal(
-    const folly::dynamic* json,
-    folly::StringPiece path) {
+std::shared_ptr<JsonExtractor> getExtractor(folly::StringPiece path) {
   // Pre-process
   auto trimedPath = folly::trimWhitespace(path).str();
 
@@ -58,10 +58,282 @@ folly::Optional<folly::dynamic> jsonExtractInternal(
     op = std::make_shared<JsonExtractor>(trimedPath);
     kExtractorCache[trimedPath] = op;
   }
+  return op;
+}
+
+folly::Optional<folly::dynamic> jsonExtractInternal(
+    const folly::dynamic* json,
+    folly::StringPiece path) {
+  return getExtractor(path)->extract(json);
+}
+
+// Parses json text, e.g. a value found by JsonExtractor::scan(). Returns
+// folly::none if the text is empty or not valid json.
+folly::Optional<folly::dynamic> parseValue(folly::StringPiece value) {
+  if (value.empty()) {
+    return folly::none;
+  }
+  try {
+    return folly::parseJson(value);
+  } catch (const folly::json::parse_error&) {
+  } catch (const folly::ConversionError&) {
+  }
+  return folly::none;
+}
+
+// The json text parsed into a folly::dynamic, filled in on first use so that
+// several paths over the same text share one parse.
+struct ParsedJson {
+  bool parsed{false};
+  // folly::none if the text is not valid json.
+  folly::Optional<folly::dynamic> value;
+};
 
-  return op->extract(json);
+folly::Optional<folly::dynamic> extractParsed(
+    JsonExtractor& extractor,
+    folly::StringPiece json,
+    ParsedJson& document) {
+  if (!document.parsed) {
+    document.parsed = true;
+    document.value = parseValue(json);
+  }
+  if (!document.value.has_value()) {
+    return folly::none;
+  }
+  try {
+    return extractor.extract(document.value.get_pointer());
+  } catch (const folly::ConversionError&) {
+  }
+  return folly::none;
 }
 
+// Returns true if 'value' is a json string without escape sequences, whose
+// contents can be returned as is.
+bool isPlainString(folly::StringPiece value) {
+  return value.size() >= 2 && value.front() == '"' && value.back() == '"' &&
+      !std::memchr(value.data(), '\\', value.size());
+}
+
+// Walks json text on demand, following a path without materializing the
+// values it passes over. Strings are skipped with memchr, which the C library
+// vectorizes. Validation is limited to what is needed to find the value.
+class JsonScanner {
+ public:
+  enum class Status { kFound, kNotFound, kMalformed };
+
+  explicit JsonScanner(folly::StringPiece json)
+      : pos_{json.begin()}, end_{json.end()} {}
+
+  Status find(
+      const std::vector<std::string>& tokens,
+      folly::StringPiece& value) {
+    skipWhitespace();
+    for (auto& token : tokens) {
+      if (pos_ == end_) {
+        return Status::kMalformed;
+      }
+      Status status;
+      if (*pos_ == '{') {
+        status = findKey(token);
+      } else if (*pos_ == '[') {
+        status = findIndex(token);
+      } else {
+        // Scalars have no children.
+        status = Status::kNotFound;
+      }
+      if (status != Status::kFound) {
+        return status;
+      }
+    }
+    auto begin = pos_;
+    if (!skipValue()) {
+      return Status::kMalformed;
+    }
+    value = folly::StringPiece(begin, pos_);
+    return Status::kFound;
+  }
+
+ private:
+  static bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+  }
+
+  void skipWhitespace() {
+    while (pos_ != end_ && isWhitespace(*pos_)) {
+      ++pos_;
+    }
+  }
+
+  // Consumes 'c' and the whitespace after it.
+  bool consume(char c) {
+    if (pos_ == end_ || *pos_ != c) {
+      return false;
+    }
+    ++pos_;
+    skipWhitespace();
+    return true;
+  }
+
+  // Skips a string starting at the opening quote. Sets 'hasEscape' if the
+  // string contains a backslash.
+  bool skipString(bool& hasEscape) {
+    auto begin = ++pos_;
+    for (;;) {
+      auto quote = static_cast<const char*>(
+          std::memchr(pos_, '"', end_ - pos_));
+      if (!quote) {
+        return false;
+      }
+      // The quote is escaped if preceded by an odd number of backslashes.
+      auto backslash = quote;
+      while (backslash > begin && *(backslash - 1) == '\\') {
+        --backslash;
+      }
+      pos_ = quote + 1;
+      if ((quote - backslash) % 2 == 0) {
+        break;
+      }
+    }
+    hasEscape = std::memchr(begin, '\\', pos_ - 1 - begin) != nullptr;
+    return true;
+  }
+
+  bool skipValue() {
+    if (pos_ == end_) {
+      return false;
+    }
+    bool hasEscape;
+    switch (*pos_) {
+      case '"':
+        return skipString(hasEscape);
+      case '{':
+      case '[':
+        return skipContainer();
+      default: {
+        auto begin = pos_;
+        while (pos_ != end_ && !isWhitespace(*pos_) && *pos_ != ',' &&
+               *pos_ != '}' && *pos_ != ']') {
+          ++pos_;
+        }
+        return pos_ != begin;
+      }
+    }
+  }
+
+  // Skips an object or array by tracking the nesting depth. Brackets inside
+  // strings are stepped over with the strings.
+  bool skipContainer() {
+    int32_t depth = 0;
+    bool hasEscape;
+    while (pos_ != end_) {
+      switch (*pos_) {
+        case '"':
+          if (!skipString(hasEscape)) {
+            return false;
+          }
+          continue;
+        case '{':
+        case '[':
+          ++depth;
+          break;
+        case '}':
+        case ']':
+          if (--depth == 0) {
+            ++pos_;
+            return true;
+          }
+          break;
+        default:
+          break;
+      }
+      ++pos_;
+    }
+    return false;
+  }
+
+  // Skips the value at the current position and the separator after it.
+  // Sets 'last' if the separator closes the container.
+  bool skipToNext(char close, bool& last) {
+    if (!skipValue()) {
+      return false;
+    }
+    skipWhitespace();
+    last = consume(close);
+    return last || consume(',');
+  }
+
+  // Positions at the value of 'key' in the object at the current position.
+  Status findKey(const std::string& key) {
+    consume('{');
+    if (consume('}')) {
+      return Status::kNotFound;
+    }
+    for (;;) {
+      if (pos_ == end_ || *pos_ != '"') {
+        return Status::kMalformed;
+      }
+      auto begin = pos_;
+      bool hasEscape;
+      if (!skipString(hasEscape)) {
+        return Status::kMalformed;
+      }
+      folly::StringPiece name(begin, pos_);
+      skipWhitespace();
+      if (!consume(':')) {
+        return Status::kMalformed;
+      }
+      if (keyEquals(name, hasEscape, key)) {
+        return Status::kFound;
+      }
+      bool last;
+      if (!skipToNext('}', last)) {
+        return Status::kMalformed;
+      }
+      if (last) {
+        return Status::kNotFound;
+      }
+    }
+  }
+
+  // 'name' is a quoted key, including the quotes.
+  static bool
+  keyEquals(folly::StringPiece name, bool hasEscape, const std::string& key) {
+    if (!hasEscape) {
+      return name.subpiece(1, name.size() - 2) == key;
+    }
+    auto decoded = parseValue(name);
+    return decoded.has_value() && decoded->isString() &&
+        decoded->getString() == key;
+  }
+
+  // Positions at element 'token' of the array at the current position.
+  Status findIndex(const std::string& token) {
+    auto rv = folly::tryTo<int32_t>(token);
+    if (!rv.hasValue() || rv.value() < 0) {
+      return Status::kNotFound;
+    }
+    consume('[');
+    if (consume(']')) {
+      return Status::kNotFound;
+    }
+    for (int32_t i = 0;; ++i) {
+      if (i == rv.value()) {
+        return Status::kFound;
+      }
+      bool last;
+      if (!skipToNext(']', last)) {
+        return Status::kMalformed;
+      }
+      if (last) {
+        return Status::kNotFound;
+      }
+    }
+  }
+
+  const char* pos_;
+  const char* const end_;
+};
+
 bool isScalarType(const folly::Optional<folly::dynamic>& json) {
   return json.has_value() && !json->isObject() && !json->isArray() &&
       !json->isNull();
@@ -121,6 +393,29 @@ void JsonExtractor::tokenize() {
     }
   }
   isValid_ = true;
+  // A root-only path needs the whole document parsed anyway.
+  canScan_ = !tokens_.empty() &&
+      std::find(tokens_.begin(), tokens_.end(), "*") == tokens_.end();
+}
+
+bool JsonExtractor::scan(folly::StringPiece json, folly::StringPiece& value)
+    const {
+  if (!canScan_) {
+    return false;
+  }
+  JsonScanner scanner{json};
+  folly::StringPiece found;
+  switch (scanner.find(tokens_, found)) {
+    case JsonScanner::Status::kFound:
+      value = found;
+      return true;
+    case JsonScanner::Status::kNotFound:
+      value = folly::StringPiece();
+      return true;
+    case JsonScanner::Status::kMalformed:
+      return false;
+  }
+  return false;
 }
 
 folly::Optional<folly::dynamic> JsonExtractor::extract(
@@ -162,18 +457,39 @@ folly::Optional<folly::dynamic> JsonExtractor::extract(
   }
 }
 
+namespace {
+folly::Optional<std::string> extractScalar(
+    JsonExtractor& extractor,
+    folly::StringPiece json,
+    ParsedJson& document) {
+  folly::StringPiece value;
+  folly::Optional<folly::dynamic> res;
+  if (extractor.scan(json, value)) {
+    if (isPlainString(value)) {
+      return value.subpiece(1, value.size() - 2).str();
+    }
+    res = parseValue(value);
+  } else {
+    res = extractParsed(extractor, json, document);
+  }
+  // Not a scalar value
+  if (isScalarType(res)) {
+    return res->asString();
+  }
+  return folly::none;
+}
+} // namespace
+
 folly::Optional<folly::dynamic> jsonExtract(
     folly::StringPiece json,
     folly::StringPiece path) {
-  try {
-    auto jsonObj = folly::parseJson(json);
-    return jsonExtractInternal(&jsonObj, path);
-  } catch (const folly::json::parse_error&) {
-  } catch (const folly::ConversionError&) {
-    // Folly might throw a conversion error while parsing the input json. In
-    // this case, let it return null.
+  auto extractor = getExtractor(path);
+  folly::StringPiece value;
+  if (extractor->scan(json, value)) {
+    return parseValue(value);
   }
-  return folly::none;
+  ParsedJson document;
+  return extractParsed(*extractor, json, document);
 }
 
 folly::Optional<folly::dynamic> jsonExtract(
@@ -195,23 +511,25 @@ folly::Optional<folly::dynamic> jsonExtract(
 folly::Optional<std::string> jsonExtractScalar(
     folly::StringPiece json,
     folly::StringPiece path) {
-  auto res = jsonExtract(json, path);
-  // Not a scalar value
-  if (isScalarType(res)) {
-    return res->asString();
+  ParsedJson document;
+  return extractScalar(*getExtractor(path), json, document);
+}
+
+void jsonExtractScalars(
+    folly::StringPiece json,
+    const std::vector<std::shared_ptr<JsonExtractor>>& extractors,
+    std::vector<folly::Optional<std::string>>& results) {
+  ParsedJson document;
+  results.resize(extractors.size());
+  for (size_t i = 0; i < extractors.size(); ++i) {
+    results[i] = extractScalar(*extractors[i], json, document);
   }
-  return folly::none;
 }
 
 folly::Optional<std::string> jsonExtractScalar(
     const std::string& json,
     const std::string& path) {
-  auto res = jsonExtract(json, path);
-  // Not a scalar value
-  if (isScalarType(res)) {
-    return res->asString();
-  }
-  return folly::none;
+  return jsonExtractScalar(folly::StringPiece(json), folly::StringPiece(path));
 }
 
 } // namespace facebook::velox::functions
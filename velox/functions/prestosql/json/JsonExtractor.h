@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "folly/Range.h"
 #include "folly/dynamic.h"
@@ -73,17 +75,38 @@ folly::Optional<std::string> jsonExtractScalar(
     const std::string& json,
     const std::string& path);
 
+class JsonExtractor;
+
+// Extracts the scalar values at several paths of one json document, like
+// jsonExtractScalar() for each of them. The document is parsed at most once
+// for all the paths, and not at all when every path can be scanned.
+void jsonExtractScalars(
+    folly::StringPiece json,
+    const std::vector<std::shared_ptr<JsonExtractor>>& extractors,
+    std::vector<folly::Optional<std::string>>& results);
+
 class JsonExtractor {
  public:
   explicit JsonExtractor(const std::string& path);
 
   folly::Optional<folly::dynamic> extract(const folly::dynamic* json);
 
+  // Looks up the path by scanning the json text rather than parsing the whole
+  // document into a folly::dynamic. Object keys and array subscripts are
+  // followed and unrelated subtrees are skipped without being parsed. The
+  // first matching key wins. Returns false if the path can't be resolved
+  // this way (root-only or wildcard paths, malformed text on the scanned
+  // route); otherwise sets 'value' to the raw text of the match, or to an
+  // empty piece if nothing matches.
+  bool scan(folly::StringPiece json, folly::StringPiece& value) const;
+
  private:
   void tokenize();
 
  private:
   bool isValid_;
+  // True if the path can be resolved by scan().
+  bool canScan_{false};
   std::string path_;
   std::vector<std::string> tokens_;
 };
@@ -501,3 +501,26 @@ TEST(JsonExtractorTest, jsonMultipleExtractsTest) {
   ASSERT_TRUE(extract2.hasValue());
   EXPECT_EQ(jsonExtract(json, "$.store.fruit").value(), extract2.value());
 }
+
+TEST(JsonExtractorTest, skipUnrelatedValuesTest) {
+  // Brackets, braces and escaped quotes inside skipped strings must not
+  // confuse the scanner.
+  std::string json = R"DELIM(
+      {"a": "x]}\"{[", "b": [{"c": "]"}, [1, [2]], "\\"],
+       "d": {"e": {"f": null}, "g": -1.5},
+       "h": ["zero", "one", {"i": "two"}]})DELIM";
+  EXPECT_JSON_VALUE_EQ(json, "$.d.g"s, "-1.5"s);
+  EXPECT_JSON_VALUE_EQ(json, "$.d.e"s, "{\"f\":null}"s);
+  EXPECT_JSON_VALUE_EQ(json, "$.b[1][1]"s, "[2]"s);
+  EXPECT_JSON_VALUE_EQ(json, "$.b[2]"s, "\"\\\\\""s);
+  EXPECT_SCALAR_VALUE_EQ(json, "$.a"s, "x]}\"{["s);
+  EXPECT_SCALAR_VALUE_EQ(json, "$.h[1]"s, "one"s);
+  EXPECT_SCALAR_VALUE_EQ(json, "$.h[2].i"s, "two"s);
+  EXPECT_SCALAR_VALUE_NULL(json, "$.d.e.f"s);
+  EXPECT_SCALAR_VALUE_NULL(json, "$.h[3]"s);
+  EXPECT_SCALAR_VALUE_NULL(json, "$.d.x"s);
+  EXPECT_JSON_VALUE_EQ(json, "$.h[*]"s, "[\"zero\",\"one\",{\"i\":\"two\"}]"s);
+  // Malformed text on the path yields null.
+  EXPECT_JSON_VALUE_NULL("{\"a\": [1, 2"s, "$.a[2]"s);
+  EXPECT_JSON_VALUE_NULL("{\"a\" 1}"s, "$.a"s);
+}
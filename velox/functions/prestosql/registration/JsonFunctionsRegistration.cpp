@@ -21,6 +21,8 @@ namespace facebook::velox::functions {
 void registerJsonFunctions() {
   registerFunction<JsonExtractScalarFunction, Varchar, Varchar, Varchar>(
       {"json_extract_scalar"});
+  VELOX_REGISTER_VECTOR_FUNCTION(
+      udf_json_extract_scalar_multi, "json_extract_scalar_multi");
 }
 
 } // namespace facebook::velox::functions
@@ -305,6 +305,20 @@ TEST_F(ArrayDistinctTest, nonContiguousRows) {
   assertEqualVectors(expected, result);
 }
 
+// Crosses the size at which the distinct values move from a linear scan to a
+// hash set.
+TEST_F(ArrayDistinctTest, largeArrays) {
+  auto array = makeArrayVector<int32_t>(
+      6,
+      [](auto row) { return row * 10; },
+      [](auto /*row*/, auto idx) { return idx % 20; });
+  auto expected = makeArrayVector<int32_t>(
+      6,
+      [](auto row) { return std::min(row * 10, 20); },
+      [](auto /*row*/, auto idx) { return idx; });
+  testExpr(expected, "array_distinct(C0)", {array});
+}
+
 // Test for invalid signature and types.
 TEST_F(ArrayDistinctTest, invalidTypes) {
   auto array = makeNullableArrayVector<int32_t>({{1}});
@@ -256,6 +256,24 @@ TEST_F(ArrayIntersectTest, constant) {
   testExpr(expected, "array_intersect(ARRAY[1,NULL,4], C0)", {array1});
 }
 
+// Both the right-hand side values and the output values cross the size at
+// which sets move from a linear scan to a hash set.
+TEST_F(ArrayIntersectTest, largeArrays) {
+  auto array1 = makeArrayVector<int32_t>(
+      6,
+      [](auto row) { return row * 10; },
+      [](auto /*row*/, auto idx) { return idx % 40; });
+  auto array2 = makeArrayVector<int32_t>(
+      6,
+      [](auto row) { return row * 5; },
+      [](auto /*row*/, auto idx) { return idx * 2; });
+  auto expected = makeArrayVector<int32_t>(
+      6,
+      [](auto row) { return std::min(row * 10, 40) / 2; },
+      [](auto /*row*/, auto idx) { return idx * 2; });
+  testExpr(expected, "array_intersect(C0, C1)", {array1, array2});
+}
+
 TEST_F(ArrayIntersectTest, wrongTypes) {
   auto expected = makeNullableArrayVector<int32_t>({{1}});
   auto array1 = makeNullableArrayVector<int32_t>({{1}});
@@ -300,6 +300,29 @@ TEST_F(DateTimeFunctionsTest, hour) {
   EXPECT_EQ(8, hour(Timestamp(998423705, 321000000)));
 }
 
+TEST_F(DateTimeFunctionsTest, hourAcrossDstTransitions) {
+  setQueryTimeZone("America/Los_Angeles");
+  // Consecutive rows cross the 2021 transitions to and from daylight saving
+  // time in both directions.
+  auto timestamps = makeFlatVector<Timestamp>({
+      Timestamp(1615715999, 0), // 2021-03-14 01:59:59 PST
+      Timestamp(1615716000, 0), // 2021-03-14 03:00:00 PDT
+      Timestamp(1615715999, 0),
+      Timestamp(1636275599, 0), // 2021-11-07 01:59:59 PDT
+      Timestamp(1636275600, 0), // 2021-11-07 01:00:00 PST
+      Timestamp(1636279200, 0), // 2021-11-07 02:00:00 PST
+      Timestamp(1615716000, 0),
+  });
+  auto result =
+      evaluate<SimpleVector<int64_t>>("hour(c0)", makeRowVector({timestamps}));
+  assertEqualVectors(makeFlatVector<int64_t>({1, 3, 1, 1, 1, 2, 3}), result);
+
+  result = evaluate<SimpleVector<int64_t>>(
+      "day_of_month(c0)", makeRowVector({timestamps}));
+  assertEqualVectors(
+      makeFlatVector<int64_t>({14, 14, 14, 7, 7, 7, 14}), result);
+}
+
 TEST_F(DateTimeFunctionsTest, hourDate) {
   const auto hour = [&](std::optional<Date> date) {
     return evaluateOnce<int64_t>("hour(c0)", date);
@@ -123,3 +123,123 @@ TEST_F(ReduceTest, conditional) {
       nullEvery(11));
   assertEqualVectors(expectedResult, result);
 }
+
+// Sums, minimums, maximums and concatenations are computed without
+// evaluating the lambda per element. The results must be the same as for
+// equivalent lambdas that are evaluated.
+TEST_F(ReduceTest, directReductions) {
+  vector_size_t size = 1'000;
+  auto input = makeRowVector({
+      makeArrayVector<int64_t>(
+          size,
+          [](auto row) { return row % 7 * row % 13; },
+          [](auto row, auto index) { return (row * 31 + index * 17) % 101; },
+          nullEvery(11)),
+      makeArrayVector<double>(
+          size,
+          [](auto row) { return row % 7 * row % 13; },
+          [](auto row, auto index) { return (row + index) * 0.1; },
+          nullEvery(13)),
+  });
+
+  struct TestCase {
+    std::string type;
+    std::string direct;
+    std::string interpreted;
+  };
+  std::vector<TestCase> testCases = {
+      {"bigint", "s + x", "s + x * 1"},
+      {"bigint", "x + s", "s + x * 1"},
+      {"bigint", "greatest(s, x)", "if(x > s, x, s)"},
+      {"bigint", "least(s, x)", "if(x < s, x, s)"},
+      {"double", "s + x", "s + x * 1.0"},
+      {"double", "greatest(s, x)", "if(x > s, x, s)"},
+      {"double", "least(s, x)", "if(x < s, x, s)"},
+  };
+  int32_t lambdaId = 0;
+  for (const auto& testCase : testCases) {
+    SCOPED_TRACE(testCase.direct);
+    auto type = testCase.type == "bigint" ? BIGINT() : DOUBLE();
+    auto column = testCase.type == "bigint" ? "c0" : "c1";
+    auto initial = testCase.type == "bigint" ? "50" : "5.0";
+    auto signature = rowType("s", type, "x", type);
+    auto direct = fmt::format("direct{}", lambdaId);
+    auto interpreted = fmt::format("interpreted{}", lambdaId);
+    auto identity = fmt::format("identity{}", lambdaId++);
+    registerLambda(direct, signature, input->type(), testCase.direct);
+    registerLambda(interpreted, signature, input->type(), testCase.interpreted);
+    registerLambda(identity, rowType("s", type), input->type(), "s");
+
+    auto reduce = [&](const std::string& inputFunction) {
+      return evaluate(
+          fmt::format(
+              "reduce({}, {}, function('{}'), function('{}'))",
+              column,
+              initial,
+              inputFunction,
+              identity),
+          input);
+    };
+    auto result = reduce(direct);
+    auto expected = reduce(interpreted);
+    assertEqualVectors(expected, result);
+  }
+}
+
+TEST_F(ReduceTest, directReductionNulls) {
+  auto input = makeRowVector({makeNullableArrayVector<int64_t>(
+      {{1, 2, 3}, {1, std::nullopt, 3}, {}, {std::nullopt}, {4}})});
+  registerLambda(
+      "sum_input",
+      rowType("s", BIGINT(), "x", BIGINT()),
+      input->type(),
+      "s + x");
+  registerLambda("identity", rowType("s", BIGINT()), input->type(), "s");
+  auto result = evaluate<SimpleVector<int64_t>>(
+      "reduce(c0, 10, function('sum_input'), function('identity'))", input);
+  assertEqualVectors(
+      makeNullableFlatVector<int64_t>(
+          {16, std::nullopt, 10, std::nullopt, 14}),
+      result);
+}
+
+TEST_F(ReduceTest, directReductionOverflow) {
+  // Overflowing arrays are left to the lambda, which raises the error.
+  auto input = makeRowVector({makeArrayVector<int64_t>(
+      {{1, 2}, {std::numeric_limits<int64_t>::max(), 1}})});
+  registerLambda(
+      "sum_input",
+      rowType("s", BIGINT(), "x", BIGINT()),
+      input->type(),
+      "s + x");
+  registerLambda("identity", rowType("s", BIGINT()), input->type(), "s");
+  EXPECT_THROW(
+      evaluate<SimpleVector<int64_t>>(
+          "reduce(c0, 0, function('sum_input'), function('identity'))",
+          input),
+      VeloxException);
+}
+
+TEST_F(ReduceTest, directConcat) {
+  auto input = makeRowVector({makeNullableArrayVector<StringView>(
+      {{"a"_sv, "bb"_sv, "a somewhat longer string"_sv},
+       {},
+       {"x"_sv, std::nullopt},
+       {"yy"_sv}})});
+  registerLambda(
+      "concat_input",
+      rowType("s", VARCHAR(), "x", VARCHAR()),
+      input->type(),
+      "concat(s, x)");
+  registerLambda("identity", rowType("s", VARCHAR()), input->type(), "s");
+  auto result = evaluate<SimpleVector<StringView>>(
+      "reduce(c0, '>', function('concat_input'), function('identity'))",
+      input);
+  assertEqualVectors(
+      makeNullableFlatVector<StringView>(
+          {">abba somewhat longer string"_sv,
+           ">"_sv,
+           std::nullopt,
+           ">yy"_sv}),
+      result);
+}
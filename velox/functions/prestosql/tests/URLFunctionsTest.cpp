@@ -98,7 +98,24 @@ TEST_F(URLFunctionsTest, validateURL) {
       "",
       "",
       std::nullopt);
+  validate(
+      "http://user:password@[::1]:8080/index.html#",
+      "http",
+      "[::1]",
+      "/index.html",
+      "",
+      "",
+      8080);
+  validate(
+      "git+ssh://git@example.com:/repo.git?ref=main",
+      "git+ssh",
+      "example.com",
+      "/repo.git",
+      "",
+      "ref=main",
+      std::nullopt);
   validate("foo", "", "", "", "", "", std::nullopt);
+  validate("1http://example.com", "", "", "", "", "", std::nullopt);
 }
 
 TEST_F(URLFunctionsTest, extractParameter) {
@@ -122,6 +139,14 @@ TEST_F(URLFunctionsTest, extractParameter) {
       extractParam(
           "http://example.com/path1/p.php?k1=v1&k2=v2&k3&k4#Ref1", "k6"),
       std::nullopt);
+  EXPECT_EQ(
+      extractParam("http://example.com/?k1=a=b&k2=c&=d&k3=", "k1"),
+      std::nullopt);
+  EXPECT_EQ(
+      extractParam("http://example.com/?k1=a=b&k2=c&=d&k3=", "k2"), "c");
+  EXPECT_EQ(
+      extractParam("http://example.com/?k1=a=b&k2=c&=d&k3=", "k3"), "");
+  EXPECT_EQ(extractParam("http://example.com/?=d", ""), std::nullopt);
   EXPECT_EQ(extractParam("foo", ""), std::nullopt);
 }
 
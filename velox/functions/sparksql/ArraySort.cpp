@@ -20,6 +20,7 @@
 #include "velox/expression/EvalCtx.h"
 #include "velox/expression/Expr.h"
 #include "velox/expression/VectorFunction.h"
+#include "velox/functions/lib/ArraySort.h"
 #include "velox/functions/lib/LambdaFunctionUtil.h"
 #include "velox/functions/sparksql/Comparisons.h"
 #include "velox/type/Type.h"
@@ -54,6 +55,21 @@ void applyTyped(
   auto resultFlatElements = resultElements->asFlatVector<T>();
   T* resultRawValues = resultFlatElements->mutableRawValues();
 
+  constexpr bool kFixedWidth =
+      std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+  [[maybe_unused]] std::conditional_t<kFixedWidth, FixedWidthSorter<T>, bool>
+      sorter{};
+  auto sortValues = [&](T* begin, T* end) {
+    if constexpr (kFixedWidth) {
+      sorter.sort(begin, end, sortDescending);
+    } else if (sortDescending) {
+      std::sort(begin, end, Greater<T>());
+    } else {
+      std::sort(begin, end, Less<T>());
+    }
+  };
+
+  const bool mayHaveNulls = inputElements->mayHaveNulls();
   vector_size_t resultOffset = 0;
   auto processRow = [&](vector_size_t row) {
     auto size = inputArray->sizeAt(row);
@@ -62,33 +78,27 @@ void applyTyped(
     if (size == 0) {
       return;
     }
-    T* rowValues = resultRawValues + resultOffset;
-    for (int j = 0; j < size; ++j) {
-      *(rowValues + j) = inputElements->valueAt<T>(j + inputOffset);
-    }
-    if (sortDescending) {
-      // Move nulls to end of array
-      vector_size_t numNulls = 0;
-      for (vector_size_t i = size - 1; i >= 0; --i) {
-        if (inputElements->isNullAt(i + inputOffset)) {
-          std::swap(*(rowValues + i), *(rowValues + size - numNulls - 1));
-          resultElements->setNull(resultOffset + size - numNulls - 1, true);
-          ++numNulls;
-        }
-      }
-      std::sort(rowValues, rowValues + size - numNulls, Greater<T>());
-    } else {
-      // Move nulls to beginning of array
-      vector_size_t numNulls = 0;
+    // Nulls go to the beginning of an ascending and the end of a descending
+    // array.
+    vector_size_t numNulls = 0;
+    if (mayHaveNulls) {
       for (vector_size_t i = 0; i < size; ++i) {
-        if (inputElements->isNullAt(i + inputOffset)) {
-          std::swap(*(rowValues + i), *(rowValues + numNulls));
-          resultElements->setNull(resultOffset + numNulls, true);
-          ++numNulls;
-        }
+        numNulls += inputElements->isNullAt(i + inputOffset);
+      }
+      auto nullsOffset = resultOffset + (sortDescending ? size - numNulls : 0);
+      for (vector_size_t i = 0; i < numNulls; ++i) {
+        resultElements->setNull(nullsOffset + i, true);
+      }
+    }
+    T* rowValues = resultRawValues + resultOffset +
+        (sortDescending ? 0 : numNulls);
+    vector_size_t numValues = 0;
+    for (vector_size_t i = 0; i < size; ++i) {
+      if (numNulls == 0 || !inputElements->isNullAt(i + inputOffset)) {
+        rowValues[numValues++] = inputElements->valueAt<T>(i + inputOffset);
       }
-      std::sort(rowValues + numNulls, rowValues + size, Less<T>());
     }
+    sortValues(rowValues, rowValues + numValues);
     resultOffset += size;
   };
 
@@ -17,9 +17,11 @@
 
 #include <stdint.h>
 #include <x86intrin.h>
+#include <type_traits>
 
 #include <folly/CPortability.h>
 
+#include "velox/vector/DecodedVector.h"
 #include "velox/vector/FlatVector.h"
 
 namespace facebook::velox::functions::sparksql {
@@ -106,6 +108,53 @@ uint32_t hashDouble(double input, uint32_t seed) {
       input == -0. ? 0 : *reinterpret_cast<uint64_t*>(&input), seed);
 }
 
+// Mixes the hash of each selected, non-null row of 'values' into 'hashes',
+// using the current hash of the row as seed. Hashing a whole column before
+// moving to the next lets flat inputs without nulls use a plain loop over
+// the raw values.
+template <typename T, typename HashFn>
+void hashColumn(
+    const DecodedVector& values,
+    const SelectivityVector& rows,
+    HashFn hashFn,
+    int32_t* hashes) {
+  if (values.isConstantMapping()) {
+    if (!values.isNullAt(0)) {
+      const auto value = values.valueAt<T>(0);
+      rows.applyToSelected(
+          [&](vector_size_t row) { hashes[row] = hashFn(value, hashes[row]); });
+    }
+    return;
+  }
+  // Booleans are bit-packed and have no raw values to index.
+  if constexpr (!std::is_same_v<T, bool>) {
+    if (!values.mayHaveNulls()) {
+      const T* rawValues = values.data<T>();
+      if (values.isIdentityMapping()) {
+        if (rows.isAllSelected()) {
+          for (auto row = rows.begin(); row < rows.end(); ++row) {
+            hashes[row] = hashFn(rawValues[row], hashes[row]);
+          }
+          return;
+        }
+        rows.applyToSelected([&](vector_size_t row) {
+          hashes[row] = hashFn(rawValues[row], hashes[row]);
+        });
+        return;
+      }
+      rows.applyToSelected([&](vector_size_t row) {
+        hashes[row] = hashFn(rawValues[values.index(row)], hashes[row]);
+      });
+      return;
+    }
+  }
+  rows.applyToSelected([&](vector_size_t row) {
+    if (!values.isNullAt(row)) {
+      hashes[row] = hashFn(values.valueAt<T>(row), hashes[row]);
+    }
+  });
+}
+
 class HashFunction final : public exec::VectorFunction {
   bool isDefaultNullBehavior() const final {
     return false;
@@ -122,26 +171,24 @@ class HashFunction final : public exec::VectorFunction {
     BaseVector::ensureWritable(rows, INTEGER(), context->pool(), resultRef);
 
     FlatVector<int32_t>& result = *(*resultRef)->as<FlatVector<int32_t>>();
-    rows.applyToSelected([&](int row) { result.set(row, kSeed); });
-
-    exec::LocalSelectivityVector selectedMinusNulls(context);
+    result.clearNulls(rows);
+    auto rawHashes = result.mutableRawValues();
+    rows.applyToSelected([&](vector_size_t row) { rawHashes[row] = kSeed; });
 
+    // Null arguments leave the hash of the row unchanged, so the hash of
+    // each row is seeded with the hash of the previous columns.
     for (auto& arg : args) {
       exec::LocalDecodedVector decoded(context, *arg, rows);
-      const SelectivityVector* selected = &rows;
-      if (arg->mayHaveNulls()) {
-        *selectedMinusNulls.get(rows.end()) = rows;
-        selectedMinusNulls->deselectNulls(
-            arg->flatRawNulls(rows), rows.begin(), rows.end());
-        selected = selectedMinusNulls.get();
-      }
       switch (arg->type()->kind()) {
 #define CASE(typeEnum, hashFn, inputType)                                      \
   case TypeKind::typeEnum:                                                     \
-    selected->applyToSelected([&](int row) {                                   \
-      result.set(                                                              \
-          row, hashFn(decoded->valueAt<inputType>(row), result.valueAt(row))); \
-    });                                                                        \
+    hashColumn<inputType>(                                                     \
+        *decoded,                                                              \
+        rows,                                                                  \
+        [](inputType value, uint32_t seed) {                                   \
+          return hashFn(value, seed);                                          \
+        },                                                                     \
+        rawHashes);                                                            \
     break;
         // Derived from InterpretedHashFunction.hash:
         // https://github.com/apache/spark/blob/382b66e/sql/catalyst/src/main/scala/org/apache/spark/sql/catalyst/expressions/hash.scala#L532
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <optional>
+
+#include "velox/functions/sparksql/tests/SparkFunctionBaseTest.h"
+
+namespace facebook::velox::functions::sparksql::test {
+namespace {
+
+class ArraySortTest : public SparkFunctionBaseTest {
+ protected:
+  void testArraySort(
+      const ArrayVectorPtr& input,
+      const ArrayVectorPtr& expectedAscending,
+      const ArrayVectorPtr& expectedDescending) {
+    auto data = makeRowVector({input});
+    assertEqualVectors(
+        expectedAscending, evaluate<ArrayVector>("array_sort(c0)", data));
+    assertEqualVectors(
+        expectedAscending,
+        evaluate<ArrayVector>("array_sort(c0, false)", data));
+    assertEqualVectors(
+        expectedDescending,
+        evaluate<ArrayVector>("array_sort(c0, true)", data));
+  }
+};
+
+TEST_F(ArraySortTest, nulls) {
+  auto input = makeNullableArrayVector<int32_t>(
+      {{3, std::nullopt, 1, 2},
+       {},
+       {std::nullopt, std::nullopt},
+       {5, -4, 5, std::nullopt, 0}});
+  auto ascending = makeNullableArrayVector<int32_t>(
+      {{std::nullopt, 1, 2, 3},
+       {},
+       {std::nullopt, std::nullopt},
+       {std::nullopt, -4, 0, 5, 5}});
+  auto descending = makeNullableArrayVector<int32_t>(
+      {{3, 2, 1, std::nullopt},
+       {},
+       {std::nullopt, std::nullopt},
+       {5, 5, 0, -4, std::nullopt}});
+  testArraySort(input, ascending, descending);
+}
+
+TEST_F(ArraySortTest, doubles) {
+  constexpr double kInf = std::numeric_limits<double>::infinity();
+  auto input = makeNullableArrayVector<double>(
+      {{1.5, kInf, std::nullopt, -kInf, -2.5, 0.0}});
+  auto ascending = makeNullableArrayVector<double>(
+      {{std::nullopt, -kInf, -2.5, 0.0, 1.5, kInf}});
+  auto descending = makeNullableArrayVector<double>(
+      {{kInf, 1.5, 0.0, -2.5, -kInf, std::nullopt}});
+  testArraySort(input, ascending, descending);
+}
+
+TEST_F(ArraySortTest, nan) {
+  constexpr double kNan = std::numeric_limits<double>::quiet_NaN();
+  auto data = makeRowVector(
+      {makeArrayVector<double>({{kNan, 2.0, -1.0, kNan, 1.0}})});
+  auto result = evaluate<ArrayVector>("array_sort(c0)", data);
+  auto elements = result->elements()->asFlatVector<double>();
+  ASSERT_EQ(result->sizeAt(0), 5);
+  EXPECT_EQ(elements->valueAt(0), -1.0);
+  EXPECT_EQ(elements->valueAt(1), 1.0);
+  EXPECT_EQ(elements->valueAt(2), 2.0);
+  EXPECT_TRUE(std::isnan(elements->valueAt(3)));
+  EXPECT_TRUE(std::isnan(elements->valueAt(4)));
+
+  result = evaluate<ArrayVector>("array_sort(c0, true)", data);
+  elements = result->elements()->asFlatVector<double>();
+  EXPECT_TRUE(std::isnan(elements->valueAt(0)));
+  EXPECT_TRUE(std::isnan(elements->valueAt(1)));
+  EXPECT_EQ(elements->valueAt(2), 2.0);
+  EXPECT_EQ(elements->valueAt(4), -1.0);
+}
+
+// Arrays of different lengths take the different sort kernels.
+TEST_F(ArraySortTest, lengths) {
+  std::vector<std::vector<int64_t>> input;
+  for (auto size : {1, 5, 8, 9, 16, 17, 100, 255, 256, 1'000}) {
+    std::vector<int64_t> array;
+    for (auto i = 0; i < size; ++i) {
+      array.push_back((i * 7919 % 1'000 - 500) * (i % 3 == 0 ? 1 : 1'000'000));
+    }
+    input.push_back(std::move(array));
+  }
+  auto ascending = input;
+  auto descending = input;
+  for (size_t i = 0; i < input.size(); ++i) {
+    std::sort(ascending[i].begin(), ascending[i].end());
+    std::sort(
+        descending[i].begin(), descending[i].end(), std::greater<int64_t>());
+  }
+  testArraySort(
+      makeArrayVector<int64_t>(input),
+      makeArrayVector<int64_t>(ascending),
+      makeArrayVector<int64_t>(descending));
+}
+
+TEST_F(ArraySortTest, timestamps) {
+  auto input = makeArrayVector<Timestamp>(
+      {{Timestamp(3, 0), Timestamp(1, 5), Timestamp(1, 2)}});
+  auto ascending = makeArrayVector<Timestamp>(
+      {{Timestamp(1, 2), Timestamp(1, 5), Timestamp(3, 0)}});
+  auto descending = makeArrayVector<Timestamp>(
+      {{Timestamp(3, 0), Timestamp(1, 5), Timestamp(1, 2)}});
+  testArraySort(input, ascending, descending);
+}
+
+} // namespace
+} // namespace facebook::velox::functions::sparksql::test
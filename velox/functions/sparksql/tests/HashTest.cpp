@@ -113,5 +113,39 @@ TEST_F(HashTest, Float) {
   EXPECT_EQ(hash<float>(-limits::infinity()), 427440766);
 }
 
+TEST_F(HashTest, multipleColumns) {
+  // Flat, dictionary and constant columns with and without nulls hash the
+  // same as the row by row results.
+  const vector_size_t size = 100;
+  auto ints = makeFlatVector<int64_t>(size, [](auto row) { return row * 7; });
+  auto strings = makeFlatVector<StringView>(
+      size,
+      [](auto row) { return row % 3 == 0 ? "Spark" : "abcdefgh"; },
+      nullEvery(5));
+  auto doubles = wrapInDictionary(
+      makeIndicesInReverse(size),
+      size,
+      makeFlatVector<double>(size, [](auto row) { return row * 0.5; }));
+  auto constant = makeConstant<int32_t>(1, size);
+  auto data = makeRowVector({ints, strings, doubles, constant});
+
+  auto result = evaluate<SimpleVector<int32_t>>("hash(c0, c1, c2, c3)", data);
+  ASSERT_EQ(size, result->size());
+  for (auto row = 0; row < size; ++row) {
+    std::optional<std::string> string;
+    if (!strings->isNullAt(row)) {
+      string = strings->valueAt(row).str();
+    }
+    auto expected = evaluateOnce<int32_t>(
+        "hash(c0, c1, c2, c3)",
+        std::optional<int64_t>(ints->valueAt(row)),
+        string,
+        std::optional<double>((size - 1 - row) * 0.5),
+        std::optional<int32_t>(1));
+    ASSERT_FALSE(result->isNullAt(row));
+    ASSERT_EQ(expected.value(), result->valueAt(row)) << row;
+  }
+}
+
 } // namespace
 } // namespace facebook::velox::functions::sparksql::test
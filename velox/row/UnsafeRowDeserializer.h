@@ -1139,4 +1139,116 @@ struct UnsafeRowDynamicVectorDeserializer {
   }
 };
 
+/**
+ * Deserializes a batch of UnsafeRows of the same row type to a RowVector. The
+ * null set and fixed-width layout only depends on the row type, so primitive
+ * fields are read column by column at offsets computed once for the batch.
+ * Complex type fields go through UnsafeRowDynamicVectorDeserializer a column
+ * at a time. As there, strings point into the rows, which must outlive the
+ * result.
+ */
+struct UnsafeRowBatchDeserializer {
+  /**
+   * @param rows the serialized rows
+   * @param type the row type
+   * @param pool the memory pool to allocate Vectors from
+   * @return a RowVector with one row per element of rows
+   */
+  static RowVectorPtr deserialize(
+      const std::vector<std::string_view>& rows,
+      const RowTypePtr& type,
+      memory::MemoryPool* pool) {
+    const size_t numFields = type->size();
+    const size_t nullLength = UnsafeRow::getNullLength(numFields);
+    std::vector<VectorPtr> children(numFields);
+    for (ChannelIndex field = 0; field < numFields; ++field) {
+      const auto& fieldType = type->childAt(field);
+      if (fieldType->isPrimitiveType()) {
+        children[field] = VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+            deserializePrimitiveColumn,
+            fieldType->kind(),
+            rows,
+            fieldType,
+            field,
+            nullLength,
+            pool);
+        continue;
+      }
+
+      std::vector<std::optional<std::string_view>> values;
+      values.reserve(rows.size());
+      for (const auto& row : rows) {
+        if (bits::isBitSet(row.data(), field)) {
+          values.emplace_back(std::nullopt);
+        } else {
+          auto [offset, size] = readDataPointer(row, nullLength, field);
+          values.emplace_back(std::string_view(row.data() + offset, size));
+        }
+      }
+      children[field] = UnsafeRowDynamicVectorDeserializer::deserializeComplex(
+          values, fieldType, pool);
+    }
+    return std::make_shared<RowVector>(
+        pool, type, BufferPtr(nullptr), rows.size(), std::move(children), 0);
+  }
+
+ private:
+  /**
+   * @return the offset and size of the variable-length data of field 'field'
+   * of 'row'.
+   */
+  static std::tuple<uint32_t, uint32_t> readDataPointer(
+      std::string_view row,
+      size_t nullLength,
+      ChannelIndex field) {
+    uint64_t dataPointer;
+    std::memcpy(
+        &dataPointer,
+        row.data() + nullLength + field * UnsafeRow::kFieldWidthBytes,
+        sizeof(dataPointer));
+    return {
+        static_cast<uint32_t>(dataPointer >> 32),
+        static_cast<uint32_t>(dataPointer)};
+  }
+
+  /**
+   * Reads primitive field 'field' of all rows into a FlatVector.
+   */
+  template <TypeKind Kind>
+  static VectorPtr deserializePrimitiveColumn(
+      const std::vector<std::string_view>& rows,
+      const TypePtr& type,
+      ChannelIndex field,
+      size_t nullLength,
+      memory::MemoryPool* pool) {
+    using Trait = ScalarTraits<Kind>;
+    using InMemoryType = typename Trait::InMemoryType;
+    auto vector = BaseVector::create(type, rows.size(), pool);
+    auto* flatVector = vector->template asFlatVector<InMemoryType>();
+    const size_t fieldOffset = nullLength + field * UnsafeRow::kFieldWidthBytes;
+
+    vector_size_t nullCount = 0;
+    for (vector_size_t i = 0; i < rows.size(); ++i) {
+      const char* row = rows[i].data();
+      if (bits::isBitSet(row, field)) {
+        flatVector->setNull(i, true);
+        ++nullCount;
+      } else if constexpr (std::is_same_v<InMemoryType, StringView>) {
+        auto [offset, size] = readDataPointer(rows[i], nullLength, field);
+        flatVector->set(i, StringView(row + offset, size));
+      } else {
+        typename Trait::SerializedType value;
+        std::memcpy(&value, row + fieldOffset, sizeof(value));
+        if constexpr (Kind == TypeKind::TIMESTAMP) {
+          flatVector->set(i, Timestamp::fromMicros(value));
+        } else {
+          flatVector->set(i, value);
+        }
+      }
+    }
+    vector->setNullCount(nullCount);
+    return vector;
+  }
+};
+
 } // namespace facebook::velox::row
@@ -361,4 +361,114 @@ struct UnsafeRowDynamicSerializer : UnsafeRowSerializer {
   }
 };
 
+/// Serializes a RowVector into consecutive UnsafeRows a batch at a time. The
+/// null set and fixed-width layout only depends on the row type, so it is
+/// computed once for the batch. Variable-width fields are written in one pass
+/// over the rows, which also places the rows in the buffer, and fixed-width
+/// fields are then written column by column.
+struct UnsafeRowBatchSerializer {
+  /// Serializes all rows of 'data' into 'buffer'. Each row is padded to a
+  /// multiple of the field width. As with the row at a time serializers,
+  /// 'buffer' must be zero-filled and large enough.
+  /// \param data
+  /// \param buffer
+  /// \return the offset of each row in 'buffer' followed by the end of the
+  /// last row, so that row i spans [offsets[i], offsets[i + 1]).
+  static std::vector<size_t> serialize(const RowVectorPtr& data, char* buffer) {
+    VELOX_CHECK_NOT_NULL(buffer);
+    const auto& rowType = data->type()->asRow();
+    const size_t numFields = rowType.size();
+    const vector_size_t numRows = data->size();
+    const size_t nullLength = UnsafeRow::getNullLength(numFields);
+    const size_t fixedLength =
+        nullLength + numFields * UnsafeRow::kFieldWidthBytes;
+
+    SelectivityVector allRows(numRows);
+    std::vector<DecodedVector> decoded(numFields);
+    std::vector<ChannelIndex> fixedWidthFields;
+    std::vector<ChannelIndex> variableWidthFields;
+    for (ChannelIndex field = 0; field < numFields; ++field) {
+      decoded[field].decode(*data->childAt(field), allRows);
+      if (rowType.childAt(field)->isFixedWidth()) {
+        fixedWidthFields.push_back(field);
+      } else {
+        variableWidthFields.push_back(field);
+      }
+    }
+
+    std::vector<size_t> offsets(numRows + 1);
+    size_t offset = 0;
+    for (vector_size_t row = 0; row < numRows; ++row) {
+      offsets[row] = offset;
+      char* rowStart = buffer + offset;
+      auto* fixedData = reinterpret_cast<uint64_t*>(rowStart + nullLength);
+      size_t rowSize = fixedLength;
+      for (auto field : variableWidthFields) {
+        if (decoded[field].isNullAt(row)) {
+          bits::setBit(rowStart, field);
+          continue;
+        }
+        char* location = rowStart + rowSize;
+        size_t size;
+        const auto& type = rowType.childAt(field);
+        if (type->kind() == TypeKind::VARCHAR ||
+            type->kind() == TypeKind::VARBINARY) {
+          auto value = decoded[field].valueAt<StringView>(row);
+          std::copy(value.data(), value.data() + value.size(), location);
+          size = value.size();
+        } else {
+          size = UnsafeRowDynamicSerializer::serialize(
+                     type, data->childAt(field), location, row)
+                     .value_or(0);
+        }
+        VELOX_CHECK_LE(rowSize, UINT32_MAX);
+        VELOX_CHECK_LE(size, UINT32_MAX);
+        fixedData[field] = rowSize << 32 | size;
+        rowSize += UnsafeRow::alignToFieldWidth(size);
+      }
+      offset += rowSize;
+    }
+    offsets[numRows] = offset;
+
+    for (auto field : fixedWidthFields) {
+      VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+          serializeFixedWidthColumn,
+          rowType.childAt(field)->kind(),
+          decoded[field],
+          field,
+          nullLength,
+          offsets,
+          buffer);
+    }
+    return offsets;
+  }
+
+ private:
+  /// Writes the nulls and values of fixed-width field 'field' of all rows.
+  /// Timestamps are written as micros, following Spark.
+  template <TypeKind Kind>
+  static void serializeFixedWidthColumn(
+      const DecodedVector& decoded,
+      ChannelIndex field,
+      size_t nullLength,
+      const std::vector<size_t>& offsets,
+      char* buffer) {
+    using NativeType = typename TypeTraits<Kind>::NativeType;
+    const size_t fieldOffset = nullLength + field * UnsafeRow::kFieldWidthBytes;
+    const vector_size_t numRows = offsets.size() - 1;
+    for (vector_size_t row = 0; row < numRows; ++row) {
+      char* rowStart = buffer + offsets[row];
+      if (decoded.isNullAt(row)) {
+        bits::setBit(rowStart, field);
+      } else if constexpr (Kind == TypeKind::TIMESTAMP) {
+        *reinterpret_cast<int64_t*>(rowStart + fieldOffset) =
+            decoded.valueAt<Timestamp>(row).toMicros();
+      } else {
+        *reinterpret_cast<NativeType*>(rowStart + fieldOffset) =
+            decoded.valueAt<NativeType>(row);
+      }
+    }
+  }
+};
+
 } // namespace facebook::velox::row
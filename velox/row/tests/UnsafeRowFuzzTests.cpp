@@ -99,5 +99,71 @@ TEST_F(UnsafeRowFuzzTests, simpleTypeRoundTripTest) {
   }
 }
 
+TEST_F(UnsafeRowFuzzTests, batchRoundTripTest) {
+  auto rowType = ROW({
+      BOOLEAN(),
+      TINYINT(),
+      SMALLINT(),
+      INTEGER(),
+      BIGINT(),
+      REAL(),
+      DOUBLE(),
+      VARCHAR(),
+      TIMESTAMP(),
+      ARRAY(INTEGER()),
+      MAP(VARCHAR(), BIGINT()),
+  });
+
+  VectorFuzzer::Options opts;
+  opts.vectorSize = 100;
+  opts.nullChance = 10;
+  opts.stringVariableLength = true;
+  opts.stringLength = 20;
+  opts.containerLength = 5;
+  opts.useMicrosecondPrecisionTimestamp = true;
+
+  auto seed = folly::Random::rand32();
+  LOG(INFO) << "seed: " << seed;
+  VectorFuzzer fuzzer(opts, pool_.get(), seed);
+
+  constexpr size_t kBatchBufferSize = 1 << 20;
+  auto batchBuffer =
+      AlignedBuffer::allocate<char>(kBatchBufferSize, pool_.get(), true);
+  auto* rawBatch = batchBuffer->asMutable<char>();
+
+  const auto iterations = 20;
+  for (size_t i = 0; i < iterations; ++i) {
+    std::memset(rawBatch, 0, kBatchBufferSize);
+    auto inputVector =
+        std::dynamic_pointer_cast<RowVector>(fuzzer.fuzzRow(rowType));
+    ASSERT_TRUE(inputVector != nullptr);
+
+    auto offsets = UnsafeRowBatchSerializer::serialize(inputVector, rawBatch);
+    ASSERT_EQ(offsets.size(), inputVector->size() + 1);
+
+    // Each row matches the row at a time serialization, padded to 8 bytes.
+    std::vector<std::string_view> rows;
+    for (auto row = 0; row < inputVector->size(); ++row) {
+      clearBuffer();
+      auto rowSize = UnsafeRowDynamicSerializer::serialize(
+          rowType, inputVector, buffer_, row);
+      auto batchRowSize = offsets[row + 1] - offsets[row];
+      ASSERT_EQ(batchRowSize % 8, 0);
+      ASSERT_GE(batchRowSize, rowSize.value());
+      ASSERT_LT(batchRowSize - rowSize.value(), 8);
+      ASSERT_EQ(
+          std::memcmp(rawBatch + offsets[row], buffer_, rowSize.value()), 0)
+          << "at " << row << " (seed " << seed << ").";
+      rows.emplace_back(rawBatch + offsets[row], batchRowSize);
+    }
+
+    auto outputVector =
+        UnsafeRowBatchDeserializer::deserialize(rows, rowType, pool_.get());
+    ASSERT_EQ(outputVector->size(), inputVector->size());
+    assertEqualVectors(
+        inputVector, outputVector, fmt::format(" (seed {}).", seed));
+  }
+}
+
 } // namespace
 } // namespace facebook::velox::row
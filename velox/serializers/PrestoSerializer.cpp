@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 #include "velox/serializers/PrestoSerializer.h"
+#include <folly/Random.h>
 #include <boost/crc.hpp>
+#include "velox/common/compression/Compression.h"
 #include "velox/functions/prestosql/types/TimestampWithTimeZoneType.h"
 #include "velox/type/Date.h"
 #include "velox/vector/BiasVector.h"
@@ -45,11 +47,12 @@ int64_t computeChecksum(
     ByteStream* source,
     int codecMarker,
     int numRows,
-    int uncompressedSize) {
+    int uncompressedSize,
+    int sizeInBytes) {
   auto offset = source->tellp();
   boost::crc_32_type crc32;
 
-  auto remainingBytes = uncompressedSize;
+  auto remainingBytes = sizeInBytes;
   while (remainingBytes > 0) {
     auto data = source->nextView(remainingBytes);
     crc32.process_bytes(data.data(), data.size());
@@ -574,9 +577,8 @@ std::string readLengthPrefixedString(ByteStream* source) {
   return value;
 }
 
-void readAndCheckType(ByteStream* source, TypePtr type) {
+void checkTypeEncoding(const std::string& encoding, const TypePtr& type) {
   auto kindEncoding = typeToEncodingName(type);
-  std::string encoding = readLengthPrefixedString(source);
   VELOX_CHECK(
       encoding == kindEncoding,
       "Encoding to Type mismatch {} expected {} got {}",
@@ -585,6 +587,36 @@ void readAndCheckType(ByteStream* source, TypePtr type) {
       encoding);
 }
 
+// Reads an RLE block into a ConstantVector.
+void readConstantVector(
+    ByteStream* source,
+    const TypePtr& type,
+    velox::memory::MemoryPool* pool,
+    VectorPtr* result) {
+  auto size = source->read<int32_t>();
+  std::vector<VectorPtr> value(1);
+  readColumns(source, pool, {type}, &value);
+  *result = BaseVector::wrapInConstant(size, 0, value[0]);
+}
+
+// Reads a DICTIONARY block into a DictionaryVector.
+void readDictionaryVector(
+    ByteStream* source,
+    const TypePtr& type,
+    velox::memory::MemoryPool* pool,
+    VectorPtr* result) {
+  auto size = source->read<int32_t>();
+  std::vector<VectorPtr> dictionary(1);
+  readColumns(source, pool, {type}, &dictionary);
+  auto indices = AlignedBuffer::allocate<vector_size_t>(size, pool);
+  source->readBytes(
+      indices->asMutable<uint8_t>(), size * sizeof(vector_size_t));
+  // Skip the dictionary id.
+  source->skip(3 * sizeof(int64_t));
+  *result = BaseVector::wrapInDictionary(
+      BufferPtr(nullptr), indices, size, dictionary[0]);
+}
+
 void readColumns(
     ByteStream* source,
     velox::memory::MemoryPool* pool,
@@ -621,16 +653,35 @@ void readColumns(
         "Column reader for type {} is missing",
         types[i]->kindName());
 
-    readAndCheckType(source, types[i]);
+    auto encoding = readLengthPrefixedString(source);
+    if (encoding == "RLE") {
+      readConstantVector(source, types[i], pool, &(*result)[i]);
+      continue;
+    }
+    if (encoding == "DICTIONARY") {
+      readDictionaryVector(source, types[i], pool, &(*result)[i]);
+      continue;
+    }
+    checkTypeEncoding(encoding, types[i]);
+    // The readers reuse only vectors in the encoding they produce.
+    auto& previous = (*result)[i];
+    if (previous &&
+        (previous->isConstantEncoding() ||
+         previous->encoding() == VectorEncoding::Simple::DICTIONARY)) {
+      previous = nullptr;
+    }
     it->second(source, types[i], pool, &(*result)[i]);
   }
 }
 
-void writeInt32(std::ostream* out, int32_t value) {
+// 'Out' is std::ostream or ByteRangeWriter.
+template <typename Out>
+void writeInt32(Out* out, int32_t value) {
   out->write(reinterpret_cast<char*>(&value), sizeof(value));
 }
 
-void writeInt64(std::ostream* out, int64_t value) {
+template <typename Out>
+void writeInt64(Out* out, int64_t value) {
   out->write(reinterpret_cast<char*>(&value), sizeof(value));
 }
 
@@ -731,8 +782,10 @@ class VectorStream {
     return children_[index].get();
   }
 
-  // Writes out the accumulated contents. Does not change the state.
-  void flush(std::ostream* out) {
+  // Writes out the accumulated contents to std::ostream or ByteRangeWriter.
+  // Does not change the state.
+  template <typename Out>
+  void flush(Out* out) {
     out->write(reinterpret_cast<char*>(header_.buffer), header_.size);
     switch (type_->kind()) {
       case TypeKind::ROW:
@@ -799,7 +852,8 @@ class VectorStream {
     }
   }
 
-  void flushNulls(std::ostream* out) {
+  template <typename Out>
+  void flushNulls(Out* out) {
     if (!nullCount_) {
       char zero = 0;
       out->write(&zero, 1);
@@ -855,6 +909,15 @@ void VectorStream::append(folly::Range<const bool*> values) {
   appendOne<uint8_t>(values[0] ? 1 : 0);
 }
 
+static inline int32_t rangesTotalSize(
+    const folly::Range<const IndexRange*>& ranges) {
+  int32_t total = 0;
+  for (auto& range : ranges) {
+    total += range.size;
+  }
+  return total;
+}
+
 template <TypeKind kind>
 void serializeFlatVector(
     const BaseVector* vector,
@@ -864,6 +927,25 @@ void serializeFlatVector(
   auto flatVector = dynamic_cast<const FlatVector<T>*>(vector);
   auto rawValues = flatVector->rawValues();
   if (!flatVector->mayHaveNulls()) {
+    if constexpr (!std::is_same_v<T, StringView>) {
+      if (ranges.size() > 1) {
+        // The rows of one destination of a shuffle are scattered in many
+        // short ranges. Gathers the values for a single append.
+        auto numRows = rangesTotalSize(ranges);
+        std::vector<T> values(numRows);
+        auto rawGathered = values.data();
+        for (auto& range : ranges) {
+          std::copy(
+              rawValues + range.begin,
+              rawValues + range.begin + range.size,
+              rawGathered);
+          rawGathered += range.size;
+        }
+        stream->appendNonNull(numRows);
+        stream->append<T>(folly::Range(values.data(), numRows));
+        return;
+      }
+    }
     for (auto& range : ranges) {
       stream->appendNonNull(range.size);
       stream->append<T>(folly::Range(&rawValues[range.begin], range.size));
@@ -1075,15 +1157,6 @@ void serializeMapVector(
       mapVector->mapValues().get(), childRanges, stream->childAt(1));
 }
 
-static inline int32_t rangesTotalSize(
-    const folly::Range<const IndexRange*>& ranges) {
-  int32_t total = 0;
-  for (auto& range : ranges) {
-    total += range.size;
-  }
-  return total;
-}
-
 template <TypeKind kind>
 void serializeConstantVector(
     const BaseVector* vector,
@@ -1442,18 +1515,202 @@ void estimateSerializedSizeInt(
   }
 }
 
+template <typename Out>
+void writeEncodingName(Out* out, const std::string& name) {
+  writeInt32(out, name.size());
+  out->write(name.data(), name.size());
+}
+
+// Serializes a top level column. A column that is constant in all
+// appended vectors is written as an RLE block. A column that is a
+// dictionary over the same base vector in all appended vectors is written
+// as a DICTIONARY block. The first append that does not fit the encoding
+// flattens the rows so far.
+class ColumnStream {
+ public:
+  ColumnStream(TypePtr type, StreamArena* streamArena, int32_t initialNumRows)
+      : type_(type),
+        streamArena_(streamArena),
+        flat_(type, streamArena, initialNumRows) {}
+
+  void append(
+      const VectorPtr& vector,
+      const folly::Range<const IndexRange*>& ranges) {
+    auto numRows = rangesTotalSize(ranges);
+    switch (encoding_) {
+      case Encoding::kNone:
+        if (startConstant(vector, numRows) ||
+            startDictionary(vector, ranges, numRows)) {
+          return;
+        }
+        encoding_ = Encoding::kFlat;
+        break;
+      case Encoding::kConstant:
+        if (vector->isConstantEncoding() &&
+            vector->equalValueAt(base_.get(), 0, 0)) {
+          numRows_ += numRows;
+          return;
+        }
+        flatten();
+        break;
+      case Encoding::kDictionary:
+        if (vector->encoding() == VectorEncoding::Simple::DICTIONARY &&
+            vector->valueVector() == base_ && addIndices(vector, ranges)) {
+          numRows_ += numRows;
+          return;
+        }
+        flatten();
+        break;
+      case Encoding::kFlat:
+        break;
+    }
+    serializeColumn(vector.get(), ranges, &flat_);
+  }
+
+  template <typename Out>
+  void flush(Out* out) {
+    switch (encoding_) {
+      case Encoding::kConstant:
+        writeEncodingName(out, "RLE");
+        writeInt32(out, numRows_);
+        baseStream_->flush(out);
+        return;
+      case Encoding::kDictionary:
+        writeEncodingName(out, "DICTIONARY");
+        writeInt32(out, numRows_);
+        baseStream_->flush(out);
+        out->write(
+            reinterpret_cast<const char*>(indices_.data()),
+            indices_.size() * sizeof(int32_t));
+        // The dictionary id: most and least significant bits and sequence
+        // id. Presto caches work per dictionary id, so each dictionary
+        // gets its own.
+        writeInt64(out, dictionaryId_.first);
+        writeInt64(out, dictionaryId_.second);
+        writeInt64(out, 0);
+        return;
+      default:
+        flat_.flush(out);
+    }
+  }
+
+ private:
+  enum class Encoding { kNone, kConstant, kDictionary, kFlat };
+
+  bool startConstant(const VectorPtr& vector, int32_t numRows) {
+    if (!vector->isConstantEncoding() || numRows < 2) {
+      return false;
+    }
+    encoding_ = Encoding::kConstant;
+    base_ = vector;
+    numRows_ = numRows;
+    baseStream_ = std::make_unique<VectorStream>(type_, streamArena_, 1);
+    IndexRange first{0, 1};
+    serializeColumn(vector.get(), folly::Range(&first, 1), baseStream_.get());
+    return true;
+  }
+
+  bool startDictionary(
+      const VectorPtr& vector,
+      const folly::Range<const IndexRange*>& ranges,
+      int32_t numRows) {
+    if (vector->encoding() != VectorEncoding::Simple::DICTIONARY) {
+      return false;
+    }
+    auto base = vector->valueVector();
+    // The whole base is sent, so a dictionary over a larger base is not
+    // worth keeping.
+    if (base->isLazy() || base->size() > numRows) {
+      return false;
+    }
+    base_ = base;
+    if (!addIndices(vector, ranges)) {
+      base_ = nullptr;
+      return false;
+    }
+    encoding_ = Encoding::kDictionary;
+    numRows_ = numRows;
+    dictionaryId_ = {folly::Random::rand64(), folly::Random::rand64()};
+    baseStream_ =
+        std::make_unique<VectorStream>(type_, streamArena_, base->size());
+    IndexRange all{0, base->size()};
+    serializeColumn(base.get(), folly::Range(&all, 1), baseStream_.get());
+    return true;
+  }
+
+  // Adds the indices of 'ranges' of the dictionary 'vector' over 'base_'.
+  // Returns false without adding anything if the dictionary adds nulls,
+  // which the DICTIONARY block cannot represent.
+  bool addIndices(
+      const VectorPtr& vector,
+      const folly::Range<const IndexRange*>& ranges) {
+    auto rawNulls = vector->rawNulls();
+    if (rawNulls) {
+      for (auto& range : ranges) {
+        if (!bits::isAllSet(rawNulls, range.begin, range.begin + range.size)) {
+          return false;
+        }
+      }
+    }
+    auto rawIndices = vector->wrapInfo()->as<vector_size_t>();
+    for (auto& range : ranges) {
+      indices_.insert(
+          indices_.end(),
+          rawIndices + range.begin,
+          rawIndices + range.begin + range.size);
+    }
+    return true;
+  }
+
+  // Serializes the rows appended so far into 'flat_' and continues without
+  // encoding.
+  void flatten() {
+    if (encoding_ == Encoding::kConstant) {
+      std::vector<IndexRange> ranges(numRows_, IndexRange{0, 1});
+      serializeColumn(base_.get(), ranges, &flat_);
+    } else {
+      std::vector<IndexRange> ranges;
+      ranges.reserve(indices_.size());
+      for (auto index : indices_) {
+        ranges.push_back(IndexRange{index, 1});
+      }
+      serializeColumn(base_.get(), ranges, &flat_);
+      indices_.clear();
+    }
+    encoding_ = Encoding::kFlat;
+    base_ = nullptr;
+    baseStream_ = nullptr;
+  }
+
+  const TypePtr type_;
+  StreamArena* const streamArena_;
+  Encoding encoding_{Encoding::kNone};
+  VectorStream flat_;
+
+  // The constant vector or the base of the dictionary and its values.
+  VectorPtr base_;
+  std::unique_ptr<VectorStream> baseStream_;
+  int32_t numRows_{0};
+
+  // Indices into 'base_' for a dictionary.
+  std::vector<int32_t> indices_;
+  std::pair<int64_t, int64_t> dictionaryId_;
+};
+
 class PrestoVectorSerializer : public VectorSerializer {
  public:
   PrestoVectorSerializer(
       std::shared_ptr<const RowType> rowType,
       int32_t numRows,
-      StreamArena* streamArena) {
+      StreamArena* streamArena,
+      common::CompressionKind compressionKind)
+      : compressionKind_(compressionKind) {
     auto types = rowType->children();
     auto numTypes = types.size();
     streams_.resize(numTypes);
     for (int i = 0; i < numTypes; i++) {
       streams_[i] =
-          std::make_unique<VectorStream>(types[i], streamArena, numRows);
+          std::make_unique<ColumnStream>(types[i], streamArena, numRows);
     }
   }
 
@@ -1464,7 +1721,7 @@ class PrestoVectorSerializer : public VectorSerializer {
     if (newRows > 0) {
       numRows_ += newRows;
       for (int32_t i = 0; i < vector->childrenSize(); ++i) {
-        serializeColumn(vector->childAt(i).get(), ranges, streams_[i].get());
+        streams_[i]->append(vector->childAt(i), ranges);
       }
     }
   }
@@ -1480,39 +1737,105 @@ class PrestoVectorSerializer : public VectorSerializer {
       stream->flush(&data);
     }
     auto stringData = data.str();
-    int32_t offset = out->tellp();
-
-    writeInt32(out, numRows_);
-    out->write(&codec, 1);
-
-    // make space for uncompressedSizeInBytes & sizeInBytes
-    writeInt32(out, 0);
-    writeInt32(out, 0);
-    writeInt64(out, 0); // checksum
+    int32_t uncompressedSize = stringData.size();
+    std::string compressed;
+    if (compress(stringData, compressed)) {
+      codec |= kCompressedBitMask;
+      stringData = std::move(compressed);
+    }
 
+    int64_t crc =
+        computeChecksum(stringData, codec, numRows_, uncompressedSize);
+    writeHeader(out, codec, uncompressedSize, stringData.size(), crc);
     out->write(stringData.data(), stringData.size());
+  }
+
+  // Adds the streams to 'out' without copying. Only the header and the
+  // counts are copied. A compressed page is copied into 'out'.
+  void flush(ByteRangeWriter* out) override {
+    char codec = getCodecMarker();
+    ByteRangeWriter data;
+    // number of columns
+    writeInt32(&data, streams_.size());
+    for (auto& stream : streams_) {
+      stream->flush(&data);
+    }
+    int32_t uncompressedSize = data.size();
 
-    // fill in uncompressedSizeInBytes & sizeInBytes
-    int32_t size = (int32_t)out->tellp() - offset;
-    int32_t uncompressedSize = size - kHeaderSize;
+    if (compressionKind_ != common::CompressionKind::kNone) {
+      std::string stringData;
+      stringData.reserve(uncompressedSize);
+      for (auto& range : data.ranges()) {
+        stringData.append(reinterpret_cast<char*>(range.buffer), range.size);
+      }
+      std::string compressed;
+      if (compress(stringData, compressed)) {
+        codec |= kCompressedBitMask;
+        int64_t crc =
+            computeChecksum(compressed, codec, numRows_, uncompressedSize);
+        writeHeader(out, codec, uncompressedSize, compressed.size(), crc);
+        out->write(compressed.data(), compressed.size());
+        return;
+      }
+    }
 
-    int64_t crc =
-        computeChecksum(stringData, codec, numRows_, uncompressedSize);
+    // The checksum is computed over the ranges in place.
+    ByteStream input;
+    input.resetInput(std::vector<ByteRange>(data.ranges()));
+    int64_t crc = computeChecksum(
+        &input, codec, numRows_, uncompressedSize, uncompressedSize);
+    writeHeader(out, codec, uncompressedSize, uncompressedSize, crc);
+    out->append(std::move(data));
+  }
 
-    out->seekp(offset + kSizeInBytesOffset);
-    writeInt32(out, uncompressedSize);
+ private:
+  // Pages that do not compress to at most this fraction of their size are
+  // sent uncompressed. Same as in Presto.
+  static constexpr double kMinCompressionRatio = 0.8;
+
+  template <typename Out>
+  void writeHeader(
+      Out* out,
+      char codec,
+      int32_t uncompressedSize,
+      int32_t sizeInBytes,
+      int64_t crc) {
+    writeInt32(out, numRows_);
+    out->write(&codec, 1);
     writeInt32(out, uncompressedSize);
+    writeInt32(out, sizeInBytes);
     writeInt64(out, crc);
-    out->seekp(offset + size);
   }
 
- private:
-  static const int32_t kSizeInBytesOffset{4 + 1};
-  static const int32_t kHeaderSize{kSizeInBytesOffset + 4 + 4 + 8};
+  // Compresses 'data' into 'compressed' with 'compressionKind_'. Returns
+  // false if there is no compression or if it does not save enough.
+  bool compress(const std::string& data, std::string& compressed) {
+    if (compressionKind_ == common::CompressionKind::kNone) {
+      return false;
+    }
+    compressed.resize(
+        common::maxCompressedLength(compressionKind_, data.size()));
+    auto size = common::compress(
+        compressionKind_,
+        data.data(),
+        data.size(),
+        compressed.data(),
+        compressed.size());
+    if (size > data.size() * kMinCompressionRatio) {
+      return false;
+    }
+    compressed.resize(size);
+    return true;
+  }
 
+  const common::CompressionKind compressionKind_;
   int32_t numRows_{0};
-  std::vector<std::unique_ptr<VectorStream>> streams_;
+  std::vector<std::unique_ptr<ColumnStream>> streams_;
 };
+
+common::CompressionKind compressionKind(const VectorSerde::Options* options) {
+  return options ? options->compressionKind : common::CompressionKind::kNone;
+}
 } // namespace
 
 void PrestoVectorSerde::estimateSerializedSize(
@@ -1525,15 +1848,18 @@ void PrestoVectorSerde::estimateSerializedSize(
 std::unique_ptr<VectorSerializer> PrestoVectorSerde::createSerializer(
     std::shared_ptr<const RowType> type,
     int32_t numRows,
-    StreamArena* streamArena) {
-  return std::make_unique<PrestoVectorSerializer>(type, numRows, streamArena);
+    StreamArena* streamArena,
+    const Options* options) {
+  return std::make_unique<PrestoVectorSerializer>(
+      type, numRows, streamArena, compressionKind(options));
 }
 
 void PrestoVectorSerde::deserialize(
     ByteStream* source,
     velox::memory::MemoryPool* pool,
     std::shared_ptr<const RowType> type,
-    std::shared_ptr<RowVector>* result) {
+    std::shared_ptr<RowVector>* result,
+    const Options* options) {
   auto numRows = source->read<int32_t>();
   if (!(*result) || !result->unique() || (*result)->type() != type) {
     *result = std::dynamic_pointer_cast<RowVector>(
@@ -1544,23 +1870,52 @@ void PrestoVectorSerde::deserialize(
 
   auto pageCodecMarker = source->read<int8_t>();
   auto uncompressedSize = source->read<int32_t>();
-  // skip size in bytes
-  source->skip(4);
+  auto sizeInBytes = source->read<int32_t>();
   auto checksum = source->read<int64_t>();
 
   int64_t actualCheckSum = 0;
   if (isChecksumBitSet(pageCodecMarker)) {
-    actualCheckSum =
-        computeChecksum(source, pageCodecMarker, numRows, uncompressedSize);
+    actualCheckSum = computeChecksum(
+        source, pageCodecMarker, numRows, uncompressedSize, sizeInBytes);
   }
   VELOX_CHECK_EQ(
       checksum, actualCheckSum, "Received corrupted serialized page.");
-
-  // skip number of columns
-  source->skip(4);
+  VELOX_CHECK(
+      !isEncryptedBit(pageCodecMarker),
+      "Encrypted serialized pages are not supported");
 
   auto children = &(*result)->children();
   auto childTypes = type->as<TypeKind::ROW>().children();
+
+  if (isCompressedBitSet(pageCodecMarker)) {
+    auto kind = compressionKind(options);
+    VELOX_CHECK(
+        kind != common::CompressionKind::kNone,
+        "Received a compressed serialized page without a compression codec");
+    std::string compressed(sizeInBytes, '\0');
+    source->readBytes(compressed.data(), sizeInBytes);
+    std::string uncompressed(uncompressedSize, '\0');
+    auto size = common::decompress(
+        kind,
+        compressed.data(),
+        sizeInBytes,
+        uncompressed.data(),
+        uncompressedSize);
+    VELOX_CHECK_EQ(size, static_cast<uint64_t>(uncompressedSize));
+
+    ByteStream page;
+    page.resetInput({ByteRange{
+        reinterpret_cast<uint8_t*>(uncompressed.data()),
+        uncompressedSize,
+        0}});
+    // skip number of columns
+    page.skip(4);
+    readColumns(&page, pool, childTypes, children);
+    return;
+  }
+
+  // skip number of columns
+  source->skip(4);
   readColumns(source, pool, childTypes, children);
 }
 
@@ -27,13 +27,18 @@ class PrestoVectorSerde : public VectorSerde {
   std::unique_ptr<VectorSerializer> createSerializer(
       std::shared_ptr<const RowType> type,
       int32_t numRows,
-      StreamArena* streamArena) override;
+      StreamArena* streamArena,
+      const Options* options = nullptr) override;
 
+  // Deserializes a page produced by a serializer with the same
+  // compressionKind in 'options'. Pages that did not compress well are not
+  // compressed and need no codec.
   void deserialize(
       ByteStream* source,
       velox::memory::MemoryPool* pool,
       std::shared_ptr<const RowType> type,
-      std::shared_ptr<RowVector>* result) override;
+      std::shared_ptr<RowVector>* result,
+      const Options* options = nullptr) override;
 
   static void registerVectorSerde();
 };
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "velox/serializers/PrestoSerializer.h"
+#include <folly/Random.h>
 #include <gtest/gtest.h>
 #include "velox/functions/prestosql/types/TimestampWithTimeZoneType.h"
 #include "velox/vector/BaseVector.h"
@@ -42,7 +43,10 @@ class PrestoSerializerTest : public ::testing::Test {
     serde_->estimateSerializedSize(rowVector, ranges, rawRowSizes.data());
   }
 
-  void serialize(RowVectorPtr rowVector, std::ostream* output) {
+  void serialize(
+      RowVectorPtr rowVector,
+      std::ostream* output,
+      const VectorSerde::Options* options = nullptr) {
     auto numRows = rowVector->size();
 
     std::vector<IndexRange> rows(numRows);
@@ -56,7 +60,8 @@ class PrestoSerializerTest : public ::testing::Test {
     auto arena =
         std::make_unique<StreamArena>(memory::MappedMemory::getInstance());
     auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
-    auto serializer = serde_->createSerializer(rowType, numRows, arena.get());
+    auto serializer =
+        serde_->createSerializer(rowType, numRows, arena.get(), options);
 
     serializer->append(rowVector, folly::Range(rows.data(), numRows));
     serializer->flush(output);
@@ -74,11 +79,13 @@ class PrestoSerializerTest : public ::testing::Test {
 
   RowVectorPtr deserialize(
       std::shared_ptr<const RowType> rowType,
-      const std::string& input) {
+      const std::string& input,
+      const VectorSerde::Options* options = nullptr) {
     auto byteStream = toByteStream(input);
 
     RowVectorPtr result;
-    serde_->deserialize(byteStream.get(), pool_.get(), rowType, &result);
+    serde_->deserialize(
+        byteStream.get(), pool_.get(), rowType, &result, options);
     return result;
   }
 
@@ -253,3 +260,152 @@ TEST_F(PrestoSerializerTest, multiPage) {
   assertEqualVectors(deserialized, c);
   ASSERT_TRUE(byteStream->atEnd());
 }
+
+TEST_F(PrestoSerializerTest, flushToRanges) {
+  auto rowVector = makeTestVector(1'000);
+  for (auto i = 0; i < rowVector->size(); i += 3) {
+    rowVector->childAt(0)->setNull(i, true);
+  }
+  auto numRows = rowVector->size();
+  std::vector<IndexRange> rows(numRows);
+  for (int i = 0; i < numRows; i++) {
+    rows[i] = IndexRange{i, 1};
+  }
+
+  auto arena =
+      std::make_unique<StreamArena>(memory::MappedMemory::getInstance());
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+  auto serializer = serde_->createSerializer(rowType, numRows, arena.get());
+  serializer->append(rowVector, folly::Range(rows.data(), numRows));
+
+  // The ranges refer to the serializer's streams and are the same bytes as
+  // the copying flush.
+  ByteRangeWriter writer;
+  serializer->flush(&writer);
+  std::ostringstream out;
+  serializer->flush(&out);
+
+  std::string bytes;
+  for (auto& range : writer.ranges()) {
+    bytes.append(reinterpret_cast<char*>(range.buffer), range.size);
+  }
+  ASSERT_EQ(bytes.size(), writer.size());
+  ASSERT_EQ(bytes, out.str());
+
+  ByteStream input;
+  input.resetInput(writer.takeRanges());
+  RowVectorPtr deserialized;
+  serde_->deserialize(&input, pool_.get(), rowType, &deserialized);
+  ASSERT_TRUE(input.atEnd());
+  assertEqualVectors(deserialized, rowVector);
+}
+
+TEST_F(PrestoSerializerTest, compression) {
+  // The codec marker follows the row count.
+  auto isCompressed = [](const std::string& page) { return page[4] & 1; };
+
+  auto rowVector = vectorMaker_->rowVector({
+      vectorMaker_->flatVector<int64_t>(
+          10'000, [](auto row) { return row % 7; }),
+      vectorMaker_->flatVector<double>(
+          10'000, [](auto row) { return row % 11 * 0.5; }),
+  });
+  auto rowType = std::dynamic_pointer_cast<const RowType>(rowVector->type());
+  std::ostringstream uncompressed;
+  serialize(rowVector, &uncompressed);
+
+  // Random values do not compress enough and are sent uncompressed.
+  folly::Random::DefaultGenerator rng(1);
+  auto random = vectorMaker_->rowVector({vectorMaker_->flatVector<int64_t>(
+      10'000, [&](auto /*row*/) { return folly::Random::rand64(rng); })});
+  auto randomType = std::dynamic_pointer_cast<const RowType>(random->type());
+
+  for (auto kind :
+       {common::CompressionKind::kLz4, common::CompressionKind::kZstd}) {
+    SCOPED_TRACE(common::compressionKindToString(kind));
+    VectorSerde::Options options;
+    options.compressionKind = kind;
+
+    std::ostringstream out;
+    serialize(rowVector, &out, &options);
+    auto page = out.str();
+    ASSERT_TRUE(isCompressed(page));
+    ASSERT_LT(page.size(), uncompressed.str().size());
+    assertEqualVectors(deserialize(rowType, page, &options), rowVector);
+
+    // A compressed page needs the codec to read.
+    EXPECT_THROW(deserialize(rowType, page), VeloxException);
+
+    std::ostringstream randomOut;
+    serialize(random, &randomOut, &options);
+    page = randomOut.str();
+    ASSERT_FALSE(isCompressed(page));
+    assertEqualVectors(deserialize(randomType, page, &options), random);
+    assertEqualVectors(deserialize(randomType, page), random);
+  }
+}
+
+TEST_F(PrestoSerializerTest, encodings) {
+  vector_size_t size = 1'000;
+  auto makeDictionary = [&](int64_t multiplier) {
+    auto base = vectorMaker_->flatVector<int64_t>(
+        10, [&](auto row) { return row * multiplier; });
+    BufferPtr indices =
+        AlignedBuffer::allocate<vector_size_t>(size, pool_.get());
+    auto rawIndices = indices->asMutable<vector_size_t>();
+    for (auto i = 0; i < size; i++) {
+      rawIndices[i] = i % 10;
+    }
+    return BaseVector::wrapInDictionary(
+        BufferPtr(nullptr), indices, size, base);
+  };
+  auto makeConstant = [&](int64_t value) {
+    return BaseVector::createConstant(variant(value), size, pool_.get());
+  };
+
+  // A page with one vector keeps the encodings.
+  auto first = vectorMaker_->rowVector({
+      makeConstant(11),
+      makeDictionary(3),
+      BaseVector::createConstant(variant(TypeKind::BIGINT), size, pool_.get()),
+  });
+  auto rowType = std::dynamic_pointer_cast<const RowType>(first->type());
+  std::ostringstream out;
+  serialize(first, &out);
+  auto deserialized = deserialize(rowType, out.str());
+  assertEqualVectors(deserialized, first);
+  EXPECT_TRUE(deserialized->childAt(0)->isConstantEncoding());
+  EXPECT_EQ(
+      deserialized->childAt(1)->encoding(),
+      VectorEncoding::Simple::DICTIONARY);
+  EXPECT_TRUE(deserialized->childAt(2)->isConstantEncoding());
+  EXPECT_TRUE(deserialized->childAt(2)->isNullAt(0));
+
+  // Vectors with different constants or dictionaries make a flat page. The
+  // same constant stays encoded.
+  auto second = vectorMaker_->rowVector({
+      makeConstant(12),
+      makeDictionary(5),
+      BaseVector::createConstant(variant(TypeKind::BIGINT), size, pool_.get()),
+  });
+  auto arena =
+      std::make_unique<StreamArena>(memory::MappedMemory::getInstance());
+  auto serializer = serde_->createSerializer(rowType, 2 * size, arena.get());
+  IndexRange all{0, size};
+  serializer->append(first, folly::Range(&all, 1));
+  serializer->append(second, folly::Range(&all, 1));
+  std::ostringstream pageOut;
+  serializer->flush(&pageOut);
+
+  deserialized = deserialize(rowType, pageOut.str());
+  ASSERT_EQ(deserialized->size(), 2 * size);
+  EXPECT_EQ(
+      deserialized->childAt(0)->encoding(), VectorEncoding::Simple::FLAT);
+  EXPECT_EQ(
+      deserialized->childAt(1)->encoding(), VectorEncoding::Simple::FLAT);
+  EXPECT_TRUE(deserialized->childAt(2)->isConstantEncoding());
+  for (auto i = 0; i < size; ++i) {
+    ASSERT_TRUE(deserialized->equalValueAt(first.get(), i, i));
+    ASSERT_TRUE(deserialized->equalValueAt(second.get(), size + i, i));
+  }
+}
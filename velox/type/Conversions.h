@@ -17,15 +17,32 @@
 #pragma once
 
 #include <folly/Conv.h>
+#include <folly/Likely.h>
 #include <cctype>
 #include <string>
 #include <type_traits>
 #include "velox/common/base/Exceptions.h"
+#include "velox/type/StringToNumber.h"
 #include "velox/type/TimestampConversion.h"
 #include "velox/type/Type.h"
 
 namespace facebook::velox::util {
 
+namespace detail {
+// Converts 'v' to T with folly::tryTo(), which returns failures instead of
+// throwing them. Sets 'nullOutput' and returns T() on failure, so that a bad
+// input to a cast under TRY costs no exception unwinding.
+template <typename T, typename From>
+T tryTo(const From& v, bool& nullOutput) {
+  auto result = folly::tryTo<T>(v);
+  if (UNLIKELY(result.hasError())) {
+    nullOutput = true;
+    return T();
+  }
+  return result.value();
+}
+} // namespace detail
+
 template <TypeKind KIND, typename = void, bool TRUNCATE = false>
 struct Converter {
   template <typename T>
@@ -48,15 +65,15 @@ struct Converter<TypeKind::BOOLEAN> {
   }
 
   static T cast(const folly::StringPiece& v, bool& nullOutput) {
-    return folly::to<T>(v);
+    return detail::tryTo<T>(v, nullOutput);
   }
 
   static T cast(const StringView& v, bool& nullOutput) {
-    return folly::to<T>(folly::StringPiece(v));
+    return detail::tryTo<T>(folly::StringPiece(v), nullOutput);
   }
 
   static T cast(const std::string& v, bool& nullOutput) {
-    return folly::to<T>(v);
+    return detail::tryTo<T>(v, nullOutput);
   }
 };
 
@@ -79,7 +96,7 @@ struct Converter<
   static T convertStringToInt(const folly::StringPiece& v, bool& nullOutput) {
     // Handling boolean target case fist because it is in this scope
     if constexpr (std::is_same_v<T, bool>) {
-      return folly::to<T>(v);
+      return detail::tryTo<T>(v, nullOutput);
     } else {
       // Handling integer target cases
       nullOutput = true;
@@ -127,39 +144,41 @@ struct Converter<
     }
   }
 
-  static T cast(const folly::StringPiece& v, bool& nullOutput) {
-    try {
-      if constexpr (TRUNCATE) {
-        return convertStringToInt(v, nullOutput);
-      } else {
-        return folly::to<T>(v);
+  // Accepts the same text as folly::to<T>() without its per value overhead.
+  static T parseInt(const folly::StringPiece& v, bool& nullOutput) {
+    if constexpr (std::is_same_v<T, bool>) {
+      return detail::tryTo<T>(v, nullOutput);
+    } else {
+      T result;
+      if (UNLIKELY(!tryParseInteger(v.begin(), v.end(), result))) {
+        nullOutput = true;
+        return T();
       }
-    } catch (const std::exception& e) {
-      throw std::invalid_argument(e.what());
+      return result;
+    }
+  }
+
+  static T cast(const folly::StringPiece& v, bool& nullOutput) {
+    if constexpr (TRUNCATE) {
+      return convertStringToInt(v, nullOutput);
+    } else {
+      return parseInt(v, nullOutput);
     }
   }
 
   static T cast(const StringView& v, bool& nullOutput) {
-    try {
-      if constexpr (TRUNCATE) {
-        return convertStringToInt(folly::StringPiece(v), nullOutput);
-      } else {
-        return folly::to<T>(folly::StringPiece(v));
-      }
-    } catch (const std::exception& e) {
-      throw std::invalid_argument(e.what());
+    if constexpr (TRUNCATE) {
+      return convertStringToInt(folly::StringPiece(v), nullOutput);
+    } else {
+      return parseInt(folly::StringPiece(v), nullOutput);
     }
   }
 
   static T cast(const std::string& v, bool& nullOutput) {
-    try {
-      if constexpr (TRUNCATE) {
-        return convertStringToInt(v, nullOutput);
-      } else {
-        return folly::to<T>(v);
-      }
-    } catch (const std::exception& e) {
-      throw std::invalid_argument(e.what());
+    if constexpr (TRUNCATE) {
+      return convertStringToInt(v, nullOutput);
+    } else {
+      return parseInt(v, nullOutput);
     }
   }
 
@@ -217,9 +236,11 @@ struct Converter<
       return LimitType::cast(v);
     } else {
       if (std::isnan(v)) {
-        throw std::invalid_argument("Cannot cast NaN to an integral value.");
+        // NaN has no integral value.
+        nullOutput = true;
+        return 0;
       }
-      return folly::to<T>(std::round(v));
+      return detail::tryTo<T>(std::round(v), nullOutput);
     }
   }
 
@@ -237,9 +258,11 @@ struct Converter<
       return LimitType::cast(v);
     } else {
       if (std::isnan(v)) {
-        throw std::invalid_argument("Cannot cast NaN to an integral value.");
+        // NaN has no integral value.
+        nullOutput = true;
+        return 0;
       }
-      return folly::to<T>(std::round(v));
+      return detail::tryTo<T>(std::round(v), nullOutput);
     }
   }
 
@@ -247,7 +270,7 @@ struct Converter<
     if constexpr (TRUNCATE) {
       return T(v);
     } else {
-      return folly::to<T>(v);
+      return detail::tryTo<T>(v, nullOutput);
     }
   }
 
@@ -255,7 +278,7 @@ struct Converter<
     if constexpr (TRUNCATE) {
       return T(v);
     } else {
-      return folly::to<T>(v);
+      return detail::tryTo<T>(v, nullOutput);
     }
   }
 
@@ -263,7 +286,7 @@ struct Converter<
     if constexpr (TRUNCATE) {
       return T(v);
     } else {
-      return folly::to<T>(v);
+      return detail::tryTo<T>(v, nullOutput);
     }
   }
 
@@ -271,7 +294,7 @@ struct Converter<
     if constexpr (TRUNCATE) {
       return T(v);
     } else {
-      return folly::to<T>(v);
+      return detail::tryTo<T>(v, nullOutput);
     }
   }
 };
@@ -285,23 +308,25 @@ struct Converter<
 
   template <typename From>
   static T cast(const From& v, bool& nullOutput) {
-    try {
-      return folly::to<T>(v);
-    } catch (const std::exception& e) {
-      throw std::invalid_argument(e.what());
-    }
+    return detail::tryTo<T>(v, nullOutput);
   }
 
+  // Parses the common short decimals directly and leaves the rest, e.g.
+  // 'NaN', 'Infinity' and long mantissas, to folly.
   static T cast(const folly::StringPiece& v, bool& nullOutput) {
+    double result;
+    if (LIKELY(tryParseSimpleDouble(v.begin(), v.end(), result))) {
+      return static_cast<T>(result);
+    }
     return cast<folly::StringPiece>(v, nullOutput);
   }
 
   static T cast(const StringView& v, bool& nullOutput) {
-    return cast<folly::StringPiece>(folly::StringPiece(v), nullOutput);
+    return cast(folly::StringPiece(v), nullOutput);
   }
 
   static T cast(const std::string& v, bool& nullOutput) {
-    return cast<std::string>(v, nullOutput);
+    return cast(folly::StringPiece(v), nullOutput);
   }
 
   static T cast(const bool& v, bool& nullOutput) {
@@ -62,6 +62,9 @@ std::string Filter::toString() const {
     case FilterKind::kMultiRange:
       strKind = "MultiRange";
       break;
+    case FilterKind::kBigintValuesUsingBloomFilter:
+      strKind = "BigintValuesUsingBloomFilter";
+      break;
   };
 
   return fmt::format(
@@ -71,6 +74,24 @@ std::string Filter::toString() const {
       nullAllowed_ ? "null allowed" : "null not allowed");
 }
 
+void Filter::testInt64Values(
+    const int64_t* values,
+    int32_t numValues,
+    uint64_t* passed) {
+  using V64 = simd::Vectors<int64_t>;
+  int32_t i = 0;
+  for (; i + V64::VSize <= numValues; i += V64::VSize) {
+    auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+    uint64_t mask = V64::compareBitMask(V64::compareResult(test4x64(x)));
+    // 'i' is a multiple of 4, so the 4 result bits are within one word.
+    auto shift = i & 63;
+    passed[i / 64] = (passed[i / 64] & ~(0xfULL << shift)) | (mask << shift);
+  }
+  for (; i < numValues; ++i) {
+    bits::setBit(passed, i, testInt64(values[i]));
+  }
+}
+
 BigintValuesUsingBitmask::BigintValuesUsingBitmask(
     int64_t min,
     int64_t max,
@@ -96,6 +117,20 @@ bool BigintValuesUsingBitmask::testInt64(int64_t value) const {
   return bitmask_[value - min_];
 }
 
+void BigintValuesUsingBitmask::testInt64Values(
+    const int64_t* values,
+    int32_t numValues,
+    uint64_t* passed) {
+  // A single unsigned comparison covers both bounds, leaving one bitmask
+  // lookup per value and no virtual calls.
+  const uint64_t range = bitmask_.size() - 1;
+  for (auto i = 0; i < numValues; ++i) {
+    uint64_t offset =
+        static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(min_);
+    bits::setBit(passed, i, offset <= range && bitmask_[offset]);
+  }
+}
+
 bool BigintValuesUsingBitmask::testInt64Range(
     int64_t min,
     int64_t max,
@@ -250,6 +285,45 @@ __m256si BigintValuesUsingHashTable::test8x32(__m256i x) {
   return V32::mask(first | (second << 4));
 }
 
+__m256i BigintValuesUsingBloomFilter::test4x64(__m256i x) {
+  using V64 = simd::Vectors<int64_t>;
+  auto rangeMask = V64::compareGt(V64::setAll(min_), x) |
+      V64::compareGt(x, V64::setAll(max_));
+  if (V64::compareResult(rangeMask) == V64::kAllTrue) {
+    return V64::setAll(0);
+  }
+  // Same as hashValue().
+  __m256i hashes = x * M;
+  hashes ^= _mm256_srli_epi64(hashes, 32);
+  return bloomFilter_->mayContain4x64(hashes, rangeMask ^ -1);
+}
+
+__m256si BigintValuesUsingBloomFilter::test8x32(__m256i x) {
+  using V32 = simd::Vectors<int32_t>;
+  using V64 = simd::Vectors<int64_t>;
+  auto x8x32 = reinterpret_cast<V32::TV>(x);
+  auto first =
+      V64::compareBitMask(V64::compareResult(test4x64(V32::as4x64<0>(x8x32))));
+  auto second =
+      V64::compareBitMask(V64::compareResult(test4x64(V32::as4x64<1>(x8x32))));
+  return V32::mask(first | (second << 4));
+}
+
+bool BigintValuesUsingBloomFilter::testInt64Range(
+    int64_t min,
+    int64_t max,
+    bool hasNull) const {
+  if (hasNull && nullAllowed_) {
+    return true;
+  }
+
+  if (min == max) {
+    return testInt64(min);
+  }
+
+  return !(min > max_ || max < min_);
+}
+
 bool BigintValuesUsingHashTable::testInt64Range(
     int64_t min,
     int64_t max,
@@ -737,6 +811,7 @@ std::unique_ptr<Filter> BigintRange::mergeWith(const Filter* other) const {
     }
     case FilterKind::kBigintValuesUsingBitmask:
     case FilterKind::kBigintValuesUsingHashTable:
+    case FilterKind::kBigintValuesUsingBloomFilter:
       return other->mergeWith(this);
     case FilterKind::kBigintMultiRange: {
       auto otherMultiRange = dynamic_cast<const BigintMultiRange*>(other);
@@ -781,6 +856,14 @@ std::unique_ptr<Filter> BigintValuesUsingHashTable::mergeWith(
 
       return mergeWith(min, max, other);
     }
+    case FilterKind::kBigintValuesUsingBloomFilter: {
+      auto otherValues =
+          dynamic_cast<const BigintValuesUsingBloomFilter*>(other);
+      auto min = std::max(min_, otherValues->min());
+      auto max = std::min(max_, otherValues->max());
+
+      return mergeWith(min, max, other);
+    }
     case FilterKind::kBigintValuesUsingBitmask:
       return other->mergeWith(this);
     case FilterKind::kBigintMultiRange: {
@@ -877,6 +960,15 @@ std::unique_ptr<Filter> BigintValuesUsingBitmask::mergeWith(
 
       return mergeWith(min, max, other);
     }
+    case FilterKind::kBigintValuesUsingBloomFilter: {
+      auto otherValues =
+          dynamic_cast<const BigintValuesUsingBloomFilter*>(other);
+
+      auto min = std::max(min_, otherValues->min());
+      auto max = std::min(max_, otherValues->max());
+
+      return mergeWith(min, max, other);
+    }
     case FilterKind::kBigintMultiRange: {
       auto otherMultiRange = dynamic_cast<const BigintMultiRange*>(other);
 
@@ -914,6 +1006,43 @@ std::unique_ptr<Filter> BigintValuesUsingBitmask::mergeWith(
   return createBigintValues(valuesToKeep, bothNullAllowed);
 }
 
+std::unique_ptr<Filter> BigintValuesUsingBloomFilter::mergeWith(
+    const Filter* other) const {
+  switch (other->kind()) {
+    case FilterKind::kAlwaysTrue:
+    case FilterKind::kAlwaysFalse:
+    case FilterKind::kIsNull:
+      return other->mergeWith(this);
+    case FilterKind::kIsNotNull:
+      return std::make_unique<BigintValuesUsingBloomFilter>(*this, false);
+    case FilterKind::kBigintRange: {
+      auto otherRange = dynamic_cast<const BigintRange*>(other);
+
+      auto min = std::max(min_, otherRange->lower());
+      auto max = std::min(max_, otherRange->upper());
+
+      bool bothNullAllowed = nullAllowed_ && other->testNull();
+      if (min > max) {
+        return nullOrFalse(bothNullAllowed);
+      }
+      return std::make_unique<BigintValuesUsingBloomFilter>(
+          min, max, bloomFilter_, bothNullAllowed);
+    }
+    case FilterKind::kBigintValuesUsingHashTable:
+    case FilterKind::kBigintValuesUsingBitmask:
+      return other->mergeWith(this);
+    case FilterKind::kBigintMultiRange:
+    case FilterKind::kBigintValuesUsingBloomFilter: {
+      // The intersection is not representable. Keeps 'other', which passes
+      // a superset of the intersection.
+      bool bothNullAllowed = nullAllowed_ && other->testNull();
+      return other->clone(bothNullAllowed);
+    }
+    default:
+      VELOX_UNREACHABLE();
+  }
+}
+
 std::unique_ptr<Filter> BigintMultiRange::mergeWith(const Filter* other) const {
   switch (other->kind()) {
     case FilterKind::kAlwaysTrue:
@@ -930,7 +1059,8 @@ std::unique_ptr<Filter> BigintMultiRange::mergeWith(const Filter* other) const {
     }
     case FilterKind::kBigintRange:
     case FilterKind::kBigintValuesUsingBitmask:
-    case FilterKind::kBigintValuesUsingHashTable: {
+    case FilterKind::kBigintValuesUsingHashTable:
+    case FilterKind::kBigintValuesUsingBloomFilter: {
       return other->mergeWith(this);
     }
     case FilterKind::kBigintMultiRange: {
@@ -24,9 +24,11 @@
 #include <folly/Range.h>
 #include <folly/container/F14Set.h>
 
+#include "velox/common/base/BloomFilter.h"
 #include "velox/common/base/Exceptions.h"
 #include "velox/common/base/SimdUtil.h"
 #include "velox/type/StringView.h"
+#include "velox/type/Timestamp.h"
 
 namespace facebook ::velox::common {
 
@@ -45,6 +47,7 @@ enum class FilterKind {
   kBytesValues,
   kBigintMultiRange,
   kMultiRange,
+  kBigintValuesUsingBloomFilter,
 };
 
 /**
@@ -152,6 +155,13 @@ class Filter {
     return *reinterpret_cast<__m256hi_u*>(&result);
   }
 
+  // Tests 'numValues' consecutive values starting at 'values' and sets the
+  // corresponding bits of 'passed' to the result. Bits past 'numValues' are
+  // not modified. Evaluates 4 values at a time with test4x64(), so filters
+  // with a SIMD implementation of test4x64() are batched automatically.
+  virtual void
+  testInt64Values(const int64_t* values, int32_t numValues, uint64_t* passed);
+
   virtual bool testDouble(double /* unused */) const {
     VELOX_UNSUPPORTED("{}: testDouble() is not supported.", toString());
   }
@@ -683,6 +693,10 @@ class BigintValuesUsingHashTable final : public Filter {
     return max_;
   }
 
+  const std::vector<int64_t>& values() const {
+    return values_;
+  }
+
   std::string toString() const final {
     return fmt::format(
         "BigintValuesUsingHashTable: [{}, {}] {}",
@@ -742,10 +756,26 @@ class BigintValuesUsingBitmask final : public Filter {
 
   bool testInt64(int64_t value) const final;
 
+  void testInt64Values(
+      const int64_t* values,
+      int32_t numValues,
+      uint64_t* passed) final;
+
   bool testInt64Range(int64_t min, int64_t max, bool hasNull) const final;
 
   std::unique_ptr<Filter> mergeWith(const Filter* other) const final;
 
+  // Returns the passing values in ascending order.
+  std::vector<int64_t> values() const {
+    std::vector<int64_t> result;
+    for (auto i = 0; i < bitmask_.size(); ++i) {
+      if (bitmask_[i]) {
+        result.push_back(min_ + i);
+      }
+    }
+    return result;
+  }
+
  private:
   std::unique_ptr<Filter>
   mergeWith(int64_t min, int64_t max, const Filter* other) const;
@@ -755,6 +785,143 @@ class BigintValuesUsingBitmask final : public Filter {
   const int64_t max_;
 };
 
+/// IN-list filter for integer values that is too large to keep as a hash
+/// table or bitmask, e.g. the join keys of a large hash join build side.
+/// Tests a range and then a BloomFilter, so that values outside of the list
+/// may pass. Such a filter is only usable where passing extra values is
+/// harmless, e.g. when pushed down from a join that still checks every row.
+/// mergeWith() may drop the BloomFilter where the intersection cannot be
+/// represented.
+class BigintValuesUsingBloomFilter final : public Filter {
+ public:
+  /// @param min Minimum value.
+  /// @param max Maximum value.
+  /// @param bloomFilter Has the hashes of all the passing values, see
+  /// hashValue().
+  /// @param nullAllowed Null values are passing the filter if true.
+  BigintValuesUsingBloomFilter(
+      int64_t min,
+      int64_t max,
+      std::shared_ptr<const BloomFilter<false>> bloomFilter,
+      bool nullAllowed)
+      : Filter(true, nullAllowed, FilterKind::kBigintValuesUsingBloomFilter),
+        min_(min),
+        max_(max),
+        bloomFilter_(std::move(bloomFilter)) {}
+
+  BigintValuesUsingBloomFilter(
+      const BigintValuesUsingBloomFilter& other,
+      bool nullAllowed)
+      : Filter(true, nullAllowed, FilterKind::kBigintValuesUsingBloomFilter),
+        min_(other.min_),
+        max_(other.max_),
+        bloomFilter_(other.bloomFilter_) {}
+
+  std::unique_ptr<Filter> clone(
+      std::optional<bool> nullAllowed = std::nullopt) const final {
+    if (nullAllowed) {
+      return std::make_unique<BigintValuesUsingBloomFilter>(
+          *this, nullAllowed.value());
+    } else {
+      return std::make_unique<BigintValuesUsingBloomFilter>(*this);
+    }
+  }
+
+  /// Returns the hash number to insert into the BloomFilter for 'value'.
+  /// test4x64() computes the same with SIMD.
+  static uint64_t hashValue(int64_t value) {
+    uint64_t hash = value * M;
+    return hash ^ (hash >> 32);
+  }
+
+  bool testInt64(int64_t value) const final {
+    if (value < min_ || value > max_) {
+      return false;
+    }
+    return bloomFilter_->mayContain(hashValue(value));
+  }
+
+  __m256i test4x64(__m256i x) final;
+
+  __m256si test8x32(__m256i x) final;
+
+  bool testInt64Range(int64_t min, int64_t max, bool hasNull) const final;
+
+  std::unique_ptr<Filter> mergeWith(const Filter* other) const final;
+
+  int64_t min() const {
+    return min_;
+  }
+
+  int64_t max() const {
+    return max_;
+  }
+
+  const std::shared_ptr<const BloomFilter<false>>& bloomFilter() const {
+    return bloomFilter_;
+  }
+
+  std::string toString() const final {
+    return fmt::format(
+        "BigintValuesUsingBloomFilter: [{}, {}] {}",
+        min_,
+        max_,
+        nullAllowed_ ? "with nulls" : "no nulls");
+  }
+
+ private:
+  // from Murmur hash
+  static constexpr uint64_t M = 0xc6a4a7935bd1e995L;
+
+  const int64_t min_;
+  const int64_t max_;
+  // Shared between the clones, e.g. the copies pushed down into each scan.
+  const std::shared_ptr<const BloomFilter<false>> bloomFilter_;
+};
+
+/// Filter on a tuple of integer columns, e.g. the composite key of a join.
+/// Tests the combined hash of the values of a row against a BloomFilter, so
+/// that tuples that are not in the set may pass. Unlike Filter, this applies
+/// to several columns together and is evaluated on whole rows.
+class BigintTuplesUsingBloomFilter {
+ public:
+  /// @param numColumns Number of values in a tuple.
+  /// @param bloomFilter Has the hashes of the passing tuples, see
+  /// hashTuple().
+  BigintTuplesUsingBloomFilter(
+      int32_t numColumns,
+      std::shared_ptr<const BloomFilter<false>> bloomFilter)
+      : numColumns_(numColumns), bloomFilter_(std::move(bloomFilter)) {}
+
+  /// Returns the hash number to insert into the BloomFilter for the tuple of
+  /// 'numColumns' values at 'values'.
+  static uint64_t hashTuple(const int64_t* values, int32_t numColumns) {
+    auto hash = BigintValuesUsingBloomFilter::hashValue(values[0]);
+    for (auto i = 1; i < numColumns; ++i) {
+      hash = bits::hashMix(
+          hash, BigintValuesUsingBloomFilter::hashValue(values[i]));
+    }
+    return hash;
+  }
+
+  /// Tests the tuple of numColumns() values at 'values'.
+  bool testInt64s(const int64_t* values) const {
+    return bloomFilter_->mayContain(hashTuple(values, numColumns_));
+  }
+
+  int32_t numColumns() const {
+    return numColumns_;
+  }
+
+  std::string toString() const {
+    return fmt::format("BigintTuplesUsingBloomFilter: {} columns", numColumns_);
+  }
+
+ private:
+  const int32_t numColumns_;
+  const std::shared_ptr<const BloomFilter<false>> bloomFilter_;
+};
+
 /// Base class for range filters on floating point and string data types.
 class AbstractRange : public Filter {
  protected:
@@ -771,6 +938,23 @@ class AbstractRange : public Filter {
         upperUnbounded_(upperUnbounded),
         upperExclusive_(upperExclusive) {}
 
+ public:
+  bool isLowerUnbounded() const {
+    return lowerUnbounded_;
+  }
+
+  bool isLowerExclusive() const {
+    return lowerExclusive_;
+  }
+
+  bool isUpperUnbounded() const {
+    return upperUnbounded_;
+  }
+
+  bool isUpperExclusive() const {
+    return upperExclusive_;
+  }
+
  protected:
   const bool lowerUnbounded_;
   const bool lowerExclusive_;
@@ -920,6 +1104,14 @@ class FloatingPointRange final : public AbstractRange {
 
   std::string toString() const final;
 
+  T lower() const {
+    return lower_;
+  }
+
+  T upper() const {
+    return upper_;
+  }
+
  private:
   std::string toString(const std::string& name) const {
     return fmt::format(
@@ -1136,14 +1328,6 @@ class BytesRange final : public AbstractRange {
     return singleValue_;
   }
 
-  bool isUpperUnbounded() const {
-    return upperUnbounded_;
-  }
-
-  bool isLowerUnbounded() const {
-    return lowerUnbounded_;
-  }
-
   const std::string& lower() const {
     return lower_;
   }
@@ -1171,6 +1355,9 @@ class BytesValues final : public Filter {
     for (const auto& value : values) {
       lengths_.insert(value.size());
       values_.insert(value);
+      if (!value.empty()) {
+        bits::setBit(firstChars_, static_cast<uint8_t>(value[0]));
+      }
     }
 
     lower_ = *std::min_element(values_.begin(), values_.end());
@@ -1182,7 +1369,12 @@ class BytesValues final : public Filter {
         lower_(other.lower_),
         upper_(other.upper_),
         values_(other.values_),
-        lengths_(other.lengths_) {}
+        lengths_(other.lengths_) {
+    std::copy(
+        std::begin(other.firstChars_),
+        std::end(other.firstChars_),
+        std::begin(firstChars_));
+  }
 
   std::unique_ptr<Filter> clone(
       std::optional<bool> nullAllowed = std::nullopt) const final {
@@ -1198,8 +1390,16 @@ class BytesValues final : public Filter {
   }
 
   bool testBytes(const char* value, int32_t length) const final {
-    return lengths_.contains(length) &&
-        values_.contains(std::string(value, length));
+    // Most values are rejected by the length or the first character, which
+    // avoids hashing the whole value.
+    if (!lengths_.contains(length)) {
+      return false;
+    }
+    if (length > 0 &&
+        !bits::isBitSet(firstChars_, static_cast<uint8_t>(value[0]))) {
+      return false;
+    }
+    return values_.contains(std::string_view(value, length));
   }
 
   bool testBytesRange(
@@ -1218,6 +1418,8 @@ class BytesValues final : public Filter {
   std::string upper_;
   folly::F14FastSet<std::string> values_;
   folly::F14FastSet<uint32_t> lengths_;
+  // Bitmap of the first characters of the non-empty values.
+  uint64_t firstChars_[4] = {};
 };
 
 /// Represents a combination of two of more range filters on integral types with
@@ -1340,6 +1542,13 @@ static inline bool applyFilter(TFilter& filter, StringView value) {
   return filter.testBytes(value.data(), value.size());
 }
 
+// Timestamps are filtered as milliseconds since epoch, so that integer
+// filters apply to them.
+template <typename TFilter>
+static inline bool applyFilter(TFilter& filter, Timestamp value) {
+  return filter.testInt64(value.toMillis());
+}
+
 // Creates a hash or bitmap based IN filter depending on value distribution.
 std::unique_ptr<Filter> createBigintValues(
     const std::vector<int64_t>& values,
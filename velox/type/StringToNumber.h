@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <folly/Portability.h>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Parsers of decimal numbers that report invalid input in their return value
+// instead of throwing. They accept the same text as folly::tryTo: optional
+// leading and trailing whitespace and an optional sign.
+namespace facebook::velox::util {
+
+namespace detail {
+
+inline bool isSpace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// True if the 8 bytes of 'word' are ASCII digits.
+inline bool isEightDigits(uint64_t word) {
+  return ((word & 0xF0F0F0F0F0F0F0F0) |
+          (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+      0x3333333333333333;
+}
+
+// Returns the value of the 8 ASCII digits of 'word', loaded from memory in
+// little endian order, with 3 multiplications instead of 8.
+inline uint32_t parseEightDigits(uint64_t word) {
+  word -= 0x3030303030303030;
+  word = word * 10 + (word >> 8);
+  word = ((word & 0x000000FF000000FF) * (100 + (1'000'000ULL << 32)) +
+          ((word >> 16) & 0x000000FF000000FF) * (1 + (10'000ULL << 32))) >>
+      32;
+  return word;
+}
+
+// The most digits that always fit in 'uint64_t'.
+constexpr int32_t kMaxUint64Digits = 19;
+
+// Appends the digits from 'begin' to 'value' and returns the first position
+// after them. Leading zeros of a zero 'value' are skipped. Adds the number of
+// other digits to 'numSignificant'. Only the first kMaxUint64Digits
+// significant digits are added to 'value'.
+inline const char* parseDigits(
+    const char* begin,
+    const char* end,
+    uint64_t& value,
+    int32_t& numSignificant) {
+  auto p = begin;
+  if (numSignificant == 0) {
+    while (p < end && *p == '0') {
+      ++p;
+    }
+  }
+  if constexpr (folly::kIsLittleEndian) {
+    while (end - p >= 8 && numSignificant + 8 <= kMaxUint64Digits) {
+      uint64_t word;
+      memcpy(&word, p, sizeof(word));
+      if (!isEightDigits(word)) {
+        break;
+      }
+      value = value * 100'000'000 + parseEightDigits(word);
+      numSignificant += 8;
+      p += 8;
+    }
+  }
+  for (; p < end && isDigit(*p); ++p) {
+    if (numSignificant < kMaxUint64Digits) {
+      value = value * 10 + (*p - '0');
+    }
+    ++numSignificant;
+  }
+  return p;
+}
+
+inline const char* skipSpaces(const char* p, const char* end) {
+  while (p < end && isSpace(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+// Powers of ten that are exact in a double.
+constexpr double kExactPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+} // namespace detail
+
+// Parses [begin, end) as a decimal integer of type T. Returns false if the
+// text is not an integer or the value does not fit in T.
+template <typename T>
+bool tryParseInteger(const char* begin, const char* end, T& result) {
+  static_assert(std::is_integral_v<T> && std::is_signed_v<T>);
+  auto p = detail::skipSpaces(begin, end);
+  if (p == end) {
+    return false;
+  }
+  bool negative = false;
+  if (*p == '-' || *p == '+') {
+    negative = *p == '-';
+    ++p;
+  }
+  uint64_t value = 0;
+  int32_t numSignificant = 0;
+  auto digitsEnd = detail::parseDigits(p, end, value, numSignificant);
+  if (digitsEnd == p || detail::skipSpaces(digitsEnd, end) != end ||
+      numSignificant > detail::kMaxUint64Digits) {
+    return false;
+  }
+  uint64_t limit =
+      static_cast<uint64_t>(std::numeric_limits<T>::max()) + negative;
+  if (value > limit) {
+    return false;
+  }
+  result = negative ? static_cast<T>(0 - value) : static_cast<T>(value);
+  return true;
+}
+
+// Parses [begin, end) as a double if it is a decimal number of at most 19
+// significant digits whose value is exact as a double times or divided by an
+// exact power of ten. Such values, e.g. prices and measurements, are
+// correctly rounded by a single floating point operation. Returns false for
+// any other text, for which the caller falls back to a complete parser.
+inline bool
+tryParseSimpleDouble(const char* begin, const char* end, double& result) {
+  auto p = detail::skipSpaces(begin, end);
+  if (p == end) {
+    return false;
+  }
+  bool negative = false;
+  if (*p == '-' || *p == '+') {
+    negative = *p == '-';
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int32_t numSignificant = 0;
+  auto digitsEnd = detail::parseDigits(p, end, mantissa, numSignificant);
+  if (digitsEnd == p) {
+    return false;
+  }
+  p = digitsEnd;
+  int32_t exponent = 0;
+  if (p < end && *p == '.') {
+    ++p;
+    digitsEnd = detail::parseDigits(p, end, mantissa, numSignificant);
+    if (digitsEnd == p) {
+      return false;
+    }
+    exponent = -static_cast<int32_t>(digitsEnd - p);
+    p = digitsEnd;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negativeExponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negativeExponent = *p == '-';
+      ++p;
+    }
+    // More than 4 digits of exponent are left to the complete parser.
+    auto exponentBegin = p;
+    int32_t value = 0;
+    for (; p < end && detail::isDigit(*p) && p - exponentBegin < 4; ++p) {
+      value = value * 10 + (*p - '0');
+    }
+    if (p == exponentBegin) {
+      return false;
+    }
+    exponent += negativeExponent ? -value : value;
+  }
+  if (detail::skipSpaces(p, end) != end ||
+      numSignificant > detail::kMaxUint64Digits) {
+    return false;
+  }
+  double value = 0;
+  if (mantissa != 0) {
+    if (mantissa > (uint64_t(1) << 53) || exponent < -22 || exponent > 22) {
+      return false;
+    }
+    value = static_cast<double>(mantissa);
+    if (exponent < 0) {
+      value /= detail::kExactPowersOfTen[-exponent];
+    } else {
+      value *= detail::kExactPowersOfTen[exponent];
+    }
+  }
+  result = negative ? -value : value;
+  return true;
+}
+
+} // namespace facebook::velox::util
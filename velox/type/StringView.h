@@ -131,6 +131,23 @@ struct StringView {
                size_ - kPrefixSize) == 0;
   }
 
+  // Returns false if 'this' and 'other' differ in size or prefix. These
+  // are inline also for strings that are not, so that most unequal strings
+  // are told apart without reading their data.
+  bool sizeAndPrefixEquals(const StringView& other) const {
+    return sizeAndPrefixAsInt64() == other.sizeAndPrefixAsInt64();
+  }
+
+  // Returns the result of compare() if it is decided by the prefixes,
+  // which are inline also for strings that are not. Returns 0 if the
+  // prefixes are equal.
+  int32_t comparePrefix(const StringView& other) const {
+    if (prefixAsInt() != other.prefixAsInt()) {
+      return memcmp(prefix_, other.prefix_, kPrefixSize);
+    }
+    return 0;
+  }
+
   bool operator!=(const StringView& other) const {
     return !(*this == other);
   }
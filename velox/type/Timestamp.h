@@ -59,6 +59,33 @@ struct Timestamp {
     return Timestamp(micros / 1'000'000, (micros % 1'000'000) * 1'000);
   }
 
+  // The seconds of the timestamps that fitsInNanos(), about the years 1677
+  // to 2262.
+  static constexpr int64_t kMinNanosSeconds = -9'223'372'036;
+  static constexpr int64_t kMaxNanosSeconds = 9'223'372'035;
+
+  // True if 'this' is exactly the int64_t nanoseconds since the epoch
+  // returned by toNanos(). These compare the same as their toNanos().
+  bool fitsInNanos() const {
+    return seconds_ >= kMinNanosSeconds && seconds_ <= kMaxNanosSeconds &&
+        nanos_ < 1'000'000'000;
+  }
+
+  // Requires fitsInNanos().
+  int64_t toNanos() const {
+    return seconds_ * 1'000'000'000 + static_cast<int64_t>(nanos_);
+  }
+
+  static Timestamp fromNanos(int64_t nanos) {
+    auto seconds = nanos / 1'000'000'000;
+    auto remainder = nanos % 1'000'000'000;
+    if (remainder < 0) {
+      --seconds;
+      remainder += 1'000'000'000;
+    }
+    return Timestamp(seconds, remainder);
+  }
+
   // Converts the unix epoch represented by this object (assumes it's GMT)
   // to the given timezone.
   // For example, ts.toTimezone("Pacific/Apia") converts ts to represent
@@ -344,6 +344,118 @@ TEST(FilterTest, bigintValuesUsingBitmask) {
   EXPECT_FALSE(filter->testInt64Range(1234, 2000, false));
 }
 
+TEST(FilterTest, testInt64Values) {
+  std::vector<int64_t> values;
+  for (auto i = -50; i < 1'000; ++i) {
+    values.push_back(i * 7);
+  }
+  auto test = [&](Filter& filter, int32_t numValues) {
+    // Bits past 'numValues' must be left alone.
+    std::vector<uint64_t> passed(bits::nwords(values.size()), ~0ULL);
+    filter.testInt64Values(values.data(), numValues, passed.data());
+    for (auto i = 0; i < values.size(); ++i) {
+      bool expected = i >= numValues || filter.testInt64(values[i]);
+      ASSERT_EQ(expected, bits::isBitSet(passed.data(), i)) << i;
+    }
+  };
+
+  auto hashTable = createBigintValues({14, 700, 49, 6'993, -7, 1 << 30}, false);
+  ASSERT_TRUE(dynamic_cast<BigintValuesUsingHashTable*>(hashTable.get()));
+  auto bitmask = createBigintValues({-7, 0, 14, 700, 1'393}, false);
+  ASSERT_TRUE(dynamic_cast<BigintValuesUsingBitmask*>(bitmask.get()));
+  BigintRange range(70, 700, false);
+  for (auto numValues : {0, 3, 67, (int32_t)values.size()}) {
+    test(*hashTable, numValues);
+    test(*bitmask, numValues);
+    test(range, numValues);
+  }
+}
+
+TEST(FilterTest, bigintValuesUsingBloomFilter) {
+  std::vector<int64_t> numbers;
+  for (auto i = 0; i < 1000; ++i) {
+    numbers.push_back(i * 1209);
+  }
+  auto bloomFilter = std::make_shared<BloomFilter<false>>();
+  bloomFilter->reset(numbers.size());
+  for (auto n : numbers) {
+    bloomFilter->insert(BigintValuesUsingBloomFilter::hashValue(n));
+  }
+  auto filter = std::make_unique<BigintValuesUsingBloomFilter>(
+      numbers.front(), numbers.back(), bloomFilter, false);
+
+  // No false negatives.
+  for (auto n : numbers) {
+    EXPECT_TRUE(filter->testInt64(n));
+  }
+  EXPECT_FALSE(filter->testNull());
+  EXPECT_FALSE(filter->testInt64(-1));
+  EXPECT_FALSE(filter->testInt64(numbers.back() + 1));
+
+  // Few false positives.
+  int32_t numPassed = 0;
+  for (auto i = 0; i < 10'000; ++i) {
+    if (i % 1209 != 0 && filter->testInt64(i)) {
+      ++numPassed;
+    }
+  }
+  EXPECT_LT(numPassed, 500);
+
+  EXPECT_TRUE(filter->testInt64Range(5, 5000, false));
+  EXPECT_FALSE(filter->testInt64Range(-10, -5, false));
+  EXPECT_FALSE(filter->testInt64Range(numbers.back() + 1, INT64_MAX, false));
+
+  __m256i outOfRange{-100, -20000, 0x10000000, 0x20000000};
+  auto verify = [&](int64_t x) { return filter->testInt64(x); };
+  checkSimd<int64_t>(filter.get(), &outOfRange, verify);
+  applySimdTestToVector(numbers, *filter, verify);
+  std::vector<int32_t> numbers32(numbers.begin(), numbers.end());
+  applySimdTestToVector(numbers32, *filter, verify);
+
+  // Merging with a range narrows the range and keeps the Bloom filter.
+  auto range = std::make_unique<BigintRange>(0, 1209 * 10, true);
+  auto merged = range->mergeWith(filter.get());
+  ASSERT_EQ(merged->kind(), FilterKind::kBigintValuesUsingBloomFilter);
+  EXPECT_TRUE(merged->testInt64(1209 * 10));
+  EXPECT_FALSE(merged->testInt64(1209 * 11));
+  EXPECT_FALSE(merged->testNull());
+
+  // Merging with an IN-list keeps the listed values that pass the Bloom
+  // filter.
+  auto values = createBigintValues({1209, 2418, 2419, 10'000'000}, false);
+  merged = values->mergeWith(filter.get());
+  EXPECT_TRUE(merged->testInt64(1209));
+  EXPECT_TRUE(merged->testInt64(2418));
+  EXPECT_FALSE(merged->testInt64(10'000'000));
+}
+
+TEST(FilterTest, bigintTuplesUsingBloomFilter) {
+  auto bloomFilter = std::make_shared<BloomFilter<false>>();
+  bloomFilter->reset(1000);
+  int64_t tuple[2];
+  for (auto i = 0; i < 1000; ++i) {
+    tuple[0] = i;
+    tuple[1] = i * 3;
+    bloomFilter->insert(BigintTuplesUsingBloomFilter::hashTuple(tuple, 2));
+  }
+  BigintTuplesUsingBloomFilter filter(2, bloomFilter);
+  EXPECT_EQ(2, filter.numColumns());
+
+  // No false negatives and few false positives, also for tuples whose
+  // values each occur in the set.
+  int32_t numPassed = 0;
+  for (auto i = 0; i < 1000; ++i) {
+    tuple[0] = i;
+    tuple[1] = i * 3;
+    EXPECT_TRUE(filter.testInt64s(tuple));
+    tuple[1] = i * 3 + 3;
+    if (filter.testInt64s(tuple)) {
+      ++numPassed;
+    }
+  }
+  EXPECT_LT(numPassed, 50);
+}
+
 TEST(FilterTest, bigintMultiRange) {
   // x between 1 and 10 or x between 100 and 120
   auto filter = bigintOr(between(1, 10), between(100, 120));
@@ -620,6 +732,8 @@ TEST(FilterTest, bytesValues) {
   EXPECT_FALSE(filter->testNull());
   EXPECT_FALSE(filter->testBytes("natura", 5));
   EXPECT_FALSE(filter->testBytes("apple", 5));
+  EXPECT_FALSE(filter->testBytes("Natura", 6));
+  EXPECT_FALSE(filter->testBytes("nature", 6));
 
   EXPECT_TRUE(filter->testLength(4));
   EXPECT_TRUE(filter->testLength(6));
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fmt/format.h>
+#include <folly/Conv.h>
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+#include "velox/type/StringToNumber.h"
+
+namespace facebook::velox::util {
+namespace {
+
+// Expects the same result as folly::tryTo<T>().
+template <typename T>
+void testInteger(const std::string& text) {
+  T value;
+  bool ok = tryParseInteger(text.data(), text.data() + text.size(), value);
+  auto expected = folly::tryTo<T>(folly::StringPiece(text));
+  ASSERT_EQ(expected.hasValue(), ok) << "'" << text << "'";
+  if (ok) {
+    EXPECT_EQ(expected.value(), value) << "'" << text << "'";
+  }
+}
+
+void testAllIntegers(const std::string& text) {
+  testInteger<int8_t>(text);
+  testInteger<int16_t>(text);
+  testInteger<int32_t>(text);
+  testInteger<int64_t>(text);
+}
+
+TEST(StringToNumberTest, integer) {
+  for (const auto& text :
+       {"0",
+        "-0",
+        "+0",
+        "7",
+        "-7",
+        "127",
+        "128",
+        "-128",
+        "-129",
+        "32767",
+        "-32768",
+        "2147483647",
+        "2147483648",
+        "-2147483648",
+        "-2147483649",
+        "9223372036854775807",
+        "9223372036854775808",
+        "-9223372036854775808",
+        "-9223372036854775809",
+        "18446744073709551615",
+        "18446744073709551616",
+        "99999999999999999999",
+        "0000000000000000000000000012",
+        "-00000000000000000000000000009223372036854775808",
+        "12345678",
+        "123456789012345678",
+        " 12",
+        "12 ",
+        "\t12\n",
+        "",
+        " ",
+        "-",
+        "+",
+        "--1",
+        "+-1",
+        "- 1",
+        "1 2",
+        "12a",
+        "a12",
+        "1.5",
+        "1e3",
+        "1234567a",
+        "12345678a",
+        "1234567812345678x"}) {
+    testAllIntegers(text);
+  }
+
+  folly::Random::DefaultGenerator rng(1);
+  for (auto i = 0; i < 10'000; ++i) {
+    auto value = static_cast<int64_t>(folly::Random::rand64(rng)) >>
+        folly::Random::rand32(64, rng);
+    testAllIntegers(std::to_string(value));
+  }
+}
+
+// Expects the fast path to either decline or return the same value as
+// folly::to<double>().
+void testSimpleDouble(const std::string& text, bool expectFastPath) {
+  double value;
+  bool ok =
+      tryParseSimpleDouble(text.data(), text.data() + text.size(), value);
+  EXPECT_EQ(expectFastPath, ok) << "'" << text << "'";
+  if (ok) {
+    auto expected = folly::to<double>(folly::StringPiece(text));
+    EXPECT_EQ(expected, value) << "'" << text << "'";
+    EXPECT_EQ(std::signbit(expected), std::signbit(value)) << "'" << text;
+  }
+}
+
+TEST(StringToNumberTest, simpleDouble) {
+  for (const auto& text :
+       {"0",
+        "-0",
+        "0.0",
+        "-0.0",
+        "1",
+        "1.5",
+        "-1.5",
+        "+2.25",
+        "123.456",
+        "0.1",
+        "0.000001",
+        "3.14159265358979",
+        "9007199254740992",
+        "1e10",
+        "1E-10",
+        "2.5e+3",
+        "0e9999",
+        "  42.0  "}) {
+    testSimpleDouble(text, true);
+  }
+
+  // Left to the complete parser, which may or may not accept them.
+  for (const auto& text :
+       {"",
+        " ",
+        "-",
+        ".5",
+        "1.",
+        "1e",
+        "1e+",
+        "1e23",
+        "1e-23",
+        "1e12345",
+        "9007199254740993",
+        "1234567890123456789",
+        "0.0000000000000000000000000000001",
+        "12345678901234567890",
+        "0.12345678901234567890",
+        "NaN",
+        "-Infinity",
+        "1.5x",
+        "0x10"}) {
+    testSimpleDouble(text, false);
+  }
+
+  folly::Random::DefaultGenerator rng(1);
+  for (auto i = 0; i < 10'000; ++i) {
+    auto cents = folly::Random::rand64(1'000'000'000'000, rng);
+    auto text = fmt::format("{}.{:02}", cents / 100, cents % 100);
+    testSimpleDouble(text, true);
+  }
+}
+
+} // namespace
+} // namespace facebook::velox::util
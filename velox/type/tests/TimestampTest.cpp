@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "velox/type/Timestamp.h"
+
+namespace facebook::velox {
+namespace {
+
+TEST(TimestampTest, nanos) {
+  for (auto nanos :
+       {int64_t{0},
+        int64_t{1},
+        int64_t{-1},
+        int64_t{999'999'999},
+        int64_t{-999'999'999},
+        int64_t{1'000'000'000},
+        int64_t{-1'000'000'000},
+        int64_t{1'600'000'000'123'456'789},
+        int64_t{-1'600'000'000'123'456'789},
+        Timestamp::kMinNanosSeconds * 1'000'000'000,
+        Timestamp::kMaxNanosSeconds * 1'000'000'000 + 999'999'999}) {
+    auto timestamp = Timestamp::fromNanos(nanos);
+    EXPECT_LT(timestamp.getNanos(), 1'000'000'000);
+    EXPECT_TRUE(timestamp.fitsInNanos()) << nanos;
+    EXPECT_EQ(nanos, timestamp.toNanos());
+  }
+  EXPECT_EQ(Timestamp(-1, 999'999'999), Timestamp::fromNanos(-1));
+
+  EXPECT_FALSE(Timestamp(Timestamp::kMinNanosSeconds - 1, 0).fitsInNanos());
+  EXPECT_FALSE(Timestamp(Timestamp::kMaxNanosSeconds + 1, 0).fitsInNanos());
+  EXPECT_FALSE(Timestamp(0, 1'000'000'000).fitsInNanos());
+  EXPECT_FALSE(Timestamp::fromNanos(std::numeric_limits<int64_t>::min())
+                   .fitsInNanos());
+}
+
+TEST(TimestampTest, nanosOrder) {
+  std::vector<Timestamp> timestamps = {
+      Timestamp(-100, 999'999'999),
+      Timestamp(-1, 0),
+      Timestamp(-1, 1),
+      Timestamp(0, 0),
+      Timestamp(0, 999'999'999),
+      Timestamp(1, 0),
+      Timestamp(1'600'000'000, 5)};
+  for (auto i = 0; i < timestamps.size(); ++i) {
+    for (auto j = 0; j < timestamps.size(); ++j) {
+      EXPECT_EQ(
+          timestamps[i] < timestamps[j],
+          timestamps[i].toNanos() < timestamps[j].toNanos());
+    }
+  }
+}
+
+} // namespace
+} // namespace facebook::velox
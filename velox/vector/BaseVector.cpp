@@ -15,6 +15,9 @@
  */
 
 #include "velox/vector/BaseVector.h"
+
+#include <numeric>
+
 #include "velox/type/Variant.h"
 #include "velox/vector/ComplexVector.h"
 #include "velox/vector/DictionaryVector.h"
@@ -67,12 +70,24 @@ void BaseVector::allocateNulls() {
   rawNulls_ = nulls_->as<uint64_t>();
 }
 
+void BaseVector::copyNulls() {
+  VELOX_CHECK(nulls_);
+  auto bytes = byteSize<bool>(length_);
+  auto newNulls = AlignedBuffer::allocate<char>(bytes, pool());
+  memcpy(newNulls->asMutable<uint8_t>(), rawNulls_, bytes);
+  nulls_ = std::move(newNulls);
+  rawNulls_ = nulls_->as<uint64_t>();
+}
+
 template <>
 uint64_t BaseVector::byteSize<bool>(vector_size_t count) {
   return bits::nbytes(count);
 }
 
 void BaseVector::resize(vector_size_t size) {
+  if (nulls_ && !nulls_->isMutable()) {
+    copyNulls();
+  }
   if (nulls_) {
     auto bytes = byteSize<bool>(size);
     if (length_ < size) {
@@ -413,12 +428,33 @@ void BaseVector::resizeIndices(
     const vector_size_t** raw) {
   if (!indices->get()) {
     *indices = AlignedBuffer::allocate<vector_size_t>(size, pool, initialValue);
+  } else if (!(*indices)->isMutable()) {
+    // A view, e.g. on the indices of another vector. Copy on write.
+    auto numOldIndices = (*indices)->size() / sizeof(vector_size_t);
+    auto newIndices = AlignedBuffer::allocate<vector_size_t>(
+        std::max<vector_size_t>(size, numOldIndices), pool, initialValue);
+    memcpy(
+        newIndices->asMutable<vector_size_t>(),
+        (*indices)->as<vector_size_t>(),
+        std::min<vector_size_t>(size, numOldIndices) * sizeof(vector_size_t));
+    *indices = std::move(newIndices);
   } else if ((*indices)->size() < size * sizeof(vector_size_t)) {
     AlignedBuffer::reallocate<vector_size_t>(indices, size, initialValue);
   }
   *raw = indices->get()->asMutable<vector_size_t>();
 }
 
+VectorPtr BaseVector::slice(vector_size_t offset, vector_size_t length)
+    const {
+  VELOX_CHECK_LE(offset + length, length_);
+  auto result = BaseVector::create(type_, length, pool_);
+  SelectivityVector rows(length);
+  std::vector<vector_size_t> sourceRows(length);
+  std::iota(sourceRows.begin(), sourceRows.end(), offset);
+  result->copy(this, rows, sourceRows.data());
+  return result;
+}
+
 std::string BaseVector::toString() const {
   std::stringstream out;
   out << "[" << encoding() << " " << type_->toString() << ": " << length_
@@ -456,7 +492,7 @@ std::string BaseVector::toString(vector_size_t from, vector_size_t to) {
 
 void BaseVector::ensureWritable(const SelectivityVector& rows) {
   auto newSize = std::max<vector_size_t>(rows.size(), length_);
-  if (nulls_ && !nulls_->unique()) {
+  if (nulls_ && (!nulls_->unique() || !nulls_->isMutable())) {
     BufferPtr newNulls = AlignedBuffer::allocate<bool>(newSize, pool_);
     auto rawNewNulls = newNulls->asMutable<uint64_t>();
     memcpy(rawNewNulls, rawNulls_, bits::nbytes(length_));
@@ -634,5 +670,21 @@ bool BaseVector::isReusableFlatVector(const VectorPtr& vector) {
   return false;
 }
 
+// static
+void BaseVector::prepareForReuse(VectorPtr& vector, vector_size_t size) {
+  if (!isReusableFlatVector(vector)) {
+    vector = BaseVector::create(vector->type(), size, vector->pool());
+    return;
+  }
+  // Resizing to 0 drops the string buffers. Growing back to 'size' sets
+  // the new rows to not null and default values.
+  vector->clear();
+  vector->resize(size);
+  vector->nullCount_ = std::nullopt;
+  vector->distinctValueCount_ = std::nullopt;
+  vector->representedByteCount_ = std::nullopt;
+  vector->storageByteCount_ = std::nullopt;
+}
+
 } // namespace velox
 } // namespace facebook
@@ -416,6 +416,12 @@ class BaseVector {
       vector_size_t index,
       std::shared_ptr<BaseVector> vector);
 
+  // Returns a vector with 'length' rows of 'this' starting at row 'offset'.
+  // Flat, complex, dictionary and constant vectors share their buffers
+  // with the result, which holds views on them. A view is not mutable and
+  // is copied on first write. Other vectors are copied.
+  virtual VectorPtr slice(vector_size_t offset, vector_size_t length) const;
+
   // Makes 'result' writable for 'rows'. A wrapper (e.g. dictionary, constant,
   // sequence) is flattened and a multiply referenced flat vector is copied.
   // The content of 'rows' is not copied, as these values are intended to be
@@ -562,6 +568,15 @@ class BaseVector {
   // and nulls and values are uniquely referenced.
   static bool isReusableFlatVector(const std::shared_ptr<BaseVector>& vector);
 
+  // Prepares 'vector' for being filled with 'size' new values. If
+  // 'vector' is a reusable flat vector, its nulls and values buffers
+  // are kept, all rows are set to not null and string buffers are
+  // dropped. Otherwise 'vector' is replaced by a new vector of the same
+  // type.
+  static void prepareForReuse(
+      std::shared_ptr<BaseVector>& vector,
+      vector_size_t size);
+
   // True if left and right are the same or if right is
   // TypeKind::UNKNOWN.  ArrayVector copying may come across unknown
   // type data for null-only content. Nulls can be transferred between
@@ -589,11 +604,23 @@ class BaseVector {
   void ensureNulls() {
     if (!nulls_) {
       allocateNulls();
+    } else if (!nulls_->isMutable()) {
+      copyNulls();
     }
   }
 
   void allocateNulls();
 
+  // Replaces 'nulls_' with a mutable copy, e.g. when 'nulls_' is a view on
+  // the nulls of another vector.
+  void copyNulls();
+
+  // Returns the nulls of 'length' rows starting at 'offset' for slice().
+  BufferPtr sliceNulls(vector_size_t offset, vector_size_t length) const {
+    return nulls_ ? sliceBuffer<bool>(nulls_, offset, length, pool_)
+                  : nullptr;
+  }
+
   void setNulls(BufferPtr nulls) {
     nulls_ = nulls;
     rawNulls_ = nulls ? nulls->as<uint64_t>() : nullptr;
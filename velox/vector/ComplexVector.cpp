@@ -252,6 +252,18 @@ std::string RowVector::toString(vector_size_t index) const {
   return out.str();
 }
 
+VectorPtr RowVector::slice(vector_size_t offset, vector_size_t length) const {
+  VELOX_CHECK_LE(offset + length, length_);
+  std::vector<VectorPtr> children(children_.size());
+  for (auto i = 0; i < children_.size(); ++i) {
+    if (children_[i]) {
+      children[i] = children_[i]->slice(offset, length);
+    }
+  }
+  return std::make_shared<RowVector>(
+      pool_, type_, sliceNulls(offset, length), length, std::move(children));
+}
+
 void RowVector::ensureWritable(const SelectivityVector& rows) {
   for (int i = 0; i < childrenSize_; i++) {
     if (children_[i]) {
@@ -502,9 +514,22 @@ std::string ArrayVector::toString(vector_size_t index) const {
   return out.str();
 }
 
+VectorPtr ArrayVector::slice(vector_size_t offset, vector_size_t length)
+    const {
+  VELOX_CHECK_LE(offset + length, length_);
+  return std::make_shared<ArrayVector>(
+      pool_,
+      type_,
+      sliceNulls(offset, length),
+      length,
+      sliceBuffer<vector_size_t>(offsets_, offset, length, pool_),
+      sliceBuffer<vector_size_t>(sizes_, offset, length, pool_),
+      elements_);
+}
+
 void ArrayVector::ensureWritable(const SelectivityVector& rows) {
   auto newSize = std::max<vector_size_t>(rows.size(), BaseVector::length_);
-  if (offsets_ && !offsets_->unique()) {
+  if (offsets_ && (!offsets_->unique() || !offsets_->isMutable())) {
     BufferPtr newOffsets =
         AlignedBuffer::allocate<vector_size_t>(newSize, BaseVector::pool_);
     auto rawNewOffsets = newOffsets->asMutable<vector_size_t>();
@@ -523,7 +548,7 @@ void ArrayVector::ensureWritable(const SelectivityVector& rows) {
     rawOffsets_ = offsets_->as<vector_size_t>();
   }
 
-  if (sizes_ && !sizes_->unique()) {
+  if (sizes_ && (!sizes_->unique() || !sizes_->isMutable())) {
     BufferPtr newSizes =
         AlignedBuffer::allocate<vector_size_t>(newSize, BaseVector::pool_);
     auto rawNewSizes = newSizes->asMutable<vector_size_t>();
@@ -841,9 +866,22 @@ std::string MapVector::toString(vector_size_t index) const {
   return out.str();
 }
 
+VectorPtr MapVector::slice(vector_size_t offset, vector_size_t length) const {
+  VELOX_CHECK_LE(offset + length, length_);
+  return std::make_shared<MapVector>(
+      pool_,
+      type_,
+      sliceNulls(offset, length),
+      length,
+      sliceBuffer<vector_size_t>(offsets_, offset, length, pool_),
+      sliceBuffer<vector_size_t>(sizes_, offset, length, pool_),
+      keys_,
+      values_);
+}
+
 void MapVector::ensureWritable(const SelectivityVector& rows) {
   auto newSize = std::max<vector_size_t>(rows.size(), BaseVector::length_);
-  if (offsets_ && !offsets_->unique()) {
+  if (offsets_ && (!offsets_->unique() || !offsets_->isMutable())) {
     BufferPtr newOffsets =
         AlignedBuffer::allocate<vector_size_t>(newSize, BaseVector::pool_);
     auto rawNewOffsets = newOffsets->asMutable<vector_size_t>();
@@ -862,7 +900,7 @@ void MapVector::ensureWritable(const SelectivityVector& rows) {
     rawOffsets_ = offsets_->as<vector_size_t>();
   }
 
-  if (sizes_ && !sizes_->unique()) {
+  if (sizes_ && (!sizes_->unique() || !sizes_->isMutable())) {
     BufferPtr newSizes =
         AlignedBuffer::allocate<vector_size_t>(newSize, BaseVector::pool_);
     auto rawNewSizes = newSizes->asMutable<vector_size_t>();
@@ -142,6 +142,8 @@ class RowVector : public BaseVector {
 
   void ensureWritable(const SelectivityVector& rows) override;
 
+  VectorPtr slice(vector_size_t offset, vector_size_t length) const override;
+
  private:
   vector_size_t childSize() const {
     bool allConstant = false;
@@ -350,6 +352,8 @@ class ArrayVector : public BaseVector {
 
   void ensureWritable(const SelectivityVector& rows) override;
 
+  VectorPtr slice(vector_size_t offset, vector_size_t length) const override;
+
  private:
   BufferPtr offsets_;
   const vector_size_t* rawOffsets_;
@@ -526,6 +530,8 @@ class MapVector : public BaseVector {
 
   void ensureWritable(const SelectivityVector& rows) override;
 
+  VectorPtr slice(vector_size_t offset, vector_size_t length) const override;
+
  private:
   // Returns true if the keys for map at 'index' are sorted from first
   // to last in the type's collation order.
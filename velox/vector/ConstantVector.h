@@ -277,6 +277,18 @@ class ConstantVector final : public SimpleVector<T> {
     return valueVector_;
   }
 
+  // A constant of 'length' rows with the same value.
+  VectorPtr slice(vector_size_t offset, vector_size_t length) const override {
+    VELOX_DCHECK(initialized_);
+    VELOX_CHECK_LE(offset + length, BaseVector::length_);
+    if (valueVector_) {
+      return std::make_shared<ConstantVector<T>>(
+          BaseVector::pool_, length, index_, valueVector_);
+    }
+    return std::make_shared<ConstantVector<T>>(
+        BaseVector::pool_, length, isNull_, BaseVector::type_, T(value_));
+  }
+
   // Index of the element of the base vector that determines the value of this
   // constant vector.
   vector_size_t index() const {
@@ -84,6 +84,14 @@ DictionaryVector<T>::DictionaryVector(
   indexType_ = indexType;
   indices_ = dictionaryIndices;
   setInternalState();
+
+  if constexpr (std::is_same_v<T, StringView>) {
+    // Any selection of all-ASCII values is all ASCII.
+    auto base = dictionaryValues_->template as<SimpleVector<StringView>>();
+    if (base && base->isKnownAllAscii()) {
+      SimpleVector<T>::setAllIsAscii(true);
+    }
+  }
 }
 
 template <typename T>
@@ -129,6 +129,32 @@ class DictionaryVector : public SimpleVector<T> {
     return indices_;
   }
 
+  // Slices the indices and shares the base vector.
+  VectorPtr slice(vector_size_t offset, vector_size_t length) const override {
+    VELOX_CHECK_LE(offset + length, BaseVector::length_);
+    BufferPtr indices;
+    switch (indexType_) {
+      case TypeKind::INTEGER:
+        indices = sliceBuffer<vector_size_t>(
+            indices_, offset, length, BaseVector::pool_);
+        break;
+      case TypeKind::SMALLINT:
+        indices =
+            sliceBuffer<uint16_t>(indices_, offset, length, BaseVector::pool_);
+        break;
+      default:
+        indices =
+            sliceBuffer<uint8_t>(indices_, offset, length, BaseVector::pool_);
+    }
+    return std::make_shared<DictionaryVector<T>>(
+        BaseVector::pool_,
+        BaseVector::sliceNulls(offset, length),
+        length,
+        dictionaryValues_,
+        indexType_,
+        std::move(indices));
+  }
+
   BufferPtr mutableIndices(vector_size_t size) {
     if (indices_ && indices_->capacity() >= size * sizeof(vector_size_t)) {
       return indices_;
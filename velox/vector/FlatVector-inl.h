@@ -282,6 +282,9 @@ void FlatVector<T>::copyValuesAndNulls(
 
 template <typename T>
 void FlatVector<T>::resize(vector_size_t size) {
+  if (values_ && !values_->isMutable()) {
+    mutableRawValues();
+  }
   auto previousSize = BaseVector::length_;
   BaseVector::resize(size);
   if (!values_) {
@@ -311,10 +314,32 @@ void FlatVector<T>::resize(vector_size_t size) {
   }
 }
 
+template <typename T>
+VectorPtr FlatVector<T>::slice(vector_size_t offset, vector_size_t length)
+    const {
+  if constexpr (!Buffer::is_pod_like_v<T>) {
+    return BaseVector::slice(offset, length);
+  } else {
+    VELOX_CHECK_LE(offset + length, BaseVector::length_);
+    BufferPtr values;
+    if (values_) {
+      values = sliceBuffer<T>(values_, offset, length, BaseVector::pool_);
+    }
+    // The string buffers are append only and are shared as they are.
+    return std::make_shared<FlatVector<T>>(
+        BaseVector::pool_,
+        BaseVector::type_,
+        BaseVector::sliceNulls(offset, length),
+        length,
+        std::move(values),
+        std::vector<BufferPtr>(stringBuffers_));
+  }
+}
+
 template <typename T>
 void FlatVector<T>::ensureWritable(const SelectivityVector& rows) {
   auto newSize = std::max<vector_size_t>(rows.size(), BaseVector::length_);
-  if (values_ && !values_->unique()) {
+  if (values_ && (!values_->unique() || !values_->isMutable())) {
     BufferPtr newValues =
         AlignedBuffer::allocate<T>(newSize, BaseVector::pool_);
 
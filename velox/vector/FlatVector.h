@@ -194,9 +194,9 @@ class FlatVector final : public SimpleVector<T> {
   // Bool uses compact representation, use mutableRawValues<uint64_t> and
   // bits::setBit instead.
   T* mutableRawValues() {
-    if (!values_ || !values_->unique()) {
+    if (!values_ || !values_->unique() || !values_->isMutable()) {
       BufferPtr newValues =
-          AlignedBuffer::allocate<T>(BaseVector::length_, values_->pool());
+          AlignedBuffer::allocate<T>(BaseVector::length_, BaseVector::pool_);
       if (values_) {
         // This codepath is not yet enabled for OPAQUE types (asMutable will
         // fail below)
@@ -246,6 +246,8 @@ class FlatVector final : public SimpleVector<T> {
 
   void resize(vector_size_t size) override;
 
+  VectorPtr slice(vector_size_t offset, vector_size_t length) const override;
+
   bool isScalar() const override {
     return true;
   }
@@ -21,6 +21,7 @@ namespace facebook::velox {
 
 namespace exec {
 class EvalCtx;
+class Expr;
 } // namespace exec
 
 // Represents a function with possible captures.
@@ -45,6 +46,18 @@ class Callable {
       exec::EvalCtx* context,
       const std::vector<VectorPtr>& args,
       VectorPtr* result) = 0;
+
+  // Returns the expression that computes the function if it is interpreted,
+  // nullptr otherwise. The expression refers to the arguments by the names
+  // in signature(). Lets a caller, e.g. reduce(), recognize a well known
+  // function and compute it without the interpreter.
+  virtual const exec::Expr* body() const {
+    return nullptr;
+  }
+
+  virtual std::shared_ptr<const RowType> signature() const {
+    return nullptr;
+  }
 };
 
 // Represents a vector of functions. In most cases all the positions
@@ -27,4 +27,21 @@ SelectivityVector SelectivityVector::empty(vector_size_t size) {
   return SelectivityVector{size, false};
 }
 
+void SelectivityVector::computeSparseRows() const {
+  sparseRows_.clear();
+  sparseRowsValid_ = true;
+  auto range = end_ - begin_;
+  if (range < kMinSparseRange || isAllSelected()) {
+    return;
+  }
+  auto numSelected = countSelected();
+  if (numSelected * kSparseRatio > range) {
+    return;
+  }
+  sparseRows_.reserve(numSelected);
+  bits::forEachSetBit(bits_.data(), begin_, end_, [&](vector_size_t row) {
+    sparseRows_.push_back(row);
+  });
+}
+
 } // namespace facebook::velox
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <optional>
 #include <ostream>
 #include <vector>
 
@@ -76,6 +77,7 @@ class SelectivityVector {
   void setValid(vector_size_t idx, bool valid) {
     VELOX_DCHECK_LT(idx, bits_.size() * sizeof(bits_[0]) * 8);
     bits::setBit(bits_.data(), idx, valid);
+    sparseRowsValid_ = false;
   }
 
   /**
@@ -86,6 +88,7 @@ class SelectivityVector {
   void setValidRange(vector_size_t begin, vector_size_t end, bool valid) {
     VELOX_DCHECK_LE(end, bits_.size() * sizeof(bits_[0]) * 8);
     bits::fillBits(bits_.data(), begin, end, valid);
+    sparseRowsValid_ = false;
   }
 
   /**
@@ -103,6 +106,7 @@ class SelectivityVector {
    * updateBounds() need to be called explicitly if data is modified.
    */
   MutableRange<bool> asMutableRange() {
+    sparseRowsValid_ = false;
     return MutableRange<bool>(bits_.data(), begin_, end_);
   }
 
@@ -112,6 +116,7 @@ class SelectivityVector {
     begin_ = begin;
     end_ = end;
     allSelected_.reset();
+    sparseRowsValid_ = false;
   }
 
   vector_size_t begin() const {
@@ -137,6 +142,7 @@ class SelectivityVector {
     begin_ = 0;
     end_ = 0;
     allSelected_.reset();
+    sparseRowsValid_ = false;
   }
 
   /**
@@ -147,6 +153,7 @@ class SelectivityVector {
     begin_ = 0;
     end_ = size_;
     allSelected_ = true;
+    sparseRowsValid_ = false;
   }
 
   void setFromBits(const uint64_t* bits, int32_t size) {
@@ -233,6 +240,7 @@ class SelectivityVector {
    * index (noting that the range in between may contain not selected indices).
    */
   void updateBounds() {
+    sparseRowsValid_ = false;
     begin_ = bits::findFirstBit(bits_.data(), 0, size_);
     if (begin_ == -1) {
       begin_ = 0;
@@ -316,6 +324,29 @@ class SelectivityVector {
   // one past the last selected value, if there are any selected
   vector_size_t end_ = 0;
   mutable std::optional<bool> allSelected_;
+  // The selected rows in ascending order if at most 1 in kSparseRatio rows
+  // of a range of at least kMinSparseRange rows is selected, empty if more
+  // are selected. Recomputed on first use after a change to the selection.
+  // Changes only clear 'sparseRowsValid_' so that a function applied to the
+  // rows may change the selection.
+  mutable std::vector<vector_size_t> sparseRows_;
+  mutable bool sparseRowsValid_ = false;
+
+  // Returns the selected rows if the selection is sparse, nullptr
+  // otherwise. Each later expression over a selection left by a very
+  // selective filter then loops over the surviving rows instead of over the
+  // words of 'bits_'.
+  const std::vector<vector_size_t>* sparseRows() const {
+    if (!sparseRowsValid_) {
+      computeSparseRows();
+    }
+    return sparseRows_.empty() ? nullptr : &sparseRows_;
+  }
+
+  void computeSparseRows() const;
+
+  static constexpr vector_size_t kSparseRatio = 32;
+  static constexpr vector_size_t kMinSparseRange = 1024;
 
   friend class SelectivityIterator;
 };
@@ -368,6 +399,10 @@ inline void SelectivityVector::applyToSelected(Callable func) const {
     for (vector_size_t row = begin_; row < end_; ++row) {
       func(row);
     }
+  } else if (auto rows = sparseRows()) {
+    for (auto i = 0; i < rows->size(); ++i) {
+      func((*rows)[i]);
+    }
   } else {
     bits::forEachSetBit(bits_.data(), begin_, end_, func);
   }
@@ -383,6 +418,14 @@ inline bool SelectivityVector::testSelected(Callable func) const {
     }
     return true;
   }
+  if (auto rows = sparseRows()) {
+    for (auto i = 0; i < rows->size(); ++i) {
+      if (!func((*rows)[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
   return bits::testSetBits(bits_.data(), begin_, end_, func);
 }
 } // namespace velox
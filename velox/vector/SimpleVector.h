@@ -285,6 +285,14 @@ class SimpleVector : public BaseVector {
     return std::nullopt;
   }
 
+  /// Returns true if all rows of the vector are known to be ASCII.
+  template <typename U = T>
+  typename std::enable_if<std::is_same<U, StringView>::value, bool>::type
+  isKnownAllAscii() const {
+    return isAllAscii_ && asciiSetRows_.size() >= length_ &&
+        asciiSetRows_.isAllSelected();
+  }
+
   /// Computes and saves is-ascii flag for a given set of rows if not already
   /// present. Returns computed value.
   template <typename U = T>
@@ -294,13 +302,14 @@ class SimpleVector : public BaseVector {
       return isAllAscii_;
     }
     ensureIsAsciiCapacity(rows.end());
-    bool isAllAscii = true;
-    rows.template applyToSelected([&](auto row) {
-      if (!isNullAt(row)) {
-        auto string = valueAt(row);
-        isAllAscii &=
-            functions::stringCore::isAscii(string.data(), string.size());
+    // A single non-ASCII row makes the flag false for all of 'rows', so the
+    // scan stops at the first one.
+    bool isAllAscii = rows.template testSelected([&](auto row) {
+      if (isNullAt(row)) {
+        return true;
       }
+      auto string = valueAt(row);
+      return functions::stringCore::isAscii(string.data(), string.size());
     });
 
     // Set isAllAscii flag, it will unset if we encounter any utf.
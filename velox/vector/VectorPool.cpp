@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "velox/vector/VectorPool.h"
+
+namespace facebook::velox {
+
+VectorPtr VectorPool::get(const TypePtr& type, vector_size_t size) {
+  if (isCachedKind(type->kind())) {
+    auto& cached = vectors_[static_cast<int32_t>(type->kind())];
+    if (!cached.empty()) {
+      auto vector = std::move(cached.back());
+      cached.pop_back();
+      BaseVector::prepareForReuse(vector, size);
+      return vector;
+    }
+  }
+  return BaseVector::create(type, size, pool_);
+}
+
+bool VectorPool::release(VectorPtr& vector) {
+  if (!vector || !isCachedKind(vector->typeKind()) ||
+      !BaseVector::isReusableFlatVector(vector) ||
+      vector->retainedSize() > kMaxRetainedBytes) {
+    return false;
+  }
+  auto& cached = vectors_[static_cast<int32_t>(vector->typeKind())];
+  if (cached.size() >= kNumPerKind) {
+    return false;
+  }
+  // Drops the string buffers right away, they may be large and are not
+  // reused.
+  vector->clear();
+  cached.push_back(std::move(vector));
+  vector = nullptr;
+  return true;
+}
+
+int32_t VectorPool::release(std::vector<VectorPtr>& vectors) {
+  int32_t numReleased = 0;
+  for (auto& vector : vectors) {
+    numReleased += release(vector);
+  }
+  return numReleased;
+}
+
+void VectorPool::clear() {
+  for (auto& cached : vectors_) {
+    cached.clear();
+  }
+}
+
+int32_t VectorPool::size() const {
+  int32_t count = 0;
+  for (auto& cached : vectors_) {
+    count += cached.size();
+  }
+  return count;
+}
+
+} // namespace facebook::velox
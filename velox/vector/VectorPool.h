@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "velox/vector/BaseVector.h"
+
+namespace facebook::velox {
+
+// Caches singly referenced flat vectors of scalar types for reuse
+// between batches. An operator or Driver releases vectors it no longer
+// needs to 'this' and gets vectors for its next batch from 'this'
+// instead of allocating new ones. Not thread safe.
+class VectorPool {
+ public:
+  // Maximum number of vectors cached per TypeKind.
+  static constexpr int32_t kNumPerKind = 10;
+
+  // Vectors retaining more bytes than this are not cached.
+  static constexpr uint64_t kMaxRetainedBytes = 4 << 20; // 4MB
+
+  explicit VectorPool(memory::MemoryPool* FOLLY_NONNULL pool) : pool_(pool) {}
+
+  // Returns a flat vector of 'type' with 'size' rows that are all not
+  // null. Reuses a cached vector of the same TypeKind if there is one.
+  VectorPtr get(const TypePtr& type, vector_size_t size);
+
+  // Takes 'vector' into 'this' if it is a reusable flat vector of a
+  // scalar type and there is space in the cache. Returns true and
+  // clears 'vector' if it was taken.
+  bool release(VectorPtr& vector);
+
+  // Releases each of 'vectors'. Returns the number of vectors taken.
+  int32_t release(std::vector<VectorPtr>& vectors);
+
+  // Frees all cached vectors.
+  void clear();
+
+  // Returns the number of cached vectors.
+  int32_t size() const;
+
+ private:
+  // Scalar TypeKinds have consecutive values from BOOLEAN to DATE.
+  static constexpr int32_t kNumCachedKinds =
+      static_cast<int32_t>(TypeKind::DATE) + 1;
+
+  static bool isCachedKind(TypeKind kind) {
+    auto index = static_cast<int32_t>(kind);
+    return index >= 0 && index < kNumCachedKinds;
+  }
+
+  memory::MemoryPool* const FOLLY_NONNULL pool_;
+
+  std::array<std::vector<VectorPtr>, kNumCachedKinds> vectors_;
+};
+
+} // namespace facebook::velox
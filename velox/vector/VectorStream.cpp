@@ -15,6 +15,7 @@
  */
 #include "velox/vector/VectorStream.h"
 #include <memory>
+#include <sstream>
 
 namespace facebook::velox {
 
@@ -91,11 +92,78 @@ void ByteStream::flush(std::ostream* out) {
   }
 }
 
+void ByteStream::flush(ByteRangeWriter* out) {
+  for (int32_t i = 0; i < ranges_.size(); ++i) {
+    int32_t count = ranges_[i].position;
+    int32_t bytes = isBits_ ? bits::nbytes(count) : count;
+    if (isBits_ && isReverseBitOrder_ && !isReversed_) {
+      bits::reverseBits(ranges_[i].buffer, bytes);
+    }
+    out->append(ByteRange{ranges_[i].buffer, bytes, 0});
+  }
+  if (isBits_ && isReverseBitOrder_) {
+    isReversed_ = true;
+  }
+}
+
+void ByteRangeWriter::write(const char* data, int32_t size) {
+  if (!size) {
+    return;
+  }
+  if (currentChunkUsed_ + size > currentChunkSize_) {
+    currentChunkSize_ = std::max(kChunkSize, size);
+    chunks_.push_back(std::make_unique<uint8_t[]>(currentChunkSize_));
+    currentChunk_ = chunks_.back().get();
+    currentChunkUsed_ = 0;
+  }
+  auto target = currentChunk_ + currentChunkUsed_;
+  memcpy(target, data, size);
+  currentChunkUsed_ += size;
+  size_ += size;
+  if (!ranges_.empty() &&
+      ranges_.back().buffer + ranges_.back().size == target) {
+    ranges_.back().size += size;
+  } else {
+    ranges_.push_back(ByteRange{target, size, 0});
+  }
+}
+
+void ByteRangeWriter::append(ByteRange range) {
+  if (!range.size) {
+    return;
+  }
+  size_ += range.size;
+  ranges_.push_back(ByteRange{range.buffer, range.size, 0});
+}
+
+void ByteRangeWriter::append(ByteRangeWriter&& other) {
+  for (auto& chunk : other.chunks_) {
+    chunks_.push_back(std::move(chunk));
+  }
+  ranges_.insert(ranges_.end(), other.ranges_.begin(), other.ranges_.end());
+  size_ += other.size_;
+  other.chunks_.clear();
+  other.ranges_.clear();
+  other.currentChunk_ = nullptr;
+  other.currentChunkSize_ = 0;
+  other.currentChunkUsed_ = 0;
+  other.size_ = 0;
+}
+
+void VectorSerializer::flush(ByteRangeWriter* out) {
+  std::stringstream stream;
+  flush(&stream);
+  auto data = stream.str();
+  out->write(data.data(), data.size());
+}
+
 void VectorStreamGroup::createStreamTree(
     std::shared_ptr<const RowType> type,
-    int32_t numRows) {
+    int32_t numRows,
+    const VectorSerde::Options* options) {
   VELOX_CHECK(getVectorSerde().get(), "Vector serde is not registered");
-  serializer_ = getVectorSerde()->createSerializer(type, numRows, this);
+  serializer_ =
+      getVectorSerde()->createSerializer(type, numRows, this, options);
 }
 
 void VectorStreamGroup::append(
@@ -105,6 +173,12 @@ void VectorStreamGroup::append(
 }
 
 void VectorStreamGroup::flush(std::ostream* out) {
+  VELOX_CHECK_NOT_NULL(serializer_, "VectorStreamGroup has no streams");
+  serializer_->flush(out);
+}
+
+void VectorStreamGroup::flush(ByteRangeWriter* out) {
+  VELOX_CHECK_NOT_NULL(serializer_, "VectorStreamGroup has no streams");
   serializer_->flush(out);
 }
 
@@ -122,9 +196,10 @@ void VectorStreamGroup::read(
     ByteStream* source,
     velox::memory::MemoryPool* pool,
     std::shared_ptr<const RowType> type,
-    std::shared_ptr<RowVector>* result) {
+    std::shared_ptr<RowVector>* result,
+    const VectorSerde::Options* options) {
   VELOX_CHECK(getVectorSerde().get(), "Vector serde is not registered");
-  getVectorSerde()->deserialize(source, pool, type, result);
+  getVectorSerde()->deserialize(source, pool, type, result, options);
 }
 
 } // namespace facebook::velox
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "velox/buffer/Buffer.h"
+#include "velox/common/compression/Compression.h"
 #include "velox/common/memory/MappedMemory.h"
 #include "velox/common/memory/Memory.h"
 #include "velox/type/Type.h"
@@ -26,6 +27,7 @@ namespace velox {
 
 class BaseVector;
 struct ByteRange;
+class ByteRangeWriter;
 class ByteStream;
 class RowVector;
 
@@ -90,12 +92,26 @@ class VectorSerializer {
 
   // Writes the contents to 'stream' in wire format
   virtual void flush(std::ostream* stream) = 0;
+
+  // Adds the contents in wire format to 'out', referring to the memory of
+  // the streams instead of copying it where possible. The default
+  // implementation copies.
+  virtual void flush(ByteRangeWriter* out);
 };
 
 class VectorSerde {
  public:
   virtual ~VectorSerde() = default;
 
+  // Serde specific parameters. The reader must use the same options as the
+  // writer.
+  struct Options {
+    virtual ~Options() = default;
+
+    // Codec for compressing serialized pages.
+    common::CompressionKind compressionKind{common::CompressionKind::kNone};
+  };
+
   virtual void estimateSerializedSize(
       std::shared_ptr<BaseVector> vector,
       const folly::Range<const IndexRange*>& ranges,
@@ -104,13 +120,15 @@ class VectorSerde {
   virtual std::unique_ptr<VectorSerializer> createSerializer(
       std::shared_ptr<const RowType> type,
       int32_t numRows,
-      StreamArena* streamArena) = 0;
+      StreamArena* streamArena,
+      const Options* options = nullptr) = 0;
 
   virtual void deserialize(
       ByteStream* source,
       velox::memory::MemoryPool* pool,
       std::shared_ptr<const RowType> type,
-      std::shared_ptr<RowVector>* result) = 0;
+      std::shared_ptr<RowVector>* result,
+      const Options* options = nullptr) = 0;
 };
 
 bool registerVectorSerde(std::unique_ptr<VectorSerde> serde);
@@ -135,7 +153,10 @@ class VectorStreamGroup : public StreamArena {
   explicit VectorStreamGroup(memory::MappedMemory* mappedMemory)
       : StreamArena(mappedMemory) {}
 
-  void createStreamTree(std::shared_ptr<const RowType> type, int32_t numRows);
+  void createStreamTree(
+      std::shared_ptr<const RowType> type,
+      int32_t numRows,
+      const VectorSerde::Options* options = nullptr);
 
   static void estimateSerializedSize(
       std::shared_ptr<BaseVector> vector,
@@ -149,12 +170,17 @@ class VectorStreamGroup : public StreamArena {
   // Writes the contents to 'stream' in wire format.
   void flush(std::ostream* stream);
 
+  // Adds the contents in wire format to 'out'. 'out' refers to the memory
+  // of 'this', which must stay live while 'out' is used.
+  void flush(ByteRangeWriter* out);
+
   // Reads data in wire format. Returns the RowVector in 'result'.
   static void read(
       ByteStream* source,
       velox::memory::MemoryPool* pool,
       std::shared_ptr<const RowType> type,
-      std::shared_ptr<RowVector>* result);
+      std::shared_ptr<RowVector>* result,
+      const VectorSerde::Options* options = nullptr);
 
  private:
   std::unique_ptr<VectorSerializer> serializer_;
@@ -177,6 +203,55 @@ inline int32_t ByteRange::available<bool>() {
   return size * 8 - position;
 }
 
+// Collects serialized bytes as a sequence of ByteRanges. Ranges given to
+// append() are referenced in place, so that their memory, e.g. the
+// StreamArena of a VectorStreamGroup, must outlive the use of the ranges.
+// Bytes given to write() are copied into memory owned by 'this'. These are
+// meant for headers and counts. The ranges are ready for reading with
+// ByteStream::resetInput().
+class ByteRangeWriter {
+ public:
+  // Copies 'size' bytes from 'data', extending the last range if it ends
+  // in the memory of 'this'.
+  void write(const char* data, int32_t size);
+
+  // Adds 'range' without copying. Empty ranges are skipped.
+  void append(ByteRange range);
+
+  // Adds the ranges of 'other' after those of 'this' and takes ownership of
+  // the memory of 'other'.
+  void append(ByteRangeWriter&& other);
+
+  const std::vector<ByteRange>& ranges() const {
+    return ranges_;
+  }
+
+  // Moves the ranges out for ByteStream::resetInput(). The memory stays
+  // owned by 'this'.
+  std::vector<ByteRange> takeRanges() {
+    return std::move(ranges_);
+  }
+
+  // Total number of bytes in the ranges.
+  int64_t size() const {
+    return size_;
+  }
+
+ private:
+  static constexpr int32_t kChunkSize = 1024;
+
+  // The memory for copied bytes.
+  std::vector<std::unique_ptr<uint8_t[]>> chunks_;
+
+  // The chunk that write() copies to and the bytes used in it.
+  uint8_t* currentChunk_{nullptr};
+  int32_t currentChunkSize_{0};
+  int32_t currentChunkUsed_{0};
+
+  std::vector<ByteRange> ranges_;
+  int64_t size_{0};
+};
+
 // Stream over a chain of ByteRanges. Provides read, write and
 // comparison for equality between stream contents and memory. Used
 // for streams in repartitioning or for complex variable length data
@@ -423,6 +498,9 @@ class ByteStream {
 
   void flush(std::ostream* stream);
 
+  // Adds the written ranges to 'out' without copying.
+  void flush(ByteRangeWriter* out);
+
   // Returns the next byte that would be written to by a write. This
   // is used after an append to release the remainder of the reserved
   // space.
@@ -15,28 +15,56 @@
  */
 
 #include "velox/vector/arrow/Bridge.h"
+
+#include <cstring>
+
 #include "velox/buffer/Buffer.h"
 #include "velox/common/base/BitUtil.h"
 #include "velox/common/base/Exceptions.h"
+#include "velox/common/base/Nulls.h"
 #include "velox/common/memory/Memory.h"
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/ConstantVector.h"
 #include "velox/vector/FlatVector.h"
 
 namespace facebook::velox {
 
 namespace {
 
-// TODO: The initial supported conversions only use one buffer for nulls and
-// one for value, but we'll need more once we support strings and complex types.
-static constexpr size_t kMaxBuffers{2};
-
 // Structure that will hold the buffers needed by ArrowArray. This is opaquely
 // carried by ArrowArray.private_data
 struct VeloxToArrowBridgeHolder {
+  // Releases the children and dictionary if the export failed before
+  // handing them over. After bridgeRelease() they are already released.
+  ~VeloxToArrowBridgeHolder() {
+    for (auto& child : childrenOwned) {
+      if (child->release != nullptr) {
+        child->release(child.get());
+      }
+    }
+    if (dictionary && dictionary->release != nullptr) {
+      dictionary->release(dictionary.get());
+    }
+  }
+
   // Holds a shared_ptr to the vector being bridged, to ensure its lifetime.
   VectorPtr vector;
 
-  // Holds the pointers to buffers.
-  const void* buffers[kMaxBuffers];
+  // Holds the buffers created by the export, e.g. Arrow offsets, which have
+  // no counterpart in the Velox vector.
+  std::vector<BufferPtr> ownedBuffers;
+
+  // Holds the pointers to buffers. The first one is always nulls.
+  std::vector<const void*> buffers;
+
+  // Same as for the schema below, ArrowArray takes an ArrowArray** pointer
+  // for children, so we keep both:
+  //   childrenRaw[i] == childrenOwned[i].get()
+  std::vector<ArrowArray*> childrenRaw;
+  std::vector<std::unique_ptr<ArrowArray>> childrenOwned;
+
+  // The values of a dictionary encoded array.
+  std::unique_ptr<ArrowArray> dictionary;
 };
 
 // Structure that will hold buffers needed by ArrowSchema. This is opaquely
@@ -55,8 +83,10 @@ struct VeloxToArrowSchemaBridgeHolder {
   // ArrowSchema.name pointer to the internal string that contains the column
   // name.
   RowTypePtr rowType;
-};
 
+  // The schema of the values of a dictionary encoded array.
+  std::unique_ptr<ArrowSchema> dictionary;
+};
 // Release function for ArrowArray. Arrow standard requires it to recurse down
 // to children and dictionary arrays, and set release and private_data to null
 // to signal it has been released.
@@ -125,8 +155,64 @@ static void bridgeSchemaRelease(ArrowSchema* arrowSchema) {
   arrowSchema->private_data = nullptr;
 }
 
-void exportFlatVector(const VectorPtr& vector, ArrowArray& arrowArray) {
-  switch (vector->typeKind()) {
+// Returns the null count to report for the nulls buffer of 'vector'. A
+// vector without a nulls buffer has no nulls of its own, e.g. a dictionary
+// whose nulls all come from its base.
+int64_t exportNullCount(const BaseVector& vector) {
+  auto rawNulls = vector.rawNulls();
+  if (rawNulls == nullptr) {
+    return 0;
+  }
+  if (vector.encoding() == VectorEncoding::Simple::FLAT) {
+    // getNullCount() returns a std::optional. -1 means we don't have the count
+    // available yet (and we don't want to count it here).
+    return vector.getNullCount().value_or(-1);
+  }
+  return bits::countNulls(rawNulls, 0, vector.size());
+}
+
+// Converts the StringViews of 'vector' into the Arrow layout of int32
+// offsets followed by the concatenated characters. Short strings are inlined
+// into the StringViews and long ones may be spread over many string buffers,
+// so the characters are always copied.
+void exportStrings(
+    const FlatVector<StringView>& vector,
+    VeloxToArrowBridgeHolder& holder) {
+  auto size = vector.size();
+  auto rawValues = vector.rawValues();
+  int64_t totalSize = 0;
+  for (auto i = 0; i < size; ++i) {
+    if (!vector.isNullAt(i)) {
+      totalSize += rawValues[i].size();
+    }
+  }
+  VELOX_CHECK_LE(
+      totalSize,
+      std::numeric_limits<int32_t>::max(),
+      "Strings are too large for Arrow int32 offsets.");
+
+  auto offsets = AlignedBuffer::allocate<int32_t>(size + 1, vector.pool());
+  auto data = AlignedBuffer::allocate<char>(totalSize, vector.pool());
+  auto rawOffsets = offsets->asMutable<int32_t>();
+  auto rawData = data->asMutable<char>();
+  rawOffsets[0] = 0;
+  for (auto i = 0; i < size; ++i) {
+    int32_t length = vector.isNullAt(i) ? 0 : rawValues[i].size();
+    if (length > 0) {
+      memcpy(rawData + rawOffsets[i], rawValues[i].data(), length);
+    }
+    rawOffsets[i + 1] = rawOffsets[i] + length;
+  }
+  holder.buffers.push_back(offsets->as<void>());
+  holder.buffers.push_back(data->as<void>());
+  holder.ownedBuffers.push_back(std::move(offsets));
+  holder.ownedBuffers.push_back(std::move(data));
+}
+
+void exportFlatVector(
+    const BaseVector& vector,
+    VeloxToArrowBridgeHolder& holder) {
+  switch (vector.typeKind()) {
     case TypeKind::BOOLEAN:
     case TypeKind::TINYINT:
     case TypeKind::SMALLINT:
@@ -134,14 +220,121 @@ void exportFlatVector(const VectorPtr& vector, ArrowArray& arrowArray) {
     case TypeKind::BIGINT:
     case TypeKind::REAL:
     case TypeKind::DOUBLE:
-      arrowArray.buffers[1] = vector->valuesAsVoid();
+    // Date is the number of days since epoch in an int32, as date32[days].
+    case TypeKind::DATE:
+      holder.buffers.push_back(vector.valuesAsVoid());
+      break;
+
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      exportStrings(*vector.asFlatVector<StringView>(), holder);
       break;
 
     default:
       VELOX_NYI(
           "Conversion of FlatVector of {} is not supported yet.",
-          vector->typeKind());
+          vector.typeKind());
+  }
+}
+
+// Returns true if the arrays or maps given by 'rawOffsets' and 'rawSizes'
+// are laid out back to back in row order. Only then the Arrow offsets can
+// refer to the elements as they are.
+bool isInOrder(
+    const vector_size_t* rawOffsets,
+    const vector_size_t* rawSizes,
+    vector_size_t size) {
+  for (auto i = 1; i < size; ++i) {
+    if (rawOffsets[i] != rawOffsets[i - 1] + rawSizes[i - 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Converts the offsets and sizes of the arrays or maps of 'vector' into the
+// size + 1 Arrow offsets. If the elements are out of order or shared among
+// rows, replaces each of 'children' by a copy of its elements in row order.
+template <typename TOffset>
+void exportOffsets(
+    const BaseVector& vector,
+    const vector_size_t* rawOffsets,
+    const vector_size_t* rawSizes,
+    std::vector<VectorPtr>& children,
+    VeloxToArrowBridgeHolder& holder) {
+  auto size = vector.size();
+  auto offsets = AlignedBuffer::allocate<TOffset>(size + 1, vector.pool());
+  auto rawArrowOffsets = offsets->asMutable<TOffset>();
+  if (isInOrder(rawOffsets, rawSizes, size)) {
+    rawArrowOffsets[0] = size == 0 ? 0 : rawOffsets[0];
+    for (auto i = 0; i < size; ++i) {
+      rawArrowOffsets[i + 1] = rawArrowOffsets[i] + rawSizes[i];
+    }
+  } else {
+    rawArrowOffsets[0] = 0;
+    for (auto i = 0; i < size; ++i) {
+      rawArrowOffsets[i + 1] =
+          rawArrowOffsets[i] + (vector.isNullAt(i) ? 0 : rawSizes[i]);
+    }
+    for (auto& child : children) {
+      auto copy = BaseVector::create(
+          child->type(), rawArrowOffsets[size], vector.pool());
+      for (auto i = 0; i < size; ++i) {
+        if (!vector.isNullAt(i) && rawSizes[i] > 0) {
+          copy->copy(
+              child.get(), rawArrowOffsets[i], rawOffsets[i], rawSizes[i]);
+        }
+      }
+      child = std::move(copy);
+    }
   }
+  holder.buffers.push_back(offsets->as<void>());
+  holder.ownedBuffers.push_back(std::move(offsets));
+}
+
+// Returns the vector exported as the values of the dictionary encoded
+// 'vector' and sets 'indices' to the dictionary indices.
+VectorPtr exportDictionaryBase(const BaseVector& vector, BufferPtr& indices) {
+  if (vector.encoding() == VectorEncoding::Simple::DICTIONARY) {
+    indices = vector.wrapInfo();
+    return vector.valueVector();
+  }
+
+  // Arrow has no constant encoding. A constant becomes a dictionary with a
+  // single value for scalars, or the base vector of complex types.
+  VELOX_CHECK_EQ(vector.encoding(), VectorEncoding::Simple::CONSTANT);
+  indices = allocateIndices(vector.size(), vector.pool());
+  if (vector.isScalar()) {
+    auto base = BaseVector::create(vector.type(), 1, vector.pool());
+    base->copy(&vector, 0, 0, 1);
+    return base;
+  }
+  auto index = vector.as<ConstantVector<ComplexType>>()->index();
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  std::fill(rawIndices, rawIndices + vector.size(), index);
+  return vector.valueVector();
+}
+
+void exportDictionaryVector(
+    const BaseVector& vector,
+    VeloxToArrowBridgeHolder& holder,
+    ArrowArray& arrowArray) {
+  BufferPtr indices;
+  auto base = exportDictionaryBase(vector, indices);
+  if (vector.encoding() == VectorEncoding::Simple::CONSTANT &&
+      vector.isNullAt(0)) {
+    auto nulls = AlignedBuffer::allocate<bool>(
+        vector.size(), vector.pool(), bits::kNull);
+    holder.buffers[0] = nulls->as<void>();
+    holder.ownedBuffers.push_back(std::move(nulls));
+    arrowArray.null_count = vector.size();
+  }
+  holder.buffers.push_back(indices->as<void>());
+  holder.ownedBuffers.push_back(std::move(indices));
+
+  holder.dictionary = std::make_unique<ArrowArray>();
+  exportToArrow(base, *holder.dictionary);
+  arrowArray.dictionary = holder.dictionary.get();
 }
 
 // Returns the Arrow C data interface format type for a given Velox type.
@@ -185,59 +378,70 @@ const char* exportArrowFormatStr(const TypePtr& type) {
   }
 }
 
-} // namespace
-
-void exportToArrow(const VectorPtr& vector, ArrowArray& arrowArray) {
-  // Bridge holder is stored in private_data, which is a C-compatible naked
-  // pointer. However, since this function can throw (unsupported conversion
-  // type, for instance), we temporarily use a unique_ptr to ensure the bridge
-  // holder is released in case this function fails.
-  //
-  // Since this unique_ptr dies with this function and we'll need this bridge
-  // alive, the last step in this function is to release this unique_ptr.
-  auto bridgeHolder = std::make_unique<VeloxToArrowBridgeHolder>();
-  bridgeHolder->vector = vector;
-  arrowArray.n_buffers = kMaxBuffers;
-  arrowArray.buffers = bridgeHolder->buffers;
-  arrowArray.release = bridgeRelease;
-  arrowArray.length = vector->size();
-
-  // getNullCount() returns a std::optional. -1 means we don't have the count
-  // available yet (and we don't want to count it here).
-  arrowArray.null_count = vector->getNullCount().value_or(-1);
-
-  // Velox does not support offset'ed vectors yet.
-  arrowArray.offset = 0;
-
-  // Setting up buffer pointers. First one is always nulls.
-  arrowArray.buffers[0] = vector->rawNulls();
-
-  // Second buffer is values. Only support flat for now.
-  switch (vector->encoding()) {
-    case VectorEncoding::Simple::FLAT:
-      exportFlatVector(vector, arrowArray);
-      break;
+// Exports 'children' as the children of 'arrowArray'.
+void exportChildren(
+    const std::vector<VectorPtr>& children,
+    VeloxToArrowBridgeHolder& holder,
+    ArrowArray& arrowArray) {
+  holder.childrenRaw.reserve(children.size());
+  holder.childrenOwned.reserve(children.size());
+  for (const auto& child : children) {
+    VELOX_CHECK_NOT_NULL(child, "Can't export a vector with null children.");
+    // The holder releases the children already exported if a later one
+    // throws.
+    holder.childrenOwned.push_back(std::make_unique<ArrowArray>());
+    holder.childrenRaw.push_back(holder.childrenOwned.back().get());
+    exportToArrow(child, *holder.childrenRaw.back());
+  }
+  arrowArray.n_children = children.size();
+  arrowArray.children = holder.childrenRaw.data();
+}
 
+// Returns the vector exported as child 'index' of 'vector', or nullptr if
+// the export makes a flat copy, e.g. of out of order array elements.
+VectorPtr exportedChild(const BaseVector& vector, int32_t index) {
+  switch (vector.encoding()) {
+    case VectorEncoding::Simple::ROW:
+      return vector.as<RowVector>()->childAt(index);
+    case VectorEncoding::Simple::ARRAY: {
+      auto arrayVector = vector.as<ArrayVector>();
+      return isInOrder(
+                 arrayVector->rawOffsets(),
+                 arrayVector->rawSizes(),
+                 arrayVector->size())
+          ? arrayVector->elements()
+          : nullptr;
+    }
+    case VectorEncoding::Simple::MAP: {
+      auto mapVector = vector.as<MapVector>();
+      if (!isInOrder(
+              mapVector->rawOffsets(),
+              mapVector->rawSizes(),
+              mapVector->size())) {
+        return nullptr;
+      }
+      return index == 0 ? mapVector->mapKeys() : mapVector->mapValues();
+    }
     default:
-      VELOX_NYI("Only FlatVectors can be exported to Arrow for now.");
-      break;
+      return nullptr;
   }
+}
 
-  // TODO: No nested types, strings, or dictionaries for now.
-  arrowArray.n_children = 0;
-  arrowArray.children = nullptr;
-  arrowArray.dictionary = nullptr;
-
-  // We release the unique_ptr since bridgeHolder will now be carried inside
-  // ArrowArray.
-  arrowArray.private_data = bridgeHolder.release();
+bool isDictionaryExport(const BaseVector& vector) {
+  return vector.encoding() == VectorEncoding::Simple::DICTIONARY ||
+      vector.encoding() == VectorEncoding::Simple::CONSTANT;
 }
 
-void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema) {
-  arrowSchema.format = exportArrowFormatStr(type);
+// Exports 'type' to 'arrowSchema'. If 'vector' is not null, the children and
+// dictionaries follow the encodings 'vector' is exported with.
+void exportSchema(
+    const TypePtr& type,
+    const VectorPtr& vector,
+    ArrowSchema& arrowSchema) {
+  auto loaded = vector ? BaseVector::loadedVectorShared(vector) : nullptr;
   arrowSchema.name = nullptr;
 
-  // No additional metadata or support for dictionaries for now.
+  // No additional metadata for now.
   arrowSchema.metadata = nullptr;
   arrowSchema.dictionary = nullptr;
 
@@ -246,6 +450,26 @@ void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema) {
 
   // Allocate private data buffer holder and recurse down to children types.
   auto bridgeHolder = std::make_unique<VeloxToArrowSchemaBridgeHolder>();
+
+  // Dictionary encoded vectors have int32 indices and the schema of the
+  // dictionary values.
+  if (loaded && isDictionaryExport(*loaded)) {
+    auto base = loaded->encoding() == VectorEncoding::Simple::DICTIONARY ||
+            !loaded->isScalar()
+        ? loaded->valueVector()
+        : nullptr;
+    bridgeHolder->dictionary = std::make_unique<ArrowSchema>();
+    exportSchema(type, base, *bridgeHolder->dictionary);
+    arrowSchema.format = "i";
+    arrowSchema.dictionary = bridgeHolder->dictionary.get();
+    arrowSchema.n_children = 0;
+    arrowSchema.children = nullptr;
+    arrowSchema.release = bridgeSchemaRelease;
+    arrowSchema.private_data = bridgeHolder.release();
+    return;
+  }
+
+  arrowSchema.format = exportArrowFormatStr(type);
   const size_t numChildren = type->size();
 
   if (numChildren > 0) {
@@ -275,7 +499,10 @@ void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema) {
       try {
         auto& currentSchema = bridgeHolder->childrenOwned[i];
         currentSchema = std::make_unique<ArrowSchema>();
-        exportToArrow(type->childAt(i), *currentSchema);
+        exportSchema(
+            type->childAt(i),
+            loaded ? exportedChild(*loaded, i) : nullptr,
+            *currentSchema);
 
         if (bridgeHolder->rowType) {
           currentSchema->name = bridgeHolder->rowType->nameOf(i).data();
@@ -300,7 +527,105 @@ void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema) {
   arrowSchema.private_data = bridgeHolder.release();
 }
 
+} // namespace
+
+void exportToArrow(const VectorPtr& vector, ArrowArray& arrowArray) {
+  // Bridge holder is stored in private_data, which is a C-compatible naked
+  // pointer. However, since this function can throw (unsupported conversion
+  // type, for instance), we temporarily use a unique_ptr to ensure the bridge
+  // holder is released in case this function fails.
+  //
+  // Since this unique_ptr dies with this function and we'll need this bridge
+  // alive, the last step in this function is to release this unique_ptr.
+  auto loaded = BaseVector::loadedVectorShared(vector);
+  auto bridgeHolder = std::make_unique<VeloxToArrowBridgeHolder>();
+  bridgeHolder->vector = loaded;
+  arrowArray.length = loaded->size();
+  arrowArray.null_count = exportNullCount(*loaded);
+
+  // Velox does not support offset'ed vectors yet.
+  arrowArray.offset = 0;
+  arrowArray.n_children = 0;
+  arrowArray.children = nullptr;
+  arrowArray.dictionary = nullptr;
+
+  // Setting up buffer pointers. First one is always nulls.
+  bridgeHolder->buffers.push_back(loaded->rawNulls());
+
+  // The other buffers and the children depend on the encoding. Only the
+  // Arrow offsets, string characters and dictionary indices of constants are
+  // allocated. All other buffers are shared with the vector.
+  switch (loaded->encoding()) {
+    case VectorEncoding::Simple::FLAT:
+      exportFlatVector(*loaded, *bridgeHolder);
+      break;
+
+    case VectorEncoding::Simple::ROW:
+      exportChildren(
+          loaded->as<RowVector>()->children(), *bridgeHolder, arrowArray);
+      break;
+
+    case VectorEncoding::Simple::ARRAY: {
+      auto arrayVector = loaded->as<ArrayVector>();
+      std::vector<VectorPtr> children{arrayVector->elements()};
+      exportOffsets<int64_t>(
+          *arrayVector,
+          arrayVector->rawOffsets(),
+          arrayVector->rawSizes(),
+          children,
+          *bridgeHolder);
+      exportChildren(children, *bridgeHolder, arrowArray);
+      break;
+    }
+
+    case VectorEncoding::Simple::MAP: {
+      auto mapVector = loaded->as<MapVector>();
+      std::vector<VectorPtr> children{
+          mapVector->mapKeys(), mapVector->mapValues()};
+      exportOffsets<int32_t>(
+          *mapVector,
+          mapVector->rawOffsets(),
+          mapVector->rawSizes(),
+          children,
+          *bridgeHolder);
+      exportChildren(children, *bridgeHolder, arrowArray);
+      break;
+    }
+
+    case VectorEncoding::Simple::DICTIONARY:
+    case VectorEncoding::Simple::CONSTANT:
+      exportDictionaryVector(*loaded, *bridgeHolder, arrowArray);
+      break;
+
+    default:
+      VELOX_NYI(
+          "Conversion of {} vectors to Arrow is not supported yet.",
+          loaded->encoding());
+  }
+
+  arrowArray.n_buffers = bridgeHolder->buffers.size();
+  arrowArray.buffers = bridgeHolder->buffers.data();
+
+  // We release the unique_ptr since bridgeHolder will now be carried inside
+  // ArrowArray.
+  arrowArray.release = bridgeRelease;
+  arrowArray.private_data = bridgeHolder.release();
+}
+
+void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema) {
+  exportSchema(type, nullptr, arrowSchema);
+}
+
+void exportToArrow(const VectorPtr& vector, ArrowSchema& arrowSchema) {
+  exportSchema(vector->type(), vector, arrowSchema);
+}
+
 TypePtr importFromArrow(const ArrowSchema& arrowSchema) {
+  // Dictionary encoded arrays have the type of their values.
+  if (arrowSchema.dictionary != nullptr) {
+    return importFromArrow(*arrowSchema.dictionary);
+  }
+
   const char* format = arrowSchema.format;
   VELOX_CHECK_NOT_NULL(format);
 
@@ -343,7 +668,8 @@ TypePtr importFromArrow(const ArrowSchema& arrowSchema) {
     // Complex types.
     case '+': {
       switch (format[1]) {
-        // Array/list.
+        // Array/list and large list.
+        case 'l':
         case 'L':
           VELOX_CHECK_EQ(arrowSchema.n_children, 1);
           VELOX_CHECK_NOT_NULL(arrowSchema.children[0]);
@@ -463,15 +789,189 @@ VectorPtr importFromArrowImpl(
     const ArrowSchema& arrowSchema,
     const ArrowArray& arrowArray,
     memory::MemoryPool* pool,
-    WrapInBufferViewFunc wrapInBufferView) {
-  VELOX_USER_CHECK_NOT_NULL(arrowSchema.release, "arrowSchema was released.");
-  VELOX_USER_CHECK_NOT_NULL(arrowArray.release, "arrowArray was released.");
-  VELOX_USER_CHECK_NULL(
-      arrowArray.dictionary,
-      "Dictionary encoded arrowArrays not supported yet.");
+    const WrapInBufferViewFunc& wrapInBufferView);
+
+std::optional<vector_size_t> importNullCount(const ArrowArray& arrowArray) {
+  return arrowArray.null_count == -1
+      ? std::nullopt
+      : std::optional<vector_size_t>(arrowArray.null_count);
+}
+
+VectorPtr importFlatVector(
+    const TypePtr& type,
+    const ArrowArray& arrowArray,
+    BufferPtr nulls,
+    memory::MemoryPool* pool,
+    const WrapInBufferViewFunc& wrapInBufferView) {
+  VELOX_USER_CHECK(
+      type->isPrimitiveType(),
+      "Conversion of {} ArrowArrays is not supported yet.",
+      type->toString());
   VELOX_USER_CHECK(
       (arrowArray.n_children == 0) && (arrowArray.children == nullptr),
-      "Only flat buffers are supported for now.");
+      "ArrowArrays of primitive types can't have children.");
+
+  // Wrap the values buffer into a Velox BufferView (also zero-copy).
+  VELOX_USER_CHECK_EQ(
+      arrowArray.n_buffers,
+      2,
+      "Expecting two buffers as input for primitive types.");
+  auto values = wrapInBufferView(
+      arrowArray.buffers[1], arrowArray.length * type->cppSizeInBytes());
+
+  return VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
+      createFlatVector,
+      type->kind(),
+      pool,
+      type,
+      nulls,
+      arrowArray.length,
+      values,
+      arrowArray.null_count);
+}
+
+// Makes StringViews over the characters of the Arrow strings. The characters
+// are wrapped, only the StringViews are allocated.
+template <typename TOffset>
+VectorPtr importStrings(
+    const TypePtr& type,
+    const ArrowArray& arrowArray,
+    BufferPtr nulls,
+    memory::MemoryPool* pool,
+    const WrapInBufferViewFunc& wrapInBufferView) {
+  VELOX_USER_CHECK_EQ(
+      arrowArray.n_buffers,
+      3,
+      "Expecting three buffers as input for strings.");
+  auto length = arrowArray.length;
+  auto rawOffsets = static_cast<const TOffset*>(arrowArray.buffers[1]);
+  auto data = static_cast<const char*>(arrowArray.buffers[2]);
+  VELOX_USER_CHECK(
+      length == 0 || rawOffsets != nullptr,
+      "Offsets buffer can't be null for strings.");
+
+  auto values = AlignedBuffer::allocate<StringView>(length, pool);
+  auto rawValues = values->asMutable<StringView>();
+  auto rawNulls = nulls ? nulls->as<uint64_t>() : nullptr;
+  for (auto i = 0; i < length; ++i) {
+    if (rawNulls && bits::isBitNull(rawNulls, i)) {
+      rawValues[i] = StringView();
+    } else {
+      rawValues[i] = StringView(
+          data + rawOffsets[i], rawOffsets[i + 1] - rawOffsets[i]);
+    }
+  }
+
+  std::vector<BufferPtr> stringBuffers;
+  if (length > 0 && data != nullptr) {
+    stringBuffers.push_back(wrapInBufferView(data, rawOffsets[length]));
+  }
+  return std::make_shared<FlatVector<StringView>>(
+      pool,
+      type,
+      nulls,
+      length,
+      values,
+      std::move(stringBuffers),
+      cdvi::EMPTY_METADATA,
+      std::nullopt,
+      importNullCount(arrowArray));
+}
+
+// Converts the length + 1 Arrow offsets of arrays or maps into Velox offsets
+// and sizes. int32 offsets are wrapped, only the sizes are allocated.
+template <typename TOffset>
+void importOffsets(
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool,
+    const WrapInBufferViewFunc& wrapInBufferView,
+    BufferPtr& offsets,
+    BufferPtr& sizes) {
+  VELOX_USER_CHECK_EQ(
+      arrowArray.n_buffers,
+      2,
+      "Expecting two buffers as input for lists and maps.");
+  auto length = arrowArray.length;
+  auto rawArrowOffsets = static_cast<const TOffset*>(arrowArray.buffers[1]);
+  VELOX_USER_CHECK(
+      length == 0 || rawArrowOffsets != nullptr,
+      "Offsets buffer can't be null for lists and maps.");
+
+  sizes = AlignedBuffer::allocate<vector_size_t>(length, pool);
+  auto rawSizes = sizes->asMutable<vector_size_t>();
+  for (auto i = 0; i < length; ++i) {
+    rawSizes[i] = rawArrowOffsets[i + 1] - rawArrowOffsets[i];
+  }
+
+  if constexpr (std::is_same_v<TOffset, vector_size_t>) {
+    offsets = wrapInBufferView(rawArrowOffsets, length * sizeof(TOffset));
+  } else {
+    offsets = AlignedBuffer::allocate<vector_size_t>(length, pool);
+    auto rawOffsets = offsets->asMutable<vector_size_t>();
+    for (auto i = 0; i < length; ++i) {
+      VELOX_USER_CHECK_LE(
+          rawArrowOffsets[i + 1],
+          std::numeric_limits<vector_size_t>::max(),
+          "Large list offsets don't fit in Velox offsets.");
+      rawOffsets[i] = rawArrowOffsets[i];
+    }
+  }
+}
+
+std::vector<VectorPtr> importChildren(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool,
+    const WrapInBufferViewFunc& wrapInBufferView) {
+  VELOX_USER_CHECK_EQ(
+      arrowArray.n_children,
+      arrowSchema.n_children,
+      "ArrowArray and ArrowSchema have different numbers of children.");
+  std::vector<VectorPtr> children;
+  children.reserve(arrowArray.n_children);
+  for (auto i = 0; i < arrowArray.n_children; ++i) {
+    VELOX_USER_CHECK_NOT_NULL(arrowArray.children[i]);
+    children.push_back(importFromArrowImpl(
+        *arrowSchema.children[i],
+        *arrowArray.children[i],
+        pool,
+        wrapInBufferView));
+  }
+  return children;
+}
+
+VectorPtr importDictionaryVector(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    BufferPtr nulls,
+    memory::MemoryPool* pool,
+    const WrapInBufferViewFunc& wrapInBufferView) {
+  VELOX_USER_CHECK_NOT_NULL(
+      arrowArray.dictionary,
+      "Dictionary encoded ArrowSchema needs a dictionary ArrowArray.");
+  VELOX_USER_CHECK_EQ(
+      std::strcmp(arrowSchema.format, "i"),
+      0,
+      "Only int32 dictionary indices are supported for now.");
+  VELOX_USER_CHECK_EQ(
+      arrowArray.n_buffers,
+      2,
+      "Expecting two buffers as input for dictionary indices.");
+  auto indices = wrapInBufferView(
+      arrowArray.buffers[1], arrowArray.length * sizeof(vector_size_t));
+  auto base = importFromArrowImpl(
+      *arrowSchema.dictionary, *arrowArray.dictionary, pool, wrapInBufferView);
+  return BaseVector::wrapInDictionary(
+      nulls, indices, arrowArray.length, std::move(base));
+}
+
+VectorPtr importFromArrowImpl(
+    const ArrowSchema& arrowSchema,
+    const ArrowArray& arrowArray,
+    memory::MemoryPool* pool,
+    const WrapInBufferViewFunc& wrapInBufferView) {
+  VELOX_USER_CHECK_NOT_NULL(arrowSchema.release, "arrowSchema was released.");
+  VELOX_USER_CHECK_NOT_NULL(arrowArray.release, "arrowArray was released.");
   VELOX_USER_CHECK_EQ(
       arrowArray.offset,
       0,
@@ -480,9 +980,6 @@ VectorPtr importFromArrowImpl(
 
   // First parse and generate a Velox type.
   auto type = importFromArrow(arrowSchema);
-  VELOX_CHECK(
-      type->isPrimitiveType(),
-      "Only conversion of primitive types is supported for now.");
 
   // Wrap the nulls buffer into a Velox BufferView (zero-copy). Null buffer size
   // needs to be at least one bit per element.
@@ -501,24 +998,83 @@ VectorPtr importFromArrowImpl(
         "Nulls buffer must be nullptr when null_count is zero.");
   }
 
-  // Wrap the values buffer into a Velox BufferView (also zero-copy).
-  VELOX_USER_CHECK_EQ(
-      arrowArray.n_buffers,
-      2,
-      "Expecting two buffers as input "
-      "(only simple types supported for now).");
-  auto values = wrapInBufferView(
-      arrowArray.buffers[1], arrowArray.length * type->cppSizeInBytes());
+  if (arrowSchema.dictionary != nullptr) {
+    return importDictionaryVector(
+        arrowSchema, arrowArray, nulls, pool, wrapInBufferView);
+  }
+  VELOX_USER_CHECK_NULL(
+      arrowArray.dictionary,
+      "Dictionary ArrowArray needs a dictionary encoded ArrowSchema.");
 
-  return VELOX_DYNAMIC_SCALAR_TYPE_DISPATCH(
-      createFlatVector,
-      type->kind(),
-      pool,
-      type,
-      nulls,
-      arrowArray.length,
-      values,
-      arrowArray.null_count);
+  // 'U' and 'Z' are large strings and binaries, and '+L' large lists.
+  bool isLarge = arrowSchema.format[0] == 'U' ||
+      arrowSchema.format[0] == 'Z' || arrowSchema.format[1] == 'L';
+  switch (type->kind()) {
+    case TypeKind::VARCHAR:
+    case TypeKind::VARBINARY:
+      return isLarge
+          ? importStrings<int64_t>(
+                type, arrowArray, nulls, pool, wrapInBufferView)
+          : importStrings<int32_t>(
+                type, arrowArray, nulls, pool, wrapInBufferView);
+
+    case TypeKind::ARRAY: {
+      BufferPtr offsets;
+      BufferPtr sizes;
+      if (isLarge) {
+        importOffsets<int64_t>(
+            arrowArray, pool, wrapInBufferView, offsets, sizes);
+      } else {
+        importOffsets<int32_t>(
+            arrowArray, pool, wrapInBufferView, offsets, sizes);
+      }
+      auto children =
+          importChildren(arrowSchema, arrowArray, pool, wrapInBufferView);
+      return std::make_shared<ArrayVector>(
+          pool,
+          type,
+          nulls,
+          arrowArray.length,
+          offsets,
+          sizes,
+          children[0],
+          importNullCount(arrowArray));
+    }
+
+    case TypeKind::MAP: {
+      BufferPtr offsets;
+      BufferPtr sizes;
+      importOffsets<int32_t>(
+          arrowArray, pool, wrapInBufferView, offsets, sizes);
+      auto children =
+          importChildren(arrowSchema, arrowArray, pool, wrapInBufferView);
+      return std::make_shared<MapVector>(
+          pool,
+          type,
+          nulls,
+          arrowArray.length,
+          offsets,
+          sizes,
+          children[0],
+          children[1],
+          importNullCount(arrowArray));
+    }
+
+    case TypeKind::ROW:
+      VELOX_USER_CHECK_EQ(
+          arrowArray.n_buffers, 1, "Expecting one buffer as input for rows.");
+      return std::make_shared<RowVector>(
+          pool,
+          type,
+          nulls,
+          arrowArray.length,
+          importChildren(arrowSchema, arrowArray, pool, wrapInBufferView),
+          importNullCount(arrowArray));
+
+    default:
+      return importFlatVector(
+          type, arrowArray, nulls, pool, wrapInBufferView);
+  }
 }
 } // namespace
 
@@ -38,6 +38,12 @@ namespace facebook::velox {
 /// being referenced, so the consumer does not need to explicitly hold on to the
 /// input Vector shared_ptr.
 ///
+/// Buffers are shared with the Vector where the layouts agree, e.g. nulls, the
+/// values of fixed-width types and dictionary indices. Offsets of strings,
+/// arrays and maps and the characters of strings are converted into new
+/// buffers. Dictionary and constant vectors are exported as dictionary
+/// encoded arrays, so their ArrowSchema comes from the Vector overload below.
+///
 /// The function throws in case the conversion is not implemented yet.
 ///
 /// Example usage:
@@ -71,6 +77,11 @@ void exportToArrow(const VectorPtr& vector, ArrowArray& arrowArray);
 ///
 void exportToArrow(const TypePtr& type, ArrowSchema& arrowSchema);
 
+/// Export the ArrowSchema of a Velox Vector. Unlike the Type overload, this
+/// describes the dictionaries the Vector is exported with, so it is the one
+/// to pair with exportToArrow(vector, arrowArray).
+void exportToArrow(const VectorPtr& vector, ArrowSchema& arrowSchema);
+
 /// Import an ArrowSchema into a Velox Type object.
 ///
 /// This function does the exact opposite of the function above. TypePtr carries
@@ -97,8 +108,9 @@ TypePtr importFromArrow(const ArrowSchema& arrowSchema);
 /// both (buffer and type). A memory pool is also required, since all vectors
 /// carry a pointer to it, but not really used in most cases - unless the
 /// conversion itself requires a new allocation. In most cases no new
-/// allocations are required, unless for arrays of varchars (or varbinaries) and
-/// complex types written out of order.
+/// allocations are required, unless for the StringViews of varchars (or
+/// varbinaries), the sizes of arrays and maps and int64 offsets. Dictionary
+/// encoded arrays with int32 indices become dictionary vectors.
 ///
 /// The new Velox vector returned contains only references to the underlying
 /// buffers, so it's the client's responsibility to ensure the buffer's
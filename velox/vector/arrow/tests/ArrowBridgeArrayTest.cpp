@@ -228,45 +228,229 @@ TEST_F(ArrowBridgeArrayExportTest, flatDouble) {
   });
 }
 
+TEST_F(ArrowBridgeArrayExportTest, flatString) {
+  std::vector<std::optional<std::string>> inputData = {
+      "a",
+      std::nullopt,
+      "a string longer than the inline size",
+      "",
+  };
+  auto vector = vectorMaker_.flatVectorNullable(inputData);
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+
+  EXPECT_EQ(4, arrowArray.length);
+  EXPECT_EQ(1, arrowArray.null_count);
+
+  // Nulls, offsets and characters.
+  EXPECT_EQ(3, arrowArray.n_buffers);
+  EXPECT_EQ(vector->rawNulls(), arrowArray.buffers[0]);
+  auto offsets = static_cast<const int32_t*>(arrowArray.buffers[1]);
+  auto data = static_cast<const char*>(arrowArray.buffers[2]);
+  for (size_t i = 0; i < inputData.size(); ++i) {
+    auto expected = inputData[i].value_or("");
+    EXPECT_EQ(expected, std::string(data + offsets[i], data + offsets[i + 1]));
+  }
+
+  arrowArray.release(&arrowArray);
+  EXPECT_EQ(nullptr, arrowArray.release);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, array) {
+  auto vector = vectorMaker_.arrayVector<int64_t>({{1, 2, 3}, {}, {4, 5}});
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+
+  EXPECT_EQ(3, arrowArray.length);
+  EXPECT_EQ(2, arrowArray.n_buffers);
+  auto offsets = static_cast<const int64_t*>(arrowArray.buffers[1]);
+  EXPECT_EQ(0, offsets[0]);
+  EXPECT_EQ(3, offsets[1]);
+  EXPECT_EQ(3, offsets[2]);
+  EXPECT_EQ(5, offsets[3]);
+
+  // The elements are shared.
+  ASSERT_EQ(1, arrowArray.n_children);
+  EXPECT_EQ(
+      vector->elements()->valuesAsVoid(), arrowArray.children[0]->buffers[1]);
+
+  arrowArray.release(&arrowArray);
+  EXPECT_EQ(nullptr, arrowArray.release);
+}
+
+TEST_F(ArrowBridgeArrayExportTest, dictionary) {
+  auto base = vectorMaker_.flatVector<int64_t>({1, 2, 3});
+  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(4, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  rawIndices[0] = 2;
+  rawIndices[1] = 0;
+  rawIndices[2] = 2;
+  rawIndices[3] = 1;
+  auto vector = BaseVector::wrapInDictionary(BufferPtr(), indices, 4, base);
+
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+  ArrowSchema arrowSchema;
+  exportToArrow(vector, arrowSchema);
+
+  // The indices and dictionary values are shared.
+  EXPECT_EQ(4, arrowArray.length);
+  EXPECT_EQ(2, arrowArray.n_buffers);
+  EXPECT_EQ(rawIndices, arrowArray.buffers[1]);
+  ASSERT_NE(nullptr, arrowArray.dictionary);
+  EXPECT_EQ(3, arrowArray.dictionary->length);
+  EXPECT_EQ(base->valuesAsVoid(), arrowArray.dictionary->buffers[1]);
+
+  EXPECT_STREQ("i", arrowSchema.format);
+  ASSERT_NE(nullptr, arrowSchema.dictionary);
+  EXPECT_STREQ("l", arrowSchema.dictionary->format);
+
+  arrowArray.release(&arrowArray);
+  arrowSchema.release(&arrowSchema);
+  EXPECT_EQ(nullptr, arrowArray.release);
+  EXPECT_EQ(nullptr, arrowSchema.release);
+}
+
 TEST_F(ArrowBridgeArrayExportTest, unsupported) {
   ArrowArray arrowArray;
   VectorPtr vector;
 
-  // Strings.
-  vector = vectorMaker_.flatVectorNullable<std::string>({});
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
-
   // Timestamps.
   vector = vectorMaker_.flatVectorNullable<Timestamp>({});
   EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
 
-  // Dates.
-  vector = vectorMaker_.flatVectorNullable<Date>({});
+  // Timestamps nested in a supported type.
+  vector = vectorMaker_.rowVector(
+      {vectorMaker_.flatVector<int64_t>({1, 2, 3}),
+       vectorMaker_.flatVector<Timestamp>(
+           {Timestamp(0, 0), Timestamp(1, 0), Timestamp(2, 0)})});
   EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+}
 
-  // Arrays.
-  vector = vectorMaker_.arrayVector<int64_t>({{1, 2, 3}, {4, 5}});
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+// Exports vectors with their schemas, imports them back and compares the
+// imported vectors with the originals.
+class ArrowBridgeArrayRoundTripTest : public ArrowBridgeArrayExportTest {
+ protected:
+  void testRoundTrip(const VectorPtr& vector) {
+    ArrowSchema arrowSchema;
+    ArrowArray arrowArray;
+    exportToArrow(vector, arrowSchema);
+    exportToArrow(vector, arrowArray);
+
+    auto imported =
+        importFromArrowAsViewer(arrowSchema, arrowArray, pool_.get());
+    ASSERT_EQ(vector->size(), imported->size());
+    ASSERT_TRUE(vector->type()->equivalent(*imported->type()));
+    for (vector_size_t i = 0; i < vector->size(); ++i) {
+      ASSERT_TRUE(vector->equalValueAt(imported.get(), i, i))
+          << "at " << i << ": " << vector->toString(i) << " vs. "
+          << imported->toString(i);
+    }
 
-  // Maps.
-  auto lambda = [](vector_size_t /* row */) { return 1; };
-  vector = vectorMaker_.mapVector<int64_t, int64_t>(2, lambda, lambda, lambda);
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+    // The imported vector only views the exported buffers.
+    imported.reset();
+    arrowArray.release(&arrowArray);
+    arrowSchema.release(&arrowSchema);
+  }
+};
 
-  // Row vectors.
-  vector =
-      vectorMaker_.rowVector({vectorMaker_.flatVector<int64_t>({1, 2, 3})});
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+TEST_F(ArrowBridgeArrayRoundTripTest, flat) {
+  testRoundTrip(vectorMaker_.flatVectorNullable<int32_t>(
+      {1, std::nullopt, 3, std::nullopt}));
+  testRoundTrip(vectorMaker_.flatVectorNullable<double>({}));
+  testRoundTrip(vectorMaker_.flatVectorNullable(
+      {"a", std::nullopt, "", "a string longer than the inline size"}));
+  testRoundTrip(vectorMaker_.flatVector(std::vector<std::string>{"x", "y"}));
+  testRoundTrip(vectorMaker_.flatVectorNullable<Date>(
+      {Date(0), std::nullopt, Date(18'000)}));
+}
 
-  // Constant encoding.
-  vector = BaseVector::createConstant(variant(10), 10, pool_.get());
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+TEST_F(ArrowBridgeArrayRoundTripTest, nested) {
+  auto sizeAt = [](vector_size_t row) { return row % 3; };
+  testRoundTrip(vectorMaker_.arrayVector<int64_t>({{1, 2, 3}, {}, {4, 5}}));
+  testRoundTrip(vectorMaker_.arrayVector<int32_t>(
+      10,
+      sizeAt,
+      [](vector_size_t index) { return index; },
+      facebook::velox::test::VectorMaker::nullEvery(4)));
+
+  std::vector<std::string> strings{"a", "a string longer than the inline size"};
+  testRoundTrip(vectorMaker_.arrayVector<StringView>(
+      5, sizeAt, [&](vector_size_t index) {
+        return StringView(strings[index % 2]);
+      }));
+
+  auto keyAt = [](vector_size_t index) { return index; };
+  auto valueAt = [](vector_size_t index) { return index * 1.5; };
+  testRoundTrip(
+      vectorMaker_.mapVector<int64_t, double>(10, sizeAt, keyAt, valueAt));
+
+  testRoundTrip(vectorMaker_.rowVector(
+      {vectorMaker_.flatVector<int64_t>({1, 2, 3}),
+       vectorMaker_.flatVectorNullable({"a", std::nullopt, "c"}),
+       vectorMaker_.arrayVector<int64_t>({{1}, {2, 3}, {}})}));
+}
 
-  // Dictionary encoding.
-  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(3, pool_.get());
-  vector = BaseVector::wrapInDictionary(
-      BufferPtr(), indices, 3, vectorMaker_.flatVector<int64_t>({1, 2, 3}));
-  EXPECT_THROW(exportToArrow(vector, arrowArray), VeloxException);
+TEST_F(ArrowBridgeArrayRoundTripTest, outOfOrderArray) {
+  // The rows are in reverse order of the elements and share elements.
+  auto elements = vectorMaker_.flatVector<int64_t>({1, 2, 3, 4, 5});
+  BufferPtr offsets = allocateIndices(3, pool_.get());
+  BufferPtr sizes = allocateIndices(3, pool_.get());
+  auto rawOffsets = offsets->asMutable<vector_size_t>();
+  auto rawSizes = sizes->asMutable<vector_size_t>();
+  rawOffsets[0] = 3;
+  rawSizes[0] = 2;
+  rawOffsets[1] = 0;
+  rawSizes[1] = 3;
+  rawOffsets[2] = 1;
+  rawSizes[2] = 4;
+  auto vector = std::make_shared<ArrayVector>(
+      pool_.get(), ARRAY(BIGINT()), BufferPtr(), 3, offsets, sizes, elements);
+  testRoundTrip(vector);
+
+  ArrowArray arrowArray;
+  exportToArrow(vector, arrowArray);
+  auto arrowOffsets = static_cast<const int64_t*>(arrowArray.buffers[1]);
+  EXPECT_EQ(0, arrowOffsets[0]);
+  EXPECT_EQ(2, arrowOffsets[1]);
+  EXPECT_EQ(5, arrowOffsets[2]);
+  EXPECT_EQ(9, arrowOffsets[3]);
+  EXPECT_EQ(9, arrowArray.children[0]->length);
+  arrowArray.release(&arrowArray);
+}
+
+TEST_F(ArrowBridgeArrayRoundTripTest, encodings) {
+  BufferPtr indices = AlignedBuffer::allocate<vector_size_t>(4, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  rawIndices[0] = 2;
+  rawIndices[1] = 0;
+  rawIndices[2] = 2;
+  rawIndices[3] = 1;
+  testRoundTrip(BaseVector::wrapInDictionary(
+      BufferPtr(),
+      indices,
+      4,
+      vectorMaker_.flatVectorNullable(
+          {"a", std::nullopt, "a string longer than the inline size"})));
+
+  testRoundTrip(
+      BaseVector::createConstant(variant(int64_t(10)), 5, pool_.get()));
+  testRoundTrip(BaseVector::createConstant(
+      variant(std::string("a string longer than the inline size")),
+      3,
+      pool_.get()));
+  testRoundTrip(BaseVector::createNullConstant(BIGINT(), 4, pool_.get()));
+  testRoundTrip(BaseVector::wrapInConstant(
+      3, 1, vectorMaker_.arrayVector<int64_t>({{1}, {2, 3}})));
+
+  // Dictionaries nested in rows.
+  testRoundTrip(vectorMaker_.rowVector(
+      {BaseVector::wrapInDictionary(
+           BufferPtr(),
+           indices,
+           4,
+           vectorMaker_.flatVector<int64_t>({1, 2, 3})),
+       BaseVector::createConstant(variant(1.5), 4, pool_.get())}));
 }
 
 class ArrowBridgeArrayImportTest : public ArrowBridgeArrayExportTest {
@@ -359,14 +543,55 @@ class ArrowBridgeArrayImportTest : public ArrowBridgeArrayExportTest {
     testArrowImport<double>("g", {std::nullopt});
     testArrowImport<double>("g", {-99.9, 4.3, 31.1, 129.11, -12});
     testArrowImport<float>("f", {-99.9, 4.3, 31.1, 129.11, -12});
+  }
 
-    // VARCHAR and VARBINARY not supported for now.
-    EXPECT_THROW(
-        testArrowImport<std::string>("u", {"hello world"}),
-        std::invalid_argument);
-    EXPECT_THROW(
-        testArrowImport<std::string>("z", {"hello world"}),
-        std::invalid_argument);
+  // Imports strings given as int32 Arrow offsets and characters and compares
+  // with a vector made from 'inputValues'.
+  void testImportString(
+      const char* format,
+      const std::vector<std::optional<std::string>>& inputValues) {
+    int64_t length = inputValues.size();
+    int64_t nullCount = 0;
+    std::vector<int32_t> offsets{0};
+    std::string data;
+    BufferPtr nulls = AlignedBuffer::allocate<uint64_t>(length, pool_.get());
+    auto rawNulls = nulls->asMutable<uint64_t>();
+    for (size_t i = 0; i < length; ++i) {
+      if (inputValues[i] == std::nullopt) {
+        bits::setNull(rawNulls, i);
+        nullCount++;
+      } else {
+        bits::clearNull(rawNulls, i);
+        data += *inputValues[i];
+      }
+      offsets.push_back(data.size());
+    }
+
+    const void* buffers[3];
+    buffers[0] = (nullCount == 0) ? nullptr : (const void*)rawNulls;
+    buffers[1] = offsets.data();
+    buffers[2] = data.data();
+
+    ArrowArray arrowArray = makeArrowArray(buffers, 3, length, nullCount);
+    auto arrowSchema = makeArrowSchema(format);
+    auto output = importFromArrow(arrowSchema, arrowArray, pool_.get());
+
+    EXPECT_EQ(nullCount, *output->getNullCount());
+    auto expected = vectorMaker_.flatVectorNullable(inputValues);
+    ASSERT_EQ(expected->size(), output->size());
+    for (vector_size_t i = 0; i < length; ++i) {
+      ASSERT_TRUE(expected->equalValueAt(output.get(), i, i))
+          << "at " << i << ": " << expected->toString(i) << " vs. "
+          << output->toString(i);
+    }
+  }
+
+  void testImportString() {
+    testImportString("u", {});
+    testImportString("u", {"hello world"});
+    testImportString(
+        "u", {"a", std::nullopt, "", "a string longer than the inline size"});
+    testImportString("z", {std::nullopt, "binary", std::nullopt});
   }
 
   void testImportFailures() {
@@ -378,7 +603,7 @@ class ArrowBridgeArrayImportTest : public ArrowBridgeArrayExportTest {
 
     // Unsupported:
 
-    // Children not yet supported.
+    // Primitive types can't have children.
     arrowSchema = makeArrowSchema("i");
     arrowArray = makeArrowArray(buffers, 2, 4, 0);
     arrowArray.n_children = 1;
@@ -452,6 +677,10 @@ TEST_F(ArrowBridgeArrayImportAsViewerTest, scalar) {
   testImportScalar();
 }
 
+TEST_F(ArrowBridgeArrayImportAsViewerTest, string) {
+  testImportString();
+}
+
 TEST_F(ArrowBridgeArrayImportAsViewerTest, failures) {
   testImportFailures();
 }
@@ -471,6 +700,10 @@ TEST_F(ArrowBridgeArrayImportAsOwnerTest, scalar) {
   testImportScalar();
 }
 
+TEST_F(ArrowBridgeArrayImportAsOwnerTest, string) {
+  testImportString();
+}
+
 TEST_F(ArrowBridgeArrayImportAsOwnerTest, failures) {
   testImportFailures();
 }
@@ -223,6 +223,7 @@ TEST_F(ArrowBridgeSchemaImportTest, complexTypes) {
   EXPECT_EQ(*ARRAY(TIMESTAMP()), *testSchemaImportComplex("+L", {"ttn"}));
   EXPECT_EQ(*ARRAY(DATE()), *testSchemaImportComplex("+L", {"tdD"}));
   EXPECT_EQ(*ARRAY(VARCHAR()), *testSchemaImportComplex("+L", {"U"}));
+  EXPECT_EQ(*ARRAY(BIGINT()), *testSchemaImportComplex("+l", {"l"}));
 
   // Map.
   EXPECT_EQ(
@@ -261,7 +262,6 @@ TEST_F(ArrowBridgeSchemaImportTest, unsupported) {
   EXPECT_THROW(testSchemaImport("tiM"), VeloxUserError);
 
   EXPECT_THROW(testSchemaImport("+"), VeloxUserError);
-  EXPECT_THROW(testSchemaImport("+l"), VeloxUserError);
   EXPECT_THROW(testSchemaImport("+b"), VeloxUserError);
   EXPECT_THROW(testSchemaImport("+z"), VeloxUserError);
   EXPECT_THROW(testSchemaImport("+u"), VeloxUserError);
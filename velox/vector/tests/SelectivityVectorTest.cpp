@@ -17,6 +17,7 @@
 #include "velox/vector/SelectivityVector.h"
 
 #include <gtest/gtest.h>
+#include <numeric>
 
 namespace facebook {
 namespace velox {
@@ -436,6 +437,61 @@ TEST(SelectivityVectorTest, select) {
   assertIsValid(2, 8, bitAfterCheck, true);
 }
 
+TEST(SelectivityVectorTest, sparse) {
+  // Selects every 1000th row. The rows are then visited from a list of
+  // selected rows instead of from the bits.
+  SelectivityVector rows(10'000, false);
+  for (auto i = 0; i < 10'000; i += 1'000) {
+    rows.setValid(i, true);
+  }
+  rows.updateBounds();
+
+  auto expectRows = [&](const std::vector<vector_size_t>& expected) {
+    std::vector<vector_size_t> selected;
+    rows.applyToSelected([&](auto row) { selected.push_back(row); });
+    ASSERT_EQ(expected, selected);
+    selected.clear();
+    rows.testSelected([&](auto row) {
+      selected.push_back(row);
+      return row < 5'000;
+    });
+    std::vector<vector_size_t> expectedTested;
+    for (auto row : expected) {
+      expectedTested.push_back(row);
+      if (row >= 5'000) {
+        break;
+      }
+    }
+    ASSERT_EQ(expectedTested, selected);
+  };
+
+  std::vector<vector_size_t> expected;
+  for (auto i = 0; i < 10'000; i += 1'000) {
+    expected.push_back(i);
+  }
+  expectRows(expected);
+
+  // A change to the selection is seen by the next iteration.
+  rows.setValid(3'000, false);
+  rows.setValid(3'001, true);
+  rows.updateBounds();
+  expected[3] = 3'001;
+  expectRows(expected);
+
+  rows.setValidRange(0, 2'000, true);
+  rows.updateBounds();
+  expected.erase(expected.begin(), expected.begin() + 2);
+  std::vector<vector_size_t> dense(2'000);
+  std::iota(dense.begin(), dense.end(), 0);
+  expected.insert(expected.begin(), dense.begin(), dense.end());
+  expectRows(expected);
+
+  rows.clearAll();
+  rows.setValid(9'999, true);
+  rows.updateBounds();
+  expectRows({9'999});
+}
+
 } // namespace test
 } // namespace velox
 } // namespace facebook
@@ -327,6 +327,35 @@ TEST_F(SimpleVectorNonParameterizedTest, isAsciiSourceRows) {
   }
 }
 
+TEST_F(SimpleVectorNonParameterizedTest, isAsciiDictionary) {
+  std::vector<std::string> data = {
+      "abc", "a long string of more than 32 ASCII characters", "xyz"};
+  auto base = maker_.flatVector(data);
+  SelectivityVector all(base->size());
+  ASSERT_TRUE(base->computeAndSetIsAscii(all));
+  ASSERT_TRUE(base->isKnownAllAscii());
+
+  // A dictionary over an all-ASCII base starts out all ASCII.
+  auto indices = allocateIndices(4, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  for (auto i = 0; i < 4; ++i) {
+    rawIndices[i] = i % base->size();
+  }
+  auto dictionary = std::make_shared<DictionaryVector<StringView>>(
+      pool_.get(), nullptr, 4, base, TypeKind::INTEGER, indices);
+  assertIsAscii(dictionary, SelectivityVector(4), true);
+
+  // Nothing is known when the base asciiness is unknown or false.
+  data[1] += "\u00e0";
+  base = maker_.flatVector(data);
+  ASSERT_FALSE(base->isKnownAllAscii());
+  dictionary = std::make_shared<DictionaryVector<StringView>>(
+      pool_.get(), nullptr, 4, base, TypeKind::INTEGER, indices);
+  ASSERT_FALSE(dictionary->isAscii(SelectivityVector(4)).has_value());
+  ASSERT_FALSE(base->computeAndSetIsAscii(all));
+  ASSERT_FALSE(base->isKnownAllAscii());
+}
+
 TEST_F(SimpleVectorNonParameterizedTest, invalidateIsAscii) {
   for (auto encoding : kAsciiEncodings) {
     LOG(INFO) << "Running:" << encoding;
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include "velox/vector/VectorPool.h"
+
+#include <gtest/gtest.h>
+
+#include "velox/vector/ComplexVector.h"
+#include "velox/vector/tests/VectorMaker.h"
+
+using namespace facebook::velox;
+
+class VectorPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pool_ = memory::getDefaultScopedMemoryPool();
+    vectorMaker_ = std::make_unique<test::VectorMaker>(pool_.get());
+  }
+
+  std::unique_ptr<memory::MemoryPool> pool_;
+  std::unique_ptr<test::VectorMaker> vectorMaker_;
+};
+
+TEST_F(VectorPoolTest, reuse) {
+  VectorPool vectorPool(pool_.get());
+  VectorPtr vector = vectorMaker_->flatVectorNullable<int64_t>(
+      {1, std::nullopt, 3, std::nullopt});
+  auto values = vector->values().get();
+  EXPECT_TRUE(vectorPool.release(vector));
+  EXPECT_EQ(nullptr, vector);
+  EXPECT_EQ(1, vectorPool.size());
+
+  // The cached vector and its buffers come back with all rows not null.
+  auto reused = vectorPool.get(BIGINT(), 3);
+  EXPECT_EQ(0, vectorPool.size());
+  EXPECT_EQ(values, reused->values().get());
+  EXPECT_EQ(3, reused->size());
+  for (auto i = 0; i < 3; ++i) {
+    EXPECT_FALSE(reused->isNullAt(i));
+  }
+
+  // A vector with another reference is not taken.
+  auto copy = reused;
+  EXPECT_FALSE(vectorPool.release(reused));
+  EXPECT_NE(nullptr, reused);
+  copy = nullptr;
+
+  // A different kind gets a new vector.
+  auto doubles = vectorPool.get(DOUBLE(), 10);
+  EXPECT_EQ(TypeKind::DOUBLE, doubles->typeKind());
+  EXPECT_EQ(10, doubles->size());
+}
+
+TEST_F(VectorPoolTest, limits) {
+  VectorPool vectorPool(pool_.get());
+  std::vector<VectorPtr> vectors;
+  for (auto i = 0; i < VectorPool::kNumPerKind + 2; ++i) {
+    vectors.push_back(BaseVector::create(INTEGER(), 100, pool_.get()));
+  }
+  vectors.push_back(BaseVector::create(ARRAY(INTEGER()), 2, pool_.get()));
+  EXPECT_EQ(VectorPool::kNumPerKind, vectorPool.release(vectors));
+  EXPECT_EQ(VectorPool::kNumPerKind, vectorPool.size());
+  EXPECT_NE(nullptr, vectors.back());
+
+  vectorPool.clear();
+  EXPECT_EQ(0, vectorPool.size());
+}
+
+TEST_F(VectorPoolTest, strings) {
+  VectorPool vectorPool(pool_.get());
+  VectorPtr vector = vectorMaker_->flatVector(std::vector<std::string>{
+      "a long string that does not fit inline", "short"});
+  EXPECT_TRUE(vectorPool.release(vector));
+  auto reused = vectorPool.get(VARCHAR(), 2);
+  auto flat = reused->asFlatVector<StringView>();
+  EXPECT_TRUE(flat->stringBuffers().empty());
+  EXPECT_EQ(0, flat->valueAt(0).size());
+  EXPECT_EQ(0, flat->valueAt(1).size());
+}
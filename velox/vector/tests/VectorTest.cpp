@@ -1319,3 +1319,95 @@ TEST_F(VectorTest, constantDictionary) {
     ASSERT_TRUE(dictionaryVector->isConstant(rows));
   }
 }
+
+namespace {
+void assertSlice(
+    const VectorPtr& vector,
+    vector_size_t offset,
+    vector_size_t length) {
+  auto slice = vector->slice(offset, length);
+  ASSERT_EQ(slice->size(), length);
+  ASSERT_EQ(slice->encoding(), vector->encoding());
+  for (auto i = 0; i < length; ++i) {
+    ASSERT_TRUE(vector->equalValueAt(slice.get(), offset + i, i))
+        << "at " << i << ": " << vector->toString(offset + i) << " vs. "
+        << slice->toString(i);
+  }
+}
+} // namespace
+
+TEST_F(VectorTest, slice) {
+  test::VectorMaker maker(pool_.get());
+  constexpr vector_size_t kSize = 100;
+  auto ints = maker.flatVector<int64_t>(
+      kSize, [](auto row) { return row; }, test::VectorMaker::nullEvery(7));
+  auto bools = maker.flatVector<bool>(
+      kSize,
+      [](auto row) { return row % 3 == 0; },
+      test::VectorMaker::nullEvery(5));
+  std::vector<std::string> stringValues;
+  for (auto i = 0; i < kSize; ++i) {
+    stringValues.push_back(fmt::format("a string longer than inline {}", i));
+  }
+  auto strings = maker.flatVector<StringView>(
+      kSize,
+      [&](auto row) { return StringView(stringValues[row]); },
+      test::VectorMaker::nullEvery(11));
+  auto arrays = maker.arrayVector<int32_t>(
+      kSize,
+      [](vector_size_t row) { return row % 4; },
+      [](vector_size_t index) { return index; },
+      test::VectorMaker::nullEvery(9));
+  auto maps = maker.mapVector<int32_t, double>(
+      kSize,
+      [](vector_size_t row) { return row % 3; },
+      [](vector_size_t index) { return index; },
+      [](vector_size_t index) { return index * 1.5; },
+      test::VectorMaker::nullEvery(13));
+  auto rows = maker.rowVector({ints, bools, strings, arrays, maps});
+
+  auto indices = allocateIndices(kSize, pool_.get());
+  auto rawIndices = indices->asMutable<vector_size_t>();
+  for (auto i = 0; i < kSize; ++i) {
+    rawIndices[i] = kSize - 1 - i;
+  }
+  auto dictionary = BaseVector::wrapInDictionary(nullptr, indices, kSize, ints);
+  auto constant = BaseVector::wrapInConstant(kSize, 3, strings);
+
+  for (auto& vector : std::vector<VectorPtr>{
+           ints,
+           bools,
+           strings,
+           arrays,
+           maps,
+           rows,
+           dictionary,
+           constant}) {
+    // Offsets at and off a byte boundary of the nulls.
+    assertSlice(vector, 0, kSize);
+    assertSlice(vector, 8, 50);
+    assertSlice(vector, 13, 40);
+    assertSlice(vector, kSize, 0);
+  }
+
+  // The values are shared. Writing to the slice copies them and leaves the
+  // vector as it was.
+  auto slice = std::dynamic_pointer_cast<FlatVector<int64_t>>(
+      ints->slice(16, 20));
+  ASSERT_TRUE(slice->values()->isView());
+  ASSERT_EQ(slice->rawValues(), ints->rawValues() + 16);
+  slice->mutableRawValues()[0] = -1;
+  slice->setNull(1, true);
+  ASSERT_EQ(slice->valueAt(0), -1);
+  ASSERT_TRUE(slice->isNullAt(1));
+  ASSERT_EQ(ints->valueAt(16), 16);
+  ASSERT_FALSE(ints->isNullAt(17));
+
+  auto arraySlice =
+      std::dynamic_pointer_cast<ArrayVector>(arrays->slice(16, 20));
+  SelectivityVector allRows(arraySlice->size());
+  arraySlice->ensureWritable(allRows);
+  arraySlice->setOffsetAndSize(1, 0, 0);
+  ASSERT_EQ(arraySlice->sizeAt(1), 0);
+  ASSERT_EQ(arrays->sizeAt(17), 1);
+}